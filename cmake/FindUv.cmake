@@ -0,0 +1,20 @@
+# -*- cmake -*-
+#
+# Copyright 2022 Dmitry Igrishin
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set(dmitigr_librarian_lib Uv)
+set(${dmitigr_librarian_lib}_include_names uv.h)
+set(${dmitigr_librarian_lib}_library_names uv libuv)
+include(dmitigr_librarian)
@@ -26,6 +26,7 @@ dmitigr_libs_set_library_info(fsx 0 0 0 "Standard filesystem extensions")
 
 set(dmitigr_fsx_headers
   filesystem.hpp
+  mapped_file.hpp
   misc.hpp
   )
 
@@ -34,3 +35,12 @@ set(dmitigr_fsx_headers
 # ------------------------------------------------------------------------------
 
 dmitigr_append_cppfs(dmitigr_fsx_target_link_libraries_interface)
+
+# ------------------------------------------------------------------------------
+# Tests
+# ------------------------------------------------------------------------------
+
+if(DMITIGR_LIBS_TESTS)
+  set(dmitigr_fsx_tests mapped_file misc)
+  set(dmitigr_fsx_tests_target_link_libraries dmitigr_base)
+endif()
@@ -27,6 +27,7 @@ dmitigr_libs_set_library_info(net 0 0 0 "Networking")
 set(dmitigr_net_headers
   address.hpp
   basics.hpp
+  buffered_descriptor.hpp
   client.hpp
   conversions.hpp
   descriptor.hpp
@@ -35,7 +36,9 @@ set(dmitigr_net_headers
   exceptions.hpp
   last_error.hpp
   listener.hpp
+  poller.hpp
   socket.hpp
+  transfer.hpp
   types_fwd.hpp
   util.hpp
   )
@@ -43,18 +46,34 @@ set(dmitigr_net_headers
 set(dmitigr_net_implementations
   )
 
+if(WIN32)
+  list(APPEND dmitigr_net_headers iocp.hpp)
+endif()
+
+if(DMITIGR_LIBS_NET_IO_URING)
+  if(NOT CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    message(FATAL_ERROR "DMITIGR_LIBS_NET_IO_URING is supported only on Linux")
+  endif()
+  list(APPEND dmitigr_net_headers io_uring.hpp)
+endif()
+
 # ------------------------------------------------------------------------------
 # Dependencies
 # ------------------------------------------------------------------------------
 
 if (WIN32)
   if (CMAKE_SYSTEM_NAME MATCHES MSYS|MinGW|Cygwin AND CMAKE_CXX_COMPILER_ID MATCHES GNU|Clang)
-    list(APPEND dmitigr_net_target_link_libraries_interface libws2_32.a)
+    list(APPEND dmitigr_net_target_link_libraries_interface libws2_32.a libmswsock.a)
   else()
-    list(APPEND dmitigr_net_target_link_libraries_interface Ws2_32.lib)
+    list(APPEND dmitigr_net_target_link_libraries_interface Ws2_32.lib Mswsock.lib)
   endif()
 endif()
 
+if(DMITIGR_LIBS_NET_IO_URING)
+  list(APPEND dmitigr_net_target_compile_definitions_public DMITIGR_NET_IO_URING)
+  list(APPEND dmitigr_net_target_compile_definitions_interface DMITIGR_NET_IO_URING)
+endif()
+
 # ------------------------------------------------------------------------------
 # Tests
 # ------------------------------------------------------------------------------
@@ -62,6 +81,9 @@ endif()
 if(DMITIGR_LIBS_TESTS)
   if(UNIX AND NOT CMAKE_SYSTEM_NAME MATCHES MSYS|MinGW|Cygwin)
     set(dmitigr_net_tests net)
+    if(DMITIGR_LIBS_NET_IO_URING)
+      list(APPEND dmitigr_net_tests io_uring)
+    endif()
     set(dmitigr_net_tests_target_link_libraries dmitigr_base)
   endif()
 endif()
@@ -27,71 +27,181 @@ dmitigr_libs_set_library_info(pgfe 2 1 2 "PostgreSQL client API")
 set(dmitigr_pgfe_headers
   array_aliases.hpp
   array_conversions.hpp
+  arrow_batch_builder.hpp
   basic_conversions.hpp
   basics.hpp
+  batch_insert.hpp
+  bulk_completion.hpp
   copier.hpp
+  copy_binary_writer.hpp
+  copy_reader.hpp
+  copy_writer.hpp
+  csv_writer.hpp
+  cursor.hpp
+  column_decoder.hpp
   completion.hpp
+  coroutine.hpp
   compositional.hpp
   composite.hpp
   connection.hpp
+  connection_multiplexer.hpp
   connection_options.hpp
   connection_pool.hpp
+  connection_reactor.hpp
   contract.hpp
   conversions_api.hpp
   conversions.hpp
   data.hpp
+  data_arena.hpp
   errc.hpp
   errctg.hpp
   error.hpp
   exceptions.hpp
+  group_commit_executor.hpp
+  hedged_read_executor.hpp
+  json_row_writer.hpp
   large_object.hpp
+  large_object_streambuf.hpp
   message.hpp
+  metrics.hpp
   misc.hpp
   notice.hpp
   notification.hpp
+  notification_dispatcher.hpp
+  parallel_column_decoder.hpp
+  parallel_copy_exporter.hpp
+  parallel_copy_loader.hpp
+  parallel_large_object_transfer.hpp
+  parallel_range_query.hpp
+  partitioned_copy_loader.hpp
+  pending_result.hpp
+  poll_reactor.hpp
   parameterizable.hpp
   pq.hpp
   prepared_statement.hpp
+  prepared_statement_registry.hpp
   problem.hpp
+  query_catalog.hpp
+  reactor.hpp
+  read_coalescer.hpp
   ready_for_query.hpp
+  replication_stream.hpp
   response.hpp
+  result_cache.hpp
+  routing_connection_pool.hpp
   row.hpp
+  row_batch.hpp
   row_info.hpp
+  row_mapping.hpp
+  row_range.hpp
+  row_spool.hpp
+  shard_routing_pool.hpp
+  sharded_connection_pool.hpp
   signal.hpp
+  slow_query_sampler.hpp
   statement.hpp
+  statement_binding.hpp
+  statement_parser.hpp
+  statement_reader.hpp
+  statement_statistics.hpp
   statement_vector.hpp
+  static_parameters.hpp
+  traffic_recorder.hpp
+  traffic_replayer.hpp
   transaction_guard.hpp
+  type_catalog.hpp
   types_fwd.hpp
+  write_coalescer.hpp
   )
 
 set(dmitigr_pgfe_implementations
+  arrow_batch_builder.cpp
+  batch_insert.cpp
+  bulk_completion.cpp
   copier.cpp
+  copy_binary_writer.cpp
+  copy_reader.cpp
+  copy_writer.cpp
+  csv_writer.cpp
+  cursor.cpp
   completion.cpp
   composite.cpp
   compositional.cpp
   connection.cpp
+  connection_multiplexer.cpp
   connection_options.cpp
   connection_pool.cpp
+  connection_reactor.cpp
   data.cpp
+  data_arena.cpp
   errc.cpp
   errctg.cpp
   error.cpp
   exceptions.cpp
+  group_commit_executor.cpp
+  hedged_read_executor.cpp
+  json_row_writer.cpp
   large_object.cpp
+  large_object_streambuf.cpp
+  metrics.cpp
   misc.cpp
   notice.cpp
   notification.cpp
+  notification_dispatcher.cpp
+  parallel_column_decoder.cpp
+  parallel_copy_exporter.cpp
+  parallel_copy_loader.cpp
+  parallel_large_object_transfer.cpp
+  parallel_range_query.cpp
+  partitioned_copy_loader.cpp
+  pending_result.cpp
+  poll_reactor.cpp
   parameterizable.cpp
   prepared_statement.cpp
+  prepared_statement_registry.cpp
   problem.cpp
+  query_catalog.cpp
+  read_coalescer.cpp
   ready_for_query.cpp
+  replication_stream.cpp
+  result_cache.cpp
+  routing_connection_pool.cpp
   row.cpp
+  row_batch.cpp
   row_info.cpp
+  row_range.cpp
+  row_spool.cpp
+  shard_routing_pool.cpp
+  sharded_connection_pool.cpp
+  slow_query_sampler.cpp
   statement.cpp
+  statement_binding.cpp
+  statement_reader.cpp
+  statement_statistics.cpp
   statement_vector.cpp
+  traffic_recorder.cpp
+  traffic_replayer.cpp
   tuple.cpp
+  type_catalog.cpp
+  write_coalescer.cpp
   )
 
+if(DMITIGR_LIBS_PGFE_AIO)
+  if(DMITIGR_LIBS_AIO STREQUAL "uv")
+    list(APPEND dmitigr_pgfe_headers uv_reactor.hpp)
+    list(APPEND dmitigr_pgfe_implementations uv_reactor.cpp)
+  endif()
+endif()
+
+if(DMITIGR_LIBS_ZLIB)
+  list(APPEND dmitigr_pgfe_headers gzip_copy.hpp)
+  list(APPEND dmitigr_pgfe_implementations gzip_copy.cpp)
+endif()
+
+if(DMITIGR_LIBS_SIMDJSON)
+  list(APPEND dmitigr_pgfe_headers simdjson_conversions.hpp)
+endif()
+
 # ------------------------------------------------------------------------------
 # Dependencies
 # ------------------------------------------------------------------------------
@@ -114,19 +224,61 @@ else()
     ${PostgreSQL_LIBRARIES})
 endif()
 
+if(DMITIGR_LIBS_PGFE_AIO)
+  if(DMITIGR_LIBS_AIO STREQUAL "uv")
+    find_package(Uv REQUIRED)
+    list(APPEND dmitigr_pgfe_target_include_directories_public "${Uv_INCLUDE_DIRS}")
+    list(APPEND dmitigr_pgfe_target_include_directories_interface "${Uv_INCLUDE_DIRS}")
+    list(APPEND dmitigr_pgfe_target_link_libraries_public ${Uv_LIBRARIES})
+    list(APPEND dmitigr_pgfe_target_link_libraries_interface ${Uv_LIBRARIES})
+  endif()
+endif()
+
+if(DMITIGR_LIBS_ZLIB)
+  find_package(ZLIB REQUIRED)
+  list(APPEND dmitigr_pgfe_target_include_directories_public "${ZLIB_INCLUDE_DIRS}")
+  list(APPEND dmitigr_pgfe_target_include_directories_interface "${ZLIB_INCLUDE_DIRS}")
+  list(APPEND dmitigr_pgfe_target_link_libraries_public ${ZLIB_LIBRARIES})
+  list(APPEND dmitigr_pgfe_target_link_libraries_interface ${ZLIB_LIBRARIES})
+  list(APPEND dmitigr_pgfe_target_compile_definitions_public DMITIGR_PGFE_ZLIB)
+  list(APPEND dmitigr_pgfe_target_compile_definitions_interface DMITIGR_PGFE_ZLIB)
+endif()
+
+if(DMITIGR_LIBS_SIMDJSON)
+  find_package(simdjson REQUIRED)
+  list(APPEND dmitigr_pgfe_target_link_libraries_public simdjson::simdjson)
+  list(APPEND dmitigr_pgfe_target_link_libraries_interface simdjson::simdjson)
+  list(APPEND dmitigr_pgfe_target_compile_definitions_public DMITIGR_PGFE_SIMDJSON)
+  list(APPEND dmitigr_pgfe_target_compile_definitions_interface DMITIGR_PGFE_SIMDJSON)
+endif()
+
+if(DMITIGR_LIBS_PGFE_ALLOCATION_TRACKING)
+  list(APPEND dmitigr_pgfe_target_compile_definitions_public DMITIGR_PGFE_ALLOCATION_TRACKING)
+  list(APPEND dmitigr_pgfe_target_compile_definitions_interface DMITIGR_PGFE_ALLOCATION_TRACKING)
+endif()
+
 # ------------------------------------------------------------------------------
 # Tests
 # ------------------------------------------------------------------------------
 
 if(DMITIGR_LIBS_TESTS)
   set(dmitigr_pgfe_tests
+    allocation_tracking
     array_dimension
+    arrow_batch_builder
+    batch_insert
+    bench
     benchmark_array_client
     benchmark_array_server
+    benchmark_connection_pool
+    benchmark_conversions
+    benchmark_statement
+    benchmark_statement_copy
     benchmark_statement_replace
     composite
     connection
     connection_deferrable
+    connection_multiplexer
     connection-err_in_mid
     connection_options
     connection_pool
@@ -135,18 +287,49 @@ if(DMITIGR_LIBS_TESTS)
     conversions
     conversions_online
     copier
+    copy_throughput
+    csv_writer
+    cursor
     data
     exceptions
+    feature_throughput
+    hedged_read_executor
     hello_world
+    json_row_writer
+    latency_proxy
+    load
+    parallel_column_decoder
     pipeline
+    poll_reactor
     pq_vs_pgfe
     ps
+    ps_allocations
+    ps_registry
+    query_catalog
     lob
+    replication_stream
+    metrics
+    notification_dispatcher
+    routing_connection_pool
     row
+    row_range
+    row_spool
+    read_coalescer
+    shard_routing_pool
+    sharded_connection_pool
+    slow_query_sampler
     statement
+    statement_binding
+    statement_statistics
     statement_vector
+    traffic_replayer
     transaction_guard
+    type_catalog
+    write_coalescer
     )
+  if(DMITIGR_LIBS_ZLIB)
+    list(APPEND dmitigr_pgfe_tests gzip_copy)
+  endif()
 
   set(dmitigr_pgfe_tests_target_link_libraries dmitigr_base dmitigr_os dmitigr_str
     dmitigr_util)
@@ -29,10 +29,12 @@ set(dmitigr_str_headers
   c_str.h
   c_str.hpp
   exceptions.hpp
+  hex.hpp
   line.hpp
   numeric.hpp
   predicate.hpp
   sequence.hpp
+  simd.hpp
   stream.hpp
   substr.hpp
   time.hpp
@@ -44,6 +46,6 @@ set(dmitigr_str_headers
 # ------------------------------------------------------------------------------
 
 if(DMITIGR_LIBS_TESTS)
-  set(dmitigr_str_tests test time)
+  set(dmitigr_str_tests hex test time)
   set(dmitigr_str_tests_target_link_libraries dmitigr_base)
 endif()
@@ -29,6 +29,8 @@ set(dmitigr_util_headers
   contract.hpp
   diagnostic.hpp
   memory.hpp
+  ring_buffer.hpp
+  small_vector.hpp
   )
 
 # ------------------------------------------------------------------------------
@@ -36,5 +38,5 @@ set(dmitigr_util_headers
 # ------------------------------------------------------------------------------
 
 if(DMITIGR_LIBS_TESTS)
-  set(dmitigr_util_tests diag)
+  set(dmitigr_util_tests diag ring_buffer small_vector)
 endif()
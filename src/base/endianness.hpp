@@ -17,6 +17,26 @@
 #ifndef DMITIGR_BASE_ENDIANNESS_HPP
 #define DMITIGR_BASE_ENDIANNESS_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * The bulk conversions are vectorized by AVX2, SSSE3 or NEON if available at
+ * compile time. Otherwise, the scalar loops are left to the auto-vectorizer.
+ */
+#if defined(__AVX2__)
+#define DMITIGR_BASE_ENDIANNESS_AVX2
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#define DMITIGR_BASE_ENDIANNESS_SSSE3
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define DMITIGR_BASE_ENDIANNESS_NEON
+#include <arm_neon.h>
+#endif
+
 namespace dmitigr {
 
 /// An endianness.
@@ -39,6 +59,203 @@ inline Endianness endianness() noexcept
   return result;
 }
 
+/// @returns `true` if the system is big-endian. (Known at compile time.)
+constexpr bool is_big_endian() noexcept
+{
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+  return __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+#else
+  return false; // MSVC targets are little-endian
+#endif
+}
+
+/// @returns The `value` with the reversed order of bytes.
+constexpr std::uint16_t byte_swapped(const std::uint16_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap16(value);
+#else
+  return static_cast<std::uint16_t>((value >> 8) | (value << 8));
+#endif
+}
+
+/// @overload
+constexpr std::uint32_t byte_swapped(const std::uint32_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap32(value);
+#else
+  return (value >> 24) | ((value >> 8) & 0x0000ff00) |
+    ((value << 8) & 0x00ff0000) | (value << 24);
+#endif
+}
+
+/// @overload
+constexpr std::uint64_t byte_swapped(const std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(value);
+#else
+  return (std::uint64_t{byte_swapped(static_cast<std::uint32_t>(value))} << 32) |
+    byte_swapped(static_cast<std::uint32_t>(value >> 32));
+#endif
+}
+
+namespace detail {
+
+/// The unsigned integer of the given size.
+template<std::size_t Size> struct Uint_of_size;
+template<> struct Uint_of_size<1> { using Type = std::uint8_t; };
+template<> struct Uint_of_size<2> { using Type = std::uint16_t; };
+template<> struct Uint_of_size<4> { using Type = std::uint32_t; };
+template<> struct Uint_of_size<8> { using Type = std::uint64_t; };
+
+} // namespace detail
+
+/**
+ * @returns The value of type `T` converted from big-endian to the order of
+ * the system or vice versa.
+ *
+ * @remarks The function is `constexpr` for integers.
+ */
+template<typename T>
+constexpr T big_endian_swapped(const T value) noexcept
+{
+  static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+  using U = typename detail::Uint_of_size<sizeof(T)>::Type;
+  if constexpr (is_big_endian() || sizeof(T) == 1)
+    return value;
+  else if constexpr (std::is_floating_point_v<T>) {
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    bits = byte_swapped(bits);
+    T result;
+    std::memcpy(&result, &bits, sizeof(T));
+    return result;
+  } else
+    return static_cast<T>(byte_swapped(static_cast<U>(value)));
+}
+
+/// @returns The value of type `T` loaded from big-endian (unaligned) `bytes`.
+template<typename T>
+inline T load_big_endian(const void* const bytes) noexcept
+{
+  T result;
+  std::memcpy(&result, bytes, sizeof(T));
+  return big_endian_swapped(result);
+}
+
+/// Stores the `value` to `bytes` (unaligned) in big-endian.
+template<typename T>
+inline void store_big_endian(void* const bytes, const T value) noexcept
+{
+  const auto swapped = big_endian_swapped(value);
+  std::memcpy(bytes, &swapped, sizeof(T));
+}
+
+namespace detail {
+
+/// Copies the `count` values of size `Size` with the reversed order of bytes.
+template<std::size_t Size>
+inline void copy_byte_swapped(char* dest, const char* src,
+  std::size_t count) noexcept
+{
+  using U = typename Uint_of_size<Size>::Type;
+#if defined(DMITIGR_BASE_ENDIANNESS_AVX2) || defined(DMITIGR_BASE_ENDIANNESS_SSSE3)
+  // The shuffle mask which reverses the bytes of each value of a lane.
+  alignas(16) char mask[16];
+  for (std::size_t i{}; i < 16; ++i)
+    mask[i] = static_cast<char>(i - i % Size + (Size - 1 - i % Size));
+  const __m128i mask128{_mm_load_si128(reinterpret_cast<const __m128i*>(mask))};
+#if defined(DMITIGR_BASE_ENDIANNESS_AVX2)
+  const __m256i mask256{_mm256_broadcastsi128_si256(mask128)};
+  constexpr std::size_t per256{32 / Size};
+  for (; count >= per256; count -= per256, dest += 32, src += 32) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+      _mm256_shuffle_epi8(v, mask256));
+  }
+#endif
+  constexpr std::size_t per128{16 / Size};
+  for (; count >= per128; count -= per128, dest += 16, src += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+      _mm_shuffle_epi8(v, mask128));
+  }
+#elif defined(DMITIGR_BASE_ENDIANNESS_NEON)
+  constexpr std::size_t per128{16 / Size};
+  for (; count >= per128; count -= per128, dest += 16, src += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(src));
+    uint8x16_t r;
+    if constexpr (Size == 2)
+      r = vrev16q_u8(v);
+    else if constexpr (Size == 4)
+      r = vrev32q_u8(v);
+    else
+      r = vrev64q_u8(v);
+    vst1q_u8(reinterpret_cast<std::uint8_t*>(dest), r);
+  }
+#endif
+  for (; count; --count, dest += Size, src += Size) {
+    U value;
+    std::memcpy(&value, src, Size);
+    value = byte_swapped(value);
+    std::memcpy(dest, &value, Size);
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Copies the `count` big-endian values of type `T` from the `src` to
+ * the `dest` in the order of the system.
+ *
+ * @details This is the bulk version of load_big_endian() vectorized by SIMD
+ * instructions where available.
+ *
+ * @par Requires
+ * The `src` and `dest` must not overlap unless they are equal.
+ */
+template<typename T>
+inline void copy_from_big_endian(T* const dest, const void* const src,
+  const std::size_t count) noexcept
+{
+  static_assert(std::is_arithmetic_v<T>);
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+    sizeof(T) == 8);
+  if constexpr (is_big_endian() || sizeof(T) == 1) {
+    if (static_cast<const void*>(dest) != src)
+      std::memcpy(dest, src, count * sizeof(T));
+  } else
+    detail::copy_byte_swapped<sizeof(T)>(reinterpret_cast<char*>(dest),
+      static_cast<const char*>(src), count);
+}
+
+/**
+ * @brief Copies the `count` values of type `T` from the `src` to the `dest`
+ * in big-endian.
+ *
+ * @details This is the bulk version of store_big_endian() vectorized by SIMD
+ * instructions where available.
+ *
+ * @par Requires
+ * The `src` and `dest` must not overlap unless they are equal.
+ */
+template<typename T>
+inline void copy_to_big_endian(void* const dest, const T* const src,
+  const std::size_t count) noexcept
+{
+  static_assert(std::is_arithmetic_v<T>);
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+    sizeof(T) == 8);
+  if constexpr (is_big_endian() || sizeof(T) == 1) {
+    if (dest != static_cast<const void*>(src))
+      std::memcpy(dest, src, count * sizeof(T));
+  } else
+    detail::copy_byte_swapped<sizeof(T)>(static_cast<char*>(dest),
+      reinterpret_cast<const char*>(src), count);
+}
+
 } // namespace dmitigr
 
 #endif  // DMITIGR_BASE_ENDIANNESS_HPP
@@ -18,6 +18,7 @@
 #define DMITIGR_FSX_FSX_HPP
 
 #include "filesystem.hpp"
+#include "mapped_file.hpp"
 #include "misc.hpp"
 
 #endif  // DMITIGR_FSX_FSX_HPP
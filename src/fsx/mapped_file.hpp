@@ -0,0 +1,348 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_FSX_MAPPED_FILE_HPP
+#define DMITIGR_FSX_MAPPED_FILE_HPP
+
+#include "filesystem.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dmitigr::fsx {
+
+/// A mode of a memory mapping.
+enum class Mapped_file_mode {
+  /// The content can be only read.
+  read_only,
+
+  /// The content can be read and written. The changes are written to the file.
+  read_write
+};
+
+/// An advice about the expected access pattern of a memory mapping.
+enum class Mapped_file_advice {
+  /// No special treatment.
+  normal,
+
+  /// The content will be accessed sequentially (aggressive read-ahead).
+  sequential,
+
+  /// The content will be accessed randomly (no read-ahead).
+  random,
+
+  /// The content will be accessed soon (it's worth to prefetch it).
+  willneed,
+
+  /// The content will not be accessed soon.
+  dontneed
+};
+
+/**
+ * @brief A memory mapping of a whole file.
+ *
+ * @details The content of the file is accessible without copying. The
+ * mapping is unmapped upon destruction.
+ */
+class Mapped_file final {
+public:
+  /// Unmaps the file.
+  ~Mapped_file()
+  {
+    close();
+  }
+
+  /// Constructs the instance which doesn't map anything.
+  Mapped_file() noexcept = default;
+
+  /**
+   * @brief Maps the file at `path` into the memory.
+   *
+   * @param path The path to the file to map.
+   * @param mode The mapping mode.
+   * @param huge_pages The indicator to request backing of the mapping by huge
+   * pages (transparent huge pages on Linux). This is just a hint which is
+   * ignored if not supported.
+   *
+   * @throws `std::filesystem::filesystem_error` on failure.
+   */
+  explicit Mapped_file(const std::filesystem::path& path,
+    const Mapped_file_mode mode = Mapped_file_mode::read_only,
+    const bool huge_pages = false)
+    : mode_{mode}
+  {
+    const bool is_writable{mode_ == Mapped_file_mode::read_write};
+#ifdef _WIN32
+    const auto file = CreateFileW(path.c_str(),
+      is_writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      throw_error("cannot open file to map", path, last_error());
+
+    const auto close_file_and_throw = [file, &path](const char* const what)
+    {
+      const auto ec = last_error();
+      CloseHandle(file);
+      throw_error(what, path, ec);
+    };
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size))
+      close_file_and_throw("cannot get size of file to map");
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_) {
+      // Large pages are available only for the mappings backed by the paging
+      // file, so `huge_pages` is ignored here.
+      (void)huge_pages;
+      const auto mapping = CreateFileMappingW(file, nullptr,
+        is_writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+      if (!mapping)
+        close_file_and_throw("cannot map file");
+      data_ = static_cast<char*>(MapViewOfFile(mapping,
+          is_writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+      const auto ec = last_error();
+      CloseHandle(mapping);
+      CloseHandle(file);
+      if (!data_)
+        throw_error("cannot map file", path, ec);
+    } else
+      CloseHandle(file);
+#else
+    const int fd{::open(path.c_str(),
+      (is_writable ? O_RDWR : O_RDONLY) | O_CLOEXEC)};
+    if (fd < 0)
+      throw_error("cannot open file to map", path, last_error());
+
+    const auto close_file_and_throw = [fd, &path](const char* const what)
+    {
+      const auto ec = last_error();
+      ::close(fd);
+      throw_error(what, path, ec);
+    };
+
+    struct stat st{};
+    if (::fstat(fd, &st))
+      close_file_and_throw("cannot get size of file to map");
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_) {
+      void* const data{::mmap(nullptr, size_,
+          is_writable ? PROT_READ | PROT_WRITE : PROT_READ,
+          is_writable ? MAP_SHARED : MAP_PRIVATE, fd, 0)};
+      if (data == MAP_FAILED)
+        close_file_and_throw("cannot map file");
+      data_ = static_cast<char*>(data);
+#ifdef MADV_HUGEPAGE
+      if (huge_pages)
+        ::madvise(data_, size_, MADV_HUGEPAGE);
+#else
+      (void)huge_pages;
+#endif
+    }
+    ::close(fd);
+#endif
+  }
+
+  /// Non copy-constructible.
+  Mapped_file(const Mapped_file&) = delete;
+
+  /// Non copy-assignable.
+  Mapped_file& operator=(const Mapped_file&) = delete;
+
+  /// Move-constructible.
+  Mapped_file(Mapped_file&& rhs) noexcept
+    : mode_{rhs.mode_}
+    , data_{std::exchange(rhs.data_, nullptr)}
+    , size_{std::exchange(rhs.size_, 0)}
+  {}
+
+  /// Move-assignable.
+  Mapped_file& operator=(Mapped_file&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Mapped_file tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// Swaps this instance with `rhs`.
+  void swap(Mapped_file& rhs) noexcept
+  {
+    using std::swap;
+    swap(mode_, rhs.mode_);
+    swap(data_, rhs.data_);
+    swap(size_, rhs.size_);
+  }
+
+  /**
+   * @brief Unmaps the file. The behaviour is no-op if nothing is mapped.
+   *
+   * @remarks The changes made in the `Mapped_file_mode::read_write` mode are
+   * written to the file eventually, use flush() to write them immediately.
+   */
+  void close() noexcept
+  {
+    if (data_) {
+#ifdef _WIN32
+      UnmapViewOfFile(data_);
+#else
+      ::munmap(data_, size_);
+#endif
+      data_ = nullptr;
+    }
+    size_ = 0;
+  }
+
+  /**
+   * @brief Writes the changes of the mapped content to the file.
+   *
+   * @details The behaviour is no-op if the mode is `Mapped_file_mode::read_only`
+   * or nothing is mapped.
+   *
+   * @throws `std::filesystem::filesystem_error` on failure.
+   */
+  void flush() const
+  {
+    if (!data_ || mode_ != Mapped_file_mode::read_write)
+      return;
+
+#ifdef _WIN32
+    if (!FlushViewOfFile(data_, 0))
+#else
+    if (::msync(data_, size_, MS_SYNC))
+#endif
+      throw std::filesystem::filesystem_error{"cannot flush mapped file",
+        last_error()};
+  }
+
+  /**
+   * @brief Advises the operating system about the expected access pattern.
+   *
+   * @returns `true` if the advice is accepted, or `false` if it's not
+   * supported or nothing is mapped. The advice is never mandatory.
+   */
+  bool advise(const Mapped_file_advice advice) const noexcept
+  {
+    if (!data_)
+      return false;
+
+#ifdef _WIN32
+    if (advice == Mapped_file_advice::willneed) {
+#if _WIN32_WINNT >= 0x0602
+      WIN32_MEMORY_RANGE_ENTRY range{data_, size_};
+      return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+    }
+    return false;
+#else
+    const int value = [advice]
+    {
+      switch (advice) {
+      case Mapped_file_advice::normal: return POSIX_MADV_NORMAL;
+      case Mapped_file_advice::sequential: return POSIX_MADV_SEQUENTIAL;
+      case Mapped_file_advice::random: return POSIX_MADV_RANDOM;
+      case Mapped_file_advice::willneed: return POSIX_MADV_WILLNEED;
+      case Mapped_file_advice::dontneed: return POSIX_MADV_DONTNEED;
+      }
+      return POSIX_MADV_NORMAL;
+    }();
+    return !::posix_madvise(data_, size_, value);
+#endif
+  }
+
+  /// @returns The mapping mode.
+  Mapped_file_mode mode() const noexcept
+  {
+    return mode_;
+  }
+
+  /// @returns The pointer to the mapped content, or `nullptr` if the content
+  /// is empty.
+  const char* data() const noexcept
+  {
+    return data_;
+  }
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `mode() == Mapped_file_mode::read_write` to write the content.
+   */
+  char* data() noexcept
+  {
+    return data_;
+  }
+
+  /// @returns The size of the mapped content.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns `true` if the mapped content is empty.
+  bool is_empty() const noexcept
+  {
+    return !size_;
+  }
+
+  /// @returns The view of the mapped content.
+  std::string_view view() const noexcept
+  {
+    return {data_, size_};
+  }
+
+private:
+  Mapped_file_mode mode_{Mapped_file_mode::read_only};
+  char* data_{};
+  std::size_t size_{};
+
+  /// @returns The last error of the operating system.
+  static std::error_code last_error() noexcept
+  {
+#ifdef _WIN32
+    return {static_cast<int>(GetLastError()), std::system_category()};
+#else
+    return {errno, std::system_category()};
+#endif
+  }
+
+  [[noreturn]] static void throw_error(const char* const what,
+    const std::filesystem::path& path, const std::error_code ec)
+  {
+    throw std::filesystem::filesystem_error{what, path, ec};
+  }
+};
+
+} // namespace dmitigr::fsx
+
+#endif  // DMITIGR_FSX_MAPPED_FILE_HPP
@@ -19,7 +19,15 @@
 
 #include "filesystem.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 namespace dmitigr::fsx {
@@ -58,7 +66,8 @@ file_paths_by_extension(const std::filesystem::path& root,
     {
       for (const auto& dirent : iterator) {
         const auto& path = dirent.path();
-        if (is_regular_file(path) && path.extension() == extension)
+        // The file type is usually cached by the directory iterator.
+        if (path.extension() == extension && dirent.is_regular_file())
           result.push_back(dirent);
       }
     };
@@ -71,6 +80,120 @@ file_paths_by_extension(const std::filesystem::path& root,
   return result;
 }
 
+/**
+ * @brief The parallel version of the recursive file_paths_by_extension().
+ *
+ * @details The subdirectories are distributed among `thread_count` threads
+ * dynamically, so the threads which are done with their directories take the
+ * pending ones. The types of the directory entries are taken from the
+ * directory iterator where possible to avoid an extra `stat` per entry. The
+ * symbolic links to directories are not followed.
+ *
+ * @param thread_count - the number of threads, or `0` to use the number of
+ * concurrent threads supported by the implementation.
+ *
+ * @returns The sorted vector of the paths.
+ *
+ * @see file_paths_by_extension().
+ */
+inline std::vector<std::filesystem::path>
+file_paths_by_extension_parallel(const std::filesystem::path& root,
+  const std::filesystem::path& extension, const bool include_heading = false,
+  std::size_t thread_count = 0)
+{
+  namespace fs = std::filesystem;
+
+  if (!is_directory(root))
+    return file_paths_by_extension(root, extension, false, include_heading);
+
+  if (!thread_count)
+    thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+
+  std::mutex mutex;
+  std::condition_variable pending_changed;
+  std::vector<fs::path> pending{root};
+  std::size_t active_count{};
+  std::exception_ptr error;
+  std::vector<std::vector<fs::path>> results(thread_count);
+
+  const auto worker = [&](std::vector<fs::path>& result)
+  {
+    std::vector<fs::path> subdirs;
+    while (true) {
+      fs::path dir;
+      {
+        std::unique_lock lock{mutex};
+        pending_changed.wait(lock, [&]
+        {
+          return error || !pending.empty() || !active_count;
+        });
+        if (error || pending.empty())
+          return;
+        dir = std::move(pending.back());
+        pending.pop_back();
+        ++active_count;
+      }
+
+      try {
+        for (const auto& dirent : fs::directory_iterator{dir}) {
+          const auto& path = dirent.path();
+          if (dirent.is_symlink()) {
+            if (path.extension() == extension && dirent.is_regular_file())
+              result.push_back(path);
+          } else if (dirent.is_directory())
+            subdirs.push_back(path);
+          else if (path.extension() == extension && dirent.is_regular_file())
+            result.push_back(path);
+        }
+      } catch (...) {
+        const std::lock_guard lg{mutex};
+        if (!error)
+          error = std::current_exception();
+      }
+
+      {
+        const std::lock_guard lg{mutex};
+        pending.insert(pending.end(), std::make_move_iterator(subdirs.begin()),
+          std::make_move_iterator(subdirs.end()));
+        --active_count;
+      }
+      subdirs.clear();
+      pending_changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  try {
+    for (std::size_t i{1}; i < thread_count; ++i)
+      threads.emplace_back(worker, std::ref(results[i]));
+  } catch (...) {
+    {
+      const std::lock_guard lg{mutex};
+      error = std::current_exception();
+    }
+    pending_changed.notify_all();
+  }
+  worker(results[0]);
+  for (auto& thread : threads)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+
+  std::vector<fs::path> result;
+  if (include_heading) {
+    auto heading_file = root;
+    heading_file.replace_extension(extension);
+    if (is_regular_file(heading_file))
+      result.push_back(heading_file);
+  }
+  for (auto& paths : results)
+    result.insert(result.end(), std::make_move_iterator(paths.begin()),
+      std::make_move_iterator(paths.end()));
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
 /**
  * @brief Searches for the `dir` directory starting from `path` up to the root.
  *
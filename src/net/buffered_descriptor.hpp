@@ -0,0 +1,285 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_BUFFERED_DESCRIPTOR_HPP
+#define DMITIGR_NET_BUFFERED_DESCRIPTOR_HPP
+
+#include "descriptor.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ios> // std::streamsize
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::net {
+
+/**
+ * @brief A descriptor with the read and write buffers over another descriptor.
+ *
+ * @details Small reads are served from the read buffer which is filled by a
+ * single read of the underlying descriptor. Small writes are accumulated in
+ * the write buffer until it's full or flush() is called. The reads and writes
+ * not smaller than the respective buffer are performed directly.
+ */
+class Buffered_descriptor final : public Descriptor {
+public:
+  /// The default size of the buffers.
+  static constexpr std::size_t default_buffer_size{8192};
+
+  /// The destructor. Flushes the write buffer.
+  ~Buffered_descriptor() override
+  {
+    if (!write_buffer_.empty()) {
+      try {
+        flush();
+      } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+      } catch (...) {
+        std::fprintf(stderr, "bug\n");
+      }
+    }
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `descriptor && read_buffer_size && write_buffer_size`.
+   */
+  explicit Buffered_descriptor(std::unique_ptr<Descriptor> descriptor,
+    const std::size_t read_buffer_size = default_buffer_size,
+    const std::size_t write_buffer_size = default_buffer_size)
+    : descriptor_{std::move(descriptor)}
+  {
+    if (!descriptor_)
+      throw Exception{"cannot create buffered descriptor: invalid descriptor"};
+    else if (!read_buffer_size || !write_buffer_size)
+      throw Exception{"cannot create buffered descriptor: invalid buffer size"};
+
+    read_buffer_.resize(read_buffer_size);
+    write_buffer_.reserve(write_buffer_size);
+  }
+
+  /// Not copy-constructible.
+  Buffered_descriptor(const Buffered_descriptor&) = delete;
+
+  /// Not copy-assignable.
+  Buffered_descriptor& operator=(const Buffered_descriptor&) = delete;
+
+  /// Not move-constructible.
+  Buffered_descriptor(Buffered_descriptor&&) = delete;
+
+  /// Not move-assignable.
+  Buffered_descriptor& operator=(Buffered_descriptor&&) = delete;
+
+  /// @returns The underlying descriptor.
+  Descriptor& descriptor() const noexcept
+  {
+    return *descriptor_;
+  }
+
+  /// @returns The size of the read buffer.
+  std::size_t read_buffer_size() const noexcept
+  {
+    return read_buffer_.size();
+  }
+
+  /// @returns The size of the write buffer.
+  std::size_t write_buffer_size() const noexcept
+  {
+    return write_buffer_.capacity();
+  }
+
+  /// @returns The number of bytes available in the read buffer.
+  std::size_t read_buffered() const noexcept
+  {
+    return read_end_ - read_pos_;
+  }
+
+  /// @returns The number of bytes pending in the write buffer.
+  std::size_t write_buffered() const noexcept
+  {
+    return write_buffer_.size();
+  }
+
+  std::streamsize max_read_size() const override
+  {
+    return descriptor_->max_read_size();
+  }
+
+  std::streamsize max_write_size() const override
+  {
+    return descriptor_->max_write_size();
+  }
+
+  /**
+   * @brief Reads from the read buffer, or from the underlying descriptor if
+   * the read buffer is empty.
+   *
+   * @returns Number of bytes read. Zero means the end of input if `len > 0`.
+   */
+  std::streamsize read(char* const buf, const std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot read from buffered descriptor to null buffer"};
+    else if (len <= 0)
+      return 0;
+
+    const auto size = static_cast<std::size_t>(len);
+    if (!read_buffered()) {
+      if (size >= read_buffer_.size())
+        return descriptor_->read(buf, len);
+      else if (!fill())
+        return 0;
+    }
+    const auto result = std::min(size, read_buffered());
+    std::memcpy(buf, read_buffer_.data() + read_pos_, result);
+    read_pos_ += result;
+    return static_cast<std::streamsize>(result);
+  }
+
+  /**
+   * @brief Writes to the write buffer, and flushes it if it's full.
+   *
+   * @returns `len`.
+   */
+  std::streamsize write(const char* const buf, const std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot write to buffered descriptor from null buffer"};
+    else if (len <= 0)
+      return 0;
+
+    const auto size = static_cast<std::size_t>(len);
+    const auto capacity = write_buffer_.capacity();
+    if (write_buffer_.size() + size > capacity)
+      flush();
+    if (size >= capacity)
+      write_all(buf, size);
+    else
+      write_buffer_.insert(write_buffer_.end(), buf, buf + size);
+    return len;
+  }
+
+  /// Writes the write buffer to the underlying descriptor.
+  void flush()
+  {
+    if (!write_buffer_.empty()) {
+      write_all(write_buffer_.data(), write_buffer_.size());
+      write_buffer_.clear();
+    }
+  }
+
+  /**
+   * @returns The data available in the read buffer, which is filled by a
+   * single read of the underlying descriptor if it's empty. An empty result
+   * means the end of input.
+   *
+   * @remarks The result is invalidated by the subsequent reads.
+   */
+  std::string_view peek()
+  {
+    if (!read_buffered())
+      fill();
+    return {read_buffer_.data() + read_pos_, read_buffered()};
+  }
+
+  /**
+   * @brief Reads until the `delimiter` (inclusive), the end of input, or
+   * until `max_size` bytes read.
+   *
+   * @details Appends the data read to the `result`.
+   *
+   * @returns The number of bytes appended to the `result`. Zero means the
+   * end of input if `max_size > 0`.
+   */
+  std::size_t read_until(std::string& result, const char delimiter,
+    const std::size_t max_size = std::numeric_limits<std::size_t>::max())
+  {
+    std::size_t count{};
+    while (count < max_size) {
+      if (!read_buffered() && !fill())
+        break;
+
+      const char* const b = read_buffer_.data() + read_pos_;
+      const auto n = std::min(read_buffered(), max_size - count);
+      const auto* const d = static_cast<const char*>(std::memchr(b, delimiter, n));
+      const auto size = d ? static_cast<std::size_t>(d - b) + 1 : n;
+      result.append(b, size);
+      read_pos_ += size;
+      count += size;
+      if (d)
+        break;
+    }
+    return count;
+  }
+
+  /// Flushes the write buffer and closes the underlying descriptor.
+  void close() override
+  {
+    flush();
+    descriptor_->close();
+  }
+
+  std::intptr_t native_handle() override
+  {
+    return descriptor_->native_handle();
+  }
+
+private:
+  std::unique_ptr<Descriptor> descriptor_;
+  std::vector<char> read_buffer_;
+  std::size_t read_pos_{};
+  std::size_t read_end_{};
+  std::vector<char> write_buffer_;
+
+  /// @returns `false` on the end of input.
+  bool fill()
+  {
+    read_pos_ = read_end_ = 0;
+    const auto n = descriptor_->read(read_buffer_.data(),
+      static_cast<std::streamsize>(read_buffer_.size()));
+    read_end_ = static_cast<std::size_t>(n);
+    return n > 0;
+  }
+
+  void write_all(const char* buf, std::size_t size)
+  {
+    while (size) {
+      const auto max_size =
+        static_cast<std::size_t>(descriptor_->max_write_size());
+      const auto n = descriptor_->write(buf,
+        static_cast<std::streamsize>(std::min(size, max_size)));
+      if (n <= 0)
+        throw Exception{"cannot write to buffered descriptor"};
+      buf += n;
+      size -= static_cast<std::size_t>(n);
+    }
+  }
+};
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_BUFFERED_DESCRIPTOR_HPP
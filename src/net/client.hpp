@@ -53,8 +53,26 @@ public:
     return endpoint_;
   }
 
+  /**
+   * @brief Sets the TCP options of the connecting socket.
+   *
+   * @remarks Has effect only with `Communication_mode::net`.
+   */
+  Client_options& set_tcp_options(Tcp_options value) noexcept
+  {
+    tcp_options_ = std::move(value);
+    return *this;
+  }
+
+  /// @returns The TCP options.
+  const Tcp_options& tcp_options() const noexcept
+  {
+    return tcp_options_;
+  }
+
 private:
   Endpoint endpoint_;
+  Tcp_options tcp_options_;
 };
 
 /**
@@ -65,9 +83,18 @@ inline std::unique_ptr<Descriptor> make_tcp_connection(const Client_options& opt
 {
   using Sockdesc = detail::socket_Descriptor;
 
-  static const auto make_tcp_connection = [](const Socket_address& addr)
+  const auto make_tcp_connection = [&opts](const Socket_address& addr)
   {
     auto result = make_tcp_socket(addr.family());
+    if (opts.endpoint().communication_mode() == Communication_mode::net) {
+      const auto& tcp = opts.tcp_options();
+      set_tcp_options(result, tcp);
+#ifdef TCP_FASTOPEN_CONNECT
+      if (tcp.fast_open)
+        detail::set_socket_option(result, IPPROTO_TCP, TCP_FASTOPEN_CONNECT,
+          *tcp.fast_open, "TCP_FASTOPEN_CONNECT");
+#endif
+    }
     connect_socket(result, addr);
     return result;
   };
@@ -45,6 +45,15 @@ inline void copy(void* const dest, const std::size_t dest_size,
   else if (!(src_size <= dest_size))
     throw Exception{"net::copy destination would not fit the source"};
 
+  // Fast path for the fixed-size values: a single (intrinsic) byte swap.
+  if (src_size == dest_size) {
+    switch (src_size) {
+    case 2: copy_from_big_endian(static_cast<std::uint16_t*>(dest), src, 1); return;
+    case 4: copy_from_big_endian(static_cast<std::uint32_t*>(dest), src, 1); return;
+    case 8: copy_from_big_endian(static_cast<std::uint64_t*>(dest), src, 1); return;
+    }
+  }
+
   const auto src_ubytes = static_cast<const unsigned char*>(src);
   const auto dest_ubytes = static_cast<unsigned char*>(dest);
   switch (endianness()) {
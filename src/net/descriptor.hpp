@@ -23,16 +23,39 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdio>
 #include <ios> // std::streamsize
 #include <utility> // std::move()
+#include <vector>
 
 #ifdef _WIN32
 #include "../os/windows.hpp"
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 namespace dmitigr::net {
 
+/// A buffer to read into.
+struct Mutable_buffer final {
+  /// The data.
+  char* data{};
+
+  /// The size of data.
+  std::streamsize size{};
+};
+
+/// A buffer to write from.
+struct Const_buffer final {
+  /// The data.
+  const char* data{};
+
+  /// The size of data.
+  std::streamsize size{};
+};
+
 /// A descriptor to perform low-level I/O operations.
 class Descriptor {
 public:
@@ -59,6 +82,60 @@ public:
    */
   virtual std::streamsize write(const char* buf, std::streamsize len) = 0;
 
+  /**
+   * @brief Reads from this descriptor into the `count` buffers synchronously.
+   *
+   * @details The buffers are filled in order. The default implementation calls
+   * read() for each buffer until it's filled partially.
+   *
+   * @returns Number of bytes read.
+   *
+   * @par Requires
+   * `(bufs || !count)`.
+   */
+  virtual std::streamsize readv(const Mutable_buffer* const bufs,
+    const std::size_t count)
+  {
+    if (!bufs && count)
+      throw Exception{"cannot read to null buffers"};
+
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i) {
+      const auto n = read(bufs[i].data, bufs[i].size);
+      result += n;
+      if (n < bufs[i].size)
+        break;
+    }
+    return result;
+  }
+
+  /**
+   * @brief Writes the `count` buffers to this descriptor synchronously.
+   *
+   * @details The buffers are written in order. The default implementation calls
+   * write() for each buffer until it's written partially.
+   *
+   * @returns Number of bytes written.
+   *
+   * @par Requires
+   * `(bufs || !count)`.
+   */
+  virtual std::streamsize writev(const Const_buffer* const bufs,
+    const std::size_t count)
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write from null buffers"};
+
+    std::streamsize result{};
+    for (std::size_t i{}; i < count; ++i) {
+      const auto n = write(bufs[i].data, bufs[i].size);
+      result += n;
+      if (n < bufs[i].size)
+        break;
+    }
+    return result;
+  }
+
   /// Closes the descriptor.
   virtual void close() = 0;
 
@@ -146,6 +223,87 @@ public:
     return static_cast<std::streamsize>(result);
   }
 
+  std::streamsize readv(const Mutable_buffer* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot read from socket to null buffers"};
+
+    count = std::min(count, max_buffer_count);
+#ifdef _WIN32
+    std::vector<WSABUF> wsabufs(count);
+    for (std::size_t i{}; i < count; ++i) {
+      if (!bufs[i].data)
+        throw Exception{"cannot read from socket to null buffer"};
+      wsabufs[i].buf = bufs[i].data;
+      wsabufs[i].len = static_cast<ULONG>(bufs[i].size);
+    }
+    DWORD result{};
+    DWORD flags{};
+    if (::WSARecv(socket_, wsabufs.data(), static_cast<DWORD>(count), &result,
+        &flags, nullptr, nullptr))
+      throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+#else
+    std::vector<iovec> iovs(count);
+    for (std::size_t i{}; i < count; ++i) {
+      if (!bufs[i].data)
+        throw Exception{"cannot read from socket to null buffer"};
+      iovs[i].iov_base = bufs[i].data;
+      iovs[i].iov_len = static_cast<std::size_t>(bufs[i].size);
+    }
+    msghdr msg{};
+    msg.msg_iov = iovs.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    const auto result = ::recvmsg(socket_, &msg, 0);
+    if (net::is_socket_error(result))
+      throw DMITIGR_NET_EXCEPTION{"cannot read from socket"};
+#endif
+    return static_cast<std::streamsize>(result);
+  }
+
+  std::streamsize writev(const Const_buffer* const bufs,
+    std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write to socket from null buffers"};
+
+    count = std::min(count, max_buffer_count);
+#ifdef _WIN32
+    std::vector<WSABUF> wsabufs(count);
+    for (std::size_t i{}; i < count; ++i) {
+      if (!bufs[i].data)
+        throw Exception{"cannot write to socket from null buffer"};
+      wsabufs[i].buf = const_cast<char*>(bufs[i].data);
+      wsabufs[i].len = static_cast<ULONG>(bufs[i].size);
+    }
+    DWORD result{};
+    if (::WSASend(socket_, wsabufs.data(), static_cast<DWORD>(count), &result,
+        0, nullptr, nullptr))
+      throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+#else
+    std::vector<iovec> iovs(count);
+    for (std::size_t i{}; i < count; ++i) {
+      if (!bufs[i].data)
+        throw Exception{"cannot write to socket from null buffer"};
+      iovs[i].iov_base = const_cast<char*>(bufs[i].data);
+      iovs[i].iov_len = static_cast<std::size_t>(bufs[i].size);
+    }
+    msghdr msg{};
+    msg.msg_iov = iovs.data();
+    msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(count);
+    // Unlike writev(2), sendmsg(2) accepts MSG_NOSIGNAL.
+#ifdef __APPLE__
+    constexpr int flags{};
+#else
+    constexpr int flags{MSG_NOSIGNAL};
+#endif
+    const auto result = ::sendmsg(socket_, &msg, flags);
+    if (net::is_socket_error(result))
+      throw DMITIGR_NET_EXCEPTION{"cannot write to socket"};
+#endif
+    return static_cast<std::streamsize>(result);
+  }
+
   void close() override
   {
     if (!is_shutted_down_) {
@@ -163,6 +321,9 @@ public:
   }
 
 private:
+  /// The maximum number of buffers per readv() or writev() call.
+  static constexpr std::size_t max_buffer_count{1024}; // IOV_MAX on Linux
+
   bool is_shutted_down_{};
   net::Socket_guard socket_;
 
@@ -231,9 +392,10 @@ public:
       throw Exception{"cannot read from named pipe to null buffer"};
 
     len = std::min(len, max_read_size());
+    Overlapped ol;
     DWORD result{};
-    if (!::ReadFile(pipe_, buf, static_cast<DWORD>(len), &result, nullptr))
-      throw os::Sys_exception{"cannot read from named pipe"};
+    if (!::ReadFile(pipe_, buf, static_cast<DWORD>(len), &result, &ol.ol))
+      result = ol.result(pipe_, "cannot read from named pipe");
 
     return static_cast<std::streamsize>(result);
   }
@@ -244,9 +406,10 @@ public:
       throw Exception{"cannot write to named pipe from null buffer"};
 
     len = std::min(len, max_write_size());
+    Overlapped ol;
     DWORD result{};
-    if (!::WriteFile(pipe_, buf, static_cast<DWORD>(len), &result, nullptr))
-      throw os::Sys_exception{"cannot write to named pipe"};
+    if (!::WriteFile(pipe_, buf, static_cast<DWORD>(len), &result, &ol.ol))
+      result = ol.result(pipe_, "cannot write to named pipe");
 
     return static_cast<std::streamsize>(result);
   }
@@ -271,6 +434,39 @@ public:
   }
 
 private:
+  /*
+   * The pipes are created with FILE_FLAG_OVERLAPPED (see pipe_Listener), so
+   * the I/O must be performed with OVERLAPPED and waited for completion.
+   */
+  struct Overlapped final {
+    OVERLAPPED ol{};
+    os::windows::Handle_guard event{make_event()};
+
+    Overlapped() noexcept
+    {
+      ol.hEvent = event.handle();
+    }
+
+    static HANDLE make_event()
+    {
+      const HANDLE result{::CreateEventA(nullptr, true, false, nullptr)};
+      if (!result)
+        throw os::Sys_exception{"cannot create event object"};
+      return result;
+    }
+
+    DWORD result(const HANDLE pipe, const char* const what)
+    {
+      if (::GetLastError() != ERROR_IO_PENDING)
+        throw os::Sys_exception{what};
+
+      DWORD size{};
+      if (!::GetOverlappedResult(pipe, &ol, &size, true))
+        throw os::Sys_exception{what};
+      return size;
+    }
+  };
+
   os::windows::Handle_guard pipe_;
 };
 
@@ -0,0 +1,735 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_IO_URING_HPP
+#define DMITIGR_NET_IO_URING_HPP
+
+#ifndef __linux__
+#error io_uring.hpp is usable only on Linux!
+#endif
+
+#include "../os/exceptions.hpp"
+#include "descriptor.hpp"
+#include "exceptions.hpp"
+#include "listener.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace dmitigr::net {
+
+/**
+ * @brief A thin wrapper around the io_uring instance.
+ *
+ * @details The submission queue entries are accumulated until submit() (or
+ * a waiting for a completion) to submit them by a single system call. The
+ * completions are identified by the user data returned by next_user_data().
+ *
+ * @par Thread safety
+ * Not thread-safe. The instance and all the descriptors using it must be used
+ * by the one thread at time.
+ *
+ * @remarks The implementation doesn't depend on liburing.
+ */
+class Io_uring final {
+public:
+  /// The destructor.
+  ~Io_uring()
+  {
+    release();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @param entries The number of submission queue entries.
+   */
+  explicit Io_uring(const unsigned entries = 256)
+  {
+    io_uring_params params{};
+    fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0)
+      throw os::Sys_exception{"cannot create io_uring"};
+
+    try {
+      map(params);
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  /// Not copy-constructible.
+  Io_uring(const Io_uring&) = delete;
+
+  /// Not copy-assignable.
+  Io_uring& operator=(const Io_uring&) = delete;
+
+  /// Not move-constructible.
+  Io_uring(Io_uring&&) = delete;
+
+  /// Not move-assignable.
+  Io_uring& operator=(Io_uring&&) = delete;
+
+  /// @returns The file descriptor of the instance.
+  int native_handle() const noexcept
+  {
+    return fd_;
+  }
+
+  /// @returns The unique user data to identify a request.
+  std::uint64_t next_user_data() noexcept
+  {
+    return ++user_data_;
+  }
+
+  /**
+   * @returns The zeroed submission queue entry to fill.
+   *
+   * @details Submits the accumulated entries if the queue is full.
+   */
+  io_uring_sqe& sqe()
+  {
+    if (sqe_tail_ - load_acquire(sq_head_) >= sq_entries_)
+      submit();
+
+    const unsigned index{sqe_tail_ & sq_mask_};
+    auto& result = sqes_[index];
+    std::memset(&result, 0, sizeof(result));
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    ++unsubmitted_;
+    return result;
+  }
+
+  /// Prepares the receiving from the socket `fd`.
+  void prepare_recv(const int fd, char* const buf, const std::size_t len,
+    const std::uint64_t user_data, const unsigned flags = 0)
+  {
+    auto& e = sqe();
+    e.opcode = IORING_OP_RECV;
+    e.fd = fd;
+    e.addr = reinterpret_cast<std::uintptr_t>(buf);
+    e.len = static_cast<std::uint32_t>(len);
+    e.flags = static_cast<std::uint8_t>(flags);
+    e.user_data = user_data;
+  }
+
+  /**
+   * @brief Prepares the sending to the socket `fd`.
+   *
+   * @param flags The flags of the entry (for example, `IOSQE_IO_LINK`).
+   * @param msg_flags The flags of send(2). `MSG_NOSIGNAL` is always added.
+   */
+  void prepare_send(const int fd, const char* const buf, const std::size_t len,
+    const std::uint64_t user_data, const unsigned flags = 0,
+    const int msg_flags = 0)
+  {
+    auto& e = sqe();
+    e.opcode = IORING_OP_SEND;
+    e.fd = fd;
+    e.addr = reinterpret_cast<std::uintptr_t>(buf);
+    e.len = static_cast<std::uint32_t>(len);
+    e.msg_flags = static_cast<std::uint32_t>(msg_flags | MSG_NOSIGNAL);
+    e.flags = static_cast<std::uint8_t>(flags);
+    e.user_data = user_data;
+  }
+
+  /// Prepares the reading into the registered buffer of `buf_index`.
+  void prepare_read_fixed(const int fd, char* const buf, const std::size_t len,
+    const unsigned buf_index, const std::uint64_t user_data)
+  {
+    auto& e = sqe();
+    e.opcode = IORING_OP_READ_FIXED;
+    e.fd = fd;
+    e.off = static_cast<std::uint64_t>(-1); // the current position
+    e.addr = reinterpret_cast<std::uintptr_t>(buf);
+    e.len = static_cast<std::uint32_t>(len);
+    e.buf_index = static_cast<std::uint16_t>(buf_index);
+    e.user_data = user_data;
+  }
+
+  /// Prepares the writing from the registered buffer of `buf_index`.
+  void prepare_write_fixed(const int fd, const char* const buf,
+    const std::size_t len, const unsigned buf_index,
+    const std::uint64_t user_data)
+  {
+    auto& e = sqe();
+    e.opcode = IORING_OP_WRITE_FIXED;
+    e.fd = fd;
+    e.off = static_cast<std::uint64_t>(-1); // the current position
+    e.addr = reinterpret_cast<std::uintptr_t>(buf);
+    e.len = static_cast<std::uint32_t>(len);
+    e.buf_index = static_cast<std::uint16_t>(buf_index);
+    e.user_data = user_data;
+  }
+
+  /**
+   * @brief Prepares the multishot accepting on the listening socket `fd`.
+   *
+   * @details Each accepted connection is reported by a separate completion
+   * with `IORING_CQE_F_MORE` flag set while the accepting is armed.
+   */
+  void prepare_accept_multishot(const int fd, const std::uint64_t user_data)
+  {
+    auto& e = sqe();
+    e.opcode = IORING_OP_ACCEPT;
+    e.fd = fd;
+    e.ioprio = IORING_ACCEPT_MULTISHOT;
+    e.accept_flags = SOCK_CLOEXEC;
+    e.user_data = user_data;
+  }
+
+  /**
+   * @brief Prepares the cancellation of the request identified by `target`.
+   *
+   * @details The completions of both the cancellation and the `target` are
+   * discarded.
+   */
+  void prepare_cancel(const std::uint64_t target)
+  {
+    const auto user_data = next_user_data();
+    auto& e = sqe();
+    e.opcode = IORING_OP_ASYNC_CANCEL;
+    e.addr = target;
+    e.user_data = user_data;
+    discard(target);
+    discard(user_data);
+  }
+
+  /// Registers the buffers for use with the fixed reads and writes.
+  void register_buffers(const Mutable_buffer* const bufs,
+    const std::size_t count)
+  {
+    if (!bufs && count)
+      throw Exception{"cannot register null buffers in io_uring"};
+
+    std::vector<iovec> iovs(count);
+    for (std::size_t i{}; i < count; ++i) {
+      iovs[i].iov_base = bufs[i].data;
+      iovs[i].iov_len = static_cast<std::size_t>(bufs[i].size);
+    }
+    if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+        iovs.data(), static_cast<unsigned>(count)) < 0)
+      throw os::Sys_exception{"cannot register buffers in io_uring"};
+  }
+
+  /// Unregisters the buffers.
+  void unregister_buffers()
+  {
+    if (::syscall(__NR_io_uring_register, fd_, IORING_UNREGISTER_BUFFERS,
+        nullptr, 0) < 0)
+      throw os::Sys_exception{"cannot unregister buffers of io_uring"};
+  }
+
+  /**
+   * @brief Submits the accumulated entries and waits for at least
+   * `wait_count` completions.
+   *
+   * @returns The number of submitted entries.
+   */
+  unsigned submit(const unsigned wait_count = 0)
+  {
+    store_release(sq_tail_, sqe_tail_);
+    const unsigned flags{wait_count ? IORING_ENTER_GETEVENTS : 0u};
+    while (true) {
+      const auto r = ::syscall(__NR_io_uring_enter, fd_, unsubmitted_,
+        wait_count, flags, nullptr, 0);
+      if (r < 0) {
+        if (errno == EINTR)
+          continue;
+        throw os::Sys_exception{"cannot submit to io_uring"};
+      }
+      const auto result = static_cast<unsigned>(r);
+      unsubmitted_ -= std::min(result, unsubmitted_);
+      return result;
+    }
+  }
+
+  /**
+   * @brief Takes the completion of the request identified by `user_data`
+   * without waiting.
+   *
+   * @returns `true` if the completion is taken to `result`.
+   */
+  bool try_take(const std::uint64_t user_data, io_uring_cqe& result)
+  {
+    reap();
+    const auto i = std::find_if(completions_.begin(), completions_.end(),
+      [user_data](const auto& cqe){return cqe.user_data == user_data;});
+    if (i == completions_.end())
+      return false;
+
+    result = *i;
+    completions_.erase(i);
+    return true;
+  }
+
+  /// @returns The completion of the request identified by `user_data`.
+  io_uring_cqe wait_for(const std::uint64_t user_data)
+  {
+    io_uring_cqe result;
+    while (!try_take(user_data, result))
+      submit(1);
+    return result;
+  }
+
+  /**
+   * @brief Submits the accumulated entries and waits for a new completion.
+   *
+   * @returns `false` if the `timeout` elapsed.
+   *
+   * @remarks
+   * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+   */
+  bool wait(const std::chrono::milliseconds timeout)
+  {
+    if (unsubmitted_)
+      submit();
+    if (load_acquire(cq_tail_) != *cq_head_)
+      return true;
+    return net::poll(fd_, Socket_readiness::read_ready, timeout) !=
+      Socket_readiness::unready;
+  }
+
+private:
+  int fd_{-1};
+  void* sq_ptr_{};
+  std::size_t sq_size_{};
+  void* cq_ptr_{};
+  std::size_t cq_size_{};
+  io_uring_sqe* sqes_{};
+  std::size_t sqes_size_{};
+
+  unsigned* sq_head_{};
+  unsigned* sq_tail_{};
+  unsigned* sq_array_{};
+  unsigned sq_mask_{};
+  unsigned sq_entries_{};
+  unsigned sqe_tail_{};
+  unsigned unsubmitted_{};
+
+  unsigned* cq_head_{};
+  unsigned* cq_tail_{};
+  unsigned cq_mask_{};
+  io_uring_cqe* cqes_{};
+
+  std::uint64_t user_data_{};
+  std::deque<io_uring_cqe> completions_; // the reaped ones
+  std::unordered_set<std::uint64_t> discarded_;
+
+  static unsigned load_acquire(const unsigned* const p) noexcept
+  {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  static void store_release(unsigned* const p, const unsigned value) noexcept
+  {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+  }
+
+  void map(const io_uring_params& params)
+  {
+    const auto mmap = [this](const std::size_t size, const off_t offset)
+    {
+      void* const result = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd_, offset);
+      if (result == MAP_FAILED)
+        throw os::Sys_exception{"cannot map io_uring"};
+      return result;
+    };
+
+    sq_size_ = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+    const bool is_single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (is_single_mmap)
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    sq_ptr_ = mmap(sq_size_, IORING_OFF_SQ_RING);
+    cq_ptr_ = is_single_mmap ? sq_ptr_ : mmap(cq_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries*sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(mmap(sqes_size_, IORING_OFF_SQES));
+
+    auto* const sq = static_cast<char*>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    sqe_tail_ = *sq_tail_;
+
+    auto* const cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  }
+
+  void release() noexcept
+  {
+    if (sqes_)
+      ::munmap(sqes_, sqes_size_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_)
+      ::munmap(cq_ptr_, cq_size_);
+    if (sq_ptr_)
+      ::munmap(sq_ptr_, sq_size_);
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  void discard(const std::uint64_t user_data)
+  {
+    discarded_.insert(user_data);
+    // Some completions could be already reaped.
+    completions_.erase(std::remove_if(completions_.begin(), completions_.end(),
+        [user_data](const auto& cqe){return cqe.user_data == user_data;}),
+      completions_.end());
+  }
+
+  /// Moves the completions from the ring to `completions_`.
+  void reap()
+  {
+    unsigned head{*cq_head_};
+    const unsigned tail{load_acquire(cq_tail_)};
+    for (; head != tail; ++head) {
+      const auto& cqe = cqes_[head & cq_mask_];
+      if (const auto i = discarded_.find(cqe.user_data); i != discarded_.end()) {
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+          discarded_.erase(i);
+      } else
+        completions_.push_back(cqe);
+    }
+    store_release(cq_head_, head);
+  }
+};
+
+/**
+ * @brief The implementation of Descriptor based on sockets and io_uring.
+ *
+ * @details The writev() submits the linked sends of all the buffers by a
+ * single system call.
+ */
+class Uring_descriptor final : public Descriptor {
+public:
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `ring && is_socket_valid(socket)`.
+   */
+  Uring_descriptor(std::shared_ptr<Io_uring> ring, Socket_guard socket)
+    : ring_{std::move(ring)}
+    , descriptor_{std::move(socket)}
+  {
+    if (!ring_)
+      throw Exception{"cannot create io_uring descriptor: invalid io_uring"};
+    socket_ = static_cast<int>(descriptor_.native_handle());
+  }
+
+  /// @returns The io_uring instance.
+  const std::shared_ptr<Io_uring>& ring() const noexcept
+  {
+    return ring_;
+  }
+
+  std::streamsize max_read_size() const override
+  {
+    return descriptor_.max_read_size();
+  }
+
+  std::streamsize max_write_size() const override
+  {
+    return descriptor_.max_write_size();
+  }
+
+  std::streamsize read(char* const buf, std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot read from socket to null buffer"};
+
+    len = std::min(len, max_read_size());
+    const auto user_data = ring_->next_user_data();
+    ring_->prepare_recv(socket_, buf, static_cast<std::size_t>(len), user_data);
+    return result(ring_->wait_for(user_data), "cannot read from socket");
+  }
+
+  std::streamsize write(const char* const buf, std::streamsize len) override
+  {
+    if (!buf)
+      throw Exception{"cannot write to socket from null buffer"};
+
+    len = std::min(len, max_write_size());
+    const auto user_data = ring_->next_user_data();
+    ring_->prepare_send(socket_, buf, static_cast<std::size_t>(len), user_data);
+    return result(ring_->wait_for(user_data), "cannot write to socket");
+  }
+
+  std::streamsize writev(const Const_buffer* const bufs,
+    const std::size_t count) override
+  {
+    if (!bufs && count)
+      throw Exception{"cannot write to socket from null buffers"};
+
+    // MSG_WAITALL makes the short sends break the link.
+    std::vector<std::uint64_t> user_data(count);
+    for (std::size_t i{}; i < count; ++i) {
+      if (!bufs[i].data)
+        throw Exception{"cannot write to socket from null buffer"};
+      user_data[i] = ring_->next_user_data();
+      ring_->prepare_send(socket_, bufs[i].data,
+        static_cast<std::size_t>(bufs[i].size), user_data[i],
+        i + 1 < count ? IOSQE_IO_LINK : 0, MSG_WAITALL);
+    }
+
+    std::streamsize written{};
+    int error{};
+    bool is_broken{};
+    for (std::size_t i{}; i < count; ++i) {
+      const auto cqe = ring_->wait_for(user_data[i]);
+      if (is_broken)
+        continue;
+      else if (cqe.res < 0) {
+        error = -cqe.res;
+        is_broken = true;
+      } else {
+        written += cqe.res;
+        is_broken = cqe.res < bufs[i].size;
+      }
+    }
+    if (error && !written)
+      throw os::Sys_exception{error, "cannot write to socket"};
+    return written;
+  }
+
+  /// Reads into the registered buffer of `buf_index`.
+  std::streamsize read_fixed(char* const buf, std::streamsize len,
+    const unsigned buf_index)
+  {
+    len = std::min(len, max_read_size());
+    const auto user_data = ring_->next_user_data();
+    ring_->prepare_read_fixed(socket_, buf, static_cast<std::size_t>(len),
+      buf_index, user_data);
+    return result(ring_->wait_for(user_data), "cannot read from socket");
+  }
+
+  /// Writes from the registered buffer of `buf_index`.
+  std::streamsize write_fixed(const char* const buf, std::streamsize len,
+    const unsigned buf_index)
+  {
+    len = std::min(len, max_write_size());
+    const auto user_data = ring_->next_user_data();
+    ring_->prepare_write_fixed(socket_, buf, static_cast<std::size_t>(len),
+      buf_index, user_data);
+    return result(ring_->wait_for(user_data), "cannot write to socket");
+  }
+
+  void close() override
+  {
+    descriptor_.close();
+  }
+
+  std::intptr_t native_handle() noexcept override
+  {
+    return socket_;
+  }
+
+private:
+  std::shared_ptr<Io_uring> ring_;
+  detail::socket_Descriptor descriptor_;
+  int socket_{-1};
+
+  static std::streamsize result(const io_uring_cqe& cqe, const char* const what)
+  {
+    if (cqe.res < 0)
+      throw os::Sys_exception{-cqe.res, what};
+    return cqe.res;
+  }
+};
+
+/**
+ * @brief The implementation of Listener based on sockets and io_uring.
+ *
+ * @details The connections are accepted by the multishot accepting, so one
+ * submission accepts all the connections arriving while it's armed. The
+ * accepted connections are represented by Uring_descriptor using the same
+ * io_uring instance.
+ */
+class Uring_listener final : public detail::iListener {
+public:
+  /// The destructor.
+  ~Uring_listener() override
+  {
+    disarm();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `ring` and the communication mode of the endpoint is not
+   * `Communication_mode::wnp`.
+   */
+  Uring_listener(std::shared_ptr<Io_uring> ring, Listener_options options)
+    : ring_{std::move(ring)}
+    , listener_{std::move(options)}
+  {
+    if (!ring_)
+      throw Exception{"cannot create io_uring listener: invalid io_uring"};
+  }
+
+  /// @returns The io_uring instance.
+  const std::shared_ptr<Io_uring>& ring() const noexcept
+  {
+    return ring_;
+  }
+
+  const Listener_options& options() const override
+  {
+    return listener_.options();
+  }
+
+  bool is_listening() const override
+  {
+    return listener_.is_listening();
+  }
+
+  void listen() override
+  {
+    listener_.listen();
+  }
+
+  bool wait(const std::chrono::milliseconds timeout =
+    std::chrono::milliseconds{-1}) override
+  {
+    using std::chrono::milliseconds;
+    if (!is_listening())
+      throw Exception{"cannot wait for data on socket if listener is "
+        "not listening"};
+    else if (!(timeout >= milliseconds{-1}))
+      throw Exception{"invalid timeout for wait operation on socket"};
+
+    arm();
+    collect();
+    if (accepted_.empty() && ring_->wait(timeout))
+      collect();
+    return !accepted_.empty();
+  }
+
+  std::unique_ptr<Descriptor> accept() override
+  {
+    if (!is_listening())
+      throw Exception{"cannot accept connections on listener which is "
+        "not listening"};
+
+    arm();
+    collect();
+    if (accepted_.empty()) {
+      if (options().is_non_blocking())
+        return nullptr;
+      while (accepted_.empty()) {
+        arm();
+        handle(ring_->wait_for(accept_user_data_));
+      }
+    }
+
+    Socket_guard socket{accepted_.front()};
+    accepted_.pop_front();
+    if (options().endpoint().communication_mode() == Communication_mode::net)
+      set_tcp_options(socket, options().tcp_options());
+    return std::make_unique<Uring_descriptor>(ring_, std::move(socket));
+  }
+
+  std::intptr_t native_handle() const noexcept override
+  {
+    return listener_.native_handle();
+  }
+
+  void close() override
+  {
+    disarm();
+    while (!accepted_.empty()) {
+      ::close(accepted_.front());
+      accepted_.pop_front();
+    }
+    listener_.close();
+  }
+
+private:
+  std::shared_ptr<Io_uring> ring_;
+  detail::socket_Listener listener_;
+  std::uint64_t accept_user_data_{};
+  bool is_armed_{};
+  std::deque<int> accepted_;
+
+  void arm()
+  {
+    if (!is_armed_) {
+      accept_user_data_ = ring_->next_user_data();
+      ring_->prepare_accept_multishot(static_cast<int>(
+          listener_.native_handle()), accept_user_data_);
+      ring_->submit();
+      is_armed_ = true;
+    }
+  }
+
+  void disarm() noexcept
+  {
+    if (is_armed_) {
+      try {
+        ring_->prepare_cancel(accept_user_data_);
+        ring_->submit();
+      } catch (...) {}
+      is_armed_ = false;
+    }
+  }
+
+  void handle(const io_uring_cqe& cqe)
+  {
+    if (!(cqe.flags & IORING_CQE_F_MORE))
+      is_armed_ = false;
+
+    if (cqe.res >= 0)
+      accepted_.push_back(cqe.res);
+    else if (cqe.res != -EAGAIN && cqe.res != -ECANCELED && accepted_.empty())
+      throw os::Sys_exception{-cqe.res, "cannot accept on socket"};
+  }
+
+  void collect()
+  {
+    io_uring_cqe cqe;
+    while (ring_->try_take(accept_user_data_, cqe))
+      handle(cqe);
+  }
+};
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_IO_URING_HPP
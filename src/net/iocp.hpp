@@ -0,0 +1,660 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_IOCP_HPP
+#define DMITIGR_NET_IOCP_HPP
+
+#ifndef _WIN32
+#error iocp.hpp is usable only on Windows!
+#endif
+
+#include "../base/assert.hpp"
+#include "../os/exceptions.hpp"
+#include "../os/windows.hpp"
+#include "descriptor.hpp"
+#include "exceptions.hpp"
+#include "listener.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::net {
+
+/**
+ * @brief A thin wrapper around the I/O completion port.
+ *
+ * @details The asynchronous operations of the descriptors associated with
+ * the port are completed by calling their handlers from run(), so a single
+ * thread can serve many descriptors.
+ *
+ * @par Thread safety
+ * Not thread-safe. The instance and all the descriptors using it must be used
+ * by the one thread at time.
+ *
+ * @par Requires
+ * The descriptors using the instance must be destroyed before it.
+ */
+class Iocp final {
+public:
+  /**
+   * @brief The handler of the completed operation.
+   *
+   * @param error The error of the operation.
+   * @param size The number of bytes transferred.
+   */
+  using Handler = std::function<void(std::error_code error,
+    std::streamsize size)>;
+
+  /// The destructor.
+  ~Iocp() = default;
+
+  /// The constructor.
+  Iocp()
+    : port_{make_port()}
+  {}
+
+  /// Non-copy-constructible.
+  Iocp(const Iocp&) = delete;
+
+  /// Non-copy-assignable.
+  Iocp& operator=(const Iocp&) = delete;
+
+  /// Non-move-constructible.
+  Iocp(Iocp&&) = delete;
+
+  /// Non-move-assignable.
+  Iocp& operator=(Iocp&&) = delete;
+
+  /// @returns The handle of the completion port.
+  HANDLE native_handle() const noexcept
+  {
+    return port_.handle();
+  }
+
+  /**
+   * @brief Associates the `handle` opened with `FILE_FLAG_OVERLAPPED` with
+   * this instance.
+   */
+  void associate(const HANDLE handle)
+  {
+    if (!::CreateIoCompletionPort(handle, port_, 0, 0))
+      throw os::Sys_exception{"cannot associate handle with I/O completion port"};
+  }
+
+  /// @returns The number of the operations not completed yet.
+  std::size_t pending_count() const noexcept
+  {
+    return operations_.size();
+  }
+
+  /**
+   * @brief Waits for the completions and calls the handlers of the completed
+   * operations.
+   *
+   * @param timeout The maximum time to wait for the first completion. The
+   * completions which are already queued are handled without waiting.
+   *
+   * @returns The number of the handlers called.
+   *
+   * @remarks
+   * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+   */
+  std::size_t run(const std::chrono::milliseconds timeout =
+    std::chrono::milliseconds{-1})
+  {
+    using std::chrono::milliseconds;
+    if (!(timeout >= milliseconds{-1}))
+      throw Exception{"invalid timeout for run operation on I/O completion port"};
+
+    DMITIGR_ASSERT(timeout.count() <= std::numeric_limits<DWORD>::max());
+    DWORD tout = (timeout.count() == -1) ? INFINITE :
+      static_cast<DWORD>(timeout.count());
+    std::size_t result{};
+    for (std::size_t i{}; i < max_batch_size; ++i, tout = 0) {
+      DWORD size{};
+      ULONG_PTR key{};
+      OVERLAPPED* ol{};
+      const BOOL ok{::GetQueuedCompletionStatus(port_, &size, &key, &ol, tout)};
+      if (!ol) {
+        if (::GetLastError() == WAIT_TIMEOUT)
+          break;
+        throw os::Sys_exception{"cannot dequeue completion from I/O "
+          "completion port"};
+      }
+      const DWORD error{ok ? 0 : ::GetLastError()};
+
+      const auto op = operations_.find(ol);
+      DMITIGR_ASSERT(op != operations_.end());
+      const auto operation = std::move(op->second);
+      operations_.erase(op);
+      if (operation->handler) {
+        ++result;
+        operation->handler(std::error_code{static_cast<int>(operation->error ?
+            operation->error : error), std::system_category()},
+          static_cast<std::streamsize>(size));
+      }
+    }
+    return result;
+  }
+
+private:
+  friend Iocp_pipe_descriptor;
+  friend Iocp_pipe_listener;
+
+  /// The maximum number of completions handled by run() at once.
+  static constexpr std::size_t max_batch_size{64};
+
+  struct Operation final {
+    OVERLAPPED overlapped{};
+    Handler handler;
+    DWORD error{};
+  };
+
+  os::windows::Handle_guard port_;
+  std::unordered_map<OVERLAPPED*, std::unique_ptr<Operation>> operations_;
+
+  static HANDLE make_port()
+  {
+    const HANDLE result{::CreateIoCompletionPort(INVALID_HANDLE_VALUE,
+      nullptr, 0, 1)};
+    if (!result)
+      throw os::Sys_exception{"cannot create I/O completion port"};
+    return result;
+  }
+
+  /// @returns The new operation owned by this instance until its completion.
+  Operation* make_operation(Handler handler)
+  {
+    auto operation = std::make_unique<Operation>();
+    operation->handler = std::move(handler);
+    auto* const result = operation.get();
+    operations_.emplace(&result->overlapped, std::move(operation));
+    return result;
+  }
+
+  /**
+   * @brief Completes the start of the `operation`.
+   *
+   * @param ok The result of the function which started the `operation`.
+   *
+   * @details The failures to start are completed via the port as well, so
+   * the handlers are never called from the initiating functions. If the
+   * completion cannot be posted, the `operation` is released.
+   */
+  void start(Operation* const operation, const BOOL ok)
+  {
+    if (ok)
+      return; // the completion is queued anyway
+
+    switch (const DWORD error = ::GetLastError()) {
+    case ERROR_IO_PENDING:
+      return;
+    case ERROR_PIPE_CONNECTED:
+      // The client connected before ConnectNamedPipe(), nothing is queued.
+      post(operation, 0);
+      return;
+    default:
+      post(operation, error);
+      return;
+    }
+  }
+
+  void post(Operation* const operation, const DWORD error)
+  {
+    operation->error = error;
+    if (!::PostQueuedCompletionStatus(port_, 0, 0, &operation->overlapped)) {
+      operations_.erase(&operation->overlapped);
+      throw os::Sys_exception{"cannot post completion to I/O completion port"};
+    }
+  }
+
+  /**
+   * @brief Cancels the `operation` on `handle` and waits until it's completed
+   * without calling its handler.
+   */
+  void cancel(const HANDLE handle, Operation* const operation) noexcept
+  {
+    operation->handler = nullptr;
+    if (::CancelIoEx(handle, &operation->overlapped) ||
+      ::GetLastError() != ERROR_NOT_FOUND) {
+      DWORD size{};
+      ::GetOverlappedResult(handle, &operation->overlapped, &size, true);
+    }
+    // The operation is released by run() when its completion is dequeued.
+  }
+};
+
+/**
+ * @brief The implementation of Descriptor based on Windows Named Pipes and
+ * the I/O completion port.
+ *
+ * @details In addition to the synchronous operations of Descriptor, provides
+ * the asynchronous ones, which are completed by Iocp::run(). The synchronous
+ * operations run the completion port until completed, so the handlers of the
+ * other descriptors can be called by them as well.
+ */
+class Iocp_pipe_descriptor final : public Descriptor {
+public:
+  /// The destructor. Cancels the pending operations.
+  ~Iocp_pipe_descriptor() override
+  {
+    cancel();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `iocp` and `pipe` is opened with `FILE_FLAG_OVERLAPPED` and is not
+   * associated with any completion port.
+   */
+  Iocp_pipe_descriptor(std::shared_ptr<Iocp> iocp,
+    os::windows::Handle_guard pipe)
+    : Iocp_pipe_descriptor{std::move(iocp), std::move(pipe), false}
+  {}
+
+  /// @returns The Iocp instance.
+  const std::shared_ptr<Iocp>& iocp() const noexcept
+  {
+    return iocp_;
+  }
+
+  std::streamsize max_read_size() const override
+  {
+    return descriptor_.max_read_size();
+  }
+
+  std::streamsize max_write_size() const override
+  {
+    return descriptor_.max_write_size();
+  }
+
+  std::streamsize read(char* const buf, const std::streamsize len) override
+  {
+    return transfer(&Iocp_pipe_descriptor::async_read, buf, len,
+      "cannot read from named pipe");
+  }
+
+  std::streamsize write(const char* const buf, const std::streamsize len) override
+  {
+    return transfer(&Iocp_pipe_descriptor::async_write, buf, len,
+      "cannot write to named pipe");
+  }
+
+  /**
+   * @brief Starts reading into the `buf`.
+   *
+   * @par Requires
+   * `buf && !is_read_pending()`. The `buf` must be valid until the `handler`
+   * is called or this instance is destroyed.
+   */
+  void async_read(char* const buf, std::streamsize len, Iocp::Handler handler)
+  {
+    if (!buf)
+      throw Exception{"cannot read from named pipe to null buffer"};
+    else if (is_read_pending())
+      throw Exception{"cannot read from named pipe: read is pending"};
+
+    len = std::min(len, max_read_size());
+    read_ = start(read_, std::move(handler));
+    try {
+      iocp_->start(read_, ::ReadFile(handle(), buf, static_cast<DWORD>(len),
+          nullptr, &read_->overlapped));
+    } catch (...) {
+      read_ = nullptr;
+      throw;
+    }
+  }
+
+  /**
+   * @brief Starts writing from the `buf`.
+   *
+   * @par Requires
+   * `buf && !is_write_pending()`. The `buf` must be valid until the `handler`
+   * is called or this instance is destroyed.
+   */
+  void async_write(const char* const buf, std::streamsize len,
+    Iocp::Handler handler)
+  {
+    if (!buf)
+      throw Exception{"cannot write to named pipe from null buffer"};
+    else if (is_write_pending())
+      throw Exception{"cannot write to named pipe: write is pending"};
+
+    len = std::min(len, max_write_size());
+    write_ = start(write_, std::move(handler));
+    try {
+      iocp_->start(write_, ::WriteFile(handle(), buf, static_cast<DWORD>(len),
+          nullptr, &write_->overlapped));
+    } catch (...) {
+      write_ = nullptr;
+      throw;
+    }
+  }
+
+  /// @returns `true` if the read is pending.
+  bool is_read_pending() const noexcept
+  {
+    return read_;
+  }
+
+  /// @returns `true` if the write is pending.
+  bool is_write_pending() const noexcept
+  {
+    return write_;
+  }
+
+  /// Cancels the pending operations without calling their handlers.
+  void cancel() noexcept
+  {
+    if (read_)
+      iocp_->cancel(handle(), std::exchange(read_, nullptr));
+    if (write_)
+      iocp_->cancel(handle(), std::exchange(write_, nullptr));
+  }
+
+  void close() override
+  {
+    cancel();
+    descriptor_.close();
+  }
+
+  std::intptr_t native_handle() noexcept override
+  {
+    return descriptor_.native_handle();
+  }
+
+private:
+  friend Iocp_pipe_listener;
+
+  std::shared_ptr<Iocp> iocp_;
+  detail::pipe_Descriptor descriptor_;
+  Iocp::Operation* read_{};
+  Iocp::Operation* write_{};
+
+  Iocp_pipe_descriptor(std::shared_ptr<Iocp> iocp,
+    os::windows::Handle_guard pipe, const bool is_associated)
+    : iocp_{std::move(iocp)}
+    , descriptor_{std::move(pipe)}
+  {
+    if (!iocp_)
+      throw Exception{"cannot create IOCP descriptor: invalid IOCP"};
+    if (!is_associated)
+      iocp_->associate(handle());
+  }
+
+  HANDLE handle() noexcept
+  {
+    return reinterpret_cast<HANDLE>(descriptor_.native_handle());
+  }
+
+  /// @returns The operation which resets the `slot` upon completion.
+  Iocp::Operation* start(Iocp::Operation*& slot, Iocp::Handler handler)
+  {
+    return iocp_->make_operation([&slot, handler = std::move(handler)]
+      (const std::error_code error, const std::streamsize size)
+      {
+        slot = nullptr;
+        if (handler)
+          handler(error, size);
+      });
+  }
+
+  template<typename F, typename B>
+  std::streamsize transfer(const F start, const B buf, const std::streamsize len,
+    const char* const what)
+  {
+    std::optional<std::pair<std::error_code, std::streamsize>> result;
+    (this->*start)(buf, len,
+      [&result](const std::error_code error, const std::streamsize size)
+      {
+        result.emplace(error, size);
+      });
+    while (!result)
+      iocp_->run();
+    if (result->first)
+      throw os::Sys_exception{result->first.value(), what};
+    return result->second;
+  }
+};
+
+/**
+ * @brief The implementation of Listener based on Windows Named Pipes and
+ * the I/O completion port.
+ *
+ * @details The listener keeps the `backlog` instances of the named pipe
+ * waiting for the clients concurrently, so the clients connecting at the same
+ * time are not refused. The connected instances are represented by
+ * Iocp_pipe_descriptor using the same Iocp instance.
+ */
+class Iocp_pipe_listener final : public detail::iListener {
+public:
+  /**
+   * @brief The handler of the accepted connection.
+   *
+   * @param error The error of accepting.
+   * @param descriptor The accepted connection, or `nullptr` on error.
+   */
+  using Accept_handler = std::function<void(std::error_code error,
+    std::unique_ptr<Iocp_pipe_descriptor> descriptor)>;
+
+  /// The destructor.
+  ~Iocp_pipe_listener() override
+  {
+    disarm();
+  }
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `iocp && backlog` and the communication mode of the endpoint is
+   * `Communication_mode::wnp`.
+   */
+  Iocp_pipe_listener(std::shared_ptr<Iocp> iocp, Listener_options options,
+    const std::size_t backlog = 4)
+    : iocp_{std::move(iocp)}
+    , listener_{std::move(options)}
+    , backlog_{backlog}
+  {
+    if (!iocp_)
+      throw Exception{"cannot create IOCP listener: invalid IOCP"};
+    else if (!backlog_)
+      throw Exception{"cannot create IOCP listener: invalid backlog"};
+  }
+
+  /// @returns The Iocp instance.
+  const std::shared_ptr<Iocp>& iocp() const noexcept
+  {
+    return iocp_;
+  }
+
+  const Listener_options& options() const override
+  {
+    return listener_.options();
+  }
+
+  bool is_listening() const override
+  {
+    return listener_.is_listening();
+  }
+
+  void listen() override
+  {
+    listener_.listen();
+    arm();
+  }
+
+  bool wait(const std::chrono::milliseconds timeout =
+    std::chrono::milliseconds{-1}) override
+  {
+    using std::chrono::milliseconds;
+    if (!is_listening())
+      throw Exception{"cannot wait for data on named pipe if listener"
+        " is not listening"};
+    else if (!(timeout >= milliseconds{-1}))
+      throw Exception{"invalid timeout for wait operation on named pipe"};
+
+    if (accepted_.empty())
+      iocp_->run(timeout);
+    return !accepted_.empty();
+  }
+
+  std::unique_ptr<Descriptor> accept() override
+  {
+    if (!is_listening())
+      throw Exception{"cannot accept connections on listener which is "
+        "not listening"};
+
+    if (accepted_.empty()) {
+      if (options().is_non_blocking())
+        return nullptr;
+      while (accepted_.empty())
+        iocp_->run();
+    }
+    return take();
+  }
+
+  /**
+   * @brief Calls the `handler` with the next accepted connection from
+   * Iocp::run().
+   *
+   * @par Requires
+   * `is_listening() && handler`.
+   */
+  void async_accept(Accept_handler handler)
+  {
+    if (!is_listening())
+      throw Exception{"cannot accept connections on listener which is "
+        "not listening"};
+    else if (!handler)
+      throw Exception{"cannot accept connections by invalid handler"};
+
+    handlers_.push_back(std::move(handler));
+  }
+
+  /// @returns The handle of the completion port.
+  std::intptr_t native_handle() const noexcept override
+  {
+    return reinterpret_cast<std::intptr_t>(iocp_->native_handle());
+  }
+
+  void close() override
+  {
+    disarm();
+    accepted_.clear();
+    handlers_.clear();
+    listener_.close();
+  }
+
+private:
+  struct Instance final {
+    os::windows::Handle_guard pipe;
+    Iocp::Operation* operation{};
+  };
+
+  std::shared_ptr<Iocp> iocp_;
+  detail::pipe_Listener listener_;
+  std::size_t backlog_{};
+  std::vector<std::unique_ptr<Instance>> pending_;
+  std::deque<os::windows::Handle_guard> accepted_;
+  std::deque<Accept_handler> handlers_;
+
+  /// Creates the pending instances up to the backlog.
+  void arm()
+  {
+    while (pending_.size() < backlog_) {
+      auto instance = std::make_unique<Instance>();
+      instance->pipe = listener_.make_named_pipe();
+      iocp_->associate(instance->pipe);
+      auto* const inst = instance.get();
+      pending_.push_back(std::move(instance));
+      inst->operation = iocp_->make_operation(
+        [this, inst](const std::error_code error, std::streamsize)
+        {
+          handle(inst, error);
+        });
+      try {
+        iocp_->start(inst->operation,
+          ::ConnectNamedPipe(inst->pipe, &inst->operation->overlapped));
+      } catch (...) {
+        pending_.pop_back();
+        throw;
+      }
+    }
+  }
+
+  void disarm() noexcept
+  {
+    for (const auto& instance : pending_)
+      iocp_->cancel(instance->pipe, instance->operation);
+    pending_.clear();
+  }
+
+  void handle(Instance* const instance, const std::error_code error)
+  {
+    const auto i = std::find_if(pending_.begin(), pending_.end(),
+      [instance](const auto& p){return p.get() == instance;});
+    DMITIGR_ASSERT(i != pending_.end());
+    auto pipe = std::move((*i)->pipe);
+    pending_.erase(i);
+
+    if (is_listening())
+      arm();
+
+    // The client which is already gone is just skipped.
+    if (error.value() == static_cast<int>(ERROR_NO_DATA)) {
+      ::DisconnectNamedPipe(pipe);
+      return;
+    } else if (!error)
+      accepted_.push_back(std::move(pipe));
+    else if (handlers_.empty())
+      throw os::Sys_exception{error.value(), "cannot accept on named pipe"};
+
+    while (!handlers_.empty() && (error || !accepted_.empty())) {
+      const auto handler = std::move(handlers_.front());
+      handlers_.pop_front();
+      if (error) {
+        handler(error, nullptr);
+        break;
+      } else
+        handler(error, take());
+    }
+  }
+
+  std::unique_ptr<Iocp_pipe_descriptor> take()
+  {
+    DMITIGR_ASSERT(!accepted_.empty());
+    auto pipe = std::move(accepted_.front());
+    accepted_.pop_front();
+    return std::unique_ptr<Iocp_pipe_descriptor>{
+      new Iocp_pipe_descriptor{iocp_, std::move(pipe), true}};
+  }
+};
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_IOCP_HPP
@@ -27,10 +27,13 @@
 #include "types_fwd.hpp"
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include "../os/windows.hpp"
@@ -118,9 +121,71 @@ public:
     return backlog_;
   }
 
+  /**
+   * @brief Sets the non-blocking mode of the listening socket.
+   *
+   * @details In this mode, Listener::accept() doesn't block if there is no
+   * pending connection. This mode is intended to be used with Poller.
+   *
+   * @remarks Has no effect with `Communication_mode::wnp`.
+   */
+  Listener_options& set_non_blocking(const bool value) noexcept
+  {
+    is_non_blocking_ = value;
+    return *this;
+  }
+
+  /// @returns `true` if the non-blocking mode is set.
+  bool is_non_blocking() const noexcept
+  {
+    return is_non_blocking_;
+  }
+
+  /**
+   * @brief Sets the `SO_REUSEPORT` option of the listening socket.
+   *
+   * @details This option allows the multiple listeners (for example, one per
+   * thread) to be bound to the same port, in which case the incoming
+   * connections are distributed among them by the kernel.
+   *
+   * @remarks Has effect only with `Communication_mode::net` on the systems
+   * which support `SO_REUSEPORT`.
+   */
+  Listener_options& set_reuse_port(const bool value) noexcept
+  {
+    is_reuse_port_ = value;
+    return *this;
+  }
+
+  /// @returns `true` if the `SO_REUSEPORT` option should be set.
+  bool is_reuse_port() const noexcept
+  {
+    return is_reuse_port_;
+  }
+
+  /**
+   * @brief Sets the TCP options of the listening and accepted sockets.
+   *
+   * @remarks Has effect only with `Communication_mode::net`.
+   */
+  Listener_options& set_tcp_options(Tcp_options value) noexcept
+  {
+    tcp_options_ = std::move(value);
+    return *this;
+  }
+
+  /// @returns The TCP options.
+  const Tcp_options& tcp_options() const noexcept
+  {
+    return tcp_options_;
+  }
+
 private:
   Endpoint endpoint_;
   std::optional<int> backlog_;
+  bool is_non_blocking_{};
+  bool is_reuse_port_{};
+  Tcp_options tcp_options_;
 
   bool is_invariant_ok() const
   {
@@ -177,15 +242,52 @@ public:
   /**
    * @brief Accepts a new client connection.
    *
-   * @returns A new instance of type Descriptor.
+   * @returns A new instance of type Descriptor, or `nullptr` if the listener
+   * is in the non-blocking mode and there is no pending connection.
    *
    * @par Requires
    * `is_listening()`.
    *
-   * @see wait().
+   * @see wait(), accept_many(), Listener_options::set_non_blocking().
    */
   virtual std::unique_ptr<Descriptor> accept() = 0;
 
+  /**
+   * @brief Accepts up to `max_count` pending client connections.
+   *
+   * @details Appends the accepted descriptors to the `result`. In the
+   * non-blocking mode, stops accepting when there are no pending connections.
+   * In the blocking mode, accepts the connections while wait() reports the
+   * readiness immediately.
+   *
+   * @returns The number of accepted connections.
+   *
+   * @par Requires
+   * `is_listening()`.
+   */
+  std::size_t accept_many(std::vector<std::unique_ptr<Descriptor>>& result,
+    const std::size_t max_count)
+  {
+    std::size_t count{};
+    while (count < max_count) {
+      if (count && !options().is_non_blocking() &&
+        !wait(std::chrono::milliseconds::zero()))
+        break;
+      else if (auto descriptor = accept()) {
+        result.push_back(std::move(descriptor));
+        ++count;
+      } else
+        break;
+    }
+    return count;
+  }
+
+  /**
+   * @returns Native handle (i.e. listening socket, or the pending named pipe),
+   * which can be used with Poller if it's a socket.
+   */
+  virtual std::intptr_t native_handle() const noexcept = 0;
+
   /// Stops the listening.
   virtual void close() = 0;
 
@@ -201,6 +303,7 @@ namespace detail {
 class iListener : public Listener {
   friend socket_Listener;
   friend pipe_Listener;
+  friend Uring_listener;
 
   iListener() = default;
 };
@@ -252,6 +355,19 @@ public:
       if (::setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR,
           reinterpret_cast<const char*>(&optval), optlen) != 0)
         throw DMITIGR_NET_EXCEPTION{"cannot set SO_REUSEADDR socket option"};
+#ifdef SO_REUSEPORT
+      if (options_.is_reuse_port() && ::setsockopt(socket_, SOL_SOCKET,
+          SO_REUSEPORT, reinterpret_cast<const char*>(&optval), optlen) != 0)
+        throw DMITIGR_NET_EXCEPTION{"cannot set SO_REUSEPORT socket option"};
+#endif
+      // Some options (like the buffer sizes) must be set before listen().
+      const auto& tcp = options_.tcp_options();
+      set_tcp_options(socket_, tcp);
+#ifdef TCP_FASTOPEN
+      if (tcp.fast_open)
+        detail::set_socket_option(socket_, IPPROTO_TCP, TCP_FASTOPEN,
+          *tcp.fast_open ? *options_.backlog() : 0, "TCP_FASTOPEN");
+#endif
 
       bind_socket(socket_, {net::Ip_address::from_text(*eid.net_address()),
         *eid.net_port()});
@@ -268,6 +384,9 @@ public:
     else
       uds_create_bind();
 
+    if (options_.is_non_blocking())
+      set_non_blocking(socket_, true);
+
     if (::listen(socket_, *options_.backlog()) != 0)
       throw DMITIGR_NET_EXCEPTION{"cannot start listening on socket"};
   }
@@ -300,11 +419,31 @@ public:
 #else
     constexpr ::socklen_t* addrlen{};
 #endif
-    if (net::Socket_guard sock{::accept(socket_, addr, addrlen)};
-      !net::is_socket_valid(sock))
-      throw DMITIGR_NET_EXCEPTION{"cannot accept on socket"};
-    else
-      return std::make_unique<socket_Descriptor>(std::move(sock));
+#ifdef __linux__
+    // The accepted socket doesn't inherit O_NONBLOCK on Linux.
+    net::Socket_guard sock{::accept4(socket_, addr, addrlen, SOCK_CLOEXEC)};
+#else
+    net::Socket_guard sock{::accept(socket_, addr, addrlen)};
+#endif
+    if (!net::is_socket_valid(sock)) {
+      if (options_.is_non_blocking() && is_last_error_would_block())
+        return nullptr;
+      else
+        throw DMITIGR_NET_EXCEPTION{"cannot accept on socket"};
+    }
+#ifndef __linux__
+    if (options_.is_non_blocking())
+      set_non_blocking(sock, false);
+#endif
+    // Not all the options are inherited from the listening socket.
+    if (options_.endpoint().communication_mode() == Communication_mode::net)
+      set_tcp_options(sock, options_.tcp_options());
+    return std::make_unique<socket_Descriptor>(std::move(sock));
+  }
+
+  std::intptr_t native_handle() const noexcept override
+  {
+    return socket_;
   }
 
   void close() override
@@ -452,6 +591,11 @@ public:
     return std::make_unique<pipe_Descriptor>(std::move(pipe_));
   }
 
+  std::intptr_t native_handle() const noexcept override
+  {
+    return reinterpret_cast<std::intptr_t>(pipe_.handle());
+  }
+
   void close() override
   {
     if (is_listening()) {
@@ -462,6 +606,8 @@ public:
   }
 
 private:
+  friend Iocp_pipe_listener;
+
   bool is_listening_{};
   os::windows::Handle_guard pipe_{INVALID_HANDLE_VALUE};
   Listener_options options_;
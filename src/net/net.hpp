@@ -20,6 +20,7 @@
 #include "types_fwd.hpp"
 #include "address.hpp"
 #include "basics.hpp"
+#include "buffered_descriptor.hpp"
 #include "client.hpp"
 #include "conversions.hpp"
 #include "descriptor.hpp"
@@ -28,8 +29,18 @@
 #include "exceptions.hpp"
 #include "last_error.hpp"
 #include "listener.hpp"
+#include "poller.hpp"
 #include "socket.hpp"
+#include "transfer.hpp"
 #include "util.hpp"
 #include "version.hpp"
 
+#ifdef DMITIGR_NET_IO_URING
+#include "io_uring.hpp"
+#endif
+
+#ifdef _WIN32
+#include "iocp.hpp"
+#endif
+
 #endif  // DMITIGR_NET_NET_HPP
@@ -0,0 +1,316 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_POLLER_HPP
+#define DMITIGR_NET_POLLER_HPP
+
+#include "exceptions.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#define DMITIGR_NET_POLLER_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+  defined(__OpenBSD__) || defined(__DragonFly__)
+#define DMITIGR_NET_POLLER_KQUEUE
+#include <sys/event.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace dmitigr::net {
+
+/**
+ * @brief A persistent set of sockets to wait for the readiness of at once.
+ *
+ * @details The implementation is based on epoll on Linux, kqueue on BSD and
+ * macOS, or poll(2) (`WSAPoll()` on Windows) otherwise. Thus, unlike
+ * poll_many(), the cost of wait() doesn't depend on the number of registered
+ * sockets on Linux, BSD and macOS.
+ *
+ * @remarks The sockets must be removed before closing.
+ *
+ * @remarks `Socket_readiness::exceptions` is never reported with kqueue.
+ */
+class Poller final {
+public:
+  /// The destructor.
+  ~Poller()
+  {
+#if defined(DMITIGR_NET_POLLER_EPOLL) || defined(DMITIGR_NET_POLLER_KQUEUE)
+    ::close(handle_);
+#endif
+  }
+
+  /// The constructor.
+  Poller()
+  {
+#if defined(DMITIGR_NET_POLLER_EPOLL)
+    handle_ = ::epoll_create1(EPOLL_CLOEXEC);
+#elif defined(DMITIGR_NET_POLLER_KQUEUE)
+    handle_ = ::kqueue();
+#endif
+#if defined(DMITIGR_NET_POLLER_EPOLL) || defined(DMITIGR_NET_POLLER_KQUEUE)
+    if (handle_ < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot create poller"};
+#endif
+  }
+
+  /// Not copy-constructible.
+  Poller(const Poller&) = delete;
+
+  /// Not copy-assignable.
+  Poller& operator=(const Poller&) = delete;
+
+  /// Not move-constructible.
+  Poller(Poller&&) = delete;
+
+  /// Not move-assignable.
+  Poller& operator=(Poller&&) = delete;
+
+  /**
+   * @brief Registers the `socket` to wait for the readiness of.
+   *
+   * @par Requires
+   * `is_socket_valid(socket) && !contains(socket)`.
+   */
+  void add(const Socket_native socket, const Socket_readiness mask)
+  {
+    if (!is_socket_valid(socket))
+      throw Exception{"cannot add socket to poller: invalid socket"};
+    else if (contains(socket))
+      throw Exception{"cannot add socket to poller: socket is already added"};
+
+    const auto i = registrations_.emplace(socket, mask).first;
+    try {
+      update(socket, Socket_readiness::unready, mask, true);
+    } catch (...) {
+      registrations_.erase(i);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Changes the readiness to wait for the `socket`.
+   *
+   * @par Requires
+   * `contains(socket)`.
+   */
+  void modify(const Socket_native socket, const Socket_readiness mask)
+  {
+    const auto i = registrations_.find(socket);
+    if (i == registrations_.end())
+      throw Exception{"cannot modify socket of poller: no such socket"};
+
+    update(socket, i->second, mask, false);
+    i->second = mask;
+  }
+
+  /**
+   * @brief Unregisters the `socket`.
+   *
+   * @returns `true` if the socket was registered.
+   */
+  bool remove(const Socket_native socket) noexcept
+  {
+    const auto i = registrations_.find(socket);
+    if (i == registrations_.end())
+      return false;
+
+#if defined(DMITIGR_NET_POLLER_EPOLL)
+    ::epoll_ctl(handle_, EPOLL_CTL_DEL, socket, nullptr);
+#elif defined(DMITIGR_NET_POLLER_KQUEUE)
+    struct kevent changes[2];
+    int count{};
+    if (has(i->second, Socket_readiness::read_ready))
+      EV_SET(&changes[count++], socket, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    if (has(i->second, Socket_readiness::write_ready))
+      EV_SET(&changes[count++], socket, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    ::kevent(handle_, changes, count, nullptr, 0, nullptr);
+#endif
+    registrations_.erase(i);
+    return true;
+  }
+
+  /// @returns `true` if the `socket` is registered.
+  bool contains(const Socket_native socket) const noexcept
+  {
+    return registrations_.count(socket);
+  }
+
+  /// @returns The number of registered sockets.
+  std::size_t size() const noexcept
+  {
+    return registrations_.size();
+  }
+
+  /**
+   * @brief Waits for the readiness of the registered sockets.
+   *
+   * @returns The number of ready sockets, which are available by ready().
+   *
+   * @remarks
+   * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+   */
+  std::size_t wait(const std::chrono::milliseconds timeout)
+  {
+    ready_.clear();
+#if defined(DMITIGR_NET_POLLER_EPOLL)
+    events_.resize(std::max<std::size_t>(registrations_.size(), 1));
+    const int r = ::epoll_wait(handle_, events_.data(),
+      static_cast<int>(events_.size()), detail::poll_timeout(timeout));
+    if (r < 0)
+      throw DMITIGR_NET_EXCEPTION{"socket error upon polling"};
+
+    for (int i{}; i < r; ++i) {
+      const auto& event = events_[static_cast<std::size_t>(i)];
+      const auto mask = registrations_.at(event.data.fd);
+      auto readiness = Socket_readiness::unready;
+      if (has(mask, Socket_readiness::read_ready) &&
+        (event.events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)))
+        readiness |= Socket_readiness::read_ready;
+      if (has(mask, Socket_readiness::write_ready) &&
+        (event.events & (EPOLLOUT | EPOLLERR)))
+        readiness |= Socket_readiness::write_ready;
+      if (event.events & EPOLLPRI)
+        readiness |= Socket_readiness::exceptions;
+      if (readiness != Socket_readiness::unready)
+        ready_.push_back(Poll_entry{event.data.fd, mask, readiness});
+    }
+#elif defined(DMITIGR_NET_POLLER_KQUEUE)
+    using std::chrono::seconds;
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    timespec ts{};
+    timespec* const ts_p = timeout >= timeout.zero() ? &ts : nullptr;
+    if (ts_p) {
+      const auto s = duration_cast<seconds>(timeout);
+      ts.tv_sec = static_cast<decltype(ts.tv_sec)>(s.count());
+      ts.tv_nsec = static_cast<decltype(ts.tv_nsec)>(
+        duration_cast<nanoseconds>(timeout - s).count());
+    }
+    events_.resize(std::max<std::size_t>(2*registrations_.size(), 1));
+    const int r = ::kevent(handle_, nullptr, 0, events_.data(),
+      static_cast<int>(events_.size()), ts_p);
+    if (r < 0)
+      throw DMITIGR_NET_EXCEPTION{"socket error upon polling"};
+
+    // The readiness of reading and writing are reported by separate events.
+    for (int i{}; i < r; ++i) {
+      const auto& event = events_[static_cast<std::size_t>(i)];
+      const auto socket = static_cast<Socket_native>(event.ident);
+      const auto mask = registrations_.at(socket);
+      auto readiness = Socket_readiness::unready;
+      if (event.flags & EV_ERROR)
+        readiness |= mask & (Socket_readiness::read_ready |
+          Socket_readiness::write_ready);
+      else if (event.filter == EVFILT_READ)
+        readiness |= Socket_readiness::read_ready;
+      else if (event.filter == EVFILT_WRITE)
+        readiness |= Socket_readiness::write_ready;
+
+      const auto e = std::find_if(ready_.begin(), ready_.end(),
+        [socket](const Poll_entry& entry){return entry.socket == socket;});
+      if (e != ready_.end())
+        e->readiness |= readiness;
+      else if (readiness != Socket_readiness::unready)
+        ready_.push_back(Poll_entry{socket, mask, readiness});
+    }
+#else
+    events_.clear();
+    events_.reserve(registrations_.size());
+    for (const auto& [socket, mask] : registrations_)
+      events_.push_back(Poll_entry{socket, mask, Socket_readiness::unready});
+    if (poll_many(events_, timeout)) {
+      for (const auto& entry : events_)
+        if (entry.readiness != Socket_readiness::unready)
+          ready_.push_back(entry);
+    }
+#endif
+    return ready_.size();
+  }
+
+  /// @returns The sockets ready upon the last call of wait().
+  const std::vector<Poll_entry>& ready() const noexcept
+  {
+    return ready_;
+  }
+
+private:
+#if defined(DMITIGR_NET_POLLER_EPOLL)
+  int handle_{-1};
+  std::vector<epoll_event> events_;
+#elif defined(DMITIGR_NET_POLLER_KQUEUE)
+  int handle_{-1};
+  std::vector<struct kevent> events_;
+#else
+  std::vector<Poll_entry> events_;
+#endif
+  std::unordered_map<Socket_native, Socket_readiness> registrations_;
+  std::vector<Poll_entry> ready_;
+
+  static bool has(const Socket_readiness value,
+    const Socket_readiness mask) noexcept
+  {
+    return (value & mask) != Socket_readiness::unready;
+  }
+
+  void update([[maybe_unused]] const Socket_native socket,
+    [[maybe_unused]] const Socket_readiness old_mask,
+    [[maybe_unused]] const Socket_readiness mask,
+    [[maybe_unused]] const bool is_new)
+  {
+#if defined(DMITIGR_NET_POLLER_EPOLL)
+    epoll_event event{};
+    event.data.fd = socket;
+    if (has(mask, Socket_readiness::read_ready))
+      event.events |= EPOLLIN | EPOLLRDHUP;
+    if (has(mask, Socket_readiness::write_ready))
+      event.events |= EPOLLOUT;
+    if (has(mask, Socket_readiness::exceptions))
+      event.events |= EPOLLPRI;
+    if (::epoll_ctl(handle_, is_new ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, socket,
+        &event))
+      throw DMITIGR_NET_EXCEPTION{"cannot register socket in poller"};
+#elif defined(DMITIGR_NET_POLLER_KQUEUE)
+    struct kevent changes[2];
+    int count{};
+    const auto change = [&](const Socket_readiness readiness, const short filter)
+    {
+      if (has(mask, readiness))
+        EV_SET(&changes[count++], socket, filter, EV_ADD, 0, 0, nullptr);
+      else if (has(old_mask, readiness))
+        EV_SET(&changes[count++], socket, filter, EV_DELETE, 0, 0, nullptr);
+    };
+    change(Socket_readiness::read_ready, EVFILT_READ);
+    change(Socket_readiness::write_ready, EVFILT_WRITE);
+    if (count && ::kevent(handle_, changes, count, nullptr, 0, nullptr) < 0)
+      throw DMITIGR_NET_EXCEPTION{"cannot register socket in poller"};
+#endif
+  }
+};
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_POLLER_HPP
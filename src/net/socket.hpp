@@ -25,22 +25,30 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <limits>
+#include <optional>
+#include <string>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 
 #ifdef _WIN32
 #include "../os/windows.hpp"
 
 #include <Winsock2.h> // includes Ws2def.h
 #include <In6addr.h>  // must follows after Winsock2.h
+#include <Ws2tcpip.h> // TCP_* options
 #else
 #include <cerrno>
 
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/time.h> // timeval
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <unistd.h>
 #endif
 
@@ -152,6 +160,144 @@ inline void set_timeout(const Socket_native socket,
     throw DMITIGR_NET_EXCEPTION{"cannot set timeout on a socket"};
 }
 
+/// TCP options of a socket. The unset options are left as is.
+struct Tcp_options final {
+  /// `TCP_NODELAY` (disables the Nagle algorithm).
+  std::optional<bool> no_delay;
+
+  /// `SO_SNDBUF` in bytes.
+  std::optional<int> send_buffer_size;
+
+  /// `SO_RCVBUF` in bytes.
+  std::optional<int> receive_buffer_size;
+
+  /// `TCP_QUICKACK` (Linux only).
+  std::optional<bool> quick_ack;
+
+  /**
+   * `TCP_FASTOPEN` for listeners (the queue length is the backlog), or
+   * `TCP_FASTOPEN_CONNECT` for clients (Linux only).
+   */
+  std::optional<bool> fast_open;
+
+  /// `SO_KEEPALIVE`.
+  std::optional<bool> keepalive;
+
+  /// `TCP_KEEPIDLE` (`TCP_KEEPALIVE` on macOS).
+  std::optional<std::chrono::seconds> keepalive_idle;
+
+  /// `TCP_KEEPINTVL`.
+  std::optional<std::chrono::seconds> keepalive_interval;
+
+  /// `TCP_KEEPCNT`.
+  std::optional<int> keepalive_count;
+
+  /// `SO_BUSY_POLL` in microseconds (Linux only).
+  std::optional<std::chrono::microseconds> busy_poll;
+};
+
+namespace detail {
+
+inline void set_socket_option(const Socket_native socket, const int level,
+  const int name, const int value, const char* const what)
+{
+#ifdef _WIN32
+  const auto optlen = static_cast<int>(sizeof(value));
+#else
+  const auto optlen = static_cast<::socklen_t>(sizeof(value));
+#endif
+  if (::setsockopt(socket, level, name,
+      reinterpret_cast<const char*>(&value), optlen) != 0)
+    throw DMITIGR_NET_EXCEPTION{std::string{"cannot set "}.append(what)
+      .append(" socket option")};
+}
+
+} // namespace detail
+
+/**
+ * @brief Sets the TCP `options` of the `socket`.
+ *
+ * @details The options which are not supported by the system are ignored.
+ * The `fast_open` option is not set by this function, since it must be set
+ * differently for listening and connecting sockets.
+ */
+inline void set_tcp_options(const Socket_native socket,
+  const Tcp_options& options)
+{
+  using detail::set_socket_option;
+  if (options.no_delay)
+    set_socket_option(socket, IPPROTO_TCP, TCP_NODELAY, *options.no_delay,
+      "TCP_NODELAY");
+  if (options.send_buffer_size)
+    set_socket_option(socket, SOL_SOCKET, SO_SNDBUF, *options.send_buffer_size,
+      "SO_SNDBUF");
+  if (options.receive_buffer_size)
+    set_socket_option(socket, SOL_SOCKET, SO_RCVBUF,
+      *options.receive_buffer_size, "SO_RCVBUF");
+#ifdef TCP_QUICKACK
+  if (options.quick_ack)
+    set_socket_option(socket, IPPROTO_TCP, TCP_QUICKACK, *options.quick_ack,
+      "TCP_QUICKACK");
+#endif
+  if (options.keepalive)
+    set_socket_option(socket, SOL_SOCKET, SO_KEEPALIVE, *options.keepalive,
+      "SO_KEEPALIVE");
+#if defined(TCP_KEEPIDLE)
+  if (options.keepalive_idle)
+    set_socket_option(socket, IPPROTO_TCP, TCP_KEEPIDLE,
+      static_cast<int>(options.keepalive_idle->count()), "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+  if (options.keepalive_idle)
+    set_socket_option(socket, IPPROTO_TCP, TCP_KEEPALIVE,
+      static_cast<int>(options.keepalive_idle->count()), "TCP_KEEPALIVE");
+#endif
+#ifdef TCP_KEEPINTVL
+  if (options.keepalive_interval)
+    set_socket_option(socket, IPPROTO_TCP, TCP_KEEPINTVL,
+      static_cast<int>(options.keepalive_interval->count()), "TCP_KEEPINTVL");
+#endif
+#ifdef TCP_KEEPCNT
+  if (options.keepalive_count)
+    set_socket_option(socket, IPPROTO_TCP, TCP_KEEPCNT,
+      *options.keepalive_count, "TCP_KEEPCNT");
+#endif
+#ifdef SO_BUSY_POLL
+  if (options.busy_poll)
+    set_socket_option(socket, SOL_SOCKET, SO_BUSY_POLL,
+      static_cast<int>(options.busy_poll->count()), "SO_BUSY_POLL");
+#endif
+}
+
+/// Sets the non-blocking mode of the `socket`.
+inline void set_non_blocking(const Socket_native socket, const bool value)
+{
+#ifdef _WIN32
+  u_long mode{value};
+  const auto r = ::ioctlsocket(socket, FIONBIO, &mode);
+#else
+  int r = ::fcntl(socket, F_GETFL, 0);
+  if (!is_socket_error(r))
+    r = ::fcntl(socket, F_SETFL, value ? (r | O_NONBLOCK) : (r & ~O_NONBLOCK));
+#endif
+  if (is_socket_error(r))
+    throw DMITIGR_NET_EXCEPTION{"cannot set non-blocking mode of a socket"};
+}
+
+/// @returns `true` if the last socket operation failed since it would block.
+inline bool is_last_error_would_block() noexcept
+{
+#ifdef _WIN32
+  return ::WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  const int err{errno};
+#if EAGAIN != EWOULDBLOCK
+  return err == EAGAIN || err == EWOULDBLOCK;
+#else
+  return err == EAGAIN;
+#endif
+#endif
+}
+
 // =============================================================================
 
 #ifdef _WIN32
@@ -310,6 +456,85 @@ inline void shutdown_socket(const Socket_native socket, const int how)
     throw DMITIGR_NET_EXCEPTION{"cannot shutdown a socket"};
 }
 
+namespace detail {
+
+#ifdef _WIN32
+using Pollfd = WSAPOLLFD;
+// WSAPoll() fails if POLLPRI is requested.
+constexpr short poll_read_events{POLLRDNORM};
+constexpr short poll_write_events{POLLWRNORM};
+constexpr short poll_except_events{POLLRDBAND};
+#else
+using Pollfd = pollfd;
+constexpr short poll_read_events{POLLIN};
+constexpr short poll_write_events{POLLOUT};
+constexpr short poll_except_events{POLLPRI};
+#endif
+
+/// @returns The value of timeout for poll(2) and alike.
+inline int poll_timeout(const std::chrono::milliseconds timeout) noexcept
+{
+  using std::chrono::milliseconds;
+  // Negative timeout means "no timeout" for poll(2), WSAPoll() and epoll.
+  return timeout >= milliseconds::zero() ?
+    static_cast<int>(std::min(timeout,
+        milliseconds{std::numeric_limits<int>::max()}).count()) : -1;
+}
+
+/// @returns The events for poll(2) according to the `mask`.
+inline short to_poll_events(const Socket_readiness mask) noexcept
+{
+  using Ut = std::underlying_type_t<Socket_readiness>;
+  short result{};
+  if (static_cast<Ut>(mask & Socket_readiness::read_ready))
+    result |= poll_read_events;
+
+  if (static_cast<Ut>(mask & Socket_readiness::write_ready))
+    result |= poll_write_events;
+
+  if (static_cast<Ut>(mask & Socket_readiness::exceptions))
+    result |= poll_except_events;
+
+  return result;
+}
+
+/**
+ * @returns The readiness according to the returned events of poll(2).
+ *
+ * @details Like with select(), the error and hang up conditions are reported
+ * as the readiness, since the subsequent I/O on the socket will not block.
+ */
+inline Socket_readiness to_socket_readiness(const short events,
+  const short revents) noexcept
+{
+  auto result = Socket_readiness::unready;
+  if ((events & poll_read_events) &&
+    (revents & (poll_read_events | POLLERR | POLLHUP)))
+    result |= Socket_readiness::read_ready;
+
+  if ((events & poll_write_events) &&
+    (revents & (poll_write_events | POLLERR)))
+    result |= Socket_readiness::write_ready;
+
+  if (revents & poll_except_events)
+    result |= Socket_readiness::exceptions;
+
+  return result;
+}
+
+/// Calls poll(2) or WSAPoll().
+inline int poll(Pollfd* const fds, const std::size_t count,
+  const std::chrono::milliseconds timeout) noexcept
+{
+#ifdef _WIN32
+  return ::WSAPoll(fds, static_cast<ULONG>(count), poll_timeout(timeout));
+#else
+  return ::poll(fds, static_cast<nfds_t>(count), poll_timeout(timeout));
+#endif
+}
+
+} // namespace detail
+
 /**
  * @brief Performs the polling of the `socket`.
  *
@@ -321,7 +546,10 @@ inline void shutdown_socket(const Socket_native socket, const int how)
  * @remarks
  * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
  *
- * @remarks The current implementation is based only on select().
+ * @remarks The implementation is based on poll(2) (`WSAPoll()` on Windows),
+ * so the value of `socket` is not limited by `FD_SETSIZE`.
+ *
+ * @see poll_many().
  */
 inline Socket_readiness poll(const Socket_native socket,
   const Socket_readiness mask, const std::chrono::milliseconds timeout)
@@ -329,65 +557,86 @@ inline Socket_readiness poll(const Socket_native socket,
   if (!is_socket_valid(socket))
     throw Exception{"cannot poll an invalid socket"};
 
-  using std::chrono::seconds;
-  using std::chrono::milliseconds;
-  using std::chrono::microseconds;
-  using std::chrono::duration_cast;
-
-  // When (tv_p == nullptr), select(2) treats it as "no timeout".
-  timeval tv;
-  timeval* const tv_p = (timeout >= milliseconds::zero() ? &tv : nullptr);
-  if (tv_p) {
-    using Tv_sec  = decltype(tv.tv_sec);
-    using Tv_usec = decltype(tv.tv_usec);
-
-    const auto s = std::min(duration_cast<seconds>(timeout),
-      seconds{std::numeric_limits<Tv_sec>::max()});
-    const auto us = std::min(duration_cast<microseconds>(timeout - s),
-      microseconds{std::numeric_limits<Tv_usec>::max()});
-
-    tv_p->tv_sec  = static_cast<Tv_sec>(s.count());
-    tv_p->tv_usec = static_cast<Tv_usec>(us.count());
-  }
+  detail::Pollfd pfd{};
+  pfd.fd = socket;
+  pfd.events = detail::to_poll_events(mask);
+  const int r = detail::poll(&pfd, 1, timeout);
+  if (is_socket_error(r) || (r > 0 && (pfd.revents & POLLNVAL)))
+    throw DMITIGR_NET_EXCEPTION{"socket error upon polling"};
 
-  fd_set read_mask;
-  FD_ZERO(&read_mask);
-  fd_set write_mask;
-  FD_ZERO(&write_mask);
-  fd_set except_mask;
-  FD_ZERO(&except_mask);
+  return r > 0 ? detail::to_socket_readiness(pfd.events, pfd.revents) :
+    Socket_readiness::unready;
+}
 
-  using Ut = std::underlying_type_t<Socket_readiness>;
+/// A socket to poll along with the result of polling.
+struct Poll_entry final {
+  /// The socket to poll.
+  Socket_native socket{invalid_socket};
 
-  if (static_cast<Ut>(mask & Socket_readiness::read_ready))
-    FD_SET(socket, &read_mask);
+  /// The readiness to poll for.
+  Socket_readiness mask{Socket_readiness::unready};
 
-  if (static_cast<Ut>(mask & Socket_readiness::write_ready))
-    FD_SET(socket, &write_mask);
+  /// The readiness of the socket according to the mask.
+  Socket_readiness readiness{Socket_readiness::unready};
+};
 
-  if (static_cast<Ut>(mask & Socket_readiness::exceptions))
-    FD_SET(socket, &except_mask);
+/**
+ * @brief Performs the polling of the sockets of `entries` at once.
+ *
+ * @details Sets the `readiness` of each of the `entries`.
+ *
+ * @returns The number of entries with readiness other than
+ * `Socket_readiness::unready`.
+ *
+ * @par Requires
+ * `(entries || !count)` and `is_socket_valid(entries[i].socket)` for each
+ * `i < count`.
+ *
+ * @remarks
+ * `(timeout < 0)` means *no timeout* and the function can block indefinitely!
+ *
+ * @see poll(), Poller.
+ */
+inline std::size_t poll_many(Poll_entry* const entries, const std::size_t count,
+  const std::chrono::milliseconds timeout)
+{
+  if (!entries && count)
+    throw Exception{"cannot poll sockets: invalid entries"};
+
+  std::vector<detail::Pollfd> fds(count);
+  for (std::size_t i{}; i < count; ++i) {
+    if (!is_socket_valid(entries[i].socket))
+      throw Exception{"cannot poll an invalid socket"};
+    fds[i].fd = entries[i].socket;
+    fds[i].events = detail::to_poll_events(entries[i].mask);
+    entries[i].readiness = Socket_readiness::unready;
+  }
 
-  const int r = ::select(static_cast<int>(socket + 1) /* ignored on Windows */,
-    &read_mask, &write_mask, &except_mask, tv_p);
+  const int r = detail::poll(fds.data(), count, timeout);
   if (is_socket_error(r))
     throw DMITIGR_NET_EXCEPTION{"socket error upon polling"};
 
-  auto result = Socket_readiness::unready;
+  std::size_t result{};
   if (r > 0) {
-    if (FD_ISSET(socket, &read_mask))
-      result |= Socket_readiness::read_ready;
-
-    if (FD_ISSET(socket, &write_mask))
-      result |= Socket_readiness::write_ready;
-
-    if (FD_ISSET(socket, &except_mask))
-      result |= Socket_readiness::exceptions;
+    for (std::size_t i{}; i < count; ++i) {
+      if (fds[i].revents & POLLNVAL)
+        throw Exception{"cannot poll an invalid socket"};
+      entries[i].readiness = detail::to_socket_readiness(fds[i].events,
+        fds[i].revents);
+      if (entries[i].readiness != Socket_readiness::unready)
+        ++result;
+    }
   }
-
   return result;
 }
 
+/// @overload
+inline std::size_t poll_many(std::vector<Poll_entry>& entries,
+  const std::chrono::milliseconds timeout)
+{
+  return poll_many(entries.data(), entries.size(), timeout);
+}
+
 } // namespace dmitigr::net
 
 #endif  // DMITIGR_NET_SOCKET_HPP
@@ -0,0 +1,188 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_NET_TRANSFER_HPP
+#define DMITIGR_NET_TRANSFER_HPP
+
+#include "../fsx/filesystem.hpp"
+#include "../os/exceptions.hpp"
+#include "buffered_descriptor.hpp"
+#include "descriptor.hpp"
+#include "exceptions.hpp"
+#include "socket.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <optional>
+
+#ifdef _WIN32
+#include "../os/windows.hpp"
+
+#include <Mswsock.h>
+#elif defined(__linux__)
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dmitigr::net {
+
+namespace detail {
+
+/// Sends the file by reading and writing via the user-space buffer.
+inline std::uint_fast64_t send_file_copy(Descriptor& descriptor,
+  const std::filesystem::path& path, const std::uint_fast64_t offset,
+  const std::uint_fast64_t length)
+{
+  std::ifstream file{path, std::ios_base::binary};
+  if (!file || !file.seekg(static_cast<std::streamoff>(offset)))
+    throw Exception{"cannot send file: cannot open " + path.string()};
+
+  std::array<char, 65536> buffer;
+  std::uint_fast64_t result{};
+  while (result < length) {
+    const auto size = static_cast<std::streamsize>(std::min<std::uint_fast64_t>(
+        buffer.size(), length - result));
+    const auto read_count = file.read(buffer.data(), size).gcount();
+    if (!read_count)
+      break; // the file is truncated
+    for (std::streamsize written{}; written < read_count;) {
+      const auto n = descriptor.write(buffer.data() + written,
+        read_count - written);
+      if (n <= 0)
+        throw Exception{"cannot send file: cannot write to descriptor"};
+      written += n;
+    }
+    result += static_cast<std::uint_fast64_t>(read_count);
+  }
+  return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Sends the `length` bytes of the file at `path` from the `offset` to
+ * the `descriptor`.
+ *
+ * @details If the `descriptor` is a socket (possibly wrapped by
+ * Buffered_descriptor, which is flushed first), the file is sent without
+ * copying via the user space by using sendfile(2) on Linux, or `TransmitFile()`
+ * on Windows. Otherwise, the file is sent by reading and writing.
+ *
+ * @param length The number of bytes to send, or `std::nullopt` to send the
+ * file until the end.
+ *
+ * @returns The number of bytes sent, which is less than `length` only if the
+ * file is shorter.
+ *
+ * @par Requires
+ * `offset` is not greater than the size of the file.
+ */
+inline std::uint_fast64_t send_file(Descriptor& descriptor,
+  const std::filesystem::path& path, const std::uint_fast64_t offset = 0,
+  std::optional<std::uint_fast64_t> length = std::nullopt)
+{
+  const std::uint_fast64_t file_size{std::filesystem::file_size(path)};
+  if (offset > file_size)
+    throw Exception{"cannot send file: invalid offset"};
+  else if (!length || *length > file_size - offset)
+    length = file_size - offset;
+
+  if (auto* const buffered = dynamic_cast<Buffered_descriptor*>(&descriptor)) {
+    buffered->flush();
+    return send_file(buffered->descriptor(), path, offset, length);
+  }
+
+  using detail::socket_Descriptor;
+  auto* const socket = dynamic_cast<socket_Descriptor*>(&descriptor);
+  if (!socket)
+    return detail::send_file_copy(descriptor, path, offset, *length);
+
+  [[maybe_unused]] const auto sock =
+    static_cast<Socket_native>(socket->native_handle());
+#if defined(__linux__)
+  const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd < 0)
+    throw os::Sys_exception{"cannot send file: cannot open " + path.string()};
+
+  std::uint_fast64_t result{};
+  try {
+    auto off = static_cast<off_t>(offset);
+    while (result < *length) {
+      // sendfile(2) transfers at most 0x7ffff000 bytes per call.
+      const auto count = static_cast<std::size_t>(
+        std::min<std::uint_fast64_t>(0x7ffff000, *length - result));
+      const auto n = ::sendfile(sock, fd, &off, count);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        else if (is_last_error_would_block()) {
+          poll(sock, Socket_readiness::write_ready,
+            std::chrono::milliseconds{-1});
+          continue;
+        } else
+          throw os::Sys_exception{"cannot send file"};
+      } else if (!n)
+        break; // the file is truncated
+      result += static_cast<std::uint_fast64_t>(n);
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  return result;
+#elif defined(_WIN32)
+  os::windows::Handle_guard file{::CreateFileW(path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr)};
+  if (file == INVALID_HANDLE_VALUE)
+    throw os::Sys_exception{"cannot send file: cannot open " + path.string()};
+
+  std::uint_fast64_t result{};
+  while (result < *length) {
+    // TransmitFile() transfers at most 2147483646 bytes per call.
+    const auto count = static_cast<DWORD>(
+      std::min<std::uint_fast64_t>(2147483646, *length - result));
+    const std::uint_fast64_t off{offset + result};
+    OVERLAPPED ol{};
+    ol.Offset = static_cast<DWORD>(off & 0xffffffff);
+    ol.OffsetHigh = static_cast<DWORD>(off >> 32);
+    if (!::TransmitFile(sock, file, count, 0, &ol, nullptr, 0)) {
+      if (::WSAGetLastError() != WSA_IO_PENDING)
+        throw Wsa_exception{"cannot send file"};
+      DWORD n{};
+      DWORD flags{};
+      if (!::WSAGetOverlappedResult(sock, &ol, &n, true, &flags))
+        throw Wsa_exception{"cannot send file"};
+    }
+    result += count;
+  }
+  return result;
+#else
+  return detail::send_file_copy(descriptor, path, offset, *length);
+#endif
+}
+
+} // namespace dmitigr::net
+
+#endif  // DMITIGR_NET_TRANSFER_HPP
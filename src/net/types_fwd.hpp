@@ -26,11 +26,23 @@ enum class Communication_mode;
 enum class Socket_readiness;
 enum class Protocol_family;
 
+class Buffered_descriptor;
 class Descriptor;
 class Ip_address;
+class Iocp;
+class Iocp_pipe_descriptor;
+class Iocp_pipe_listener;
 class Endpoint;
 class Listener_options;
 class Listener;
+class Poller;
+class Io_uring;
+class Uring_descriptor;
+class Uring_listener;
+
+struct Const_buffer;
+struct Mutable_buffer;
+struct Poll_entry;
 
 class Wsa_exception;
 class Wsa_error_category;
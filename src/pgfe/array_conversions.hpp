@@ -18,8 +18,10 @@
 #define DMITIGR_PGFE_ARRAY_CONVERSIONS_HPP
 
 #include "../base/assert.hpp"
+#include "../net/conversions.hpp"
 #include "../str/c_str.hpp"
 #include "../str/predicate.hpp"
+#include "../str/simd.hpp"
 #include "basic_conversions.hpp"
 #include "conversions_api.hpp"
 #include "data.hpp"
@@ -27,27 +29,94 @@
 
 #include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace dmitigr::pgfe {
 namespace detail {
 
 /// @returns The PostgreSQL array literal representation of the `container`.
-template<typename T,
-  template<class> class Optional,
-  template<class, class> class Container,
-  template<class> class Allocator,
-  typename ... Types>
-std::string to_array_literal(const Container<Optional<T>,
-  Allocator<Optional<T>>>& container, char delimiter = ',', Types&& ... args);
+template<class Container, typename ... Types>
+std::string to_array_literal(const Container& container, char delimiter = ',',
+  Types&& ... args);
+
+/**
+ * @returns The PostgreSQL array literal representation of the `container` in
+ * Data_format::text format.
+ *
+ * @remarks The literal is generated directly into the storage of the result.
+ */
+template<class Container, typename ... Types>
+std::unique_ptr<Data> to_array_literal_data(const Container& container,
+  char delimiter = ',', Types&& ... args);
+
+/**
+ * @brief Appends the PostgreSQL array literal representation of the
+ * `container` to `result`.
+ */
+template<class Container, typename ... Types>
+void append_array_literal(std::string& result, const Container& container,
+  char delimiter, Types&& ... args);
+
+/**
+ * @brief Writes the text representation of `value` into [first, last).
+ *
+ * @remarks Defined in conversions.hpp.
+ */
+template<typename T>
+char* numeric_to_chars(char* first, char* last, T value);
 
 /// @returns The container representation of the PostgreSQL array `literal`.
 template<class Container, typename ... Types>
 Container to_container(const char* literal, char delimiter = ',', Types&& ... args);
 
+/**
+ * @brief Fills the container of non-null values from the PostgreSQL array
+ * `literal`.
+ */
+template<class Container, typename ... Types>
+const char* fill_container_of_values(Container& result, const char* literal,
+  char delimiter, Types&& ... args);
+
+/// The trait to detect (sub-)containers of arrays.
+template<typename T> struct Is_array_container;
+
+/// The trait to detect optionals.
+template<typename T> struct Is_optional;
+
+/**
+ * @brief Parses the one-dimensional PostgreSQL array literal [first, last) of
+ * numbers or unquoted strings into `result`.
+ *
+ * @returns `false` if the literal must be parsed by the general parser. (In
+ * this case the content of `result` is unspecified.)
+ */
+template<class Container>
+bool parse_flat_array_literal(Container& result, const char* first,
+  const char* last, char delimiter);
+
+/**
+ * @returns The container representation of the PostgreSQL array `data` in
+ * Data_format::binary format.
+ */
+template<class Container>
+Container binary_array_to_container(const Data& data);
+
+/// @returns The PostgreSQL array in Data_format::binary format of `container`.
+template<class Container>
+std::unique_ptr<Data> container_to_binary_array(const Container& container);
+
 // =============================================================================
 
 /**
@@ -88,6 +157,17 @@ struct Cont_of_opts<std::basic_string<CharT, Traits, Allocator>> final {
   using Type = std::basic_string<CharT, Traits, Allocator>;
 };
 
+/**
+ * @brief Forces treating `std::string_view` as a non-container type.
+ *
+ * @details Without this specialization, `std::string_view` treated as
+ * `std::basic_string_view<Optional<char>, ...>`.
+ */
+template<>
+struct Cont_of_opts<std::string_view> final {
+  using Type = std::string_view;
+};
+
 /// The partial specialization of Cont_of_opts.
 template<typename T,
   template<class, class> class Container,
@@ -173,6 +253,12 @@ struct Array_string_conversions_opts<Container<Optional<T>,
   template<typename ... Types>
   static Type to_type(const std::string& literal, Types&& ... args)
   {
+    if constexpr (!sizeof...(args)) {
+      Type result;
+      if (parse_flat_array_literal(result, literal.data(),
+          literal.data() + literal.size(), ','))
+        return result;
+    }
     return to_container<Type>(literal.c_str(), ',', std::forward<Types>(args)...);
   }
 
@@ -195,11 +281,15 @@ struct Array_data_conversions_opts<Container<Optional<T>,
   template<typename ... Types>
   static Type to_type(const Data& data, Types&& ... args)
   {
-    if (!(data.format() == Data_format::text))
-      throw Client_exception{"cannot convert array to native type: "
-        "unsupported input data format"};
-    return to_container<Type>(static_cast<const char*>(data.bytes()), ',',
-      std::forward<Types>(args)...);
+    if (data.format() == Data_format::binary)
+      return binary_array_to_container<Type>(data);
+    const auto* const literal = static_cast<const char*>(data.bytes());
+    if constexpr (!sizeof...(args)) {
+      Type result;
+      if (parse_flat_array_literal(result, literal, literal + data.size(), ','))
+        return result;
+    }
+    return to_container<Type>(literal, ',', std::forward<Types>(args)...);
   }
 
   template<typename ... Types>
@@ -214,9 +304,14 @@ struct Array_data_conversions_opts<Container<Optional<T>,
   template<typename ... Types>
   static std::unique_ptr<Data> to_data(const Type& value, Types&& ... args)
   {
-    using StringConversions = Array_string_conversions_opts<Type>;
-    return Data::make(StringConversions::to_string(value,
-      std::forward<Types>(args)...), Data_format::text);
+    return to_array_literal_data(value, ',', std::forward<Types>(args)...);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    return format == Data_format::binary ?
+      container_to_binary_array(value) : to_data(value);
   }
 };
 
@@ -238,21 +333,23 @@ struct Array_string_conversions_vals<Container<T, Allocator<T>>> final {
   template<typename ... Types>
   static Type to_type(const std::string& literal, Types&& ... args)
   {
-    return to_container_of_values(
-      Array_string_conversions_opts<Cont>::to_type(literal,
-        std::forward<Types>(args)...));
+    if constexpr (!sizeof...(args)) {
+      Type result;
+      if (parse_flat_array_literal(result, literal.data(),
+          literal.data() + literal.size(), ','))
+        return result;
+    }
+    Type result;
+    fill_container_of_values(result, literal.c_str(), ',',
+      std::forward<Types>(args)...);
+    return result;
   }
 
   template<typename ... Types>
   static std::string to_string(const Type& value, Types&& ... args)
   {
-    return Array_string_conversions_opts<Cont>::to_string(
-      to_container_of_optionals<std::optional>(value),
-      std::forward<Types>(args)...);
+    return to_array_literal(value, ',', std::forward<Types>(args)...);
   }
-
-private:
-  using Cont = Cont_of_opts_t<Type>;
 };
 
 /// The partial specialization of Array_data_conversions_vals.
@@ -265,9 +362,18 @@ struct Array_data_conversions_vals<Container<T, Allocator<T>>> final {
   template<typename ... Types>
   static Type to_type(const Data& data, Types&& ... args)
   {
-    return to_container_of_values(
-      Array_data_conversions_opts<Cont>::to_type(data,
-        std::forward<Types>(args)...));
+    if (data.format() == Data_format::binary)
+      return binary_array_to_container<Type>(data);
+    if constexpr (!sizeof...(args)) {
+      Type result;
+      const auto* const literal = static_cast<const char*>(data.bytes());
+      if (parse_flat_array_literal(result, literal, literal + data.size(), ','))
+        return result;
+    }
+    Type result;
+    fill_container_of_values(result, static_cast<const char*>(data.bytes()),
+      ',', std::forward<Types>(args)...);
+    return result;
   }
 
   template<typename ... Types>
@@ -276,21 +382,21 @@ struct Array_data_conversions_vals<Container<T, Allocator<T>>> final {
     if (!data)
       throw Client_exception{"cannot convert array to native type: "
         "null data given"};
-    return to_container_of_values(
-      Array_data_conversions_opts<Cont>::to_type(std::move(data),
-        std::forward<Types>(args)...));
+    return to_type(*data, std::forward<Types>(args)...);
   }
 
   template<typename ... Types>
-  static std::unique_ptr<Data> to_data(Type&& value, Types&& ... args)
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ... args)
   {
-    return Array_data_conversions_opts<Cont>::to_data(
-      to_container_of_optionals<std::optional>(std::forward<Type>(value)),
-      std::forward<Types>(args)...);
+    return to_array_literal_data(value, ',', std::forward<Types>(args)...);
   }
 
-private:
-  using Cont = Cont_of_opts_t<Type>;
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    return format == Data_format::binary ?
+      container_to_binary_array(value) : to_data(value);
+  }
 };
 
 // -----------------------------------------------------------------------------
@@ -343,7 +449,14 @@ public:
   void operator()(std::string&& value, const bool is_null,
     const int /*dimension*/, Types&& ... args)
   {
-    if constexpr (!is_value_type_container) {
+    if constexpr (std::is_same_v<Value_type, std::string_view>) {
+      // The view of the temporary element would dangle.
+      (void)value;   // dummy usage
+      (void)is_null; // dummy usage
+      throw Client_exception{"cannot convert array to native type: "
+        "only one-dimensional array literals can be converted to containers "
+        "of std::string_view"};
+    } else if constexpr (!is_value_type_container) {
       if (is_null)
         cont_.push_back(Optional_type());
       else
@@ -360,6 +473,52 @@ private:
   Container_type& cont_;
 };
 
+/**
+ * @brief The filler of the deepest container of non-null values.
+ *
+ * @details Similar to Filler_of_deepest_container but fills the container
+ * directly rather than through a container of optionals.
+ */
+template<class Container>
+class Filler_of_deepest_container_of_values final {
+public:
+  using Container_type = Container;
+  using Value_type     = typename Container_type::value_type;
+
+  explicit constexpr Filler_of_deepest_container_of_values(Container_type& c)
+    : cont_(c)
+  {}
+
+  constexpr void operator()(const int /*dimension*/)
+  {}
+
+  template<typename ... Types>
+  void operator()(std::string&& value, const bool is_null,
+    const int /*dimension*/, Types&& ... args)
+  {
+    if constexpr (std::is_same_v<Value_type, std::string_view>) {
+      // The view of the temporary element would dangle.
+      (void)value;   // dummy usage
+      (void)is_null; // dummy usage
+      throw Client_exception{"cannot convert array to native type: "
+        "only one-dimensional array literals can be converted to containers "
+        "of std::string_view"};
+    } else if constexpr (!Is_array_container<Value_type>::value) {
+      if (is_null)
+        throw Client_exception{Client_errc::improper_value_type};
+      cont_.push_back(Conversions<Value_type>::to_type(std::move(value),
+          std::forward<Types>(args)...));
+    } else {
+      (void)value;   // dummy usage
+      (void)is_null; // dummy usage
+      throw Client_exception{Client_errc::excessive_dimensionality};
+    }
+  }
+
+private:
+  Container_type& cont_;
+};
+
 // -------------------------------------
 
 /// Special overloads.
@@ -373,53 +532,6 @@ const char* fill_container(T& /*result*/, const char* /*literal*/,
   throw Client_exception{Client_errc::insufficient_dimensionality};
 }
 
-/// Used by to_array_literal()
-template<typename T>
-const char* quote_for_array_element(const T&)
-{
-  return "\"";
-}
-
-/// Used by to_array_literal().
-template<typename T,
-  template<class> class Optional,
-  template<class, class> class Container,
-  template<class> class Allocator>
-const char* quote_for_array_element(const Container<Optional<T>,
-  Allocator<Optional<T>>>&)
-{
-  return "";
-}
-
-/// Used by to_array_literal().
-template<typename T, typename ... Types>
-std::string to_array_literal(const T& element,
-  const char /*delimiter*/, Types&& ... args)
-{
-  return Conversions<T>::to_string(element, std::forward<Types>(args)...);
-}
-
-/// Used by to_array_literal().
-template<class CharT, class Traits, class Allocator, typename ... Types>
-std::string to_array_literal(
-  const std::basic_string<CharT, Traits, Allocator>& element,
-  const char /*delimiter*/, Types&& ... args)
-{
-  using String = std::basic_string<CharT, Traits, Allocator>;
-
-  std::string result{Conversions<String>::to_string(element,
-    std::forward<Types>(args)...)};
-
-  // Escaping quotes.
-  typename String::size_type i = result.find("\"");
-  while (i != String::npos) {
-    result.replace(i, 1, "\\\"");
-    i = result.find("\"", i + 2);
-  }
-
-  return result;
-}
-
 /// Used by to_container_of_values().
 template<typename T>
 T to_container_of_values(T&& element)
@@ -513,7 +625,7 @@ const char* parse_array_literal(const char* literal, const char delimiter,
          in_quoted_element, in_unquoted_element } state = in_beginning;
 
   int  dimension{};
-  char previous_char{};
+  bool is_escaped{};
   char previous_nonspace_char{};
   std::string element;
   while (const char c = *literal) {
@@ -563,9 +675,13 @@ const char* parse_array_literal(const char* literal, const char delimiter,
     }
 
     case in_quoted_element: {
-      if (c == '\\' && previous_char != '\\') {
+      if (is_escaped) {
+        element += c;
+        is_escaped = false;
+      } else if (c == '\\') {
         // Skip escape character '\\'.
-      } else if (c == '"' && previous_char != '\\')
+        is_escaped = true;
+      } else if (c == '"')
         goto element_extracted;
       else
         element += c;
@@ -585,7 +701,7 @@ const char* parse_array_literal(const char* literal, const char delimiter,
 
   element_extracted:
     {
-      if (element.empty())
+      if (element.empty() && state == in_unquoted_element)
         throw Client_exception{Client_errc::malformed_literal};
 
       const bool is_element_null =
@@ -616,7 +732,6 @@ const char* parse_array_literal(const char* literal, const char delimiter,
   preparing_to_the_next_iteration:
     if (str::is_non_space(c))
       previous_nonspace_char = c;
-    previous_char = c;
     ++literal;
   } // while
 
@@ -702,43 +817,60 @@ const char* fill_container(Container<Optional<T>, Allocator<Optional<T>>>& resul
   }
 }
 
-/// @returns PostgreSQL array literal converted from the given `container`.
-template<typename T,
-  template<class> class Optional,
-  template<class, class> class Container,
-  template<class> class Allocator,
-  typename ... Types>
-std::string to_array_literal(const Container<Optional<T>,
-  Allocator<Optional<T>>>& container, const char delimiter, Types&& ... args)
+/**
+ * @brief Fills the container of non-null values with elements extracted from
+ * the PostgreSQL array literal.
+ *
+ * @details Unlike fill_container(), the elements are stored directly rather
+ * than through an intermediate container of optionals. The subcontainers of
+ * optionals are filled by fill_container().
+ *
+ * @returns The pointer that points to a next character after the last closing
+ * curly bracket found in the `literal`.
+ *
+ * @throws Client_exception.
+ */
+template<class Container, typename ... Types>
+const char* fill_container_of_values(Container& result, const char* literal,
+  const char delimiter, Types&& ... args)
 {
-  auto i = cbegin(container);
-  const auto e = cend(container);
+  DMITIGR_ASSERT(result.empty());
+  DMITIGR_ASSERT(literal);
 
-  std::string result("{");
-  if (i != e) {
-    while (true) {
-      if (const Optional<T>& element = *i) {
-        /*
-         * End elements shall be quoted, subliterals shall not be quoted.
-         * We are using overloads defined in nested namespace "arrays" for this.
-         */
-        using namespace arrays;
-        result.append(quote_for_array_element(*element));
-        result.append(to_array_literal(*element, delimiter,
-            std::forward<Types>(args)...));
-        result.append(quote_for_array_element(*element));
-      } else
-        result.append("NULL");
+  using str::next_non_space_pointer;
+  using T = typename Container::value_type;
+
+  literal = next_non_space_pointer(literal);
+  if (*literal != '{')
+    throw Client_exception{Client_errc::malformed_literal};
 
-      if (++i != e)
-        result += delimiter;
+  const char* subliteral = next_non_space_pointer(literal + 1);
+  if (*subliteral != '{') {
+    Filler_of_deepest_container_of_values<Container> handler(result);
+    return parse_array_literal(literal, delimiter, handler,
+      std::forward<Types>(args)...);
+  } else if constexpr (!Is_array_container<T>::value)
+    throw Client_exception{Client_errc::insufficient_dimensionality};
+  else {
+    // Multidimensional array literal detected. (See fill_container().)
+    while (true) {
+      result.push_back(T());
+      if constexpr (Is_optional<typename T::value_type>::value)
+        subliteral = fill_container(result.back(), subliteral, delimiter,
+          std::forward<Types>(args)...);
       else
-        break;
+        subliteral = fill_container_of_values(result.back(), subliteral,
+          delimiter, std::forward<Types>(args)...);
+
+      subliteral = next_non_space_pointer(subliteral);
+      if (*subliteral == delimiter) {
+        subliteral = next_non_space_pointer(subliteral + 1);
+        if (*subliteral != '{')
+          throw Client_exception{Client_errc::malformed_literal};
+      } else if (*subliteral == '}')
+        return ++subliteral;
     }
   }
-  result.append("}");
-
-  return result;
 }
 
 /// @returns A container converted from PostgreSQL array literal.
@@ -799,98 +931,1607 @@ auto to_container_of_optionals(Container<T, Allocator<T>>&& container)
   return result;
 }
 
-} // namespace detail
+// -----------------------------------------------------------------------------
+// Binary format
+// -----------------------------------------------------------------------------
 
 /**
- * @ingroup conversions
- *
- * @brief The partial specialization of Conversions for nullable arrays (i.e.
- * containers with optional values).
- *
- * @details The support of the following data formats is implemented for:
- *   - input data - Data_format::text;
- *   - output data - Data_format::text.
- *
- * @par Requirements
- * @parblock
- * Requirements to the type T of elements of array:
- *   - default-constructible, copy-constructible;
- *   - convertible (there shall be a suitable specialization of Conversions).
- *
- * Requirements to the type Optional:
- *   - default-constructible, copy-constructible;
- *   - implemented operator bool() that returns `true` if the value is not null,
- *   or `false` otherwise. (For default constructed Optional<T> it should return
- *   `false`);
- *   - implemented operator*() that returns a reference to the value of type `T`.
- * @endparblock
+ * @brief The traits of the array elements in Data_format::binary format.
  *
- * @tparam T The type of the elements of the Container (which may be a container
- * of optionals).
- * @tparam Optional The optional template class, such as `std::optional`.
- * @tparam Container The container template class, such as `std::vector`.
- * @tparam Allocator The allocator template class, such as `std::allocator`.
+ * @details The specializations provide the OIDs of the element type and of
+ * the corresponding array type, and the conversion of the element to Data of Data_format::binary format.
  */
-template<typename T,
-  template<class> class Optional,
-  template<class, class> class Container,
-  template<class> class Allocator>
-struct Conversions<Container<Optional<T>, Allocator<Optional<T>>>> final
-  : Basic_conversions<Container<Optional<T>, Allocator<Optional<T>>>,
-      detail::Array_string_conversions_opts<Container<Optional<T>,
-                                              Allocator<Optional<T>>>>,
-      detail::Array_data_conversions_opts<Container<Optional<T>,
-                                            Allocator<Optional<T>>>>> {};
+template<typename T> struct Array_element_traits;
+
+/// The base of Array_element_traits specializations.
+template<typename T, std::uint32_t Oid, std::uint32_t ArrayOid,
+  bool HasFormatArgument = true>
+struct Array_element_traits_base {
+  static constexpr std::uint32_t oid{Oid};
+  static constexpr std::uint32_t array_oid{ArrayOid};
+
+  static std::unique_ptr<Data> to_data(const T& value)
+  {
+    if constexpr (HasFormatArgument)
+      return Conversions<T>::to_data(value, Data_format::binary);
+    else
+      return Conversions<T>::to_data(value);
+  }
+};
+
+template<> struct Array_element_traits<bool>
+  : Array_element_traits_base<bool, 16, 1000> {};
+template<> struct Array_element_traits<short>
+  : Array_element_traits_base<short, 21, 1005> {};
+template<> struct Array_element_traits<int>
+  : Array_element_traits_base<int, 23, 1007> {};
+template<> struct Array_element_traits<long>
+  : Array_element_traits_base<long,
+    sizeof(long) == 8 ? 20 : 23, sizeof(long) == 8 ? 1016 : 1007> {};
+template<> struct Array_element_traits<long long>
+  : Array_element_traits_base<long long, 20, 1016> {};
+template<> struct Array_element_traits<float>
+  : Array_element_traits_base<float, 700, 1021> {};
+template<> struct Array_element_traits<double>
+  : Array_element_traits_base<double, 701, 1022> {};
+template<> struct Array_element_traits<std::string>
+  : Array_element_traits_base<std::string, 25, 1009, false> {};
+template<> struct Array_element_traits<std::string_view>
+  : Array_element_traits_base<std::string_view, 25, 1009, false> {};
+template<> struct Array_element_traits<std::vector<std::byte>>
+  : Array_element_traits_base<std::vector<std::byte>, 17, 1001,
+    false> {};
+template<> struct Array_element_traits<Numeric>
+  : Array_element_traits_base<Numeric, 1700, 1231> {};
+template<> struct Array_element_traits<Uuid>
+  : Array_element_traits_base<Uuid, 2950, 2951> {};
+template<typename Duration>
+struct Array_element_traits<std::chrono::time_point<std::chrono::system_clock,
+  Duration>> : Array_element_traits_base<std::chrono::time_point<
+    std::chrono::system_clock, Duration>, 1184, 1185> {};
+
+/// The trait to detect `std::optional`.
+template<typename T>
+struct Is_optional final : std::false_type {
+  using Value_type = T;
+};
+
+/// The partial specialization of Is_optional.
+template<typename T>
+struct Is_optional<std::optional<T>> final : std::true_type {
+  using Value_type = T;
+};
+
+// -----------------------------------------------------------------------------
+// Fast path of parsing one-dimensional arrays
+// -----------------------------------------------------------------------------
+
+/// The trait to detect containers with `reserve()`.
+template<class Container, typename = void>
+struct Has_reserve final : std::false_type {};
+
+/// The partial specialization of Has_reserve.
+template<class Container>
+struct Has_reserve<Container,
+  std::void_t<decltype(std::declval<Container&>().reserve(0))>> final
+  : std::true_type {};
 
 /**
- * @ingroup conversions
- *
- * @brief The partial specialization of Conversions for non-nullable arrays.
- *
- * @details The support of the following data formats is implemented for:
- *   - input data  - Data_format::text;
- *   - output data - Data_format::text.
- *
- * @par Requirements
- * @parblock
- * Requirements to the type T of elements of array:
- *   - default-constructible, copy-constructible;
- *   - convertible (there shall be a suitable specialization of Conversions).
- * @endparblock
+ * @returns The pointer to the first of `"`, `\`, `{`, `}` or zero character
+ * in [first, last), or `last` if there is no such a character.
  *
- * @tparam T The type of the elements of the Container (which may be a container).
- * @tparam Container The container template class, such as `std::vector`.
- * @tparam Allocator The allocator template class, such as `std::allocator`.
- *
- * @throws Client_exception with code Client_errc::improper_value_type when
- * converting the PostgreSQL array representations with at least one NULL element.
+ * @par Effects
+ * `delimiter_count` is the number of `delimiter` characters before the result.
  */
-template<typename T,
-  template<class, class> class Container,
-  template<class> class Allocator>
-struct Conversions<Container<T, Allocator<T>>>
-  : Basic_conversions<Container<T, Allocator<T>>,
-      detail::Array_string_conversions_vals<Container<T, Allocator<T>>>,
-      detail::Array_data_conversions_vals<Container<T, Allocator<T>>>> {};
+inline const char* scan_flat_array_literal(const char* first,
+  const char* const last, const char delimiter,
+  std::size_t& delimiter_count) noexcept
+{
+  std::size_t count{};
+#if defined(DMITIGR_STR_SSE2)
+  const auto quote = _mm_set1_epi8('"');
+  const auto backslash = _mm_set1_epi8('\\');
+  const auto lbrace = _mm_set1_epi8('{');
+  const auto rbrace = _mm_set1_epi8('}');
+  const auto zero = _mm_setzero_si128();
+  const auto delim = _mm_set1_epi8(delimiter);
+  for (; last - first >= 16; first += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const auto special = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+      _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, lbrace),
+          _mm_cmpeq_epi8(v, rbrace)), _mm_cmpeq_epi8(v, zero)));
+    if (_mm_movemask_epi8(special))
+      break; // the block is scanned below
+    for (auto m = static_cast<unsigned>(_mm_movemask_epi8(
+          _mm_cmpeq_epi8(v, delim))); m; m &= m - 1)
+      ++count;
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto quote = vdupq_n_u8('"');
+  const auto backslash = vdupq_n_u8('\\');
+  const auto lbrace = vdupq_n_u8('{');
+  const auto rbrace = vdupq_n_u8('}');
+  const auto delim = vdupq_n_u8(static_cast<std::uint8_t>(delimiter));
+  const auto one = vdupq_n_u8(1);
+  for (; last - first >= 16; first += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+    const auto special = vorrq_u8(
+      vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)),
+      vorrq_u8(vorrq_u8(vceqq_u8(v, lbrace), vceqq_u8(v, rbrace)),
+        vceqzq_u8(v)));
+    if (vmaxvq_u8(special))
+      break; // the block is scanned below
+    count += vaddvq_u8(vandq_u8(vceqq_u8(v, delim), one));
+  }
+#endif
+  for (; first != last; ++first) {
+    const char c{*first};
+    if (c == '"' || c == '\\' || c == '{' || c == '}' || !c)
+      break;
+    else if (c == delimiter)
+      ++count;
+  }
+  delimiter_count = count;
+  return first;
+}
 
 /**
- * @brief The partial specialization of Conversions for non-nullable arrays.
+ * @brief Parses the one-dimensional PostgreSQL array literal [first, last)
+ * into `result` of views of the elements of the literal.
  *
- * @details This is a workaround for GCC. When using multidimensional STL-containers
- * GCC (at least version 8.1) incorrectly choises the specialization of
- * `Conversions<Container<Optional<T>, Allocator<Optional<T>>>>` by deducing
- * `Optional` as an STL container, instead of choising
- * `Conversions<Container<T>, Allocator<T>>` and thus, the nested vector in
- * `std::vector<std::vector<int>>` treated as `Optional`.
+ * @throws Client_exception if the literal is malformed or multidimensional,
+ * or if it contains the elements with escaped characters (which cannot be
+ * represented as views).
  */
-template<typename T,
-  template<class, class> class Container,
-  template<class, class> class Subcontainer,
-  template<class> class ContainerAllocator,
-  template<class> class SubcontainerAllocator>
-struct Conversions<Container<Subcontainer<T, SubcontainerAllocator<T>>,
-                     ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>>
-  : Basic_conversions<
+template<class Container>
+void parse_flat_array_literal_of_views(Container& result, const char* first,
+  const char* const last, const char delimiter)
+{
+  using E = typename Container::value_type;
+  DMITIGR_ASSERT(result.empty());
+  const auto skip_spaces = [last](const char* p) noexcept
+  {
+    while (p != last && str::is_space(*p))
+      ++p;
+    return p;
+  };
+
+  first = skip_spaces(first);
+  if (first == last || *first != '{')
+    throw Client_exception{Client_errc::malformed_literal};
+  first = skip_spaces(first + 1);
+  if (first != last && *first == '}')
+    return;
+
+  if constexpr (Has_reserve<Container>::value)
+    result.reserve(static_cast<std::size_t>(std::count(first, last,
+          delimiter)) + 1);
+  while (true) {
+    const char* element{first};
+    if (first != last && *first == '"') {
+      element = ++first;
+      while (first != last && *first != '"') {
+        if (*first == '\\')
+          throw Client_exception{"cannot convert array element to "
+            "std::string_view: element contains escaped characters"};
+        ++first;
+      }
+      if (first == last)
+        throw Client_exception{Client_errc::malformed_literal};
+      result.push_back(E{std::string_view{element,
+            static_cast<std::size_t>(first - element)}});
+      first = skip_spaces(first + 1);
+    } else if (first != last && *first == '{') {
+      throw Client_exception{"cannot convert array to native type: "
+        "only one-dimensional array literals can be converted to containers "
+        "of std::string_view"};
+    } else {
+      // Like the general parser, the trailing spaces are kept.
+      while (first != last && *first != delimiter && *first != '}' &&
+        *first != '{' && *first != '"')
+        ++first;
+      const auto size = static_cast<std::size_t>(first - element);
+      if (!size || first == last || *first == '{' || *first == '"')
+        throw Client_exception{Client_errc::malformed_literal};
+      else if (size == 4 &&
+        (element[0] == 'n' || element[0] == 'N') &&
+        (element[1] == 'u' || element[1] == 'U') &&
+        (element[2] == 'l' || element[2] == 'L') &&
+        (element[3] == 'l' || element[3] == 'L')) {
+        if constexpr (Is_optional<E>::value)
+          result.push_back(E{});
+        else
+          throw Client_exception{Client_errc::improper_value_type};
+      } else
+        result.push_back(E{std::string_view{element, size}});
+    }
+
+    if (first == last)
+      throw Client_exception{Client_errc::malformed_literal};
+    else if (*first == '}')
+      return;
+    else if (*first != delimiter)
+      throw Client_exception{Client_errc::malformed_literal};
+    first = skip_spaces(first + 1);
+  }
+}
+
+template<class Container>
+bool parse_flat_array_literal(Container& result, const char* first,
+  const char* const last, const char delimiter)
+{
+  using E = typename Container::value_type;
+  using V = typename Is_optional<E>::Value_type;
+  if constexpr (std::is_same_v<V, std::string_view>) {
+    parse_flat_array_literal_of_views(result, first, last, delimiter);
+    return true;
+  } else if constexpr (!(is_numeric_conversions_v<V> ||
+      std::is_same_v<V, std::string>)) {
+    (void)result;
+    (void)first;
+    (void)last;
+    (void)delimiter;
+    return false;
+  } else {
+    DMITIGR_ASSERT(result.empty());
+    const auto skip_spaces = [last](const char* p) noexcept
+    {
+      while (p != last && str::is_space(*p))
+        ++p;
+      return p;
+    };
+
+    // Only one-dimensional array literals without quotes are parsed here.
+    first = skip_spaces(first);
+    if (first == last || *first != '{')
+      return false;
+    ++first;
+    std::size_t delimiter_count{};
+    const char* const end = scan_flat_array_literal(first, last, delimiter,
+      delimiter_count);
+    if (end == last || *end != '}')
+      return false;
+    else if (skip_spaces(first) == end)
+      return true;
+
+    if constexpr (Has_reserve<Container>::value)
+      result.reserve(delimiter_count + 1);
+    while (true) {
+      // Like the general parser, the trailing spaces are kept.
+      const char* const element = skip_spaces(first);
+      const char* const next = std::find(element, end, delimiter);
+      const auto size = static_cast<std::size_t>(next - element);
+      if (!size)
+        return false; // malformed literal is reported by the general parser
+      else if (size == 4 &&
+        (element[0] == 'n' || element[0] == 'N') &&
+        (element[1] == 'u' || element[1] == 'U') &&
+        (element[2] == 'l' || element[2] == 'L') &&
+        (element[3] == 'l' || element[3] == 'L')) {
+        if constexpr (Is_optional<E>::value)
+          result.push_back(E{});
+        else
+          throw Client_exception{Client_errc::improper_value_type};
+      } else if constexpr (std::is_same_v<V, std::string>)
+        result.push_back(E{V(element, size)});
+      else
+        result.push_back(E{Conversions<V>::to_type(Data_view{element, size,
+              Data_format::text})});
+
+      if (next == end)
+        return true;
+      first = next + 1;
+    }
+  }
+}
+
+/// The trait to detect (sub-)containers of arrays.
+template<typename T>
+struct Is_array_container final : std::false_type {};
+
+/// The partial specialization of Is_array_container.
+template<typename T,
+  template<class, class> class Container,
+  template<class> class Allocator>
+struct Is_array_container<Container<T, Allocator<T>>> final : std::true_type {};
+
+/// The full specialization of Is_array_container for `std::string`.
+template<>
+struct Is_array_container<std::string> final : std::false_type {};
+
+/// The full specialization of Is_array_container for `std::string_view`.
+template<>
+struct Is_array_container<std::string_view> final : std::false_type {};
+
+/// The full specialization of Is_array_container for `bytea` representation.
+template<>
+struct Is_array_container<std::vector<std::byte>> final : std::false_type {};
+
+/// The deepest (non-container) element type and dimensionality of array.
+template<typename T, bool = Is_array_container<T>::value>
+struct Array_deepest_element final {
+  using Type = T;
+  static constexpr int dimension_count{};
+};
+
+/// The partial specialization of Array_deepest_element for containers.
+template<typename T>
+struct Array_deepest_element<T, true> final {
+private:
+  using Next = Array_deepest_element<
+    typename Is_optional<typename T::value_type>::Value_type>;
+public:
+  using Type = typename Next::Type;
+  static constexpr int dimension_count{Next::dimension_count + 1};
+};
+
+/**
+ * @brief The base of Conversions of arrays.
+ *
+ * @details Provides `binary_oid` (the OID of the array type) if there is a
+ * specialization of Array_element_traits for the deepest element type.
+ */
+template<class Container, typename = void>
+struct Array_conversions_base {};
+
+/// The partial specialization of Array_conversions_base for known elements.
+template<class Container>
+struct Array_conversions_base<Container, std::void_t<decltype(
+    Array_element_traits<typename Array_deepest_element<Container>::Type>
+    ::array_oid)>> {
+  static constexpr Oid binary_oid{Array_element_traits<
+    typename Array_deepest_element<Container>::Type>::array_oid};
+};
+
+/// The reader of the PostgreSQL array in binary format.
+class Binary_array_reader final {
+public:
+  Binary_array_reader(const char* const bytes, const std::size_t size) noexcept
+    : pos_{bytes}
+    , end_{bytes + size}
+  {}
+
+  const char* read(const std::size_t size)
+  {
+    if (!(size <= static_cast<std::size_t>(end_ - pos_)))
+      throw Client_exception{"cannot convert array to native type: "
+        "unexpected end of binary data"};
+    const char* const result{pos_};
+    pos_ += size;
+    return result;
+  }
+
+  template<typename T>
+  T read()
+  {
+    return net::conv<T>(read(sizeof(T)), sizeof(T));
+  }
+
+  bool is_end() const noexcept
+  {
+    return pos_ == end_;
+  }
+
+private:
+  const char* pos_{};
+  const char* end_{};
+};
+
+/// The predicate to test if `T` is a number of a native binary array element.
+template<typename T>
+struct Is_binary_array_number final : std::integral_constant<bool,
+  (std::is_integral_v<T> && std::is_signed_v<T> &&
+    !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+    (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+  std::is_same_v<T, float> || std::is_same_v<T, double>> {};
+
+/// Fills the `container` from the array reader.
+template<class Container>
+void fill_container_from_binary(Container& container,
+  Binary_array_reader& reader, const std::int32_t* const dimensions)
+{
+  using E = typename Container::value_type;
+  using V = typename Is_optional<E>::Value_type;
+  for (std::int32_t i{}; i < dimensions[0]; ++i) {
+    if constexpr (Is_array_container<V>::value) {
+      V subcontainer;
+      fill_container_from_binary(subcontainer, reader, dimensions + 1);
+      container.insert(container.end(), E{std::move(subcontainer)});
+    } else {
+      const auto size = reader.read<std::int32_t>();
+      if (size < 0) {
+        if constexpr (Is_optional<E>::value)
+          container.insert(container.end(), E{});
+        else
+          throw Client_exception{Client_errc::improper_value_type};
+      } else {
+        const auto usize = static_cast<std::size_t>(size);
+        const char* const bytes{reader.read(usize)};
+        if constexpr (Is_binary_array_number<V>::value) {
+          // Fast path for the elements of int2[], int4[], int8[], float4[]
+          // and float8[] of the matching size: a single byte swapped load.
+          if (usize == sizeof(V)) {
+            container.insert(container.end(), E{load_big_endian<V>(bytes)});
+            continue;
+          }
+        }
+        const Data_view data{bytes, usize, Data_format::binary};
+        container.insert(container.end(), E{to<V>(data)});
+      }
+    }
+  }
+}
+
+template<class Container>
+Container binary_array_to_container(const Data& data)
+{
+  constexpr int dimension_count{
+    Array_deepest_element<Container>::dimension_count};
+  Binary_array_reader reader{static_cast<const char*>(data.bytes()), data.size()};
+  const auto ndim = reader.read<std::int32_t>();
+  reader.read<std::int32_t>(); // has null flag
+  reader.read<std::uint32_t>(); // element type OID
+  Container result;
+  if (!ndim)
+    return result;
+  else if (ndim > dimension_count)
+    throw Client_exception{Client_errc::insufficient_dimensionality};
+  else if (ndim < dimension_count)
+    throw Client_exception{Client_errc::excessive_dimensionality};
+
+  std::int32_t dimensions[dimension_count];
+  for (int i{}; i < dimension_count; ++i) {
+    dimensions[i] = reader.read<std::int32_t>();
+    reader.read<std::int32_t>(); // lower bound
+    if (dimensions[i] < 0)
+      throw Client_exception{"cannot convert array to native type: "
+        "invalid dimension size"};
+  }
+  fill_container_from_binary(result, reader, dimensions);
+  if (!reader.is_end())
+    throw Client_exception{"cannot convert array to native type: "
+      "unexpected trailing binary data"};
+  return result;
+}
+
+/// Determines the size of each dimension of the `container`.
+template<class Container>
+void binary_array_dimensions(const Container& container,
+  std::int32_t* const dimensions)
+{
+  using V = typename Is_optional<typename Container::value_type>::Value_type;
+  dimensions[0] = static_cast<std::int32_t>(container.size());
+  if constexpr (Is_array_container<V>::value) {
+    if (!container.empty()) {
+      const auto& first = *container.begin();
+      if constexpr (Is_optional<typename Container::value_type>::value) {
+        if (!first)
+          throw Client_exception{"cannot convert array to binary data: "
+            "null subarray"};
+        binary_array_dimensions(*first, dimensions + 1);
+      } else
+        binary_array_dimensions(first, dimensions + 1);
+    } else
+      dimensions[1] = 0;
+  }
+}
+
+/// Appends the elements of the `container` to the `result`.
+template<class Container>
+void append_binary_array_elements(std::string& result, bool& has_null,
+  const Container& container, const std::int32_t* const dimensions)
+{
+  using E = typename Container::value_type;
+  using V = typename Is_optional<E>::Value_type;
+  if (static_cast<std::int32_t>(container.size()) != dimensions[0])
+    throw Client_exception{"cannot convert array to binary data: "
+      "multidimensional arrays must have subarrays with matching dimensions"};
+
+  for (const auto& e : container) {
+    const V* value{};
+    if constexpr (Is_optional<E>::value) {
+      if (e)
+        value = &*e;
+    } else
+      value = &e;
+
+    if constexpr (Is_array_container<V>::value) {
+      if (!value)
+        throw Client_exception{"cannot convert array to binary data: "
+          "null subarray"};
+      append_binary_array_elements(result, has_null, *value, dimensions + 1);
+    } else {
+      char buf[sizeof(std::int32_t)];
+      if (value) {
+        const auto data = Array_element_traits<V>::to_data(*value);
+        net::copy(buf, static_cast<std::int32_t>(data->size()));
+        result.append(buf, sizeof(buf));
+        result.append(static_cast<const char*>(data->bytes()), data->size());
+      } else {
+        has_null = true;
+        net::copy(buf, std::int32_t{-1});
+        result.append(buf, sizeof(buf));
+      }
+    }
+  }
+}
+
+template<class Container>
+std::unique_ptr<Data> container_to_binary_array(const Container& container)
+{
+  using Deepest = Array_deepest_element<Container>;
+  constexpr int dimension_count{Deepest::dimension_count};
+  std::int32_t dimensions[dimension_count];
+  binary_array_dimensions(container, dimensions);
+  const bool is_empty = std::any_of(dimensions, dimensions + dimension_count,
+    [](const auto d){return !d;});
+
+  std::string result;
+  char buf[sizeof(std::int32_t)];
+  const auto append = [&result, &buf](const auto value)
+  {
+    static_assert(sizeof(value) == sizeof(buf));
+    net::copy(buf, value);
+    result.append(buf, sizeof(buf));
+  };
+  append(std::int32_t{is_empty ? 0 : dimension_count});
+  append(std::int32_t{}); // has null flag (will be updated below)
+  append(std::uint32_t{Array_element_traits<typename Deepest::Type>::oid});
+  if (!is_empty) {
+    for (int i{}; i < dimension_count; ++i) {
+      append(dimensions[i]);
+      append(std::int32_t{1}); // lower bound
+    }
+    bool has_null{};
+    append_binary_array_elements(result, has_null, container, dimensions);
+    if (has_null) {
+      net::copy(buf, std::int32_t{1});
+      result.replace(sizeof(buf), sizeof(buf), buf, sizeof(buf));
+    }
+  }
+  return Data::make(std::move(result), Data_format::binary);
+}
+
+// -----------------------------------------------------------------------------
+// Array literal generator
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Appends the quoted `element` to `result`.
+ *
+ * @details Quotes and backslashes of the element are escaped in one pass.
+ */
+inline void append_quoted_array_element(std::string& result,
+  const std::string_view element)
+{
+  result += '"';
+  const char* first{element.data()};
+  const char* const last{first + element.size()};
+  while (true) {
+    const char* const special = std::find_if(first, last,
+      [](const char c){return c == '"' || c == '\\';});
+    result.append(first, special);
+    if (special == last)
+      break;
+    result += '\\';
+    result += *special;
+    first = special + 1;
+  }
+  result += '"';
+}
+
+/// @returns The estimated size of the array literal of the `container`.
+template<class Container>
+std::size_t array_literal_size_hint(const Container& container) noexcept
+{
+  using E = typename Container::value_type;
+  using V = typename Is_optional<E>::Value_type;
+  std::size_t result{2 + container.size()};
+  if constexpr (Is_array_container<V>::value || std::is_same_v<V, std::string> ||
+    std::is_same_v<V, std::string_view>) {
+    for (const auto& e : container) {
+      const V* value{};
+      if constexpr (Is_optional<E>::value) {
+        if (e)
+          value = &*e;
+      } else
+        value = &e;
+
+      if (!value)
+        result += 4;
+      else if constexpr (Is_array_container<V>::value)
+        result += array_literal_size_hint(*value);
+      else
+        result += value->size() + 2;
+    }
+  } else
+    result += container.size() * 8;
+  return result;
+}
+
+/// Appends the array literal representation of the `value` to `result`.
+template<typename V, typename ... Types>
+void append_array_element(std::string& result, const V& value,
+  const char delimiter, Types&& ... args)
+{
+  if constexpr (Is_array_container<V>::value) {
+    // Subliterals shall not be quoted.
+    append_array_literal(result, value, delimiter, args...);
+  } else if constexpr (!sizeof...(args) && is_numeric_conversions_v<V>) {
+    char buf[64];
+    result.append(buf, numeric_to_chars(buf, buf + sizeof(buf), value));
+  } else if constexpr (!sizeof...(args) && (std::is_same_v<V, std::string> ||
+      std::is_same_v<V, std::string_view>))
+    append_quoted_array_element(result, value);
+  else
+    append_quoted_array_element(result, Conversions<V>::to_string(value,
+        args...));
+}
+
+template<class Container, typename ... Types>
+void append_array_literal(std::string& result, const Container& container,
+  const char delimiter, Types&& ... args)
+{
+  using E = typename Container::value_type;
+  result += '{';
+  bool is_first{true};
+  for (const auto& e : container) {
+    if (!is_first)
+      result += delimiter;
+    else
+      is_first = false;
+
+    if constexpr (Is_optional<E>::value) {
+      if (e)
+        append_array_element(result, *e, delimiter, args...);
+      else
+        result.append("NULL");
+    } else
+      append_array_element(result, e, delimiter, args...);
+  }
+  result += '}';
+}
+
+template<class Container, typename ... Types>
+std::string to_array_literal(const Container& container, const char delimiter,
+  Types&& ... args)
+{
+  std::string result;
+  result.reserve(array_literal_size_hint(container));
+  append_array_literal(result, container, delimiter,
+    std::forward<Types>(args)...);
+  return result;
+}
+
+template<class Container, typename ... Types>
+std::unique_ptr<Data> to_array_literal_data(const Container& container,
+  const char delimiter, Types&& ... args)
+{
+  // The storage of the literal is moved into the result.
+  return Data::make(to_array_literal(container, delimiter,
+      std::forward<Types>(args)...), Data_format::text);
+}
+
+template<typename> struct Md_array_builder;
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Md_array
+// -----------------------------------------------------------------------------
+
+template<typename> class Nullable_array;
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A multidimensional array with contiguous storage of the elements.
+ *
+ * @details The elements are stored in the row-major order in a single
+ * `std::vector<T>`. The dimensions and the lower bounds are stored separately,
+ * as well as the null bitmap, which is allocated only if there are nulls. The
+ * null elements are represented by the value-initialized `T` in the storage.
+ *
+ * @par Requires
+ * `T` must be default-constructible and must not be a container.
+ *
+ * @see Conversions<Md_array<T>>.
+ */
+template<typename T>
+class Md_array final {
+  static_assert(!detail::Is_array_container<T>::value,
+    "Md_array of containers is not supported");
+public:
+  /// The type of the elements.
+  using Value_type = T;
+
+  /// The maximum number of dimensions (as in PostgreSQL).
+  static constexpr std::size_t max_dimension_count{6};
+
+  /// Constructs the empty array.
+  Md_array() = default;
+
+  /**
+   * @brief Constructs the array of value-initialized elements with the
+   * lower bounds of 1.
+   *
+   * @par Requires
+   * `dimensions.size() <= max_dimension_count` and each dimension is
+   * non-negative.
+   */
+  explicit Md_array(std::vector<std::int32_t> dimensions)
+    : dimensions_{std::move(dimensions)}
+  {
+    const auto size = size_of(dimensions_);
+    if (!size)
+      dimensions_.clear();
+    lower_bounds_.assign(dimensions_.size(), 1);
+    values_.resize(size);
+  }
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `values.size()` is equal to the product of `dimensions`.
+   */
+  Md_array(std::vector<std::int32_t> dimensions, std::vector<T> values)
+    : dimensions_{std::move(dimensions)}
+    , values_{std::move(values)}
+  {
+    if (size_of(dimensions_) != values_.size())
+      throw Client_exception{"cannot create array: number of values doesn't "
+        "match the dimensions"};
+    if (values_.empty())
+      dimensions_.clear();
+    lower_bounds_.assign(dimensions_.size(), 1);
+  }
+
+  /// @returns The number of dimensions.
+  std::size_t dimension_count() const noexcept
+  {
+    return dimensions_.size();
+  }
+
+  /// @returns The sizes of dimensions.
+  const std::vector<std::int32_t>& dimensions() const noexcept
+  {
+    return dimensions_;
+  }
+
+  /// @returns The lower bounds of dimensions.
+  const std::vector<std::int32_t>& lower_bounds() const noexcept
+  {
+    return lower_bounds_;
+  }
+
+  /**
+   * @brief Sets the lower bounds of dimensions.
+   *
+   * @par Requires
+   * `lower_bounds.size() == dimension_count()`.
+   */
+  void set_lower_bounds(std::vector<std::int32_t> lower_bounds)
+  {
+    if (lower_bounds.size() != dimensions_.size())
+      throw Client_exception{"cannot set lower bounds of array: invalid "
+        "number of lower bounds"};
+    lower_bounds_ = std::move(lower_bounds);
+  }
+
+  /// @returns The total number of elements.
+  std::size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  /// @returns `(size() == 0)`.
+  bool is_empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  /**
+   * @returns The index of the element at the zero-based position `subscripts`
+   * in the storage.
+   *
+   * @par Requires
+   * `subscripts.size() == dimension_count()` and each subscript is less than
+   * the size of the corresponding dimension.
+   */
+  std::size_t index_of(const std::initializer_list<std::size_t> subscripts) const
+  {
+    if (subscripts.size() != dimensions_.size())
+      throw Client_exception{"cannot get element of array: invalid number of "
+        "subscripts"};
+    std::size_t result{};
+    auto d = dimensions_.cbegin();
+    for (const auto subscript : subscripts) {
+      const auto dimension = static_cast<std::size_t>(*d++);
+      if (!(subscript < dimension))
+        throw Client_exception{"cannot get element of array: subscript out "
+          "of range"};
+      result = result * dimension + subscript;
+    }
+    return result;
+  }
+
+  /**
+   * @returns The element at the `index` in the storage.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  const T& operator[](const std::size_t index) const
+  {
+    DMITIGR_ASSERT(index < size());
+    return values_[index];
+  }
+
+  /// @overload
+  T& operator[](const std::size_t index)
+  {
+    return const_cast<T&>(static_cast<const Md_array&>(*this)[index]);
+  }
+
+  /// @returns The element at the zero-based position `subscripts`.
+  const T& at(const std::initializer_list<std::size_t> subscripts) const
+  {
+    return values_[index_of(subscripts)];
+  }
+
+  /// @overload
+  T& at(const std::initializer_list<std::size_t> subscripts)
+  {
+    return values_[index_of(subscripts)];
+  }
+
+  /// @returns The elements in the row-major order.
+  const std::vector<T>& values() const noexcept
+  {
+    return values_;
+  }
+
+  /// @returns The pointer to the first element.
+  T* data() noexcept
+  {
+    return values_.data();
+  }
+
+  /// @overload
+  const T* data() const noexcept
+  {
+    return values_.data();
+  }
+
+  /// @returns `true` if there is at least one null element.
+  bool has_nulls() const noexcept
+  {
+    return std::find(nulls_.cbegin(), nulls_.cend(), true) != nulls_.cend();
+  }
+
+  /**
+   * @returns `true` if the element at the `index` is null.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  bool is_null(const std::size_t index) const
+  {
+    DMITIGR_ASSERT(index < size());
+    return index < nulls_.size() && nulls_[index];
+  }
+
+  /**
+   * @brief Marks the element at the `index` as null or as non-null.
+   *
+   * @details If the element is marked as null its value is reset.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  void set_null(const std::size_t index, const bool value = true)
+  {
+    DMITIGR_ASSERT(index < size());
+    if (value) {
+      nulls_.resize(values_.size());
+      nulls_[index] = true;
+      values_[index] = T{};
+    } else if (index < nulls_.size())
+      nulls_[index] = false;
+  }
+
+  /// @returns `true` if `lhs` is equal to `rhs`.
+  friend bool operator==(const Md_array& lhs, const Md_array& rhs)
+  {
+    if (lhs.dimensions_ != rhs.dimensions_ ||
+      lhs.lower_bounds_ != rhs.lower_bounds_ || lhs.values_ != rhs.values_)
+      return false;
+    for (std::size_t i{}; i < lhs.size(); ++i)
+      if (lhs.is_null(i) != rhs.is_null(i))
+        return false;
+    return true;
+  }
+
+  /// @returns `!(lhs == rhs)`.
+  friend bool operator!=(const Md_array& lhs, const Md_array& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  template<typename> friend struct detail::Md_array_builder;
+
+  std::vector<std::int32_t> dimensions_;
+  std::vector<std::int32_t> lower_bounds_;
+  std::vector<T> values_;
+  std::vector<bool> nulls_; // no more elements than values_
+
+  static std::size_t size_of(const std::vector<std::int32_t>& dimensions)
+  {
+    if (dimensions.size() > max_dimension_count)
+      throw Client_exception{"cannot create array: too many dimensions"};
+    std::size_t result{!dimensions.empty()};
+    for (const auto d : dimensions) {
+      if (d < 0)
+        throw Client_exception{"cannot create array: invalid dimension size"};
+      result *= static_cast<std::size_t>(d);
+    }
+    return result;
+  }
+};
+
+namespace detail {
+
+/// The builder of Md_array from the PostgreSQL array representations.
+template<typename T>
+struct Md_array_builder final {
+  Md_array<T> result;
+
+  // ---------------------------------------------------------------------------
+  // Binary format
+  // ---------------------------------------------------------------------------
+
+  void from_binary(const Data& data)
+  {
+    Binary_array_reader reader{static_cast<const char*>(data.bytes()),
+      data.size()};
+    const auto ndim = reader.read<std::int32_t>();
+    reader.read<std::int32_t>(); // has null flag
+    reader.read<std::uint32_t>(); // element type OID
+    if (ndim < 0 ||
+      static_cast<std::size_t>(ndim) > Md_array<T>::max_dimension_count)
+      throw Client_exception{"cannot convert array to native type: "
+        "invalid number of dimensions"};
+
+    std::size_t size{ndim > 0};
+    for (std::int32_t i{}; i < ndim; ++i) {
+      const auto dimension = reader.read<std::int32_t>();
+      if (dimension < 0)
+        throw Client_exception{"cannot convert array to native type: "
+          "invalid dimension size"};
+      result.dimensions_.push_back(dimension);
+      result.lower_bounds_.push_back(reader.read<std::int32_t>());
+      size *= static_cast<std::size_t>(dimension);
+    }
+    if (!size) {
+      result.dimensions_.clear();
+      result.lower_bounds_.clear();
+    }
+
+    result.values_.reserve(size);
+    for (std::size_t i{}; i < size; ++i) {
+      const auto element_size = reader.read<std::int32_t>();
+      if (element_size < 0)
+        push_null();
+      else {
+        const auto usize = static_cast<std::size_t>(element_size);
+        result.values_.push_back(Conversions<T>::to_type(
+            Data_view{reader.read(usize), usize, Data_format::binary}));
+      }
+    }
+    if (!reader.is_end())
+      throw Client_exception{"cannot convert array to native type: "
+        "unexpected trailing binary data"};
+  }
+
+  // ---------------------------------------------------------------------------
+  // Text format
+  // ---------------------------------------------------------------------------
+
+  template<typename ... Types>
+  void from_text(const char* literal, const char delimiter, Types&& ... args)
+  {
+    // Parse the optional decoration of dimensions, such as "[0:1][1:2]=".
+    std::vector<std::int32_t> decorated_dimensions;
+    literal = str::next_non_space_pointer(literal);
+    if (*literal == '[') {
+      const auto parse_int = [&literal]
+      {
+        const char* const end = literal + std::strlen(literal);
+        std::int32_t value{};
+        const auto [ptr, ec] = std::from_chars(literal, end, value);
+        if (ec != std::errc{})
+          throw Client_exception{Client_errc::malformed_literal};
+        literal = ptr;
+        return value;
+      };
+      while (*literal == '[') {
+        ++literal;
+        const auto lower = parse_int();
+        if (*literal++ != ':')
+          throw Client_exception{Client_errc::malformed_literal};
+        const auto upper = parse_int();
+        if (*literal++ != ']' || upper < lower - 1)
+          throw Client_exception{Client_errc::malformed_literal};
+        result.lower_bounds_.push_back(lower);
+        decorated_dimensions.push_back(upper - lower + 1);
+      }
+      if (*literal++ != '=')
+        throw Client_exception{Client_errc::malformed_literal};
+    }
+
+    // The number of delimiters is the upper bound of the number of elements.
+    result.values_.reserve(static_cast<std::size_t>(std::count(literal,
+      literal + std::strlen(literal), delimiter)) + 1);
+    parse_array_literal(literal, delimiter, *this,
+      std::forward<Types>(args)...);
+    close_subarrays(0);
+    if (!element_depth_)
+      result.dimensions_.clear();
+
+    if (decorated_dimensions.empty())
+      result.lower_bounds_.assign(result.dimensions_.size(), 1);
+    else if (decorated_dimensions != result.dimensions_)
+      throw Client_exception{"cannot convert array to native type: "
+        "dimensions of array don't match the dimensions decoration"};
+  }
+
+  /// Called by parse_array_literal() on the opening of the subarray.
+  void operator()(const int level)
+  {
+    const auto ulevel = static_cast<std::size_t>(level);
+    if (element_depth_ && ulevel >= element_depth_)
+      throw Client_exception{Client_errc::malformed_literal};
+    else if (!(ulevel < Md_array<T>::max_dimension_count))
+      throw Client_exception{"cannot convert array to native type: "
+        "too many dimensions"};
+
+    close_subarrays(ulevel);
+    if (ulevel)
+      ++counts_[ulevel - 1];
+    counts_.push_back(0);
+    if (result.dimensions_.size() < counts_.size())
+      result.dimensions_.push_back(-1);
+  }
+
+  /// Called by parse_array_literal() on the elements.
+  template<typename ... Types>
+  void operator()(std::string&& value, const bool is_null, const int depth,
+    Types&& ... args)
+  {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      // The view of the temporary element would dangle.
+      throw Client_exception{"cannot convert array literal to Md_array of "
+        "std::string_view: use Data_format::binary"};
+    }
+
+    const auto udepth = static_cast<std::size_t>(depth);
+    if (!element_depth_)
+      element_depth_ = udepth;
+    close_subarrays(udepth);
+    if (udepth != element_depth_ || result.dimensions_.size() != udepth)
+      throw Client_exception{Client_errc::malformed_literal};
+
+    ++counts_[udepth - 1];
+    if (is_null)
+      push_null();
+    else
+      result.values_.push_back(Conversions<T>::to_type(std::move(value),
+          std::forward<Types>(args)...));
+  }
+
+  /**
+   * @returns The one-dimensional array.
+   *
+   * @throws Client_exception with code Client_errc::excessive_dimensionality
+   * if the result is multidimensional.
+   */
+  Nullable_array<T> to_nullable_array() &&
+  {
+    if (result.dimension_count() > 1)
+      throw Client_exception{Client_errc::excessive_dimensionality};
+    return Nullable_array<T>{std::move(result.values_),
+      std::move(result.nulls_)};
+  }
+
+private:
+  std::vector<std::int32_t> counts_;
+  std::size_t element_depth_{};
+
+  void push_null()
+  {
+    result.values_.emplace_back();
+    result.nulls_.resize(result.values_.size());
+    result.nulls_.back() = true;
+  }
+
+  void close_subarrays(const std::size_t level)
+  {
+    while (counts_.size() > level) {
+      auto& dimension = result.dimensions_[counts_.size() - 1];
+      if (dimension < 0)
+        dimension = counts_.back();
+      else if (dimension != counts_.back())
+        throw Client_exception{"cannot convert array to native type: "
+          "multidimensional arrays must have subarrays with matching dimensions"};
+      counts_.pop_back();
+    }
+  }
+};
+
+/// Appends the literal of the subarray of `array` at `level` to `result`.
+template<typename T, typename ... Types>
+void append_md_array_literal(std::string& result, const Md_array<T>& array,
+  const std::size_t level, std::size_t& index, const char delimiter,
+  Types&& ... args)
+{
+  const auto is_deepest = level + 1 == array.dimension_count();
+  result += '{';
+  for (std::int32_t i{}; i < array.dimensions()[level]; ++i) {
+    if (i)
+      result += delimiter;
+    if (!is_deepest)
+      append_md_array_literal(result, array, level + 1, index, delimiter,
+        args...);
+    else {
+      if (array.is_null(index))
+        result.append("NULL");
+      else
+        append_array_element(result, array[index], delimiter, args...);
+      ++index;
+    }
+  }
+  result += '}';
+}
+
+/// @returns The PostgreSQL array literal of `array`.
+template<typename T, typename ... Types>
+std::string md_array_to_literal(const Md_array<T>& array, const char delimiter,
+  Types&& ... args)
+{
+  std::string result;
+  if (array.is_empty())
+    return result.append("{}");
+
+  result.reserve(array.size() * 8 + 2);
+  const auto& lower_bounds = array.lower_bounds();
+  if (std::any_of(lower_bounds.cbegin(), lower_bounds.cend(),
+      [](const auto b){return b != 1;})) {
+    char buf[32];
+    for (std::size_t i{}; i < array.dimension_count(); ++i) {
+      const auto lower = lower_bounds[i];
+      result.append(1, '[')
+        .append(buf, numeric_to_chars(buf, buf + sizeof(buf), lower))
+        .append(1, ':')
+        .append(buf, numeric_to_chars(buf, buf + sizeof(buf),
+            lower + array.dimensions()[i] - 1))
+        .append(1, ']');
+    }
+    result += '=';
+  }
+  std::size_t index{};
+  append_md_array_literal(result, array, 0, index, delimiter,
+    std::forward<Types>(args)...);
+  return result;
+}
+
+/**
+ * @returns The PostgreSQL array in Data_format::binary format of the flat
+ * `array` (Md_array or Nullable_array) of the specified shape.
+ */
+template<typename T, class Array>
+std::unique_ptr<Data> flat_array_to_binary(const Array& array,
+  const std::vector<std::int32_t>& dimensions,
+  const std::vector<std::int32_t>& lower_bounds)
+{
+  DMITIGR_ASSERT(dimensions.size() == lower_bounds.size());
+  std::string result;
+  char buf[sizeof(std::int32_t)];
+  const auto append = [&result, &buf](const auto value)
+  {
+    static_assert(sizeof(value) == sizeof(buf));
+    net::copy(buf, value);
+    result.append(buf, sizeof(buf));
+  };
+  append(static_cast<std::int32_t>(dimensions.size()));
+  append(std::int32_t{array.has_nulls()});
+  append(std::uint32_t{Array_element_traits<T>::oid});
+  for (std::size_t i{}; i < dimensions.size(); ++i) {
+    append(dimensions[i]);
+    append(lower_bounds[i]);
+  }
+  for (std::size_t i{}; i < array.size(); ++i) {
+    if (array.is_null(i))
+      append(std::int32_t{-1});
+    else {
+      const auto data = Array_element_traits<T>::to_data(array[i]);
+      append(static_cast<std::int32_t>(data->size()));
+      result.append(static_cast<const char*>(data->bytes()), data->size());
+    }
+  }
+  return Data::make(std::move(result), Data_format::binary);
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Nullable_array
+// -----------------------------------------------------------------------------
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A one-dimensional array of nullable elements with contiguous storage
+ * of the values.
+ *
+ * @details Unlike `std::vector<std::optional<T>>`, the values are stored in a
+ * `std::vector<T>` and the nulls are stored in a separate bitmap, which is
+ * allocated only if there are nulls. The null elements are represented by the
+ * value-initialized `T` in the storage of values.
+ *
+ * @par Requires
+ * `T` must be default-constructible and must not be a container.
+ *
+ * @see Conversions<Nullable_array<T>>.
+ */
+template<typename T>
+class Nullable_array final {
+  static_assert(!detail::Is_array_container<T>::value,
+    "Nullable_array of containers is not supported");
+public:
+  /// The type of the elements.
+  using Value_type = T;
+
+  /// Constructs the empty array.
+  Nullable_array() = default;
+
+  /// Constructs the array of non-null `values`.
+  explicit Nullable_array(std::vector<T> values) noexcept
+    : values_{std::move(values)}
+  {}
+
+  /**
+   * @brief Constructs the array of `values` with the null bitmap `nulls`.
+   *
+   * @par Requires
+   * `(nulls.size() <= values.size())`.
+   */
+  Nullable_array(std::vector<T> values, std::vector<bool> nulls)
+    : values_{std::move(values)}
+    , nulls_{std::move(nulls)}
+  {
+    if (nulls_.size() > values_.size())
+      throw Client_exception{"cannot create array: null bitmap is larger "
+        "than the number of values"};
+  }
+
+  /// @returns The number of elements.
+  std::size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  /// @returns `(size() == 0)`.
+  bool is_empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  /// Reserves the storage for `size` elements.
+  void reserve(const std::size_t size)
+  {
+    values_.reserve(size);
+  }
+
+  /// Removes all the elements.
+  void clear() noexcept
+  {
+    values_.clear();
+    nulls_.clear();
+  }
+
+  /// Appends the non-null `value`.
+  void push_back(T value)
+  {
+    values_.push_back(std::move(value));
+  }
+
+  /// Appends the null element.
+  void push_back_null()
+  {
+    values_.emplace_back();
+    nulls_.resize(values_.size());
+    nulls_.back() = true;
+  }
+
+  /**
+   * @returns The element at the `index`.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  const T& operator[](const std::size_t index) const
+  {
+    DMITIGR_ASSERT(index < size());
+    return values_[index];
+  }
+
+  /// @overload
+  T& operator[](const std::size_t index)
+  {
+    return const_cast<T&>(static_cast<const Nullable_array&>(*this)[index]);
+  }
+
+  /// @returns The values (the nulls are represented by the value-initialized `T`).
+  const std::vector<T>& values() const noexcept
+  {
+    return values_;
+  }
+
+  /// @returns The released values.
+  std::vector<T> release_values() noexcept
+  {
+    nulls_.clear();
+    return std::move(values_);
+  }
+
+  /// @returns The pointer to the first value.
+  T* data() noexcept
+  {
+    return values_.data();
+  }
+
+  /// @overload
+  const T* data() const noexcept
+  {
+    return values_.data();
+  }
+
+  /**
+   * @returns The null bitmap.
+   *
+   * @remarks The elements beyond the size of the bitmap are non-null.
+   */
+  const std::vector<bool>& nulls() const noexcept
+  {
+    return nulls_;
+  }
+
+  /// @returns `true` if there is at least one null element.
+  bool has_nulls() const noexcept
+  {
+    return std::find(nulls_.cbegin(), nulls_.cend(), true) != nulls_.cend();
+  }
+
+  /**
+   * @returns `true` if the element at the `index` is null.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  bool is_null(const std::size_t index) const
+  {
+    DMITIGR_ASSERT(index < size());
+    return index < nulls_.size() && nulls_[index];
+  }
+
+  /**
+   * @brief Marks the element at the `index` as null or as non-null.
+   *
+   * @details If the element is marked as null its value is reset.
+   *
+   * @par Requires
+   * `(index < size())`.
+   */
+  void set_null(const std::size_t index, const bool value = true)
+  {
+    DMITIGR_ASSERT(index < size());
+    if (value) {
+      nulls_.resize(values_.size());
+      nulls_[index] = true;
+      values_[index] = T{};
+    } else if (index < nulls_.size())
+      nulls_[index] = false;
+  }
+
+  /// @returns `true` if `lhs` is equal to `rhs`.
+  friend bool operator==(const Nullable_array& lhs, const Nullable_array& rhs)
+  {
+    if (lhs.values_ != rhs.values_)
+      return false;
+    for (std::size_t i{}; i < lhs.size(); ++i)
+      if (lhs.is_null(i) != rhs.is_null(i))
+        return false;
+    return true;
+  }
+
+  /// @returns `!(lhs == rhs)`.
+  friend bool operator!=(const Nullable_array& lhs, const Nullable_array& rhs)
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  std::vector<T> values_;
+  std::vector<bool> nulls_; // no more elements than values_
+};
+
+namespace detail {
+
+/**
+ * @brief The adapter of Nullable_array to the interface of the container of
+ * optionals required by parse_flat_array_literal().
+ */
+template<typename T>
+class Nullable_array_inserter final {
+public:
+  using value_type = std::optional<T>;
+
+  explicit Nullable_array_inserter(Nullable_array<T>& array) noexcept
+    : array_{array}
+  {}
+
+  bool empty() const noexcept
+  {
+    return array_.is_empty();
+  }
+
+  void reserve(const std::size_t size)
+  {
+    array_.reserve(size);
+  }
+
+  void push_back(value_type&& value)
+  {
+    if (value)
+      array_.push_back(std::move(*value));
+    else
+      array_.push_back_null();
+  }
+
+private:
+  Nullable_array<T>& array_;
+};
+
+/// @returns The PostgreSQL array literal of `array`.
+template<typename T, typename ... Types>
+std::string nullable_array_to_literal(const Nullable_array<T>& array,
+  const char delimiter, Types&& ... args)
+{
+  std::string result;
+  result.reserve(array.size() * 8 + 2);
+  result += '{';
+  for (std::size_t i{}; i < array.size(); ++i) {
+    if (i)
+      result += delimiter;
+    if (array.is_null(i))
+      result.append("NULL");
+    else
+      append_array_element(result, array[i], delimiter, args...);
+  }
+  result += '}';
+  return result;
+}
+
+} // namespace detail
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The partial specialization of Conversions for nullable arrays (i.e.
+ * containers with optional values).
+ *
+ * @details The support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called, for the elements of types
+ *   for which there is a specialization of detail::Array_element_traits).
+ *
+ * For such elements `binary_oid` is defined as the OID of the array type, so
+ * the arrays of binary format can be passed as parameters without explicit
+ * type casts (see binary_argument()).
+ *
+ * @par Requirements
+ * @parblock
+ * Requirements to the type T of elements of array:
+ *   - default-constructible, copy-constructible;
+ *   - convertible (there shall be a suitable specialization of Conversions).
+ *
+ * Requirements to the type Optional:
+ *   - default-constructible, copy-constructible;
+ *   - implemented operator bool() that returns `true` if the value is not null,
+ *   or `false` otherwise. (For default constructed Optional<T> it should return
+ *   `false`);
+ *   - implemented operator*() that returns a reference to the value of type `T`.
+ * @endparblock
+ *
+ * @tparam T The type of the elements of the Container (which may be a container
+ * of optionals).
+ * @tparam Optional The optional template class, such as `std::optional`.
+ * @tparam Container The container template class, such as `std::vector`.
+ * @tparam Allocator The allocator template class, such as `std::allocator`.
+ */
+template<typename T,
+  template<class> class Optional,
+  template<class, class> class Container,
+  template<class> class Allocator>
+struct Conversions<Container<Optional<T>, Allocator<Optional<T>>>> final
+  : Basic_conversions<Container<Optional<T>, Allocator<Optional<T>>>,
+      detail::Array_string_conversions_opts<Container<Optional<T>,
+                                              Allocator<Optional<T>>>>,
+      detail::Array_data_conversions_opts<Container<Optional<T>,
+                                            Allocator<Optional<T>>>>>
+  , detail::Array_conversions_base<Container<Optional<T>,
+      Allocator<Optional<T>>>> {};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The partial specialization of Conversions for non-nullable arrays.
+ *
+ * @details The support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called, for the elements of types
+ *   for which there is a specialization of detail::Array_element_traits).
+ *
+ * For such elements `binary_oid` is defined as the OID of the array type, so
+ * the arrays of binary format can be passed as parameters without explicit
+ * type casts (see binary_argument()).
+ *
+ * @par Requirements
+ * @parblock
+ * Requirements to the type T of elements of array:
+ *   - default-constructible, copy-constructible;
+ *   - convertible (there shall be a suitable specialization of Conversions).
+ * @endparblock
+ *
+ * @tparam T The type of the elements of the Container (which may be a container).
+ * @tparam Container The container template class, such as `std::vector`.
+ * @tparam Allocator The allocator template class, such as `std::allocator`.
+ *
+ * @throws Client_exception with code Client_errc::improper_value_type when
+ * converting the PostgreSQL array representations with at least one NULL element.
+ */
+template<typename T,
+  template<class, class> class Container,
+  template<class> class Allocator>
+struct Conversions<Container<T, Allocator<T>>>
+  : Basic_conversions<Container<T, Allocator<T>>,
+      detail::Array_string_conversions_vals<Container<T, Allocator<T>>>,
+      detail::Array_data_conversions_vals<Container<T, Allocator<T>>>>
+  , detail::Array_conversions_base<Container<T, Allocator<T>>> {};
+
+/**
+ * @brief The partial specialization of Conversions for non-nullable arrays.
+ *
+ * @details This is a workaround for GCC. When using multidimensional STL-containers
+ * GCC (at least version 8.1) incorrectly choises the specialization of
+ * `Conversions<Container<Optional<T>, Allocator<Optional<T>>>>` by deducing
+ * `Optional` as an STL container, instead of choising
+ * `Conversions<Container<T>, Allocator<T>>` and thus, the nested vector in
+ * `std::vector<std::vector<int>>` treated as `Optional`.
+ */
+template<typename T,
+  template<class, class> class Container,
+  template<class, class> class Subcontainer,
+  template<class> class ContainerAllocator,
+  template<class> class SubcontainerAllocator>
+struct Conversions<Container<Subcontainer<T, SubcontainerAllocator<T>>,
+                     ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>>
+  : Basic_conversions<
       Container<Subcontainer<T, SubcontainerAllocator<T>>,
         ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>,
       detail::Array_string_conversions_vals<
@@ -898,7 +2539,162 @@ struct Conversions<Container<Subcontainer<T, SubcontainerAllocator<T>>,
           ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>>,
       detail::Array_data_conversions_vals<
         Container<Subcontainer<T, SubcontainerAllocator<T>>,
-          ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>>> {};
+          ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>>>
+  , detail::Array_conversions_base<
+      Container<Subcontainer<T, SubcontainerAllocator<T>>,
+        ContainerAllocator<Subcontainer<T, SubcontainerAllocator<T>>>>> {};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The partial specialization of Conversions for Md_array.
+ *
+ * @details The support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called, for the elements of types
+ *   for which there is a specialization of detail::Array_element_traits).
+ *
+ * @remarks The resulting array is built with a single allocation of the storage
+ * of the elements (unless the literal contains nulls).
+ */
+template<typename T>
+struct Conversions<Md_array<T>> final {
+  using Type = Md_array<T>;
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ... args)
+  {
+    detail::Md_array_builder<T> builder;
+    if (data.format() == Data_format::binary)
+      builder.from_binary(data);
+    else
+      builder.from_text(static_cast<const char*>(data.bytes()), ',',
+        std::forward<Types>(args)...);
+    return std::move(builder.result);
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ... args)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert array to native type: "
+        "null data given"};
+    return to_type(*data, std::forward<Types>(args)...);
+  }
+
+  template<typename ... Types>
+  static Type to_type(const std::string& literal, Types&& ... args)
+  {
+    detail::Md_array_builder<T> builder;
+    builder.from_text(literal.c_str(), ',', std::forward<Types>(args)...);
+    return std::move(builder.result);
+  }
+
+  template<typename ... Types>
+  static std::string to_string(const Type& value, Types&& ... args)
+  {
+    return detail::md_array_to_literal(value, ',', std::forward<Types>(args)...);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ... args)
+  {
+    return Data::make(to_string(value, std::forward<Types>(args)...),
+      Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    return format == Data_format::binary ?
+      detail::flat_array_to_binary<T>(value, value.dimensions(),
+        value.lower_bounds()) : to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The partial specialization of Conversions for Nullable_array.
+ *
+ * @details The support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called, for the elements of types
+ *   for which there is a specialization of detail::Array_element_traits).
+ *
+ * @throws Client_exception with code Client_errc::excessive_dimensionality
+ * when converting the PostgreSQL representations of multidimensional arrays.
+ */
+template<typename T>
+struct Conversions<Nullable_array<T>> final {
+  using Type = Nullable_array<T>;
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ... args)
+  {
+    const auto* const literal = static_cast<const char*>(data.bytes());
+    if constexpr (!sizeof...(args)) {
+      if (data.format() == Data_format::text) {
+        Type result;
+        detail::Nullable_array_inserter<T> inserter{result};
+        if (detail::parse_flat_array_literal(inserter, literal,
+            literal + data.size(), ','))
+          return result;
+      }
+    }
+
+    detail::Md_array_builder<T> builder;
+    if (data.format() == Data_format::binary)
+      builder.from_binary(data);
+    else
+      builder.from_text(literal, ',', std::forward<Types>(args)...);
+    return std::move(builder).to_nullable_array();
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ... args)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert array to native type: "
+        "null data given"};
+    return to_type(*data, std::forward<Types>(args)...);
+  }
+
+  template<typename ... Types>
+  static Type to_type(const std::string& literal, Types&& ... args)
+  {
+    return to_type(Data_view{literal.data(), literal.size()},
+      std::forward<Types>(args)...);
+  }
+
+  template<typename ... Types>
+  static std::string to_string(const Type& value, Types&& ... args)
+  {
+    return detail::nullable_array_to_literal(value, ',',
+      std::forward<Types>(args)...);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ... args)
+  {
+    return Data::make(to_string(value, std::forward<Types>(args)...),
+      Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::binary) {
+      return value.is_empty() ?
+        detail::flat_array_to_binary<T>(value, {}, {}) :
+        detail::flat_array_to_binary<T>(value,
+          {static_cast<std::int32_t>(value.size())}, {1});
+    } else
+      return to_data(value);
+  }
+};
 
 } // namespace dmitigr::pgfe
 
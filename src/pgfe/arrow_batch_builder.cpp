@@ -0,0 +1,488 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../net/conversions.hpp"
+#include "arrow_batch_builder.hpp"
+#include "conversions.hpp"
+#include "copy_reader.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "row_batch.hpp"
+
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// The data of the exported Arrow array.
+struct Arrow_array_private final {
+  std::vector<std::uint8_t> validity;
+  std::vector<char> values;
+  std::vector<std::int32_t> offsets;
+  std::vector<const void*> buffers;
+  std::vector<ArrowArray> children;
+  std::vector<ArrowArray*> child_pointers;
+};
+
+/// The data of the exported Arrow schema.
+struct Arrow_schema_private final {
+  std::string name;
+  std::vector<ArrowSchema> children;
+  std::vector<ArrowSchema*> child_pointers;
+};
+
+/// The release callback of the exported Arrow array.
+inline void release_arrow_array(ArrowArray* const array) noexcept
+{
+  auto* const p = static_cast<Arrow_array_private*>(array->private_data);
+  for (auto* const child : p->child_pointers) {
+    if (child->release)
+      child->release(child);
+  }
+  delete p;
+  array->release = nullptr;
+}
+
+/// The release callback of the exported Arrow schema.
+inline void release_arrow_schema(ArrowSchema* const schema) noexcept
+{
+  auto* const p = static_cast<Arrow_schema_private*>(schema->private_data);
+  for (auto* const child : p->child_pointers) {
+    if (child->release)
+      child->release(child);
+  }
+  delete p;
+  schema->release = nullptr;
+}
+
+/// The buffer to export instead of the empty ones.
+inline const std::int64_t arrow_empty_buffer{};
+
+[[noreturn]] inline void throw_arrow_invalid_size()
+{
+  throw Client_exception{"cannot append data to Arrow batch: invalid data size"};
+}
+
+/// @returns The days since the Unix epoch of `date` data.
+inline std::int32_t arrow_date32(const Data& data)
+{
+  using Limits32 = std::numeric_limits<std::int32_t>;
+  if (data.format() == Data_format::binary) {
+    if (data.size() != 4)
+      throw_arrow_invalid_size();
+    const auto days = net::conv<std::int32_t>(data.bytes(), data.size());
+    return days == Limits32::max() || days == Limits32::min() ? days :
+      days + pg_epoch_offset_days;
+  }
+
+  using Limits = std::numeric_limits<std::int64_t>;
+  const auto us = timestamp_from_string({static_cast<const char*>(data.bytes()),
+      data.size()});
+  if (us == Limits::max())
+    return Limits32::max();
+  else if (us == Limits::min())
+    return Limits32::min();
+  else
+    return static_cast<std::int32_t>(us >= 0 ? us / us_per_day :
+      (us - us_per_day + 1) / us_per_day);
+}
+
+/// @returns The microseconds since the Unix epoch of `timestamp[tz]` data.
+inline std::int64_t arrow_timestamp(const Data& data)
+{
+  if (data.format() == Data_format::binary) {
+    using Limits = std::numeric_limits<std::int64_t>;
+    if (data.size() != 8)
+      throw_arrow_invalid_size();
+    const auto us = net::conv<std::int64_t>(data.bytes(), data.size());
+    return us == Limits::max() || us == Limits::min() ? us :
+      us + pg_epoch_offset_us;
+  } else
+    return timestamp_from_string({static_cast<const char*>(data.bytes()),
+      data.size()});
+}
+
+template<typename T>
+inline void arrow_store(char* const dest, const T value) noexcept
+{
+  std::memcpy(dest, &value, sizeof(value));
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Arrow_batch_builder::~Arrow_batch_builder() = default;
+
+DMITIGR_PGFE_INLINE
+Arrow_batch_builder::Arrow_batch_builder(std::vector<Field> fields)
+  : fields_{std::move(fields)}
+{
+  if (fields_.empty())
+    throw Client_exception{"cannot create Arrow batch builder: no fields"};
+
+  columns_ = make_columns(fields_);
+}
+
+DMITIGR_PGFE_INLINE
+Arrow_batch_builder::Arrow_batch_builder(const Row_info& info)
+  : Arrow_batch_builder{[&info]
+  {
+    std::vector<Field> result;
+    result.reserve(info.field_count());
+    for (std::size_t i{}; i < info.field_count(); ++i)
+      result.push_back(Field{std::string{info.field_name(i)},
+        static_cast<Oid>(info.type_oid(i)), info.data_format(i)});
+    return result;
+  }()}
+{}
+
+DMITIGR_PGFE_INLINE auto Arrow_batch_builder::fields() const noexcept
+  -> const std::vector<Field>&
+{
+  return fields_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Arrow_batch_builder::row_count() const noexcept
+{
+  return row_count_;
+}
+
+DMITIGR_PGFE_INLINE void Arrow_batch_builder::append(const Row_batch& batch)
+{
+  if (!batch || batch.field_count() != fields_.size())
+    throw Client_exception{"cannot append rows to Arrow batch: "
+      "invalid row batch"};
+
+  const auto row_count = batch.row_count();
+  try {
+    for (std::size_t f{}; f < fields_.size(); ++f) {
+      for (std::size_t r{}; r < row_count; ++r) {
+        const auto data = batch.data(r, f);
+        append(f, data ? &data : nullptr);
+      }
+    }
+  } catch (...) {
+    rollback();
+    throw;
+  }
+  row_count_ += row_count;
+}
+
+DMITIGR_PGFE_INLINE void Arrow_batch_builder::append(const Row& row)
+{
+  if (!row || row.field_count() != fields_.size())
+    throw Client_exception{"cannot append row to Arrow batch: invalid row"};
+
+  try {
+    for (std::size_t f{}; f < fields_.size(); ++f) {
+      const auto data = row.data(f);
+      append(f, data ? &data : nullptr);
+    }
+  } catch (...) {
+    rollback();
+    throw;
+  }
+  ++row_count_;
+}
+
+DMITIGR_PGFE_INLINE void Arrow_batch_builder::append(const Copy_reader& reader)
+{
+  if (reader.field_count() != fields_.size())
+    throw Client_exception{"cannot append COPY row to Arrow batch: "
+      "unexpected field count"};
+
+  try {
+    for (std::size_t f{}; f < fields_.size(); ++f) {
+      const auto data = reader.field(f);
+      append(f, data ? &data : nullptr);
+    }
+  } catch (...) {
+    rollback();
+    throw;
+  }
+  ++row_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Arrow_batch_builder::release(ArrowArray& array, ArrowSchema& schema)
+{
+  const auto field_count = fields_.size();
+
+  // Allocate everything up front to not affect the builder on failure.
+  auto fresh_columns = make_columns(fields_);
+  auto array_p = std::make_unique<detail::Arrow_array_private>();
+  auto schema_p = std::make_unique<detail::Arrow_schema_private>();
+  array_p->buffers.assign(1, nullptr);
+  array_p->children.resize(field_count);
+  array_p->child_pointers.resize(field_count);
+  schema_p->children.resize(field_count);
+  schema_p->child_pointers.resize(field_count);
+  std::vector<std::unique_ptr<detail::Arrow_array_private>> child_arrays;
+  std::vector<std::unique_ptr<detail::Arrow_schema_private>> child_schemas;
+  child_arrays.reserve(field_count);
+  child_schemas.reserve(field_count);
+  for (std::size_t i{}; i < field_count; ++i) {
+    child_arrays.push_back(std::make_unique<detail::Arrow_array_private>());
+    child_arrays.back()->buffers.resize(
+      columns_[i].layout == Layout::variable ? 3 : 2);
+    child_schemas.push_back(std::make_unique<detail::Arrow_schema_private>());
+    child_schemas.back()->name = fields_[i].name;
+  }
+
+  // Build the children (nothing can throw from here).
+  const auto buffer = [](const auto& vec) noexcept -> const void*
+  {
+    return !vec.empty() ? static_cast<const void*>(vec.data()) :
+      &detail::arrow_empty_buffer;
+  };
+  for (std::size_t i{}; i < field_count; ++i) {
+    auto& column = columns_[i];
+    auto& p = *child_arrays[i];
+    p.validity = std::move(column.validity);
+    p.values = std::move(column.values);
+    p.offsets = std::move(column.offsets);
+    p.buffers[0] = column.null_count ? p.validity.data() : nullptr;
+    if (column.layout == Layout::variable) {
+      p.buffers[1] = p.offsets.data();
+      p.buffers[2] = buffer(p.values);
+    } else
+      p.buffers[1] = buffer(p.values);
+
+    auto& child = array_p->children[i];
+    child.length = static_cast<std::int64_t>(column.length);
+    child.null_count = column.null_count;
+    child.offset = 0;
+    child.n_buffers = static_cast<std::int64_t>(p.buffers.size());
+    child.n_children = 0;
+    child.buffers = p.buffers.data();
+    child.children = nullptr;
+    child.dictionary = nullptr;
+    child.release = &detail::release_arrow_array;
+    child.private_data = child_arrays[i].release();
+    array_p->child_pointers[i] = &child;
+
+    auto& child_schema = schema_p->children[i];
+    child_schema.format = column.format;
+    child_schema.name = child_schemas[i]->name.c_str();
+    child_schema.metadata = nullptr;
+    child_schema.flags = ARROW_FLAG_NULLABLE;
+    child_schema.n_children = 0;
+    child_schema.children = nullptr;
+    child_schema.dictionary = nullptr;
+    child_schema.release = &detail::release_arrow_schema;
+    child_schema.private_data = child_schemas[i].release();
+    schema_p->child_pointers[i] = &child_schema;
+  }
+
+  array.length = static_cast<std::int64_t>(row_count_);
+  array.null_count = 0;
+  array.offset = 0;
+  array.n_buffers = 1;
+  array.n_children = static_cast<std::int64_t>(field_count);
+  array.buffers = array_p->buffers.data();
+  array.children = array_p->child_pointers.data();
+  array.dictionary = nullptr;
+  array.release = &detail::release_arrow_array;
+  array.private_data = array_p.release();
+
+  schema.format = "+s";
+  schema.name = "";
+  schema.metadata = nullptr;
+  schema.flags = 0;
+  schema.n_children = static_cast<std::int64_t>(field_count);
+  schema.children = schema_p->child_pointers.data();
+  schema.dictionary = nullptr;
+  schema.release = &detail::release_arrow_schema;
+  schema.private_data = schema_p.release();
+
+  columns_.swap(fresh_columns);
+  row_count_ = 0;
+}
+
+auto Arrow_batch_builder::make_columns(const std::vector<Field>& fields)
+  -> std::vector<Column>
+{
+  std::vector<Column> result(fields.size());
+  for (std::size_t i{}; i < fields.size(); ++i) {
+    auto& column = result[i];
+    const auto fixed = [&column](const char* const format,
+      const std::size_t value_size) noexcept
+    {
+      column.format = format;
+      column.layout = Layout::fixed;
+      column.value_size = value_size;
+    };
+    switch (fields[i].type) {
+    case 16: // bool
+      column.format = "b";
+      column.layout = Layout::boolean;
+      break;
+    case 21: fixed("s", 2); break; // int2
+    case 23: fixed("i", 4); break; // int4
+    case 20: fixed("l", 8); break; // int8
+    case 700: fixed("f", 4); break; // float4
+    case 701: fixed("g", 8); break; // float8
+    case 1082: fixed("tdD", 4); break; // date
+    case 1114: fixed("tsu:", 8); break; // timestamp
+    case 1184: fixed("tsu:UTC", 8); break; // timestamptz
+    case 2950: fixed("w:16", 16); break; // uuid
+    case 25: // text
+      [[fallthrough]];
+    case 1043: // varchar
+      [[fallthrough]];
+    case 1042: // bpchar
+      [[fallthrough]];
+    case 19: // name
+      [[fallthrough]];
+    case 114: // json
+      [[fallthrough]];
+    case 3802: // jsonb
+      [[fallthrough]];
+    case 1700: // numeric
+      column.format = "u";
+      column.layout = Layout::variable;
+      break;
+    case 17: // bytea
+      column.format = "z";
+      column.layout = Layout::variable;
+      break;
+    default:
+      column.format = fields[i].format == Data_format::text ? "u" : "z";
+      column.layout = Layout::variable;
+    }
+  }
+  return result;
+}
+
+void Arrow_batch_builder::append(const std::size_t field, const Data* const data)
+{
+  auto& column = columns_[field];
+  const auto bit = static_cast<std::uint8_t>(1 << (column.length % 8));
+  if (!(column.length % 8)) {
+    column.validity.push_back(0);
+    if (column.layout == Layout::boolean)
+      column.values.push_back(0);
+  }
+
+  switch (column.layout) {
+  case Layout::boolean:
+    if (data && to<bool>(*data))
+      column.values.back() |= bit;
+    break;
+  case Layout::fixed: {
+    const auto offset = column.values.size();
+    column.values.resize(offset + column.value_size); // zeroed for NULL
+    if (!data)
+      break;
+
+    auto* const dest = column.values.data() + offset;
+    switch (fields_[field].type) {
+    case 21: detail::arrow_store(dest, to<std::int16_t>(*data)); break;
+    case 23: detail::arrow_store(dest, to<std::int32_t>(*data)); break;
+    case 20: detail::arrow_store(dest, to<std::int64_t>(*data)); break;
+    case 700: detail::arrow_store(dest, to<float>(*data)); break;
+    case 701: detail::arrow_store(dest, to<double>(*data)); break;
+    case 1082: detail::arrow_store(dest, detail::arrow_date32(*data)); break;
+    case 1114:
+      [[fallthrough]];
+    case 1184: detail::arrow_store(dest, detail::arrow_timestamp(*data)); break;
+    case 2950:
+      if (data->format() == Data_format::binary) {
+        if (data->size() != 16)
+          detail::throw_arrow_invalid_size();
+        std::memcpy(dest, data->bytes(), 16);
+      } else
+        std::memcpy(dest, to<Uuid>(*data).bytes().data(), 16);
+      break;
+    default:
+      DMITIGR_ASSERT(false);
+    }
+    break;
+  }
+  case Layout::variable:
+    if (data) {
+      const auto* bytes = static_cast<const char*>(data->bytes());
+      auto size = data->size();
+      const auto type = fields_[field].type;
+      const bool is_binary{data->format() == Data_format::binary};
+      if (type == 17) { // bytea
+        const auto offset = column.values.size();
+        column.values.resize(offset + detail::bytea_size(*data));
+        detail::copy_bytea(reinterpret_cast<std::byte*>(
+            column.values.data() + offset), *data);
+      } else if (type == 1700 && is_binary) { // numeric
+        const auto numeric = to<Numeric>(*data);
+        const auto& str = numeric.to_string();
+        column.values.insert(column.values.end(), str.begin(), str.end());
+      } else {
+        if (type == 3802 && is_binary) { // jsonb
+          const auto text = detail::json_text(*data);
+          bytes = text.data();
+          size = text.size();
+        }
+        column.values.insert(column.values.end(), bytes, bytes + size);
+      }
+    }
+    if (column.values.size() >
+      static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+      throw Client_exception{"cannot append data to Arrow batch: "
+        "too large data"};
+    column.offsets.push_back(static_cast<std::int32_t>(column.values.size()));
+    break;
+  }
+
+  if (data)
+    column.validity.back() |= bit;
+  else
+    ++column.null_count;
+  ++column.length;
+}
+
+void Arrow_batch_builder::rollback() noexcept
+{
+  const auto length = row_count_;
+  const auto truncate_bits = [length](auto& bits) noexcept
+  {
+    bits.resize((length + 7) / 8);
+    if (length % 8)
+      bits.back() &= static_cast<std::uint8_t>((1 << (length % 8)) - 1);
+  };
+  for (auto& column : columns_) {
+    truncate_bits(column.validity);
+    switch (column.layout) {
+    case Layout::boolean:
+      truncate_bits(column.values);
+      break;
+    case Layout::fixed:
+      column.values.resize(length * column.value_size);
+      break;
+    case Layout::variable:
+      column.offsets.resize(length + 1);
+      column.values.resize(static_cast<std::size_t>(column.offsets.back()));
+      break;
+    }
+    column.length = length;
+    column.null_count = 0;
+    for (std::size_t i{}; i < length; ++i) {
+      if (!(column.validity[i / 8] & (1 << (i % 8))))
+        ++column.null_count;
+    }
+  }
+}
+
+} // namespace dmitigr::pgfe
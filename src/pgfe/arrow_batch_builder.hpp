@@ -0,0 +1,245 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ARROW_BATCH_BUILDER_HPP
+#define DMITIGR_PGFE_ARROW_BATCH_BUILDER_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// The Arrow C data interface
+// (https://arrow.apache.org/docs/format/CDataInterface.html)
+// -----------------------------------------------------------------------------
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+} // extern "C"
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A builder of Apache Arrow record batches from the rows.
+ *
+ * @details The field data is decoded directly into the buffers of Arrow
+ * columnar arrays, without intermediate strings or objects. The built batch
+ * is exported by using the Arrow C data interface, so it can be imported by
+ * any Arrow implementation (for example, by `arrow::ImportRecordBatch()` of
+ * Arrow C++ or by `pyarrow.RecordBatch._import_from_c()`) without copying
+ * and without the dependency on Arrow.
+ *
+ * The types are mapped as follows:
+ *   - `bool` - `boolean`;
+ *   - `int2`, `int4`, `int8` - `int16`, `int32`, `int64`;
+ *   - `float4`, `float8` - `float32`, `float64`;
+ *   - `date` - `date32`;
+ *   - `timestamp`, `timestamptz` - `timestamp[us]`, `timestamp[us, UTC]`;
+ *   - `uuid` - `fixed_size_binary[16]`;
+ *   - `text`, `varchar`, `bpchar`, `name`, `json`, `jsonb`, `numeric` -
+ *   `utf8`;
+ *   - `bytea` - `binary`;
+ *   - any other type - `utf8` if the data format of the field is
+ *   Data_format::text, or `binary` (the data as is) otherwise.
+ *
+ * Both data formats are accepted for the types listed above, although the
+ * binary format is much cheaper to decode. The values `infinity` and
+ * `-infinity` of dates and timestamps are represented by the maximum and
+ * minimum values of the underlying integers accordingly.
+ *
+ * @see Row_batch, Copy_reader.
+ */
+class Arrow_batch_builder final {
+public:
+  /// A field of the batch.
+  struct Field final {
+    /// The name of the field.
+    std::string name;
+
+    /// The OID of the type of the field.
+    Oid type{};
+
+    /// The data format of the field.
+    Data_format format{Data_format::text};
+  };
+
+  /// The destructor.
+  DMITIGR_PGFE_API ~Arrow_batch_builder();
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `!fields.empty()`.
+   */
+  DMITIGR_PGFE_API explicit Arrow_batch_builder(std::vector<Field> fields);
+
+  /**
+   * @overload
+   *
+   * @details The fields are taken from `info`.
+   */
+  DMITIGR_PGFE_API explicit Arrow_batch_builder(const Row_info& info);
+
+  /// Not copy-constructible.
+  Arrow_batch_builder(const Arrow_batch_builder&) = delete;
+
+  /// Not copy-assignable.
+  Arrow_batch_builder& operator=(const Arrow_batch_builder&) = delete;
+
+  /// Not move-constructible.
+  Arrow_batch_builder(Arrow_batch_builder&&) = delete;
+
+  /// Not move-assignable.
+  Arrow_batch_builder& operator=(Arrow_batch_builder&&) = delete;
+
+  /// @returns The fields of the batch.
+  DMITIGR_PGFE_API const std::vector<Field>& fields() const noexcept;
+
+  /// @returns The number of rows appended since the last export.
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /**
+   * @brief Appends all rows of `batch`.
+   *
+   * @details The rows are appended column by column.
+   *
+   * @par Requires
+   * `batch && batch.field_count() == fields().size()`.
+   *
+   * @throws Client_exception if some field data cannot be decoded.
+   */
+  DMITIGR_PGFE_API void append(const Row_batch& batch);
+
+  /**
+   * @brief Appends `row`.
+   *
+   * @par Requires
+   * `row && row.field_count() == fields().size()`.
+   *
+   * @throws Client_exception if some field data cannot be decoded.
+   */
+  DMITIGR_PGFE_API void append(const Row& row);
+
+  /**
+   * @brief Appends the current row of `reader`.
+   *
+   * @par Requires
+   * `reader.field_count() == fields().size()`.
+   *
+   * @throws Client_exception if some field data cannot be decoded.
+   *
+   * @remarks The field types are not known from the `COPY` data, so they must
+   * be specified explicitly by using the constructor which accepts `fields`.
+   */
+  DMITIGR_PGFE_API void append(const Copy_reader& reader);
+
+  /**
+   * @brief Exports the batch of the rows appended since the last export as the
+   * Arrow array of type `struct` with the child array per field.
+   *
+   * @param[out] array The array. The caller takes the ownership.
+   * @param[out] schema The schema. The caller takes the ownership.
+   *
+   * @par Effects
+   * `!row_count()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void release(ArrowArray& array, ArrowSchema& schema);
+
+private:
+  /// A layout of the column.
+  enum class Layout { fixed, boolean, variable };
+
+  /// A column being built.
+  struct Column final {
+    const char* format{};
+    Layout layout{};
+    std::size_t value_size{};
+    std::size_t length{};
+    std::int64_t null_count{};
+    std::vector<std::uint8_t> validity;
+    std::vector<char> values;
+    std::vector<std::int32_t> offsets{0};
+  };
+
+  std::vector<Field> fields_;
+  std::vector<Column> columns_;
+  std::size_t row_count_{};
+
+  static std::vector<Column> make_columns(const std::vector<Field>& fields);
+  void append(std::size_t field, const Data* data);
+  void rollback() noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "arrow_batch_builder.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_ARROW_BATCH_BUILDER_HPP
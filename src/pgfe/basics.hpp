@@ -344,6 +344,64 @@ inline std::string_view to_string_view(const Session_mode cm)
 
 // =============================================================================
 
+/**
+ * @ingroup main
+ *
+ * @brief Replication mode.
+ */
+enum class Replication_mode {
+  /// Physical replication (the connection isn't bound to a database).
+  physical = 0,
+
+  /// Logical replication (the connection is bound to a database).
+  logical = 100
+};
+
+/**
+ * @ingroup main
+ *
+ * @returns The replication mode by `str`.
+ */
+inline std::optional<Replication_mode>
+to_replication_mode(const std::string_view str) noexcept
+{
+  using Rm = Replication_mode;
+  if (str == "physical")
+    return Rm::physical;
+  else if (str == "logical")
+    return Rm::logical;
+  else
+    return std::nullopt;
+}
+
+/**
+ * @ingroup main
+ *
+ * @returns The string representation of `rm`, or `nullptr`.
+ */
+inline const char* to_literal(const Replication_mode rm) noexcept
+{
+  using Rm = Replication_mode;
+  switch (rm) {
+  case Rm::physical: return "physical";
+  case Rm::logical: return "logical";
+  }
+  return nullptr;
+}
+
+/**
+ * @ingroup main
+ *
+ * @returns The string representation of `rm`, or an empty view.
+ */
+inline std::string_view to_string_view(const Replication_mode rm)
+{
+  const char* const l = to_literal(rm);
+  return l ? std::string_view{l} : std::string_view{};
+}
+
+// =============================================================================
+
 /**
  * @ingroup main
  *
@@ -440,6 +498,30 @@ enum class Pipeline_status {
 
 // =============================================================================
 
+/**
+ * @ingroup main
+ *
+ * @brief A mode of establishing the synchronization points of the pipelined
+ * execution of a Statement_vector.
+ */
+enum class Pipeline_sync_mode {
+  /**
+   * The only synchronization point is established after the last statement.
+   * Thus, all the statements are executed in an implicit transaction (unless
+   * explicit transaction control commands are used) and the statements which
+   * follow a failed one are skipped by the server.
+   */
+  once = 0,
+
+  /**
+   * The synchronization point is established after each statement. Thus, the
+   * statements are executed independently of each other.
+   */
+  each = 100
+};
+
+// =============================================================================
+
 /**
  * @ingroup main
  *
@@ -465,7 +547,10 @@ enum class Data_direction {
   to_server = 0,
 
   /// Data directed from the server.
-  from_server = 100
+  from_server = 100,
+
+  /// Data directed both to and from the server (`COPY BOTH` of replication).
+  both = 200
 };
 
 // =============================================================================
@@ -584,6 +669,79 @@ enum class Response_status {
 
 // =============================================================================
 
+/**
+ * @ingroup main
+ *
+ * @brief A row delivery mode.
+ *
+ * @details Denotes how the rows produced by a statement execution are retrieved
+ * from a server. Regardless of the mode, the rows are delivered to the callbacks
+ * of Connection::process_responses() one by one.
+ */
+enum class Row_delivery_mode {
+  /// Each row is retrieved as a separate result.
+  single = 0,
+
+  /**
+   * Rows are retrieved in chunks of the size which is specified by
+   * Connection::set_rows_chunk_size(). (Requires libpq from PostgreSQL 17 or
+   * more recent version.)
+   */
+  chunked = 100,
+
+  /// All rows are retrieved at once as a single result upon command completion.
+  full = 200,
+
+  /**
+   * One of the modes above is chosen for each execution of a prepared statement
+   * according to the statistics of its previous executions: the statements
+   * which return a few small rows are executed in `full` mode, and the others
+   * are executed in `chunked` mode (or in `single` mode if `chunked` mode is
+   * not available) with the size of chunks tuned by the average size of rows.
+   * The first execution is performed in `single` mode.
+   *
+   * @remarks The statistics are collected per named prepared statement and
+   * shared by its instances.
+   */
+  adaptive = 300
+};
+
+// =============================================================================
+
+/**
+ * @ingroup main
+ *
+ * @brief A policy of the limit of the client-side memory of results.
+ *
+ * @details The memory of a result is the memory allocated by libpq for it,
+ * i.e. for a row in Row_delivery_mode::single mode, for a chunk of rows in
+ * Row_delivery_mode::chunked mode, and for all the rows at once in
+ * Row_delivery_mode::full mode. If the limit is exceeded, the processing of
+ * the command is canceled (see Connection::cancel_request_nio()), the rest of
+ * the response is discarded, and Client_exception with code
+ * Client_errc::result_memory_exceeded is thrown.
+ *
+ * @see Connection::set_result_memory_limit().
+ */
+enum class Result_memory_policy {
+  /**
+   * The limit is applied to the total memory of the results of the request.
+   * (Since libpq accumulates the result of Row_delivery_mode::full mode until
+   * the command completion, it can only be discarded when it's received.)
+   */
+  cancel = 0,
+
+  /**
+   * The requests of Row_delivery_mode::full mode are executed in
+   * Row_delivery_mode::single mode, and the limit is applied to each result
+   * separately. Thus, the processing of the command is canceled only if a
+   * single row (or a chunk of rows) doesn't fit in the limit.
+   */
+  stream = 100
+};
+
+// =============================================================================
+
 /**
  * @ingroup main
  *
@@ -0,0 +1,225 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "batch_insert.hpp"
+#include "connection.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Batch_insert::Batch_insert(Connection& connection,
+  std::string table, std::vector<std::string> columns, std::string suffix)
+  : connection_{connection}
+  , table_{std::move(table)}
+  , columns_{std::move(columns)}
+  , suffix_{std::move(suffix)}
+{
+  if (table_.empty())
+    throw Client_exception{"cannot create batch insert: empty table name"};
+  else if (columns_.empty())
+    throw Client_exception{"cannot create batch insert: no columns specified"};
+  else if (columns_.size() > Prepared_statement::max_parameter_count())
+    throw Client_exception{"cannot create batch insert: too many columns"};
+
+  static std::atomic<unsigned long long> id;
+  name_prefix_ = "pgfe_batch_insert_" + std::to_string(++id) + '_';
+}
+
+DMITIGR_PGFE_INLINE Batch_insert::~Batch_insert()
+{
+  try {
+    for (auto& [row_count, statement] : statements_) {
+      if (statement.is_valid() && connection_.is_ready_for_request())
+        connection_.unprepare(statement.name());
+    }
+  } catch (...) {}
+}
+
+DMITIGR_PGFE_INLINE Connection& Batch_insert::connection() const noexcept
+{
+  return connection_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Batch_insert::column_count() const noexcept
+{
+  return columns_.size();
+}
+
+DMITIGR_PGFE_INLINE void
+Batch_insert::set_max_chunk_row_count(const std::optional<std::size_t> value)
+{
+  if (value && !*value)
+    throw Client_exception{"cannot set max chunk row count of batch insert: "
+      "invalid value"};
+  max_chunk_row_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Batch_insert::max_chunk_row_count() const noexcept
+{
+  const auto limit = Prepared_statement::max_parameter_count() / column_count();
+  return max_chunk_row_count_ ? std::min(*max_chunk_row_count_, limit) : limit;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Batch_insert::row_count() const noexcept
+{
+  return values_.size() / column_count();
+}
+
+DMITIGR_PGFE_INLINE bool Batch_insert::is_empty() const noexcept
+{
+  return values_.empty();
+}
+
+DMITIGR_PGFE_INLINE void Batch_insert::clear() noexcept
+{
+  values_.clear();
+  arena_.clear();
+}
+
+DMITIGR_PGFE_INLINE Bulk_completion
+Batch_insert::flush(const std::function<void(Row&&)>& handler)
+{
+  struct Clear_guard final {
+    Batch_insert& self;
+    ~Clear_guard()
+    {
+      self.clear();
+    }
+  } const clear_guard{*this};
+
+  auto& conn = connection_;
+  if (!conn.is_ready_for_request())
+    throw Client_exception{"cannot flush batch insert: not ready for request"};
+
+  /*
+   * The chunks of the maximum size are followed by the chunks of the sizes
+   * of powers of two, so the number of the prepared statements is bounded.
+   */
+  std::vector<Prepared_statement*> chunks;
+  const auto max_size = max_chunk_row_count();
+  for (auto rest = row_count(); rest;) {
+    std::size_t size{max_size};
+    if (rest < max_size) {
+      for (size = 1; size <= rest / 2;)
+        size *= 2;
+    }
+    chunks.push_back(&statement(size)); // can throw
+    rest -= size;
+  }
+
+  Bulk_completion result;
+  const auto process_responses = [&conn, &result, &handler]
+  {
+    for (std::size_t i{}; i < result.execution_count_;) {
+      conn.wait_response();
+      if (auto e = conn.error()) {
+        result.errors_.emplace_back(i, std::move(e));
+        ++i;
+      } else if (auto r = conn.row()) {
+        if (handler)
+          handler(std::move(r));
+      } else if (auto c = conn.completion()) {
+        result.row_count_ += c.row_count().value_or(0);
+        ++result.completion_count_;
+        ++i;
+      } else {
+        // The execution is skipped due to the preceding error.
+        ++result.aborted_count_;
+        ++i;
+      }
+    }
+    conn.wait_response();
+    DMITIGR_ASSERT(conn.ready_for_query());
+  };
+
+  conn.set_pipeline_enabled(true);
+  try {
+    auto value = values_.cbegin();
+    for (auto* const ps : chunks) {
+      const auto count = ps->parameter_count();
+      for (std::size_t i{}; i < count; ++i, ++value) {
+        if (*value)
+          ps->bind(i, **value);
+        else
+          ps->bind(i, nullptr);
+      }
+      ps->execute_nio();
+      ++result.execution_count_;
+      // The input is consumed to prevent the server from blocking.
+      if (conn.socket_readiness(Socket_readiness::read_ready) ==
+        Socket_readiness::read_ready)
+        conn.read_input();
+    }
+    DMITIGR_ASSERT(value == values_.cend());
+    conn.send_sync();
+  } catch (...) {
+    // Bring the connection back to the normal mode if possible.
+    if (conn.is_connected() && conn.pipeline_status() != Pipeline_status::disabled) {
+      try {
+        conn.send_sync();
+        process_responses();
+        conn.set_pipeline_enabled(false);
+      } catch (...) {}
+    }
+    throw;
+  }
+  process_responses();
+  conn.set_pipeline_enabled(false);
+
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Batch_insert::statement(const std::size_t row_count)
+{
+  DMITIGR_ASSERT(row_count && row_count <= max_chunk_row_count());
+  const auto i = statements_.find(row_count);
+  if (i != statements_.end() && i->second.is_valid())
+    return i->second;
+
+  std::string query{"insert into "};
+  query.append(table_).append(" (");
+  for (const auto& column : columns_) {
+    if (&column != &columns_.front())
+      query.append(", ");
+    connection_.append_quoted_identifier(query, column);
+  }
+  query.append(") values ");
+  std::size_t parameter{};
+  for (std::size_t r{}; r < row_count; ++r) {
+    query.append(r ? ", (" : "(");
+    for (std::size_t c{}; c < columns_.size(); ++c)
+      query.append(c ? ", $" : "$").append(std::to_string(++parameter));
+    query += ')';
+  }
+  if (!suffix_.empty())
+    query.append(" ").append(suffix_);
+
+  auto ps = connection_.prepare_as_is(query,
+    name_prefix_ + std::to_string(row_count), {}, true);
+  if (i != statements_.end()) {
+    i->second = std::move(ps);
+    return i->second;
+  } else
+    return statements_.emplace(row_count, std::move(ps)).first->second;
+}
+
+} // namespace dmitigr::pgfe
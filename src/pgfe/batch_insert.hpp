@@ -0,0 +1,227 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_BATCH_INSERT_HPP
+#define DMITIGR_PGFE_BATCH_INSERT_HPP
+
+#include "bulk_completion.hpp"
+#include "conversions.hpp"
+#include "data.hpp"
+#include "data_arena.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "prepared_statement.hpp"
+#include "row.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A builder of the multi-row `INSERT ... VALUES` statements.
+ *
+ * @details The rows are accumulated by add() and inserted by flush() with the
+ * statements like
+ * @code{sql}
+ * insert into tab (a, b) values ($1, $2), ($3, $4), ... [suffix]
+ * @endcode
+ * where the number of rows per statement is limited by the maximum number of
+ * parameters of the statement. The rows are split into the chunks of
+ * max_chunk_row_count() rows, and the rest of rows is split into the chunks
+ * of the sizes of powers of two. The statement for each size of chunk is
+ * prepared once, and the executions of the chunks are pipelined with the
+ * single synchronization point. For example:
+ * @code
+ * pgfe::Batch_insert insert{conn, "person", {"id", "name"},
+ *   "on conflict (id) do nothing returning id"};
+ * for (const auto& [id, name] : persons)
+ *   insert.add(id, name);
+ * insert.flush([](pgfe::Row&& row){ std::cout << to<int>(row[0]) << '\n'; });
+ * @endcode
+ *
+ * This is the fastest way to insert the rows when `COPY` is not applicable
+ * (for example, when `RETURNING` or `ON CONFLICT` is required).
+ *
+ * @remarks The prepared statements are deallocated by the destructor if the
+ * connection is ready for request at that moment.
+ *
+ * @see Connection::copy_into().
+ */
+class Batch_insert final {
+public:
+  /**
+   * @brief The constructor.
+   *
+   * @param connection The connection to insert with. It must outlive the
+   * instance.
+   * @param table The name of the table. It's not quoted.
+   * @param columns The names of the columns. They're quoted.
+   * @param suffix The SQL text to append to each statement, such as
+   * `ON CONFLICT` and/or `RETURNING` clauses.
+   *
+   * @par Requires
+   * `!table.empty() && !columns.empty()`.
+   */
+  DMITIGR_PGFE_API Batch_insert(Connection& connection, std::string table,
+    std::vector<std::string> columns, std::string suffix = {});
+
+  /// Deallocates the prepared statements if possible.
+  DMITIGR_PGFE_API ~Batch_insert();
+
+  /// Not copy-constructible.
+  Batch_insert(const Batch_insert&) = delete;
+
+  /// Not copy-assignable.
+  Batch_insert& operator=(const Batch_insert&) = delete;
+
+  /// Not move-constructible.
+  Batch_insert(Batch_insert&&) = delete;
+
+  /// Not move-assignable.
+  Batch_insert& operator=(Batch_insert&&) = delete;
+
+  /// @returns The connection.
+  DMITIGR_PGFE_API Connection& connection() const noexcept;
+
+  /// @returns The number of columns.
+  DMITIGR_PGFE_API std::size_t column_count() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of rows per statement.
+   *
+   * @details `std::nullopt` means the maximum possible number of rows, which
+   * is limited by Parameterizable::max_parameter_count().
+   *
+   * @par Requires
+   * `!value || *value > 0`.
+   */
+  DMITIGR_PGFE_API void set_max_chunk_row_count(std::optional<std::size_t> value);
+
+  /// @returns The maximum number of rows per statement.
+  DMITIGR_PGFE_API std::size_t max_chunk_row_count() const noexcept;
+
+  /**
+   * @brief Adds the row to insert.
+   *
+   * @details Each value is either of type `std::nullptr_t` (SQL NULL), Data,
+   * `std::optional<T>`, or of a type convertible to Data. The values are
+   * copied.
+   *
+   * @par Requires
+   * `sizeof...(values) == column_count()`.
+   */
+  template<typename ... Types>
+  Batch_insert& add(Types&& ... values)
+  {
+    if (sizeof...(values) != column_count())
+      throw Client_exception{"cannot add row to batch insert: "
+        "invalid number of values"};
+
+    const auto size = values_.size();
+    try {
+      (add_value(std::forward<Types>(values)), ...);
+    } catch (...) {
+      values_.resize(size);
+      throw;
+    }
+    return *this;
+  }
+
+  /// @returns The number of rows added since the last flush() or clear().
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /// @returns `!row_count()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// Discards the added rows.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /**
+   * @brief Inserts the added rows.
+   *
+   * @details Since the executions between the synchronization points are
+   * performed by the server in the single implicit transaction, an error
+   * aborts the remaining chunks and rolls back the preceding ones, unless
+   * the insertion is performed in an explicit transaction block.
+   *
+   * @param handler The handler of rows returned by the statements (if the
+   * suffix contains `RETURNING`).
+   *
+   * @returns The aggregated completion, where the executions are the chunks.
+   *
+   * @par Requires
+   * `connection().is_ready_for_request()`.
+   *
+   * @par Effects
+   * `is_empty()`, even if an exception is thrown.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API Bulk_completion
+  flush(const std::function<void(Row&&)>& handler = {});
+
+private:
+  Connection& connection_;
+  std::string table_;
+  std::vector<std::string> columns_;
+  std::string suffix_;
+  std::optional<std::size_t> max_chunk_row_count_;
+  std::string name_prefix_;
+  std::map<std::size_t, Prepared_statement> statements_;
+  std::vector<const Data*> values_;
+  Data_arena arena_;
+
+  template<typename T>
+  void add_value(T&& value)
+  {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, std::nullptr_t>) {
+      values_.push_back(nullptr);
+    } else if constexpr (std::is_base_of_v<Data, U>) {
+      values_.push_back(value ? &arena_.make(std::string_view{
+            static_cast<const char*>(value.bytes()), value.size()},
+          value.format()) : nullptr);
+    } else if constexpr (detail::Is_optional<U>::value) {
+      if (value)
+        add_value(*std::forward<T>(value));
+      else
+        values_.push_back(nullptr);
+    } else
+      values_.push_back(&arena_.to_data(std::forward<T>(value)));
+  }
+
+  Prepared_statement& statement(std::size_t row_count);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "batch_insert.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_BATCH_INSERT_HPP
@@ -0,0 +1,62 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bulk_completion.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void Bulk_completion::swap(Bulk_completion& rhs) noexcept
+{
+  using std::swap;
+  swap(execution_count_, rhs.execution_count_);
+  swap(completion_count_, rhs.completion_count_);
+  swap(aborted_count_, rhs.aborted_count_);
+  swap(row_count_, rhs.row_count_);
+  swap(errors_, rhs.errors_);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Bulk_completion::execution_count() const noexcept
+{
+  return execution_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Bulk_completion::completion_count() const noexcept
+{
+  return completion_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Bulk_completion::aborted_count() const noexcept
+{
+  return aborted_count_;
+}
+
+DMITIGR_PGFE_INLINE long Bulk_completion::row_count() const noexcept
+{
+  return row_count_;
+}
+
+DMITIGR_PGFE_INLINE bool Bulk_completion::is_ok() const noexcept
+{
+  return completion_count_ == execution_count_;
+}
+
+DMITIGR_PGFE_INLINE auto Bulk_completion::errors() const noexcept
+  -> const std::vector<Execution_error>&
+{
+  return errors_;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_BULK_COMPLETION_HPP
+#define DMITIGR_PGFE_BULK_COMPLETION_HPP
+
+#include "dll.hpp"
+#include "error.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief An aggregated completion of the multiple executions of a prepared
+ * statement.
+ *
+ * @see Prepared_statement::execute_many().
+ */
+class Bulk_completion final {
+public:
+  /// An error with the index of the execution which caused it.
+  using Execution_error = std::pair<std::size_t, Error>;
+
+  /// Default-constructible.
+  Bulk_completion() = default;
+
+  /// Not copy-constructible.
+  Bulk_completion(const Bulk_completion&) = delete;
+
+  /// Move-constructible.
+  Bulk_completion(Bulk_completion&&) = default;
+
+  /// Not copy-assignable.
+  Bulk_completion& operator=(const Bulk_completion&) = delete;
+
+  /// Move-assignable.
+  Bulk_completion& operator=(Bulk_completion&&) = default;
+
+  /// Swaps this instance with `rhs`.
+  DMITIGR_PGFE_API void swap(Bulk_completion& rhs) noexcept;
+
+  /// @returns The number of the requested executions.
+  DMITIGR_PGFE_API std::size_t execution_count() const noexcept;
+
+  /// @returns The number of the successfully completed executions.
+  DMITIGR_PGFE_API std::size_t completion_count() const noexcept;
+
+  /**
+   * @returns The number of the executions which are skipped by the server
+   * because of an error of one of the preceding executions.
+   */
+  DMITIGR_PGFE_API std::size_t aborted_count() const noexcept;
+
+  /**
+   * @returns The total number of rows affected by the successfully completed
+   * executions.
+   *
+   * @see Completion::row_count().
+   */
+  DMITIGR_PGFE_API long row_count() const noexcept;
+
+  /// @returns `true` if there are no failed or aborted executions.
+  DMITIGR_PGFE_API bool is_ok() const noexcept;
+
+  /// @returns The errors in order of the executions which caused them.
+  DMITIGR_PGFE_API const std::vector<Execution_error>& errors() const noexcept;
+
+private:
+  friend Batch_insert;
+  friend Parallel_copy_loader;
+  friend Partitioned_copy_loader;
+  friend Prepared_statement;
+
+  std::size_t execution_count_{};
+  std::size_t completion_count_{};
+  std::size_t aborted_count_{};
+  long row_count_{};
+  std::vector<Execution_error> errors_;
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief Bulk_completion is swappable.
+ */
+inline void swap(Bulk_completion& lhs, Bulk_completion& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "bulk_completion.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_BULK_COMPLETION_HPP
@@ -0,0 +1,290 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COLUMN_DECODER_HPP
+#define DMITIGR_PGFE_COLUMN_DECODER_HPP
+
+#include "../net/conversions.hpp"
+#include "conversions.hpp"
+#include "data.hpp"
+#include "exceptions.hpp"
+#include "row_info.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// The OIDs of the built-in types used by Column_decoder.
+enum Builtin_type_oid : std::uint_fast32_t {
+  bool_oid = 16,
+  name_oid = 19,
+  int8_oid = 20,
+  int2_oid = 21,
+  int4_oid = 23,
+  text_oid = 25,
+  oid_oid = 26,
+  json_oid = 114,
+  xml_oid = 142,
+  float4_oid = 700,
+  float8_oid = 701,
+  bpchar_oid = 1042,
+  varchar_oid = 1043
+};
+
+/// @returns `true` if the values of type `oid` are strings in binary format.
+constexpr bool is_string_type_oid(const std::uint_fast32_t oid) noexcept
+{
+  return oid == text_oid || oid == varchar_oid || oid == bpchar_oid ||
+    oid == name_oid || oid == json_oid || oid == xml_oid;
+}
+
+/// @returns The value of `T` converted by Conversions.
+template<typename T>
+T decode_generic(const Data& data)
+{
+  return to<T>(data);
+}
+
+/// @returns The number of `T` decoded from the binary representation of `U`.
+template<typename T, typename U>
+T decode_binary_number(const Data& data)
+{
+  if (data.size() != sizeof(U))
+    throw Client_exception{"cannot convert numeric from data of binary "
+      "format: invalid input size"};
+  const auto result = net::conv<U>(data.bytes(), sizeof(U));
+  if constexpr (std::is_integral_v<T> && std::is_integral_v<U> &&
+    sizeof(U) > sizeof(T)) {
+    if (result < std::numeric_limits<T>::min() ||
+      result > std::numeric_limits<T>::max())
+      throw Client_exception{"cannot convert numeric from data of binary "
+        "format: value is out of range"};
+  }
+  return static_cast<T>(result);
+}
+
+/// @returns The number `T` decoded from the text representation.
+template<typename T>
+T decode_text_number(const Data& data)
+{
+  const auto* const text = static_cast<const char*>(data.bytes());
+  return to_numeric<T>(text, text + data.size());
+}
+
+/// @returns The `bool` decoded from the binary representation of `bool`.
+inline bool decode_binary_bool(const Data& data)
+{
+  if (data.size() != 1)
+    throw Client_exception{"cannot convert to bool: invalid input size"};
+  return *static_cast<const char*>(data.bytes()) != 0;
+}
+
+/// @returns The string decoded from the data.
+template<typename T>
+T decode_string(const Data& data)
+{
+  return T(static_cast<const char*>(data.bytes()), data.size());
+}
+
+/**
+ * @returns The decoder of the values of type `oid` in `format` to `T`, or
+ * `nullptr` if there is no specialized decoder.
+ */
+template<typename T>
+auto specialized_decoder(const std::uint_fast32_t oid,
+  const Data_format format) noexcept -> T(*)(const Data&)
+{
+  const bool is_binary{format == Data_format::binary};
+  if constexpr (is_numeric_conversions_v<T> && !std::is_same_v<T, long double>) {
+    if (is_binary) {
+      switch (oid) {
+      case int2_oid: return &decode_binary_number<T, std::int16_t>;
+      case int4_oid: return &decode_binary_number<T, std::int32_t>;
+      case int8_oid: return &decode_binary_number<T, std::int64_t>;
+      case oid_oid:
+        if constexpr (sizeof(T) > sizeof(std::uint32_t) ||
+          std::is_floating_point_v<T>)
+          return &decode_binary_number<T, std::uint32_t>;
+        else
+          break;
+      case float4_oid:
+        if constexpr (std::is_floating_point_v<T>)
+          return &decode_binary_number<T, float>;
+        else
+          break;
+      case float8_oid:
+        if constexpr (std::is_floating_point_v<T>)
+          return &decode_binary_number<T, double>;
+        else
+          break;
+      }
+    } else {
+      switch (oid) {
+      case int2_oid: case int4_oid: case int8_oid: case oid_oid:
+        return &decode_text_number<T>;
+      case float4_oid: case float8_oid:
+        if constexpr (std::is_floating_point_v<T>)
+          return &decode_text_number<T>;
+        else
+          break;
+      }
+    }
+  } else if constexpr (std::is_same_v<T, bool>) {
+    if (is_binary && oid == bool_oid)
+      return &decode_binary_bool;
+  } else if constexpr (std::is_same_v<T, std::string> ||
+    std::is_same_v<T, std::string_view>) {
+    if (!is_binary || is_string_type_oid(oid))
+      return &decode_string<T>;
+  }
+  return nullptr;
+}
+
+} // namespace detail
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A decoder of the values of the column of result to `T`.
+ *
+ * @details The decoder is resolved once by the type OID and the data format
+ * of the column, so the values are decoded by the function specialized for
+ * the pair of the column type and `T`, without checks of the data format per
+ * value. For example, the values of `bigint` column in binary format are
+ * decoded to `int` directly from the 8-byte representation with the range
+ * check. If there is no specialized function, the values are converted by
+ * using Conversions.
+ *
+ * @remarks The specialized functions are provided for the numeric types,
+ * `bool`, `std::string` and `std::string_view`. Additionally,
+ * `Column_decoder<std::optional<T>>` decodes SQL NULLs as `std::nullopt`.
+ *
+ * @see Row_info::type_oid(), Row_info::data_format(), Row_mapper.
+ */
+template<typename T>
+class Column_decoder final {
+public:
+  /// The type of the decoded values.
+  using Value_type = T;
+
+  /// The type of the decoder function.
+  using Function = T(*)(const Data&);
+
+  /// Constructs the decoder which uses Conversions.
+  Column_decoder() = default;
+
+  /// Constructs the decoder of the values of type `oid` in `format`.
+  Column_decoder(const std::uint_fast32_t oid, const Data_format format) noexcept
+  {
+    if (const auto function = detail::specialized_decoder<T>(oid, format)) {
+      function_ = function;
+      is_specialized_ = true;
+    }
+  }
+
+  /**
+   * @brief Constructs the decoder of the values of the field `index`.
+   *
+   * @par Requires
+   * `index < info.field_count()`.
+   */
+  Column_decoder(const Row_info& info, const std::size_t index)
+    : Column_decoder{info.type_oid(index), info.data_format(index)}
+  {}
+
+  /// @returns `true` if the specialized function is used for decoding.
+  bool is_specialized() const noexcept
+  {
+    return is_specialized_;
+  }
+
+  /// @returns The decoder function.
+  Function function() const noexcept
+  {
+    return function_;
+  }
+
+  /**
+   * @returns The value decoded from `data`.
+   *
+   * @throws Client_exception if `!data` or the value cannot be decoded.
+   */
+  T operator()(const Data& data) const
+  {
+    return data ? function_(data) : to<T>(data);
+  }
+
+private:
+  Function function_{&detail::decode_generic<T>};
+  bool is_specialized_{};
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The partial specialization of Column_decoder for the nullable values.
+ */
+template<typename T>
+class Column_decoder<std::optional<T>> final {
+public:
+  /// The type of the decoded values.
+  using Value_type = std::optional<T>;
+
+  /// Constructs the decoder which uses Conversions.
+  Column_decoder() = default;
+
+  /// Constructs the decoder of the values of type `oid` in `format`.
+  Column_decoder(const std::uint_fast32_t oid, const Data_format format) noexcept
+    : decoder_{oid, format}
+  {}
+
+  /**
+   * @brief Constructs the decoder of the values of the field `index`.
+   *
+   * @par Requires
+   * `index < info.field_count()`.
+   */
+  Column_decoder(const Row_info& info, const std::size_t index)
+    : decoder_{info, index}
+  {}
+
+  /// @returns `true` if the specialized function is used for decoding.
+  bool is_specialized() const noexcept
+  {
+    return decoder_.is_specialized();
+  }
+
+  /// @returns The decoded value, or `std::nullopt` if `!data`.
+  Value_type operator()(const Data& data) const
+  {
+    return data ? Value_type{decoder_(data)} : std::nullopt;
+  }
+
+private:
+  Column_decoder<T> decoder_;
+};
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_COLUMN_DECODER_HPP
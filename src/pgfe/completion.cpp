@@ -15,12 +15,11 @@
 // limitations under the License.
 
 #include "../base/assert.hpp"
-#include "../os/error.hpp"
 #include "completion.hpp"
 
 #include <cassert>
-#include <cstdlib>
-#include <system_error>
+#include <charconv>
+#include <limits>
 
 namespace dmitigr::pgfe {
 
@@ -32,47 +31,24 @@ DMITIGR_PGFE_INLINE Completion::Completion() noexcept
 DMITIGR_PGFE_INLINE Completion::Completion(Completion&& rhs) noexcept
   : row_count_{rhs.row_count_}
   , tag_{std::move(rhs.tag_)}
+  , pq_result_{std::move(rhs.pq_result_)}
 {
   rhs.row_count_ = -2;
 }
 
 DMITIGR_PGFE_INLINE Completion::Completion(const std::string_view tag)
-  : row_count_{-1} // mark instance as valid
 {
   DMITIGR_ASSERT(tag.data());
+  parse(tag);
+  DMITIGR_ASSERT(is_valid());
+  assert(is_invariant_ok());
+}
 
-  constexpr char space{' '};
-  auto space_before_word_pos = tag.find_last_of(space);
-  if (space_before_word_pos != std::string_view::npos) {
-    auto end_word_pos = tag.size() - 1;
-    while (space_before_word_pos != std::string_view::npos) {
-      /*
-       * The tag can include affected row count as the last word. We'll try to
-       * convert each word of the tag to a number. All numbers except the last
-       * one (i.e. affected row count) must be ignored.
-       */
-      const auto word_size = end_word_pos - space_before_word_pos;
-      const std::string word{tag.substr(space_before_word_pos + 1, word_size)};
-
-      errno = 0;
-      char* p{};
-      const long number = std::strtol(word.c_str(), &p, 10);
-      if (const int err = errno)
-        throw Client_exception{"cannot parse command completion tag:"
-          " " + os::error_message(err)};
-      if (p == word.c_str())
-        // The word is not a number.
-        break;
-      else if (row_count_ < 0)
-        row_count_ = number;
-
-      end_word_pos = space_before_word_pos - 1;
-      space_before_word_pos = tag.find_last_of(space, end_word_pos);
-    }
-    tag_ = tag.substr(0, end_word_pos + 1);
-  } else
-    tag_ = tag;
-
+DMITIGR_PGFE_INLINE Completion::Completion(detail::pq::Result&& result) noexcept
+  : row_count_{-1} // mark instance as valid
+  , pq_result_{std::move(result)}
+{
+  DMITIGR_ASSERT(pq_result_);
   DMITIGR_ASSERT(is_valid());
   assert(is_invariant_ok());
 }
@@ -91,6 +67,7 @@ DMITIGR_PGFE_INLINE void Completion::swap(Completion& rhs) noexcept
   using std::swap;
   swap(row_count_, rhs.row_count_);
   swap(tag_, rhs.tag_);
+  pq_result_.swap(rhs.pq_result_);
 }
 
 DMITIGR_PGFE_INLINE bool Completion::is_valid() const noexcept
@@ -100,17 +77,64 @@ DMITIGR_PGFE_INLINE bool Completion::is_valid() const noexcept
 
 DMITIGR_PGFE_INLINE const std::string& Completion::tag() const noexcept
 {
+  parse_if_needed();
   return tag_;
 }
 
 DMITIGR_PGFE_INLINE std::optional<long> Completion::row_count() const noexcept
 {
+  parse_if_needed();
   return row_count_ >= 0 ? std::optional<long>(row_count_) : std::nullopt;
 }
 
+DMITIGR_PGFE_INLINE void
+Completion::parse(const std::string_view tag) const noexcept
+{
+  row_count_ = -1; // mark instance as valid
+
+  constexpr char space{' '};
+  auto space_before_word_pos = tag.find_last_of(space);
+  if (space_before_word_pos != std::string_view::npos) {
+    auto end_word_pos = tag.size() - 1;
+    while (space_before_word_pos != std::string_view::npos) {
+      /*
+       * The tag can include affected row count as the last word. We'll try to
+       * convert each word of the tag to a number. All numbers except the last
+       * one (i.e. affected row count) must be ignored.
+       */
+      const auto word_size = end_word_pos - space_before_word_pos;
+      const auto word = tag.substr(space_before_word_pos + 1, word_size);
+      long number{};
+      const auto [ptr, ec] = std::from_chars(word.data(),
+        word.data() + word.size(), number);
+      if (ptr != word.data() + word.size() ||
+        (ec != std::errc{} && ec != std::errc::result_out_of_range))
+        // The word is not a number.
+        break;
+      else if (row_count_ < 0)
+        row_count_ = ec == std::errc{} ? number :
+          std::numeric_limits<long>::max();
+
+      end_word_pos = space_before_word_pos - 1;
+      space_before_word_pos = tag.find_last_of(space, end_word_pos);
+    }
+    tag_ = tag.substr(0, end_word_pos + 1);
+  } else
+    tag_ = tag;
+}
+
+DMITIGR_PGFE_INLINE void Completion::parse_if_needed() const noexcept
+{
+  if (pq_result_) {
+    parse(pq_result_.command_tag());
+    pq_result_.reset();
+    assert(is_invariant_ok());
+  }
+}
+
 DMITIGR_PGFE_INLINE bool Completion::is_invariant_ok() const noexcept
 {
-  return (row_count_ < 0) || !tag_.empty();
+  return (row_count_ < 0) || !tag_.empty() || pq_result_;
 }
 
 } // namespace dmitigr::pgfe
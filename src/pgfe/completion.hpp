@@ -18,10 +18,12 @@
 #define DMITIGR_PGFE_COMPLETION_HPP
 
 #include "dll.hpp"
+#include "pq.hpp"
 #include "response.hpp"
 
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace dmitigr::pgfe {
 
@@ -29,6 +31,14 @@ namespace dmitigr::pgfe {
  * @ingroup main
  *
  * @brief A successful operation completion.
+ *
+ * @details The completion received from the server retains the result until
+ * either tag() or row_count() is called for the first time, and the command
+ * tag is parsed on that call only. Thus, the completions which are just
+ * dismissed (e.g. by Connection::process_responses()) are never parsed.
+ *
+ * @remarks Since tag() and row_count() may parse the command tag, they must
+ * not be called concurrently on the same instance.
  */
 class Completion final : public Response {
 public:
@@ -78,10 +88,14 @@ public:
 private:
   friend Connection;
 
-  long row_count_{-2}; // -1 - no value, -2 - invalid instance
-  std::string tag_;
+  mutable long row_count_{-2}; // -1 - no value, -2 - invalid instance
+  mutable std::string tag_;
+  mutable detail::pq::Result pq_result_; // reset once the tag is parsed
 
-  explicit Completion(const std::string_view tag);
+  explicit Completion(std::string_view tag);
+  explicit Completion(detail::pq::Result&& result) noexcept;
+  void parse(std::string_view tag) const noexcept;
+  void parse_if_needed() const noexcept;
   bool is_invariant_ok() const noexcept;
 };
 
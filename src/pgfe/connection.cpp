@@ -16,14 +16,28 @@
 
 #include "../base/assert.hpp"
 #include "../net/socket.hpp"
+#include "../str/hex.hpp"
+#include "../str/substr.hpp"
 #include "connection.hpp"
 #include "copier.hpp"
+#include "copy_binary_writer.hpp"
+#include "copy_writer.hpp"
 #include "exceptions.hpp"
 #include "large_object.hpp"
+#include "prepared_statement_registry.hpp"
 #include "ready_for_query.hpp"
 #include "statement.hpp"
-
+#include "statement_vector.hpp"
+#include "type_catalog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <iterator>
 
 namespace dmitigr::pgfe {
 
@@ -64,6 +78,99 @@ DMITIGR_PGFE_INLINE Server_status ping(const Connection_options& options)
   throw false; // disable -Wreturn-type
 }
 
+DMITIGR_PGFE_INLINE Connection
+connect_first(const std::vector<Connection_options>& candidates,
+  std::optional<std::chrono::milliseconds> timeout)
+{
+  using std::chrono::milliseconds;
+  using std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using Status = Connection_status;
+
+  if (candidates.empty())
+    throw Client_exception{"cannot connect: no candidates specified"};
+  else if (!(!timeout || timeout >= milliseconds{-1}))
+    throw Client_exception{"cannot connect: invalid timeout specified"};
+
+  if (timeout == milliseconds{-1}) {
+    timeout = milliseconds::zero();
+    for (const auto& options : candidates) {
+      const auto t = options.connect_timeout();
+      if (!t) {
+        timeout.reset();
+        break;
+      } else if (*t > *timeout)
+        timeout = t;
+    }
+  }
+  const auto deadline = steady_clock::now() + timeout.value_or(milliseconds{});
+
+  std::string last_error{"no connection established"};
+  std::vector<Connection> connections;
+  connections.reserve(candidates.size());
+  for (const auto& options : candidates) {
+    auto& conn = connections.emplace_back(options);
+    try {
+      conn.connect_nio();
+    } catch (const Client_exception& e) {
+      last_error = e.what();
+      conn.disconnect();
+    }
+  }
+
+  std::vector<net::Poll_entry> entries;
+  std::vector<std::size_t> indexes;
+  while (true) {
+    entries.clear();
+    indexes.clear();
+    for (std::size_t i{}; i < connections.size(); ++i) {
+      auto& conn = connections[i];
+      const auto status = conn.status();
+      if (status == Status::connected) {
+        return std::move(conn); // the rest are closed by destructors
+      } else if (status == Status::failure) {
+        last_error = conn.error_message();
+        conn.disconnect();
+      } else if (status == Status::establishment_reading ||
+        status == Status::establishment_writing) {
+        entries.push_back({static_cast<net::Socket_native>(conn.socket()),
+          status == Status::establishment_reading ?
+          net::Socket_readiness::read_ready :
+          net::Socket_readiness::write_ready});
+        indexes.push_back(i);
+      }
+    }
+
+    if (entries.empty())
+      throw Client_exception{"cannot connect to any of candidates: "
+        + last_error};
+
+    auto wait_timeout = milliseconds{-1};
+    if (timeout) {
+      const auto now = steady_clock::now();
+      if (now >= deadline)
+        throw Client_exception{Client_errc::timed_out, "connection timeout"};
+      wait_timeout = duration_cast<milliseconds>(deadline - now);
+      if (wait_timeout == milliseconds::zero())
+        wait_timeout = milliseconds{1};
+    }
+
+    net::poll_many(entries, wait_timeout);
+    for (std::size_t i{}; i < entries.size(); ++i) {
+      if (entries[i].readiness == net::Socket_readiness::unready)
+        continue;
+
+      auto& conn = connections[indexes[i]];
+      try {
+        conn.connect_nio();
+      } catch (const Client_exception& e) {
+        last_error = e.what();
+        conn.disconnect();
+      }
+    }
+  }
+}
+
 // =============================================================================
 
 DMITIGR_PGFE_INLINE Connection::Request::Request(const Id id) noexcept
@@ -91,9 +198,18 @@ DMITIGR_PGFE_INLINE Connection::~Connection() noexcept
 
 DMITIGR_PGFE_INLINE Connection::Connection(Options options)
   : options_{std::move(options)}
+  , type_catalog_{std::make_shared<Type_catalog>()}
+  , ps_registry_{std::make_shared<Prepared_statement_registry>()}
   , execute_ps_state_{std::make_shared<Prepared_statement::State>("", this)}
 {}
 
+DMITIGR_PGFE_INLINE Connection::Connection(
+  std::shared_ptr<const Compiled_connection_options> options)
+  : Connection{}
+{
+  set_options(std::move(options));
+}
+
 DMITIGR_PGFE_INLINE Connection::Connection(Connection&& rhs) noexcept
 {
   Connection tmp;
@@ -114,42 +230,84 @@ DMITIGR_PGFE_INLINE void Connection::swap(Connection& rhs) noexcept
 {
   using std::swap;
   swap(options_, rhs.options_);
+  swap(compiled_options_, rhs.compiled_options_);
   swap(error_handler_, rhs.error_handler_);
   swap(notice_handler_, rhs.notice_handler_);
+  swap(notice_min_severity_, rhs.notice_min_severity_);
   swap(notification_handler_, rhs.notification_handler_);
+  swap(trace_handler_, rhs.trace_handler_);
+  swap(traffic_recorder_, rhs.traffic_recorder_);
+  swap(traffic_session_, rhs.traffic_session_);
   swap(default_result_format_, rhs.default_result_format_);
+  swap(is_simple_query_enabled_, rhs.is_simple_query_enabled_);
+  swap(default_row_delivery_mode_, rhs.default_row_delivery_mode_);
+  swap(rows_chunk_size_, rhs.rows_chunk_size_);
+  swap(result_memory_limit_, rhs.result_memory_limit_);
+  swap(result_memory_policy_, rhs.result_memory_policy_);
+  swap(statement_cache_capacity_, rhs.statement_cache_capacity_);
+  swap(statement_cache_threshold_, rhs.statement_cache_threshold_);
+  swap(is_metrics_enabled_, rhs.is_metrics_enabled_);
+  swap(is_query_tagging_enabled_, rhs.is_query_tagging_enabled_);
+  swap(request_timeout_, rhs.request_timeout_);
+  swap(type_catalog_, rhs.type_catalog_);
+  swap(ps_registry_, rhs.ps_registry_);
   //
   swap(execute_ps_state_, rhs.execute_ps_state_);
   swap(execute_ps_state_->connection_, rhs.execute_ps_state_->connection_);
+  swap(execute_data_arena_, rhs.execute_data_arena_);
   //
   swap(conn_, rhs.conn_);
   swap(polling_status_, rhs.polling_status_);
   swap(lo_id_, rhs.lo_id_);
+  swap(metrics_, rhs.metrics_);
+  swap(tagged_query_, rhs.tagged_query_);
+  swap(binding_query_, rhs.binding_query_);
+  swap(query_strings_, rhs.query_strings_);
+  swap(cancel_request_, rhs.cancel_request_);
   swap(session_start_time_, rhs.session_start_time_);
   swap(response_, rhs.response_);
   swap(response_status_, rhs.response_status_);
+  swap(response_row_number_, rhs.response_row_number_);
   swap(last_prepared_statement_, rhs.last_prepared_statement_);
   swap(is_output_flushed_, rhs.is_output_flushed_);
   //
   swap(copier_state_, rhs.copier_state_);
   swap(*copier_state_, *rhs.copier_state_);
   //
-  swap(is_single_row_mode_enabled_, rhs.is_single_row_mode_enabled_);
+  swap(is_row_delivery_mode_set_, rhs.is_row_delivery_mode_set_);
+  swap(field_name_index_, rhs.field_name_index_);
+  swap(field_name_index_request_, rhs.field_name_index_request_);
+  swap(dismissed_request_count_, rhs.dismissed_request_count_);
   //
   swap(ps_states_, rhs.ps_states_);
-  for (auto& state : ps_states_)
+  for (auto& [id, state] : ps_states_)
     state->connection_ = this;
-  for (auto& state : rhs.ps_states_)
+  for (auto& [id, state] : rhs.ps_states_)
     state->connection_ = &rhs;
   //
   swap(lo_states_, rhs.lo_states_);
-  for (auto& state : lo_states_)
+  for (auto& [id, state] : lo_states_)
     state->connection_ = this;
-  for (auto& state : rhs.lo_states_)
+  for (auto& [id, state] : rhs.lo_states_)
     state->connection_ = &rhs;
   //
+  swap(statement_cache_, rhs.statement_cache_);
+  swap(statement_cache_index_, rhs.statement_cache_index_);
+  swap(statement_cache_ps_id_, rhs.statement_cache_ps_id_);
+  swap(is_routine_cache_enabled_, rhs.is_routine_cache_enabled_);
+  swap(routine_cache_, rhs.routine_cache_);
+  swap(routine_cache_ps_id_, rhs.routine_cache_ps_id_);
+  swap(ps_registry_states_, rhs.ps_registry_states_);
+  //
   swap(requests_, rhs.requests_);
   swap(last_processed_request_, rhs.last_processed_request_);
+  swap(parameter_buffers_, rhs.parameter_buffers_);
+  //
+  swap(pipeline_sync_request_threshold_, rhs.pipeline_sync_request_threshold_);
+  swap(pipeline_sync_byte_threshold_, rhs.pipeline_sync_byte_threshold_);
+  swap(pipeline_max_depth_, rhs.pipeline_max_depth_);
+  swap(pipeline_unsynced_request_count_, rhs.pipeline_unsynced_request_count_);
+  swap(pipeline_unsynced_byte_count_, rhs.pipeline_unsynced_byte_count_);
 }
 
 DMITIGR_PGFE_INLINE const Connection_options& Connection::options() const noexcept
@@ -157,6 +315,25 @@ DMITIGR_PGFE_INLINE const Connection_options& Connection::options() const noexce
   return options_;
 }
 
+DMITIGR_PGFE_INLINE void Connection::set_options(
+  std::shared_ptr<const Compiled_connection_options> options)
+{
+  if (!options)
+    throw Client_exception{"cannot set connection options: null options"};
+  else if (options == compiled_options_)
+    return;
+
+  options_ = options->options(); // can throw
+  compiled_options_ = std::move(options);
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE auto Connection::compiled_options() const noexcept
+  -> const std::shared_ptr<const Compiled_connection_options>&
+{
+  return compiled_options_;
+}
+
 DMITIGR_PGFE_INLINE bool Connection::is_ssl_secured() const noexcept
 {
   return conn() ? PQsslInUse(conn()) : false;
@@ -221,6 +398,71 @@ Connection::session_start_time() const noexcept
   return session_start_time_;
 }
 
+DMITIGR_PGFE_INLINE void Connection::set_metrics_enabled(const bool value) noexcept
+{
+  is_metrics_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Connection::is_metrics_enabled() const noexcept
+{
+  return is_metrics_enabled_;
+}
+
+DMITIGR_PGFE_INLINE const Connection_metrics&
+Connection::metrics() const noexcept
+{
+  return metrics_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::reset_metrics() noexcept
+{
+  metrics_ = {};
+}
+
+DMITIGR_PGFE_INLINE Connection_metrics Connection::take_metrics() noexcept
+{
+  return std::exchange(metrics_, Connection_metrics{});
+}
+
+DMITIGR_PGFE_INLINE void Connection::set_trace_handler(Trace_handler handler)
+{
+  trace_handler_ = std::move(handler);
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE auto Connection::trace_handler() const noexcept
+  -> const Trace_handler&
+{
+  return trace_handler_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_traffic_recorder(std::shared_ptr<Traffic_recorder> recorder)
+{
+  if (recorder != traffic_recorder_) {
+    traffic_session_ = recorder ? recorder->open_session() : 0;
+    traffic_recorder_ = std::move(recorder);
+  }
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Traffic_recorder>&
+Connection::traffic_recorder() const noexcept
+{
+  return traffic_recorder_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_query_tagging_enabled(const bool value) noexcept
+{
+  is_query_tagging_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Connection::is_query_tagging_enabled() const noexcept
+{
+  return is_query_tagging_enabled_;
+}
+
 DMITIGR_PGFE_INLINE void Connection::connect_nio()
 {
   const auto s = status();
@@ -248,6 +490,7 @@ DMITIGR_PGFE_INLINE void Connection::connect_nio()
     case PGRES_POLLING_OK:
       polling_status_.reset();
       session_start_time_ = std::chrono::system_clock::now();
+      set_socket_options__();
       /*
        * We cannot assert here that status() is "connected", because it can
        * become "failure" at *any* time, even just after successful connection
@@ -265,7 +508,11 @@ DMITIGR_PGFE_INLINE void Connection::connect_nio()
 
     DMITIGR_ASSERT(status() == Status::disconnected);
 
-    const detail::pq::Connection_options pq_options{options_};
+    // The options are compiled once, and shared with the reconnects.
+    if (!compiled_options_)
+      compiled_options_ =
+        std::make_shared<const Compiled_connection_options>(options_);
+    const auto& pq_options = *compiled_options_->pq_options_;
     constexpr int expand_dbname{};
     conn_.reset(PQconnectStartParams(pq_options.keywords(),
         pq_options.values(), expand_dbname));
@@ -372,6 +619,7 @@ Connection::connect(std::optional<std::chrono::milliseconds> timeout)
 DMITIGR_PGFE_INLINE void Connection::disconnect() noexcept
 {
   reset_session();
+  polling_status_.reset(); // the establishment could be in progress
   conn_.reset(); // discarding unhandled notifications btw.
   DMITIGR_ASSERT(status() == Status::disconnected);
   assert(is_invariant_ok());
@@ -423,6 +671,8 @@ Connection::socket_readiness(const Socket_readiness mask) const
 
 DMITIGR_PGFE_INLINE void Connection::read_input()
 {
+  if (is_metrics_enabled_)
+    ++metrics_.read_input_count;
   if (!PQconsumeInput(conn()))
     throw Client_exception{error_message()};
 }
@@ -437,21 +687,95 @@ Connection::handle_input(const bool wait_response)
 {
   if (!is_connected())
     throw Client_exception{"cannot handle input from server: not connected"};
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::row_receive};
+
+  static const auto is_row_chunk_status = [](const auto status) noexcept
+  {
+    return status == PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+      || status == PGRES_TUPLES_CHUNK
+#endif
+      ;
+  };
 
   const auto check_state = [this]() noexcept
   {
     DMITIGR_ASSERT(response_status_ == Response_status::ready_not_preprocessed);
-    DMITIGR_ASSERT(response_.status() == PGRES_SINGLE_TUPLE);
+    DMITIGR_ASSERT(is_row_chunk_status(response_.status()));
     DMITIGR_ASSERT(!requests_.empty());
     DMITIGR_ASSERT(requests_.front().id_ == Request::Id::execute);
   };
 
   const auto dismiss_request = [this]() noexcept
   {
-    if (!requests_.empty()) {
-      last_processed_request_ = std::move(requests_.front());
-      requests_.pop();
+    this->dismiss_request(response_.status());
+  };
+
+  static const auto is_result_memory_exceeded =
+    [](const Request& request) noexcept
+  {
+    return request.result_memory_limit_ &&
+      request.result_memory_size_ > *request.result_memory_limit_;
+  };
+
+  /*
+   * Accounts the memory of response_ according to the policy of the request.
+   * Returns `true` if the limit of the request is exceeded.
+   */
+  const auto account_result_memory = [this](Request& request) noexcept
+  {
+    if (!request.result_memory_limit_)
+      return false;
+
+    const auto size = response_.memory_size();
+    if (request.result_memory_policy_ == Result_memory_policy::cancel)
+      request.result_memory_size_ += size;
+    else
+      request.result_memory_size_ = size;
+    return is_result_memory_exceeded(request);
+  };
+
+  // Returns `true` if the rows of the current request are rejected.
+  const auto is_rows_rejected = [this]() noexcept
+  {
+    return !response_ && !requests_.empty() &&
+      is_result_memory_exceeded(requests_.front());
+  };
+
+  /*
+   * Rejects the rows of the current request which exceeds the limit of the
+   * result memory. The rest of the response is discarded either right away,
+   * if waiting, or by the next calls otherwise.
+   */
+  const auto reject_rows = [this, wait_response, &dismiss_request]
+  {
+    response_.reset();
+    try {
+      cancel_request_nio();
+    } catch (...) {
+      // The rest of the response will be just discarded in this case.
     }
+    if (wait_response) {
+      while (auto* const r = PQgetResult(conn()))
+        PQclear(r);
+      response_status_ = Response_status::empty;
+      dismiss_request();
+    } else
+      response_status_ = Response_status::unready;
+    throw Client_exception{Client_errc::result_memory_exceeded,
+      "result memory limit exceeded"};
+  };
+
+  /*
+   * Makes the row chunk of response_ shareable between the rows delivered by
+   * row(). The single row is delivered by releasing the response, so the
+   * allocation of the shared state is not needed in this case.
+   */
+  const auto make_row_chunk_shareable = [this]
+  {
+    if (response_.status() != PGRES_SINGLE_TUPLE)
+      response_.make_shareable(); // can throw
   };
 
   static const auto is_completion_status = [](const auto status) noexcept
@@ -467,31 +791,80 @@ Connection::handle_input(const bool wait_response)
       status == PGRES_BAD_RESPONSE;
   };
 
+  /*
+   * Handles the result `r` which follows the completion of the request. Only
+   * the simple query of the multiple commands has such results, in which case
+   * the first error, or otherwise the completion of the last command, becomes
+   * the response. The other results are just discarded. The rows of the last
+   * command are delivered only in Row_delivery_mode::full, since otherwise
+   * the rows of the first command are already delivered.
+   */
+  const auto absorb_result = [this](PGresult* const r) noexcept
+  {
+    detail::pq::Result result{r};
+    if (requests_.empty() || !requests_.front().is_simple_query_ ||
+      response_.status() == PGRES_FATAL_ERROR)
+      return;
+
+    const auto status = result.status();
+    if (status == PGRES_FATAL_ERROR || status == PGRES_COMMAND_OK ||
+      status == PGRES_TUPLES_OK || status == PGRES_EMPTY_QUERY) {
+      if (response_.status() == PGRES_COMMAND_OK) {
+        // All the prepared statements are deallocated by these commands.
+        const char* const tag = response_.command_tag();
+        if (!std::strcmp(tag, "DISCARD ALL") ||
+          !std::strcmp(tag, "DEALLOCATE ALL")) {
+          last_prepared_statement_ = {};
+          reset_prepared_statements();
+          reset_statement_cache();
+        }
+      }
+      response_.swap(result);
+      response_row_number_ =
+        requests_.front().row_delivery_mode_ == Row_delivery_mode::full ?
+        0 : response_.row_count();
+    }
+  };
+
   /*
    * According to https://www.postgresql.org/docs/current/libpq-pipeline-mode.html,
    * "To enter single-row mode, call PQsetSingleRowMode() before retrieving
    * results with PQgetResult(). This mode selection is effective only for the
-   * query currently being processed." Therefore, set_single_row_mode_enabled()
-   * is called once for each query in a pipeline.
+   * query currently being processed." Therefore, set_row_delivery_mode_enabled()
+   * is called once for each query in a pipeline. (The same is true for
+   * PQsetChunkedRowsMode().)
    */
   if ((pipeline_status() == Pipeline_status::enabled) &&
-    !is_single_row_mode_enabled_ && !requests_.empty() &&
+    !is_row_delivery_mode_set_ && !requests_.empty() &&
     requests_.front().id_ == Request::Id::execute)
-    set_single_row_mode_enabled();
+    set_row_delivery_mode_enabled(requests_.front());
 
   if (wait_response) {
     if (response_status_ == Response_status::unready) {
     complete_response:
       while (auto* const r = PQgetResult(conn()))
-        PQclear(r);
+        absorb_result(r);
+      if (is_rows_rejected()) { // the rest of the response is discarded
+        response_status_ = Response_status::empty;
+        dismiss_request();
+        goto handle_notifications;
+      }
       response_status_ = Response_status::ready_not_preprocessed;
       dismiss_request();
     } else if (!response_ || (response_status_ == Response_status::ready &&
-        is_completion_status(response_.status()))) {
+        is_completion_status(response_.status()) && !has_undelivered_rows())) {
       response_.reset(PQgetResult(conn()));
-      if (response_.status() == PGRES_SINGLE_TUPLE) {
+      response_row_number_ = 0;
+      if (is_row_chunk_status(response_.status())) {
+        if (account_result_memory(requests_.front()))
+          reject_rows();
+        make_row_chunk_shareable(); // can throw
         response_status_ = Response_status::ready_not_preprocessed;
         check_state();
+        account_first_row(requests_.front());
+        account_delivered_rows(requests_.front());
+        if (const auto& state = requests_.front().trace_state_)
+          trace_rows(*state);
         goto handle_notifications;
       } else if (is_completion_status(response_.status()))
         goto complete_response;
@@ -518,19 +891,32 @@ Connection::handle_input(const bool wait_response)
     try_complete_response:
       while (!is_get_result_would_block(conn())) {
         if (auto* const r = PQgetResult(conn()); !r) {
+          if (is_rows_rejected()) { // the rest of the response is discarded
+            response_status_ = Response_status::empty;
+            dismiss_request();
+            goto handle_notifications;
+          }
           response_status_ = Response_status::ready_not_preprocessed;
           dismiss_request();
           break;
         } else
-          PQclear(r);
+          absorb_result(r);
       }
     } else if (!response_ || (response_status_ == Response_status::ready &&
-        is_completion_status(response_.status()))) {
+        is_completion_status(response_.status()) && !has_undelivered_rows())) {
       if (!is_get_result_would_block(conn())) {
         response_.reset(PQgetResult(conn()));
-        if (response_.status() == PGRES_SINGLE_TUPLE) {
+        response_row_number_ = 0;
+        if (is_row_chunk_status(response_.status())) {
+          if (account_result_memory(requests_.front()))
+            reject_rows();
+          make_row_chunk_shareable(); // can throw
           response_status_ = Response_status::ready_not_preprocessed;
           check_state();
+          account_first_row(requests_.front());
+          account_delivered_rows(requests_.front());
+          if (const auto& state = requests_.front().trace_state_)
+            trace_rows(*state);
           goto handle_notifications;
         } else if (is_completion_status(response_.status())) {
           response_status_ = Response_status::unready;
@@ -548,17 +934,30 @@ Connection::handle_input(const bool wait_response)
   if (response_status_ == Response_status::ready_not_preprocessed) {
     const auto rstatus = response_.status();
     DMITIGR_ASSERT(rstatus != PGRES_NONFATAL_ERROR);
-    DMITIGR_ASSERT(rstatus != PGRES_SINGLE_TUPLE);
+    DMITIGR_ASSERT(!is_row_chunk_status(rstatus));
+    if (is_metrics_enabled_)
+      account_response(rstatus);
     if (rstatus == PGRES_TUPLES_OK) {
       DMITIGR_ASSERT(last_processed_request_.id_ == Request::Id::execute);
-      is_single_row_mode_enabled_ = false;
-    } else if (rstatus == PGRES_COPY_OUT || rstatus == PGRES_COPY_IN) {
+      is_row_delivery_mode_set_ = false;
+      if (response_.row_count() > 0) {
+        if (account_result_memory(last_processed_request_)) {
+          // The response is already completed, so there is nothing to cancel.
+          response_.reset();
+          response_status_ = Response_status::empty;
+          throw Client_exception{Client_errc::result_memory_exceeded,
+            "result memory limit exceeded"};
+        }
+        response_.make_shareable(); // can throw
+      }
+    } else if (rstatus == PGRES_COPY_OUT || rstatus == PGRES_COPY_IN ||
+      rstatus == PGRES_COPY_BOTH) {
       // is_copy_in_progress() now returns `true`, copier() returns Copier.
       copier_state_ = std::make_shared<Connection*>(nullptr); // can throw
     } else if (rstatus == PGRES_FATAL_ERROR) {
       // is_copy_in_progress() now returns `false`.
       reset_copier_state();
-      is_single_row_mode_enabled_ = false;
+      is_row_delivery_mode_set_ = false;
     } else if (rstatus == PGRES_COMMAND_OK) {
       auto& lpr = last_processed_request_;
       DMITIGR_ASSERT(lpr.id_ != Request::Id::prepare || lpr.prepared_statement_);
@@ -588,10 +987,19 @@ Connection::handle_input(const bool wait_response)
         DMITIGR_ASSERT(lpr.prepared_statement_name_ &&
           !std::strcmp(response_.command_tag(), "DEALLOCATE"));
         unregister_ps(*lpr.prepared_statement_name_);
+      } else if (lpr.id_ == Request::Id::execute) {
+        // All the prepared statements are deallocated by these commands.
+        const char* const tag = response_.command_tag();
+        if (!std::strcmp(tag, "DISCARD ALL") ||
+          !std::strcmp(tag, "DEALLOCATE ALL")) {
+          last_prepared_statement_ = {};
+          reset_prepared_statements();
+          reset_statement_cache();
+        }
       }
       // is_copy_in_progress() now returns `false`.
       reset_copier_state();
-      is_single_row_mode_enabled_ = false;
+      is_row_delivery_mode_set_ = false;
     }
     response_status_ = Response_status::ready;
   } else if (response_status_ == Response_status::empty)
@@ -601,8 +1009,11 @@ Connection::handle_input(const bool wait_response)
   try {
     // Note: notifications are collected by PQisBusy() and PQgetResult().
     if (notification_handler_) {
-      while (auto* const n = PQnotifies(conn()))
+      while (auto* const n = PQnotifies(conn())) {
+        if (is_metrics_enabled_)
+          ++metrics_.notification_count;
         notification_handler_(Notification{n});
+      }
     }
   } catch (const std::exception& e) {
     std::clog << "notification handler: error: " << e.what() << '\n';
@@ -631,7 +1042,13 @@ DMITIGR_PGFE_INLINE bool Connection::flush_output(const bool wait)
     return true;
 
   using Sr = Socket_readiness;
-  if (const int r{PQflush(conn())}; r == 1) {
+  const int r{PQflush(conn())};
+  if (is_metrics_enabled_) {
+    ++metrics_.flush_output_count;
+    if (r == 1)
+      ++metrics_.flush_output_would_block_count;
+  }
+  if (r == 1) {
     if (wait) {
       const auto sr = wait_socket_readiness(Sr::read_ready | Sr::write_ready);
       if (sr == Sr::read_ready) {
@@ -641,11 +1058,8 @@ DMITIGR_PGFE_INLINE bool Connection::flush_output(const bool wait)
         return flush_output(wait);
     } else
       return false;
-  } else if (!r) {
-    if (wait)
-      wait_socket_readiness(Sr::read_ready);
+  } else if (!r)
     return is_output_flushed_ = true;
-  }
 
   throw Client_exception{"cannot flush queued output data to the server"};
 }
@@ -671,25 +1085,75 @@ Connection::wait_response(std::optional<std::chrono::milliseconds> timeout)
   if (timeout < milliseconds::zero()) // even if timeout < -1
     timeout = options().wait_response_timeout();
 
+  struct Wait_time_guard final {
+    Connection_metrics* metrics_{};
+    std::chrono::steady_clock::time_point start_{};
+    ~Wait_time_guard()
+    {
+      if (metrics_) {
+        const auto duration = std::chrono::steady_clock::now() - start_;
+        metrics_->wait_response_time += duration;
+        metrics_->wait_response_duration.record(duration);
+      }
+    }
+  } const wait_time_guard{is_metrics_enabled_ ? &metrics_ : nullptr,
+    is_metrics_enabled_ ? std::chrono::steady_clock::now() :
+      std::chrono::steady_clock::time_point{}};
+
+  // The moment until which the socket is polled without blocking.
+  std::optional<std::chrono::steady_clock::time_point> spin_end;
+  if (const auto spin = options().wait_response_spin_duration();
+    spin && spin->count() > 0)
+    spin_end = std::chrono::steady_clock::now() + *spin;
+
   while (true) {
-    const auto s = handle_input(!timeout);
+    // The deadline of the current request if it's not canceled yet.
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (!requests_.empty() &&
+      requests_.front().deadline_ != std::chrono::steady_clock::time_point{})
+      deadline = requests_.front().deadline_;
+
+    const bool is_spinning = spin_end &&
+      std::chrono::steady_clock::now() < *spin_end;
+    const auto s = handle_input(!is_spinning && !timeout && !deadline);
     if (s == Response_status::unready) {
-      DMITIGR_ASSERT(timeout);
+      if (is_spinning) {
+        read_input(); // doesn't block since the socket is non-blocking
+        continue;
+      }
+
+      DMITIGR_ASSERT(timeout || deadline);
+
+      auto wait_timeout = timeout;
+      if (deadline) {
+        const auto left = std::max(milliseconds::zero(),
+          std::chrono::ceil<milliseconds>(*deadline -
+            std::chrono::steady_clock::now()));
+        if (!wait_timeout || left < *wait_timeout)
+          wait_timeout = left;
+      }
 
       const auto moment_of_wait = system_clock::now();
-      if (wait_socket_readiness(
-          Socket_readiness::read_ready, timeout) == Socket_readiness::read_ready)
-        *timeout -= duration_cast<milliseconds>(system_clock::now() - moment_of_wait);
-      else // timeout expired
+      const auto readiness = wait_socket_readiness(
+        Socket_readiness::read_ready, wait_timeout);
+      if (timeout)
+        *timeout = std::max(milliseconds::zero(), *timeout -
+          duration_cast<milliseconds>(system_clock::now() - moment_of_wait));
+
+      if (readiness == Socket_readiness::read_ready)
+        read_input();
+      else if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+        requests_.front().deadline_ = {};
+        cancel_request_nio();
+      } else // timeout expired
         throw Client_exception{Client_errc::timed_out,
           "wait response timeout expired"};
-
-      read_input();
     } else
       return s == Response_status::ready;
   }
 
   DMITIGR_ASSERT(false);
+  return false; // disable -Wreturn-type
 }
 
 DMITIGR_PGFE_INLINE bool
@@ -715,19 +1179,92 @@ DMITIGR_PGFE_INLINE auto Connection::error_handler() noexcept
 
 DMITIGR_PGFE_INLINE Error Connection::error() noexcept
 {
+  const detail::Allocation_scope allocation_scope{Allocation_category::error};
   return (response_.status() == PGRES_FATAL_ERROR) ?
     Error{release_response()} : Error{};
 }
 
 DMITIGR_PGFE_INLINE Row Connection::row() noexcept
 {
-  return (response_.status() == PGRES_SINGLE_TUPLE)
-    ? Row{release_response()} : Row{};
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::row_receive};
+  switch (response_.status()) {
+  case PGRES_SINGLE_TUPLE: {
+    if (is_metrics_enabled_)
+      account_rows(0, 1);
+    auto index = field_name_index();
+    return Row{Row_info{release_response(), std::move(index)}, 0};
+  }
+#ifdef LIBPQ_HAS_CHUNK_MODE
+  case PGRES_TUPLES_CHUNK: {
+    const int number = response_row_number_++;
+    if (is_metrics_enabled_)
+      account_rows(number, 1);
+    auto index = field_name_index();
+    if (response_row_number_ < response_.row_count())
+      return Row{Row_info{response_.share(), std::move(index)}, number};
+    else
+      return Row{Row_info{release_response(), std::move(index)}, number};
+  }
+#endif
+  case PGRES_TUPLES_OK:
+    /*
+     * The response is kept until the last row is delivered in order to
+     * provide the command tag by completion().
+     */
+    if (!has_undelivered_rows())
+      return Row{};
+    if (is_metrics_enabled_)
+      account_rows(response_row_number_, 1);
+    return Row{Row_info{response_.share(), field_name_index()},
+      response_row_number_++};
+  default:
+    return {};
+  }
+}
+
+DMITIGR_PGFE_INLINE Row_batch Connection::row_batch() noexcept
+{
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::row_receive};
+  const int offset{response_row_number_};
+  switch (response_.status()) {
+  case PGRES_SINGLE_TUPLE:
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    [[fallthrough]];
+  case PGRES_TUPLES_CHUNK:
+#endif
+  {
+    const int count{response_.row_count() - offset};
+    if (is_metrics_enabled_)
+      account_rows(offset, count);
+    auto index = field_name_index();
+    return Row_batch{Row_info{release_response(), std::move(index)},
+      offset, count};
+  }
+  case PGRES_TUPLES_OK:
+    /*
+     * The response is kept until the last row is delivered in order to
+     * provide the command tag by completion(). (See row().)
+     */
+    if (has_undelivered_rows()) {
+      response_row_number_ = response_.row_count();
+      if (is_metrics_enabled_)
+        account_rows(offset, response_row_number_ - offset);
+      return Row_batch{Row_info{response_.share(), field_name_index()}, offset,
+        response_row_number_ - offset};
+    } else
+      return {};
+  default:
+    return {};
+  }
 }
 
 DMITIGR_PGFE_INLINE Notification Connection::pop_notification()
 {
   auto* const n = PQnotifies(conn());
+  if (n && is_metrics_enabled_)
+    ++metrics_.notification_count;
   return n ? Notification{n} : Notification{};
 }
 
@@ -744,6 +1281,20 @@ DMITIGR_PGFE_INLINE auto Connection::notice_handler() const noexcept
   return notice_handler_;
 }
 
+DMITIGR_PGFE_INLINE void
+Connection::set_notice_min_severity(
+  const std::optional<Problem_severity> severity) noexcept
+{
+  notice_min_severity_ = severity;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::optional<Problem_severity>
+Connection::notice_min_severity() const noexcept
+{
+  return notice_min_severity_;
+}
+
 DMITIGR_PGFE_INLINE void
 Connection::set_notification_handler(Notification_handler handler)
 {
@@ -765,7 +1316,8 @@ DMITIGR_PGFE_INLINE bool Connection::has_response() const noexcept
 DMITIGR_PGFE_INLINE Copier Connection::copier() noexcept
 {
   const auto s = response_.status();
-  return (s == PGRES_COPY_IN || s == PGRES_COPY_OUT) && !*copier_state_ ?
+  return (s == PGRES_COPY_IN || s == PGRES_COPY_OUT || s == PGRES_COPY_BOTH) &&
+    !*copier_state_ ?
     Copier{*this, release_response()} : Copier{};
 }
 
@@ -773,11 +1325,13 @@ DMITIGR_PGFE_INLINE Completion Connection::completion() noexcept
 {
   switch (response_.status()) {
   case PGRES_TUPLES_OK:
-    return Completion{release_response().command_tag()};
+    if (has_undelivered_rows())
+      return {};
+    return Completion{release_response()};
   case PGRES_COMMAND_OK:
     switch (last_processed_request_.id_) {
     case Request::Id::execute:
-      return Completion{release_response().command_tag()};
+      return Completion{release_response()};
     case Request::Id::prepare:
       [[fallthrough]];
     case Request::Id::describe:
@@ -841,30 +1395,88 @@ DMITIGR_PGFE_INLINE bool Connection::has_uncompleted_request() const noexcept
   return !requests_.empty();
 }
 
+DMITIGR_PGFE_INLINE bool Connection::cancel_request_nio()
+{
+  if (!is_connected())
+    throw Client_exception{"cannot cancel request: not connected"};
+
+  if (cancel_request_.valid() && cancel_request_.wait_for(
+      std::chrono::seconds::zero()) != std::future_status::ready)
+    return false;
+
+#ifdef LIBPQ_HAS_ASYNC_CANCEL
+  using Uptr = std::unique_ptr<PGcancelConn, void(*)(PGcancelConn*)>;
+  Uptr cancel{PQcancelCreate(conn()), &PQcancelFinish};
+  if (!cancel)
+    throw Client_exception{"cannot cancel request: "+error_message()};
+  cancel_request_ = std::async(std::launch::async,
+    [cancel = std::move(cancel)]
+    {
+      PQcancelBlocking(cancel.get());
+    });
+#else
+  using Uptr = std::unique_ptr<PGcancel, void(*)(PGcancel*)>;
+  Uptr cancel{PQgetCancel(conn()), &PQfreeCancel};
+  if (!cancel)
+    throw Client_exception{"cannot cancel request: "+error_message()};
+  cancel_request_ = std::async(std::launch::async,
+    [cancel = std::move(cancel)]
+    {
+      char errbuf[256];
+      PQcancel(cancel.get(), errbuf, sizeof(errbuf));
+    });
+#endif
+  return true;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_request_timeout(const std::optional<std::chrono::milliseconds> timeout)
+{
+  if (!(!timeout || timeout->count() > 0))
+    throw Client_exception{"cannot set request timeout: invalid timeout"};
+
+  request_timeout_ = timeout;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Connection::request_timeout() const noexcept
+{
+  return request_timeout_;
+}
+
 DMITIGR_PGFE_INLINE void
-Connection::prepare_nio(const Statement& statement, const std::string& name)
+Connection::prepare_nio(const Statement& statement, const std::string& name,
+  const std::vector<Oid>& parameter_types)
 {
-  prepare_nio__(statement.to_query_string(*this).c_str(),
-    name.c_str(), &statement); // can throw
+  prepare_nio__(query_string__(statement).c_str(),
+    name.c_str(), &statement, parameter_types); // can throw
 }
 
 DMITIGR_PGFE_INLINE void
-Connection::prepare_nio_as_is(const std::string& statement, const std::string& name)
+Connection::prepare_nio_as_is(const std::string& statement,
+  const std::string& name, const std::vector<Oid>& parameter_types)
 {
-  prepare_nio__(statement.c_str(), name.c_str(), nullptr); // can throw
+  prepare_nio__(statement.c_str(), name.c_str(), nullptr,
+    parameter_types); // can throw
 }
 
 DMITIGR_PGFE_INLINE Prepared_statement
-Connection::prepare(const Statement& statement, const std::string& name)
+Connection::prepare(const Statement& statement, const std::string& name,
+  const std::vector<Oid>& parameter_types, const bool describe)
 {
-  using M = void(Connection::*)(const Statement&, const std::string&);
-  return prepare__(static_cast<M>(&Connection::prepare_nio), statement, name);
+  using M = void(Connection::*)(const Statement&, const std::string&,
+    const std::vector<Oid>&);
+  return prepare__(static_cast<M>(&Connection::prepare_nio), statement, name,
+    parameter_types, describe);
 }
 
 DMITIGR_PGFE_INLINE Prepared_statement
-Connection::prepare_as_is(const std::string& statement, const std::string& name)
+Connection::prepare_as_is(const std::string& statement,
+  const std::string& name, const std::vector<Oid>& parameter_types,
+  const bool describe)
 {
-  return prepare__(&Connection::prepare_nio_as_is, statement, name);
+  return prepare__(&Connection::prepare_nio_as_is, statement, name,
+    parameter_types, describe);
 }
 
 DMITIGR_PGFE_INLINE void Connection::describe_nio(const std::string& name)
@@ -872,22 +1484,12 @@ DMITIGR_PGFE_INLINE void Connection::describe_nio(const std::string& name)
   if (!is_ready_for_nio_request())
     throw Client_exception{"cannot describe prepared statement: "
       "not ready for non-blocking IO request"};
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::execute_send};
 
   const auto [p, e] = registered_ps(name);
-  auto state = (p == e) ?
-    std::make_shared<Prepared_statement::State>(name, this) : *p;
-  Prepared_statement ps{state};
-  requests_.emplace(Request::Id::describe, std::move(ps)); // can throw
-  try {
-    const int send_ok = PQsendDescribePrepared(conn(), name.c_str());
-    if (!send_ok)
-      throw Client_exception{error_message()};
-  } catch (...) {
-    requests_.pop(); // rollback
-    throw;
-  }
-
-  assert(is_invariant_ok());
+  describe_nio__((p == e) ?
+    std::make_shared<Prepared_statement::State>(name, this) : p->second);
 }
 
 DMITIGR_PGFE_INLINE Prepared_statement Connection::describe(const std::string& name)
@@ -907,7 +1509,7 @@ DMITIGR_PGFE_INLINE void Connection::unprepare_nio(const std::string& name)
 
   auto name_copy = name; // can throw
   const auto query = "DEALLOCATE " + to_quoted_identifier(name); // can throw
-  execute_nio(query); // can throw
+  execute_nio__(std::shared_ptr{execute_ps_state_}, query); // can throw
   DMITIGR_ASSERT(requests_.front().id_ == Request::Id::execute);
   requests_.front().id_ = Request::Id::unprepare; // cannot throw
   requests_.front().prepared_statement_name_ = std::move(name_copy); // cannot throw
@@ -925,6 +1527,33 @@ DMITIGR_PGFE_INLINE Completion Connection::unprepare(const std::string& name)
   return completion();
 }
 
+DMITIGR_PGFE_INLINE Completion
+Connection::execute_simple(const Statement_vector& statements)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot execute statement vector by simple query: "
+      "not ready for request"};
+
+  std::string query;
+  for (std::size_t i{}; i < statements.size(); ++i) {
+    const auto& statement = statements[i];
+    if (statement.is_query_empty())
+      continue;
+    else if (statement.parameter_count() != statement.bound_parameter_count())
+      throw Client_exception{"cannot execute statement vector by simple query: "
+        "statement " + std::to_string(i) + " has parameters"};
+
+    // The separator is on the new line in case of trailing line comment.
+    if (!query.empty())
+      query += "\n;\n";
+    query += statement.to_query_string(*this);
+  }
+
+  Prepared_statement ps{execute_ps_state_, nullptr, false};
+  ps.execute_simple_nio(query);
+  return completion_or_throw(process_responses(ignore_row));
+}
+
 DMITIGR_PGFE_INLINE void Connection::set_pipeline_enabled(const bool value)
 {
 #ifdef LIBPQ_HAS_PIPELINING
@@ -966,6 +1595,7 @@ DMITIGR_PGFE_INLINE void Connection::send_sync()
 #ifdef LIBPQ_HAS_PIPELINING
   if (!PQpipelineSync(conn()))
     throw Client_exception{"cannot send sync message to the server"};
+  is_output_flushed_ = !is_nio_output_enabled();
   requests_.emplace(Request::Id::sync);
 #else
   throw Client_exception{"cannot send sync message: feature is not available"};
@@ -977,63 +1607,363 @@ DMITIGR_PGFE_INLINE void Connection::send_flush()
 #ifdef LIBPQ_HAS_PIPELINING
   if (!PQsendFlushRequest(conn()))
     throw Client_exception{"cannot send flush message to the server"};
+  is_output_flushed_ = false;
 #else
   throw Client_exception{"cannot send flush message: feature is not available"};
 #endif
 }
 
 DMITIGR_PGFE_INLINE void
-Connection::set_result_format(const Data_format format)
+Connection::set_pipeline_sync_request_threshold(const std::size_t value)
 {
-  default_result_format_ = format;
+  if (!value)
+    throw Client_exception{"cannot set pipeline sync request threshold: "
+      "invalid value"};
+  pipeline_sync_request_threshold_ = value;
   assert(is_invariant_ok());
 }
 
-DMITIGR_PGFE_INLINE Data_format Connection::result_format() const noexcept
+DMITIGR_PGFE_INLINE std::size_t
+Connection::pipeline_sync_request_threshold() const noexcept
 {
-  return default_result_format_;
+  return pipeline_sync_request_threshold_;
 }
 
-DMITIGR_PGFE_INLINE Oid Connection::create_large_object(const Oid oid)
+DMITIGR_PGFE_INLINE void
+Connection::set_pipeline_sync_byte_threshold(const std::size_t value)
 {
-  if (!is_ready_for_request())
-    throw Client_exception{"cannot create large object: not ready for request"};
-  const Oid result = (oid == invalid_oid) ?
-    lo_creat(conn(),
-      static_cast<int>(
-        Large_object_open_mode::reading |
-        Large_object_open_mode::writing)) :
-    lo_create(conn(), oid);
-  if (result == invalid_oid)
-    throw Client_exception{"cannot create large object: "+error_message()};
-  return result;
+  if (!value)
+    throw Client_exception{"cannot set pipeline sync byte threshold: "
+      "invalid value"};
+  pipeline_sync_byte_threshold_ = value;
+  assert(is_invariant_ok());
 }
 
-DMITIGR_PGFE_INLINE Large_object Connection::open_large_object(const Oid oid,
-  const Large_object_open_mode mode)
+DMITIGR_PGFE_INLINE std::size_t
+Connection::pipeline_sync_byte_threshold() const noexcept
 {
-  if (!is_ready_for_request())
-    throw Client_exception{"cannot open large object: not ready for request"};
+  return pipeline_sync_byte_threshold_;
+}
 
-  const int desc{lo_open(conn(), oid, static_cast<int>(mode))};
-  if (desc < 0)
-    throw Client_exception{"cannot open large object: "+error_message()};
+DMITIGR_PGFE_INLINE void
+Connection::set_pipeline_max_depth(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set pipeline max depth: invalid value"};
+  pipeline_max_depth_ = value;
+  assert(is_invariant_ok());
+}
 
-  Large_object result{std::make_shared<Large_object::State>(++lo_id_, desc, this)};
-  register_lo(result);
-  return result;
+DMITIGR_PGFE_INLINE std::size_t Connection::pipeline_max_depth() const noexcept
+{
+  return pipeline_max_depth_;
 }
 
-DMITIGR_PGFE_INLINE void Connection::remove_large_object(const Oid oid)
+DMITIGR_PGFE_INLINE void Connection::poll_pipeline()
 {
-  if (!is_ready_for_request())
-    throw Client_exception{"cannot remove large object: not ready for request"};
+  if (pipeline_status() == Pipeline_status::disabled)
+    throw Client_exception{"cannot poll pipeline: pipeline is disabled"};
 
-  if (lo_unlink(conn(), oid) == -1)
-    throw Client_exception{"cannot remove large object: "+error_message()};
+  while (has_uncompleted_request()) {
+    if (handle_input(false) == Response_status::ready)
+      dispatch_pipeline_response();
+    else if (socket_readiness(Socket_readiness::read_ready) ==
+      Socket_readiness::read_ready)
+      read_input();
+    else
+      break;
+  }
 }
 
-DMITIGR_PGFE_INLINE Oid
+DMITIGR_PGFE_INLINE void Connection::complete_pipeline()
+{
+  if (pipeline_status() == Pipeline_status::disabled)
+    throw Client_exception{"cannot complete pipeline: pipeline is disabled"};
+
+  if (!requests_.empty() && requests_.back().id_ != Request::Id::sync)
+    send_pipeline_sync();
+
+  while (has_uncompleted_request()) {
+    wait_response();
+    dispatch_pipeline_response();
+  }
+  DMITIGR_ASSERT(!has_uncompleted_request());
+}
+
+DMITIGR_PGFE_INLINE std::vector<std::size_t>
+Connection::drain_aborted_pipeline()
+{
+  if (pipeline_status() == Pipeline_status::disabled)
+    throw Client_exception{"cannot drain aborted pipeline: "
+      "pipeline is disabled"};
+
+  std::vector<std::size_t> result;
+#ifdef LIBPQ_HAS_PIPELINING
+  if (pipeline_status() != Pipeline_status::aborted)
+    return result;
+
+  // Complete and discard the current response.
+  while (response_status_ == Response_status::unready)
+    handle_input(true);
+  response_.reset();
+  response_status_ = Response_status::empty;
+  is_row_delivery_mode_set_ = false;
+
+  for (std::size_t index{}; !requests_.empty() &&
+         requests_.front().id_ != Request::Id::sync; ++index) {
+    const detail::pq::Result r{PQgetResult(conn())};
+    const auto status = r.status();
+    if (r) {
+      while (auto* const nr = PQgetResult(conn()))
+        PQclear(nr);
+    }
+
+    if (is_metrics_enabled_)
+      account_response(status);
+    if (status == PGRES_PIPELINE_ABORTED)
+      result.push_back(index);
+    auto handler = std::move(requests_.front().pipeline_handler_);
+    dismiss_request(status);
+    if (handler)
+      handler->handle(Error{});
+  }
+#endif
+  assert(is_invariant_ok());
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_result_format(const Data_format format)
+{
+  default_result_format_ = format;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE Data_format Connection::result_format() const noexcept
+{
+  return default_result_format_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_simple_query_enabled(const bool value) noexcept
+{
+  is_simple_query_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Connection::is_simple_query_enabled() const noexcept
+{
+  return is_simple_query_enabled_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_row_delivery_mode(const Row_delivery_mode mode)
+{
+  throw_if_row_delivery_mode_unavailable(mode);
+  default_row_delivery_mode_ = mode;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE Row_delivery_mode
+Connection::row_delivery_mode() const noexcept
+{
+  return default_row_delivery_mode_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::set_rows_chunk_size(const std::size_t size)
+{
+  if (!(0 < size && size <= static_cast<std::size_t>(INT_MAX)))
+    throw Client_exception{"cannot set rows chunk size: invalid size"};
+  rows_chunk_size_ = static_cast<int>(size);
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection::rows_chunk_size() const noexcept
+{
+  return static_cast<std::size_t>(rows_chunk_size_);
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_result_memory_limit(const std::optional<std::size_t> limit)
+{
+  if (!(!limit || *limit > 0))
+    throw Client_exception{"cannot set result memory limit: invalid limit"};
+
+  result_memory_limit_ = limit;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::size_t>
+Connection::result_memory_limit() const noexcept
+{
+  return result_memory_limit_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_result_memory_policy(const Result_memory_policy policy) noexcept
+{
+  result_memory_policy_ = policy;
+}
+
+DMITIGR_PGFE_INLINE Result_memory_policy
+Connection::result_memory_policy() const noexcept
+{
+  return result_memory_policy_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_statement_cache_capacity(const std::size_t capacity)
+{
+  while (statement_cache_.size() > capacity)
+    evict_statement_cache_entry__(); // can throw
+  statement_cache_capacity_ = capacity;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection::statement_cache_capacity() const noexcept
+{
+  return statement_cache_capacity_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection::statement_cache_size() const noexcept
+{
+  return statement_cache_.size();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_statement_cache_threshold(const std::size_t count)
+{
+  if (!count)
+    throw Client_exception{"cannot set statement cache threshold: "
+      "invalid count"};
+  statement_cache_threshold_ = count;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection::statement_cache_threshold() const noexcept
+{
+  return statement_cache_threshold_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::clear_statement_cache()
+{
+  while (!statement_cache_.empty())
+    evict_statement_cache_entry__(); // can throw
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_routine_cache_enabled(const bool value) noexcept
+{
+  is_routine_cache_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Connection::is_routine_cache_enabled() const noexcept
+{
+  return is_routine_cache_enabled_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection::routine_cache_size() const noexcept
+{
+  return routine_cache_.size();
+}
+
+DMITIGR_PGFE_INLINE void Connection::clear_routine_cache()
+{
+  while (!routine_cache_.empty()) {
+    const auto i = routine_cache_.begin();
+    if (const auto& state = i->second.state_; state && state->connection_ == this)
+      unprepare(state->id_); // can throw
+    routine_cache_.erase(i);
+  }
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE void Connection::set_prepared_statement_registry(
+  std::shared_ptr<Prepared_statement_registry> registry)
+{
+  if (!registry)
+    throw Client_exception{"cannot set prepared statement registry: "
+      "invalid registry"};
+  ps_registry_ = std::move(registry);
+  ps_registry_states_.clear();
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Prepared_statement_registry>&
+Connection::prepared_statement_registry() const noexcept
+{
+  return ps_registry_;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement
+Connection::registered_statement(const std::string_view name)
+{
+  const auto entry = ps_registry_->entry(name);
+  if (!entry)
+    throw Client_exception{"cannot get registered statement "
+      + std::string{name} + ": no such statement in registry"};
+
+  auto i = ps_registry_states_.find(entry->name_);
+  if (i == ps_registry_states_.end() || i->second->connection_ != this) {
+    prepare_registered__({entry}); // can throw
+    i = ps_registry_states_.find(entry->name_);
+    DMITIGR_ASSERT(i != ps_registry_states_.end());
+  }
+  return Prepared_statement{i->second, &entry->statement_, true};
+}
+
+DMITIGR_PGFE_INLINE void Connection::prepare_registered_statements()
+{
+  auto entries = ps_registry_->entries();
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+    [this](const auto& entry)
+    {
+      const auto i = ps_registry_states_.find(entry->name_);
+      return i != ps_registry_states_.end() && i->second->connection_ == this;
+    }), entries.end());
+  prepare_registered__(entries);
+}
+
+DMITIGR_PGFE_INLINE Oid Connection::create_large_object(const Oid oid)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot create large object: not ready for request"};
+  const Oid result = (oid == invalid_oid) ?
+    lo_creat(conn(),
+      static_cast<int>(
+        Large_object_open_mode::reading |
+        Large_object_open_mode::writing)) :
+    lo_create(conn(), oid);
+  if (result == invalid_oid)
+    throw Client_exception{"cannot create large object: "+error_message()};
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Large_object Connection::open_large_object(const Oid oid,
+  const Large_object_open_mode mode)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot open large object: not ready for request"};
+
+  const int desc{lo_open(conn(), oid, static_cast<int>(mode))};
+  if (desc < 0)
+    throw Client_exception{"cannot open large object: "+error_message()};
+
+  Large_object result{std::make_shared<Large_object::State>(++lo_id_, desc, this)};
+  register_lo(result);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Connection::remove_large_object(const Oid oid)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot remove large object: not ready for request"};
+
+  if (lo_unlink(conn(), oid) == -1)
+    throw Client_exception{"cannot remove large object: "+error_message()};
+}
+
+DMITIGR_PGFE_INLINE Oid
 Connection::import_large_object(const std::filesystem::path& filename,
   const Oid oid)
 {
@@ -1058,36 +1988,81 @@ Connection::export_large_object(const Oid oid,
     throw Client_exception{"cannot export large object: "+error_message()};
 }
 
+DMITIGR_PGFE_INLINE std::size_t
+Connection::read_large_object_range(const Oid oid,
+  const std::int_fast64_t offset, char* const buf, const std::size_t size)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot read large object range: "
+      "not ready for request"};
+  else if (offset < 0)
+    throw Client_exception{"cannot read large object range: invalid offset"};
+  else if (!buf && size)
+    throw Client_exception{"cannot read large object range: invalid buffer"};
+  else if (size > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    throw Client_exception{"cannot read large object range: invalid size"};
+  else if (!size)
+    return 0;
+
+  const auto& entry = routine_cache_entry__(
+    "select pg_catalog.lo_get($1, $2, $3)"); // can throw
+  Prepared_statement ps{entry.state_, entry.statement_.get(), false};
+  ps.set_result_format(Data_format::binary);
+  std::size_t result{};
+  ps.execute([buf, size, &result](auto&& row)
+  {
+    if (const auto data = row.data()) {
+      result = std::min(data.size(), size);
+      std::memcpy(buf, data.bytes(), result);
+    }
+  }, static_cast<long long>(oid), offset, static_cast<int>(size));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::vector<std::byte>
+Connection::read_large_object_range(const Oid oid,
+  const std::int_fast64_t offset, const std::size_t length)
+{
+  std::vector<std::byte> result(length);
+  result.resize(read_large_object_range(oid, offset,
+      reinterpret_cast<char*>(result.data()), length));
+  return result;
+}
+
 DMITIGR_PGFE_INLINE std::string
 Connection::to_quoted_literal(const std::string_view literal) const
+{
+  std::string result;
+  append_quoted_literal(result, literal);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::string
+Connection::to_quoted_identifier(const std::string_view identifier) const
+{
+  std::string result;
+  append_quoted_identifier(result, identifier);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::append_quoted_literal(std::string& result,
+  const std::string_view literal) const
 {
   if (!is_connected())
     throw Client_exception{"cannot quote literal: not connected"};
 
-  using Uptr = std::unique_ptr<char, void(*)(void*)>;
-  if (const auto p = Uptr{PQescapeLiteral(conn(), literal.data(),
-        literal.size()), &PQfreemem})
-    return p.get();
-  else if (is_out_of_memory())
-    throw std::bad_alloc{};
-  else
-    throw Client_exception{error_message()};
+  append_quoted(result, literal, false);
 }
 
-DMITIGR_PGFE_INLINE std::string
-Connection::to_quoted_identifier(const std::string_view identifier) const
+DMITIGR_PGFE_INLINE void
+Connection::append_quoted_identifier(std::string& result,
+  const std::string_view identifier) const
 {
   if (!is_connected())
     throw Client_exception{"cannot quote identifier: not connected"};
 
-  using Uptr = std::unique_ptr<char, void(*)(void*)>;
-  if (const auto p = Uptr{PQescapeIdentifier(conn(), identifier.data(),
-        identifier.size()), &PQfreemem})
-    return p.get();
-  else if (is_out_of_memory())
-    throw std::bad_alloc{};
-  else
-    throw Client_exception{error_message()};
+  append_quoted(result, identifier, true);
 }
 
 DMITIGR_PGFE_INLINE std::unique_ptr<Data>
@@ -1103,6 +2078,20 @@ DMITIGR_PGFE_INLINE std::string Connection::to_hex_string(const Data& data) cons
   return std::string{static_cast<const char*>(storage.get()), size};
 }
 
+DMITIGR_PGFE_INLINE void
+Connection::set_type_catalog(std::shared_ptr<Type_catalog> catalog)
+{
+  if (!catalog)
+    throw Client_exception{"cannot set type catalog: invalid catalog"};
+  type_catalog_ = std::move(catalog);
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Type_catalog>&
+Connection::type_catalog() const noexcept
+{
+  return type_catalog_;
+}
+
 // -----------------------------------------------------------------------------
 // private
 // -----------------------------------------------------------------------------
@@ -1124,6 +2113,7 @@ DMITIGR_PGFE_INLINE bool Connection::is_invariant_ok() const noexcept
     (response_status_ == Response_status::empty) &&
     ps_states_.empty() &&
     lo_states_.empty() &&
+    statement_cache_.empty() &&
     requests_.empty();
   const bool session_data_ok = session_data_empty ||
     (status() == Status::failure) || (status() == Status::connected);
@@ -1131,6 +2121,9 @@ DMITIGR_PGFE_INLINE bool Connection::is_invariant_ok() const noexcept
   const bool sess_time_ok = !is_connected() || session_start_time();
   const bool pid_ok = !is_connected() || server_pid();
   const bool readiness_ok = is_ready_for_nio_request() || !is_ready_for_request();
+  const bool statement_cache_ok =
+    (statement_cache_.size() <= statement_cache_capacity_) &&
+    (statement_cache_.size() == statement_cache_index_.size());
 
   // std::clog << conn_ok << " "
   //           << polling_status_ok << " "
@@ -1141,6 +2134,7 @@ DMITIGR_PGFE_INLINE bool Connection::is_invariant_ok() const noexcept
   //           << sess_time_ok << " "
   //           << pid_ok << " "
   //           << readiness_ok << " "
+  //           << statement_cache_ok << " "
   //           << std::endl;
 
   return
@@ -1152,12 +2146,14 @@ DMITIGR_PGFE_INLINE bool Connection::is_invariant_ok() const noexcept
     trans_ok &&
     sess_time_ok &&
     pid_ok &&
-    readiness_ok;
+    readiness_ok &&
+    statement_cache_ok;
 }
 
 DMITIGR_PGFE_INLINE detail::pq::Result Connection::release_response() noexcept
 {
   response_status_ = Response_status::empty;
+  response_row_number_ = 0;
   return std::move(response_);
 }
 
@@ -1168,26 +2164,121 @@ Connection::reset_response(detail::pq::Result&& response) noexcept
     response_status_ = Response_status::ready;
 }
 
+DMITIGR_PGFE_INLINE void Connection::send_pipeline_sync()
+{
+  send_sync();
+  pipeline_unsynced_request_count_ = 0;
+  pipeline_unsynced_byte_count_ = 0;
+}
+
+DMITIGR_PGFE_INLINE void Connection::wait_pipeline_capacity()
+{
+  if (pipeline_status() == Pipeline_status::disabled)
+    return;
+
+  // Apply the backpressure.
+  while (requests_.size() >= pipeline_max_depth_) {
+    if (requests_.back().id_ != Request::Id::sync)
+      send_pipeline_sync();
+    wait_response();
+    dispatch_pipeline_response();
+  }
+}
+
+DMITIGR_PGFE_INLINE void Connection::register_pipelined_request(
+  std::unique_ptr<detail::Pipeline_handler>&& handler,
+  const Statement& statement)
+{
+  DMITIGR_ASSERT(!requests_.empty());
+  DMITIGR_ASSERT(requests_.back().id_ == Request::Id::execute);
+  requests_.back().pipeline_handler_ = std::move(handler);
+  if (pipeline_status() == Pipeline_status::disabled)
+    return;
+
+  ++pipeline_unsynced_request_count_;
+  pipeline_unsynced_byte_count_ += query_string__(statement).size();
+  if (pipeline_unsynced_request_count_ >= pipeline_sync_request_threshold_ ||
+    pipeline_unsynced_byte_count_ >= pipeline_sync_byte_threshold_)
+    send_pipeline_sync();
+
+  poll_pipeline();
+}
+
+DMITIGR_PGFE_INLINE void Connection::dispatch_pipeline_response()
+{
+  const auto status = response_.status();
+  const bool is_row_chunk{status == PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    || status == PGRES_TUPLES_CHUNK
+#endif
+  };
+
+  /*
+   * The request is dismissed only when the response is complete. Thus, the
+   * rows of the incomplete response belong to the request at the front of
+   * the queue, and complete responses belong to the last processed request.
+   */
+  auto& request = is_row_chunk ? requests_.front() : last_processed_request_;
+  detail::Pipeline_handler* const handler = request.pipeline_handler_.get();
+  if (auto r = row()) {
+    do {
+      if (handler)
+        handler->handle(std::move(r));
+    } while ( (r = row()));
+  } else if (auto c = completion()) {
+    if (handler)
+      handler->handle(std::move(c));
+  } else if (auto e = error()) {
+    if (handler)
+      handler->handle(std::move(e));
+  } else if (!ready_for_query()) {
+#ifdef LIBPQ_HAS_PIPELINING
+    if (status == PGRES_PIPELINE_ABORTED && handler)
+      handler->handle(Error{});
+#endif
+    release_response();
+  }
+}
+
+DMITIGR_PGFE_INLINE void Connection::set_socket_options__()
+{
+  if (options_.communication_mode() != Communication_mode::net)
+    return;
+
+  net::Tcp_options options;
+  options.no_delay = options_.tcp_no_delay();
+  options.send_buffer_size = options_.socket_send_buffer_size();
+  options.receive_buffer_size = options_.socket_receive_buffer_size();
+  options.busy_poll = options_.socket_busy_poll();
+  try {
+    net::set_tcp_options(static_cast<net::Socket_native>(socket()), options);
+  } catch (const std::exception& e) {
+    throw Client_exception{std::string{"cannot set socket options: "}
+      .append(e.what())};
+  }
+}
+
 DMITIGR_PGFE_INLINE void Connection::reset_session() noexcept
 {
   session_start_time_.reset();
   response_.reset();
   response_status_ = {};
-  requests_ = {};
+  response_row_number_ = 0;
+  requests_.clear();
+  pipeline_unsynced_request_count_ = 0;
+  pipeline_unsynced_byte_count_ = 0;
   is_output_flushed_ = true;
   reset_copier_state();
-  is_single_row_mode_enabled_ = false;
+  is_row_delivery_mode_set_ = false;
 
   // Reset prepared statements.
   last_prepared_statement_ = {};
-  for (auto& s : ps_states_) {
-    DMITIGR_ASSERT(s);
-    s->connection_ = nullptr;
-  }
-  ps_states_.clear();
+  reset_prepared_statements();
+  reset_statement_cache();
+  query_strings_.clear();
 
   // Reset large objects.
-  for (auto& s : lo_states_) {
+  for (auto& [id, s] : lo_states_) {
     DMITIGR_ASSERT(s);
     s->connection_ = nullptr;
   }
@@ -1202,11 +2293,58 @@ DMITIGR_PGFE_INLINE void Connection::reset_copier_state() noexcept
   }
 }
 
-DMITIGR_PGFE_INLINE void Connection::set_single_row_mode_enabled() noexcept
+DMITIGR_PGFE_INLINE void Connection::reset_prepared_statements() noexcept
+{
+  for (auto& [id, s] : ps_states_) {
+    DMITIGR_ASSERT(s);
+    s->connection_ = nullptr;
+  }
+  ps_states_.clear();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::set_row_delivery_mode_enabled(const Request& request) noexcept
+{
+  switch (request.row_delivery_mode_) {
+  case Row_delivery_mode::single: {
+    const auto set_ok = PQsetSingleRowMode(conn());
+    DMITIGR_ASSERT(set_ok);
+    break;
+  }
+  case Row_delivery_mode::chunked: {
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    const auto set_ok = PQsetChunkedRowsMode(conn(),
+      request.rows_chunk_size_ > 0 ? request.rows_chunk_size_ : rows_chunk_size_);
+    DMITIGR_ASSERT(set_ok);
+#else
+    DMITIGR_ASSERT(false);
+#endif
+    break;
+  }
+  case Row_delivery_mode::full:
+    break;
+  case Row_delivery_mode::adaptive:
+    DMITIGR_ASSERT(false); // resolved by Prepared_statement::execute_nio()
+  }
+  is_row_delivery_mode_set_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Connection::has_undelivered_rows() const noexcept
+{
+  return response_.status() == PGRES_TUPLES_OK &&
+    response_row_number_ < response_.row_count();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::throw_if_row_delivery_mode_unavailable(const Row_delivery_mode mode)
 {
-  const auto set_ok = PQsetSingleRowMode(conn());
-  DMITIGR_ASSERT(set_ok);
-  is_single_row_mode_enabled_ = true;
+#ifndef LIBPQ_HAS_CHUNK_MODE
+  if (mode == Row_delivery_mode::chunked)
+    throw Client_exception{"cannot set chunked row delivery mode: "
+      "feature is not available"};
+#else
+  (void)mode;
+#endif
 }
 
 DMITIGR_PGFE_INLINE void
@@ -1215,7 +2353,17 @@ Connection::notice_receiver(void* const arg, const PGresult* const r) noexcept
   DMITIGR_ASSERT(arg);
   DMITIGR_ASSERT(r);
   auto* const cn = static_cast<Connection*>(arg);
+  if (cn->is_metrics_enabled_)
+    ++cn->metrics_.notice_count;
   if (cn->notice_handler_) {
+    // Skip the notices of lesser severity without creating Notice.
+    if (const auto min_severity = cn->notice_min_severity_) {
+      const char* const s{PQresultErrorField(r,
+          PG_DIAG_SEVERITY_NONLOCALIZED)};
+      if (const auto severity = s ? to_problem_severity(s) : std::nullopt;
+        severity && *severity < *min_severity)
+        return;
+    }
     try {
       cn->notice_handler_(Notice{r});
     } catch (const std::exception& e) {
@@ -1234,31 +2382,137 @@ Connection::default_notice_handler(const Notice& n) noexcept
 
 DMITIGR_PGFE_INLINE void
 Connection::prepare_nio__(const char* const query, const char* const name,
-  const Statement* const preparsed)
+  const Statement* const preparsed, const std::vector<Oid>& parameter_types)
 {
+  static_assert(std::is_same_v<Oid, ::Oid>);
   if (!is_ready_for_nio_request())
     throw Client_exception{"cannot prepare statement: "
       "not ready for non-blocking IO request"};
+  else if (!(parameter_types.size() <= Prepared_statement::max_parameter_count()))
+    throw Client_exception{"cannot prepare statement: too many parameter types"};
   DMITIGR_ASSERT(query);
   DMITIGR_ASSERT(name);
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::execute_send};
 
   auto state = std::make_shared<Prepared_statement::State>(name, this);
   Prepared_statement ps{std::move(state), preparsed, true};
+  const auto type_count = std::min(parameter_types.size(), ps.parameter_count());
+  for (std::size_t i{}; i < type_count; ++i)
+    ps.parameters_[i].type = parameter_types[i];
   requests_.emplace(Request::Id::prepare, std::move(ps));
+  std::size_t byte_count{};
+  try {
+    prepare_trace(Trace_request::prepare, query, name, 0); // can throw
+    const auto text = tagged_query(query); // can throw
+    const int send_ok{PQsendPrepare(conn(), name, text.data(),
+      static_cast<int>(parameter_types.size()),
+      parameter_types.empty() ? nullptr : parameter_types.data())};
+    if (!send_ok)
+      throw Client_exception{error_message()};
+    byte_count = text.size();
+    if (traffic_recorder_)
+      traffic_recorder_->record_prepare(traffic_session_, name, query,
+        parameter_types);
+  } catch (...) {
+    requests_.pop_back(); // rollback
+    throw;
+  }
+  account_request(byte_count);
+
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::execute_recorded_nio__(const Statement& statement,
+  const std::vector<std::optional<Data_view>>& parameters,
+  const std::vector<Oid>& parameter_types, const Data_format result_format)
+{
+  Prepared_statement ps{execute_ps_state_, &statement, false};
+  const auto count = std::min(parameters.size(), ps.parameter_count());
+  for (std::size_t i{}; i < count; ++i) {
+    if (i < parameter_types.size())
+      ps.set_parameter_type(i, parameter_types[i]);
+    if (const auto& value = parameters[i])
+      ps.bind_no_copy(i, std::string_view{static_cast<const char*>(
+        value->bytes()), value->size()}, value->format());
+  }
+  ps.set_result_format(result_format);
+  ps.execute_nio(statement);
+}
+
+DMITIGR_PGFE_INLINE bool
+Connection::is_static_parameters_allowed__(const Statement& statement,
+  const std::size_t count) const noexcept
+{
+  return !statement_cache_capacity_ && statement.parameter_count() == count &&
+    !statement.bound_parameter_count();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::describe_nio__(std::shared_ptr<Prepared_statement::State> state)
+{
+  DMITIGR_ASSERT(state);
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::execute_send};
+
+  const auto& name = state->id_;
+  requests_.emplace(Request::Id::describe,
+    Prepared_statement{std::move(state)}); // can throw
   try {
-    constexpr int n_params{};
-    constexpr const ::Oid* const param_types{};
-    const int send_ok{PQsendPrepare(conn(), name, query, n_params, param_types)};
+    prepare_trace(Trace_request::describe, {}, name, 0); // can throw
+    const int send_ok = PQsendDescribePrepared(conn(), name.c_str());
     if (!send_ok)
       throw Client_exception{error_message()};
   } catch (...) {
-    requests_.pop(); // rollback
+    requests_.pop_back(); // rollback
     throw;
   }
+  account_request(name.size());
 
   assert(is_invariant_ok());
 }
 
+DMITIGR_PGFE_INLINE Prepared_statement
+Connection::wait_prepared_described_statement__()
+{
+  DMITIGR_ASSERT(!requests_.empty() &&
+    requests_.back().id_ == Request::Id::prepare);
+
+  /*
+   * The describe request shares the state of the statement being prepared,
+   * thus the description is applied to the statement returned.
+   */
+  Prepared_statement result;
+  Error error;
+  try {
+    describe_nio__(requests_.back().prepared_statement_.state_); // can throw
+    send_sync(); // can throw
+    while (has_uncompleted_request()) {
+      wait_response(); // can throw
+      if (auto e = this->error()) {
+        if (!error)
+          error = std::move(e);
+      } else if (!ready_for_query()) {
+        if (auto ps = prepared_statement(); !result)
+          result = std::move(ps);
+        else if (ps)
+          result.parameters_.resize(ps.parameters_.size());
+      }
+    }
+  } catch (...) {
+    disconnect(); // the state of the pipeline is unknown
+    throw;
+  }
+  set_pipeline_enabled(false);
+
+  if (error)
+    throw Server_exception{std::make_shared<Error>(std::move(error))};
+
+  DMITIGR_ASSERT(result && result.is_described());
+  return result;
+}
+
 DMITIGR_PGFE_INLINE Prepared_statement Connection::wait_prepared_statement__()
 {
   wait_response_throw();
@@ -1273,7 +2527,7 @@ DMITIGR_PGFE_INLINE void
 Connection::register_ps(Prepared_statement&& ps)
 {
   if (const auto [p, e] = registered_ps(ps.name()); p == e)
-    ps_states_.push_back(ps.state_); // can throw
+    ps_states_.emplace(ps.state_->id_, ps.state_); // can throw
   last_prepared_statement_ = std::move(ps);
   DMITIGR_ASSERT(last_prepared_statement_);
 }
@@ -1292,6 +2546,372 @@ Connection::unregister_ps(decltype(ps_states_)::const_iterator p) noexcept
   unregister(ps_states_, p);
 }
 
+DMITIGR_PGFE_INLINE std::shared_ptr<Prepared_statement::State>
+Connection::statement_cache_state__(const Statement& statement,
+  const bool is_preparing_allowed, const Prepared_statement& bound)
+{
+  if (!statement_cache_capacity_)
+    return execute_ps_state_;
+  return statement_cache_state__(query_string__(statement), // can throw
+    is_preparing_allowed, bound);
+}
+
+DMITIGR_PGFE_INLINE std::shared_ptr<Prepared_statement::State>
+Connection::statement_cache_state__(const std::string& query,
+  const bool is_preparing_allowed, const Prepared_statement& bound)
+{
+  if (!statement_cache_capacity_)
+    return execute_ps_state_;
+
+  auto& cache = statement_cache_;
+  auto& index = statement_cache_index_;
+  if (const auto i = index.find(query); i != index.cend()) {
+    cache.splice(cache.begin(), cache, i->second); // mark as MRU
+  } else {
+    if (cache.size() >= statement_cache_capacity_) {
+      /*
+       * Deallocation of the prepared statement requires the round trip to the
+       * server, which is possible only if the connection is ready for request.
+       */
+      if (cache.back().state_ && !is_preparing_allowed)
+        return execute_ps_state_;
+      evict_statement_cache_entry__(); // can throw
+    }
+    cache.emplace_front(); // can throw
+    try {
+      cache.front().query_ = query; // can throw
+      index.emplace(cache.front().query_, cache.begin()); // can throw
+    } catch (...) {
+      cache.pop_front(); // rollback
+      throw;
+    }
+  }
+
+  auto& entry = cache.front();
+  if (entry.state_ && entry.state_->connection_ != this) {
+    // The statement has been deallocated by the user.
+    entry.state_.reset();
+    entry.execution_count_ = 0;
+  }
+  ++entry.execution_count_;
+
+  if (!entry.state_ && is_preparing_allowed &&
+    entry.execution_count_ >= statement_cache_threshold_) {
+    auto name = "pgfe_cached_" + std::to_string(++statement_cache_ps_id_);
+    std::vector<Oid> types(bound.parameter_count());
+    for (std::size_t i{}; i < types.size(); ++i)
+      types[i] = bound.parameter_type(i);
+    while (!types.empty() && types.back() == invalid_oid)
+      types.pop_back();
+    const auto ps = prepare_as_is(entry.query_, name, types); // can throw
+    entry.state_ = ps.state_;
+  }
+
+  return entry.state_ ? entry.state_ : execute_ps_state_;
+}
+
+DMITIGR_PGFE_INLINE void Connection::evict_statement_cache_entry__()
+{
+  DMITIGR_ASSERT(!statement_cache_.empty());
+  auto& entry = statement_cache_.back();
+  if (entry.state_ && entry.state_->connection_ == this)
+    unprepare(entry.state_->id_); // can throw
+  statement_cache_index_.erase(entry.query_);
+  statement_cache_.pop_back();
+}
+
+DMITIGR_PGFE_INLINE void Connection::reset_statement_cache() noexcept
+{
+  statement_cache_index_.clear();
+  statement_cache_.clear();
+}
+
+DMITIGR_PGFE_INLINE auto Connection::routine_cache_entry__(std::string&& query)
+  -> Routine_cache_entry&
+{
+  auto i = routine_cache_.find(query);
+  if (i == routine_cache_.end()) {
+    auto statement = std::make_shared<Statement>(query); // can throw
+    i = routine_cache_.emplace(std::move(query),
+      Routine_cache_entry{std::move(statement), nullptr}).first; // can throw
+  }
+
+  // The statement could be deallocated by the user or by DISCARD ALL.
+  auto& entry = i->second;
+  if (!entry.state_ || entry.state_->connection_ != this) {
+    auto name = "pgfe_routine_" + std::to_string(++routine_cache_ps_id_);
+    const auto ps = prepare_as_is(query_string__(*entry.statement_),
+      name); // can throw
+    entry.state_ = ps.state_;
+  }
+  return entry;
+}
+
+DMITIGR_PGFE_INLINE void Connection::prepare_registered__(
+  const std::vector<std::shared_ptr<detail::Registered_statement>>& entries)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot prepare registered statements: "
+      "not ready for request"};
+  else if (entries.empty())
+    return;
+
+  const auto wait_responses = [this](const auto& handle)
+  {
+    send_sync();
+    Error error;
+    while (has_uncompleted_request()) {
+      wait_response();
+      if (auto e = this->error()) {
+        if (!error)
+          error = std::move(e);
+      } else if (!ready_for_query())
+        handle(prepared_statement());
+    }
+    return error;
+  };
+
+  const auto entry_of = [&entries](const Prepared_statement& ps)
+  {
+    const auto i = std::find_if(entries.begin(), entries.end(),
+      [&ps](const auto& entry){return entry->name_ == ps.name();});
+    DMITIGR_ASSERT(i != entries.end());
+    return *i;
+  };
+
+  /*
+   * The statements are prepared with the shared description at first, and
+   * the statements without the description are described afterwards.
+   */
+  Pipeline_scope pipeline{*this};
+  for (const auto& entry : entries)
+    prepare_nio(entry->statement_, entry->name_,
+      ps_registry_->parameter_types(*entry));
+  bool is_undescribed{};
+  auto error = wait_responses([this, &entry_of,
+      &is_undescribed](Prepared_statement&& ps)
+  {
+    const auto entry = entry_of(ps);
+    ps_registry_states_[entry->name_] = ps.state_;
+    if (auto description = ps_registry_->description(*entry))
+      ps.set_description(std::move(description));
+    else
+      is_undescribed = true;
+  });
+  if (!error && is_undescribed) {
+    for (const auto& entry : entries) {
+      if (!ps_registry_->description(*entry))
+        describe_nio(entry->name_);
+    }
+    error = wait_responses([this, &entry_of](Prepared_statement&& ps)
+    {
+      ps_registry_->set_description(*entry_of(ps),
+        ps.state_->description_.pq_result_);
+    });
+  }
+  pipeline.restore();
+
+  if (error)
+    throw Server_exception{std::make_shared<Error>(std::move(error))};
+}
+
+DMITIGR_PGFE_INLINE long
+Connection::copy_into__(const std::string_view table,
+  const std::vector<std::string>& columns,
+  const std::vector<std::string>& conflict_columns,
+  const std::function<void(Copy_binary_writer&)>& write_rows)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot copy into table: not ready for request"};
+  else if (columns.empty())
+    throw Client_exception{"cannot copy into table: no columns specified"};
+
+  const auto to_list = [this](const std::vector<std::string>& names,
+    const char* const suffix = nullptr)
+  {
+    std::string result;
+    for (const auto& name : names) {
+      if (!result.empty())
+        result += ", ";
+      const auto quoted = to_quoted_identifier(name);
+      result += quoted;
+      if (suffix)
+        result.append(" = ").append(suffix).append(quoted);
+    }
+    return result;
+  };
+  const auto column_list = to_list(columns);
+  const bool is_upsert{!conflict_columns.empty()};
+  /*
+   * The temporary table is named uniquely and dropped on commit, so neither
+   * the nested calls nor the tables left by the failed calls can collide.
+   */
+  std::string temporary_table;
+  bool is_own_transaction{};
+  if (is_upsert) {
+    static std::atomic<std::uint64_t> counter;
+    temporary_table = "pgfe_copy_into_" + std::to_string(++counter);
+    if (transaction_status() == Transaction_status::unstarted) {
+      execute("begin");
+      is_own_transaction = true;
+    }
+    try {
+      execute("create temp table " + temporary_table +
+        " on commit drop as select " + column_list + " from " +
+        std::string{table} + " with no data");
+    } catch (...) {
+      if (is_own_transaction && is_connected() && is_ready_for_request()) {
+        try {
+          execute("rollback");
+        } catch (...) {}
+      }
+      throw;
+    }
+  }
+
+  try {
+    execute("copy " + (is_upsert ? temporary_table : std::string{table}) +
+      " (" + column_list + ") from stdin (format binary)");
+    auto copier = this->copier();
+    DMITIGR_ASSERT(copier);
+    {
+      Copy_writer writer{copier};
+      Copy_binary_writer binary_writer{writer};
+      try {
+        write_rows(binary_writer);
+        while (!binary_writer.end())
+          flush_output(true);
+      } catch (const std::exception& e) {
+        // Bring the connection back to the normal mode if possible.
+        if (is_connected() && copier) {
+          try {
+            while (!writer.end(e.what()))
+              flush_output(true);
+            wait_response();
+          } catch (...) {}
+        }
+        throw;
+      }
+    }
+    wait_response_throw();
+    auto result = completion().row_count().value_or(0);
+
+    if (is_upsert) {
+      std::vector<std::string> update_columns;
+      std::copy_if(columns.cbegin(), columns.cend(),
+        std::back_inserter(update_columns), [&conflict_columns](const auto& c)
+        {
+          return std::find(conflict_columns.cbegin(), conflict_columns.cend(),
+            c) == conflict_columns.cend();
+        });
+      result = execute("insert into " + std::string{table} + " (" +
+        column_list + ") select " + column_list + " from " + temporary_table +
+        " on conflict (" + to_list(conflict_columns) + ") do " +
+        (update_columns.empty() ? std::string{"nothing"} :
+          "update set " + to_list(update_columns, "excluded."))).row_count()
+        .value_or(0);
+      execute(is_own_transaction ? "commit" : "drop table " + temporary_table);
+    }
+    return result;
+  } catch (...) {
+    if (is_upsert && is_connected() && is_ready_for_request()) {
+      try {
+        if (is_own_transaction)
+          execute("rollback");
+        else if (transaction_status() != Transaction_status::failed)
+          execute("drop table if exists " + temporary_table);
+        // Otherwise the table is dropped by the rollback of the caller.
+      } catch (...) {}
+    }
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE std::string
+Connection::insert_unnest_query__(const std::string_view table,
+  const std::vector<std::string>& columns, const std::size_t array_count,
+  const std::string_view suffix) const
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot insert unnest: not ready for request"};
+  else if (columns.empty())
+    throw Client_exception{"cannot insert unnest: no columns specified"};
+  else if (columns.size() != array_count)
+    throw Client_exception{"cannot insert unnest: "
+      "number of columns and arrays mismatch"};
+
+  std::string result{"insert into "};
+  result.append(table).append(" (");
+  for (const auto& column : columns) {
+    if (&column != &columns.front())
+      result.append(", ");
+    append_quoted_identifier(result, column);
+  }
+  result.append(") select * from unnest(");
+  for (std::size_t i{}; i < array_count; ++i)
+    result.append(i ? ", $" : "$").append(std::to_string(i + 1));
+  result += ')';
+  if (!suffix.empty())
+    result.append(" ").append(suffix);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::string
+Connection::update_unnest_query__(const std::string_view table,
+  const std::vector<std::string>& columns, const std::size_t array_count,
+  const std::vector<std::string>& key_columns) const
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot update unnest: not ready for request"};
+  else if (columns.size() != array_count)
+    throw Client_exception{"cannot update unnest: "
+      "number of columns and arrays mismatch"};
+  else if (key_columns.empty())
+    throw Client_exception{"cannot update unnest: no key columns specified"};
+  else if (key_columns.size() >= columns.size())
+    throw Client_exception{"cannot update unnest: no columns to update"};
+
+  const auto is_key = [&key_columns](const std::string& column)
+  {
+    return std::find(key_columns.cbegin(), key_columns.cend(), column) !=
+      key_columns.cend();
+  };
+  if (std::count_if(columns.cbegin(), columns.cend(), is_key) !=
+    static_cast<std::ptrdiff_t>(key_columns.size()))
+    throw Client_exception{"cannot update unnest: "
+      "key columns must be a subset of columns"};
+
+  std::string result{"update "};
+  result.append(table).append(" as pgfe_t set ");
+  bool is_first{true};
+  for (const auto& column : columns) {
+    if (is_key(column))
+      continue;
+    if (!is_first)
+      result.append(", ");
+    is_first = false;
+    const auto quoted = to_quoted_identifier(column);
+    result.append(quoted).append(" = pgfe_u.").append(quoted);
+  }
+  result.append(" from unnest(");
+  for (std::size_t i{}; i < array_count; ++i)
+    result.append(i ? ", $" : "$").append(std::to_string(i + 1));
+  result.append(") as pgfe_u(");
+  for (const auto& column : columns) {
+    if (&column != &columns.front())
+      result.append(", ");
+    append_quoted_identifier(result, column);
+  }
+  result.append(") where ");
+  for (const auto& column : key_columns) {
+    if (&column != &key_columns.front())
+      result.append(" and ");
+    const auto quoted = to_quoted_identifier(column);
+    result.append("pgfe_t.").append(quoted).append(" = pgfe_u.").append(quoted);
+  }
+  return result;
+}
+
 DMITIGR_PGFE_INLINE int Connection::socket() const noexcept
 {
   return PQsocket(conn());
@@ -1334,6 +2954,231 @@ DMITIGR_PGFE_INLINE bool Connection::is_out_of_memory() const noexcept
   return !std::strncmp(PQerrorMessage(conn()), msg, sizeof(msg) - 1);
 }
 
+DMITIGR_PGFE_INLINE void
+Connection::account_rows(const int offset, const int count) noexcept
+{
+  metrics_.row_count += static_cast<std::uint_least64_t>(count);
+  const int field_count{response_.field_count()};
+  for (int r{offset}; r < offset + count; ++r) {
+    for (int f{}; f < field_count; ++f)
+      metrics_.bytes_received += static_cast<std::uint_least64_t>(
+        response_.data_size(r, f));
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::account_response(const ExecStatusType status) noexcept
+{
+  switch (status) {
+  case PGRES_COMMAND_OK:
+    [[fallthrough]];
+  case PGRES_TUPLES_OK:
+    [[fallthrough]];
+  case PGRES_EMPTY_QUERY:
+    ++metrics_.completion_count;
+    break;
+  case PGRES_FATAL_ERROR:
+    ++metrics_.error_count;
+    break;
+  case PGRES_COPY_IN:
+    [[fallthrough]];
+  case PGRES_COPY_OUT:
+    [[fallthrough]];
+  case PGRES_COPY_BOTH:
+    ++metrics_.copy_count;
+    break;
+#ifdef LIBPQ_HAS_PIPELINING
+  case PGRES_PIPELINE_SYNC:
+    ++metrics_.pipeline_sync_count;
+    break;
+#endif
+  default:
+    break;
+  }
+}
+
+DMITIGR_PGFE_INLINE void Connection::account_first_row(Request& request) noexcept
+{
+  using Time_point = std::chrono::steady_clock::time_point;
+  if (!is_metrics_enabled_ || request.send_time_ == Time_point{} ||
+    request.first_row_time_ != Time_point{})
+    return;
+
+  request.first_row_time_ = std::chrono::steady_clock::now();
+  metrics_.first_response_time.record(request.first_row_time_ -
+    request.send_time_);
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::account_delivered_rows(Request& request) noexcept
+{
+  if (request.delivery_state_.expired() || response_.row_count() <= 0)
+    return;
+
+  request.delivery_row_count_ += static_cast<std::size_t>(response_.row_count());
+  request.delivery_byte_count_ += response_.memory_size();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::dismiss_request(const ExecStatusType status) noexcept
+{
+  if (requests_.empty())
+    return;
+
+  account_completion(requests_.front());
+  if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK) {
+    auto& request = requests_.front();
+    if (const auto state = request.delivery_state_.lock()) {
+      if (status == PGRES_TUPLES_OK) // rows of Row_delivery_mode::full mode
+        account_delivered_rows(request);
+      state->account_delivery(request.delivery_row_count_,
+        request.delivery_byte_count_);
+    }
+  }
+  if (const auto& state = requests_.front().trace_state_) {
+    if (status == PGRES_TUPLES_OK)
+      trace_rows(*state);
+    trace(Trace_point::completion, *state, status == PGRES_FATAL_ERROR
+#ifdef LIBPQ_HAS_PIPELINING
+      || status == PGRES_PIPELINE_ABORTED
+#endif
+      );
+  }
+  last_processed_request_ = std::move(requests_.front());
+  last_processed_request_.trace_state_.reset();
+  ++dismissed_request_count_;
+  requests_.pop();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::account_completion(const Request& request) noexcept
+{
+  using Time_point = std::chrono::steady_clock::time_point;
+  if (!is_metrics_enabled_ || request.send_time_ == Time_point{})
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (request.first_row_time_ != Time_point{})
+    metrics_.row_streaming_time.record(now - request.first_row_time_);
+  else
+    metrics_.first_response_time.record(now - request.send_time_);
+}
+
+DMITIGR_PGFE_INLINE std::string_view
+Connection::tagged_query(const std::string_view query)
+{
+  const auto& tag = query_tag();
+  if (!is_query_tagging_enabled_ || tag.empty())
+    return query;
+
+  tagged_query_.assign("/* ").append(tag).append(" */ ")
+    .append(query); // can throw
+  return tagged_query_;
+}
+
+DMITIGR_PGFE_INLINE const std::string&
+Connection::query_string__(const Statement& statement)
+{
+  // Only the hot statements are worth caching, so the cache is small.
+  constexpr std::size_t capacity{64};
+  if (const auto i = query_strings_.find(statement.revision_);
+    i != query_strings_.end())
+    return i->second;
+
+  auto query = statement.to_query_string(*this); // can throw
+  if (query_strings_.size() >= capacity)
+    query_strings_.clear();
+  return query_strings_.emplace(statement.revision_,
+    std::move(query)).first->second; // can throw
+}
+
+DMITIGR_PGFE_INLINE void
+Connection::prepare_trace(const Trace_request request,
+  const std::string_view query, const std::string_view prepared_statement_name,
+  const std::size_t parameter_count)
+{
+  DMITIGR_ASSERT(!requests_.empty());
+  if (!trace_handler_)
+    return;
+
+  auto state = std::make_unique<Trace_state>(); // can throw
+  state->request_ = request;
+  state->query_ = query; // can throw
+  state->prepared_statement_name_ = prepared_statement_name; // can throw
+  state->tag_ = query_tag(); // can throw
+  state->parameter_count_ = parameter_count;
+  requests_.back().trace_state_ = std::move(state);
+}
+
+DMITIGR_PGFE_INLINE void Connection::trace_rows(Trace_state& state) noexcept
+{
+  state.row_count_ += static_cast<std::uint_least64_t>(response_.row_count());
+  if (response_.row_count() > 0)
+    state.byte_count_ += response_.memory_size();
+  if (!state.has_first_row_ && state.row_count_) {
+    state.has_first_row_ = true;
+    trace(Trace_point::first_row, state);
+  }
+}
+
+DMITIGR_PGFE_INLINE void Connection::trace(const Trace_point point,
+  const Trace_state& state, const bool is_failed) const noexcept
+{
+  if (!trace_handler_)
+    return;
+
+  try {
+    Trace_event event;
+    event.point = point;
+    event.request = state.request_;
+    event.query = state.query_;
+    event.prepared_statement_name = state.prepared_statement_name_;
+    event.parameter_count = state.parameter_count_;
+    event.row_count = state.row_count_;
+    event.byte_count = state.byte_count_;
+    if (point != Trace_point::request)
+      event.duration = std::chrono::steady_clock::now() - state.start_time_;
+    event.is_failed = is_failed;
+    event.tag = state.tag_;
+    trace_handler_(event);
+  } catch (const std::exception& e) {
+    std::clog << "trace handler: error: " << e.what() << '\n';
+  } catch (...) {
+    std::clog << "trace handler: unknown error\n";
+  }
+}
+
+DMITIGR_PGFE_INLINE std::shared_ptr<const detail::Field_name_index>
+Connection::field_name_index() noexcept
+{
+  /*
+   * All the rows of the request have the same description, so the index is
+   * shared between them. The index is reused if it's not shared anymore.
+   * Note, that the request of the complete response is already dismissed.
+   */
+  const auto s = response_.status();
+  const bool is_complete{s != PGRES_SINGLE_TUPLE
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    && s != PGRES_TUPLES_CHUNK
+#endif
+  };
+  const auto request = dismissed_request_count_ + !is_complete;
+  if (!field_name_index_ || field_name_index_request_ != request) {
+    if (field_name_index_ && field_name_index_.use_count() == 1)
+      field_name_index_->reset();
+    else {
+      try {
+        field_name_index_ = std::make_shared<detail::Field_name_index>();
+      } catch (...) {
+        field_name_index_.reset();
+        return nullptr; // Row_info falls back to the linear search
+      }
+    }
+    field_name_index_request_ = request;
+  }
+  return field_name_index_;
+}
+
 DMITIGR_PGFE_INLINE std::pair<std::unique_ptr<void, void(*)(void*)>, std::size_t>
 Connection::to_hex_storage(const pgfe::Data& data) const
 {
@@ -1342,25 +3187,93 @@ Connection::to_hex_storage(const pgfe::Data& data) const
   else if (!(data && (data.format() == Data_format::binary)))
     throw Client_exception{"cannot encode data to hex: invalid data specified"};
 
-  const auto from_length = data.size();
-  const auto* const from = static_cast<const unsigned char*>(data.bytes());
-  std::size_t result_length{};
+  /*
+   * The result is the same as of PQescapeByteaConn(), i.e. the backslash of
+   * the prefix is doubled unless standard_conforming_strings is on.
+   */
+  const char* const scs{PQparameterStatus(conn(),
+      "standard_conforming_strings")};
+  const std::string_view prefix{scs && !std::strcmp(scs, "on") ? "\\x" :
+    "\\\\x"};
+  const std::size_t size{prefix.size() + 2*data.size()};
   using Uptr = std::unique_ptr<void, void(*)(void*)>;
-  if (auto storage = Uptr{PQescapeByteaConn(conn(), from, from_length,
-        &result_length), &PQfreemem})
-    // The result_length includes the terminating zero byte of the result.
-    return std::make_pair(std::move(storage), result_length - 1);
-  else
-    /*
-     * Currently, the only possible error is insufficient memory for the result
-     * string. See: https://www.postgresql.org/docs/current/static/libpq-exec.html#LIBPQ-PQESCAPEBYTEACONN
-     */
+  Uptr storage{std::malloc(size + 1), &std::free};
+  if (!storage)
     throw std::bad_alloc{};
+  auto* const result = static_cast<char*>(storage.get());
+  std::memcpy(result, prefix.data(), prefix.size());
+  str::hex_encode(result + prefix.size(), data.bytes(), data.size());
+  result[size] = '\0';
+  return std::make_pair(std::move(storage), size);
+}
+
+DMITIGR_PGFE_INLINE bool
+Connection::is_client_encoding_ascii_safe() const noexcept
+{
+  /*
+   * The trailing bytes of the multibyte characters of these encodings can be
+   * in the ASCII range, including the quote characters and the backslash.
+   */
+  const char* const value{PQparameterStatus(conn(), "client_encoding")};
+  const std::string_view encoding{value ? value : ""};
+  return !(encoding == "SJIS" || encoding == "SHIFT_JIS_2004" ||
+    encoding == "BIG5" || encoding == "GBK" || encoding == "UHC" ||
+    encoding == "GB18030" || encoding == "JOHAB");
+}
+
+DMITIGR_PGFE_INLINE void Connection::append_quoted(std::string& result,
+  std::string_view str, const bool is_identifier) const
+{
+  DMITIGR_ASSERT(is_connected());
+
+  if (!is_client_encoding_ascii_safe()) {
+    using Uptr = std::unique_ptr<char, void(*)(void*)>;
+    if (const auto p = is_identifier ?
+      Uptr{PQescapeIdentifier(conn(), str.data(), str.size()), &PQfreemem} :
+      Uptr{PQescapeLiteral(conn(), str.data(), str.size()), &PQfreemem}) {
+      result += p.get();
+      return;
+    } else if (is_out_of_memory())
+      throw std::bad_alloc{};
+    else
+      throw Client_exception{error_message()};
+  }
+
+  // Just like libpq, ignore everything after the first NUL.
+  str = str.substr(0, static_cast<std::string_view::size_type>(
+      str::find_char(str.data(), str.data() + str.size(), '\0') - str.data()));
+
+  /*
+   * The backslashes are doubled (within E'' literal) only if
+   * standard_conforming_strings is off.
+   */
+  const char quote{is_identifier ? '"' : '\''};
+  const char* const scs{is_identifier ? nullptr :
+    PQparameterStatus(conn(), "standard_conforming_strings")};
+  const bool is_backslash_special{!is_identifier &&
+    !(scs && !std::strcmp(scs, "on"))};
+  const std::string_view specials{is_backslash_special ?
+    std::string_view{"'\\", 2} : std::string_view{&quote, 1}};
+  const char* first{str.data()};
+  const char* const last{first + str.size()};
+  const char* special{str::find_first_of_chars(first, last, specials)};
+
+  if (is_backslash_special && str::find_char(special, last, '\\') != last)
+    result += " E";
+  result += quote;
+  while (special != last) {
+    result.append(first, special + 1);
+    result += *special; // doubled
+    first = special + 1;
+    special = str::find_first_of_chars(first, last, specials);
+  }
+  result.append(first, last);
+  result += quote;
 }
 
 DMITIGR_PGFE_INLINE void Connection::register_lo(const Large_object& lo)
 {
-  lo_states_.push_back(lo.state_);
+  lo_states_.emplace(lo.state_->id_, lo.state_);
 }
 
 DMITIGR_PGFE_INLINE void Connection::unregister_lo(Large_object& lo) noexcept
@@ -18,31 +18,49 @@
 #define DMITIGR_PGFE_CONNECTION_HPP
 
 #include "../base/assert.hpp"
+#include "../base/ret.hpp"
+#include "../util/ring_buffer.hpp"
 #include "basics.hpp"
 #include "completion.hpp"
 #include "connection_options.hpp"
 #include "data.hpp"
+#include "data_arena.hpp"
 #include "dll.hpp"
 #include "error.hpp"
 #include "exceptions.hpp"
 #include "large_object.hpp"
+#include "metrics.hpp"
 #include "notice.hpp"
 #include "notification.hpp"
+#include "pending_result.hpp"
 #include "pq.hpp"
 #include "prepared_statement.hpp"
+#include "ready_for_query.hpp"
 #include "row.hpp"
+#include "row_batch.hpp"
+#include "row_mapping.hpp"
+#include "row_range.hpp"
+#include "traffic_recorder.hpp"
 #include "types_fwd.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <memory>
 #include <optional>
-#include <queue>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace dmitigr::pgfe {
 
@@ -55,6 +73,87 @@ namespace dmitigr::pgfe {
  */
 DMITIGR_PGFE_API Server_status ping(const Connection_options& options);
 
+/**
+ * @ingroup main
+ *
+ * @brief Establishes the connections to all of the `candidates` concurrently
+ * and keeps the first established one.
+ *
+ * @details The establishment of the connections is started at once and driven
+ * by polling of all of the sockets in progress. The first connection which
+ * becomes connected wins and the rest of connections are closed. Since the
+ * target session mode (see Connection_options::session_mode()) is checked
+ * during the connection establishment, a candidate which doesn't satisfy it
+ * fails and doesn't win.
+ *
+ * @param candidates The options of the connections to race.
+ * @param timeout The value of `std::nullopt` means *eternity*. The value of
+ * `-1` means the maximum of `Connection_options::connect_timeout()` of the
+ * candidates, or *eternity* if any of them is not set.
+ *
+ * @par Requires
+ * `!candidates.empty() && (!timeout || timeout->count() >= -1)`.
+ *
+ * @returns The connection which is connected.
+ *
+ * @throws Client_exception with the code `Client_errc::timed_out` on timeout,
+ * or Client_exception if none of the candidates can be connected.
+ */
+DMITIGR_PGFE_API Connection
+connect_first(const std::vector<Connection_options>& candidates,
+  std::optional<std::chrono::milliseconds> timeout = std::chrono::milliseconds{-1});
+
+namespace detail {
+
+/// A type-erased handler of responses on a pipelined request.
+class Pipeline_handler {
+public:
+  virtual ~Pipeline_handler() = default;
+  virtual void handle(Row&& row) = 0;
+  virtual void handle(Completion&& completion) = 0;
+  virtual void handle(Error&& error) = 0;
+};
+
+/// The implementation of Pipeline_handler which calls `F`.
+template<typename F>
+class Basic_pipeline_handler final : public Pipeline_handler {
+public:
+  explicit Basic_pipeline_handler(F&& callback)
+    : callback_{std::move(callback)}
+  {}
+
+  explicit Basic_pipeline_handler(const F& callback)
+    : callback_{callback}
+  {}
+
+  void handle(Row&& row) override
+  {
+    handle__(std::move(row));
+  }
+
+  void handle(Completion&& completion) override
+  {
+    handle__(std::move(completion));
+  }
+
+  void handle(Error&& error) override
+  {
+    handle__(std::move(error));
+  }
+
+private:
+  F callback_;
+
+  template<class R>
+  void handle__(R&& response)
+  {
+    if constexpr (std::is_invocable_v<F&, R&&>)
+      callback_(std::move(response));
+  }
+};
+
+} // namespace detail
+
 /**
  * @ingroup main
  *
@@ -81,6 +180,18 @@ public:
    */
   explicit DMITIGR_PGFE_API Connection(Options options = {});
 
+  /**
+   * @overload
+   *
+   * @details The compiled options can be shared by many connections, so
+   * they are not compiled upon of each connect().
+   *
+   * @par Requires
+   * `options`.
+   */
+  explicit DMITIGR_PGFE_API Connection(
+    std::shared_ptr<const Compiled_connection_options> options);
+
   /// Not copy-constructible.
   Connection(const Connection&) = delete;
 
@@ -102,6 +213,29 @@ public:
   /// @returns The connection options of this instance.
   DMITIGR_PGFE_API const Connection_options& options() const noexcept;
 
+  /**
+   * @brief Sets the connection options to be used upon of the next connect().
+   *
+   * @details The session already established (if any) is not affected.
+   *
+   * @par Requires
+   * `options`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Compiled_connection_options.
+   */
+  DMITIGR_PGFE_API void
+  set_options(std::shared_ptr<const Compiled_connection_options> options);
+
+  /**
+   * @returns The compiled connection options of this instance, or `nullptr`
+   * if the options are not compiled yet (i.e. before the first connect()).
+   */
+  DMITIGR_PGFE_API const std::shared_ptr<const Compiled_connection_options>&
+  compiled_options() const noexcept;
+
   /// @returns `true` if the connection secured by SSL.
   DMITIGR_PGFE_API bool is_ssl_secured() const noexcept;
 
@@ -151,6 +285,109 @@ public:
   DMITIGR_PGFE_API std::optional<std::chrono::system_clock::time_point>
   session_start_time() const noexcept;
 
+  /**
+   * @brief Enables or disables the collection of metrics.
+   *
+   * @remarks By default, the metrics are not collected.
+   *
+   * @see metrics().
+   */
+  DMITIGR_PGFE_API void set_metrics_enabled(bool value) noexcept;
+
+  /// @returns `true` if the collection of metrics is enabled.
+  DMITIGR_PGFE_API bool is_metrics_enabled() const noexcept;
+
+  /**
+   * @returns The metrics collected since the construction or the last call
+   * of reset_metrics().
+   *
+   * @remarks The metrics are not reset by disconnect().
+   *
+   * @see set_metrics_enabled().
+   */
+  DMITIGR_PGFE_API const Connection_metrics& metrics() const noexcept;
+
+  /// Resets the metrics.
+  DMITIGR_PGFE_API void reset_metrics() noexcept;
+
+  /**
+   * @brief Resets the metrics.
+   *
+   * @returns The metrics collected before the reset.
+   *
+   * @see metrics(), reset_metrics().
+   */
+  DMITIGR_PGFE_API Connection_metrics take_metrics() noexcept;
+
+  /// An alias of a trace handler.
+  using Trace_handler = std::function<void(const Trace_event&)>;
+
+  /**
+   * @brief Sets the handler which is called when the request is sent, when
+   * the first row of the response is arrived and when the request is completed.
+   *
+   * @param handler A handler to set.
+   *
+   * @details The requests sent by execute_nio(), prepare_nio(), describe_nio()
+   * and the functions which based on them are traced.
+   *
+   * @remarks By default, a trace handler isn't set. Only the requests sent
+   * while the handler is set are traced.
+   * @remarks The exceptions thrown by the handler are caught and reported
+   * to `std::clog`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void set_trace_handler(Trace_handler handler);
+
+  /// @returns The current trace handler.
+  DMITIGR_PGFE_API const Trace_handler& trace_handler() const noexcept;
+
+  /**
+   * @brief Sets the recorder of the requests.
+   *
+   * @details The requests sent by execute_nio(), prepare_nio() and the
+   * functions which based on them are recorded as the separate session of
+   * the `recorder` to be replayed by Traffic_replayer later.
+   *
+   * @remarks By default, a recorder isn't set. The recording costs the copying
+   * of the query and the parameters of each request under the lock of the
+   * recorder, so it's intended for capturing of the workloads rather than for
+   * permanent use.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Traffic_recorder.
+   */
+  DMITIGR_PGFE_API void
+  set_traffic_recorder(std::shared_ptr<Traffic_recorder> recorder);
+
+  /// @returns The current recorder of the requests.
+  DMITIGR_PGFE_API const std::shared_ptr<Traffic_recorder>&
+  traffic_recorder() const noexcept;
+
+  /**
+   * @brief Enables or disables the prepending of the queries with the comment
+   * which contains query_tag() of the calling thread (if it's not empty).
+   *
+   * @details The queries sent by execute_nio() and prepare_nio() and the
+   * functions which based on them are tagged. (The statements are tagged
+   * when prepared, so the executions of prepared statements are attributed
+   * to the tag of the preparation.) The tagging costs the copying of the
+   * query into the buffer of the connection and doesn't involve additional
+   * round trips to the server.
+   *
+   * @remarks By default, the queries are not tagged.
+   *
+   * @see set_query_tag().
+   */
+  DMITIGR_PGFE_API void set_query_tagging_enabled(bool value) noexcept;
+
+  /// @returns `true` if the queries are tagged.
+  DMITIGR_PGFE_API bool is_query_tagging_enabled() const noexcept;
+
   ///@}
 
   // ---------------------------------------------------------------------------
@@ -215,6 +452,15 @@ public:
    */
   DMITIGR_PGFE_API void disconnect() noexcept;
 
+  /**
+   * @returns The descriptor of the connection socket, or `-1` if there is no
+   * connection.
+   *
+   * @remarks The descriptor can be used to wait for the socket readiness by
+   * an event loop (see Reactor).
+   */
+  DMITIGR_PGFE_API int socket() const noexcept;
+
   /**
    * @brief Waits for readiness of the connection socket if it's unready.
    *
@@ -353,6 +599,27 @@ public:
   /// @returns The current notice handler.
   DMITIGR_PGFE_API const Notice_handler& notice_handler() const noexcept;
 
+  /**
+   * @brief Sets the minimum severity of notices to be passed to the notice
+   * handler.
+   *
+   * @details The severity of each notice is checked before the instance of
+   * Notice is created, so the notices of lesser severity (in the order of
+   * Problem_severity) are skipped at the minimum cost. The notices without
+   * the severity are always passed.
+   *
+   * @param severity The minimum severity, or `std::nullopt` to pass all the
+   * notices.
+   *
+   * @see notice_min_severity().
+   */
+  DMITIGR_PGFE_API void
+  set_notice_min_severity(std::optional<Problem_severity> severity) noexcept;
+
+  /// @returns The minimum severity of notices to be passed to the notice handler.
+  DMITIGR_PGFE_API std::optional<Problem_severity>
+  notice_min_severity() const noexcept;
+
   /// An alias of a notification handler.
   using Notification_handler = std::function<void(Notification&&)>;
 
@@ -403,7 +670,11 @@ public:
    * @remarks All signals retrieved upon waiting the Response will be handled
    * by signals handlers being set.
    *
-   * @see wait_response_throw().
+   * @remarks If `options().wait_response_spin_duration()` is set, the socket
+   * is polled without blocking for up to the specified duration before the
+   * blocking wait. The spin duration is not counted against the `timeout`.
+   *
+   * @see wait_response_throw(), Connection_options::wait_response_spin_duration().
    */
   DMITIGR_PGFE_API bool
   wait_response(std::optional<std::chrono::milliseconds> timeout =
@@ -471,6 +742,20 @@ public:
    */
   DMITIGR_PGFE_API Row row() noexcept;
 
+  /**
+   * @returns The Row_batch of all the rows of the response which are not yet
+   * released by either row() or row_batch(), if available.
+   *
+   * @par Effects
+   * `!row_batch() && !row()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see wait_response(), completion(), Row_delivery_mode.
+   */
+  DMITIGR_PGFE_API Row_batch row_batch() noexcept;
+
   /**
    * @returns The Copier as response on request if available.
    *
@@ -513,6 +798,13 @@ public:
    *   return an invalid instance of type Completion after the callback returns.
    *   In case of success, an invalid instance of type Error will be passed as the
    *   second argument of the callback;
+   *   - can be defined with a parameter of type `Row_batch&&` in order to
+   *   process the rows in batches (see Row_delivery_mode). An exception will be
+   *   thrown on error in this case;
+   *   - can be defined with a parameter of type `T&&`, where `T` is the struct
+   *   for which Row_mapping is specialized, in order to process the rows
+   *   converted to `T` (the indexes of fields are resolved once by the first
+   *   row). An exception will be thrown on error in this case;
    *   - can return a value of type Row_processing to indicate further behavior.
    *
    * @see execute(), invoke(), call(), Row_processing.
@@ -523,84 +815,173 @@ public:
   {
     using Traits = detail::Response_callback_traits<F>;
 
-    const auto with_complete_on_exception = [this](auto&& callback)
-    {
-      try {
-        callback();
-      } catch (...) {
-        if constexpr (on_exception == Row_processing::complete) {
-          Completion comp;
-          Error err;
-          Client_exception process_responses_error{""};
-          try {
-            // std::function is used as the workaround for GCC 7.5
-            std::function<void(Row&&, Error&&)> f = [&err](auto&&, auto&& e)
-            {
-              if (e)
-                err = std::move(e);
-            };
-            comp = process_responses(std::move(f));
-            DMITIGR_ASSERT((comp && !err) || (!comp && err));
-          } catch (const std::bad_alloc&) {
-            goto bad_alloc;
-          } catch (const std::exception& e) {
+    if constexpr (Traits::has_mapped_parameter) {
+      // The indexes of fields are resolved once for all the rows.
+      Row_mapper<typename Traits::Mapped> mapper;
+      return process_responses<on_exception>([&callback, &mapper](Row&& row)
+        -> typename Traits::Result
+      {
+        return callback(mapper.map(row));
+      });
+    } else {
+      const auto with_complete_on_exception = [this](auto&& callback)
+      {
+        try {
+          callback();
+        } catch (...) {
+          if constexpr (on_exception == Row_processing::complete) {
+            Completion comp;
+            Error err;
+            Client_exception process_responses_error{""};
             try {
-              process_responses_error = Client_exception{e.what()};
-            } catch (...) {
+              // std::function is used as the workaround for GCC 7.5
+              std::function<void(Row&&, Error&&)> f = [&err](auto&&, auto&& e)
+              {
+                if (e)
+                  err = std::move(e);
+              };
+              comp = process_responses(std::move(f));
+              DMITIGR_ASSERT((comp && !err) || (!comp && err));
+            } catch (const std::bad_alloc&) {
               goto bad_alloc;
-            }
-          } catch (...) {}
-
-          if (comp)
+            } catch (const std::exception& e) {
+              try {
+                process_responses_error = Client_exception{e.what()};
+              } catch (...) {
+                goto bad_alloc;
+              }
+            } catch (...) {}
+
+            if (comp)
+              throw;
+            else if (!err)
+              std::throw_with_nested(process_responses_error);
+            else if (std::shared_ptr<Error> e{
+                new (std::nothrow) Error{std::move(err)}})
+              std::throw_with_nested(Server_exception{std::move(e)});
+
+          bad_alloc:
+            std::throw_with_nested(std::bad_alloc{});
+          } else if constexpr (on_exception == Row_processing::suspend)
             throw;
-          else if (!err)
-            std::throw_with_nested(process_responses_error);
-          else if (std::shared_ptr<Error> e{new (std::nothrow) Error{std::move(err)}})
-            std::throw_with_nested(Server_exception{std::move(e)});
-
-        bad_alloc:
-          std::throw_with_nested(std::bad_alloc{});
-        } else if constexpr (on_exception == Row_processing::suspend)
-          throw;
-      }
-    };
-
-    Row_processing rowpro{Row_processing::continu};
-    while (true) {
-      if constexpr (Traits::has_error_parameter) {
-        wait_response();
-        if (auto e = error()) {
-          callback(Row{}, std::move(e));
+        }
+      };
+
+      Row_processing rowpro{Row_processing::continu};
+      while (true) {
+        if constexpr (Traits::has_error_parameter) {
+          wait_response();
+          if (auto e = error()) {
+            callback(Row{}, std::move(e));
+            return Completion{};
+          } else if (auto r = row()) {
+            with_complete_on_exception([this, &callback, &rowpro, &r]
+            {
+              if constexpr (!Traits::is_result_void)
+                rowpro = callback(std::move(r), Error{});
+              else
+                callback(std::move(r), Error{});
+            });
+          } else
+            return completion();
+        } else if constexpr (Traits::has_row_batch_parameter) {
+          wait_response_throw();
+          if (auto b = row_batch()) {
+            with_complete_on_exception([this, &callback, &rowpro, &b]
+            {
+              if constexpr (!Traits::is_result_void)
+                rowpro = callback(std::move(b));
+              else
+                callback(std::move(b));
+            });
+          } else
+            return completion();
+        } else {
+          wait_response_throw();
+          if (auto r = row()) {
+            with_complete_on_exception([this, &callback, &rowpro, &r]
+            {
+              if constexpr (!Traits::is_result_void)
+                rowpro = callback(std::move(r));
+              else
+                callback(std::move(r));
+            });
+          } else
+            return completion();
+        }
+
+        if (rowpro == Row_processing::complete)
+          return process_responses(ignore_row);
+        else if (rowpro == Row_processing::suspend)
           return Completion{};
-        } else if (auto r = row()) {
-          with_complete_on_exception([this, &callback, &rowpro, &r]
-          {
-            if constexpr (!Traits::is_result_void)
-              rowpro = callback(std::move(r), Error{});
-            else
-              callback(std::move(r), Error{});
-          });
-        } else
-          return completion();
-      } else {
-        wait_response_throw();
-        if (auto r = row()) {
-          with_complete_on_exception([this, &callback, &rowpro, &r]
-          {
-            if constexpr (!Traits::is_result_void)
-              rowpro = callback(std::move(r));
-            else
-              callback(std::move(r));
-          });
-        } else
-          return completion();
       }
+    }
+  }
 
-      if (rowpro == Row_processing::complete)
-        return process_responses(ignore_row);
-      else if (rowpro == Row_processing::suspend)
-        return Completion{};
+  /**
+   * @brief Similar to process_responses(), but returns the error of the server
+   * as the value instead of throwing Server_exception.
+   *
+   * @details This is useful in hot loops where the errors of the server (such
+   * as unique violations) are the part of the normal flow, since no exceptions
+   * are thrown on such errors.
+   *
+   * @returns The Completion, or the error of the server. In the latter case
+   * the condition and the message of the returned Err are the `condition()`
+   * and the `brief()` of the Error. If the response is invalid, the returned
+   * Err holds `Client_errc::invalid_response`.
+   *
+   * @param callback Same as for process_responses(), except that it cannot be
+   * defined with a parameter of type `Error&&` or `Row_batch&&`.
+   *
+   * @remarks The error handler is not called.
+   * @remarks The client errors (such as the broken connection) and the
+   * exceptions thrown by the callback are still reported by throwing.
+   *
+   * @see process_responses(), execute_nothrow().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid &&
+    !detail::Response_callback_traits<F>::has_error_parameter &&
+    !detail::Response_callback_traits<F>::has_row_batch_parameter,
+    Ret<Completion>>
+  process_responses_nothrow(F&& callback)
+  {
+    using Traits = detail::Response_callback_traits<F>;
+    using Result = typename Traits::Result;
+
+    Err err;
+    Completion comp;
+    if constexpr (Traits::has_mapped_parameter) {
+      // The indexes of fields are resolved once for all the rows.
+      Row_mapper<typename Traits::Mapped> mapper;
+      comp = process_responses<on_exception>([&err, &callback, &mapper]
+        (Row&& row, Error&& error) -> Result
+      {
+        if (!error)
+          return callback(mapper.map(row));
+        err = Err{error.condition(), error.brief()};
+        if constexpr (!Traits::is_result_void)
+          return Row_processing::continu;
+      });
+    } else {
+      comp = process_responses<on_exception>([&err, &callback]
+        (Row&& row, Error&& error) -> Result
+      {
+        if (!error)
+          return callback(std::move(row));
+        err = Err{error.condition(), error.brief()};
+        if constexpr (!Traits::is_result_void)
+          return Row_processing::continu;
+      });
     }
+
+    if (err)
+      return Ret<Completion>{std::move(err)};
+    else if (comp.tag() == "invalid")
+      return Ret<Completion>{Client_errc::invalid_response};
+    else
+      return Ret<Completion>{std::move(comp)};
   }
 
   /**
@@ -672,11 +1053,63 @@ public:
    */
   DMITIGR_PGFE_API bool has_uncompleted_request() const noexcept;
 
+  /**
+   * @brief Requests the server to cancel the processing of the current
+   * command without blocking.
+   *
+   * @details The cancel request is sent over the separate connection by the
+   * helper thread (by using `PQcancelBlocking()` if libpq 17+ is used, or
+   * `PQcancel()` otherwise). If the command is canceled, its response is the
+   * error with code Server_errc::c57_query_canceled, and the connection
+   * remains usable.
+   *
+   * @returns `true` if the cancel request is initiated, or `false` if the
+   * previous cancel request is still being sent.
+   *
+   * @par Requires
+   * `is_connected()`.
+   *
+   * @remarks The destructor of this instance waits for the cancel request to
+   * be sent.
+   *
+   * @see set_request_timeout().
+   */
+  DMITIGR_PGFE_API bool cancel_request_nio();
+
+  /**
+   * @brief Sets the timeout of processing of the requests.
+   *
+   * @details If the response to a request sent after this call is not
+   * completed within `timeout`, then wait_response() requests the server to
+   * cancel the processing of the command (see cancel_request_nio()) and
+   * continues to wait for the response, which is normally the error with code
+   * Server_errc::c57_query_canceled. Thus, the connection remains usable
+   * instead of being left with the uncompleted request upon the expiration of
+   * the `timeout` of wait_response().
+   *
+   * @param timeout The value of `std::nullopt` means *eternity*.
+   *
+   * @par Requires
+   * `!timeout || timeout->count() > 0`.
+   *
+   * @remarks In pipeline mode the timeout is applied to each request
+   * separately, starting from the moment it's sent.
+   */
+  DMITIGR_PGFE_API void
+  set_request_timeout(std::optional<std::chrono::milliseconds> timeout);
+
+  /// @returns The timeout of processing of the requests.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  request_timeout() const noexcept;
+
   /**
    * @brief Submits a request to a server to prepare the statement.
    *
    * @param statement A preparsed SQL string.
    * @param name A name of statement to be prepared.
+   * @param parameter_types The OIDs of the types of the parameters. The
+   * `invalid_oid` (as well as the absence of the OID) means that the type of
+   * the corresponding parameter is inferred by the server.
    *
    * @par Effects
    * - `has_uncompleted_request()` - just after the successful request submission;
@@ -696,36 +1129,49 @@ public:
    *     SELECT generate_series($1::int, $2::int);
    *   @endcode
    * This forces parameters `$1` and `$2` to be treated as of type `integer`
-   * and thus the corresponding overload will be used in this case.
+   * and thus the corresponding overload will be used in this case. The same
+   * effect can be achieved by using `parameter_types`, which is required to
+   * pass the parameters of binary format without the explicit type casts.
    *
-   * @see unprepare_nio().
+   * @see unprepare_nio(), Prepared_statement::parameter_type().
    */
   DMITIGR_PGFE_API void prepare_nio(const Statement& statement,
-    const std::string& name = {});
+    const std::string& name = {}, const std::vector<Oid>& parameter_types = {});
 
   /// Same as prepare_nio() except the statement will be send without preparsing.
   DMITIGR_PGFE_API void prepare_nio_as_is(const std::string& statement,
-    const std::string& name = {});
+    const std::string& name = {}, const std::vector<Oid>& parameter_types = {});
 
   /**
    * @returns The Prepared_statement as response on prepare request.
    *
+   * @param describe If `true`, the describe request is pipelined with the
+   * prepare request, so the statement is both prepared and described in a
+   * single round trip.
+   *
    * @par Requires
    * `is_ready_for_request() && !statement.has_missing_parameters()`.
    *
+   * @par Effects
+   * `result.is_described()` if `describe`.
+   *
    * @par Exception safety guarantee
    * Basic.
    *
    * @remarks See remarks of prepare_nio().
+   * @remarks If the pipeline feature is not available, the statement is
+   * described by the separate request.
    *
-   * @see unprepare().
+   * @see unprepare(), describe().
    */
   DMITIGR_PGFE_API Prepared_statement prepare(const Statement& statement,
-    const std::string& name = {});
+    const std::string& name = {}, const std::vector<Oid>& parameter_types = {},
+    bool describe = false);
 
   /// Same as prepare() except the statement will be send without preparsing.
   DMITIGR_PGFE_API Prepared_statement prepare_as_is(const std::string& statement,
-    const std::string& name = {});
+    const std::string& name = {}, const std::vector<Oid>& parameter_types = {},
+    bool describe = false);
 
   /**
    * @brief Requests the server to describe the prepared statement.
@@ -807,8 +1253,8 @@ public:
   template<typename ... Types>
   void execute_nio(const Statement& statement, Types&& ... parameters)
   {
-    Prepared_statement ps{execute_ps_state_, &statement, false};
-    ps.bind_many(std::forward<Types>(parameters)...).execute_nio(statement);
+    execute_cached_nio__(false, statement,
+      std::forward<Types>(parameters)...);
   }
 
   /**
@@ -828,6 +1274,8 @@ public:
    * Strong.
    *
    * @remarks See remarks of prepare().
+   * @remarks If the statement cache is enabled the statement may be prepared
+   * transparently. See set_statement_cache_capacity().
    *
    * @see process_responses().
    */
@@ -838,7 +1286,8 @@ public:
   {
     if (!is_ready_for_request())
       throw Client_exception{"cannot execute statement: not ready for request"};
-    execute_nio(statement, std::forward<Types>(parameters)...);
+    execute_cached_nio__(true, statement,
+      std::forward<Types>(parameters)...);
     return completion_or_throw(
       process_responses<on_exception>(std::forward<F>(callback)));
   }
@@ -852,85 +1301,491 @@ public:
   }
 
   /**
-   * @brief Requests the server to invoke the specified function and waits for
-   * a response.
+   * @brief Similar to execute_nio(const Statement&, Types&& ...) but for the
+   * shared statement template with the values bound by the `binding`.
    *
-   * @details If `function` returns table with multiple columns or has multiple
-   * output parameters they are can be accessed as usual by using Row::data().
-   * If `function` have named parameters it can be called using either positional,
-   * named or mixed notation. When using positional notation all arguments
-   * specified traditionally in order, for example:
+   * @details The query string is rendered into the buffer reused by this
+   * instance, so neither the template nor its fragments are copied.
    *
-   * @code
-   * conn.invoke("generate_series", 1, 3);
-   * @endcode
+   * @remarks Defined after the definition of Statement_binding.
+   */
+  template<typename ... Types>
+  void execute_nio(const Statement_binding& binding, Types&& ... parameters);
+
+  /**
+   * @brief Similar to execute(F&&, const Statement&, Types&& ...) but for the
+   * shared statement template with the values bound by the `binding`.
    *
-   * When using named notation, each argument is specified using object of type
-   * Named_argument (or it alias - `a`), for example:
+   * @remarks Defined after the definition of Statement_binding.
    *
-   * @code
-   * conn.invoke("person_info", a{"name", "Christopher"}, a{"id", 1});
-   * @endcode
+   * @see Statement_binding.
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Completion>
+  execute(F&& callback, const Statement_binding& binding, Types&& ... parameters);
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete, typename ... Types>
+  Completion execute(const Statement_binding& binding, Types&& ... parameters)
+  {
+    return execute<on_exception>(ignore_row, binding,
+      std::forward<Types>(parameters)...);
+  }
+
+  /**
+   * @brief Similar to execute(F&&, const Statement&, Types&& ...) but for the
+   * statement which is parsed at compile time.
    *
-   * When using mixed notation which combines positional and named notation,
-   * named arguments cannot precede positional arguments. The compile time check
-   * will be performed to enforce that. For example:
+   * @details The number of the specified parameters is checked at compile
+   * time, for example:
    *
    * @code
-   * conn.invoke("person_info", 1, a{"name", "Christopher"});
+   * static constexpr Static_statement query{"select :a::int, :b::int"};
+   * conn.execute<query>(callback, 1, 2); // ok
+   * conn.execute<query>(callback, 1); // compile-time error
    * @endcode
    *
-   * See <a href="https://www.postgresql.org/docs/current/static/sql-syntax-calling-funcs.html">calling functions</a>
-   * section of the PostgreSQL documentation for the full details on calling
-   * notations.
-   *
-   * @returns The released instance.
-   *
-   * @par Responses
-   * Similar to execute().
-   *
-   * @param callback Same as for process_responses().
-   * @param function A function name to invoke.
-   * @param arguments Function arguments.
+   * @tparam S A Static_statement instance with static storage duration.
    *
    * @par Requires
-   * `is_ready_for_request() && !function.empty()`.
-   *
-   * @par Exception safety guarantee
-   * Basic.
-   *
-   * @remarks It may be problematic to invoke overloaded functions with same
-   * number of parameters. A SQL query with explicit type casts should be
-   * executed is such a case. See remarks of prepare_nio().
-   *
-   * @see invoke_unexpanded(), call(), execute().
+   * `is_ready_for_request()`.
    */
-  template<Row_processing on_exception = Row_processing::complete, typename F,
-    typename ... Types>
+  template<const auto& S, Row_processing on_exception = Row_processing::complete,
+    typename F, typename ... Types>
   std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Completion>
-  invoke(F&& callback, std::string_view function, Types&& ... arguments)
+  execute(F&& callback, Types&& ... parameters)
   {
-    static_assert(is_routine_arguments_ok__<Types...>(),
-      "named arguments cannot precede positional arguments");
-    const auto stmt = routine_query__(function,
-      "SELECT * FROM", std::forward<Types>(arguments)...);
-    return execute<on_exception>(std::forward<F>(callback),
-      stmt, std::forward<Types>(arguments)...);
+    static_assert(!S.has_missing_parameters(),
+      "statement has missing parameters");
+    static_assert(S.parameter_count() == sizeof...(Types),
+      "number of arguments doesn't match the number of statement parameters");
+    // The statement is never modified, so it can be shared among threads.
+    static const Statement statement{S.to_statement()};
+    return execute<on_exception>(std::forward<F>(callback), statement,
+      std::forward<Types>(parameters)...);
   }
 
   /// @overload
-  template<Row_processing on_exception = Row_processing::complete, typename ... Types>
-  Completion invoke(std::string_view function, Types&& ... arguments)
+  template<const auto& S, Row_processing on_exception = Row_processing::complete,
+    typename ... Types>
+  Completion execute(Types&& ... parameters)
   {
-    return invoke<on_exception>(ignore_row, function,
-      std::forward<Types>(arguments)...);
+    return execute<S, on_exception>(ignore_row,
+      std::forward<Types>(parameters)...);
   }
 
   /**
-   * @brief Requests the server to invoke the specified function and waits for
-   * a response.
+   * @brief Requests the server to prepare and execute the unnamed statement
+   * from the preparsed SQL string, and returns the lazy range of the rows.
    *
-   * @details This method is similar to invoke() but even if `function` returns
+   * @details Unlike execute(), the rows are pulled by the caller rather than
+   * pushed to the callback, for example:
+   * @code
+   * for (auto&& row : conn.rows("select * from person where age > $1", 18))
+   *   if (to<std::string>(row["name"]) == "Dmitry")
+   *     break; // the rest of the response is discarded
+   * @endcode
+   *
+   * @param statement A *preparsed* statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Row_range.
+   */
+  template<typename ... Types>
+  Row_range rows(const Statement& statement, Types&& ... parameters)
+  {
+    if (!is_ready_for_request())
+      throw Client_exception{"cannot execute statement: not ready for request"};
+    execute_cached_nio__(true, statement,
+      std::forward<Types>(parameters)...);
+    return Row_range{*this};
+  }
+
+  /**
+   * @brief Requests the server to prepare and execute the unnamed statement
+   * from the preparsed SQL string, and appends the rows converted to `T` to
+   * `result`.
+   *
+   * @details If `T` is mapped by Row_mapping, the rows are converted according
+   * to the mapping. Otherwise, the rows must consist of exactly one field.
+   * The rows are retrieved in Row_delivery_mode::chunked mode if it's
+   * available, or in Row_delivery_mode::full mode otherwise, and converted
+   * batch by batch. Thus, the capacity of `result` is reserved once per batch
+   * and the decoders (see Column_decoder) are resolved once per batch.
+   *
+   * @param result The container to append the rows to.
+   * @param statement A *preparsed* statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement.
+   *
+   * @returns The Completion as response on a request.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Basic. (`result` can contain a part of rows.)
+   *
+   * @see fetch_columns(), Row_mapping.
+   */
+  template<typename T, typename ... Types>
+  Completion fetch_into(std::vector<T>& result, const Statement& statement,
+    Types&& ... parameters)
+  {
+    if constexpr (detail::Is_row_mapped<T>::value) {
+      // The indexes of fields are resolved once for all the rows.
+      Row_mapper<T> mapper;
+      return fetch__([&result, &mapper](Row_batch&& batch)
+      {
+        reserve__(result, batch);
+        for (std::size_t i{}; i < batch.row_count(); ++i)
+          result.push_back(mapper.map(batch, i));
+      }, statement, std::forward<Types>(parameters)...);
+    } else
+      return fetch_columns(std::tie(result), statement,
+        std::forward<Types>(parameters)...);
+  }
+
+  /**
+   * @brief Similar to fetch_into(), but appends the values of the fields
+   * to the separate containers, one per field, for example:
+   * @code
+   * std::vector<std::int64_t> ids;
+   * std::vector<std::optional<std::string>> names;
+   * conn.fetch_columns(std::tie(ids, names), "select id, name from person");
+   * @endcode
+   *
+   * @param columns The containers to append the values of the fields to.
+   *
+   * @par Requires
+   * The number of fields of the rows equals to the number of `columns`.
+   *
+   * @par Exception safety guarantee
+   * Basic. (`columns` can contain a part of values and be of different sizes.)
+   */
+  template<typename ... Ts, typename ... Types>
+  Completion fetch_columns(const std::tuple<std::vector<Ts>&...>& columns,
+    const Statement& statement, Types&& ... parameters)
+  {
+    static_assert(sizeof...(Ts) > 0, "no columns to fetch into");
+    return fetch__([&columns](Row_batch&& batch)
+    {
+      if (batch.field_count() != sizeof...(Ts))
+        throw Client_exception{"cannot fetch columns: number of fields "
+          "doesn't match the number of columns"};
+      fetch_columns__(columns, batch, std::index_sequence_for<Ts...>{});
+    }, statement, std::forward<Types>(parameters)...);
+  }
+
+  /**
+   * @brief Executes all the non-empty statements of `statements` in the
+   * pipeline and waits for all the responses.
+   *
+   * @details All the statements are sent without waiting for the responses,
+   * so the whole vector costs as few round trips as possible.
+   *
+   * @param handler A callback which is called with the index of the statement
+   * in `statements` and each response on it. It can be a generic lambda or can
+   * be a function object invocable with some of `(std::size_t, Row&&)`,
+   * `(std::size_t, Completion&&)` and `(std::size_t, Error&&)`. The responses
+   * of types for which the handler is not invocable are discarded. An invalid
+   * Error is passed if the execution is skipped by the server because of an
+   * error of one of the preceding statements of the same synchronization
+   * point.
+   * @param statements The statements to execute.
+   * @param sync_mode The mode of establishing the synchronization points.
+   *
+   * @par Requires
+   * `is_ready_for_request()` and none of the non-empty `statements` has
+   * missing parameters.
+   *
+   * @par Effects
+   * `is_ready_for_request()` on success.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks The errors of the server are passed to the `handler` rather than
+   * thrown.
+   *
+   * @remarks Defined after the definition of Statement_vector.
+   *
+   * @see execute_pipelined(), Pipeline_sync_mode.
+   */
+  template<typename F>
+  void execute(F&& handler, const Statement_vector& statements,
+    Pipeline_sync_mode sync_mode = Pipeline_sync_mode::once);
+
+  /**
+   * @brief Executes the `statements` joined into the single query by the
+   * simple query protocol, and waits for the response.
+   *
+   * @details Unlike execute(F&&, const Statement_vector&, Pipeline_sync_mode)
+   * the whole vector is sent by the single message and is executed by the
+   * server as the single implicit transaction (unless the statements contain
+   * the transaction control commands). This is the cheapest way to execute a
+   * script of statements without parameters, such as DDL.
+   *
+   * @returns The completion of the last statement.
+   *
+   * @par Requires
+   * `is_ready_for_request()` and none of the non-empty `statements` has
+   * parameters which are not bound.
+   *
+   * @throws Server_exception with the error of the first failed statement.
+   * (The statements after it are not executed by the server.)
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks The rows produced by the statements are discarded.
+   *
+   * @see set_simple_query_enabled().
+   */
+  DMITIGR_PGFE_API Completion execute_simple(const Statement_vector& statements);
+
+
+  /**
+   * @brief Prepares the unnamed statement from the preparsed SQL string and
+   * executes it for each element of `tuples`.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see Prepared_statement::execute_many().
+   */
+  template<typename Range>
+  Bulk_completion execute_many(const Statement& statement, const Range& tuples)
+  {
+    if (!is_ready_for_request())
+      throw Client_exception{"cannot execute statement many times: "
+        "not ready for request"};
+    return prepare(statement).execute_many(tuples);
+  }
+
+  /**
+   * @brief Loads `tuples` into the `table` by using the `COPY` command of
+   * the binary format.
+   *
+   * @details The rows are streamed through the Copy_writer, so this is the
+   * much faster alternative to the multi-row `INSERT` statements. If the
+   * `conflict_columns` are specified, the rows are loaded into the uniquely
+   * named temporary table `pgfe_copy_into_N` (created with `ON COMMIT DROP`)
+   * at first and then merged into the `table` by `INSERT ... ON CONFLICT
+   * (conflict_columns) DO UPDATE` which updates the columns which are not in
+   * `conflict_columns` (or `DO NOTHING` if there are no such columns). If no
+   * transaction is in progress, the upsert is performed in its own one.
+   *
+   * @param table The name of the table, which is inserted into the SQL query
+   * as is and therefore should be quoted by the caller if needed.
+   * @param columns The names of the columns to load. The names are quoted by
+   * using to_quoted_identifier().
+   * @param tuples The range of tuples of values. Each tuple must have exactly
+   * `columns.size()` elements. The values are written by using
+   * Copy_binary_writer::write_row().
+   * @param conflict_columns The names of the columns of an unique index or
+   * constraint of the `table` to use for upsert.
+   *
+   * @returns The number of loaded (or merged) rows.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !columns.empty()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see Copy_binary_writer.
+   */
+  template<typename Range>
+  long copy_into(const std::string_view table,
+    const std::vector<std::string>& columns, const Range& tuples,
+    const std::vector<std::string>& conflict_columns = {})
+  {
+    return copy_into__(table, columns, conflict_columns,
+      [&tuples](auto& writer)
+      {
+        for (const auto& tuple : tuples) {
+          std::apply([&writer](const auto& ... values)
+          {
+            writer.write_row(values...);
+          }, tuple);
+        }
+      });
+  }
+
+  /**
+   * @brief Inserts the rows into the `table` by the single statement
+   * @code{sql}
+   * insert into table (columns) select * from unnest($1, $2, ...) [suffix]
+   * @endcode
+   * where each parameter is the array of values of the corresponding column.
+   *
+   * @details The arrays are passed in binary format with the array types
+   * of the elements (see binary_oid_v), so the SQL text doesn't depend on the
+   * number of rows. Thus, if the statement cache is enabled, the statement is
+   * prepared once and its plan is reused regardless of the number of rows.
+   * For example:
+   * @code
+   * std::vector<long long> ids{1, 2, 3};
+   * std::vector<std::optional<std::string>> names{"one", std::nullopt, "three"};
+   * conn.insert_unnest("person", {"id", "name"}, std::tie(ids, names));
+   * @endcode
+   *
+   * @param table The name of the table, which is inserted into the SQL query
+   * as is and therefore should be quoted by the caller if needed.
+   * @param columns The names of the columns. The names are quoted by using
+   * to_quoted_identifier().
+   * @param arrays The tuple of one-dimensional containers of values of the
+   * columns, such as `std::vector<T>` or `std::vector<std::optional<T>>`, where
+   * `T` is a type for which there is a specialization of
+   * detail::Array_element_traits.
+   * @param suffix The SQL text to append to the statement, such as
+   * `ON CONFLICT` clause.
+   *
+   * @returns The number of inserted rows.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !columns.empty() &&
+   * (columns.size() == sizeof...(Types))` and all the containers must be of
+   * the same size.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see copy_into(), update_unnest().
+   */
+  template<typename ... Types>
+  long insert_unnest(const std::string_view table,
+    const std::vector<std::string>& columns,
+    const std::tuple<Types...>& arrays, const std::string_view suffix = {})
+  {
+    return execute_unnest__(insert_unnest_query__(table, columns,
+        sizeof...(Types), suffix), arrays, std::index_sequence_for<Types...>{});
+  }
+
+  /**
+   * @brief Updates the rows of the `table` by the single statement
+   * @code{sql}
+   * update table as pgfe_t set c = pgfe_u.c, ...
+   *   from unnest($1, $2, ...) as pgfe_u(columns)
+   *   where pgfe_t.k = pgfe_u.k and ...
+   * @endcode
+   * where each parameter is the array of values of the corresponding column,
+   * `k` are the `key_columns` and `c` are the rest of `columns`.
+   *
+   * @details See insert_unnest() for the details about the parameters.
+   *
+   * @returns The number of updated rows.
+   *
+   * @par Requires
+   * `is_ready_for_request() && (columns.size() == sizeof...(Types))`, and
+   * `key_columns` must be a non-empty proper subset of `columns`, and all the
+   * containers must be of the same size.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see insert_unnest().
+   */
+  template<typename ... Types>
+  long update_unnest(const std::string_view table,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& key_columns,
+    const std::tuple<Types...>& arrays)
+  {
+    return execute_unnest__(update_unnest_query__(table, columns,
+        sizeof...(Types), key_columns), arrays,
+      std::index_sequence_for<Types...>{});
+  }
+
+  /**
+   * @brief Requests the server to invoke the specified function and waits for
+   * a response.
+   *
+   * @details If `function` returns table with multiple columns or has multiple
+   * output parameters they are can be accessed as usual by using Row::data().
+   * If `function` have named parameters it can be called using either positional,
+   * named or mixed notation. When using positional notation all arguments
+   * specified traditionally in order, for example:
+   *
+   * @code
+   * conn.invoke("generate_series", 1, 3);
+   * @endcode
+   *
+   * When using named notation, each argument is specified using object of type
+   * Named_argument (or it alias - `a`), for example:
+   *
+   * @code
+   * conn.invoke("person_info", a{"name", "Christopher"}, a{"id", 1});
+   * @endcode
+   *
+   * When using mixed notation which combines positional and named notation,
+   * named arguments cannot precede positional arguments. The compile time check
+   * will be performed to enforce that. For example:
+   *
+   * @code
+   * conn.invoke("person_info", 1, a{"name", "Christopher"});
+   * @endcode
+   *
+   * See <a href="https://www.postgresql.org/docs/current/static/sql-syntax-calling-funcs.html">calling functions</a>
+   * section of the PostgreSQL documentation for the full details on calling
+   * notations.
+   *
+   * @returns The released instance.
+   *
+   * @par Responses
+   * Similar to execute().
+   *
+   * @param callback Same as for process_responses().
+   * @param function A function name to invoke.
+   * @param arguments Function arguments.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !function.empty()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks It may be problematic to invoke overloaded functions with same
+   * number of parameters. A SQL query with explicit type casts should be
+   * executed is such a case. See remarks of prepare_nio().
+   *
+   * @see invoke_unexpanded(), call(), execute().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Completion>
+  invoke(F&& callback, std::string_view function, Types&& ... arguments)
+  {
+    static_assert(is_routine_arguments_ok__<Types...>(),
+      "named arguments cannot precede positional arguments");
+    invoke_nio__(function, "SELECT * FROM", std::forward<Types>(arguments)...);
+    return completion_or_throw(
+      process_responses<on_exception>(std::forward<F>(callback)));
+  }
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete, typename ... Types>
+  Completion invoke(std::string_view function, Types&& ... arguments)
+  {
+    return invoke<on_exception>(ignore_row, function,
+      std::forward<Types>(arguments)...);
+  }
+
+  /**
+   * @brief Requests the server to invoke the specified function and waits for
+   * a response.
+   *
+   * @details This method is similar to invoke() but even if `function` returns
    * table with multiple columns or has multiple output parameters the result
    * row is always consists of exactly one field.
    *
@@ -948,10 +1803,9 @@ public:
   {
     static_assert(is_routine_arguments_ok__<Types...>(),
       "named arguments cannot precede positional arguments");
-    const auto stmt = routine_query__(function,
-      "SELECT", std::forward<Types>(arguments)...);
-    return execute<on_exception>(std::forward<F>(callback),
-      stmt, std::forward<Types>(arguments)...);
+    invoke_nio__(function, "SELECT", std::forward<Types>(arguments)...);
+    return completion_or_throw(
+      process_responses<on_exception>(std::forward<F>(callback)));
   }
 
   /// @overload
@@ -983,10 +1837,9 @@ public:
   {
     static_assert(is_routine_arguments_ok__<Types...>(),
       "named arguments cannot precede positional arguments");
-    const auto stmt = routine_query__(procedure,
-      "CALL", std::forward<Types>(arguments)...);
-    return execute<on_exception>(std::forward<F>(callback),
-      stmt, std::forward<Types>(arguments)...);
+    invoke_nio__(procedure, "CALL", std::forward<Types>(arguments)...);
+    return completion_or_throw(
+      process_responses<on_exception>(std::forward<F>(callback)));
   }
 
   /// @overload
@@ -998,6 +1851,89 @@ public:
       procedure, std::forward<Types>(arguments)...);
   }
 
+  /**
+   * @brief Similar to execute(F&&, const Statement&, Types&& ...), but returns
+   * the error of the server as the value instead of throwing Server_exception.
+   *
+   * @par Requires
+   * `is_ready_for_request() && !statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see process_responses_nothrow().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Ret<Completion>>
+  execute_nothrow(F&& callback, const Statement& statement, Types&& ... parameters)
+  {
+    if (!is_ready_for_request())
+      throw Client_exception{"cannot execute statement: not ready for request"};
+    execute_cached_nio__(true, statement,
+      std::forward<Types>(parameters)...);
+    return process_responses_nothrow<on_exception>(std::forward<F>(callback));
+  }
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete, typename ... Types>
+  Ret<Completion> execute_nothrow(const Statement& statement, Types&& ... parameters)
+  {
+    return execute_nothrow<on_exception>(ignore_row, statement,
+      std::forward<Types>(parameters)...);
+  }
+
+  /**
+   * @brief Similar to invoke(), but returns the error of the server as the
+   * value instead of throwing Server_exception.
+   *
+   * @see invoke(), execute_nothrow().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Ret<Completion>>
+  invoke_nothrow(F&& callback, std::string_view function, Types&& ... arguments)
+  {
+    static_assert(is_routine_arguments_ok__<Types...>(),
+      "named arguments cannot precede positional arguments");
+    invoke_nio__(function, "SELECT * FROM", std::forward<Types>(arguments)...);
+    return process_responses_nothrow<on_exception>(std::forward<F>(callback));
+  }
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete, typename ... Types>
+  Ret<Completion> invoke_nothrow(std::string_view function, Types&& ... arguments)
+  {
+    return invoke_nothrow<on_exception>(ignore_row, function,
+      std::forward<Types>(arguments)...);
+  }
+
+  /**
+   * @brief Similar to call(), but returns the error of the server as the value
+   * instead of throwing Server_exception.
+   *
+   * @see call(), execute_nothrow().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Ret<Completion>>
+  call_nothrow(F&& callback, std::string_view procedure, Types&& ... arguments)
+  {
+    static_assert(is_routine_arguments_ok__<Types...>(),
+      "named arguments cannot precede positional arguments");
+    invoke_nio__(procedure, "CALL", std::forward<Types>(arguments)...);
+    return process_responses_nothrow<on_exception>(std::forward<F>(callback));
+  }
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete,
+    typename ... Types>
+  Ret<Completion> call_nothrow(std::string_view procedure, Types&& ... arguments)
+  {
+    return call_nothrow<on_exception>(ignore_row,
+      procedure, std::forward<Types>(arguments)...);
+  }
+
   /**
    * @brief Enables or disables the pipeline on this instance.
    *
@@ -1020,58 +1956,505 @@ public:
    * @par Requires
    * libpq from PostgreSQL 14 or more recent version.
    *
-   * @par Effects
-   *   - if `value`, then `!is_ready_for_request()` and
-   *   `is_ready_for_nio_request()` and `pipeline_status() == Pipeline_status::enabled`;
-   *   - if `!value`, then `is_ready_for_request()` and
-   *   `is_ready_for_nio_request()` and `pipeline_status() == Pipeline_status::disabled`.
+   * @par Effects
+   *   - if `value`, then `!is_ready_for_request()` and
+   *   `is_ready_for_nio_request()` and `pipeline_status() == Pipeline_status::enabled`;
+   *   - if `!value`, then `is_ready_for_request()` and
+   *   `is_ready_for_nio_request()` and `pipeline_status() == Pipeline_status::disabled`.
+   *
+   * @throws Client_exception on error.
+   *
+   * @see pipeline_status(), send_sync(), send_flush().
+   */
+  DMITIGR_PGFE_API void set_pipeline_enabled(bool value);
+
+  /// @returns The status of pipeline.
+  DMITIGR_PGFE_API Pipeline_status pipeline_status() const noexcept;
+
+  /**
+   * @brief Sends a Sync message to the server.
+   *
+   * @par Requires
+   * libpq from PostgreSQL 14 or more recent version.
+   *
+   * @remarks At present, this method is only useful to mark a synchronization
+   * point in a pipeline and to cause the server to flush its output buffer.
+   *
+   * @see send_flush(), set_pipeline_enabled().
+   */
+  DMITIGR_PGFE_API void send_sync();
+
+  /**
+   * @brief Sends a Flush message to the server.
+   *
+   * @par Requires
+   * libpq from PostgreSQL 14 or more recent version.
+   *
+   * @remarks At present, this method is only useful to flush the server's
+   * point in a pipeline and to cause the server to flush its output buffer
+   * without establishing a synchronization point (as with send_sync()).
+   *
+   * @see send_sync(), set_pipeline_enabled().
+   */
+  DMITIGR_PGFE_API void send_flush();
+
+  /**
+   * @brief Sets the number of requests queued by execute_pipelined() after
+   * which the synchronization point is established automatically.
+   *
+   * @par Requires
+   * `value > 0`.
+   *
+   * @see execute_pipelined(), pipeline_sync_request_threshold().
+   */
+  DMITIGR_PGFE_API void set_pipeline_sync_request_threshold(std::size_t value);
+
+  /// @returns The current value of the threshold. (Default is 64.)
+  DMITIGR_PGFE_API std::size_t pipeline_sync_request_threshold() const noexcept;
+
+  /**
+   * @brief Sets the estimated number of bytes of requests queued by
+   * execute_pipelined() after which the synchronization point is established
+   * automatically.
+   *
+   * @par Requires
+   * `value > 0`.
+   *
+   * @see execute_pipelined(), pipeline_sync_byte_threshold().
+   */
+  DMITIGR_PGFE_API void set_pipeline_sync_byte_threshold(std::size_t value);
+
+  /// @returns The current value of the threshold. (Default is 65536.)
+  DMITIGR_PGFE_API std::size_t pipeline_sync_byte_threshold() const noexcept;
+
+  /**
+   * @brief Sets the maximum size of the request queue when using
+   * execute_pipelined().
+   *
+   * @details When the request queue is full, execute_pipelined() waits for
+   * the responses and dispatches them before queueing a new request.
+   *
+   * @par Requires
+   * `value > 0`.
+   *
+   * @see execute_pipelined(), pipeline_max_depth().
+   */
+  DMITIGR_PGFE_API void set_pipeline_max_depth(std::size_t value);
+
+  /// @returns The current value of the maximum depth. (Default is 1024.)
+  DMITIGR_PGFE_API std::size_t pipeline_max_depth() const noexcept;
+
+  /**
+   * @brief Queues the execution of the statement in the pipeline and
+   * associates `handler` with it.
+   *
+   * @details The synchronization point is established automatically when
+   * either of thresholds is crossed (see set_pipeline_sync_request_threshold()
+   * and set_pipeline_sync_byte_threshold()). The responses are dispatched in
+   * order by poll_pipeline(), complete_pipeline() and by this function itself
+   * when the request queue is full (see set_pipeline_max_depth()).
+   *
+   * @param handler A callback which is called with each response on the
+   * request. It can be a generic lambda or can be a function object invocable
+   * with some of `Row&&`, `Completion&&` and `Error&&`. The responses of types
+   * for which the handler is not invocable are discarded. An invalid Error is
+   * passed if the execution is skipped by the server because of an error of
+   * one of the preceding requests of the same synchronization point.
+   * @param statement A *preparsed* statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement.
+   *
+   * @par Requires
+   * `pipeline_status() != Pipeline_status::disabled` and
+   * `!statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks The responses on requests queued by other functions (for example,
+   * execute_nio()) are discarded while dispatching.
+   *
+   * @see complete_pipeline(), poll_pipeline().
+   */
+  template<typename F, typename ... Types>
+  void execute_pipelined(F&& handler, const Statement& statement,
+    Types&& ... parameters)
+  {
+    if (pipeline_status() == Pipeline_status::disabled)
+      throw Client_exception{"cannot execute statement in pipeline: "
+        "pipeline is disabled"};
+    execute_with_handler__(std::forward<F>(handler), statement,
+      std::forward<Types>(parameters)...);
+  }
+
+  /**
+   * @brief Submits a request to execute the statement and returns the handle
+   * of its result.
+   *
+   * @details If the pipeline is enabled, the request is queued as by
+   * execute_pipelined(). Thus, many requests can be in flight on the same
+   * connection at the same time.
+   *
+   * @param statement A *preparsed* statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement.
+   *
+   * @returns The pending result which collects the rows, the completion or
+   * the error of the request.
+   *
+   * @par Requires
+   * `is_ready_for_nio_request() && !statement.has_missing_parameters()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see Pending_result, execute_pipelined().
+   */
+  template<typename ... Types>
+  Pending_result execute_async(const Statement& statement,
+    Types&& ... parameters)
+  {
+    auto state = std::make_shared<Pending_result::State>();
+    state->connection_ = this;
+    execute_with_handler__([state](auto&& response)
+    {
+      using R = std::decay_t<decltype(response)>;
+      if constexpr (std::is_same_v<R, Row>)
+        state->rows_.push_back(std::move(response));
+      else {
+        if constexpr (std::is_same_v<R, Completion>)
+          state->completion_ = std::move(response);
+        else
+          state->error_ = std::move(response);
+        state->is_ready_ = true;
+      }
+    }, statement, std::forward<Types>(parameters)...);
+    return Pending_result{std::move(state)};
+  }
+
+  /**
+   * @brief Dispatches the responses which are available without blocking to
+   * the handlers of requests queued by execute_pipelined().
+   *
+   * @par Requires
+   * `pipeline_status() != Pipeline_status::disabled`.
+   *
+   * @see execute_pipelined(), complete_pipeline().
+   */
+  DMITIGR_PGFE_API void poll_pipeline();
+
+  /**
+   * @brief Establishes the synchronization point if needed, waits for all the
+   * responses and dispatches them to the handlers of requests queued by
+   * execute_pipelined().
+   *
+   * @par Requires
+   * `pipeline_status() != Pipeline_status::disabled`.
+   *
+   * @par Effects
+   * `!has_uncompleted_request()`.
+   *
+   * @remarks The errors of the server are passed to the handlers (as well as
+   * the invalid Error for each aborted request) rather than thrown.
+   *
+   * @see execute_pipelined(), poll_pipeline().
+   */
+  DMITIGR_PGFE_API void complete_pipeline();
+
+  /**
+   * @brief Discards the responses to the requests aborted in the pipeline up
+   * to the next synchronization point.
+   *
+   * @details When a request in the pipeline fails, the responses to all the
+   * subsequent requests up to the next synchronization point are received
+   * with the status `PGRES_PIPELINE_ABORTED`. This function discards these
+   * responses as they are received, without creating the instances of Error
+   * or Completion for each of them. The handlers of requests queued by
+   * execute_pipelined() are called with the invalid Error as usual. The
+   * current response, if any, is discarded too. The synchronization point
+   * itself is not consumed, so the next response is Ready_for_query.
+   *
+   * @returns The indexes of the aborted requests in the request queue as it
+   * was before the call, or empty vector if the pipeline is not aborted.
+   *
+   * @par Requires
+   * `pipeline_status() != Pipeline_status::disabled`.
+   *
+   * @par Effects
+   * `pipeline_status() != Pipeline_status::aborted` after the next response
+   * is handled.
+   *
+   * @see pipeline_status(), complete_pipeline().
+   */
+  DMITIGR_PGFE_API std::vector<std::size_t> drain_aborted_pipeline();
+
+  /**
+   * @brief Sets the default data format of statements execution results.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void set_result_format(const Data_format format);
+
+  /// @returns The default data format of a statement execution result.
+  DMITIGR_PGFE_API Data_format result_format() const noexcept;
+
+  /**
+   * @brief Enables the simple query protocol for the statements executed
+   * without parameters.
+   *
+   * @details By default, each statement is executed by the extended query
+   * protocol (that is, by the messages Parse, Bind, Describe, Execute and
+   * Sync). If enabled, the statements which have no parameters to bind are
+   * sent by the single message Query instead, which costs less on both sides.
+   * The simple query protocol is not used for:
+   *   - the prepared statements (including the ones of the statement cache);
+   *   - the statements executed in pipeline mode;
+   *   - the statements executed while result_format() is Data_format::binary,
+   *   since the results of the simple query protocol are always in
+   *   Data_format::text format.
+   *
+   * @remarks If the statement executed by the simple query protocol consists
+   * of the multiple SQL commands, the first error, or otherwise the completion
+   * of the last command is the response. The rows are delivered only for the
+   * first command in Row_delivery_mode::single and Row_delivery_mode::chunked
+   * (since they are delivered as they are received), and only for the last
+   * command (if it returns rows) in Row_delivery_mode::full.
+   *
+   * @see execute_simple().
+   */
+  DMITIGR_PGFE_API void set_simple_query_enabled(bool value) noexcept;
+
+  /// @returns `true` if the simple query protocol is enabled.
+  DMITIGR_PGFE_API bool is_simple_query_enabled() const noexcept;
+
+  /**
+   * @brief Sets the default row delivery mode of statements execution results.
+   *
+   * @details By default, Row_delivery_mode::single is used.
+   *
+   * @throws Client_exception if `mode == Row_delivery_mode::chunked` but
+   * libpq doesn't support it.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Row_delivery_mode, set_rows_chunk_size(),
+   * Prepared_statement::set_row_delivery_mode().
+   */
+  DMITIGR_PGFE_API void set_row_delivery_mode(Row_delivery_mode mode);
+
+  /// @returns The default row delivery mode of statements execution results.
+  DMITIGR_PGFE_API Row_delivery_mode row_delivery_mode() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of rows in a chunk when the rows are
+   * delivered in Row_delivery_mode::chunked mode.
+   *
+   * @remarks The size of chunks is tuned automatically for the statements
+   * executed in Row_delivery_mode::adaptive mode.
+   *
+   * @par Requires
+   * `0 < size && size <= INT_MAX`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void set_rows_chunk_size(std::size_t size);
+
+  /// @returns The maximum number of rows in a chunk.
+  DMITIGR_PGFE_API std::size_t rows_chunk_size() const noexcept;
+
+  /**
+   * @brief Sets the default limit of the client-side memory of the results
+   * produced by a statement execution.
+   *
+   * @param limit The value of `std::nullopt` means no limit.
+   *
+   * @par Requires
+   * `!limit || *limit > 0`.
+   *
+   * @see Result_memory_policy, set_result_memory_policy(),
+   * Prepared_statement::set_result_memory_limit().
+   */
+  DMITIGR_PGFE_API void
+  set_result_memory_limit(std::optional<std::size_t> limit);
+
+  /// @returns The default limit of the client-side memory of the results.
+  DMITIGR_PGFE_API std::optional<std::size_t>
+  result_memory_limit() const noexcept;
+
+  /**
+   * @brief Sets the policy of the limit of the client-side memory of the
+   * results.
+   *
+   * @details By default, Result_memory_policy::cancel is used. The policy
+   * is applied to the requests sent after this call.
+   *
+   * @see set_result_memory_limit().
+   */
+  DMITIGR_PGFE_API void
+  set_result_memory_policy(Result_memory_policy policy) noexcept;
+
+  /// @returns The policy of the limit of the client-side memory of the results.
+  DMITIGR_PGFE_API Result_memory_policy result_memory_policy() const noexcept;
+
+  /**
+   * @brief Sets the capacity of the statement cache.
+   *
+   * @details The statement cache is used by execute() to transparently prepare
+   * the statements which are executed frequently, so the server doesn't need
+   * to parse and plan them on each execution. The statements are identified
+   * by their query strings. The least recently used statements are evicted
+   * from the cache (and deallocated) when the capacity is exceeded. The cache
+   * is cleared if either `DISCARD ALL` or `DEALLOCATE ALL` is executed.
+   *
+   * @details By default, the capacity is `0` which means the cache is disabled.
+   *
+   * @par Requires
+   * `!is_connected() || is_ready_for_request()` if prepared statements must
+   * be evicted from the cache.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks execute_nio() uses the statements which are already prepared by
+   * the cache, but never prepares the statements itself.
+   *
+   * @see set_statement_cache_threshold(), clear_statement_cache().
+   */
+  DMITIGR_PGFE_API void set_statement_cache_capacity(std::size_t capacity);
+
+  /// @returns The capacity of the statement cache.
+  DMITIGR_PGFE_API std::size_t statement_cache_capacity() const noexcept;
+
+  /// @returns The number of statements in the statement cache.
+  DMITIGR_PGFE_API std::size_t statement_cache_size() const noexcept;
+
+  /**
+   * @brief Sets the number of executions of a statement after which the
+   * statement is prepared by the statement cache.
+   *
+   * @details By default, the threshold is `5`.
+   *
+   * @par Requires
+   * `count > 0`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void set_statement_cache_threshold(std::size_t count);
+
+  /// @returns The threshold of the statement cache.
+  DMITIGR_PGFE_API std::size_t statement_cache_threshold() const noexcept;
+
+  /**
+   * @brief Deallocates the statements prepared by the statement cache and
+   * clears the cache.
+   *
+   * @par Requires
+   * `!is_connected() || is_ready_for_request()` if there are prepared
+   * statements in the cache.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  DMITIGR_PGFE_API void clear_statement_cache();
+
+  /**
+   * @brief Enables or disables the routine cache.
+   *
+   * @details When enabled, the queries generated by invoke(),
+   * invoke_unexpanded() and call() (and by their exception-free variants) are
+   * parsed once per routine name and argument signature, and executed as the
+   * named prepared statements, which are prepared upon the first invocation.
+   * By default, the routine cache is disabled.
    *
-   * @throws Client_exception on error.
+   * @remarks The parsed queries are retained across sessions, while the
+   * prepared statements are prepared again after being deallocated (for
+   * example, by `DISCARD ALL`).
    *
-   * @see pipeline_status(), send_sync(), send_flush().
+   * @see clear_routine_cache().
    */
-  DMITIGR_PGFE_API void set_pipeline_enabled(bool value);
+  DMITIGR_PGFE_API void set_routine_cache_enabled(bool value) noexcept;
 
-  /// @returns The status of pipeline.
-  DMITIGR_PGFE_API Pipeline_status pipeline_status() const noexcept;
+  /// @returns `true` if the routine cache is enabled.
+  DMITIGR_PGFE_API bool is_routine_cache_enabled() const noexcept;
+
+  /// @returns The number of queries in the routine cache.
+  DMITIGR_PGFE_API std::size_t routine_cache_size() const noexcept;
 
   /**
-   * @brief Sends a Sync message to the server.
+   * @brief Deallocates the statements prepared by the routine cache and
+   * clears the cache.
    *
    * @par Requires
-   * libpq from PostgreSQL 14 or more recent version.
-   *
-   * @remarks At present, this method is only useful to mark a synchronization
-   * point in a pipeline and to cause the server to flush its output buffer.
+   * `!is_connected() || is_ready_for_request()` if there are prepared
+   * statements in the cache.
    *
-   * @see send_flush(), set_pipeline_enabled().
+   * @par Exception safety guarantee
+   * Basic.
    */
-  DMITIGR_PGFE_API void send_sync();
+  DMITIGR_PGFE_API void clear_routine_cache();
 
   /**
-   * @brief Sends a Flush message to the server.
+   * @brief Sets the registry of the statements to be prepared on demand.
+   *
+   * @details The registry can be shared by the connections to the same
+   * database.
    *
    * @par Requires
-   * libpq from PostgreSQL 14 or more recent version.
+   * `registry`.
    *
-   * @remarks At present, this method is only useful to flush the server's
-   * point in a pipeline and to cause the server to flush its output buffer
-   * without establishing a synchronization point (as with send_sync()).
+   * @see prepared_statement_registry(), registered_statement().
+   */
+  DMITIGR_PGFE_API void set_prepared_statement_registry(
+    std::shared_ptr<Prepared_statement_registry> registry);
+
+  /**
+   * @returns The registry of the statements to be prepared on demand.
    *
-   * @see send_sync(), set_pipeline_enabled().
+   * @remarks By default, each connection has its own registry.
+   *
+   * @see set_prepared_statement_registry().
    */
-  DMITIGR_PGFE_API void send_flush();
+  DMITIGR_PGFE_API const std::shared_ptr<Prepared_statement_registry>&
+  prepared_statement_registry() const noexcept;
 
   /**
-   * @brief Sets the default data format of statements execution results.
+   * @returns The statement `name` of the registry, which is prepared at first
+   * if it isn't prepared in the current session yet. (For example, after
+   * reconnect or `DISCARD ALL`.)
+   *
+   * @par Requires
+   * `prepared_statement_registry()->contains(name)` and
+   * `is_ready_for_request()` if the statement isn't prepared yet.
    *
    * @par Exception safety guarantee
-   * Strong.
+   * Basic.
+   *
+   * @remarks The statement is described by the server only if its description
+   * is not yet known by the registry.
+   *
+   * @see prepare_registered_statements().
    */
-  DMITIGR_PGFE_API void set_result_format(const Data_format format);
+  DMITIGR_PGFE_API Prepared_statement registered_statement(std::string_view name);
 
-  /// @returns The default data format of a statement execution result.
-  DMITIGR_PGFE_API Data_format result_format() const noexcept;
+  /**
+   * @brief Prepares all the statements of the registry which are not prepared
+   * in the current session yet.
+   *
+   * @details All the requests are sent in the pipeline, so the whole registry
+   * is prepared at the cost of about one round trip (two round trips if some
+   * of the statements must be described). It's intended to be called from the
+   * connect handler of the pool (see Connection_pool::set_connect_handler()).
+   *
+   * @par Requires
+   * `is_ready_for_request()`.
+   *
+   * @throws Server_exception with the first error of the server, if any.
+   *
+   * @see registered_statement().
+   */
+  DMITIGR_PGFE_API void prepare_registered_statements();
 
   ///@}
 
@@ -1150,6 +2533,43 @@ public:
   DMITIGR_PGFE_API void export_large_object(Oid oid,
     const std::filesystem::path& filename);
 
+  /**
+   * @brief Requests the server to read the range of the large object into
+   * the `buf` in a single round trip.
+   *
+   * @details The range is read by the server-side function `lo_get()`, which
+   * is called by the statement prepared on demand and cached in the routine
+   * cache. Thus, no transaction and no descriptor is needed, unlike the
+   * read of Large_object which requires the separate seek.
+   *
+   * @param oid The OID of the large object.
+   * @param offset The offset of the range.
+   * @param buf The buffer to read the range into.
+   * @param size The size of the range.
+   *
+   * @returns The number of bytes read, which is less than `size` only if
+   * the range exceeds the end of the large object.
+   *
+   * @par Requires
+   * `is_ready_for_request() && offset >= 0 && (buf || !size) &&
+   * size <= std::numeric_limits<int>::max()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see Parallel_large_object_transfer::read_range().
+   */
+  DMITIGR_PGFE_API std::size_t read_large_object_range(Oid oid,
+    std::int_fast64_t offset, char* buf, std::size_t size);
+
+  /**
+   * @overload
+   *
+   * @returns The bytes of the range.
+   */
+  DMITIGR_PGFE_API std::vector<std::byte> read_large_object_range(Oid oid,
+    std::int_fast64_t offset, std::size_t length);
+
   /// @}
 
   // ---------------------------------------------------------------------------
@@ -1198,6 +2618,42 @@ public:
   DMITIGR_PGFE_API std::string
   to_quoted_identifier(const std::string_view identifier) const;
 
+  /**
+   * @brief Appends the quoted `literal` to `result`.
+   *
+   * @details The quoting is performed without intermediate allocations by
+   * taking into account the value of `standard_conforming_strings` and the
+   * client encoding. (For the client-only encodings, such as `SJIS` or `BIG5`,
+   * which multibyte characters can contain the bytes of ASCII quote
+   * characters, the quoting is performed by libpq.)
+   *
+   * @par Requires
+   * `is_connected()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see to_quoted_literal().
+   */
+  DMITIGR_PGFE_API void append_quoted_literal(std::string& result,
+    std::string_view literal) const;
+
+  /**
+   * @brief Appends the quoted `identifier` to `result`.
+   *
+   * @details See the details of append_quoted_literal().
+   *
+   * @par Requires
+   * `is_connected()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see to_quoted_identifier().
+   */
+  DMITIGR_PGFE_API void append_quoted_identifier(std::string& result,
+    std::string_view identifier) const;
+
   /**
    * @brief Encodes the binary data into the textual representation to be used
    * in a SQL query.
@@ -1230,11 +2686,43 @@ public:
    */
   DMITIGR_PGFE_API std::string to_hex_string(const Data& data) const;
 
+  /**
+   * @brief Sets the catalog of the data types of the server.
+   *
+   * @details The catalog can be shared by the connections to the same
+   * database.
+   *
+   * @par Requires
+   * `catalog`.
+   *
+   * @see type_catalog().
+   */
+  DMITIGR_PGFE_API void set_type_catalog(std::shared_ptr<Type_catalog> catalog);
+
+  /**
+   * @returns The catalog of the data types of the server.
+   *
+   * @remarks By default, each connection has its own catalog, which is empty
+   * until loaded by Type_catalog::load().
+   *
+   * @see set_type_catalog().
+   */
+  DMITIGR_PGFE_API const std::shared_ptr<Type_catalog>&
+  type_catalog() const noexcept;
+
   ///@}
 private:
+  friend Connection_pool;
+  friend Connection_reactor;
   friend Copier;
   friend Large_object;
+  friend Large_object_streambuf;
+  friend Pending_result;
   friend Prepared_statement;
+  friend Traffic_replayer;
+  friend Connection
+  connect_first(const std::vector<Connection_options>&,
+    std::optional<std::chrono::milliseconds>);
 
   // ---------------------------------------------------------------------------
   // Persistent data
@@ -1242,18 +2730,43 @@ private:
 
   // Persistent data / constant data
   Options options_;
+  std::shared_ptr<const Compiled_connection_options> compiled_options_;
 
   // Persistent data / public-modifiable data
   Error_handler error_handler_;
   Notice_handler notice_handler_{&default_notice_handler};
+  std::optional<Problem_severity> notice_min_severity_;
   Notification_handler notification_handler_;
+  Trace_handler trace_handler_;
+  std::shared_ptr<Traffic_recorder> traffic_recorder_;
+  std::uint_least32_t traffic_session_{};
   Data_format default_result_format_{Data_format::text};
+  bool is_simple_query_enabled_{};
+  Row_delivery_mode default_row_delivery_mode_{Row_delivery_mode::single};
+  int rows_chunk_size_{1024};
+  std::optional<std::size_t> result_memory_limit_;
+  Result_memory_policy result_memory_policy_{Result_memory_policy::cancel};
+  std::size_t statement_cache_capacity_{};
+  std::size_t statement_cache_threshold_{5};
+  bool is_routine_cache_enabled_{};
+  bool is_metrics_enabled_{};
+  bool is_query_tagging_enabled_{};
+  std::optional<std::chrono::milliseconds> request_timeout_;
+  std::shared_ptr<Type_catalog> type_catalog_;
+  std::shared_ptr<Prepared_statement_registry> ps_registry_;
 
   // Persistent data / private-modifiable data
   std::shared_ptr<Prepared_statement::State> execute_ps_state_;
+  Data_arena execute_data_arena_;
   std::unique_ptr<PGconn> conn_;
   std::optional<Status> polling_status_;
   std::int_fast64_t lo_id_{};
+  Connection_metrics metrics_;
+  std::string tagged_query_; // the buffer of tagged_query()
+  std::string binding_query_; // the buffer of execute_binding_nio__()
+  // The query strings of statements by revisions (see query_string__()).
+  std::unordered_map<std::uint64_t, std::string> query_strings_;
+  std::future<void> cancel_request_; // the cancel request being sent
 
   PGconn* conn() const noexcept
   {
@@ -1264,6 +2777,19 @@ private:
   // Session data / requests
   // ---------------------------------------------------------------------------
 
+  /// A state of traced request.
+  struct Trace_state final {
+    Trace_request request_{};
+    std::string query_;
+    std::string prepared_statement_name_;
+    std::string tag_;
+    std::size_t parameter_count_{};
+    std::chrono::steady_clock::time_point start_time_;
+    std::uint_least64_t row_count_{};
+    std::uint_least64_t byte_count_{};
+    bool has_first_row_{};
+  };
+
   /// A request.
   struct Request final {
     enum class Id {
@@ -1284,25 +2810,126 @@ private:
     Request& operator=(Request&&) = default;
 
     Id id_{};
+    Row_delivery_mode row_delivery_mode_{};
+    int rows_chunk_size_{}; // 0 means rows_chunk_size()
+    std::weak_ptr<Prepared_statement::State> delivery_state_; // if adaptive
+    std::size_t delivery_row_count_{}; // accounted if delivery_state_ is set
+    std::size_t delivery_byte_count_{}; // accounted if delivery_state_ is set
     Prepared_statement prepared_statement_;
     std::optional<std::string> prepared_statement_name_;
+    std::unique_ptr<detail::Pipeline_handler> pipeline_handler_;
+    std::unique_ptr<Trace_state> trace_state_; // null if not traced
+    std::chrono::steady_clock::time_point send_time_; // if metrics enabled
+    std::chrono::steady_clock::time_point first_row_time_; // if metrics enabled
+    std::chrono::steady_clock::time_point deadline_; // if not canceled yet
+    std::optional<std::size_t> result_memory_limit_;
+    Result_memory_policy result_memory_policy_{};
+    std::size_t result_memory_size_{}; // accounted by the policy
+    bool is_simple_query_{}; // can have the results of the multiple commands
   };
 
   std::optional<std::chrono::system_clock::time_point> session_start_time_;
 
   detail::pq::Result response_; // synchronized with response_status_ ...
   Response_status response_status_{}; // ... by handle_input()
+  int response_row_number_{}; // the number of next row of multi-row response_
   Prepared_statement last_prepared_statement_;
   bool is_output_flushed_{true};
   std::shared_ptr<Connection*> copier_state_;
-  bool is_single_row_mode_enabled_{};
+  bool is_row_delivery_mode_set_{};
+  std::shared_ptr<detail::Field_name_index> field_name_index_;
+  std::uint_fast64_t field_name_index_request_{}; // see field_name_index()
+  std::uint_fast64_t dismissed_request_count_{};
+
+  // The keys of ps_states_ are views of the (immutable) State::id_.
+  std::unordered_map<std::string_view,
+    std::shared_ptr<Prepared_statement::State>> ps_states_;
+  std::unordered_map<std::int_fast64_t,
+    std::shared_ptr<Large_object::State>> lo_states_;
+
+  /// An entry of the statement cache.
+  struct Statement_cache_entry final {
+    std::string query_;
+    std::size_t execution_count_{};
+    std::shared_ptr<Prepared_statement::State> state_; // null if not prepared
+  };
+
+  std::list<Statement_cache_entry> statement_cache_; // the MRU entry is first
+  std::unordered_map<std::string_view,
+    decltype(statement_cache_)::iterator> statement_cache_index_;
+  std::uint_fast64_t statement_cache_ps_id_{};
 
-  std::list<std::shared_ptr<Prepared_statement::State>> ps_states_;
-  std::list<std::shared_ptr<Large_object::State>> lo_states_;
+  /// An entry of the routine cache.
+  struct Routine_cache_entry final {
+    std::shared_ptr<Statement> statement_;
+    std::shared_ptr<Prepared_statement::State> state_; // null if not prepared
+  };
+
+  // The keys are the generated queries.
+  std::unordered_map<std::string, Routine_cache_entry> routine_cache_;
+  std::uint_fast64_t routine_cache_ps_id_{};
 
-  std::queue<Request> requests_;
+  // The states of the statements of ps_registry_ prepared by this instance.
+  std::unordered_map<std::string,
+    std::shared_ptr<Prepared_statement::State>> ps_registry_states_;
+
+  util::Ring_buffer<Request> requests_; // the slots are reused
   Request last_processed_request_;
 
+  /// The reusable buffers of parameters to pass to libpq.
+  struct Parameter_buffers final {
+    /// The maximum number of parameters which are passed via stack.
+    static constexpr std::size_t stack_capacity{16};
+    std::vector<const char*> values_;
+    std::vector<int> lengths_;
+    std::vector<int> formats_;
+    std::vector<::Oid> types_;
+  };
+  Parameter_buffers parameter_buffers_;
+
+  std::size_t pipeline_sync_request_threshold_{64};
+  std::size_t pipeline_sync_byte_threshold_{65536};
+  std::size_t pipeline_max_depth_{1024};
+  std::size_t pipeline_unsynced_request_count_{};
+  std::size_t pipeline_unsynced_byte_count_{};
+
+  /// Enables the pipeline (if disabled) until restore() or destruction.
+  class Pipeline_scope final {
+  public:
+    explicit Pipeline_scope(Connection& conn)
+      : conn_{conn}
+      , is_enabled_{conn.pipeline_status() == Pipeline_status::disabled}
+    {
+      if (is_enabled_)
+        conn_.set_pipeline_enabled(true);
+    }
+
+    ~Pipeline_scope()
+    {
+      try {
+        restore();
+      } catch (...) {
+        // The connection is in unknown state anyway.
+      }
+    }
+
+    Pipeline_scope(const Pipeline_scope&) = delete;
+    Pipeline_scope& operator=(const Pipeline_scope&) = delete;
+
+    /// Disables the pipeline if it was disabled upon construction.
+    void restore()
+    {
+      if (is_enabled_) {
+        is_enabled_ = false;
+        conn_.set_pipeline_enabled(false);
+      }
+    }
+
+  private:
+    Connection& conn_;
+    bool is_enabled_{};
+  };
+
   bool is_invariant_ok() const noexcept;
 
   // ---------------------------------------------------------------------------
@@ -1312,13 +2939,7 @@ private:
   template<class C, typename T>
   static auto registered(C&& container, const T& id) noexcept
   {
-    const auto b = begin(std::forward<C>(container));
-    const auto e = end(std::forward<C>(container));
-    const auto p = find_if(b, e, [&id](const auto& reg)
-    {
-      return reg->id_ == id;
-    });
-    return std::make_pair(p, e);
+    return std::make_pair(container.find(id), container.end());
   }
 
   template<class C>
@@ -1329,17 +2950,21 @@ private:
      * SQL PREPARE but deallocated with unprepare().
      */
     if (p != end(states)) {
-      DMITIGR_ASSERT((*p)->connection_ == this);
-      (*p)->connection_ = nullptr; // invalidate instance(-s)
-      states.erase(p);             // remove the copy of state
+      DMITIGR_ASSERT(p->second->connection_ == this);
+      p->second->connection_ = nullptr; // invalidate instance(-s)
+      states.erase(p);                  // remove the copy of state
     }
   }
 
   detail::pq::Result release_response() noexcept;
   void reset_response(detail::pq::Result&& response) noexcept;
   void reset_session() noexcept;
+  void set_socket_options__();
   void reset_copier_state() noexcept;
-  void set_single_row_mode_enabled() noexcept;
+  void reset_prepared_statements() noexcept;
+  void set_row_delivery_mode_enabled(const Request& request) noexcept;
+  bool has_undelivered_rows() const noexcept;
+  static void throw_if_row_delivery_mode_unavailable(Row_delivery_mode mode);
 
   // ---------------------------------------------------------------------------
   // Handlers
@@ -1356,19 +2981,37 @@ private:
   {}
 
   void prepare_nio__(const char* const query, const char* const name,
-    const Statement* const preparsed);
+    const Statement* const preparsed, const std::vector<Oid>& parameter_types);
 
   template<typename M, typename T>
-  Prepared_statement prepare__(M&& prepare, T&& statement, const std::string& name)
+  Prepared_statement prepare__(M&& prepare, T&& statement,
+    const std::string& name, const std::vector<Oid>& parameter_types,
+    const bool describe = false)
   {
     if (!is_ready_for_request())
       throw Client_exception{"cannot prepare statement: not ready for request"};
-    (this->*prepare)(std::forward<T>(statement), name);
+#ifdef LIBPQ_HAS_PIPELINING
+    if (describe) {
+      set_pipeline_enabled(true);
+      try {
+        (this->*prepare)(std::forward<T>(statement), name, parameter_types);
+      } catch (...) {
+        set_pipeline_enabled(false);
+        throw;
+      }
+      return wait_prepared_described_statement__();
+    }
+#endif
+    (this->*prepare)(std::forward<T>(statement), name, parameter_types);
     auto result = wait_prepared_statement__();
     DMITIGR_ASSERT(result);
+    if (describe)
+      result.describe();
     return result;
   }
 
+  void describe_nio__(std::shared_ptr<Prepared_statement::State> state);
+  Prepared_statement wait_prepared_described_statement__();
   Prepared_statement wait_prepared_statement__();
 
   auto registered_ps(const std::string_view name) const noexcept
@@ -1379,18 +3022,256 @@ private:
   void unregister_ps(std::string_view name) noexcept;
   void unregister_ps(decltype(ps_states_)::const_iterator p) noexcept;
 
+  template<typename ... Types>
+  void execute_nio__(std::shared_ptr<Prepared_statement::State>&& state,
+    const Statement& statement, Types&& ... parameters)
+  {
+    const bool is_cached{state != execute_ps_state_};
+    // The parameters are converted in the arena, which is cleared once sent.
+    const struct Arena_guard final {
+      Data_arena& arena;
+      ~Arena_guard() { arena.clear(); }
+    } arena_guard{execute_data_arena_};
+    Prepared_statement ps{std::move(state), &statement, false};
+    ps.set_data_arena(&execute_data_arena_);
+    ps.bind_many(std::forward<Types>(parameters)...);
+    if (is_cached)
+      ps.execute_nio();
+    else
+      ps.execute_nio(statement);
+  }
+
+  void execute_recorded_nio__(const Statement& statement,
+    const std::vector<std::optional<Data_view>>& parameters,
+    const std::vector<Oid>& parameter_types, Data_format result_format);
+
+  bool is_static_parameters_allowed__(const Statement& statement,
+    std::size_t count) const noexcept;
+
+  template<typename ... Types>
+  void execute_cached_nio__(const bool is_preparing_allowed,
+    const Statement& statement, Types&& ... parameters)
+  {
+    /*
+     * The parameters of the supported types are encoded in place and sent as
+     * is, unless the statement can be prepared by the cache or has parameters
+     * bound to it (which requires the general binding).
+     */
+    using Static = detail::Static_parameters<Types...>;
+    if constexpr (Static::is_supported) {
+      if (is_static_parameters_allowed__(statement, Static::count)) {
+        const Static static_parameters{parameters...};
+        Prepared_statement ps{execute_ps_state_};
+        ps.execute_nio(statement, static_parameters.arrays());
+        return;
+      }
+    }
+
+    // The parameters are converted in the arena, which is cleared once sent.
+    const struct Arena_guard final {
+      Data_arena& arena;
+      ~Arena_guard() { arena.clear(); }
+    } arena_guard{execute_data_arena_};
+    Prepared_statement ps{execute_ps_state_, &statement, false};
+    ps.set_data_arena(&execute_data_arena_);
+    ps.bind_many(std::forward<Types>(parameters)...);
+    // The parameters are bound first to prepare the statement of their types.
+    auto state = statement_cache_state__(statement, is_preparing_allowed, ps);
+    if (state != execute_ps_state_) {
+      state->preparsed_ = true;
+      ps.state_ = std::move(state);
+      ps.execute_nio();
+    } else
+      ps.execute_nio(statement);
+  }
+
+  template<typename ... Types>
+  void execute_binding_nio__(bool is_preparing_allowed,
+    const Statement_binding& binding, Types&& ... parameters);
+
+  // ---------------------------------------------------------------------------
+  // Fetch helpers
+  // ---------------------------------------------------------------------------
+
+  template<typename F, typename ... Types>
+  Completion fetch__(F&& callback, const Statement& statement,
+    Types&& ... parameters)
+  {
+    if (!is_ready_for_request())
+      throw Client_exception{"cannot fetch rows: not ready for request"};
+
+    // The rows are accumulated by the caller anyway.
+    const auto row_delivery_mode = default_row_delivery_mode_;
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    default_row_delivery_mode_ = Row_delivery_mode::chunked;
+#else
+    default_row_delivery_mode_ = Row_delivery_mode::full;
+#endif
+    try {
+      execute_cached_nio__(true, statement,
+        std::forward<Types>(parameters)...);
+    } catch (...) {
+      default_row_delivery_mode_ = row_delivery_mode;
+      throw;
+    }
+    default_row_delivery_mode_ = row_delivery_mode;
+    return completion_or_throw(process_responses(std::forward<F>(callback)));
+  }
+
+  template<typename T>
+  static void reserve__(std::vector<T>& container, const Row_batch& batch)
+  {
+    // Reserving per single row would defeat the geometric growth.
+    if (batch.row_count() > 1)
+      container.reserve(container.size() + batch.row_count());
+  }
+
+  template<typename ... Ts, std::size_t ... I>
+  static void fetch_columns__(const std::tuple<std::vector<Ts>&...>& columns,
+    const Row_batch& batch, std::index_sequence<I...>)
+  {
+    (fetch_column__(std::get<I>(columns), batch, I), ...);
+  }
+
+  template<typename T>
+  static void fetch_column__(std::vector<T>& column, const Row_batch& batch,
+    const std::size_t field)
+  {
+    const Column_decoder<T> decoder{batch.info(), field};
+    reserve__(column, batch);
+    for (std::size_t i{}; i < batch.row_count(); ++i)
+      column.push_back(decoder(batch.data(i, field)));
+  }
+
+  // ---------------------------------------------------------------------------
+  // Pipeline helpers
+  // ---------------------------------------------------------------------------
+
+  void send_pipeline_sync();
+  void wait_pipeline_capacity();
+
+  template<typename F, typename ... Types>
+  void execute_with_handler__(F&& handler, const Statement& statement,
+    Types&& ... parameters)
+  {
+    wait_pipeline_capacity();
+    std::unique_ptr<detail::Pipeline_handler> h{
+      new detail::Basic_pipeline_handler<std::decay_t<F>>{
+        std::forward<F>(handler)}};
+    execute_cached_nio__(false, statement,
+      std::forward<Types>(parameters)...);
+    register_pipelined_request(std::move(h), statement);
+  }
+
+  void register_pipelined_request(std::unique_ptr<detail::Pipeline_handler>&&
+    handler, const Statement& statement);
+  void dispatch_pipeline_response();
+
+  // ---------------------------------------------------------------------------
+  // Statement cache helpers
+  // ---------------------------------------------------------------------------
+
+  std::shared_ptr<Prepared_statement::State>
+  statement_cache_state__(const Statement& statement, bool is_preparing_allowed,
+    const Prepared_statement& bound);
+  std::shared_ptr<Prepared_statement::State>
+  statement_cache_state__(const std::string& query, bool is_preparing_allowed,
+    const Prepared_statement& bound);
+  void evict_statement_cache_entry__();
+  void reset_statement_cache() noexcept;
+  Routine_cache_entry& routine_cache_entry__(std::string&& query);
+  void prepare_registered__(const std::vector<
+    std::shared_ptr<detail::Registered_statement>>& entries);
+
+  // ---------------------------------------------------------------------------
+  // COPY helpers
+  // ---------------------------------------------------------------------------
+
+  long copy_into__(std::string_view table,
+    const std::vector<std::string>& columns,
+    const std::vector<std::string>& conflict_columns,
+    const std::function<void(Copy_binary_writer&)>& write_rows);
+
+  // ---------------------------------------------------------------------------
+  // Unnest helpers
+  // ---------------------------------------------------------------------------
+
+  std::string insert_unnest_query__(std::string_view table,
+    const std::vector<std::string>& columns, std::size_t array_count,
+    std::string_view suffix) const;
+  std::string update_unnest_query__(std::string_view table,
+    const std::vector<std::string>& columns, std::size_t array_count,
+    const std::vector<std::string>& key_columns) const;
+
+  template<typename ... Types, std::size_t ... I>
+  long execute_unnest__(const std::string& query,
+    const std::tuple<Types...>& arrays, std::index_sequence<I...>)
+  {
+    static_assert(((detail::Array_deepest_element<std::decay_t<Types>>
+          ::dimension_count == 1) && ...), "arrays must be one-dimensional");
+    const std::size_t sizes[]{std::size(std::get<I>(arrays))...};
+    if (std::any_of(std::cbegin(sizes), std::cend(sizes),
+        [&sizes](const auto size){return size != sizes[0];}))
+      throw Client_exception{"cannot execute unnest statement: "
+        "arrays are of different sizes"};
+    const Statement statement{query};
+    return execute(statement, binary_argument(std::get<I>(arrays))...)
+      .row_count().value_or(0);
+  }
+
   // ---------------------------------------------------------------------------
   // Utilities helpers
   // ---------------------------------------------------------------------------
 
-  int socket() const noexcept;
   void throw_if_error();
   static Completion&& completion_or_throw(Completion&& comp);
   std::string error_message() const;
   bool is_out_of_memory() const noexcept;
+  void account_rows(int offset, int count) noexcept;
+  void account_response(ExecStatusType status) noexcept;
+  void account_first_row(Request& request) noexcept;
+  void account_delivered_rows(Request& request) noexcept;
+  void account_completion(const Request& request) noexcept;
+  void dismiss_request(ExecStatusType status) noexcept;
+  std::shared_ptr<const detail::Field_name_index> field_name_index() noexcept;
+
+  void account_request(const std::size_t byte_count) noexcept
+  {
+    // The requests in pipeline mode are not flushed by libpq immediately.
+    is_output_flushed_ = !is_nio_output_enabled() &&
+      pipeline_status() == Pipeline_status::disabled;
+    if (is_metrics_enabled_) {
+      ++metrics_.request_count;
+      metrics_.bytes_sent += byte_count;
+      requests_.back().send_time_ = std::chrono::steady_clock::now();
+    }
+    if (request_timeout_)
+      requests_.back().deadline_ = std::chrono::steady_clock::now() +
+        *request_timeout_;
+    if (const auto& state = requests_.back().trace_state_) {
+      state->start_time_ = std::chrono::steady_clock::now();
+      trace(Trace_point::request, *state);
+    }
+  }
+
+  std::string_view tagged_query(std::string_view query);
+
+  /*
+   * Returns the query string of the `statement` rendered for this session.
+   * The result is valid until the next call of this function.
+   */
+  const std::string& query_string__(const Statement& statement);
+  void prepare_trace(Trace_request request, std::string_view query,
+    std::string_view prepared_statement_name, std::size_t parameter_count);
+  void trace_rows(Trace_state& state) noexcept;
+  void trace(Trace_point point, const Trace_state& state,
+    bool is_failed = false) const noexcept;
 
   std::pair<std::unique_ptr<void, void(*)(void*)>, std::size_t>
   to_hex_storage(const pgfe::Data& data) const;
+  bool is_client_encoding_ascii_safe() const noexcept;
+  void append_quoted(std::string& result, std::string_view str,
+    bool is_identifier) const;
 
   // ---------------------------------------------------------------------------
   // Large Object private API
@@ -1440,6 +3321,10 @@ private:
     return result;
   }
 
+  template<typename ... Types>
+  void invoke_nio__(std::string_view routine, std::string_view invocation,
+    Types&& ... arguments);
+
   template<std::size_t ... I, typename ... Types>
   std::string routine_arguments__(std::index_sequence<I...>, Types&& ... arguments)
   {
@@ -1497,6 +3382,71 @@ Prepared_statement::execute(F&& callback, Types&& ... parameters)
     connection().process_responses<on_exception>(std::forward<F>(callback)));
 }
 
+template<typename Range>
+Bulk_completion Prepared_statement::execute_many(const Range& tuples)
+{
+  if (!is_valid() || !connection().is_ready_for_request())
+    throw_exception("cannot execute many times");
+
+  auto& conn = connection();
+  Bulk_completion result;
+  const auto process_responses = [&conn, &result]
+  {
+    for (std::size_t i{}; i < result.execution_count_;) {
+      conn.wait_response();
+      if (auto e = conn.error()) {
+        result.errors_.emplace_back(i, std::move(e));
+        ++i;
+      } else if (conn.row())
+        continue; // discard
+      else if (auto c = conn.completion()) {
+        result.row_count_ += c.row_count().value_or(0);
+        ++result.completion_count_;
+        ++i;
+      } else {
+        // The execution is skipped due to the preceding error.
+        ++result.aborted_count_;
+        ++i;
+      }
+    }
+    conn.wait_response();
+    DMITIGR_ASSERT(conn.ready_for_query());
+  };
+
+  conn.set_pipeline_enabled(true);
+  try {
+    // The input is periodically consumed to prevent the server from blocking.
+    constexpr std::size_t input_check_interval{64};
+    for (const auto& tuple : tuples) {
+      std::apply([this](const auto& ... values)
+      {
+        bind_many(values...);
+      }, tuple);
+      execute_nio();
+      if (!(++result.execution_count_ % input_check_interval) &&
+        conn.socket_readiness(Socket_readiness::read_ready) ==
+        Socket_readiness::read_ready)
+        conn.read_input();
+    }
+    conn.send_sync();
+  } catch (...) {
+    // Bring the connection back to the normal mode if possible.
+    if (conn.is_connected() && conn.pipeline_status() != Pipeline_status::disabled) {
+      try {
+        conn.send_sync();
+        process_responses();
+        conn.set_pipeline_enabled(false);
+      } catch (...) {}
+    }
+    throw;
+  }
+  process_responses();
+  conn.set_pipeline_enabled(false);
+
+  assert(is_invariant_ok());
+  return result;
+}
+
 /**
  * @ingroup main
  *
@@ -1512,7 +3462,141 @@ inline void swap(Connection& lhs, Connection& rhs) noexcept
 #ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
 #include "connection.cpp"
 #include "large_object.cpp"
+#include "pending_result.cpp"
 #include "prepared_statement.cpp"
+#include "row_range.cpp"
 #endif
 
+// Copy_binary_writer is required by Connection::copy_into().
+#include "copy_binary_writer.hpp"
+
+// Statement_binding is required by Connection::execute(F&&,
+// const Statement_binding&, Types&& ...).
+#include "statement_binding.hpp"
+
+// Statement_vector is required by Connection::execute(F&&,
+// const Statement_vector&, Pipeline_sync_mode).
+#include "statement_vector.hpp"
+
+namespace dmitigr::pgfe {
+
+template<typename ... Types>
+void Connection::execute_nio(const Statement_binding& binding,
+  Types&& ... parameters)
+{
+  execute_binding_nio__(false, binding, std::forward<Types>(parameters)...);
+}
+
+template<Row_processing on_exception, typename F, typename ... Types>
+std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Completion>
+Connection::execute(F&& callback, const Statement_binding& binding,
+  Types&& ... parameters)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot execute statement binding: "
+      "not ready for request"};
+  execute_binding_nio__(true, binding, std::forward<Types>(parameters)...);
+  return completion_or_throw(
+    process_responses<on_exception>(std::forward<F>(callback)));
+}
+
+template<typename ... Types>
+void Connection::execute_binding_nio__(const bool is_preparing_allowed,
+  const Statement_binding& binding, Types&& ... parameters)
+{
+  // The parameters are converted in the arena, which is cleared once sent.
+  const struct Arena_guard final {
+    Data_arena& arena;
+    ~Arena_guard() { arena.clear(); }
+  } arena_guard{execute_data_arena_};
+  const auto& statement = *binding.statement_;
+  Prepared_statement ps{execute_ps_state_, &statement, false,
+    binding.values_.data()};
+  ps.set_data_arena(&execute_data_arena_);
+  ps.bind_many(std::forward<Types>(parameters)...);
+  binding_query_.clear();
+  binding.append_query_string(binding_query_, *this);
+  // The parameters are bound first to prepare the statement of their types.
+  auto state = statement_cache_state__(binding_query_, is_preparing_allowed, ps);
+  if (state != execute_ps_state_) {
+    state->preparsed_ = true;
+    ps.state_ = std::move(state);
+    ps.execute_nio();
+  } else
+    ps.execute_nio(binding_query_);
+}
+
+template<typename ... Types>
+void Connection::invoke_nio__(const std::string_view routine,
+  const std::string_view invocation, Types&& ... arguments)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot call/invoke: not ready for request"};
+
+  auto query = routine_query__(routine, invocation, arguments...);
+  if (is_routine_cache_enabled_) {
+    const auto& entry = routine_cache_entry__(std::move(query));
+    execute_nio__(std::shared_ptr{entry.state_}, *entry.statement_,
+      std::forward<Types>(arguments)...);
+  } else {
+    const Statement statement{query};
+    execute_cached_nio__(true, statement,
+      std::forward<Types>(arguments)...);
+  }
+}
+
+template<typename F>
+void Connection::execute(F&& handler, const Statement_vector& statements,
+  const Pipeline_sync_mode sync_mode)
+{
+  if (!is_ready_for_request())
+    throw Client_exception{"cannot execute statement vector: "
+      "not ready for request"};
+
+  const auto request_threshold = pipeline_sync_request_threshold_;
+  const auto byte_threshold = pipeline_sync_byte_threshold_;
+  const auto max_depth = pipeline_max_depth_;
+  const auto restore_limits = [&]() noexcept
+  {
+    pipeline_sync_request_threshold_ = request_threshold;
+    pipeline_sync_byte_threshold_ = byte_threshold;
+    pipeline_max_depth_ = max_depth;
+  };
+  if (sync_mode == Pipeline_sync_mode::once) {
+    // No synchronization points must be established automatically.
+    constexpr auto max = std::numeric_limits<std::size_t>::max();
+    pipeline_sync_request_threshold_ = max;
+    pipeline_sync_byte_threshold_ = max;
+    pipeline_max_depth_ = max;
+  }
+
+  set_pipeline_enabled(true);
+  try {
+    const std::size_t size{statements.size()};
+    for (std::size_t i{}; i < size; ++i) {
+      const auto& statement = statements[i];
+      if (statement.is_query_empty())
+        continue;
+
+      execute_with_handler__([&handler, i](auto&& response)
+      {
+        using R = decltype(response);
+        if constexpr (std::is_invocable_v<F&, std::size_t, R>)
+          handler(i, std::forward<R>(response));
+      }, statement);
+      if (sync_mode == Pipeline_sync_mode::each &&
+        requests_.back().id_ != Request::Id::sync)
+        send_pipeline_sync();
+    }
+    complete_pipeline();
+  } catch (...) {
+    restore_limits();
+    throw;
+  }
+  restore_limits();
+  set_pipeline_enabled(false);
+}
+
+} // namespace dmitigr::pgfe
+
 #endif  // DMITIGR_PGFE_CONNECTION_HPP
@@ -0,0 +1,272 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "connection_multiplexer.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+// -----------------------------------------------------------------------------
+// Connection_multiplexer::Session
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Connection_multiplexer::Session::~Session()
+{
+  unpin();
+}
+
+DMITIGR_PGFE_INLINE Connection_multiplexer::Session&
+Connection_multiplexer::Session::operator=(Session&& rhs) noexcept
+{
+  if (this != &rhs) {
+    unpin();
+    multiplexer_ = rhs.multiplexer_;
+    pinned_ = std::move(rhs.pinned_);
+  }
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Connection_multiplexer&
+Connection_multiplexer::Session::multiplexer() const noexcept
+{
+  DMITIGR_ASSERT(multiplexer_);
+  return *multiplexer_;
+}
+
+DMITIGR_PGFE_INLINE Connection& Connection_multiplexer::Session::pin()
+{
+  if (!is_pinned()) {
+    auto handle = multiplexer().pool().connection(std::nullopt);
+    if (!handle)
+      throw Client_exception{"cannot pin session of connection multiplexer: "
+        "no connection"};
+    pinned_.emplace(std::move(handle));
+  }
+  return connection();
+}
+
+DMITIGR_PGFE_INLINE void Connection_multiplexer::Session::unpin() noexcept
+{
+  if (!pinned_)
+    return;
+
+  if (pinned_->is_valid()) {
+    auto& conn = **pinned_;
+    try {
+      if (conn.is_transaction_uncommitted())
+        conn.execute("rollback");
+    } catch (...) {
+      // The connection is closed since failed rollback indicates a mess.
+      conn.disconnect();
+    }
+  }
+  pinned_.reset();
+}
+
+DMITIGR_PGFE_INLINE bool
+Connection_multiplexer::Session::is_pinned() const noexcept
+{
+  return pinned_ && pinned_->is_valid();
+}
+
+DMITIGR_PGFE_INLINE Connection& Connection_multiplexer::Session::connection()
+{
+  if (!is_pinned())
+    throw Client_exception{"cannot get connection of session of connection "
+      "multiplexer: session is not pinned"};
+  return **pinned_;
+}
+
+// -----------------------------------------------------------------------------
+// Connection_multiplexer
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Connection_multiplexer::Connection_multiplexer(
+  Connection_pool& pool, std::size_t worker_count)
+  : pool_{pool}
+{
+  if (!worker_count)
+    worker_count = pool_.size();
+  if (!worker_count)
+    throw Client_exception{"cannot create connection multiplexer: empty pool"};
+
+  workers_.reserve(worker_count);
+  try {
+    for (std::size_t i{}; i < worker_count; ++i)
+      workers_.emplace_back([this]{work();});
+  } catch (...) {
+    stop();
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE Connection_multiplexer::~Connection_multiplexer()
+{
+  stop();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Connection_multiplexer::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection_multiplexer::worker_count() const noexcept
+{
+  return workers_.size();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_multiplexer::set_max_batch_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set max batch size of connection "
+      "multiplexer: invalid value"};
+  const std::lock_guard lg{mutex_};
+  max_batch_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection_multiplexer::max_batch_size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_batch_size_;
+}
+
+DMITIGR_PGFE_INLINE Connection_multiplexer::Session
+Connection_multiplexer::session() noexcept
+{
+  return Session{*this};
+}
+
+DMITIGR_PGFE_INLINE void Connection_multiplexer::stop()
+{
+  {
+    const std::lock_guard lg{mutex_};
+    is_stopped_ = true;
+  }
+  state_changed_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Connection_multiplexer::is_stopped() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return is_stopped_;
+}
+
+DMITIGR_PGFE_INLINE std::future<Completion>
+Connection_multiplexer::submit(Request request)
+{
+  DMITIGR_ASSERT(request);
+  std::future<Completion> result;
+  {
+    const std::lock_guard lg{mutex_};
+    if (is_stopped_)
+      throw Client_exception{"cannot submit request to connection "
+        "multiplexer: multiplexer is stopped"};
+    auto& pending = queue_.emplace_back();
+    pending.request_ = std::move(request);
+    result = pending.promise_.get_future();
+  }
+  state_changed_.notify_one();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Connection_multiplexer::work()
+{
+  std::vector<Pending> batch;
+  while (true) {
+    {
+      std::unique_lock lk{mutex_};
+      state_changed_.wait(lk, [this]{return is_stopped_ || !queue_.empty();});
+      if (queue_.empty())
+        return; // stopped
+
+      /*
+       * The requests are not delayed to fill the batch, since they are
+       * accumulated in the queue anyway while the workers are busy.
+       */
+      const auto end = queue_.begin() + static_cast<std::ptrdiff_t>(
+        std::min(queue_.size(), max_batch_size_));
+      batch.assign(std::make_move_iterator(queue_.begin()),
+        std::make_move_iterator(end));
+      queue_.erase(queue_.begin(), end);
+    }
+    execute(batch);
+    batch.clear();
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_multiplexer::execute(std::vector<Pending>& batch)
+{
+  try {
+    auto handle = pool_.connection(std::nullopt);
+    if (!handle)
+      throw Client_exception{"cannot execute requests by connection "
+        "multiplexer: no connection"};
+    auto& conn = *handle;
+    const auto sync_threshold = conn.pipeline_sync_request_threshold();
+    conn.set_pipeline_enabled(true);
+    // Isolate the requests of the different sessions from each other.
+    conn.set_pipeline_sync_request_threshold(1);
+    for (auto& pending : batch) {
+      try {
+        pending.request_(conn, pending);
+      } catch (...) {
+        pending.exception_ = std::current_exception();
+      }
+    }
+    conn.complete_pipeline();
+    conn.set_pipeline_sync_request_threshold(sync_threshold);
+    conn.set_pipeline_enabled(false);
+    // Don't leak the transaction begun by mistake to the other sessions.
+    if (conn.is_transaction_uncommitted())
+      conn.execute("rollback");
+  } catch (...) {
+    // The connection is closed by the pool if the pipeline is incomplete.
+    const auto e = std::current_exception();
+    for (auto& pending : batch) {
+      if (!pending.exception_ && !pending.error_ && !pending.completion_)
+        pending.exception_ = e;
+    }
+  }
+
+  for (auto& pending : batch) {
+    if (pending.exception_)
+      pending.promise_.set_exception(pending.exception_);
+    else if (pending.error_)
+      pending.promise_.set_exception(std::make_exception_ptr(Server_exception{
+        std::make_shared<Error>(std::move(pending.error_))}));
+    else if (!pending.completion_)
+      pending.promise_.set_exception(std::make_exception_ptr(Client_exception{
+        "cannot execute request by connection multiplexer: aborted"}));
+    else
+      pending.promise_.set_value(std::move(pending.completion_));
+  }
+}
+
+} // namespace dmitigr::pgfe
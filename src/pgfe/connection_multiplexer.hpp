@@ -0,0 +1,302 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_CONNECTION_MULTIPLEXER_HPP
+#define DMITIGR_PGFE_CONNECTION_MULTIPLEXER_HPP
+
+#include "completion.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "dll.hpp"
+#include "error.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A multiplexer of many logical sessions over a few connections.
+ *
+ * @details Each worker runs in its own thread, takes up to max_batch_size()
+ * of requests submitted by the sessions, acquires a connection from the pool
+ * and queues all the requests in the pipeline with the synchronization point
+ * after each request, so the whole batch costs one round trip, while the
+ * error of one request doesn't affects the others. Thus, the number of the
+ * server backends is bounded by the size of the pool rather than by the
+ * number of sessions.
+ *
+ * Since the consecutive requests of a session can be executed on different
+ * connections, the session must be pinned to a connection for the duration
+ * of an explicit transaction (or for any other use of the session state):
+ * @code
+ * auto session = multiplexer.session();
+ * session.execute("select 1"); // multiplexed
+ * {
+ *   Transaction_guard tg{session.pin()};
+ *   session.execute("insert into t values (1)"); // executed on the pinned
+ *   tg.commit();
+ * }
+ * session.unpin();
+ * @endcode
+ *
+ * @remarks The pinned connections are acquired from the same pool, so the
+ * size of the pool must be greater than the number of workers.
+ *
+ * @see Connection_pool, Transaction_guard.
+ */
+class Connection_multiplexer final {
+private:
+  struct Pending;
+
+public:
+  /// The default maximum number of requests sent at once.
+  static constexpr std::size_t default_max_batch_size{256};
+
+  /// A logical session.
+  class Session final {
+  public:
+    /// Calls unpin().
+    DMITIGR_PGFE_API ~Session();
+
+    /// Not copy-constructible.
+    Session(const Session&) = delete;
+
+    /// Not copy-assignable.
+    Session& operator=(const Session&) = delete;
+
+    /// Move-constructible.
+    Session(Session&&) = default;
+
+    /// Move-assignable.
+    DMITIGR_PGFE_API Session& operator=(Session&& rhs) noexcept;
+
+    /// @returns The multiplexer.
+    DMITIGR_PGFE_API Connection_multiplexer& multiplexer() const noexcept;
+
+    /**
+     * @brief Pins the session to a connection acquired from the pool, if the
+     * session is not pinned yet.
+     *
+     * @returns The pinned connection.
+     *
+     * @throws Client_exception if there is no free connection in the pool
+     * within `Connection_pool::connection()` timeout.
+     *
+     * @par Effects
+     * `is_pinned()`.
+     */
+    DMITIGR_PGFE_API Connection& pin();
+
+    /**
+     * @brief Returns the pinned connection to the pool.
+     *
+     * @details The uncommitted transaction is rolled back at first.
+     *
+     * @par Effects
+     * `!is_pinned()`.
+     */
+    DMITIGR_PGFE_API void unpin() noexcept;
+
+    /// @returns `true` if the session is pinned to a connection.
+    DMITIGR_PGFE_API bool is_pinned() const noexcept;
+
+    /**
+     * @returns The pinned connection.
+     *
+     * @par Requires
+     * `is_pinned()`.
+     */
+    DMITIGR_PGFE_API Connection& connection();
+
+    /**
+     * @brief Executes the statement on the pinned connection if `is_pinned()`,
+     * or submits it to the multiplexer and waits for the completion otherwise.
+     *
+     * @param callback A function which is called with each row. If the
+     * statement is multiplexed it's called from the thread of a worker.
+     * @param statement A *preparsed* statement to execute. It must not begin
+     * a transaction if the session is not pinned.
+     * @param parameters Parameters to bind with a parameterized statement.
+     *
+     * @returns The Completion.
+     *
+     * @throws Server_exception on the error response, or Client_exception if
+     * the multiplexer is stopped.
+     */
+    template<typename F, typename ... Types>
+    std::enable_if_t<std::is_invocable_v<F&, Row&&>, Completion>
+    execute(F&& callback, const Statement& statement, Types&& ... parameters)
+    {
+      if (is_pinned())
+        return connection().execute([&callback](Row&& row)
+        {
+          callback(std::move(row));
+        }, statement, std::forward<Types>(parameters)...);
+
+      return multiplexer().submit([&callback, &statement,
+          &parameters...](Connection& conn, Pending& request)
+      {
+        conn.execute_pipelined([&callback, &request](auto&& response)
+        {
+          using R = std::decay_t<decltype(response)>;
+          if constexpr (std::is_same_v<R, Row>) {
+            if (!request.exception_) {
+              try {
+                callback(std::move(response));
+              } catch (...) {
+                request.exception_ = std::current_exception();
+              }
+            }
+          } else if constexpr (std::is_same_v<R, Completion>)
+            request.completion_ = std::move(response);
+          else
+            request.error_ = std::move(response);
+        }, statement, parameters...);
+      }).get();
+    }
+
+    /// @overload
+    template<typename ... Types>
+    Completion execute(const Statement& statement, Types&& ... parameters)
+    {
+      return execute([](Row&&){}, statement, std::forward<Types>(parameters)...);
+    }
+
+  private:
+    friend Connection_multiplexer;
+
+    Connection_multiplexer* multiplexer_{};
+    std::optional<Connection_pool::Handle> pinned_;
+
+    explicit Session(Connection_multiplexer& multiplexer) noexcept
+      : multiplexer_{&multiplexer}
+    {}
+  };
+
+  /**
+   * @brief The constructor. Starts the workers.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the multiplexer.
+   * @param worker_count The number of workers, i.e. the number of connections
+   * shared by the unpinned sessions. Zero means `pool.size()`.
+   *
+   * @par Requires
+   * `worker_count || pool.size()`.
+   */
+  DMITIGR_PGFE_API explicit Connection_multiplexer(Connection_pool& pool,
+    std::size_t worker_count = 0);
+
+  /// Calls stop().
+  DMITIGR_PGFE_API ~Connection_multiplexer();
+
+  /// Not copy-constructible.
+  Connection_multiplexer(const Connection_multiplexer&) = delete;
+
+  /// Not copy-assignable.
+  Connection_multiplexer& operator=(const Connection_multiplexer&) = delete;
+
+  /// Not move-constructible.
+  Connection_multiplexer(Connection_multiplexer&&) = delete;
+
+  /// Not move-assignable.
+  Connection_multiplexer& operator=(Connection_multiplexer&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of requests sent at once.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_max_batch_size(std::size_t value);
+
+  /// @returns The maximum number of requests sent at once.
+  DMITIGR_PGFE_API std::size_t max_batch_size() const noexcept;
+
+  /**
+   * @returns The new session.
+   *
+   * @par Thread safety
+   * Thread-safe. (The instances of Session are not thread-safe.)
+   */
+  DMITIGR_PGFE_API Session session() noexcept;
+
+  /**
+   * @brief Stops accepting the requests, waits for the submitted requests
+   * to be executed and stops the workers.
+   *
+   * @par Effects
+   * `is_stopped()`.
+   */
+  DMITIGR_PGFE_API void stop();
+
+  /// @returns `true` if the multiplexer is stopped.
+  DMITIGR_PGFE_API bool is_stopped() const noexcept;
+
+private:
+  /// A function which queues the request in the pipeline.
+  using Request = std::function<void(Connection&, Pending&)>;
+
+  struct Pending final {
+    Request request_;
+    std::promise<Completion> promise_;
+    Completion completion_;
+    Error error_;
+    std::exception_ptr exception_; // thrown by request_ or by the callback
+  };
+
+  Connection_pool& pool_;
+  mutable std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::deque<Pending> queue_;
+  std::vector<std::thread> workers_;
+  std::size_t max_batch_size_{default_max_batch_size};
+  bool is_stopped_{};
+
+  DMITIGR_PGFE_API std::future<Completion> submit(Request request);
+  void work();
+  void execute(std::vector<Pending>& batch);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "connection_multiplexer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_CONNECTION_MULTIPLEXER_HPP
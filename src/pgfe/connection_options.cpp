@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <stdexcept>
 
 namespace dmitigr::pgfe {
@@ -55,6 +56,15 @@ inline bool is_hostname(const std::string& value)
   return net::is_hostname_valid(value);
 }
 
+inline bool is_parameter_name(const std::string& value) noexcept
+{
+  return !value.empty() && std::all_of(value.cbegin(), value.cend(),
+    [](const unsigned char c)
+    {
+      return std::isalnum(c) || c == '_' || c == '.';
+    });
+}
+
 inline bool is_absolute_directory_name(const std::filesystem::path& value)
 {
   return value.is_absolute();
@@ -75,8 +85,10 @@ Connection_options::swap(Connection_options& rhs) noexcept
   using std::swap;
   swap(communication_mode_, rhs.communication_mode_);
   swap(session_mode_, rhs.session_mode_);
+  swap(replication_mode_, rhs.replication_mode_);
   swap(connect_timeout_, rhs.connect_timeout_);
   swap(wait_response_timeout_, rhs.wait_response_timeout_);
+  swap(wait_response_spin_duration_, rhs.wait_response_spin_duration_);
   swap(uds_directory_, rhs.uds_directory_);
   swap(uds_require_server_process_username_,
     rhs.uds_require_server_process_username_);
@@ -85,9 +97,14 @@ Connection_options::swap(Connection_options& rhs) noexcept
   swap(tcp_keepalives_interval_, rhs.tcp_keepalives_interval_);
   swap(tcp_keepalives_count_, rhs.tcp_keepalives_count_);
   swap(tcp_user_timeout_, rhs.tcp_user_timeout_);
+  swap(tcp_no_delay_, rhs.tcp_no_delay_);
+  swap(socket_send_buffer_size_, rhs.socket_send_buffer_size_);
+  swap(socket_receive_buffer_size_, rhs.socket_receive_buffer_size_);
+  swap(socket_busy_poll_, rhs.socket_busy_poll_);
   swap(address_, rhs.address_);
   swap(hostname_, rhs.hostname_);
   swap(port_, rhs.port_);
+  swap(startup_parameters_, rhs.startup_parameters_);
   swap(username_, rhs.username_);
   swap(database_, rhs.database_);
   swap(password_, rhs.password_);
@@ -149,6 +166,26 @@ Connection_options::session_mode() const noexcept
   return session_mode_;
 }
 
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_replication_mode(
+  const std::optional<Replication_mode> value)
+{
+  replication_mode_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set(const std::optional<Replication_mode> value)
+{
+  return set_replication_mode(value);
+}
+
+DMITIGR_PGFE_INLINE std::optional<Replication_mode>
+Connection_options::replication_mode() const noexcept
+{
+  return replication_mode_;
+}
+
 DMITIGR_PGFE_INLINE Connection_options&
 Connection_options::set_connect_timeout(
   const std::optional<std::chrono::milliseconds> value)
@@ -181,6 +218,22 @@ Connection_options::wait_response_timeout() const noexcept
   return wait_response_timeout_;
 }
 
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_wait_response_spin_duration(
+  const std::optional<std::chrono::microseconds> value)
+{
+  if (value)
+    validate(is_non_negative(value->count()), "response spin duration");
+  wait_response_spin_duration_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::microseconds>
+Connection_options::wait_response_spin_duration() const noexcept
+{
+  return wait_response_spin_duration_;
+}
+
 DMITIGR_PGFE_INLINE Connection_options&
 Connection_options::set_port(const std::optional<std::int_fast32_t> value)
 {
@@ -196,6 +249,25 @@ Connection_options::port() const noexcept
   return port_;
 }
 
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_startup_parameter(std::string name,
+  std::optional<std::string> value)
+{
+  validate(is_parameter_name(name), "Startup parameter name");
+  if (value)
+    startup_parameters_.insert_or_assign(std::move(name), std::move(*value));
+  else if (const auto i = startup_parameters_.find(name);
+    i != startup_parameters_.end())
+    startup_parameters_.erase(i);
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE const std::map<std::string, std::string, std::less<>>&
+Connection_options::startup_parameters() const noexcept
+{
+  return startup_parameters_;
+}
+
 DMITIGR_PGFE_INLINE Connection_options&
 Connection_options::set_uds_directory(std::optional<std::filesystem::path> value)
 {
@@ -303,6 +375,66 @@ Connection_options::tcp_user_timeout() const noexcept
   return tcp_user_timeout_;
 }
 
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_tcp_no_delay(const std::optional<bool> value)
+{
+  tcp_no_delay_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE std::optional<bool>
+Connection_options::tcp_no_delay() const noexcept
+{
+  return tcp_no_delay_;
+}
+
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_socket_send_buffer_size(const std::optional<int> value)
+{
+  if (value)
+    validate(*value > 0, "Socket send buffer size");
+  socket_send_buffer_size_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE std::optional<int>
+Connection_options::socket_send_buffer_size() const noexcept
+{
+  return socket_send_buffer_size_;
+}
+
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_socket_receive_buffer_size(
+  const std::optional<int> value)
+{
+  if (value)
+    validate(*value > 0, "Socket receive buffer size");
+  socket_receive_buffer_size_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE std::optional<int>
+Connection_options::socket_receive_buffer_size() const noexcept
+{
+  return socket_receive_buffer_size_;
+}
+
+DMITIGR_PGFE_INLINE Connection_options&
+Connection_options::set_socket_busy_poll(
+  const std::optional<std::chrono::microseconds> value)
+{
+  if (value)
+    validate(is_non_negative(value->count()), "Socket busy poll");
+  socket_busy_poll_ = value;
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::microseconds>
+Connection_options::socket_busy_poll() const noexcept
+{
+  return socket_busy_poll_;
+}
+
 DMITIGR_PGFE_INLINE Connection_options&
 Connection_options::set_address(std::optional<std::string> value)
 {
@@ -609,6 +741,7 @@ operator==(const Connection_options& lhs, const Connection_options& rhs) noexcep
   return
     // booleans
     lhs.tcp_keepalives_enabled_ == rhs.tcp_keepalives_enabled_ &&
+    lhs.tcp_no_delay_ == rhs.tcp_no_delay_ &&
     lhs.is_ssl_enabled_ == rhs.is_ssl_enabled_ &&
     lhs.ssl_compression_enabled_ == rhs.ssl_compression_enabled_ &&
     lhs.ssl_server_hostname_verification_enabled_ ==
@@ -618,13 +751,18 @@ operator==(const Connection_options& lhs, const Connection_options& rhs) noexcep
     // numerics
     lhs.communication_mode_ == rhs.communication_mode_ &&
     lhs.session_mode_ == rhs.session_mode_ &&
+    lhs.replication_mode_ == rhs.replication_mode_ &&
     lhs.channel_binding_ == rhs.channel_binding_ &&
     lhs.connect_timeout_ == rhs.connect_timeout_ &&
     lhs.wait_response_timeout_ == rhs.wait_response_timeout_ &&
+    lhs.wait_response_spin_duration_ == rhs.wait_response_spin_duration_ &&
     lhs.tcp_keepalives_idle_ == rhs.tcp_keepalives_idle_ &&
     lhs.tcp_keepalives_interval_ == rhs.tcp_keepalives_interval_ &&
     lhs.tcp_keepalives_count_ == rhs.tcp_keepalives_count_ &&
     lhs.tcp_user_timeout_ == rhs.tcp_user_timeout_ &&
+    lhs.socket_send_buffer_size_ == rhs.socket_send_buffer_size_ &&
+    lhs.socket_receive_buffer_size_ == rhs.socket_receive_buffer_size_ &&
+    lhs.socket_busy_poll_ == rhs.socket_busy_poll_ &&
     lhs.port_ == rhs.port_ &&
     lhs.ssl_min_protocol_version_ == rhs.ssl_min_protocol_version_ &&
     lhs.ssl_max_protocol_version_ == rhs.ssl_max_protocol_version_ &&
@@ -645,7 +783,9 @@ operator==(const Connection_options& lhs, const Connection_options& rhs) noexcep
     lhs.ssl_certificate_authority_file_ ==
     rhs.ssl_certificate_authority_file_ &&
     lhs.ssl_certificate_revocation_list_file_ ==
-    rhs.ssl_certificate_revocation_list_file_;
+    rhs.ssl_certificate_revocation_list_file_ &&
+    // containers
+    lhs.startup_parameters_ == rhs.startup_parameters_;
 }
 
 // =============================================================================
@@ -700,6 +840,9 @@ public:
     else
       values_[target_session_attrs] = to_literal(Session_mode::any);
 
+    if (const auto v = o.replication_mode())
+      values_[replication] = to_literal(*v);
+
     if (const auto& v = o.database())
       values_[dbname] = *v;
     if (const auto& v = o.username())
@@ -760,7 +903,7 @@ public:
     values_[gsslib] = "";
     values_[connect_timeout] = "";
     values_[client_encoding] = "auto";
-    values_[options] = "";
+    values_[options] = to_command_line_options(o.startup_parameters());
     values_[application_name] = "";
     values_[fallback_application_name] = "";
     values_[service] = "";
@@ -859,7 +1002,7 @@ private:
     sslmode, sslcompression, sslcert, sslkey, sslpassword, sslrootcert, sslcrl,
     sslsni, requirepeer, ssl_min_protocol_version, ssl_max_protocol_version,
 
-    target_session_attrs,
+    target_session_attrs, replication,
 
     // Options that are unavailable from Pgfe API (at least for now):
     gsslib, connect_timeout, client_encoding, options, application_name,
@@ -906,11 +1049,35 @@ private:
     case gsslib: return "gsslib";
     case service: return "service";
     case target_session_attrs: return "target_session_attrs";
+    case replication: return "replication";
     case Keyword_count_:;
     }
     DMITIGR_ASSERT(false);
   }
 
+  /**
+   * @returns The value of the `options` keyword for libpq.
+   *
+   * @details libpq splits the value by whitespaces, and a backslash escapes
+   * the next character.
+   */
+  static std::string to_command_line_options(
+    const std::map<std::string, std::string, std::less<>>& parameters)
+  {
+    std::string result;
+    for (const auto& [name, value] : parameters) {
+      if (!result.empty())
+        result += ' ';
+      result.append("-c ").append(name) += '=';
+      for (const char c : value) {
+        if (c == '\\' || std::isspace(static_cast<unsigned char>(c)))
+          result += '\\';
+        result += c;
+      }
+    }
+    return result;
+  }
+
   /// @returns The value literal for libpq.
   static const char* to_literal(const Channel_binding value) noexcept
   {
@@ -936,6 +1103,17 @@ private:
     DMITIGR_ASSERT(false);
   }
 
+  /// @returns The value literal for libpq.
+  static const char* to_literal(const Replication_mode value) noexcept
+  {
+    using Rm = Replication_mode;
+    switch (value) {
+    case Rm::physical: return "true";
+    case Rm::logical: return "database";
+    }
+    DMITIGR_ASSERT(false);
+  }
+
   /// @returns The value literal for libpq.
   static const char* to_literal(const Session_mode value) noexcept
   {
@@ -987,4 +1165,21 @@ private:
 };
 
 } // namespace detail::pq
+
+// =============================================================================
+
+DMITIGR_PGFE_INLINE
+Compiled_connection_options::Compiled_connection_options(
+  Connection_options options)
+  : options_{std::move(options)}
+  , pq_options_{std::make_shared<const detail::pq::Connection_options>(
+      options_)}
+{}
+
+DMITIGR_PGFE_INLINE const Connection_options&
+Compiled_connection_options::options() const noexcept
+{
+  return options_;
+}
+
 } // namespace dmitigr::pgfe
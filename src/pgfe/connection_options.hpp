@@ -20,9 +20,13 @@
 #include "../fsx/filesystem.hpp"
 #include "basics.hpp"
 #include "dll.hpp"
+#include "types_fwd.hpp"
 
 #include <cstdint>
 #include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -84,6 +88,29 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  /**
+   * @brief Sets the replication mode.
+   *
+   * @details If set, the connection is a replication connection and accepts
+   * the commands of the streaming replication protocol (such as
+   * `START_REPLICATION`) instead of the SQL commands. `std::nullopt` means
+   * the normal connection.
+   *
+   * @see Replication_stream.
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_replication_mode(std::optional<Replication_mode> value);
+
+  /// Shortcut of set_replication_mode().
+  DMITIGR_PGFE_API Connection_options&
+  set(const std::optional<Replication_mode> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<Replication_mode>
+  replication_mode() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
   /**
    * @brief Sets the timeout of the connect operation.
    *
@@ -130,6 +157,40 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  /**
+   * @brief Sets the duration of busy polling of the socket before blocking
+   * while waiting for response.
+   *
+   * @details If set, Connection::wait_response() polls the socket by calling
+   * `PQconsumeInput()` in a loop without blocking for up to `*value`, and only
+   * then falls back to waiting for the socket readiness. This saves the cost
+   * of the wakeup by the kernel when the response is expected soon (for
+   * example, when the server is co-located), at the cost of burning a core.
+   *
+   * @param value A value of spin duration. `std::nullopt` means no spinning.
+   *
+   * @par Requires
+   * `!value || (value->count() >= 0)`.
+   *
+   * @remarks The spin duration is not counted against the timeout of waiting
+   * for response.
+   *
+   * @see Connection::wait_response(), set_socket_busy_poll().
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_wait_response_spin_duration(
+    std::optional<std::chrono::microseconds> value);
+
+  /**
+   * @returns The current value of the option.
+   *
+   * @see Connection::wait_response().
+   */
+  DMITIGR_PGFE_API std::optional<std::chrono::microseconds>
+  wait_response_spin_duration() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
   /**
    * @brief Sets the server port number.
    *
@@ -154,6 +215,47 @@ public:
   DMITIGR_PGFE_API std::optional<std::int_fast32_t>
   port() const noexcept;
 
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Sets the run-time parameter of the server to be set at connection
+   * start.
+   *
+   * @details The startup parameters are passed to the server as the command
+   * line options (`-c name=value`) in the startup packet, so the session is
+   * configured without extra round trips after the connection establishment,
+   * for example:
+   * @code
+   * opts.set_startup_parameter("search_path", "app, public")
+   *   .set_startup_parameter("statement_timeout", "5s")
+   *   .set_startup_parameter("application_name", "billing");
+   * @endcode
+   *
+   * @param name The name of the parameter.
+   * @param value The value of the parameter. `std::nullopt` means removing
+   * the parameter.
+   *
+   * @par Requires
+   * `!name.empty()`, and `name` must consist of ASCII letters, digits,
+   * underscores and dots only.
+   *
+   * @remarks The errors in the startup parameters (for example, an unknown
+   * parameter or an invalid value) are reported by the server as the errors
+   * of the connection establishment.
+   *
+   * @see startup_parameters().
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_startup_parameter(std::string name, std::optional<std::string> value);
+
+  /**
+   * @returns The startup parameters.
+   *
+   * @see set_startup_parameter().
+   */
+  DMITIGR_PGFE_API const std::map<std::string, std::string, std::less<>>&
+  startup_parameters() const noexcept;
+
   /// @}
 
   // --------------------------------------------------------------------------
@@ -279,6 +381,81 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  /**
+   * @brief Sets the `TCP_NODELAY` option of the socket (i.e. disables the
+   * Nagle algorithm if `*value`).
+   *
+   * @remarks The option is applied by pgfe to the socket just after the
+   * connection establishment.
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_tcp_no_delay(std::optional<bool> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<bool> tcp_no_delay() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Sets the size of the send buffer of the socket (`SO_SNDBUF`).
+   *
+   * @par Requires
+   * `!value || (*value > 0)`.
+   *
+   * @remarks The option is applied by pgfe to the socket just after the
+   * connection establishment.
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_socket_send_buffer_size(std::optional<int> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<int>
+  socket_send_buffer_size() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Sets the size of the receive buffer of the socket (`SO_RCVBUF`).
+   *
+   * @par Requires
+   * `!value || (*value > 0)`.
+   *
+   * @remarks The option is applied by pgfe to the socket just after the
+   * connection establishment. Thus, the TCP window scale negotiated upon
+   * the connection establishment is not affected.
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_socket_receive_buffer_size(std::optional<int> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<int>
+  socket_receive_buffer_size() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
+  /**
+   * @brief Sets the approximate time to busy poll the device queue of the
+   * network interface on blocking receive (`SO_BUSY_POLL`).
+   *
+   * @par Requires
+   * `!value || (value->count() >= 0)`.
+   *
+   * @remarks The option is applied by pgfe to the socket just after the
+   * connection establishment. The option is supported on Linux only, and is
+   * ignored on other systems. Increasing the value above the system wide
+   * `net.core.busy_read` requires the `CAP_NET_ADMIN` capability.
+   *
+   * @see set_wait_response_spin_duration().
+   */
+  DMITIGR_PGFE_API Connection_options&
+  set_socket_busy_poll(std::optional<std::chrono::microseconds> value);
+
+  /// @returns The current value of the option.
+  DMITIGR_PGFE_API std::optional<std::chrono::microseconds>
+  socket_busy_poll() const noexcept;
+
+  // ---------------------------------------------------------------------------
+
   /**
    * @brief Sets the numeric IP address of a PostgreSQL server
    * to avoid hostname lookup.
@@ -446,6 +623,12 @@ public:
    * @param value `std::nullopt` or `false` means *disabled*.
    *
    * @remarks SSL mode is disabled by default.
+   *
+   * @remarks Each connection (and reconnection) performs a full TLS handshake,
+   * since TLS sessions cannot be resumed: libpq provides no hook to set the
+   * session before the handshake, and the PostgreSQL server disables both the
+   * session cache and the session tickets. To amortize the cost of handshakes
+   * the connections should be reused (see Connection_pool).
    */
   DMITIGR_PGFE_API Connection_options&
   set_ssl_enabled(std::optional<bool> value);
@@ -622,8 +805,10 @@ private:
 
   std::optional<Communication_mode> communication_mode_;
   std::optional<Session_mode> session_mode_;
+  std::optional<Replication_mode> replication_mode_;
   std::optional<std::chrono::milliseconds> connect_timeout_;
   std::optional<std::chrono::milliseconds> wait_response_timeout_;
+  std::optional<std::chrono::microseconds> wait_response_spin_duration_;
   std::optional<std::filesystem::path> uds_directory_;
   std::optional<std::string> uds_require_server_process_username_;
   std::optional<bool> tcp_keepalives_enabled_;
@@ -631,9 +816,14 @@ private:
   std::optional<std::chrono::seconds> tcp_keepalives_interval_;
   std::optional<int> tcp_keepalives_count_;
   std::optional<std::chrono::milliseconds> tcp_user_timeout_;
+  std::optional<bool> tcp_no_delay_;
+  std::optional<int> socket_send_buffer_size_;
+  std::optional<int> socket_receive_buffer_size_;
+  std::optional<std::chrono::microseconds> socket_busy_poll_;
   std::optional<std::string> address_;
   std::optional<std::string> hostname_;
   std::optional<std::int_fast32_t> port_{5432};
+  std::map<std::string, std::string, std::less<>> startup_parameters_;
   std::optional<std::string> username_;
   std::optional<std::string> database_;
   std::optional<std::string> password_;
@@ -682,6 +872,45 @@ inline bool operator!=(const Connection_options& lhs,
   return !(lhs == rhs);
 }
 
+/**
+ * @ingroup main
+ *
+ * @brief An immutable Connection_options compiled into the keyword/value
+ * arrays of libpq.
+ *
+ * @details Since the instance is immutable, it can be shared by many
+ * connections (see Connection::set_options()), so the options are compiled
+ * only once rather than upon of each (re)connect. For example:
+ * @code
+ * const auto compiled =
+ *   std::make_shared<const pgfe::Compiled_connection_options>(options);
+ * pgfe::Connection conn1{compiled};
+ * pgfe::Connection conn2{compiled};
+ * @endcode
+ *
+ * @see Connection_pool::set_options().
+ */
+class Compiled_connection_options final {
+public:
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `options.communication_mode()`.
+   */
+  DMITIGR_PGFE_API explicit Compiled_connection_options(
+    Connection_options options);
+
+  /// @returns The compiled options.
+  DMITIGR_PGFE_API const Connection_options& options() const noexcept;
+
+private:
+  friend Connection;
+
+  Connection_options options_;
+  std::shared_ptr<const detail::pq::Connection_options> pq_options_;
+};
+
 } // namespace dmitigr::pgfe
 
 #ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
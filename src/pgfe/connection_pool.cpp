@@ -16,9 +16,13 @@
 
 #include "../base/assert.hpp"
 #include "connection_pool.hpp"
+#include "poll_reactor.hpp"
+#include "prepared_statement_registry.hpp"
+#include "type_catalog.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 
 namespace dmitigr::pgfe {
@@ -86,7 +90,6 @@ DMITIGR_PGFE_INLINE Connection_pool::Handle::Handle(
   , connection_{std::move(connection)}
   , state_index_{state_index}
 {
-  // Attention! pool_->mutex_ is locked here!
   DMITIGR_ASSERT(pool_ && *pool_);
   DMITIGR_ASSERT(connection_);
   DMITIGR_ASSERT(state_index_ < (*pool_)->states_.size());
@@ -98,6 +101,7 @@ DMITIGR_PGFE_INLINE Connection_pool::Handle::Handle(
 
 DMITIGR_PGFE_INLINE Connection_pool::~Connection_pool() noexcept
 {
+  stop_maintenance();
   for (auto& state : states_) {
     DMITIGR_ASSERT(state.second);
     *state.second = nullptr;
@@ -106,15 +110,26 @@ DMITIGR_PGFE_INLINE Connection_pool::~Connection_pool() noexcept
 
 DMITIGR_PGFE_INLINE Connection_pool::Connection_pool(std::size_t count,
   const Connection_options& options)
-  : release_handler_{[](Connection& conn)
-  {
-    conn.process_responses([](auto&&){});
-    conn.execute("DISCARD ALL");
-  }}
+  : min_size_{count}
+  , type_catalog_{std::make_shared<Type_catalog>()}
+  , prepared_statement_registry_{std::make_shared<Prepared_statement_registry>()}
 {
+  if (options.communication_mode())
+    options_ = std::make_shared<const Compiled_connection_options>(options);
+
   const auto self = std::make_shared<Connection_pool*>(this);
-  for (; count > 0; --count)
-    states_.emplace_back(std::make_unique<Connection>(options), self);
+  states_.reserve(count);
+  free_indices_.reserve(count);
+  idle_infos_.resize(count);
+  for (std::size_t i{}; i < count; ++i) {
+    states_.emplace_back(options_ ? std::make_unique<Connection>(options_) :
+      std::make_unique<Connection>(options), self);
+    states_.back().first->set_type_catalog(type_catalog_);
+    states_.back().first->set_prepared_statement_registry(
+      prepared_statement_registry_);
+    // The connection with the lowest index is acquired first.
+    free_indices_.push_back(count - i - 1);
+  }
 }
 
 DMITIGR_PGFE_INLINE bool Connection_pool::is_valid() const noexcept
@@ -122,6 +137,26 @@ DMITIGR_PGFE_INLINE bool Connection_pool::is_valid() const noexcept
   return !states_.empty();
 }
 
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_options(const Connection_options& options)
+{
+  if (!options.communication_mode())
+    throw Client_exception{"cannot set options of connection pool: "
+      "communication mode is not specified"};
+
+  // Compile outside the lock.
+  auto compiled = std::make_shared<const Compiled_connection_options>(options);
+  const std::lock_guard lg{mutex_};
+  options_ = std::move(compiled);
+}
+
+DMITIGR_PGFE_INLINE std::shared_ptr<const Compiled_connection_options>
+Connection_pool::options() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return options_;
+}
+
 DMITIGR_PGFE_INLINE void
 Connection_pool::set_connect_handler(std::function<void(Connection&)> handler)
 {
@@ -148,21 +183,46 @@ Connection_pool::release_handler() const noexcept
   return release_handler_;
 }
 
-DMITIGR_PGFE_INLINE void Connection_pool::connect()
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_reset_policy(const Reset_policy policy) noexcept
 {
   const std::lock_guard lg{mutex_};
+  reset_policy_ = policy;
+}
+
+DMITIGR_PGFE_INLINE auto
+Connection_pool::reset_policy() const noexcept -> Reset_policy
+{
+  const std::lock_guard lg{mutex_};
+  return reset_policy_;
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::connect()
+{
+  std::unique_lock lk{mutex_};
 
   if (is_connected_)
     return;
 
-  for (const auto& state : states_) {
-    auto& conn = state.first;
-    conn->connect();
-    if (connect_handler_)
-      connect_handler_(*conn);
+  // Open the free connections which will be acquired first.
+  std::vector<Connection*> connections;
+  for (auto i = free_indices_.crbegin(); i != free_indices_.crend() &&
+         connections.size() < std::min(min_size_, states_.size()); ++i)
+    connections.push_back(states_[*i].first.get());
+  if (options_) {
+    for (auto* const conn : connections)
+      conn->set_options(options_);
   }
+  std::vector<std::pair<Metric, std::chrono::nanoseconds>> samples;
+  connect(connections, samples);
+  if (connect_handler_)
+    for (auto* const conn : connections)
+      connect_handler_(*conn);
 
   is_connected_ = is_valid();
+  lk.unlock();
+  for (const auto& [metric, value] : samples)
+    record(metric, value);
 }
 
 DMITIGR_PGFE_INLINE void Connection_pool::disconnect() noexcept
@@ -178,6 +238,260 @@ DMITIGR_PGFE_INLINE void Connection_pool::disconnect() noexcept
   }
 
   is_connected_ = false;
+  release_condition_.notify_all();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_min_size(const std::size_t value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  min_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection_pool::min_size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return min_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_warm_spare_count(const std::size_t value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  warm_spare_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection_pool::warm_spare_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return warm_spare_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection_pool::predicted_demand() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return static_cast<std::size_t>(std::ceil(demand_));
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::set_maintenance_interval(
+  const std::optional<std::chrono::milliseconds> value)
+{
+  if (value && value->count() <= 0)
+    throw Client_exception{"cannot set connection pool maintenance interval: "
+      "invalid interval specified"};
+
+  stop_maintenance();
+  const std::lock_guard lg{mutex_};
+  maintenance_interval_ = value;
+  if (!maintenance_interval_)
+    return;
+
+  is_maintenance_stopping_ = false;
+  maintenance_thread_ = std::thread{[this]
+  {
+    std::unique_lock lk{mutex_};
+    while (!is_maintenance_stopping_) {
+      const auto is_stopping = [this]{return is_maintenance_stopping_;};
+      if (maintenance_condition_.wait_for(lk, *maintenance_interval_,
+          is_stopping))
+        break;
+
+      lk.unlock();
+      try {
+        maintain();
+      } catch (const std::exception& e) {
+        std::clog << "connection pool's maintenance: error:" << e.what() << '\n';
+      } catch (...) {
+        std::clog << "connection pool's maintenance: unknown error\n";
+      }
+      lk.lock();
+    }
+  }};
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Connection_pool::maintenance_interval() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return maintenance_interval_;
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::set_max_idle_time(
+  const std::optional<std::chrono::milliseconds> value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  max_idle_time_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Connection_pool::max_idle_time() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_idle_time_;
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::set_max_lifetime(
+  const std::optional<std::chrono::milliseconds> value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  max_lifetime_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Connection_pool::max_lifetime() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_lifetime_;
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::maintain()
+{
+  using std::chrono::steady_clock;
+  using std::chrono::system_clock;
+
+  std::unique_lock lk{mutex_};
+  if (!is_connected_)
+    return;
+
+  const auto candidates = free_indices_;
+  const auto check_interval = maintenance_interval_;
+  const auto max_idle_time = max_idle_time_;
+  const auto max_lifetime = max_lifetime_;
+  const auto options = options_;
+  const auto min_size = warm_size();
+  const auto connect_handler = connect_handler_;
+  // The busy connections are considered as opened.
+  auto open_count = states_.size() - free_indices_.size();
+  for (const auto index : free_indices_)
+    if (states_[index].first->is_connected())
+      ++open_count;
+  lk.unlock();
+
+  // Start from the top of stack, i.e. from the next connection to acquire.
+  for (auto i = candidates.crbegin(); i != candidates.crend(); ++i) {
+    const auto index = *i;
+
+    // Take the connection out of the pool.
+    lk.lock();
+    const auto fi = find(begin(free_indices_), end(free_indices_), index);
+    if (!is_connected_ || fi == end(free_indices_)) {
+      lk.unlock();
+      continue; // acquired meanwhile
+    }
+    free_indices_.erase(fi);
+    const auto idle_info = idle_infos_[index];
+    auto& state = states_[index];
+    Handle handle{state.second, std::move(state.first), index};
+    lk.unlock();
+
+    auto& conn = *handle.connection_;
+    const auto now = steady_clock::now();
+    bool is_checked{};
+    try {
+      // The response on the deferred reset must be read before the check.
+      if (conn.is_connected() && !complete_reset(conn))
+        --open_count;
+
+      if (conn.is_connected()) {
+        const auto start_time = conn.session_start_time();
+        const bool is_expired =
+          (max_lifetime && start_time &&
+            system_clock::now() - *start_time >= *max_lifetime) ||
+          (max_idle_time && open_count > min_size &&
+            now - idle_info.released_ >= *max_idle_time);
+        if (is_expired) {
+          conn.disconnect();
+          --open_count;
+        } else if (check_interval && now -
+          std::max(idle_info.released_, idle_info.checked_) >= *check_interval) {
+          is_checked = true;
+          try {
+            conn.execute("");
+          } catch (...) {}
+          if (!conn.is_ready_for_request()) {
+            conn.disconnect();
+            --open_count;
+          }
+        }
+      }
+
+      // Keep the minimum number of opened connections.
+      if (!conn.is_connected() && open_count < min_size) {
+        const auto start = steady_clock::now();
+        const bool is_reconnect{conn.session_start_time()};
+        if (options)
+          conn.set_options(options);
+        conn.connect();
+        if (is_metrics_enabled_)
+          record(is_reconnect ? Metric::reconnect : Metric::connect,
+            steady_clock::now() - start);
+        if (connect_handler)
+          connect_handler(conn);
+        ++open_count;
+      }
+    } catch (...) {
+      put_back(handle, false);
+      throw;
+    }
+
+    if (is_checked) {
+      const std::lock_guard lg{mutex_};
+      idle_infos_[index].checked_ = now;
+    }
+    put_back(handle, false);
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_metrics_enabled(const bool value) noexcept
+{
+  is_metrics_enabled_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Connection_pool::is_metrics_enabled() const noexcept
+{
+  return is_metrics_enabled_;
+}
+
+DMITIGR_PGFE_INLINE auto Connection_pool::metrics() const -> Metrics
+{
+  Metrics result;
+  {
+    const std::lock_guard lg{metrics_mutex_};
+    result = metrics_;
+  }
+  const std::lock_guard lg{mutex_};
+  result.in_use_count = states_.size() - free_indices_.size();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::reset_metrics() noexcept
+{
+  const std::lock_guard lg{metrics_mutex_};
+  metrics_ = {};
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::set_metrics_handler(Metrics_handler handler)
+{
+  auto value = handler ?
+    std::make_shared<const Metrics_handler>(std::move(handler)) : nullptr;
+  const std::lock_guard lg{metrics_mutex_};
+  metrics_handler_ = std::move(value);
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Type_catalog>&
+Connection_pool::type_catalog() const noexcept
+{
+  return type_catalog_;
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<Prepared_statement_registry>&
+Connection_pool::prepared_statement_registry() const noexcept
+{
+  return prepared_statement_registry_;
 }
 
 DMITIGR_PGFE_INLINE bool Connection_pool::is_connected() const noexcept
@@ -186,28 +500,64 @@ DMITIGR_PGFE_INLINE bool Connection_pool::is_connected() const noexcept
   return is_connected_;
 }
 
+DMITIGR_PGFE_INLINE auto Connection_pool::try_connection() -> Handle
+{
+  std::unique_lock lk{mutex_};
+
+  if (!is_connected_)
+    throw Client_exception{"cannot obtain connection from disconnected "
+      "connection pool"};
+
+  // Don't overtake the waiting threads.
+  const auto start = is_metrics_enabled_ ? std::chrono::steady_clock::now() :
+    std::chrono::steady_clock::time_point{};
+  auto result = waiters_.empty() ? acquire(lk) : Handle{};
+  if (lk.owns_lock())
+    lk.unlock(); // acquire() unlocks only on success
+  record_acquire(result, start);
+  return result;
+}
+
 DMITIGR_PGFE_INLINE auto Connection_pool::connection() -> Handle
 {
-  const std::lock_guard lg{mutex_};
+  return try_connection();
+}
+
+DMITIGR_PGFE_INLINE auto Connection_pool::connection(
+  const std::optional<std::chrono::milliseconds> timeout) -> Handle
+{
+  const auto start = is_metrics_enabled_ ? std::chrono::steady_clock::now() :
+    std::chrono::steady_clock::time_point{};
+  std::unique_lock lk{mutex_};
 
   if (!is_connected_)
     throw Client_exception{"cannot obtain connection from disconnected "
       "connection pool"};
 
-  const auto b = begin(states_);
-  const auto e = end(states_);
-  const auto i = find_if(b, e, [](const auto& pair)
+  const auto waiter = next_waiter_++;
+  waiters_.push_back(waiter);
+  track_demand();
+  const auto is_turn = [this, waiter]
   {
-    return static_cast<bool>(pair.first);
-  });
-  if (i != e) {
-    auto& conn = i->first;
-    auto& self = i->second;
-    conn->connect();
-    DMITIGR_ASSERT(conn->is_ready_for_request());
-    return {self, std::move(conn), static_cast<std::size_t>(i - b)};
-  } else
-    return {};
+    return !is_connected_ ||
+      (waiters_.front() == waiter && has_free_connection());
+  };
+  const bool is_waited = timeout ?
+    release_condition_.wait_for(lk, *timeout, is_turn) :
+    (release_condition_.wait(lk, is_turn), true);
+  waiters_.erase(find(begin(waiters_), end(waiters_), waiter));
+  // The next waiter could be served now.
+  release_condition_.notify_all();
+
+  if (!is_connected_)
+    throw Client_exception{"cannot obtain connection from disconnected "
+      "connection pool"};
+
+  auto result = is_waited ? acquire(lk) : Handle{};
+  if (lk.owns_lock())
+    lk.unlock(); // acquire() unlocks only on success
+  record_acquire(result, start);
+  return result;
 }
 
 DMITIGR_PGFE_INLINE void Connection_pool::release(Handle& handle) noexcept
@@ -215,43 +565,358 @@ DMITIGR_PGFE_INLINE void Connection_pool::release(Handle& handle) noexcept
   if (!handle.is_valid())
     return;
 
-  const std::lock_guard lg{mutex_};
-
   DMITIGR_ASSERT(handle.connection_);
   auto& conn = *handle.connection_;
-  const auto index = handle.state_index_;
-  DMITIGR_ASSERT(index < states_.size());
 
+  /*
+   * The release handler (which usually talks to the server) is called without
+   * holding the lock, so the pool isn't serialized by the release handlers.
+   */
+  const auto start = is_metrics_enabled_ ? std::chrono::steady_clock::now() :
+    std::chrono::steady_clock::time_point{};
   if (!conn.is_ready_for_request()) {
     // Disconnect and don't call the release handler.
     conn.disconnect();
-  } else if (release_handler_) {
+  } else {
+    auto policy = Reset_policy::none;
     try {
-      release_handler_(conn); // kinda of DISCARD ALL
+      const auto handler = [this, &policy]
+      {
+        const std::lock_guard lg{mutex_};
+        policy = reset_policy_;
+        return release_handler_;
+      }();
+      if (handler)
+        handler(conn);
+      if (conn.is_ready_for_request())
+        reset(conn, policy);
     } catch (const std::exception& e) {
       std::clog << "connection pool's release handler: error:" << e.what() << '\n';
+      conn.disconnect();
     } catch (...) {
       std::clog << "connection pool's release handler: unknown error\n";
+      conn.disconnect();
+    }
+
+    /*
+     * Disconnect if not ready for request after resetting, unless the response
+     * on the reset request is awaited upon the next acquisition.
+     */
+    if (policy == Reset_policy::deferred_discard_all ? !conn.is_connected() :
+      !conn.is_ready_for_request())
+      conn.disconnect();
+  }
+  if (is_metrics_enabled_)
+    record(Metric::release, std::chrono::steady_clock::now() - start);
+
+  put_back(handle);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection_pool::size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return states_.size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection_pool::free_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return free_indices_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Connection_pool::has_free_connection() const noexcept
+{
+  // Attention! mutex_ must be locked here!
+  return !free_indices_.empty();
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::track_demand() noexcept
+{
+  // Attention! mutex_ must be locked here!
+  const auto busy_count = states_.size() - free_indices_.size();
+  demand_peak_ = std::max(demand_peak_, busy_count + waiters_.size());
+}
+
+DMITIGR_PGFE_INLINE std::size_t Connection_pool::warm_size() noexcept
+{
+  // Attention! mutex_ must be locked here!
+  if (!warm_spare_count_)
+    return min_size_;
+
+  // The prediction follows the peak up immediately and decays smoothly.
+  const auto peak = static_cast<double>(demand_peak_);
+  demand_ = peak >= demand_ ? peak : demand_ + (peak - demand_) / 4;
+  demand_peak_ = states_.size() - free_indices_.size() + waiters_.size();
+  const auto demand = static_cast<std::size_t>(std::ceil(demand_));
+  return std::min(states_.size(),
+    std::max(min_size_, demand + warm_spare_count_));
+}
+
+DMITIGR_PGFE_INLINE auto
+Connection_pool::acquire(std::unique_lock<std::mutex>& lk) -> Handle
+{
+  // Attention! lk must be locked here!
+  DMITIGR_ASSERT(lk.owns_lock());
+  if (free_indices_.empty())
+    return {};
+
+  const auto index = free_indices_.back();
+  free_indices_.pop_back();
+  track_demand();
+  auto& state = states_[index];
+  const auto connect_handler = !state.first->is_connected() ?
+    connect_handler_ : decltype(connect_handler_){};
+  const auto options = options_;
+  Handle result{state.second, std::move(state.first), index};
+  lk.unlock();
+
+  auto& conn = *result.connection_;
+  complete_reset(conn);
+
+  // Open the connection not opened yet or closed upon of calling release().
+  try {
+    if (!conn.is_connected()) {
+      const auto start = std::chrono::steady_clock::now();
+      const bool is_reconnect{conn.session_start_time()};
+      if (options)
+        conn.set_options(options);
+      conn.connect();
+      if (is_metrics_enabled_)
+        record(is_reconnect ? Metric::reconnect : Metric::connect,
+          std::chrono::steady_clock::now() - start);
+      if (connect_handler)
+        connect_handler(conn);
     }
+  } catch (...) {
+    put_back(result);
+    throw;
+  }
+  DMITIGR_ASSERT(result.connection_->is_ready_for_request());
+  return result;
+}
+
+DMITIGR_PGFE_INLINE bool
+Connection_pool::complete_reset(Connection& conn) noexcept
+{
+  if (conn.is_connected() && !conn.is_ready_for_request()) {
+    try {
+      conn.process_responses([](auto&&){});
+    } catch (...) {
+      // The connection with the valid session will be reopened.
+    }
+    if (!conn.is_ready_for_request())
+      conn.disconnect();
+  }
+  return conn.is_connected();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::reset(Connection& conn, const Reset_policy policy)
+{
+  DMITIGR_ASSERT(conn.is_ready_for_request());
+  switch (policy) {
+  case Reset_policy::none:
+    return;
+  case Reset_policy::discard_all:
+    conn.execute("DISCARD ALL");
+    return;
+  case Reset_policy::reset_all:
+    conn.execute("RESET ALL");
+    return;
+  case Reset_policy::keep_prepared: {
+    // DISCARD ALL without DEALLOCATE ALL and DISCARD PLANS.
+    static const char* const queries[] = {
+      "CLOSE ALL",
+      "SET SESSION AUTHORIZATION DEFAULT",
+      "RESET ALL",
+      "UNLISTEN *",
+      "SELECT pg_advisory_unlock_all()",
+      "DISCARD TEMP",
+      "DISCARD SEQUENCES"
+    };
+#ifdef LIBPQ_HAS_PIPELINING
+    bool is_failed{};
+    Connection::Pipeline_scope pipeline{conn};
+    for (const auto* const query : queries)
+      conn.execute_pipelined([&is_failed](Error&&){is_failed = true;}, query);
+    conn.complete_pipeline();
+    pipeline.restore();
+    if (is_failed)
+      throw Client_exception{"cannot reset session state"};
+#else
+    for (const auto* const query : queries)
+      conn.execute(query);
+#endif
+    return;
   }
+  case Reset_policy::rollback:
+    if (const auto status = conn.transaction_status();
+      status == Transaction_status::uncommitted ||
+      status == Transaction_status::failed)
+      conn.execute("ROLLBACK");
+    return;
+  case Reset_policy::deferred_discard_all:
+    conn.execute_nio("DISCARD ALL");
+    return;
+  }
+  DMITIGR_ASSERT(false);
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::connect(const std::vector<Connection*>& connections,
+  std::vector<std::pair<Metric, std::chrono::nanoseconds>>& samples)
+{
+  using std::chrono::milliseconds;
+  using std::chrono::steady_clock;
+
+  if (connections.empty())
+    return;
 
   /*
-   * Disconnect if not ready for request after invoking the release handler,
-   * or if the whole connection pool is closed.
+   * The connections are established in parallel: the sockets of all the
+   * connections are polled by the single reactor.
    */
-  if (!conn.is_ready_for_request() || !is_connected_)
-    conn.disconnect();
+  Poll_reactor reactor;
+  std::size_t pending_count{connections.size()};
+  const auto start = steady_clock::now();
+  std::function<void(Connection&)> proceed = [&](Connection& conn)
+  {
+    const bool is_reconnect{conn.session_start_time()};
+    conn.connect_nio();
+    switch (conn.status()) {
+    case Connection_status::establishment_reading:
+      reactor.async_wait(conn.socket(), Socket_readiness::read_ready,
+        [&proceed, &conn](auto){proceed(conn);});
+      break;
+    case Connection_status::establishment_writing:
+      reactor.async_wait(conn.socket(), Socket_readiness::write_ready,
+        [&proceed, &conn](auto){proceed(conn);});
+      break;
+    case Connection_status::connected:
+      --pending_count;
+      if (is_metrics_enabled_)
+        samples.emplace_back(is_reconnect ? Metric::reconnect :
+          Metric::connect, steady_clock::now() - start);
+      break;
+    case Connection_status::failure:
+      throw Client_exception{conn.error_message()};
+    case Connection_status::disconnected:
+      DMITIGR_ASSERT(false);
+    }
+  };
+
+  try {
+    const auto timeout = connections.front()->options().connect_timeout();
+    const auto deadline = timeout ?
+      std::optional{steady_clock::now() + *timeout} : std::nullopt;
+    for (auto* const conn : connections)
+      proceed(*conn);
+    while (pending_count) {
+      std::optional<milliseconds> remaining;
+      if (deadline) {
+        remaining = std::chrono::duration_cast<milliseconds>(
+          *deadline - steady_clock::now());
+        if (remaining <= milliseconds::zero())
+          throw Client_exception{Client_errc::timed_out, "connection timeout"};
+      }
+      reactor.run_once(remaining);
+    }
+  } catch (...) {
+    for (auto* const conn : connections)
+      if (!conn->is_connected())
+        conn->disconnect();
+    throw;
+  }
+}
 
-  states_[index].first = std::move(handle.connection_);
-  handle.connection_ = {};
-  handle.state_index_ = {};
-  DMITIGR_ASSERT(!handle.is_valid());
+DMITIGR_PGFE_INLINE void
+Connection_pool::record(const Metric metric,
+  const std::chrono::nanoseconds value) noexcept
+{
+  std::shared_ptr<const Metrics_handler> handler;
+  {
+    const std::lock_guard lg{metrics_mutex_};
+    switch (metric) {
+    case Metric::acquire:
+      ++metrics_.acquire_count;
+      metrics_.acquire_wait_time.record(value);
+      break;
+    case Metric::acquire_miss:
+      ++metrics_.acquire_miss_count;
+      break;
+    case Metric::reconnect:
+      ++metrics_.reconnect_count;
+      [[fallthrough]];
+    case Metric::connect:
+      ++metrics_.connect_count;
+      metrics_.connect_time.record(value);
+      break;
+    case Metric::release:
+      metrics_.release_time.record(value);
+      break;
+    }
+    handler = metrics_handler_;
+  }
+
+  // The handler is called without locks, so it can use this instance.
+  if (handler) {
+    try {
+      (*handler)(metric, value);
+    } catch (const std::exception& e) {
+      std::clog << "connection pool's metrics handler: error:" << e.what() << '\n';
+    } catch (...) {
+      std::clog << "connection pool's metrics handler: unknown error\n";
+    }
+  }
 }
 
-DMITIGR_PGFE_INLINE std::size_t Connection_pool::size() const noexcept
+DMITIGR_PGFE_INLINE void Connection_pool::record_acquire(const Handle& handle,
+  const std::chrono::steady_clock::time_point start) noexcept
+{
+  if (is_metrics_enabled_)
+    record(handle ? Metric::acquire : Metric::acquire_miss,
+      std::chrono::steady_clock::now() - start);
+}
+
+DMITIGR_PGFE_INLINE void Connection_pool::stop_maintenance() noexcept
+{
+  if (!maintenance_thread_.joinable())
+    return;
+
+  {
+    const std::lock_guard lg{mutex_};
+    is_maintenance_stopping_ = true;
+  }
+  maintenance_condition_.notify_all();
+  maintenance_thread_.join();
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_pool::put_back(Handle& handle, const bool is_released) noexcept
 {
   const std::lock_guard lg{mutex_};
-  return states_.size();
+
+  DMITIGR_ASSERT(handle.connection_);
+  const auto index = handle.state_index_;
+  DMITIGR_ASSERT(index < states_.size());
+  DMITIGR_ASSERT(free_indices_.size() < free_indices_.capacity());
+
+  // Disconnect if the whole connection pool is closed.
+  if (!is_connected_)
+    handle.connection_->disconnect();
+
+  // The closed connections are moved to the bottom of the stack.
+  if (handle.connection_->is_connected())
+    free_indices_.push_back(index);
+  else
+    free_indices_.insert(begin(free_indices_), index);
+  states_[index].first = std::move(handle.connection_);
+  if (is_released)
+    idle_infos_[index].released_ = std::chrono::steady_clock::now();
+  handle.connection_ = {};
+  handle.state_index_ = {};
+  DMITIGR_ASSERT(!handle.is_valid());
+  release_condition_.notify_all();
 }
 
 } // namespace dmitigr::pgfe
@@ -19,10 +19,18 @@
 
 #include "connection.hpp"
 #include "dll.hpp"
+#include "metrics.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -32,9 +40,108 @@ namespace dmitigr::pgfe {
  * @ingroup utilities
  *
  * @brief A thread-safe pool of connections to a PostgreSQL server.
+ *
+ * @details All the functions of the pool are thread-safe, except the
+ * constructors, the destructor, connect_handler() and release_handler().
+ * The latter two return references to the handlers, which must not be used
+ * concurrently with the corresponding setters.
  */
 class Connection_pool final {
 public:
+  /**
+   * @brief A policy of resetting the session state of connections returned
+   * to the pool.
+   *
+   * @see set_reset_policy().
+   */
+  enum class Reset_policy {
+    /// The session state is not reset.
+    none,
+
+    /// The `DISCARD ALL` statement is executed.
+    discard_all,
+
+    /// The `RESET ALL` statement is executed.
+    reset_all,
+
+    /**
+     * The session state is reset as by `DISCARD ALL` except that the prepared
+     * statements and the cached plans are kept. The statements are executed
+     * in the pipeline with only one round trip.
+     */
+    keep_prepared,
+
+    /**
+     * The uncommitted or failed transaction, if any, is rolled back. Thus,
+     * there is no round trip in the common case.
+     */
+    rollback,
+
+    /**
+     * The `DISCARD ALL` statement is sent without waiting for its response
+     * when the connection is returned to the pool. The response is awaited
+     * when the connection is acquired again, by which time it's usually
+     * already received.
+     */
+    deferred_discard_all
+  };
+
+  /**
+   * @brief A metric of the pool.
+   *
+   * @see set_metrics_handler().
+   */
+  enum class Metric {
+    /// The connection is acquired. (The duration is the wait time.)
+    acquire,
+
+    /// The connection is not acquired. (The duration is the wait time.)
+    acquire_miss,
+
+    /// The connection is opened. (The duration is the connect time.)
+    connect,
+
+    /// The closed connection is reopened. (The duration is the connect time.)
+    reconnect,
+
+    /// The connection is released. (The duration is the reset time.)
+    release
+  };
+
+  /// The snapshot of the metrics of the pool.
+  struct Metrics final {
+    /// The number of acquired connections.
+    std::uint_least64_t acquire_count{};
+
+    /// The number of failed acquisitions (when invalid handles are returned).
+    std::uint_least64_t acquire_miss_count{};
+
+    /// The number of opened connections.
+    std::uint_least64_t connect_count{};
+
+    /// The number of reopened connections (included in `connect_count`).
+    std::uint_least64_t reconnect_count{};
+
+    /// The number of busy connections at the moment of snapshot.
+    std::size_t in_use_count{};
+
+    /// The wait time of the acquisitions.
+    Duration_histogram acquire_wait_time;
+
+    /// The connect time.
+    Duration_histogram connect_time;
+
+    /// The time of the calls of release handler and the reset (see Reset_policy).
+    Duration_histogram release_time;
+  };
+
+  /**
+   * @brief The handler of metrics.
+   *
+   * @remarks The handler must not call the functions of the pool.
+   */
+  using Metrics_handler = std::function<void(Metric, std::chrono::nanoseconds)>;
+
   /**
    * @brief A connection handle.
    *
@@ -120,7 +227,8 @@ public:
   /**
    * @brief The destructor.
    *
-   * @details Nullifies the pool() for each Handle instance.
+   * @details Stops the maintenance thread and nullifies the pool() for each
+   * Handle instance.
    */
   DMITIGR_PGFE_API ~Connection_pool() noexcept;
 
@@ -144,6 +252,8 @@ public:
    *
    * @param count A number of connections in the pool.
    * @param options A connection options to be used for connections of pool.
+   * If the communication mode is specified, the options are compiled once and
+   * shared by all the connections of the pool.
    */
   explicit DMITIGR_PGFE_API Connection_pool(std::size_t count,
     const Connection_options& options = {});
@@ -157,6 +267,34 @@ public:
     return is_valid();
   }
 
+  /**
+   * @brief Replaces the connection options of the pool.
+   *
+   * @details The options are compiled once and applied to each connection
+   * just before it's (re)connected. The connections which are already open
+   * are not affected, so the pool is not rebuilt. This is useful, for
+   * example, for the rotation of credentials.
+   *
+   * @par Requires
+   * `options.communication_mode()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see options(), Compiled_connection_options.
+   */
+  DMITIGR_PGFE_API void set_options(const Connection_options& options);
+
+  /**
+   * @returns The compiled connection options of the pool, or `nullptr` if the
+   * communication mode isn't specified in the options passed to the
+   * constructor.
+   *
+   * @see set_options().
+   */
+  DMITIGR_PGFE_API std::shared_ptr<const Compiled_connection_options>
+  options() const noexcept;
+
   /**
    * @brief Sets the handler which will be called for each connection in the
    * pool just after connecting to the PostgreSQL server.
@@ -178,9 +316,12 @@ public:
 
   /**
    * @brief Sets the handler which will be called just after returning a
-   * connection to the pool.
+   * connection to the pool, before resetting the session state according to
+   * reset_policy().
    *
-   * @remarks By default, it executes the `DISCARD ALL` statement.
+   * @remarks By default, there is no release handler.
+   * @remarks The handler is called without holding the lock of the pool, so
+   * the handlers of different connections can be invoked concurrently.
    *
    * @see release_handler().
    */
@@ -196,12 +337,50 @@ public:
   release_handler() const noexcept;
 
   /**
-   * @brief Opens the connections to the server.
+   * @brief Sets the policy of resetting the session state of connections
+   * returned to the pool.
+   *
+   * @remarks By default, it's Reset_policy::discard_all.
+   *
+   * @see reset_policy(), set_release_handler().
+   */
+  DMITIGR_PGFE_API void set_reset_policy(Reset_policy policy) noexcept;
+
+  /**
+   * @returns The current reset policy.
+   *
+   * @see set_reset_policy().
+   */
+  DMITIGR_PGFE_API Reset_policy reset_policy() const noexcept;
+
+  /**
+   * @brief Sets the number of connections to open by connect().
+   *
+   * @details The rest of connections are opened on demand by connection().
+   *
+   * @remarks By default, it's size().
+   *
+   * @see min_size(), connect().
+   */
+  DMITIGR_PGFE_API void set_min_size(std::size_t value) noexcept;
+
+  /**
+   * @returns The number of connections to open by connect().
+   *
+   * @see set_min_size().
+   */
+  DMITIGR_PGFE_API std::size_t min_size() const noexcept;
+
+  /**
+   * @brief Opens `min(min_size(), size())` free connections to the server.
+   *
+   * @details The connections are established in parallel. The connect timeout
+   * of each connection is taken from the options passed to the constructor.
    *
    * @par Effects
    * `is_connected() == is_valid()` on success.
    *
-   * @see connect_handler().
+   * @see connect_handler(), set_min_size().
    */
   DMITIGR_PGFE_API void connect();
 
@@ -213,20 +392,198 @@ public:
    */
   DMITIGR_PGFE_API void disconnect() noexcept;
 
+  /**
+   * @brief Sets the interval of maintenance of the free connections.
+   *
+   * @details If `value` is not `std::nullopt` the maintenance thread is
+   * started which calls maintain() with the specified interval. Otherwise,
+   * the maintenance thread is stopped.
+   *
+   * @par Requires
+   * `!value || value->count() > 0`.
+   *
+   * @remarks By default, the maintenance is disabled.
+   *
+   * @see maintenance_interval(), maintain().
+   */
+  DMITIGR_PGFE_API void
+  set_maintenance_interval(std::optional<std::chrono::milliseconds> value);
+
+  /// @returns The interval of maintenance.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  maintenance_interval() const noexcept;
+
+  /**
+   * @brief Sets the maximum time a connection may stay free in the pool
+   * before it's closed by maintain(). (The connections are not closed if
+   * `min_size()` connections or less are opened.)
+   *
+   * @remarks By default, it's `std::nullopt` which means *eternity*.
+   */
+  DMITIGR_PGFE_API void
+  set_max_idle_time(std::optional<std::chrono::milliseconds> value) noexcept;
+
+  /// @returns The maximum idle time.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  max_idle_time() const noexcept;
+
+  /**
+   * @brief Sets the maximum lifetime of the session, after which a free
+   * connection is closed by maintain().
+   *
+   * @remarks By default, it's `std::nullopt` which means *eternity*.
+   */
+  DMITIGR_PGFE_API void
+  set_max_lifetime(std::optional<std::chrono::milliseconds> value) noexcept;
+
+  /// @returns The maximum lifetime of the session.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  max_lifetime() const noexcept;
+
+  /**
+   * @brief Sets the number of the opened free connections to keep ahead of
+   * the predicted demand.
+   *
+   * @details The demand is the number of the busy connections plus the number
+   * of the threads waiting for a connection. Its peak between the calls of
+   * maintain() is tracked, and the predicted demand follows the peak up
+   * immediately and decays with the weight 1/4 per call of maintain(). Thus,
+   * maintain() keeps `min(size(), max(min_size(), predicted_demand() + value))`
+   * connections opened (so the repeated bursts don't pay the connect latency),
+   * and the connections above that number are closed after max_idle_time()
+   * once the burst is over.
+   *
+   * @remarks By default, it's `0`, which means that the demand is not
+   * predicted and maintain() keeps `min_size()` connections opened.
+   *
+   * @see warm_spare_count(), predicted_demand(), maintain().
+   */
+  DMITIGR_PGFE_API void set_warm_spare_count(std::size_t value) noexcept;
+
+  /// @returns The number of warm spare connections.
+  DMITIGR_PGFE_API std::size_t warm_spare_count() const noexcept;
+
+  /**
+   * @returns The number of connections predicted to be busy at once.
+   *
+   * @see set_warm_spare_count().
+   */
+  DMITIGR_PGFE_API std::size_t predicted_demand() const noexcept;
+
+  /**
+   * @brief Maintains the free connections.
+   *
+   * @details For each free connection, one by one, outside the lock of the
+   * pool:
+   *   -# closes it if either its session is older than max_lifetime(),
+   *   or it's free longer than max_idle_time();
+   *   -# checks it by executing the empty query if it's free longer than
+   *   maintenance_interval(), and closes it if the check is failed;
+   *   -# reopens it, if it's closed while less than `min_size()` connections
+   *   (or the number of connections required by the predicted demand, see
+   *   set_warm_spare_count()) are opened.
+   *
+   * Thus, the broken connections are reconnected off the hot path.
+   *
+   * @remarks Does nothing if `!is_connected()`.
+   */
+  DMITIGR_PGFE_API void maintain();
+
+  /**
+   * @brief Enables or disables the collection of metrics.
+   *
+   * @remarks By default, the metrics are not collected.
+   *
+   * @see metrics(), set_metrics_handler().
+   */
+  DMITIGR_PGFE_API void set_metrics_enabled(bool value) noexcept;
+
+  /// @returns `true` if the collection of metrics is enabled.
+  DMITIGR_PGFE_API bool is_metrics_enabled() const noexcept;
+
+  /// @returns The snapshot of the metrics.
+  DMITIGR_PGFE_API Metrics metrics() const;
+
+  /// Resets the metrics.
+  DMITIGR_PGFE_API void reset_metrics() noexcept;
+
+  /**
+   * @brief Sets the handler which is called for each recorded metric if the
+   * collection of metrics is enabled.
+   *
+   * @details The handler is called without holding the locks of this
+   * instance, so it can call the functions of this instance (for example,
+   * metrics()). The handler can be called concurrently by the threads which
+   * use this instance.
+   *
+   * @see set_metrics_enabled().
+   */
+  DMITIGR_PGFE_API void set_metrics_handler(Metrics_handler handler);
+
+  /**
+   * @returns The catalog of the data types shared by the connections of the
+   * pool.
+   *
+   * @remarks The catalog is empty until loaded, for example, by
+   * `pool.type_catalog()->load(*pool.connection())`.
+   *
+   * @see Connection::type_catalog().
+   */
+  DMITIGR_PGFE_API const std::shared_ptr<Type_catalog>&
+  type_catalog() const noexcept;
+
+  /**
+   * @returns The registry of the statements to be prepared on demand shared
+   * by the connections of the pool.
+   *
+   * @see Connection::prepared_statement_registry(),
+   * Connection::registered_statement().
+   */
+  DMITIGR_PGFE_API const std::shared_ptr<Prepared_statement_registry>&
+  prepared_statement_registry() const noexcept;
+
   /// @returns `true` if the pool is connected.
   DMITIGR_PGFE_API bool is_connected() const noexcept;
 
   /**
    * @returns The valid connection handle if there is a free connection in the
-   * pool, or invalid handle otherwise.
+   * pool and there are no threads waiting for a connection in connection(),
+   * or invalid handle otherwise.
    *
    * @throws Client_exception if:
    *   - `!is_connected()`;
    *   - attempt to reopen the connection possibly closed upon of calling
    *   release() is failed.
+   *
+   * @remarks The connection which is not opened yet (see set_min_size()) is
+   * opened on demand outside the lock of the pool, so the connections acquired
+   * by different threads are opened in parallel.
    */
+  DMITIGR_PGFE_API Handle try_connection();
+
+  /// @returns try_connection().
   DMITIGR_PGFE_API Handle connection();
 
+  /**
+   * @brief Waits for a free connection.
+   *
+   * @details The waiting threads are served in FIFO order.
+   *
+   * @param timeout The maximum amount of time to wait. The value of
+   * `std::nullopt` means *eternity*.
+   *
+   * @returns The valid connection handle, or invalid handle if there is no
+   * free connection within the specified `timeout`.
+   *
+   * @throws Client_exception if:
+   *   - `!is_connected()`, including the case when the pool is disconnected
+   *   while waiting;
+   *   - attempt to reopen the connection possibly closed upon of calling
+   *   release() is failed.
+   */
+  DMITIGR_PGFE_API Handle
+  connection(std::optional<std::chrono::milliseconds> timeout);
+
   /**
    * @brief Returns the connection of `handle` back to the pool.
    *
@@ -246,6 +603,9 @@ public:
   /// @returns The size of the pool.
   DMITIGR_PGFE_API std::size_t size() const noexcept;
 
+  /// @returns The number of free connections in the pool.
+  DMITIGR_PGFE_API std::size_t free_count() const noexcept;
+
 private:
   friend Handle;
 
@@ -254,10 +614,63 @@ private:
     std::shared_ptr<Connection_pool*>>;
 
   mutable std::mutex mutex_;
+  std::condition_variable release_condition_;
+  std::deque<std::uint_fast64_t> waiters_;
+  std::uint_fast64_t next_waiter_{};
   bool is_connected_{};
   std::vector<State> states_;
+  std::vector<std::size_t> free_indices_; // LIFO stack of states_ indices
+  std::shared_ptr<const Compiled_connection_options> options_; // or null
   std::function<void(Connection&)> connect_handler_;
   std::function<void(Connection&)> release_handler_;
+  Reset_policy reset_policy_{Reset_policy::discard_all};
+  std::size_t min_size_{};
+  std::size_t warm_spare_count_{};
+  std::size_t demand_peak_{};
+  double demand_{};
+
+  struct Idle_info final {
+    std::chrono::steady_clock::time_point released_{};
+    std::chrono::steady_clock::time_point checked_{};
+  };
+  std::vector<Idle_info> idle_infos_; // indexed as states_
+  std::optional<std::chrono::milliseconds> max_idle_time_;
+  std::optional<std::chrono::milliseconds> max_lifetime_;
+  std::optional<std::chrono::milliseconds> maintenance_interval_;
+  std::condition_variable maintenance_condition_;
+  std::thread maintenance_thread_;
+  bool is_maintenance_stopping_{};
+
+  void stop_maintenance() noexcept;
+
+  std::atomic<bool> is_metrics_enabled_{};
+  mutable std::mutex metrics_mutex_;
+  Metrics metrics_;
+  std::shared_ptr<const Metrics_handler> metrics_handler_;
+  std::shared_ptr<Type_catalog> type_catalog_;
+  std::shared_ptr<Prepared_statement_registry> prepared_statement_registry_;
+
+  /*
+   * Establishes the `connections` in parallel. The metrics (if enabled) are
+   * appended to the `samples` to record them without holding the lock.
+   */
+  void connect(const std::vector<Connection*>& connections,
+    std::vector<std::pair<Metric, std::chrono::nanoseconds>>& samples);
+  void record(Metric metric, std::chrono::nanoseconds value) noexcept;
+  void record_acquire(const Handle& handle,
+    std::chrono::steady_clock::time_point start) noexcept;
+
+  static void reset(Connection& conn, Reset_policy policy);
+  /*
+   * Completes the reset deferred upon of calling release(), and disconnects
+   * on failure. Returns `conn.is_connected()`.
+   */
+  static bool complete_reset(Connection& conn) noexcept;
+  bool has_free_connection() const noexcept;
+  void track_demand() noexcept;
+  std::size_t warm_size() noexcept;
+  Handle acquire(std::unique_lock<std::mutex>& lk);
+  void put_back(Handle& handle, bool is_released = true) noexcept;
 };
 
 } // namespace dmitigr::pgfe
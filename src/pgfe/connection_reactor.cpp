@@ -0,0 +1,208 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "connection_reactor.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void
+Connection_reactor::add(Connection& connection, Response_handler handler)
+{
+  if (!connection.is_connected())
+    throw Client_exception{"cannot add connection to reactor: not connected"};
+
+  const int socket{connection.socket()};
+  auto& state = state_of(socket);
+  if (state.connection_)
+    throw Client_exception{"cannot add connection to reactor: socket is "
+      "already in use by another connection"};
+  // The handler of the removed connection can still be being called.
+  if (state.handler_call_count_ && state.handler_)
+    retired_handlers_.push_back(std::move(state.handler_));
+  state.connection_ = &connection;
+  state.handler_ = std::move(handler);
+  try {
+    update_registration(state);
+  } catch (...) {
+    state.connection_ = nullptr;
+    state.handler_ = {};
+    release_if_unused(socket);
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_reactor::remove(const Connection& connection) noexcept
+{
+  const auto i = std::find_if(sockets_.begin(), sockets_.end(),
+    [&connection](const auto& p)
+    {
+      return p.second->connection_ == &connection;
+    });
+  if (i == sockets_.end())
+    return;
+
+  const int socket{i->first};
+  auto& state = *i->second;
+  state.connection_ = nullptr;
+  // The handler being called is reset by handle() after the call.
+  if (!state.handler_call_count_)
+    state.handler_ = {};
+  try {
+    update_registration(state);
+  } catch (...) {
+    // The socket may be already closed.
+  }
+  release_if_unused(socket);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Connection_reactor::connection_count() const noexcept
+{
+  return static_cast<std::size_t>(std::count_if(sockets_.cbegin(),
+    sockets_.cend(), [](const auto& p){return p.second->connection_;}));
+}
+
+DMITIGR_PGFE_INLINE void Connection_reactor::async_wait(const int socket,
+  const Socket_readiness mask, Callback callback)
+{
+  if (socket < 0)
+    throw Client_exception{"cannot wait socket readiness: invalid socket"};
+  else if (!callback)
+    throw Client_exception{"cannot wait socket readiness: invalid callback"};
+
+  auto& state = state_of(socket);
+  state.waits_.push_back(Pending_wait{mask, std::move(callback)});
+  try {
+    update_registration(state);
+  } catch (...) {
+    state.waits_.pop_back();
+    release_if_unused(socket);
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_reactor::release_if_unused(const int socket) noexcept
+{
+  if (const auto i = sockets_.find(socket); i != sockets_.end()) {
+    const auto& state = *i->second;
+    if (!state.connection_ && state.waits_.empty() &&
+      !state.handler_call_count_)
+      release(socket);
+  }
+}
+
+DMITIGR_PGFE_INLINE Socket_readiness
+Connection_reactor::requested_readiness(const Socket_state& state) noexcept
+{
+  auto result = Socket_readiness::unready;
+  for (const auto& wait : state.waits_)
+    result |= wait.mask_;
+  if (const auto* const conn = state.connection_) {
+    result |= Socket_readiness::read_ready;
+    if (!conn->is_output_flushed())
+      result |= Socket_readiness::write_ready;
+  }
+  return result & (Socket_readiness::read_ready | Socket_readiness::write_ready);
+}
+
+DMITIGR_PGFE_INLINE void
+Connection_reactor::handle(const int socket, const Socket_readiness readiness)
+{
+  const auto has_readiness = [readiness](const Socket_readiness mask)
+  {
+    return (readiness & mask) != Socket_readiness::unready;
+  };
+
+  const auto i = sockets_.find(socket);
+  if (i == sockets_.end())
+    return;
+  auto& state = *i->second;
+
+  // Take the fired one-shot waits.
+  std::vector<Pending_wait> fired;
+  {
+    auto& waits = state.waits_;
+    const auto is_pending = [&has_readiness](const Pending_wait& wait)
+    {
+      return !has_readiness(wait.mask_) &&
+        !has_readiness(Socket_readiness::exceptions);
+    };
+    const auto b = std::stable_partition(waits.begin(), waits.end(),
+      is_pending);
+    fired.assign(std::make_move_iterator(b),
+      std::make_move_iterator(waits.end()));
+    waits.erase(b, waits.end());
+  }
+
+  // Drive the connection.
+  if (auto* const conn = state.connection_) {
+    if (has_readiness(Socket_readiness::write_ready) &&
+      !conn->is_output_flushed())
+      conn->flush_output();
+
+    if (has_readiness(Socket_readiness::read_ready)) {
+      conn->read_input();
+
+      /*
+       * The handler is called by reference. While it's being called neither
+       * the handler nor the state are destroyed even if the handler removes
+       * the connection.
+       */
+      struct Handler_call_guard final {
+        Connection_reactor& reactor;
+        Socket_state& state;
+
+        ~Handler_call_guard()
+        {
+          if (!--state.handler_call_count_ && !state.connection_)
+            state.handler_ = {};
+          if (!--reactor.handler_call_depth_)
+            reactor.retired_handlers_.clear();
+        }
+      };
+      ++state.handler_call_count_;
+      ++handler_call_depth_;
+      const Handler_call_guard guard{*this, state};
+
+      while (state.connection_ == conn && conn->is_connected() &&
+        conn->handle_input(false) == Response_status::ready) {
+        if (state.handler_)
+          state.handler_(*conn);
+        else
+          conn->dispatch_pipeline_response();
+      }
+    }
+  }
+
+  // Update the registration. (The handler could remove the connection.)
+  if (state.connection_ || !state.waits_.empty())
+    update_registration(state);
+  release_if_unused(socket);
+
+  // Call the fired callbacks, which can add new waits.
+  for (auto& wait : fired)
+    wait.callback_(readiness);
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,162 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_CONNECTION_REACTOR_HPP
+#define DMITIGR_PGFE_CONNECTION_REACTOR_HPP
+
+#include "dll.hpp"
+#include "reactor.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief The base of the reactors which drive connections.
+ *
+ * @details For each added connection the reactor flushes the output when the
+ * socket becomes write-ready (which is needed only if
+ * Connection::is_nio_output_enabled()), reads the input when the socket
+ * becomes read-ready, and calls the response handler for each ready response.
+ * The derived classes wait for the readiness of the sockets and call handle().
+ *
+ * @remarks This class is not thread-safe.
+ */
+class Connection_reactor : public Reactor {
+public:
+  /**
+   * @brief The handler which is called when a response on `connection`
+   * is ready.
+   *
+   * @details The handler must consume the response, for example, by calling
+   * Connection::row(), Connection::completion() etc.
+   */
+  using Response_handler = std::function<void(Connection& connection)>;
+
+  /// Not copy-constructible.
+  Connection_reactor(const Connection_reactor&) = delete;
+
+  /// Not copy-assignable.
+  Connection_reactor& operator=(const Connection_reactor&) = delete;
+
+  /// Not move-constructible.
+  Connection_reactor(Connection_reactor&&) = delete;
+
+  /// Not move-assignable.
+  Connection_reactor& operator=(Connection_reactor&&) = delete;
+
+  /**
+   * @brief Registers the connection.
+   *
+   * @param connection The connection to drive. It must not be moved,
+   * disconnected or destroyed until removed.
+   * @param handler The response handler. If empty, the responses are
+   * dispatched to the handlers of requests submitted by
+   * Connection::execute_pipelined() and Connection::execute_async().
+   *
+   * @par Requires
+   * `connection.is_connected()` and the connection is not added yet.
+   *
+   * @remarks The connection must be added again after reconnect.
+   */
+  DMITIGR_PGFE_API void add(Connection& connection,
+    Response_handler handler = {});
+
+  /**
+   * @brief Unregisters the connection.
+   *
+   * @remarks Does nothing if the connection isn't added.
+   * @remarks Can be called from the response handler.
+   */
+  DMITIGR_PGFE_API void remove(const Connection& connection) noexcept;
+
+  /// @returns The number of added connections.
+  DMITIGR_PGFE_API std::size_t connection_count() const noexcept;
+
+  /// @see Reactor::async_wait().
+  DMITIGR_PGFE_API void async_wait(int socket, Socket_readiness mask,
+    Callback callback) override;
+
+protected:
+  /// A one-shot wait of the socket readiness.
+  struct Pending_wait final {
+    Socket_readiness mask_{};
+    Callback callback_;
+  };
+
+  /// A state of the socket.
+  struct Socket_state {
+    virtual ~Socket_state() = default;
+
+    int socket_{-1};
+    Connection* connection_{};
+    Response_handler handler_;
+    std::vector<Pending_wait> waits_;
+    int registered_events_{};
+    std::size_t handler_call_count_{};
+  };
+
+  /// The states of the sockets, which are owned by the derived class.
+  std::unordered_map<int, Socket_state*> sockets_;
+
+  /// The default constructor.
+  Connection_reactor() = default;
+
+  /// @returns The state of the `socket`, which is created if needed.
+  virtual Socket_state& state_of(int socket) = 0;
+
+  /// Registers the readiness the `state` requests. Unregisters if none.
+  virtual void update_registration(Socket_state& state) = 0;
+
+  /// Unregisters and releases the state of the `socket` if any.
+  virtual void release(int socket) noexcept = 0;
+
+  /**
+   * @brief Releases the state of the `socket` if it has neither the connection
+   * nor the waits, and is not used by the response handler being called.
+   */
+  DMITIGR_PGFE_API void release_if_unused(int socket) noexcept;
+
+  /// @returns The readiness which is requested by `state`.
+  DMITIGR_PGFE_API static Socket_readiness
+  requested_readiness(const Socket_state& state) noexcept;
+
+  /**
+   * @brief Handles the `readiness` of the `socket`.
+   *
+   * @details Drives the connection and then calls the fired callbacks of the
+   * pending waits.
+   */
+  DMITIGR_PGFE_API void handle(int socket, Socket_readiness readiness);
+
+private:
+  std::size_t handler_call_depth_{};
+  std::vector<Response_handler> retired_handlers_;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "connection_reactor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_CONNECTION_REACTOR_HPP
@@ -18,6 +18,7 @@
 #define DMITIGR_PGFE_CONVERSIONS_HPP
 
 #include "../net/conversions.hpp"
+#include "../str/hex.hpp"
 #include "array_conversions.hpp"
 #include "basic_conversions.hpp"
 #include "basics.hpp"
@@ -26,12 +27,21 @@
 #include "row.hpp"
 #include "types_fwd.hpp"
 
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <limits>
 #include <sstream>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace dmitigr::pgfe::detail {
 
@@ -101,144 +111,112 @@ struct Generic_data_conversions final {
 // Optimized numeric to/from std::string conversions
 // -----------------------------------------------------------------------------
 
-/// The common implementation of numeric to/from `std::string` conversions.
+/**
+ * @returns The numeric converted from the text `[first, last)`.
+ *
+ * @remarks The conversion is performed by `std::from_chars()` without any
+ * memory allocations. (For floating point numbers, if the standard library
+ * doesn't provide `std::from_chars()` for them, the text is copied and the
+ * conversion is performed by `std::stold()` and friends.)
+ */
 template<typename T>
-struct Numeric_string_conversions_base {
-  using Type = T;
-
-  template<typename ... Types>
-  static std::string to_string(Type value, Types&& ... args)
-  {
-    if constexpr (std::is_floating_point_v<Type>) {
-      return Generic_string_conversions<Type>::to_string(value,
-        std::forward<Types>(args)...);
-    } else
-      return std::to_string(value);
-  }
-
-protected:
-  template<typename R, typename ... Types>
-  static Type to_numeric__(const std::string& text,
-    R(*converter)(const std::string&, std::size_t*, Types ...))
-  {
-    Type result;
-    std::size_t idx;
-    if constexpr (std::is_floating_point_v<R>) // workaround for GCC 7.5
-      result = converter(text, &idx);
+T to_numeric(const char* first, const char* const last)
+{
+  static_assert(std::is_arithmetic_v<T>);
+  if (first != last && *first == '+')
+    ++first; // std::from_chars() doesn't accept the plus sign
+
+  T result{};
+#ifndef __cpp_lib_to_chars
+  if constexpr (std::is_floating_point_v<T>) {
+    const std::string text{first, last};
+    std::size_t idx{};
+    if constexpr (std::is_same_v<T, float>)
+      result = std::stof(text, &idx);
+    else if constexpr (std::is_same_v<T, double>)
+      result = std::stod(text, &idx);
     else
-      result = converter(text, &idx, 10);
-
+      result = std::stold(text, &idx);
     if (idx != text.size())
       throw Client_exception{"cannot convert to numeric: "
         "input contains non-convertible symbols"};
-
     return result;
+  } else {
+#endif
+    const auto [ptr, ec] = std::from_chars(first, last, result);
+    if (ec == std::errc::result_out_of_range)
+      throw Client_exception{"cannot convert to numeric: value is out of range"};
+    else if (ec != std::errc{} || ptr != last)
+      throw Client_exception{"cannot convert to numeric: "
+        "input contains non-convertible symbols"};
+    return result;
+#ifndef __cpp_lib_to_chars
   }
-};
-
-// -----------------------------------------------------------------------------
-
-/// The implementation of `short int` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<short int> final
-  : private Numeric_string_conversions_base<int> {
-  using Type = short int;
-  using Numeric_string_conversions_base::to_string;
-
-  template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
-  {
-    const int result = to_numeric__(text, &std::stoi);
-    constexpr auto max = std::numeric_limits<short int>::max();
-    if (result > max)
-      throw Client_exception{"cannot convert to type: numeric value "
-        + std::to_string(result) + " is greater than " + std::to_string(max)};
-
-    return static_cast<Type>(result);
-  }
-};
-
-/// The implementation of `int` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<int> final
-  : private Numeric_string_conversions_base<int> {
-  using Type = int;
-  using Numeric_string_conversions_base::to_string;
-
-  template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
-  {
-    return to_numeric__(text, &std::stoi);
-  }
-};
-
-/// The implementation of `long int` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<long int> final
-  : private Numeric_string_conversions_base<long int> {
-  using Type = long int;
-  using Numeric_string_conversions_base::to_string;
-
-  template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
-  {
-    return to_numeric__(text, &std::stol);
-  }
-};
-
-/// The implementation of `long long int` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<long long int> final
-  : private Numeric_string_conversions_base<long long int> {
-  using Type = long long int;
-  using Numeric_string_conversions_base::to_string;
+#endif
+}
 
-  template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
-  {
-    return to_numeric__(text, &std::stoll);
+/**
+ * @brief Writes the text representation of `value` into [first, last).
+ *
+ * @returns The pointer past the last written character. The result is not
+ * zero-terminated.
+ *
+ * @throws Client_exception if the size of [first, last) is insufficient.
+ *
+ * @remarks The floating point numbers are converted to the shortest text
+ * representation which can be converted back without loss of precision.
+ */
+template<typename T>
+char* numeric_to_chars(char* const first, char* const last, const T value)
+{
+  static_assert(std::is_arithmetic_v<T>);
+#ifndef __cpp_lib_to_chars
+  if constexpr (std::is_floating_point_v<T>) {
+    const auto text = Generic_string_conversions<T>::to_string(value);
+    if (text.size() > static_cast<std::size_t>(last - first))
+      throw Client_exception{"cannot convert numeric to string: "
+        "insufficient buffer size"};
+    return std::copy(text.cbegin(), text.cend(), first);
+  } else {
+#endif
+    const auto [ptr, ec] = std::to_chars(first, last, value);
+    if (ec != std::errc{})
+      throw Client_exception{"cannot convert numeric to string: "
+        "insufficient buffer size"};
+    return ptr;
+#ifndef __cpp_lib_to_chars
   }
-};
-
-/// The implementation of `float` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<float> final
-  : private Numeric_string_conversions_base<float> {
-  using Type = float;
-  using Numeric_string_conversions_base::to_string;
+#endif
+}
 
-  template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
-  {
-    return to_numeric__(text, &std::stof);
-  }
-};
+/**
+ * @returns The text representation of `value`.
+ *
+ * @remarks The floating point numbers are converted to the shortest text
+ * representation which can be converted back without loss of precision.
+ */
+template<typename T>
+std::string numeric_to_string(const T value)
+{
+  char buf[64];
+  return std::string(buf, numeric_to_chars(buf, buf + sizeof(buf), value));
+}
 
-/// The implementation of `double` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<double> final
-  : private Numeric_string_conversions_base<double> {
-  using Type = double;
-  using Numeric_string_conversions_base::to_string;
+/// The implementation of numeric to/from `std::string` conversions.
+template<typename T>
+struct Numeric_string_conversions final {
+  using Type = T;
 
   template<typename ... Types>
   static Type to_type(const std::string& text, Types&& ...)
   {
-    return to_numeric__(text, &std::stod);
+    return to_numeric<Type>(text.data(), text.data() + text.size());
   }
-};
-
-/// The implementation of `long double` to/from `std::string` conversions.
-template<>
-struct Numeric_string_conversions<long double> final
-  : private Numeric_string_conversions_base<long double> {
-  using Type = long double;
-  using Numeric_string_conversions_base::to_string;
 
   template<typename ... Types>
-  static Type to_type(const std::string& text, Types&& ...)
+  static std::string to_string(const Type value, Types&& ...)
   {
-    return to_numeric__(text, &std::stold);
+    return numeric_to_string(value);
   }
 };
 
@@ -252,13 +230,14 @@ struct Numeric_data_conversions final {
   using Type = T;
 
   template<typename ... Types>
-  static Type to_type(const Data& data, Types&& ... args)
+  static Type to_type(const Data& data, Types&& ...)
   {
     if (data.format() == Data_format::binary)
-      return net::conv<Type>(data.bytes(), data.size());
-    else
-      return Generic_data_conversions<Type, StringConversions>::to_type(data,
-        std::forward<Types>(args)...);
+      return from_binary(data.bytes(), data.size());
+    else {
+      const auto* const text = static_cast<const char*>(data.bytes());
+      return to_numeric<Type>(text, text + data.size());
+    }
   }
 
   template<typename ... Types>
@@ -266,14 +245,82 @@ struct Numeric_data_conversions final {
   {
     if (!data)
       throw Client_exception{"cannot convert to type: null data given"};
-    return to_type(data, std::forward<Types>(args)...);
+    return to_type(*data, std::forward<Types>(args)...);
   }
 
   template<typename ... Types>
-  static std::unique_ptr<Data> to_data(Type value, Types&& ... args)
+  static std::unique_ptr<Data> to_data(Type value, Types&& ...)
+  {
+    char buf[64];
+    const auto* const end = numeric_to_chars(buf, buf + sizeof(buf), value);
+    return Data::make(std::string_view(buf, static_cast<std::size_t>(end - buf)),
+      Data_format::text);
+  }
+
+  /**
+   * @returns The data of the specified `format`. The data of binary format
+   * is produced in the network byte order as `int2`, `int4` or `int8` for
+   * integers and as `float4` or `float8` for floating point numbers.
+   */
+  static std::unique_ptr<Data> to_data(const Type value, const Data_format format)
+  {
+    if (format == Data_format::binary) {
+      static_assert(!std::is_integral_v<Type> ||
+        sizeof(Type) == 2 || sizeof(Type) == 4 || sizeof(Type) == 8);
+      if constexpr (std::is_floating_point_v<Type> && sizeof(Type) > 8)
+        throw Client_exception{"cannot convert numeric to data of binary "
+          "format: type is not supported"};
+      else {
+        char buf[sizeof(Type)];
+        net::copy(buf, value);
+        return std::make_unique<Inline_data>(buf, sizeof(buf),
+          Data_format::binary);
+      }
+    } else
+      return to_data(value);
+  }
+
+private:
+  template<typename U>
+  static Type from_binary__(const void* const bytes)
+  {
+    using Limits = std::numeric_limits<Type>;
+    const auto result = net::conv<U>(bytes, sizeof(U));
+    bool is_in_range{true};
+    if constexpr (std::is_integral_v<Type> && std::is_unsigned_v<Type>) {
+      // U is signed.
+      is_in_range = result >= 0 &&
+        static_cast<std::make_unsigned_t<U>>(result) <= Limits::max();
+    } else if constexpr (std::is_integral_v<Type>) {
+      if constexpr (sizeof(U) > sizeof(Type))
+        is_in_range = Limits::min() <= result && result <= Limits::max();
+    } else if constexpr (sizeof(U) > sizeof(Type)) {
+      // The infinities and NaNs are representable.
+      is_in_range = !std::isfinite(result) ||
+        (-Limits::max() <= result && result <= Limits::max());
+    }
+    if (!is_in_range)
+      throw Client_exception{"cannot convert numeric from data of binary "
+        "format: value is out of range"};
+    return static_cast<Type>(result);
+  }
+
+  static Type from_binary(const void* const bytes, const std::size_t size)
   {
-    return Generic_data_conversions<Type, StringConversions>::to_data(value,
-      std::forward<Types>(args)...);
+    if constexpr (std::is_integral_v<Type>) {
+      switch (size) {
+      case 2: return from_binary__<std::int16_t>(bytes);
+      case 4: return from_binary__<std::int32_t>(bytes);
+      case 8: return from_binary__<std::int64_t>(bytes);
+      }
+    } else {
+      switch (size) {
+      case 4: return from_binary__<float>(bytes);
+      case 8: return from_binary__<double>(bytes);
+      }
+    }
+    throw Client_exception{"cannot convert numeric from data of binary "
+      "format: invalid input size"};
   }
 };
 
@@ -426,6 +473,15 @@ struct Bool_data_conversions final {
     return Data::make(Bool_string_conversions::to_string(value),
       Data_format::text);
   }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type value, const Data_format format)
+  {
+    if (format == Data_format::binary)
+      return Data::make(std::string(1, value ? '\1' : '\0'), Data_format::binary);
+    else
+      return to_data(value);
+  }
 };
 
 // -----------------------------------------------------------------------------
@@ -468,17 +524,25 @@ namespace dmitigr::pgfe {
  *
  * @details Support of the following data formats is implemented for:
  *   - input data  - Data_format::text, Data_format::binary;
- *   - output data - Data_format::text.
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called; `long double` is not
+ *   supported).
  *
  * @par Requires
- * When converting to the native type `Type`, the size of the input data in
- * Data_format::binary format must be less or equal to the size of the `Type`.
+ * The size of the input data in Data_format::binary format must be either 2, 4
+ * or 8 for integers (`int2`, `int4` or `int8`), and either 4 or 8 for floating
+ * point numbers (`float4` or `float8`).
  */
 template<typename T>
 struct Numeric_conversions : Basic_conversions<
   T,
   detail::Numeric_string_conversions<T>,
-  detail::Numeric_data_conversions<T>> {};
+  detail::Numeric_data_conversions<T>> {
+  /// The OID of `int2`, `int4`, `int8`, `float4` or `float8`.
+  static constexpr Oid binary_oid{std::is_integral_v<T>
+    ? (sizeof(T) == 2 ? 21 : sizeof(T) == 4 ? 23 : 20)
+    : (sizeof(T) == 4 ? 700 : sizeof(T) == 8 ? 701 : invalid_oid)};
+};
 
 // -----------------------------------------------------------------------------
 
@@ -537,6 +601,23 @@ struct Conversions<std::string> final : Basic_conversions<
  *   Data_format::text and Data_format::binary formats;
  *   - instances of the type Data can only be created in Data_format::text
  *   format.
+ *
+ * @par Zero-copy conversions
+ * @parblock
+ * The resulting views refer to the bytes of the converted data rather than
+ * to copies, so, for example, the views converted from Row::data() or
+ * Row_batch::data() refer to the memory of the response and are valid as long
+ * as the corresponding Row or Row_batch (or the instance of Data) is alive.
+ *
+ * The same applies to the containers of (optional) `std::string_view`, such as
+ * `std::vector<std::string_view>` or Nullable_array<std::string_view>, which
+ * elements are views of the elements of the array:
+ *   - in Data_format::binary format, arrays of any dimensionality are
+ *   supported;
+ *   - in Data_format::text format, only one-dimensional arrays are supported,
+ *   and the quoted elements must not contain escaped characters (otherwise
+ *   Client_exception is thrown).
+ * @endparblock
  */
 template<>
 struct Conversions<std::string_view> final : Basic_conversions<
@@ -622,14 +703,18 @@ struct Conversions<char> final : Basic_conversions<char,
  *
  * @details Support of the following data formats is implemented for:
  *   - input data  - Data_format::text, Data_format::binary;
- *   - output data - Data_format::text.
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called).
  *
  * @par Requires
  * The size of the input data of Data_format::binary format must be exactly `1`.
  */
 template<>
 struct Conversions<bool> final : Basic_conversions<bool,
-  detail::Bool_string_conversions, detail::Bool_data_conversions> {};
+  detail::Bool_string_conversions, detail::Bool_data_conversions> {
+  /// The OID of `bool`.
+  static constexpr Oid binary_oid{16};
+};
 
 /**
  * @ingroup conversions
@@ -640,11 +725,14 @@ template<typename T>
 struct Conversions<std::optional<T>> final {
   using Type = std::optional<T>;
 
+  /// The OID of the type of binary data of `T`.
+  static constexpr Oid binary_oid{binary_oid_v<T>};
+
   template<typename ... Types>
   static Type to_type(const Data& data, Types&& ... args)
   {
     if (data)
-      return Conversions<T>::to_type(data, std::forward(args)...);
+      return Conversions<T>::to_type(data, std::forward<Types>(args)...);
     else
       return std::nullopt;
   }
@@ -653,7 +741,8 @@ struct Conversions<std::optional<T>> final {
   static Type to_type(std::unique_ptr<Data>&& data, Types&& ... args)
   {
     if (data && *data)
-      return Conversions<T>::to_type(std::move(data), std::forward(args)...);
+      return Conversions<T>::to_type(std::move(data),
+        std::forward<Types>(args)...);
     else
       return std::nullopt;
   }
@@ -662,7 +751,7 @@ struct Conversions<std::optional<T>> final {
   static std::unique_ptr<Data> to_data(const Type& value, Types&& ... args)
   {
     if (value)
-      return Conversions<T>::to_data(*value, std::forward(args)...);
+      return Conversions<T>::to_data(*value, std::forward<Types>(args)...);
     else
       return nullptr;
   }
@@ -671,7 +760,8 @@ struct Conversions<std::optional<T>> final {
   static std::unique_ptr<Data> to_data(Type&& value, Types&& ... args)
   {
     if (value)
-      return Conversions<T>::to_data(std::move(*value), std::forward(args)...);
+      return Conversions<T>::to_data(std::move(*value),
+        std::forward<Types>(args)...);
     else
       return nullptr;
   }
@@ -680,7 +770,7 @@ struct Conversions<std::optional<T>> final {
   static Type to_type(const Row& row, Types&& ... args)
   {
     if (row)
-      return Conversions<T>::to_type(row, std::forward(args)...);
+      return Conversions<T>::to_type(row, std::forward<Types>(args)...);
     else
       return std::nullopt;
   }
@@ -689,7 +779,8 @@ struct Conversions<std::optional<T>> final {
   static Type to_type(Row&& row, Types&& ... args)
   {
     if (row)
-      return Conversions<T>::to_type(std::move(row), std::forward(args)...);
+      return Conversions<T>::to_type(std::move(row),
+        std::forward<Types>(args)...);
     else
       return std::nullopt;
   }
@@ -697,4 +788,1142 @@ struct Conversions<std::optional<T>> final {
 
 } // namespace dmitigr::pgfe
 
+// =============================================================================
+// Conversions of bytea, uuid, numeric, timestamp and date
+// =============================================================================
+
+namespace dmitigr::pgfe::detail {
+
+/// @returns The value of hexadecimal digit `c`, or `-1` if `c` is not a digit.
+inline int hex_digit_value(const char c) noexcept
+{
+  if ('0' <= c && c <= '9')
+    return c - '0';
+  else if ('a' <= c && c <= 'f')
+    return c - 'a' + 10;
+  else if ('A' <= c && c <= 'F')
+    return c - 'A' + 10;
+  else
+    return -1;
+}
+
+/// @returns The lowercase hexadecimal digit of the lower 4 bits of `value`.
+inline char hex_digit(const unsigned value) noexcept
+{
+  return "0123456789abcdef"[value & 0xf];
+}
+
+/**
+ * @returns The size in bytes of the value of type `bytea` represented by the
+ * `data`.
+ *
+ * @par Requires
+ * `data` must be either of Data_format::binary format or of Data_format::text
+ * format in the hex output format of `bytea` (i.e. `\x...`).
+ */
+inline std::size_t bytea_size(const Data& data)
+{
+  if (data.format() == Data_format::binary)
+    return data.size();
+
+  const std::string_view text{static_cast<const char*>(data.bytes()), data.size()};
+  if (!(text.size() >= 2 && text[0] == '\\' && text[1] == 'x' &&
+      !(text.size() % 2)))
+    throw Client_exception{"cannot convert to bytea: only binary and hex text"
+      " formats are supported"};
+  return (text.size() - 2) / 2;
+}
+
+/**
+ * @brief Copies the value of type `bytea` represented by the `data` to `dest`.
+ *
+ * @par Requires
+ * `dest` must point to at least `bytea_size(data)` bytes.
+ */
+inline void copy_bytea(std::byte* const dest, const Data& data)
+{
+  const auto* const bytes = static_cast<const char*>(data.bytes());
+  if (data.format() == Data_format::binary) {
+    if (data.size())
+      std::memcpy(dest, bytes, data.size());
+  } else {
+    if (!str::hex_decode(dest, bytes + 2, 2*bytea_size(data)))
+      throw Client_exception{"cannot convert to bytea: invalid hex digit"};
+  }
+}
+
+/// @returns The data of text format in the hex format of `bytea`.
+inline std::unique_ptr<Data> to_hex_bytea_data(const std::byte* const bytes,
+  const std::size_t size)
+{
+  std::string result(2 + 2*size, '\0');
+  result[0] = '\\';
+  result[1] = 'x';
+  str::hex_encode(result.data() + 2, bytes, size);
+  return Data::make(std::move(result), Data_format::text);
+}
+
+} // namespace dmitigr::pgfe::detail
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A value of PostgreSQL `uuid` type.
+ */
+class Uuid final {
+public:
+  /// Constructs the nil UUID.
+  Uuid() = default;
+
+  /// The constructor.
+  explicit Uuid(const std::array<std::byte, 16>& bytes) noexcept
+    : bytes_{bytes}
+  {}
+
+  /**
+   * @returns The instance parsed from the text representation `str`, such as
+   * `a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11` (hyphens are optional and the
+   * representation can be enclosed in braces). As in PostgreSQL, a hyphen
+   * can follow any group of four hex digits except the last one.
+   *
+   * @throws Client_exception if `str` is not a valid UUID representation.
+   */
+  static Uuid from_string(std::string_view str)
+  {
+    if (str.size() >= 2 && str.front() == '{' && str.back() == '}')
+      str = str.substr(1, str.size() - 2);
+
+    const auto throw_invalid = []
+    {
+      throw Client_exception{"cannot convert to uuid: invalid text "
+        "representation"};
+    };
+    Uuid result;
+    std::size_t count{};
+    bool is_hyphen_allowed{};
+    for (const char c : str) {
+      if (c == '-' && is_hyphen_allowed) {
+        is_hyphen_allowed = false;
+        continue;
+      }
+      const int value{detail::hex_digit_value(c)};
+      if (value < 0 || count == 32)
+        throw_invalid();
+      auto& b = result.bytes_[count / 2];
+      b = (count % 2) ? (b | static_cast<std::byte>(value)) :
+        static_cast<std::byte>(value << 4);
+      ++count;
+      is_hyphen_allowed = count % 4 == 0 && count < 32;
+    }
+    if (count != 32)
+      throw_invalid();
+    return result;
+  }
+
+  /// @returns The bytes of this UUID.
+  const std::array<std::byte, 16>& bytes() const noexcept
+  {
+    return bytes_;
+  }
+
+  /// @returns `true` if this UUID is the nil UUID.
+  bool is_nil() const noexcept
+  {
+    return *this == Uuid{};
+  }
+
+  /// @returns The canonical text representation of this UUID.
+  std::string to_string() const
+  {
+    std::string result;
+    result.reserve(36);
+    for (std::size_t i{}; i < bytes_.size(); ++i) {
+      if (i == 4 || i == 6 || i == 8 || i == 10)
+        result += '-';
+      const auto b = std::to_integer<unsigned>(bytes_[i]);
+      result += detail::hex_digit(b >> 4);
+      result += detail::hex_digit(b);
+    }
+    return result;
+  }
+
+  /// @returns `true` if `lhs` is equal to `rhs`.
+  friend bool operator==(const Uuid& lhs, const Uuid& rhs) noexcept
+  {
+    return lhs.bytes_ == rhs.bytes_;
+  }
+
+  /// @returns `true` if `lhs` is not equal to `rhs`.
+  friend bool operator!=(const Uuid& lhs, const Uuid& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  /// @returns `true` if `lhs` is less than `rhs`.
+  friend bool operator<(const Uuid& lhs, const Uuid& rhs) noexcept
+  {
+    return lhs.bytes_ < rhs.bytes_;
+  }
+
+private:
+  std::array<std::byte, 16> bytes_{};
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A lossless representation of a value of PostgreSQL `numeric` type.
+ *
+ * @details The value is stored in the text representation which is used by
+ * PostgreSQL for output, for example, `-123.4500`, `NaN`, `Infinity` or
+ * `-Infinity`.
+ */
+class Numeric final {
+public:
+  /// Constructs zero.
+  Numeric() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @throws Client_exception if `value` is not a valid representation. (The
+   * exponential notation is not supported.)
+   */
+  explicit Numeric(std::string value)
+    : value_{std::move(value)}
+  {
+    if (!is_valid_representation(value_))
+      throw Client_exception{"cannot create numeric: invalid representation"};
+  }
+
+  /// @returns The text representation of this instance.
+  const std::string& to_string() const noexcept
+  {
+    return value_;
+  }
+
+  /// @returns `true` if this instance is "not a number".
+  bool is_nan() const noexcept
+  {
+    return value_ == "NaN";
+  }
+
+  /**
+   * @returns `true` if `lhs` has the same representation as `rhs`.
+   *
+   * @remarks Values which differ only in the display scale, such as `1.0` and
+   * `1.00`, are not considered equal.
+   */
+  friend bool operator==(const Numeric& lhs, const Numeric& rhs) noexcept
+  {
+    return lhs.value_ == rhs.value_;
+  }
+
+  /// @returns `!(lhs == rhs)`.
+  friend bool operator!=(const Numeric& lhs, const Numeric& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  std::string value_{"0"};
+
+  static bool is_valid_representation(const std::string_view value) noexcept
+  {
+    if (value == "NaN" || value == "Infinity" || value == "+Infinity" ||
+      value == "-Infinity")
+      return true;
+
+    std::size_t pos{};
+    if (pos < value.size() && (value[pos] == '-' || value[pos] == '+'))
+      ++pos;
+    std::size_t digit_count{};
+    bool is_dot_seen{};
+    for (; pos < value.size(); ++pos) {
+      if ('0' <= value[pos] && value[pos] <= '9')
+        ++digit_count;
+      else if (value[pos] == '.' && !is_dot_seen)
+        is_dot_seen = true;
+      else
+        return false;
+    }
+    return digit_count > 0;
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A non-owning view of a value of PostgreSQL `json` or `jsonb` type.
+ *
+ * @details The value is the JSON text which is neither parsed nor validated
+ * by Pgfe, so the pre-serialized JSON can be passed to the server without
+ * re-escaping, and the JSON received from the server can be passed to a JSON
+ * parser without copying.
+ *
+ * @see Json.
+ */
+class Json_view final {
+public:
+  /// Constructs the view of JSON `null`.
+  Json_view() = default;
+
+  /// The constructor.
+  explicit Json_view(const std::string_view text) noexcept
+    : text_{text}
+  {}
+
+  /// @returns The JSON text.
+  std::string_view to_string_view() const noexcept
+  {
+    return text_;
+  }
+
+  /// @returns `true` if `lhs` has the same text as `rhs`.
+  friend bool operator==(const Json_view lhs, const Json_view rhs) noexcept
+  {
+    return lhs.text_ == rhs.text_;
+  }
+
+  /// @returns `!(lhs == rhs)`.
+  friend bool operator!=(const Json_view lhs, const Json_view rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  std::string_view text_{"null"};
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A value of PostgreSQL `json` or `jsonb` type.
+ *
+ * @details The value is the JSON text which is neither parsed nor validated
+ * by Pgfe.
+ *
+ * @see Json_view.
+ */
+class Json final {
+public:
+  /// Constructs JSON `null`.
+  Json() = default;
+
+  /// The constructor.
+  explicit Json(std::string text) noexcept
+    : text_{std::move(text)}
+  {}
+
+  /// @overload
+  explicit Json(const Json_view view)
+    : text_{view.to_string_view()}
+  {}
+
+  /// @returns The JSON text.
+  const std::string& to_string() const noexcept
+  {
+    return text_;
+  }
+
+  /// @returns The view of this instance.
+  Json_view to_view() const noexcept
+  {
+    return Json_view{text_};
+  }
+
+  /// @returns `true` if `lhs` has the same text as `rhs`.
+  friend bool operator==(const Json& lhs, const Json& rhs) noexcept
+  {
+    return lhs.text_ == rhs.text_;
+  }
+
+  /// @returns `!(lhs == rhs)`.
+  friend bool operator!=(const Json& lhs, const Json& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  std::string text_{"null"};
+};
+
+} // namespace dmitigr::pgfe
+
+namespace dmitigr::pgfe::detail {
+
+/// The version of `jsonb` in binary format.
+constexpr char jsonb_version{1};
+
+/**
+ * @returns The JSON text of `data` of type `json` or `jsonb`.
+ *
+ * @details The version byte of `jsonb` in binary format is skipped. (The
+ * binary format of `json` is the text itself, which cannot start with the
+ * byte `1`.)
+ *
+ * @throws Client_exception if the version of `jsonb` is not supported.
+ */
+inline std::string_view json_text(const Data& data)
+{
+  std::string_view result{static_cast<const char*>(data.bytes()), data.size()};
+  if (data.format() == Data_format::binary && !result.empty() &&
+    static_cast<unsigned char>(result.front()) < 0x20) {
+    if (result.front() != jsonb_version)
+      throw Client_exception{"cannot convert to JSON: unsupported jsonb version"};
+    result.remove_prefix(1);
+  }
+  return result;
+}
+
+/// @returns The data of `jsonb` in binary format of `text`.
+inline std::unique_ptr<Data> to_jsonb_data(const std::string_view text)
+{
+  std::string result;
+  result.reserve(1 + text.size());
+  result += jsonb_version;
+  result += text;
+  return Data::make(std::move(result), Data_format::binary);
+}
+
+} // namespace dmitigr::pgfe::detail
+
+namespace dmitigr::pgfe::detail {
+
+/// The sign values of `numeric` in binary format.
+enum Numeric_sign : std::uint16_t {
+  numeric_pos = 0x0000,
+  numeric_neg = 0x4000,
+  numeric_nan = 0xC000,
+  numeric_pinf = 0xD000,
+  numeric_ninf = 0xF000
+};
+
+/**
+ * @returns The value of `numeric` in binary format (the number of base-10000
+ * digits, weight, sign, display scale, digits) converted from `value`.
+ */
+inline std::string numeric_to_binary(const Numeric& value)
+{
+  const std::string_view text{value.to_string()};
+  std::uint16_t sign{numeric_pos};
+  std::int16_t weight{};
+  std::int16_t dscale{};
+  std::vector<std::int16_t> digits;
+  if (text == "NaN")
+    sign = numeric_nan;
+  else if (text == "Infinity" || text == "+Infinity")
+    sign = numeric_pinf;
+  else if (text == "-Infinity")
+    sign = numeric_ninf;
+  else {
+    std::string_view s{text};
+    if (s.front() == '-' || s.front() == '+') {
+      if (s.front() == '-')
+        sign = numeric_neg;
+      s.remove_prefix(1);
+    }
+    const auto dot_pos = s.find('.');
+    auto int_part = s.substr(0, dot_pos);
+    const auto frac_part = dot_pos != std::string_view::npos ?
+      s.substr(dot_pos + 1) : std::string_view{};
+    while (!int_part.empty() && int_part.front() == '0')
+      int_part.remove_prefix(1);
+    if (!(int_part.size() / 4 < 0x7fff && frac_part.size() <= 0x3fff))
+      throw Client_exception{"cannot convert numeric to data of binary format:"
+        " value is out of range"};
+
+    // Align both parts to the groups of 4 decimal digits.
+    const std::size_t int_pad{(4 - int_part.size() % 4) % 4};
+    std::string all(int_pad, '0');
+    all.append(int_part).append(frac_part).append((4 - frac_part.size() % 4) % 4, '0');
+    weight = static_cast<std::int16_t>((int_pad + int_part.size()) / 4) - 1;
+    dscale = static_cast<std::int16_t>(frac_part.size());
+    for (std::size_t i{}; i < all.size(); i += 4) {
+      const auto d = (all[i] - '0')*1000 + (all[i + 1] - '0')*100 +
+        (all[i + 2] - '0')*10 + (all[i + 3] - '0');
+      if (digits.empty() && !d)
+        --weight; // strip leading zero
+      else
+        digits.push_back(static_cast<std::int16_t>(d));
+    }
+    while (!digits.empty() && !digits.back())
+      digits.pop_back();
+    if (digits.empty()) {
+      weight = 0;
+      sign = numeric_pos;
+    }
+  }
+
+  std::string result(8 + 2*digits.size(), '\0');
+  auto* const dest = result.data();
+  net::copy(dest, static_cast<std::int16_t>(digits.size()));
+  net::copy(dest + 2, weight);
+  net::copy(dest + 4, sign);
+  net::copy(dest + 6, dscale);
+  copy_to_big_endian(dest + 8, digits.data(), digits.size());
+  return result;
+}
+
+/// @returns The value converted from `numeric` in binary format.
+inline Numeric numeric_from_binary(const void* const data, const std::size_t size)
+{
+  static const auto throw_invalid = []
+  {
+    throw Client_exception{"cannot convert to numeric: invalid binary input"};
+  };
+
+  if (size < 8)
+    throw_invalid();
+  const auto* const bytes = static_cast<const char*>(data);
+  const auto ndigits = net::conv<std::int16_t>(bytes, 2);
+  const auto weight = net::conv<std::int16_t>(bytes + 2, 2);
+  const auto sign = net::conv<std::uint16_t>(bytes + 4, 2);
+  const auto dscale = net::conv<std::int16_t>(bytes + 6, 2);
+  if (ndigits < 0 || dscale < 0 ||
+    size != 8 + 2*static_cast<std::size_t>(ndigits))
+    throw_invalid();
+
+  switch (sign) {
+  case numeric_nan: return Numeric{"NaN"};
+  case numeric_pinf: return Numeric{"Infinity"};
+  case numeric_ninf: return Numeric{"-Infinity"};
+  case numeric_pos: [[fallthrough]];
+  case numeric_neg: break;
+  default: throw_invalid();
+  }
+
+  const auto digit = [bytes, ndigits](const int i)
+  {
+    if (i < 0 || i >= ndigits)
+      return 0;
+    const int result{net::conv<std::int16_t>(bytes + 8 + 2*i, 2)};
+    if (result < 0 || result > 9999)
+      throw_invalid();
+    return result;
+  };
+
+  std::string result;
+  if (sign == numeric_neg)
+    result += '-';
+  if (weight < 0)
+    result += '0';
+  else {
+    for (int i{}; i <= weight; ++i) {
+      const int d{digit(i)};
+      if (!i)
+        result += std::to_string(d);
+      else
+        for (int div{1000}; div; div /= 10)
+          result += static_cast<char>('0' + d / div % 10);
+    }
+  }
+  if (dscale > 0) {
+    result += '.';
+    int appended{};
+    for (int i{weight + 1}; appended < dscale; ++i) {
+      const int d{digit(i)};
+      for (int div{1000}; div && appended < dscale; div /= 10, ++appended)
+        result += static_cast<char>('0' + d / div % 10);
+    }
+  }
+  return Numeric{std::move(result)};
+}
+
+/// The number of microseconds between the Unix and PostgreSQL epochs.
+constexpr std::int64_t pg_epoch_offset_us{946684800000000};
+
+/// The number of days between the Unix and PostgreSQL epochs.
+constexpr std::int32_t pg_epoch_offset_days{10957};
+
+/// The number of microseconds per day.
+constexpr std::int64_t us_per_day{86400000000};
+
+/// @returns The number of days since 1970-01-01 of the specified civil date.
+constexpr std::int64_t days_from_civil(std::int64_t y, const unsigned m,
+  const unsigned d) noexcept
+{
+  y -= m <= 2;
+  const std::int64_t era{(y >= 0 ? y : y - 399) / 400};
+  const auto yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy{(153*(m > 2 ? m - 3 : m + 9) + 2)/5 + d - 1};
+  const unsigned doe{yoe*365 + yoe/4 - yoe/100 + doy};
+  return era*146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+/// A civil date.
+struct Civil_date final {
+  std::int64_t year{};
+  unsigned month{};
+  unsigned day{};
+};
+
+/// @returns The civil date of the specified number of days since 1970-01-01.
+constexpr Civil_date civil_from_days(std::int64_t z) noexcept
+{
+  z += 719468;
+  const std::int64_t era{(z >= 0 ? z : z - 146096) / 146097};
+  const auto doe = static_cast<unsigned>(z - era * 146097);
+  const unsigned yoe{(doe - doe/1460 + doe/36524 - doe/146096) / 365};
+  const std::int64_t y{static_cast<std::int64_t>(yoe) + era * 400};
+  const unsigned doy{doe - (365*yoe + yoe/4 - yoe/100)};
+  const unsigned mp{(5*doy + 2)/153};
+  const unsigned d{doy - (153*mp + 2)/5 + 1};
+  const unsigned m{mp < 10 ? mp + 3 : mp - 9};
+  return {y + (m <= 2), m, d};
+}
+
+/**
+ * @returns The number of microseconds since the Unix epoch parsed from the
+ * text representation of `timestamp`, `timestamptz` or `date` in the ISO
+ * format, or `std::numeric_limits<std::int64_t>::max()` (`min()`) for
+ * `infinity` (`-infinity`).
+ *
+ * @remarks The value without the time zone is treated as UTC.
+ */
+inline std::int64_t timestamp_from_string(const std::string_view s)
+{
+  using Limits = std::numeric_limits<std::int64_t>;
+  if (s == "infinity")
+    return Limits::max();
+  else if (s == "-infinity")
+    return Limits::min();
+
+  static const auto throw_invalid = []
+  {
+    throw Client_exception{"cannot convert to time point: invalid text "
+      "representation"};
+  };
+
+  std::size_t pos{};
+  const auto number = [&s, &pos](const std::size_t min_width,
+    const std::size_t max_width)
+  {
+    std::int64_t result{};
+    std::size_t width{};
+    for (; pos < s.size() && width < max_width &&
+           '0' <= s[pos] && s[pos] <= '9'; ++pos, ++width)
+      result = result*10 + (s[pos] - '0');
+    if (width < min_width)
+      throw_invalid();
+    return result;
+  };
+  const auto expect = [&s, &pos](const char c)
+  {
+    if (!(pos < s.size() && s[pos] == c))
+      throw_invalid();
+    ++pos;
+  };
+
+  const auto year = number(4, 9);
+  expect('-');
+  const auto month = number(2, 2);
+  expect('-');
+  const auto day = number(2, 2);
+  if (!(1 <= month && month <= 12 && 1 <= day && day <= 31))
+    throw_invalid();
+  std::int64_t seconds{days_from_civil(year, static_cast<unsigned>(month),
+    static_cast<unsigned>(day)) * 86400};
+  std::int64_t us{};
+  if (pos < s.size()) {
+    if (s[pos] != ' ' && s[pos] != 'T')
+      throw_invalid();
+    ++pos;
+    const auto hour = number(2, 2);
+    expect(':');
+    const auto minute = number(2, 2);
+    expect(':');
+    const auto second = number(2, 2);
+    if (!(hour <= 24 && minute <= 59 && second <= 60))
+      throw_invalid();
+    seconds += hour*3600 + minute*60 + second;
+    if (pos < s.size() && s[pos] == '.') {
+      ++pos;
+      const auto start = pos;
+      us = number(1, 6);
+      for (auto w = pos - start; w < 6; ++w)
+        us *= 10;
+      while (pos < s.size() && '0' <= s[pos] && s[pos] <= '9')
+        ++pos; // ignore the digits beyond microseconds
+    }
+    if (pos < s.size()) {
+      if (s[pos] == 'Z')
+        ++pos;
+      else if (s[pos] == '+' || s[pos] == '-') {
+        const int sign{s[pos] == '-' ? -1 : 1};
+        ++pos;
+        auto offset = number(2, 2)*3600;
+        if (pos < s.size() && s[pos] == ':') {
+          ++pos;
+          offset += number(2, 2)*60;
+          if (pos < s.size() && s[pos] == ':') {
+            ++pos;
+            offset += number(2, 2);
+          }
+        }
+        seconds -= sign*offset;
+      }
+    }
+  }
+  if (pos != s.size())
+    throw_invalid(); // BC dates are not supported
+  return seconds*1000000 + us;
+}
+
+/**
+ * @returns The text representation of `timestamptz` of the specified number
+ * of microseconds since the Unix epoch.
+ */
+inline std::string timestamp_to_string(const std::int64_t us)
+{
+  using Limits = std::numeric_limits<std::int64_t>;
+  if (us == Limits::max())
+    return "infinity";
+  else if (us == Limits::min())
+    return "-infinity";
+
+  std::int64_t days{us / us_per_day};
+  std::int64_t rem{us % us_per_day};
+  if (rem < 0) {
+    rem += us_per_day;
+    --days;
+  }
+  const auto date = civil_from_days(days);
+  if (date.year < 1)
+    throw Client_exception{"cannot convert time point to text: years BC are "
+      "not supported"};
+  const auto secs = static_cast<long long>(rem / 1000000);
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%04lld-%02u-%02u %02lld:%02lld:%02lld.%06lld+00",
+    static_cast<long long>(date.year), date.month, date.day,
+    secs / 3600, secs / 60 % 60, secs % 60,
+    static_cast<long long>(rem % 1000000));
+  return buf;
+}
+
+} // namespace dmitigr::pgfe::detail
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for `std::vector<std::byte>`
+ * which represents a value of type `bytea`.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text (hex format only), Data_format::binary;
+ *   - output data - Data_format::binary, Data_format::text (hex format, if
+ *   `to_data(value, Data_format::text)` is called).
+ */
+template<>
+struct Conversions<std::vector<std::byte>> final {
+  using Type = std::vector<std::byte>;
+
+  /// The OID of `bytea`.
+  static constexpr Oid binary_oid{17};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    Type result(detail::bytea_size(data));
+    detail::copy_bytea(result.data(), data);
+    return result;
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to bytea: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(std::string_view{reinterpret_cast<const char*>(
+      value.data()), value.size()}, Data_format::binary);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::text)
+      return detail::to_hex_bytea_data(value.data(), value.size());
+    else
+      return to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Partial specialization of Conversions for `std::array<std::byte, N>`
+ * which represents a value of type `bytea` of fixed size.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text (hex format only), Data_format::binary;
+ *   - output data - Data_format::binary, Data_format::text (hex format, if
+ *   `to_data(value, Data_format::text)` is called).
+ *
+ * @par Requires
+ * The size of the input value must be exactly `N` bytes.
+ */
+template<std::size_t N>
+struct Conversions<std::array<std::byte, N>> final {
+  using Type = std::array<std::byte, N>;
+
+  /// The OID of `bytea`.
+  static constexpr Oid binary_oid{17};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    if (detail::bytea_size(data) != N)
+      throw Client_exception{"cannot convert to bytea: invalid input size"};
+    Type result;
+    detail::copy_bytea(result.data(), data);
+    return result;
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to bytea: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(std::string_view{reinterpret_cast<const char*>(
+      value.data()), value.size()}, Data_format::binary);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::text)
+      return detail::to_hex_bytea_data(value.data(), value.size());
+    else
+      return to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for Uuid.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called).
+ */
+template<>
+struct Conversions<Uuid> final {
+  using Type = Uuid;
+
+  /// The OID of `uuid`.
+  static constexpr Oid binary_oid{2950};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    if (data.format() == Data_format::binary) {
+      if (data.size() != 16)
+        throw Client_exception{"cannot convert to uuid: invalid input size"};
+      std::array<std::byte, 16> bytes;
+      std::memcpy(bytes.data(), data.bytes(), bytes.size());
+      return Type{bytes};
+    } else
+      return Type::from_string({static_cast<const char*>(data.bytes()),
+        data.size()});
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to uuid: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(value.to_string(), Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::binary)
+      return Data::make(std::string_view{reinterpret_cast<const char*>(
+        value.bytes().data()), value.bytes().size()}, Data_format::binary);
+    else
+      return to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for Numeric.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (if
+ *   `to_data(value, Data_format::binary)` is called).
+ */
+template<>
+struct Conversions<Numeric> final {
+  using Type = Numeric;
+
+  /// The OID of `numeric`.
+  static constexpr Oid binary_oid{1700};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    if (data.format() == Data_format::binary)
+      return detail::numeric_from_binary(data.bytes(), data.size());
+    else
+      return Type{std::string{static_cast<const char*>(data.bytes()),
+        data.size()}};
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to numeric: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(std::string_view{value.to_string()}, Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::binary)
+      return Data::make(detail::numeric_to_binary(value), Data_format::binary);
+    else
+      return to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Partial specialization of Conversions for time points of
+ * `std::chrono::system_clock`, which represent values of types `timestamptz`,
+ * `timestamp` (the value is treated as UTC) and `date` (input only).
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text (ISO format), Data_format::binary;
+ *   - output data - Data_format::text, Data_format::binary (`timestamptz`, if
+ *   `to_data(value, Data_format::binary)` is called).
+ *
+ * @remarks The values `infinity` and `-infinity` are represented by
+ * `Type::max()` and `Type::min()` accordingly.
+ */
+template<typename Duration>
+struct Conversions<std::chrono::time_point<std::chrono::system_clock, Duration>> final {
+  using Type = std::chrono::time_point<std::chrono::system_clock, Duration>;
+
+  /// The OID of `timestamptz`.
+  static constexpr Oid binary_oid{1184};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    using Limits = std::numeric_limits<std::int64_t>;
+    std::int64_t us{};
+    if (data.format() == Data_format::binary) {
+      if (data.size() == 8) {
+        us = net::conv<std::int64_t>(data.bytes(), data.size());
+        if (us != Limits::max() && us != Limits::min())
+          us += detail::pg_epoch_offset_us;
+      } else if (data.size() == 4) {
+        using Limits32 = std::numeric_limits<std::int32_t>;
+        const auto days = net::conv<std::int32_t>(data.bytes(), data.size());
+        if (days == Limits32::max())
+          us = Limits::max();
+        else if (days == Limits32::min())
+          us = Limits::min();
+        else
+          us = (static_cast<std::int64_t>(days) + detail::pg_epoch_offset_days)
+            * detail::us_per_day;
+      } else
+        throw Client_exception{"cannot convert to time point: invalid input size"};
+    } else
+      us = detail::timestamp_from_string({static_cast<const char*>(data.bytes()),
+        data.size()});
+
+    if (us == Limits::max())
+      return Type::max();
+    else if (us == Limits::min())
+      return Type::min();
+    else
+      return Type{std::chrono::duration_cast<Duration>(
+        std::chrono::microseconds{us})};
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to time point: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(detail::timestamp_to_string(to_us(value)),
+      Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::binary) {
+      using Limits = std::numeric_limits<std::int64_t>;
+      auto us = to_us(value);
+      if (us != Limits::max() && us != Limits::min())
+        us -= detail::pg_epoch_offset_us;
+      std::string result(sizeof(us), '\0');
+      net::copy(result.data(), us);
+      return Data::make(std::move(result), Data_format::binary);
+    } else
+      return to_data(value);
+  }
+
+private:
+  static std::int64_t to_us(const Type& value)
+  {
+    using Limits = std::numeric_limits<std::int64_t>;
+    if (value == Type::max())
+      return Limits::max();
+    else if (value == Type::min())
+      return Limits::min();
+    else
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+        value.time_since_epoch()).count();
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for Json_view.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary (both `json` and
+ *   `jsonb`);
+ *   - output data - Data_format::text, Data_format::binary (`jsonb`, if
+ *   `to_data(value, Data_format::binary)` is called).
+ *
+ * @par Zero-copy conversions
+ * The resulting views refer to the bytes of the converted data, and the data
+ * of Data_format::text format refers to the bytes of the view, just like the
+ * conversions of `std::string_view`.
+ */
+template<>
+struct Conversions<Json_view> final {
+  using Type = Json_view;
+
+  /// The OID of `jsonb`.
+  static constexpr Oid binary_oid{3802};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    return Type{detail::json_text(data)};
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to JSON: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type value, Types&& ...)
+  {
+    const auto text = value.to_string_view();
+    return Data::make_no_copy({text.data(), text.size()}, Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type value, const Data_format format)
+  {
+    if (format == Data_format::binary)
+      return detail::to_jsonb_data(value.to_string_view());
+    else
+      return to_data(value);
+  }
+};
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for Json.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary (both `json` and
+ *   `jsonb`);
+ *   - output data - Data_format::text, Data_format::binary (`jsonb`, if
+ *   `to_data(value, Data_format::binary)` is called).
+ */
+template<>
+struct Conversions<Json> final {
+  using Type = Json;
+
+  /// The OID of `jsonb`.
+  static constexpr Oid binary_oid{3802};
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    return Type{std::string{detail::json_text(data)}};
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to JSON: null data given"};
+    return to_type(*data);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(std::string_view{value.to_string()}, Data_format::text);
+  }
+
+  /// @returns The data of the specified `format`.
+  static std::unique_ptr<Data> to_data(const Type& value, const Data_format format)
+  {
+    if (format == Data_format::binary)
+      return detail::to_jsonb_data(value.to_string());
+    else
+      return to_data(value);
+  }
+};
+
+} // namespace dmitigr::pgfe
+
 #endif  // DMITIGR_PGFE_CONVERSIONS_HPP
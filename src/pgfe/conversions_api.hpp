@@ -17,7 +17,9 @@
 #ifndef DMITIGR_PGFE_CONVERSIONS_API_HPP
 #define DMITIGR_PGFE_CONVERSIONS_API_HPP
 
+#include "basics.hpp"
 #include "data.hpp"
+#include "metrics.hpp"
 #include "types_fwd.hpp"
 
 #include <memory>
@@ -61,6 +63,7 @@ namespace dmitigr::pgfe {
  *   static T to_type(std::unique_ptr<Data>&& data, Types&& ... args);       // 13
  *   static std::unique_ptr<Data> to_data(T&& value, Types&& ... args);      // 14
  *   static T to_type(Row&& row, Types&& ... args);                          // 15
+ *   static constexpr Oid binary_oid;                                        // 16
  * };
  * @endcode
  *
@@ -83,7 +86,11 @@ namespace dmitigr::pgfe {
  *
  *   - (5) and (15) are used when a value of type Row needs to be converted to
  *   the value of type `T`. These conversions might be used to convert an entire
- *   row from a server representation to a natural client representation.
+ *   row from a server representation to a natural client representation;
+ *
+ *   - (16) is the OID of the type of the data produced by
+ *   `to_data(value, Data_format::binary)`. It's used to specify the types of
+ *   the parameters bound in binary format (see binary_oid_v).
  *
  * Variadic arguments (args) are *optional* and may be used in cases when
  * some extra information (for example, a server version) need to be passed into
@@ -106,6 +113,38 @@ namespace dmitigr::pgfe {
  */
 template<typename> struct Conversions;
 
+/**
+ * @ingroup conversions
+ *
+ * @brief `true` if `T` is converted by the numeric specializations of
+ * Conversions (i.e. the numeric types except `char` and `bool`).
+ */
+template<typename T>
+constexpr bool is_numeric_conversions_v = std::is_same_v<T, short int> ||
+  std::is_same_v<T, int> || std::is_same_v<T, long int> ||
+  std::is_same_v<T, long long int> || std::is_same_v<T, float> ||
+  std::is_same_v<T, double> || std::is_same_v<T, long double>;
+
+namespace detail {
+template<typename T, typename = void>
+struct Binary_oid final : std::integral_constant<Oid, invalid_oid> {};
+
+template<typename T>
+struct Binary_oid<T, std::void_t<decltype(Conversions<T>::binary_oid)>> final
+  : std::integral_constant<Oid, Conversions<T>::binary_oid> {};
+} // namespace detail
+
+/**
+ * @ingroup conversions
+ *
+ * @brief The OID of the type of the data produced by
+ * `to_data(value, Data_format::binary)` for the values of type `T`, or
+ * `invalid_oid` if the specialization of Conversions for `T` doesn't defines
+ * `binary_oid`.
+ */
+template<typename T>
+constexpr Oid binary_oid_v = detail::Binary_oid<T>::value;
+
 /**
  * @ingroup conversions
  *
@@ -119,6 +158,8 @@ template<typename> struct Conversions;
 template<typename T, typename ... Types>
 inline T to(const Data& data, Types&& ... args)
 {
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return Conversions<T>::to_type(data, std::forward<Types>(args)...);
 }
 
@@ -133,6 +174,8 @@ inline T to(const Data& data, Types&& ... args)
 template<typename T, typename ... Types>
 inline T to(std::unique_ptr<Data>&& data, Types&& ... args)
 {
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return Conversions<T>::to_type(std::move(data), std::forward<Types>(args)...);
 }
 
@@ -154,6 +197,8 @@ inline T to(std::unique_ptr<Data>&& data, Types&& ... args)
 template<typename T, typename ... Types>
 inline T to(const Row& row, Types&& ... args)
 {
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return Conversions<T>::to_type(row, std::forward<Types>(args)...);
 }
 
@@ -168,6 +213,8 @@ inline T to(const Row& row, Types&& ... args)
 template<typename T, typename ... Types>
 inline T to(Row&& row, Types&& ... args)
 {
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return Conversions<T>::to_type(std::move(row), std::forward<Types>(args)...);
 }
 
@@ -187,6 +234,8 @@ template<typename T, typename ... Types>
 inline std::unique_ptr<Data> to_data(T&& value, Types&& ... args)
 {
   using U = std::decay_t<T>;
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return Conversions<U>::to_data(std::forward<T>(value),
     std::forward<Types>(args)...);
 }
@@ -195,6 +244,8 @@ inline std::unique_ptr<Data> to_data(T&& value, Types&& ... args)
 template<typename ... Types>
 inline std::unique_ptr<Data> to_data(const Data& value, Types&& ...)
 {
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::conversion};
   return value.to_data();
 }
 
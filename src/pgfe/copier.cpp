@@ -15,10 +15,15 @@
 // limitations under the License.
 
 #include "../base/assert.hpp"
+#include "../fsx/mapped_file.hpp"
 #include "connection.hpp"
 #include "copier.hpp"
 #include "exceptions.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <string>
+
 namespace dmitigr::pgfe {
 
 DMITIGR_PGFE_INLINE Copier::~Copier() noexcept
@@ -45,6 +50,7 @@ DMITIGR_PGFE_INLINE Copier::Copier(Connection& connection,
 DMITIGR_PGFE_INLINE Copier::Copier(Copier&& rhs) noexcept
   : connection_{std::move(rhs.connection_)}
   , pq_result_{std::move(rhs.pq_result_)}
+  , is_receive_done_{rhs.is_receive_done_}
 {}
 
 DMITIGR_PGFE_INLINE Copier& Copier::operator=(Copier&& rhs) noexcept
@@ -62,6 +68,7 @@ DMITIGR_PGFE_INLINE void Copier::swap(Copier& rhs) noexcept
   swap(connection_, rhs.connection_);
   swap(pq_result_, rhs.pq_result_);
   swap(buffer_, rhs.buffer_);
+  swap(is_receive_done_, rhs.is_receive_done_);
 }
 
 DMITIGR_PGFE_INLINE bool Copier::is_valid() const noexcept
@@ -87,6 +94,7 @@ DMITIGR_PGFE_INLINE Data_direction Copier::data_direction() const noexcept
   switch (pq_result_.status()) {
   case PGRES_COPY_IN: return Data_direction::to_server;
   case PGRES_COPY_OUT: return Data_direction::from_server;
+  case PGRES_COPY_BOTH: return Data_direction::both;
   default: break;
   }
   DMITIGR_ASSERT(false);
@@ -97,32 +105,79 @@ DMITIGR_PGFE_INLINE bool Copier::send(const std::string_view data) const
   check_send();
 
   const int r{PQputCopyData(connection().conn(), data.data(), static_cast<int>(data.size()))};
-  if (r == 0 || r == 1)
-    return r;
+  if (r == 1) {
+    (*connection_)->is_output_flushed_ = false;
+    return true;
+  } else if (r == 0)
+    return false;
   else if (r == -1)
     throw Client_exception{connection().error_message()};
 
   DMITIGR_ASSERT(false);
 }
 
+DMITIGR_PGFE_INLINE Socket_readiness
+Copier::send_nio(const std::string_view data) const
+{
+  return send(data) ? Socket_readiness::unready :
+    Socket_readiness::read_ready | Socket_readiness::write_ready;
+}
+
+DMITIGR_PGFE_INLINE std::uintmax_t
+Copier::send_file(const std::filesystem::path& path, const std::size_t chunk_size)
+{
+  check_send();
+  if (!chunk_size || chunk_size > INT_MAX)
+    throw Client_exception{"cannot COPY file to the server: invalid chunk size"};
+
+  const auto file = [&path]
+  {
+    try {
+      return fsx::Mapped_file{path};
+    } catch (const std::exception& e) {
+      throw Client_exception{std::string{"cannot map file to COPY: "}
+        + e.what()};
+    }
+  }();
+  file.advise(fsx::Mapped_file_advice::sequential);
+  for (std::size_t offset{}; offset < file.size();) {
+    const std::string_view chunk{file.data() + offset,
+      std::min(chunk_size, file.size() - offset)};
+    while (!send(chunk))
+      connection().flush_output(true);
+    offset += chunk.size();
+  }
+  return file.size();
+}
+
 DMITIGR_PGFE_INLINE bool Copier::end(const std::string& error_message) const
 {
   check_send();
 
   const int r{PQputCopyEnd(connection().conn(),
     !error_message.empty() ? error_message.c_str() : nullptr)};
-  if (r == 0 || r == 1) {
+  if (r == 1) {
     auto& conn = **connection_;
+    conn.is_output_flushed_ = !conn.is_nio_output_enabled();
     conn.reset_copier_state();
     DMITIGR_ASSERT(!is_valid());
     DMITIGR_ASSERT(!conn.is_copy_in_progress());
-    return r;
-  } else if (r == -1)
+    return true;
+  } else if (r == 0) // not queued, the copier is still valid to retry
+    return false;
+  else if (r == -1)
     throw Client_exception{connection().error_message()};
 
   DMITIGR_ASSERT(false);
 }
 
+DMITIGR_PGFE_INLINE Socket_readiness
+Copier::end_nio(const std::string& error_message) const
+{
+  return end(error_message) ? Socket_readiness::unready :
+    Socket_readiness::read_ready | Socket_readiness::write_ready;
+}
+
 DMITIGR_PGFE_INLINE Data_view Copier::receive(const bool wait) const
 {
   check_receive();
@@ -134,19 +189,76 @@ DMITIGR_PGFE_INLINE Data_view Copier::receive(const bool wait) const
     buffer_ = decltype(buffer_){buffer, &PQfreemem};
   DMITIGR_ASSERT(!buffer_ || size > 0);
 
+  // The response of START_REPLICATION has no fields.
+  const auto format = field_count() ? data_format(0) : Data_format::binary;
   if (size == -1)
     return Data_view{};
   else if (size == 0)
-    return Data_view{"", 0, data_format(0)};
+    return Data_view{"", 0, format};
   else if (size > 0)
-    return Data_view{buffer_.get(),
-      static_cast<std::size_t>(size), data_format(0)};
+    return Data_view{buffer_.get(), static_cast<std::size_t>(size), format};
   else if (size == -2)
     throw Client_exception{connection().error_message()};
 
   DMITIGR_ASSERT(false);
 }
 
+DMITIGR_PGFE_INLINE Socket_readiness Copier::receive_nio(Data_view& data) const
+{
+  auto result = receive(false);
+  if (result && !result.size())
+    return Socket_readiness::read_ready;
+
+  data = std::move(result);
+  return Socket_readiness::unready;
+}
+
+DMITIGR_PGFE_INLINE bool Copier::receive_batch(Batch& batch,
+  const std::size_t max_rows, const std::size_t max_bytes,
+  const bool wait) const
+{
+  check_receive();
+  if (!max_rows || !max_bytes)
+    throw Client_exception{"cannot COPY data from the server: "
+      "invalid batch limits"};
+
+  buffer_ = decltype(buffer_){nullptr, &dummy_free};
+  batch.clear();
+  // The response of START_REPLICATION has no fields.
+  batch.format_ = field_count() ? data_format(0) : Data_format::binary;
+  if (is_receive_done_)
+    return false;
+
+  auto* const conn = connection().conn();
+  for (bool is_async{!wait}; batch.offsets_.size() < max_rows &&
+         batch.data_.size() < max_bytes; is_async = true) {
+    char* buffer{};
+    const int size{PQgetCopyData(conn, &buffer, is_async)};
+    if (size > 0) {
+      const std::unique_ptr<char, void(*)(void*)> guard{buffer, &PQfreemem};
+      batch.data_.append(buffer, static_cast<std::size_t>(size));
+      batch.offsets_.push_back(batch.data_.size());
+    } else if (size == 0)
+      break; // no more buffered rows
+    else if (size == -1) {
+      is_receive_done_ = true;
+      break;
+    } else if (size == -2)
+      throw Client_exception{connection().error_message()};
+    else
+      DMITIGR_ASSERT(false);
+  }
+  return !is_receive_done_ || !batch.is_empty();
+}
+
+DMITIGR_PGFE_INLINE Data_view Copier::Batch::row(const std::size_t index) const
+{
+  if (!(index < row_count()))
+    throw Client_exception{"cannot get row of COPY batch: invalid index"};
+  const std::size_t begin{index ? offsets_[index - 1] : 0};
+  return Data_view{data_.data() + begin, offsets_[index] - begin, format_};
+}
+
 DMITIGR_PGFE_INLINE const Connection& Copier::connection() const
 {
   if (is_valid())
@@ -162,14 +274,14 @@ DMITIGR_PGFE_INLINE Connection& Copier::connection()
 
 void Copier::check_send() const
 {
-  if (data_direction() != Data_direction::to_server)
+  if (data_direction() == Data_direction::from_server)
     throw Client_exception{"cannot COPY data to the server: "
       "wrong data direction"};
 }
 
 void Copier::check_receive() const
 {
-  if (data_direction() != Data_direction::from_server)
+  if (data_direction() == Data_direction::to_server)
     throw Client_exception{"cannot COPY data from the server: "
       "wrong data direction"};
 }
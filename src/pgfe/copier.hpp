@@ -17,12 +17,19 @@
 #ifndef DMITIGR_PGFE_COPIER_HPP
 #define DMITIGR_PGFE_COPIER_HPP
 
+#include "basics.hpp"
 #include "data.hpp"
 #include "dll.hpp"
 #include "pq.hpp"
 #include "response.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace dmitigr::pgfe {
 
@@ -39,10 +46,93 @@ namespace dmitigr::pgfe {
  * Completion or Error. After that, the used Connection instance returns to
  * normal operation and can be used to issue further SQL commands.
  *
+ * The functions send_nio(), end_nio() and receive_nio() never block and
+ * return the readiness of the socket to wait for before the retry, so a lot
+ * of concurrent `COPY` streams can be driven by a single thread. For example:
+ * @code
+ * for (auto sr = copier.send_nio(data); sr != Socket_readiness::unready;
+ *   sr = copier.send_nio(data)) {
+ *   // Wait for `sr` by using an event loop, then:
+ *   if (!conn.flush_output() && ready_for_reading)
+ *     conn.read_input();
+ * }
+ * @endcode
+ * The output queued by these functions must be flushed by
+ * Connection::flush_output(), which should be retried when the socket becomes
+ * either read-ready (after calling Connection::read_input()) or write-ready
+ * until it returns `true`. (See also async_send(), async_end() and
+ * async_receive() of the coroutine layer.)
+ *
  * @see The <a href="https://www.postgresql.org/docs/current/static/sql-copy.html">SQL COPY command</a>.
  */
 class Copier final : public Response {
 public:
+  /**
+   * @brief A batch of data rows received by receive_batch().
+   *
+   * @details The rows are stored contiguously in a single buffer, which is
+   * reused by the subsequent calls of receive_batch(), so the whole batch can
+   * be written to the destination at once. For example:
+   * @code
+   * Copier::Batch batch;
+   * while (copier.receive_batch(batch, 4096, 1024 * 1024))
+   *   output.write(batch.data().data(), batch.data().size());
+   * @endcode
+   */
+  class Batch final {
+  public:
+    /// Constructs the empty batch.
+    Batch() = default;
+
+    /// @returns The number of rows.
+    std::size_t row_count() const noexcept
+    {
+      return offsets_.size();
+    }
+
+    /// @returns `!row_count()`.
+    bool is_empty() const noexcept
+    {
+      return offsets_.empty();
+    }
+
+    /// @returns The data of all the rows.
+    std::string_view data() const noexcept
+    {
+      return data_;
+    }
+
+    /**
+     * @returns The data of the row `index`.
+     *
+     * @par Requires
+     * `index < row_count()`.
+     *
+     * @remarks The data is not zero-terminated.
+     */
+    DMITIGR_PGFE_API Data_view row(std::size_t index) const;
+
+    /// @returns The format of the data.
+    Data_format data_format() const noexcept
+    {
+      return format_;
+    }
+
+    /// Removes all the rows but keeps the allocated memory.
+    void clear() noexcept
+    {
+      data_.clear();
+      offsets_.clear();
+    }
+
+  private:
+    friend Copier;
+
+    std::string data_;
+    std::vector<std::size_t> offsets_; // the end of each row
+    Data_format format_{Data_format::text};
+  };
+
   /**
    * @brief The destructor.
    *
@@ -98,7 +188,7 @@ public:
    * @brief Sends data to the server.
    *
    * @par Requires
-   * `data_direction() == Data_direction::to_server`.
+   * `data_direction() != Data_direction::from_server`.
    *
    * @returns `true` if the `data` was queued. Returns `false` if the output
    * buffers are full and needs to be flushed (it's possible only if
@@ -108,6 +198,36 @@ public:
    */
   DMITIGR_PGFE_API bool send(std::string_view data) const;
 
+  /// The default size of chunk to send the file by.
+  static constexpr std::size_t default_file_chunk_size{1024 * 1024};
+
+  /**
+   * @brief Sends the content of the file to the server.
+   *
+   * @details The file is memory-mapped and its pages are passed to send()
+   * directly in chunks of `chunk_size` bytes, so the content is neither read
+   * into intermediate buffers nor split on the row boundaries (which libpq
+   * doesn't requires). Thus, the file must contain the data of the format of
+   * the `COPY` command as is (for example, CSV or the binary `COPY` format
+   * including both the header and the trailer).
+   *
+   * @param path The path to the file.
+   * @param chunk_size The size of chunk.
+   *
+   * @par Requires
+   * `data_direction() != Data_direction::from_server &&
+   * chunk_size && chunk_size <= INT_MAX`.
+   *
+   * @returns The number of bytes sent.
+   *
+   * @remarks If Connection::is_nio_output_enabled() returns `true`, the output
+   * buffers are flushed each time they become full.
+   *
+   * @see end().
+   */
+  DMITIGR_PGFE_API std::uintmax_t send_file(const std::filesystem::path& path,
+    std::size_t chunk_size = default_file_chunk_size);
+
   /**
    * @brief Sends end-of-data indication to the server.
    *
@@ -115,7 +235,7 @@ public:
    * value of this parameter as the error message.
    *
    * @par Requires
-   * `data_direction() == Data_direction::to_server`.
+   * `data_direction() != Data_direction::from_server`.
    *
    * @returns `true` if either:
    *   - the indication was sent (Connection::is_nio_output_enabled()
@@ -131,11 +251,43 @@ public:
    */
   DMITIGR_PGFE_API bool end(const std::string& error_message = {}) const;
 
+  /**
+   * @brief Queues the data to be sent to the server without blocking.
+   *
+   * @par Requires
+   * `data_direction() != Data_direction::from_server` and
+   * Connection::is_nio_output_enabled() returns `true`.
+   *
+   * @returns Socket_readiness::unready if the `data` was queued. Otherwise,
+   * the readiness of the socket to wait for before flushing the output by
+   * Connection::flush_output() and retrying with the same `data`.
+   *
+   * @see send().
+   */
+  DMITIGR_PGFE_API Socket_readiness send_nio(std::string_view data) const;
+
+  /**
+   * @brief Queues the end-of-data indication to be sent to the server
+   * without blocking.
+   *
+   * @par Requires
+   * Same as for send_nio().
+   *
+   * @returns Socket_readiness::unready if the indication was queued (and
+   * `!is_valid()` in this case). Otherwise, the readiness of the socket to
+   * wait for before flushing the output by Connection::flush_output() and
+   * retrying.
+   *
+   * @see end().
+   */
+  DMITIGR_PGFE_API Socket_readiness
+  end_nio(const std::string& error_message = {}) const;
+
   /**
    * @brief Receives data from the server.
    *
    * @par Requires
-   * `data_direction() == Data_direction::from_server`.
+   * `data_direction() != Data_direction::to_server`.
    *
    * @returns Either:
    *   - invalid instance if the `COPY` command is done;
@@ -143,10 +295,61 @@ public:
    *   is yet available (this is only possible when `wait` is `false`);
    *   - the non-empty instance received from the server.
    *
-   *  @remarks The format of returned data is equals to `data_format(0)`.
+   *  @remarks The format of returned data is equals to `data_format(0)`, or to
+   *  Data_format::binary if `!field_count()` (`COPY BOTH` of replication).
    */
   DMITIGR_PGFE_API Data_view receive(bool wait = true) const;
 
+  /**
+   * @brief Receives data from the server without blocking.
+   *
+   * @param[out] data The result of `receive(false)` if no readiness of the
+   * socket to wait for is returned.
+   *
+   * @par Requires
+   * `data_direction() != Data_direction::to_server`.
+   *
+   * @returns Socket_readiness::read_ready if no row is yet available. In this
+   * case the caller should wait for the socket to be read-ready, call
+   * Connection::read_input() and retry. Otherwise, returns
+   * Socket_readiness::unready.
+   *
+   * @see receive().
+   */
+  DMITIGR_PGFE_API Socket_readiness receive_nio(Data_view& data) const;
+
+  /**
+   * @brief Receives the rows which are already buffered by libpq into the
+   * `batch`.
+   *
+   * @details The previous content of the `batch` is discarded. If `wait` is
+   * `true`, waits for the first row at first. Then the rows are taken without
+   * blocking until either there are no more buffered rows, or `max_rows` rows
+   * are received, or the size of the rows reaches `max_bytes`. Thus, the batch
+   * consists of the rows of at least one network read, so the overhead of
+   * receive() per row is amortized.
+   *
+   * @param batch The batch to store the rows to.
+   * @param max_rows The maximum number of rows.
+   * @param max_bytes The size of the rows upon reaching of which the
+   * receiving is stopped. (The last row can exceed this limit.)
+   * @param wait Whether to wait for the first row.
+   *
+   * @par Requires
+   * `data_direction() != Data_direction::to_server && max_rows && max_bytes`.
+   *
+   * @returns `false` if the `COPY` command is done and there are no rows
+   * received. (In particular, the empty batch and `true` are returned if no
+   * row is yet available and `wait` is `false`.)
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @see receive().
+   */
+  DMITIGR_PGFE_API bool receive_batch(Batch& batch, std::size_t max_rows,
+    std::size_t max_bytes, bool wait = true) const;
+
   /**
    * @returns The underlying connection instance.
    *
@@ -164,6 +367,7 @@ private:
   std::shared_ptr<Connection*> connection_;
   detail::pq::Result pq_result_;
   mutable std::unique_ptr<char, void(*)(void*)> buffer_{nullptr, &dummy_free};
+  mutable bool is_receive_done_{}; // the end of data is received by batch
 
   /// The constructor.
   explicit DMITIGR_PGFE_API Copier(Connection& connection,
@@ -0,0 +1,72 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "copier.hpp"
+#include "copy_binary_writer.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Copy_binary_writer::Copy_binary_writer(Copy_writer& writer)
+  : writer_{writer}
+  , field_count_{writer_.copier().field_count()}
+{
+  if (field_count_ && writer_.copier().data_format(0) != Data_format::binary)
+    throw Client_exception{"cannot create binary COPY writer: wrong data format"};
+}
+
+DMITIGR_PGFE_INLINE Copy_writer& Copy_binary_writer::writer() const noexcept
+{
+  return writer_;
+}
+
+DMITIGR_PGFE_INLINE bool
+Copy_binary_writer::write_encoded_row(const std::string_view row)
+{
+  if (row.size() < sizeof(std::int16_t) ||
+    net::conv<std::int16_t>(row.data(), sizeof(std::int16_t)) !=
+    static_cast<std::int16_t>(field_count_))
+    throw Client_exception{"cannot write encoded row of binary COPY: invalid "
+      "number of fields"};
+  write_header();
+  write(row);
+  return is_written_;
+}
+
+DMITIGR_PGFE_INLINE bool Copy_binary_writer::end(const std::string& error_message)
+{
+  if (error_message.empty() && !is_trailer_written_) {
+    write_header();
+    char trailer[sizeof(std::int16_t)];
+    net::copy(trailer, std::int16_t{-1});
+    write({trailer, sizeof(trailer)});
+    is_trailer_written_ = true;
+  }
+  return writer_.end(error_message);
+}
+
+DMITIGR_PGFE_INLINE void Copy_binary_writer::write_header()
+{
+  if (is_header_written_)
+    return;
+
+  // The signature, the flags field and the length of header extension area.
+  static constexpr char header[]{'P', 'G', 'C', 'O', 'P', 'Y', '\n', '\377',
+    '\r', '\n', '\0', 0, 0, 0, 0, 0, 0, 0, 0};
+  write({header, sizeof(header)});
+  is_header_written_ = true;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,230 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COPY_BINARY_WRITER_HPP
+#define DMITIGR_PGFE_COPY_BINARY_WRITER_HPP
+
+#include "../net/conversions.hpp"
+#include "conversions.hpp"
+#include "copy_writer.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A writer of the data of `COPY FROM STDIN (FORMAT binary)` command.
+ *
+ * @details Writes the rows in the binary format of `COPY` (the header, the
+ * tuples of length-prefixed fields and the trailer) into Copy_writer, so the
+ * values are never formatted as text and the server never parses them. The
+ * fields are encoded as follows:
+ *   - `std::nullptr_t`, `std::nullopt_t` or empty `std::optional` - `NULL`;
+ *   - `bool` - `boolean`;
+ *   - integer types - `int2`, `int4` or `int8` according to the size;
+ *   - floating point types - `float4` or `float8` according to the size;
+ *   - strings - as is (which is suitable for `text`, `varchar`, `bytea` etc);
+ *   - Data - as is;
+ *   - other types - by using `to_data(value, Data_format::binary)`.
+ *
+ * @remarks The types of the values must match the types of the columns.
+ *
+ * @see The <a href="https://www.postgresql.org/docs/current/sql-copy.html#id-1.9.3.55.9.4">binary format of COPY</a>.
+ */
+class Copy_binary_writer final {
+public:
+  /**
+   * @brief The constructor.
+   *
+   * @param writer The writer to write the data to. It must outlive this
+   * instance.
+   *
+   * @par Requires
+   * `writer.copier().data_format(0) == Data_format::binary`.
+   */
+  DMITIGR_PGFE_API explicit Copy_binary_writer(Copy_writer& writer);
+
+  /// Not copy-constructible.
+  Copy_binary_writer(const Copy_binary_writer&) = delete;
+
+  /// Not copy-assignable.
+  Copy_binary_writer& operator=(const Copy_binary_writer&) = delete;
+
+  /// Not move-constructible.
+  Copy_binary_writer(Copy_binary_writer&&) = delete;
+
+  /// Not move-assignable.
+  Copy_binary_writer& operator=(Copy_binary_writer&&) = delete;
+
+  /// @returns The writer.
+  DMITIGR_PGFE_API Copy_writer& writer() const noexcept;
+
+  /**
+   * @brief Writes the row of the specified `values`.
+   *
+   * @par Requires
+   * `sizeof...(values) == writer().copier().field_count()`.
+   *
+   * @returns The value returned by the last call of Copy_writer::write().
+   */
+  template<typename ... Types>
+  bool write_row(const Types& ... values)
+  {
+    if (sizeof...(values) != field_count_)
+      throw Client_exception{"cannot write row of binary COPY: invalid number "
+        "of fields"};
+    write_header();
+    write_tuple([this](const std::string_view data){write(data);}, values...);
+    return is_written_;
+  }
+
+  /**
+   * @brief Appends the row of the specified `values` encoded as by write_row()
+   * to `result`.
+   *
+   * @details This is useful to encode the rows in advance (for example, in
+   * the threads other than the one which owns the connection) and to write
+   * them later by write_encoded_row().
+   */
+  template<typename ... Types>
+  static void encode_row(std::string& result, const Types& ... values)
+  {
+    write_tuple([&result](const std::string_view data){result.append(data);},
+      values...);
+  }
+
+  /**
+   * @brief Writes the row encoded by encode_row().
+   *
+   * @par Requires
+   * The number of fields of `row` must be equal to
+   * `writer().copier().field_count()`.
+   *
+   * @returns The value returned by the last call of Copy_writer::write().
+   */
+  DMITIGR_PGFE_API bool write_encoded_row(std::string_view row);
+
+  /**
+   * @brief Writes the trailer and calls Copy_writer::end().
+   *
+   * @details The trailer is written only once, so this function can be called
+   * again if it returned `false`.
+   *
+   * @see Copy_writer::end().
+   */
+  DMITIGR_PGFE_API bool end(const std::string& error_message = {});
+
+private:
+  Copy_writer& writer_;
+  std::size_t field_count_{};
+  bool is_header_written_{};
+  bool is_trailer_written_{};
+  bool is_written_{true};
+
+  DMITIGR_PGFE_API void write_header();
+
+  void write(const std::string_view data)
+  {
+    is_written_ = writer_.write(data);
+  }
+
+  template<class Sink, typename ... Types>
+  static void write_tuple(const Sink& sink, const Types& ... values)
+  {
+    char count[sizeof(std::int16_t)];
+    net::copy(count, static_cast<std::int16_t>(sizeof...(values)));
+    sink({count, sizeof(count)});
+    (write_field(sink, values), ...);
+  }
+
+  template<class Sink>
+  static void write_length(const Sink& sink, const std::int32_t length)
+  {
+    char bytes[sizeof(length)];
+    net::copy(bytes, length);
+    sink({bytes, sizeof(bytes)});
+  }
+
+  template<class Sink>
+  static void write_bytes(const Sink& sink, const void* const bytes,
+    const std::size_t size)
+  {
+    if (size > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+      throw Client_exception{"cannot write field of binary COPY: too long"};
+    write_length(sink, static_cast<std::int32_t>(size));
+    sink({static_cast<const char*>(bytes), size});
+  }
+
+  template<class Sink, typename T>
+  static void write_field(const Sink& sink, const T& value)
+  {
+    if constexpr (std::is_same_v<T, std::nullptr_t> ||
+      std::is_same_v<T, std::nullopt_t>) {
+      write_length(sink, -1);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      const char byte(value ? 1 : 0);
+      write_bytes(sink, &byte, 1);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      static_assert(sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+        "unsupported size of numeric type");
+      char bytes[sizeof(T)];
+      net::copy(bytes, value);
+      write_bytes(sink, bytes, sizeof(bytes));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+      const std::string_view str{value};
+      write_bytes(sink, str.data(), str.size());
+    } else if constexpr (std::is_base_of_v<Data, T>) {
+      if (value)
+        write_bytes(sink, value.bytes(), value.size());
+      else
+        write_length(sink, -1);
+    } else if constexpr (detail::Is_optional<T>::value) {
+      if (value)
+        write_field(sink, *value);
+      else
+        write_length(sink, -1);
+    } else {
+      const auto data = to_data(value, Data_format::binary);
+      if (!data)
+        write_length(sink, -1);
+      else if (data->format() != Data_format::binary)
+        throw Client_exception{"cannot write field of binary COPY: "
+          "conversion to binary format is not supported"};
+      else
+        write_bytes(sink, data->bytes(), data->size());
+    }
+  }
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "copy_binary_writer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_COPY_BINARY_WRITER_HPP
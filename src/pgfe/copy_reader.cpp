@@ -0,0 +1,305 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../net/conversions.hpp"
+#include "copier.hpp"
+#include "copy_reader.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+[[noreturn]] inline void throw_malformed_copy_data()
+{
+  throw Client_exception{"cannot read COPY data: malformed row"};
+}
+
+/// @returns The value of the hex digit `c`, or `-1` if `c` is not hex digit.
+inline int copy_hex_digit(const char c) noexcept
+{
+  if ('0' <= c && c <= '9')
+    return c - '0';
+  else if ('a' <= c && c <= 'f')
+    return c - 'a' + 10;
+  else if ('A' <= c && c <= 'F')
+    return c - 'A' + 10;
+  else
+    return -1;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Copy_reader::Copy_reader(Copier& copier)
+  : Copy_reader{copier, copier && copier.field_count() &&
+      copier.data_format(0) == Data_format::binary ? Format::binary : Format::text}
+{}
+
+DMITIGR_PGFE_INLINE Copy_reader::Copy_reader(Copier& copier,
+  const Format format, const char delimiter)
+  : copier_{copier}
+  , format_{format}
+  , delimiter_{delimiter ? delimiter : format == Format::csv ? ',' : '\t'}
+{
+  if (!copier_)
+    throw Client_exception{"cannot create COPY reader: invalid copier"};
+  else if (copier_.data_direction() != Data_direction::from_server)
+    throw Client_exception{"cannot create COPY reader: wrong data direction"};
+  else if (copier_.field_count() && ((format_ == Format::binary) !=
+      (copier_.data_format(0) == Data_format::binary)))
+    throw Client_exception{"cannot create COPY reader: wrong data format"};
+
+  fields_.reserve(copier_.field_count());
+}
+
+DMITIGR_PGFE_INLINE Copier& Copy_reader::copier() const noexcept
+{
+  return copier_;
+}
+
+DMITIGR_PGFE_INLINE auto Copy_reader::format() const noexcept -> Format
+{
+  return format_;
+}
+
+DMITIGR_PGFE_INLINE char Copy_reader::delimiter() const noexcept
+{
+  return delimiter_;
+}
+
+DMITIGR_PGFE_INLINE bool Copy_reader::read(const bool wait)
+{
+  fields_.clear(); // the capacity is kept
+  while (!is_done_) {
+    const auto data = copier_.receive(wait);
+    if (!data) {
+      is_done_ = true;
+      break;
+    } else if (!data.size())
+      break;
+
+    /*
+     * The buffer is allocated by libpq, owned by the copier and is never
+     * used by it until the next call of Copier::receive(). Therefore, it's
+     * safe to decode the data in place.
+     */
+    auto* const bytes = const_cast<char*>(static_cast<const char*>(data.bytes()));
+    switch (format_) {
+    case Format::text:
+      parse_text(bytes, data.size());
+      break;
+    case Format::csv:
+      parse_csv(bytes, data.size());
+      break;
+    case Format::binary:
+      if (!parse_binary(bytes, data.size()))
+        continue; // the trailer is read
+      break;
+    }
+    if (fields_.size() != copier_.field_count())
+      throw Client_exception{"cannot read COPY data: unexpected field count"};
+    return true;
+  }
+  return false;
+}
+
+DMITIGR_PGFE_INLINE bool Copy_reader::is_done() const noexcept
+{
+  return is_done_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Copy_reader::field_count() const noexcept
+{
+  return fields_.size();
+}
+
+DMITIGR_PGFE_INLINE Data_view Copy_reader::field(const std::size_t index) const
+{
+  if (!(index < field_count()))
+    throw Client_exception{"cannot get field of COPY row: invalid field index"};
+  return fields_[index];
+}
+
+DMITIGR_PGFE_INLINE void Copy_reader::parse_text(char* const data,
+  std::size_t size)
+{
+  if (size && data[size - 1] == '\n')
+    --size;
+  if (!size && !copier_.field_count())
+    return;
+
+  // Note, that `*end` is either '\n' or '\0' appended by libpq.
+  char* const end{data + size};
+  char* p{data};
+  while (true) {
+    char* const begin{p};
+    char* w{p};
+    bool is_null{};
+    for (; p != end && *p != delimiter_; ++p) {
+      if (*p != '\\') {
+        *w++ = *p;
+        continue;
+      } else if (++p == end)
+        detail::throw_malformed_copy_data();
+
+      switch (*p) {
+      case 'N': is_null = true; break;
+      case 'b': *w++ = '\b'; break;
+      case 'f': *w++ = '\f'; break;
+      case 'n': *w++ = '\n'; break;
+      case 'r': *w++ = '\r'; break;
+      case 't': *w++ = '\t'; break;
+      case 'v': *w++ = '\v'; break;
+      case 'x':
+        if (p + 1 != end && detail::copy_hex_digit(p[1]) >= 0) {
+          int value{detail::copy_hex_digit(*++p)};
+          if (p + 1 != end && detail::copy_hex_digit(p[1]) >= 0)
+            value = value * 16 + detail::copy_hex_digit(*++p);
+          *w++ = static_cast<char>(value);
+        } else
+          *w++ = 'x';
+        break;
+      default:
+        if ('0' <= *p && *p <= '7') {
+          int value{*p - '0'};
+          for (int i{}; i < 2 && p + 1 != end && '0' <= p[1] && p[1] <= '7'; ++i)
+            value = value * 8 + (*++p - '0');
+          *w++ = static_cast<char>(value);
+        } else
+          *w++ = *p;
+      }
+    }
+    if (is_null && p - begin != 2)
+      detail::throw_malformed_copy_data();
+
+    const bool is_last{p == end};
+    *w = '\0'; // `w <= p`
+    if (is_null)
+      fields_.emplace_back();
+    else
+      fields_.emplace_back(begin, static_cast<std::size_t>(w - begin));
+    if (is_last)
+      break;
+    ++p;
+  }
+}
+
+DMITIGR_PGFE_INLINE void Copy_reader::parse_csv(char* const data,
+  std::size_t size)
+{
+  if (size && data[size - 1] == '\n')
+    --size;
+  if (!size && !copier_.field_count())
+    return;
+
+  char* const end{data + size};
+  char* p{data};
+  while (true) {
+    char* const begin{p};
+    char* w{p};
+    const bool is_quoted{p != end && *p == '"'};
+    if (is_quoted) {
+      for (++p;; ++p) {
+        if (p == end)
+          detail::throw_malformed_copy_data();
+        else if (*p == '"') {
+          if (p + 1 != end && p[1] == '"')
+            ++p;
+          else {
+            ++p;
+            break;
+          }
+        }
+        *w++ = *p;
+      }
+    }
+    for (; p != end && *p != delimiter_; ++p)
+      *w++ = *p;
+
+    const bool is_last{p == end};
+    *w = '\0'; // `w <= p`
+    if (!is_quoted && w == begin)
+      fields_.emplace_back();
+    else
+      fields_.emplace_back(begin, static_cast<std::size_t>(w - begin));
+    if (is_last)
+      break;
+    ++p;
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Copy_reader::parse_binary(const char* const data,
+  const std::size_t size)
+{
+  const char* p{data};
+  const char* const end{data + size};
+  const auto check_size = [&p, end](const std::size_t sz)
+  {
+    if (static_cast<std::size_t>(end - p) < sz)
+      detail::throw_malformed_copy_data();
+  };
+  const auto read_int32 = [&p, &check_size]
+  {
+    check_size(sizeof(std::int32_t));
+    const auto result = net::conv<std::int32_t>(p, sizeof(std::int32_t));
+    p += sizeof(std::int32_t);
+    return result;
+  };
+
+  // The header is the prefix of the first row.
+  if (!is_header_read_) {
+    static constexpr char signature[]{'P', 'G', 'C', 'O', 'P', 'Y', '\n',
+      '\377', '\r', '\n', '\0'};
+    check_size(sizeof(signature));
+    if (std::memcmp(p, signature, sizeof(signature)))
+      throw Client_exception{"cannot read COPY data: invalid binary header"};
+    p += sizeof(signature);
+    read_int32(); // the flags field
+    const auto extension_size = read_int32();
+    if (extension_size < 0)
+      detail::throw_malformed_copy_data();
+    check_size(static_cast<std::size_t>(extension_size));
+    p += extension_size;
+    is_header_read_ = true;
+  }
+
+  check_size(sizeof(std::int16_t));
+  const auto field_count = net::conv<std::int16_t>(p, sizeof(std::int16_t));
+  p += sizeof(std::int16_t);
+  if (field_count == -1)
+    return false; // the trailer
+  else if (field_count < 0)
+    detail::throw_malformed_copy_data();
+
+  for (std::int16_t i{}; i < field_count; ++i) {
+    const auto field_size = read_int32();
+    if (field_size == -1)
+      fields_.emplace_back();
+    else if (field_size < 0)
+      detail::throw_malformed_copy_data();
+    else {
+      check_size(static_cast<std::size_t>(field_size));
+      fields_.emplace_back(p, static_cast<std::size_t>(field_size),
+        Data_format::binary);
+      p += field_size;
+    }
+  }
+  return true;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,178 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COPY_READER_HPP
+#define DMITIGR_PGFE_COPY_READER_HPP
+
+#include "conversions.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A streaming reader of the data of `COPY TO STDOUT` command.
+ *
+ * @details Each row received by Copier::receive() is parsed in place, i.e.
+ * the fields are views of the buffer of libpq, which is valid until the next
+ * call of read(). The escape sequences of the text format and the doubled
+ * quotes of the CSV format are decoded in place as well, since the decoded
+ * value is never longer than the encoded one. Thus, the row bytes are never
+ * copied.
+ *
+ * @remarks Only the default `NULL`, `QUOTE` and `ESCAPE` options of the
+ * `COPY` command are supported.
+ *
+ * @see Copier.
+ */
+class Copy_reader final {
+public:
+  /// A format of the data.
+  enum class Format {
+    /// The text format.
+    text,
+    /// The CSV format.
+    csv,
+    /// The binary format.
+    binary
+  };
+
+  /// The destructor.
+  ~Copy_reader() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param copier The copier to receive the data by. It must outlive the
+   * reader.
+   *
+   * @details The format is either Format::text or Format::binary depending
+   * on `copier.data_format(0)`.
+   *
+   * @par Requires
+   * `copier.data_direction() == Data_direction::from_server`.
+   */
+  DMITIGR_PGFE_API explicit Copy_reader(Copier& copier);
+
+  /**
+   * @overload
+   *
+   * @param format The format of the data.
+   * @param delimiter The delimiter of the fields. If `0`, the default one of
+   * the `format` is used (tab for the text format and comma for the CSV).
+   *
+   * @par Requires
+   * `(format == Format::binary) == (copier.data_format(0) == Data_format::binary)`.
+   */
+  DMITIGR_PGFE_API Copy_reader(Copier& copier, Format format,
+    char delimiter = 0);
+
+  /// Not copy-constructible.
+  Copy_reader(const Copy_reader&) = delete;
+
+  /// Not copy-assignable.
+  Copy_reader& operator=(const Copy_reader&) = delete;
+
+  /// Not move-constructible.
+  Copy_reader(Copy_reader&&) = delete;
+
+  /// Not move-assignable.
+  Copy_reader& operator=(Copy_reader&&) = delete;
+
+  /// @returns The copier.
+  DMITIGR_PGFE_API Copier& copier() const noexcept;
+
+  /// @returns The format of the data.
+  DMITIGR_PGFE_API Format format() const noexcept;
+
+  /// @returns The delimiter of the fields of the text and CSV formats.
+  DMITIGR_PGFE_API char delimiter() const noexcept;
+
+  /**
+   * @brief Receives and parses the next row.
+   *
+   * @par Effects
+   * Invalidates the fields of the previous row.
+   *
+   * @returns `true` if the row is read. Returns `false` if either
+   * `is_done()`, or no row is yet available (this is only possible when
+   * `wait` is `false`).
+   *
+   * @throws Client_exception if the received row is malformed.
+   *
+   * @see Copier::receive().
+   */
+  DMITIGR_PGFE_API bool read(bool wait = true);
+
+  /// @returns `true` if the `COPY` command is done.
+  DMITIGR_PGFE_API bool is_done() const noexcept;
+
+  /// @returns The number of fields of the current row.
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept;
+
+  /**
+   * @returns The field of the current row, or invalid instance if the field
+   * is `NULL`.
+   *
+   * @par Requires
+   * `index < field_count()`.
+   *
+   * @remarks Fields of the text and CSV formats are always zero-terminated.
+   */
+  DMITIGR_PGFE_API Data_view field(std::size_t index) const;
+
+  /**
+   * @returns The field of the current row converted to the type `T`.
+   *
+   * @par Requires
+   * `index < field_count()`.
+   *
+   * @see field().
+   */
+  template<typename T, typename ... Types>
+  T get(const std::size_t index, Types&& ... args) const
+  {
+    return to<T>(field(index), std::forward<Types>(args)...);
+  }
+
+private:
+  Copier& copier_;
+  Format format_{};
+  char delimiter_{};
+  bool is_done_{};
+  bool is_header_read_{};
+  std::vector<Data_view> fields_;
+
+  void parse_text(char* data, std::size_t size);
+  void parse_csv(char* data, std::size_t size);
+  bool parse_binary(const char* data, std::size_t size);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "copy_reader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_COPY_READER_HPP
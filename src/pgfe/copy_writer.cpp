@@ -0,0 +1,79 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "copier.hpp"
+#include "copy_writer.hpp"
+#include "exceptions.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Copy_writer::Copy_writer(Copier& copier,
+  const std::size_t buffer_capacity)
+  : copier_{copier}
+  , buffer_capacity_{buffer_capacity}
+{
+  if (!copier_)
+    throw Client_exception{"cannot create COPY writer: invalid copier"};
+  else if (copier_.data_direction() != Data_direction::to_server)
+    throw Client_exception{"cannot create COPY writer: wrong data direction"};
+  else if (!buffer_capacity_)
+    throw Client_exception{"cannot create COPY writer: invalid buffer capacity"};
+
+  buffer_.reserve(buffer_capacity_);
+}
+
+DMITIGR_PGFE_INLINE Copier& Copy_writer::copier() const noexcept
+{
+  return copier_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Copy_writer::buffer_capacity() const noexcept
+{
+  return buffer_capacity_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Copy_writer::buffered_size() const noexcept
+{
+  return buffer_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Copy_writer::write(const std::string_view data)
+{
+  buffer_.append(data);
+  return buffer_.size() < buffer_capacity_ || flush();
+}
+
+DMITIGR_PGFE_INLINE bool Copy_writer::flush()
+{
+  if (buffer_.empty())
+    return true;
+  else if (!copier_.send(buffer_))
+    return false;
+
+  buffer_.clear(); // the capacity is kept
+  return true;
+}
+
+DMITIGR_PGFE_INLINE bool Copy_writer::end(const std::string& error_message)
+{
+  if (error_message.empty() && !flush())
+    return false;
+
+  buffer_.clear();
+  return copier_.end(error_message);
+}
+
+} // namespace dmitigr::pgfe
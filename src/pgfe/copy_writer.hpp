@@ -0,0 +1,135 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COPY_WRITER_HPP
+#define DMITIGR_PGFE_COPY_WRITER_HPP
+
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A buffered writer of the data of `COPY FROM STDIN` command.
+ *
+ * @details The written data is accumulated in the reusable buffer which is
+ * sent to the server by Copier::send() when its size reaches the capacity,
+ * so the number of calls to libpq is reduced dramatically when sending a lot
+ * of small rows.
+ *
+ * @remarks If Connection::is_nio_output_enabled() returns `true`, write(),
+ * flush() and end() may return `false` to indicate that the output buffers
+ * of the connection are full. In this case the written data is kept in the
+ * buffer and the caller should call Connection::flush_output() (for example,
+ * when the socket becomes write-ready) and retry flush() or end().
+ *
+ * @see Copier.
+ */
+class Copy_writer final {
+public:
+  /// The default capacity of the buffer.
+  static constexpr std::size_t default_buffer_capacity{256 * 1024};
+
+  /**
+   * @brief The destructor.
+   *
+   * @warning Neither flushes the buffer nor calls end()!
+   */
+  ~Copy_writer() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param copier The copier to send the data by. It must outlive the writer.
+   * @param buffer_capacity The capacity of the buffer.
+   *
+   * @par Requires
+   * `copier.data_direction() == Data_direction::to_server && buffer_capacity`.
+   */
+  DMITIGR_PGFE_API explicit Copy_writer(Copier& copier,
+    std::size_t buffer_capacity = default_buffer_capacity);
+
+  /// Not copy-constructible.
+  Copy_writer(const Copy_writer&) = delete;
+
+  /// Not copy-assignable.
+  Copy_writer& operator=(const Copy_writer&) = delete;
+
+  /// Not move-constructible.
+  Copy_writer(Copy_writer&&) = delete;
+
+  /// Not move-assignable.
+  Copy_writer& operator=(Copy_writer&&) = delete;
+
+  /// @returns The copier.
+  DMITIGR_PGFE_API Copier& copier() const noexcept;
+
+  /// @returns The capacity of the buffer.
+  DMITIGR_PGFE_API std::size_t buffer_capacity() const noexcept;
+
+  /// @returns The number of buffered bytes.
+  DMITIGR_PGFE_API std::size_t buffered_size() const noexcept;
+
+  /**
+   * @brief Appends the `data` to the buffer and flushes the buffer if its
+   * size reaches the capacity.
+   *
+   * @details The `data` is always appended to the buffer.
+   *
+   * @returns `false` if the buffer should be flushed but the output buffers
+   * of the connection are full.
+   *
+   * @see flush().
+   */
+  DMITIGR_PGFE_API bool write(std::string_view data);
+
+  /**
+   * @brief Sends the buffered data by using Copier::send().
+   *
+   * @returns `false` if the output buffers of the connection are full. The
+   * buffered data is kept in this case.
+   */
+  DMITIGR_PGFE_API bool flush();
+
+  /**
+   * @brief Flushes the buffer and calls Copier::end().
+   *
+   * @returns `false` if either the buffer is not flushed or Copier::end()
+   * returned `false`.
+   *
+   * @see Copier::end().
+   */
+  DMITIGR_PGFE_API bool end(const std::string& error_message = {});
+
+private:
+  Copier& copier_;
+  std::size_t buffer_capacity_{};
+  std::string buffer_;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "copy_writer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_COPY_WRITER_HPP
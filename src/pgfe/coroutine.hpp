@@ -0,0 +1,508 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_COROUTINE_HPP
+#define DMITIGR_PGFE_COROUTINE_HPP
+
+#if __cplusplus < 202002L || !__has_include(<coroutine>)
+#error dmitigr_pgfe: coroutine.hpp requires C++20 coroutines
+#endif
+
+#include "connection.hpp"
+#include "copier.hpp"
+#include "exceptions.hpp"
+#include "reactor.hpp"
+#include "statement.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+template<typename> class Task;
+
+namespace detail {
+
+/// The awaiter of the final suspend point of Task which resumes the awaiter.
+struct Task_final_awaiter final {
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  template<class P>
+  std::coroutine_handle<> await_suspend(const std::coroutine_handle<P> handle)
+    const noexcept
+  {
+    const auto continuation = handle.promise().continuation_;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept
+  {}
+};
+
+/// The base of promise types of Task.
+class Basic_task_promise {
+public:
+  std::suspend_always initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  Task_final_awaiter final_suspend() const noexcept
+  {
+    return {};
+  }
+
+  void unhandled_exception() noexcept
+  {
+    exception_ = std::current_exception();
+  }
+
+  std::coroutine_handle<> continuation_;
+  std::exception_ptr exception_;
+};
+
+/// The promise type of Task which returns a value.
+template<typename T>
+class Task_promise final : public Basic_task_promise {
+public:
+  Task<T> get_return_object() noexcept;
+
+  template<typename U>
+  void return_value(U&& value)
+  {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T result()
+  {
+    if (exception_)
+      std::rethrow_exception(exception_);
+    return std::move(*value_);
+  }
+
+private:
+  std::optional<T> value_;
+};
+
+/// The promise type of Task which returns nothing.
+template<>
+class Task_promise<void> final : public Basic_task_promise {
+public:
+  Task<void> get_return_object() noexcept;
+
+  void return_void() const noexcept
+  {}
+
+  void result()
+  {
+    if (exception_)
+      std::rethrow_exception(exception_);
+  }
+};
+
+} // namespace detail
+
+/**
+ * @ingroup main
+ *
+ * @brief A lazily started coroutine.
+ *
+ * @details The coroutine starts either when the task is awaited by another
+ * coroutine, or when start() is called.
+ */
+template<typename T = void>
+class Task final {
+public:
+  /// The promise type.
+  using promise_type = detail::Task_promise<T>;
+
+  /// Not copy-constructible.
+  Task(const Task&) = delete;
+
+  /// Not copy-assignable.
+  Task& operator=(const Task&) = delete;
+
+  /// Move-constructible.
+  Task(Task&& rhs) noexcept
+    : handle_{std::exchange(rhs.handle_, {})}
+  {}
+
+  /// Move-assignable.
+  Task& operator=(Task&& rhs) noexcept
+  {
+    if (this != &rhs) {
+      Task tmp{std::move(rhs)};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// The destructor.
+  ~Task()
+  {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  /// Swaps this instance with `rhs`.
+  void swap(Task& rhs) noexcept
+  {
+    std::swap(handle_, rhs.handle_);
+  }
+
+  /**
+   * @brief Starts the coroutine which runs until the first suspension.
+   *
+   * @par Requires
+   * The coroutine is not started.
+   */
+  void start()
+  {
+    handle_.resume();
+  }
+
+  /// @returns `true` if the coroutine is finished.
+  bool is_done() const noexcept
+  {
+    return handle_.done();
+  }
+
+  /**
+   * @returns The result of the coroutine.
+   *
+   * @par Requires
+   * `is_done()`.
+   *
+   * @throws The exception thrown by the coroutine if any.
+   */
+  T result()
+  {
+    return handle_.promise().result();
+  }
+
+  /// @name Awaitable
+  /// @{
+
+  bool await_ready() const noexcept
+  {
+    return handle_.done();
+  }
+
+  std::coroutine_handle<>
+  await_suspend(const std::coroutine_handle<> continuation) noexcept
+  {
+    handle_.promise().continuation_ = continuation;
+    return handle_;
+  }
+
+  T await_resume()
+  {
+    return handle_.promise().result();
+  }
+
+  /// @}
+
+private:
+  friend promise_type;
+
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(const std::coroutine_handle<promise_type> handle) noexcept
+    : handle_{handle}
+  {}
+};
+
+namespace detail {
+
+template<typename T>
+inline Task<T> Task_promise<T>::get_return_object() noexcept
+{
+  return Task<T>{std::coroutine_handle<Task_promise>::from_promise(*this)};
+}
+
+inline Task<void> Task_promise<void>::get_return_object() noexcept
+{
+  return Task<void>{std::coroutine_handle<Task_promise>::from_promise(*this)};
+}
+
+} // namespace detail
+
+/**
+ * @ingroup main
+ *
+ * @brief An awaitable which suspends the coroutine until the socket becomes
+ * ready.
+ *
+ * @details The result of `co_await` is the actual readiness of the socket.
+ */
+class Socket_readiness_awaitable final {
+public:
+  /// The constructor.
+  Socket_readiness_awaitable(Reactor& reactor, const int socket,
+    const Socket_readiness mask) noexcept
+    : reactor_{reactor}
+    , socket_{socket}
+    , mask_{mask}
+  {}
+
+  /// @name Awaitable
+  /// @{
+
+  bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void await_suspend(const std::coroutine_handle<> handle)
+  {
+    // The callback may resume the coroutine before async_wait() returns.
+    reactor_.async_wait(socket_, mask_, [this, handle](const Socket_readiness r)
+    {
+      result_ = r;
+      handle.resume();
+    });
+  }
+
+  Socket_readiness await_resume() const noexcept
+  {
+    return result_;
+  }
+
+  /// @}
+
+private:
+  Reactor& reactor_;
+  int socket_{-1};
+  Socket_readiness mask_{};
+  Socket_readiness result_{};
+};
+
+/**
+ * @ingroup main
+ *
+ * @returns The awaitable of the readiness of the socket of `connection`.
+ */
+inline Socket_readiness_awaitable async_wait_socket_readiness(Reactor& reactor,
+  const Connection& connection, const Socket_readiness mask) noexcept
+{
+  return {reactor, connection.socket(), mask};
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Establishes the connection without blocking the calling thread.
+ *
+ * @par Effects
+ * `connection.is_connected()`.
+ *
+ * @throws Client_exception on failure.
+ *
+ * @see Connection::connect_nio().
+ */
+inline Task<> async_connect(Reactor& reactor, Connection& connection)
+{
+  using Status = Connection::Status;
+  connection.connect_nio();
+  while (true) {
+    switch (connection.status()) {
+    case Status::establishment_reading:
+      co_await async_wait_socket_readiness(reactor, connection,
+        Socket_readiness::read_ready);
+      break;
+    case Status::establishment_writing:
+      co_await async_wait_socket_readiness(reactor, connection,
+        Socket_readiness::write_ready);
+      break;
+    case Status::connected:
+      co_return;
+    case Status::failure:
+      throw Client_exception{"cannot connect: connection failure"};
+    case Status::disconnected:
+      throw Client_exception{"cannot connect: unexpected status"};
+    }
+    connection.connect_nio();
+  }
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Flushes the output of the connection without blocking the calling
+ * thread.
+ *
+ * @see Connection::flush_output().
+ */
+inline Task<> async_flush_output(Reactor& reactor, Connection& connection)
+{
+  // The input is consumed when the socket is read-ready as libpq requires.
+  while (!connection.flush_output()) {
+    const auto readiness = co_await async_wait_socket_readiness(reactor,
+      connection, Socket_readiness::read_ready | Socket_readiness::write_ready);
+    if ((readiness & Socket_readiness::read_ready) != Socket_readiness::unready)
+      connection.read_input();
+  }
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Processes the responses without blocking the calling thread.
+ *
+ * @param callback A function which is called with each Row. It must be
+ * invocable with `Row&&`.
+ *
+ * @returns The Completion.
+ *
+ * @throws Server_exception on error response.
+ *
+ * @see Connection::process_responses().
+ */
+template<typename F>
+Task<Completion> async_process_responses(Reactor& reactor,
+  Connection& connection, F callback)
+{
+  static_assert(std::is_invocable_v<F&, Row&&>,
+    "callback must be invocable with Row&&");
+  while (true) {
+    if (connection.handle_input() != Response_status::ready) {
+      if (!connection.has_uncompleted_request())
+        throw Client_exception{"cannot process responses: no request"};
+      co_await async_wait_socket_readiness(reactor, connection,
+        Socket_readiness::read_ready);
+      connection.read_input();
+    } else if (auto r = connection.row())
+      callback(std::move(r));
+    else if (auto c = connection.completion())
+      co_return c;
+    else if (auto e = connection.error())
+      throw Server_exception{std::make_shared<Error>(std::move(e))};
+    else
+      throw Client_exception{"cannot process responses: unexpected response"};
+  }
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Executes the statement without blocking the calling thread.
+ *
+ * @details For example:
+ * @code
+ * pgfe::Task<> session(pgfe::Reactor& reactor, pgfe::Connection& conn)
+ * {
+ *   co_await pgfe::async_connect(reactor, conn);
+ *   co_await pgfe::async_execute(reactor, conn, [](pgfe::Row&& row)
+ *   {
+ *     std::cout << pgfe::to<int>(row[0]) << std::endl;
+ *   }, "select generate_series($1::int, $2::int)", 1, 3);
+ * }
+ * @endcode
+ *
+ * @param callback Same as for async_process_responses().
+ * @param statement A statement to execute. It's taken by value since the
+ * coroutine can outlive the full-expression of the call.
+ * @param parameters Parameters to bind, which are taken by value too.
+ *
+ * @returns The Completion.
+ *
+ * @par Requires
+ * `connection.is_ready_for_nio_request()`.
+ *
+ * @see Connection::execute_nio().
+ */
+template<typename F, typename ... Types>
+Task<Completion> async_execute(Reactor& reactor, Connection& connection,
+  F callback, const Statement statement, Types ... parameters)
+{
+  connection.execute_nio(statement, std::move(parameters)...);
+  co_await async_flush_output(reactor, connection);
+  co_return co_await async_process_responses(reactor, connection,
+    std::move(callback));
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Sends the data to the server without blocking the calling thread.
+ *
+ * @see Copier::send().
+ */
+inline Task<> async_send(Reactor& reactor, Copier& copier,
+  std::string data)
+{
+  auto& connection = copier.connection();
+  while (copier.send_nio(data) != Socket_readiness::unready)
+    co_await async_flush_output(reactor, connection);
+  co_await async_flush_output(reactor, connection);
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Sends end-of-data indication to the server and waits for the
+ * completion of `COPY` without blocking the calling thread.
+ *
+ * @returns The Completion.
+ *
+ * @see Copier::end().
+ */
+inline Task<Completion> async_end(Reactor& reactor, Copier& copier,
+  std::string error_message = {})
+{
+  auto& connection = copier.connection();
+  while (copier.end_nio(error_message) != Socket_readiness::unready)
+    co_await async_flush_output(reactor, connection);
+  co_await async_flush_output(reactor, connection);
+  co_return co_await async_process_responses(reactor, connection,
+    [](Row&&){});
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief Receives data from the server without blocking the calling thread.
+ *
+ * @returns Either invalid instance if the `COPY` command is done, or the
+ * non-empty instance received from the server, which is valid until the next
+ * receiving.
+ *
+ * @see Copier::receive_nio().
+ */
+inline Task<Data_view> async_receive(Reactor& reactor, Copier& copier)
+{
+  auto& connection = copier.connection();
+  Data_view result;
+  while (copier.receive_nio(result) != Socket_readiness::unready) {
+    co_await async_wait_socket_readiness(reactor, connection,
+      Socket_readiness::read_ready);
+    connection.read_input();
+  }
+  co_return result;
+}
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_COROUTINE_HPP
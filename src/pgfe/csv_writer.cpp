@@ -0,0 +1,340 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../net/descriptor.hpp"
+#include "../str/simd.hpp"
+#include "csv_writer.hpp"
+#include "data.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "row_batch.hpp"
+
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/**
+ * @returns The pointer to the first of `c1`, `c2`, CR or LF character in
+ * [first, last), or `last` if there is no such a character.
+ */
+inline const char* scan_csv_field(const char* first, const char* const last,
+  const char c1, const char c2) noexcept
+{
+#if defined(DMITIGR_STR_SSE2)
+  const auto v1 = _mm_set1_epi8(c1);
+  const auto v2 = _mm_set1_epi8(c2);
+  const auto cr = _mm_set1_epi8('\r');
+  const auto lf = _mm_set1_epi8('\n');
+  for (; last - first >= 16; first += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const auto special = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, v1), _mm_cmpeq_epi8(v, v2)),
+      _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+    if (_mm_movemask_epi8(special))
+      break; // the block is scanned below
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto v1 = vdupq_n_u8(static_cast<std::uint8_t>(c1));
+  const auto v2 = vdupq_n_u8(static_cast<std::uint8_t>(c2));
+  const auto cr = vdupq_n_u8('\r');
+  const auto lf = vdupq_n_u8('\n');
+  for (; last - first >= 16; first += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+    const auto special = vorrq_u8(
+      vorrq_u8(vceqq_u8(v, v1), vceqq_u8(v, v2)),
+      vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, lf)));
+    if (vmaxvq_u8(special))
+      break; // the block is scanned below
+  }
+#endif
+  for (; first != last; ++first) {
+    const char c{*first};
+    if (c == c1 || c == c2 || c == '\r' || c == '\n')
+      break;
+  }
+  return first;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Csv_writer::Csv_writer(net::Descriptor* const descriptor,
+  const Format format, const std::size_t block_size)
+  : format_{format}
+  , delimiter_{format == Format::csv ? ',' : '\t'}
+  , block_size_{block_size}
+  , descriptor_{descriptor}
+{
+  if (!block_size_)
+    throw Client_exception{"cannot create CSV writer: invalid block size"};
+  block_.reserve(block_size_ + block_size_ / 8);
+  pending_.reserve(block_.capacity());
+}
+
+DMITIGR_PGFE_INLINE Csv_writer::Csv_writer(net::Descriptor& descriptor,
+  const Format format, const std::size_t block_size)
+  : Csv_writer{&descriptor, format, block_size}
+{
+  writer_ = std::thread{&Csv_writer::work, this};
+}
+
+DMITIGR_PGFE_INLINE Csv_writer::Csv_writer(const std::filesystem::path& path,
+  const Format format, const std::size_t block_size)
+  : Csv_writer{nullptr, format, block_size}
+{
+  file_.open(path, std::ios_base::binary | std::ios_base::trunc);
+  if (!file_)
+    throw Client_exception{"cannot open file " + path.string()};
+  writer_ = std::thread{&Csv_writer::work, this};
+}
+
+DMITIGR_PGFE_INLINE Csv_writer::~Csv_writer()
+{
+  stop();
+}
+
+DMITIGR_PGFE_INLINE auto Csv_writer::format() const noexcept -> Format
+{
+  return format_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Csv_writer::block_size() const noexcept
+{
+  return block_size_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Csv_writer::row_count() const noexcept
+{
+  return row_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uintmax_t Csv_writer::byte_count() const noexcept
+{
+  return byte_count_ + block_.size();
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::write_header(const Row_info& info)
+{
+  check_writable("cannot write header by CSV writer");
+  for (std::size_t i{}; i < info.field_count(); ++i) {
+    if (i)
+      block_ += delimiter_;
+    append(info.field_name(i));
+  }
+  end_row();
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::write(const Row_batch& batch)
+{
+  check_writable("cannot write row batch by CSV writer");
+  if (!batch)
+    throw Client_exception{"cannot write row batch by CSV writer: "
+      "invalid batch"};
+
+  const auto field_count = batch.field_count();
+  for (std::size_t row{}; row < batch.row_count(); ++row) {
+    for (std::size_t field{}; field < field_count; ++field) {
+      if (field)
+        block_ += delimiter_;
+      append(batch.data(row, field));
+    }
+    ++row_count_;
+    end_row();
+  }
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::write(const Row& row)
+{
+  check_writable("cannot write row by CSV writer");
+  if (!row)
+    throw Client_exception{"cannot write row by CSV writer: invalid row"};
+
+  for (std::size_t field{}; field < row.field_count(); ++field) {
+    if (field)
+      block_ += delimiter_;
+    append(row.data(field));
+  }
+  ++row_count_;
+  end_row();
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::close()
+{
+  if (is_closed_)
+    return;
+
+  is_closed_ = true;
+  if (!block_.empty())
+    flush();
+  stop();
+  if (error_)
+    std::rethrow_exception(error_);
+  if (file_.is_open()) {
+    file_.close();
+    if (!file_)
+      throw Client_exception{"cannot close file by CSV writer"};
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Csv_writer::is_closed() const noexcept
+{
+  return is_closed_;
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::check_writable(const char* const what) const
+{
+  if (is_closed_)
+    throw Client_exception{std::string{what} + ": writer is closed"};
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::append(const std::string_view value)
+{
+  const char* first{value.data()};
+  const char* const last{first + value.size()};
+  if (format_ == Format::csv) {
+    const char* special{detail::scan_csv_field(first, last, ',', '"')};
+    if (special == last && first != last) {
+      block_.append(first, last);
+      return;
+    }
+
+    // The empty string is quoted to be distinguishable from NULL.
+    block_ += '"';
+    while (special != last) {
+      if (*special == '"') {
+        block_.append(first, special + 1);
+        block_ += '"';
+        first = special + 1;
+      }
+      special = detail::scan_csv_field(special + 1, last, '"', '"');
+    }
+    block_.append(first, last);
+    block_ += '"';
+  } else {
+    while (true) {
+      const char* const special{detail::scan_csv_field(first, last, '\t',
+        '\\')};
+      block_.append(first, special);
+      if (special == last)
+        break;
+
+      switch (*special) {
+      case '\t': block_ += "\\t"; break;
+      case '\\': block_ += "\\\\"; break;
+      case '\r': block_ += "\\r"; break;
+      case '\n': block_ += "\\n"; break;
+      }
+      first = special + 1;
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::append(const Data& data)
+{
+  if (!data) {
+    if (format_ == Format::tsv)
+      block_ += "\\N";
+  } else if (data.format() != Data_format::text)
+    throw Client_exception{"cannot write field data by CSV writer: "
+      "data in binary format"};
+  else
+    append(std::string_view{static_cast<const char*>(data.bytes()),
+      data.size()});
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::end_row()
+{
+  block_ += '\n';
+  if (block_.size() >= block_size_)
+    flush();
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::flush()
+{
+  std::unique_lock lk{mutex_};
+  state_changed_.wait(lk, [this]{return !has_pending_ || error_;});
+  if (error_) {
+    is_closed_ = true;
+    std::rethrow_exception(error_);
+  }
+  byte_count_ += block_.size();
+  pending_.swap(block_);
+  has_pending_ = true;
+  lk.unlock();
+  state_changed_.notify_all();
+  block_.clear(); // keeps the capacity of the block written before
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::stop() noexcept
+{
+  {
+    const std::lock_guard lg{mutex_};
+    is_stopped_ = true;
+  }
+  state_changed_.notify_all();
+  if (writer_.joinable())
+    writer_.join();
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::work()
+{
+  while (true) {
+    {
+      std::unique_lock lk{mutex_};
+      state_changed_.wait(lk, [this]{return has_pending_ || is_stopped_;});
+      if (!has_pending_)
+        return;
+    }
+
+    // The pending block is not touched by the producer until it's written.
+    try {
+      write_out(pending_);
+    } catch (...) {
+      {
+        const std::lock_guard lg{mutex_};
+        error_ = std::current_exception();
+        has_pending_ = false;
+      }
+      state_changed_.notify_all();
+      return;
+    }
+
+    {
+      const std::lock_guard lg{mutex_};
+      pending_.clear();
+      has_pending_ = false;
+    }
+    state_changed_.notify_all();
+  }
+}
+
+DMITIGR_PGFE_INLINE void Csv_writer::write_out(const std::string& block)
+{
+  if (descriptor_) {
+    for (std::size_t offset{}; offset < block.size();) {
+      const auto written = descriptor_->write(block.data() + offset,
+        static_cast<std::streamsize>(block.size() - offset));
+      if (written <= 0)
+        throw Client_exception{"cannot write to descriptor by CSV writer"};
+      offset += static_cast<std::size_t>(written);
+    }
+  } else if (!file_.write(block.data(),
+      static_cast<std::streamsize>(block.size())))
+    throw Client_exception{"cannot write to file by CSV writer"};
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,229 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_CSV_WRITER_HPP
+#define DMITIGR_PGFE_CSV_WRITER_HPP
+
+#include "../net/types_fwd.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A writer of the rows in CSV or TSV format to a descriptor or a file.
+ *
+ * @details The rows are formatted directly into the block of about
+ * block_size() bytes. The filled block is passed to the background thread
+ * which writes it while the next block is being filled (double buffering), so
+ * the receiving and the formatting are overlapped with the IO. This is
+ * useful when `COPY TO` cannot be used, for example, to export the result of
+ * an arbitrary query under a role which has no privileges to run `COPY`.
+ * The rows should be delivered in batches to avoid the result per row:
+ * @code
+ * Csv_writer writer{"items.csv", Csv_writer::Format::csv};
+ * conn.set_row_delivery_mode(Row_delivery_mode::chunked);
+ * conn.execute([&writer](Row_batch&& batch)
+ * {
+ *   if (!writer.row_count())
+ *     writer.write_header(batch.info());
+ *   writer.write(batch);
+ * }, "select id, name from item");
+ * writer.close();
+ * @endcode
+ *
+ * The formats are the same as of the formats `csv` and `text` of `COPY TO`
+ * with the default options accordingly, that is:
+ *   - Format::csv: the fields are separated by commas, the field which is an
+ *   empty string or contains a comma, a double quote, CR or LF is quoted (by
+ *   double quotes, with the double quotes inside doubled), and SQL NULL is an
+ *   empty unquoted field;
+ *   - Format::tsv: the fields are separated by tabs, the backslash, tab, CR
+ *   and LF are written as `\\`, `\t`, `\r` and `\n` accordingly, and SQL NULL
+ *   is written as `\N`.
+ *
+ * The rows are terminated by LF in both formats.
+ *
+ * @par Requires
+ * The field data must be in Data_format::text format.
+ *
+ * @see Row_batch, Json_row_writer.
+ */
+class Csv_writer final {
+public:
+  /// The default size of the block.
+  static constexpr std::size_t default_block_size{1024 * 1024};
+
+  /// A format of the output.
+  enum class Format {
+    /// Comma-separated values.
+    csv,
+
+    /// Tab-separated values.
+    tsv
+  };
+
+  /**
+   * @brief The constructor. Starts the background writer.
+   *
+   * @par Requires
+   * `block_size`.
+   *
+   * @warning The `descriptor` must outlive this instance.
+   */
+  DMITIGR_PGFE_API Csv_writer(net::Descriptor& descriptor, Format format,
+    std::size_t block_size = default_block_size);
+
+  /**
+   * @overload
+   *
+   * @details Creates (or truncates) the file at `path`.
+   *
+   * @throws Client_exception if the file cannot be opened.
+   */
+  DMITIGR_PGFE_API Csv_writer(const std::filesystem::path& path, Format format,
+    std::size_t block_size = default_block_size);
+
+  /**
+   * @brief Stops the background writer.
+   *
+   * @warning The rows which are not written are lost unless close() is
+   * called!
+   */
+  DMITIGR_PGFE_API ~Csv_writer();
+
+  /// Not copy-constructible.
+  Csv_writer(const Csv_writer&) = delete;
+
+  /// Not copy-assignable.
+  Csv_writer& operator=(const Csv_writer&) = delete;
+
+  /// Not move-constructible.
+  Csv_writer(Csv_writer&&) = delete;
+
+  /// Not move-assignable.
+  Csv_writer& operator=(Csv_writer&&) = delete;
+
+  /// @returns The format of the output.
+  DMITIGR_PGFE_API Format format() const noexcept;
+
+  /// @returns The size of the block.
+  DMITIGR_PGFE_API std::size_t block_size() const noexcept;
+
+  /// @returns The number of rows written (excluding the header).
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /// @returns The number of bytes formatted.
+  DMITIGR_PGFE_API std::uintmax_t byte_count() const noexcept;
+
+  /**
+   * @brief Writes the names of the fields of `info`.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   *
+   * @throws An exception of the background writer if any.
+   */
+  DMITIGR_PGFE_API void write_header(const Row_info& info);
+
+  /**
+   * @brief Writes all the rows of `batch`.
+   *
+   * @par Requires
+   * `batch && !is_closed()`.
+   *
+   * @throws Client_exception if some field data is not in Data_format::text
+   * format.
+   * @throws An exception of the background writer if any.
+   */
+  DMITIGR_PGFE_API void write(const Row_batch& batch);
+
+  /**
+   * @brief Writes the `row`.
+   *
+   * @par Requires
+   * `row && !is_closed()`.
+   *
+   * @throws Client_exception if some field data is not in Data_format::text
+   * format.
+   * @throws An exception of the background writer if any.
+   */
+  DMITIGR_PGFE_API void write(const Row& row);
+
+  /**
+   * @brief Writes the remaining data, stops the background writer and closes
+   * the file (if any).
+   *
+   * @par Effects
+   * `is_closed()`.
+   *
+   * @throws An exception of the background writer if any.
+   */
+  DMITIGR_PGFE_API void close();
+
+  /// @returns `true` if this instance is closed.
+  DMITIGR_PGFE_API bool is_closed() const noexcept;
+
+private:
+  Format format_{};
+  char delimiter_{};
+  std::size_t block_size_{};
+  std::size_t row_count_{};
+  std::uintmax_t byte_count_{};
+  net::Descriptor* descriptor_{};
+  std::ofstream file_;
+  std::string block_; // the block being filled
+  std::string pending_; // the block being written
+  bool has_pending_{};
+  bool is_closed_{};
+  bool is_stopped_{};
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::thread writer_;
+
+  Csv_writer(net::Descriptor* descriptor, Format format,
+    std::size_t block_size);
+  void check_writable(const char* what) const;
+  void append(std::string_view value);
+  void append(const Data& data);
+  void end_row();
+  void flush();
+  void stop() noexcept;
+  void work();
+  void write_out(const std::string& block);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "csv_writer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_CSV_WRITER_HPP
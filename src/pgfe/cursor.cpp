@@ -0,0 +1,179 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "completion.hpp"
+#include "connection.hpp"
+#include "cursor.hpp"
+#include "exceptions.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Cursor::~Cursor()
+{
+  try {
+    try {
+      close();
+    } catch (...) {
+      conn_.disconnect();
+      throw;
+    }
+  } catch (const std::exception& e) {
+    std::clog << "cursor close error:" << e.what() << '\n';
+  } catch (...) {
+    std::clog << "cursor close error: unknown error\n";
+  }
+}
+
+DMITIGR_PGFE_INLINE Connection& Cursor::connection() const noexcept
+{
+  return conn_;
+}
+
+DMITIGR_PGFE_INLINE const std::string& Cursor::name() const noexcept
+{
+  return name_;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::set_fetch_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set fetch size of cursor: invalid value"};
+  fetch_statement_ = make_fetch_statement(name_, value);
+  fetch_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Cursor::fetch_size() const noexcept
+{
+  return fetch_size_;
+}
+
+DMITIGR_PGFE_INLINE Row_batch Cursor::fetch()
+{
+  if (is_closed_)
+    throw Client_exception{"cannot fetch from cursor: cursor is closed"};
+  else if (is_exhausted_)
+    return Row_batch{};
+
+  if (!is_fetch_pending_)
+    send_fetch();
+
+  Row_batch result;
+  is_fetch_pending_ = false;
+  try {
+    conn_.process_responses([&result](Row_batch&& batch)
+    {
+      result = std::move(batch);
+    });
+  } catch (...) {
+    is_exhausted_ = true;
+    throw;
+  }
+
+  // The batch of lesser size than requested is the last one.
+  if (result.row_count() < pending_fetch_size_)
+    is_exhausted_ = true;
+  else
+    send_fetch(); // fetch ahead
+  return result;
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::is_fetch_pending() const noexcept
+{
+  return is_fetch_pending_;
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::is_exhausted() const noexcept
+{
+  return is_exhausted_;
+}
+
+DMITIGR_PGFE_INLINE void Cursor::close()
+{
+  if (is_closed_)
+    return;
+
+  is_closed_ = true;
+  is_exhausted_ = true;
+  if (!conn_.is_connected())
+    return;
+
+  if (is_fetch_pending_) {
+    is_fetch_pending_ = false;
+    conn_.process_responses([](Row&&){});
+  }
+  // The cursor is closed by the server at the end of transaction.
+  if (conn_.is_transaction_uncommitted())
+    conn_.execute(Statement{"close " + name_});
+}
+
+DMITIGR_PGFE_INLINE bool Cursor::is_closed() const noexcept
+{
+  return is_closed_;
+}
+
+DMITIGR_PGFE_INLINE auto Cursor::begin() -> Iterator
+{
+  return Iterator{this};
+}
+
+DMITIGR_PGFE_INLINE auto Cursor::end() noexcept -> Iterator
+{
+  return Iterator{};
+}
+
+DMITIGR_PGFE_INLINE void Cursor::send_fetch()
+{
+  DMITIGR_ASSERT(!is_fetch_pending_);
+  // All the rows of the batch are retrieved as a single result.
+  const auto mode = conn_.row_delivery_mode();
+  conn_.set_row_delivery_mode(Row_delivery_mode::full);
+  try {
+    conn_.execute_nio(fetch_statement_);
+  } catch (...) {
+    conn_.set_row_delivery_mode(mode);
+    throw;
+  }
+  conn_.set_row_delivery_mode(mode);
+  pending_fetch_size_ = fetch_size_;
+  is_fetch_pending_ = true;
+}
+
+DMITIGR_PGFE_INLINE std::string Cursor::make_name()
+{
+  static std::atomic<std::uint_fast64_t> id;
+  return "pgfe_cursor_" + std::to_string(++id);
+}
+
+DMITIGR_PGFE_INLINE Statement Cursor::make_declaration(const std::string& name,
+  const Statement& query)
+{
+  Statement result{"declare " + name + " no scroll cursor for "};
+  result.append(query);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Statement Cursor::make_fetch_statement(
+  const std::string& name, const std::size_t fetch_size)
+{
+  return Statement{"fetch forward " + std::to_string(fetch_size) +
+    " from " + name};
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,240 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_CURSOR_HPP
+#define DMITIGR_PGFE_CURSOR_HPP
+
+#include "connection.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "row_batch.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A server-side cursor which fetches the rows of a query in batches.
+ *
+ * @details The memory used to retrieve the rows is bounded by the size of a
+ * batch. The next batch is requested (by sending the `FETCH` command) right
+ * after the current batch is received, so the server produces the next batch
+ * while the client processes the current one.
+ *
+ * @warning The connection isn't ready for requests while the next batch is
+ * requested (see is_fetch_pending()). In such a case close() must be called
+ * to use the connection for other requests.
+ *
+ * @see Row_batch.
+ */
+class Cursor final {
+public:
+  /// The default number of rows fetched at once.
+  static constexpr std::size_t default_fetch_size{1000};
+
+  /// An input iterator over the batches of rows of the cursor.
+  class Iterator final {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row_batch;
+    using difference_type = std::ptrdiff_t;
+    using reference = const Row_batch&;
+    using pointer = const Row_batch*;
+
+    /// Constructs the end iterator.
+    Iterator() = default;
+
+    /// @returns The current batch.
+    reference operator*() const noexcept
+    {
+      return batch_;
+    }
+
+    /// @returns The pointer to the current batch.
+    pointer operator->() const noexcept
+    {
+      return &batch_;
+    }
+
+    /// Fetches the next batch.
+    Iterator& operator++()
+    {
+      DMITIGR_ASSERT(cursor_);
+      if (!(batch_ = cursor_->fetch()))
+        cursor_ = nullptr;
+      return *this;
+    }
+
+    /// @returns `true` if `*this == rhs`.
+    bool operator==(const Iterator& rhs) const noexcept
+    {
+      return cursor_ == rhs.cursor_;
+    }
+
+    /// @returns `true` if `*this != rhs`.
+    bool operator!=(const Iterator& rhs) const noexcept
+    {
+      return !(*this == rhs);
+    }
+
+  private:
+    friend Cursor;
+
+    Cursor* cursor_{};
+    Row_batch batch_;
+
+    explicit Iterator(Cursor* const cursor)
+      : cursor_{cursor}
+    {
+      ++*this;
+    }
+  };
+
+  /**
+   * @brief Closes the cursor.
+   *
+   * @details Attempts to close the cursor. If that failed, closes the
+   * connection, since the state of the connection is unknown.
+   */
+  DMITIGR_PGFE_API ~Cursor();
+
+  /**
+   * @brief Declares the cursor for the `query`.
+   *
+   * @param conn The connection. It must outlive the cursor.
+   * @param query A *preparsed* query which returns rows.
+   * @param parameters Parameters to bind with a parameterized query.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request() && conn.is_transaction_uncommitted()`.
+   */
+  template<typename ... Types>
+  Cursor(Connection& conn, const Statement& query, Types&& ... parameters)
+    : conn_{conn}
+    , name_{make_name()}
+    , fetch_statement_{make_fetch_statement(name_, fetch_size_)}
+  {
+    if (!conn_.is_transaction_uncommitted())
+      throw Client_exception{"cannot declare cursor: no transaction in progress"};
+    conn_.execute(make_declaration(name_, query),
+      std::forward<Types>(parameters)...);
+  }
+
+  /// Not copy-constructible.
+  Cursor(const Cursor&) = delete;
+
+  /// Not copy-assignable.
+  Cursor& operator=(const Cursor&) = delete;
+
+  /// Not move-constructible.
+  Cursor(Cursor&&) = delete;
+
+  /// Not move-assignable.
+  Cursor& operator=(Cursor&&) = delete;
+
+  /// @returns The connection.
+  DMITIGR_PGFE_API Connection& connection() const noexcept;
+
+  /// @returns The name of the cursor.
+  DMITIGR_PGFE_API const std::string& name() const noexcept;
+
+  /**
+   * @brief Sets the number of rows fetched at once.
+   *
+   * @details The new value affects the batches requested after the call.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_fetch_size(std::size_t value);
+
+  /// @returns The number of rows fetched at once.
+  DMITIGR_PGFE_API std::size_t fetch_size() const noexcept;
+
+  /**
+   * @brief Fetches the next batch of rows and requests the next one.
+   *
+   * @returns The batch of rows, or invalid instance if there are no more
+   * rows.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   *
+   * @par Effects
+   * `is_fetch_pending()` if there can be more rows.
+   */
+  DMITIGR_PGFE_API Row_batch fetch();
+
+  /// @returns `true` if the next batch is requested but not yet fetched.
+  DMITIGR_PGFE_API bool is_fetch_pending() const noexcept;
+
+  /// @returns `true` if all the rows are fetched.
+  DMITIGR_PGFE_API bool is_exhausted() const noexcept;
+
+  /**
+   * @brief Discards the requested batch (if any) and closes the cursor.
+   *
+   * @par Effects
+   * `is_closed()`.
+   */
+  DMITIGR_PGFE_API void close();
+
+  /// @returns `true` if the cursor is closed.
+  DMITIGR_PGFE_API bool is_closed() const noexcept;
+
+  /**
+   * @returns The iterator which fetches the first batch.
+   *
+   * @par Requires
+   * `!is_closed()`.
+   */
+  DMITIGR_PGFE_API Iterator begin();
+
+  /// @returns The end iterator.
+  DMITIGR_PGFE_API Iterator end() noexcept;
+
+private:
+  Connection& conn_;
+  std::string name_;
+  std::size_t fetch_size_{default_fetch_size};
+  std::size_t pending_fetch_size_{};
+  Statement fetch_statement_;
+  bool is_fetch_pending_{};
+  bool is_exhausted_{};
+  bool is_closed_{};
+
+  void send_fetch();
+  static std::string make_name();
+  static Statement make_declaration(const std::string& name,
+    const Statement& query);
+  static Statement make_fetch_statement(const std::string& name,
+    std::size_t fetch_size);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "cursor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_CURSOR_HPP
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "../str/hex.hpp"
 #include "data.hpp"
 #include "exceptions.hpp"
 #include "pq.hpp"
@@ -181,6 +182,23 @@ inline std::unique_ptr<pgfe::Data> to_bytea__(const void* const text)
   if (!text)
     throw Client_exception{"cannot convert data to bytea: null input data"};
 
+  // The hex format is decoded natively, anything else is decoded by libpq.
+  const auto* const chars = static_cast<const char*>(text);
+  if (chars[0] == '\\' && chars[1] == 'x') {
+    const std::size_t hex_size{std::strlen(chars + 2)};
+    if (!(hex_size % 2)) {
+      const std::size_t size{hex_size / 2};
+      if (!size)
+        return std::make_unique<detail::empty_Data>(pgfe::Data_format::binary);
+      std::unique_ptr<char[]> storage{new char[size + 1]};
+      if (str::hex_decode(storage.get(), chars + 2, hex_size)) {
+        storage[size] = '\0';
+        return std::make_unique<detail::array_memory_Data>(std::move(storage),
+          size, pgfe::Data_format::binary);
+      }
+    }
+  }
+
   const auto* const bytes = static_cast<const unsigned char*>(text);
   std::size_t storage_size{};
   using Uptr = std::unique_ptr<void, void(*)(void*)>;
@@ -246,14 +264,17 @@ Data::make(std::unique_ptr<void, void(*)(void*)>&& storage,
 DMITIGR_PGFE_INLINE std::unique_ptr<Data>
 Data::make(const std::string_view bytes, const Data_format format)
 {
-  if (bytes.size() > 0) {
-    std::unique_ptr<char[]> storage{new char[bytes.size() + 1]};
-    std::memcpy(storage.get(), bytes.data(), bytes.size());
-    storage.get()[bytes.size()] = '\0';
-    return std::make_unique<detail::array_memory_Data>(std::move(storage),
-      bytes.size(), format);
-  } else
+  if (bytes.empty())
     return std::make_unique<detail::empty_Data>(format);
+  else if (bytes.size() <= Inline_data::capacity)
+    // The only allocation is needed for the small data.
+    return std::make_unique<Inline_data>(bytes.data(), bytes.size(), format);
+
+  std::unique_ptr<char[]> storage{new char[bytes.size() + 1]};
+  std::memcpy(storage.get(), bytes.data(), bytes.size());
+  storage.get()[bytes.size()] = '\0';
+  return std::make_unique<detail::array_memory_Data>(std::move(storage),
+    bytes.size(), format);
 }
 
 DMITIGR_PGFE_INLINE std::unique_ptr<Data>
@@ -351,4 +372,46 @@ DMITIGR_PGFE_INLINE const void* Data_view::bytes() const noexcept
   return data_.data();
 }
 
+// -----------------------------------------------------------------------------
+// Inline_data
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Inline_data::Inline_data(const char* const bytes,
+  const std::size_t size, const Format format)
+  : format_{format}
+  , size_{static_cast<unsigned char>(size)}
+{
+  if (!((bytes || !size) && size <= capacity))
+    throw Client_exception{"cannot create an instance of inline data"};
+  if (size)
+    std::memcpy(storage_, bytes, size);
+  storage_[size] = '\0';
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::unique_ptr<Data> Inline_data::to_data() const
+{
+  return std::make_unique<Inline_data>(*this);
+}
+
+DMITIGR_PGFE_INLINE auto Inline_data::format() const noexcept -> Format
+{
+  return format_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Inline_data::size() const noexcept
+{
+  return size_;
+}
+
+DMITIGR_PGFE_INLINE bool Inline_data::is_empty() const noexcept
+{
+  return !size_;
+}
+
+DMITIGR_PGFE_INLINE const void* Inline_data::bytes() const noexcept
+{
+  return storage_;
+}
+
 } // namespace dmitigr::pgfe
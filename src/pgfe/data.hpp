@@ -315,6 +315,64 @@ inline void swap(Data_view& lhs, Data_view& rhs) noexcept
   lhs.swap(rhs);
 }
 
+// =============================================================================
+
+/**
+ * @ingroup main
+ *
+ * @brief A data of the small size stored inline.
+ *
+ * @details The bytes are stored within the instance itself, so the instances
+ * of this class doesn't allocate memory. It's convenient for the numbers,
+ * UUIDs and short strings.
+ */
+class Inline_data final : public Data {
+public:
+  /// The maximum size of data.
+  static constexpr std::size_t capacity{40};
+
+  /**
+   * @brief Constructs the empty data of the text format.
+   *
+   * @par Effects
+   * `is_empty() && (format() == Format::text)`.
+   */
+  Inline_data() = default;
+
+  /**
+   * @brief Constructs the data of the specified `format` with a copy of the
+   * specified `bytes` of the specified `size`.
+   *
+   * @par Requires
+   * `(bytes || !size) && (size <= capacity)`.
+   *
+   * @par Effects
+   * The copy of bytes is followed by zero byte.
+   */
+  DMITIGR_PGFE_API Inline_data(const char* bytes, std::size_t size,
+    Format format = Format::text);
+
+  /// @see Data::to_data().
+  DMITIGR_PGFE_API std::unique_ptr<Data> to_data() const override;
+
+  /// @see Data::format().
+  DMITIGR_PGFE_API Format format() const noexcept override;
+
+  /// @see Data::size().
+  DMITIGR_PGFE_API std::size_t size() const noexcept override;
+
+  /// @see Data::is_empty().
+  DMITIGR_PGFE_API bool is_empty() const noexcept override;
+
+  /// @see Data::bytes().
+  DMITIGR_PGFE_API const void* bytes() const noexcept override;
+
+private:
+  Format format_{Format::text};
+  unsigned char size_{};
+  char storage_[capacity + 1]{};
+};
+
 } // namespace dmitigr::pgfe
 
 #ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
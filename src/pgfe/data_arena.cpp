@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "data_arena.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Data_arena::~Data_arena()
+{
+  clear();
+}
+
+DMITIGR_PGFE_INLINE Data_arena::Data_arena(const std::size_t block_size)
+  : block_size_{block_size}
+{
+  if (!block_size_)
+    throw Client_exception{"cannot create data arena: invalid block size"};
+}
+
+DMITIGR_PGFE_INLINE Data_arena::Data_arena(Data_arena&& rhs) noexcept
+  : block_size_{rhs.block_size_}
+{
+  swap(rhs);
+}
+
+DMITIGR_PGFE_INLINE Data_arena& Data_arena::operator=(Data_arena&& rhs) noexcept
+{
+  if (this != &rhs) {
+    Data_arena tmp{std::move(rhs)};
+    swap(tmp);
+  }
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE void Data_arena::swap(Data_arena& rhs) noexcept
+{
+  using std::swap;
+  swap(block_size_, rhs.block_size_);
+  swap(blocks_, rhs.blocks_);
+  swap(block_index_, rhs.block_index_);
+  swap(block_offset_, rhs.block_offset_);
+  swap(view_count_, rhs.view_count_);
+  swap(retained_, rhs.retained_);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Data_arena::block_size() const noexcept
+{
+  return block_size_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Data_arena::size() const noexcept
+{
+  return view_count_ + retained_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Data_arena::is_empty() const noexcept
+{
+  return !size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Data_arena::capacity() const noexcept
+{
+  std::size_t result{};
+  for (const auto& block : blocks_)
+    result += block.size;
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Data_arena::clear() noexcept
+{
+  // Data_view doesn't own anything so the views are just abandoned.
+  block_index_ = 0;
+  block_offset_ = 0;
+  view_count_ = 0;
+  retained_.clear();
+}
+
+DMITIGR_PGFE_INLINE const Data&
+Data_arena::make(const std::string_view bytes, const Data_format format)
+{
+  constexpr auto view_size = sizeof(Data_view);
+  char* const memory = allocate(view_size + bytes.size() + 1);
+  char* const storage = memory + view_size;
+  if (!bytes.empty())
+    std::memcpy(storage, bytes.data(), bytes.size());
+  storage[bytes.size()] = '\0';
+  const auto* const result = new (memory) Data_view{storage, bytes.size(),
+    format};
+  ++view_count_;
+  return *result;
+}
+
+DMITIGR_PGFE_INLINE const Data& Data_arena::make(std::unique_ptr<Data>&& data)
+{
+  if (!data)
+    throw Client_exception{"cannot retain data in arena: null data given"};
+  return *retained_.emplace_back(std::move(data));
+}
+
+DMITIGR_PGFE_INLINE char* Data_arena::allocate(const std::size_t size)
+{
+  constexpr auto alignment = alignof(Data_view);
+  const auto aligned = [](const std::size_t offset) noexcept
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  };
+
+  for (; block_index_ < blocks_.size(); ++block_index_, block_offset_ = 0) {
+    const auto& block = blocks_[block_index_];
+    if (const auto offset = aligned(block_offset_); size <= block.size &&
+      offset <= block.size - size) {
+      block_offset_ = offset + size;
+      return block.memory.get() + offset;
+    }
+  }
+
+  // The memory of `new char[]` is suitably aligned for any fundamental type.
+  const auto block_size = std::max(block_size_, size);
+  blocks_.push_back(Block{std::unique_ptr<char[]>{new char[block_size]},
+    block_size});
+  block_index_ = blocks_.size() - 1;
+  block_offset_ = size;
+  return blocks_.back().memory.get();
+}
+
+} // namespace dmitigr::pgfe
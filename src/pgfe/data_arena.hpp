@@ -0,0 +1,181 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_DATA_ARENA_HPP
+#define DMITIGR_PGFE_DATA_ARENA_HPP
+
+#include "conversions.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief An arena of data.
+ *
+ * @details The instances of Data made by the arena are placed along with their
+ * bytes into the blocks of memory owned by the arena. All of these instances
+ * are released at once by clear(), which keeps the blocks for reuse. Thus,
+ * making the data of the similar sizes repeatedly does not allocate after the
+ * first time.
+ *
+ * @remarks The arena is used by the Connection to bind the parameters of the
+ * statements executed by `execute()` and the like, and can be used to bind the
+ * parameters of Prepared_statement. (See Prepared_statement::set_data_arena().)
+ *
+ * @remarks The arena is not thread-safe.
+ */
+class Data_arena final {
+public:
+  /// The default size of block of memory.
+  static constexpr std::size_t default_block_size{4096};
+
+  /// The destructor.
+  DMITIGR_PGFE_API ~Data_arena();
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `block_size > 0`.
+   */
+  explicit DMITIGR_PGFE_API Data_arena(std::size_t block_size = default_block_size);
+
+  /// Not copy-constructible.
+  Data_arena(const Data_arena&) = delete;
+
+  /// Not copy-assignable.
+  Data_arena& operator=(const Data_arena&) = delete;
+
+  /// Move-constructible.
+  DMITIGR_PGFE_API Data_arena(Data_arena&& rhs) noexcept;
+
+  /// Move-assignable.
+  DMITIGR_PGFE_API Data_arena& operator=(Data_arena&& rhs) noexcept;
+
+  /// Swaps this instance with `rhs`.
+  DMITIGR_PGFE_API void swap(Data_arena& rhs) noexcept;
+
+  /// @returns The size of block of memory.
+  DMITIGR_PGFE_API std::size_t block_size() const noexcept;
+
+  /// @returns The number of the data instances made since the last clear().
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns `!size()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// @returns The total size of the blocks of memory owned by the arena.
+  DMITIGR_PGFE_API std::size_t capacity() const noexcept;
+
+  /**
+   * @brief Releases the data instances made by the arena.
+   *
+   * @details The blocks of memory are kept for reuse.
+   *
+   * @par Effects
+   * `is_empty()`.
+   */
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /**
+   * @returns The data of the specified `format` with the copy of `bytes`
+   * placed in the arena. The copy of bytes is always followed by zero byte.
+   *
+   * @remarks The result is valid until clear().
+   */
+  DMITIGR_PGFE_API const Data& make(std::string_view bytes,
+    Data_format format = Data_format::text);
+
+  /**
+   * @returns The data retained by the arena until clear().
+   *
+   * @par Requires
+   * `data`.
+   */
+  DMITIGR_PGFE_API const Data& make(std::unique_ptr<Data>&& data);
+
+  /**
+   * @returns The result of conversion of `value` to Data retained by the
+   * arena until clear().
+   *
+   * @details The values of type `std::string`, `std::string_view` and of the
+   * numeric types converted to the data of text format are placed into the
+   * arena directly. The values of other types are converted by using
+   * `pgfe::to_data()`.
+   */
+  template<typename T, typename ... Types>
+  const Data& to_data(T&& value, Types&& ... args)
+  {
+    using U = std::decay_t<T>;
+    if constexpr (!sizeof...(args) && (std::is_same_v<U, std::string> ||
+        std::is_same_v<U, std::string_view>)) {
+      return make(value, Data_format::text);
+    } else if constexpr (!sizeof...(args) && is_numeric_conversions_v<U>) {
+      char buf[64];
+      const auto* const end = detail::numeric_to_chars(buf, buf + sizeof(buf), value);
+      return make(std::string_view(buf, static_cast<std::size_t>(end - buf)),
+        Data_format::text);
+    } else
+      return make(pgfe::to_data(std::forward<T>(value),
+          std::forward<Types>(args)...));
+  }
+
+private:
+  struct Block final {
+    std::unique_ptr<char[]> memory;
+    std::size_t size{};
+  };
+
+  std::size_t block_size_{};
+  std::vector<Block> blocks_;
+  std::size_t block_index_{};
+  std::size_t block_offset_{};
+  std::size_t view_count_{};
+  std::vector<std::unique_ptr<Data>> retained_;
+
+  /// @returns The memory of the given `size` aligned for Data_view.
+  char* allocate(std::size_t size);
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief Data_arena is swappable.
+ */
+inline void swap(Data_arena& lhs, Data_arena& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "data_arena.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_DATA_ARENA_HPP
@@ -35,6 +35,8 @@ DMITIGR_PGFE_INLINE const char* to_literal(const Client_errc errc) noexcept
     return "timed_out";
   case Client_errc::invalid_response:
     return "invalid_response";
+  case Client_errc::result_memory_exceeded:
+    return "result_memory_exceeded";
   }
   return nullptr;
 }
@@ -46,7 +46,10 @@ enum class Client_errc {
   timed_out = 500,
 
   /// Denotes the server's response that was not understood.
-  invalid_response = 600
+  invalid_response = 600,
+
+  /// Denotes an exceeded limit of the memory of the result.
+  result_memory_exceeded = 700
 };
 
 /**
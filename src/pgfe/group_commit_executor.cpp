@@ -0,0 +1,301 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "completion.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "group_commit_executor.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// A receiver of the outcome of a transaction control command.
+struct Control_outcome final {
+  Completion completion;
+  Error error;
+
+  auto handler()
+  {
+    return [this](auto&& response)
+    {
+      using R = std::decay_t<decltype(response)>;
+      if constexpr (std::is_same_v<R, Completion>)
+        completion = std::move(response);
+      else if constexpr (std::is_same_v<R, Error>)
+        error = std::move(response);
+    };
+  }
+
+  void throw_if_failed(const char* const what)
+  {
+    if (error)
+      throw Server_exception{std::make_shared<Error>(std::move(error))};
+    else if (!completion || completion.tag() == "ROLLBACK")
+      throw Client_exception{std::string{what} +
+        ": aborted by the preceding error"};
+  }
+};
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Group_commit_executor::Group_commit_executor(
+  Connection_pool& pool, std::size_t worker_count)
+  : pool_{pool}
+{
+  if (!worker_count)
+    worker_count = pool_.size();
+  if (!worker_count)
+    throw Client_exception{"cannot create group commit executor: empty pool"};
+
+  workers_.reserve(worker_count);
+  try {
+    for (std::size_t i{}; i < worker_count; ++i)
+      workers_.emplace_back([this]{work();});
+  } catch (...) {
+    stop();
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE Group_commit_executor::~Group_commit_executor()
+{
+  stop();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool& Group_commit_executor::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Group_commit_executor::worker_count() const noexcept
+{
+  return workers_.size();
+}
+
+DMITIGR_PGFE_INLINE void
+Group_commit_executor::set_max_batch_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set max batch size of group commit "
+      "executor: invalid value"};
+  const std::lock_guard lg{mutex_};
+  max_batch_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Group_commit_executor::max_batch_size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_batch_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Group_commit_executor::set_max_delay(const std::chrono::microseconds value)
+{
+  if (value < std::chrono::microseconds::zero())
+    throw Client_exception{"cannot set max delay of group commit executor: "
+      "invalid value"};
+  const std::lock_guard lg{mutex_};
+  max_delay_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::microseconds
+Group_commit_executor::max_delay() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_delay_;
+}
+
+DMITIGR_PGFE_INLINE std::future<void> Group_commit_executor::submit(Work work)
+{
+  if (!work)
+    throw Client_exception{"cannot submit unit of work to group commit "
+      "executor: invalid work"};
+
+  std::future<void> result;
+  {
+    const std::lock_guard lg{mutex_};
+    if (is_stopped_)
+      throw Client_exception{"cannot submit unit of work to group commit "
+        "executor: executor is stopped"};
+    auto& unit = queue_.emplace_back();
+    unit.work_ = std::move(work);
+    result = unit.promise_.get_future();
+  }
+  // The worker which waits for the batch to fill must be notified as well.
+  state_changed_.notify_all();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Group_commit_executor::stop()
+{
+  {
+    const std::lock_guard lg{mutex_};
+    is_stopped_ = true;
+  }
+  state_changed_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Group_commit_executor::is_stopped() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return is_stopped_;
+}
+
+DMITIGR_PGFE_INLINE void Group_commit_executor::work()
+{
+  std::vector<Pending> batch;
+  while (true) {
+    {
+      std::unique_lock lk{mutex_};
+      state_changed_.wait(lk, [this]{return is_stopped_ || !queue_.empty();});
+      if (queue_.empty())
+        return; // stopped
+
+      // Wait for the batch to fill.
+      const auto is_full = [this]
+      {
+        return is_stopped_ || queue_.size() >= max_batch_size_;
+      };
+      if (!is_full())
+        state_changed_.wait_for(lk, max_delay_, is_full);
+      if (queue_.empty())
+        continue; // taken by another worker
+
+      const auto end = queue_.begin() + static_cast<std::ptrdiff_t>(
+        std::min(queue_.size(), max_batch_size_));
+      batch.assign(std::make_move_iterator(queue_.begin()),
+        std::make_move_iterator(end));
+      queue_.erase(queue_.begin(), end);
+    }
+    execute(batch);
+    batch.clear();
+  }
+}
+
+DMITIGR_PGFE_INLINE void Group_commit_executor::execute(std::vector<Pending>& batch)
+{
+  try {
+    auto handle = pool_.connection(std::nullopt);
+    if (!handle)
+      throw Client_exception{"cannot execute units of work by group commit "
+        "executor: no connection"};
+    auto& conn = *handle;
+    conn.set_pipeline_enabled(true);
+    commit(conn, batch);
+    conn.set_pipeline_enabled(false);
+  } catch (...) {
+    // The connection is closed by the pool if the pipeline is incomplete.
+    const auto e = std::current_exception();
+    for (auto& unit : batch) {
+      if (!unit.is_resolved_) {
+        unit.promise_.set_exception(e);
+        unit.is_resolved_ = true;
+      }
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Group_commit_executor::commit(Connection& conn, std::vector<Pending>& batch)
+{
+  const auto resolve = [](Pending& unit)
+  {
+    if (unit.exception_)
+      unit.promise_.set_exception(unit.exception_);
+    else if (unit.error_)
+      unit.promise_.set_exception(std::make_exception_ptr(Server_exception{
+        std::make_shared<Error>(std::move(unit.error_))}));
+    else if (!unit.is_completed_)
+      unit.promise_.set_exception(std::make_exception_ptr(Client_exception{
+        "cannot execute unit of work by group commit executor: aborted"}));
+    else
+      unit.promise_.set_value();
+    unit.is_resolved_ = true;
+  };
+
+  for (auto first = batch.begin(); ; ) {
+    detail::Control_outcome start;
+    if (first == batch.begin())
+      conn.execute_pipelined(start.handler(), "begin");
+    else {
+      // Restore the transaction aborted by the failed unit.
+      conn.execute_pipelined(start.handler(),
+        "rollback to savepoint pgfe_group_commit");
+      conn.execute_pipelined([](auto&&){},
+        "release savepoint pgfe_group_commit");
+    }
+    for (auto i = first; i != batch.end(); ++i)
+      queue(conn, *i);
+    detail::Control_outcome end;
+    conn.execute_pipelined(end.handler(), "commit");
+    conn.complete_pipeline();
+
+    start.throw_if_failed("cannot begin group transaction");
+    const auto failed = std::find_if(first, batch.end(),
+      [](const Pending& unit){return !unit.is_completed_;});
+    if (failed == batch.end()) {
+      end.throw_if_failed("cannot commit group transaction");
+      for (auto& unit : batch) {
+        if (!unit.is_resolved_)
+          resolve(unit);
+      }
+      return;
+    }
+
+    // The units preceding the failed one are kept in the transaction.
+    resolve(*failed);
+    first = failed + 1;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Group_commit_executor::queue(Connection& conn, Pending& unit)
+{
+  unit.error_ = Error{};
+  unit.exception_ = nullptr;
+  unit.is_completed_ = false;
+
+  const auto ignore = [](auto&&){};
+  conn.execute_pipelined(ignore, "savepoint pgfe_group_commit");
+  try {
+    Unit u{conn, unit};
+    unit.work_(u);
+  } catch (...) {
+    // Revert the statements queued before the exception.
+    unit.exception_ = std::current_exception();
+    conn.execute_pipelined(ignore,
+      "rollback to savepoint pgfe_group_commit");
+  }
+  conn.execute_pipelined([&unit](auto&& response)
+  {
+    if constexpr (std::is_same_v<std::decay_t<decltype(response)>, Completion>)
+      unit.is_completed_ = true;
+  }, "release savepoint pgfe_group_commit");
+}
+
+} // namespace dmitigr::pgfe
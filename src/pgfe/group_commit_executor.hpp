@@ -0,0 +1,260 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_GROUP_COMMIT_EXECUTOR_HPP
+#define DMITIGR_PGFE_GROUP_COMMIT_EXECUTOR_HPP
+
+#include "connection.hpp"
+#include "dll.hpp"
+#include "error.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief An executor which commits the small independent units of work
+ * submitted from many threads in groups.
+ *
+ * @details Each worker runs in its own thread, takes up to max_batch_size()
+ * of submitted units of work, acquires a connection from the pool and queues
+ * all the units in the pipeline in a single transaction, so the whole batch
+ * costs one round trip and one commit (one WAL flush) in the common case.
+ * Each unit is executed within its own savepoint. When a unit fails, the
+ * savepoint of the failed unit is rolled back, the units preceding it are
+ * kept, and the units following it are executed again. Thus, a failure of a
+ * unit doesn't affects the other units of the batch.
+ *
+ * @remarks The order in which the units are committed is unspecified.
+ *
+ * @see Connection_pool.
+ */
+class Group_commit_executor final {
+private:
+  struct Pending;
+
+public:
+  /// The default maximum number of units of work committed at once.
+  static constexpr std::size_t default_max_batch_size{64};
+
+  /// The default maximum delay of execution to wait for the batch to fill.
+  static constexpr std::chrono::microseconds default_max_delay{200};
+
+  /// A unit of work being executed.
+  class Unit final {
+  public:
+    /// Not copy-constructible.
+    Unit(const Unit&) = delete;
+
+    /// Not copy-assignable.
+    Unit& operator=(const Unit&) = delete;
+
+    /// @returns The connection the unit of work is executed on.
+    Connection& connection() const noexcept
+    {
+      return conn_;
+    }
+
+    /**
+     * @brief Queues the execution of the statement as the part of the unit
+     * of work.
+     *
+     * @details Unlike Connection::execute_pipelined(), `handler` is called
+     * with the rows and the completion only. The first error of the
+     * statements of the unit is reported by the future returned by submit().
+     *
+     * @see Connection::execute_pipelined().
+     */
+    template<typename F, typename ... Types>
+    std::enable_if_t<!std::is_convertible_v<F&&, const Statement&>>
+    execute(F&& handler, const Statement& statement, Types&& ... parameters)
+    {
+      conn_.execute_pipelined([&state = state_,
+          handler = std::forward<F>(handler)](auto&& response) mutable
+      {
+        using R = std::decay_t<decltype(response)>;
+        if constexpr (std::is_same_v<R, Error>) {
+          if (response && !state.error_)
+            state.error_ = std::move(response);
+        } else if constexpr (std::is_invocable_v<decltype(handler)&, R&&>)
+          handler(std::move(response));
+      }, statement, std::forward<Types>(parameters)...);
+    }
+
+    /// @overload
+    template<typename ... Types>
+    void execute(const Statement& statement, Types&& ... parameters)
+    {
+      execute([](auto&&){}, statement, std::forward<Types>(parameters)...);
+    }
+
+  private:
+    friend Group_commit_executor;
+
+    Connection& conn_;
+    Pending& state_;
+
+    Unit(Connection& conn, Pending& state) noexcept
+      : conn_{conn}
+      , state_{state}
+    {}
+  };
+
+  /**
+   * @brief The unit of work.
+   *
+   * @details The function must queue the statements of the unit of work by
+   * using Unit::execute() and must not wait for the responses.
+   *
+   * @remarks The function can be called more than once (if a unit of work
+   * of the same batch which is queued before fails), but the changes made by
+   * the unit of work are committed at most once.
+   */
+  using Work = std::function<void(Unit&)>;
+
+  /**
+   * @brief The constructor. Starts the workers.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the executor.
+   * @param worker_count The number of workers. Zero means `pool.size()`.
+   *
+   * @par Requires
+   * `worker_count || pool.size()`.
+   */
+  DMITIGR_PGFE_API explicit Group_commit_executor(Connection_pool& pool,
+    std::size_t worker_count = 0);
+
+  /// Calls stop().
+  DMITIGR_PGFE_API ~Group_commit_executor();
+
+  /// Not copy-constructible.
+  Group_commit_executor(const Group_commit_executor&) = delete;
+
+  /// Not copy-assignable.
+  Group_commit_executor& operator=(const Group_commit_executor&) = delete;
+
+  /// Not move-constructible.
+  Group_commit_executor(Group_commit_executor&&) = delete;
+
+  /// Not move-assignable.
+  Group_commit_executor& operator=(Group_commit_executor&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of units of work committed at once.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_max_batch_size(std::size_t value);
+
+  /// @returns The maximum number of units of work committed at once.
+  DMITIGR_PGFE_API std::size_t max_batch_size() const noexcept;
+
+  /**
+   * @brief Sets the maximum delay of execution to wait for the batch to fill.
+   *
+   * @details The greater delay trades the latency for the throughput.
+   *
+   * @par Requires
+   * `value >= std::chrono::microseconds::zero()`.
+   */
+  DMITIGR_PGFE_API void set_max_delay(std::chrono::microseconds value);
+
+  /// @returns The maximum delay of execution to wait for the batch to fill.
+  DMITIGR_PGFE_API std::chrono::microseconds max_delay() const noexcept;
+
+  /**
+   * @brief Submits the unit of work.
+   *
+   * @returns The future which is ready when the unit of work is committed or
+   * failed. The future holds either the Server_exception with the first error
+   * of the unit, or the exception thrown by `work`, or the exception of the
+   * execution of the whole batch (for example, on loss of connection).
+   *
+   * @par Requires
+   * `work && !is_stopped()`.
+   *
+   * @par Thread safety
+   * Thread-safe.
+   */
+  DMITIGR_PGFE_API std::future<void> submit(Work work);
+
+  /**
+   * @brief Stops accepting the units of work, waits for the submitted units
+   * to be executed and stops the workers.
+   *
+   * @par Effects
+   * `is_stopped()`.
+   */
+  DMITIGR_PGFE_API void stop();
+
+  /// @returns `true` if the executor is stopped.
+  DMITIGR_PGFE_API bool is_stopped() const noexcept;
+
+private:
+  struct Pending final {
+    Work work_;
+    std::promise<void> promise_;
+    Error error_; // the first error of the statements of the unit
+    std::exception_ptr exception_; // thrown by work_
+    bool is_completed_{}; // whether the savepoint of the unit is released
+    bool is_resolved_{}; // whether the promise_ is satisfied
+  };
+
+  Connection_pool& pool_;
+  mutable std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::deque<Pending> queue_;
+  std::vector<std::thread> workers_;
+  std::size_t max_batch_size_{default_max_batch_size};
+  std::chrono::microseconds max_delay_{default_max_delay};
+  bool is_stopped_{};
+
+  void work();
+  void execute(std::vector<Pending>& batch);
+  void commit(Connection& conn, std::vector<Pending>& batch);
+  void queue(Connection& conn, Pending& unit);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "group_commit_executor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_GROUP_COMMIT_EXECUTOR_HPP
@@ -0,0 +1,272 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "copier.hpp"
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "gzip_copy.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// A bounded queue of blocks of data passed between two threads.
+class Gzip_copy_queue final {
+public:
+  /// Pushes the `block`. Blocks while the queue is full.
+  bool push(std::string&& block)
+  {
+    std::unique_lock lk{mutex_};
+    cv_.wait(lk, [this]{return is_closed_ || blocks_.size() < capacity_;});
+    if (is_closed_)
+      return false;
+    blocks_.push_back(std::move(block));
+    cv_.notify_all();
+    return true;
+  }
+
+  /// Pops the block. Blocks while the queue is empty and not closed.
+  bool pop(std::string& block)
+  {
+    std::unique_lock lk{mutex_};
+    cv_.wait(lk, [this]{return is_closed_ || !blocks_.empty();});
+    if (blocks_.empty())
+      return false;
+    block = std::move(blocks_.front());
+    blocks_.pop_front();
+    cv_.notify_all();
+    return true;
+  }
+
+  /// Closes the queue. The remaining blocks are still can be popped.
+  void close() noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    is_closed_ = true;
+    cv_.notify_all();
+  }
+
+private:
+  static constexpr std::size_t capacity_{4};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::string> blocks_;
+  bool is_closed_{};
+};
+
+/// The file of gzip format.
+class Gzip_file final {
+public:
+  Gzip_file(const std::filesystem::path& path, const std::string& mode)
+#ifdef _WIN32
+    : file_{::gzopen_w(path.c_str(), mode.c_str())}
+#else
+    : file_{::gzopen(path.c_str(), mode.c_str())}
+#endif
+    , path_{path}
+  {
+    if (!file_)
+      throw Client_exception{"cannot open gzip file " + path_.string()};
+    ::gzbuffer(file_, 256 * 1024);
+  }
+
+  ~Gzip_file()
+  {
+    if (file_)
+      ::gzclose(file_);
+  }
+
+  Gzip_file(const Gzip_file&) = delete;
+  Gzip_file& operator=(const Gzip_file&) = delete;
+  Gzip_file(Gzip_file&&) = delete;
+  Gzip_file& operator=(Gzip_file&&) = delete;
+
+  void write(const std::string& block)
+  {
+    for (std::size_t offset{}; offset < block.size();) {
+      const auto size = static_cast<unsigned>(std::min<std::size_t>(
+        block.size() - offset, INT_MAX));
+      if (::gzwrite(file_, block.data() + offset, size) != static_cast<int>(size))
+        throw_error("cannot write gzip file");
+      offset += size;
+    }
+  }
+
+  std::size_t read(char* const buffer, const std::size_t size)
+  {
+    const int result{::gzread(file_, buffer, static_cast<unsigned>(size))};
+    if (result < 0)
+      throw_error("cannot read gzip file");
+    return static_cast<std::size_t>(result);
+  }
+
+  void close()
+  {
+    const int err{::gzclose(std::exchange(file_, nullptr))};
+    if (err != Z_OK)
+      throw Client_exception{"cannot close gzip file " + path_.string() +
+        ": error " + std::to_string(err)};
+  }
+
+private:
+  gzFile file_{};
+  std::filesystem::path path_;
+
+  [[noreturn]] void throw_error(const char* const what) const
+  {
+    int err{};
+    const char* const message{::gzerror(file_, &err)};
+    throw Client_exception{std::string{what} + " " + path_.string() + ": " +
+      (message ? message : "unknown error")};
+  }
+};
+
+/// Runs the background part of gzip copy and joins it on destruction.
+class Gzip_copy_worker final {
+public:
+  template<typename F>
+  Gzip_copy_worker(Gzip_copy_queue& queue, F&& work)
+    : queue_{queue}
+    , thread_{[this, work = std::forward<F>(work)]
+      {
+        try {
+          work();
+        } catch (...) {
+          error_ = std::current_exception();
+        }
+        queue_.close();
+      }}
+  {}
+
+  ~Gzip_copy_worker()
+  {
+    queue_.close();
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  Gzip_copy_worker(const Gzip_copy_worker&) = delete;
+  Gzip_copy_worker& operator=(const Gzip_copy_worker&) = delete;
+  Gzip_copy_worker(Gzip_copy_worker&&) = delete;
+  Gzip_copy_worker& operator=(Gzip_copy_worker&&) = delete;
+
+  /// Waits for the completion and rethrows the error if any.
+  void join()
+  {
+    thread_.join();
+    if (error_)
+      std::rethrow_exception(error_);
+  }
+
+private:
+  Gzip_copy_queue& queue_;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE std::uintmax_t copy_to_gzip_file(Copier& copier,
+  const std::filesystem::path& path, const int level,
+  const std::size_t block_size)
+{
+  if (!copier || copier.data_direction() != Data_direction::from_server)
+    throw Client_exception{"cannot COPY data to gzip file: "
+      "wrong data direction"};
+  else if (!(-1 <= level && level <= 9))
+    throw Client_exception{"cannot COPY data to gzip file: "
+      "invalid compression level"};
+  else if (!block_size)
+    throw Client_exception{"cannot COPY data to gzip file: "
+      "invalid block size"};
+
+  detail::Gzip_file file{path, level < 0 ? "wb" : "wb" + std::to_string(level)};
+  detail::Gzip_copy_queue queue;
+  detail::Gzip_copy_worker compressor{queue, [&queue, &file]
+  {
+    std::string block;
+    while (queue.pop(block))
+      file.write(block);
+    file.close();
+  }};
+
+  std::uintmax_t result{};
+  std::string block;
+  block.reserve(block_size);
+  while (const auto data = copier.receive()) {
+    block.append(static_cast<const char*>(data.bytes()), data.size());
+    result += data.size();
+    if (block.size() >= block_size) {
+      if (!queue.push(std::move(block)))
+        break; // the compressor is failed
+      block = {};
+      block.reserve(block_size);
+    }
+  }
+  if (!block.empty())
+    queue.push(std::move(block));
+  queue.close();
+  compressor.join();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::uintmax_t copy_from_gzip_file(Copier& copier,
+  const std::filesystem::path& path, const std::size_t block_size)
+{
+  if (!copier || copier.data_direction() != Data_direction::to_server)
+    throw Client_exception{"cannot COPY data from gzip file: "
+      "wrong data direction"};
+  else if (!block_size || block_size > INT_MAX)
+    throw Client_exception{"cannot COPY data from gzip file: "
+      "invalid block size"};
+
+  detail::Gzip_file file{path, "rb"};
+  detail::Gzip_copy_queue queue;
+  detail::Gzip_copy_worker decompressor{queue, [&queue, &file, block_size]
+  {
+    while (true) {
+      std::string block(block_size, '\0');
+      block.resize(file.read(block.data(), block.size()));
+      if (block.empty() || !queue.push(std::move(block)))
+        break;
+    }
+  }};
+
+  std::uintmax_t result{};
+  std::string block;
+  auto& conn = copier.connection();
+  while (queue.pop(block)) {
+    while (!copier.send(block))
+      conn.flush_output(true);
+    result += block.size();
+  }
+  decompressor.join();
+  return result;
+}
+
+} // namespace dmitigr::pgfe
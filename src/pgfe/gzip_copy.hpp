@@ -0,0 +1,100 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_GZIP_COPY_HPP
+#define DMITIGR_PGFE_GZIP_COPY_HPP
+
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace dmitigr::pgfe {
+
+/// The default size of block to pass between the threads.
+constexpr std::size_t default_gzip_copy_block_size{1024 * 1024};
+
+/**
+ * @ingroup main
+ *
+ * @brief Receives the data of `COPY TO STDOUT` and writes it compressed into
+ * the file of gzip format.
+ *
+ * @details The received rows are accumulated in blocks of about `block_size`
+ * bytes which are compressed and written by the background thread, so the
+ * receiving is overlapped with the compression and the IO.
+ *
+ * @param copier The copier to receive the data by.
+ * @param path The path to the file to create (or truncate).
+ * @param level The compression level from `0` to `9`, or `-1` for the
+ * default level of zlib.
+ * @param block_size The size of block.
+ *
+ * @par Requires
+ * `copier.data_direction() == Data_direction::from_server &&
+ * level >= -1 && level <= 9 && block_size`.
+ *
+ * @returns The number of received (uncompressed) bytes.
+ *
+ * @remarks This function is available only if the build option
+ * `DMITIGR_LIBS_ZLIB` is enabled.
+ *
+ * @see copy_from_gzip_file().
+ */
+DMITIGR_PGFE_API std::uintmax_t copy_to_gzip_file(Copier& copier,
+  const std::filesystem::path& path, int level = -1,
+  std::size_t block_size = default_gzip_copy_block_size);
+
+/**
+ * @ingroup main
+ *
+ * @brief Reads the file of gzip format and sends its decompressed content
+ * as the data of `COPY FROM STDIN`.
+ *
+ * @details The file is read and decompressed by the background thread in
+ * blocks of `block_size` bytes, so the decompression and the IO are
+ * overlapped with the sending.
+ *
+ * @param copier The copier to send the data by.
+ * @param path The path to the file.
+ * @param block_size The size of block.
+ *
+ * @par Requires
+ * `copier.data_direction() == Data_direction::to_server &&
+ * block_size && block_size <= INT_MAX`.
+ *
+ * @returns The number of sent (decompressed) bytes.
+ *
+ * @remarks This function is available only if the build option
+ * `DMITIGR_LIBS_ZLIB` is enabled.
+ *
+ * @warning Doesn't calls Copier::end()!
+ *
+ * @see copy_to_gzip_file().
+ */
+DMITIGR_PGFE_API std::uintmax_t copy_from_gzip_file(Copier& copier,
+  const std::filesystem::path& path,
+  std::size_t block_size = default_gzip_copy_block_size);
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "gzip_copy.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_GZIP_COPY_HPP
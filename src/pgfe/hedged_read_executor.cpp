@@ -0,0 +1,238 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../net/socket.hpp"
+#include "exceptions.hpp"
+#include "hedged_read_executor.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Hedged_read_executor::Race::~Race()
+{
+  if (!loser_)
+    return;
+
+  auto& conn = **loser_;
+  try {
+    if (conn.has_uncompleted_request()) {
+      conn.cancel_request_nio();
+      while (conn.has_uncompleted_request())
+        conn.process_responses([](Row&&, Error&&){});
+    }
+  } catch (...) {
+    // The pool disconnects the connection if it's not ready for request.
+  }
+}
+
+DMITIGR_PGFE_INLINE
+Hedged_read_executor::Hedged_read_executor(Routing_connection_pool& pool)
+  : pool_{pool}
+{
+  if (!pool)
+    throw Client_exception{"cannot create hedged read executor: "
+      "invalid connection pool"};
+}
+
+DMITIGR_PGFE_INLINE Routing_connection_pool&
+Hedged_read_executor::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE void Hedged_read_executor::set_hedge_delay(
+  const std::optional<std::chrono::milliseconds> value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  hedge_delay_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Hedged_read_executor::hedge_delay() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hedge_delay_;
+}
+
+DMITIGR_PGFE_INLINE void Hedged_read_executor::set_hedge_percentile(
+  const double value)
+{
+  if (!(0 < value && value <= 100))
+    throw Client_exception{"cannot set hedge percentile: invalid value"};
+
+  const std::lock_guard lg{mutex_};
+  hedge_percentile_ = value;
+}
+
+DMITIGR_PGFE_INLINE double Hedged_read_executor::hedge_percentile() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hedge_percentile_;
+}
+
+DMITIGR_PGFE_INLINE void Hedged_read_executor::set_min_sample_count(
+  const std::uint_least64_t value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  min_sample_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Hedged_read_executor::min_sample_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return min_sample_count_;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Hedged_read_executor::effective_hedge_delay() const
+{
+  const std::lock_guard lg{mutex_};
+  if (hedge_delay_)
+    return hedge_delay_;
+  else if (latencies_.count() < min_sample_count_)
+    return std::nullopt;
+  else
+    return std::chrono::ceil<std::chrono::milliseconds>(
+      latencies_.percentile(hedge_percentile_));
+}
+
+DMITIGR_PGFE_INLINE Duration_histogram Hedged_read_executor::latencies() const
+{
+  const std::lock_guard lg{mutex_};
+  return latencies_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Hedged_read_executor::hedged_request_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hedged_request_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Hedged_read_executor::hedge_win_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hedge_win_count_;
+}
+
+DMITIGR_PGFE_INLINE Connection&
+Hedged_read_executor::run(Race& race,
+  const std::function<void(Connection&)>& send)
+{
+  using Clock = std::chrono::steady_clock;
+  using std::chrono::ceil;
+  using std::chrono::milliseconds;
+
+  const auto delay = effective_hedge_delay();
+  race.first_ = pool_.connection(Session_mode::read_only, std::nullopt);
+  if (!*race.first_)
+    throw Client_exception{"cannot execute hedged request: "
+      "no connection available"};
+
+  const auto timeout = (*race.first_)->options().wait_response_timeout();
+  const auto start = Clock::now();
+  const auto deadline = start + timeout.value_or(milliseconds{});
+  send(**race.first_);
+
+  bool is_hedge_pending{delay.has_value()};
+  Handle* winner{};
+  std::array<Handle*, 2> handles{};
+  std::array<net::Poll_entry, 2> entries;
+  while (true) {
+    std::size_t count{};
+    handles[count++] = &*race.first_;
+    if (race.second_)
+      handles[count++] = &*race.second_;
+    for (std::size_t i{}; i < count && !winner; ++i) {
+      if ((*handles[i])->handle_input() != Response_status::unready)
+        winner = handles[i];
+    }
+    if (winner)
+      break;
+
+    const auto now = Clock::now();
+    if (timeout && now >= deadline)
+      throw Client_exception{Client_errc::timed_out,
+        "wait response timeout expired"};
+
+    auto wait_timeout = milliseconds{-1};
+    if (is_hedge_pending) {
+      if (now - start >= *delay) {
+        is_hedge_pending = false;
+        if (auto second = second_connection(race.first_->pool())) {
+          try {
+            send(**second);
+            race.second_ = std::move(second);
+            const std::lock_guard lg{mutex_};
+            ++hedged_request_count_;
+          } catch (...) {
+            // Just continue waiting for the first server.
+          }
+        }
+        continue;
+      } else
+        wait_timeout = ceil<milliseconds>(start + *delay - now);
+    }
+    if (timeout) {
+      const auto left = ceil<milliseconds>(deadline - now);
+      wait_timeout = wait_timeout.count() < 0 ? left :
+        std::min(wait_timeout, left);
+    }
+
+    for (std::size_t i{}; i < count; ++i)
+      entries[i] = {static_cast<net::Socket_native>((*handles[i])->socket()),
+        net::Socket_readiness::read_ready};
+    net::poll_many(entries.data(), count, wait_timeout);
+    for (std::size_t i{}; i < count; ++i) {
+      if (entries[i].readiness != net::Socket_readiness::unready)
+        (*handles[i])->read_input();
+    }
+  }
+
+  {
+    const std::lock_guard lg{mutex_};
+    latencies_.record(Clock::now() - start);
+    if (race.second_ && winner == &*race.second_)
+      ++hedge_win_count_;
+  }
+  if (race.second_)
+    race.loser_ = winner == &*race.first_ ? &*race.second_ : &*race.first_;
+  return **winner;
+}
+
+DMITIGR_PGFE_INLINE auto
+Hedged_read_executor::second_connection(const Connection_pool* const excluded)
+  -> std::optional<Handle>
+{
+  for (std::size_t i{}; i < pool_.replica_count(); ++i) {
+    auto& replica = pool_.replica(i);
+    if (&replica == excluded || !pool_.is_replica_available(i))
+      continue;
+    else if (auto result = replica.try_connection())
+      return result;
+  }
+  if (&pool_.primary() != excluded) {
+    if (auto result = pool_.primary().try_connection())
+      return result;
+  }
+  return std::nullopt;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,211 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_HEDGED_READ_EXECUTOR_HPP
+#define DMITIGR_PGFE_HEDGED_READ_EXECUTOR_HPP
+
+#include "basics.hpp"
+#include "completion.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "dll.hpp"
+#include "metrics.hpp"
+#include "routing_connection_pool.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe executor of the hedged read requests.
+ *
+ * @details The statement is executed on a read-only connection of the routing
+ * pool. If there is no response within the hedge delay, the same statement is
+ * executed on a connection of another server of the pool (a replica, or the
+ * primary if there are no other available replicas). The first response wins
+ * and the rows are delivered from the winner only, while the processing on
+ * the other server is canceled (see Connection::cancel_request_nio()) and
+ * its connection is returned to the pool after receiving the response.
+ *
+ * By default, the hedge delay is the 95th percentile of the latencies of the
+ * first responses of the previous requests. The requests are not hedged until
+ * min_sample_count() latencies are recorded.
+ *
+ * @warning Only the idempotent read-only statements must be executed, since
+ * the statement can be executed on two servers.
+ */
+class Hedged_read_executor final {
+public:
+  /// The default percentile of the latencies used as the hedge delay.
+  static constexpr double default_hedge_percentile{95};
+
+  /// The default minimum number of latencies to start hedging.
+  static constexpr std::uint_least64_t default_min_sample_count{20};
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the executor.
+   *
+   * @par Requires
+   * `pool`.
+   */
+  DMITIGR_PGFE_API explicit Hedged_read_executor(Routing_connection_pool& pool);
+
+  /// Not copy-constructible.
+  Hedged_read_executor(const Hedged_read_executor&) = delete;
+
+  /// Not copy-assignable.
+  Hedged_read_executor& operator=(const Hedged_read_executor&) = delete;
+
+  /// Not move-constructible.
+  Hedged_read_executor(Hedged_read_executor&&) = delete;
+
+  /// Not move-assignable.
+  Hedged_read_executor& operator=(Hedged_read_executor&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Routing_connection_pool& pool() const noexcept;
+
+  /**
+   * @brief Sets the fixed hedge delay.
+   *
+   * @param value The value of `std::nullopt` means the adaptive delay (see
+   * hedge_percentile()).
+   */
+  DMITIGR_PGFE_API void
+  set_hedge_delay(std::optional<std::chrono::milliseconds> value) noexcept;
+
+  /// @returns The fixed hedge delay.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  hedge_delay() const noexcept;
+
+  /**
+   * @brief Sets the percentile of the latencies used as the adaptive hedge
+   * delay.
+   *
+   * @par Requires
+   * `0 < value && value <= 100`.
+   */
+  DMITIGR_PGFE_API void set_hedge_percentile(double value);
+
+  /// @returns The percentile of the latencies used as the adaptive hedge delay.
+  DMITIGR_PGFE_API double hedge_percentile() const noexcept;
+
+  /// Sets the minimum number of latencies to start adaptive hedging.
+  DMITIGR_PGFE_API void set_min_sample_count(std::uint_least64_t value) noexcept;
+
+  /// @returns The minimum number of latencies to start adaptive hedging.
+  DMITIGR_PGFE_API std::uint_least64_t min_sample_count() const noexcept;
+
+  /**
+   * @returns The hedge delay to be used for the next request, or
+   * `std::nullopt` if the next request will not be hedged.
+   */
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  effective_hedge_delay() const;
+
+  /// @returns The histogram of the latencies of the first responses.
+  DMITIGR_PGFE_API Duration_histogram latencies() const;
+
+  /// @returns The number of the hedged requests.
+  DMITIGR_PGFE_API std::uint_least64_t hedged_request_count() const noexcept;
+
+  /// @returns The number of the hedged requests won by the second server.
+  DMITIGR_PGFE_API std::uint_least64_t hedge_win_count() const noexcept;
+
+  /**
+   * @brief Executes the statement as described in the class details.
+   *
+   * @param callback Same as for Connection::process_responses().
+   * @param statement A *preparsed* idempotent read-only statement to execute.
+   * @param parameters Parameters to bind with a parameterized statement. They
+   * may be converted twice.
+   *
+   * @returns The Completion of the winner.
+   *
+   * @throws Client_exception with code Client_errc::timed_out if there is no
+   * response within `wait_response_timeout()` of the options of the
+   * connection of the first server.
+   *
+   * @see Connection::execute().
+   */
+  template<Row_processing on_exception = Row_processing::complete, typename F,
+    typename ... Types>
+  std::enable_if_t<detail::Response_callback_traits<F>::is_valid, Completion>
+  execute(F&& callback, const Statement& statement, const Types& ... parameters)
+  {
+    Race race;
+    Connection& conn = run(race, [&statement, &parameters...](Connection& conn)
+    {
+      conn.execute_nio(statement, parameters...);
+    });
+    return conn.process_responses<on_exception>(std::forward<F>(callback));
+  }
+
+  /// @overload
+  template<Row_processing on_exception = Row_processing::complete,
+    typename ... Types>
+  Completion execute(const Statement& statement, const Types& ... parameters)
+  {
+    return execute<on_exception>([](Row&&){}, statement, parameters...);
+  }
+
+private:
+  using Handle = Connection_pool::Handle;
+
+  /// The state of the request executed on up to two servers.
+  struct Race final {
+    std::optional<Handle> first_;
+    std::optional<Handle> second_;
+    Handle* loser_{};
+
+    /// Cancels the request of the loser and drains its responses.
+    DMITIGR_PGFE_API ~Race();
+  };
+
+  Routing_connection_pool& pool_;
+  mutable std::mutex mutex_;
+  std::optional<std::chrono::milliseconds> hedge_delay_;
+  double hedge_percentile_{default_hedge_percentile};
+  std::uint_least64_t min_sample_count_{default_min_sample_count};
+  Duration_histogram latencies_;
+  std::uint_least64_t hedged_request_count_{};
+  std::uint_least64_t hedge_win_count_{};
+
+  DMITIGR_PGFE_API Connection& run(Race& race,
+    const std::function<void(Connection&)>& send);
+  std::optional<Handle> second_connection(const Connection_pool* excluded);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "hedged_read_executor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_HEDGED_READ_EXECUTOR_HPP
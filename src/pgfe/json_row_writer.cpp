@@ -0,0 +1,327 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../str/hex.hpp"
+#include "../str/simd.hpp"
+#include "conversions.hpp"
+#include "exceptions.hpp"
+#include "json_row_writer.hpp"
+#include "row.hpp"
+#include "row_batch.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/**
+ * @returns The pointer to the first of `"`, `\` or control character in
+ * [first, last), or `last` if there is no such a character.
+ */
+inline const char* scan_json_string(const char* first,
+  const char* const last) noexcept
+{
+#if defined(DMITIGR_STR_SSE2)
+  const auto quote = _mm_set1_epi8('"');
+  const auto backslash = _mm_set1_epi8('\\');
+  const auto control = _mm_set1_epi8(0x1f);
+  for (; last - first >= 16; first += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    const auto special = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+      _mm_cmpeq_epi8(_mm_min_epu8(v, control), v)); // v <= 0x1f
+    if (_mm_movemask_epi8(special))
+      break; // the block is scanned below
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto quote = vdupq_n_u8('"');
+  const auto backslash = vdupq_n_u8('\\');
+  const auto control = vdupq_n_u8(0x20);
+  for (; last - first >= 16; first += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+    const auto special = vorrq_u8(
+      vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)),
+      vcltq_u8(v, control));
+    if (vmaxvq_u8(special))
+      break; // the block is scanned below
+  }
+#endif
+  for (; first != last; ++first) {
+    const auto c = static_cast<unsigned char>(*first);
+    if (c == '"' || c == '\\' || c < 0x20)
+      break;
+  }
+  return first;
+}
+
+/// Appends `value` to `output` as the JSON string.
+inline void append_json_string(std::string& output, const std::string_view value)
+{
+  static const char hex[] = "0123456789abcdef";
+  const char* first{value.data()};
+  const char* const last{first + value.size()};
+  output += '"';
+  while (true) {
+    const char* const special{scan_json_string(first, last)};
+    output.append(first, special);
+    if (special == last)
+      break;
+
+    const auto c = static_cast<unsigned char>(*special);
+    switch (c) {
+    case '"': output += "\\\""; break;
+    case '\\': output += "\\\\"; break;
+    case '\b': output += "\\b"; break;
+    case '\f': output += "\\f"; break;
+    case '\n': output += "\\n"; break;
+    case '\r': output += "\\r"; break;
+    case '\t': output += "\\t"; break;
+    default:
+      output += "\\u00";
+      output += hex[c >> 4];
+      output += hex[c & 0x0f];
+    }
+    first = special + 1;
+  }
+  output += '"';
+}
+
+/**
+ * @brief Appends the text representation of the floating point number to
+ * `output` as the JSON number, or as the JSON string if it's not finite.
+ */
+inline void append_json_number_text(std::string& output,
+  const std::string_view text)
+{
+  if (text == "NaN" || text == "Infinity" || text == "-Infinity") {
+    output += '"';
+    output += text;
+    output += '"';
+  } else
+    output += text;
+}
+
+/// Appends `value` to `output` as the JSON number.
+template<typename T>
+void append_json_number(std::string& output, const T value)
+{
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(value))
+      return append_json_number_text(output, "NaN");
+    else if (std::isinf(value))
+      return append_json_number_text(output, value > 0 ? "Infinity" :
+        "-Infinity");
+  }
+  char buf[64];
+  output.append(buf, numeric_to_chars(buf, buf + sizeof(buf), value));
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Json_row_writer::Json_row_writer(const Row_info& info)
+{
+  fields_.reserve(info.field_count());
+  for (std::size_t i{}; i < info.field_count(); ++i) {
+    Field field;
+    detail::append_json_string(field.key, info.field_name(i));
+    field.key += ':';
+    field.type = static_cast<Oid>(info.type_oid(i));
+    switch (field.type) {
+    case 16: // bool
+      field.kind = Kind::boolean;
+      break;
+    case 21: // int2
+      [[fallthrough]];
+    case 23: // int4
+      [[fallthrough]];
+    case 20: // int8
+      [[fallthrough]];
+    case 26: // oid
+      field.kind = Kind::number;
+      break;
+    case 700: // float4
+      [[fallthrough]];
+    case 701: // float8
+      [[fallthrough]];
+    case 1700: // numeric
+      field.kind = Kind::floating;
+      break;
+    case 114: // json
+      [[fallthrough]];
+    case 3802: // jsonb
+      field.kind = Kind::json;
+      break;
+    default:
+      field.kind = Kind::string;
+    }
+    fields_.push_back(std::move(field));
+  }
+}
+
+DMITIGR_PGFE_INLINE std::size_t Json_row_writer::field_count() const noexcept
+{
+  return fields_.size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Json_row_writer::row_count() const noexcept
+{
+  return row_count_;
+}
+
+DMITIGR_PGFE_INLINE void Json_row_writer::reset() noexcept
+{
+  row_count_ = 0;
+}
+
+DMITIGR_PGFE_INLINE void
+Json_row_writer::write(std::string& output, const Row& row)
+{
+  if (!row)
+    throw Client_exception{"cannot write row as JSON: invalid row"};
+  else if (row.field_count() != fields_.size())
+    throw Client_exception{"cannot write row as JSON: invalid field count"};
+
+  const auto size = output.size();
+  try {
+    write_object(output, [&row](const std::size_t field)
+    {
+      return row.data(field);
+    });
+  } catch (...) {
+    output.resize(size);
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Json_row_writer::write(std::string& output, const Row_batch& batch)
+{
+  if (!batch)
+    throw Client_exception{"cannot write row batch as JSON: invalid batch"};
+  else if (batch.field_count() != fields_.size())
+    throw Client_exception{"cannot write row batch as JSON: "
+      "invalid field count"};
+
+  const auto size = output.size();
+  const auto row_count = row_count_;
+  try {
+    for (std::size_t row{}; row < batch.row_count(); ++row) {
+      write_object(output, [&batch, row](const std::size_t field)
+      {
+        return batch.data(row, field);
+      });
+    }
+  } catch (...) {
+    output.resize(size);
+    row_count_ = row_count;
+    throw;
+  }
+}
+
+template<class Getter>
+void Json_row_writer::write_object(std::string& output, const Getter& data)
+{
+  if (row_count_)
+    output += ',';
+  output += '{';
+  for (std::size_t i{}; i < fields_.size(); ++i) {
+    const auto& field = fields_[i];
+    if (i)
+      output += ',';
+    output += field.key;
+    if (const auto d = data(i))
+      write_value(output, field, d);
+    else
+      output += "null";
+  }
+  output += '}';
+  ++row_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Json_row_writer::write_value(std::string& output, const Field& field,
+  const Data& data) const
+{
+  const std::string_view text{static_cast<const char*>(data.bytes()),
+    data.size()};
+  const bool is_binary{data.format() == Data_format::binary};
+  switch (field.kind) {
+  case Kind::boolean:
+    output += to<bool>(data) ? "true" : "false";
+    return;
+  case Kind::number:
+    if (!is_binary)
+      output += text;
+    else if (field.type == 21)
+      detail::append_json_number(output, to<std::int16_t>(data));
+    else if (field.type == 23)
+      detail::append_json_number(output, to<std::int32_t>(data));
+    else if (field.type == 20)
+      detail::append_json_number(output, to<std::int64_t>(data));
+    else
+      detail::append_json_number(output, to<std::uint32_t>(data));
+    return;
+  case Kind::floating:
+    if (!is_binary)
+      detail::append_json_number_text(output, text);
+    else if (field.type == 700)
+      detail::append_json_number(output, to<float>(data));
+    else if (field.type == 701)
+      detail::append_json_number(output, to<double>(data));
+    else
+      detail::append_json_number_text(output, to<Numeric>(data).to_string());
+    return;
+  case Kind::json:
+    output += detail::json_text(data);
+    return;
+  case Kind::string:
+    if (!is_binary)
+      return detail::append_json_string(output, text);
+
+    switch (field.type) {
+    case 25: // text
+      [[fallthrough]];
+    case 1043: // varchar
+      [[fallthrough]];
+    case 1042: // bpchar
+      [[fallthrough]];
+    case 19: // name
+      return detail::append_json_string(output, text);
+    case 17: { // bytea
+      const auto offset = output.size();
+      output.resize(offset + 2*data.size() + 5);
+      auto* const dest = output.data() + offset;
+      dest[0] = '"'; dest[1] = '\\'; dest[2] = '\\'; dest[3] = 'x';
+      str::hex_encode(dest + 4, data.bytes(), data.size());
+      output.back() = '"';
+      return;
+    }
+    case 2950: // uuid
+      output += '"';
+      output += to<Uuid>(data).to_string();
+      output += '"';
+      return;
+    default:
+      throw Client_exception{"cannot write field data as JSON: "
+        "unsupported type of data in binary format"};
+    }
+  }
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,145 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_JSON_ROW_WRITER_HPP
+#define DMITIGR_PGFE_JSON_ROW_WRITER_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A writer of the rows as JSON objects.
+ *
+ * @details The field data is written directly to the output buffer, without
+ * intermediate strings or objects. Each row is written as the object whose
+ * keys are the field names. The rows are separated by commas, so the rows of
+ * the multiple batches written by the same writer form the elements of a
+ * single JSON array. For example:
+ * @code
+ * std::string output{'['};
+ * std::optional<Json_row_writer> writer;
+ * conn.execute([&](Row_batch&& batch)
+ * {
+ *   if (!writer)
+ *     writer.emplace(batch.info());
+ *   writer->write(output, batch);
+ * }, "select id, name, tags from item");
+ * output += ']';
+ * @endcode
+ *
+ * The values are written by the types of the fields as follows:
+ *   - `bool` - `true` or `false`;
+ *   - `int2`, `int4`, `int8`, `oid` - number;
+ *   - `float4`, `float8`, `numeric` - number, or string for `NaN`,
+ *   `Infinity` and `-Infinity`;
+ *   - `json`, `jsonb` - the JSON text as is;
+ *   - any other type - string;
+ *   - SQL NULL - `null`.
+ *
+ * Both data formats are accepted for the types listed above and for `text`,
+ * `varchar`, `bpchar`, `name`, `bytea` and `uuid`. The data of the other types
+ * must be in Data_format::text format.
+ *
+ * @see Row, Row_batch, Arrow_batch_builder.
+ */
+class Json_row_writer final {
+public:
+  /// The constructor. The fields are taken from `info`.
+  DMITIGR_PGFE_API explicit Json_row_writer(const Row_info& info);
+
+  /// @returns The number of fields of the rows.
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept;
+
+  /// @returns The number of rows written since the last reset.
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /**
+   * @brief Resets the row count.
+   *
+   * @details The next row is written without the preceding comma.
+   *
+   * @par Effects
+   * `!row_count()`.
+   */
+  DMITIGR_PGFE_API void reset() noexcept;
+
+  /**
+   * @brief Appends `row` to `output` as a JSON object.
+   *
+   * @details The object is preceded by a comma if `row_count()`.
+   *
+   * @par Requires
+   * `row && row.field_count() == field_count()`.
+   *
+   * @throws Client_exception if some field data cannot be written.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void write(std::string& output, const Row& row);
+
+  /**
+   * @brief Appends all rows of `batch` to `output` as the JSON objects
+   * separated by commas.
+   *
+   * @details The first object is preceded by a comma if `row_count()`.
+   *
+   * @par Requires
+   * `batch && batch.field_count() == field_count()`.
+   *
+   * @throws Client_exception if some field data cannot be written.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void write(std::string& output, const Row_batch& batch);
+
+private:
+  /// A representation of the field values.
+  enum class Kind { boolean, number, floating, json, string };
+
+  /// A field of the rows.
+  struct Field final {
+    std::string key; // the escaped name with the quotes and the colon
+    Oid type{};
+    Kind kind{};
+  };
+
+  std::vector<Field> fields_;
+  std::size_t row_count_{};
+
+  template<class Getter>
+  void write_object(std::string& output, const Getter& data);
+  void write_value(std::string& output, const Field& field,
+    const Data& data) const;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "json_row_writer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_JSON_ROW_WRITER_HPP
@@ -14,12 +14,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "../net/descriptor.hpp"
 #include "connection.hpp"
 #include "exceptions.hpp"
 #include "large_object.hpp"
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 
 namespace dmitigr::pgfe {
 
@@ -30,7 +32,7 @@ DMITIGR_PGFE_INLINE Large_object::~Large_object() noexcept
     auto [p, e] = conn->registered_lo(state_->id_);
     DMITIGR_ASSERT(p != e);
     state_ = nullptr;
-    DMITIGR_ASSERT((*p).use_count() == 1);
+    DMITIGR_ASSERT(p->second.use_count() == 1);
     conn->unregister_lo(p);
     DMITIGR_ASSERT(!is_valid());
   }
@@ -114,6 +116,51 @@ Large_object::read(char* const buf, const std::size_t size)
   return static_cast<std::size_t>(state_->connection_->read(*this, buf, size));
 }
 
+DMITIGR_PGFE_INLINE std::size_t
+Large_object::read_into(char* const buf, const std::size_t size)
+{
+  if (!(is_valid() && buf))
+    throw Client_exception{"cannot read large object"};
+
+  constexpr std::size_t max_size{std::numeric_limits<int>::max()};
+  std::size_t result{};
+  while (result < size) {
+    const auto request_size = std::min(size - result, max_size);
+    const auto read_size = static_cast<std::size_t>(
+      state_->connection_->read(*this, buf + result, request_size));
+    result += read_size;
+    if (read_size < request_size)
+      break;
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::uintmax_t
+Large_object::send_to(net::Descriptor& descriptor, const std::size_t chunk_size)
+{
+  if (!(is_valid() && chunk_size &&
+      chunk_size <= static_cast<std::size_t>(std::numeric_limits<int>::max())))
+    throw Client_exception{"cannot send large object"};
+
+  std::uintmax_t result{};
+  const auto buf = std::make_unique<char[]>(chunk_size);
+  while (true) {
+    const auto size = read_into(buf.get(), chunk_size);
+    for (std::size_t offset{}; offset < size;) {
+      const auto written = descriptor.write(buf.get() + offset,
+        static_cast<std::streamsize>(size - offset));
+      if (written <= 0)
+        throw Client_exception{"cannot send large object: "
+          "cannot write to descriptor"};
+      offset += static_cast<std::size_t>(written);
+    }
+    result += size;
+    if (size < chunk_size)
+      break;
+  }
+  return result;
+}
+
 DMITIGR_PGFE_INLINE std::size_t
 Large_object::write(const char* const buf, const std::size_t size)
 {
@@ -17,10 +17,12 @@
 #ifndef DMITIGR_PGFE_LARGE_OBJECT_HPP
 #define DMITIGR_PGFE_LARGE_OBJECT_HPP
 
+#include "../net/types_fwd.hpp"
 #include "basics.hpp"
 #include "dll.hpp"
 #include "types_fwd.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -216,6 +218,51 @@ public:
    */
   DMITIGR_PGFE_API std::size_t read(char* buf, std::size_t size);
 
+  /**
+   * @brief Reads `size` bytes, or up to the end of the large object, from the
+   * current position associated with the underlying large object descriptor
+   * directly into `buf`.
+   *
+   * @details Unlike read(), the `size` is not limited and the data is read
+   * by as many calls of `lo_read()` as needed. Thus, `buf` can be, for
+   * example, an entire memory-mapped region of the output file.
+   *
+   * @returns The number of bytes actually read, which is less than `size`
+   * only if the end of the large object is reached.
+   *
+   * @throw Client_exception on error.
+   *
+   * @par Requires
+   * `buf`.
+   *
+   * @remarks The behavior is undefined if the actual size of `buf` is less
+   * than `size`.
+   */
+  DMITIGR_PGFE_API std::size_t read_into(char* buf, std::size_t size);
+
+  /// The default size of chunk of send_to().
+  static constexpr std::size_t default_send_chunk_size{256*1024};
+
+  /**
+   * @brief Reads the large object from the current position associated with
+   * the underlying large object descriptor up to the end of the large object
+   * and writes the data to `descriptor`.
+   *
+   * @details The data is read by chunks of `chunk_size` bytes into the single
+   * buffer, which is written to `descriptor` as is. Thus, each byte is copied
+   * only once on the client side.
+   *
+   * @returns The number of bytes sent.
+   *
+   * @throw Client_exception on error of reading the large object, and the
+   * exceptions of `descriptor` on error of writing.
+   *
+   * @par Requires
+   * `chunk_size && (chunk_size <= std::numeric_limits<int>::max())`.
+   */
+  DMITIGR_PGFE_API std::uintmax_t send_to(net::Descriptor& descriptor,
+    std::size_t chunk_size = default_send_chunk_size);
+
   /**
    * @brief Writes up to `size` bytes from the current position associated with
    * the underlying large object descriptor from `buf`.
@@ -245,6 +292,7 @@ public:
 
 private:
   friend Connection;
+  friend Large_object_streambuf;
 
   /// A state.
   struct State final {
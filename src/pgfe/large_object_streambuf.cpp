@@ -0,0 +1,228 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "error.hpp"
+#include "exceptions.hpp"
+#include "large_object.hpp"
+#include "large_object_streambuf.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Large_object_streambuf::~Large_object_streambuf()
+{
+  try {
+    write_put_area();
+  } catch (...) {}
+}
+
+DMITIGR_PGFE_INLINE
+Large_object_streambuf::Large_object_streambuf(Large_object& large_object,
+  const std::size_t chunk_size, const std::size_t read_ahead)
+  : large_object_{&large_object}
+  , chunk_size_{chunk_size}
+  , read_ahead_{read_ahead}
+{
+  if (!large_object)
+    throw Client_exception{"cannot create large object stream buffer: "
+      "invalid large object"};
+  else if (!chunk_size ||
+    chunk_size > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    throw Client_exception{"cannot create large object stream buffer: "
+      "invalid chunk size"};
+  else if (!read_ahead)
+    throw Client_exception{"cannot create large object stream buffer: "
+      "invalid read ahead"};
+}
+
+DMITIGR_PGFE_INLINE Large_object&
+Large_object_streambuf::large_object() const noexcept
+{
+  return *large_object_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Large_object_streambuf::chunk_size() const noexcept
+{
+  return chunk_size_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Large_object_streambuf::read_ahead() const noexcept
+{
+  return read_ahead_;
+}
+
+DMITIGR_PGFE_INLINE auto Large_object_streambuf::underflow() -> int_type
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+
+  write_put_area();
+  if (get_area_.empty())
+    get_area_.resize(chunk_size_ * read_ahead_);
+  const std::size_t size{read_chunks(get_area_.data())};
+  if (!size) {
+    setg(nullptr, nullptr, nullptr);
+    return traits_type::eof();
+  }
+  setg(get_area_.data(), get_area_.data(), get_area_.data() + size);
+  return traits_type::to_int_type(*gptr());
+}
+
+DMITIGR_PGFE_INLINE auto
+Large_object_streambuf::overflow(const int_type ch) -> int_type
+{
+  discard_get_area();
+  if (!pbase()) {
+    put_area_.resize(chunk_size_);
+    setp(put_area_.data(), put_area_.data() + put_area_.size());
+  } else if (pptr() == epptr())
+    write_put_area();
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+DMITIGR_PGFE_INLINE int Large_object_streambuf::sync()
+{
+  try {
+    write_put_area();
+    discard_get_area();
+    return 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+DMITIGR_PGFE_INLINE auto
+Large_object_streambuf::seekoff(off_type off, const std::ios_base::seekdir dir,
+  const std::ios_base::openmode) -> pos_type
+{
+  write_put_area();
+  if (dir == std::ios_base::cur)
+    off -= egptr() - gptr();
+  setg(nullptr, nullptr, nullptr);
+
+  const auto whence = dir == std::ios_base::beg ?
+    Large_object_seek_whence::begin : dir == std::ios_base::cur ?
+    Large_object_seek_whence::current : Large_object_seek_whence::end;
+  return pos_type(static_cast<off_type>(large_object_->seek(off, whence)));
+}
+
+DMITIGR_PGFE_INLINE auto
+Large_object_streambuf::seekpos(const pos_type pos,
+  const std::ios_base::openmode which) -> pos_type
+{
+  return seekoff(off_type(pos), std::ios_base::beg, which);
+}
+
+DMITIGR_PGFE_INLINE void Large_object_streambuf::write_put_area()
+{
+  if (!pbase())
+    return;
+
+  const char* data{pbase()};
+  std::size_t size = pptr() - pbase();
+  while (size) {
+    const std::size_t written{large_object_->write(data, size)};
+    if (!written)
+      throw Client_exception{"cannot write large object"};
+    data += written;
+    size -= written;
+  }
+  setp(put_area_.data(), put_area_.data() + put_area_.size());
+}
+
+DMITIGR_PGFE_INLINE void Large_object_streambuf::discard_get_area()
+{
+  if (gptr() < egptr())
+    large_object_->seek(gptr() - egptr(), Large_object_seek_whence::current);
+  setg(nullptr, nullptr, nullptr);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Large_object_streambuf::read_chunks(char* const buf)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+  if (read_ahead_ > 1) {
+    std::size_t result{};
+    auto& conn = large_object_->connection();
+    const int descriptor{large_object_->descriptor()};
+    const int chunk_size{static_cast<int>(chunk_size_)};
+    const Statement statement{"select pg_catalog.loread($1, $2)"};
+    const auto result_format = conn.result_format();
+    bool is_eof{};
+    Error error;
+    conn.set_result_format(Data_format::binary);
+    conn.set_pipeline_enabled(true);
+    try {
+      for (std::size_t i{}; i < read_ahead_; ++i) {
+        conn.execute_pipelined([buf, chunk_size, &result, &is_eof,
+          &error](auto&& response)
+        {
+          using R = std::decay_t<decltype(response)>;
+          if constexpr (std::is_same_v<R, Row>) {
+            const auto data = response.data();
+            if (!is_eof && data) {
+              std::memcpy(buf + result, data.bytes(), data.size());
+              result += data.size();
+            }
+            is_eof = is_eof || !data ||
+              data.size() < static_cast<std::size_t>(chunk_size);
+          } else if constexpr (std::is_same_v<R, Error>) {
+            if (!error && response)
+              error = std::move(response);
+          }
+        }, statement, descriptor, chunk_size);
+      }
+      conn.send_sync();
+      while (conn.has_uncompleted_request()) {
+        conn.wait_response();
+        conn.dispatch_pipeline_response();
+      }
+      conn.set_pipeline_enabled(false);
+    } catch (...) {
+      try {
+        while (conn.has_uncompleted_request()) {
+          conn.wait_response();
+          conn.dispatch_pipeline_response();
+        }
+        conn.set_pipeline_enabled(false);
+      } catch (...) {}
+      conn.set_result_format(result_format);
+      throw;
+    }
+    conn.set_result_format(result_format);
+    if (error)
+      throw Server_exception{std::make_shared<Error>(std::move(error))};
+    return result;
+  }
+#endif
+  return large_object_->read_into(buf, chunk_size_ * read_ahead_);
+}
+
+} // namespace dmitigr::pgfe
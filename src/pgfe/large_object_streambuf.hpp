@@ -0,0 +1,152 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_LARGE_OBJECT_STREAMBUF_HPP
+#define DMITIGR_PGFE_LARGE_OBJECT_STREAMBUF_HPP
+
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A stream buffer of large object.
+ *
+ * @details The data is read by chunks of chunk_size() bytes. If read_ahead()
+ * is greater than `1`, up to read_ahead() chunks are requested at once by
+ * `loread()` calls queued in the pipeline, i.e. by the single round trip to
+ * the server. The data is written by chunks of chunk_size() bytes as well.
+ *
+ * @par Example
+ * @code
+ * auto lob = conn.open_large_object(oid, Large_object_open_mode::reading);
+ * Large_object_streambuf buf{lob, 1024*1024, 8};
+ * std::istream in{&buf};
+ * std::ofstream out{"blob.dat", std::ios_base::binary};
+ * out << in.rdbuf();
+ * @endcode
+ *
+ * @warning Using this API must take place within an SQL transaction block!
+ *
+ * @remarks The read-ahead requires the pipeline support of libpq. Without it
+ * the chunks are read one by one.
+ * @remarks The connection of the large object must not be used by other
+ * means while the data is buffered.
+ *
+ * @see Large_object.
+ */
+class Large_object_streambuf final : public std::streambuf {
+public:
+  /// The default chunk size.
+  static constexpr std::size_t default_chunk_size{256*1024};
+
+  /// The default number of chunks to read at once.
+  static constexpr std::size_t default_read_ahead{4};
+
+  /**
+   * @brief The destructor.
+   *
+   * @details Attempts to write the buffered data. The errors are ignored.
+   *
+   * @see sync().
+   */
+  DMITIGR_PGFE_API ~Large_object_streambuf() override;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param large_object The large object to read and write. It must outlive
+   * the stream buffer.
+   * @param chunk_size The size of chunk to read and write.
+   * @param read_ahead The number of chunks to read at once.
+   *
+   * @par Requires
+   * `large_object.is_valid() && chunk_size && read_ahead &&
+   * (chunk_size <= std::numeric_limits<int>::max())`.
+   */
+  DMITIGR_PGFE_API explicit Large_object_streambuf(Large_object& large_object,
+    std::size_t chunk_size = default_chunk_size,
+    std::size_t read_ahead = default_read_ahead);
+
+  /// Not copy-constructible.
+  Large_object_streambuf(const Large_object_streambuf&) = delete;
+
+  /// Not copy-assignable.
+  Large_object_streambuf& operator=(const Large_object_streambuf&) = delete;
+
+  /// Not move-constructible.
+  Large_object_streambuf(Large_object_streambuf&&) = delete;
+
+  /// Not move-assignable.
+  Large_object_streambuf& operator=(Large_object_streambuf&&) = delete;
+
+  /// @returns The large object.
+  DMITIGR_PGFE_API Large_object& large_object() const noexcept;
+
+  /// @returns The size of chunk.
+  DMITIGR_PGFE_API std::size_t chunk_size() const noexcept;
+
+  /// @returns The number of chunks to read at once.
+  DMITIGR_PGFE_API std::size_t read_ahead() const noexcept;
+
+protected:
+  /// Reads the next chunks into the get area.
+  DMITIGR_PGFE_API int_type underflow() override;
+
+  /// Writes the put area if it's full and puts `ch` into it.
+  DMITIGR_PGFE_API int_type overflow(int_type ch) override;
+
+  /**
+   * @brief Writes the put area and discards the unread data of the get area
+   * by moving the position of the large object back.
+   *
+   * @returns `0` on success, or `-1` otherwise.
+   */
+  DMITIGR_PGFE_API int sync() override;
+
+  /// Changes the position of the large object.
+  DMITIGR_PGFE_API pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+    std::ios_base::openmode which) override;
+
+  /// Changes the position of the large object.
+  DMITIGR_PGFE_API pos_type seekpos(pos_type pos,
+    std::ios_base::openmode which) override;
+
+private:
+  Large_object* large_object_{};
+  std::size_t chunk_size_{};
+  std::size_t read_ahead_{};
+  std::vector<char> get_area_;
+  std::vector<char> put_area_;
+
+  void write_put_area();
+  void discard_get_area();
+  std::size_t read_chunks(char* buf);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "large_object_streambuf.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_LARGE_OBJECT_STREAMBUF_HPP
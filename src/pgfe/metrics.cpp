@@ -0,0 +1,191 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void
+Duration_histogram::record(const std::chrono::nanoseconds value) noexcept
+{
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+    value).count();
+  std::size_t index{};
+  for (; us > 0 && index < bucket_count - 1; us >>= 1)
+    ++index;
+  ++buckets_[index];
+  ++count_;
+  sum_ += value;
+  max_ = std::max(max_, value);
+}
+
+DMITIGR_PGFE_INLINE void Duration_histogram::reset() noexcept
+{
+  *this = {};
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Duration_histogram::count() const noexcept
+{
+  return count_;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::nanoseconds
+Duration_histogram::sum() const noexcept
+{
+  return sum_;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::nanoseconds
+Duration_histogram::max() const noexcept
+{
+  return max_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Duration_histogram::bucket(const std::size_t index) const
+{
+  if (!(index < bucket_count))
+    throw Client_exception{"cannot get bucket of histogram: invalid index"};
+  return buckets_[index];
+}
+
+DMITIGR_PGFE_INLINE std::chrono::microseconds
+Duration_histogram::bucket_upper_bound(const std::size_t index)
+{
+  if (!(index < bucket_count))
+    throw Client_exception{"cannot get bucket upper bound of histogram: "
+      "invalid index"};
+  return std::chrono::microseconds{std::chrono::microseconds::rep{1} << index};
+}
+
+DMITIGR_PGFE_INLINE std::chrono::nanoseconds
+Duration_histogram::percentile(const double percentile) const
+{
+  if (!(0 <= percentile && percentile <= 100))
+    throw Client_exception{"cannot get percentile of histogram: "
+      "invalid percentile"};
+
+  if (!count_)
+    return {};
+
+  const auto rank = static_cast<std::uint_least64_t>(
+    std::ceil(static_cast<double>(count_) * percentile / 100));
+  std::uint_least64_t accumulated{};
+  for (std::size_t i{}; i < bucket_count; ++i) {
+    accumulated += buckets_[i];
+    if (accumulated >= std::max<std::uint_least64_t>(rank, 1))
+      return std::min<std::chrono::nanoseconds>(bucket_upper_bound(i), max_);
+  }
+  return max_;
+}
+
+// -----------------------------------------------------------------------------
+// Allocation tracking
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+/// The atomic counterpart of Allocation_counters.
+struct Atomic_allocation_counters final {
+  std::atomic<std::uint_least64_t> count{};
+  std::atomic<std::uint_least64_t> bytes{};
+};
+
+/// @returns The counters of all the allocation categories.
+inline auto& allocation_counters_storage() noexcept
+{
+  static std::array<Atomic_allocation_counters, allocation_category_count>
+    result;
+  return result;
+}
+
+DMITIGR_PGFE_INLINE int& current_allocation_category() noexcept
+{
+  thread_local int result{-1};
+  return result;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE void record_allocation(const std::size_t size) noexcept
+{
+  if constexpr (is_allocation_tracking_enabled()) {
+    const int category{detail::current_allocation_category()};
+    if (category >= 0) {
+      auto& counters = detail::allocation_counters_storage()[
+        static_cast<std::size_t>(category)];
+      counters.count.fetch_add(1, std::memory_order_relaxed);
+      counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+  } else
+    (void)size; // dummy usage
+}
+
+DMITIGR_PGFE_INLINE Allocation_counters
+allocation_counters(const Allocation_category category) noexcept
+{
+  const auto& counters = detail::allocation_counters_storage()[
+    static_cast<std::size_t>(category)];
+  return {counters.count.load(std::memory_order_relaxed),
+    counters.bytes.load(std::memory_order_relaxed)};
+}
+
+DMITIGR_PGFE_INLINE void reset_allocation_counters() noexcept
+{
+  for (auto& counters : detail::allocation_counters_storage()) {
+    counters.count.store(0, std::memory_order_relaxed);
+    counters.bytes.store(0, std::memory_order_relaxed);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Query tagging
+// -----------------------------------------------------------------------------
+
+namespace detail {
+
+DMITIGR_PGFE_INLINE std::string& query_tag_storage() noexcept
+{
+  thread_local std::string result;
+  return result;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE const std::string& query_tag() noexcept
+{
+  return detail::query_tag_storage();
+}
+
+DMITIGR_PGFE_INLINE void set_query_tag(std::string tag)
+{
+  // The comments of PostgreSQL nest, so both markers would break the query.
+  if (tag.find("*/") != std::string::npos)
+    throw Client_exception{"cannot set query tag: end of comment marker"
+      " found"};
+  else if (tag.find("/*") != std::string::npos)
+    throw Client_exception{"cannot set query tag: start of comment marker"
+      " found"};
+  detail::query_tag_storage() = std::move(tag);
+}
+
+} // namespace dmitigr::pgfe
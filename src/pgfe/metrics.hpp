@@ -0,0 +1,467 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_METRICS_HPP
+#define DMITIGR_PGFE_METRICS_HPP
+
+#include "dll.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A histogram of durations with exponential buckets.
+ *
+ * @details The bucket at index `0` counts the durations less than 1
+ * microsecond, the bucket at index `i > 0` counts the durations in range
+ * [2^(i-1), 2^i) microseconds. The last bucket counts all the longer
+ * durations as well.
+ */
+class Duration_histogram final {
+public:
+  /// The number of buckets.
+  static constexpr std::size_t bucket_count{32};
+
+  /// Records the `value`.
+  DMITIGR_PGFE_API void record(std::chrono::nanoseconds value) noexcept;
+
+  /// Resets the histogram.
+  DMITIGR_PGFE_API void reset() noexcept;
+
+  /// @returns The number of recorded values.
+  DMITIGR_PGFE_API std::uint_least64_t count() const noexcept;
+
+  /// @returns The sum of recorded values.
+  DMITIGR_PGFE_API std::chrono::nanoseconds sum() const noexcept;
+
+  /// @returns The maximum recorded value.
+  DMITIGR_PGFE_API std::chrono::nanoseconds max() const noexcept;
+
+  /**
+   * @returns The number of values recorded in the bucket at `index`.
+   *
+   * @par Requires
+   * `index < bucket_count`.
+   */
+  DMITIGR_PGFE_API std::uint_least64_t bucket(std::size_t index) const;
+
+  /**
+   * @returns The exclusive upper bound of the bucket at `index`.
+   *
+   * @par Requires
+   * `index < bucket_count`.
+   */
+  DMITIGR_PGFE_API static std::chrono::microseconds
+  bucket_upper_bound(std::size_t index);
+
+  /**
+   * @returns The upper bound of the bucket which contains the specified
+   * percentile, or zero if `!count()`. (The result is limited by max().)
+   *
+   * @par Requires
+   * `0 <= percentile && percentile <= 100`.
+   */
+  DMITIGR_PGFE_API std::chrono::nanoseconds percentile(double percentile) const;
+
+private:
+  std::array<std::uint_least64_t, bucket_count> buckets_{};
+  std::uint_least64_t count_{};
+  std::chrono::nanoseconds sum_{};
+  std::chrono::nanoseconds max_{};
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief The metrics of a connection.
+ *
+ * @see Connection::set_metrics_enabled().
+ */
+struct Connection_metrics final {
+  /// The number of execute, prepare and describe requests sent.
+  std::uint_least64_t request_count{};
+
+  /// The number of bytes of the queries and the parameters sent.
+  std::uint_least64_t bytes_sent{};
+
+  /// The number of bytes of the row data received.
+  std::uint_least64_t bytes_received{};
+
+  /// The number of rows received.
+  std::uint_least64_t row_count{};
+
+  /// The number of command completions received (including empty queries).
+  std::uint_least64_t completion_count{};
+
+  /// The number of errors received.
+  std::uint_least64_t error_count{};
+
+  /// The number of notices received.
+  std::uint_least64_t notice_count{};
+
+  /// The number of notifications received.
+  std::uint_least64_t notification_count{};
+
+  /// The number of responses which start the COPY.
+  std::uint_least64_t copy_count{};
+
+  /// The number of pipeline synchronization points received.
+  std::uint_least64_t pipeline_sync_count{};
+
+  /**
+   * @brief The number of reads of the input from the socket.
+   *
+   * @details Incremented by each call of Connection::read_input().
+   */
+  std::uint_least64_t read_input_count{};
+
+  /**
+   * @brief The number of attempts to flush the output to the socket.
+   *
+   * @details Incremented by each attempt of Connection::flush_output() to
+   * send the queued data.
+   */
+  std::uint_least64_t flush_output_count{};
+
+  /// The number of attempts to flush the output which would block.
+  std::uint_least64_t flush_output_would_block_count{};
+
+  /// The time spent in Connection::wait_response() waiting for the input.
+  std::chrono::nanoseconds wait_response_time{};
+
+  /**
+   * @brief The time from sending of a request to the arrival of the first
+   * response to it (either the first row or the completion).
+   *
+   * @details This is the network round trip plus the server time.
+   */
+  Duration_histogram first_response_time;
+
+  /**
+   * @brief The time from the arrival of the first row of a response to its
+   * completion.
+   *
+   * @details Only recorded for the responses delivered in Row_delivery_mode
+   * other than Row_delivery_mode::full.
+   */
+  Duration_histogram row_streaming_time;
+
+  /// The durations of the calls of Connection::wait_response().
+  Duration_histogram wait_response_duration;
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief The point of a request at which the trace handler is called.
+ *
+ * @see Connection::set_trace_handler().
+ */
+enum class Trace_point {
+  /// The request is sent.
+  request,
+
+  /// The first row of the response is arrived.
+  first_row,
+
+  /// The request is completed (either successfully or not).
+  completion
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief The kind of a traced request.
+ */
+enum class Trace_request {
+  /// Connection::execute_nio(), Prepared_statement::execute_nio() etc.
+  execute,
+
+  /// Connection::prepare_nio().
+  prepare,
+
+  /// Connection::describe_nio().
+  describe
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief The event which is passed to the trace handler.
+ *
+ * @remarks The string views are valid only while the handler is called.
+ *
+ * @see Connection::set_trace_handler().
+ */
+struct Trace_event final {
+  /// The point of the request.
+  Trace_point point{};
+
+  /// The kind of the request.
+  Trace_request request{};
+
+  /// The query. (Empty if a prepared statement is executed or described.)
+  std::string_view query;
+
+  /// The name of the prepared statement.
+  std::string_view prepared_statement_name;
+
+  /// The number of parameters of the request.
+  std::size_t parameter_count{};
+
+  /// The number of rows received so far.
+  std::uint_least64_t row_count{};
+
+  /// The number of bytes of the rows received so far (the memory of results).
+  std::uint_least64_t byte_count{};
+
+  /// The time since the request is sent.
+  std::chrono::nanoseconds duration{};
+
+  /// `true` if the request is completed with error.
+  bool is_failed{};
+
+  /// The query tag of the thread which sent the request.
+  std::string_view tag;
+};
+
+// -----------------------------------------------------------------------------
+// Query tagging
+// -----------------------------------------------------------------------------
+
+/**
+ * @ingroup utilities
+ *
+ * @returns The query tag of the current thread.
+ *
+ * @see set_query_tag(), Connection::set_query_tagging_enabled().
+ */
+DMITIGR_PGFE_API const std::string& query_tag() noexcept;
+
+/**
+ * @ingroup utilities
+ *
+ * @brief Sets the query tag of the current thread.
+ *
+ * @details The tag (for example, the identifier of the request being processed
+ * by the application) is passed to the trace handler in Trace_event::tag and,
+ * if Connection::is_query_tagging_enabled(), is prepended to the queries as a
+ * comment, so it can be seen in `pg_stat_activity`, the server log or the
+ * output of `auto_explain`.
+ *
+ * @par Requires
+ * `tag` must contain neither the start ("/" "*") nor the end ("*" "/") of
+ * comment marker.
+ */
+DMITIGR_PGFE_API void set_query_tag(std::string tag);
+
+namespace detail {
+
+/// @returns The query tag of the current thread.
+DMITIGR_PGFE_API std::string& query_tag_storage() noexcept;
+
+} // namespace detail
+
+/**
+ * @ingroup utilities
+ *
+ * @brief Sets the query tag of the current thread during the lifetime of the
+ * instance and restores the previous one upon destruction.
+ */
+class Query_tag_guard final {
+public:
+  /// Non copy-constructible.
+  Query_tag_guard(const Query_tag_guard&) = delete;
+
+  /// Non copy-assignable.
+  Query_tag_guard& operator=(const Query_tag_guard&) = delete;
+
+  /// The constructor.
+  explicit Query_tag_guard(std::string tag)
+    : previous_{query_tag()}
+  {
+    set_query_tag(std::move(tag));
+  }
+
+  /// The destructor.
+  ~Query_tag_guard()
+  {
+    detail::query_tag_storage().swap(previous_);
+  }
+
+private:
+  std::string previous_;
+};
+
+// -----------------------------------------------------------------------------
+// Allocation tracking
+// -----------------------------------------------------------------------------
+
+/**
+ * @ingroup utilities
+ *
+ * @brief The category of operations of which the heap allocations are counted.
+ *
+ * @see record_allocation().
+ */
+enum class Allocation_category {
+  /// Binding of parameters (including the conversions of the values).
+  bind,
+
+  /// Sending of execute, prepare and describe requests.
+  execute_send,
+
+  /// Receiving of responses and rows.
+  row_receive,
+
+  /// Conversions by to() and to_data() outside of other categories.
+  conversion,
+
+  /// Building of errors.
+  error
+};
+
+/// The number of allocation categories.
+constexpr std::size_t allocation_category_count{5};
+
+/**
+ * @ingroup utilities
+ *
+ * @brief The counters of heap allocations of an allocation category.
+ */
+struct Allocation_counters final {
+  /// The number of allocations.
+  std::uint_least64_t count{};
+
+  /// The total size of allocations in bytes.
+  std::uint_least64_t bytes{};
+};
+
+/**
+ * @ingroup utilities
+ *
+ * @returns `true` if Pgfe is built with the allocation tracking enabled (by
+ * `DMITIGR_LIBS_PGFE_ALLOCATION_TRACKING` CMake option).
+ */
+constexpr bool is_allocation_tracking_enabled() noexcept
+{
+#ifdef DMITIGR_PGFE_ALLOCATION_TRACKING
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @ingroup utilities
+ *
+ * @brief The instrumentation hook which accounts the allocation of `size`
+ * bytes in the allocation category of the operation which is performed by the
+ * calling thread, if any.
+ *
+ * @details This function is intended to be called by the replaced global
+ * allocation functions (`operator new`) of the application. It's a no-op
+ * if `!is_allocation_tracking_enabled()`.
+ *
+ * @remarks The allocations performed by libpq (via `malloc()`) are not
+ * accounted unless the application intercepts them as well.
+ *
+ * @par Thread safety
+ * Thread-safe.
+ */
+DMITIGR_PGFE_API void record_allocation(std::size_t size) noexcept;
+
+/**
+ * @ingroup utilities
+ *
+ * @returns The counters of the specified allocation `category` accumulated
+ * by all threads.
+ */
+DMITIGR_PGFE_API Allocation_counters
+allocation_counters(Allocation_category category) noexcept;
+
+/**
+ * @ingroup utilities
+ *
+ * @brief Resets the counters of all allocation categories.
+ */
+DMITIGR_PGFE_API void reset_allocation_counters() noexcept;
+
+namespace detail {
+
+/// @returns The index of the category of the current thread, or `-1`.
+DMITIGR_PGFE_API int& current_allocation_category() noexcept;
+
+/**
+ * @brief Associates the allocations of the current thread with the category
+ * during the lifetime of the instance.
+ *
+ * @details The nested scopes don't change the category, so the allocations
+ * are attributed to the outermost operation.
+ */
+class Allocation_scope final {
+public:
+  /// Non copy-constructible.
+  Allocation_scope(const Allocation_scope&) = delete;
+
+  /// Non copy-assignable.
+  Allocation_scope& operator=(const Allocation_scope&) = delete;
+
+#ifdef DMITIGR_PGFE_ALLOCATION_TRACKING
+  /// The constructor.
+  explicit Allocation_scope(const Allocation_category category) noexcept
+  {
+    auto& current = current_allocation_category();
+    if (current < 0) {
+      current = static_cast<int>(category);
+      is_outermost_ = true;
+    }
+  }
+
+  /// The destructor.
+  ~Allocation_scope()
+  {
+    if (is_outermost_)
+      current_allocation_category() = -1;
+  }
+
+private:
+  bool is_outermost_{};
+#else
+  /// The constructor.
+  explicit Allocation_scope(Allocation_category) noexcept
+  {}
+#endif
+};
+
+} // namespace detail
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "metrics.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_METRICS_HPP
@@ -0,0 +1,329 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "notification_dispatcher.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Notification_dispatcher::~Notification_dispatcher() noexcept
+{
+  stop_workers();
+}
+
+DMITIGR_PGFE_INLINE
+Notification_dispatcher::Notification_dispatcher(Connection_options options)
+  : connection_{std::move(options)}
+{}
+
+DMITIGR_PGFE_INLINE Connection& Notification_dispatcher::connection() noexcept
+{
+  return connection_;
+}
+
+DMITIGR_PGFE_INLINE const Connection&
+Notification_dispatcher::connection() const noexcept
+{
+  return connection_;
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::connect()
+{
+  connection_.connect();
+  const std::shared_lock lg{subscribers_mutex_};
+  for (const auto& [channel, subscribers] : subscribers_)
+    listen(channel, true);
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::disconnect() noexcept
+{
+  connection_.disconnect();
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::subscribe(const std::string& channel,
+  Subscriber subscriber)
+{
+  if (channel.empty())
+    throw Client_exception{"cannot subscribe to notification channel: "
+      "empty channel name"};
+  else if (!subscriber)
+    throw Client_exception{"cannot subscribe to notification channel: "
+      "invalid subscriber"};
+
+  if (!is_subscribed(channel) && connection_.is_connected())
+    listen(channel, true);
+  const std::unique_lock lg{subscribers_mutex_};
+  // The subscribers being called by deliver() are never modified.
+  const auto i = subscribers_.find(channel);
+  auto subscribers = i != subscribers_.cend() ?
+    std::make_shared<std::vector<Subscriber>>(*i->second) :
+    std::make_shared<std::vector<Subscriber>>();
+  subscribers->push_back(std::move(subscriber));
+  subscribers_[channel] = std::move(subscribers);
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::unsubscribe(const std::string& channel)
+{
+  if (!is_subscribed(channel))
+    return;
+
+  if (connection_.is_connected())
+    listen(channel, false);
+  const std::unique_lock lg{subscribers_mutex_};
+  subscribers_.erase(channel);
+}
+
+DMITIGR_PGFE_INLINE bool
+Notification_dispatcher::is_subscribed(const std::string& channel) const
+{
+  const std::shared_lock lg{subscribers_mutex_};
+  return subscribers_.find(channel) != subscribers_.cend();
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::set_worker_count(const std::size_t value)
+{
+  if (value != workers_.size()) {
+    stop_workers();
+    start_workers(value);
+  }
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Notification_dispatcher::worker_count() const noexcept
+{
+  return workers_.size();
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::set_coalescing_window(
+  const std::optional<std::chrono::milliseconds> value)
+{
+  if (value && value->count() <= 0)
+    throw Client_exception{"cannot set coalescing window of notification "
+      "dispatcher: invalid value"};
+
+  coalescing_window_ = value;
+  if (!coalescing_window_) {
+    coalesced_keys_.clear();
+    deliver(std::move(coalesced_));
+    coalesced_.clear();
+  }
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Notification_dispatcher::coalescing_window() const noexcept
+{
+  return coalescing_window_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Notification_dispatcher::dispatch(
+  const std::optional<std::chrono::milliseconds> timeout)
+{
+  if (!connection_.is_connected())
+    throw Client_exception{"cannot dispatch notifications: not connected"};
+
+  {
+    const std::lock_guard lg{error_mutex_};
+    if (error_)
+      std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+
+  // Drain the notifications which are already parsed first.
+  Batch batch;
+  while (auto n = connection_.pop_notification())
+    batch.push_back(std::move(n));
+
+  if (batch.empty()) {
+    // Don't wait longer than the rest of the coalescing window.
+    auto wait_timeout = timeout;
+    if (coalescing_window_ && !coalesced_.empty()) {
+      namespace chrono = std::chrono;
+      const auto rest = std::max(chrono::duration_cast<chrono::milliseconds>(
+        coalescing_start_ + *coalescing_window_ - chrono::steady_clock::now()),
+        chrono::milliseconds{});
+      if (!wait_timeout || rest < *wait_timeout)
+        wait_timeout = rest;
+    }
+
+    if (connection_.wait_socket_readiness(Socket_readiness::read_ready,
+        wait_timeout) != Socket_readiness::unready) {
+      connection_.read_input();
+      while (auto n = connection_.pop_notification())
+        batch.push_back(std::move(n));
+    }
+  }
+
+  if (coalescing_window_)
+    return coalesce(std::move(batch));
+
+  const auto result = batch.size();
+  deliver(std::move(batch));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::listen(const std::string& channel, const bool value)
+{
+  connection_.execute(std::string{value ? "listen " : "unlisten "}
+    .append(connection_.to_quoted_identifier(channel)));
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::deliver(const Notification& notification) const
+{
+  // The subscribers are called without the lock, so they can subscribe
+  // and unsubscribe.
+  std::shared_ptr<const std::vector<Subscriber>> subscribers;
+  {
+    const std::shared_lock lg{subscribers_mutex_};
+    const auto i = subscribers_.find(std::string{notification.channel_name()});
+    if (i != subscribers_.cend())
+      subscribers = i->second;
+  }
+  if (subscribers) {
+    for (const auto& subscriber : *subscribers)
+      subscriber(notification);
+  }
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::deliver(Batch&& batch)
+{
+  if (batch.empty())
+    return;
+
+  if (workers_.empty()) {
+    for (const auto& notification : batch)
+      deliver(notification);
+    return;
+  }
+
+  // Partition the batch by the channels.
+  std::vector<Batch> partitions(workers_.size());
+  const std::hash<std::string_view> hash;
+  for (auto& notification : batch) {
+    auto& partition = partitions[hash(notification.channel_name()) %
+      workers_.size()];
+    partition.push_back(std::move(notification));
+  }
+  for (std::size_t i{}; i < partitions.size(); ++i) {
+    if (!partitions[i].empty()) {
+      auto& worker = *workers_[i];
+      {
+        const std::lock_guard lg{worker.mutex_};
+        worker.queue_.push_back(std::move(partitions[i]));
+      }
+      worker.cv_.notify_one();
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE std::size_t Notification_dispatcher::coalesce(Batch&& batch)
+{
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& notification : batch) {
+    const auto payload = notification.payload();
+    std::string key{notification.channel_name()};
+    key.push_back('\0');
+    if (payload.size())
+      key.append(static_cast<const char*>(payload.bytes()), payload.size());
+    if (coalesced_keys_.insert(std::move(key)).second) {
+      if (coalesced_.empty())
+        coalescing_start_ = now;
+      coalesced_.push_back(std::move(notification));
+    }
+  }
+
+  if (coalesced_.empty() || now - coalescing_start_ < *coalescing_window_)
+    return 0;
+
+  const auto result = coalesced_.size();
+  coalesced_keys_.clear();
+  deliver(std::move(coalesced_));
+  coalesced_.clear();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Notification_dispatcher::start_workers(const std::size_t count)
+{
+  workers_.reserve(count);
+  try {
+    for (std::size_t i{}; i < count; ++i) {
+      auto worker = std::make_unique<Worker>();
+      auto* const w = worker.get();
+      workers_.push_back(std::move(worker));
+      w->thread_ = std::thread{[this, w]{work(*w);}};
+    }
+  } catch (...) {
+    stop_workers();
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::stop_workers() noexcept
+{
+  for (auto& worker : workers_) {
+    {
+      const std::lock_guard lg{worker->mutex_};
+      worker->is_stopped_ = true;
+    }
+    worker->cv_.notify_one();
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread_.joinable())
+      worker->thread_.join();
+  }
+  workers_.clear();
+}
+
+DMITIGR_PGFE_INLINE void Notification_dispatcher::work(Worker& worker) noexcept
+{
+  std::vector<Batch> batches;
+  while (true) {
+    {
+      std::unique_lock lk{worker.mutex_};
+      worker.cv_.wait(lk, [&worker]
+      {
+        return worker.is_stopped_ || !worker.queue_.empty();
+      });
+      if (worker.queue_.empty())
+        return;
+      batches.swap(worker.queue_);
+    }
+    for (const auto& batch : batches) {
+      for (const auto& notification : batch) {
+        try {
+          deliver(notification);
+        } catch (...) {
+          const std::lock_guard lg{error_mutex_};
+          if (!error_)
+            error_ = std::current_exception();
+        }
+      }
+    }
+    batches.clear();
+  }
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,251 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_NOTIFICATION_DISPATCHER_HPP
+#define DMITIGR_PGFE_NOTIFICATION_DISPATCHER_HPP
+
+#include "connection.hpp"
+#include "dll.hpp"
+#include "notification.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A dispatcher of notifications to the subscribers of channels.
+ *
+ * @details The dispatcher owns the dedicated connection which listens the
+ * channels of subscribers. Each call of dispatch() reads all the input
+ * available on the connection at once, drains all the parsed notifications
+ * into a batch and calls the subscribers of the channels of each notification
+ * of the batch. If worker_count() is not zero the batches are partitioned by
+ * the channels and the subscribers are called by the worker threads. All the
+ * notifications of a channel are handled by the same worker, so the order of
+ * notifications of a channel is preserved.
+ *
+ * If the coalescing window is set, the notifications are accumulated during
+ * the window and the identical notifications (i.e. the ones of the same
+ * channel and with the same payload) are dispatched only once at the end of
+ * the window. This is useful for the channels of cache invalidation, where
+ * many identical notifications arrive in bursts.
+ *
+ * @par Example
+ * @code
+ * Notification_dispatcher dispatcher{options};
+ * dispatcher.subscribe("cache", [](const Notification& n)
+ * {
+ *   invalidate(n.payload());
+ * });
+ * dispatcher.connect();
+ * while (is_running)
+ *   dispatcher.dispatch(std::chrono::milliseconds{100});
+ * @endcode
+ *
+ * @remarks The functions of this class are not thread-safe and must be
+ * called from the same thread.
+ */
+class Notification_dispatcher final {
+public:
+  /**
+   * @brief The subscriber of a channel.
+   *
+   * @remarks If worker_count() is not zero, the subscribers of different
+   * channels can be called concurrently.
+   * @remarks The subscriber can call subscribe() and unsubscribe(). The
+   * changes take effect from the next notification.
+   */
+  using Subscriber = std::function<void(const Notification& notification)>;
+
+  /**
+   * @brief The destructor.
+   *
+   * @details Stops the workers after handling of all the notifications
+   * queued for them.
+   */
+  DMITIGR_PGFE_API ~Notification_dispatcher() noexcept;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param options The options of the dedicated connection.
+   */
+  DMITIGR_PGFE_API explicit Notification_dispatcher(Connection_options options = {});
+
+  /// Not copy-constructible.
+  Notification_dispatcher(const Notification_dispatcher&) = delete;
+
+  /// Not copy-assignable.
+  Notification_dispatcher& operator=(const Notification_dispatcher&) = delete;
+
+  /// Not move-constructible.
+  Notification_dispatcher(Notification_dispatcher&&) = delete;
+
+  /// Not move-assignable.
+  Notification_dispatcher& operator=(Notification_dispatcher&&) = delete;
+
+  /**
+   * @returns The dedicated connection.
+   *
+   * @warning The connection must not be used to execute statements which
+   * may produce the responses other than the completions of `LISTEN` and
+   * `UNLISTEN` commands.
+   */
+  DMITIGR_PGFE_API Connection& connection() noexcept;
+
+  /// @overload
+  DMITIGR_PGFE_API const Connection& connection() const noexcept;
+
+  /**
+   * @brief Establishes the connection and listens all the channels of the
+   * subscribers.
+   */
+  DMITIGR_PGFE_API void connect();
+
+  /// Closes the connection.
+  DMITIGR_PGFE_API void disconnect() noexcept;
+
+  /**
+   * @brief Adds the subscriber of the channel. If the connection is
+   * established and the channel is not listened yet it's listened
+   * immediately.
+   *
+   * @par Requires
+   * `!channel.empty() && subscriber`.
+   */
+  DMITIGR_PGFE_API void subscribe(const std::string& channel,
+    Subscriber subscriber);
+
+  /**
+   * @brief Removes all the subscribers of the channel. If the connection is
+   * established the channel is unlistened immediately.
+   *
+   * @remarks Does nothing if the channel has no subscribers.
+   */
+  DMITIGR_PGFE_API void unsubscribe(const std::string& channel);
+
+  /// @returns `true` if the channel has subscribers.
+  DMITIGR_PGFE_API bool is_subscribed(const std::string& channel) const;
+
+  /**
+   * @brief Sets the number of worker threads.
+   *
+   * @details The value of `0` means the subscribers are called by dispatch()
+   * in the calling thread.
+   *
+   * @remarks The current workers are stopped after handling of all the
+   * notifications queued for them.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of worker threads. (Default is 0.)
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the window of coalescing of identical notifications.
+   *
+   * @details The window starts upon receipt of the first notification after
+   * the previous window is elapsed. The value of `std::nullopt` disables the
+   * coalescing, in which case the accumulated notifications are dispatched
+   * immediately.
+   *
+   * @par Requires
+   * `!value || value->count() > 0`.
+   */
+  DMITIGR_PGFE_API void
+  set_coalescing_window(std::optional<std::chrono::milliseconds> value);
+
+  /// @returns The window of coalescing. (Default is `std::nullopt`.)
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  coalescing_window() const noexcept;
+
+  /**
+   * @brief Waits for the notifications, reads all the available ones and
+   * dispatches them to the subscribers.
+   *
+   * @param timeout The maximum amount of time to wait for the input. The
+   * value of `std::nullopt` means *eternity*. If the coalescing window is
+   * set, the waiting is not longer than the rest of the current window.
+   *
+   * @returns The number of notifications dispatched. (If the coalescing window
+   * is set, the number of the distinct notifications dispatched at the end of
+   * the window.)
+   *
+   * @par Requires
+   * `connection().is_connected()`.
+   *
+   * @throws The exception thrown by a subscriber. If the subscriber is called
+   * by a worker, the exception is rethrown by the next call of this function.
+   */
+  DMITIGR_PGFE_API std::size_t
+  dispatch(std::optional<std::chrono::milliseconds> timeout =
+    std::chrono::milliseconds{});
+
+private:
+  using Batch = std::vector<Notification>;
+
+  struct Worker final {
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Batch> queue_;
+    bool is_stopped_{};
+  };
+
+  Connection connection_;
+  mutable std::shared_mutex subscribers_mutex_;
+  std::unordered_map<std::string,
+    std::shared_ptr<const std::vector<Subscriber>>> subscribers_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+  std::optional<std::chrono::milliseconds> coalescing_window_;
+  std::chrono::steady_clock::time_point coalescing_start_;
+  Batch coalesced_;
+  std::unordered_set<std::string> coalesced_keys_;
+
+  void listen(const std::string& channel, bool value);
+  void deliver(const Notification& notification) const;
+  void deliver(Batch&& batch);
+  std::size_t coalesce(Batch&& batch);
+  void start_workers(std::size_t count);
+  void stop_workers() noexcept;
+  void work(Worker& worker) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "notification_dispatcher.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_NOTIFICATION_DISPATCHER_HPP
@@ -0,0 +1,145 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "parallel_column_decoder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Parallel_column_decoder::Parallel_column_decoder()
+  : worker_count_{std::max(std::thread::hardware_concurrency(), 1U)}
+{}
+
+DMITIGR_PGFE_INLINE
+Parallel_column_decoder::Parallel_column_decoder(const std::size_t worker_count)
+  : worker_count_{worker_count}
+{
+  if (!worker_count_)
+    throw Client_exception{"cannot create parallel column decoder: "
+      "invalid worker count"};
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_column_decoder::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of parallel column "
+      "decoder: invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_column_decoder::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_column_decoder::set_min_range_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set minimum range size of parallel column "
+      "decoder: invalid value"};
+  min_range_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_column_decoder::min_range_size() const noexcept
+{
+  return min_range_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_column_decoder::for_each_range(const std::size_t row_count,
+  const Range_handler& handler) const
+{
+  if (!handler)
+    throw Client_exception{"cannot decode columns in parallel: "
+      "invalid range handler"};
+  else if (!row_count)
+    return;
+
+  /*
+   * A few ranges per worker are used to balance the load, since the decoding
+   * of the rows of variable length (e.g. of text) takes unequal time.
+   */
+  const std::size_t count = std::max<std::size_t>(1,
+    std::min(worker_count_ * 4, row_count / min_range_size_));
+  if (count == 1) {
+    handler(0, row_count);
+    return;
+  }
+  const std::size_t step{row_count / count};
+  const std::size_t remainder{row_count % count};
+  const auto bound = [step, remainder](const std::size_t index)
+  {
+    return index * step + std::min(index, remainder);
+  };
+
+  std::mutex mutex;
+  std::atomic<bool> is_stopped{};
+  std::atomic<std::size_t> next_index{};
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  const auto work = [&]
+  {
+    std::size_t index{count};
+    try {
+      while (!is_stopped && (index = next_index++) < count)
+        handler(bound(index), bound(index + 1));
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index, std::current_exception());
+    }
+  };
+
+  {
+    // The calling thread is one of the workers.
+    std::vector<std::thread> workers;
+    const auto worker_count = std::min(worker_count_, count);
+    workers.reserve(worker_count - 1);
+    try {
+      for (std::size_t i{1}; i < worker_count; ++i)
+        workers.emplace_back(work);
+    } catch (...) {
+      is_stopped = true;
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    work();
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (!failures.empty())
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,243 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_COLUMN_DECODER_HPP
+#define DMITIGR_PGFE_PARALLEL_COLUMN_DECODER_HPP
+
+#include "column_decoder.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "row_batch.hpp"
+#include "types_fwd.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup conversions
+ *
+ * @brief A decoder of the columns of Row_batch into the typed containers on
+ * multiple threads.
+ *
+ * @details The rows of the batch are split into ranges which are decoded
+ * concurrently by the workers, each of which runs in its own thread (the
+ * calling thread is one of the workers). The values are decoded by
+ * Column_decoder, i.e. by the functions specialized by the type OIDs of the
+ * columns where possible. For example:
+ * @code
+ * conn.set_row_delivery_mode(Row_delivery_mode::full);
+ * conn.execute([](Row_batch&& batch)
+ * {
+ *   const Parallel_column_decoder decoder;
+ *   auto [ids, prices] = decoder.decode<std::int64_t,
+ *     std::optional<double>>(batch, {0, 1});
+ * }, "select id, price from item");
+ * @endcode
+ * Since the conversion of a lot of rows on a single thread is often slower
+ * than the receiving of them, the decoding scales with the number of workers.
+ * The batches which are not large enough are decoded on the calling thread.
+ *
+ * @par Thread safety
+ * The methods are reentrant. The batch must not be modified while decoding.
+ *
+ * @see Column_decoder, Row_batch, Row_delivery_mode.
+ */
+class Parallel_column_decoder final {
+public:
+  /**
+   * @brief The function which handles the rows `[first, last)`.
+   *
+   * @remarks The function is called concurrently for the different ranges.
+   */
+  using Range_handler = std::function<void(std::size_t first, std::size_t last)>;
+
+  /**
+   * @brief The default constructor.
+   *
+   * @par Effects
+   * `worker_count()` is the number of hardware threads (at least 1).
+   */
+  DMITIGR_PGFE_API Parallel_column_decoder();
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `worker_count`.
+   */
+  DMITIGR_PGFE_API explicit Parallel_column_decoder(std::size_t worker_count);
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the minimum number of rows in the range decoded by a worker.
+   *
+   * @details The batches of less than two ranges are decoded on the calling
+   * thread, since starting a thread costs more than decoding a few rows.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_min_range_size(std::size_t value);
+
+  /// @returns The minimum number of rows in the range decoded by a worker.
+  DMITIGR_PGFE_API std::size_t min_range_size() const noexcept;
+
+  /**
+   * @brief Calls the `handler` for the ranges of `[0, row_count)`
+   * concurrently.
+   *
+   * @details If the `handler` throws, the remaining ranges are not handled,
+   * and the exception of the range with the lowest index is rethrown.
+   *
+   * @par Requires
+   * `handler`.
+   */
+  DMITIGR_PGFE_API void for_each_range(std::size_t row_count,
+    const Range_handler& handler) const;
+
+  /**
+   * @returns The values of the column `field` of the `batch` decoded by
+   * Column_decoder.
+   *
+   * @par Requires
+   * `field < batch.field_count()`.
+   *
+   * @throws Client_exception if a value cannot be decoded, for example, if
+   * the value is SQL NULL and `T` is not an `std::optional`.
+   */
+  template<typename T>
+  std::vector<T> decode(const Row_batch& batch, const std::size_t field) const
+  {
+    return std::get<0>(decode<T>(batch, std::array<std::size_t, 1>{field}));
+  }
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `batch.info().field_index(name, offset) < batch.field_count()`.
+   */
+  template<typename T>
+  std::vector<T> decode(const Row_batch& batch, const std::string_view name,
+    const std::size_t offset = 0) const
+  {
+    return decode<T>(batch, batch.info().field_index(name, offset));
+  }
+
+  /**
+   * @returns The values of the columns `fields` of the `batch` decoded to
+   * the containers of the corresponding types `Types`.
+   *
+   * @details The columns are decoded by the same ranges of rows, so each
+   * worker reads the rows of its range once.
+   *
+   * @par Requires
+   * `fields[i] < batch.field_count()` for each `i`.
+   */
+  template<typename ... Types>
+  std::enable_if_t<(sizeof...(Types) > 0), std::tuple<std::vector<Types>...>>
+  decode(const Row_batch& batch,
+    const std::array<std::size_t, sizeof...(Types)>& fields) const
+  {
+    if (!batch.is_valid())
+      throw Client_exception{"cannot decode columns of row batch: "
+        "invalid row batch"};
+    for (const auto field : fields) {
+      if (!(field < batch.field_count()))
+        throw Client_exception{"cannot decode columns of row batch: "
+          "invalid field"};
+    }
+    return decode__(batch, fields, std::index_sequence_for<Types...>{},
+      static_cast<Types*>(nullptr)...);
+  }
+
+private:
+  std::size_t worker_count_{};
+  std::size_t min_range_size_{16384};
+
+  /*
+   * The vector<bool> is filled through the array of bool since its elements
+   * are not separate objects and cannot be modified concurrently.
+   */
+  template<typename T>
+  using Buffer = std::conditional_t<std::is_same_v<T, bool>,
+    std::unique_ptr<bool[]>, std::vector<T>>;
+
+  template<typename T>
+  static Buffer<T> make_buffer(const std::size_t size)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+      return std::make_unique<bool[]>(size);
+    else
+      return std::vector<T>(size);
+  }
+
+  template<typename T>
+  static std::vector<T> to_vector(Buffer<T>&& buffer, const std::size_t size)
+  {
+    if constexpr (std::is_same_v<T, bool>)
+      return std::vector<bool>(buffer.get(), buffer.get() + size);
+    else {
+      (void)size;
+      return std::move(buffer);
+    }
+  }
+
+  template<std::size_t ... I, typename ... Types>
+  std::tuple<std::vector<Types>...> decode__(const Row_batch& batch,
+    const std::array<std::size_t, sizeof...(Types)>& fields,
+    std::index_sequence<I...>, Types* ...) const
+  {
+    const auto count = batch.row_count();
+    const std::tuple<Column_decoder<Types>...> decoders{
+      Column_decoder<Types>{batch.info(), fields[I]}...};
+    std::tuple<Buffer<Types>...> buffers{make_buffer<Types>(count)...};
+    for_each_range(count, [&](const std::size_t first, const std::size_t last)
+    {
+      for (auto row = first; row < last; ++row)
+        ((std::get<I>(buffers)[row] =
+          std::get<I>(decoders)(batch.data(row, fields[I]))), ...);
+    });
+    return {to_vector<Types>(std::move(std::get<I>(buffers)), count)...};
+  }
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_column_decoder.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_COLUMN_DECODER_HPP
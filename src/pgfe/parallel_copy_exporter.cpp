@@ -0,0 +1,202 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "copier.hpp"
+#include "exceptions.hpp"
+#include "parallel_copy_exporter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Parallel_copy_exporter::Parallel_copy_exporter(Connection_pool& pool)
+  : pool_{pool}
+  , worker_count_{pool_.size()}
+{
+  if (!worker_count_)
+    throw Client_exception{"cannot create parallel COPY exporter: empty pool"};
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Parallel_copy_exporter::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_copy_exporter::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of parallel COPY "
+      "exporter: invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_copy_exporter::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE const std::string&
+Parallel_copy_exporter::snapshot() const noexcept
+{
+  return snapshot_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_copy_exporter::execute(const std::vector<Statement>& partitions,
+  const Data_handler& handler)
+{
+  if (!handler)
+    throw Client_exception{"cannot export by parallel COPY exporter: "
+      "invalid data handler"};
+  else if (!pool_.is_connected())
+    throw Client_exception{"cannot export by parallel COPY exporter: "
+      "pool is not connected"};
+
+  snapshot_.clear();
+  const auto count = partitions.size();
+  if (!count)
+    return 0;
+
+  // The transaction of the leader must be open until the workers are done.
+  auto leader = pool_.connection(std::nullopt);
+  if (!leader)
+    throw Client_exception{"cannot export by parallel COPY exporter: "
+      "no connection"};
+  leader->execute("begin transaction isolation level repeatable read, read only");
+  leader->execute([this](Row&& row)
+  {
+    snapshot_ = to<std::string>(row[0]);
+  }, "select pg_catalog.pg_export_snapshot()");
+
+  std::mutex mutex;
+  std::atomic<bool> is_stopped{};
+  std::size_t next_index{};
+  std::size_t row_count{};
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // Returns the index of the partition, or `std::nullopt` if there are none.
+  const auto next_partition = [&]() -> std::optional<std::size_t>
+  {
+    const std::lock_guard lg{mutex};
+    if (is_stopped || next_index == count)
+      return std::nullopt;
+    return next_index++;
+  };
+
+  // Rolls back the transaction of the failed worker if possible.
+  static const auto rollback = [](Connection& conn) noexcept
+  {
+    try {
+      if (conn.is_ready_for_request() && conn.is_transaction_uncommitted())
+        conn.execute("rollback");
+    } catch (...) {
+      // The connection will be closed upon of release.
+    }
+  };
+
+  const auto work = [&](Connection* conn)
+  {
+    std::optional<std::size_t> index;
+    std::optional<Connection_pool::Handle> handle;
+    try {
+      if (!conn) {
+        handle = pool_.connection(std::nullopt);
+        if (!*handle)
+          throw Client_exception{"cannot export by parallel COPY exporter: "
+            "no connection"};
+        conn = &**handle;
+        conn->execute("begin transaction isolation level repeatable read, "
+          "read only");
+        conn->execute(std::string{"set transaction snapshot "}
+          .append(conn->to_quoted_literal(snapshot_)));
+      }
+
+      while ((index = next_partition())) {
+        conn->execute_nio(partitions[*index]);
+        conn->wait_response_throw();
+        const auto copier = conn->copier();
+        if (!copier || copier.data_direction() != Data_direction::from_server)
+          throw Client_exception{"cannot export by parallel COPY exporter: "
+            "the statement is not a COPY TO STDOUT"};
+        // The rest of the data is just received if the export is stopped.
+        while (const auto data = copier.receive()) {
+          if (!is_stopped)
+            handler(*index, data);
+        }
+        conn->wait_response_throw();
+        const auto rows = conn->completion().row_count().value_or(0);
+        const std::lock_guard lg{mutex};
+        row_count += static_cast<std::size_t>(rows);
+      }
+
+      index.reset();
+      if (handle)
+        conn->execute("commit");
+    } catch (...) {
+      {
+        const std::lock_guard lg{mutex};
+        is_stopped = true;
+        failures.emplace_back(index.value_or(count), std::current_exception());
+      }
+      if (handle && *handle)
+        rollback(**handle);
+    }
+  };
+
+  {
+    std::vector<std::thread> workers;
+    const auto worker_count = std::min(worker_count_, count);
+    workers.reserve(worker_count);
+    try {
+      for (std::size_t i{}; i < worker_count; ++i)
+        workers.emplace_back(work, i ? nullptr : &*leader);
+    } catch (...) {
+      is_stopped = true;
+      for (auto& worker : workers)
+        worker.join();
+      rollback(*leader);
+      throw;
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (!failures.empty()) {
+    rollback(*leader);
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+  }
+
+  leader->execute("commit");
+  return row_count;
+}
+
+} // namespace dmitigr::pgfe
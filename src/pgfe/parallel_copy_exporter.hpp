@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_COPY_EXPORTER_HPP
+#define DMITIGR_PGFE_PARALLEL_COPY_EXPORTER_HPP
+
+#include "data.hpp"
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief An exporter which executes the partitions of an export (the
+ * `COPY ... TO STDOUT` commands) concurrently over the connections of
+ * Connection_pool in the same snapshot.
+ *
+ * @details Since the `COPY` on a single connection is limited by a single
+ * backend process, the export of a lot of data scales with the number of
+ * workers. The leader connection opens the `REPEATABLE READ` transaction and
+ * exports its snapshot by `pg_export_snapshot()`. Each worker runs in its own
+ * thread, acquires a connection from the pool for the entire export (the
+ * first worker uses the leader connection), imports the snapshot by
+ * `SET TRANSACTION SNAPSHOT` and executes the partitions one by one. Thus,
+ * the result is consistent as if it was exported by a single transaction.
+ * The leader transaction is kept open until all the workers are done.
+ *
+ * @remarks The server must be PostgreSQL 9.2 or more recent. (Exporting of
+ * snapshots is not available on standby servers prior to PostgreSQL 10.)
+ *
+ * @see Connection_pool, Parallel_copy_loader, Parallel_range_query.
+ */
+class Parallel_copy_exporter final {
+public:
+  /**
+   * @brief The function which handles the data (usually a row) received by
+   * the `COPY` of the partition of the specified index.
+   *
+   * @remarks The function is called concurrently for different partitions,
+   * but never concurrently for the same partition. The data of each partition
+   * is passed in order of its receiving.
+   */
+  using Data_handler = std::function<void(std::size_t partition,
+    const Data_view& data)>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the exporter.
+   *
+   * @par Effects
+   * `worker_count() == pool.size()`.
+   */
+  DMITIGR_PGFE_API explicit Parallel_copy_exporter(Connection_pool& pool);
+
+  /// Not copy-constructible.
+  Parallel_copy_exporter(const Parallel_copy_exporter&) = delete;
+
+  /// Not copy-assignable.
+  Parallel_copy_exporter& operator=(const Parallel_copy_exporter&) = delete;
+
+  /// Not move-constructible.
+  Parallel_copy_exporter(Parallel_copy_exporter&&) = delete;
+
+  /// Not move-assignable.
+  Parallel_copy_exporter& operator=(Parallel_copy_exporter&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @remarks The number of workers greater than the size of the pool is
+   * pointless since the excess workers will only wait for connections.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Executes the `partitions` concurrently in the same snapshot.
+   *
+   * @param partitions The `COPY ... TO STDOUT` statements. For example,
+   * `copy (select * from tab where id % 4 = 0) to stdout`.
+   * @param handler The handler of the received data.
+   *
+   * @returns The total number of rows exported.
+   *
+   * @par Requires
+   * `handler && pool().is_connected()`.
+   *
+   * @throws The first (in order of partitions) exception of the export
+   * (including the one thrown by `handler`). In this case the export is
+   * stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API std::size_t execute(const std::vector<Statement>& partitions,
+    const Data_handler& handler);
+
+  /**
+   * @returns The snapshot identifier exported by the last call of execute(),
+   * or an empty string if there was none.
+   */
+  DMITIGR_PGFE_API const std::string& snapshot() const noexcept;
+
+private:
+  Connection_pool& pool_;
+  std::size_t worker_count_{};
+  std::string snapshot_;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_copy_exporter.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_COPY_EXPORTER_HPP
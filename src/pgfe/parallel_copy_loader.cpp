@@ -0,0 +1,282 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "copier.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "parallel_copy_loader.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Parallel_copy_loader::Parallel_copy_loader(
+  Connection_pool& pool, Statement copy_statement)
+  : pool_{pool}
+  , copy_statement_{std::move(copy_statement)}
+  , worker_count_{pool_.size()}
+{
+  if (!worker_count_)
+    throw Client_exception{"cannot create parallel COPY loader: empty pool"};
+}
+
+DMITIGR_PGFE_INLINE Connection_pool& Parallel_copy_loader::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE const Statement&
+Parallel_copy_loader::copy_statement() const noexcept
+{
+  return copy_statement_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_copy_loader::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of parallel COPY loader: "
+      "invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_copy_loader::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_copy_loader::set_chunk_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set chunk size of parallel COPY loader: "
+      "invalid value"};
+  chunk_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Parallel_copy_loader::chunk_size() const noexcept
+{
+  return chunk_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_copy_loader::set_transaction_policy(const Transaction_policy policy) noexcept
+{
+  transaction_policy_ = policy;
+}
+
+DMITIGR_PGFE_INLINE auto
+Parallel_copy_loader::transaction_policy() const noexcept -> Transaction_policy
+{
+  return transaction_policy_;
+}
+
+DMITIGR_PGFE_INLINE Bulk_completion
+Parallel_copy_loader::load(const Chunk_source& source)
+{
+  if (!source)
+    throw Client_exception{"cannot load by parallel COPY loader: "
+      "invalid chunk source"};
+  else if (!pool_.is_connected())
+    throw Client_exception{"cannot load by parallel COPY loader: "
+      "pool is not connected"};
+
+  std::mutex mutex;
+  bool is_stopped{};
+  Bulk_completion result;
+  std::exception_ptr source_failure;
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // Returns the index of the chunk, or `std::nullopt` if there are no chunks.
+  const auto next_chunk = [&](std::string& chunk) -> std::optional<std::size_t>
+  {
+    const std::lock_guard lg{mutex};
+    if (is_stopped)
+      return std::nullopt;
+
+    try {
+      chunk.clear();
+      if (source(chunk))
+        return result.execution_count_++;
+    } catch (...) {
+      source_failure = std::current_exception();
+    }
+    is_stopped = true;
+    return std::nullopt;
+  };
+
+  // Accounts the committed (or rolled back) chunks of the worker.
+  using Chunk_info = std::pair<std::size_t, long>; // index and row count
+  const auto account = [&](std::vector<Chunk_info>& chunks,
+    const bool is_committed)
+  {
+    const std::lock_guard lg{mutex};
+    for (const auto& [index, row_count] : chunks) {
+      if (is_committed) {
+        result.row_count_ += row_count;
+        ++result.completion_count_;
+      } else
+        ++result.aborted_count_;
+    }
+    chunks.clear();
+  };
+
+  const auto work = [&]
+  {
+    std::optional<std::size_t> index;
+    try {
+      auto handle = pool_.connection(std::nullopt);
+      if (!handle)
+        throw Client_exception{"cannot load by parallel COPY loader: "
+          "no connection"};
+      auto& conn = *handle;
+      const Statement copy_statement{copy_statement_}; // not shared by workers
+
+      const bool is_worker_transaction{transaction_policy_ ==
+        Transaction_policy::worker};
+      std::vector<Chunk_info> uncommitted;
+      std::string chunk;
+      while ((index = next_chunk(chunk))) {
+        if (is_worker_transaction && !conn.is_transaction_uncommitted())
+          conn.execute("begin");
+
+        // Connection::error() is used to get the errors reported by the server.
+        auto error = [&]
+        {
+          conn.execute_nio(copy_statement);
+          conn.wait_response();
+          if (auto e = conn.error())
+            return e;
+
+          auto copier = conn.copier();
+          if (!copier)
+            throw Client_exception{"cannot load by parallel COPY loader: "
+              "the statement is not a COPY FROM STDIN"};
+          while (!copier.send(chunk))
+            conn.flush_output(true);
+          while (!copier.end())
+            conn.flush_output(true);
+          conn.wait_response();
+          if (auto e = conn.error())
+            return e;
+
+          uncommitted.emplace_back(*index,
+            conn.completion().row_count().value_or(0));
+          return Error{};
+        }();
+
+        if (error) {
+          {
+            const std::lock_guard lg{mutex};
+            result.errors_.emplace_back(*index, std::move(error));
+          }
+          if (is_worker_transaction) {
+            conn.execute("rollback");
+            account(uncommitted, false);
+          }
+        } else if (!is_worker_transaction)
+          account(uncommitted, true);
+      }
+
+      index.reset();
+      if (!uncommitted.empty()) {
+        conn.execute("commit");
+        account(uncommitted, true);
+      }
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index.value_or(result.execution_count_),
+        std::current_exception());
+    }
+  };
+
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count_);
+    try {
+      for (std::size_t i{}; i < worker_count_; ++i)
+        workers.emplace_back(work);
+    } catch (...) {
+      {
+        const std::lock_guard lg{mutex};
+        is_stopped = true;
+      }
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (source_failure)
+    std::rethrow_exception(source_failure);
+  else if (!failures.empty())
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+
+  std::sort(result.errors_.begin(), result.errors_.end(),
+    [](const auto& lhs, const auto& rhs)
+    {
+      return lhs.first < rhs.first;
+    });
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Bulk_completion Parallel_copy_loader::load(std::istream& input)
+{
+  std::string rest; // the beginning of the next chunk
+  return load([this, &input, &rest](std::string& chunk)
+  {
+    chunk.swap(rest);
+    if (const auto offset = chunk.size(); offset < chunk_size_) {
+      chunk.resize(chunk_size_);
+      input.read(chunk.data() + offset, chunk_size_ - offset);
+      chunk.resize(offset + static_cast<std::size_t>(input.gcount()));
+    }
+    if (chunk.empty())
+      return false;
+    else if (!input)
+      return true; // the last chunk
+
+    // Partition on the line boundary.
+    if (const auto pos = chunk.rfind('\n'); pos != std::string::npos) {
+      rest.assign(chunk, pos + 1);
+      chunk.resize(pos + 1);
+    } else {
+      std::string tail;
+      std::getline(input, tail);
+      chunk.append(tail);
+      if (!input.eof())
+        chunk.push_back('\n');
+    }
+    return true;
+  });
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,193 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_COPY_LOADER_HPP
+#define DMITIGR_PGFE_PARALLEL_COPY_LOADER_HPP
+
+#include "bulk_completion.hpp"
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A loader which partitions the input data into chunks and loads them
+ * concurrently by using the `COPY FROM STDIN` command over the connections of
+ * Connection_pool.
+ *
+ * @details Since the `COPY` on a single connection is limited by a single
+ * backend process, the loading of a lot of data scales with the number of
+ * workers. Each worker runs in its own thread, acquires a connection from the
+ * pool for the entire loading and loads the chunks one by one. The chunks are
+ * indexed in order of their obtaining from the input, and the errors of the
+ * loading are reported in order of the indexes of the chunks.
+ *
+ * @remarks The order in which chunks are loaded is unspecified.
+ *
+ * @see Connection_pool, Bulk_completion.
+ */
+class Parallel_copy_loader final {
+public:
+  /// The default size of the chunk.
+  static constexpr std::size_t default_chunk_size{8 * 1024 * 1024};
+
+  /// A transaction policy.
+  enum class Transaction_policy {
+    /**
+     * Each chunk is loaded in its own transaction, so an error of a chunk
+     * doesn't affects the other chunks.
+     */
+    chunk,
+
+    /**
+     * All the chunks loaded by a worker are loaded in a single transaction,
+     * which is committed after the input is exhausted. An error of a chunk
+     * rolls back all the chunks loaded by the worker in the transaction (such
+     * chunks are counted as aborted).
+     */
+    worker
+  };
+
+  /**
+   * @brief The function which stores the next chunk of data into `chunk`.
+   *
+   * @details Each chunk must consist of the whole rows of the format of the
+   * `COPY` statement. (A chunk of the binary format must include both the
+   * header and the trailer.)
+   *
+   * @returns `false` if the input is exhausted.
+   *
+   * @remarks The function is never called concurrently.
+   */
+  using Chunk_source = std::function<bool(std::string& chunk)>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the loader.
+   * @param copy_statement The `COPY ... FROM STDIN` statement. For example,
+   * `copy tab from stdin (format csv)`.
+   *
+   * @par Effects
+   * `worker_count() == pool.size()`.
+   */
+  DMITIGR_PGFE_API Parallel_copy_loader(Connection_pool& pool,
+    Statement copy_statement);
+
+  /// Not copy-constructible.
+  Parallel_copy_loader(const Parallel_copy_loader&) = delete;
+
+  /// Not copy-assignable.
+  Parallel_copy_loader& operator=(const Parallel_copy_loader&) = delete;
+
+  /// Not move-constructible.
+  Parallel_copy_loader(Parallel_copy_loader&&) = delete;
+
+  /// Not move-assignable.
+  Parallel_copy_loader& operator=(Parallel_copy_loader&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The `COPY` statement.
+  DMITIGR_PGFE_API const Statement& copy_statement() const noexcept;
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @remarks The number of workers greater than the size of the pool is
+   * pointless since the excess workers will only wait for connections.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the approximate size of the chunk to partition the input
+   * stream to.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @see load(std::istream&).
+   */
+  DMITIGR_PGFE_API void set_chunk_size(std::size_t value);
+
+  /// @returns The approximate size of the chunk.
+  DMITIGR_PGFE_API std::size_t chunk_size() const noexcept;
+
+  /// Sets the transaction policy.
+  DMITIGR_PGFE_API void set_transaction_policy(Transaction_policy policy) noexcept;
+
+  /// @returns The transaction policy. The default is Transaction_policy::chunk.
+  DMITIGR_PGFE_API Transaction_policy transaction_policy() const noexcept;
+
+  /**
+   * @brief Loads the chunks provided by `source` concurrently.
+   *
+   * @returns The aggregated completion, where the executions are the chunks.
+   * Only the rows of the committed chunks are counted by
+   * Bulk_completion::row_count().
+   *
+   * @par Requires
+   * `pool().is_connected()`.
+   *
+   * @throws The exception thrown by `source` or the first (in order of chunks)
+   * exception which is not an error of loading of a chunk reported by the
+   * server (for example, on loss of connection). In this case the loading is
+   * stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API Bulk_completion load(const Chunk_source& source);
+
+  /**
+   * @overload
+   *
+   * @details The `input` is partitioned into chunks of about chunk_size()
+   * bytes on the line boundaries.
+   *
+   * @remarks Only the text format and the CSV format without newlines in the
+   * quoted values can be partitioned this way.
+   */
+  DMITIGR_PGFE_API Bulk_completion load(std::istream& input);
+
+private:
+  Connection_pool& pool_;
+  Statement copy_statement_;
+  std::size_t worker_count_{};
+  std::size_t chunk_size_{default_chunk_size};
+  Transaction_policy transaction_policy_{Transaction_policy::chunk};
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_copy_loader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_COPY_LOADER_HPP
@@ -0,0 +1,312 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "large_object.hpp"
+#include "parallel_large_object_transfer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Parallel_large_object_transfer::Parallel_large_object_transfer(
+  Connection_pool& pool)
+  : pool_{pool}
+  , worker_count_{pool_.size()}
+{
+  if (!worker_count_)
+    throw Client_exception{"cannot create parallel large object transfer: "
+      "empty pool"};
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Parallel_large_object_transfer::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of parallel large object "
+      "transfer: invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_large_object_transfer::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::set_chunk_size(const std::size_t value)
+{
+  if (!value ||
+    value > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    throw Client_exception{"cannot set chunk size of parallel large object "
+      "transfer: invalid value"};
+  chunk_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_large_object_transfer::chunk_size() const noexcept
+{
+  return chunk_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::set_read_ahead(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set read ahead of parallel large object "
+      "transfer: invalid value"};
+  read_ahead_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_large_object_transfer::read_ahead() const noexcept
+{
+  return read_ahead_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::set_progress_handler(Progress_handler handler)
+{
+  progress_handler_ = std::move(handler);
+}
+
+DMITIGR_PGFE_INLINE auto
+Parallel_large_object_transfer::progress_handler() const noexcept
+  -> const Progress_handler&
+{
+  return progress_handler_;
+}
+
+DMITIGR_PGFE_INLINE std::vector<Oid>
+Parallel_large_object_transfer::import_files(
+  const std::vector<std::filesystem::path>& files)
+{
+  std::vector<Oid> result(files.size(), invalid_oid);
+  transfer(files.size(), [this, &files, &result](Connection& conn,
+    const std::size_t index, const auto& report)
+  {
+    const auto& path = files[index];
+    std::ifstream input{path, std::ios_base::binary};
+    if (!input)
+      throw Client_exception{"cannot import large object: cannot open file "
+        + path.string()};
+    Progress progress{index, 0, std::filesystem::file_size(path), false};
+
+    conn.execute("begin");
+    const Oid oid{conn.create_large_object()};
+    auto lob = conn.open_large_object(oid, Large_object_open_mode::writing);
+    {
+      Large_object_streambuf buf{lob, chunk_size_, read_ahead_};
+      std::string chunk(chunk_size_, '\0');
+      while (input.read(chunk.data(), chunk.size()), input.gcount() > 0) {
+        const auto size = input.gcount();
+        if (buf.sputn(chunk.data(), size) != size || buf.pubsync())
+          throw Client_exception{"cannot import large object from file "
+            + path.string() + ": cannot write large object"};
+        progress.transferred_size += static_cast<std::uintmax_t>(size);
+        report(progress);
+      }
+      if (input.bad())
+        throw Client_exception{"cannot import large object: cannot read file "
+          + path.string()};
+    }
+    lob.close();
+    conn.execute("commit");
+    result[index] = oid;
+    progress.is_done = true;
+    report(progress);
+  });
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::export_files(const std::vector<Export_item>& items)
+{
+  transfer(items.size(), [this, &items](Connection& conn,
+    const std::size_t index, const auto& report)
+  {
+    const auto& [oid, path] = items[index];
+    Progress progress{index, 0, std::nullopt, false};
+
+    conn.execute("begin");
+    auto lob = conn.open_large_object(oid, Large_object_open_mode::reading);
+    std::ofstream output{path, std::ios_base::binary | std::ios_base::trunc};
+    if (!output)
+      throw Client_exception{"cannot export large object: cannot open file "
+        + path.string()};
+    {
+      Large_object_streambuf buf{lob, chunk_size_, read_ahead_};
+      std::string chunk(chunk_size_, '\0');
+      while (const auto size = buf.sgetn(chunk.data(), chunk.size())) {
+        if (!output.write(chunk.data(), size))
+          throw Client_exception{"cannot export large object: cannot write "
+            "file " + path.string()};
+        progress.transferred_size += static_cast<std::uintmax_t>(size);
+        report(progress);
+      }
+    }
+    lob.close();
+    conn.execute("commit");
+    if (!output.flush())
+      throw Client_exception{"cannot export large object: cannot write file "
+        + path.string()};
+    progress.total_size = progress.transferred_size;
+    progress.is_done = true;
+    report(progress);
+  });
+}
+
+DMITIGR_PGFE_INLINE std::vector<std::byte>
+Parallel_large_object_transfer::read_range(const Oid oid,
+  const std::int_fast64_t offset, const std::size_t length)
+{
+  if (offset < 0)
+    throw Client_exception{"cannot read large object range: invalid offset"};
+
+  constexpr auto max_part_size =
+    static_cast<std::size_t>(std::numeric_limits<int>::max());
+  const auto part_size = std::min(max_part_size, std::max(chunk_size_,
+      (length + worker_count_ - 1) / worker_count_));
+  const auto part_count = length ? (length - 1) / part_size + 1 : 0;
+  std::vector<std::byte> result(length);
+  std::vector<std::size_t> sizes(part_count);
+  transfer(part_count, [&](Connection& conn, const std::size_t index,
+    const auto& report)
+  {
+    const auto part_offset = index * part_size;
+    const auto size = std::min(part_size, length - part_offset);
+    sizes[index] = conn.read_large_object_range(oid,
+      offset + static_cast<std::int_fast64_t>(part_offset),
+      reinterpret_cast<char*>(result.data() + part_offset), size);
+    report(Progress{index, sizes[index], size, true});
+  });
+
+  // Truncate the result after the first part read partially.
+  std::size_t size{};
+  for (std::size_t i{}; i < part_count; ++i) {
+    size += sizes[i];
+    if (sizes[i] < std::min(part_size, length - i * part_size))
+      break;
+  }
+  result.resize(size);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_large_object_transfer::transfer(const std::size_t item_count,
+  const std::function<void(Connection&, std::size_t,
+    const std::function<void(const Progress&)>&)>& transfer_item)
+{
+  if (!pool_.is_connected())
+    throw Client_exception{"cannot transfer large objects: pool is not "
+      "connected"};
+
+  std::mutex mutex;
+  bool is_stopped{};
+  std::size_t next_index{};
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // Returns the index of the item, or `std::nullopt` if there are no items.
+  const auto next_item = [&]() -> std::optional<std::size_t>
+  {
+    const std::lock_guard lg{mutex};
+    if (is_stopped || next_index == item_count)
+      return std::nullopt;
+    return next_index++;
+  };
+
+  const std::function<void(const Progress&)> report =
+    [this, &mutex](const Progress& progress)
+    {
+      if (progress_handler_) {
+        const std::lock_guard lg{mutex};
+        progress_handler_(progress);
+      }
+    };
+
+  const auto work = [&]
+  {
+    std::optional<std::size_t> index;
+    try {
+      auto handle = pool_.connection(std::nullopt);
+      if (!handle)
+        throw Client_exception{"cannot transfer large objects: no connection"};
+      auto& conn = *handle;
+      try {
+        while ((index = next_item()))
+          transfer_item(conn, *index, report);
+      } catch (...) {
+        if (conn.is_connected() && conn.is_transaction_uncommitted()) {
+          try {
+            conn.execute("rollback");
+          } catch (...) {}
+        }
+        throw;
+      }
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index.value_or(item_count),
+        std::current_exception());
+    }
+  };
+
+  {
+    std::vector<std::thread> workers;
+    const auto count = std::min(worker_count_, item_count);
+    workers.reserve(count);
+    try {
+      for (std::size_t i{}; i < count; ++i)
+        workers.emplace_back(work);
+    } catch (...) {
+      {
+        const std::lock_guard lg{mutex};
+        is_stopped = true;
+      }
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (!failures.empty())
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+}
+
+} // namespace dmitigr::pgfe
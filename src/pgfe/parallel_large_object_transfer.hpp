@@ -0,0 +1,209 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_LARGE_OBJECT_TRANSFER_HPP
+#define DMITIGR_PGFE_PARALLEL_LARGE_OBJECT_TRANSFER_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "large_object_streambuf.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A transfer of many files to and from large objects which proceeds
+ * concurrently over the connections of Connection_pool.
+ *
+ * @details Each worker runs in its own thread, acquires a connection from the
+ * pool for the entire transfer and transfers the items one by one. Each item
+ * is transferred in its own transaction by using Large_object_streambuf.
+ *
+ * @remarks The order in which items are transferred is unspecified.
+ *
+ * @see Connection_pool, Large_object_streambuf.
+ */
+class Parallel_large_object_transfer final {
+public:
+  /// A progress of the transfer of an item.
+  struct Progress final {
+    /// The index of the item.
+    std::size_t index{};
+    /// The number of bytes transferred so far.
+    std::uintmax_t transferred_size{};
+    /// The size of the item if known.
+    std::optional<std::uintmax_t> total_size;
+    /// `true` if the transfer of the item is committed.
+    bool is_done{};
+  };
+
+  /**
+   * @brief The function which is called after each chunk transferred and
+   * after the transfer of each item is committed.
+   *
+   * @remarks The function is never called concurrently.
+   */
+  using Progress_handler = std::function<void(const Progress& progress)>;
+
+  /// An item to export.
+  using Export_item = std::pair<Oid, std::filesystem::path>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the transfer.
+   *
+   * @par Effects
+   * `worker_count() == pool.size()`.
+   */
+  DMITIGR_PGFE_API explicit Parallel_large_object_transfer(Connection_pool& pool);
+
+  /// Not copy-constructible.
+  Parallel_large_object_transfer(const Parallel_large_object_transfer&) = delete;
+
+  /// Not copy-assignable.
+  Parallel_large_object_transfer&
+  operator=(const Parallel_large_object_transfer&) = delete;
+
+  /// Not move-constructible.
+  Parallel_large_object_transfer(Parallel_large_object_transfer&&) = delete;
+
+  /// Not move-assignable.
+  Parallel_large_object_transfer&
+  operator=(Parallel_large_object_transfer&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the size of chunk of the stream buffer of large object.
+   *
+   * @par Requires
+   * `value && (value <= std::numeric_limits<int>::max())`.
+   *
+   * @see Large_object_streambuf::chunk_size().
+   */
+  DMITIGR_PGFE_API void set_chunk_size(std::size_t value);
+
+  /// @returns The size of chunk.
+  DMITIGR_PGFE_API std::size_t chunk_size() const noexcept;
+
+  /**
+   * @brief Sets the number of chunks to read at once.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @see Large_object_streambuf::read_ahead().
+   */
+  DMITIGR_PGFE_API void set_read_ahead(std::size_t value);
+
+  /// @returns The number of chunks to read at once.
+  DMITIGR_PGFE_API std::size_t read_ahead() const noexcept;
+
+  /// Sets the progress handler.
+  DMITIGR_PGFE_API void set_progress_handler(Progress_handler handler);
+
+  /// @returns The progress handler.
+  DMITIGR_PGFE_API const Progress_handler& progress_handler() const noexcept;
+
+  /**
+   * @brief Imports the files into the new large objects concurrently.
+   *
+   * @returns The vector of OIDs of the created large objects, where each
+   * element corresponds to the file of the same index.
+   *
+   * @par Requires
+   * `pool().is_connected()`.
+   *
+   * @throws The first (in order of items) exception thrown upon the transfer.
+   * In this case the transfer is stopped as soon as possible, but the items
+   * already transferred are not rolled back.
+   */
+  DMITIGR_PGFE_API std::vector<Oid>
+  import_files(const std::vector<std::filesystem::path>& files);
+
+  /**
+   * @brief Exports the large objects into the files concurrently.
+   *
+   * @par Requires
+   * `pool().is_connected()`.
+   *
+   * @throws The first (in order of items) exception thrown upon the transfer.
+   * In this case the transfer is stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API void export_files(const std::vector<Export_item>& items);
+
+  /**
+   * @brief Reads the range of the large object concurrently.
+   *
+   * @details The range is split into (at most) worker_count() parts of at
+   * least chunk_size() bytes, and each part is read in a single round trip by
+   * Connection::read_large_object_range(). The progress is reported for each
+   * part read, where Progress::index is the index of the part.
+   *
+   * @returns The bytes of the range, which are fewer than `length` only if
+   * the range exceeds the end of the large object.
+   *
+   * @par Requires
+   * `pool().is_connected() && offset >= 0`.
+   *
+   * @throws The first (in order of parts) exception thrown upon the read.
+   */
+  DMITIGR_PGFE_API std::vector<std::byte> read_range(Oid oid,
+    std::int_fast64_t offset, std::size_t length);
+
+private:
+  Connection_pool& pool_;
+  std::size_t worker_count_{};
+  std::size_t chunk_size_{Large_object_streambuf::default_chunk_size};
+  std::size_t read_ahead_{Large_object_streambuf::default_read_ahead};
+  Progress_handler progress_handler_;
+
+  void transfer(std::size_t item_count,
+    const std::function<void(Connection&, std::size_t,
+      const std::function<void(const Progress&)>&)>& transfer_item);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_large_object_transfer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_LARGE_OBJECT_TRANSFER_HPP
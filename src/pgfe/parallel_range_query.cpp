@@ -0,0 +1,233 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "parallel_range_query.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Parallel_range_query::Parallel_range_query(
+  Connection_pool& pool, Statement query)
+  : pool_{pool}
+  , query_{std::move(query)}
+  , worker_count_{pool_.size()}
+  , partition_count_{worker_count_}
+{
+  if (!worker_count_)
+    throw Client_exception{"cannot create parallel range query: empty pool"};
+}
+
+DMITIGR_PGFE_INLINE Connection_pool& Parallel_range_query::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE const Statement& Parallel_range_query::query() const noexcept
+{
+  return query_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_range_query::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of parallel range query: "
+      "invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_range_query::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Parallel_range_query::set_partition_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set partition count of parallel range "
+      "query: invalid value"};
+  partition_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_range_query::partition_count() const noexcept
+{
+  return partition_count_;
+}
+
+DMITIGR_PGFE_INLINE void Parallel_range_query::set_ordered(const bool value) noexcept
+{
+  is_ordered_ = value;
+}
+
+DMITIGR_PGFE_INLINE bool Parallel_range_query::is_ordered() const noexcept
+{
+  return is_ordered_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Parallel_range_query::execute(const Key first, const Key last,
+  const Row_handler& handler)
+{
+  if (!(first <= last))
+    throw Client_exception{"cannot execute parallel range query: "
+      "invalid range"};
+  else if (!handler)
+    throw Client_exception{"cannot execute parallel range query: "
+      "invalid row handler"};
+  else if (!pool_.is_connected())
+    throw Client_exception{"cannot execute parallel range query: "
+      "pool is not connected"};
+
+  // The arithmetic is unsigned to not overflow on the widest ranges.
+  using U = std::uint_fast64_t;
+  const U width{static_cast<U>(last) - static_cast<U>(first)};
+  const std::size_t count = static_cast<std::size_t>(
+    std::min<U>(partition_count_, width));
+  if (!count)
+    return 0;
+  const U step{width / count};
+  const U remainder{width % count};
+  const auto bound = [first, step, remainder](const std::size_t index)
+  {
+    const U i{index};
+    return static_cast<Key>(static_cast<U>(first) + i * step +
+      std::min(i, remainder));
+  };
+
+  std::mutex mutex;
+  std::atomic<bool> is_stopped{};
+  std::size_t next_index{};
+  std::size_t row_count{};
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // The state of ordered delivery.
+  std::vector<std::vector<Row>> buffers(is_ordered_ ? count : 0);
+  std::vector<bool> is_done(is_ordered_ ? count : 0);
+  std::size_t current{}; // the partition whose rows are passed directly
+
+  // Returns the index of the partition, or `std::nullopt` if there are none.
+  const auto next_partition = [&]() -> std::optional<std::size_t>
+  {
+    const std::lock_guard lg{mutex};
+    if (is_stopped || next_index == count)
+      return std::nullopt;
+    return next_index++;
+  };
+
+  // Passes the buffered rows of the partition to the handler.
+  const auto flush = [&](const std::size_t index)
+  {
+    auto& buffer = buffers[index];
+    for (auto& row : buffer) {
+      handler(index, std::move(row));
+      ++row_count;
+    }
+    std::vector<Row>{}.swap(buffer);
+  };
+
+  const auto deliver = [&](const std::size_t index, Row&& row)
+  {
+    const std::lock_guard lg{mutex};
+    if (is_ordered_ && index != current) {
+      buffers[index].push_back(std::move(row));
+      return;
+    } else if (is_ordered_)
+      flush(index);
+    handler(index, std::move(row));
+    ++row_count;
+  };
+
+  const auto complete = [&](const std::size_t index)
+  {
+    const std::lock_guard lg{mutex};
+    is_done[index] = true;
+    for (; current < count && is_done[current]; ++current)
+      flush(current);
+    if (current < count)
+      flush(current);
+  };
+
+  const auto work = [&]
+  {
+    std::optional<std::size_t> index;
+    try {
+      auto handle = pool_.connection(std::nullopt);
+      if (!handle)
+        throw Client_exception{"cannot execute parallel range query: "
+          "no connection"};
+      auto& conn = *handle;
+      const Statement query{query_}; // not shared by workers
+
+      while ((index = next_partition())) {
+        conn.execute([&](Row&& row)
+        {
+          if (is_stopped)
+            return Row_processing::complete;
+          deliver(*index, std::move(row));
+          return Row_processing::continu;
+        }, query, bound(*index), bound(*index + 1));
+        if (is_ordered_)
+          complete(*index);
+      }
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index.value_or(count), std::current_exception());
+    }
+  };
+
+  {
+    std::vector<std::thread> workers;
+    const auto worker_count = std::min(worker_count_, count);
+    workers.reserve(worker_count);
+    try {
+      for (std::size_t i{}; i < worker_count; ++i)
+        workers.emplace_back(work);
+    } catch (...) {
+      is_stopped = true;
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (!failures.empty())
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+
+  return row_count;
+}
+
+} // namespace dmitigr::pgfe
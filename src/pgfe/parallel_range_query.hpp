@@ -0,0 +1,164 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARALLEL_RANGE_QUERY_HPP
+#define DMITIGR_PGFE_PARALLEL_RANGE_QUERY_HPP
+
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A query which partitions the range of the partitioning key into
+ * subranges and executes the query for them concurrently over the
+ * connections of Connection_pool.
+ *
+ * @details Since the scan on a single connection is limited by a single
+ * backend process, the execution of a query over a lot of data scales with
+ * the number of workers. Each worker runs in its own thread, acquires a
+ * connection from the pool for the entire execution and executes the query
+ * for the partitions one by one. The partitions are indexed in order of
+ * their subranges, and the exceptions of the execution are reported in order
+ * of the indexes of the partitions.
+ *
+ * @remarks The partitions are executed in separate transactions, so the rows
+ * of different partitions may belong to different snapshots.
+ *
+ * @see Connection_pool.
+ */
+class Parallel_range_query final {
+public:
+  /// The key of partitioning.
+  using Key = std::int_fast64_t;
+
+  /**
+   * @brief The function which handles the row of the partition of the
+   * specified index.
+   *
+   * @remarks The function is never called concurrently.
+   */
+  using Row_handler = std::function<void(std::size_t partition, Row&& row)>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the query.
+   * @param query The query with the parameters `$1` and `$2` which denote the
+   * inclusive lower and the exclusive upper bounds of the partitioning key
+   * accordingly. For example, `select * from tab where id >= $1 and id < $2`.
+   *
+   * @par Effects
+   * `worker_count() == pool.size() && partition_count() == worker_count()`.
+   */
+  DMITIGR_PGFE_API Parallel_range_query(Connection_pool& pool, Statement query);
+
+  /// Not copy-constructible.
+  Parallel_range_query(const Parallel_range_query&) = delete;
+
+  /// Not copy-assignable.
+  Parallel_range_query& operator=(const Parallel_range_query&) = delete;
+
+  /// Not move-constructible.
+  Parallel_range_query(Parallel_range_query&&) = delete;
+
+  /// Not move-assignable.
+  Parallel_range_query& operator=(Parallel_range_query&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The query.
+  DMITIGR_PGFE_API const Statement& query() const noexcept;
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @remarks The number of workers greater than the size of the pool is
+   * pointless since the excess workers will only wait for connections.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the number of partitions to partition the range to.
+   *
+   * @details The number of partitions greater than the number of workers
+   * smooths out the uneven distribution of the rows in the range.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_partition_count(std::size_t value);
+
+  /// @returns The number of partitions.
+  DMITIGR_PGFE_API std::size_t partition_count() const noexcept;
+
+  /**
+   * @brief Sets the ordering of the rows.
+   *
+   * @details If `true`, the rows are passed to the handler in order of the
+   * partitions, and the rows of partitions which are not yet passed are
+   * buffered in memory. Otherwise, the rows are passed as soon as received.
+   */
+  DMITIGR_PGFE_API void set_ordered(bool value) noexcept;
+
+  /// @returns `true` if the rows are passed in order of the partitions.
+  DMITIGR_PGFE_API bool is_ordered() const noexcept;
+
+  /**
+   * @brief Executes the query for the range `[first, last)` concurrently.
+   *
+   * @returns The number of rows passed to `handler`.
+   *
+   * @par Requires
+   * `first <= last && handler && pool().is_connected()`.
+   *
+   * @throws The first (in order of partitions) exception of the execution
+   * (including the one thrown by `handler`). In this case the execution is
+   * stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API std::size_t execute(Key first, Key last,
+    const Row_handler& handler);
+
+private:
+  Connection_pool& pool_;
+  Statement query_;
+  std::size_t worker_count_{};
+  std::size_t partition_count_{};
+  bool is_ordered_{};
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "parallel_range_query.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARALLEL_RANGE_QUERY_HPP
@@ -0,0 +1,712 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "copier.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "partitioned_copy_loader.hpp"
+#include "type_catalog.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+constexpr Oid date_oid{1082};
+
+/// A value of the partition bound as printed by `pg_get_expr()`.
+struct Partition_bound_value final {
+  enum class Kind { literal, null, minvalue, maxvalue };
+  Kind kind{Kind::literal};
+  std::string text;
+};
+
+[[noreturn]] inline void throw_invalid_partition_bound(const std::string_view bound)
+{
+  throw Client_exception{"cannot parse partition bound "
+    + std::string{bound}};
+}
+
+/// Skips the `prefix` (preceded by spaces) if any.
+inline bool skip_partition_bound_prefix(std::string_view& text,
+  const std::string_view prefix) noexcept
+{
+  while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+    text.remove_prefix(1);
+  if (text.substr(0, prefix.size()) != prefix)
+    return false;
+  text.remove_prefix(prefix.size());
+  return true;
+}
+
+/**
+ * @returns The values of the parenthesized list of the partition `bound` at
+ * the beginning of the `text`, such as `('a', NULL)` or `(MINVALUE)`.
+ */
+inline std::vector<Partition_bound_value>
+parse_partition_bound_list(const std::string_view bound, std::string_view& text)
+{
+  using Kind = Partition_bound_value::Kind;
+  std::vector<Partition_bound_value> result;
+  if (!skip_partition_bound_prefix(text, "("))
+    throw_invalid_partition_bound(bound);
+
+  do {
+    skip_partition_bound_prefix(text, "");
+    auto& value = result.emplace_back();
+    const bool is_escape{text.size() > 1 && (text[0] == 'E' || text[0] == 'e')
+      && text[1] == '\''};
+    if (is_escape || (!text.empty() && text.front() == '\'')) {
+      text.remove_prefix(is_escape ? 2 : 1);
+      while (true) {
+        if (text.empty())
+          throw_invalid_partition_bound(bound);
+        const char c{text.front()};
+        text.remove_prefix(1);
+        if (c == '\'') {
+          if (text.empty() || text.front() != '\'')
+            break;
+          text.remove_prefix(1); // quote is doubled
+        } else if (c == '\\' && is_escape) {
+          if (text.empty())
+            throw_invalid_partition_bound(bound);
+          value.text.push_back(text.front()); // backslash is doubled
+          text.remove_prefix(1);
+          continue;
+        }
+        value.text.push_back(c);
+      }
+    } else {
+      auto token = text.substr(0, text.find_first_of(",)"));
+      text.remove_prefix(token.size());
+      while (!token.empty() &&
+        std::isspace(static_cast<unsigned char>(token.back())))
+        token.remove_suffix(1);
+      if (token.empty())
+        throw_invalid_partition_bound(bound);
+      else if (token == "NULL")
+        value.kind = Kind::null;
+      else if (token == "MINVALUE")
+        value.kind = Kind::minvalue;
+      else if (token == "MAXVALUE")
+        value.kind = Kind::maxvalue;
+      else
+        value.text = token;
+    }
+  } while (skip_partition_bound_prefix(text, ","));
+
+  if (!skip_partition_bound_prefix(text, ")"))
+    throw_invalid_partition_bound(bound);
+  return result;
+}
+
+/**
+ * @brief Unescapes the `field` of the `COPY` text format into the `result`.
+ *
+ * @returns `false` if the field is SQL NULL.
+ */
+inline bool unescape_copy_text_field(const std::string_view field,
+  std::string& result)
+{
+  result.clear();
+  if (field == "\\N")
+    return false;
+
+  const auto digit = [](const char c, const int base) noexcept
+  {
+    const int value{std::isdigit(static_cast<unsigned char>(c)) ? c - '0' :
+      std::isxdigit(static_cast<unsigned char>(c)) ?
+      std::tolower(static_cast<unsigned char>(c)) - 'a' + 10 : base};
+    return value < base ? value : -1;
+  };
+  const auto size = field.size();
+  for (std::size_t i{}; i < size; ++i) {
+    if (field[i] != '\\' || i + 1 == size) {
+      result.push_back(field[i]);
+      continue;
+    }
+
+    const char c{field[++i]};
+    switch (c) {
+    case 'b': result.push_back('\b'); break;
+    case 'f': result.push_back('\f'); break;
+    case 'n': result.push_back('\n'); break;
+    case 'r': result.push_back('\r'); break;
+    case 't': result.push_back('\t'); break;
+    case 'v': result.push_back('\v'); break;
+    case 'x':
+      if (i + 1 < size && digit(field[i + 1], 16) >= 0) {
+        int value{};
+        for (int n{}; n < 2 && i + 1 < size && digit(field[i + 1], 16) >= 0; ++n)
+          value = value * 16 + digit(field[++i], 16);
+        result.push_back(static_cast<char>(value));
+      } else
+        result.push_back(c);
+      break;
+    default:
+      if (digit(c, 8) >= 0) {
+        int value{digit(c, 8)};
+        for (int n{}; n < 2 && i + 1 < size && digit(field[i + 1], 8) >= 0; ++n)
+          value = value * 8 + digit(field[++i], 8);
+        result.push_back(static_cast<char>(value));
+      } else
+        result.push_back(c);
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Partitioned_copy_loader::Partitioned_copy_loader(
+  Connection_pool& pool, std::string table, std::vector<std::string> columns)
+  : pool_{pool}
+  , table_{std::move(table)}
+  , columns_{std::move(columns)}
+  , worker_count_{pool_.size()}
+{
+  if (table_.empty())
+    throw Client_exception{"cannot create partitioned COPY loader: "
+      "empty table name"};
+  else if (!worker_count_)
+    throw Client_exception{"cannot create partitioned COPY loader: "
+      "empty pool"};
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Partitioned_copy_loader::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE const std::string&
+Partitioned_copy_loader::table() const noexcept
+{
+  return table_;
+}
+
+DMITIGR_PGFE_INLINE const std::vector<std::string>&
+Partitioned_copy_loader::columns() const noexcept
+{
+  return columns_;
+}
+
+DMITIGR_PGFE_INLINE void
+Partitioned_copy_loader::set_worker_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set worker count of partitioned COPY "
+      "loader: invalid value"};
+  worker_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Partitioned_copy_loader::worker_count() const noexcept
+{
+  return worker_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Partitioned_copy_loader::set_chunk_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set chunk size of partitioned COPY "
+      "loader: invalid value"};
+  chunk_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Partitioned_copy_loader::chunk_size() const noexcept
+{
+  return chunk_size_;
+}
+
+DMITIGR_PGFE_INLINE void Partitioned_copy_loader::load_partitions()
+{
+  if (!pool_.is_connected())
+    throw Client_exception{"cannot load partitions by partitioned COPY "
+      "loader: pool is not connected"};
+
+  auto handle = pool_.connection(std::nullopt);
+  if (!handle)
+    throw Client_exception{"cannot load partitions by partitioned COPY "
+      "loader: no connection"};
+  auto& conn = *handle;
+  const auto failure = [this](const std::string& reason)
+  {
+    return Client_exception{"cannot load partitions of table " + table_
+      + " by partitioned COPY loader: " + reason};
+  };
+
+  // Fetch the partition key.
+  std::optional<char> strategy;
+  int key_count{};
+  std::optional<std::string> key_name;
+  Oid key_type{invalid_oid};
+  std::size_t key_position{};
+  conn.execute([&](auto&& row)
+  {
+    strategy = to<std::string_view>(row.data(0)).front();
+    key_count = to<int>(row.data(1));
+    if (row.data(2)) {
+      key_name = to<std::string>(row.data(2));
+      key_type = to<Oid>(row.data(3));
+      key_position = static_cast<std::size_t>(to<long long>(row.data(4)));
+    }
+  }, "select p.partstrat, p.partnatts, a.attname, a.atttypid,"
+     " (select count(*) from pg_attribute b where b.attrelid = p.partrelid"
+     " and b.attnum > 0 and b.attnum < a.attnum and not b.attisdropped"
+     " and b.attgenerated = '')"
+     " from pg_partitioned_table p left join pg_attribute a"
+     " on a.attrelid = p.partrelid and a.attnum = p.partattrs[0]"
+     " where p.partrelid = $1::regclass", table_);
+  if (!strategy)
+    throw failure("table is not partitioned");
+  else if (key_count != 1 || !key_name)
+    throw failure("partitioning by multiple columns or by expression "
+      "is not supported");
+  else if (*strategy == 'h')
+    throw failure("hash partitioning is not supported");
+
+  // Resolve the type of the key (including the base types of domains).
+  Partitioning result;
+  {
+    const auto& catalog = pool_.type_catalog();
+    for (auto type = catalog->descriptor(conn, key_type);
+         type && type->kind == Type_kind::domain;
+         type = catalog->descriptor(conn, type->base_oid));
+    const auto oid = catalog->representation_oid(key_type);
+    if (oid == detail::int2_oid || oid == detail::int4_oid ||
+      oid == detail::int8_oid)
+      result.key_kind = Key_kind::integer;
+    else if (oid == detail::date_oid)
+      result.key_kind = Key_kind::date;
+    else if ((oid == detail::text_oid || oid == detail::varchar_oid) &&
+      *strategy == 'l')
+      result.key_kind = Key_kind::text;
+    else
+      throw failure("the type of partition key is not supported");
+  }
+
+  if (columns_.empty())
+    result.key_position = key_position;
+  else if (const auto i = std::find(columns_.cbegin(), columns_.cend(),
+      *key_name); i != columns_.cend())
+    result.key_position = static_cast<std::size_t>(i - columns_.cbegin());
+  else
+    throw failure("partition key column " + *key_name + " is not loaded");
+
+  // Fetch the partitions.
+  std::vector<std::string> bounds;
+  conn.execute([&](auto&& row)
+  {
+    result.partition_names.push_back(to<std::string>(row.data(0)));
+    bounds.push_back(to<std::string>(row.data(1)));
+  }, "select c.oid::regclass::text, pg_get_expr(c.relpartbound, c.oid)"
+     " from pg_inherits i join pg_class c on c.oid = i.inhrelid"
+     " where i.inhparent = $1::regclass order by c.oid", table_);
+  if (bounds.empty())
+    throw failure("table has no partitions");
+  for (std::size_t i{}; i < bounds.size(); ++i)
+    add_bound__(result, i, bounds[i]);
+  std::sort(result.ranges.begin(), result.ranges.end(),
+    [](const Range& lhs, const Range& rhs)
+    {
+      return rhs.lower && (!lhs.lower || *lhs.lower < *rhs.lower);
+    });
+
+  partitioning_ = std::move(result);
+}
+
+DMITIGR_PGFE_INLINE bool
+Partitioned_copy_loader::is_partitions_loaded() const noexcept
+{
+  return static_cast<bool>(partitioning_);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Partitioned_copy_loader::partition_count() const noexcept
+{
+  return partitioning_ ? partitioning_->partition_names.size() : 0;
+}
+
+DMITIGR_PGFE_INLINE const std::string&
+Partitioned_copy_loader::partition_name(const std::size_t index) const
+{
+  if (!(index < partition_count()))
+    throw Client_exception{"cannot get partition name of partitioned COPY "
+      "loader: invalid index"};
+  return partitioning_->partition_names[index];
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::size_t>
+Partitioned_copy_loader::route(const std::optional<std::string_view> key) const
+{
+  if (!partitioning_)
+    throw Client_exception{"cannot route by partitioned COPY loader: "
+      "partitions are not loaded"};
+
+  std::string value;
+  if (key)
+    normalize__(partitioning_->key_kind, *key, value);
+  return route__(key ? &value : nullptr);
+}
+
+DMITIGR_PGFE_INLINE Bulk_completion
+Partitioned_copy_loader::load(std::istream& input)
+{
+  if (!pool_.is_connected())
+    throw Client_exception{"cannot load by partitioned COPY loader: "
+      "pool is not connected"};
+  else if (!partitioning_)
+    load_partitions();
+
+  const auto& partition_names = partitioning_->partition_names;
+  const std::size_t partition_count{partition_names.size()};
+
+  struct Chunk final {
+    std::size_t index{};
+    std::size_t partition{};
+    std::string data;
+  };
+
+  std::mutex mutex;
+  std::condition_variable state_changed;
+  std::deque<Chunk> queue;
+  const std::size_t max_queue_size{2 * worker_count_};
+  bool is_input_done{};
+  bool is_stopped{};
+  Bulk_completion result;
+  std::exception_ptr input_failure;
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // Returns the next chunk, or `std::nullopt` if there are no chunks.
+  const auto next_chunk = [&]() -> std::optional<Chunk>
+  {
+    std::unique_lock lk{mutex};
+    state_changed.wait(lk, [&]
+    {
+      return is_stopped || is_input_done || !queue.empty();
+    });
+    if (is_stopped || queue.empty())
+      return std::nullopt;
+
+    auto result = std::move(queue.front());
+    queue.pop_front();
+    state_changed.notify_all();
+    return result;
+  };
+
+  // Queues the chunk of the partition. Returns `false` if the loading is stopped.
+  const auto queue_chunk = [&](const std::size_t partition, std::string& data)
+  {
+    std::unique_lock lk{mutex};
+    state_changed.wait(lk, [&]
+    {
+      return is_stopped || queue.size() < max_queue_size;
+    });
+    if (is_stopped)
+      return false;
+
+    queue.push_back(Chunk{result.execution_count_++, partition,
+      std::move(data)});
+    data.clear();
+    state_changed.notify_all();
+    return true;
+  };
+
+  const auto work = [&]
+  {
+    std::optional<std::size_t> index;
+    try {
+      auto handle = pool_.connection(std::nullopt);
+      if (!handle)
+        throw Client_exception{"cannot load by partitioned COPY loader: "
+          "no connection"};
+      auto& conn = *handle;
+
+      std::vector<std::optional<Statement>> statements(partition_count);
+      while (auto chunk = next_chunk()) {
+        index = chunk->index;
+        auto& statement = statements[chunk->partition];
+        if (!statement) {
+          std::string query{"copy "};
+          query.append(partition_names[chunk->partition]);
+          if (!columns_.empty()) {
+            query.append(" (");
+            for (const auto& column : columns_) {
+              if (&column != &columns_.front())
+                query.append(", ");
+              conn.append_quoted_identifier(query, column);
+            }
+            query.append(")");
+          }
+          query.append(" from stdin");
+          statement.emplace(query);
+        }
+
+        // Connection::error() is used to get the errors reported by the server.
+        auto error = [&]
+        {
+          conn.execute_nio(*statement);
+          conn.wait_response();
+          if (auto e = conn.error())
+            return e;
+
+          auto copier = conn.copier();
+          DMITIGR_ASSERT(copier);
+          while (!copier.send(chunk->data))
+            conn.flush_output(true);
+          while (!copier.end())
+            conn.flush_output(true);
+          conn.wait_response();
+          return conn.error();
+        }();
+
+        const std::lock_guard lg{mutex};
+        if (error)
+          result.errors_.emplace_back(*index, std::move(error));
+        else {
+          result.row_count_ += conn.completion().row_count().value_or(0);
+          ++result.completion_count_;
+        }
+      }
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index.value_or(result.execution_count_),
+        std::current_exception());
+      state_changed.notify_all();
+    }
+  };
+
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count_);
+    try {
+      for (std::size_t i{}; i < worker_count_; ++i)
+        workers.emplace_back(work);
+
+      // Route the rows into the chunks of the partitions.
+      try {
+        std::vector<std::string> chunks(partition_count);
+        std::string row;
+        std::string key;
+        std::string value;
+        bool is_queued{true};
+        while (is_queued && std::getline(input, row) && row != "\\.") {
+          const auto partition = route_row__(row, key, value);
+          auto& chunk = chunks[partition];
+          chunk.append(row).push_back('\n');
+          if (chunk.size() >= chunk_size_)
+            is_queued = queue_chunk(partition, chunk);
+        }
+        if (input.bad())
+          throw Client_exception{"cannot load by partitioned COPY loader: "
+            "cannot read input"};
+        for (std::size_t i{}; is_queued && i < partition_count; ++i) {
+          if (!chunks[i].empty())
+            is_queued = queue_chunk(i, chunks[i]);
+        }
+      } catch (...) {
+        input_failure = std::current_exception();
+      }
+    } catch (...) {
+      {
+        const std::lock_guard lg{mutex};
+        is_stopped = true;
+      }
+      state_changed.notify_all();
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    {
+      const std::lock_guard lg{mutex};
+      is_input_done = true;
+      if (input_failure)
+        is_stopped = true;
+    }
+    state_changed.notify_all();
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (input_failure)
+    std::rethrow_exception(input_failure);
+  else if (!failures.empty())
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+
+  std::sort(result.errors_.begin(), result.errors_.end(),
+    [](const auto& lhs, const auto& rhs)
+    {
+      return lhs.first < rhs.first;
+    });
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Partitioned_copy_loader::normalize__(const Key_kind kind,
+  const std::string_view key, std::string& result)
+{
+  const auto invalid_key = [key]
+  {
+    return Client_exception{"invalid partition key " + std::string{key}};
+  };
+
+  result.clear();
+  switch (kind) {
+  case Key_kind::integer: {
+    // Encoded as hex digits of the integer with flipped sign bit to preserve
+    // the order when compared as strings.
+    std::int64_t value{};
+    const auto end = key.data() + key.size();
+    if (const auto [ptr, ec] = std::from_chars(key.data(), end, value);
+      ec != std::errc{} || ptr != end)
+      throw invalid_key();
+    auto bits = static_cast<std::uint64_t>(value) ^ (std::uint64_t{1} << 63);
+    result.resize(16);
+    for (auto i = result.rbegin(); i != result.rend(); ++i, bits >>= 4)
+      *i = "0123456789abcdef"[bits & 0xf];
+    break;
+  }
+  case Key_kind::date: {
+    // YYYY-MM-DD
+    const auto is_digit = [&key](const std::size_t i)
+    {
+      return std::isdigit(static_cast<unsigned char>(key[i]));
+    };
+    if (key.size() != 10 || key[4] != '-' || key[7] != '-' || !is_digit(0) ||
+      !is_digit(1) || !is_digit(2) || !is_digit(3) || !is_digit(5) ||
+      !is_digit(6) || !is_digit(8) || !is_digit(9))
+      throw invalid_key();
+    result = key;
+    break;
+  }
+  case Key_kind::text:
+    result = key;
+    break;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Partitioned_copy_loader::add_bound__(Partitioning& partitioning,
+  const std::size_t partition, const std::string_view bound)
+{
+  using Kind = detail::Partition_bound_value::Kind;
+  std::string_view text{bound};
+  if (detail::skip_partition_bound_prefix(text, "DEFAULT")) {
+    partitioning.default_partition = partition;
+    return;
+  } else if (!detail::skip_partition_bound_prefix(text, "FOR VALUES"))
+    detail::throw_invalid_partition_bound(bound);
+
+  if (detail::skip_partition_bound_prefix(text, "IN")) {
+    for (auto& value : detail::parse_partition_bound_list(bound, text)) {
+      if (value.kind == Kind::null)
+        partitioning.null_partition = partition;
+      else if (value.kind == Kind::literal) {
+        std::string key;
+        normalize__(partitioning.key_kind, value.text, key);
+        partitioning.values.emplace(std::move(key), partition);
+      } else
+        detail::throw_invalid_partition_bound(bound);
+    }
+  } else if (detail::skip_partition_bound_prefix(text, "FROM")) {
+    const auto lower = detail::parse_partition_bound_list(bound, text);
+    if (!detail::skip_partition_bound_prefix(text, "TO"))
+      detail::throw_invalid_partition_bound(bound);
+    const auto upper = detail::parse_partition_bound_list(bound, text);
+    if (lower.size() != 1 || upper.size() != 1 ||
+      lower[0].kind == Kind::null || upper[0].kind == Kind::null)
+      detail::throw_invalid_partition_bound(bound);
+    else if (lower[0].kind == Kind::maxvalue ||
+      upper[0].kind == Kind::minvalue)
+      return; // empty range
+
+    auto& range = partitioning.ranges.emplace_back();
+    range.partition = partition;
+    if (lower[0].kind == Kind::literal)
+      normalize__(partitioning.key_kind, lower[0].text, range.lower.emplace());
+    if (upper[0].kind == Kind::literal)
+      normalize__(partitioning.key_kind, upper[0].text, range.upper.emplace());
+  } else
+    detail::throw_invalid_partition_bound(bound);
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::size_t>
+Partitioned_copy_loader::route__(const std::string* const key) const noexcept
+{
+  const auto& p = *partitioning_;
+  if (!key)
+    return p.null_partition ? p.null_partition : p.default_partition;
+
+  if (const auto i = p.values.find(*key); i != p.values.cend())
+    return i->second;
+
+  // Find the last range whose lower bound isn't greater than the key.
+  auto i = std::upper_bound(p.ranges.cbegin(), p.ranges.cend(), *key,
+    [](const std::string& key, const Range& range)
+    {
+      return range.lower && key < *range.lower;
+    });
+  if (i != p.ranges.cbegin() && (!(--i)->upper || *key < *i->upper))
+    return i->partition;
+
+  return p.default_partition;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Partitioned_copy_loader::route_row__(const std::string_view row,
+  std::string& key, std::string& value) const
+{
+  // Find the field of the key.
+  std::size_t offset{};
+  for (std::size_t i{}; i < partitioning_->key_position; ++i) {
+    offset = row.find('\t', offset);
+    if (offset == std::string_view::npos)
+      throw Client_exception{"cannot load by partitioned COPY loader: "
+        "no partition key in row " + std::string{row}};
+    ++offset;
+  }
+  const auto field = row.substr(offset, row.find('\t', offset) - offset);
+
+  const bool is_null{!detail::unescape_copy_text_field(field, key)};
+  if (!is_null)
+    normalize__(partitioning_->key_kind, key, value);
+  if (const auto result = route__(is_null ? nullptr : &value))
+    return *result;
+  else
+    throw Client_exception{"cannot load by partitioned COPY loader: "
+      "no partition for row " + std::string{row}};
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,261 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PARTITIONED_COPY_LOADER_HPP
+#define DMITIGR_PGFE_PARTITIONED_COPY_LOADER_HPP
+
+#include "bulk_completion.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A loader which routes the rows to the partitions of the partitioned
+ * table on the client side and loads the partitions concurrently by using the
+ * `COPY FROM STDIN` commands over the connections of Connection_pool.
+ *
+ * @details The rows of the `COPY` text format are routed by the value of the
+ * partition key into the per-partition chunks, and each chunk is loaded
+ * directly into its partition by the workers (each of which runs in its own
+ * thread and acquires a connection from the pool for the entire loading), so
+ * the server doesn't route the tuples and the different partitions are loaded
+ * in parallel. For example:
+ * @code
+ * pgfe::Partitioned_copy_loader loader{pool, "measurement"};
+ * std::ifstream input{"measurement.tsv"};
+ * const auto completion = loader.load(input);
+ * @endcode
+ *
+ * The bounds of the partitions are read from the system catalog once, by
+ * load_partitions(), and are cached by the loader. The types of the partition
+ * keys are resolved by Connection_pool::type_catalog(), so the keys of
+ * domains and enumerated types are supported.
+ *
+ * Supported partitioning is:
+ *   - by range of a single column of the types `smallint`, `integer`,
+ *   `bigint` and `date` (in ISO format, i.e. `YYYY-MM-DD`);
+ *   - by list of values of a single column of the types `smallint`,
+ *   `integer`, `bigint`, `date`, `text`, `varchar` and enumerated types.
+ *
+ * The rows which don't fit any partition are routed to the default partition
+ * if any. The sub-partitioned partitions are loaded as is, i.e. with the
+ * tuple routing of the next level by the server.
+ *
+ * @remarks The hash partitioning cannot be routed on the client side since it
+ * depends on the hash functions of the server.
+ *
+ * @see Parallel_copy_loader, Bulk_completion.
+ */
+class Partitioned_copy_loader final {
+public:
+  /// The default size of the chunk.
+  static constexpr std::size_t default_chunk_size{1024 * 1024};
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from. It must outlive
+   * the loader.
+   * @param table The name of the partitioned table, which is inserted into
+   * the SQL query as is and therefore should be quoted by the caller if
+   * needed.
+   * @param columns The names of the columns of the input in order, or empty
+   * vector if the input consists of all the columns of the `table` (except
+   * the generated ones) in order. The names are quoted by using
+   * Connection::to_quoted_identifier().
+   *
+   * @par Requires
+   * `!table.empty()`.
+   *
+   * @par Effects
+   * `worker_count() == pool.size()`.
+   */
+  DMITIGR_PGFE_API Partitioned_copy_loader(Connection_pool& pool,
+    std::string table, std::vector<std::string> columns = {});
+
+  /// Not copy-constructible.
+  Partitioned_copy_loader(const Partitioned_copy_loader&) = delete;
+
+  /// Not copy-assignable.
+  Partitioned_copy_loader& operator=(const Partitioned_copy_loader&) = delete;
+
+  /// Not move-constructible.
+  Partitioned_copy_loader(Partitioned_copy_loader&&) = delete;
+
+  /// Not move-assignable.
+  Partitioned_copy_loader& operator=(Partitioned_copy_loader&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The name of the table.
+  DMITIGR_PGFE_API const std::string& table() const noexcept;
+
+  /// @returns The names of the columns.
+  DMITIGR_PGFE_API const std::vector<std::string>& columns() const noexcept;
+
+  /**
+   * @brief Sets the number of workers.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @remarks The number of workers greater than the size of the pool is
+   * pointless since the excess workers will only wait for connections.
+   */
+  DMITIGR_PGFE_API void set_worker_count(std::size_t value);
+
+  /// @returns The number of workers.
+  DMITIGR_PGFE_API std::size_t worker_count() const noexcept;
+
+  /**
+   * @brief Sets the approximate size of the chunk of a partition.
+   *
+   * @par Requires
+   * `value`.
+   *
+   * @remarks Up to the chunk per partition is accumulated in the memory.
+   */
+  DMITIGR_PGFE_API void set_chunk_size(std::size_t value);
+
+  /// @returns The approximate size of the chunk of a partition.
+  DMITIGR_PGFE_API std::size_t chunk_size() const noexcept;
+
+  /**
+   * @brief Reads the partitioning of the table from the system catalog. (The
+   * previously cached partitioning is discarded.)
+   *
+   * @par Requires
+   * `pool().is_connected()`.
+   *
+   * @throws Client_exception if the table is not partitioned or if its
+   * partitioning is not supported.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @remarks The loader doesn't track the DDL. If the partitions are altered,
+   * this function should be called again.
+   */
+  DMITIGR_PGFE_API void load_partitions();
+
+  /// @returns `true` if load_partitions() was called successfully.
+  DMITIGR_PGFE_API bool is_partitions_loaded() const noexcept;
+
+  /// @returns The number of partitions.
+  DMITIGR_PGFE_API std::size_t partition_count() const noexcept;
+
+  /**
+   * @returns The name of the partition `index` (qualified by the schema if
+   * it's not in the search path).
+   *
+   * @par Requires
+   * `index < partition_count()`.
+   */
+  DMITIGR_PGFE_API const std::string& partition_name(std::size_t index) const;
+
+  /**
+   * @returns The index of the partition of the row with the partition `key`,
+   * or `std::nullopt` if there is no such partition.
+   *
+   * @param key The text representation of the partition key, or
+   * `std::nullopt` to denote SQL NULL.
+   *
+   * @par Requires
+   * `is_partitions_loaded()`.
+   *
+   * @throws Client_exception if the `key` is not a valid value of the type of
+   * the partition key.
+   */
+  DMITIGR_PGFE_API std::optional<std::size_t>
+  route(std::optional<std::string_view> key) const;
+
+  /**
+   * @brief Loads the rows of the `COPY` text format from the `input`
+   * concurrently. Calls load_partitions() at first if
+   * `!is_partitions_loaded()`.
+   *
+   * @details Each chunk is loaded in its own transaction, so an error of a
+   * chunk doesn't affects the other chunks.
+   *
+   * @returns The aggregated completion, where the executions are the chunks.
+   * Only the rows of the committed chunks are counted by
+   * Bulk_completion::row_count().
+   *
+   * @par Requires
+   * `pool().is_connected()`.
+   *
+   * @throws Client_exception if a row cannot be routed (for example, if the
+   * partition key is invalid or there is no partition for it), or the first
+   * (in order of chunks) exception which is not an error of loading of a
+   * chunk reported by the server (for example, on loss of connection). In this
+   * case the loading is stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API Bulk_completion load(std::istream& input);
+
+private:
+  enum class Key_kind { integer, date, text };
+
+  struct Range final {
+    std::optional<std::string> lower; // `std::nullopt` denotes MINVALUE
+    std::optional<std::string> upper; // `std::nullopt` denotes MAXVALUE
+    std::size_t partition{};
+  };
+
+  struct Partitioning final {
+    Key_kind key_kind{Key_kind::text};
+    std::size_t key_position{}; // the index of the key column in the input
+    std::vector<std::string> partition_names;
+    std::vector<Range> ranges; // ordered by the lower bounds
+    std::unordered_map<std::string, std::size_t> values;
+    std::optional<std::size_t> null_partition;
+    std::optional<std::size_t> default_partition;
+  };
+
+  Connection_pool& pool_;
+  std::string table_;
+  std::vector<std::string> columns_;
+  std::size_t worker_count_{};
+  std::size_t chunk_size_{default_chunk_size};
+  std::optional<Partitioning> partitioning_;
+
+  static void normalize__(Key_kind kind, std::string_view key,
+    std::string& result);
+  static void add_bound__(Partitioning& partitioning, std::size_t partition,
+    std::string_view bound);
+  std::optional<std::size_t> route__(const std::string* key) const noexcept;
+  std::size_t route_row__(std::string_view row, std::string& key,
+    std::string& value) const;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "partitioned_copy_loader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PARTITIONED_COPY_LOADER_HPP
@@ -0,0 +1,90 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "pending_result.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Pending_result::Pending_result(std::shared_ptr<State> state) noexcept
+  : state_{std::move(state)}
+{}
+
+DMITIGR_PGFE_INLINE bool Pending_result::is_valid() const noexcept
+{
+  return static_cast<bool>(state_);
+}
+
+DMITIGR_PGFE_INLINE bool Pending_result::is_ready() const
+{
+  throw_if_invalid("cannot check readiness of");
+  return state_->is_ready_;
+}
+
+DMITIGR_PGFE_INLINE void Pending_result::wait()
+{
+  throw_if_invalid("cannot wait");
+  while (!state_->is_ready_) {
+    auto* const conn = state_->connection_;
+    DMITIGR_ASSERT(conn);
+    if (!conn->is_connected() || !conn->has_uncompleted_request())
+      throw Client_exception{"cannot wait pending result: request is lost"};
+    else if (conn->pipeline_status() != Pipeline_status::disabled &&
+      conn->requests_.back().id_ != Connection::Request::Id::sync)
+      conn->send_pipeline_sync();
+    conn->wait_response();
+    conn->dispatch_pipeline_response();
+  }
+}
+
+DMITIGR_PGFE_INLINE Completion Pending_result::get()
+{
+  wait();
+  if (state_->error_)
+    throw Server_exception{std::make_shared<Error>(std::move(state_->error_))};
+  else if (!state_->completion_)
+    throw Client_exception{"cannot get pending result: request is aborted"};
+  return std::move(state_->completion_);
+}
+
+DMITIGR_PGFE_INLINE std::vector<Row>& Pending_result::rows()
+{
+  throw_if_invalid("cannot get rows of");
+  return state_->rows_;
+}
+
+DMITIGR_PGFE_INLINE Completion& Pending_result::completion()
+{
+  throw_if_invalid("cannot get completion of");
+  return state_->completion_;
+}
+
+DMITIGR_PGFE_INLINE Error& Pending_result::error()
+{
+  throw_if_invalid("cannot get error of");
+  return state_->error_;
+}
+
+DMITIGR_PGFE_INLINE void
+Pending_result::throw_if_invalid(const char* const what) const
+{
+  if (!is_valid())
+    throw Client_exception{std::string{what} + " invalid pending result"};
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PENDING_RESULT_HPP
+#define DMITIGR_PGFE_PENDING_RESULT_HPP
+
+#include "completion.hpp"
+#include "dll.hpp"
+#include "error.hpp"
+#include "row.hpp"
+#include "types_fwd.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A handle of the result of a request which is completed
+ * asynchronously.
+ *
+ * @details The result becomes ready when either the Completion or the Error
+ * arrives in response on the request. The responses are dispatched by
+ * Connection::poll_pipeline(), Connection::complete_pipeline() and wait().
+ *
+ * @remarks The Connection must not be moved or swapped while the result is
+ * pending.
+ *
+ * @see Connection::execute_async().
+ */
+class Pending_result final {
+public:
+  /// Default-constructible. (Constructs an invalid instance.)
+  Pending_result() = default;
+
+  /// @returns `true` if this instance is associated with a request.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /**
+   * @returns `true` if the result is ready.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API bool is_ready() const;
+
+  /**
+   * @brief Waits for and dispatches the responses until the result is ready.
+   *
+   * @details If the pipeline is enabled and the request is not followed by
+   * a synchronization point, the latter is established by this function.
+   *
+   * @par Requires
+   * `is_valid()`.
+   *
+   * @par Effects
+   * `is_ready()`.
+   *
+   * @throws Client_exception if the request can no longer be completed (for
+   * example, if the connection is closed).
+   *
+   * @remarks The error of the server is not thrown but reported by error().
+   */
+  DMITIGR_PGFE_API void wait();
+
+  /**
+   * @brief Waits for the result and returns the Completion.
+   *
+   * @par Requires
+   * `is_valid()`.
+   *
+   * @throws Server_exception if the request failed.
+   * @throws Client_exception if the request was skipped by the server
+   * because of the preceding error in the same pipeline.
+   */
+  DMITIGR_PGFE_API Completion get();
+
+  /**
+   * @returns The rows received in response on the request so far.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API std::vector<Row>& rows();
+
+  /**
+   * @returns The completion, or invalid instance if the result is not ready or
+   * the request failed.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API Completion& completion();
+
+  /**
+   * @returns The error, or invalid instance if the result is not ready or
+   * the request succeeded.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API Error& error();
+
+private:
+  friend Connection;
+
+  struct State final {
+    Connection* connection_{};
+    bool is_ready_{};
+    std::vector<Row> rows_;
+    Completion completion_;
+    Error error_;
+  };
+
+  std::shared_ptr<State> state_;
+
+  explicit Pending_result(std::shared_ptr<State> state) noexcept;
+  void throw_if_invalid(const char* what) const;
+};
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_PENDING_RESULT_HPP
@@ -19,42 +19,97 @@
 
 #include "array_aliases.hpp"
 #include "array_conversions.hpp"
+#include "arrow_batch_builder.hpp"
 #include "basics.hpp"
 #include "basic_conversions.hpp"
+#include "batch_insert.hpp"
+#include "bulk_completion.hpp"
+#include "column_decoder.hpp"
 #include "completion.hpp"
 #include "composite.hpp"
 #include "compositional.hpp"
 #include "connection.hpp"
+#include "connection_multiplexer.hpp"
 #include "connection_options.hpp"
 #include "connection_pool.hpp"
+#include "connection_reactor.hpp"
 #include "contract.hpp"
 #include "conversions.hpp"
 #include "conversions_api.hpp"
 #include "copier.hpp"
+#include "copy_binary_writer.hpp"
+#include "copy_reader.hpp"
+#include "copy_writer.hpp"
+#include "csv_writer.hpp"
+#include "cursor.hpp"
 #include "data.hpp"
+#include "data_arena.hpp"
 #include "errc.hpp"
 #include "errctg.hpp"
 #include "error.hpp"
 #include "exceptions.hpp"
+#include "group_commit_executor.hpp"
+#include "hedged_read_executor.hpp"
+#include "json_row_writer.hpp"
 #include "large_object.hpp"
+#include "large_object_streambuf.hpp"
 #include "message.hpp"
+#include "metrics.hpp"
 #include "misc.hpp"
 #include "notice.hpp"
 #include "notification.hpp"
+#include "notification_dispatcher.hpp"
+#include "parallel_column_decoder.hpp"
+#include "parallel_copy_exporter.hpp"
+#include "parallel_copy_loader.hpp"
+#include "parallel_large_object_transfer.hpp"
+#include "parallel_range_query.hpp"
+#include "partitioned_copy_loader.hpp"
+#include "pending_result.hpp"
+#include "poll_reactor.hpp"
 #include "parameterizable.hpp"
 #include "prepared_statement.hpp"
+#include "prepared_statement_registry.hpp"
 #include "problem.hpp"
+#include "query_catalog.hpp"
+#include "reactor.hpp"
+#include "read_coalescer.hpp"
 #include "ready_for_query.hpp"
+#include "replication_stream.hpp"
 #include "response.hpp"
+#include "result_cache.hpp"
+#include "routing_connection_pool.hpp"
 #include "row.hpp"
+#include "row_batch.hpp"
 #include "row_info.hpp"
+#include "row_mapping.hpp"
+#include "row_range.hpp"
+#include "row_spool.hpp"
+#include "shard_routing_pool.hpp"
+#include "sharded_connection_pool.hpp"
 #include "signal.hpp"
+#include "slow_query_sampler.hpp"
 #include "statement.hpp"
+#include "statement_binding.hpp"
+#include "statement_reader.hpp"
+#include "statement_statistics.hpp"
 #include "statement_vector.hpp"
+#include "traffic_recorder.hpp"
+#include "traffic_replayer.hpp"
 #include "transaction_guard.hpp"
 #include "tuple.hpp"
+#include "type_catalog.hpp"
 #include "types_fwd.hpp"
 #include "version.hpp"
+#include "write_coalescer.hpp"
 #include "lib_version.hpp"
 
+#ifdef DMITIGR_PGFE_ZLIB
+#include "gzip_copy.hpp"
+#endif
+
+#ifdef DMITIGR_PGFE_SIMDJSON
+#include "simdjson_conversions.hpp"
+#endif
+
 #endif  // DMITIGR_PGFE_PGFE_HPP
@@ -0,0 +1,223 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../os/error.hpp"
+#include "../os/last_error.hpp"
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "poll_reactor.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <string>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include "../os/windows.hpp"
+#include <Winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+[[noreturn]] inline void throw_reactor_error(const char* const what)
+{
+  throw Client_exception{std::string{what} + ": " +
+    os::error_message(os::last_error())};
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Poll_reactor::~Poll_reactor()
+{
+  while (!sockets_.empty())
+    release(sockets_.begin()->first);
+#ifdef __linux__
+  if (descriptor_ >= 0)
+    ::close(descriptor_);
+#endif
+}
+
+DMITIGR_PGFE_INLINE Poll_reactor::Poll_reactor()
+{
+#ifdef __linux__
+  descriptor_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (descriptor_ < 0)
+    detail::throw_reactor_error("cannot create reactor");
+#endif
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Poll_reactor::run_once(const std::optional<std::chrono::milliseconds> timeout)
+{
+  // The readiness of the output of connections could be changed.
+  for (auto& [socket, state] : sockets_)
+    if (state->connection_)
+      update_registration(*state);
+
+  const int timeout_ms = timeout ?
+    static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(
+        timeout->count(), 0, INT_MAX)) : -1;
+
+  ready_sockets_.clear();
+  ready_readiness_.clear();
+  const auto push_ready = [this](const int socket, const bool is_readable,
+    const bool is_writable, const bool is_failed)
+  {
+    auto readiness = Socket_readiness::unready;
+    if (is_readable || is_failed)
+      readiness |= Socket_readiness::read_ready;
+    if (is_writable)
+      readiness |= Socket_readiness::write_ready;
+    if (is_failed)
+      readiness |= Socket_readiness::exceptions;
+    ready_sockets_.push_back(socket);
+    ready_readiness_.push_back(readiness);
+  };
+
+#ifdef __linux__
+  constexpr int max_event_count{64};
+  epoll_event events[max_event_count];
+  const int count = ::epoll_wait(descriptor_, events, max_event_count,
+    timeout_ms);
+  if (count < 0) {
+    if (errno == EINTR)
+      return 0;
+    detail::throw_reactor_error("cannot wait for events");
+  }
+  for (int i{}; i < count; ++i) {
+    const auto e = events[i].events;
+    push_ready(events[i].data.fd, e & EPOLLIN, e & EPOLLOUT,
+      e & (EPOLLERR | EPOLLHUP));
+  }
+#else
+#ifdef _WIN32
+  using Pollfd = WSAPOLLFD;
+#else
+  using Pollfd = pollfd;
+#endif
+  std::vector<Pollfd> fds;
+  fds.reserve(sockets_.size());
+  for (const auto& [socket, state] : sockets_) {
+    if (const int events = state->registered_events_) {
+      Pollfd fd{};
+#ifdef _WIN32
+      fd.fd = static_cast<SOCKET>(socket);
+#else
+      fd.fd = socket;
+#endif
+      if (events & static_cast<int>(Socket_readiness::read_ready))
+        fd.events |= POLLIN;
+      if (events & static_cast<int>(Socket_readiness::write_ready))
+        fd.events |= POLLOUT;
+      fds.push_back(fd);
+    }
+  }
+#ifdef _WIN32
+  const int count = ::WSAPoll(fds.data(), static_cast<ULONG>(fds.size()),
+    timeout_ms);
+#else
+  const int count = ::poll(fds.data(), fds.size(), timeout_ms);
+  if (count < 0 && errno == EINTR)
+    return 0;
+#endif
+  if (count < 0)
+    detail::throw_reactor_error("cannot wait for events");
+  for (const auto& fd : fds) {
+    if (const auto e = fd.revents)
+      push_ready(static_cast<int>(fd.fd), e & POLLIN, e & POLLOUT,
+        e & (POLLERR | POLLHUP | POLLNVAL));
+  }
+#endif
+
+  for (std::size_t i{}; i < ready_sockets_.size(); ++i)
+    handle(ready_sockets_[i], ready_readiness_[i]);
+  return ready_sockets_.size();
+}
+
+DMITIGR_PGFE_INLINE void Poll_reactor::run()
+{
+  const auto has_work = [this]
+  {
+    return std::any_of(sockets_.cbegin(), sockets_.cend(), [](const auto& p)
+    {
+      const auto& state = *p.second;
+      return !state.waits_.empty() ||
+        (state.connection_ && state.connection_->has_uncompleted_request());
+    });
+  };
+  while (has_work())
+    run_once();
+}
+
+DMITIGR_PGFE_INLINE auto Poll_reactor::state_of(const int socket)
+  -> Socket_state&
+{
+  if (const auto i = sockets_.find(socket); i != sockets_.end())
+    return *i->second;
+
+  auto state = std::make_unique<Socket_state>();
+  state->socket_ = socket;
+  sockets_.emplace(socket, state.get());
+  return *state.release();
+}
+
+DMITIGR_PGFE_INLINE void Poll_reactor::update_registration(Socket_state& state)
+{
+  const int events{static_cast<int>(requested_readiness(state))};
+  if (events == state.registered_events_)
+    return;
+
+#ifdef __linux__
+  epoll_event event{};
+  event.data.fd = state.socket_;
+  if (events & static_cast<int>(Socket_readiness::read_ready))
+    event.events |= EPOLLIN;
+  if (events & static_cast<int>(Socket_readiness::write_ready))
+    event.events |= EPOLLOUT;
+  const int op = !state.registered_events_ ? EPOLL_CTL_ADD :
+    !events ? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+  if (::epoll_ctl(descriptor_, op, state.socket_, &event) != 0)
+    detail::throw_reactor_error("cannot register socket in reactor");
+#endif
+  state.registered_events_ = events;
+}
+
+DMITIGR_PGFE_INLINE void Poll_reactor::release(const int socket) noexcept
+{
+  const auto i = sockets_.find(socket);
+  if (i == sockets_.end())
+    return;
+
+  const std::unique_ptr<Socket_state> state{i->second};
+  sockets_.erase(i);
+#ifdef __linux__
+  if (state->registered_events_) {
+    epoll_event event{};
+    // The socket may be already closed.
+    ::epoll_ctl(descriptor_, EPOLL_CTL_DEL, socket, &event);
+  }
+#endif
+}
+
+} // namespace dmitigr::pgfe
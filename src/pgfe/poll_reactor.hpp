@@ -0,0 +1,100 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_POLL_REACTOR_HPP
+#define DMITIGR_PGFE_POLL_REACTOR_HPP
+
+#include "connection_reactor.hpp"
+#include "dll.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief The event loop which drives many connections from one thread.
+ *
+ * @details The sockets are polled by `epoll` on Linux and by `poll` (or
+ * `WSAPoll` on Windows) on other platforms.
+ *
+ * @remarks This class is not thread-safe.
+ */
+class Poll_reactor final : public Connection_reactor {
+public:
+  /// The destructor.
+  DMITIGR_PGFE_API ~Poll_reactor() override;
+
+  /**
+   * @brief The constructor.
+   *
+   * @throws Client_exception on error.
+   */
+  DMITIGR_PGFE_API Poll_reactor();
+
+  /// Not copy-constructible.
+  Poll_reactor(const Poll_reactor&) = delete;
+
+  /// Not copy-assignable.
+  Poll_reactor& operator=(const Poll_reactor&) = delete;
+
+  /// Not move-constructible.
+  Poll_reactor(Poll_reactor&&) = delete;
+
+  /// Not move-assignable.
+  Poll_reactor& operator=(Poll_reactor&&) = delete;
+
+  /**
+   * @brief Waits for the readiness of the sockets and handles it.
+   *
+   * @param timeout The maximum amount of time to wait. The value of
+   * `std::nullopt` means *eternity*.
+   *
+   * @returns The number of the ready sockets which were handled.
+   *
+   * @throws Any exception thrown by the handlers or by the connection
+   * operations.
+   */
+  DMITIGR_PGFE_API std::size_t
+  run_once(std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+  /**
+   * @brief Calls run_once() while either a wait is pending or any added
+   * connection has an uncompleted request.
+   */
+  DMITIGR_PGFE_API void run();
+
+private:
+  int descriptor_{-1}; // epoll instance
+  std::vector<int> ready_sockets_;
+  std::vector<Socket_readiness> ready_readiness_;
+
+  Socket_state& state_of(int socket) override;
+  void update_registration(Socket_state& state) override;
+  void release(int socket) noexcept override;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "poll_reactor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_POLL_REACTOR_HPP
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 
 namespace std {
@@ -116,6 +117,7 @@ public:
   Result(Result&& rhs) noexcept
     : status_{rhs.status_}
     , pgresult_{std::move(rhs.pgresult_)}
+    , shared_pgresult_{std::move(rhs.shared_pgresult_)}
   {
     rhs.status_ = static_cast<Status>(-1);
   }
@@ -136,7 +138,7 @@ public:
   /// @returns `true` if this instance is set to a some `PGresult`.
   explicit operator bool() const noexcept
   {
-    return static_cast<bool>(pgresult_);
+    return pgresult_ || shared_pgresult_;
   }
 
   /// Resets the current instance to the specified `pgresult`.
@@ -144,18 +146,25 @@ public:
   {
     status_ = pgresult ? PQresultStatus(pgresult) : static_cast<Status>(-1);
     pgresult_.reset(pgresult);
+    shared_pgresult_.reset();
   }
 
-  /// Releases the underlying result.
+  /**
+   * @brief Releases the underlying result.
+   *
+   * @par Requires
+   * `!is_shareable()`.
+   */
   PGresult* release() noexcept
   {
+    DMITIGR_ASSERT(!is_shareable());
     return pgresult_.release();
   }
 
   /// @returns The raw pointer to the libpq's result.
   const PGresult* native_handle() const noexcept
   {
-    return pgresult_.get();
+    return pgresult_ ? pgresult_.get() : shared_pgresult_.get();
   }
 
   /// Swaps this with `rhs`.
@@ -164,6 +173,61 @@ public:
     using std::swap;
     swap(status_, rhs.status_);
     swap(pgresult_, rhs.pgresult_);
+    swap(shared_pgresult_, rhs.shared_pgresult_);
+  }
+
+  /**
+   * @brief Makes the underlying result shareable between the multiple
+   * instances.
+   *
+   * @par Requires
+   * `*this`.
+   *
+   * @par Effects
+   * `is_shareable()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see share().
+   */
+  void make_shareable()
+  {
+    DMITIGR_ASSERT(*this);
+    if (pgresult_)
+      shared_pgresult_ = std::move(pgresult_); // can throw
+  }
+
+  /// @returns `true` if the underlying result is shareable.
+  bool is_shareable() const noexcept
+  {
+    return static_cast<bool>(shared_pgresult_);
+  }
+
+  /**
+   * @returns The instance which shares the underlying result with this one.
+   *
+   * @par Requires
+   * `is_shareable()`.
+   *
+   * @see make_shareable().
+   */
+  Result share() const noexcept
+  {
+    DMITIGR_ASSERT(is_shareable());
+    Result result;
+    result.status_ = status_;
+    result.shared_pgresult_ = shared_pgresult_;
+    return result;
+  }
+
+  /**
+   * @returns The number of bytes allocated for the underlying result, or `0`
+   * if there is no underlying result.
+   */
+  std::size_t memory_size() const noexcept
+  {
+    return native_handle() ? PQresultMemorySize(native_handle()) : 0;
   }
 
   /**
@@ -476,6 +540,7 @@ public:
 private:
   Status status_{static_cast<Status>(-1)}; // optimization
   std::unique_ptr<PGresult> pgresult_;
+  std::shared_ptr<PGresult> shared_pgresult_; // see make_shareable()
 };
 
 /// Result is swappable.
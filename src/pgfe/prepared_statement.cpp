@@ -77,6 +77,29 @@ DMITIGR_PGFE_INLINE bool Named_argument::is_invariant_ok() const noexcept
 
 // =============================================================================
 
+DMITIGR_PGFE_INLINE Typed_argument::Typed_argument(const Oid type,
+  std::unique_ptr<Data>&& data) noexcept
+  : type_{type}
+  , data_{std::move(data)}
+{}
+
+DMITIGR_PGFE_INLINE Oid Typed_argument::type() const noexcept
+{
+  return type_;
+}
+
+DMITIGR_PGFE_INLINE Data_view Typed_argument::data() const noexcept
+{
+  return data_ ? Data_view{*data_} : Data_view{};
+}
+
+DMITIGR_PGFE_INLINE std::unique_ptr<Data> Typed_argument::release() noexcept
+{
+  return std::move(data_);
+}
+
+// =============================================================================
+
 DMITIGR_PGFE_INLINE Prepared_statement::~Prepared_statement() noexcept
 {
   if (is_registered_ && is_valid()) {
@@ -85,7 +108,7 @@ DMITIGR_PGFE_INLINE Prepared_statement::~Prepared_statement() noexcept
     DMITIGR_ASSERT(p != e);
 
     state_ = nullptr;
-    if ((*p).use_count() == 1)
+    if (p->second.use_count() == 1)
       conn->unregister_ps(p);
   }
 }
@@ -95,7 +118,11 @@ Prepared_statement::Prepared_statement(Prepared_statement&& rhs) noexcept
   : is_registered_{rhs.is_registered_}
   , state_{std::move(rhs.state_)}
   , parameters_{std::move(rhs.parameters_)}
+  , named_parameter_indexes_{std::move(rhs.named_parameter_indexes_)}
   , result_format_{std::move(rhs.result_format_)}
+  , row_delivery_mode_{std::move(rhs.row_delivery_mode_)}
+  , result_memory_limit_{std::move(rhs.result_memory_limit_)}
+  , data_arena_{rhs.data_arena_}
 {}
 
 DMITIGR_PGFE_INLINE Prepared_statement&
@@ -114,7 +141,11 @@ DMITIGR_PGFE_INLINE void Prepared_statement::swap(Prepared_statement& rhs) noexc
   swap(is_registered_, rhs.is_registered_);
   swap(state_, rhs.state_);
   swap(parameters_, rhs.parameters_);
+  swap(named_parameter_indexes_, rhs.named_parameter_indexes_);
   swap(result_format_, rhs.result_format_);
+  swap(row_delivery_mode_, rhs.row_delivery_mode_);
+  swap(result_memory_limit_, rhs.result_memory_limit_);
+  swap(data_arena_, rhs.data_arena_);
 }
 
 DMITIGR_PGFE_INLINE bool Prepared_statement::is_valid() const noexcept
@@ -175,13 +206,13 @@ Prepared_statement::parameter_name(const std::size_t index) const
 DMITIGR_PGFE_INLINE std::size_t
 Prepared_statement::parameter_index(const std::string_view name) const noexcept
 {
-  const auto b = cbegin(parameters_);
-  const auto e = cend(parameters_);
-  const auto i = find_if(b, e, [&name](const auto& p)
+  const auto [b, e] =
+    named_parameter_indexes_.equal_range(std::hash<std::string_view>{}(name));
+  const auto i = find_if(b, e, [this, name](const auto& hi)
   {
-    return p.name == name;
+    return parameters_[hi.second].name == name;
   });
-  return static_cast<std::size_t>(i - b);
+  return i != e ? i->second : parameter_count();
 }
 
 DMITIGR_PGFE_INLINE const std::string& Prepared_statement::name() const noexcept
@@ -198,7 +229,7 @@ DMITIGR_PGFE_INLINE Data_view Prepared_statement::bound(const std::size_t index)
 {
   if (!(index < parameter_count()))
     throw_exception("cannot get bound parameter value of");
-  const auto& result = parameters_[index].data;
+  const auto* const result = parameters_[index].bound_data();
   return result ? Data_view{*result} : Data_view{};
 }
 
@@ -208,6 +239,35 @@ Prepared_statement::bound(const std::string_view name) const
   return bound(parameter_index(name));
 }
 
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::set_parameter_type(const std::size_t index, const Oid type)
+{
+  bindable_parameter__(index).type = type;
+  assert(is_invariant_ok());
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::set_parameter_type(const std::string_view name,
+  const Oid type)
+{
+  return set_parameter_type(parameter_index(name), type);
+}
+
+DMITIGR_PGFE_INLINE Oid
+Prepared_statement::parameter_type(const std::size_t index) const
+{
+  if (!(index < parameter_count()))
+    throw_exception("cannot get parameter type of");
+  return parameters_[index].type;
+}
+
+DMITIGR_PGFE_INLINE Oid
+Prepared_statement::parameter_type(const std::string_view name) const
+{
+  return parameter_type(parameter_index(name));
+}
+
 DMITIGR_PGFE_INLINE void
 Prepared_statement::set_result_format(const Data_format format)
 {
@@ -221,60 +281,241 @@ Prepared_statement::result_format() const noexcept
   return result_format_;
 }
 
+DMITIGR_PGFE_INLINE void
+Prepared_statement::set_row_delivery_mode(const Row_delivery_mode mode)
+{
+  Connection::throw_if_row_delivery_mode_unavailable(mode);
+  row_delivery_mode_ = mode;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE Row_delivery_mode
+Prepared_statement::row_delivery_mode() const noexcept
+{
+  return row_delivery_mode_;
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::set_result_memory_limit(
+  const std::optional<std::size_t> limit)
+{
+  if (!(!limit || *limit > 0))
+    throw Client_exception{"cannot set result memory limit: invalid limit"};
+
+  result_memory_limit_ = limit;
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::size_t>
+Prepared_statement::result_memory_limit() const noexcept
+{
+  return result_memory_limit_;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_no_copy(const std::size_t index,
+  const std::string_view bytes, const Data_format format)
+{
+  // Data_view of null bytes is invalid, i.e. would be bound as NULL.
+  return bind_view__(index, Data_view{bytes.data() ? bytes.data() : "",
+      bytes.size(), format});
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_no_copy(const std::size_t index,
+  const std::byte* const bytes, const std::size_t size, const Data_format format)
+{
+  if (!(bytes || !size))
+    throw_exception("cannot bind parameter of");
+  return bind_no_copy(index, std::string_view{
+      reinterpret_cast<const char*>(bytes), size}, format);
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_no_copy(const std::string_view name,
+  const std::string_view bytes, const Data_format format)
+{
+  return bind_no_copy(parameter_index(name), bytes, format);
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_no_copy(const std::string_view name,
+  const std::byte* const bytes, const std::size_t size, const Data_format format)
+{
+  return bind_no_copy(parameter_index(name), bytes, size, format);
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::set_data_arena(Data_arena* const arena) noexcept
+{
+  data_arena_ = arena;
+}
+
+DMITIGR_PGFE_INLINE Data_arena* Prepared_statement::data_arena() const noexcept
+{
+  return data_arena_;
+}
+
 DMITIGR_PGFE_INLINE void Prepared_statement::execute_nio()
 {
-  execute_nio__(nullptr);
+  execute_nio__(nullptr, nullptr);
 }
 
 DMITIGR_PGFE_INLINE void Prepared_statement::execute_nio(const Statement& statement)
 {
-  execute_nio__(&statement);
+  execute_nio__(&statement, nullptr);
+}
+
+DMITIGR_PGFE_INLINE void Prepared_statement::execute_nio(const std::string& query)
+{
+  execute_nio__(nullptr, &query);
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::execute_simple_nio(const std::string& query)
+{
+  execute_nio__(nullptr, &query, true);
 }
 
 DMITIGR_PGFE_INLINE void
-Prepared_statement::execute_nio__(const Statement* const statement)
+Prepared_statement::execute_nio(const Statement& statement,
+  const detail::Static_parameter_arrays& parameters)
+{
+  execute_nio__(&statement, nullptr, false, &parameters);
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::execute_nio__(const Statement* const statement,
+  const std::string* query, bool is_simple,
+  const detail::Static_parameter_arrays* const static_parameters)
 {
   if (!is_valid())
     throw_exception("cannot execute invalid");
   else if (!(connection().is_ready_for_nio_request()))
     throw_exception("cannot execute");
+  const detail::Allocation_scope allocation_scope{
+    Allocation_category::execute_send};
 
-  // All the values are NULLs initially. (Can throw.)
-  const int param_count{static_cast<int>(parameter_count())};
-  std::vector<const char*> values(static_cast<unsigned>(param_count), nullptr);
-  std::vector<int> lengths(static_cast<unsigned>(param_count), 0);
-  std::vector<int> formats(static_cast<unsigned>(param_count), 0);
-
+  /*
+   * The parameter arrays are placed on the stack if possible, otherwise the
+   * reusable buffers of the connection are used, so no allocations are
+   * performed in the steady state. The static parameters are passed as is.
+   */
+  const std::size_t param_count{static_parameters ?
+    static_parameters->count : parameter_count()};
+  const char* stack_values[Connection::Parameter_buffers::stack_capacity];
+  int stack_lengths[Connection::Parameter_buffers::stack_capacity];
+  int stack_formats[Connection::Parameter_buffers::stack_capacity];
+  ::Oid stack_types[Connection::Parameter_buffers::stack_capacity];
+  const char** values{stack_values};
+  int* lengths{stack_lengths};
+  int* formats{stack_formats};
+  ::Oid* types{stack_types};
   auto& conn = connection();
+  if (!static_parameters &&
+    param_count > Connection::Parameter_buffers::stack_capacity) {
+    auto& buffers = conn.parameter_buffers_;
+    buffers.values_.resize(param_count); // can throw
+    buffers.lengths_.resize(param_count); // can throw
+    buffers.formats_.resize(param_count); // can throw
+    buffers.types_.resize(param_count); // can throw
+    values = buffers.values_.data();
+    lengths = buffers.lengths_.data();
+    formats = buffers.formats_.data();
+    types = buffers.types_.data();
+  }
+
+  // The mode is chosen by the statistics of executions if adaptive.
+  const bool is_adaptive{row_delivery_mode_ == Row_delivery_mode::adaptive};
+  const auto [resolved_mode, rows_chunk_size] = is_adaptive ?
+    adaptive_row_delivery_mode() : std::pair{row_delivery_mode_, 0};
+
+  // The rows are streamed rather than accumulated if the memory is limited.
+  const auto row_delivery_mode = result_memory_limit_ &&
+    conn.result_memory_policy_ == Result_memory_policy::stream &&
+    resolved_mode == Row_delivery_mode::full ?
+    Row_delivery_mode::single : resolved_mode;
   conn.requests_.emplace(Connection::Request::Id::execute); // can throw
+  auto& request = conn.requests_.back();
+  request.row_delivery_mode_ = row_delivery_mode;
+  request.rows_chunk_size_ = rows_chunk_size;
+  if (is_adaptive)
+    request.delivery_state_ = state_;
+  request.result_memory_limit_ = result_memory_limit_;
+  request.result_memory_policy_ = conn.result_memory_policy_;
   try {
     // Prepare the input for libpq.
-    for (unsigned i{}; i < static_cast<unsigned>(param_count); ++i) {
+    bool has_types{};
+    for (std::size_t i{}; !static_parameters && i < param_count; ++i) {
+      types[i] = parameters_[i].type;
+      has_types = has_types || types[i] != invalid_oid;
       if (const auto d = bound(i)) {
         values[i] = static_cast<const char*>(d.bytes());
         lengths[i] = static_cast<int>(d.size());
         formats[i] = detail::pq::to_int(d.format());
+      } else {
+        values[i] = nullptr;
+        lengths[i] = 0;
+        formats[i] = 0;
       }
     }
+    const char* const* const param_values{static_parameters ?
+      static_parameters->values : values};
+    const int* const param_lengths{static_parameters ?
+      static_parameters->lengths : lengths};
+    const int* const param_formats{static_parameters ?
+      static_parameters->formats : formats};
     const int result_format = detail::pq::to_int(result_format_);
 
-    const int send_ok = statement
+    if (statement)
+      query = &conn.query_string__(*statement);
+
+    // The simple query protocol is used for the unprepared statements only.
+    is_simple = query && !param_count &&
+      conn.pipeline_status() == Pipeline_status::disabled &&
+      (is_simple || (conn.is_simple_query_enabled_ &&
+        result_format_ == Data_format::text));
+    request.is_simple_query_ = is_simple;
+    conn.prepare_trace(Trace_request::execute,
+      query ? std::string_view{*query} : std::string_view{}, name(),
+      param_count); // can throw
+    const std::string_view query_text = query ?
+      conn.tagged_query(*query) : std::string_view{}; // can throw
+    const int send_ok = is_simple
+      ? PQsendQuery(conn.conn(), query_text.data())
+      : query
       ? PQsendQueryParams(conn.conn(),
-        statement->to_query_string(conn).c_str(),
-        param_count, nullptr, values.data(), lengths.data(),
-        formats.data(), result_format)
+        query_text.data(),
+        static_cast<int>(param_count), has_types ? types : nullptr,
+        param_values, param_lengths, param_formats, result_format)
       : PQsendQueryPrepared(conn.conn(),
         name().c_str(),
-        param_count, values.data(), lengths.data(),
-        formats.data(), result_format);
+        static_cast<int>(param_count), param_values, param_lengths,
+        param_formats, result_format);
 
     if (!send_ok)
       throw Client_exception{conn.error_message()};
 
+    if (const auto& recorder = conn.traffic_recorder_) {
+      recorder->record_execute(conn.traffic_session_,
+        query ? std::string_view{} : std::string_view{name()},
+        query ? std::string_view{*query} : std::string_view{},
+        param_count, param_values, param_lengths, param_formats,
+        has_types ? types : nullptr, result_format);
+    }
+
+    std::size_t byte_count{};
+    if (conn.is_metrics_enabled_) {
+      byte_count = query ? query_text.size() : name().size();
+      for (std::size_t i{}; i < param_count; ++i)
+        byte_count += static_cast<std::size_t>(param_lengths[i]);
+    }
+    conn.account_request(byte_count);
+
     if (conn.pipeline_status() == Pipeline_status::disabled)
-      conn.set_single_row_mode_enabled();
+      conn.set_row_delivery_mode_enabled(request);
   } catch (...) {
-    conn.requests_.pop(); // rollback
+    conn.requests_.pop_back(); // rollback
     throw;
   }
 
@@ -351,7 +592,8 @@ Prepared_statement::row_info() const noexcept
 DMITIGR_PGFE_INLINE Prepared_statement::Prepared_statement(
   std::shared_ptr<Prepared_statement::State> state,
   const Statement* const preparsed,
-  const bool is_registered)
+  const bool is_registered,
+  const std::optional<std::string>* const bound_values)
   : is_registered_{is_registered}
 {
   init_connection__(std::move(state));
@@ -362,12 +604,18 @@ DMITIGR_PGFE_INLINE Prepared_statement::Prepared_statement(
     parameters_.resize(pc);
     for (std::size_t i = preparsed->positional_parameter_count(); i < pc; ++i) {
       const auto name = preparsed->parameter_name(i);
-      if (preparsed->bound(name))
+      if (preparsed->bound(name) || (bound_values && bound_values[i]))
         ++bound_params_count;
       else
         parameters_[i - bound_params_count].name = name;
     }
     parameters_.resize(pc - bound_params_count);
+    named_parameter_indexes_.reserve(parameters_.size());
+    for (std::size_t i{}; i < parameters_.size(); ++i) {
+      if (const auto& name = parameters_[i].name; !name.empty())
+        named_parameter_indexes_.emplace(
+          std::hash<std::string_view>{}(name), i);
+    }
   } else
     parameters_.reserve(8);
 
@@ -389,6 +637,55 @@ Prepared_statement::init_connection__(
   DMITIGR_ASSERT(state_);
   DMITIGR_ASSERT(is_valid());
   result_format_ = connection().result_format();
+  row_delivery_mode_ = connection().row_delivery_mode();
+  result_memory_limit_ = connection().result_memory_limit();
+}
+
+DMITIGR_PGFE_INLINE std::pair<Row_delivery_mode, int>
+Prepared_statement::adaptive_row_delivery_mode() const noexcept
+{
+  // The results up to these sizes are cheaper to retrieve at once.
+  constexpr double max_full_row_count{64};
+  constexpr double max_full_byte_count{64 * 1024};
+
+  const auto& s = *state_;
+  if (!s.delivery_count_)
+    return {Row_delivery_mode::single, 0};
+  else if (s.delivery_row_count_ <= max_full_row_count &&
+    s.delivery_row_count_ * s.delivery_row_size_ <= max_full_byte_count)
+    return {Row_delivery_mode::full, 0};
+
+#ifdef LIBPQ_HAS_CHUNK_MODE
+  // The size of chunks is tuned to retrieve about 256 KiB at once.
+  constexpr double chunk_byte_count{256 * 1024};
+  constexpr double min_chunk_row_count{16};
+  constexpr double max_chunk_row_count{64 * 1024};
+  const double row_size = std::max(s.delivery_row_size_, 1.0);
+  const double chunk_row_count = std::clamp(chunk_byte_count / row_size,
+    min_chunk_row_count, max_chunk_row_count);
+  return {Row_delivery_mode::chunked, static_cast<int>(chunk_row_count)};
+#else
+  return {Row_delivery_mode::single, 0};
+#endif
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement::State::account_delivery(const std::size_t row_count,
+  const std::size_t byte_count) noexcept
+{
+  // The moving averages give the weight of 1/8 to the last execution.
+  constexpr double weight{.125};
+  const auto rows = static_cast<double>(row_count);
+  if (!delivery_count_++)
+    delivery_row_count_ = rows;
+  else
+    delivery_row_count_ += weight * (rows - delivery_row_count_);
+
+  if (row_count) {
+    const double row_size = static_cast<double>(byte_count) / rows;
+    delivery_row_size_ = delivery_row_size_ > 0 ? delivery_row_size_ +
+      weight * (row_size - delivery_row_size_) : row_size;
+  }
 }
 
 DMITIGR_PGFE_INLINE bool Prepared_statement::is_invariant_ok() const noexcept
@@ -410,8 +707,8 @@ Prepared_statement::throw_exception(std::string msg) const
   throw Client_exception{msg};
 }
 
-DMITIGR_PGFE_INLINE Prepared_statement&
-Prepared_statement::bind(const std::size_t index, Data_ptr&& data)
+DMITIGR_PGFE_INLINE auto
+Prepared_statement::bindable_parameter__(const std::size_t index) -> Parameter&
 {
   const bool is_opaque = !is_preparsed() && !is_described();
   if (!(is_opaque || (index < parameter_count())))
@@ -423,7 +720,41 @@ Prepared_statement::bind(const std::size_t index, Data_ptr&& data)
     if (index >= parameters_.size())
       parameters_.resize(index + 1);
   }
-  parameters_[index].data = std::move(data);
+  return parameters_[index];
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind(const std::size_t index, Data_ptr&& data)
+{
+  auto& parameter = bindable_parameter__(index);
+  parameter.data = std::move(data);
+  parameter.inline_data.reset();
+  parameter.view = {};
+
+  assert(is_invariant_ok());
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_inline__(const std::size_t index,
+  const Inline_data& data)
+{
+  auto& parameter = bindable_parameter__(index);
+  parameter.inline_data = data;
+  parameter.data.reset();
+  parameter.view = {};
+
+  assert(is_invariant_ok());
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind_view__(const std::size_t index, const Data_view& data)
+{
+  auto& parameter = bindable_parameter__(index);
+  parameter.view = data;
+  parameter.data.reset();
+  parameter.inline_data.reset();
 
   assert(is_invariant_ok());
   return *this;
@@ -438,6 +769,20 @@ Prepared_statement::bind__(const std::size_t, Named_argument&& na)
     return bind(na.name(), na.data());
 }
 
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind__(const std::size_t index, Typed_argument&& ta)
+{
+  bind(index, ta.release());
+  return set_parameter_type(index, ta.type());
+}
+
+DMITIGR_PGFE_INLINE Prepared_statement&
+Prepared_statement::bind__(const std::size_t index, const Typed_argument& ta)
+{
+  bind(index, ta.data());
+  return set_parameter_type(index, ta.type());
+}
+
 DMITIGR_PGFE_INLINE Prepared_statement&
 Prepared_statement::bind__(const std::size_t, const Named_argument& na)
 {
@@ -453,6 +798,8 @@ Prepared_statement::set_description(detail::pq::Result&& r)
   DMITIGR_ASSERT(r);
 
   parameters_.resize(static_cast<std::size_t>(r.ps_param_count()));
+  for (std::size_t i{}; i < parameters_.size(); ++i)
+    parameters_[i].type = r.ps_param_type_oid(static_cast<int>(i));
 
   /*
    * If result contains fields info, initialize Row_info.
@@ -19,20 +19,27 @@
 
 #include "../util/memory.hpp"
 #include "basics.hpp"
-#include "conversions_api.hpp"
+#include "bulk_completion.hpp"
+#include "conversions.hpp"
+#include "data_arena.hpp"
 #include "dll.hpp"
+#include "metrics.hpp"
 #include "parameterizable.hpp"
 #include "response.hpp"
 #include "row_info.hpp"
+#include "static_parameters.hpp"
 #include "types_fwd.hpp"
 
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -118,6 +125,54 @@ private:
  */
 using a = Named_argument;
 
+/**
+ * @ingroup main
+ *
+ * @brief A positional argument of the specified type to pass to a prepared
+ * statement.
+ *
+ * @details Unlike the arguments of other types, the type of this argument is
+ * sent to the server upon execution without preparing, so the server doesn't
+ * infer it. This is required to pass the data of binary format without the
+ * explicit type casts.
+ *
+ * @see binary_argument(), Prepared_statement::set_parameter_type().
+ */
+class Typed_argument final {
+public:
+  /// Constructs the argument of the type `type` bound to `data`.
+  DMITIGR_PGFE_API Typed_argument(Oid type,
+    std::unique_ptr<Data>&& data) noexcept;
+
+  /// @returns The OID of the argument type.
+  DMITIGR_PGFE_API Oid type() const noexcept;
+
+  /// @returns The bound data.
+  DMITIGR_PGFE_API Data_view data() const noexcept;
+
+  /// @returns The released bound data.
+  DMITIGR_PGFE_API std::unique_ptr<Data> release() noexcept;
+
+private:
+  Oid type_{invalid_oid};
+  std::unique_ptr<Data> data_;
+};
+
+/**
+ * @ingroup main
+ *
+ * @returns The argument bound to `value` converted to the data of binary
+ * format, of type `binary_oid_v<T>`.
+ */
+template<typename T>
+Typed_argument binary_argument(T&& value)
+{
+  constexpr Oid type{binary_oid_v<std::decay_t<T>>};
+  static_assert(type != invalid_oid, "the type of binary data is unknown");
+  return Typed_argument{type, to_data(std::forward<T>(value),
+      Data_format::binary)};
+}
+
 /**
  * @ingroup main
  *
@@ -258,6 +313,8 @@ public:
    *   - a type for which the specialization of Conversions is defined to bind
    *   the specified `value` of type `T`. (The conversion result of type Data
    *   will be owned by this instance;)
+   *   - Data_view to bind the copy of the specified `value`. (The data
+   *   referenced by `value` will not be owned by this instance;)
    *   - a type convertible to `const Data&` to bind the specified `value`. (The
    *   `value` will not be owned by this instance;)
    *   - `std::nullptr_t` to bind the SQL NULL.
@@ -287,14 +344,39 @@ public:
     constexpr auto is_nullptr = std::is_same_v<U, std::nullptr_t>;
     static_assert(is_nullptr || !std::is_convertible_v<U, const Data*>,
       "binding of Data* is forbidden");
+    const detail::Allocation_scope allocation_scope{Allocation_category::bind};
     if constexpr (std::is_same_v<U, std::unique_ptr<Data>>) {
       return bind(index, Data_ptr{value.release(), Data_deletion_required{true}});
+    } else if constexpr (std::is_same_v<U, Data_view>) {
+      return bind_view__(index, value);
     } else if constexpr (std::is_convertible_v<U, const Data&>) {
       return bind(index, Data_ptr{&value, Data_deletion_required{false}});
     } else if constexpr (is_nullptr) {
       return bind(index, Data_ptr{nullptr, Data_deletion_required{false}});
-    } else
-      return bind(index, to_data(std::forward<T>(value)));
+    } else {
+      // The small strings and numbers are stored in place.
+      if constexpr (std::is_same_v<U, std::string> ||
+        std::is_same_v<U, std::string_view>) {
+        if (value.size() <= Inline_data::capacity)
+          return bind_inline__(index, Inline_data{value.data(), value.size()});
+      } else if constexpr (is_numeric_conversions_v<U>) {
+        char buf[Inline_data::capacity];
+        const auto* const end = detail::numeric_to_chars(buf, buf + sizeof(buf), value);
+        return bind_inline__(index, Inline_data{buf,
+            static_cast<std::size_t>(end - buf)});
+      }
+
+      if (data_arena_)
+        bind(index, Data_ptr{&data_arena_->to_data(std::forward<T>(value)),
+            Data_deletion_required{false}});
+      else
+        bind(index, to_data(std::forward<T>(value)));
+      if constexpr (binary_oid_v<U> != invalid_oid) {
+        if (bound(index).format() == Data_format::binary)
+          parameters_[index].type = binary_oid_v<U>;
+      }
+      return *this;
+    }
   }
 
   /**
@@ -309,6 +391,154 @@ public:
     return bind(parameter_index(name), std::forward<T>(value));
   }
 
+  /**
+   * @brief Binds the parameter of the specified index with the specified value
+   * converted to the data of the specified format.
+   *
+   * @details If `format == Data_format::binary` and `binary_oid_v<T>` is valid,
+   * then the type of the parameter is set to `binary_oid_v<T>`, so the server
+   * accepts the binary data without the explicit type casts.
+   *
+   * @par Requires
+   * See bind(std::size_t, T&&).
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see set_parameter_type().
+   */
+  template<typename T>
+  Prepared_statement& bind(const std::size_t index, T&& value,
+    const Data_format format)
+  {
+    using U = std::decay_t<T>;
+    const detail::Allocation_scope allocation_scope{Allocation_category::bind};
+    bind(index, to_data(std::forward<T>(value), format));
+    if constexpr (binary_oid_v<U> != invalid_oid) {
+      if (format == Data_format::binary)
+        parameters_[index].type = binary_oid_v<U>;
+    }
+    return *this;
+  }
+
+  /**
+   * @overload
+   *
+   * @par Requries
+   * `parameter_index(name) < parameter_count()`.
+   */
+  template<typename T>
+  Prepared_statement& bind(const std::string_view name, T&& value,
+    const Data_format format)
+  {
+    return bind(parameter_index(name), std::forward<T>(value), format);
+  }
+
+  /**
+   * @brief Sets the type of the parameter of the specified index.
+   *
+   * @details The types of the parameters are sent to the server upon execution
+   * without preparing (for example, by Connection::execute()), so the server
+   * doesn't infer them. The types of the parameters of the statements prepared
+   * by Connection::prepare() are specified upon preparing and can't be changed.
+   *
+   * @param index A parameter index.
+   * @param type The OID of the type. The `invalid_oid` means that the type is
+   * inferred by the server.
+   *
+   * @par Requires
+   * See bind(std::size_t, T&&).
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see parameter_type(), Connection::prepare().
+   */
+  DMITIGR_PGFE_API Prepared_statement& set_parameter_type(std::size_t index,
+    Oid type);
+
+  /**
+   * @overload
+   *
+   * @par Requries
+   * `parameter_index(name) < parameter_count()`.
+   */
+  DMITIGR_PGFE_API Prepared_statement& set_parameter_type(std::string_view name,
+    Oid type);
+
+  /**
+   * @returns The OID of the type of the parameter, or `invalid_oid` if the
+   * type is unspecified. If `is_described()`, the type is the one inferred by
+   * the server.
+   *
+   * @par Requires
+   * `index < parameter_count()`.
+   */
+  DMITIGR_PGFE_API Oid parameter_type(std::size_t index) const;
+
+  /**
+   * @overload
+   *
+   * @par Requries
+   * `parameter_index(name) < parameter_count()`.
+   */
+  DMITIGR_PGFE_API Oid parameter_type(std::string_view name) const;
+
+  /**
+   * @brief Binds the parameter of the specified index with the specified bytes
+   * without copying them.
+   *
+   * @details This is the way to pass the large values to the server without
+   * extra copies.
+   *
+   * @par Requires
+   * The `bytes` must outlive the binding, i.e. must be valid until the parameter
+   * is rebound or this instance is destroyed.
+   *
+   * @see bind().
+   */
+  DMITIGR_PGFE_API Prepared_statement& bind_no_copy(std::size_t index,
+    std::string_view bytes, Data_format format = Data_format::text);
+
+  /// @overload
+  DMITIGR_PGFE_API Prepared_statement& bind_no_copy(std::size_t index,
+    const std::byte* bytes, std::size_t size,
+    Data_format format = Data_format::binary);
+
+  /**
+   * @overload
+   *
+   * @par Requries
+   * `parameter_index(name) < parameter_count()`.
+   */
+  DMITIGR_PGFE_API Prepared_statement& bind_no_copy(std::string_view name,
+    std::string_view bytes, Data_format format = Data_format::text);
+
+  /// @overload
+  DMITIGR_PGFE_API Prepared_statement& bind_no_copy(std::string_view name,
+    const std::byte* bytes, std::size_t size,
+    Data_format format = Data_format::binary);
+
+  /**
+   * @brief Sets the arena of data to place the results of conversions of the
+   * values bound by bind() in.
+   *
+   * @details If `arena` is not null, the values which are not of type Data are
+   * converted to Data by using `arena->to_data()` rather than `to_data()`, so
+   * the bound data is released by `arena->clear()` rather than by this instance.
+   *
+   * @par Requires
+   * If `arena` then the `arena` must outlive the bindings made with it, and
+   * must not be cleared until these bindings are replaced or this instance
+   * is executed.
+   *
+   * @see data_arena(), Data_arena.
+   */
+  DMITIGR_PGFE_API void set_data_arena(Data_arena* arena) noexcept;
+
+  /// @returns The arena of data.
+  DMITIGR_PGFE_API Data_arena* data_arena() const noexcept;
+
   /**
    * @brief Binds parameters by indexes in range [0, sizeof ... (values)).
    *
@@ -358,6 +588,56 @@ public:
    */
   DMITIGR_PGFE_API Data_format result_format() const noexcept;
 
+  /**
+   * @brief Sets the row delivery mode of results that will be produced during
+   * the execution of a SQL command.
+   *
+   * @details Overrides the mode inherited from the connection, e.g. to pin
+   * the mode of a statement which is known in advance, or to let the mode be
+   * chosen automatically (Row_delivery_mode::adaptive).
+   *
+   * @throws Client_exception if `mode == Row_delivery_mode::chunked` but
+   * libpq doesn't support it.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Connection::set_row_delivery_mode().
+   */
+  DMITIGR_PGFE_API void set_row_delivery_mode(Row_delivery_mode mode);
+
+  /**
+   * @returns The row delivery mode of results.
+   *
+   * @see Connection::row_delivery_mode().
+   */
+  DMITIGR_PGFE_API Row_delivery_mode row_delivery_mode() const noexcept;
+
+  /**
+   * @brief Sets the limit of the client-side memory of the results that will
+   * be produced during the execution of a SQL command.
+   *
+   * @param limit The value of `std::nullopt` means no limit.
+   *
+   * @par Requires
+   * `!limit || *limit > 0`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @see Connection::set_result_memory_limit().
+   */
+  DMITIGR_PGFE_API void
+  set_result_memory_limit(std::optional<std::size_t> limit);
+
+  /**
+   * @returns The limit of the client-side memory of the results.
+   *
+   * @see Connection::result_memory_limit().
+   */
+  DMITIGR_PGFE_API std::optional<std::size_t>
+  result_memory_limit() const noexcept;
+
   /**
    * @brief Submits a request to a PostgreSQL server to execute this prepared
    * statement.
@@ -397,6 +677,34 @@ public:
   /// @overload
   DMITIGR_PGFE_API Completion execute();
 
+  /**
+   * @brief Executes this prepared statement for each element of `tuples` by
+   * using the pipeline with the single synchronization point.
+   *
+   * @details The rows produced by the executions are discarded. Since the
+   * executions between the synchronization points are performed by the server
+   * in the single implicit transaction, an error aborts the remaining
+   * executions and rolls back the preceding ones, unless the executions are
+   * performed in an explicit transaction block.
+   *
+   * @param tuples A range of tuple-like objects (e.g. `std::tuple`) of the
+   * values to bind with the parameters for each execution.
+   *
+   * @returns The aggregated completion of the executions.
+   *
+   * @par Requires
+   * `connection()->is_ready_for_request()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks Defined in connection.hpp.
+   *
+   * @see Connection::execute_many().
+   */
+  template<typename Range>
+  Bulk_completion execute_many(const Range& tuples);
+
   /**
    * @returns The related Connection instance which prepared this statement.
    *
@@ -472,7 +780,15 @@ private:
   /// A parameter.
   struct Parameter final {
     Data_ptr data;
+    std::optional<Inline_data> inline_data; // used instead of data if set
+    Data_view view; // used instead of data if valid
     std::string name;
+    Oid type{invalid_oid};
+
+    const Data* bound_data() const noexcept
+    {
+      return inline_data ? &*inline_data : view ? &view : data.get();
+    }
   };
 
   /// A state.
@@ -482,36 +798,59 @@ private:
       , connection_{connection}
     {}
 
+    /// Accounts the rows delivered by an execution (Row_delivery_mode::adaptive).
+    void account_delivery(std::size_t row_count, std::size_t byte_count) noexcept;
+
     std::string id_;
     Connection* connection_{};
     bool preparsed_{};
     Row_info description_; // may be invalid, see set_description()
+    std::uint_fast64_t delivery_count_{}; // the number of accounted executions
+    double delivery_row_count_{}; // moving average of rows per execution
+    double delivery_row_size_{}; // moving average of bytes per row
   };
 
   bool is_registered_{};
   std::shared_ptr<State> state_;
   std::vector<Parameter> parameters_;
+  // Hash of name -> index of parameters_. (Filled at preparation time.)
+  std::unordered_multimap<std::size_t, std::size_t> named_parameter_indexes_;
   Data_format result_format_{Data_format::text};
+  Row_delivery_mode row_delivery_mode_{Row_delivery_mode::single};
+  std::optional<std::size_t> result_memory_limit_;
+  Data_arena* data_arena_{};
 
   // ---------------------------------------------------------------------------
 
-  /// Constructs when preparing. (Or just executing without preparement.)
+  /**
+   * Constructs when preparing. (Or just executing without preparement.) The
+   * `bound_values`, if not null, are indexed by the parameter indexes of
+   * `preparsed` and denote the parameters bound in addition to the ones bound
+   * to `preparsed`. (See Statement_binding.)
+   */
   Prepared_statement(std::shared_ptr<Prepared_statement::State> state,
-    const Statement* preparsed, const bool is_registered);
+    const Statement* preparsed, const bool is_registered,
+    const std::optional<std::string>* bound_values = nullptr);
 
   /// Constructs when describing.
   explicit
   Prepared_statement(std::shared_ptr<Prepared_statement::State> state) noexcept;
 
   void init_connection__(std::shared_ptr<Prepared_statement::State> state) noexcept;
+  std::pair<Row_delivery_mode, int> adaptive_row_delivery_mode() const noexcept;
   bool is_invariant_ok() const noexcept override;
   [[noreturn]] void throw_exception(std::string msg) const;
 
   // ---------------------------------------------------------------------------
 
+  Parameter& bindable_parameter__(std::size_t index);
   Prepared_statement& bind(std::size_t index, Data_ptr&& data);
+  Prepared_statement& bind_inline__(std::size_t index, const Inline_data& data);
+  Prepared_statement& bind_view__(std::size_t index, const Data_view& data);
   Prepared_statement& bind__(std::size_t, Named_argument&& na);
   Prepared_statement& bind__(std::size_t, const Named_argument& na);
+  Prepared_statement& bind__(std::size_t index, Typed_argument&& ta);
+  Prepared_statement& bind__(std::size_t index, const Typed_argument& ta);
 
   template<typename T>
   Prepared_statement& bind__(const std::size_t index, T&& value)
@@ -532,7 +871,13 @@ private:
 
   void set_description(detail::pq::Result&& r);
   void execute_nio(const Statement& statement);
-  void execute_nio__(const Statement* const statement);
+  void execute_nio(const std::string& query);
+  void execute_simple_nio(const std::string& query);
+  void execute_nio(const Statement& statement,
+    const detail::Static_parameter_arrays& parameters);
+  void execute_nio__(const Statement* const statement, const std::string* query,
+    bool is_simple = false,
+    const detail::Static_parameter_arrays* static_parameters = nullptr);
 };
 
 /**
@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "prepared_statement_registry.hpp"
+
+#include <mutex>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void Prepared_statement_registry::add(std::string name,
+  Statement statement, std::vector<Oid> parameter_types)
+{
+  if (name.empty())
+    throw Client_exception{"cannot register prepared statement: empty name"};
+  else if (statement.has_missing_parameters())
+    throw Client_exception{"cannot register prepared statement "
+      + name + ": statement has missing parameters"};
+
+  auto entry = std::make_shared<Entry>();
+  entry->name_ = name;
+  entry->statement_ = std::move(statement);
+  entry->parameter_types_ = std::move(parameter_types);
+
+  const std::lock_guard lg{mutex_};
+  if (!entries_.try_emplace(std::move(name), entry).second)
+    throw Client_exception{"cannot register prepared statement "
+      + entry->name_ + ": statement already registered"};
+}
+
+DMITIGR_PGFE_INLINE bool
+Prepared_statement_registry::remove(const std::string_view name)
+{
+  const std::lock_guard lg{mutex_};
+  if (const auto i = entries_.find(name); i != entries_.end()) {
+    entries_.erase(i);
+    return true;
+  }
+  return false;
+}
+
+DMITIGR_PGFE_INLINE void Prepared_statement_registry::clear() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  entries_.clear();
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Prepared_statement_registry::size() const noexcept
+{
+  const std::shared_lock lg{mutex_};
+  return entries_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Prepared_statement_registry::is_empty() const noexcept
+{
+  return !size();
+}
+
+DMITIGR_PGFE_INLINE bool
+Prepared_statement_registry::contains(const std::string_view name) const noexcept
+{
+  const std::shared_lock lg{mutex_};
+  return entries_.find(name) != entries_.end();
+}
+
+DMITIGR_PGFE_INLINE bool
+Prepared_statement_registry::is_described(
+  const std::string_view name) const noexcept
+{
+  const std::shared_lock lg{mutex_};
+  const auto i = entries_.find(name);
+  return i != entries_.end() && static_cast<bool>(i->second->description_);
+}
+
+DMITIGR_PGFE_INLINE auto
+Prepared_statement_registry::entry(const std::string_view name) const
+  -> Entry_ptr
+{
+  const std::shared_lock lg{mutex_};
+  const auto i = entries_.find(name);
+  return i != entries_.end() ? i->second : nullptr;
+}
+
+DMITIGR_PGFE_INLINE auto Prepared_statement_registry::entries() const
+  -> std::vector<Entry_ptr>
+{
+  std::vector<Entry_ptr> result;
+  const std::shared_lock lg{mutex_};
+  result.reserve(entries_.size());
+  for (const auto& [name, entry] : entries_)
+    result.push_back(entry);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE detail::pq::Result
+Prepared_statement_registry::description(const Entry& entry) const
+{
+  const std::shared_lock lg{mutex_};
+  return entry.description_ ? entry.description_.share() : detail::pq::Result{};
+}
+
+DMITIGR_PGFE_INLINE std::vector<Oid>
+Prepared_statement_registry::parameter_types(const Entry& entry) const
+{
+  const std::shared_lock lg{mutex_};
+  if (!entry.description_)
+    return entry.parameter_types_;
+
+  // The types inferred by the server are passed explicitly to avoid the
+  // inference on the other connections.
+  const auto& description = entry.description_;
+  std::vector<Oid> result(static_cast<std::size_t>(
+    description.ps_param_count()));
+  for (std::size_t i{}; i < result.size(); ++i)
+    result[i] = description.ps_param_type_oid(static_cast<int>(i));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Prepared_statement_registry::set_description(Entry& entry,
+  detail::pq::Result& description)
+{
+  description.make_shareable(); // can throw
+  const std::lock_guard lg{mutex_};
+  if (!entry.description_)
+    entry.description_ = description.share();
+}
+
+} // namespace dmitigr::pgfe
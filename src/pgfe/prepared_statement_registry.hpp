@@ -0,0 +1,154 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_PREPARED_STATEMENT_REGISTRY_HPP
+#define DMITIGR_PGFE_PREPARED_STATEMENT_REGISTRY_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "pq.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// A statement of Prepared_statement_registry.
+struct Registered_statement final {
+  std::string name_;
+  Statement statement_;
+  std::vector<Oid> parameter_types_;
+  pq::Result description_; // shareable, or invalid
+};
+
+} // namespace detail
+
+/**
+ * @ingroup main
+ *
+ * @brief A registry of the named statements to be prepared on each connection.
+ *
+ * @details The registered statements are prepared on a connection either
+ * lazily, by Connection::registered_statement(), or all at once in the
+ * pipeline, by Connection::prepare_registered_statements(). Thus, they are
+ * transparently prepared again after reconnect (or `DISCARD ALL`).
+ *
+ * The statement is described by the server only once per registry, and the
+ * description (the Row_info and the OIDs of the types of the parameters) is
+ * shared by the statements prepared on the other connections afterwards.
+ *
+ * By default, each Connection has its own registry. Since the registry is
+ * thread-safe, the same registry can be shared by the connections to the
+ * same database (see Connection_pool::prepared_statement_registry()), for
+ * example:
+ * @code
+ * pool.prepared_statement_registry()->add("person_by_id",
+ *   "select * from person where id = $1");
+ * pool.set_connect_handler([](pgfe::Connection& conn)
+ * {
+ *   conn.prepare_registered_statements(); // optional, pipelined
+ * });
+ * // ...
+ * auto ps = pool.connection()->registered_statement("person_by_id");
+ * @endcode
+ *
+ * @remarks The registry doesn't track the DDL. If the result of the statement
+ * is altered, the statement should be registered again.
+ *
+ * @see Connection::prepared_statement_registry().
+ */
+class Prepared_statement_registry final {
+public:
+  /// Constructs the empty registry.
+  Prepared_statement_registry() = default;
+
+  /// Non copy-constructible.
+  Prepared_statement_registry(const Prepared_statement_registry&) = delete;
+
+  /// Non copy-assignable.
+  Prepared_statement_registry&
+  operator=(const Prepared_statement_registry&) = delete;
+
+  /**
+   * @brief Registers the statement.
+   *
+   * @param name The name of the prepared statement.
+   * @param statement A *preparsed* statement to prepare.
+   * @param parameter_types See Connection::prepare_nio().
+   *
+   * @par Requires
+   * `!name.empty() && !contains(name) && !statement.has_missing_parameters()`.
+   */
+  DMITIGR_PGFE_API void add(std::string name, Statement statement,
+    std::vector<Oid> parameter_types = {});
+
+  /**
+   * @brief Unregisters the statement.
+   *
+   * @returns `true` if the statement was registered.
+   *
+   * @remarks The statement isn't deallocated on the connections where it's
+   * already prepared.
+   */
+  DMITIGR_PGFE_API bool remove(std::string_view name);
+
+  /// Unregisters all the statements.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /// @returns The number of the registered statements.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns `!size()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// @returns `true` if the statement `name` is registered.
+  DMITIGR_PGFE_API bool contains(std::string_view name) const noexcept;
+
+  /// @returns `true` if the description of the statement `name` is known.
+  DMITIGR_PGFE_API bool is_described(std::string_view name) const noexcept;
+
+private:
+  friend Connection;
+
+  using Entry = detail::Registered_statement;
+  using Entry_ptr = std::shared_ptr<Entry>;
+
+  mutable std::shared_mutex mutex_;
+  std::map<std::string, Entry_ptr, std::less<>> entries_;
+
+  Entry_ptr entry(std::string_view name) const;
+  std::vector<Entry_ptr> entries() const;
+  detail::pq::Result description(const Entry& entry) const;
+  std::vector<Oid> parameter_types(const Entry& entry) const;
+  void set_description(Entry& entry, detail::pq::Result& description);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "prepared_statement_registry.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_PREPARED_STATEMENT_REGISTRY_HPP
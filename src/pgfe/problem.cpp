@@ -21,16 +21,15 @@
 #include "problem.hpp"
 
 #include <cassert>
-#include <cctype>
-#include <cerrno>
-#include <cstdlib>
 
 namespace dmitigr::pgfe {
 
 DMITIGR_PGFE_INLINE Problem::Problem(detail::pq::Result&& result) noexcept
   : pq_result_{std::move(result)}
 {
-  const int condition{sqlstate_string_to_int(pq_result_.er_code())};
+  const char* const sqlstate{pq_result_.er_code()};
+  const int condition{sqlstate ? sqlstate_to_int(sqlstate) : -1};
+  assert(condition >= 0);
   condition_ = {condition, server_error_category()};
   assert(is_invariant_ok());
 }
@@ -170,21 +169,13 @@ DMITIGR_PGFE_INLINE std::error_condition Problem::min_error_condition() noexcept
 
 DMITIGR_PGFE_INLINE int Problem::sqlstate_string_to_int(const char* const sqlstate)
 {
-  const std::string_view state{sqlstate};
-  if (!((state.size() == 5) &&
-      std::isalnum(static_cast<unsigned char>(state[0])) &&
-      std::isalnum(static_cast<unsigned char>(state[1])) &&
-      std::isalnum(static_cast<unsigned char>(state[2])) &&
-      std::isalnum(static_cast<unsigned char>(state[3])) &&
-      std::isalnum(static_cast<unsigned char>(state[4]))))
+  const int result{sqlstate ? sqlstate_to_int(sqlstate) : -1};
+  if (result < 0)
     throw Client_exception{"cannot convert SQLSTATE to int"};
 
-  errno = 0;
-  const long int result{std::strtol(state.data(), nullptr, 36)};
-  DMITIGR_ASSERT(errno == 0);
   DMITIGR_ASSERT(min_condition().value() <= result &&
     result <= max_condition().value());
-  return static_cast<int>(result);
+  return result;
 }
 
 DMITIGR_PGFE_INLINE std::string Problem::sqlstate_int_to_string(const int sqlstate)
@@ -21,12 +21,33 @@
 #include "pq.hpp"
 #include "types_fwd.hpp"
 
+#include <array>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <system_error>
 
 namespace dmitigr::pgfe {
 
+namespace detail {
+
+/// The values of the base-36 digits of SQLSTATE, or `-1` for other characters.
+inline constexpr auto sqlstate_digits = []
+{
+  std::array<signed char, 256> result{};
+  for (auto& digit : result)
+    digit = -1;
+  for (int i{}; i < 10; ++i)
+    result['0' + i] = static_cast<signed char>(i);
+  for (int i{}; i < 26; ++i) {
+    result['A' + i] = static_cast<signed char>(10 + i);
+    result['a' + i] = static_cast<signed char>(10 + i);
+  }
+  return result;
+}();
+
+} // namespace detail
+
 /**
  * @ingroup main
  *
@@ -191,9 +212,39 @@ public:
    *
    * @par Requires
    * `sqlstate` must consist of five alphanumeric characters terminated by zero.
+   *
+   * @see sqlstate_to_int().
    */
   static DMITIGR_PGFE_API int sqlstate_string_to_int(const char* sqlstate);
 
+  /**
+   * @returns The integer representation of the SQLSTATE (which is the value
+   * of the corresponding Server_errc), or `-1` if `sqlstate` doesn't consist
+   * of five alphanumeric characters.
+   *
+   * @details The SQLSTATE is packed as the base-36 number by the table lookup
+   * of its characters, so this function can be used in constant expressions
+   * and costs a few instructions at run time. For example:
+   * @code
+   * static_assert(Problem::sqlstate_to_int("23505") ==
+   *   static_cast<int>(Server_errc::c23_unique_violation));
+   * @endcode
+   */
+  static constexpr int sqlstate_to_int(const std::string_view sqlstate) noexcept
+  {
+    if (sqlstate.size() != 5)
+      return -1;
+
+    int result{};
+    for (const char c : sqlstate) {
+      const int digit{detail::sqlstate_digits[static_cast<unsigned char>(c)]};
+      if (digit < 0)
+        return -1;
+      result = result * 36 + digit;
+    }
+    return result;
+  }
+
   /**
    * @returns The textual representation of the SQLSTATE.
    *
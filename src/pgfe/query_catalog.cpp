@@ -0,0 +1,336 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "../str/stream.hpp"
+#include "connection.hpp"
+#include "conversions.hpp"
+#include "exceptions.hpp"
+#include "query_catalog.hpp"
+#include "statement_reader.hpp"
+#include "statement_vector.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// The signature of the file of Query_catalog.
+constexpr std::string_view query_catalog_signature{"PGFEQC\x01\n", 8};
+
+/// Appends `value` to `result` in the little-endian byte order.
+inline void append_query_catalog_uint(std::string& result,
+  const std::uint32_t value)
+{
+  for (int i{}; i < 4; ++i)
+    result.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+/// Appends the size of `value` followed by `value` to `result`.
+inline void append_query_catalog_string(std::string& result,
+  const std::string_view value)
+{
+  append_query_catalog_uint(result, static_cast<std::uint32_t>(value.size()));
+  result.append(value);
+}
+
+/// A reader of the content of the file of Query_catalog.
+class Query_catalog_input final {
+public:
+  explicit Query_catalog_input(const std::string_view input) noexcept
+    : input_{input}
+  {}
+
+  std::string_view read(const std::size_t size)
+  {
+    if (input_.size() < size)
+      throw_invalid();
+    const auto result = input_.substr(0, size);
+    input_.remove_prefix(size);
+    return result;
+  }
+
+  std::uint32_t read_uint()
+  {
+    const auto bytes = read(4);
+    std::uint32_t result{};
+    for (int i{}; i < 4; ++i)
+      result |= static_cast<std::uint32_t>(
+        static_cast<unsigned char>(bytes[i])) << (8 * i);
+    return result;
+  }
+
+  std::string_view read_string()
+  {
+    return read(read_uint());
+  }
+
+  bool is_empty() const noexcept
+  {
+    return input_.empty();
+  }
+
+  [[noreturn]] static void throw_invalid()
+  {
+    throw Client_exception{"cannot load query catalog: invalid file"};
+  }
+
+private:
+  std::string_view input_;
+};
+
+/// @returns The hash of the query name.
+inline std::size_t query_catalog_hash(const std::string_view name) noexcept
+{
+  return std::hash<std::string_view>{}(name);
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE
+Query_catalog::Query_catalog(const Statement_vector& statements,
+  const std::string_view name_field)
+{
+  for (const auto& statement : statements.vector())
+    append(statement, name_field);
+}
+
+DMITIGR_PGFE_INLINE Query_catalog
+Query_catalog::from_sql_files(const std::vector<std::filesystem::path>& files,
+  const std::string_view name_field)
+{
+  Query_catalog result;
+  for (const auto& file : files) {
+    std::ifstream stream{file, std::ios_base::binary};
+    if (!stream)
+      throw Client_exception{"cannot open SQL file " + file.string()};
+    Statement_reader reader{stream};
+    while (reader.read())
+      result.append(std::move(reader.statement()), name_field);
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Query_catalog
+Query_catalog::from_file(const std::filesystem::path& file)
+{
+  using detail::Query_catalog_input;
+  using Ft = detail::Statement_fragment_type;
+
+  const auto [err, content] = str::read_to_string_nothrow(file);
+  if (err)
+    throw Client_exception{"cannot load query catalog: " + err.message()};
+
+  Query_catalog_input input{content};
+  if (input.read(detail::query_catalog_signature.size()) !=
+    detail::query_catalog_signature)
+    Query_catalog_input::throw_invalid();
+
+  Query_catalog result;
+  std::vector<detail::Statement_fragment> fragments;
+  const auto count = input.read_uint();
+  for (std::uint32_t i{}; i < count; ++i) {
+    std::string name{input.read_string()};
+    const auto text = input.read_string();
+    fragments.resize(input.read_uint());
+    for (auto& fragment : fragments) {
+      const auto type = input.read_uint();
+      fragment.offset = input.read_uint();
+      fragment.size = input.read_uint();
+      if (type > static_cast<std::uint32_t>(Ft::positional_parameter) ||
+        fragment.offset > text.size() ||
+        fragment.size > text.size() - fragment.offset)
+        Query_catalog_input::throw_invalid();
+      fragment.type = static_cast<Ft>(type);
+    }
+    const auto hash = detail::query_catalog_hash(name);
+    if (result.query_index(name) != result.size())
+      Query_catalog_input::throw_invalid();
+    result.statements_.push_back(Statement{text, fragments.data(),
+      fragments.size()});
+    result.names_.push_back(std::move(name));
+    result.index_[hash].push_back(result.names_.size() - 1);
+  }
+  if (!input.is_empty())
+    Query_catalog_input::throw_invalid();
+
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Query_catalog
+Query_catalog::load(const std::vector<std::filesystem::path>& files,
+  const std::filesystem::path& cache_file, const std::string_view name_field)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (const auto cache_time = fs::last_write_time(cache_file, ec); !ec) {
+    bool is_fresh{true};
+    for (const auto& file : files) {
+      const auto time = fs::last_write_time(file, ec);
+      if (ec || time > cache_time) {
+        is_fresh = false;
+        break;
+      }
+    }
+    if (is_fresh) {
+      try {
+        return from_file(cache_file);
+      } catch (const Client_exception&) {
+        // The cache file is rebuilt.
+      }
+    }
+  }
+
+  auto result = from_sql_files(files, name_field);
+  result.save(cache_file);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Query_catalog::save(const std::filesystem::path& file) const
+{
+  using detail::append_query_catalog_string;
+  using detail::append_query_catalog_uint;
+
+  std::string content{detail::query_catalog_signature};
+  append_query_catalog_uint(content, static_cast<std::uint32_t>(size()));
+  for (std::size_t i{}; i < size(); ++i) {
+    const auto& statement = statements_[i];
+    append_query_catalog_string(content, names_[i]);
+    append_query_catalog_string(content, statement.text_);
+    append_query_catalog_uint(content,
+      static_cast<std::uint32_t>(statement.fragments_.size()));
+    for (const auto& fragment : statement.fragments_) {
+      append_query_catalog_uint(content,
+        static_cast<std::uint32_t>(fragment.type));
+      append_query_catalog_uint(content,
+        static_cast<std::uint32_t>(fragment.offset));
+      append_query_catalog_uint(content,
+        static_cast<std::uint32_t>(fragment.size));
+    }
+  }
+
+  std::ofstream stream{file, std::ios_base::binary | std::ios_base::trunc};
+  if (!(stream && stream.write(content.data(),
+        static_cast<std::streamsize>(content.size())) && stream.flush()))
+    throw Client_exception{"cannot save query catalog to " + file.string()};
+}
+
+DMITIGR_PGFE_INLINE std::size_t Query_catalog::size() const noexcept
+{
+  return names_.size();
+}
+
+DMITIGR_PGFE_INLINE bool Query_catalog::is_empty() const noexcept
+{
+  return names_.empty();
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Query_catalog::query_index(const std::string_view name) const noexcept
+{
+  if (const auto i = index_.find(detail::query_catalog_hash(name));
+    i != index_.end()) {
+    for (const auto index : i->second) {
+      if (names_[index] == name)
+        return index;
+    }
+  }
+  return size();
+}
+
+DMITIGR_PGFE_INLINE const std::string&
+Query_catalog::name(const std::size_t index) const
+{
+  if (!(index < size()))
+    throw Client_exception{"cannot get query name of query catalog: "
+      "invalid index"};
+  return names_[index];
+}
+
+DMITIGR_PGFE_INLINE const Statement&
+Query_catalog::statement(const std::size_t index) const
+{
+  if (!(index < size()))
+    throw Client_exception{"cannot get statement of query catalog: "
+      "invalid index"};
+  return statements_[index];
+}
+
+DMITIGR_PGFE_INLINE const Statement&
+Query_catalog::statement(const std::string_view name) const
+{
+  const auto index = query_index(name);
+  if (!(index < size()))
+    throw Client_exception{std::string{"cannot get statement of query "
+      "catalog: no query named "}.append(name)};
+  return statements_[index];
+}
+
+DMITIGR_PGFE_INLINE void Query_catalog::prepare(Connection& conn) const
+{
+  if (!conn.is_ready_for_request())
+    throw Client_exception{"cannot prepare query catalog: "
+      "not ready for request"};
+  else if (is_empty())
+    return;
+
+  conn.set_pipeline_enabled(true);
+  for (std::size_t i{}; i < size(); ++i)
+    conn.prepare_nio(statements_[i], names_[i]);
+  conn.send_sync();
+
+  Error error;
+  while (conn.has_uncompleted_request()) {
+    conn.wait_response();
+    if (auto e = conn.error()) {
+      if (!error)
+        error = std::move(e);
+    } else if (!conn.ready_for_query())
+      (void)conn.prepared_statement();
+  }
+  conn.set_pipeline_enabled(false);
+
+  if (error)
+    throw Server_exception{std::make_shared<Error>(std::move(error))};
+}
+
+DMITIGR_PGFE_INLINE void Query_catalog::append(Statement statement,
+  const std::string_view name_field)
+{
+  const auto& extra = statement.extra();
+  const auto field_index = extra.field_index(name_field);
+  if (!(field_index < extra.field_count()))
+    return;
+  const auto data = extra.data(field_index);
+  if (!data)
+    return;
+
+  auto name = to<std::string>(data);
+  if (query_index(name) != size())
+    throw Client_exception{"cannot add query to query catalog: duplicate "
+      "query name " + name};
+  const auto hash = detail::query_catalog_hash(name);
+  statements_.push_back(std::move(statement));
+  names_.push_back(std::move(name));
+  index_[hash].push_back(names_.size() - 1);
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,183 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_QUERY_CATALOG_HPP
+#define DMITIGR_PGFE_QUERY_CATALOG_HPP
+
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A catalog of named queries.
+ *
+ * @details The queries are named by the extra data of statements (see
+ * Statement::extra()), for example:
+ *   @code{sql}
+ *   -- $id$person_by_id$id$
+ *   SELECT * FROM person WHERE id = :id;
+ *   @endcode
+ * The statements without the name (such as empty ones) are skipped.
+ *
+ * The catalog can be saved to a file in the compact preparsed form, so it can
+ * be loaded later without parsing SQL. The catalog is usually loaded at the
+ * startup and its queries are prepared on each new connection of the pool:
+ *
+ * @code
+ * const auto catalog = pgfe::Query_catalog::load({"queries.sql"},
+ *   "queries.pgfe");
+ * pool.set_connect_handler([&catalog](pgfe::Connection& conn)
+ * {
+ *   catalog.prepare(conn);
+ * });
+ * @endcode
+ *
+ * @see Statement_vector, Connection_pool::set_connect_handler().
+ */
+class Query_catalog final {
+public:
+  /// Default-constructible. (Constructs an empty instance.)
+  Query_catalog() = default;
+
+  /**
+   * @brief Makes the catalog of named statements of `statements`.
+   *
+   * @param statements The statements.
+   * @param name_field The name of the field of extra data of statements which
+   * holds the name of the query.
+   *
+   * @throws Client_exception if the query names are not unique.
+   */
+  DMITIGR_PGFE_API explicit Query_catalog(const Statement_vector& statements,
+    std::string_view name_field = "id");
+
+  /**
+   * @brief Makes the catalog by parsing the SQL files.
+   *
+   * @see Query_catalog(const Statement_vector&, std::string_view).
+   */
+  static DMITIGR_PGFE_API Query_catalog
+  from_sql_files(const std::vector<std::filesystem::path>& files,
+    std::string_view name_field = "id");
+
+  /**
+   * @brief Loads the catalog saved by save().
+   *
+   * @throws Client_exception if the file cannot be read or is not a valid
+   * catalog file.
+   */
+  static DMITIGR_PGFE_API Query_catalog
+  from_file(const std::filesystem::path& file);
+
+  /**
+   * @brief Loads the catalog from `cache_file` if it's newer than each of
+   * the SQL `files`, or makes the catalog from the SQL `files` and saves it
+   * to `cache_file` otherwise.
+   *
+   * @see from_sql_files(), from_file().
+   */
+  static DMITIGR_PGFE_API Query_catalog
+  load(const std::vector<std::filesystem::path>& files,
+    const std::filesystem::path& cache_file,
+    std::string_view name_field = "id");
+
+  /**
+   * @brief Saves the catalog to the `file` in the compact preparsed form.
+   *
+   * @throws Client_exception if the file cannot be written.
+   *
+   * @see from_file().
+   */
+  DMITIGR_PGFE_API void save(const std::filesystem::path& file) const;
+
+  /// @returns The number of queries.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns `!size()`.
+  DMITIGR_PGFE_API bool is_empty() const noexcept;
+
+  /// @returns The index of the query named `name`, or `size()` if none.
+  DMITIGR_PGFE_API std::size_t
+  query_index(std::string_view name) const noexcept;
+
+  /**
+   * @returns The name of the query.
+   *
+   * @par Requires
+   * `index < size()`.
+   */
+  DMITIGR_PGFE_API const std::string& name(std::size_t index) const;
+
+  /**
+   * @returns The statement of the query.
+   *
+   * @par Requires
+   * `index < size()`.
+   */
+  DMITIGR_PGFE_API const Statement& statement(std::size_t index) const;
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `query_index(name) < size()`.
+   */
+  DMITIGR_PGFE_API const Statement& statement(std::string_view name) const;
+
+  /**
+   * @brief Prepares all the queries as the statements named as the queries.
+   *
+   * @details All the requests are sent in the pipeline with the single
+   * synchronization point, so the whole catalog is prepared at the cost of
+   * about one round trip.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()`.
+   *
+   * @throws Server_exception with the first error of the server, if any.
+   * In this case the queries which follow the failed one are not prepared.
+   *
+   * @see Connection::prepare_nio().
+   */
+  DMITIGR_PGFE_API void prepare(Connection& conn) const;
+
+private:
+  std::vector<std::string> names_;
+  std::vector<Statement> statements_;
+  // The indexes of queries by the hash of name.
+  std::unordered_map<std::size_t, std::vector<std::size_t>> index_;
+
+  void append(Statement statement, std::string_view name_field);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "query_catalog.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_QUERY_CATALOG_HPP
@@ -0,0 +1,62 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_REACTOR_HPP
+#define DMITIGR_PGFE_REACTOR_HPP
+
+#include "basics.hpp"
+
+#include <functional>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief An interface of an event loop which waits for the readiness of
+ * sockets.
+ *
+ * @details This interface is used by the coroutine layer (see coroutine.hpp)
+ * to suspend the coroutines until the sockets of connections become ready,
+ * and can be implemented on top of any event loop.
+ */
+class Reactor {
+public:
+  /// The callback to call when the socket is ready.
+  using Callback = std::function<void(Socket_readiness)>;
+
+  /// The destructor.
+  virtual ~Reactor() = default;
+
+  /**
+   * @brief Arranges `callback` to be called once, when `socket` becomes ready
+   * as requested by `mask`, or when an error occurred on the socket.
+   *
+   * @param socket The socket descriptor to wait for.
+   * @param mask A bit mask specifying the requested readiness of the socket.
+   * @param callback The callback to call with the actual readiness of the
+   * socket.
+   *
+   * @remarks The callback may be called either from this function (for
+   * example, if the socket is already ready), or later from the event loop.
+   */
+  virtual void async_wait(int socket, Socket_readiness mask,
+    Callback callback) = 0;
+};
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_REACTOR_HPP
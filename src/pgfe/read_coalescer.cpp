@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "prepared_statement.hpp"
+#include "read_coalescer.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Read_coalescer::Read_coalescer(Connection_pool& pool,
+  const std::optional<std::chrono::milliseconds> connection_timeout)
+  : pool_{pool}
+  , connection_timeout_{connection_timeout}
+{}
+
+DMITIGR_PGFE_INLINE Connection_pool& Read_coalescer::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Read_coalescer::connection_timeout() const noexcept
+{
+  return connection_timeout_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Read_coalescer::in_flight_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return flights_.size();
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t
+Read_coalescer::execution_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return execution_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t
+Read_coalescer::coalesced_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return coalesced_count_;
+}
+
+DMITIGR_PGFE_INLINE auto
+Read_coalescer::execute__(const std::string_view statement_name,
+  Parameters&& parameters) -> Result
+{
+  // The key is the name followed by the parameters (as in Result_cache).
+  std::string key;
+  key.reserve(statement_name.size() + 16);
+  key.append(statement_name).push_back('\0');
+  const auto append_size = [&key](const std::uint_fast32_t size)
+  {
+    char bytes[4];
+    for (int i{}; i < 4; ++i)
+      bytes[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    key.append(bytes, sizeof(bytes));
+  };
+  for (const auto& data : parameters) {
+    if (data) {
+      key.push_back(static_cast<char>(data->format()) + 1);
+      append_size(static_cast<std::uint_fast32_t>(data->size()));
+      key.append(static_cast<const char*>(data->bytes()), data->size());
+    } else
+      key.push_back(0); // NULL
+  }
+
+  std::promise<Result> promise;
+  {
+    std::unique_lock lk{mutex_};
+    if (const auto i = flights_.find(key); i != flights_.end()) {
+      auto flight = i->second;
+      ++coalesced_count_;
+      lk.unlock();
+      return flight.get();
+    }
+    flights_.emplace(key, promise.get_future().share());
+    ++execution_count_;
+  }
+
+  // The flight is removed before the result is published, so the requests
+  // which arrive after the completion are executed anew.
+  const auto land = [this, &key]() noexcept
+  {
+    const std::lock_guard lg{mutex_};
+    flights_.erase(key);
+  };
+  try {
+    auto result = execute_on_pool__(statement_name, parameters);
+    land();
+    promise.set_value(result);
+    return result;
+  } catch (...) {
+    land();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+DMITIGR_PGFE_INLINE auto
+Read_coalescer::execute_on_pool__(const std::string_view statement_name,
+  const Parameters& parameters) -> Result
+{
+  auto conn = pool_.connection(connection_timeout_);
+  if (!conn)
+    throw Client_exception{"cannot execute by read coalescer: "
+      "no free connection of the pool"};
+
+  auto statement = conn->registered_statement(statement_name);
+  const std::size_t param_count{parameters.size()};
+  for (std::size_t i{}; i < param_count; ++i) {
+    if (const auto& data = parameters[i])
+      statement.bind(i, *data);
+    else
+      statement.bind(i, nullptr);
+  }
+
+  // All the rows are retrieved as a single batch.
+  Row_batch batch;
+  statement.set_row_delivery_mode(Row_delivery_mode::full);
+  statement.execute([&batch](Row_batch&& b)
+  {
+    batch = std::move(b);
+  });
+  return std::make_shared<const Row_batch>(std::move(batch));
+}
+
+} // namespace dmitigr::pgfe
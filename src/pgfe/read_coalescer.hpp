@@ -0,0 +1,175 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_READ_COALESCER_HPP
+#define DMITIGR_PGFE_READ_COALESCER_HPP
+
+#include "connection_pool.hpp"
+#include "conversions_api.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "row_batch.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A coalescer of the identical concurrent executions of idempotent
+ * read queries on the connections of Connection_pool.
+ *
+ * @details The executions are identified by the name of the prepared
+ * statement of the registry of the pool and the bytes of the parameters. When
+ * the execution is requested while the identical execution is in flight, the
+ * request waits for the result of the latter instead of executing the query
+ * again (and acquiring another connection of the pool), so a burst of the same
+ * reads (for example, after expiration of the cached value) costs the single
+ * round trip. For example:
+ * @code
+ * pool.prepared_statement_registry()->add("item",
+ *   "select * from item where id = $1");
+ * pgfe::Read_coalescer reads{pool};
+ * // In any thread.
+ * const auto item = reads.execute("item", id);
+ * @endcode
+ *
+ * @par Thread safety
+ * Thread-safe.
+ *
+ * @remarks Only the concurrent executions are coalesced, the results are not
+ * retained after the execution is completed.
+ *
+ * @see Result_cache.
+ */
+class Read_coalescer final {
+public:
+  /// The shared result. The rows are retrieved as a single batch.
+  using Result = std::shared_ptr<const Row_batch>;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param pool The pool to acquire the connections from.
+   * @param connection_timeout The maximum amount of time to wait for a free
+   * connection of the `pool`. The value of `std::nullopt` means *eternity*.
+   *
+   * @remarks The `pool` must outlive the instance.
+   */
+  DMITIGR_PGFE_API explicit Read_coalescer(Connection_pool& pool,
+    std::optional<std::chrono::milliseconds> connection_timeout = std::nullopt);
+
+  /// Not copy-constructible.
+  Read_coalescer(const Read_coalescer&) = delete;
+
+  /// Not copy-assignable.
+  Read_coalescer& operator=(const Read_coalescer&) = delete;
+
+  /// Not move-constructible.
+  Read_coalescer(Read_coalescer&&) = delete;
+
+  /// Not move-assignable.
+  Read_coalescer& operator=(Read_coalescer&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /// @returns The maximum amount of time to wait for a free connection.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  connection_timeout() const noexcept;
+
+  /// @returns The number of executions which are in flight.
+  DMITIGR_PGFE_API std::size_t in_flight_count() const noexcept;
+
+  /// @returns The number of executions of the queries.
+  DMITIGR_PGFE_API std::uint_fast64_t execution_count() const noexcept;
+
+  /// @returns The number of requests served by the identical executions.
+  DMITIGR_PGFE_API std::uint_fast64_t coalesced_count() const noexcept;
+
+  /**
+   * @brief Executes the registered statement `statement_name` with the
+   * `parameters` on a connection of the pool, or waits for the result of the
+   * identical execution which is in flight.
+   *
+   * @details The `parameters` are converted via Conversions, and are bound
+   * as the values of Data.
+   *
+   * @par Requires
+   * `pool().prepared_statement_registry()->contains(statement_name)`.
+   *
+   * @throws Client_exception if there is no free connection within the
+   * connection_timeout(). The exception thrown by the execution is rethrown
+   * to all the requests served by it.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  template<typename ... Types>
+  Result execute(const std::string_view statement_name,
+    Types&& ... parameters)
+  {
+    Parameters params;
+    params.reserve(sizeof...(Types));
+    (params.push_back(to_parameter__(std::forward<Types>(parameters))), ...);
+    return execute__(statement_name, std::move(params));
+  }
+
+private:
+  using Parameters = std::vector<std::unique_ptr<Data>>;
+
+  mutable std::mutex mutex_;
+  Connection_pool& pool_;
+  std::optional<std::chrono::milliseconds> connection_timeout_;
+  std::unordered_map<std::string, std::shared_future<Result>> flights_;
+  std::uint_fast64_t execution_count_{};
+  std::uint_fast64_t coalesced_count_{};
+
+  template<typename T>
+  static std::unique_ptr<Data> to_parameter__(T&& value)
+  {
+    if constexpr (std::is_same_v<std::decay_t<T>, std::nullptr_t>)
+      return nullptr;
+    else
+      return to_data(std::forward<T>(value));
+  }
+
+  Result execute__(std::string_view statement_name, Parameters&& parameters);
+  Result execute_on_pool__(std::string_view statement_name,
+    const Parameters& parameters);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "read_coalescer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_READ_COALESCER_HPP
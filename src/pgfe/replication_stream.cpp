@@ -0,0 +1,309 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../net/conversions.hpp"
+#include "connection.hpp"
+#include "conversions.hpp"
+#include "copier.hpp"
+#include "exceptions.hpp"
+#include "replication_stream.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/// The size of the header of `XLogData` message.
+constexpr std::size_t xlog_data_header_size{1 + 8 + 8 + 8};
+
+/// The size of the primary keepalive message.
+constexpr std::size_t keepalive_message_size{1 + 8 + 8 + 1};
+
+/// The size of the standby status update message.
+constexpr std::size_t standby_status_size{1 + 8 + 8 + 8 + 8 + 1};
+
+[[noreturn]] inline void throw_malformed_replication_message()
+{
+  throw Client_exception{"cannot read replication message: malformed message"};
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE std::optional<std::uint64_t>
+to_lsn(const std::string_view str) noexcept
+{
+  const auto slash = str.find('/');
+  if (slash == std::string_view::npos)
+    return std::nullopt;
+
+  const auto parse = [](const std::string_view part) -> std::optional<std::uint32_t>
+  {
+    std::uint32_t result{};
+    const auto* const end = part.data() + part.size();
+    if (part.empty() || part.size() > 8)
+      return std::nullopt;
+    const auto [ptr, ec] = std::from_chars(part.data(), end, result, 16);
+    return ec == std::errc{} && ptr == end ?
+      std::optional<std::uint32_t>{result} : std::nullopt;
+  };
+  const auto hi = parse(str.substr(0, slash));
+  const auto lo = parse(str.substr(slash + 1));
+  return hi && lo ? std::optional<std::uint64_t>{
+    static_cast<std::uint64_t>(*hi) << 32 | *lo} : std::nullopt;
+}
+
+DMITIGR_PGFE_INLINE std::string lsn_to_string(const std::uint64_t lsn)
+{
+  char buf[18];
+  const int size{std::snprintf(buf, sizeof(buf), "%X/%X",
+    static_cast<unsigned>(lsn >> 32), static_cast<unsigned>(lsn))};
+  DMITIGR_ASSERT(size > 0 && static_cast<std::size_t>(size) < sizeof(buf));
+  return std::string(buf, static_cast<std::size_t>(size));
+}
+
+// -----------------------------------------------------------------------------
+// Replication_message
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Replication_message::Replication_message(const Data_view& data)
+{
+  const auto* const bytes = static_cast<const char*>(data.bytes());
+  const auto size = data.size();
+  if (!data || !size)
+    detail::throw_malformed_replication_message();
+
+  switch (bytes[0]) {
+  case static_cast<char>(Kind::xlog_data):
+    if (size < detail::xlog_data_header_size)
+      detail::throw_malformed_replication_message();
+    kind_ = Kind::xlog_data;
+    wal_start_ = net::conv<std::uint64_t>(bytes + 1, 8);
+    wal_end_ = net::conv<std::uint64_t>(bytes + 9, 8);
+    server_time_ = net::conv<std::int64_t>(bytes + 17, 8);
+    payload_ = Data_view{bytes + detail::xlog_data_header_size,
+      size - detail::xlog_data_header_size, data.format()};
+    break;
+  case static_cast<char>(Kind::keepalive):
+    if (size != detail::keepalive_message_size)
+      detail::throw_malformed_replication_message();
+    kind_ = Kind::keepalive;
+    wal_end_ = net::conv<std::uint64_t>(bytes + 1, 8);
+    server_time_ = net::conv<std::int64_t>(bytes + 9, 8);
+    is_reply_requested_ = bytes[17];
+    payload_ = Data_view{"", 0, data.format()};
+    break;
+  default:
+    detail::throw_malformed_replication_message();
+  }
+  is_valid_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Replication_message::is_valid() const noexcept
+{
+  return is_valid_;
+}
+
+DMITIGR_PGFE_INLINE auto Replication_message::kind() const noexcept -> Kind
+{
+  return kind_;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Replication_message::wal_start() const noexcept
+{
+  return wal_start_;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Replication_message::wal_end() const noexcept
+{
+  return wal_end_;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::system_clock::time_point
+Replication_message::server_time() const noexcept
+{
+  using std::chrono::system_clock;
+  return system_clock::time_point{
+    std::chrono::duration_cast<system_clock::duration>(
+      std::chrono::microseconds{server_time_ + detail::pg_epoch_offset_us})};
+}
+
+DMITIGR_PGFE_INLINE bool Replication_message::is_reply_requested() const noexcept
+{
+  return is_reply_requested_;
+}
+
+DMITIGR_PGFE_INLINE const Data_view& Replication_message::payload() const noexcept
+{
+  return payload_;
+}
+
+// -----------------------------------------------------------------------------
+// Replication_stream
+// -----------------------------------------------------------------------------
+
+DMITIGR_PGFE_INLINE Replication_stream::Replication_stream(Copier& copier,
+  const std::chrono::milliseconds status_interval)
+  : copier_{copier}
+  , last_status_time_{std::chrono::steady_clock::now()}
+{
+  if (!copier_)
+    throw Client_exception{"cannot create replication stream: invalid copier"};
+  else if (copier_.data_direction() != Data_direction::both)
+    throw Client_exception{"cannot create replication stream: "
+      "wrong data direction"};
+
+  set_status_interval(status_interval);
+}
+
+DMITIGR_PGFE_INLINE Copier& Replication_stream::copier() const noexcept
+{
+  return copier_;
+}
+
+DMITIGR_PGFE_INLINE void
+Replication_stream::set_status_interval(const std::chrono::milliseconds value)
+{
+  if (!(value.count() > 0))
+    throw Client_exception{"cannot set status interval of replication stream: "
+      "invalid interval"};
+  status_interval_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds
+Replication_stream::status_interval() const noexcept
+{
+  return status_interval_;
+}
+
+DMITIGR_PGFE_INLINE bool Replication_stream::read(const bool wait)
+{
+  using std::chrono::ceil;
+  using std::chrono::milliseconds;
+  using std::chrono::steady_clock;
+
+  message_ = {};
+  while (!is_done_) {
+    if (is_status_due())
+      send_status();
+
+    const auto data = copier_.receive(false);
+    if (!data) {
+      is_done_ = true;
+      break;
+    } else if (!data.size()) {
+      if (!wait)
+        break;
+
+      // Wait for the input until the next standby status update is due.
+      const auto timeout = std::max(milliseconds::zero(),
+        ceil<milliseconds>(last_status_time_ + status_interval_ -
+          steady_clock::now()));
+      auto& conn = copier_.connection();
+      if (conn.wait_socket_readiness(Socket_readiness::read_ready, timeout) ==
+        Socket_readiness::read_ready)
+        conn.read_input();
+      continue;
+    }
+
+    message_ = Replication_message{data};
+    received_lsn_ = std::max(received_lsn_, message_.wal_end());
+    if (message_.is_reply_requested())
+      send_status();
+    return true;
+  }
+  return false;
+}
+
+DMITIGR_PGFE_INLINE bool Replication_stream::is_done() const noexcept
+{
+  return is_done_;
+}
+
+DMITIGR_PGFE_INLINE const Replication_message&
+Replication_stream::message() const noexcept
+{
+  return message_;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Replication_stream::received_lsn() const noexcept
+{
+  return received_lsn_;
+}
+
+DMITIGR_PGFE_INLINE void
+Replication_stream::set_flushed_lsn(const std::uint64_t lsn) noexcept
+{
+  flushed_lsn_ = std::max(flushed_lsn_, lsn);
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Replication_stream::flushed_lsn() const noexcept
+{
+  return flushed_lsn_;
+}
+
+DMITIGR_PGFE_INLINE void
+Replication_stream::send_status(const bool is_reply_requested)
+{
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  using std::chrono::system_clock;
+
+  const std::int64_t now{duration_cast<microseconds>(
+      system_clock::now().time_since_epoch()).count() -
+    detail::pg_epoch_offset_us};
+  const auto written_lsn = std::max(received_lsn_, flushed_lsn_);
+
+  char message[detail::standby_status_size]{'r'};
+  net::copy(message + 1, written_lsn);
+  net::copy(message + 9, flushed_lsn_);
+  net::copy(message + 17, flushed_lsn_);
+  net::copy(message + 25, now);
+  message[33] = is_reply_requested;
+
+  auto& conn = copier_.connection();
+  const std::string_view data{message, sizeof(message)};
+  while (!copier_.send(data))
+    conn.flush_output(true);
+  conn.flush_output(true);
+
+  last_status_time_ = std::chrono::steady_clock::now();
+  ++status_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uintmax_t Replication_stream::status_count() const noexcept
+{
+  return status_count_;
+}
+
+DMITIGR_PGFE_INLINE void Replication_stream::end()
+{
+  auto& conn = copier_.connection();
+  send_status();
+  while (!copier_.end())
+    conn.flush_output(true);
+  conn.flush_output(true);
+  is_done_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Replication_stream::is_status_due() const noexcept
+{
+  return std::chrono::steady_clock::now() - last_status_time_ >= status_interval_;
+}
+
+} // namespace dmitigr::pgfe
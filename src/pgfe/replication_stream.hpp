@@ -0,0 +1,297 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_REPLICATION_STREAM_HPP
+#define DMITIGR_PGFE_REPLICATION_STREAM_HPP
+
+#include "basics.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @returns The log sequence number parsed from the string of form `X/X`, or
+ * `std::nullopt` if the `str` is malformed.
+ */
+DMITIGR_PGFE_API std::optional<std::uint64_t>
+to_lsn(std::string_view str) noexcept;
+
+/**
+ * @ingroup main
+ *
+ * @returns The string representation of `lsn` of form `X/X`.
+ */
+DMITIGR_PGFE_API std::string lsn_to_string(std::uint64_t lsn);
+
+/**
+ * @ingroup main
+ *
+ * @brief A message of the streaming replication protocol received within the
+ * `COPY BOTH` mode.
+ *
+ * @details The message is decoded in place, i.e. the payload is a view of the
+ * data the message is constructed from.
+ *
+ * @see Replication_stream.
+ */
+class Replication_message final {
+public:
+  /// A kind of the message.
+  enum class Kind {
+    /// The `XLogData` message with the WAL data.
+    xlog_data = 'w',
+    /// The primary keepalive message.
+    keepalive = 'k'
+  };
+
+  /// Constructs invalid instance.
+  Replication_message() = default;
+
+  /**
+   * @brief Decodes the message from `data`.
+   *
+   * @par Requires
+   * `data` must outlive the instance.
+   *
+   * @throws Client_exception if the `data` is not a well-formed `XLogData`
+   * or primary keepalive message.
+   */
+  DMITIGR_PGFE_API explicit Replication_message(const Data_view& data);
+
+  /// @returns `true` if the instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /// @returns The kind of the message.
+  DMITIGR_PGFE_API Kind kind() const noexcept;
+
+  /**
+   * @returns The starting point of the WAL data of the `XLogData` message, or
+   * `0` for the keepalive message.
+   */
+  DMITIGR_PGFE_API std::uint64_t wal_start() const noexcept;
+
+  /// @returns The current end of WAL on the server.
+  DMITIGR_PGFE_API std::uint64_t wal_end() const noexcept;
+
+  /// @returns The server's system clock at the time of transmission.
+  DMITIGR_PGFE_API std::chrono::system_clock::time_point
+  server_time() const noexcept;
+
+  /**
+   * @returns `true` if the keepalive message requests the client to reply as
+   * soon as possible.
+   */
+  DMITIGR_PGFE_API bool is_reply_requested() const noexcept;
+
+  /**
+   * @returns The WAL data of the `XLogData` message (for example, a message
+   * of the `pgoutput` plugin or a JSON document of the `wal2json` plugin), or
+   * the empty view for the keepalive message.
+   */
+  DMITIGR_PGFE_API const Data_view& payload() const noexcept;
+
+private:
+  bool is_valid_{};
+  Kind kind_{};
+  bool is_reply_requested_{};
+  std::uint64_t wal_start_{};
+  std::uint64_t wal_end_{};
+  std::int64_t server_time_{};
+  Data_view payload_;
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A consumer of the streaming replication started by the
+ * `START_REPLICATION` command.
+ *
+ * @details The messages received by Copier::receive() are decoded in place,
+ * and the standby status updates are sent to the server in batches: the
+ * progress recorded by set_flushed_lsn() is reported once per status interval
+ * rather than after each message, and immediately only when the server
+ * requests a reply. For example:
+ * @code
+ * Connection conn{Connection_options{}.set(Replication_mode::logical)...};
+ * conn.connect();
+ * conn.execute("START_REPLICATION SLOT s LOGICAL 0/0"
+ *   " (proto_version '1', publication_names 'p')");
+ * auto copier = conn.copier();
+ * Replication_stream stream{copier};
+ * while (stream.read()) {
+ *   if (const auto& msg = stream.message();
+ *     msg.kind() == Replication_message::Kind::xlog_data) {
+ *     handle(msg.payload());
+ *     stream.set_flushed_lsn(msg.wal_end());
+ *   }
+ * }
+ * @endcode
+ *
+ * @see Connection_options::set_replication_mode(), Copier.
+ */
+class Replication_stream final {
+public:
+  /// The default interval of standby status updates.
+  static constexpr std::chrono::milliseconds default_status_interval{10000};
+
+  /// The destructor.
+  ~Replication_stream() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param copier The copier to receive the messages by. It must outlive the
+   * stream.
+   * @param status_interval The interval of standby status updates.
+   *
+   * @par Requires
+   * `copier.data_direction() == Data_direction::both &&
+   *  status_interval.count() > 0`.
+   */
+  DMITIGR_PGFE_API explicit Replication_stream(Copier& copier,
+    std::chrono::milliseconds status_interval = default_status_interval);
+
+  /// Not copy-constructible.
+  Replication_stream(const Replication_stream&) = delete;
+
+  /// Not copy-assignable.
+  Replication_stream& operator=(const Replication_stream&) = delete;
+
+  /// Not move-constructible.
+  Replication_stream(Replication_stream&&) = delete;
+
+  /// Not move-assignable.
+  Replication_stream& operator=(Replication_stream&&) = delete;
+
+  /// @returns The copier.
+  DMITIGR_PGFE_API Copier& copier() const noexcept;
+
+  /**
+   * @brief Sets the interval of standby status updates.
+   *
+   * @par Requires
+   * `value.count() > 0`.
+   */
+  DMITIGR_PGFE_API void set_status_interval(std::chrono::milliseconds value);
+
+  /// @returns The interval of standby status updates.
+  DMITIGR_PGFE_API std::chrono::milliseconds status_interval() const noexcept;
+
+  /**
+   * @brief Receives and decodes the next message.
+   *
+   * @details The standby status update is sent before the receiving if the
+   * status interval is elapsed, and after the receiving if the received
+   * keepalive message requests a reply. When `wait` is `true` the waiting of
+   * the message is interrupted every status interval to send the update.
+   *
+   * @par Effects
+   * Invalidates the previous message.
+   *
+   * @returns `true` if the message is read. Returns `false` if either
+   * `is_done()`, or no message is yet available (this is only possible when
+   * `wait` is `false`).
+   *
+   * @throws Client_exception if the received message is malformed.
+   */
+  DMITIGR_PGFE_API bool read(bool wait = true);
+
+  /// @returns `true` if the `COPY BOTH` is done.
+  DMITIGR_PGFE_API bool is_done() const noexcept;
+
+  /// @returns The last message read.
+  DMITIGR_PGFE_API const Replication_message& message() const noexcept;
+
+  /**
+   * @returns The maximum of the ends of WAL of the messages read which is
+   * reported as the written position.
+   */
+  DMITIGR_PGFE_API std::uint64_t received_lsn() const noexcept;
+
+  /**
+   * @brief Records the position up to which the WAL is durably processed by
+   * the client, which is reported as both the flushed and the applied
+   * position by the next standby status update.
+   *
+   * @details The values less than `flushed_lsn()` are ignored.
+   *
+   * @remarks The server can remove the WAL and advance the replication slot up
+   * to the reported position.
+   */
+  DMITIGR_PGFE_API void set_flushed_lsn(std::uint64_t lsn) noexcept;
+
+  /// @returns The position recorded by set_flushed_lsn().
+  DMITIGR_PGFE_API std::uint64_t flushed_lsn() const noexcept;
+
+  /**
+   * @brief Sends the standby status update immediately.
+   *
+   * @param is_reply_requested Indicates whether to request the server to reply
+   * immediately.
+   */
+  DMITIGR_PGFE_API void send_status(bool is_reply_requested = false);
+
+  /// @returns The number of the standby status updates sent.
+  DMITIGR_PGFE_API std::uintmax_t status_count() const noexcept;
+
+  /**
+   * @brief Sends the final standby status update and the end-of-data
+   * indication to the server.
+   *
+   * @details After that the caller should wait for the next response in the
+   * usual way. (The WAL data which is already sent by the server can be
+   * received by the Copier available at this point.)
+   *
+   * @see Copier::end().
+   */
+  DMITIGR_PGFE_API void end();
+
+private:
+  Copier& copier_;
+  std::chrono::milliseconds status_interval_{};
+  std::chrono::steady_clock::time_point last_status_time_;
+  std::uintmax_t status_count_{};
+  std::uint64_t received_lsn_{};
+  std::uint64_t flushed_lsn_{};
+  bool is_done_{};
+  Replication_message message_;
+
+  bool is_status_due() const noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "replication_stream.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_REPLICATION_STREAM_HPP
@@ -37,6 +37,7 @@ private:
   friend Prepared_statement;
   friend Ready_for_query;
   friend Row;
+  friend Row_batch;
 
   Response() = default;
 };
@@ -46,6 +47,76 @@ private:
 // -----------------------------------------------------------------------------
 
 namespace detail {
+
+/// The argument type of callables with single parameter.
+template<typename F, typename = void>
+struct Callable_argument {};
+
+/// Callable argument partial specialization for function pointers.
+template<typename R, typename A>
+struct Callable_argument<R(*)(A)> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for function pointers.
+template<typename R, typename A>
+struct Callable_argument<R(*)(A) noexcept> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for member function pointers.
+template<typename R, class C, typename A>
+struct Callable_argument<R(C::*)(A)> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for member function pointers.
+template<typename R, class C, typename A>
+struct Callable_argument<R(C::*)(A) const> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for member function pointers.
+template<typename R, class C, typename A>
+struct Callable_argument<R(C::*)(A) noexcept> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for member function pointers.
+template<typename R, class C, typename A>
+struct Callable_argument<R(C::*)(A) const noexcept> {
+  using Type = A;
+};
+
+/// Callable argument partial specialization for function objects.
+template<typename F>
+struct Callable_argument<F, std::void_t<decltype(&F::operator())>>
+  : Callable_argument<decltype(&F::operator())> {};
+
+/// @returns `true` if `T` is a struct mapped by Row_mapping.
+template<typename T, typename = void>
+struct Is_row_mapped final : std::false_type {};
+
+/// Is_row_mapped partial specialization.
+template<typename T>
+struct Is_row_mapped<T,
+  std::void_t<decltype(Row_mapping<T>::fields)>> final : std::true_type {};
+
+/// The type of the struct mapped by Row_mapping which `F` accepts.
+template<typename F, typename = void>
+struct Mapped_argument final {
+  constexpr static bool is_valid = false;
+};
+
+/// Mapped argument partial specialization.
+template<typename F>
+struct Mapped_argument<F,
+  std::void_t<typename Callable_argument<std::decay_t<F>>::Type>> final {
+  using Type = std::decay_t<typename Callable_argument<std::decay_t<F>>::Type>;
+  constexpr static bool is_valid = Is_row_mapped<Type>::value &&
+    std::is_invocable_v<F, Type&&>;
+};
+
 /// Response callback traits.
 template<typename F, typename = void>
 struct Response_callback_traits final {
@@ -63,6 +134,8 @@ struct Response_callback_traits<F,
     std::is_same_v<Result, void>;
   constexpr static bool is_valid = is_result_row_processing || is_result_void;
   constexpr static bool has_error_parameter = false;
+  constexpr static bool has_row_batch_parameter = false;
+  constexpr static bool has_mapped_parameter = false;
 };
 
 /// Response callback traits partial specialization.
@@ -75,6 +148,54 @@ struct Response_callback_traits<F,
   constexpr static bool is_result_void = std::is_same_v<Result, void>;
   constexpr static bool is_valid = is_result_row_processing || is_result_void;
   constexpr static bool has_error_parameter = true;
+  constexpr static bool has_row_batch_parameter = false;
+  constexpr static bool has_mapped_parameter = false;
+};
+
+/**
+ * @brief Response callback traits partial specialization.
+ *
+ * @remarks The callbacks which are invocable with `Row&&` (such as generic
+ * lambdas) are never considered as callbacks with a `Row_batch&&` parameter.
+ */
+template<typename F>
+struct Response_callback_traits<F,
+  std::enable_if_t<std::conjunction_v<
+    std::negation<std::is_invocable<F, Row&&>>,
+    std::negation<std::is_invocable<F, Row&&, Error&&>>,
+    std::is_invocable<F, Row_batch&&>>>> final {
+  using Result = std::invoke_result_t<F, Row_batch&&>;
+  constexpr static bool is_result_row_processing =
+    std::is_same_v<Result, Row_processing>;
+  constexpr static bool is_result_void = std::is_same_v<Result, void>;
+  constexpr static bool is_valid = is_result_row_processing || is_result_void;
+  constexpr static bool has_error_parameter = false;
+  constexpr static bool has_row_batch_parameter = true;
+  constexpr static bool has_mapped_parameter = false;
+};
+
+/**
+ * @brief Response callback traits partial specialization.
+ *
+ * @details The callbacks of this kind accept the structs mapped by
+ * Row_mapping.
+ */
+template<typename F>
+struct Response_callback_traits<F,
+  std::enable_if_t<std::conjunction_v<
+    std::negation<std::is_invocable<F, Row&&>>,
+    std::negation<std::is_invocable<F, Row&&, Error&&>>,
+    std::negation<std::is_invocable<F, Row_batch&&>>,
+    std::bool_constant<Mapped_argument<F>::is_valid>>>> final {
+  using Mapped = typename Mapped_argument<F>::Type;
+  using Result = std::invoke_result_t<F, Mapped&&>;
+  constexpr static bool is_result_row_processing =
+    std::is_same_v<Result, Row_processing>;
+  constexpr static bool is_result_void = std::is_same_v<Result, void>;
+  constexpr static bool is_valid = is_result_row_processing || is_result_void;
+  constexpr static bool has_error_parameter = false;
+  constexpr static bool has_row_batch_parameter = false;
+  constexpr static bool has_mapped_parameter = true;
 };
 } // namespace detail
 
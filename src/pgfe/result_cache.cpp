@@ -0,0 +1,219 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "notification.hpp"
+#include "notification_dispatcher.hpp"
+#include "result_cache.hpp"
+
+#include <cstring>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Result_cache::Result_cache(const std::size_t capacity,
+  const std::optional<std::chrono::milliseconds> ttl)
+{
+  set_capacity(capacity);
+  set_ttl(ttl);
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::set_capacity(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set capacity of result cache: "
+      "invalid value"};
+
+  const std::lock_guard lg{mutex_};
+  capacity_ = value;
+  while (entries_.size() > capacity_)
+    erase__(std::prev(entries_.end()));
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::capacity() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return capacity_;
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::set_ttl(const std::optional<std::chrono::milliseconds> value)
+{
+  if (value && !(*value > std::chrono::milliseconds::zero()))
+    throw Client_exception{"cannot set TTL of result cache: invalid value"};
+
+  const std::lock_guard lg{mutex_};
+  ttl_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Result_cache::ttl() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return ttl_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Result_cache::size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return entries_.size();
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t Result_cache::hit_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return hit_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t Result_cache::miss_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return miss_count_;
+}
+
+DMITIGR_PGFE_INLINE void Result_cache::invalidate() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  index_.clear();
+  entries_.clear();
+  ++generation_;
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::invalidate(const std::string_view statement_name) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  for (auto i = entries_.begin(); i != entries_.end();) {
+    const auto e = i++;
+    if (e->statement_name_ == statement_name)
+      erase__(e);
+  }
+  ++generation_;
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::listen(Notification_dispatcher& dispatcher,
+  const std::string& channel)
+{
+  if (channel.empty())
+    throw Client_exception{"cannot listen channel by result cache: "
+      "invalid channel"};
+
+  dispatcher.subscribe(channel, [this](const Notification& notification)
+  {
+    if (const auto payload = notification.payload(); !payload.is_empty())
+      invalidate(std::string_view{static_cast<const char*>(payload.bytes()),
+          payload.size()});
+    else
+      invalidate();
+  });
+}
+
+DMITIGR_PGFE_INLINE auto Result_cache::execute__(Prepared_statement& statement)
+  -> Result
+{
+  if (!statement)
+    throw Client_exception{"cannot execute prepared statement by result "
+      "cache: invalid prepared statement"};
+
+  // The key is the name followed by the result format and the parameters.
+  const auto& name = statement.name();
+  std::string key;
+  key.reserve(name.size() + 16);
+  key.append(name).push_back('\0');
+  key.push_back(static_cast<char>(statement.result_format()));
+  const auto append_size = [&key](const std::uint_fast32_t size)
+  {
+    char bytes[4];
+    for (int i{}; i < 4; ++i)
+      bytes[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    key.append(bytes, sizeof(bytes));
+  };
+  const std::size_t param_count{statement.parameter_count()};
+  for (std::size_t i{}; i < param_count; ++i) {
+    if (const auto data = statement.bound(i)) {
+      key.push_back(static_cast<char>(data.format()) + 1);
+      append_size(static_cast<std::uint_fast32_t>(data.size()));
+      key.append(static_cast<const char*>(data.bytes()), data.size());
+    } else
+      key.push_back(0); // NULL
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  std::uint_fast64_t generation{};
+  {
+    const std::lock_guard lg{mutex_};
+    if (const auto i = index_.find(key); i != index_.end()) {
+      const auto entry = i->second;
+      if (!entry->expiry_ || now < *entry->expiry_) {
+        entries_.splice(entries_.begin(), entries_, entry); // mark as MRU
+        ++hit_count_;
+        return entry->result_;
+      }
+      erase__(entry);
+    }
+    ++miss_count_;
+    generation = generation_;
+  }
+
+  // All the rows are retrieved as a single batch.
+  Row_batch batch;
+  {
+    const auto mode = statement.row_delivery_mode();
+    statement.set_row_delivery_mode(Row_delivery_mode::full);
+    try {
+      statement.execute([&batch](Row_batch&& b)
+      {
+        batch = std::move(b);
+      });
+    } catch (...) {
+      statement.set_row_delivery_mode(mode);
+      throw;
+    }
+    statement.set_row_delivery_mode(mode);
+  }
+  auto result = std::make_shared<const Row_batch>(std::move(batch));
+
+  const std::lock_guard lg{mutex_};
+  // The result could be invalidated while being retrieved.
+  if (generation != generation_ || index_.count(key))
+    return result;
+
+  entries_.emplace_front();
+  try {
+    auto& entry = entries_.front();
+    entry.key_ = std::move(key);
+    entry.statement_name_ = std::string_view{entry.key_.data(), name.size()};
+    entry.result_ = result;
+    if (ttl_)
+      entry.expiry_ = now + *ttl_;
+    index_.emplace(entry.key_, entries_.begin());
+  } catch (...) {
+    entries_.pop_front();
+    throw;
+  }
+  while (entries_.size() > capacity_)
+    erase__(std::prev(entries_.end()));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Result_cache::erase__(const decltype(entries_)::iterator entry) noexcept
+{
+  index_.erase(entry->key_);
+  entries_.erase(entry);
+}
+
+} // namespace dmitigr::pgfe
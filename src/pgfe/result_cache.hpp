@@ -0,0 +1,191 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_RESULT_CACHE_HPP
+#define DMITIGR_PGFE_RESULT_CACHE_HPP
+
+#include "dll.hpp"
+#include "prepared_statement.hpp"
+#include "row_batch.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A client-side cache of the results of idempotent read queries.
+ *
+ * @details The results are cached per prepared statement name, result format
+ * and bytes of bound parameters. Thus, the prepared statements of the same
+ * name must be prepared from the same query on all the connections the cache
+ * is used with. The results are evicted in the least recently used order when
+ * the capacity is exceeded, and expire after the time to live (if set). The
+ * results can be invalidated explicitly, or by the notifications of a channel
+ * (see listen()).
+ *
+ * @par Thread safety
+ * Thread-safe.
+ *
+ * @see Notification_dispatcher.
+ */
+class Result_cache final {
+public:
+  /// The cached result. The rows are retrieved as a single batch.
+  using Result = std::shared_ptr<const Row_batch>;
+
+  /// The default capacity.
+  static constexpr std::size_t default_capacity{1024};
+
+  /**
+   * @brief The constructor.
+   *
+   * @param capacity The maximum number of cached results.
+   * @param ttl The time to live of cached results, or `std::nullopt` if the
+   * results never expire.
+   *
+   * @par Requires
+   * `capacity && (!ttl || ttl > std::chrono::milliseconds::zero())`.
+   */
+  DMITIGR_PGFE_API explicit Result_cache(std::size_t capacity = default_capacity,
+    std::optional<std::chrono::milliseconds> ttl = std::nullopt);
+
+  /// Not copy-constructible.
+  Result_cache(const Result_cache&) = delete;
+
+  /// Not copy-assignable.
+  Result_cache& operator=(const Result_cache&) = delete;
+
+  /// Not move-constructible.
+  Result_cache(Result_cache&&) = delete;
+
+  /// Not move-assignable.
+  Result_cache& operator=(Result_cache&&) = delete;
+
+  /**
+   * @brief Sets the capacity. Evicts the excess results.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_capacity(std::size_t value);
+
+  /// @returns The capacity.
+  DMITIGR_PGFE_API std::size_t capacity() const noexcept;
+
+  /**
+   * @brief Sets the time to live of the results cached after the call.
+   *
+   * @par Requires
+   * `!value || value > std::chrono::milliseconds::zero()`.
+   */
+  DMITIGR_PGFE_API void set_ttl(std::optional<std::chrono::milliseconds> value);
+
+  /// @returns The time to live of cached results.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds> ttl() const noexcept;
+
+  /// @returns The number of cached results.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns The number of results returned from the cache.
+  DMITIGR_PGFE_API std::uint_fast64_t hit_count() const noexcept;
+
+  /// @returns The number of results retrieved from the server.
+  DMITIGR_PGFE_API std::uint_fast64_t miss_count() const noexcept;
+
+  /**
+   * @brief Binds the `parameters` to the `statement` and returns the cached
+   * result, or executes the `statement` and caches the result.
+   *
+   * @par Requires
+   * `statement && statement.connection().is_ready_for_request()`.
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   *
+   * @remarks The concurrent misses of the same result are executed
+   * independently.
+   */
+  template<typename ... Types>
+  Result execute(Prepared_statement& statement, Types&& ... parameters)
+  {
+    statement.bind_many(std::forward<Types>(parameters)...);
+    return execute__(statement);
+  }
+
+  /// Removes all the cached results.
+  DMITIGR_PGFE_API void invalidate() noexcept;
+
+  /// Removes the cached results of the prepared statement of the given name.
+  DMITIGR_PGFE_API void invalidate(std::string_view statement_name) noexcept;
+
+  /**
+   * @brief Subscribes the cache to the notifications of the `channel`.
+   *
+   * @details Upon a notification, the results of the prepared statement named
+   * by the payload are invalidated, or all the results are invalidated if the
+   * payload is empty.
+   *
+   * @par Requires
+   * `!channel.empty()`.
+   *
+   * @remarks The cache must outlive the subscription.
+   *
+   * @see invalidate().
+   */
+  DMITIGR_PGFE_API void listen(Notification_dispatcher& dispatcher,
+    const std::string& channel);
+
+private:
+  struct Entry final {
+    std::string key_;
+    std::string_view statement_name_; // the prefix of key_
+    Result result_;
+    std::optional<std::chrono::steady_clock::time_point> expiry_;
+  };
+
+  mutable std::mutex mutex_;
+  std::size_t capacity_{};
+  std::optional<std::chrono::milliseconds> ttl_;
+  std::list<Entry> entries_; // the MRU entry is first
+  std::unordered_map<std::string_view, decltype(entries_)::iterator> index_;
+  std::uint_fast64_t generation_{}; // incremented by every invalidation
+  std::uint_fast64_t hit_count_{};
+  std::uint_fast64_t miss_count_{};
+
+  Result execute__(Prepared_statement& statement);
+  void erase__(decltype(entries_)::iterator entry) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "result_cache.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_RESULT_CACHE_HPP
@@ -0,0 +1,257 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "conversions.hpp"
+#include "exceptions.hpp"
+#include "routing_connection_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Routing_connection_pool::Routing_connection_pool(const std::size_t size,
+  Connection_options primary_options,
+  const std::vector<Connection_options>& replicas_options)
+{
+  if (!primary_options.session_mode())
+    primary_options.set_session_mode(Session_mode::read_write);
+  primary_ = std::make_unique<Connection_pool>(size, primary_options);
+  replicas_.reserve(replicas_options.size());
+  for (const auto& options : replicas_options)
+    replicas_.push_back(Replica{std::make_unique<Connection_pool>(size,
+          options)});
+}
+
+DMITIGR_PGFE_INLINE bool Routing_connection_pool::is_valid() const noexcept
+{
+  return primary_ && primary_->is_valid();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool& Routing_connection_pool::primary()
+{
+  return const_cast<Connection_pool&>(
+    static_cast<const Routing_connection_pool*>(this)->primary());
+}
+
+DMITIGR_PGFE_INLINE const Connection_pool&
+Routing_connection_pool::primary() const
+{
+  if (!primary_)
+    throw Client_exception{"cannot get primary of invalid connection pool"};
+  return *primary_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Routing_connection_pool::replica_count() const noexcept
+{
+  return replicas_.size();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Routing_connection_pool::replica(const std::size_t index)
+{
+  return const_cast<Connection_pool&>(
+    static_cast<const Routing_connection_pool*>(this)->replica(index));
+}
+
+DMITIGR_PGFE_INLINE const Connection_pool&
+Routing_connection_pool::replica(const std::size_t index) const
+{
+  if (!(index < replica_count()))
+    throw Client_exception{"cannot get replica of connection pool: "
+      "invalid index"};
+  return *replicas_[index].pool_;
+}
+
+DMITIGR_PGFE_INLINE bool
+Routing_connection_pool::is_replica_available(const std::size_t index) const
+{
+  if (!(index < replica_count()))
+    throw Client_exception{"cannot get replica availability of connection "
+      "pool: invalid index"};
+  const std::lock_guard lg{mutex_};
+  return Clock::now() >= replicas_[index].unavailable_until_;
+}
+
+DMITIGR_PGFE_INLINE void Routing_connection_pool::set_replica_retry_interval(
+  const std::chrono::milliseconds value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  replica_retry_interval_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds
+Routing_connection_pool::replica_retry_interval() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return replica_retry_interval_;
+}
+
+DMITIGR_PGFE_INLINE void Routing_connection_pool::set_max_replica_lag(
+  const std::optional<std::chrono::milliseconds> value) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  max_replica_lag_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::optional<std::chrono::milliseconds>
+Routing_connection_pool::max_replica_lag() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_replica_lag_;
+}
+
+DMITIGR_PGFE_INLINE void Routing_connection_pool::connect()
+{
+  primary().connect();
+  for (std::size_t i{}; i < replicas_.size(); ++i) {
+    try {
+      replicas_[i].pool_->connect();
+    } catch (const std::exception&) {
+      set_replica_unavailable(i);
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE void Routing_connection_pool::disconnect() noexcept
+{
+  if (primary_)
+    primary_->disconnect();
+  for (auto& replica : replicas_)
+    replica.pool_->disconnect();
+}
+
+DMITIGR_PGFE_INLINE bool Routing_connection_pool::is_connected() const noexcept
+{
+  return primary_ && primary_->is_connected();
+}
+
+DMITIGR_PGFE_INLINE auto
+Routing_connection_pool::try_connection(const Session_mode mode) -> Handle
+{
+  return is_read_only(mode) ? replica_connection(available_replicas()) :
+    primary().try_connection();
+}
+
+DMITIGR_PGFE_INLINE auto Routing_connection_pool::connection(
+  const Session_mode mode,
+  const std::optional<std::chrono::milliseconds> timeout) -> Handle
+{
+  if (!is_read_only(mode))
+    return primary().connection(timeout);
+
+  const auto replicas = available_replicas();
+  if (auto result = replica_connection(replicas))
+    return result;
+
+  // Wait on the least loaded available replica.
+  if (!replicas.empty()) {
+    const auto index = replicas.front();
+    try {
+      return replicas_[index].pool_->connection(timeout);
+    } catch (const std::exception&) {
+      set_replica_unavailable(index);
+    }
+  }
+  return primary().connection(timeout);
+}
+
+DMITIGR_PGFE_INLINE void Routing_connection_pool::check_replicas()
+{
+  const auto max_lag = max_replica_lag();
+  if (!max_lag)
+    return;
+
+  for (const auto index : available_replicas()) {
+    try {
+      auto conn = replicas_[index].pool_->try_connection();
+      if (!conn)
+        continue; // the replica is busy
+
+      double lag{};
+      conn->execute([&lag](auto&& row)
+      {
+        lag = to<double>(row.data());
+      }, "select coalesce(extract(epoch from now() -"
+        " pg_last_xact_replay_timestamp()) * 1000, 0)");
+      if (lag > static_cast<double>(max_lag->count()))
+        set_replica_unavailable(index);
+    } catch (const std::exception&) {
+      set_replica_unavailable(index);
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE bool
+Routing_connection_pool::is_read_only(const Session_mode mode) noexcept
+{
+  return mode == Session_mode::read_only || mode == Session_mode::standby;
+}
+
+DMITIGR_PGFE_INLINE std::vector<std::size_t>
+Routing_connection_pool::available_replicas() const
+{
+  std::vector<std::pair<std::size_t, std::size_t>> busy_counts;
+  {
+    const std::lock_guard lg{mutex_};
+    const auto now = Clock::now();
+    for (std::size_t i{}; i < replicas_.size(); ++i) {
+      if (now >= replicas_[i].unavailable_until_) {
+        const auto& pool = *replicas_[i].pool_;
+        busy_counts.emplace_back(pool.size() - pool.free_count(), i);
+      }
+    }
+  }
+  std::sort(busy_counts.begin(), busy_counts.end());
+
+  std::vector<std::size_t> result;
+  result.reserve(busy_counts.size());
+  for (const auto& [busy_count, index] : busy_counts)
+    result.push_back(index);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto Routing_connection_pool::replica_connection(
+  const std::vector<std::size_t>& replicas) -> Handle
+{
+  // Fall back to the primary if the replicas are busy or unavailable.
+  for (const auto index : replicas) {
+    auto& pool = *replicas_[index].pool_;
+    try {
+      // Reconnect the replica which was unavailable.
+      if (!pool.is_connected())
+        pool.connect();
+      if (auto result = pool.try_connection())
+        return result;
+    } catch (const std::exception&) {
+      set_replica_unavailable(index);
+    }
+  }
+  return primary().try_connection();
+}
+
+DMITIGR_PGFE_INLINE void
+Routing_connection_pool::set_replica_unavailable(const std::size_t index) noexcept
+{
+  DMITIGR_ASSERT(index < replicas_.size());
+  const std::lock_guard lg{mutex_};
+  replicas_[index].unavailable_until_ = Clock::now() + replica_retry_interval_;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,234 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ROUTING_CONNECTION_POOL_HPP
+#define DMITIGR_PGFE_ROUTING_CONNECTION_POOL_HPP
+
+#include "basics.hpp"
+#include "connection_pool.hpp"
+#include "dll.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe pool of connections which routes the read-only
+ * sessions to replicas.
+ *
+ * @details The pool consists of the pool of the primary server and the pools
+ * of replicas. The read-write handles are always acquired from the primary.
+ * The read-only handles are acquired from the available replica with the
+ * least number of busy connections, or from the primary if there are no
+ * available replicas. A replica becomes unavailable for replica_retry_interval()
+ * if either it cannot be connected, or its replication lag exceeds
+ * max_replica_lag() (see check_replicas()).
+ *
+ * @remarks All the functions are thread-safe, except the constructor and
+ * the destructor.
+ */
+class Routing_connection_pool final {
+public:
+  /// A connection handle.
+  using Handle = Connection_pool::Handle;
+
+  /// Default-constructible. (Constructs invalid instance.)
+  Routing_connection_pool() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param size A number of connections in the pool of each server.
+   * @param primary_options A connection options of the primary server. If
+   * the session mode is not specified, Session_mode::read_write is used.
+   * @param replicas_options A connection options of the replicas.
+   */
+  DMITIGR_PGFE_API Routing_connection_pool(std::size_t size,
+    Connection_options primary_options,
+    const std::vector<Connection_options>& replicas_options);
+
+  /// Not copy-constructible.
+  Routing_connection_pool(const Routing_connection_pool&) = delete;
+
+  /// Not copy-assignable.
+  Routing_connection_pool& operator=(const Routing_connection_pool&) = delete;
+
+  /// Not move-constructible.
+  Routing_connection_pool(Routing_connection_pool&&) = delete;
+
+  /// Not move-assignable.
+  Routing_connection_pool& operator=(Routing_connection_pool&&) = delete;
+
+  /// @returns `true` if this instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /**
+   * @returns The pool of the primary server.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API Connection_pool& primary();
+
+  /// @overload
+  DMITIGR_PGFE_API const Connection_pool& primary() const;
+
+  /// @returns The number of replicas.
+  DMITIGR_PGFE_API std::size_t replica_count() const noexcept;
+
+  /**
+   * @returns The pool of the replica at `index`.
+   *
+   * @par Requires
+   * `index < replica_count()`.
+   */
+  DMITIGR_PGFE_API Connection_pool& replica(std::size_t index);
+
+  /// @overload
+  DMITIGR_PGFE_API const Connection_pool& replica(std::size_t index) const;
+
+  /**
+   * @returns `true` if the replica at `index` is available for routing.
+   *
+   * @par Requires
+   * `index < replica_count()`.
+   */
+  DMITIGR_PGFE_API bool is_replica_available(std::size_t index) const;
+
+  /**
+   * @brief Sets the time during which the failed replica is not used.
+   *
+   * @remarks By default, it's 5 seconds.
+   */
+  DMITIGR_PGFE_API void
+  set_replica_retry_interval(std::chrono::milliseconds value) noexcept;
+
+  /// @returns The time during which the failed replica is not used.
+  DMITIGR_PGFE_API std::chrono::milliseconds
+  replica_retry_interval() const noexcept;
+
+  /**
+   * @brief Sets the maximum replication lag of a replica.
+   *
+   * @remarks By default, it's `std::nullopt` which means *eternity*.
+   *
+   * @see check_replicas().
+   */
+  DMITIGR_PGFE_API void
+  set_max_replica_lag(std::optional<std::chrono::milliseconds> value) noexcept;
+
+  /// @returns The maximum replication lag of a replica.
+  DMITIGR_PGFE_API std::optional<std::chrono::milliseconds>
+  max_replica_lag() const noexcept;
+
+  /**
+   * @brief Opens the connections to the servers.
+   *
+   * @details The replicas which cannot be connected become unavailable.
+   *
+   * @throws Client_exception if the primary cannot be connected.
+   */
+  DMITIGR_PGFE_API void connect();
+
+  /// Closes the connections to the servers.
+  DMITIGR_PGFE_API void disconnect() noexcept;
+
+  /// @returns `true` if the pool of the primary server is connected.
+  DMITIGR_PGFE_API bool is_connected() const noexcept;
+
+  /**
+   * @returns The valid connection handle if there is a free connection on the
+   * server selected according to `mode`, or invalid handle otherwise.
+   *
+   * @param mode If it's Session_mode::read_only or Session_mode::standby the
+   * server is selected as described in the class details. Otherwise, the
+   * connection is acquired from the primary server.
+   *
+   * @throws Client_exception as Connection_pool::try_connection().
+   */
+  DMITIGR_PGFE_API Handle try_connection(Session_mode mode);
+
+  /**
+   * @brief Waits for a free connection on the server selected according to
+   * `mode`.
+   *
+   * @details Returns try_connection() if it's valid. Otherwise, waits for the
+   * free connection on the least loaded available replica, or on the primary
+   * if there are no available replicas or if `mode` is not read-only.
+   *
+   * @param mode Same as for try_connection().
+   * @param timeout The maximum amount of time to wait. The value of
+   * `std::nullopt` means *eternity*.
+   *
+   * @returns The valid connection handle, or invalid handle if there is no
+   * free connection within the specified `timeout`.
+   *
+   * @throws Client_exception as Connection_pool::connection().
+   */
+  DMITIGR_PGFE_API Handle connection(Session_mode mode,
+    std::optional<std::chrono::milliseconds> timeout);
+
+  /**
+   * @brief Checks the replication lag of the available replicas.
+   *
+   * @details The lag is measured by `now() - pg_last_xact_replay_timestamp()`
+   * on a free connection of each replica. The replicas with the lag greater
+   * than max_replica_lag() become unavailable.
+   *
+   * @remarks The lag is overestimated if there are no writes on the primary.
+   */
+  DMITIGR_PGFE_API void check_replicas();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Replica final {
+    std::unique_ptr<Connection_pool> pool_;
+    Clock::time_point unavailable_until_{};
+  };
+
+  mutable std::mutex mutex_;
+  std::unique_ptr<Connection_pool> primary_;
+  std::vector<Replica> replicas_;
+  std::chrono::milliseconds replica_retry_interval_{std::chrono::seconds{5}};
+  std::optional<std::chrono::milliseconds> max_replica_lag_;
+
+  static bool is_read_only(Session_mode mode) noexcept;
+  std::vector<std::size_t> available_replicas() const;
+  Handle replica_connection(const std::vector<std::size_t>& replicas);
+  void set_replica_unavailable(std::size_t index) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "routing_connection_pool.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_ROUTING_CONNECTION_POOL_HPP
@@ -16,6 +16,7 @@
 
 #include "exceptions.hpp"
 #include "row.hpp"
+#include "tuple.hpp"
 
 #include <algorithm>
 
@@ -25,6 +26,7 @@ DMITIGR_PGFE_INLINE void Row::swap(Row& rhs) noexcept
 {
   using std::swap;
   swap(info_, rhs.info_);
+  swap(number_, rhs.number_);
 }
 
 DMITIGR_PGFE_INLINE bool Row::is_valid() const noexcept
@@ -65,7 +67,7 @@ DMITIGR_PGFE_INLINE Data_view Row::data(const std::size_t index) const
   if (!(index < field_count()))
     throw Client_exception{"cannot get field data of row"};
 
-  constexpr int row{};
+  const int row{number_};
   const auto fld = static_cast<int>(index);
   const auto& r = info_.pq_result_;
   return !r.is_data_null(row, fld) ?
@@ -80,9 +82,46 @@ DMITIGR_PGFE_INLINE Data_view Row::data(const std::string_view name,
   return data(field_index(name, offset));
 }
 
+DMITIGR_PGFE_INLINE Tuple Row::to_tuple() const
+{
+  const int row{number_};
+  const auto& r = info_.pq_result_;
+  const int fc{r.field_count()};
+  auto compact = std::make_shared<detail::Compact_tuple>();
+  std::size_t size{};
+  for (int i{}; i < fc; ++i)
+    size += static_cast<std::size_t>(r.data_size(row, i));
+  compact->bytes.reserve(size);
+  compact->values.reserve(static_cast<std::size_t>(fc));
+  for (int i{}; i < fc; ++i) {
+    auto& value = compact->values.emplace_back();
+    value.format = r.field_format(i);
+    if (r.is_data_null(row, i)) {
+      value.is_null = true;
+      continue;
+    }
+    value.offset = compact->bytes.size();
+    value.size = static_cast<std::size_t>(r.data_size(row, i));
+    compact->bytes.append(r.data_value(row, i), value.size);
+  }
+  compact->names = info_.field_names();
+
+  Tuple result;
+  result.compact_ = std::move(compact);
+  return result;
+}
+
 DMITIGR_PGFE_INLINE bool Row::is_invariant_ok() const noexcept
 {
-  const bool info_ok = info_.pq_result_.status() == PGRES_SINGLE_TUPLE;
+  const auto& r = info_.pq_result_;
+  const auto s = r.status();
+  const bool is_multi_row =
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    (s == PGRES_TUPLES_CHUNK) ||
+#endif
+    (s == PGRES_TUPLES_OK);
+  const bool info_ok = (s == PGRES_SINGLE_TUPLE && !number_) ||
+    (is_multi_row && 0 <= number_ && number_ < r.row_count());
   return info_ok && Composite::is_invariant_ok();
 }
 
@@ -24,7 +24,9 @@
 #include "row_info.hpp"
 
 #include <cassert>
+#include <cstddef>
 #include <iterator>
+#include <string_view>
 #include <type_traits>
 
 namespace dmitigr::pgfe {
@@ -98,6 +100,16 @@ public:
   DMITIGR_PGFE_API Data_view data(const std::string_view name,
     std::size_t offset = 0) const noexcept override;
 
+  /**
+   * @returns The compact tuple of the copies of the data of this row.
+   *
+   * @details The table of field names of the result is shared by the tuples
+   * made of all the rows of the request, so the names are not copied per row.
+   *
+   * @see Tuple::compact(), Tuple::is_field_names_shared().
+   */
+  DMITIGR_PGFE_API Tuple to_tuple() const;
+
   /// @name Iterators
   /// @{
 
@@ -231,8 +243,274 @@ public:
 
   /// @}
 
+  /// @name Views
+  /// @{
+
+  /**
+   * @brief A random access view of the field values of the row.
+   *
+   * @details Unlike the iterators of the row, the view doesn't resolve the
+   * names of the fields, and its elements are read from the result directly,
+   * so the iteration over the view costs just the calls of `PQgetisnull()`,
+   * `PQgetvalue()` and `PQgetlength()` per field.
+   *
+   * @tparam T Either Data_view, or `std::string_view` (in which case the
+   * element of SQL NULL has `data() == nullptr`).
+   *
+   * @remarks The view and its iterators are valid as long as the row is
+   * alive.
+   *
+   * @see values(), spans().
+   */
+  template<typename T>
+  class Field_view final {
+    static_assert(std::is_same_v<T, Data_view> ||
+      std::is_same_v<T, std::string_view>);
+  public:
+    /// The iterator of the view.
+    class Iterator final {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = T;
+      using difference_type = std::ptrdiff_t;
+      using reference = T;
+      using pointer = void;
+
+      /// Constructs an invalid iterator.
+      Iterator() = default;
+
+      /// Dereferences the iterator.
+      T operator*() const noexcept
+      {
+        DMITIGR_ASSERT(result_);
+        return get(*result_, row_, index_);
+      }
+
+      /// @returns The element at the specified offset.
+      T operator[](const difference_type n) const noexcept
+      {
+        return *(*this + n);
+      }
+
+      /// Prefix increment.
+      Iterator& operator++() noexcept
+      {
+        ++index_;
+        return *this;
+      }
+
+      /// Postfix increment.
+      Iterator operator++(int) noexcept
+      {
+        auto tmp{*this};
+        ++index_;
+        return tmp;
+      }
+
+      /// Prefix decrement.
+      Iterator& operator--() noexcept
+      {
+        --index_;
+        return *this;
+      }
+
+      /// Postfix decrement.
+      Iterator operator--(int) noexcept
+      {
+        auto tmp{*this};
+        --index_;
+        return tmp;
+      }
+
+      /// Advances the iterator by `n`.
+      Iterator& operator+=(const difference_type n) noexcept
+      {
+        index_ += static_cast<int>(n);
+        return *this;
+      }
+
+      /// Advances the iterator by `-n`.
+      Iterator& operator-=(const difference_type n) noexcept
+      {
+        return *this += -n;
+      }
+
+      /// @returns The iterator advanced by `n`.
+      Iterator operator+(const difference_type n) const noexcept
+      {
+        auto result{*this};
+        return result += n;
+      }
+
+      /// @returns The iterator advanced by `-n`.
+      Iterator operator-(const difference_type n) const noexcept
+      {
+        auto result{*this};
+        return result -= n;
+      }
+
+      /// @returns The distance between `rhs` and this iterator.
+      difference_type operator-(const Iterator& rhs) const noexcept
+      {
+        return index_ - rhs.index_;
+      }
+
+      /// @returns `true` if `*this == rhs`.
+      bool operator==(const Iterator& rhs) const noexcept
+      {
+        return (result_ == rhs.result_) && (row_ == rhs.row_) &&
+          (index_ == rhs.index_);
+      }
+
+      /// @returns `true` if `*this != rhs`.
+      bool operator!=(const Iterator& rhs) const noexcept
+      {
+        return !(*this == rhs);
+      }
+
+      /// @returns `true` if `*this < rhs`.
+      bool operator<(const Iterator& rhs) const noexcept
+      {
+        return index_ < rhs.index_;
+      }
+
+      /// @returns `true` if `*this > rhs`.
+      bool operator>(const Iterator& rhs) const noexcept
+      {
+        return rhs < *this;
+      }
+
+      /// @returns `true` if `*this <= rhs`.
+      bool operator<=(const Iterator& rhs) const noexcept
+      {
+        return !(rhs < *this);
+      }
+
+      /// @returns `true` if `*this >= rhs`.
+      bool operator>=(const Iterator& rhs) const noexcept
+      {
+        return !(*this < rhs);
+      }
+
+    private:
+      friend Field_view;
+
+      const detail::pq::Result* result_{};
+      int row_{};
+      int index_{};
+
+      Iterator(const detail::pq::Result* const result, const int row,
+        const int index) noexcept
+        : result_{result}
+        , row_{row}
+        , index_{index}
+      {}
+    };
+
+    /// @returns The number of fields.
+    std::size_t size() const noexcept
+    {
+      return static_cast<std::size_t>(size_);
+    }
+
+    /// @returns `true` if `size() == 0`.
+    bool empty() const noexcept
+    {
+      return !size_;
+    }
+
+    /**
+     * @returns The value of the field at `index`.
+     *
+     * @par Requires
+     * `index < size()`.
+     */
+    T operator[](const std::size_t index) const noexcept
+    {
+      DMITIGR_ASSERT(index < size());
+      return get(*result_, row_, static_cast<int>(index));
+    }
+
+    /// @returns The iterator that points to a zero field.
+    Iterator begin() const noexcept
+    {
+      return Iterator{result_, row_, 0};
+    }
+
+    /// @returns The iterator that points to an one-past-the-last field.
+    Iterator end() const noexcept
+    {
+      return Iterator{result_, row_, size_};
+    }
+
+  private:
+    friend Row;
+
+    const detail::pq::Result* result_{};
+    int row_{};
+    int size_{};
+
+    Field_view(const detail::pq::Result& result, const int row) noexcept
+      : result_{&result}
+      , row_{row}
+      , size_{result.field_count()}
+    {}
+
+    static T get(const detail::pq::Result& result, const int row,
+      const int index) noexcept
+    {
+      if (result.is_data_null(row, index))
+        return T{};
+
+      const char* const value{result.data_value(row, index)};
+      const auto size = static_cast<std::size_t>(result.data_size(row, index));
+      if constexpr (std::is_same_v<T, Data_view>)
+        return Data_view{value, size, result.field_format(index)};
+      else
+        return std::string_view{value, size};
+    }
+  };
+
+  /**
+   * @returns The view of the field values of this row as Data_view.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  Field_view<Data_view> values() const noexcept
+  {
+    DMITIGR_ASSERT(is_valid());
+    return {info_.pq_result_, number_};
+  }
+
+  /**
+   * @returns The view of the raw bytes of the field values of this row, where
+   * the value of SQL NULL is `std::string_view{}`.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  Field_view<std::string_view> spans() const noexcept
+  {
+    DMITIGR_ASSERT(is_valid());
+    return {info_.pq_result_, number_};
+  }
+
+  /// @}
+
 private:
+  friend Connection;
+
   Row_info info_; // has pq_result_
+  int number_{}; // the row number in info_.pq_result_
+
+  /// Constructs the row of the specified `number` of the multi-row result.
+  Row(Row_info&& info, const int number) noexcept
+    : info_{std::move(info)}
+    , number_{number}
+  {
+    assert(is_invariant_ok());
+  }
 
   bool is_invariant_ok() const noexcept override;
 };
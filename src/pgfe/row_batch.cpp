@@ -0,0 +1,119 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "row_batch.hpp"
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void Row_batch::swap(Row_batch& rhs) noexcept
+{
+  using std::swap;
+  swap(info_, rhs.info_);
+  swap(offset_, rhs.offset_);
+  swap(row_count_, rhs.row_count_);
+}
+
+DMITIGR_PGFE_INLINE bool Row_batch::is_valid() const noexcept
+{
+  return static_cast<bool>(info_.pq_result_);
+}
+
+DMITIGR_PGFE_INLINE Row_batch Row_batch::share()
+{
+  if (!is_valid())
+    throw Client_exception{"cannot share invalid row batch"};
+
+  auto& r = info_.pq_result_;
+  r.make_shareable();
+  return Row_batch{Row_info{r.share(), info_.field_name_index_}, offset_,
+    row_count_};
+}
+
+DMITIGR_PGFE_INLINE bool Row_batch::is_shared() const noexcept
+{
+  return info_.pq_result_.is_shareable();
+}
+
+DMITIGR_PGFE_INLINE const Row_info& Row_batch::info() const noexcept
+{
+  return info_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Row_batch::row_count() const noexcept
+{
+  return static_cast<std::size_t>(row_count_);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Row_batch::field_count() const noexcept
+{
+  return info_.field_count();
+}
+
+DMITIGR_PGFE_INLINE Data_view
+Row_batch::data(const std::size_t row, const std::size_t field) const
+{
+  if (!(row < row_count()))
+    throw Client_exception{"cannot get field data of row batch: invalid row"};
+  else if (!(field < field_count()))
+    throw Client_exception{"cannot get field data of row batch: invalid field"};
+
+  const int rw{offset_ + static_cast<int>(row)};
+  const auto fld = static_cast<int>(field);
+  const auto& r = info_.pq_result_;
+  return !r.is_data_null(rw, fld) ?
+    Data_view{r.data_value(rw, fld),
+    static_cast<std::size_t>(r.data_size(rw, fld)), r.field_format(fld)} :
+    Data_view{};
+}
+
+DMITIGR_PGFE_INLINE Data_view
+Row_batch::data(const std::size_t row, const std::string_view name,
+  const std::size_t offset) const
+{
+  return data(row, info_.field_index(name, offset));
+}
+
+DMITIGR_PGFE_INLINE auto
+Row_batch::column(const std::size_t field) const -> Column
+{
+  if (!(field < field_count()))
+    throw Client_exception{"cannot get column of row batch: invalid field"};
+  return Column{this, field};
+}
+
+DMITIGR_PGFE_INLINE auto
+Row_batch::column(const std::string_view name,
+  const std::size_t offset) const -> Column
+{
+  return column(info_.field_index(name, offset));
+}
+
+DMITIGR_PGFE_INLINE bool Row_batch::is_invariant_ok() const noexcept
+{
+  const auto& r = info_.pq_result_;
+  const auto s = r.status();
+  const bool status_ok =
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    (s == PGRES_TUPLES_CHUNK) ||
+#endif
+    (s == PGRES_SINGLE_TUPLE) || (s == PGRES_TUPLES_OK);
+  const bool rows_ok = 0 <= offset_ && 0 < row_count_ &&
+    offset_ + row_count_ <= r.row_count();
+  return status_ok && rows_ok;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,311 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ROW_BATCH_HPP
+#define DMITIGR_PGFE_ROW_BATCH_HPP
+
+#include "../base/assert.hpp"
+#include "data.hpp"
+#include "response.hpp"
+#include "row_info.hpp"
+
+#include <cassert>
+#include <iterator>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A batch of rows produced by a PostgreSQL server.
+ *
+ * @details Unlike Row, the batch provides access to the data of multiple rows
+ * of the same result without constructing the object per row. The batch can
+ * contain more than one row only if the rows are delivered in
+ * Row_delivery_mode::chunked or Row_delivery_mode::full mode.
+ *
+ * The batch is move-only, but share() provides the instances which refer to
+ * the same rows without copying them. Such instances can be passed to the
+ * different threads (for example, one for decoding and another one for
+ * caching) since the rows are never modified and the reference counting is
+ * atomic. The rows are released when the last of such instances is destroyed,
+ * regardless of the state of the connection which produced the batch.
+ *
+ * @see Connection::row_batch(), Row_delivery_mode.
+ */
+class Row_batch final : public Response {
+public:
+  class Column;
+
+  /// Default-constructible. (Constructs invalid instance.)
+  Row_batch() = default;
+
+  /// Swaps this with `rhs`.
+  DMITIGR_PGFE_API void swap(Row_batch& rhs) noexcept;
+
+  /// @see Message::is_valid().
+  DMITIGR_PGFE_API bool is_valid() const noexcept override;
+
+  /**
+   * @returns The batch which shares the rows with this one.
+   *
+   * @par Requires
+   * `is_valid()`.
+   *
+   * @par Effects
+   * `is_shared()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   *
+   * @par Thread safety
+   * Must not be called concurrently for the same instance.
+   *
+   * @see is_shared().
+   */
+  DMITIGR_PGFE_API Row_batch share();
+
+  /**
+   * @returns `true` if the rows of this batch can be shared with the other
+   * instances without the allocation.
+   *
+   * @remarks The batches of the rows delivered in Row_delivery_mode::full
+   * mode are always shared with the connection until the completion of the
+   * response.
+   *
+   * @see share().
+   */
+  DMITIGR_PGFE_API bool is_shared() const noexcept;
+
+  /// @returns The information about the rows of this batch.
+  DMITIGR_PGFE_API const Row_info& info() const noexcept;
+
+  /// @returns The number of rows in this batch.
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /// @returns The number of fields of each row of this batch.
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept;
+
+  /**
+   * @returns The field data of the specified row of this batch, or invalid
+   * instance if SQL NULL.
+   *
+   * @par Requires
+   * `row < row_count() && field < field_count()`.
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t row, std::size_t field) const;
+
+  /**
+   * @overload
+   *
+   * @param offset See Compositional.
+   *
+   * @par Requires
+   * `row < row_count() && info().field_index(name, offset) < field_count()`.
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t row, std::string_view name,
+    std::size_t offset = 0) const;
+
+  /**
+   * @returns The column of this batch.
+   *
+   * @par Requires
+   * `field < field_count()`.
+   */
+  DMITIGR_PGFE_API Column column(std::size_t field) const;
+
+  /**
+   * @overload
+   *
+   * @par Requires
+   * `info().field_index(name, offset) < field_count()`.
+   */
+  DMITIGR_PGFE_API Column column(std::string_view name,
+    std::size_t offset = 0) const;
+
+  /**
+   * @brief A column of the row batch.
+   *
+   * @warning The lifetime of the instances of this class is limited by the
+   * lifetime of the corresponding instance of Row_batch.
+   */
+  class Column final {
+  public:
+    /// Constant iterator over the field data of the column.
+    class Const_iterator final {
+    public:
+      using iterator_category = std::bidirectional_iterator_tag;
+      using value_type = Data_view;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type;
+      using pointer = void;
+
+      /// Constructs an invalid iterator.
+      Const_iterator() = default;
+
+      /// Dereferences the iterator.
+      Data_view operator*() const
+      {
+        DMITIGR_ASSERT(column_);
+        return (*column_)[index_];
+      }
+
+      /// Prefix increment.
+      Const_iterator& operator++() noexcept
+      {
+        ++index_;
+        return *this;
+      }
+
+      /// Postfix increment.
+      Const_iterator operator++(int) noexcept
+      {
+        auto tmp{*this};
+        ++index_;
+        return tmp;
+      }
+
+      /// Prefix decrement.
+      Const_iterator& operator--() noexcept
+      {
+        --index_;
+        return *this;
+      }
+
+      /// Postfix decrement.
+      Const_iterator operator--(int) noexcept
+      {
+        auto tmp{*this};
+        --index_;
+        return tmp;
+      }
+
+      /// @returns `true` if `*this == rhs`.
+      bool operator==(const Const_iterator& rhs) const noexcept
+      {
+        return (column_ == rhs.column_) && (index_ == rhs.index_);
+      }
+
+      /// @returns `true` if `*this != rhs`.
+      bool operator!=(const Const_iterator& rhs) const noexcept
+      {
+        return !(*this == rhs);
+      }
+
+    private:
+      friend Column;
+
+      const Column* column_{};
+      std::size_t index_{};
+
+      Const_iterator(const Column* const column,
+        const std::size_t index) noexcept
+        : column_{column}
+        , index_{index}
+      {
+        DMITIGR_ASSERT(column_);
+        DMITIGR_ASSERT(index_ <= column_->size());
+      }
+    };
+
+    /// @returns The number of rows in the column.
+    std::size_t size() const noexcept
+    {
+      return batch_->row_count();
+    }
+
+    /// @returns The index of the column in the batch.
+    std::size_t field() const noexcept
+    {
+      return field_;
+    }
+
+    /**
+     * @returns The field data of the specified row, or invalid instance if
+     * SQL NULL.
+     *
+     * @par Requires
+     * `row < size()`.
+     */
+    Data_view operator[](const std::size_t row) const
+    {
+      return batch_->data(row, field_);
+    }
+
+    /// @returns Iterator that points to the first row.
+    Const_iterator begin() const noexcept
+    {
+      return Const_iterator{this, 0};
+    }
+
+    /// @returns Iterator that points to an one-past-the-last row.
+    Const_iterator end() const noexcept
+    {
+      return Const_iterator{this, size()};
+    }
+
+  private:
+    friend Row_batch;
+
+    const Row_batch* batch_{};
+    std::size_t field_{};
+
+    Column(const Row_batch* const batch, const std::size_t field) noexcept
+      : batch_{batch}
+      , field_{field}
+    {
+      DMITIGR_ASSERT(batch_);
+      DMITIGR_ASSERT(field_ < batch_->field_count());
+    }
+  };
+
+private:
+  friend Connection;
+  friend Row_spool;
+
+  Row_info info_; // has pq_result_
+  int offset_{}; // the number of the first row of this batch in pq_result_
+  int row_count_{};
+
+  /// Constructs the batch of `row_count` rows starting from `offset`.
+  Row_batch(Row_info&& info, const int offset, const int row_count) noexcept
+    : info_{std::move(info)}
+    , offset_{offset}
+    , row_count_{row_count}
+  {
+    assert(is_invariant_ok());
+  }
+
+  bool is_invariant_ok() const noexcept;
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief Row_batch is swappable.
+ */
+inline void swap(Row_batch& lhs, Row_batch& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "row_batch.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_ROW_BATCH_HPP
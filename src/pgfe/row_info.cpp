@@ -16,20 +16,112 @@
 
 #include "exceptions.hpp"
 #include "row_info.hpp"
+#include "tuple.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 namespace dmitigr::pgfe {
 
-DMITIGR_PGFE_INLINE Row_info::Row_info(detail::pq::Result&& pq_result) noexcept
+namespace detail {
+
+DMITIGR_PGFE_INLINE std::size_t
+Field_name_index::find(const pq::Result& result, const std::string_view name,
+  const std::size_t offset) const
+{
+  if (!is_built_.load(std::memory_order_acquire)) {
+    const std::lock_guard lg{mutex_};
+    if (!is_built_.load(std::memory_order_relaxed)) {
+      build(result); // can throw
+      is_built_.store(true, std::memory_order_release);
+    }
+  }
+
+  const auto fc = static_cast<std::size_t>(result.field_count());
+  if (slots_.empty())
+    return fc;
+
+  const std::size_t mask{slots_.size() - 1};
+  for (std::size_t s{std::hash<std::string_view>{}(name) & mask};; s = (s + 1) & mask) {
+    const int slot{slots_[s]};
+    if (!slot)
+      return fc;
+
+    const int i{slot - 1};
+    if (result.field_name(i) == name) {
+      // The index contains the first occurrence of name only.
+      if (static_cast<std::size_t>(i) >= offset)
+        return static_cast<std::size_t>(i);
+      for (std::size_t j{offset}; j < fc; ++j) {
+        if (result.field_name(static_cast<int>(j)) == name)
+          return j;
+      }
+      return fc;
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE void Field_name_index::reset() noexcept
+{
+  is_built_.store(false, std::memory_order_relaxed);
+  slots_.clear();
+  names_.reset();
+}
+
+DMITIGR_PGFE_INLINE std::shared_ptr<const Tuple_field_names>
+Field_name_index::names(const pq::Result& result) const
+{
+  const std::lock_guard lg{mutex_};
+  if (!names_) {
+    const int fc{result.field_count()};
+    std::vector<std::string> names;
+    names.reserve(static_cast<std::size_t>(fc));
+    for (int i{}; i < fc; ++i)
+      names.emplace_back(result.field_name(i));
+    names_ = std::make_shared<Tuple_field_names>(std::move(names));
+  }
+  return names_;
+}
+
+DMITIGR_PGFE_INLINE void Field_name_index::build(const pq::Result& result) const
+{
+  const int fc{result.field_count()};
+  if (!fc)
+    return;
+
+  // The load factor is at most 0.5.
+  std::size_t size{2};
+  while (size < static_cast<std::size_t>(fc) * 2)
+    size *= 2;
+  slots_.assign(size, 0); // can throw
+  const std::size_t mask{size - 1};
+  for (int i{}; i < fc; ++i) {
+    const std::string_view name{result.field_name(i)};
+    for (std::size_t s{std::hash<std::string_view>{}(name) & mask};; s = (s + 1) & mask) {
+      int& slot = slots_[s];
+      if (!slot) {
+        slot = i + 1;
+        break;
+      } else if (result.field_name(slot - 1) == name)
+        break; // keep the first occurrence
+    }
+  }
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Row_info::Row_info(detail::pq::Result&& pq_result,
+  std::shared_ptr<const detail::Field_name_index> field_name_index) noexcept
   : pq_result_(std::move(pq_result))
+  , field_name_index_{std::move(field_name_index)}
 {}
 
 DMITIGR_PGFE_INLINE void Row_info::swap(Row_info& rhs) noexcept
 {
   using std::swap;
   swap(pq_result_, rhs.pq_result_);
+  swap(field_name_index_, rhs.field_name_index_);
 }
 
 DMITIGR_PGFE_INLINE bool Row_info::is_valid() const noexcept
@@ -62,6 +154,13 @@ Row_info::field_index(const std::string_view name,
   const std::size_t fc{field_count()};
   if (!(offset < fc))
     return fc;
+  if (field_name_index_) {
+    try {
+      return field_name_index_->find(pq_result_, name, offset);
+    } catch (...) {
+      // Fallback to the linear search.
+    }
+  }
   for (std::size_t i{offset}; i < fc; ++i) {
     const std::string_view nm{pq_result_.field_name(static_cast<int>(i))};
     if (nm == name)
@@ -70,6 +169,20 @@ Row_info::field_index(const std::string_view name,
   return fc;
 }
 
+DMITIGR_PGFE_INLINE std::shared_ptr<const detail::Tuple_field_names>
+Row_info::field_names() const
+{
+  if (field_name_index_)
+    return field_name_index_->names(pq_result_);
+
+  const std::size_t fc{field_count()};
+  std::vector<std::string> names;
+  names.reserve(fc);
+  for (std::size_t i{}; i < fc; ++i)
+    names.emplace_back(field_name(i));
+  return std::make_shared<detail::Tuple_field_names>(std::move(names));
+}
+
 DMITIGR_PGFE_INLINE std::uint_fast32_t
 Row_info::table_oid(const std::size_t index) const
 {
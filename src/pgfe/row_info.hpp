@@ -21,10 +21,59 @@
 #include "compositional.hpp"
 #include "pq.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace dmitigr::pgfe {
 
+namespace detail {
+
+class Tuple_field_names;
+
+/**
+ * @brief The hash index of the field names of the results which have the
+ * same description (for example, of the all results of a request).
+ *
+ * @details The index is built on the first lookup. Only the numbers of the
+ * fields are stored, so the index can be used with any of such results.
+ */
+class Field_name_index final {
+public:
+  /**
+   * @returns The index of the field `name` of `result` starting from `offset`,
+   * or `result.field_count()` if there is no such a field.
+   */
+  std::size_t find(const pq::Result& result, std::string_view name,
+    std::size_t offset) const;
+
+  /**
+   * @brief Resets the index to be used for other results.
+   *
+   * @par Requires
+   * The index is not used concurrently.
+   */
+  void reset() noexcept;
+
+  /**
+   * @returns The interned names of the fields of `result`, which are shared
+   * by the tuples made of the rows of all such results.
+   */
+  std::shared_ptr<const Tuple_field_names> names(const pq::Result& result) const;
+
+private:
+  mutable std::mutex mutex_;
+  mutable std::atomic<bool> is_built_{};
+  mutable std::vector<int> slots_; // field number + 1, or 0 if empty
+  mutable std::shared_ptr<const Tuple_field_names> names_;
+
+  void build(const pq::Result& result) const;
+};
+
+} // namespace detail
+
 /**
  * @ingroup main
  *
@@ -208,10 +257,16 @@ private:
   friend Connection;
   friend Prepared_statement;
   friend Row;
+  friend Row_batch;
+  friend Row_spool;
 
   detail::pq::Result pq_result_;
+  std::shared_ptr<const detail::Field_name_index> field_name_index_;
+
+  explicit DMITIGR_PGFE_API Row_info(detail::pq::Result&& pq_result,
+    std::shared_ptr<const detail::Field_name_index> field_name_index = {}) noexcept;
 
-  explicit DMITIGR_PGFE_API Row_info(detail::pq::Result&& pq_result) noexcept;
+  std::shared_ptr<const detail::Tuple_field_names> field_names() const;
 };
 
 /**
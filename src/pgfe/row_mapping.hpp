@@ -0,0 +1,254 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ROW_MAPPING_HPP
+#define DMITIGR_PGFE_ROW_MAPPING_HPP
+
+#include "column_decoder.hpp"
+#include "composite.hpp"
+#include "conversions_api.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "row_batch.hpp"
+#include "types_fwd.hpp"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A binding of a field of row to a data member of struct `T`.
+ *
+ * @see mapped_field().
+ */
+template<class T, typename M>
+struct Mapped_field final {
+  /// The type of the data member.
+  using Type = M;
+
+  /// The name of the field of row.
+  const char* name{};
+
+  /// The pointer to the data member.
+  M T::* member{};
+};
+
+/**
+ * @ingroup main
+ *
+ * @returns The binding of the field `name` to the data member `member`.
+ */
+template<class T, typename M>
+constexpr Mapped_field<T, M> mapped_field(const char* const name,
+  M T::* const member) noexcept
+{
+  return {name, member};
+}
+
+/**
+ * @ingroup main
+ *
+ * @brief The mapping of rows to the struct `T`.
+ *
+ * @details The specialization of this template must contain the static
+ * member `fields` of the tuple of bindings, for example:
+ * @code{cpp}
+ * struct Person final {
+ *   std::int64_t id{};
+ *   std::string name;
+ *   std::optional<std::string> email;
+ * };
+ *
+ * template<> struct pgfe::Row_mapping<Person> final {
+ *   static constexpr auto fields = std::make_tuple(
+ *     pgfe::mapped_field("id", &Person::id),
+ *     pgfe::mapped_field("name", &Person::name),
+ *     pgfe::mapped_field("email", &Person::email));
+ * };
+ * @endcode
+ * When the mapping is specialized, the callbacks which accept `T` can be
+ * passed to Connection::execute(), Connection::process_responses() etc:
+ * @code{cpp}
+ * conn.execute([](Person&& p){...}, "select id, name, email from person");
+ * @endcode
+ * The fields are converted by using Conversions.
+ *
+ * @see Row_mapper.
+ */
+template<class T>
+struct Row_mapping;
+
+/**
+ * @ingroup main
+ *
+ * @brief A converter of rows to the struct `T` according to Row_mapping.
+ *
+ * @details The indexes and the decoders (see Column_decoder) of the fields are
+ * resolved once by the first row passed to map(), so the instance must be used
+ * only with the rows of the same description (for example, with the rows of
+ * one request).
+ */
+template<class T>
+class Row_mapper final {
+public:
+  /// The mapping.
+  using Mapping = Row_mapping<T>;
+
+  /// The number of mapped fields.
+  static constexpr std::size_t field_count{
+    std::tuple_size_v<std::decay_t<decltype(Mapping::fields)>>};
+
+  /**
+   * @returns The value of `T` converted from `row`.
+   *
+   * @par Requires
+   * `row` has all the fields of the mapping.
+   *
+   * @throws Client_exception if the row has no mapped field.
+   */
+  T map(const Row& row) const
+  {
+    if (!is_resolved_)
+      resolve(row.info());
+
+    T result{};
+    map__([&row](const std::size_t index){return row.data(index);}, result,
+      std::make_index_sequence<field_count>{});
+    return result;
+  }
+
+  /**
+   * @returns The value of `T` converted from the row `row` of `batch`.
+   *
+   * @par Requires
+   * `row < batch.row_count()` and `batch` has all the fields of the mapping.
+   *
+   * @throws Client_exception if the batch has no mapped field.
+   */
+  T map(const Row_batch& batch, const std::size_t row) const
+  {
+    if (!is_resolved_)
+      resolve(batch.info());
+
+    T result{};
+    map__([&batch, row](const std::size_t index){return batch.data(row, index);},
+      result, std::make_index_sequence<field_count>{});
+    return result;
+  }
+
+  /// Resets the resolved indexes and decoders of the fields.
+  void reset() noexcept
+  {
+    is_resolved_ = false;
+  }
+
+private:
+  template<class> struct Decoders;
+  template<typename ... Fields>
+  struct Decoders<std::tuple<Fields...>> final {
+    using Type = std::tuple<Column_decoder<typename Fields::Type>...>;
+  };
+
+  mutable std::array<std::size_t, field_count> indexes_{};
+  mutable typename Decoders<std::decay_t<decltype(Mapping::fields)>>::Type
+    decoders_;
+  mutable bool is_resolved_{};
+
+  void resolve(const Row_info& info) const
+  {
+    resolve__(info, std::make_index_sequence<field_count>{});
+    is_resolved_ = true;
+  }
+
+  template<std::size_t ... I>
+  void resolve__(const Row_info& info, std::index_sequence<I...>) const
+  {
+    (resolve_field(info, indexes_[I], std::get<I>(decoders_),
+      std::get<I>(Mapping::fields).name), ...);
+  }
+
+  template<typename M>
+  static void resolve_field(const Row_info& info, std::size_t& index,
+    Column_decoder<M>& decoder, const char* const name)
+  {
+    index = info.field_index(name);
+    if (!(index < info.field_count()))
+      throw Client_exception{std::string{"cannot map row: no field "}
+        .append(name)};
+    decoder = Column_decoder<M>{info, index};
+  }
+
+  template<typename F, std::size_t ... I>
+  void map__(const F& data, T& result, std::index_sequence<I...>) const
+  {
+    (map_field(data, result, std::get<I>(decoders_), indexes_[I],
+      std::get<I>(Mapping::fields)), ...);
+  }
+
+  template<typename F, typename M>
+  static void map_field(const F& data, T& result,
+    const Column_decoder<M>& decoder, const std::size_t index,
+    const Mapped_field<T, M>& field)
+  {
+    result.*field.member = decoder(data(index));
+  }
+};
+
+namespace detail {
+
+template<class T, typename M>
+void map_composite_field(const Composite& composite, T& result,
+  const Mapped_field<T, M>& field)
+{
+  const auto index = composite.field_index(field.name);
+  if (!(index < composite.field_count()))
+    throw Client_exception{std::string{"cannot map composite: no field "}
+      .append(field.name)};
+  result.*field.member = to<M>(composite.data(index));
+}
+
+} // namespace detail
+
+/**
+ * @ingroup main
+ *
+ * @returns The value of `T` converted from `composite` according to
+ * Row_mapping, for example, from the Tuple decoded from the value of
+ * composite type by Type_catalog::to_tuple().
+ *
+ * @throws Client_exception if `composite` has no mapped field.
+ */
+template<class T>
+T map_composite(const Composite& composite)
+{
+  T result{};
+  std::apply([&composite, &result](const auto& ... fields)
+  {
+    (detail::map_composite_field(composite, result, fields), ...);
+  }, Row_mapping<T>::fields);
+  return result;
+}
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_ROW_MAPPING_HPP
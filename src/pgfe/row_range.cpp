@@ -0,0 +1,125 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "row_range.hpp"
+
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Row_range::Row_range(Connection& connection) noexcept
+  : connection_{&connection}
+{}
+
+DMITIGR_PGFE_INLINE Row_range::~Row_range()
+{
+  close();
+}
+
+DMITIGR_PGFE_INLINE Row_range::Row_range(Row_range&& rhs) noexcept
+  : connection_{rhs.connection_}
+  , row_{std::move(rhs.row_)}
+  , completion_{std::move(rhs.completion_)}
+  , is_started_{rhs.is_started_}
+  , is_exhausted_{rhs.is_exhausted_}
+{
+  rhs.connection_ = nullptr;
+}
+
+DMITIGR_PGFE_INLINE Row_range& Row_range::operator=(Row_range&& rhs) noexcept
+{
+  if (this != &rhs) {
+    Row_range tmp{std::move(rhs)};
+    swap(tmp);
+  }
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE void Row_range::swap(Row_range& rhs) noexcept
+{
+  using std::swap;
+  swap(connection_, rhs.connection_);
+  swap(row_, rhs.row_);
+  swap(completion_, rhs.completion_);
+  swap(is_started_, rhs.is_started_);
+  swap(is_exhausted_, rhs.is_exhausted_);
+}
+
+DMITIGR_PGFE_INLINE auto Row_range::begin() -> Iterator
+{
+  if (!is_started_) {
+    is_started_ = true;
+    fetch();
+  }
+  return Iterator{this};
+}
+
+DMITIGR_PGFE_INLINE bool Row_range::is_exhausted() const noexcept
+{
+  return is_exhausted_;
+}
+
+DMITIGR_PGFE_INLINE const Completion& Row_range::completion() const noexcept
+{
+  return completion_;
+}
+
+DMITIGR_PGFE_INLINE void Row_range::fetch()
+{
+  if (!connection_)
+    throw Client_exception{"cannot fetch row of range: range is moved"};
+  else if (is_exhausted_)
+    throw Client_exception{"cannot fetch row of range: range is exhausted"};
+
+  row_ = {};
+  try {
+    connection_->wait_response_throw();
+  } catch (const Server_exception&) {
+    // The request is completed by the error.
+    is_exhausted_ = true;
+    throw;
+  }
+  if (!(row_ = connection_->row())) {
+    completion_ = connection_->completion();
+    is_exhausted_ = true;
+  }
+}
+
+DMITIGR_PGFE_INLINE void Row_range::close() noexcept
+{
+  if (!connection_ || is_exhausted_)
+    return;
+
+  auto& conn = *connection_;
+  is_exhausted_ = true;
+  row_ = {};
+  try {
+    if (!conn.is_connected() || !conn.has_uncompleted_request())
+      return;
+    conn.cancel_request_nio();
+    while (conn.wait_response()) {
+      if (!conn.error() && !conn.row())
+        conn.completion();
+    }
+  } catch (...) {
+    // The connection is closed since its state is unknown.
+    conn.disconnect();
+  }
+}
+
+} // namespace dmitigr::pgfe
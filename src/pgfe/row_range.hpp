@@ -0,0 +1,221 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ROW_RANGE_HPP
+#define DMITIGR_PGFE_ROW_RANGE_HPP
+
+#include "../base/assert.hpp"
+#include "completion.hpp"
+#include "dll.hpp"
+#include "row.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A lazy input range of the rows of the response.
+ *
+ * @details The next row is retrieved only when the iterator is incremented,
+ * so the socket isn't read until the next row is needed, and the server is
+ * naturally throttled by the consumer. The range models the input range, so
+ * it's composable with the range adaptors, for example:
+ * @code
+ * for (auto&& row : conn.rows("select generate_series(1, $1)", 1000000)
+ *     | std::views::filter([](const auto& row){return to<int>(row[0]) % 2;})
+ *     | std::views::take(10))
+ *   std::cout << to<int>(row[0]) << std::endl;
+ * @endcode
+ *
+ * If the range is destroyed before all the rows are retrieved, the processing
+ * of the command is canceled and the rest of the response is discarded.
+ *
+ * @remarks The connection isn't ready for requests until the range is either
+ * exhausted or destroyed.
+ *
+ * @see Connection::rows().
+ */
+class Row_range final {
+public:
+  /// The sentinel which denotes the end of the range.
+  struct Sentinel final {};
+
+  /// An input iterator over the rows of the range.
+  class Iterator final {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+    using reference = Row&;
+    using pointer = Row*;
+
+    /// Constructs the iterator which equals to the end iterator.
+    Iterator() = default;
+
+    /// @returns The current row.
+    reference operator*() const noexcept
+    {
+      DMITIGR_ASSERT(range_);
+      return range_->row_;
+    }
+
+    /// @returns The pointer to the current row.
+    pointer operator->() const noexcept
+    {
+      return &**this;
+    }
+
+    /// Retrieves the next row.
+    Iterator& operator++()
+    {
+      DMITIGR_ASSERT(range_);
+      range_->fetch();
+      return *this;
+    }
+
+    /// Retrieves the next row.
+    void operator++(int)
+    {
+      ++*this;
+    }
+
+    /// @returns `true` if both iterators are at the end, or neither.
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return lhs.is_end() == rhs.is_end();
+    }
+
+    /// @returns `!(lhs == rhs)`.
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return !(lhs == rhs);
+    }
+
+    /// @returns `true` if the iterator is at the end.
+    friend bool operator==(const Iterator& lhs, Sentinel) noexcept
+    {
+      return lhs.is_end();
+    }
+
+    /// @returns `true` if the iterator is at the end.
+    friend bool operator==(Sentinel, const Iterator& rhs) noexcept
+    {
+      return rhs.is_end();
+    }
+
+    /// @returns `true` if the iterator is not at the end.
+    friend bool operator!=(const Iterator& lhs, Sentinel) noexcept
+    {
+      return !lhs.is_end();
+    }
+
+    /// @returns `true` if the iterator is not at the end.
+    friend bool operator!=(Sentinel, const Iterator& rhs) noexcept
+    {
+      return !rhs.is_end();
+    }
+
+  private:
+    friend Row_range;
+
+    Row_range* range_{};
+
+    explicit Iterator(Row_range* const range) noexcept
+      : range_{range}
+    {}
+
+    bool is_end() const noexcept
+    {
+      return !range_ || range_->is_exhausted_;
+    }
+  };
+
+  /// Completes the request as described in the class details.
+  DMITIGR_PGFE_API ~Row_range();
+
+  /// Not copy-constructible.
+  Row_range(const Row_range&) = delete;
+
+  /// Not copy-assignable.
+  Row_range& operator=(const Row_range&) = delete;
+
+  /**
+   * @brief Move-constructible.
+   *
+   * @remarks The iterators of `rhs` are invalidated.
+   */
+  DMITIGR_PGFE_API Row_range(Row_range&& rhs) noexcept;
+
+  /**
+   * @brief Move-assignable.
+   *
+   * @remarks The iterators of both `*this` and `rhs` are invalidated.
+   */
+  DMITIGR_PGFE_API Row_range& operator=(Row_range&& rhs) noexcept;
+
+  /// Swaps this instance with `rhs`.
+  DMITIGR_PGFE_API void swap(Row_range& rhs) noexcept;
+
+  /**
+   * @returns The iterator to the current row. The first row is retrieved by
+   * the first call.
+   *
+   * @throws Server_exception on the error response.
+   */
+  DMITIGR_PGFE_API Iterator begin();
+
+  /// @returns The end sentinel.
+  Sentinel end() const noexcept
+  {
+    return Sentinel{};
+  }
+
+  /// @returns `true` if all the rows are retrieved.
+  DMITIGR_PGFE_API bool is_exhausted() const noexcept;
+
+  /**
+   * @returns The completion of the request if the range is exhausted without
+   * an error, or invalid instance otherwise.
+   */
+  DMITIGR_PGFE_API const Completion& completion() const noexcept;
+
+private:
+  friend Connection;
+
+  Connection* connection_{};
+  Row row_;
+  Completion completion_;
+  bool is_started_{};
+  bool is_exhausted_{};
+
+  explicit Row_range(Connection& connection) noexcept;
+  void fetch();
+  void close() noexcept;
+};
+
+/// Row_range is swappable.
+inline void swap(Row_range& lhs, Row_range& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_ROW_RANGE_HPP
@@ -0,0 +1,314 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../os/pid.hpp"
+#include "exceptions.hpp"
+#include "row.hpp"
+#include "row_batch.hpp"
+#include "row_spool.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+/*
+ * Each row is stored as the header of `field_count` entries of type
+ * `std::uint32_t` followed by the data of the fields. Each entry is the offset
+ * of the end of the data of the corresponding field relative to the end of the
+ * header, with the highest bit set if the field is SQL NULL. The data of each
+ * non-NULL field is followed by zero byte.
+ */
+constexpr std::uint32_t spool_null_bit{0x80000000};
+constexpr std::uint32_t spool_max_row_size{spool_null_bit - 1};
+
+inline std::uint32_t spool_entry(const char* const header,
+  const std::size_t field) noexcept
+{
+  std::uint32_t result;
+  std::memcpy(&result, header + field * sizeof(result), sizeof(result));
+  return result;
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Row_spool::Row_spool(const std::size_t memory_limit,
+  std::filesystem::path directory)
+  : memory_limit_{memory_limit}
+  , directory_{std::move(directory)}
+{
+  if (!memory_limit_)
+    throw Client_exception{"cannot create row spool: invalid memory limit"};
+  if (directory_.empty())
+    directory_ = std::filesystem::temp_directory_path();
+}
+
+DMITIGR_PGFE_INLINE Row_spool::~Row_spool()
+{
+  clear();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Row_spool::memory_limit() const noexcept
+{
+  return memory_limit_;
+}
+
+DMITIGR_PGFE_INLINE const std::filesystem::path&
+Row_spool::directory() const noexcept
+{
+  return directory_;
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::append(const Row_batch& batch)
+{
+  if (is_sealed_)
+    throw Client_exception{"cannot append rows to sealed row spool"};
+  else if (!batch)
+    throw Client_exception{"cannot append invalid row batch to row spool"};
+
+  init_info__(batch.info());
+  const std::size_t row_count{batch.row_count()};
+  for (std::size_t i{}; i < row_count; ++i) {
+    append_row__([&batch, i](const std::size_t field)
+    {
+      return batch.data(i, field);
+    });
+  }
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::append(const Row& row)
+{
+  if (is_sealed_)
+    throw Client_exception{"cannot append row to sealed row spool"};
+  else if (!row)
+    throw Client_exception{"cannot append invalid row to row spool"};
+
+  init_info__(row.info());
+  append_row__([&row](const std::size_t field)
+  {
+    return row.data(field);
+  });
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::seal()
+{
+  if (is_sealed_)
+    return;
+
+  if (file_) {
+    spill__();
+    const bool is_closed{!std::fclose(file_.release())};
+    if (!is_closed)
+      throw Client_exception{"cannot write row spool file "
+        + path_.string()};
+    buffer_ = std::string{}; // release the memory
+    try {
+      mapping_ = fsx::Mapped_file{path_};
+    } catch (const std::exception& e) {
+      throw Client_exception{std::string{"cannot map row spool file: "}
+        + e.what()};
+    }
+    mapping_.advise(fsx::Mapped_file_advice::random);
+  }
+  is_sealed_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Row_spool::is_sealed() const noexcept
+{
+  return is_sealed_;
+}
+
+DMITIGR_PGFE_INLINE bool Row_spool::is_spilled() const noexcept
+{
+  return !path_.empty();
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::clear() noexcept
+{
+  mapping_.close();
+  file_.reset();
+  if (!path_.empty()) {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+    path_.clear();
+  }
+  is_sealed_ = false;
+  info_ = Row_info{};
+  row_offsets_.clear();
+  spilled_size_ = 0;
+  buffer_.clear();
+}
+
+DMITIGR_PGFE_INLINE const Row_info& Row_spool::info() const noexcept
+{
+  return info_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Row_spool::row_count() const noexcept
+{
+  return row_offsets_.size();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Row_spool::field_count() const noexcept
+{
+  return info_ ? info_.field_count() : 0;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Row_spool::byte_count() const noexcept
+{
+  return spilled_size_ + buffer_.size();
+}
+
+DMITIGR_PGFE_INLINE Data_view
+Row_spool::data(const std::size_t row, const std::size_t field) const
+{
+  if (!is_sealed_)
+    throw Client_exception{"cannot get field data of unsealed row spool"};
+  else if (!(row < row_count()))
+    throw Client_exception{"cannot get field data of row spool: invalid row"};
+  else if (!(field < field_count()))
+    throw Client_exception{"cannot get field data of row spool: invalid field"};
+
+  const char* const header{row__(row)};
+  const auto end = detail::spool_entry(header, field);
+  if (end & detail::spool_null_bit)
+    return Data_view{};
+
+  const auto begin = field ? detail::spool_entry(header, field - 1) &
+    detail::spool_max_row_size : 0;
+  const char* const data{header + field_count() * sizeof(std::uint32_t)};
+  return Data_view{data + begin, end - begin - 1, info_.data_format(field)};
+}
+
+DMITIGR_PGFE_INLINE Row_batch
+Row_spool::batch(const std::size_t offset, const std::size_t count) const
+{
+  if (!is_sealed_)
+    throw Client_exception{"cannot get row batch of unsealed row spool"};
+  else if (!(count && offset + count <= row_count()))
+    throw Client_exception{"cannot get row batch of row spool: invalid range"};
+  else if (count > static_cast<std::size_t>(INT_MAX))
+    throw Client_exception{"cannot get row batch of row spool: too many rows"};
+
+  detail::pq::Result result{PQcopyResult(info_.pq_result_.native_handle(),
+      PG_COPYRES_ATTRS)};
+  if (!result)
+    throw std::bad_alloc{};
+
+  const std::size_t fld_count{field_count()};
+  for (std::size_t i{}; i < count; ++i) {
+    for (std::size_t j{}; j < fld_count; ++j) {
+      const auto d = data(offset + i, j);
+      if (!result.set_data_value(static_cast<int>(i), static_cast<int>(j),
+          static_cast<const char*>(d.bytes()),
+          d ? static_cast<int>(d.size()) : -1))
+        throw std::bad_alloc{};
+    }
+  }
+  return Row_batch{Row_info{std::move(result), info_.field_name_index_}, 0,
+    static_cast<int>(count)};
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::init_info__(const Row_info& info)
+{
+  if (info_) {
+    const std::size_t count{info_.field_count()};
+    bool is_same{info.field_count() == count};
+    for (std::size_t i{}; is_same && i < count; ++i)
+      is_same = info.data_format(i) == info_.data_format(i);
+    if (!is_same)
+      throw Client_exception{"cannot append rows to row spool: "
+        "fields mismatch the fields of the rows appended before"};
+    return;
+  }
+
+  // The copy without rows, so the rows of `info` are not retained.
+  detail::pq::Result result{PQcopyResult(info.pq_result_.native_handle(),
+      PG_COPYRES_ATTRS)};
+  if (!result)
+    throw std::bad_alloc{};
+  info_ = Row_info{std::move(result), info.field_name_index_};
+}
+
+template<typename F>
+void Row_spool::append_row__(F&& field_data)
+{
+  using detail::spool_max_row_size;
+  using detail::spool_null_bit;
+
+  const std::size_t fld_count{info_.field_count()};
+  const std::size_t offset{buffer_.size()};
+  try {
+    buffer_.resize(offset + fld_count * sizeof(std::uint32_t));
+    std::size_t end{};
+    for (std::size_t i{}; i < fld_count; ++i) {
+      std::uint32_t entry;
+      if (const Data_view data = field_data(i)) {
+        end += data.size() + 1;
+        if (end > spool_max_row_size)
+          throw Client_exception{"cannot append row to row spool: "
+            "row is too large"};
+        buffer_.append(static_cast<const char*>(data.bytes()), data.size())
+          .push_back('\0');
+        entry = static_cast<std::uint32_t>(end);
+      } else
+        entry = static_cast<std::uint32_t>(end) | spool_null_bit;
+      std::memcpy(buffer_.data() + offset + i * sizeof(entry), &entry,
+        sizeof(entry));
+    }
+    row_offsets_.push_back(spilled_size_ + offset);
+  } catch (...) {
+    buffer_.resize(offset); // rollback
+    throw;
+  }
+
+  if (buffer_.size() >= memory_limit_)
+    spill__();
+}
+
+DMITIGR_PGFE_INLINE void Row_spool::spill__()
+{
+  if (!file_) {
+    static std::atomic_uint_fast64_t file_count;
+    auto path = directory_ / ("pgfe-spool-" + std::to_string(os::pid()) + "-"
+      + std::to_string(++file_count));
+    // The exclusive mode prevents the use of the file created by someone else.
+    file_.reset(std::fopen(path.string().c_str(), "wbx"));
+    if (!file_)
+      throw Client_exception{"cannot create row spool file " + path.string()};
+    path_ = std::move(path);
+  }
+
+  if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_.get())
+    != buffer_.size())
+    throw Client_exception{"cannot write row spool file " + path_.string()};
+  spilled_size_ += buffer_.size();
+  buffer_.clear();
+}
+
+DMITIGR_PGFE_INLINE const char*
+Row_spool::row__(const std::size_t row) const noexcept
+{
+  const auto offset = static_cast<std::size_t>(row_offsets_[row]);
+  return (is_spilled() ? mapping_.data() : buffer_.data()) + offset;
+}
+
+} // namespace dmitigr::pgfe
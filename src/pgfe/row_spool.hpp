@@ -0,0 +1,260 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_ROW_SPOOL_HPP
+#define DMITIGR_PGFE_ROW_SPOOL_HPP
+
+#include "../fsx/mapped_file.hpp"
+#include "connection.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "row_info.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A storage of the rows of a result which is spilled to a temporary
+ * file when it exceeds the memory limit.
+ *
+ * @details The rows are copied in the compact binary form. Until the size of
+ * the rows reaches memory_limit() they are kept in the memory, and after that
+ * they are written to the temporary file, which is memory-mapped by seal(),
+ * so the rows of the result which doesn't fit in the memory can still be
+ * accessed randomly (for example, to be sorted or to generate a report), and
+ * the pages of the file are loaded and evicted by the operating system as
+ * needed:
+ * @code
+ * Row_spool spool{256 * 1024 * 1024};
+ * spool.execute(conn, "select id, name from item");
+ * spool.seal();
+ * const std::size_t count{spool.row_count()};
+ * for (std::size_t i{}; i < count; i += 4096)
+ *   writer.write(spool.batch(i, std::min<std::size_t>(4096, count - i)));
+ * @endcode
+ *
+ * The rows are provided as instances of Row_batch, so the code which processes
+ * the batches of rows (Column_decoder, Json_row_writer, Csv_writer etc) can
+ * process the spooled rows as is. The field data can also be accessed without
+ * copying by data().
+ *
+ * The index of rows (8 bytes per row) is always kept in the memory. The
+ * temporary file is removed by clear() or upon destruction.
+ *
+ * @see Row_batch.
+ */
+class Row_spool final {
+public:
+  /// The default memory limit.
+  static constexpr std::size_t default_memory_limit{64 * 1024 * 1024};
+
+  /**
+   * @brief The constructor.
+   *
+   * @param memory_limit The size of the rows kept in the memory.
+   * @param directory The directory of the temporary file, or empty path to
+   * use `std::filesystem::temp_directory_path()`.
+   *
+   * @par Requires
+   * `memory_limit`.
+   */
+  DMITIGR_PGFE_API explicit Row_spool(
+    std::size_t memory_limit = default_memory_limit,
+    std::filesystem::path directory = {});
+
+  /// Removes the temporary file.
+  DMITIGR_PGFE_API ~Row_spool();
+
+  /// Not copy-constructible.
+  Row_spool(const Row_spool&) = delete;
+
+  /// Not copy-assignable.
+  Row_spool& operator=(const Row_spool&) = delete;
+
+  /// Not move-constructible.
+  Row_spool(Row_spool&&) = delete;
+
+  /// Not move-assignable.
+  Row_spool& operator=(Row_spool&&) = delete;
+
+  /// @returns The memory limit.
+  DMITIGR_PGFE_API std::size_t memory_limit() const noexcept;
+
+  /// @returns The directory of the temporary file.
+  DMITIGR_PGFE_API const std::filesystem::path& directory() const noexcept;
+
+  /**
+   * @brief Appends the rows of `batch`.
+   *
+   * @par Requires
+   * `!is_sealed() && batch`, and the fields of `batch` must be the same (in
+   * number and in data format) as of the rows appended before.
+   *
+   * @par Exception safety guarantee
+   * Basic. (The spool must be cleared if an exception is thrown.)
+   */
+  DMITIGR_PGFE_API void append(const Row_batch& batch);
+
+  /// @overload
+  DMITIGR_PGFE_API void append(const Row& row);
+
+  /**
+   * @brief Executes the `statement` on `conn` and appends the rows of the
+   * result.
+   *
+   * @details The rows are retrieved in Row_delivery_mode::chunked mode if it's
+   * available, or in Row_delivery_mode::single mode otherwise, since libpq
+   * accumulates the result of Row_delivery_mode::full mode in the memory.
+   *
+   * @par Requires
+   * See append() and Connection::execute().
+   *
+   * @par Exception safety guarantee
+   * Basic.
+   */
+  template<typename ... Types>
+  Completion execute(Connection& conn, const Statement& statement,
+    Types&& ... parameters)
+  {
+    const auto row_delivery_mode = conn.row_delivery_mode();
+#ifdef LIBPQ_HAS_CHUNK_MODE
+    conn.set_row_delivery_mode(Row_delivery_mode::chunked);
+#else
+    conn.set_row_delivery_mode(Row_delivery_mode::single);
+#endif
+    try {
+      auto result = conn.execute([this](Row_batch&& batch)
+      {
+        append(batch);
+      }, statement, std::forward<Types>(parameters)...);
+      conn.set_row_delivery_mode(row_delivery_mode);
+      return result;
+    } catch (...) {
+      conn.set_row_delivery_mode(row_delivery_mode);
+      throw;
+    }
+  }
+
+  /**
+   * @brief Completes the appending, and maps the temporary file into the
+   * memory if the rows are spilled.
+   *
+   * @details The rows which are kept in the memory are written to the file
+   * before mapping, so the whole spilled result is accessed through the
+   * mapping. The behaviour is no-op if `is_sealed()`.
+   *
+   * @par Effects
+   * `is_sealed()`.
+   *
+   * @throws Client_exception if the file cannot be written or mapped.
+   */
+  DMITIGR_PGFE_API void seal();
+
+  /// @returns `true` if the appending is completed.
+  DMITIGR_PGFE_API bool is_sealed() const noexcept;
+
+  /// @returns `true` if the rows are spilled to the temporary file.
+  DMITIGR_PGFE_API bool is_spilled() const noexcept;
+
+  /**
+   * @brief Removes all the rows and the temporary file.
+   *
+   * @par Effects
+   * `!is_sealed() && !is_spilled() && !row_count() && !info()`.
+   */
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /**
+   * @returns The information about the rows, or invalid instance if no rows
+   * are appended.
+   */
+  DMITIGR_PGFE_API const Row_info& info() const noexcept;
+
+  /// @returns The number of rows.
+  DMITIGR_PGFE_API std::size_t row_count() const noexcept;
+
+  /// @returns The number of fields of each row.
+  DMITIGR_PGFE_API std::size_t field_count() const noexcept;
+
+  /// @returns The total size of the rows in the compact binary form.
+  DMITIGR_PGFE_API std::uint64_t byte_count() const noexcept;
+
+  /**
+   * @returns The field data of the specified row, or invalid instance if SQL
+   * NULL. The data of Data_format::text format is zero-terminated (as the data
+   * of Row_batch).
+   *
+   * @par Requires
+   * `is_sealed() && row < row_count() && field < field_count()`.
+   *
+   * @remarks The data refers to the memory of this instance and is valid
+   * until clear() is called or this instance is destroyed.
+   */
+  DMITIGR_PGFE_API Data_view data(std::size_t row, std::size_t field) const;
+
+  /**
+   * @returns The batch of the copies of `count` rows starting from `offset`.
+   *
+   * @par Requires
+   * `is_sealed() && count && offset + count <= row_count()`.
+   *
+   * @remarks The batch doesn't refer to this instance.
+   */
+  DMITIGR_PGFE_API Row_batch batch(std::size_t offset, std::size_t count) const;
+
+private:
+  struct File_deleter final {
+    void operator()(std::FILE* const file) const noexcept
+    {
+      std::fclose(file);
+    }
+  };
+
+  std::size_t memory_limit_{};
+  std::filesystem::path directory_;
+  std::filesystem::path path_; // the path of the temporary file
+  std::unique_ptr<std::FILE, File_deleter> file_;
+  fsx::Mapped_file mapping_;
+  bool is_sealed_{};
+  Row_info info_; // without rows
+  std::vector<std::uint64_t> row_offsets_;
+  std::uint64_t spilled_size_{}; // the size of the rows written to the file
+  std::string buffer_; // the rows which are not written to the file
+
+  void init_info__(const Row_info& info);
+  template<typename F> void append_row__(F&& field_data);
+  void spill__();
+  const char* row__(std::size_t row) const noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "row_spool.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_ROW_SPOOL_HPP
@@ -0,0 +1,240 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "shard_routing_pool.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Shard_routing_pool::Shard_routing_pool(const std::size_t size,
+  const std::vector<Connection_options>& shards_options,
+  const Routing routing, Hasher hasher)
+  : routing_{routing}
+  , hasher_{std::move(hasher)}
+{
+  if (shards_options.empty())
+    throw Client_exception{"cannot create shard routing pool: no shards"};
+
+  shards_.reserve(shards_options.size());
+  for (const auto& options : shards_options)
+    shards_.emplace_back().pool_ = std::make_unique<Connection_pool>(size,
+      options);
+
+  if (routing_ == Routing::ring) {
+    ring_.reserve(shards_.size() * virtual_node_count);
+    for (std::size_t i{}; i < shards_.size(); ++i) {
+      for (std::size_t j{}; j < virtual_node_count; ++j) {
+        const auto point = "shard-" + std::to_string(i) + '-' +
+          std::to_string(j);
+        ring_.emplace_back(default_hash(point), i);
+      }
+    }
+    std::sort(ring_.begin(), ring_.end());
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Shard_routing_pool::is_valid() const noexcept
+{
+  return !shards_.empty();
+}
+
+DMITIGR_PGFE_INLINE std::size_t Shard_routing_pool::shard_count() const noexcept
+{
+  return shards_.size();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Shard_routing_pool::shard(const std::size_t index)
+{
+  return const_cast<Connection_pool&>(
+    static_cast<const Shard_routing_pool*>(this)->shard(index));
+}
+
+DMITIGR_PGFE_INLINE const Connection_pool&
+Shard_routing_pool::shard(const std::size_t index) const
+{
+  if (!(index < shard_count()))
+    throw Client_exception{"cannot get shard of shard routing pool: "
+      "invalid index"};
+  return *shards_[index].pool_;
+}
+
+DMITIGR_PGFE_INLINE auto Shard_routing_pool::routing() const noexcept -> Routing
+{
+  return routing_;
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t
+Shard_routing_pool::default_hash(const std::string_view key) noexcept
+{
+  // FNV-1a.
+  std::uint64_t result{0xcbf29ce484222325};
+  for (const char c : key) {
+    result ^= static_cast<unsigned char>(c);
+    result *= 0x100000001b3;
+  }
+
+  // The finalizer of SplitMix64 to spread the close hashes.
+  result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9;
+  result = (result ^ (result >> 27)) * 0x94d049bb133111eb;
+  return result ^ (result >> 31);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Shard_routing_pool::shard_index(const std::string_view key) const
+{
+  return shard_index_by_hash(hasher_ ? hasher_(key) : default_hash(key));
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Shard_routing_pool::shard_index_by_hash(const std::uint64_t hash) const
+{
+  if (!is_valid())
+    throw Client_exception{"cannot get shard index of invalid shard routing "
+      "pool"};
+
+  if (routing_ == Routing::modulo)
+    return static_cast<std::size_t>(hash % shards_.size());
+
+  // The first point of the ring which follows the hash clockwise.
+  DMITIGR_ASSERT(!ring_.empty());
+  const auto i = std::upper_bound(ring_.cbegin(), ring_.cend(), hash,
+    [](const std::uint64_t value, const auto& point)
+    {
+      return value < point.first;
+    });
+  return (i != ring_.cend() ? i : ring_.cbegin())->second;
+}
+
+DMITIGR_PGFE_INLINE void Shard_routing_pool::connect()
+{
+  for (auto& shard : shards_)
+    shard.pool_->connect();
+}
+
+DMITIGR_PGFE_INLINE void Shard_routing_pool::disconnect() noexcept
+{
+  for (auto& shard : shards_)
+    shard.pool_->disconnect();
+}
+
+DMITIGR_PGFE_INLINE bool Shard_routing_pool::is_connected() const noexcept
+{
+  return is_valid() && std::all_of(shards_.cbegin(), shards_.cend(),
+    [](const auto& shard){return shard.pool_->is_connected();});
+}
+
+DMITIGR_PGFE_INLINE auto
+Shard_routing_pool::try_connection(const std::string_view key) -> Handle
+{
+  return route(key).try_connection();
+}
+
+DMITIGR_PGFE_INLINE auto
+Shard_routing_pool::connection(const std::string_view key,
+  const std::optional<std::chrono::milliseconds> timeout) -> Handle
+{
+  return route(key).connection(timeout);
+}
+
+DMITIGR_PGFE_INLINE auto
+Shard_routing_pool::metrics(const std::size_t index) const -> Shard_metrics
+{
+  if (!(index < shard_count()))
+    throw Client_exception{"cannot get metrics of shard of shard routing "
+      "pool: invalid index"};
+
+  const auto& shard = shards_[index];
+  Shard_metrics result;
+  {
+    const std::lock_guard lg{mutex_};
+    result.route_count = shard.route_count_;
+    result.scatter_count = shard.scatter_count_;
+    result.scatter_error_count = shard.scatter_error_count_;
+    result.scatter_time = shard.scatter_time_;
+  }
+  result.pool = shard.pool_->metrics();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Shard_routing_pool::reset_metrics() noexcept
+{
+  {
+    const std::lock_guard lg{mutex_};
+    for (auto& shard : shards_) {
+      shard.route_count_ = 0;
+      shard.scatter_count_ = 0;
+      shard.scatter_error_count_ = 0;
+      shard.scatter_time_.reset();
+    }
+  }
+  for (auto& shard : shards_)
+    shard.pool_->reset_metrics();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Shard_routing_pool::route(const std::string_view key)
+{
+  auto& shard = shards_[shard_index(key)];
+  {
+    const std::lock_guard lg{mutex_};
+    ++shard.route_count_;
+  }
+  return *shard.pool_;
+}
+
+DMITIGR_PGFE_INLINE auto Shard_routing_pool::connections__()
+  -> std::vector<Handle>
+{
+  if (!is_connected())
+    throw Client_exception{"cannot execute on all shards of shard routing "
+      "pool: not connected"};
+
+  std::vector<Handle> result;
+  result.reserve(shards_.size());
+  for (auto& shard : shards_) {
+    auto handle = shard.pool_->connection(std::nullopt);
+    if (!handle)
+      throw Client_exception{"cannot execute on all shards of shard routing "
+        "pool: no connection"};
+    result.push_back(std::move(handle));
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Shard_routing_pool::record_scatter__(
+  const std::vector<std::exception_ptr>& errors,
+  const std::vector<std::chrono::nanoseconds>& times) noexcept
+{
+  DMITIGR_ASSERT(errors.size() == shards_.size());
+  DMITIGR_ASSERT(times.size() == shards_.size());
+  const std::lock_guard lg{mutex_};
+  for (std::size_t i{}; i < shards_.size(); ++i) {
+    auto& shard = shards_[i];
+    ++shard.scatter_count_;
+    if (errors[i])
+      ++shard.scatter_error_count_;
+    else
+      shard.scatter_time_.record(times[i]);
+  }
+}
+
+} // namespace dmitigr::pgfe
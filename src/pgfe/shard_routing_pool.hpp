@@ -0,0 +1,335 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SHARD_ROUTING_POOL_HPP
+#define DMITIGR_PGFE_SHARD_ROUTING_POOL_HPP
+
+#include "completion.hpp"
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "metrics.hpp"
+#include "row.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe pool of connections to the shards of the manually
+ * sharded database.
+ *
+ * @details The pool consists of the pools of each shard. The connections are
+ * acquired from the shard selected by the hash of the key according to the
+ * routing:
+ *   - Routing::modulo - the shard is `hash % shard_count()`;
+ *   - Routing::ring - the shard is selected by the consistent hashing ring
+ *   with virtual_node_count() points per shard, so the keys are mostly kept
+ *   on their shards when the set of shards changes.
+ *
+ * The statement can be executed on all the shards at once by
+ * execute_on_all(). For example:
+ * @code
+ * pgfe::Shard_routing_pool pool{4, shards_options};
+ * pool.connect();
+ * pool.connection(user_id, std::nullopt)->execute("insert ...");
+ * pool.execute_on_all([](std::size_t shard, pgfe::Row&& row)
+ * {
+ *   // ...
+ * }, "select count(*) from users");
+ * @endcode
+ *
+ * @remarks All the functions are thread-safe, except the constructor and
+ * the destructor.
+ *
+ * @see Connection_pool.
+ */
+class Shard_routing_pool final {
+public:
+  /// A connection handle.
+  using Handle = Connection_pool::Handle;
+
+  /// The hash function of the keys.
+  using Hasher = std::function<std::uint64_t(std::string_view key)>;
+
+  /// The routing of the keys to the shards.
+  enum class Routing {
+    /// The shard index is the remainder of division of the hash.
+    modulo,
+
+    /// The shard is selected by the consistent hashing ring.
+    ring
+  };
+
+  /// The number of points of each shard on the consistent hashing ring.
+  static constexpr std::size_t virtual_node_count{160};
+
+  /// The metrics of the shard.
+  struct Shard_metrics final {
+    /// The number of connections acquired by key.
+    std::uint_least64_t route_count{};
+
+    /// The number of executions by execute_on_all().
+    std::uint_least64_t scatter_count{};
+
+    /// The number of failed executions by execute_on_all().
+    std::uint_least64_t scatter_error_count{};
+
+    /// The time of the executions by execute_on_all() (until completion).
+    Duration_histogram scatter_time;
+
+    /// The metrics of the pool of the shard (see Connection_pool::metrics()).
+    Connection_pool::Metrics pool;
+  };
+
+  /// Default-constructible. (Constructs invalid instance.)
+  Shard_routing_pool() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param size A number of connections in the pool of each shard.
+   * @param shards_options A connection options of the shards.
+   * @param routing The routing of the keys.
+   * @param hasher The hash function of the keys. The empty function means
+   * default_hash().
+   *
+   * @par Requires
+   * `!shards_options.empty()`.
+   */
+  DMITIGR_PGFE_API Shard_routing_pool(std::size_t size,
+    const std::vector<Connection_options>& shards_options,
+    Routing routing = Routing::modulo, Hasher hasher = {});
+
+  /// Not copy-constructible.
+  Shard_routing_pool(const Shard_routing_pool&) = delete;
+
+  /// Not copy-assignable.
+  Shard_routing_pool& operator=(const Shard_routing_pool&) = delete;
+
+  /// Not move-constructible.
+  Shard_routing_pool(Shard_routing_pool&&) = delete;
+
+  /// Not move-assignable.
+  Shard_routing_pool& operator=(Shard_routing_pool&&) = delete;
+
+  /// @returns `true` if this instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /// @returns The number of shards.
+  DMITIGR_PGFE_API std::size_t shard_count() const noexcept;
+
+  /**
+   * @returns The pool of the shard at `index`.
+   *
+   * @par Requires
+   * `index < shard_count()`.
+   */
+  DMITIGR_PGFE_API Connection_pool& shard(std::size_t index);
+
+  /// @overload
+  DMITIGR_PGFE_API const Connection_pool& shard(std::size_t index) const;
+
+  /// @returns The routing of the keys.
+  DMITIGR_PGFE_API Routing routing() const noexcept;
+
+  /**
+   * @returns The 64-bit FNV-1a hash of `key` mixed by the finalizer of
+   * SplitMix64. Unlike `std::hash`, the result doesn't depend on the
+   * implementation, so it's suitable for persistent routing.
+   */
+  DMITIGR_PGFE_API static std::uint64_t default_hash(std::string_view key) noexcept;
+
+  /**
+   * @returns The index of the shard of `key`.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API std::size_t shard_index(std::string_view key) const;
+
+  /**
+   * @returns The index of the shard of the key with the specified `hash`.
+   *
+   * @par Requires
+   * `is_valid()`.
+   */
+  DMITIGR_PGFE_API std::size_t shard_index_by_hash(std::uint64_t hash) const;
+
+  /// Calls Connection_pool::connect() for each shard.
+  DMITIGR_PGFE_API void connect();
+
+  /// Calls Connection_pool::disconnect() for each shard.
+  DMITIGR_PGFE_API void disconnect() noexcept;
+
+  /// @returns `true` if all the shards are connected.
+  DMITIGR_PGFE_API bool is_connected() const noexcept;
+
+  /**
+   * @returns The valid connection handle if there is a free connection in
+   * the shard of `key`, or invalid handle otherwise.
+   *
+   * @throws Client_exception as Connection_pool::try_connection().
+   */
+  DMITIGR_PGFE_API Handle try_connection(std::string_view key);
+
+  /**
+   * @brief Waits for a free connection in the shard of `key`.
+   *
+   * @param timeout The maximum amount of time to wait. The value of
+   * `std::nullopt` means *eternity*.
+   *
+   * @returns The valid connection handle, or invalid handle if there is no
+   * free connection within the specified `timeout`.
+   *
+   * @throws Client_exception as Connection_pool::connection().
+   */
+  DMITIGR_PGFE_API Handle connection(std::string_view key,
+    std::optional<std::chrono::milliseconds> timeout);
+
+  /**
+   * @brief Executes the statement on all the shards in parallel.
+   *
+   * @details The connections are acquired from all the shards (in order of
+   * shards, so the concurrent calls cannot deadlock), the statement is sent
+   * to all of them, and then the responses are received one shard after
+   * another. Thus, the shards execute the statement simultaneously without
+   * extra threads.
+   *
+   * @param handler The function which is called as `handler(shard, row)` for
+   * each row of each shard. It's never called concurrently.
+   *
+   * @returns The completions in order of shards.
+   *
+   * @par Requires
+   * `is_connected()`.
+   *
+   * @throws The first (in order of shards) exception of the execution
+   * (including the one thrown by `handler`), after the responses of all the
+   * shards are received.
+   */
+  template<typename F, typename ... Types>
+  std::enable_if_t<std::is_invocable_v<F&, std::size_t, Row&&>,
+    std::vector<Completion>>
+  execute_on_all(F&& handler, const Statement& statement,
+    const Types& ... parameters)
+  {
+    using Clock = std::chrono::steady_clock;
+    auto handles = connections__();
+    const auto size = handles.size();
+    std::vector<Completion> result(size);
+    std::vector<std::exception_ptr> errors(size);
+    std::vector<std::chrono::nanoseconds> times(size);
+
+    const auto start = Clock::now();
+    for (std::size_t i{}; i < size; ++i) {
+      try {
+        handles[i]->execute_nio(statement, parameters...);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+    for (std::size_t i{}; i < size; ++i) {
+      if (errors[i])
+        continue;
+      try {
+        result[i] = handles[i]->process_responses([&handler, i](Row&& row)
+        {
+          handler(i, std::move(row));
+        });
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+      times[i] = Clock::now() - start;
+    }
+    record_scatter__(errors, times);
+
+    for (const auto& e : errors) {
+      if (e)
+        std::rethrow_exception(e);
+    }
+    return result;
+  }
+
+  /// @overload
+  template<typename ... Types>
+  std::vector<Completion> execute_on_all(const Statement& statement,
+    const Types& ... parameters)
+  {
+    return execute_on_all([](std::size_t, Row&&){}, statement, parameters...);
+  }
+
+  /**
+   * @returns The snapshot of the metrics of the shard at `index`.
+   *
+   * @par Requires
+   * `index < shard_count()`.
+   */
+  DMITIGR_PGFE_API Shard_metrics metrics(std::size_t index) const;
+
+  /// Resets the metrics of all the shards (including the metrics of pools).
+  DMITIGR_PGFE_API void reset_metrics() noexcept;
+
+private:
+  struct Shard final {
+    std::unique_ptr<Connection_pool> pool_;
+    std::uint_least64_t route_count_{};
+    std::uint_least64_t scatter_count_{};
+    std::uint_least64_t scatter_error_count_{};
+    Duration_histogram scatter_time_;
+  };
+
+  mutable std::mutex mutex_; // protects the metrics
+  std::vector<Shard> shards_;
+  Routing routing_{Routing::modulo};
+  Hasher hasher_;
+  std::vector<std::pair<std::uint64_t, std::size_t>> ring_; // sorted points
+
+  Connection_pool& route(std::string_view key);
+  std::vector<Handle> connections__();
+  void record_scatter__(const std::vector<std::exception_ptr>& errors,
+    const std::vector<std::chrono::nanoseconds>& times) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "shard_routing_pool.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_SHARD_ROUTING_POOL_HPP
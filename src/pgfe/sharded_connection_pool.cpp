@@ -0,0 +1,279 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "sharded_connection_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Sharded_connection_pool::Sharded_connection_pool(const std::size_t shard_count,
+  const std::size_t shard_size, const Connection_options& options)
+{
+  if (shard_size) {
+    shards_.reserve(shard_count);
+    for (std::size_t i{}; i < shard_count; ++i)
+      shards_.push_back(std::make_unique<Connection_pool>(shard_size, options));
+    shards_cpus_.resize(shard_count);
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Sharded_connection_pool::is_valid() const noexcept
+{
+  return !shards_.empty();
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Sharded_connection_pool::shard_count() const noexcept
+{
+  return shards_.size();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool&
+Sharded_connection_pool::shard(const std::size_t index)
+{
+  return const_cast<Connection_pool&>(
+    static_cast<const Sharded_connection_pool*>(this)->shard(index));
+}
+
+DMITIGR_PGFE_INLINE const Connection_pool&
+Sharded_connection_pool::shard(const std::size_t index) const
+{
+  if (!(index < shard_count()))
+    throw Client_exception{"cannot get shard of connection pool: "
+      "invalid index"};
+  return *shards_[index];
+}
+
+DMITIGR_PGFE_INLINE void
+Sharded_connection_pool::set_shard_cpus(const std::size_t index,
+  std::vector<unsigned> cpus)
+{
+  if (!(index < shard_count()))
+    throw Client_exception{"cannot bind shard of connection pool to CPUs: "
+      "invalid index"};
+  else if (is_connected())
+    throw Client_exception{"cannot bind shard of connection pool to CPUs: "
+      "pool is connected"};
+  else if (std::any_of(cpus.cbegin(), cpus.cend(),
+      [](const unsigned cpu){return cpu >= max_cpu_count;}))
+    throw Client_exception{"cannot bind shard of connection pool to CPUs: "
+      "invalid CPU"};
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  shards_cpus_[index] = std::move(cpus);
+
+  // Rebuild the CPU -> shard map. The CPU bound to several shards is mapped
+  // to the first of them.
+  cpu_shards_.clear();
+  for (std::size_t i{}; i < shards_cpus_.size(); ++i) {
+    for (const auto cpu : shards_cpus_[i]) {
+      if (!(cpu < cpu_shards_.size()))
+        cpu_shards_.resize(cpu + 1, no_shard);
+      if (cpu_shards_[cpu] == no_shard)
+        cpu_shards_[cpu] = i;
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE const std::vector<unsigned>&
+Sharded_connection_pool::shard_cpus(const std::size_t index) const
+{
+  if (!(index < shard_count()))
+    throw Client_exception{"cannot get CPUs of shard of connection pool: "
+      "invalid index"};
+  return shards_cpus_[index];
+}
+
+DMITIGR_PGFE_INLINE std::vector<std::vector<unsigned>>
+Sharded_connection_pool::numa_node_cpus()
+{
+  std::vector<std::vector<unsigned>> result;
+#ifdef __linux__
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  const fs::path root{"/sys/devices/system/node"};
+  for (unsigned node{};; ++node) {
+    const auto dir = root / ("node" + std::to_string(node));
+    if (!fs::is_directory(dir, ec))
+      break;
+    std::ifstream file{dir / "cpulist"};
+    std::string list;
+    std::getline(file, list);
+    result.push_back(parse_cpu_list(list));
+  }
+#endif
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Sharded_connection_pool::connect()
+{
+#ifdef __linux__
+  /*
+   * Connect the shards bound to CPUs by the threads running on these CPUs,
+   * so the memory of the connections is allocated node-locally. (The
+   * maintenance threads of the shards inherit the affinity of these threads.)
+   */
+  static_assert(max_cpu_count <= CPU_SETSIZE);
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(shards_.size());
+  for (std::size_t i{}; i < shards_.size(); ++i) {
+    if (shards_cpus_[i].empty())
+      continue;
+    threads.emplace_back([this, i, &error = errors[i]]
+    {
+      try {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const auto cpu : shards_cpus_[i])
+          CPU_SET(cpu, &set);
+        // Binding is an optimization, so the failure is ignored.
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        shards_[i]->connect();
+      } catch (...) {
+        error = std::current_exception();
+      }
+    });
+  }
+  for (std::size_t i{}; i < shards_.size(); ++i) {
+    if (shards_cpus_[i].empty())
+      shards_[i]->connect();
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+#else
+  for (auto& shard : shards_)
+    shard->connect();
+#endif
+}
+
+DMITIGR_PGFE_INLINE void Sharded_connection_pool::disconnect() noexcept
+{
+  for (auto& shard : shards_)
+    shard->disconnect();
+}
+
+DMITIGR_PGFE_INLINE bool Sharded_connection_pool::is_connected() const noexcept
+{
+  return is_valid() && std::all_of(shards_.cbegin(), shards_.cend(),
+    [](const auto& shard){return shard->is_connected();});
+}
+
+DMITIGR_PGFE_INLINE auto Sharded_connection_pool::try_connection() -> Handle
+{
+  if (!is_valid())
+    throw Client_exception{"cannot obtain connection from invalid "
+      "connection pool"};
+
+  // Start from the own shard and steal from the others if it's exhausted.
+  const auto own = thread_shard_index();
+  const auto count = shard_count();
+  auto result = shards_[own]->try_connection();
+  for (std::size_t i{1}; !result && i < count; ++i)
+    result = shards_[(own + i) % count]->try_connection();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto Sharded_connection_pool::connection(
+  const std::optional<std::chrono::milliseconds> timeout) -> Handle
+{
+  if (auto result = try_connection())
+    return result;
+  return shards_[thread_shard_index()]->connection(timeout);
+}
+
+DMITIGR_PGFE_INLINE std::size_t Sharded_connection_pool::size() const noexcept
+{
+  std::size_t result{};
+  for (const auto& shard : shards_)
+    result += shard->size();
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Sharded_connection_pool::thread_shard_index() const noexcept
+{
+  DMITIGR_ASSERT(is_valid());
+#ifdef __linux__
+  if (!cpu_shards_.empty()) {
+    if (const int cpu = ::sched_getcpu(); cpu >= 0) {
+      const auto index = static_cast<std::size_t>(cpu);
+      if (index < cpu_shards_.size() && cpu_shards_[index] != no_shard)
+        return cpu_shards_[index];
+    }
+  }
+#endif
+  static std::atomic<std::size_t> thread_count;
+  thread_local const std::size_t thread_number{thread_count++};
+  return thread_number % shard_count();
+}
+
+DMITIGR_PGFE_INLINE std::vector<unsigned>
+Sharded_connection_pool::parse_cpu_list(const std::string_view list)
+{
+  // The list is of the form like "0-3,8-11" (see cpuset(7)).
+  std::vector<unsigned> result;
+  const auto parse = [](const char*& first, const char* const last,
+    unsigned& value)
+  {
+    const auto [ptr, ec] = std::from_chars(first, last, value);
+    const bool ok = ec == std::errc{} && ptr != first;
+    first = ptr;
+    return ok;
+  };
+  const char* first = list.data();
+  const char* const last = list.data() + list.size();
+  while (first < last) {
+    unsigned lo{}, hi{};
+    if (!parse(first, last, lo))
+      break;
+    hi = lo;
+    if (first < last && *first == '-' && !parse(++first, last, hi))
+      break;
+    // The upper bound also prevents the overflow of cpu below.
+    if (lo >= max_cpu_count || hi >= max_cpu_count)
+      throw Client_exception{"cannot parse CPU list: invalid CPU"};
+    for (auto cpu = lo; cpu <= hi; ++cpu)
+      result.push_back(cpu);
+    if (first < last && *first == ',')
+      ++first;
+    else
+      break;
+  }
+  return result;
+}
+
+} // namespace dmitigr::pgfe
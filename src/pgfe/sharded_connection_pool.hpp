@@ -0,0 +1,214 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SHARDED_CONNECTION_POOL_HPP
+#define DMITIGR_PGFE_SHARDED_CONNECTION_POOL_HPP
+
+#include "connection_pool.hpp"
+#include "dll.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A thread-safe pool of connections which consists of several
+ * independent shards.
+ *
+ * @details Each thread is bound to one of the shards (in round-robin manner
+ * upon the first acquisition of a connection) and acquires the connections
+ * from it. If the shard of the thread has no free connections, a connection
+ * is stolen from another shard. Thus, the threads which acquire connections
+ * don't contend for the single mutex.
+ *
+ * The shards can be bound to the sets of CPUs (for example, to the CPUs of
+ * the NUMA nodes returned by numa_node_cpus()) by set_shard_cpus(). In this
+ * case the thread running on the CPU of the shard acquires the connections
+ * from this shard in first place, and the connections of the shard are
+ * established by the thread which runs on the CPUs of the shard, so the
+ * memory of the connections is allocated on the local NUMA node (under the
+ * default first-touch policy). For example:
+ * @code
+ * const auto nodes = pgfe::Sharded_connection_pool::numa_node_cpus();
+ * pgfe::Sharded_connection_pool pool{nodes.size(), 8, options};
+ * for (std::size_t i{}; i < nodes.size(); ++i)
+ *   pool.set_shard_cpus(i, nodes[i]);
+ * pool.connect();
+ * @endcode
+ *
+ * @remarks All the functions are thread-safe, except the constructor,
+ * the destructor and set_shard_cpus().
+ *
+ * @remarks The binding to CPUs is implemented on Linux only.
+ */
+class Sharded_connection_pool final {
+public:
+  /// A connection handle.
+  using Handle = Connection_pool::Handle;
+
+  /// Default-constructible. (Constructs invalid instance.)
+  Sharded_connection_pool() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param shard_count A number of shards.
+   * @param shard_size A number of connections in each shard.
+   * @param options A connection options to be used for connections of pool.
+   */
+  DMITIGR_PGFE_API Sharded_connection_pool(std::size_t shard_count,
+    std::size_t shard_size, const Connection_options& options = {});
+
+  /// Not copy-constructible.
+  Sharded_connection_pool(const Sharded_connection_pool&) = delete;
+
+  /// Not copy-assignable.
+  Sharded_connection_pool& operator=(const Sharded_connection_pool&) = delete;
+
+  /// Not move-constructible.
+  Sharded_connection_pool(Sharded_connection_pool&&) = delete;
+
+  /// Not move-assignable.
+  Sharded_connection_pool& operator=(Sharded_connection_pool&&) = delete;
+
+  /// @returns `true` if this instance is valid.
+  DMITIGR_PGFE_API bool is_valid() const noexcept;
+
+  /// @returns `is_valid()`.
+  explicit operator bool() const noexcept
+  {
+    return is_valid();
+  }
+
+  /// @returns The number of shards.
+  DMITIGR_PGFE_API std::size_t shard_count() const noexcept;
+
+  /**
+   * @returns The shard at `index`. It can be used to configure the shard,
+   * for example, by calling Connection_pool::set_reset_policy().
+   *
+   * @par Requires
+   * `index < shard_count()`.
+   */
+  DMITIGR_PGFE_API Connection_pool& shard(std::size_t index);
+
+  /// @overload
+  DMITIGR_PGFE_API const Connection_pool& shard(std::size_t index) const;
+
+  /**
+   * @brief Binds the shard at `index` to the specified `cpus`.
+   *
+   * @details The empty `cpus` unbinds the shard.
+   *
+   * @par Requires
+   * `index < shard_count() && !is_connected()` and each of `cpus` is less
+   * than `1024`.
+   *
+   * @remarks Has no effect on the platforms other than Linux.
+   *
+   * @see shard_cpus(), numa_node_cpus().
+   */
+  DMITIGR_PGFE_API void set_shard_cpus(std::size_t index,
+    std::vector<unsigned> cpus);
+
+  /**
+   * @returns The CPUs of the shard at `index`.
+   *
+   * @par Requires
+   * `index < shard_count()`.
+   */
+  DMITIGR_PGFE_API const std::vector<unsigned>&
+  shard_cpus(std::size_t index) const;
+
+  /**
+   * @returns The CPUs of each NUMA node indexed by the node number, or empty
+   * vector if the information is not available.
+   *
+   * @remarks The CPUs are expected to be less than `1024`.
+   */
+  DMITIGR_PGFE_API static std::vector<std::vector<unsigned>> numa_node_cpus();
+
+  /**
+   * @brief Calls Connection_pool::connect() for each shard.
+   *
+   * @details The shards bound to CPUs are connected by the threads which run
+   * on the CPUs of these shards.
+   */
+  DMITIGR_PGFE_API void connect();
+
+  /// Calls Connection_pool::disconnect() for each shard.
+  DMITIGR_PGFE_API void disconnect() noexcept;
+
+  /// @returns `true` if all the shards are connected.
+  DMITIGR_PGFE_API bool is_connected() const noexcept;
+
+  /**
+   * @returns The valid connection handle if there is a free connection in
+   * the shard of the calling thread or in any other shard, or invalid handle
+   * otherwise. The shard of the thread is the shard bound to the CPU the
+   * thread is running on, or the shard assigned to the thread in round-robin
+   * manner otherwise.
+   *
+   * @throws Client_exception as Connection_pool::try_connection().
+   */
+  DMITIGR_PGFE_API Handle try_connection();
+
+  /**
+   * @brief Waits for a free connection.
+   *
+   * @details Returns try_connection() if it's valid. Otherwise, waits for the
+   * free connection in the shard of the calling thread.
+   *
+   * @param timeout The maximum amount of time to wait. The value of
+   * `std::nullopt` means *eternity*.
+   *
+   * @returns The valid connection handle, or invalid handle if there is no
+   * free connection within the specified `timeout`.
+   *
+   * @throws Client_exception as Connection_pool::connection().
+   */
+  DMITIGR_PGFE_API Handle
+  connection(std::optional<std::chrono::milliseconds> timeout);
+
+  /// @returns The total number of connections of all the shards.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+private:
+  static constexpr std::size_t no_shard{static_cast<std::size_t>(-1)};
+  static constexpr unsigned max_cpu_count{1024};
+
+  std::vector<std::unique_ptr<Connection_pool>> shards_;
+  std::vector<std::vector<unsigned>> shards_cpus_; // indexed as shards_
+  std::vector<std::size_t> cpu_shards_; // shard indexes indexed by CPU
+
+  std::size_t thread_shard_index() const noexcept;
+  static std::vector<unsigned> parse_cpu_list(std::string_view list);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "sharded_connection_pool.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_SHARDED_CONNECTION_POOL_HPP
@@ -0,0 +1,90 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SIMDJSON_CONVERSIONS_HPP
+#define DMITIGR_PGFE_SIMDJSON_CONVERSIONS_HPP
+
+#include "conversions.hpp"
+#include "data.hpp"
+#include "exceptions.hpp"
+
+#include <simdjson.h>
+
+#include <memory>
+#include <string>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for `simdjson::dom::element`
+ * which represents a parsed value of type `json` or `jsonb`.
+ *
+ * @details The data is parsed by the parser which must be passed as the
+ * extra argument of the conversion, for example:
+ * @code
+ * simdjson::dom::parser parser;
+ * const auto doc = to<simdjson::dom::element>(row["doc"], parser);
+ * @endcode
+ * The resulting element refers to the memory of the parser, so it's valid
+ * until the parser is destroyed or used to parse another document.
+ *
+ * Support of the following data formats is implemented for:
+ *   - input data  - Data_format::text, Data_format::binary (both `json` and
+ *   `jsonb`);
+ *   - output data - Data_format::text (minified JSON).
+ *
+ * @remarks This specialization is available only if the build option
+ * `DMITIGR_LIBS_SIMDJSON` is enabled.
+ *
+ * @see Json_view.
+ */
+template<>
+struct Conversions<simdjson::dom::element> final {
+  using Type = simdjson::dom::element;
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, simdjson::dom::parser& parser,
+    Types&& ...)
+  {
+    const auto text = detail::json_text(data);
+    Type result;
+    if (const auto err = parser.parse(text.data(), text.size()).get(result))
+      throw Client_exception{std::string{"cannot parse JSON: "}
+        .append(simdjson::error_message(err))};
+    return result;
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data,
+    simdjson::dom::parser& parser, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to JSON: null data given"};
+    return to_type(*data, parser);
+  }
+
+  template<typename ... Types>
+  static std::unique_ptr<Data> to_data(const Type& value, Types&& ...)
+  {
+    return Data::make(simdjson::minify(value), Data_format::text);
+  }
+};
+
+} // namespace dmitigr::pgfe
+
+#endif  // DMITIGR_PGFE_SIMDJSON_CONVERSIONS_HPP
@@ -0,0 +1,193 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "slow_query_sampler.hpp"
+
+#include <iostream>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Slow_query_sampler::Slow_query_sampler(
+  Connection_pool& pool, const std::chrono::milliseconds threshold,
+  Handler handler)
+  : pool_{pool}
+  , handler_{std::move(handler)}
+  , threshold_{threshold}
+{
+  if (threshold_ < std::chrono::milliseconds::zero())
+    throw Client_exception{"cannot create slow query sampler: invalid threshold"};
+  else if (!handler_)
+    throw Client_exception{"cannot create slow query sampler: invalid handler"};
+
+  worker_ = std::thread{[this]{work();}};
+}
+
+DMITIGR_PGFE_INLINE Slow_query_sampler::~Slow_query_sampler()
+{
+  stop();
+}
+
+DMITIGR_PGFE_INLINE Connection_pool& Slow_query_sampler::pool() const noexcept
+{
+  return pool_;
+}
+
+DMITIGR_PGFE_INLINE void
+Slow_query_sampler::set_threshold(const std::chrono::milliseconds value)
+{
+  if (value < std::chrono::milliseconds::zero())
+    throw Client_exception{"cannot set threshold of slow query sampler: "
+      "invalid value"};
+  const std::lock_guard lg{mutex_};
+  threshold_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds
+Slow_query_sampler::threshold() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return threshold_;
+}
+
+DMITIGR_PGFE_INLINE void
+Slow_query_sampler::set_max_queue_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set max queue size of slow query sampler: "
+      "invalid value"};
+  const std::lock_guard lg{mutex_};
+  max_queue_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Slow_query_sampler::max_queue_size() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_queue_size_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t
+Slow_query_sampler::sample_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return sample_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_fast64_t
+Slow_query_sampler::drop_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return drop_count_;
+}
+
+DMITIGR_PGFE_INLINE void Slow_query_sampler::stop()
+{
+  {
+    const std::lock_guard lg{mutex_};
+    is_stopped_ = true;
+    drop_count_ += queue_.size();
+    queue_.clear();
+  }
+  state_changed_.notify_all();
+  if (worker_.joinable())
+    worker_.join();
+}
+
+DMITIGR_PGFE_INLINE bool Slow_query_sampler::is_stopped() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return is_stopped_;
+}
+
+DMITIGR_PGFE_INLINE void Slow_query_sampler::queue(Sample&& sample)
+{
+  {
+    const std::lock_guard lg{mutex_};
+    if (is_stopped_ || queue_.size() >= max_queue_size_) {
+      ++drop_count_;
+      return;
+    }
+    queue_.push_back(std::move(sample));
+  }
+  state_changed_.notify_one();
+}
+
+DMITIGR_PGFE_INLINE void Slow_query_sampler::work()
+{
+  while (true) {
+    Sample sample;
+    {
+      std::unique_lock lk{mutex_};
+      state_changed_.wait(lk, [this]{return is_stopped_ || !queue_.empty();});
+      if (is_stopped_)
+        return;
+      sample = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    bool is_captured{};
+    try {
+      is_captured = capture(sample);
+    } catch (const std::exception& e) {
+      std::clog << "slow query sampler: error: " << e.what() << '\n';
+    } catch (...) {
+      std::clog << "slow query sampler: unknown error\n";
+    }
+
+    {
+      const std::lock_guard lg{mutex_};
+      if (is_captured)
+        ++sample_count_;
+      else
+        ++drop_count_;
+    }
+    if (!is_captured)
+      continue;
+
+    try {
+      handler_(sample);
+    } catch (const std::exception& e) {
+      std::clog << "slow query sampler handler: error: " << e.what() << '\n';
+    } catch (...) {
+      std::clog << "slow query sampler handler: unknown error\n";
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE bool Slow_query_sampler::capture(Sample& sample)
+{
+  // The sampling must not wait for the connection used by the application.
+  auto handle = pool_.try_connection();
+  if (!handle)
+    return false;
+
+  auto& conn = *handle;
+  Statement explain{"explain (format json) "};
+  explain.append(sample.statement);
+  auto ps = conn.prepare(explain);
+  const auto& params = sample.parameters;
+  for (std::size_t i{}; i < params.size(); ++i)
+    ps.bind(i, params[i] ? params[i]->to_data() : nullptr);
+  ps.execute([&sample](auto&& row)
+  {
+    sample.plan = to<std::string>(row[0]);
+  });
+  return true;
+}
+
+} // namespace dmitigr::pgfe
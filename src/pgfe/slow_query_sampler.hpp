@@ -0,0 +1,247 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_SLOW_QUERY_SAMPLER_HPP
+#define DMITIGR_PGFE_SLOW_QUERY_SAMPLER_HPP
+
+#include "connection.hpp"
+#include "conversions_api.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "prepared_statement.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A sampler of the plans of slow queries.
+ *
+ * @details The statements executed by execute() which are executed longer
+ * than threshold() are queued to the worker thread, which acquires a spare
+ * connection from the pool, runs `EXPLAIN (FORMAT JSON)` of the statement
+ * with the same parameters and reports the plan to the handler. Thus, the
+ * sampling doesn't delays the caller. The samples are dropped if the queue
+ * is full or if there is no spare connection in the pool.
+ *
+ * @remarks The plan is obtained by the separate session and therefore may
+ * differ from the plan of the sampled execution (for example, because of the
+ * different session settings, or since the objects created in the
+ * uncommitted transaction of the sampled execution are invisible to it).
+ *
+ * @par Thread safety
+ * Thread-safe.
+ *
+ * @see Connection_pool.
+ */
+class Slow_query_sampler final {
+public:
+  /// The default maximum number of samples waiting for the plan capture.
+  static constexpr std::size_t default_max_queue_size{16};
+
+  /// A sample.
+  struct Sample final {
+    /// The statement of the sampled execution.
+    Statement statement;
+
+    /**
+     * @brief The parameters of the sampled execution in the order of the
+     * parameters of the `statement` (`nullptr` means NULL).
+     */
+    std::vector<std::unique_ptr<Data>> parameters;
+
+    /// The duration of the sampled execution.
+    std::chrono::nanoseconds duration{};
+
+    /// The plan in JSON format.
+    std::string plan;
+  };
+
+  /**
+   * @brief The handler of samples.
+   *
+   * @details The handler is called in the worker thread.
+   */
+  using Handler = std::function<void(const Sample&)>;
+
+  /**
+   * @brief The constructor. Starts the worker.
+   *
+   * @param pool The pool to acquire the connections to capture the plans
+   * from. It must outlive the sampler.
+   * @param threshold The minimum duration of execution to be sampled.
+   * @param handler The handler of samples.
+   *
+   * @par Requires
+   * `threshold >= std::chrono::milliseconds::zero() && handler`.
+   */
+  DMITIGR_PGFE_API Slow_query_sampler(Connection_pool& pool,
+    std::chrono::milliseconds threshold, Handler handler);
+
+  /// Calls stop().
+  DMITIGR_PGFE_API ~Slow_query_sampler();
+
+  /// Not copy-constructible.
+  Slow_query_sampler(const Slow_query_sampler&) = delete;
+
+  /// Not copy-assignable.
+  Slow_query_sampler& operator=(const Slow_query_sampler&) = delete;
+
+  /// Not move-constructible.
+  Slow_query_sampler(Slow_query_sampler&&) = delete;
+
+  /// Not move-assignable.
+  Slow_query_sampler& operator=(Slow_query_sampler&&) = delete;
+
+  /// @returns The pool.
+  DMITIGR_PGFE_API Connection_pool& pool() const noexcept;
+
+  /**
+   * @brief Sets the minimum duration of execution to be sampled.
+   *
+   * @par Requires
+   * `value >= std::chrono::milliseconds::zero()`.
+   */
+  DMITIGR_PGFE_API void set_threshold(std::chrono::milliseconds value);
+
+  /// @returns The minimum duration of execution to be sampled.
+  DMITIGR_PGFE_API std::chrono::milliseconds threshold() const noexcept;
+
+  /**
+   * @brief Sets the maximum number of samples waiting for the plan capture.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_max_queue_size(std::size_t value);
+
+  /// @returns The maximum number of samples waiting for the plan capture.
+  DMITIGR_PGFE_API std::size_t max_queue_size() const noexcept;
+
+  /// @returns The number of reported samples.
+  DMITIGR_PGFE_API std::uint_fast64_t sample_count() const noexcept;
+
+  /// @returns The number of dropped samples.
+  DMITIGR_PGFE_API std::uint_fast64_t drop_count() const noexcept;
+
+  /**
+   * @brief Executes the `statement` on the `conn` and samples the execution
+   * if it is executed longer than threshold().
+   *
+   * @returns The result of `conn.execute(callback, statement, parameters...)`.
+   *
+   * @remarks Since the plan is captured with the parameters converted before
+   * the execution, the `parameters` are not forwarded to the `conn` as is but
+   * passed as lvalues.
+   *
+   * @see Connection::execute().
+   */
+  template<typename F, typename ... Types>
+  std::enable_if_t<!std::is_convertible_v<F&&, const Statement&>, Completion>
+  execute(Connection& conn, F&& callback, const Statement& statement,
+    const Types& ... parameters)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = conn.execute(std::forward<F>(callback), statement,
+      parameters...);
+    const auto duration = std::chrono::steady_clock::now() - start;
+    if (duration >= threshold()) {
+      Sample sample;
+      sample.statement = statement;
+      sample.parameters.resize(statement.parameter_count());
+      std::size_t index{};
+      (store(sample, index++, parameters), ...);
+      sample.duration = duration;
+      queue(std::move(sample));
+    }
+    return result;
+  }
+
+  /// @overload
+  template<typename ... Types>
+  Completion execute(Connection& conn, const Statement& statement,
+    const Types& ... parameters)
+  {
+    return execute(conn, [](auto&&){}, statement, parameters...);
+  }
+
+  /**
+   * @brief Stops the worker. The queued samples are dropped.
+   *
+   * @par Effects
+   * `is_stopped()`.
+   */
+  DMITIGR_PGFE_API void stop();
+
+  /// @returns `true` if the sampler is stopped.
+  DMITIGR_PGFE_API bool is_stopped() const noexcept;
+
+private:
+  Connection_pool& pool_;
+  Handler handler_;
+  mutable std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::deque<Sample> queue_;
+  std::thread worker_;
+  std::chrono::milliseconds threshold_{};
+  std::size_t max_queue_size_{default_max_queue_size};
+  std::uint_fast64_t sample_count_{};
+  std::uint_fast64_t drop_count_{};
+  bool is_stopped_{};
+
+  DMITIGR_PGFE_API void queue(Sample&& sample);
+
+  template<typename T>
+  static void store(Sample& sample, const std::size_t index, const T& value)
+  {
+    if constexpr (std::is_same_v<T, Named_argument>) {
+      const auto data = value.data();
+      sample.parameters.at(sample.statement.parameter_index(value.name())) =
+        data ? data.to_data() : nullptr;
+    } else if constexpr (std::is_same_v<T, Typed_argument>) {
+      const auto data = value.data();
+      sample.parameters.at(index) = data ? data.to_data() : nullptr;
+    } else
+      sample.parameters.at(index) = to_data(value);
+  }
+
+  void work();
+  bool capture(Sample& sample);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "slow_query_sampler.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_SLOW_QUERY_SAMPLER_HPP
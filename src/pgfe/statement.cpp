@@ -19,10 +19,13 @@
 #include "connection.hpp"
 #include "data.hpp"
 #include "exceptions.hpp"
+#include "metrics.hpp"
 #include "statement.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <charconv>
 #include <cstring>
 #include <memory>
 #include <stdexcept>
@@ -30,9 +33,11 @@
 namespace dmitigr::pgfe {
 
 DMITIGR_PGFE_INLINE
-Statement::Fragment::Fragment(const Type tp, const std::string& s)
-  : type(tp)
-  , str(s)
+Statement::Fragment::Fragment(const Type tp, const std::size_t off,
+  const std::size_t sz) noexcept
+  : type{tp}
+  , offset{off}
+  , size{sz}
 {}
 
 DMITIGR_PGFE_INLINE bool
@@ -44,12 +49,6 @@ Statement::Fragment::is_named_parameter() const noexcept
     type == Ft::named_parameter_identifier;
 }
 
-DMITIGR_PGFE_INLINE bool
-Statement::Fragment::is_named_parameter(const std::string_view name) const noexcept
-{
-  return is_named_parameter() && str == name;
-}
-
 // =============================================================================
 
 DMITIGR_PGFE_INLINE Statement::Statement(const std::string_view text)
@@ -67,15 +66,29 @@ DMITIGR_PGFE_INLINE Statement::Statement(const char* const text)
   : Statement{std::string_view{text, std::strlen(text)}}
 {}
 
+DMITIGR_PGFE_INLINE Statement::Statement(const std::string_view text,
+  const detail::Statement_fragment* const fragments,
+  const std::size_t fragment_count)
+  : text_{text}
+{
+  DMITIGR_ASSERT(fragments || !fragment_count);
+  fragments_.reserve(fragment_count);
+  for (std::size_t i{}; i < fragment_count; ++i)
+    push_fragment(fragments[i].type, fragments[i].offset, fragments[i].size);
+  assert(is_invariant_ok());
+}
+
 DMITIGR_PGFE_INLINE Statement::Statement(const Statement& rhs)
-  : fragments_{rhs.fragments_}
+  : text_{rhs.text_}
+  , fragments_{rhs.fragments_}
   , positional_parameters_{rhs.positional_parameters_}
+  , named_parameters_{rhs.named_parameters_}
+  , named_parameter_indexes_{rhs.named_parameter_indexes_}
   , is_extra_data_should_be_extracted_from_comments_{
       rhs.is_extra_data_should_be_extracted_from_comments_}
   , extra_{rhs.extra_}
-{
-  named_parameters_ = named_parameters();
-}
+  , revision_{rhs.revision_}
+{}
 
 DMITIGR_PGFE_INLINE Statement& Statement::operator=(const Statement& rhs)
 {
@@ -87,13 +100,17 @@ DMITIGR_PGFE_INLINE Statement& Statement::operator=(const Statement& rhs)
 }
 
 DMITIGR_PGFE_INLINE Statement::Statement(Statement&& rhs) noexcept
-  : fragments_{std::move(rhs.fragments_)}
+  : text_{std::move(rhs.text_)}
+  , fragments_{std::move(rhs.fragments_)}
   , positional_parameters_{std::move(rhs.positional_parameters_)}
+  , named_parameters_{std::move(rhs.named_parameters_)}
+  , named_parameter_indexes_{std::move(rhs.named_parameter_indexes_)}
   , is_extra_data_should_be_extracted_from_comments_{
       std::move(rhs.is_extra_data_should_be_extracted_from_comments_)}
   , extra_{std::move(rhs.extra_)}
+  , revision_{rhs.revision_}
 {
-  named_parameters_ = named_parameters();
+  rhs.revise();
 }
 
 DMITIGR_PGFE_INLINE Statement& Statement::operator=(Statement&& rhs) noexcept
@@ -108,12 +125,15 @@ DMITIGR_PGFE_INLINE Statement& Statement::operator=(Statement&& rhs) noexcept
 DMITIGR_PGFE_INLINE void Statement::swap(Statement& rhs) noexcept
 {
   using std::swap;
+  swap(text_, rhs.text_);
   swap(fragments_, rhs.fragments_);
   swap(positional_parameters_, rhs.positional_parameters_);
   swap(named_parameters_, rhs.named_parameters_);
+  swap(named_parameter_indexes_, rhs.named_parameter_indexes_);
   swap(is_extra_data_should_be_extracted_from_comments_,
     rhs.is_extra_data_should_be_extracted_from_comments_);
   swap(extra_, rhs.extra_);
+  swap(revision_, rhs.revision_);
 }
 
 DMITIGR_PGFE_INLINE std::size_t
@@ -152,7 +172,8 @@ Statement::parameter_name(const std::size_t index) const
 {
   if (!((positional_parameter_count() <= index) && (index < parameter_count())))
     throw Client_exception{"cannot get Statement parameter name"};
-  return named_parameters_[index - positional_parameter_count()]->str;
+  return fragment_text(fragments_[named_parameters_[index -
+    positional_parameter_count()]]);
 }
 
 DMITIGR_PGFE_INLINE std::size_t
@@ -171,7 +192,7 @@ DMITIGR_PGFE_INLINE bool Statement::is_query_empty() const noexcept
   return all_of(cbegin(fragments_), cend(fragments_),
     [this](const Fragment& f)
     {
-      return is_comment(f) || (is_text(f) && str::is_blank(f.str));
+      return is_comment(f) || (is_text(f) && str::is_blank(fragment_text(f)));
     });
 }
 
@@ -222,8 +243,13 @@ DMITIGR_PGFE_INLINE void Statement::append(const Statement& appendix)
   const bool was_query_empty{is_query_empty()};
 
   // Update fragments.
-  fragments_.insert(cend(fragments_), cbegin(appendix.fragments_),
-    cend(appendix.fragments_));
+  const auto text_offset = text_.size();
+  fragments_.reserve(fragments_.size() + appendix.fragments_.size()); // can throw
+  text_.append(appendix.text_); // can throw
+  for (const auto& fragment : appendix.fragments_) {
+    fragments_.push_back(fragment); // can throw
+    fragments_.back().offset += text_offset;
+  }
   update_cache(appendix); // can throw
 
   if (was_query_empty)
@@ -238,10 +264,12 @@ Statement::bind(const std::string_view name,
 {
   if (!has_parameter(name))
     throw Client_exception{"cannot bind Statement parameter"};
+  const detail::Allocation_scope allocation_scope{Allocation_category::bind};
   for (auto& fragment : fragments_) {
-    if (fragment.is_named_parameter(name))
+    if (is_named_parameter(fragment, name))
       fragment.value = value;
   }
+  revise();
   assert(is_invariant_ok());
   return *this;
 }
@@ -252,7 +280,7 @@ Statement::bound(const std::string_view name) const
   if (!has_parameter(name))
     throw Client_exception{"cannot get bound Statement parameter"};
   for (auto& fragment : fragments_) {
-    if (fragment.is_named_parameter(name))
+    if (is_named_parameter(fragment, name))
       return fragment.value;
   }
   DMITIGR_ASSERT(false);
@@ -262,13 +290,15 @@ DMITIGR_PGFE_INLINE std::size_t
 Statement::bound_parameter_count() const noexcept
 {
   return count_if(cbegin(fragments_), cend(fragments_),
-    [counted = std::vector<std::string>{}](const auto& fragment)mutable -> bool
+    [this, counted = std::vector<std::string_view>{}](const auto& fragment)
+    mutable -> bool
     {
       if (fragment.is_named_parameter()) {
+        const auto fragment_name = fragment_text(fragment);
         const bool is_uncounted{none_of(cbegin(counted), cend(counted),
-          [&fragment](const auto& name){return name == fragment.str;})};
+          [&fragment_name](const auto& name){return name == fragment_name;})};
         if (is_uncounted) {
-          counted.push_back(fragment.str);
+          counted.push_back(fragment_name);
           return static_cast<bool>(fragment.value);
         }
       }
@@ -294,16 +324,20 @@ Statement::replace_parameter(const std::string_view name,
     throw Client_exception{"cannot replace Statement parameter"};
 
   // Update fragments.
-  for (auto fi = begin(fragments_); fi != end(fragments_);) {
-    if (fi->is_named_parameter(name)) {
-      // Insert the `replacement` just before `fi`.
-      fragments_.insert(fi, cbegin(replacement.fragments_),
-        cend(replacement.fragments_));
-      // Erase named parameter pointed by `fi` and got the next iterator.
-      fi = fragments_.erase(fi);
+  const auto text_offset = text_.size();
+  Fragment_list fragments;
+  fragments.reserve(fragments_.size() + replacement.fragments_.size());
+  for (const auto& fragment : fragments_) {
+    if (is_named_parameter(fragment, name)) {
+      for (const auto& rfragment : replacement.fragments_) {
+        fragments.push_back(rfragment);
+        fragments.back().offset += text_offset;
+      }
     } else
-      ++fi;
+      fragments.push_back(fragment);
   }
+  text_.append(replacement.text_); // can throw
+  fragments_.swap(fragments);
 
   update_cache(replacement);  // can throw
 
@@ -314,39 +348,39 @@ DMITIGR_PGFE_INLINE std::string Statement::to_string() const
 {
   using Ft = Fragment::Type;
   std::string result;
-  result.reserve(512);
+  result.reserve(text_.size() + 2*fragments_.size());
   for (const auto& fragment : fragments_) {
     switch (fragment.type) {
     case Ft::text:
-      result += fragment.str;
+      result += fragment_text(fragment);
       break;
     case Ft::one_line_comment:
       result += "--";
-      result += fragment.str;
+      result += fragment_text(fragment);
       result += '\n';
       break;
     case Ft::multi_line_comment:
       result += "/*";
-      result += fragment.str;
+      result += fragment_text(fragment);
       result += "*/";
       break;
     case Ft::named_parameter:
       result += ':';
-      result += fragment.str;
+      result += fragment_text(fragment);
       break;
     case Ft::named_parameter_literal:
       result += ":'";
-      result += fragment.str;
+      result += fragment_text(fragment);
       result += '\'';
       break;
     case Ft::named_parameter_identifier:
       result += ":\"";
-      result += fragment.str;
+      result += fragment_text(fragment);
       result += '"';
       break;
     case Ft::positional_parameter:
       result += '$';
-      result += fragment.str;
+      result += fragment_text(fragment);
       break;
     }
   }
@@ -357,8 +391,6 @@ DMITIGR_PGFE_INLINE std::string Statement::to_string() const
 DMITIGR_PGFE_INLINE std::string
 Statement::to_query_string(const Connection& conn) const
 {
-  using Ft = Fragment::Type;
-
   if (has_missing_parameters())
     throw Client_exception{"cannot convert Statement to query string: "
       "has missing parameters"};
@@ -366,12 +398,35 @@ Statement::to_query_string(const Connection& conn) const
     throw Client_exception{"cannot convert Statement to query string: "
       "not connected"};
 
-  static const auto check_value_bound = [](const auto& fragment)
+  std::string result;
+  append_query_string(result, conn, nullptr);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE bool
+Statement::append_query_string(std::string& result, const Connection& conn,
+  const std::optional<std::string>* const values) const
+{
+  using Ft = Fragment::Type;
+
+  // Returns the value bound to the named parameter fragment.
+  const auto value_of = [this, values](const Fragment& fragment)
+    -> const std::optional<std::string>&
+  {
+    if (values) {
+      const auto& value = values[named_parameter_index(fragment_text(fragment))];
+      if (value)
+        return value;
+    }
+    return fragment.value;
+  };
+
+  const auto check_value_bound = [this](const auto& fragment, const auto& value)
   {
     DMITIGR_ASSERT(fragment.is_named_parameter());
-    if (!fragment.value) {
+    if (!value) {
       std::string what{"named parameter "};
-      what.append(fragment.str);
+      what.append(fragment_text(fragment));
       const char* const type_str =
         fragment.type == Ft::named_parameter_literal ? "literal" :
         fragment.type == Ft::named_parameter_identifier ? "identifier" : nullptr;
@@ -382,41 +437,47 @@ Statement::to_query_string(const Connection& conn) const
     }
   };
 
-  std::string result;
-  result.reserve(512);
+  bool is_connection_dependent{};
+  result.reserve(result.size() + text_.size());
   for (const auto& fragment : fragments_) {
     switch (fragment.type) {
     case Ft::text:
-      result += fragment.str;
+      result += fragment_text(fragment);
       break;
     case Ft::one_line_comment:
       [[fallthrough]];
     case Ft::multi_line_comment:
       break;
     case Ft::named_parameter:
-      if (!fragment.value) {
-        const auto idx = named_parameter_index(fragment.str);
+      if (const auto& value = value_of(fragment); !value) {
+        const auto idx = named_parameter_index(fragment_text(fragment));
         DMITIGR_ASSERT(idx < parameter_count());
         result += '$';
         result += std::to_string(idx + 1);
       } else
-        result += *fragment.value;
+        result += *value;
       break;
-    case Ft::named_parameter_literal:
-      check_value_bound(fragment);
-      result += conn.to_quoted_literal(*fragment.value);
+    case Ft::named_parameter_literal: {
+      const auto& value = value_of(fragment);
+      check_value_bound(fragment, value);
+      conn.append_quoted_literal(result, *value);
+      is_connection_dependent = true;
       break;
-    case Ft::named_parameter_identifier:
-      check_value_bound(fragment);
-      result += conn.to_quoted_identifier(*fragment.value);
+    }
+    case Ft::named_parameter_identifier: {
+      const auto& value = value_of(fragment);
+      check_value_bound(fragment, value);
+      conn.append_quoted_identifier(result, *value);
+      is_connection_dependent = true;
       break;
+    }
     case Ft::positional_parameter:
       result += '$';
-      result += fragment.str;
+      result += fragment_text(fragment);
       break;
     }
   }
-  return result;
+  return is_connection_dependent;
 }
 
 // ---------------------------------------------------------------------------
@@ -440,12 +501,12 @@ public:
 
   /// @returns The vector of associated extra data.
   static std::vector<std::pair<Key, Value>>
-  extract(const Fragment_list& fragments)
+  extract(const Statement& statement)
   {
     std::vector<std::pair<Key, Value>> result;
-    const auto iters = first_related_comments(fragments);
-    if (iters.first != cend(fragments)) {
-      const auto comments = joined_comments(iters.first, iters.second);
+    const auto iters = first_related_comments(statement);
+    if (iters.first != cend(statement.fragments_)) {
+      const auto comments = joined_comments(statement, iters.first, iters.second);
       for (const auto& comment : comments) {
         auto associations = extract(comment.first, comment.second);
         result.reserve(result.capacity() + associations.size());
@@ -697,11 +758,11 @@ private:
    * @returns The pair of iterators that specifies the range of relevant comments.
    */
   std::pair<Fragment_list::const_iterator, Fragment_list::const_iterator>
-  static first_related_comments(const Fragment_list& fragments)
+  static first_related_comments(const Statement& statement)
   {
     using Ft = Fragment::Type;
-    const auto b = cbegin(fragments);
-    const auto e = cend(fragments);
+    const auto b = cbegin(statement.fragments_);
+    const auto e = cend(statement.fragments_);
     auto result = std::make_pair(e, e);
 
     const auto is_nearby_string = [](const std::string_view str)
@@ -722,10 +783,11 @@ private:
      * Stops lookup when either named parameter or positional parameter are found.
      * (Only fragments of type `text` can have related comments.)
      */
-    auto i = find_if(b, e, [&is_nearby_string](const Fragment& f)
+    auto i = find_if(b, e, [&statement, &is_nearby_string](const Fragment& f)
     {
+      const auto text = statement.fragment_text(f);
       return (f.type == Ft::text &&
-        is_nearby_string(f.str) && !str::is_blank(f.str)) ||
+        is_nearby_string(text) && !str::is_blank(text)) ||
         f.type == Ft::named_parameter ||
         f.type == Ft::positional_parameter;
     });
@@ -734,9 +796,9 @@ private:
       do {
         --i;
         DMITIGR_ASSERT(is_comment(*i) ||
-          (is_text(*i) && str::is_blank(i->str)));
+          (is_text(*i) && str::is_blank(statement.fragment_text(*i))));
         if (i->type == Ft::text) {
-          if (!is_nearby_string(i->str))
+          if (!is_nearby_string(statement.fragment_text(*i)))
             break;
         }
         result.first = i;
@@ -756,15 +818,15 @@ private:
    */
   std::pair<std::pair<std::string, Extra::Comment_type>,
     Fragment_list::const_iterator>
-  static joined_comments_of_same_type(Fragment_list::const_iterator i,
-    const Fragment_list::const_iterator e)
+  static joined_comments_of_same_type(const Statement& statement,
+    Fragment_list::const_iterator i, const Fragment_list::const_iterator e)
   {
     using Ft = Fragment::Type;
     DMITIGR_ASSERT(is_comment(*i));
     std::string result;
     const auto fragment_type = i->type;
-    for (; i->type == fragment_type && i != e; ++i) {
-      result.append(i->str);
+    for (; i != e && i->type == fragment_type; ++i) {
+      result.append(statement.fragment_text(*i));
       if (fragment_type == Ft::one_line_comment)
         result.append("\n");
     }
@@ -790,13 +852,13 @@ private:
    *   - the type of the joined comments as second element.
    */
   std::vector<std::pair<std::string, Extra::Comment_type>>
-  static joined_comments(Fragment_list::const_iterator i,
-    const Fragment_list::const_iterator e)
+  static joined_comments(const Statement& statement,
+    Fragment_list::const_iterator i, const Fragment_list::const_iterator e)
   {
     std::vector<std::pair<std::string, Extra::Comment_type>> result;
     while (i != e) {
       if (is_comment(*i)) {
-        auto comments = joined_comments_of_same_type(i, e);
+        auto comments = joined_comments_of_same_type(statement, i, e);
         result.push_back(std::move(comments.first));
         i = comments.second;
       } else
@@ -809,10 +871,14 @@ private:
 DMITIGR_PGFE_INLINE const Tuple& Statement::extra() const noexcept
 {
   if (!extra_)
-    extra_.emplace(Extra::extract(fragments_));
+    extra_.emplace(Extra::extract(*this));
   else if (is_extra_data_should_be_extracted_from_comments_)
-    extra_->append(Tuple{Extra::extract(fragments_)});
-  is_extra_data_should_be_extracted_from_comments_ = false;
+    extra_->append(Tuple{Extra::extract(*this)});
+  if (is_extra_data_should_be_extracted_from_comments_) {
+    // The extracted data is stored compactly to make copying cheap.
+    extra_->compact();
+    is_extra_data_should_be_extracted_from_comments_ = false;
+  }
   assert(is_invariant_ok());
   return *extra_;
 }
@@ -851,63 +917,71 @@ DMITIGR_PGFE_INLINE bool Statement::is_invariant_ok() const noexcept
 // ---------------------------------------------------------------------------
 
 DMITIGR_PGFE_INLINE void
-Statement::push_back_fragment(const Fragment::Type type, const std::string& str)
+Statement::push_back_fragment(const Fragment::Type type,
+  const std::size_t offset, const std::size_t size)
 {
-  fragments_.emplace_back(type, str);
+  DMITIGR_ASSERT(offset + size <= text_.size());
+  fragments_.emplace_back(type, offset, size);
   assert(is_invariant_ok());
 }
 
 DMITIGR_PGFE_INLINE void
-Statement::push_text(const std::string& str)
-{
-  push_back_fragment(Fragment::Type::text, str);
-}
-
-DMITIGR_PGFE_INLINE void
-Statement::push_one_line_comment(const std::string& str)
+Statement::push_fragment(const Fragment::Type type, const std::size_t offset,
+  const std::size_t size)
 {
-  push_back_fragment(Fragment::Type::one_line_comment, str);
-}
-
-DMITIGR_PGFE_INLINE void
-Statement::push_multi_line_comment(const std::string& str)
-{
-  push_back_fragment(Fragment::Type::multi_line_comment, str);
+  using Ft = Fragment::Type;
+  switch (type) {
+  case Ft::positional_parameter:
+    push_positional_parameter(offset, size);
+    break;
+  case Ft::named_parameter:
+    [[fallthrough]];
+  case Ft::named_parameter_literal:
+    [[fallthrough]];
+  case Ft::named_parameter_identifier:
+    push_named_parameter(type, offset, size);
+    break;
+  default:
+    push_back_fragment(type, offset, size);
+  }
 }
 
 DMITIGR_PGFE_INLINE void
-Statement::push_positional_parameter(const std::string& str)
+Statement::push_positional_parameter(const std::size_t offset,
+  const std::size_t size)
 {
-  push_back_fragment(Fragment::Type::positional_parameter, str);
+  push_back_fragment(Fragment::Type::positional_parameter, offset, size);
 
   using Size = std::vector<bool>::size_type;
-  const int position = stoi(str);
-  if (position < 1 || static_cast<Size>(position) > max_parameter_count())
-    throw Client_exception{"invalid parameter position \"" + str + "\""};
-  else if (static_cast<Size>(position) > positional_parameters_.size())
-    positional_parameters_.resize(static_cast<Size>(position), false);
+  const auto str = fragment_text(fragments_.back());
+  Size position{};
+  const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(),
+    position);
+  if (ec != std::errc{} || ptr != str.data() + str.size() ||
+    position < 1 || position > max_parameter_count())
+    throw Client_exception{"invalid parameter position \""
+      + std::string{str} + "\""};
+  else if (position > positional_parameters_.size())
+    positional_parameters_.resize(position, false);
 
   // Set parameter presence flag.
-  positional_parameters_[static_cast<Size>(position) - 1] = true;
+  positional_parameters_[position - 1] = true;
 
   assert(is_invariant_ok());
 }
 
 DMITIGR_PGFE_INLINE void
-Statement::push_named_parameter(const std::string& str, const char quote_char)
+Statement::push_named_parameter(const Fragment::Type type,
+  const std::size_t offset, const std::size_t size)
 {
-  DMITIGR_ASSERT(!quote_char || is_quote_char(quote_char));
   if (parameter_count() < max_parameter_count()) {
-    using Ft = Fragment::Type;
-    const auto type =
-      quote_char == '\'' ? Ft::named_parameter_literal :
-      quote_char == '\"' ? Ft::named_parameter_identifier : Ft::named_parameter;
-    push_back_fragment(type, str);
-    if (none_of(cbegin(named_parameters_), cend(named_parameters_),
-        [&str](const auto& i){return (i->str == str);})) {
-      auto e = cend(fragments_);
-      --e;
-      named_parameters_.push_back(e);
+    push_back_fragment(type, offset, size);
+    DMITIGR_ASSERT(fragments_.back().is_named_parameter());
+    const auto str = fragment_text(fragments_.back());
+    if (named_parameter_index(str) == parameter_count()) {
+      named_parameter_indexes_.emplace(std::hash<std::string_view>{}(str),
+        named_parameters_.size());
+      named_parameters_.push_back(fragments_.size() - 1);
     }
   } else
     throw Client_exception{"maximum parameters count (" +
@@ -923,6 +997,8 @@ Statement::push_named_parameter(const std::string& str, const char quote_char)
 // Exception safety guarantee: basic.
 DMITIGR_PGFE_INLINE void Statement::update_cache(const Statement& rhs)
 {
+  revise();
+
   // Prepare positional parameters for merge.
   const auto old_pos_params_size = positional_parameters_.size();
   const auto rhs_pos_params_size = rhs.positional_parameters_.size();
@@ -930,7 +1006,9 @@ DMITIGR_PGFE_INLINE void Statement::update_cache(const Statement& rhs)
   positional_parameters_.resize(new_pos_params_size); // can throw
 
   // Recreate the cache for named parameters. (Can throw.)
-  named_parameters_ = named_parameters();
+  auto named_params = named_parameters();
+  named_parameter_indexes_ = named_parameter_indexes(named_params);
+  named_parameters_.swap(named_params);
 
   // Check the new parameter count.
   const auto new_parameter_count = new_pos_params_size + named_parameters_.size();
@@ -948,6 +1026,17 @@ DMITIGR_PGFE_INLINE void Statement::update_cache(const Statement& rhs)
   assert(is_invariant_ok());
 }
 
+DMITIGR_PGFE_INLINE void Statement::revise() noexcept
+{
+  revision_ = next_revision();
+}
+
+DMITIGR_PGFE_INLINE std::uint64_t Statement::next_revision() noexcept
+{
+  static std::atomic<std::uint64_t> revision;
+  return ++revision;
+}
+
 // ---------------------------------------------------------------------------
 // Named parameters helpers
 // ---------------------------------------------------------------------------
@@ -958,7 +1047,7 @@ Statement::named_parameter_type(const std::size_t index) const noexcept
 {
   DMITIGR_ASSERT(positional_parameter_count() <= index && index < parameter_count());
   const auto relative_index = index - positional_parameter_count();
-  return named_parameters_[relative_index]->type;
+  return fragments_[named_parameters_[relative_index]].type;
 }
 
 DMITIGR_PGFE_INLINE std::size_t
@@ -966,493 +1055,110 @@ Statement::named_parameter_index(const std::string_view name) const noexcept
 {
   const auto relative_index = [this, name]() noexcept
   {
-    const auto b = cbegin(named_parameters_);
-    const auto e = cend(named_parameters_);
-    const auto i = find_if(b, e, [name](const auto& pi){return pi->str == name;});
-    return static_cast<std::size_t>(i - b);
+    const auto [b, e] =
+      named_parameter_indexes_.equal_range(std::hash<std::string_view>{}(name));
+    const auto i = find_if(b, e, [this, name](const auto& hi)
+    {
+      return fragment_text(fragments_[named_parameters_[hi.second]]) == name;
+    });
+    return i != e ? i->second : named_parameters_.size();
   }();
   return positional_parameter_count() + relative_index;
 }
 
 DMITIGR_PGFE_INLINE auto Statement::named_parameters() const
-  -> std::vector<Fragment_list::const_iterator>
+  -> std::vector<std::size_t>
 {
-  std::vector<Fragment_list::const_iterator> result;
+  std::vector<std::size_t> result;
   result.reserve(8);
-  const auto e = cend(fragments_);
-  for (auto i = cbegin(fragments_); i != e; ++i) {
-    if (i->is_named_parameter()) {
-      if (none_of(cbegin(result), cend(result),
-          [i](const auto& result_i){return i->str == result_i->str;}))
+  const auto fragment_count = fragments_.size();
+  for (std::size_t i{}; i < fragment_count; ++i) {
+    const auto& fragment = fragments_[i];
+    if (fragment.is_named_parameter()) {
+      const auto name = fragment_text(fragment);
+      if (none_of(cbegin(result), cend(result), [this, name](const auto ri)
+        {
+          return fragment_text(fragments_[ri]) == name;
+        }))
         result.push_back(i);
     }
   }
   return result;
 }
 
+DMITIGR_PGFE_INLINE auto
+Statement::named_parameter_indexes(
+  const std::vector<std::size_t>& params) const
+  -> std::unordered_multimap<std::size_t, std::size_t>
+{
+  std::unordered_multimap<std::size_t, std::size_t> result;
+  result.reserve(params.size());
+  for (std::size_t i{}; i < params.size(); ++i) {
+    const auto name = fragment_text(fragments_[params[i]]);
+    result.emplace(std::hash<std::string_view>{}(name), i);
+  }
+  return result;
+}
+
 // ---------------------------------------------------------------------------
-// Predicates
+// Fragments helpers
 // ---------------------------------------------------------------------------
 
-DMITIGR_PGFE_INLINE bool
-Statement::is_comment(const Fragment& f) noexcept
+DMITIGR_PGFE_INLINE std::string_view
+Statement::fragment_text(const Fragment& f) const noexcept
 {
-  return (f.type == Fragment::Type::one_line_comment) ||
-    (f.type == Fragment::Type::multi_line_comment);
+  DMITIGR_ASSERT(f.offset + f.size <= text_.size());
+  return {text_.data() + f.offset, f.size};
 }
 
+// ---------------------------------------------------------------------------
+// Predicates
+// ---------------------------------------------------------------------------
+
 DMITIGR_PGFE_INLINE bool
-Statement::is_text(const Fragment& f) noexcept
+Statement::is_named_parameter(const Fragment& f,
+  const std::string_view name) const noexcept
 {
-  return (f.type == Fragment::Type::text);
+  return f.is_named_parameter() && fragment_text(f) == name;
 }
 
 DMITIGR_PGFE_INLINE bool
-Statement::is_ident_char(const unsigned char c) noexcept
+Statement::is_comment(const Fragment& f) noexcept
 {
-  return std::isalnum(c) || c == '_' || c == '$';
+  return (f.type == Fragment::Type::one_line_comment) ||
+    (f.type == Fragment::Type::multi_line_comment);
 }
 
 DMITIGR_PGFE_INLINE bool
-Statement::is_quote_char(const unsigned char c) noexcept
+Statement::is_text(const Fragment& f) noexcept
 {
-  return c == '\'' || c == '\"';
+  return (f.type == Fragment::Type::text);
 }
 
 // -----------------------------------------------------------------------------
 // Basic SQL input parser
 // -----------------------------------------------------------------------------
 
-/*
- * SQL SYNTAX BASICS (from PostgreSQL documentation):
- * https://www.postgresql.org/docs/current/static/sql-syntax-lexical.html
- *
- * COMMANDS
- *
- * A command is composed of a sequence of tokens, terminated by a (";").
- * A token can be a key word, an identifier, a quoted identifier,
- * a literal (or constant), or a special character symbol. Tokens are normally
- * separated by whitespace (space, tab, newline), but need not be if there is no
- * ambiguity.
- *
- * IDENTIFIERS (UNQUOTED)
- *
- * SQL identifiers and key words must begin with a letter (a-z, but also
- * letters with diacritical marks and non-Latin letters) or an ("_").
- * Subsequent characters in an identifier or key word can be letters,
- * underscores, digits (0-9), or dollar signs ($).
- *
- * QUOTED IDENTIFIERS
- *
- * The delimited identifier or quoted identifier is formed by enclosing an
- * arbitrary sequence of characters in double-quotes ("). Quoted identifiers can
- * contain any character, except the character with code zero. (To include a
- * double quote, two double quotes should be written.)
- *
- * CONSTANTS
- *
- *   STRING CONSTANTS (QUOTED LITERALS)
- *
- * A string constant in SQL is an arbitrary sequence of characters bounded
- * by single quotes ('), for example 'This is a string'. To include a
- * single-quote character within a string constant, write two adjacent
- * single quotes, e.g., 'Dianne''s horse'.
- *
- *   DOLLAR QUOTED STRING CONSTANTS
- *
- * A dollar-quoted string constant consists of a dollar sign ($), an
- * optional "tag" of zero or more characters, another dollar sign, an
- * arbitrary sequence of characters that makes up the string content, a
- * dollar sign, the same tag that began this dollar quote, and a dollar
- * sign.
- * The tag, if any, of a dollar-quoted string follows the same rules
- * as an unquoted identifier, except that it cannot contain a dollar sign.
- * A dollar-quoted string that follows a keyword or identifier must be
- * separated from it by whitespace; otherwise the dollar quoting delimiter
- * would be taken as part of the preceding identifier.
- *
- * SPECIAL CHARACTERS
- *
- * - A dollar sign ("$") followed by digits is used to represent a positional
- * parameter in the body of a function definition or a prepared statement.
- * In other contexts the dollar sign can be part of an identifier or a
- * dollar-quoted string constant.
- *
- * - The colon (":") is used to select "slices" from arrays. In certain SQL
- * dialects (such as Embedded SQL), the colon is used to prefix variable
- * names.
- * [In Pgfe ":" is user to prefix named parameters and placeholders.]
- *
- * - Brackets ([]) are used to select the elements of an array.
- */
-
 /**
  * @returns Preparsed SQL string in pair with the pointer to a character
  * that follows returned SQL string.
  */
 DMITIGR_PGFE_INLINE std::pair<Statement, std::string_view::size_type>
-Statement::parse_sql_input(const std::string_view text)
+Statement::parse_sql_input(const std::string_view text,
+  bool* const is_terminated)
 {
-  enum {
-    top,
-
-    bracket,
-
-    colon,
-    named_parameter,
-
-    dollar,
-    positional_parameter,
-    dollar_quote_leading_tag,
-    dollar_quote,
-    dollar_quote_dollar,
-
-    quote,
-    quote_quote,
-
-    dash,
-    one_line_comment,
-
-    slash,
-    multi_line_comment,
-    multi_line_comment_star
-  } state = top;
-
   Statement result;
-  int depth{};
-  char current_char{};
-  char previous_char{};
-  char quote_char{};
-  std::string fragment;
-  std::string dollar_quote_leading_tag_name;
-  std::string dollar_quote_trailing_tag_name;
-  const auto b = cbegin(text);
-  auto i = b;
-  for (const auto e = cend(text); i != e; previous_char = current_char, ++i) {
-    current_char = *i;
-    switch (state) {
-    case top:
-      switch (current_char) {
-      case '\'':
-        state = quote;
-        quote_char = current_char;
-        fragment += current_char;
-        continue;
-
-      case '"':
-        state = quote;
-        quote_char = current_char;
-        fragment += current_char;
-        continue;
-
-      case '[':
-        state = bracket;
-        depth = 1;
-        fragment += current_char;
-        continue;
-
-      case '$':
-        if (!is_ident_char(previous_char))
-          state = dollar;
-        else
-          fragment += current_char;
-
-        continue;
-
-      case ':':
-        if (previous_char != ':')
-          state = colon;
-        else
-          fragment += current_char;
-
-        continue;
-
-      case '-':
-        state = dash;
-        continue;
-
-      case '/':
-        state = slash;
-        continue;
-
-      case ';':
-        goto finish;
-
-      default:
-        fragment += current_char;
-        continue;
-      } // switch (current_char)
-
-    case bracket:
-      if (current_char == ']')
-        --depth;
-      else if (current_char == '[')
-        ++depth;
-
-      if (depth == 0) {
-        DMITIGR_ASSERT(current_char == ']');
-        state = top;
-      }
-
-      fragment += current_char;
-      continue;
-
-    case dollar:
-      DMITIGR_ASSERT(previous_char == '$');
-      if (isdigit(static_cast<unsigned char>(current_char))) {
-        state = positional_parameter;
-        result.push_text(fragment);
-        fragment.clear();
-        // The 1st digit of positional parameter (current_char) will be stored below.
-      } else if (is_ident_char(current_char)) {
-        if (current_char == '$') {
-          state = dollar_quote;
-        } else {
-          state = dollar_quote_leading_tag;
-          dollar_quote_leading_tag_name += current_char;
-        }
-        fragment += previous_char;
-      } else {
-        state = top;
-        fragment += previous_char;
-      }
-
-      fragment += current_char;
-      continue;
-
-    case positional_parameter:
-      DMITIGR_ASSERT(isdigit(static_cast<unsigned char>(previous_char)));
-      if (!isdigit(static_cast<unsigned char>(current_char))) {
-        state = top;
-        result.push_positional_parameter(fragment);
-        fragment.clear();
-      }
-
-      if (current_char != ';') {
-        fragment += current_char;
-        continue;
-      } else
-        goto finish;
-
-    case dollar_quote_leading_tag:
-      DMITIGR_ASSERT(previous_char != '$' && is_ident_char(previous_char));
-      if (current_char == '$') {
-        fragment += current_char;
-        state = dollar_quote;
-      } else if (is_ident_char(current_char)) {
-        dollar_quote_leading_tag_name += current_char;
-        fragment += current_char;
-      } else
-        throw Client_exception{"invalid dollar quote tag"};
-
-      continue;
-
-    case dollar_quote:
-      if (current_char == '$')
-        state = dollar_quote_dollar;
-
-      fragment += current_char;
-      continue;
-
-    case dollar_quote_dollar:
-      if (current_char == '$') {
-        if (dollar_quote_leading_tag_name == dollar_quote_trailing_tag_name) {
-          state = top;
-          dollar_quote_leading_tag_name.clear();
-        } else
-          state = dollar_quote;
-
-        dollar_quote_trailing_tag_name.clear();
-      } else
-        dollar_quote_trailing_tag_name += current_char;
-
-      fragment += current_char;
-      continue;
-
-    case colon:
-      DMITIGR_ASSERT(previous_char == ':');
-      if (is_ident_char(current_char) || is_quote_char(current_char)) {
-        state = named_parameter;
-        result.push_text(fragment);
-        fragment.clear();
-        // The 1st character of the named parameter (current_char) will be stored below.
-      } else {
-        state = top;
-        fragment += previous_char;
-      }
-
-      if (state == named_parameter && is_quote_char(current_char)) {
-        quote_char = current_char;
-        continue;
-      } else if (current_char != ';') {
-        fragment += current_char;
-        continue;
-      } else
-        goto finish;
-
-    case named_parameter:
-      DMITIGR_ASSERT(is_ident_char(previous_char) ||
-        (is_quote_char(previous_char) && quote_char));
-
-      if (!is_ident_char(current_char)) {
-        state = top;
-        result.push_named_parameter(fragment, quote_char);
-        fragment.clear();
-      }
-
-      if (current_char == quote_char) {
-        quote_char = 0;
-        continue;
-      } if (current_char != ';') {
-        fragment += current_char;
-        continue;
-      } else
-        goto finish;
-
-    case quote:
-      if (current_char == quote_char)
-        state = quote_quote;
-      else
-        fragment += current_char;
-
-      continue;
-
-    case quote_quote:
-      DMITIGR_ASSERT(previous_char == quote_char);
-      if (current_char == quote_char) {
-        state = quote;
-        // Skip previous quote.
-      } else {
-        state = top;
-        quote_char = 0;
-        fragment += previous_char; // store previous quote
-      }
-
-      if (current_char != ';') {
-        fragment += current_char;
-        continue;
-      } else
-        goto finish;
-
-    case dash:
-      DMITIGR_ASSERT(previous_char == '-');
-      if (current_char == '-') {
-        state = one_line_comment;
-        result.push_text(fragment);
-        fragment.clear();
-        // The comment marker ("--") will not be included in the next fragment.
-      } else {
-        state = top;
-        fragment += previous_char;
-
-        if (current_char != ';') {
-          fragment += current_char;
-          continue;
-        } else
-          goto finish;
-      }
-
-      continue;
-
-    case one_line_comment:
-      if (current_char == '\n') {
-        state = top;
-        if (!fragment.empty() && fragment.back() == '\r')
-          fragment.pop_back();
-        result.push_one_line_comment(fragment);
-        fragment.clear();
-      } else
-        fragment += current_char;
-
-      continue;
-
-    case slash:
-      DMITIGR_ASSERT(previous_char == '/');
-      if (current_char == '*') {
-        state = multi_line_comment;
-        if (depth > 0) {
-          fragment += previous_char;
-          fragment += current_char;
-        } else {
-          result.push_text(fragment);
-          fragment.clear();
-          // The comment marker ("/*") will not be included in the next fragment.
-        }
-        ++depth;
-      } else {
-        state = (depth == 0) ? top : multi_line_comment;
-        fragment += previous_char;
-        fragment += current_char;
-      }
-
-      continue;
-
-    case multi_line_comment:
-      if (current_char == '/') {
-        state = slash;
-      } else if (current_char == '*') {
-        state = multi_line_comment_star;
-      } else
-        fragment += current_char;
-
-      continue;
-
-    case multi_line_comment_star:
-      DMITIGR_ASSERT(previous_char == '*');
-      if (current_char == '/') {
-        --depth;
-        if (depth == 0) {
-          state = top;
-          result.push_multi_line_comment(fragment); // without trailing "*/"
-          fragment.clear();
-        } else {
-          state = multi_line_comment;
-          fragment += previous_char; // '*'
-          fragment += current_char;  // '/'
-        }
-      } else {
-        state = multi_line_comment;
-        fragment += previous_char;
-        fragment += current_char;
-      }
-
-      continue;
-    } // switch (state)
-  } // for
-
- finish:
-  switch (state) {
-  case top:
-    if (current_char == ';')
-      ++i;
-    if (!fragment.empty())
-      result.push_text(fragment);
-    break;
-  case quote_quote:
-    fragment += previous_char;
-    result.push_text(fragment);
-    break;
-  case one_line_comment:
-    result.push_one_line_comment(fragment);
-    break;
-  case positional_parameter:
-    result.push_positional_parameter(fragment);
-    break;
-  case named_parameter:
-    if (!quote_char) {
-      result.push_named_parameter(fragment, quote_char);
-      break;
-    }
-    [[fallthrough]];
-  default: {
-    std::string message{"invalid SQL input"};
-    if (!result.fragments_.empty())
-      message.append(" after: ").append(result.fragments_.back().str);
-    throw Client_exception{message};
-  }
-  }
-
-  return std::make_pair(result, i - b);
+  const auto size = detail::parse_sql_input(text,
+    [&result, &text](const Fragment::Type type, const std::size_t offset,
+      const std::size_t size)
+    {
+      // The text of the result is extended on demand.
+      const auto end = offset + size;
+      if (const auto text_size = result.text_.size(); text_size < end)
+        result.text_.append(text.data() + text_size, end - text_size);
+      result.push_fragment(type, offset, size);
+    }, is_terminated);
+  return std::make_pair(std::move(result), size);
 }
 
 } // namespace dmitigr::pgfe
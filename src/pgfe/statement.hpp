@@ -20,15 +20,17 @@
 #include "basics.hpp"
 #include "dll.hpp"
 #include "parameterizable.hpp"
+#include "statement_parser.hpp"
 #include "tuple.hpp"
 #include "types_fwd.hpp"
 
+#include <array>
 #include <cctype>
 #include <cstdint>
-#include <list>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -290,6 +292,10 @@ public:
    *
    * @par Requires
    * `!has_missing_parameters() && conn.is_connected()`.
+   *
+   * @remarks The connection caches the query strings of the executed
+   * statements until they are modified by bind(), replace_parameter() or
+   * append(), so the same statement is not rendered on every execution.
    */
   DMITIGR_PGFE_API std::string to_query_string(const Connection& conn) const;
 
@@ -391,38 +397,64 @@ public:
   DMITIGR_PGFE_API Tuple& extra() noexcept;
 
 private:
+  friend Connection;
+  friend Query_catalog;
+  friend Statement_binding;
+  friend Statement_reader;
   friend Statement_vector;
+  template<std::size_t> friend class Static_statement;
 
   /// A fragment.
   struct Fragment final {
-    enum class Type {
-      text,
-      one_line_comment,
-      multi_line_comment,
-      named_parameter,
-      named_parameter_literal,
-      named_parameter_identifier,
-      positional_parameter
-    };
-
-    Fragment(const Type tp, const std::string& s);
+    using Type = detail::Statement_fragment_type;
+
+    Fragment(Type tp, std::size_t off, std::size_t sz) noexcept;
     bool is_named_parameter() const noexcept;
-    bool is_named_parameter(const std::string_view name) const noexcept;
 
     Type type;
-    std::string str;
+    std::size_t offset{}; // the offset of the fragment text in text_
+    std::size_t size{}; // the size of the fragment text
     std::optional<std::string> value;
   };
-  using Fragment_list = std::list<Fragment>;
+  using Fragment_list = std::vector<Fragment>;
 
+  std::string text_; // the storage of texts of all the fragments
   Fragment_list fragments_;
   std::vector<bool> positional_parameters_; // cache
-  std::vector<Fragment_list::const_iterator> named_parameters_; // cache
+  std::vector<std::size_t> named_parameters_; // cache (indexes of fragments_)
+  /*
+   * Cache (hash of name -> index of named_parameters_). Keyed by hash rather
+   * than by std::string_view since views into text_ are not preserved across
+   * copies and moves (small string optimization).
+   */
+  std::unordered_multimap<std::size_t, std::size_t> named_parameter_indexes_;
   mutable bool is_extra_data_should_be_extracted_from_comments_{true};
   mutable std::optional<Tuple> extra_; // cache
+  /*
+   * The identifier of the content of this instance, which is changed upon
+   * each modification and is preserved by copying. (The key of the cache of
+   * query strings of Connection.)
+   */
+  std::uint64_t revision_{next_revision()};
+
+  /// Constructs from the fragments of Static_statement.
+  DMITIGR_PGFE_API Statement(std::string_view text,
+    const detail::Statement_fragment* fragments, std::size_t fragment_count);
 
   static std::pair<Statement, std::string_view::size_type>
-  parse_sql_input(std::string_view);
+  parse_sql_input(std::string_view, bool* is_terminated = nullptr);
+
+  std::string_view fragment_text(const Fragment& f) const noexcept;
+
+  /**
+   * Appends the query string to the `result` without caching. The `values`,
+   * if not null, are indexed by the parameter indexes and override the values
+   * bound to the named parameters.
+   *
+   * @returns `true` if the result depends on the session of `conn`.
+   */
+  bool append_query_string(std::string& result, const Connection& conn,
+    const std::optional<std::string>* values) const;
 
   bool is_invariant_ok() const noexcept override;
 
@@ -430,12 +462,13 @@ private:
   // Initializers
   // ---------------------------------------------------------------------------
 
-  void push_back_fragment(const Fragment::Type type, const std::string& str);
-  void push_text(const std::string& str);
-  void push_one_line_comment(const std::string& str);
-  void push_multi_line_comment(const std::string& str);
-  void push_positional_parameter(const std::string& str);
-  void push_named_parameter(const std::string& str, char quote_char);
+  void push_back_fragment(Fragment::Type type, std::size_t offset,
+    std::size_t size);
+  void push_fragment(Fragment::Type type, std::size_t offset,
+    std::size_t size);
+  void push_positional_parameter(std::size_t offset, std::size_t size);
+  void push_named_parameter(Fragment::Type type, std::size_t offset,
+    std::size_t size);
 
   // ---------------------------------------------------------------------------
   // Updaters
@@ -443,6 +476,8 @@ private:
 
   // Exception safety guarantee: strong.
   void update_cache(const Statement& rhs);
+  void revise() noexcept;
+  static std::uint64_t next_revision() noexcept;
 
   // ---------------------------------------------------------------------------
   // Named parameters helpers
@@ -450,16 +485,18 @@ private:
 
   Fragment::Type named_parameter_type(const std::size_t index) const noexcept;
   std::size_t named_parameter_index(const std::string_view name) const noexcept;
-  std::vector<Fragment_list::const_iterator> named_parameters() const;
+  std::vector<std::size_t> named_parameters() const;
+  std::unordered_multimap<std::size_t, std::size_t>
+  named_parameter_indexes(const std::vector<std::size_t>& params) const;
 
   // ---------------------------------------------------------------------------
   // Predicates
   // ---------------------------------------------------------------------------
 
+  bool is_named_parameter(const Fragment& f,
+    std::string_view name) const noexcept;
   static bool is_comment(const Fragment& f) noexcept;
   static bool is_text(const Fragment& f) noexcept;
-  static bool is_ident_char(const unsigned char c) noexcept;
-  static bool is_quote_char(const unsigned char c) noexcept;
 
   // ---------------------------------------------------------------------------
   // Extra data
@@ -479,6 +516,165 @@ inline void swap(Statement& lhs, Statement& rhs) noexcept
   lhs.swap(rhs);
 }
 
+/**
+ * @ingroup utilities
+ *
+ * @brief A SQL string preparsed at compile time.
+ *
+ * @details The syntax is the same as of Statement. Since the parsing is
+ * performed at compile time, an invalid SQL input results in the compilation
+ * error, and the conversion to Statement doesn't require the parsing. For
+ * example:
+ *
+ * @code
+ * static constexpr Static_statement query{"SELECT :a, $1"};
+ * static_assert(query.parameter_count() == 2);
+ * conn.execute<query>([](auto&& row){}, 1, 2); // the argument count is checked
+ * @endcode
+ *
+ * @par Requires
+ * The instance must be constructed from the string literal, since the
+ * instance refers to it.
+ *
+ * @see Connection::execute().
+ */
+template<std::size_t N>
+class Static_statement final {
+public:
+  /// The constructor.
+  constexpr Static_statement(const char (&text)[N])
+    : text_{text, N - 1}
+  {
+    using Ft = detail::Statement_fragment_type;
+    const auto size = detail::parse_sql_input(text_,
+      [this](const Ft type, const std::size_t offset, const std::size_t size)
+      {
+        auto& fragment = fragments_[fragment_count_++];
+        fragment.type = type;
+        fragment.offset = static_cast<std::uint32_t>(offset);
+        fragment.size = static_cast<std::uint32_t>(size);
+      });
+    text_ = text_.substr(0, size);
+
+    for (std::size_t i{}; i < fragment_count_; ++i) {
+      if (fragments_[i].type == Ft::positional_parameter) {
+        const auto position = to_position(fragments_[i]);
+        if (position < 1 || position > max_parameter_count())
+          detail::throw_invalid_sql_input("invalid parameter position",
+            fragment_text(fragments_[i]));
+        else if (position > positional_parameter_count_)
+          positional_parameter_count_ = position;
+      } else if (is_named_parameter(fragments_[i]) &&
+        is_first_named_parameter(i))
+        ++named_parameter_count_;
+    }
+    if (parameter_count() > max_parameter_count())
+      detail::throw_invalid_sql_input("maximum parameters count exceeded");
+  }
+
+  /// @returns The maximum parameter count allowed.
+  static constexpr std::size_t max_parameter_count() noexcept
+  {
+    return Parameterizable::max_parameter_count();
+  }
+
+  /// @returns The number of positional parameters.
+  constexpr std::size_t positional_parameter_count() const noexcept
+  {
+    return positional_parameter_count_;
+  }
+
+  /// @returns The number of named parameters.
+  constexpr std::size_t named_parameter_count() const noexcept
+  {
+    return named_parameter_count_;
+  }
+
+  /// @returns The number of parameters.
+  constexpr std::size_t parameter_count() const noexcept
+  {
+    return positional_parameter_count_ + named_parameter_count_;
+  }
+
+  /// @returns `true` if this instance has a positional parameter missing.
+  constexpr bool has_missing_parameters() const noexcept
+  {
+    for (std::size_t p{1}; p <= positional_parameter_count_; ++p) {
+      bool is_present{};
+      for (std::size_t i{}; i < fragment_count_ && !is_present; ++i)
+        is_present = fragments_[i].type ==
+          detail::Statement_fragment_type::positional_parameter &&
+          to_position(fragments_[i]) == p;
+      if (!is_present)
+        return true;
+    }
+    return false;
+  }
+
+  /// @returns The preparsed SQL string.
+  constexpr std::string_view text() const noexcept
+  {
+    return text_;
+  }
+
+  /// @returns The instance of Statement without parsing.
+  Statement to_statement() const
+  {
+    return Statement{text_, fragments_.data(), fragment_count_};
+  }
+
+  /// @returns `to_statement()`.
+  operator Statement() const
+  {
+    return to_statement();
+  }
+
+private:
+  std::string_view text_;
+  std::array<detail::Statement_fragment, N> fragments_{};
+  std::size_t fragment_count_{};
+  std::size_t positional_parameter_count_{};
+  std::size_t named_parameter_count_{};
+
+  constexpr std::string_view
+  fragment_text(const detail::Statement_fragment& f) const noexcept
+  {
+    return text_.substr(f.offset, f.size);
+  }
+
+  static constexpr bool
+  is_named_parameter(const detail::Statement_fragment& f) noexcept
+  {
+    using Ft = detail::Statement_fragment_type;
+    return f.type == Ft::named_parameter ||
+      f.type == Ft::named_parameter_literal ||
+      f.type == Ft::named_parameter_identifier;
+  }
+
+  constexpr bool is_first_named_parameter(const std::size_t index) const noexcept
+  {
+    const auto name = fragment_text(fragments_[index]);
+    for (std::size_t i{}; i < index; ++i) {
+      if (is_named_parameter(fragments_[i]) &&
+        fragment_text(fragments_[i]) == name)
+        return false;
+    }
+    return true;
+  }
+
+  constexpr std::size_t
+  to_position(const detail::Statement_fragment& f) const noexcept
+  {
+    std::size_t result{};
+    for (const char c : fragment_text(f)) {
+      result = result * 10 + static_cast<std::size_t>(c - '0');
+      if (result > max_parameter_count())
+        break;
+    }
+    return result;
+  }
+};
+
 } // namespace dmitigr::pgfe
 
 #ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
@@ -0,0 +1,111 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "statement_binding.hpp"
+
+#include <algorithm>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Statement_binding::Statement_binding(std::shared_ptr<const Statement> statement)
+  : statement_{std::move(statement)}
+{
+  if (!statement_)
+    throw Client_exception{"cannot create statement binding: "
+      "invalid statement"};
+  values_.resize(statement_->parameter_count());
+}
+
+DMITIGR_PGFE_INLINE const std::shared_ptr<const Statement>&
+Statement_binding::statement() const noexcept
+{
+  return statement_;
+}
+
+DMITIGR_PGFE_INLINE Statement_binding&
+Statement_binding::bind(const std::string_view name,
+  std::optional<std::string> value)
+{
+  values_[parameter_index(name, "cannot bind parameter of statement binding")]
+    = std::move(value);
+  return *this;
+}
+
+DMITIGR_PGFE_INLINE const std::optional<std::string>&
+Statement_binding::bound(const std::string_view name) const
+{
+  const auto& value = values_[parameter_index(name,
+    "cannot get bound parameter of statement binding")];
+  return value ? value : statement_->bound(name);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_binding::bound_parameter_count() const noexcept
+{
+  return static_cast<std::size_t>(std::count_if(values_.cbegin(),
+    values_.cend(), [](const auto& value){return value.has_value();}));
+}
+
+DMITIGR_PGFE_INLINE bool Statement_binding::has_bound_parameters() const noexcept
+{
+  return std::any_of(values_.cbegin(), values_.cend(),
+    [](const auto& value){return value.has_value();});
+}
+
+DMITIGR_PGFE_INLINE void Statement_binding::clear() noexcept
+{
+  for (auto& value : values_)
+    value.reset();
+}
+
+DMITIGR_PGFE_INLINE void
+Statement_binding::append_query_string(std::string& result,
+  const Connection& conn) const
+{
+  if (statement_->has_missing_parameters())
+    throw Client_exception{"cannot convert statement binding to query string: "
+      "has missing parameters"};
+  else if (!conn.is_connected())
+    throw Client_exception{"cannot convert statement binding to query string: "
+      "not connected"};
+
+  statement_->append_query_string(result, conn, values_.data());
+}
+
+DMITIGR_PGFE_INLINE std::string
+Statement_binding::to_query_string(const Connection& conn) const
+{
+  std::string result;
+  append_query_string(result, conn);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_binding::parameter_index(const std::string_view name,
+  const char* const what) const
+{
+  const auto result = statement_->parameter_index(name);
+  if (!(result < values_.size()) ||
+    result < statement_->positional_parameter_count())
+    throw Client_exception{std::string{what}.append(": no parameter named ")
+      .append(name)};
+  return result;
+}
+
+} // namespace dmitigr::pgfe
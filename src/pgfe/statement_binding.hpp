@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_BINDING_HPP
+#define DMITIGR_PGFE_STATEMENT_BINDING_HPP
+
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief The values bound to the named parameters of the shared immutable
+ * Statement for a single call.
+ *
+ * @details Since Statement::bind() modifies the statement, a statement with
+ * the named parameters which are substituted by values (such as quoted
+ * literals or identifiers) has to be copied per request in order to be used
+ * from multiple threads. Instead, the statement can be parsed once and shared
+ * as a template, while the values are bound to a lightweight instance of this
+ * class, for example:
+ * @code
+ * static const auto tmpl = std::make_shared<const Statement>(
+ *   "select * from :\"table\" where id = $1");
+ * // Per call (possibly from multiple threads).
+ * Statement_binding binding{tmpl};
+ * binding.bind("table", "person");
+ * conn.execute(binding, 42);
+ * @endcode
+ * The values bound to the template itself are used for the parameters which
+ * are not bound to the binding.
+ *
+ * @par Thread safety
+ * The template is only read, so it can be shared by the instances used by the
+ * different threads. (Provided the template itself is not modified.) An
+ * instance of this class is not thread-safe.
+ *
+ * @see Connection::execute(F&&, const Statement_binding&, Types&& ...).
+ */
+class Statement_binding final {
+public:
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `statement`.
+   */
+  DMITIGR_PGFE_API explicit
+  Statement_binding(std::shared_ptr<const Statement> statement);
+
+  /// @returns The template.
+  DMITIGR_PGFE_API const std::shared_ptr<const Statement>&
+  statement() const noexcept;
+
+  /**
+   * @brief Binds the parameter named by the `name` with the specified `value`.
+   *
+   * @details Binding `std::nullopt` resets the parameter to the value bound
+   * to the template.
+   *
+   * @returns `*this`.
+   *
+   * @par Requires
+   * `statement()->has_parameter(name)`.
+   *
+   * @see Statement::bind().
+   */
+  DMITIGR_PGFE_API Statement_binding&
+  bind(std::string_view name, std::optional<std::string> value);
+
+  /**
+   * @returns The value bound to the parameter either by this instance, or to
+   * the template.
+   *
+   * @par Requires
+   * `statement()->has_parameter(name)`.
+   */
+  DMITIGR_PGFE_API const std::optional<std::string>&
+  bound(std::string_view name) const;
+
+  /// @returns The number of parameters bound by this instance.
+  DMITIGR_PGFE_API std::size_t bound_parameter_count() const noexcept;
+
+  /// @returns `bound_parameter_count() > 0`.
+  DMITIGR_PGFE_API bool has_bound_parameters() const noexcept;
+
+  /// Resets the values bound by this instance.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /**
+   * @brief Appends the query string that's actually passed to a PostgreSQL
+   * server to the `result`.
+   *
+   * @details Unlike Statement::to_query_string() the result is not cached,
+   * so the buffer can be reused across the calls.
+   *
+   * @par Requires
+   * `!statement()->has_missing_parameters() && conn.is_connected()`.
+   */
+  DMITIGR_PGFE_API void append_query_string(std::string& result,
+    const Connection& conn) const;
+
+  /// @returns The query string that's actually passed to a PostgreSQL server.
+  DMITIGR_PGFE_API std::string to_query_string(const Connection& conn) const;
+
+private:
+  friend Connection;
+
+  std::shared_ptr<const Statement> statement_;
+  std::vector<std::optional<std::string>> values_; // by parameter indexes
+
+  std::size_t parameter_index(std::string_view name, const char* what) const;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "statement_binding.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_STATEMENT_BINDING_HPP
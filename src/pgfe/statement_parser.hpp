@@ -0,0 +1,495 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_PARSER_HPP
+#define DMITIGR_PGFE_STATEMENT_PARSER_HPP
+
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dmitigr::pgfe::detail {
+
+/// A type of a fragment of the preparsed SQL string.
+enum class Statement_fragment_type {
+  text,
+  one_line_comment,
+  multi_line_comment,
+  named_parameter,
+  named_parameter_literal,
+  named_parameter_identifier,
+  positional_parameter
+};
+
+/// A fragment of the preparsed SQL string.
+struct Statement_fragment final {
+  Statement_fragment_type type{};
+  std::uint32_t offset{}; // the offset of the fragment text
+  std::uint32_t size{}; // the size of the fragment text
+};
+
+/// @returns `true` if `c` is a decimal digit.
+constexpr bool is_sql_digit(const char c) noexcept
+{
+  return '0' <= c && c <= '9';
+}
+
+/// @returns `true` if `c` is a valid character of unquoted identifier.
+constexpr bool is_sql_ident_char(const char c) noexcept
+{
+  return is_sql_digit(c) || ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+    c == '_' || c == '$';
+}
+
+/// @returns `true` if `c` is a quote character.
+constexpr bool is_sql_quote_char(const char c) noexcept
+{
+  return c == '\'' || c == '\"';
+}
+
+/// Throws the exception of invalid SQL input.
+[[noreturn]] inline void throw_invalid_sql_input(const char* const what,
+  const std::string_view after = {})
+{
+  std::string message{what};
+  if (!after.empty())
+    message.append(" after: ").append(after);
+  throw Client_exception{message};
+}
+
+/*
+ * SQL SYNTAX BASICS (from PostgreSQL documentation):
+ * https://www.postgresql.org/docs/current/static/sql-syntax-lexical.html
+ *
+ * COMMANDS
+ *
+ * A command is composed of a sequence of tokens, terminated by a (";").
+ * A token can be a key word, an identifier, a quoted identifier,
+ * a literal (or constant), or a special character symbol. Tokens are normally
+ * separated by whitespace (space, tab, newline), but need not be if there is no
+ * ambiguity.
+ *
+ * IDENTIFIERS (UNQUOTED)
+ *
+ * SQL identifiers and key words must begin with a letter (a-z, but also
+ * letters with diacritical marks and non-Latin letters) or an ("_").
+ * Subsequent characters in an identifier or key word can be letters,
+ * underscores, digits (0-9), or dollar signs ($).
+ *
+ * QUOTED IDENTIFIERS
+ *
+ * The delimited identifier or quoted identifier is formed by enclosing an
+ * arbitrary sequence of characters in double-quotes ("). Quoted identifiers can
+ * contain any character, except the character with code zero. (To include a
+ * double quote, two double quotes should be written.)
+ *
+ * CONSTANTS
+ *
+ *   STRING CONSTANTS (QUOTED LITERALS)
+ *
+ * A string constant in SQL is an arbitrary sequence of characters bounded
+ * by single quotes ('), for example 'This is a string'. To include a
+ * single-quote character within a string constant, write two adjacent
+ * single quotes, e.g., 'Dianne''s horse'.
+ *
+ *   DOLLAR QUOTED STRING CONSTANTS
+ *
+ * A dollar-quoted string constant consists of a dollar sign ($), an
+ * optional "tag" of zero or more characters, another dollar sign, an
+ * arbitrary sequence of characters that makes up the string content, a
+ * dollar sign, the same tag that began this dollar quote, and a dollar
+ * sign.
+ * The tag, if any, of a dollar-quoted string follows the same rules
+ * as an unquoted identifier, except that it cannot contain a dollar sign.
+ * A dollar-quoted string that follows a keyword or identifier must be
+ * separated from it by whitespace; otherwise the dollar quoting delimiter
+ * would be taken as part of the preceding identifier.
+ *
+ * SPECIAL CHARACTERS
+ *
+ * - A dollar sign ("$") followed by digits is used to represent a positional
+ * parameter in the body of a function definition or a prepared statement.
+ * In other contexts the dollar sign can be part of an identifier or a
+ * dollar-quoted string constant.
+ *
+ * - The colon (":") is used to select "slices" from arrays. In certain SQL
+ * dialects (such as Embedded SQL), the colon is used to prefix variable
+ * names.
+ * [In Pgfe ":" is user to prefix named parameters and placeholders.]
+ *
+ * - Brackets ([]) are used to select the elements of an array.
+ */
+
+/**
+ * @brief Parses the SQL input up to either the first top-level semicolon or
+ * the end of `text`.
+ *
+ * @param handler A function which is called for each fragment as
+ * `handler(type, offset, size)`, where `offset` and `size` denote the text of
+ * the fragment in `text`.
+ *
+ * @param is_terminated If not null, then it's set to `true` if the input
+ * is terminated by the top-level semicolon, or to `false` otherwise. In the
+ * latter case the input is considered as incomplete (for example, as the
+ * first part of a statement being read by chunks), so neither the trailing
+ * fragment is reported nor the exception of invalid (unterminated) input is
+ * thrown.
+ *
+ * @returns The number of characters consumed (including the semicolon, if
+ * any).
+ *
+ * @remarks This function can be evaluated at compile time. In this case the
+ * invalid SQL input results in the compilation error.
+ */
+template<class Handler>
+constexpr std::size_t parse_sql_input(const std::string_view text,
+  Handler&& handler, bool* const is_terminated = nullptr)
+{
+  using Ft = Statement_fragment_type;
+
+  enum {
+    top,
+
+    bracket,
+
+    colon,
+    named_parameter,
+
+    dollar,
+    positional_parameter,
+    dollar_quote_leading_tag,
+    dollar_quote,
+    dollar_quote_dollar,
+
+    quote,
+    quote_quote,
+
+    dash,
+    one_line_comment,
+
+    slash,
+    multi_line_comment,
+    multi_line_comment_star
+  } state = top;
+
+  int depth{};
+  char current_char{};
+  char previous_char{};
+  char quote_char{};
+  std::size_t fragment_offset{};
+  std::size_t last_fragment_offset{};
+  std::size_t last_fragment_size{};
+  std::size_t dollar_quote_leading_tag_offset{};
+  std::size_t dollar_quote_leading_tag_size{};
+  std::size_t dollar_quote_trailing_tag_offset{};
+  const std::size_t size{text.size()};
+  std::size_t pos{};
+  bool is_finished{};
+
+  // Calls the handler for the fragment [fragment_offset, end).
+  const auto push = [&](const Ft type, const std::size_t end)
+  {
+    last_fragment_offset = fragment_offset;
+    last_fragment_size = end - fragment_offset;
+    handler(type, last_fragment_offset, last_fragment_size);
+  };
+
+  for (; pos < size; previous_char = current_char, ++pos) {
+    current_char = text[pos];
+    switch (state) {
+    case top:
+      switch (current_char) {
+      case '\'':
+        [[fallthrough]];
+      case '"':
+        state = quote;
+        quote_char = current_char;
+        continue;
+
+      case '[':
+        state = bracket;
+        depth = 1;
+        continue;
+
+      case '$':
+        if (!is_sql_ident_char(previous_char))
+          state = dollar;
+        continue;
+
+      case ':':
+        if (previous_char != ':')
+          state = colon;
+        continue;
+
+      case '-':
+        state = dash;
+        continue;
+
+      case '/':
+        state = slash;
+        continue;
+
+      case ';':
+        is_finished = true;
+        break;
+
+      default:
+        continue;
+      } // switch (current_char)
+      break;
+
+    case bracket:
+      if (current_char == ']')
+        --depth;
+      else if (current_char == '[')
+        ++depth;
+
+      if (depth == 0)
+        state = top;
+
+      continue;
+
+    case dollar:
+      if (is_sql_digit(current_char)) {
+        state = positional_parameter;
+        push(Ft::text, pos - 1);
+        // The 1st digit of positional parameter (current_char) starts the next fragment.
+        fragment_offset = pos;
+      } else if (is_sql_ident_char(current_char)) {
+        if (current_char == '$') {
+          state = dollar_quote;
+          dollar_quote_leading_tag_size = 0;
+        } else {
+          state = dollar_quote_leading_tag;
+          dollar_quote_leading_tag_offset = pos;
+          dollar_quote_leading_tag_size = 1;
+        }
+      } else
+        state = top;
+
+      continue;
+
+    case positional_parameter:
+      if (!is_sql_digit(current_char)) {
+        state = top;
+        push(Ft::positional_parameter, pos);
+        fragment_offset = pos;
+      }
+
+      if (current_char != ';')
+        continue;
+      is_finished = true;
+      break;
+
+    case dollar_quote_leading_tag:
+      if (current_char == '$')
+        state = dollar_quote;
+      else if (is_sql_ident_char(current_char))
+        ++dollar_quote_leading_tag_size;
+      else
+        throw_invalid_sql_input("invalid dollar quote tag");
+
+      continue;
+
+    case dollar_quote:
+      if (current_char == '$') {
+        state = dollar_quote_dollar;
+        dollar_quote_trailing_tag_offset = pos + 1;
+      }
+
+      continue;
+
+    case dollar_quote_dollar:
+      if (current_char == '$') {
+        const auto leading_tag = text.substr(dollar_quote_leading_tag_offset,
+          dollar_quote_leading_tag_size);
+        const auto trailing_tag = text.substr(dollar_quote_trailing_tag_offset,
+          pos - dollar_quote_trailing_tag_offset);
+        if (leading_tag == trailing_tag)
+          state = top;
+        else {
+          state = dollar_quote;
+          dollar_quote_trailing_tag_offset = pos + 1;
+        }
+      }
+
+      continue;
+
+    case colon:
+      if (is_sql_ident_char(current_char) || is_sql_quote_char(current_char)) {
+        state = named_parameter;
+        push(Ft::text, pos - 1);
+        // The 1st character of the named parameter (current_char) starts the next fragment.
+        fragment_offset = pos;
+      } else
+        state = top;
+
+      if (state == named_parameter && is_sql_quote_char(current_char)) {
+        quote_char = current_char;
+        fragment_offset = pos + 1; // the quote is not a part of the name
+        continue;
+      } else if (current_char != ';')
+        continue;
+      is_finished = true;
+      break;
+
+    case named_parameter:
+      if (!is_sql_ident_char(current_char)) {
+        state = top;
+        push(quote_char == '\'' ? Ft::named_parameter_literal :
+          quote_char == '"' ? Ft::named_parameter_identifier :
+          Ft::named_parameter, pos);
+        fragment_offset = pos;
+      }
+
+      if (current_char == quote_char) {
+        quote_char = 0;
+        fragment_offset = pos + 1; // the quote is not a part of the text
+        continue;
+      } else if (current_char != ';')
+        continue;
+      is_finished = true;
+      break;
+
+    case quote:
+      if (current_char == quote_char)
+        state = quote_quote;
+
+      continue;
+
+    case quote_quote:
+      if (current_char == quote_char) {
+        state = quote; // escaped quote
+      } else {
+        state = top;
+        quote_char = 0;
+      }
+
+      if (current_char != ';')
+        continue;
+      is_finished = true;
+      break;
+
+    case dash:
+      if (current_char == '-') {
+        state = one_line_comment;
+        push(Ft::text, pos - 1);
+        // The comment marker ("--") will not be included in the next fragment.
+        fragment_offset = pos + 1;
+        continue;
+      }
+
+      state = top;
+      if (current_char != ';')
+        continue;
+      is_finished = true;
+      break;
+
+    case one_line_comment:
+      if (current_char == '\n') {
+        state = top;
+        const auto end = (pos > fragment_offset && text[pos - 1] == '\r') ?
+          pos - 1 : pos;
+        push(Ft::one_line_comment, end);
+        fragment_offset = pos + 1; // the newline is not a part of the text
+      }
+
+      continue;
+
+    case slash:
+      if (current_char == '*') {
+        state = multi_line_comment;
+        if (depth == 0) {
+          push(Ft::text, pos - 1);
+          // The comment marker ("/*") will not be included in the next fragment.
+          fragment_offset = pos + 1;
+        }
+        ++depth;
+      } else
+        state = (depth == 0) ? top : multi_line_comment;
+
+      continue;
+
+    case multi_line_comment:
+      if (current_char == '/')
+        state = slash;
+      else if (current_char == '*')
+        state = multi_line_comment_star;
+
+      continue;
+
+    case multi_line_comment_star:
+      if (current_char == '/') {
+        --depth;
+        if (depth == 0) {
+          state = top;
+          push(Ft::multi_line_comment, pos - 1); // without trailing "*/"
+          fragment_offset = pos + 1;
+        } else
+          state = multi_line_comment;
+      } else
+        state = multi_line_comment;
+
+      continue;
+    } // switch (state)
+
+    if (is_finished)
+      break;
+  } // for
+
+  if (is_terminated) {
+    *is_terminated = is_finished;
+    if (!is_finished)
+      return pos;
+  }
+
+  const auto end = pos;
+  switch (state) {
+  case top:
+    if (pos < size && current_char == ';')
+      ++pos;
+    if (fragment_offset < end)
+      push(Ft::text, end);
+    break;
+  case quote_quote:
+    push(Ft::text, end);
+    break;
+  case one_line_comment:
+    push(Ft::one_line_comment, end);
+    break;
+  case positional_parameter:
+    push(Ft::positional_parameter, end);
+    break;
+  case named_parameter:
+    if (!quote_char) {
+      push(Ft::named_parameter, end);
+      break;
+    }
+    [[fallthrough]];
+  default:
+    throw_invalid_sql_input("invalid SQL input",
+      text.substr(last_fragment_offset, last_fragment_size));
+  }
+
+  return pos;
+}
+
+} // namespace dmitigr::pgfe::detail
+
+#endif  // DMITIGR_PGFE_STATEMENT_PARSER_HPP
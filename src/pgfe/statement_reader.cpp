@@ -0,0 +1,113 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "exceptions.hpp"
+#include "statement_reader.hpp"
+
+#include <algorithm>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Statement_reader::Statement_reader(std::istream& input,
+  const std::size_t chunk_size)
+  : stream_{&input}
+  , chunk_size_{chunk_size}
+{
+  if (!chunk_size_)
+    throw Client_exception{"cannot create Statement_reader: invalid chunk size"};
+}
+
+DMITIGR_PGFE_INLINE
+Statement_reader::Statement_reader(const std::string_view input) noexcept
+  : input_{input}
+  , is_eof_{true}
+{}
+
+DMITIGR_PGFE_INLINE bool Statement_reader::read()
+{
+  while (!is_done_) {
+    if (input_.empty() && !fill()) {
+      is_done_ = true;
+      break;
+    }
+
+    /*
+     * Until the end of the input is reached, the statement which is not
+     * terminated by the semicolon could continue in the next chunk.
+     */
+    bool is_terminated{};
+    auto [st, pos] = Statement::parse_sql_input(input_,
+      is_eof_ ? nullptr : &is_terminated);
+    if (is_eof_ || is_terminated) {
+      DMITIGR_ASSERT(pos <= input_.size());
+      input_.remove_prefix(pos);
+      statement_ = std::move(st);
+      ++statement_count_;
+      return true;
+    } else
+      fill();
+  }
+  return false;
+}
+
+DMITIGR_PGFE_INLINE bool Statement_reader::is_done() const noexcept
+{
+  return is_done_;
+}
+
+DMITIGR_PGFE_INLINE const Statement& Statement_reader::statement() const noexcept
+{
+  return statement_;
+}
+
+DMITIGR_PGFE_INLINE Statement& Statement_reader::statement() noexcept
+{
+  return statement_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Statement_reader::statement_count() const noexcept
+{
+  return statement_count_;
+}
+
+DMITIGR_PGFE_INLINE bool Statement_reader::fill()
+{
+  if (is_eof_)
+    return false;
+
+  // Discard the parsed part of the buffer.
+  const auto unparsed_size = input_.size();
+  buffer_.erase(0, buffer_.size() - unparsed_size);
+
+  /*
+   * The incomplete statement is parsed again after each fill, so the size
+   * of the chunk grows with the statement to keep the parsing linear.
+   */
+  const auto read_size = std::max(chunk_size_, unparsed_size);
+  buffer_.resize(unparsed_size + read_size);
+  stream_->read(buffer_.data() + unparsed_size,
+    static_cast<std::streamsize>(read_size));
+  if (stream_->bad())
+    throw Client_exception{"cannot read SQL input"};
+  const auto count = static_cast<std::size_t>(stream_->gcount());
+  buffer_.resize(unparsed_size + count);
+  is_eof_ = stream_->eof();
+  input_ = buffer_;
+  return count > 0;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,135 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_READER_HPP
+#define DMITIGR_PGFE_STATEMENT_READER_HPP
+
+#include "dll.hpp"
+#include "statement.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A streaming reader of the statements of SQL input.
+ *
+ * @details The statements are parsed one at a time and in the same way as by
+ * Statement_vector, so, for example, a multi-gigabyte SQL dump can be replayed
+ * with the bounded memory and the parsing can be overlapped with the pipelined
+ * execution:
+ *
+ * @code
+ * std::ifstream dump{"dump.sql"};
+ * pgfe::Statement_reader reader{dump};
+ * conn.set_pipeline_enabled(true);
+ * while (reader.read()) {
+ *   if (!reader.statement().is_query_empty())
+ *     conn.execute_pipelined([](pgfe::Error&& e){ ... }, reader.statement());
+ * }
+ * conn.complete_pipeline();
+ * @endcode
+ *
+ * @see Statement_vector.
+ */
+class Statement_reader final {
+public:
+  /// The destructor.
+  ~Statement_reader() = default;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param input The stream to read the SQL input from. It must outlive the
+   * reader.
+   * @param chunk_size The minimum number of characters to read from `input`
+   * at once.
+   *
+   * @par Requires
+   * `chunk_size > 0`.
+   */
+  DMITIGR_PGFE_API explicit Statement_reader(std::istream& input,
+    std::size_t chunk_size = 65536);
+
+  /**
+   * @overload
+   *
+   * @param input The SQL input, such as a content of memory-mapped file, which
+   * is parsed in place. It must outlive the reader.
+   */
+  DMITIGR_PGFE_API explicit Statement_reader(std::string_view input) noexcept;
+
+  /// Not copy-constructible.
+  Statement_reader(const Statement_reader&) = delete;
+
+  /// Not copy-assignable.
+  Statement_reader& operator=(const Statement_reader&) = delete;
+
+  /// Not move-constructible.
+  Statement_reader(Statement_reader&&) = delete;
+
+  /// Not move-assignable.
+  Statement_reader& operator=(Statement_reader&&) = delete;
+
+  /**
+   * @brief Reads and parses the next statement.
+   *
+   * @returns `true` if the statement is read, or `false` if `is_done()`.
+   *
+   * @throws Client_exception if the SQL input is invalid or cannot be read.
+   *
+   * @see statement().
+   */
+  DMITIGR_PGFE_API bool read();
+
+  /// @returns `true` if the whole SQL input is read.
+  DMITIGR_PGFE_API bool is_done() const noexcept;
+
+  /// @returns The statement read by the last call of read().
+  DMITIGR_PGFE_API const Statement& statement() const noexcept;
+
+  /// @overload
+  DMITIGR_PGFE_API Statement& statement() noexcept;
+
+  /// @returns The number of statements read so far.
+  DMITIGR_PGFE_API std::size_t statement_count() const noexcept;
+
+private:
+  std::istream* stream_{};
+  std::size_t chunk_size_{};
+  std::string buffer_;
+  std::string_view input_; // the unparsed part of the input
+  bool is_eof_{};
+  bool is_done_{};
+  std::size_t statement_count_{};
+  Statement statement_;
+
+  bool fill();
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "statement_reader.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_STATEMENT_READER_HPP
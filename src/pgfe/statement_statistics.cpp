@@ -0,0 +1,309 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "statement_statistics.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE
+Statement_statistics::Statement_statistics(const std::size_t max_entry_count)
+  : max_entry_count_{max_entry_count}
+{
+  if (!max_entry_count_)
+    throw Client_exception{"cannot create statement statistics: "
+      "invalid maximum entry count"};
+}
+
+DMITIGR_PGFE_INLINE Connection::Trace_handler
+Statement_statistics::trace_handler(Connection::Trace_handler next)
+{
+  return [this, next = std::move(next)](const Trace_event& event)
+  {
+    record(event);
+    if (next)
+      next(event);
+  };
+}
+
+DMITIGR_PGFE_INLINE void Statement_statistics::record(const Trace_event& event)
+{
+  if (event.point != Trace_point::completion ||
+    event.request != Trace_request::execute)
+    return;
+
+  const bool is_prepared_statement{event.query.empty()};
+  auto key = is_prepared_statement ?
+    std::string{event.prepared_statement_name} : normalized_query(event.query);
+
+  const std::lock_guard lg{mutex_};
+  auto& map = is_prepared_statement ? prepared_statements_ : queries_;
+  auto i = map.find(key);
+  if (i == map.end()) {
+    if (prepared_statements_.size() + queries_.size() >= max_entry_count_) {
+      ++drop_count_;
+      return;
+    }
+    i = map.emplace(key, Entry{}).first;
+    i->second.key = std::move(key);
+    i->second.is_prepared_statement = is_prepared_statement;
+  }
+  record(i->second, event);
+}
+
+DMITIGR_PGFE_INLINE void
+Statement_statistics::set_max_entry_count(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set maximum entry count of statement "
+      "statistics: invalid value"};
+  const std::lock_guard lg{mutex_};
+  max_entry_count_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_statistics::max_entry_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return max_entry_count_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Statement_statistics::drop_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return drop_count_;
+}
+
+DMITIGR_PGFE_INLINE auto
+Statement_statistics::prepared_statement_entry(const std::string_view name) const
+  -> std::optional<Entry>
+{
+  const std::string key{name};
+  const std::lock_guard lg{mutex_};
+  const auto i = prepared_statements_.find(key);
+  return i != prepared_statements_.cend() ? std::optional{i->second} : std::nullopt;
+}
+
+DMITIGR_PGFE_INLINE auto
+Statement_statistics::query_entry(const std::string_view query) const
+  -> std::optional<Entry>
+{
+  const auto key = normalized_query(query);
+  const std::lock_guard lg{mutex_};
+  const auto i = queries_.find(key);
+  return i != queries_.cend() ? std::optional{i->second} : std::nullopt;
+}
+
+DMITIGR_PGFE_INLINE auto Statement_statistics::entries() const
+  -> std::vector<Entry>
+{
+  const std::lock_guard lg{mutex_};
+  return entries__();
+}
+
+DMITIGR_PGFE_INLINE auto Statement_statistics::take_entries()
+  -> std::vector<Entry>
+{
+  const std::lock_guard lg{mutex_};
+  auto result = entries__();
+  prepared_statements_.clear();
+  queries_.clear();
+  drop_count_ = 0;
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Statement_statistics::reset() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  prepared_statements_.clear();
+  queries_.clear();
+  drop_count_ = 0;
+}
+
+DMITIGR_PGFE_INLINE void
+Statement_statistics::dump(std::ostream& out, const bool reset)
+{
+  const auto entries = reset ? take_entries() : this->entries();
+  const auto us = [](const std::chrono::nanoseconds value)
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(value).count();
+  };
+  for (const auto& e : entries) {
+    out << e.key
+        << '\t' << e.call_count
+        << '\t' << e.error_count
+        << '\t' << e.row_count
+        << '\t' << e.byte_count
+        << '\t' << us(e.durations.sum())
+        << '\t' << us(e.min_duration)
+        << '\t' << us(e.durations.max())
+        << '\t' << us(e.durations.percentile(99))
+        << '\n';
+  }
+}
+
+DMITIGR_PGFE_INLINE std::string
+Statement_statistics::normalized_query(const std::string_view query)
+{
+  static const auto is_ident_char = [](const char c) noexcept
+  {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+  };
+
+  std::string result;
+  result.reserve(query.size());
+  bool is_space_pending{};
+  const auto begin_token = [&result, &is_space_pending]
+  {
+    if (is_space_pending && !result.empty())
+      result += ' ';
+    is_space_pending = false;
+  };
+  const auto is_after_ident = [&result, &is_space_pending]() noexcept
+  {
+    return !is_space_pending && !result.empty() && is_ident_char(result.back());
+  };
+
+  const auto size = query.size();
+  for (std::size_t i{}; i < size;) {
+    const char c = query[i];
+    const char n = i + 1 < size ? query[i + 1] : '\0';
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      is_space_pending = true;
+      ++i;
+    } else if (c == '-' && n == '-') {
+      i = query.find('\n', i);
+      i = i != std::string_view::npos ? i + 1 : size;
+      is_space_pending = true;
+    } else if (c == '/' && n == '*') {
+      int depth{1};
+      for (i += 2; i < size && depth; ++i) {
+        if (query[i] == '/' && i + 1 < size && query[i + 1] == '*')
+          ++depth, ++i;
+        else if (query[i] == '*' && i + 1 < size && query[i + 1] == '/')
+          --depth, ++i;
+      }
+      is_space_pending = true;
+    } else if (c == '\'') {
+      // Remove the prefix of E'', B'', X'' and N'' strings.
+      bool is_escaped{};
+      if (!is_space_pending && !result.empty() &&
+        std::strchr("EeBbXxNn", result.back()) &&
+        (result.size() == 1 || !is_ident_char(result[result.size() - 2]))) {
+        is_escaped = result.back() == 'E' || result.back() == 'e';
+        result.pop_back();
+      }
+      for (++i; i < size; ++i) {
+        if (is_escaped && query[i] == '\\')
+          ++i;
+        else if (query[i] == '\'') {
+          if (i + 1 < size && query[i + 1] == '\'')
+            ++i;
+          else
+            break;
+        }
+      }
+      i = std::min(i + 1, size);
+      begin_token();
+      result += '?';
+    } else if (c == '"') {
+      const auto b = i;
+      for (++i; i < size; ++i) {
+        if (query[i] == '"') {
+          if (i + 1 < size && query[i + 1] == '"')
+            ++i;
+          else
+            break;
+        }
+      }
+      i = std::min(i + 1, size);
+      begin_token();
+      result.append(query.substr(b, i - b));
+    } else if (c == '$' && !is_after_ident() &&
+      !std::isdigit(static_cast<unsigned char>(n))) {
+      // Dollar-quoted string (or just a character if the tag is unterminated).
+      auto e = i + 1;
+      while (e < size && is_ident_char(query[e]) && query[e] != '$')
+        ++e;
+      if (e < size && query[e] == '$') {
+        const auto tag = query.substr(i, e - i + 1);
+        const auto end = query.find(tag, e + 1);
+        i = end != std::string_view::npos ? end + tag.size() : size;
+        begin_token();
+        result += '?';
+      } else {
+        begin_token();
+        result += c;
+        ++i;
+      }
+    } else if ((std::isdigit(static_cast<unsigned char>(c)) ||
+        (c == '.' && std::isdigit(static_cast<unsigned char>(n)))) &&
+      !is_after_ident()) {
+      for (++i; i < size; ++i) {
+        const char d = query[i];
+        if (std::isalnum(static_cast<unsigned char>(d)) || d == '_' || d == '.')
+          continue;
+        else if ((d == '+' || d == '-') && (query[i - 1] == 'e' ||
+            query[i - 1] == 'E'))
+          continue;
+        break;
+      }
+      begin_token();
+      result += '?';
+    } else {
+      begin_token();
+      result += c;
+      ++i;
+    }
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void
+Statement_statistics::record(Entry& entry, const Trace_event& event) noexcept
+{
+  if (!entry.call_count || event.duration < entry.min_duration)
+    entry.min_duration = event.duration;
+  ++entry.call_count;
+  if (event.is_failed)
+    ++entry.error_count;
+  entry.row_count += event.row_count;
+  entry.byte_count += event.byte_count;
+  entry.durations.record(event.duration);
+}
+
+DMITIGR_PGFE_INLINE auto Statement_statistics::entries__() const
+  -> std::vector<Entry>
+{
+  std::vector<Entry> result;
+  result.reserve(prepared_statements_.size() + queries_.size());
+  for (const auto* const map : {&prepared_statements_, &queries_}) {
+    for (const auto& [key, entry] : *map)
+      result.push_back(entry);
+  }
+  std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs)
+  {
+    return lhs.durations.sum() > rhs.durations.sum();
+  });
+  return result;
+}
+
+} // namespace dmitigr::pgfe
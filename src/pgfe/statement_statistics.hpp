@@ -0,0 +1,215 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATEMENT_STATISTICS_HPP
+#define DMITIGR_PGFE_STATEMENT_STATISTICS_HPP
+
+#include "connection.hpp"
+#include "dll.hpp"
+#include "metrics.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief The client-side statistics of statement executions.
+ *
+ * @details The statistics are collected from the completions of the execute
+ * requests reported to the trace handler of the connection (see
+ * trace_handler()) and aggregated per named prepared statement, or per
+ * normalized query (see normalized_query()) for the unnamed statements.
+ * Thus, the statistics similar to the ones of `pg_stat_statements` are
+ * available without the access to the server.
+ *
+ * @remarks The number of entries is limited by max_entry_count(). The
+ * executions of the statements without the entry are dropped once the limit
+ * is reached.
+ *
+ * @par Thread safety
+ * Thread-safe. (So the instance can be shared by the connections of a pool.)
+ *
+ * @see Connection::set_trace_handler().
+ */
+class Statement_statistics final {
+public:
+  /// The default maximum number of entries.
+  static constexpr std::size_t default_max_entry_count{5000};
+
+  /// An entry of statistics.
+  struct Entry final {
+    /// The name of the prepared statement, or the normalized query.
+    std::string key;
+
+    /// `true` if the `key` is the name of the prepared statement.
+    bool is_prepared_statement{};
+
+    /// The number of completed executions.
+    std::uint_least64_t call_count{};
+
+    /// The number of executions completed with error.
+    std::uint_least64_t error_count{};
+
+    /// The number of rows received.
+    std::uint_least64_t row_count{};
+
+    /// The number of bytes of the rows received (the memory of results).
+    std::uint_least64_t byte_count{};
+
+    /// The minimum duration of execution.
+    std::chrono::nanoseconds min_duration{};
+
+    /**
+     * @brief The histogram of durations of executions.
+     *
+     * @details The total and maximum durations are `durations.sum()` and
+     * `durations.max()`, the 99th percentile is `durations.percentile(99)`.
+     */
+    Duration_histogram durations;
+  };
+
+  /**
+   * @brief The constructor.
+   *
+   * @par Requires
+   * `max_entry_count`.
+   */
+  DMITIGR_PGFE_API explicit Statement_statistics(
+    std::size_t max_entry_count = default_max_entry_count);
+
+  /// Not copy-constructible.
+  Statement_statistics(const Statement_statistics&) = delete;
+
+  /// Not copy-assignable.
+  Statement_statistics& operator=(const Statement_statistics&) = delete;
+
+  /// Not move-constructible.
+  Statement_statistics(Statement_statistics&&) = delete;
+
+  /// Not move-assignable.
+  Statement_statistics& operator=(Statement_statistics&&) = delete;
+
+  /**
+   * @returns The trace handler which records the events by record() and
+   * then passes them to the `next` handler (if any).
+   *
+   * @remarks The instance must outlive the connections the handler is set to.
+   *
+   * @see Connection::set_trace_handler().
+   */
+  DMITIGR_PGFE_API Connection::Trace_handler
+  trace_handler(Connection::Trace_handler next = {});
+
+  /**
+   * @brief Records the `event`.
+   *
+   * @details Only the completions of the execute requests are recorded.
+   */
+  DMITIGR_PGFE_API void record(const Trace_event& event);
+
+  /**
+   * @brief Sets the maximum number of entries.
+   *
+   * @details The existing entries are kept even if their number exceeds the
+   * `value`.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_max_entry_count(std::size_t value);
+
+  /// @returns The maximum number of entries.
+  DMITIGR_PGFE_API std::size_t max_entry_count() const noexcept;
+
+  /// @returns The number of executions dropped because of max_entry_count().
+  DMITIGR_PGFE_API std::uint_least64_t drop_count() const noexcept;
+
+  /// @returns The entry of the prepared statement of the given `name`.
+  DMITIGR_PGFE_API std::optional<Entry>
+  prepared_statement_entry(std::string_view name) const;
+
+  /**
+   * @returns The entry of the unnamed statement of the given `query`.
+   *
+   * @remarks The `query` is normalized before the lookup.
+   */
+  DMITIGR_PGFE_API std::optional<Entry> query_entry(std::string_view query) const;
+
+  /// @returns The entries sorted by the total duration in descending order.
+  DMITIGR_PGFE_API std::vector<Entry> entries() const;
+
+  /**
+   * @brief Resets the statistics.
+   *
+   * @returns The entries collected before the reset sorted as by entries().
+   */
+  DMITIGR_PGFE_API std::vector<Entry> take_entries();
+
+  /// Resets the statistics.
+  DMITIGR_PGFE_API void reset() noexcept;
+
+  /**
+   * @brief Writes the entries to the `out` as the tab separated values (one
+   * line per entry): key, calls, errors, rows, bytes, and the total, minimum,
+   * maximum and 99th percentile durations in microseconds.
+   *
+   * @details This function is suitable to be called periodically.
+   *
+   * @param reset Whether to reset the statistics after the dump.
+   */
+  DMITIGR_PGFE_API void dump(std::ostream& out, bool reset = false);
+
+  /**
+   * @returns The `query` in which the comments are removed, the runs of
+   * whitespaces are collapsed into a single space, and the literal constants
+   * (numbers, strings and dollar-quoted strings) are replaced with `?`.
+   * Thus, the queries which differ only in constants are aggregated into
+   * the same entry.
+   */
+  DMITIGR_PGFE_API static std::string normalized_query(std::string_view query);
+
+private:
+  using Entry_map = std::unordered_map<std::string, Entry>;
+
+  mutable std::mutex mutex_;
+  Entry_map prepared_statements_;
+  Entry_map queries_;
+  std::size_t max_entry_count_{};
+  std::uint_least64_t drop_count_{};
+
+  static void record(Entry& entry, const Trace_event& event) noexcept;
+  std::vector<Entry> entries__() const;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "statement_statistics.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_STATEMENT_STATISTICS_HPP
@@ -20,6 +20,7 @@
 #include "statement_vector.hpp"
 
 #include <algorithm>
+#include <functional>
 
 namespace dmitigr::pgfe {
 
@@ -42,6 +43,7 @@ DMITIGR_PGFE_INLINE void Statement_vector::swap(Statement_vector& rhs) noexcept
 {
   using std::swap;
   swap(statements_, rhs.statements_);
+  swap(extra_index_, rhs.extra_index_);
 }
 
 DMITIGR_PGFE_INLINE std::size_t Statement_vector::size() const noexcept
@@ -70,6 +72,26 @@ DMITIGR_PGFE_INLINE std::size_t Statement_vector::statement_index(
   const std::string_view extra_value,
   const std::size_t offset, const std::size_t extra_offset) const noexcept
 {
+  if (!extra_offset) {
+    try {
+      if (!extra_index_)
+        build_extra_index();
+    } catch (...) {
+      extra_index_.reset();
+    }
+    if (extra_index_) {
+      if (const auto i = extra_index_->find(extra_index_hash(extra_name,
+          extra_value)); i != extra_index_->end()) {
+        for (const auto& entry : i->second) {
+          if (entry.index >= offset && entry.name == extra_name &&
+            entry.value == extra_value)
+            return entry.index;
+        }
+      }
+      return size();
+    }
+  }
+
   const auto sz = size();
   const auto b = cbegin(statements_);
   const auto e = cend(statements_);
@@ -100,6 +122,7 @@ Statement_vector::operator[](const std::size_t index) const
 DMITIGR_PGFE_INLINE Statement&
 Statement_vector::operator[](const std::size_t index)
 {
+  extra_index_.reset();
   return const_cast<Statement&>(static_cast<const Statement_vector&>(*this)[index]);
 }
 
@@ -124,6 +147,7 @@ Statement_vector::query_absolute_position(const std::size_t index,
 
 DMITIGR_PGFE_INLINE void Statement_vector::append(Statement statement) noexcept
 {
+  extra_index_.reset();
   statements_.push_back(std::move(statement));
 }
 
@@ -132,6 +156,7 @@ DMITIGR_PGFE_INLINE void Statement_vector::insert(const std::size_t index,
 {
   if (!(index < size()))
     throw Client_exception{"cannot insert to Statement_vector"};
+  extra_index_.reset();
   const auto b = begin(statements_);
   using Diff = decltype(b)::difference_type;
   statements_.insert(b + static_cast<Diff>(index), std::move(statement));
@@ -141,6 +166,7 @@ DMITIGR_PGFE_INLINE void Statement_vector::remove(const std::size_t index)
 {
   if (!(index < size()))
     throw Client_exception{"cannot remove from Statement_vector"};
+  extra_index_.reset();
   const auto b = begin(statements_);
   using Diff = decltype(b)::difference_type;
   statements_.erase(b + static_cast<Diff>(index));
@@ -166,8 +192,40 @@ Statement_vector::vector() const noexcept
 DMITIGR_PGFE_INLINE std::vector<Statement>&
 Statement_vector::vector() noexcept
 {
+  extra_index_.reset();
   return const_cast<std::vector<Statement>&>(
     static_cast<const Statement_vector*>(this)->vector());
 }
 
+DMITIGR_PGFE_INLINE void Statement_vector::build_extra_index() const
+{
+  Extra_index index;
+  const auto sz = size();
+  for (std::size_t i{}; i < sz; ++i) {
+    const auto& extra = statements_[i].extra();
+    const auto field_count = extra.field_count();
+    for (std::size_t j{}; j < field_count; ++j) {
+      // Only the first field of the given name is looked up.
+      const auto name = extra.field_name(j);
+      if (extra.field_index(name) != j)
+        continue;
+      else if (const auto data = extra.data(j)) {
+        const auto value = to<std::string_view>(data);
+        index[extra_index_hash(name, value)].push_back(
+          Extra_index_entry{std::string{name}, std::string{value}, i});
+      }
+    }
+  }
+  extra_index_ = std::move(index);
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Statement_vector::extra_index_hash(const std::string_view name,
+  const std::string_view value) noexcept
+{
+  const std::hash<std::string_view> hash;
+  const auto result = hash(name);
+  return result ^ (hash(value) + 0x9e3779b9 + (result << 6) + (result >> 2));
+}
+
 } // namespace dmitigr::pgfe
@@ -21,8 +21,10 @@
 #include "statement.hpp"
 #include "types_fwd.hpp"
 
+#include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace dmitigr::pgfe {
@@ -88,6 +90,11 @@ public:
    * @param offset A starting position of lookup in this vector.
    * @param extra_offset A starting position of lookup in the extra data.
    *
+   * @remarks If `extra_offset == 0` the lookup is performed in constant time
+   * by using the index of extra data built by the first such a lookup. The
+   * index is invalidated by any modification of this vector (including the
+   * access to the statements through the non-const methods).
+   *
    * @see Statement::extra().
    */
   DMITIGR_PGFE_API std::size_t statement_index(
@@ -153,7 +160,21 @@ public:
   DMITIGR_PGFE_API std::vector<Statement>& vector() noexcept;
 
 private:
+  struct Extra_index_entry final {
+    std::string name;
+    std::string value;
+    std::size_t index{};
+  };
+  // The entries of the same hash are sorted by the index of statement.
+  using Extra_index = std::unordered_map<std::size_t,
+    std::vector<Extra_index_entry>>;
+
   std::vector<Statement> statements_;
+  mutable std::optional<Extra_index> extra_index_; // cache
+
+  void build_extra_index() const;
+  static std::size_t extra_index_hash(std::string_view name,
+    std::string_view value) noexcept;
 };
 
 /**
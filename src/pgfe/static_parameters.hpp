@@ -0,0 +1,205 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_STATIC_PARAMETERS_HPP
+#define DMITIGR_PGFE_STATIC_PARAMETERS_HPP
+
+#include "conversions.hpp"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::pgfe::detail {
+
+/**
+ * @brief The parameter arrays to pass to libpq as is.
+ *
+ * @details All the values are of Data_format::text format and of unspecified
+ * types, i.e. are sent exactly as the values converted by Conversions.
+ */
+struct Static_parameter_arrays final {
+  std::size_t count{};
+  const char* const* values{};
+  const int* lengths{};
+  const int* formats{};
+};
+
+/**
+ * @brief The traits of the parameters which can be encoded by
+ * Static_parameters without instances of Data.
+ *
+ * @details The supported specializations provide:
+ *   - `buffer_size` - the size of the buffer required to encode the value;
+ *   - `encode(char* buffer, const T& value)` - returns the zero-terminated
+ *   text representation of `value` which is either written to the `buffer`
+ *   or refers to the `value` itself, or the view with null data for NULL.
+ */
+template<typename T, typename = void>
+struct Static_parameter_traits final {
+  static constexpr bool is_supported{false};
+  static constexpr std::size_t buffer_size{};
+};
+
+/// The specialization for the numerics of the numeric conversions.
+template<typename T>
+struct Static_parameter_traits<T,
+  std::enable_if_t<is_numeric_conversions_v<T> &&
+    !std::is_same_v<T, long double>>> final {
+  static constexpr bool is_supported{true};
+  static constexpr std::size_t buffer_size{std::is_floating_point_v<T> ? 32 :
+    std::numeric_limits<T>::digits10 + 4};
+
+  static std::string_view encode(char* const buffer, const T value)
+  {
+    auto* const end = numeric_to_chars(buffer, buffer + buffer_size - 1, value);
+    *end = '\0';
+    return {buffer, static_cast<std::size_t>(end - buffer)};
+  }
+};
+
+/// The specialization for `bool`.
+template<>
+struct Static_parameter_traits<bool> final {
+  static constexpr bool is_supported{true};
+  static constexpr std::size_t buffer_size{};
+
+  static std::string_view encode(char*, const bool value) noexcept
+  {
+    return value ? "t" : "f";
+  }
+};
+
+/// The specialization for `std::string`. (The value is sent as is.)
+template<>
+struct Static_parameter_traits<std::string> final {
+  static constexpr bool is_supported{true};
+  static constexpr std::size_t buffer_size{};
+
+  static std::string_view encode(char*, const std::string& value) noexcept
+  {
+    return value;
+  }
+};
+
+/// The specialization for `std::nullptr_t`.
+template<>
+struct Static_parameter_traits<std::nullptr_t> final {
+  static constexpr bool is_supported{true};
+  static constexpr std::size_t buffer_size{};
+
+  static std::string_view encode(char*, std::nullptr_t) noexcept
+  {
+    return {};
+  }
+};
+
+/// The specialization for `std::optional` of the supported types.
+template<typename T>
+struct Static_parameter_traits<std::optional<T>,
+  std::enable_if_t<Static_parameter_traits<T>::is_supported>> final {
+  static constexpr bool is_supported{true};
+  static constexpr std::size_t buffer_size{
+    Static_parameter_traits<T>::buffer_size};
+
+  static std::string_view encode(char* const buffer,
+    const std::optional<T>& value)
+  {
+    return value ? Static_parameter_traits<T>::encode(buffer, *value) :
+      std::string_view{};
+  }
+};
+
+/**
+ * @brief The parameters encoded without instances of Data.
+ *
+ * @details The values, lengths and formats are stored in place, and the sizes
+ * and offsets of the encoding buffer are computed at compile time, so encoding
+ * neither allocates memory nor dispatches dynamically.
+ *
+ * @remarks The values are sent in text format of unspecified types (exactly as
+ * if they were bound by Prepared_statement::bind()), so the server infers the
+ * types of parameters from the query as usual.
+ */
+template<typename ... Types>
+class Static_parameters final {
+public:
+  /// The number of parameters.
+  static constexpr std::size_t count{sizeof...(Types)};
+
+  /// `true` if all of `Types` can be encoded.
+  static constexpr bool is_supported{
+    (Static_parameter_traits<std::decay_t<Types>>::is_supported && ...)};
+
+  /// Encodes the `values`.
+  explicit Static_parameters(const std::decay_t<Types>& ... values)
+  {
+    encode__(std::index_sequence_for<Types...>{}, values...);
+  }
+
+  /// Non copy-constructible, since refers to its own buffer.
+  Static_parameters(const Static_parameters&) = delete;
+
+  /// Non copy-assignable.
+  Static_parameters& operator=(const Static_parameters&) = delete;
+
+  /// @returns The arrays to pass to libpq.
+  Static_parameter_arrays arrays() const noexcept
+  {
+    return {count, values_.data(), lengths_.data(), formats_.data()};
+  }
+
+private:
+  static constexpr std::array<std::size_t, count + 1> offsets_{[]
+  {
+    std::array<std::size_t, count + 1> result{};
+    const std::size_t sizes[]{
+      Static_parameter_traits<std::decay_t<Types>>::buffer_size..., 0};
+    for (std::size_t i{}; i < count; ++i)
+      result[i + 1] = result[i] + sizes[i];
+    return result;
+  }()};
+  static constexpr std::array<int, count> formats_{}; // all are text
+
+  std::array<char, offsets_[count] ? offsets_[count] : 1> buffer_;
+  std::array<const char*, count> values_;
+  std::array<int, count> lengths_;
+
+  template<std::size_t ... I>
+  void encode__(std::index_sequence<I...>,
+    const std::decay_t<Types>& ... values)
+  {
+    (encode_one__<I, std::decay_t<Types>>(values), ...);
+  }
+
+  template<std::size_t I, typename T>
+  void encode_one__(const T& value)
+  {
+    const auto text = Static_parameter_traits<T>::encode(
+      buffer_.data() + offsets_[I], value);
+    values_[I] = text.data();
+    lengths_[I] = static_cast<int>(text.size());
+  }
+};
+
+} // namespace dmitigr::pgfe::detail
+
+#endif  // DMITIGR_PGFE_STATIC_PARAMETERS_HPP
@@ -0,0 +1,158 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "exceptions.hpp"
+#include "traffic_recorder.hpp"
+
+#include <type_traits>
+
+namespace dmitigr::pgfe {
+
+namespace detail::traffic {
+
+/// Appends the bytes of the integral `value` to the `record`.
+template<typename T>
+inline void append(std::string& record, const T value)
+{
+  static_assert(std::is_integral_v<T>);
+  record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// Appends the length-prefixed `value` to the `record`.
+inline void append(std::string& record, const std::string_view value)
+{
+  append(record, static_cast<std::uint32_t>(value.size()));
+  record.append(value.data(), value.size());
+}
+
+} // namespace detail::traffic
+
+DMITIGR_PGFE_INLINE
+Traffic_recorder::Traffic_recorder(const std::filesystem::path& path)
+  : path_{path}
+  , start_time_{std::chrono::steady_clock::now()}
+  , file_{path_, std::ios_base::binary | std::ios_base::trunc}
+{
+  if (!file_ || !file_.write(detail::traffic::signature.data(),
+      detail::traffic::signature.size()))
+    throw Client_exception{"cannot create traffic recorder: "
+      "cannot open file " + path_.string()};
+}
+
+DMITIGR_PGFE_INLINE const std::filesystem::path&
+Traffic_recorder::path() const noexcept
+{
+  return path_;
+}
+
+DMITIGR_PGFE_INLINE std::uint_least64_t
+Traffic_recorder::record_count() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return record_count_;
+}
+
+DMITIGR_PGFE_INLINE bool Traffic_recorder::is_failed() const noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return !file_;
+}
+
+DMITIGR_PGFE_INLINE void Traffic_recorder::flush()
+{
+  const std::lock_guard lg{mutex_};
+  if (!file_.flush())
+    throw Client_exception{"cannot flush traffic recorder: "
+      "cannot write file " + path_.string()};
+}
+
+DMITIGR_PGFE_INLINE std::uint_least32_t Traffic_recorder::open_session() noexcept
+{
+  const std::lock_guard lg{mutex_};
+  return ++session_count_;
+}
+
+DMITIGR_PGFE_INLINE void
+Traffic_recorder::record_prepare(const std::uint_least32_t session,
+  const std::string_view name, const std::string_view query,
+  const std::vector<Oid>& parameter_types) noexcept
+{
+  namespace traffic = detail::traffic;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  using std::chrono::steady_clock;
+  try {
+    std::string record;
+    record.reserve(1 + 8 + 4 + 4 + name.size() + 4 + query.size() +
+      4 + 4*parameter_types.size());
+    traffic::append(record, static_cast<std::uint8_t>(traffic::Record_kind::prepare));
+    traffic::append(record, static_cast<std::uint64_t>(
+      duration_cast<nanoseconds>(steady_clock::now() - start_time_).count()));
+    traffic::append(record, static_cast<std::uint32_t>(session));
+    traffic::append(record, name);
+    traffic::append(record, query);
+    traffic::append(record, static_cast<std::uint32_t>(parameter_types.size()));
+    for (const auto type : parameter_types)
+      traffic::append(record, static_cast<std::uint32_t>(type));
+    write(record);
+  } catch (...) {}
+}
+
+DMITIGR_PGFE_INLINE void
+Traffic_recorder::record_execute(const std::uint_least32_t session,
+  const std::string_view name, const std::string_view query,
+  const std::size_t parameter_count, const char* const* const values,
+  const int* const lengths, const int* const formats, const Oid* const types,
+  const int result_format) noexcept
+{
+  namespace traffic = detail::traffic;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  using std::chrono::steady_clock;
+  try {
+    std::string record;
+    record.reserve(1 + 8 + 4 + 4 + name.size() + 4 + query.size() + 1 + 4 +
+      9*parameter_count);
+    traffic::append(record, static_cast<std::uint8_t>(traffic::Record_kind::execute));
+    traffic::append(record, static_cast<std::uint64_t>(
+      duration_cast<nanoseconds>(steady_clock::now() - start_time_).count()));
+    traffic::append(record, static_cast<std::uint32_t>(session));
+    traffic::append(record, name);
+    traffic::append(record, query);
+    traffic::append(record, static_cast<std::uint8_t>(result_format));
+    traffic::append(record, static_cast<std::uint32_t>(parameter_count));
+    for (std::size_t i{}; i < parameter_count; ++i) {
+      traffic::append(record, static_cast<std::uint32_t>(types ? types[i] : 0));
+      traffic::append(record, static_cast<std::uint8_t>(formats[i]));
+      if (values[i]) {
+        traffic::append(record, static_cast<std::int32_t>(lengths[i]));
+        record.append(values[i], static_cast<std::size_t>(lengths[i]));
+      } else
+        traffic::append(record, std::int32_t{-1});
+    }
+    write(record);
+  } catch (...) {}
+}
+
+DMITIGR_PGFE_INLINE void
+Traffic_recorder::write(const std::string& record) noexcept
+{
+  const std::lock_guard lg{mutex_};
+  if (file_ && file_.write(record.data(), record.size()))
+    ++record_count_;
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,133 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_TRAFFIC_RECORDER_HPP
+#define DMITIGR_PGFE_TRAFFIC_RECORDER_HPP
+
+#include "basics.hpp"
+#include "dll.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+namespace detail::traffic {
+
+/// The signature of a recording file.
+constexpr std::string_view signature{"PGFETRC1"};
+
+/// A kind of recorded request.
+enum class Record_kind : std::uint8_t {
+  prepare = 1,
+  execute = 2
+};
+
+} // namespace detail::traffic
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A recorder of the requests sent by connections.
+ *
+ * @details Records the prepare and execute requests (the queries or the names
+ * of the prepared statements, the parameters with their formats and types,
+ * and the time of sending) of the connections the recorder is set to (see
+ * Connection::set_traffic_recorder()) to a compact binary file, which can be
+ * replayed by Traffic_replayer. Each connection is recorded as a separate
+ * session.
+ *
+ * @remarks The recording file is written in the byte order of the host.
+ * @remarks The parameters are recorded as is, so the recording may contain
+ * sensitive data.
+ *
+ * @par Thread safety
+ * Thread-safe. (So the recorder can be shared by the connections of a pool.)
+ *
+ * @see Traffic_replayer.
+ */
+class Traffic_recorder final {
+public:
+  /**
+   * @brief The constructor. Creates (truncates) the recording file.
+   *
+   * @throws Client_exception if the file cannot be opened.
+   */
+  DMITIGR_PGFE_API explicit Traffic_recorder(const std::filesystem::path& path);
+
+  /// Not copy-constructible.
+  Traffic_recorder(const Traffic_recorder&) = delete;
+
+  /// Not copy-assignable.
+  Traffic_recorder& operator=(const Traffic_recorder&) = delete;
+
+  /// Not move-constructible.
+  Traffic_recorder(Traffic_recorder&&) = delete;
+
+  /// Not move-assignable.
+  Traffic_recorder& operator=(Traffic_recorder&&) = delete;
+
+  /// @returns The path of the recording file.
+  DMITIGR_PGFE_API const std::filesystem::path& path() const noexcept;
+
+  /// @returns The number of requests recorded.
+  DMITIGR_PGFE_API std::uint_least64_t record_count() const noexcept;
+
+  /**
+   * @returns `true` if writing to the file is failed. The requests are not
+   * recorded after the failure.
+   */
+  DMITIGR_PGFE_API bool is_failed() const noexcept;
+
+  /// Flushes the buffered records to the file.
+  DMITIGR_PGFE_API void flush();
+
+private:
+  friend Connection;
+  friend Prepared_statement;
+
+  std::filesystem::path path_;
+  const std::chrono::steady_clock::time_point start_time_;
+  mutable std::mutex mutex_;
+  std::ofstream file_;
+  std::uint_least64_t record_count_{};
+  std::uint_least32_t session_count_{};
+
+  std::uint_least32_t open_session() noexcept;
+  void record_prepare(std::uint_least32_t session, std::string_view name,
+    std::string_view query, const std::vector<Oid>& parameter_types) noexcept;
+  void record_execute(std::uint_least32_t session, std::string_view name,
+    std::string_view query, std::size_t parameter_count,
+    const char* const* values, const int* lengths, const int* formats,
+    const Oid* types, int result_format) noexcept;
+  void write(const std::string& record) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "traffic_recorder.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_TRAFFIC_RECORDER_HPP
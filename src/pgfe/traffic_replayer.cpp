@@ -0,0 +1,347 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include "exceptions.hpp"
+#include "statement.hpp"
+#include "traffic_replayer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+namespace detail::traffic {
+
+/// A reader of the recording.
+class Reader final {
+public:
+  explicit Reader(const std::string_view data) noexcept
+    : data_{data}
+  {}
+
+  bool is_end() const noexcept
+  {
+    return pos_ == data_.size();
+  }
+
+  template<typename T>
+  T read()
+  {
+    T result;
+    std::memcpy(&result, bytes(sizeof(T)), sizeof(T));
+    return result;
+  }
+
+  std::string_view read_string()
+  {
+    const auto size = read<std::uint32_t>();
+    return {bytes(size), size};
+  }
+
+  const char* bytes(const std::size_t size)
+  {
+    if (size > data_.size() - pos_)
+      throw Client_exception{"cannot load traffic recording: truncated record"};
+    const auto* const result = data_.data() + pos_;
+    pos_ += size;
+    return result;
+  }
+
+private:
+  std::string_view data_;
+  std::size_t pos_{};
+};
+
+} // namespace detail::traffic
+
+DMITIGR_PGFE_INLINE
+Traffic_replayer::Traffic_replayer(const std::filesystem::path& path)
+{
+  namespace traffic = detail::traffic;
+  using traffic::Record_kind;
+
+  {
+    std::ifstream file{path, std::ios_base::binary};
+    if (!file)
+      throw Client_exception{"cannot load traffic recording: "
+        "cannot open file " + path.string()};
+    data_.assign(std::istreambuf_iterator<char>{file},
+      std::istreambuf_iterator<char>{});
+    if (file.bad())
+      throw Client_exception{"cannot load traffic recording: "
+        "cannot read file " + path.string()};
+  }
+
+  const std::string_view data{data_};
+  if (data.substr(0, traffic::signature.size()) != traffic::signature)
+    throw Client_exception{"cannot load traffic recording: invalid signature"};
+
+  std::unordered_map<std::uint32_t, std::size_t> session_indexes;
+  traffic::Reader reader{data.substr(traffic::signature.size())};
+  std::optional<std::chrono::nanoseconds> first_time;
+  std::chrono::nanoseconds last_time{};
+  while (!reader.is_end()) {
+    Record record;
+    record.kind = static_cast<Record_kind>(reader.read<std::uint8_t>());
+    if (record.kind != Record_kind::prepare && record.kind != Record_kind::execute)
+      throw Client_exception{"cannot load traffic recording: "
+        "invalid record kind"};
+    record.time = std::chrono::nanoseconds{reader.read<std::uint64_t>()};
+    const auto session = reader.read<std::uint32_t>();
+    record.name = reader.read_string();
+    record.query = reader.read_string();
+    if (record.kind == Record_kind::prepare) {
+      const auto type_count = reader.read<std::uint32_t>();
+      record.parameter_types.reserve(type_count);
+      for (std::uint32_t i{}; i < type_count; ++i)
+        record.parameter_types.push_back(reader.read<std::uint32_t>());
+    } else {
+      record.result_format = static_cast<Data_format>(reader.read<std::uint8_t>());
+      const auto param_count = reader.read<std::uint32_t>();
+      record.parameter_types.reserve(param_count);
+      record.parameters.reserve(param_count);
+      for (std::uint32_t i{}; i < param_count; ++i) {
+        record.parameter_types.push_back(reader.read<std::uint32_t>());
+        const auto format = static_cast<Data_format>(reader.read<std::uint8_t>());
+        const auto length = reader.read<std::int32_t>();
+        if (length >= 0) {
+          const auto size = static_cast<std::size_t>(length);
+          record.parameters.emplace_back(Data_view{reader.bytes(size), size,
+            format});
+        } else
+          record.parameters.emplace_back();
+      }
+    }
+
+    if (!first_time || record.time < *first_time)
+      first_time = record.time;
+    last_time = std::max(last_time, record.time);
+    const auto [i, is_new] = session_indexes.emplace(session, sessions_.size());
+    if (is_new)
+      sessions_.emplace_back();
+    sessions_[i->second].push_back(std::move(record));
+    ++record_count_;
+  }
+
+  if (first_time)
+    recorded_duration_ = last_time - *first_time;
+
+  // The sessions are replayed in order of their starting.
+  std::stable_sort(sessions_.begin(), sessions_.end(),
+    [](const auto& lhs, const auto& rhs)
+    {
+      return lhs.front().time < rhs.front().time;
+    });
+}
+
+DMITIGR_PGFE_INLINE std::size_t Traffic_replayer::record_count() const noexcept
+{
+  return record_count_;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Traffic_replayer::session_count() const noexcept
+{
+  return sessions_.size();
+}
+
+DMITIGR_PGFE_INLINE std::chrono::nanoseconds
+Traffic_replayer::recorded_duration() const noexcept
+{
+  return recorded_duration_;
+}
+
+DMITIGR_PGFE_INLINE void Traffic_replayer::set_speed(const double value)
+{
+  if (!(value >= 0))
+    throw Client_exception{"cannot set speed of traffic replayer: "
+      "invalid value"};
+  speed_ = value;
+}
+
+DMITIGR_PGFE_INLINE double Traffic_replayer::speed() const noexcept
+{
+  return speed_;
+}
+
+DMITIGR_PGFE_INLINE auto
+Traffic_replayer::replay(Connection_pool& pool) const -> Result
+{
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  using std::chrono::steady_clock;
+  using Record_kind = detail::traffic::Record_kind;
+
+  if (!pool.is_connected())
+    throw Client_exception{"cannot replay traffic: pool is not connected"};
+
+  Result result;
+  const auto count = sessions_.size();
+  if (!count)
+    return result;
+
+  const auto first_time = sessions_.front().front().time;
+  const auto start = steady_clock::now();
+
+  std::mutex mutex;
+  std::atomic<bool> is_stopped{};
+  std::size_t next_index{};
+  std::vector<std::pair<std::size_t, std::exception_ptr>> failures;
+
+  // Returns the index of the session, or `std::nullopt` if there are none.
+  const auto next_session = [&]() -> std::optional<std::size_t>
+  {
+    const std::lock_guard lg{mutex};
+    if (is_stopped || next_index == count)
+      return std::nullopt;
+    return next_index++;
+  };
+
+  const auto work = [&]
+  {
+    std::optional<std::size_t> index;
+    Result local;
+    std::vector<nanoseconds> latencies;
+    try {
+      while ((index = next_session())) {
+        auto conn = pool.connection(std::nullopt);
+        if (!conn)
+          throw Client_exception{"cannot replay traffic: no connection"};
+
+        std::map<std::string_view, Prepared_statement> statements;
+        for (const auto& record : sessions_[*index]) {
+          if (is_stopped)
+            break;
+
+          // The statements to execute are parsed before the timing.
+          std::optional<Statement> statement;
+          Prepared_statement* ps{};
+          if (record.kind == Record_kind::execute) {
+            if (!record.name.empty() || record.query.empty()) {
+              const auto i = statements.find(record.name);
+              if (i == statements.end()) {
+                ++local.skip_count;
+                continue;
+              }
+              ps = &i->second;
+            } else
+              statement.emplace(record.query);
+          } else
+            statements.erase(record.name);
+
+          if (speed_ > 0)
+            std::this_thread::sleep_until(start + duration_cast<nanoseconds>(
+              (record.time - first_time) / speed_));
+
+          const auto request_start = steady_clock::now();
+          bool is_failed{};
+          if (record.kind == Record_kind::prepare) {
+            try {
+              statements.emplace(record.name, conn->prepare_as_is(
+                std::string{record.query}, std::string{record.name},
+                record.parameter_types));
+            } catch (const Server_exception&) {
+              is_failed = true;
+            }
+          } else {
+            if (ps) {
+              const auto param_count = std::min(record.parameters.size(),
+                ps->parameter_count());
+              for (std::size_t i{}; i < param_count; ++i) {
+                if (const auto& value = record.parameters[i]) {
+                  ps->bind_no_copy(i, std::string_view{static_cast<const char*>(
+                    value->bytes()), value->size()}, value->format());
+                } else
+                  ps->bind(i, nullptr);
+              }
+              ps->set_result_format(record.result_format);
+              ps->execute_nio();
+            } else
+              conn->execute_recorded_nio__(*statement, record.parameters,
+                record.parameter_types, record.result_format);
+            is_failed = !conn->process_responses_nothrow([](Row&&){});
+          }
+          latencies.push_back(steady_clock::now() - request_start);
+          ++local.request_count;
+          if (is_failed)
+            ++local.error_count;
+        }
+
+        // The statements prepared by the session are not needed anymore.
+        for (const auto& [name, ps] : statements) {
+          if (name.empty() || !ps.is_valid())
+            continue;
+          try {
+            conn->unprepare(std::string{name});
+          } catch (const Server_exception&) {
+            // The statement was deallocated by the session.
+          }
+        }
+      }
+    } catch (...) {
+      const std::lock_guard lg{mutex};
+      is_stopped = true;
+      failures.emplace_back(index.value_or(count), std::current_exception());
+    }
+
+    const std::lock_guard lg{mutex};
+    for (const auto latency : latencies)
+      result.latencies.record(latency);
+    result.request_count += local.request_count;
+    result.error_count += local.error_count;
+    result.skip_count += local.skip_count;
+  };
+
+  {
+    std::vector<std::thread> workers;
+    const auto worker_count = std::min(pool.size(), count);
+    workers.reserve(worker_count);
+    try {
+      for (std::size_t i{}; i < worker_count; ++i)
+        workers.emplace_back(work);
+    } catch (...) {
+      is_stopped = true;
+      for (auto& worker : workers)
+        worker.join();
+      throw;
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+
+  if (!failures.empty()) {
+    std::rethrow_exception(std::min_element(failures.cbegin(), failures.cend(),
+      [](const auto& lhs, const auto& rhs)
+      {
+        return lhs.first < rhs.first;
+      })->second);
+  }
+
+  result.duration = steady_clock::now() - start;
+  return result;
+}
+
+} // namespace dmitigr::pgfe
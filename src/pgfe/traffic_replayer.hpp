@@ -0,0 +1,164 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_TRAFFIC_REPLAYER_HPP
+#define DMITIGR_PGFE_TRAFFIC_REPLAYER_HPP
+
+#include "basics.hpp"
+#include "data.hpp"
+#include "dll.hpp"
+#include "metrics.hpp"
+#include "traffic_recorder.hpp"
+#include "types_fwd.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup utilities
+ *
+ * @brief A replayer of the requests recorded by Traffic_recorder.
+ *
+ * @details Re-executes the recorded sessions concurrently over the connections
+ * of Connection_pool, preserving the order of the requests within each session
+ * and (optionally) the original pacing of the requests. Each session is
+ * replayed on a single connection of the pool, so the prepared statements of
+ * the session are available to its executions. The latencies of the replayed
+ * requests are collected into Duration_histogram, so the results of the
+ * replays against the different servers (or against the different versions of
+ * the schema) can be compared by percentiles to detect the regressions.
+ *
+ * @remarks The sessions are replayed against the current state of the
+ * database, so the results of the data modifying requests may differ from the
+ * recorded ones.
+ *
+ * @see Traffic_recorder.
+ */
+class Traffic_replayer final {
+public:
+  /// The result of the replay.
+  struct Result final {
+    /// The latencies of the replayed requests.
+    Duration_histogram latencies;
+
+    /// The number of the replayed requests.
+    std::uint_least64_t request_count{};
+
+    /// The number of the replayed requests failed with the server errors.
+    std::uint_least64_t error_count{};
+
+    /**
+     * @brief The number of the skipped requests, i.e. the executions of the
+     * statements which were prepared before the recording was started.
+     */
+    std::uint_least64_t skip_count{};
+
+    /// The wall-clock duration of the replay.
+    std::chrono::nanoseconds duration{};
+  };
+
+  /**
+   * @brief The constructor. Loads the recording.
+   *
+   * @throws Client_exception if the file cannot be read or is malformed.
+   */
+  DMITIGR_PGFE_API explicit Traffic_replayer(const std::filesystem::path& path);
+
+  /// Not copy-constructible.
+  Traffic_replayer(const Traffic_replayer&) = delete;
+
+  /// Not copy-assignable.
+  Traffic_replayer& operator=(const Traffic_replayer&) = delete;
+
+  /// Not move-constructible.
+  Traffic_replayer(Traffic_replayer&&) = delete;
+
+  /// Not move-assignable.
+  Traffic_replayer& operator=(Traffic_replayer&&) = delete;
+
+  /// @returns The number of the recorded requests.
+  DMITIGR_PGFE_API std::size_t record_count() const noexcept;
+
+  /// @returns The number of the recorded sessions.
+  DMITIGR_PGFE_API std::size_t session_count() const noexcept;
+
+  /// @returns The time between the first and the last recorded requests.
+  DMITIGR_PGFE_API std::chrono::nanoseconds recorded_duration() const noexcept;
+
+  /**
+   * @brief Sets the speed of the replay relative to the recording.
+   *
+   * @details For example, `1` means the original pacing, `2` means twice as
+   * fast as it was recorded and `0` means as fast as possible.
+   *
+   * @par Requires
+   * `value >= 0`.
+   *
+   * @remarks By default, the speed is `1`.
+   */
+  DMITIGR_PGFE_API void set_speed(double value);
+
+  /// @returns The speed of the replay.
+  DMITIGR_PGFE_API double speed() const noexcept;
+
+  /**
+   * @brief Replays the recorded sessions.
+   *
+   * @param pool The pool to acquire the connections from. The number of
+   * the sessions replayed concurrently is limited by its size.
+   *
+   * @par Requires
+   * `pool.is_connected()`.
+   *
+   * @throws The first exception (other than Server_exception, which is
+   * counted by Result::error_count) of the replay. In this case the replay
+   * is stopped as soon as possible.
+   */
+  DMITIGR_PGFE_API Result replay(Connection_pool& pool) const;
+
+private:
+  struct Record final {
+    detail::traffic::Record_kind kind{};
+    std::chrono::nanoseconds time{};
+    std::string_view name;
+    std::string_view query;
+    Data_format result_format{};
+    std::vector<Oid> parameter_types;
+    std::vector<std::optional<Data_view>> parameters;
+  };
+
+  std::string data_;
+  std::size_t record_count_{};
+  std::chrono::nanoseconds recorded_duration_{};
+  std::vector<std::vector<Record>> sessions_;
+  double speed_{1};
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "traffic_replayer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_TRAFFIC_REPLAYER_HPP
@@ -22,13 +22,30 @@
 #include "statement.hpp"
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <type_traits>
 
 namespace dmitigr::pgfe {
 
 /// @brief A transaction guard.
 class Transaction_guard final {
 public:
+  /// A mode of sending the transaction control commands.
+  enum class Mode {
+    /// Each command is executed as a separate request.
+    immediate,
+
+    /**
+     * Each command is queued in the pipeline, so `BEGIN` (or `SAVEPOINT`) is
+     * sent along with the statements queued after it by
+     * Connection::execute_pipelined(), and `COMMIT` (or `RELEASE`) is sent
+     * along with the synchronization point. Thus, a short transaction costs
+     * only one round trip.
+     */
+    pipelined
+  };
+
   /// Not copy-constructible.
   Transaction_guard(const Transaction_guard&) = delete;
   /// Not copy-assignable.
@@ -63,11 +80,34 @@ public:
 
   /// Begins the transaction (or defines a savepoint) if `auto_begin`.
   Transaction_guard(Connection& conn,
+    const bool auto_begin = true, std::string savepoint = {})
+    : Transaction_guard{conn, Mode::immediate, auto_begin, std::move(savepoint)}
+  {}
+
+  /**
+   * @overload
+   *
+   * @details If `mode == Mode::pipelined`, the subtransaction is guarded if
+   * either the transaction is uncommitted or the `savepoint` is specified,
+   * since the status of the transaction which is begun in the pipeline is
+   * unknown until the synchronization point.
+   *
+   * @par Requires
+   * `mode == Mode::immediate || conn.pipeline_status() != Pipeline_status::disabled`.
+   */
+  Transaction_guard(Connection& conn, const Mode mode,
     const bool auto_begin = true, std::string savepoint = {})
     : conn_{conn}
-    , is_subtransaction_{conn_.is_transaction_uncommitted()}
+    , mode_{mode}
+    , is_subtransaction_{conn_.is_transaction_uncommitted() ||
+        (mode_ == Mode::pipelined && !savepoint.empty())}
     , savepoint_{std::move(savepoint)}
   {
+    if (mode_ == Mode::pipelined &&
+      conn_.pipeline_status() == Pipeline_status::disabled)
+      throw Client_exception{"cannot create pipelined transaction guard: "
+        "pipeline is not enabled"};
+
     if (is_subtransaction_) {
       if (savepoint_.empty())
         savepoint_ = "pgfe_savepoint";
@@ -80,6 +120,12 @@ public:
       begin();
   }
 
+  /// @returns The mode of sending the transaction control commands.
+  Mode mode() const noexcept
+  {
+    return mode_;
+  }
+
   /// @returns `true` if this instance guards a subtransaction.
   bool is_subtransaction() const noexcept
   {
@@ -95,6 +141,16 @@ public:
   /// Begins a transaction (or opens savepoint) if it hasn't already begun.
   void begin()
   {
+    if (mode_ == Mode::pipelined) {
+      // The commands are skipped by the server on preceding error.
+      const auto ignore = [](auto&&){};
+      if (is_subtransaction_)
+        conn_.execute_pipelined(ignore, savepoint_stmt__(R"(savepoint :"s")"));
+      else
+        conn_.execute_pipelined(ignore, "begin");
+      return;
+    }
+
     if (!conn_.is_transaction_uncommitted())
       conn_.execute("begin");
 
@@ -105,6 +161,13 @@ public:
   /**
    * @brief Commits the transaction (or destroys a savepoint) if the
    * transaction is uncommitted.
+   *
+   * @details If `mode() == Mode::pipelined`, queues the command and completes
+   * the pipeline (see Connection::complete_pipeline()).
+   *
+   * @throws Server_exception if `mode() == Mode::pipelined` and the command
+   * failed, or Client_exception if it was skipped (or the transaction was
+   * rolled back) because of the error of one of the preceding commands.
    */
   void commit()
   {
@@ -128,12 +191,27 @@ public:
    */
   void rollback()
   {
+    if (mode_ == Mode::pipelined &&
+      conn_.pipeline_status() != Pipeline_status::disabled) {
+      // Skip the rest of the aborted pipeline (if any) at first.
+      conn_.complete_pipeline();
+      const auto status = conn_.transaction_status();
+      if ((status == Transaction_status::uncommitted ||
+          status == Transaction_status::failed) &&
+        !is_subtransaction_committed_) {
+        conn_.execute_pipelined([](auto&&){}, rollback_stmt_);
+        conn_.complete_pipeline();
+      }
+      return;
+    }
+
     if (conn_.is_transaction_uncommitted() && !is_subtransaction_committed_)
       conn_.execute(rollback_stmt_);
   }
 
 private:
   Connection& conn_;
+  Mode mode_{Mode::immediate};
   bool is_subtransaction_{};
   bool is_subtransaction_committed_{};
   std::string savepoint_;
@@ -147,6 +225,12 @@ private:
 
   void commit__(const Statement commit_query)
   {
+    if (mode_ == Mode::pipelined) {
+      commit_pipelined__(is_subtransaction_ ?
+        savepoint_stmt__(R"(release :"s")") : commit_query);
+      return;
+    }
+
     if (conn_.is_transaction_uncommitted()) {
       if (is_subtransaction_) {
         conn_.execute(savepoint_stmt__(R"(release :"s")"));
@@ -155,6 +239,30 @@ private:
         conn_.execute(commit_query);
     }
   }
+
+  void commit_pipelined__(const Statement& commit_query)
+  {
+    // The invalid Error is passed if the command is skipped by the server.
+    Completion comp;
+    Error err;
+    conn_.execute_pipelined([&comp, &err](auto&& response)
+    {
+      using R = std::decay_t<decltype(response)>;
+      if constexpr (std::is_same_v<R, Completion>)
+        comp = std::move(response);
+      else if constexpr (std::is_same_v<R, Error>)
+        err = std::move(response);
+    }, commit_query);
+    conn_.complete_pipeline();
+
+    if (err)
+      throw Server_exception{std::make_shared<Error>(std::move(err))};
+    else if (!comp || comp.tag() == "ROLLBACK")
+      throw Client_exception{"cannot commit transaction: "
+        "aborted by the preceding error"};
+    else if (is_subtransaction_)
+      is_subtransaction_committed_ = true;
+  }
 };
 
 } // namespace dmitigr::pgfe
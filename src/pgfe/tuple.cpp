@@ -14,13 +14,75 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "../net/conversions.hpp"
 #include "data.hpp"
 #include "tuple.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
 
 namespace dmitigr::pgfe {
 
+namespace detail {
+
+DMITIGR_PGFE_INLINE
+Tuple_field_names::Tuple_field_names(std::vector<std::string> names)
+  : names_{std::move(names)}
+{
+  if (names_.empty())
+    return;
+
+  // The load factor is at most 0.5.
+  std::size_t size{2};
+  while (size < names_.size() * 2)
+    size *= 2;
+  slots_.assign(size, 0);
+  const std::size_t mask{size - 1};
+  for (std::size_t i{}; i < names_.size(); ++i) {
+    const std::string_view name{names_[i]};
+    for (std::size_t s{std::hash<std::string_view>{}(name) & mask};; s = (s + 1) & mask) {
+      auto& slot = slots_[s];
+      if (!slot) {
+        slot = i + 1;
+        break;
+      } else if (names_[slot - 1] == name)
+        break; // keep the first occurrence
+    }
+  }
+}
+
+DMITIGR_PGFE_INLINE std::size_t
+Tuple_field_names::find(const std::string_view name,
+  const std::size_t offset) const noexcept
+{
+  const std::size_t size{names_.size()};
+  if (!(offset < size))
+    return size;
+
+  const std::size_t mask{slots_.size() - 1};
+  for (std::size_t s{std::hash<std::string_view>{}(name) & mask};; s = (s + 1) & mask) {
+    const std::size_t slot{slots_[s]};
+    if (!slot)
+      return size;
+
+    const std::size_t i{slot - 1};
+    if (names_[i] == name) {
+      // The index contains the first occurrence of name only.
+      if (i >= offset)
+        return i;
+      for (std::size_t j{offset}; j < size; ++j) {
+        if (names_[j] == name)
+          return j;
+      }
+      return size;
+    }
+  }
+}
+
+} // namespace detail
+
 DMITIGR_PGFE_INLINE Tuple::Tuple(std::vector<Element>&& elements) noexcept
   : elements_{std::move(elements)}
 {
@@ -29,11 +91,13 @@ DMITIGR_PGFE_INLINE Tuple::Tuple(std::vector<Element>&& elements) noexcept
 
 DMITIGR_PGFE_INLINE Tuple::Tuple(const Tuple& rhs)
   : elements_{rhs.elements_.size()}
+  , compact_{rhs.compact_}
 {
   transform(rhs.elements_.cbegin(), rhs.elements_.cend(), elements_.begin(),
     [](const auto& pair)
     {
-      return std::make_pair(pair.first, pair.second->to_data());
+      return std::make_pair(pair.first,
+        pair.second ? pair.second->to_data() : nullptr);
     });
   assert(is_invariant_ok());
 }
@@ -51,16 +115,17 @@ DMITIGR_PGFE_INLINE void Tuple::swap(Tuple& rhs) noexcept
 {
   using std::swap;
   swap(elements_, rhs.elements_);
+  swap(compact_, rhs.compact_);
 }
 
 DMITIGR_PGFE_INLINE std::size_t Tuple::field_count() const noexcept
 {
-  return elements_.size();
+  return compact_ ? compact_->values.size() : elements_.size();
 }
 
 DMITIGR_PGFE_INLINE bool Tuple::is_empty() const noexcept
 {
-  return elements_.empty();
+  return !field_count();
 }
 
 DMITIGR_PGFE_INLINE std::string_view
@@ -68,6 +133,9 @@ Tuple::field_name(const std::size_t index) const
 {
   if (!(index < field_count()))
     throw Client_exception{"cannot get field name of tuple"};
+  else if (compact_)
+    return compact_->names ? std::string_view{(*compact_->names)[index]} :
+      std::string_view{};
   return elements_[index].first;
 }
 
@@ -78,6 +146,11 @@ Tuple::field_index(const std::string_view name,
   const std::size_t fc{field_count()};
   if (!(offset < fc))
     return fc;
+  else if (compact_) {
+    if (compact_->names)
+      return compact_->names->find(name, offset);
+    return name.empty() ? offset : fc;
+  }
   const auto b = elements_.cbegin();
   const auto e = elements_.cend();
   using Diff = decltype(b)::difference_type;
@@ -90,6 +163,11 @@ DMITIGR_PGFE_INLINE Data_view Tuple::data(const std::size_t index) const
 {
   if (!(index < field_count()))
     throw Client_exception{"cannot get data of tuple"};
+  else if (compact_) {
+    const auto& value = compact_->values[index];
+    return value.is_null ? Data_view{} : Data_view{compact_->bytes.data() +
+      value.offset, value.size, value.format};
+  }
   const auto& result = elements_[index].second;
   return result ? Data_view{*result} : Data_view{};
 }
@@ -102,6 +180,8 @@ DMITIGR_PGFE_INLINE Data_view Tuple::data(const std::string_view name,
 
 DMITIGR_PGFE_INLINE void Tuple::append(Tuple rhs)
 {
+  expand();
+  rhs.expand();
   elements_.insert(elements_.cend(),
     std::make_move_iterator(rhs.elements_.begin()),
     std::make_move_iterator(rhs.elements_.end()));
@@ -112,6 +192,7 @@ DMITIGR_PGFE_INLINE void Tuple::remove(const std::size_t index)
 {
   if (!(index < field_count()))
     throw Client_exception{"cannot remove field from tuple"};
+  expand();
   const auto b = elements_.cbegin();
   using Diff = decltype(b)::difference_type;
   elements_.erase(b + static_cast<Diff>(index));
@@ -122,6 +203,7 @@ DMITIGR_PGFE_INLINE void Tuple::remove(const std::string_view name,
   const std::size_t offset)
 {
   if (const auto index = field_index(name, offset); index != field_count()) {
+    expand();
     const auto b = elements_.cbegin();
     using Diff = decltype(b)::difference_type;
     elements_.erase(b + static_cast<Diff>(index));
@@ -130,16 +212,138 @@ DMITIGR_PGFE_INLINE void Tuple::remove(const std::string_view name,
 }
 
 DMITIGR_PGFE_INLINE auto
-Tuple::vector() const noexcept -> const std::vector<Element>&
+Tuple::vector() const -> const std::vector<Element>&
 {
+  expand();
   return elements_;
 }
 
 DMITIGR_PGFE_INLINE auto
-Tuple::vector() noexcept -> std::vector<Element>&
+Tuple::vector() -> std::vector<Element>&
 {
   return const_cast<std::vector<Element>&>(
     static_cast<const Tuple*>(this)->vector());
 }
 
+DMITIGR_PGFE_INLINE void Tuple::compact()
+{
+  if (compact_)
+    return;
+
+  auto result = std::make_shared<detail::Compact_tuple>();
+  std::size_t size{};
+  for (const auto& element : elements_)
+    if (element.second)
+      size += element.second->size();
+  result->bytes.reserve(size);
+  result->values.reserve(elements_.size());
+  std::vector<std::string> names;
+  names.reserve(elements_.size());
+  for (const auto& [name, data] : elements_) {
+    names.push_back(name);
+    auto& value = result->values.emplace_back();
+    if (data) {
+      value.offset = result->bytes.size();
+      value.size = data->size();
+      value.format = data->format();
+      result->bytes.append(static_cast<const char*>(data->bytes()),
+        data->size());
+    } else
+      value.is_null = true;
+  }
+  result->names = std::make_shared<detail::Tuple_field_names>(std::move(names));
+
+  compact_ = std::move(result);
+  elements_.clear();
+  assert(is_invariant_ok());
+}
+
+DMITIGR_PGFE_INLINE bool Tuple::is_compact() const noexcept
+{
+  return static_cast<bool>(compact_);
+}
+
+DMITIGR_PGFE_INLINE bool
+Tuple::is_field_names_shared(const Tuple& rhs) const noexcept
+{
+  return compact_ && rhs.compact_ && compact_->names &&
+    compact_->names == rhs.compact_->names;
+}
+
+DMITIGR_PGFE_INLINE Tuple Tuple::from_binary_record(const Data& data)
+{
+  return from_binary_record(data, nullptr);
+}
+
+DMITIGR_PGFE_INLINE Tuple Tuple::from_binary_record(const Data& data,
+  std::shared_ptr<const detail::Tuple_field_names> names)
+{
+  if (data.format() != Data_format::binary)
+    throw Client_exception{"cannot convert to tuple: text format is not "
+      "supported"};
+
+  // The format is: field count (int4), then for each field: the type OID
+  // (oid), the size (int4, -1 for NULL) and the bytes of the size.
+  auto compact = std::make_shared<detail::Compact_tuple>();
+  compact->bytes.assign(static_cast<const char*>(data.bytes()), data.size());
+  const char* const begin{compact->bytes.data()};
+  const char* const end{begin + compact->bytes.size()};
+  const char* cur{begin};
+  const auto read_int4 = [&cur, end]
+  {
+    if (end - cur < 4)
+      throw Client_exception{"cannot convert to tuple: unexpected end of "
+        "record"};
+    const auto result = net::conv<std::int32_t>(cur, 4);
+    cur += 4;
+    return result;
+  };
+
+  const auto field_count = read_int4();
+  if (field_count < 0 || (end - cur) / 8 < field_count)
+    throw Client_exception{"cannot convert to tuple: invalid field count"};
+  else if (names && names->size() != static_cast<std::size_t>(field_count))
+    throw Client_exception{"cannot convert to tuple: field count mismatch"};
+
+  compact->values.reserve(static_cast<std::size_t>(field_count));
+  for (std::int32_t i{}; i < field_count; ++i) {
+    read_int4(); // the type OID
+    const auto size = read_int4();
+    auto& value = compact->values.emplace_back();
+    value.format = Data_format::binary;
+    if (size == -1) {
+      value.is_null = true;
+      continue;
+    } else if (size < 0 || end - cur < size)
+      throw Client_exception{"cannot convert to tuple: invalid field size"};
+    value.offset = static_cast<std::size_t>(cur - begin);
+    value.size = static_cast<std::size_t>(size);
+    cur += size;
+  }
+  if (cur != end)
+    throw Client_exception{"cannot convert to tuple: excessive data"};
+
+  compact->names = std::move(names);
+  Tuple result;
+  result.compact_ = std::move(compact);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Tuple::expand() const
+{
+  if (!compact_)
+    return;
+
+  std::vector<Element> elements;
+  elements.reserve(compact_->values.size());
+  for (std::size_t i{}; i < compact_->values.size(); ++i) {
+    const auto& value = compact_->values[i];
+    elements.emplace_back(std::string{field_name(i)}, value.is_null ? nullptr :
+      Data::make(std::string_view{compact_->bytes.data() + value.offset,
+        value.size}, value.format));
+  }
+  elements_ = std::move(elements);
+  compact_.reset();
+}
+
 } // namespace dmitigr::pgfe
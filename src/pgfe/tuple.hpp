@@ -17,6 +17,7 @@
 #ifndef DMITIGR_PGFE_TUPLE_HPP
 #define DMITIGR_PGFE_TUPLE_HPP
 
+#include "basics.hpp"
 #include "composite.hpp"
 #include "conversions_api.hpp"
 #include "dll.hpp"
@@ -24,20 +25,83 @@
 #include "types_fwd.hpp"
 
 #include <cassert>
+#include <cstddef>
 #include <iterator>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 namespace dmitigr::pgfe {
 
+namespace detail {
+
+/**
+ * @brief The immutable table of the field names with the hash index, which
+ * can be shared by the tuples of the same structure.
+ */
+class Tuple_field_names final {
+public:
+  /// The constructor.
+  explicit DMITIGR_PGFE_API Tuple_field_names(std::vector<std::string> names);
+
+  /// @returns The number of names.
+  std::size_t size() const noexcept
+  {
+    return names_.size();
+  }
+
+  /// @returns The name at `index`.
+  const std::string& operator[](const std::size_t index) const noexcept
+  {
+    return names_[index];
+  }
+
+  /**
+   * @returns The index of the `name` starting from `offset`, or `size()` if
+   * there is no such a name.
+   */
+  DMITIGR_PGFE_API std::size_t find(std::string_view name,
+    std::size_t offset) const noexcept;
+
+private:
+  std::vector<std::string> names_;
+  std::vector<std::size_t> slots_; // index + 1, or 0 if empty
+};
+
+/// The compact storage of tuple: the values are stored in one buffer.
+struct Compact_tuple final {
+  /// The location of the value in the buffer.
+  struct Value final {
+    std::size_t offset{};
+    std::size_t size{};
+    Data_format format{Data_format::text};
+    bool is_null{};
+  };
+
+  /// The names of fields, or `nullptr` if the fields are unnamed.
+  std::shared_ptr<const Tuple_field_names> names;
+  /// The bytes of the values.
+  std::string bytes;
+  /// The values.
+  std::vector<Value> values;
+};
+
+} // namespace detail
+
 /**
  * @ingroup utilities
  *
  * @brief A tuple.
  *
  * @details A collection of elements in a fixed order.
+ *
+ * The tuple can be stored either as the vector of elements, or compactly (see
+ * compact()). The compact storage consists of the table of field names with
+ * the hash index and one buffer of values. It's immutable and shared by the
+ * copies of the tuple, so copying of compact tuple doesn't allocate. Any of
+ * the modifiers converts the compact storage back to the vector of elements.
  */
 class Tuple final : public Composite {
 public:
@@ -50,7 +114,11 @@ public:
   /// The constructor.
   DMITIGR_PGFE_API Tuple(std::vector<Element>&& elements) noexcept;
 
-  /// Copy-constructible.
+  /**
+   * @brief Copy-constructible.
+   *
+   * @remarks If `rhs.is_compact()` the storage is shared without copying.
+   */
   DMITIGR_PGFE_API Tuple(const Tuple& rhs);
 
   /// Copy-assignable.
@@ -110,6 +178,7 @@ public:
   {
     if (!(index < field_count()))
       throw Client_exception{"cannot set data of tuple"};
+    expand();
     elements_[index].second = to_data(std::forward<T>(value));
   }
 
@@ -132,6 +201,7 @@ public:
   template<typename T>
   void append(std::string name, T&& value)
   {
+    expand();
     elements_.emplace_back(std::move(name), to_data(std::forward<T>(value)));
     assert(is_invariant_ok());
   }
@@ -157,6 +227,7 @@ public:
   {
     if (!(index < field_count()))
       throw Client_exception{"cannot insert field to tuple"};
+    expand();
     const auto b = elements_.begin();
     using Diff = decltype(b)::difference_type;
     elements_.insert(b + static_cast<Diff>(index),
@@ -202,14 +273,65 @@ public:
    */
   DMITIGR_PGFE_API void remove(std::string_view name, std::size_t offset = 0);
 
-  /// @returns The underlying vector of elements.
-  DMITIGR_PGFE_API const std::vector<Element>& vector() const noexcept;
+  /**
+   * @returns The underlying vector of elements.
+   *
+   * @remarks If is_compact() the storage is converted to the vector of
+   * elements first, so this function must not be called concurrently with
+   * other functions.
+   */
+  DMITIGR_PGFE_API const std::vector<Element>& vector() const;
 
   /// @overload
-  DMITIGR_PGFE_API std::vector<Element>& vector() noexcept;
+  DMITIGR_PGFE_API std::vector<Element>& vector();
+
+  /**
+   * @brief Converts the storage to the compact one.
+   *
+   * @par Effects
+   * `is_compact()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void compact();
+
+  /// @returns `true` if the storage is compact.
+  DMITIGR_PGFE_API bool is_compact() const noexcept;
+
+  /**
+   * @returns The compact tuple decoded from the binary representation of the
+   * value of composite type. The fields of the result are unnamed.
+   *
+   * @par Requires
+   * `data.format() == Data_format::binary`.
+   *
+   * @remarks The data of the fields are in the binary format.
+   *
+   * @see Type_catalog::to_tuple().
+   */
+  static DMITIGR_PGFE_API Tuple from_binary_record(const Data& data);
+
+  /**
+   * @returns `true` if this tuple and `rhs` are compact and share the same
+   * table of field names, i.e. the tuples are made of the rows of the same
+   * request or of the values of the same composite type. In this case, the
+   * field indexes resolved for one of these tuples are valid for another.
+   *
+   * @see Row::to_tuple(), Type_catalog::to_tuple().
+   */
+  DMITIGR_PGFE_API bool is_field_names_shared(const Tuple& rhs) const noexcept;
 
 private:
-  std::vector<Element> elements_;
+  friend Row;
+  friend Type_catalog;
+
+  mutable std::vector<Element> elements_;
+  mutable std::shared_ptr<const detail::Compact_tuple> compact_;
+
+  static Tuple from_binary_record(const Data& data,
+    std::shared_ptr<const detail::Tuple_field_names> names);
+  DMITIGR_PGFE_API void expand() const;
 };
 
 /**
@@ -222,6 +344,35 @@ inline void swap(Tuple& lhs, Tuple& rhs) noexcept
   lhs.swap(rhs);
 }
 
+/**
+ * @ingroup conversions
+ *
+ * @brief Full specialization of Conversions for Tuple.
+ *
+ * @details Support of the following data formats is implemented for:
+ *   - input data - Data_format::binary.
+ *
+ * @see Tuple::from_binary_record().
+ */
+template<>
+struct Conversions<Tuple> final {
+  using Type = Tuple;
+
+  template<typename ... Types>
+  static Type to_type(const Data& data, Types&& ...)
+  {
+    return Type::from_binary_record(data);
+  }
+
+  template<typename ... Types>
+  static Type to_type(std::unique_ptr<Data>&& data, Types&& ...)
+  {
+    if (!data)
+      throw Client_exception{"cannot convert to tuple: null data given"};
+    return to_type(*data);
+  }
+};
+
 } // namespace dmitigr::pgfe
 
 #ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
@@ -0,0 +1,241 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connection.hpp"
+#include "conversions.hpp"
+#include "type_catalog.hpp"
+
+#include <mutex>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE void Type_catalog::load(Connection& conn)
+{
+  auto descriptors = fetch(conn, std::nullopt);
+  const std::unique_lock lg{mutex_};
+  descriptors_ = std::move(descriptors);
+  field_names_.clear();
+  is_loaded_ = true;
+}
+
+DMITIGR_PGFE_INLINE bool Type_catalog::is_loaded() const noexcept
+{
+  const std::shared_lock lg{mutex_};
+  return is_loaded_;
+}
+
+DMITIGR_PGFE_INLINE void Type_catalog::clear() noexcept
+{
+  const std::unique_lock lg{mutex_};
+  descriptors_.by_oid.clear();
+  descriptors_.by_name.clear();
+  field_names_.clear();
+  is_loaded_ = false;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Type_catalog::size() const noexcept
+{
+  const std::shared_lock lg{mutex_};
+  return descriptors_.by_oid.size();
+}
+
+DMITIGR_PGFE_INLINE auto Type_catalog::descriptor(const Oid oid) const
+  -> Descriptor_ptr
+{
+  const std::shared_lock lg{mutex_};
+  const auto i = descriptors_.by_oid.find(oid);
+  return i != descriptors_.by_oid.cend() ? i->second : nullptr;
+}
+
+DMITIGR_PGFE_INLINE auto
+Type_catalog::descriptor(const std::string_view name) const -> Descriptor_ptr
+{
+  const std::shared_lock lg{mutex_};
+  const auto i = descriptors_.by_name.find(std::string{name});
+  if (i == descriptors_.by_name.cend())
+    return nullptr;
+  const auto j = descriptors_.by_oid.find(i->second);
+  return j != descriptors_.by_oid.cend() ? j->second : nullptr;
+}
+
+DMITIGR_PGFE_INLINE auto Type_catalog::descriptor(Connection& conn,
+  const Oid oid) -> Descriptor_ptr
+{
+  if (auto result = descriptor(oid); result && is_fields_loaded(*result))
+    return result;
+
+  auto descriptors = fetch(conn, oid);
+  const auto i = descriptors.by_oid.find(oid);
+  if (i == descriptors.by_oid.cend())
+    return nullptr;
+
+  auto result = i->second;
+  const std::unique_lock lg{mutex_};
+  descriptors_.by_oid.insert_or_assign(oid, result);
+  field_names_.erase(oid);
+  for (auto& [name, type_oid] : descriptors.by_name)
+    descriptors_.by_name.insert_or_assign(name, type_oid);
+  return result;
+}
+
+DMITIGR_PGFE_INLINE Oid Type_catalog::representation_oid(Oid oid) const
+{
+  const std::shared_lock lg{mutex_};
+  while (true) {
+    const auto i = descriptors_.by_oid.find(oid);
+    if (i == descriptors_.by_oid.cend())
+      return oid;
+
+    const auto& descriptor = *i->second;
+    if (descriptor.kind == Type_kind::domain)
+      oid = descriptor.base_oid;
+    else if (descriptor.kind == Type_kind::enumeration)
+      return detail::text_oid;
+    else
+      return oid;
+  }
+}
+
+DMITIGR_PGFE_INLINE Tuple Type_catalog::to_tuple(const Data& data,
+  const Oid type_oid) const
+{
+  const auto type = descriptor(type_oid);
+  if (!type)
+    throw Client_exception{"cannot convert to tuple: unknown type "
+      + std::to_string(type_oid)};
+  else if (type->kind != Type_kind::composite)
+    throw Client_exception{"cannot convert to tuple: type "
+      + type->name + " is not composite"};
+
+  // The table of field names is shared by the tuples of the same type.
+  std::shared_ptr<const detail::Tuple_field_names> names;
+  {
+    const std::shared_lock lg{mutex_};
+    if (const auto i = field_names_.find(type_oid); i != field_names_.cend())
+      names = i->second;
+  }
+  if (!names) {
+    std::vector<std::string> field_names;
+    field_names.reserve(type->fields.size());
+    for (const auto& field : type->fields)
+      field_names.push_back(field.name);
+    names = std::make_shared<detail::Tuple_field_names>(std::move(field_names));
+    const std::unique_lock lg{mutex_};
+    field_names_.emplace(type_oid, names);
+  }
+  return Tuple::from_binary_record(data, std::move(names));
+}
+
+DMITIGR_PGFE_INLINE auto Type_catalog::fetch(Connection& conn,
+  const std::optional<Oid> oid) -> Descriptors
+{
+  if (!conn.is_ready_for_request())
+    throw Client_exception{"cannot load type catalog: not ready for request"};
+
+  const auto oid_condition = [&oid](const char* const column)
+  {
+    return std::string{column}.append(" = ").append(std::to_string(*oid));
+  };
+
+  // Load the types.
+  std::unordered_map<Oid, std::shared_ptr<Type_descriptor>> types;
+  {
+    std::string query{"select t.oid, n.nspname, t.typname, t.typtype,"
+      " t.typcategory, t.typlen::integer, t.typelem, t.typarray,"
+      " t.typbasetype, t.typrelid"
+      " from pg_catalog.pg_type t"
+      " join pg_catalog.pg_namespace n on n.oid = t.typnamespace"};
+    if (oid)
+      query.append(" where ").append(oid_condition("t.oid"));
+    conn.execute([&types](auto&& row)
+    {
+      auto descriptor = std::make_shared<Type_descriptor>();
+      descriptor->oid = to<Oid>(row.data(0));
+      descriptor->schema = to<std::string>(row.data(1));
+      descriptor->name = to<std::string>(row.data(2));
+      descriptor->kind = static_cast<Type_kind>(
+        to<std::string_view>(row.data(3)).front());
+      descriptor->category = to<std::string_view>(row.data(4)).front();
+      descriptor->length = static_cast<std::int_fast16_t>(to<int>(row.data(5)));
+      descriptor->element_oid = to<Oid>(row.data(6));
+      descriptor->array_oid = to<Oid>(row.data(7));
+      descriptor->base_oid = to<Oid>(row.data(8));
+      descriptor->relation_oid = to<Oid>(row.data(9));
+      const auto type_oid = descriptor->oid;
+      types.emplace(type_oid, std::move(descriptor));
+    }, Statement{query});
+  }
+
+  // Load the fields of composite types.
+  {
+    std::string query{"select t.oid, a.attname, a.atttypid"
+      " from pg_catalog.pg_attribute a"
+      " join pg_catalog.pg_type t on t.typrelid = a.attrelid"
+      " join pg_catalog.pg_namespace n on n.oid = t.typnamespace"
+      " where a.attnum > 0 and not a.attisdropped and "};
+    query.append(oid ? oid_condition("t.oid") :
+      "n.nspname not in ('pg_catalog', 'information_schema')");
+    query.append(" order by t.oid, a.attnum");
+    conn.execute([&types](auto&& row)
+    {
+      if (const auto i = types.find(to<Oid>(row.data(0))); i != types.end())
+        i->second->fields.push_back(Type_descriptor::Field{
+          to<std::string>(row.data(1)), to<Oid>(row.data(2))});
+    }, Statement{query});
+  }
+
+  // Load the labels of enumerated types.
+  {
+    std::string query{"select e.enumtypid, e.enumlabel"
+      " from pg_catalog.pg_enum e"};
+    if (oid)
+      query.append(" where ").append(oid_condition("e.enumtypid"));
+    query.append(" order by e.enumtypid, e.enumsortorder");
+    conn.execute([&types](auto&& row)
+    {
+      if (const auto i = types.find(to<Oid>(row.data(0))); i != types.end())
+        i->second->labels.push_back(to<std::string>(row.data(1)));
+    }, Statement{query});
+  }
+
+  Descriptors result;
+  result.by_oid.reserve(types.size());
+  for (auto& [type_oid, descriptor] : types)
+    insert(result, std::move(descriptor));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Type_catalog::insert(Descriptors& descriptors,
+  Descriptor_ptr descriptor)
+{
+  const auto oid = descriptor->oid;
+  descriptors.by_name.insert_or_assign(std::string{descriptor->schema}
+    .append(1, '.').append(descriptor->name), oid);
+  if (descriptor->schema == "pg_catalog")
+    descriptors.by_name.insert_or_assign(descriptor->name, oid);
+  else if (descriptor->schema == "public")
+    descriptors.by_name.emplace(descriptor->name, oid);
+  descriptors.by_oid.insert_or_assign(oid, std::move(descriptor));
+}
+
+DMITIGR_PGFE_INLINE bool
+Type_catalog::is_fields_loaded(const Type_descriptor& descriptor) noexcept
+{
+  return descriptor.kind != Type_kind::composite || !descriptor.fields.empty();
+}
+
+} // namespace dmitigr::pgfe
@@ -0,0 +1,266 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_TYPE_CATALOG_HPP
+#define DMITIGR_PGFE_TYPE_CATALOG_HPP
+
+#include "basics.hpp"
+#include "column_decoder.hpp"
+#include "dll.hpp"
+#include "row_info.hpp"
+#include "tuple.hpp"
+#include "types_fwd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A kind of data type (the value of `pg_type.typtype`).
+ */
+enum class Type_kind : char {
+  /// Base type.
+  base = 'b',
+  /// Composite type (including the row types of tables).
+  composite = 'c',
+  /// Domain.
+  domain = 'd',
+  /// Enumerated type.
+  enumeration = 'e',
+  /// Pseudo-type.
+  pseudo = 'p',
+  /// Range type.
+  range = 'r',
+  /// Multirange type.
+  multirange = 'm'
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A descriptor of the data type of the server.
+ */
+struct Type_descriptor final {
+  /// A field of composite type.
+  struct Field final {
+    /// The name of the field.
+    std::string name;
+    /// The OID of the type of the field.
+    Oid type_oid{invalid_oid};
+  };
+
+  /// The OID of the type.
+  Oid oid{invalid_oid};
+  /// The name of the schema of the type.
+  std::string schema;
+  /// The name of the type.
+  std::string name;
+  /// The kind of the type.
+  Type_kind kind{Type_kind::base};
+  /// The category of the type (the value of `pg_type.typcategory`).
+  char category{};
+  /// The length of the type (`-1` for varlena types, `-2` for C strings).
+  std::int_fast16_t length{};
+  /// The OID of the type of elements if the type is array.
+  Oid element_oid{invalid_oid};
+  /// The OID of the array type of this type.
+  Oid array_oid{invalid_oid};
+  /// The OID of the base type if the type is domain.
+  Oid base_oid{invalid_oid};
+  /// The OID of the relation if the type is composite.
+  Oid relation_oid{invalid_oid};
+  /// The fields of composite type.
+  std::vector<Field> fields;
+  /// The labels of enumerated type in the sort order.
+  std::vector<std::string> labels;
+
+  /// @returns `true` if the type is array.
+  bool is_array() const noexcept
+  {
+    return category == 'A' && element_oid != invalid_oid;
+  }
+
+  /**
+   * @returns The index of the field `name`, or `fields.size()` if there is no
+   * such field.
+   */
+  std::size_t field_index(const std::string_view name) const noexcept
+  {
+    std::size_t i{};
+    for (; i < fields.size() && fields[i].name != name; ++i);
+    return i;
+  }
+};
+
+/**
+ * @ingroup main
+ *
+ * @brief A cache of the descriptors of the data types of the server.
+ *
+ * @details The OIDs of the types which are not built-in (such as enumerated
+ * types, domains and composite types) differ from database to database, so
+ * they must be resolved at runtime. The catalog loads the descriptors of all
+ * the types by load() at once (fetching `pg_type`, `pg_attribute` and
+ * `pg_enum` with three queries) and serves the lookups by OID or by name
+ * from memory afterwards. The descriptors of the types which are not yet
+ * cached can be loaded on demand by descriptor(Connection&, Oid).
+ *
+ * By default, each Connection has its own catalog. Since the catalog is
+ * thread-safe, the same catalog can be shared by the connections to the same
+ * database, so the catalog is loaded once per pool (see
+ * Connection_pool::type_catalog()).
+ *
+ * @remarks The fields of the row types of tables of the schemas `pg_catalog`
+ * and `information_schema` are not loaded by load(), but load on demand.
+ *
+ * @remarks The catalog doesn't track the DDL. If the types are altered,
+ * clear() or load() should be called.
+ *
+ * @see Connection::type_catalog().
+ */
+class Type_catalog final {
+public:
+  /// The alias of the shared pointer to the descriptor.
+  using Descriptor_ptr = std::shared_ptr<const Type_descriptor>;
+
+  /// Constructs the empty catalog.
+  Type_catalog() = default;
+
+  /// Non copy-constructible.
+  Type_catalog(const Type_catalog&) = delete;
+
+  /// Non copy-assignable.
+  Type_catalog& operator=(const Type_catalog&) = delete;
+
+  /**
+   * @brief Loads the descriptors of all the types of the database. (The
+   * previously cached descriptors are discarded.)
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  DMITIGR_PGFE_API void load(Connection& conn);
+
+  /// @returns `true` if load() was called successfully and not cleared since.
+  DMITIGR_PGFE_API bool is_loaded() const noexcept;
+
+  /// Clears the catalog.
+  DMITIGR_PGFE_API void clear() noexcept;
+
+  /// @returns The number of the cached descriptors.
+  DMITIGR_PGFE_API std::size_t size() const noexcept;
+
+  /// @returns The cached descriptor of the type `oid`, or `nullptr`.
+  DMITIGR_PGFE_API Descriptor_ptr descriptor(Oid oid) const;
+
+  /**
+   * @returns The cached descriptor of the type `name`, or `nullptr`.
+   *
+   * @param name Either the name qualified by the schema (such as
+   * `"public.color"`), or the name of the type of the schemas `pg_catalog`
+   * or `public`.
+   */
+  DMITIGR_PGFE_API Descriptor_ptr descriptor(std::string_view name) const;
+
+  /**
+   * @returns The descriptor of the type `oid` loaded by using `conn` if the
+   * type is not cached yet (or its fields are not loaded), or `nullptr` if
+   * there is no such type.
+   *
+   * @par Requires
+   * `conn.is_ready_for_request()` if the type is not cached.
+   */
+  DMITIGR_PGFE_API Descriptor_ptr descriptor(Connection& conn, Oid oid);
+
+  /**
+   * @returns The OID of the type whose representation the values of the type
+   * `oid` have, i.e. the OID of the base type of domain (recursively), the
+   * OID of `text` for enumerated types, or `oid` otherwise.
+   */
+  DMITIGR_PGFE_API Oid representation_oid(Oid oid) const;
+
+  /**
+   * @returns The decoder of the values of the field `index` to `T`, which
+   * resolves the representation of domains and enumerated types.
+   *
+   * @par Requires
+   * `index < info.field_count()`.
+   *
+   * @see representation_oid().
+   */
+  template<typename T>
+  Column_decoder<T> make_decoder(const Row_info& info,
+    const std::size_t index) const
+  {
+    return Column_decoder<T>{representation_oid(info.type_oid(index)),
+      info.data_format(index)};
+  }
+
+  /**
+   * @returns The compact tuple decoded from the binary representation of the
+   * value of composite type `type_oid`, with the fields named according to the
+   * cached descriptor of the type. (The table of names is shared by all the
+   * tuples of the type.)
+   *
+   * @par Requires
+   * `data.format() == Data_format::binary`, and the descriptor of the type
+   * `type_oid` is cached.
+   *
+   * @remarks The values of the nested composite types can be decoded by
+   * calling this function with the data of fields and the OIDs of their types
+   * from Type_descriptor::fields.
+   *
+   * @see Tuple::from_binary_record(), map_composite().
+   */
+  DMITIGR_PGFE_API Tuple to_tuple(const Data& data, Oid type_oid) const;
+
+private:
+  struct Descriptors final {
+    std::unordered_map<Oid, Descriptor_ptr> by_oid;
+    std::unordered_map<std::string, Oid> by_name;
+  };
+
+  mutable std::shared_mutex mutex_;
+  Descriptors descriptors_;
+  mutable std::unordered_map<Oid,
+    std::shared_ptr<const detail::Tuple_field_names>> field_names_;
+  bool is_loaded_{};
+
+  static Descriptors fetch(Connection& conn, std::optional<Oid> oid);
+  static void insert(Descriptors& descriptors, Descriptor_ptr descriptor);
+  static bool is_fields_loaded(const Type_descriptor& descriptor) noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "type_catalog.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_TYPE_CATALOG_HPP
@@ -39,8 +39,12 @@ enum class Data_format;
 enum class External_library;
 enum class Password_encryption;
 enum class Pipeline_status;
+enum class Pipeline_sync_mode;
 enum class Problem_severity;
+enum class Replication_mode;
 enum class Response_status;
+enum class Result_memory_policy;
+enum class Row_delivery_mode;
 enum class Row_processing;
 enum class Socket_readiness;
 enum class Server_status;
@@ -48,7 +52,10 @@ enum class Session_mode;
 enum class Ssl_certificate_authority_policy;
 enum class Ssl_mode;
 enum class Ssl_protocol_version;
+enum class Trace_point;
+enum class Trace_request;
 enum class Transaction_status;
+enum class Type_kind : char;
 
 enum class Client_errc;
 enum class Server_errc;
@@ -60,33 +67,95 @@ enum class Large_object_seek_whence;
 // Classes
 // -----------------------------------------------------------------------------
 
+class Arrow_batch_builder;
+class Batch_insert;
+class Bulk_completion;
+template<typename> class Column_decoder;
 class Completion;
+class Compiled_connection_options;
 class Composite;
 class Compositional;
 class Connection;
+struct Connection_metrics;
+class Connection_multiplexer;
 class Connection_options;
 class Connection_pool;
+class Connection_reactor;
 class Copier;
+class Copy_binary_writer;
+class Copy_reader;
+class Copy_writer;
+class Csv_writer;
+class Cursor;
 class Data;
+class Data_arena;
 class Data_view;
+class Duration_histogram;
 class Error;
+class Group_commit_executor;
+class Hedged_read_executor;
+class Json;
+class Json_view;
+class Json_row_writer;
 class Large_object;
+class Large_object_streambuf;
 class Message;
+template<typename> class Md_array;
 class Notice;
 class Notification;
+class Notification_dispatcher;
+template<typename> class Nullable_array;
+class Parallel_column_decoder;
+class Parallel_copy_exporter;
+class Parallel_copy_loader;
+class Parallel_large_object_transfer;
+class Parallel_range_query;
+class Partitioned_copy_loader;
+class Pending_result;
+class Poll_reactor;
+class Numeric;
 class Parameterizable;
 class Prepared_statement;
+class Prepared_statement_registry;
 class Named_argument;
 class Problem;
+class Query_catalog;
+class Reactor;
+class Read_coalescer;
 class Ready_for_query;
+class Replication_message;
+class Replication_stream;
 class Response;
+class Result_cache;
+class Routing_connection_pool;
 class Row;
+class Row_batch;
 class Row_info;
+class Row_range;
+class Row_spool;
+template<class> class Row_mapper;
+template<class> struct Row_mapping;
+class Shard_routing_pool;
+class Sharded_connection_pool;
 class Signal;
+class Slow_query_sampler;
+template<std::size_t> class Static_statement;
 class Statement;
+class Statement_binding;
+class Statement_reader;
+class Statement_statistics;
 class Statement_vector;
+struct Trace_event;
+class Traffic_recorder;
+class Traffic_replayer;
 class Transaction_guard;
 class Tuple;
+class Type_catalog;
+struct Type_descriptor;
+class Typed_argument;
+class Uuid;
+class Uv_reactor;
+class Write_coalescer;
 
 class Exception;
 class Client_exception;
@@ -99,6 +168,8 @@ template<typename> struct Conversions;
 /// The implementation details.
 namespace detail {
 
+struct Registered_statement;
+
 template<typename> struct Generic_string_conversions;
 template<typename> struct Numeric_string_conversions;
 
@@ -0,0 +1,195 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "connection.hpp"
+#include "exceptions.hpp"
+#include "uv_reactor.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+namespace detail {
+
+[[noreturn]] inline void throw_uv_reactor_error(const char* const what,
+  const int error)
+{
+  throw Client_exception{std::string{what} + ": " + uv_strerror(error)};
+}
+
+} // namespace detail
+
+DMITIGR_PGFE_INLINE Uv_reactor::~Uv_reactor()
+{
+  while (!sockets_.empty())
+    release(sockets_.begin()->first);
+  uv_prepare_stop(prepare_);
+  uv_close(reinterpret_cast<uv_handle_t*>(prepare_), [](uv_handle_t* handle)
+  {
+    delete reinterpret_cast<uv_prepare_t*>(handle);
+  });
+}
+
+DMITIGR_PGFE_INLINE Uv_reactor::Uv_reactor(uv_loop_t* const loop)
+  : loop_{loop}
+{
+  if (!loop_)
+    throw Client_exception{"cannot create reactor: invalid loop"};
+
+  auto prepare = std::make_unique<uv_prepare_t>();
+  if (const int err = uv_prepare_init(loop_, prepare.get()))
+    detail::throw_uv_reactor_error("cannot create reactor", err);
+  prepare->data = this;
+  if (const int err = uv_prepare_start(prepare.get(), [](uv_prepare_t* handle)
+    {
+      auto* const self = static_cast<Uv_reactor*>(handle->data);
+      try {
+        // The readiness of the output of connections could be changed.
+        self->update_registrations();
+      } catch (...) {
+        self->handle_error();
+      }
+    })) {
+    uv_close(reinterpret_cast<uv_handle_t*>(prepare.release()),
+      [](uv_handle_t* handle)
+      {
+        delete reinterpret_cast<uv_prepare_t*>(handle);
+      });
+    detail::throw_uv_reactor_error("cannot create reactor", err);
+  }
+  // The prepare handle alone must not keep the loop alive.
+  uv_unref(reinterpret_cast<uv_handle_t*>(prepare.get()));
+  prepare_ = prepare.release();
+}
+
+DMITIGR_PGFE_INLINE uv_loop_t* Uv_reactor::loop() const noexcept
+{
+  return loop_;
+}
+
+DMITIGR_PGFE_INLINE int Uv_reactor::run(const uv_run_mode mode)
+{
+  error_ = nullptr;
+  const int result{uv_run(loop_, mode)};
+  if (error_)
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto Uv_reactor::state_of(const int socket)
+  -> Socket_state&
+{
+  if (const auto i = sockets_.find(socket); i != sockets_.end())
+    return *i->second;
+
+  auto state = std::make_unique<Uv_socket_state>();
+  if (const int err = uv_poll_init_socket(loop_, &state->handle_,
+      static_cast<uv_os_sock_t>(socket)))
+    detail::throw_uv_reactor_error("cannot register socket in reactor", err);
+  state->handle_.data = state.get();
+  state->reactor_ = this;
+  state->socket_ = socket;
+  try {
+    sockets_.emplace(socket, state.get());
+  } catch (...) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&state.release()->handle_),
+      [](uv_handle_t* handle)
+      {
+        delete static_cast<Uv_socket_state*>(handle->data);
+      });
+    throw;
+  }
+  return *state.release();
+}
+
+DMITIGR_PGFE_INLINE void Uv_reactor::release(const int socket) noexcept
+{
+  const auto i = sockets_.find(socket);
+  if (i == sockets_.end())
+    return;
+
+  // The memory is released by the loop after closing the handle.
+  auto* const state = static_cast<Uv_socket_state*>(i->second);
+  sockets_.erase(i);
+  state->reactor_ = nullptr;
+  uv_poll_stop(&state->handle_);
+  uv_close(reinterpret_cast<uv_handle_t*>(&state->handle_),
+    [](uv_handle_t* handle)
+    {
+      delete static_cast<Uv_socket_state*>(handle->data);
+    });
+}
+
+DMITIGR_PGFE_INLINE void
+Uv_reactor::update_registration(Socket_state& socket_state)
+{
+  auto& state = static_cast<Uv_socket_state&>(socket_state);
+  const auto readiness = requested_readiness(state);
+  int events{};
+  if ((readiness & Socket_readiness::read_ready) != Socket_readiness::unready)
+    events |= UV_READABLE;
+  if ((readiness & Socket_readiness::write_ready) != Socket_readiness::unready)
+    events |= UV_WRITABLE;
+  if (events == state.registered_events_)
+    return;
+
+  if (!events) {
+    uv_poll_stop(&state.handle_);
+  } else if (const int err = uv_poll_start(&state.handle_, events,
+      [](uv_poll_t* const handle, const int status, const int events)
+      {
+        auto* const state = static_cast<Uv_socket_state*>(handle->data);
+        auto* const self = state->reactor_;
+        if (!self)
+          return;
+
+        auto readiness = Socket_readiness::unready;
+        if (status < 0)
+          readiness |= Socket_readiness::read_ready |
+            Socket_readiness::exceptions;
+        if (events & UV_READABLE)
+          readiness |= Socket_readiness::read_ready;
+        if (events & UV_WRITABLE)
+          readiness |= Socket_readiness::write_ready;
+        try {
+          self->handle(state->socket_, readiness);
+        } catch (...) {
+          self->handle_error();
+        }
+      })) {
+    detail::throw_uv_reactor_error("cannot register socket in reactor", err);
+  }
+  state.registered_events_ = events;
+}
+
+DMITIGR_PGFE_INLINE void Uv_reactor::update_registrations()
+{
+  for (auto& [socket, state] : sockets_)
+    if (state->connection_)
+      update_registration(*state);
+}
+
+DMITIGR_PGFE_INLINE void Uv_reactor::handle_error() noexcept
+{
+  if (!error_)
+    error_ = std::current_exception();
+  uv_stop(loop_);
+}
+
+} // namespace dmitigr::pgfe
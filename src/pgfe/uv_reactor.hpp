@@ -0,0 +1,122 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_UV_REACTOR_HPP
+#define DMITIGR_PGFE_UV_REACTOR_HPP
+
+#include "connection_reactor.hpp"
+#include "dll.hpp"
+
+#include <uv.h>
+
+#include <exception>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief The reactor which drives connections on a libuv event loop.
+ *
+ * @details The socket of each added connection is bound to an `uv_poll_t`
+ * handle. The write interest is updated before each iteration of the loop
+ * by an `uv_prepare_t` handle. The added connections keep the loop alive
+ * until removed.
+ *
+ * @remarks This class is available only if the build option
+ * `DMITIGR_LIBS_PGFE_AIO` is enabled and `DMITIGR_LIBS_AIO` is "uv".
+ *
+ * @remarks This class is not thread-safe. All the functions must be called
+ * from the thread which runs the loop.
+ */
+class Uv_reactor final : public Connection_reactor {
+public:
+  /**
+   * @brief The destructor.
+   *
+   * @details Closes all the handles of the reactor.
+   *
+   * @remarks The loop should be run once more to release the memory of the
+   * closed handles.
+   */
+  DMITIGR_PGFE_API ~Uv_reactor() override;
+
+  /**
+   * @brief The constructor.
+   *
+   * @param loop The loop to drive the connections on. It must outlive
+   * the reactor.
+   *
+   * @par Requires
+   * `loop`.
+   *
+   * @throws Client_exception on error.
+   */
+  DMITIGR_PGFE_API explicit Uv_reactor(uv_loop_t* loop);
+
+  /// Not copy-constructible.
+  Uv_reactor(const Uv_reactor&) = delete;
+
+  /// Not copy-assignable.
+  Uv_reactor& operator=(const Uv_reactor&) = delete;
+
+  /// Not move-constructible.
+  Uv_reactor(Uv_reactor&&) = delete;
+
+  /// Not move-assignable.
+  Uv_reactor& operator=(Uv_reactor&&) = delete;
+
+  /// @returns The loop.
+  DMITIGR_PGFE_API uv_loop_t* loop() const noexcept;
+
+  /**
+   * @brief Runs the loop by calling `uv_run(loop(), mode)`.
+   *
+   * @details If the handlers or the connection operations throw from the
+   * callbacks of the loop, the loop is stopped and the exception is
+   * rethrown from this function.
+   *
+   * @returns The value returned by `uv_run()`.
+   *
+   * @throws Any exception thrown by the handlers or by the connection
+   * operations.
+   */
+  DMITIGR_PGFE_API int run(uv_run_mode mode = UV_RUN_DEFAULT);
+
+private:
+  struct Uv_socket_state final : Socket_state {
+    uv_poll_t handle_{};
+    Uv_reactor* reactor_{};
+  };
+
+  uv_loop_t* loop_{};
+  uv_prepare_t* prepare_{};
+  std::exception_ptr error_;
+
+  Socket_state& state_of(int socket) override;
+  void update_registration(Socket_state& state) override;
+  void release(int socket) noexcept override;
+  void update_registrations();
+  void handle_error() noexcept;
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "uv_reactor.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_UV_REACTOR_HPP
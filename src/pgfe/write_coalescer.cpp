@@ -0,0 +1,240 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../base/assert.hpp"
+#include "copier.hpp"
+#include "copy_writer.hpp"
+#include "exceptions.hpp"
+#include "write_coalescer.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace dmitigr::pgfe {
+
+DMITIGR_PGFE_INLINE Write_coalescer::Write_coalescer(Connection_options options,
+  std::string table, std::vector<std::string> columns)
+  : connection_{std::move(options)}
+  , table_{std::move(table)}
+  , columns_{std::move(columns)}
+{
+  if (table_.empty())
+    throw Client_exception{"cannot create write coalescer: empty table name"};
+  else if (columns_.empty())
+    throw Client_exception{"cannot create write coalescer: no columns specified"};
+
+  flusher_ = std::thread{[this]{work();}};
+}
+
+DMITIGR_PGFE_INLINE Write_coalescer::~Write_coalescer()
+{
+  stop();
+}
+
+DMITIGR_PGFE_INLINE const std::string& Write_coalescer::table() const noexcept
+{
+  return table_;
+}
+
+DMITIGR_PGFE_INLINE const std::vector<std::string>&
+Write_coalescer::columns() const noexcept
+{
+  return columns_;
+}
+
+DMITIGR_PGFE_INLINE void
+Write_coalescer::set_max_batch_size(const std::size_t value)
+{
+  if (!value)
+    throw Client_exception{"cannot set max batch size of write coalescer: "
+      "invalid value"};
+  max_batch_size_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::size_t Write_coalescer::max_batch_size() const noexcept
+{
+  return max_batch_size_;
+}
+
+DMITIGR_PGFE_INLINE void
+Write_coalescer::set_max_delay(const std::chrono::milliseconds value)
+{
+  if (value <= std::chrono::milliseconds::zero())
+    throw Client_exception{"cannot set max delay of write coalescer: "
+      "invalid value"};
+  max_delay_ = value;
+}
+
+DMITIGR_PGFE_INLINE std::chrono::milliseconds
+Write_coalescer::max_delay() const noexcept
+{
+  return max_delay_;
+}
+
+DMITIGR_PGFE_INLINE void Write_coalescer::stop()
+{
+  is_stopped_ = true;
+  {
+    // Prevent the flusher from missing the notification.
+    const std::lock_guard lg{mutex_};
+  }
+  state_changed_.notify_one();
+  if (flusher_.joinable())
+    flusher_.join();
+}
+
+DMITIGR_PGFE_INLINE bool Write_coalescer::is_stopped() const noexcept
+{
+  return is_stopped_;
+}
+
+DMITIGR_PGFE_INLINE std::future<void>
+Write_coalescer::push(std::unique_ptr<Row>&& row)
+{
+  auto result = row->promise_.get_future();
+
+  // The flusher doesn't exit while there are producers in progress.
+  ++producer_count_;
+  if (is_stopped_) {
+    --producer_count_;
+    throw Client_exception{"cannot insert row by write coalescer: "
+      "coalescer is stopped"};
+  }
+  const auto size = ++size_;
+  auto* const r = row.release();
+  r->next_ = head_.load(std::memory_order_relaxed);
+  while (!head_.compare_exchange_weak(r->next_, r,
+      std::memory_order_release, std::memory_order_relaxed));
+  --producer_count_;
+
+  // The flusher is notified only when it's either idle or must flush now.
+  if (size == 1 || size == max_batch_size_) {
+    {
+      const std::lock_guard lg{mutex_};
+    }
+    state_changed_.notify_one();
+  }
+  return result;
+}
+
+DMITIGR_PGFE_INLINE auto Write_coalescer::take() noexcept
+  -> std::vector<std::unique_ptr<Row>>
+{
+  std::vector<std::unique_ptr<Row>> result;
+  auto* row = head_.exchange(nullptr, std::memory_order_acquire);
+  try {
+    while (row) {
+      auto* const next = row->next_;
+      result.emplace_back(row);
+      row = next;
+    }
+  } catch (...) {
+    // Out of memory. The rest of rows is failed by destroying the promises.
+    while (row) {
+      std::unique_ptr<Row> r{row};
+      row = r->next_;
+    }
+  }
+  size_ -= result.size();
+  // The stack is LIFO, so the rows are reversed to keep the order of pushes.
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+DMITIGR_PGFE_INLINE void Write_coalescer::work()
+{
+  while (true) {
+    {
+      std::unique_lock lk{mutex_};
+      state_changed_.wait(lk, [this]{return is_stopped_ || size_;});
+
+      // Wait for the batch to fill.
+      const auto is_full = [this]
+      {
+        return is_stopped_ || size_ >= max_batch_size_;
+      };
+      if (!is_full())
+        state_changed_.wait_for(lk, max_delay_.load(), is_full);
+    }
+
+    // All the rows are pushed if the coalescer is stopped and no producers.
+    const bool is_last{is_stopped_ && !producer_count_};
+    auto batch = take();
+    if (!batch.empty())
+      flush(batch);
+    if (is_last)
+      return;
+  }
+}
+
+DMITIGR_PGFE_INLINE void
+Write_coalescer::flush(std::vector<std::unique_ptr<Row>>& batch)
+{
+  auto& conn = connection_;
+  try {
+    if (!conn.is_connected())
+      conn.connect();
+
+    std::string query{"copy "};
+    query.append(table_).append(" (");
+    for (const auto& column : columns_) {
+      if (&column != &columns_.front())
+        query.append(", ");
+      conn.append_quoted_identifier(query, column);
+    }
+    query.append(") from stdin (format binary)");
+    conn.execute(query);
+
+    auto copier = conn.copier();
+    DMITIGR_ASSERT(copier);
+    {
+      Copy_writer writer{copier};
+      Copy_binary_writer binary_writer{writer};
+      try {
+        for (const auto& row : batch)
+          binary_writer.write_encoded_row(row->data_);
+        while (!binary_writer.end())
+          conn.flush_output(true);
+      } catch (const std::exception& e) {
+        // Bring the connection back to the normal mode if possible.
+        if (conn.is_connected() && copier) {
+          try {
+            while (!writer.end(e.what()))
+              conn.flush_output(true);
+            conn.wait_response();
+          } catch (...) {}
+        }
+        throw;
+      }
+    }
+    conn.wait_response_throw();
+    conn.completion();
+  } catch (...) {
+    const auto e = std::current_exception();
+    for (auto& row : batch)
+      row->promise_.set_exception(e);
+    // The connection will be re-established on the next flush.
+    if (conn.is_connected() && !conn.is_ready_for_request())
+      conn.disconnect();
+    return;
+  }
+
+  for (auto& row : batch)
+    row->promise_.set_value();
+}
+
+} // namespace dmitigr::pgfe
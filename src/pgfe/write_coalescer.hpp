@@ -0,0 +1,205 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_PGFE_WRITE_COALESCER_HPP
+#define DMITIGR_PGFE_WRITE_COALESCER_HPP
+
+#include "connection.hpp"
+#include "connection_options.hpp"
+#include "copy_binary_writer.hpp"
+#include "dll.hpp"
+#include "exceptions.hpp"
+#include "types_fwd.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dmitigr::pgfe {
+
+/**
+ * @ingroup main
+ *
+ * @brief A coalescer of the single-row inserts submitted from many threads
+ * into the `COPY` commands.
+ *
+ * @details The rows are encoded in the binary format of `COPY` by the
+ * submitting threads and pushed into the lock-free multi-producer queue. The
+ * flusher thread takes all the queued rows either every max_delay() or as
+ * soon as max_batch_size() rows are queued, and streams them into the table
+ * by the single `COPY FROM STDIN (FORMAT binary)` command on its own
+ * connection. For example:
+ * @code
+ * pgfe::Write_coalescer events{options, "event", {"id", "payload"}};
+ * // In any thread.
+ * auto inserted = events.insert(id, payload);
+ * inserted.get(); // wait for the commit, if needed
+ * @endcode
+ *
+ * @remarks Since each `COPY` command is atomic, the rows of the batch are
+ * either all committed or all failed.
+ * @remarks The connection is established on the first flush, and is
+ * re-established on the next flush after a failure.
+ *
+ * @see Copy_binary_writer, Group_commit_executor.
+ */
+class Write_coalescer final {
+public:
+  /// The default number of queued rows which triggers the flush.
+  static constexpr std::size_t default_max_batch_size{10000};
+
+  /// The default maximum delay of the flush of the queued rows.
+  static constexpr std::chrono::milliseconds default_max_delay{10};
+
+  /**
+   * @brief The constructor. Starts the flusher.
+   *
+   * @param options The options of the connection of the flusher.
+   * @param table The name of the table, which is inserted into the SQL query
+   * as is and therefore should be quoted by the caller if needed.
+   * @param columns The names of the columns. The names are quoted by using
+   * Connection::to_quoted_identifier().
+   *
+   * @par Requires
+   * `!table.empty() && !columns.empty()`.
+   */
+  DMITIGR_PGFE_API Write_coalescer(Connection_options options,
+    std::string table, std::vector<std::string> columns);
+
+  /// Calls stop().
+  DMITIGR_PGFE_API ~Write_coalescer();
+
+  /// Not copy-constructible.
+  Write_coalescer(const Write_coalescer&) = delete;
+
+  /// Not copy-assignable.
+  Write_coalescer& operator=(const Write_coalescer&) = delete;
+
+  /// Not move-constructible.
+  Write_coalescer(Write_coalescer&&) = delete;
+
+  /// Not move-assignable.
+  Write_coalescer& operator=(Write_coalescer&&) = delete;
+
+  /// @returns The name of the table.
+  DMITIGR_PGFE_API const std::string& table() const noexcept;
+
+  /// @returns The names of the columns.
+  DMITIGR_PGFE_API const std::vector<std::string>& columns() const noexcept;
+
+  /**
+   * @brief Sets the number of queued rows which triggers the flush.
+   *
+   * @par Requires
+   * `value`.
+   */
+  DMITIGR_PGFE_API void set_max_batch_size(std::size_t value);
+
+  /// @returns The number of queued rows which triggers the flush.
+  DMITIGR_PGFE_API std::size_t max_batch_size() const noexcept;
+
+  /**
+   * @brief Sets the maximum delay of the flush of the queued rows.
+   *
+   * @details The greater delay trades the latency for the throughput.
+   *
+   * @par Requires
+   * `value > std::chrono::milliseconds::zero()`.
+   */
+  DMITIGR_PGFE_API void set_max_delay(std::chrono::milliseconds value);
+
+  /// @returns The maximum delay of the flush of the queued rows.
+  DMITIGR_PGFE_API std::chrono::milliseconds max_delay() const noexcept;
+
+  /**
+   * @brief Queues the row of the specified `values` to insert.
+   *
+   * @details The values are encoded as by Copy_binary_writer::write_row().
+   *
+   * @returns The future which is ready when the `COPY` command the row is
+   * flushed with is completed. The future holds the exception if the command
+   * is failed.
+   *
+   * @par Requires
+   * `sizeof...(values) == columns().size() && !is_stopped()`.
+   *
+   * @par Thread safety
+   * Thread-safe.
+   */
+  template<typename ... Types>
+  std::future<void> insert(const Types& ... values)
+  {
+    if (sizeof...(values) != columns_.size())
+      throw Client_exception{"cannot insert row by write coalescer: "
+        "invalid number of values"};
+
+    auto row = std::make_unique<Row>();
+    Copy_binary_writer::encode_row(row->data_, values...);
+    return push(std::move(row));
+  }
+
+  /**
+   * @brief Stops accepting the rows, flushes the queued rows and stops the
+   * flusher.
+   *
+   * @par Effects
+   * `is_stopped()`.
+   */
+  DMITIGR_PGFE_API void stop();
+
+  /// @returns `true` if the coalescer is stopped.
+  DMITIGR_PGFE_API bool is_stopped() const noexcept;
+
+private:
+  struct Row final {
+    std::string data_;
+    std::promise<void> promise_;
+    Row* next_{};
+  };
+
+  Connection connection_;
+  std::string table_;
+  std::vector<std::string> columns_;
+  std::atomic<Row*> head_{}; // the lock-free stack of the queued rows
+  std::atomic<std::size_t> size_{}; // the number of the queued rows
+  std::atomic<std::size_t> producer_count_{}; // the number of the pushers
+  std::atomic<std::size_t> max_batch_size_{default_max_batch_size};
+  std::atomic<std::chrono::milliseconds> max_delay_{default_max_delay};
+  std::atomic<bool> is_stopped_{};
+  std::mutex mutex_;
+  std::condition_variable state_changed_;
+  std::thread flusher_;
+
+  DMITIGR_PGFE_API std::future<void> push(std::unique_ptr<Row>&& row);
+  std::vector<std::unique_ptr<Row>> take() noexcept;
+  void work();
+  void flush(std::vector<std::unique_ptr<Row>>& batch);
+};
+
+} // namespace dmitigr::pgfe
+
+#ifndef DMITIGR_PGFE_NOT_HEADER_ONLY
+#include "write_coalescer.cpp"
+#endif
+
+#endif  // DMITIGR_PGFE_WRITE_COALESCER_HPP
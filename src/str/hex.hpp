@@ -0,0 +1,188 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_STR_HEX_HPP
+#define DMITIGR_STR_HEX_HPP
+
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dmitigr::str {
+
+// -----------------------------------------------------------------------------
+// Hex encoding
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Writes the lowercase hexadecimal representation of `size` bytes of
+ * `src` to `dest`.
+ *
+ * @par Requires
+ * `dest` must point to at least `2*size` bytes.
+ *
+ * @remarks The SIMD instructions (SSE2 or NEON) are used if available.
+ */
+inline void hex_encode(char* dest, const void* const src, std::size_t size) noexcept
+{
+  const auto* s = static_cast<const std::uint8_t*>(src);
+#if defined(DMITIGR_STR_SSE2)
+  const auto mask = _mm_set1_epi8(0x0f);
+  const auto nine = _mm_set1_epi8(9);
+  const auto zero = _mm_set1_epi8('0');
+  const auto alpha = _mm_set1_epi8('a' - '0' - 10);
+  const auto to_digits = [&](const __m128i nibbles) noexcept
+  {
+    const auto is_alpha = _mm_cmpgt_epi8(nibbles, nine);
+    return _mm_add_epi8(_mm_add_epi8(nibbles, zero),
+      _mm_and_si128(is_alpha, alpha));
+  };
+  for (; size >= 16; size -= 16, s += 16, dest += 32) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+    const auto lo = _mm_and_si128(v, mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+      to_digits(_mm_unpacklo_epi8(hi, lo)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16),
+      to_digits(_mm_unpackhi_epi8(hi, lo)));
+  }
+#elif defined(DMITIGR_STR_NEON)
+  static const std::uint8_t digits[16] = {'0', '1', '2', '3', '4', '5', '6',
+    '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+  const auto table = vld1q_u8(digits);
+  const auto mask = vdupq_n_u8(0x0f);
+  for (; size >= 16; size -= 16, s += 16, dest += 32) {
+    const auto v = vld1q_u8(s);
+    uint8x16x2_t r;
+    r.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+    r.val[1] = vqtbl1q_u8(table, vandq_u8(v, mask));
+    vst2q_u8(reinterpret_cast<std::uint8_t*>(dest), r);
+  }
+#endif
+  for (; size; --size, ++s) {
+    *dest++ = "0123456789abcdef"[*s >> 4];
+    *dest++ = "0123456789abcdef"[*s & 0x0f];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Hex decoding
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Writes `size/2` bytes represented by `size` hexadecimal digits of
+ * `src` (in either case) to `dest`.
+ *
+ * @returns `false` if `src` contains a character which isn't a hexadecimal
+ * digit. In this case the content of `dest` is unspecified.
+ *
+ * @par Requires
+ * `size` must be even, and `dest` must point to at least `size/2` bytes.
+ *
+ * @remarks The SIMD instructions (SSE2 or NEON) are used if available.
+ */
+inline bool hex_decode(void* const dest, const char* src, std::size_t size) noexcept
+{
+  auto* d = static_cast<std::uint8_t*>(dest);
+#if defined(DMITIGR_STR_SSE2)
+  /*
+   * The values of digits are computed for both [0-9] and [a-fA-F] ranges, the
+   * range checks are done by the signed comparisons of biased values.
+   */
+  const auto bias = _mm_set1_epi8(static_cast<char>(0x80));
+  const auto digit_limit = _mm_set1_epi8(static_cast<char>(0x80 + 10));
+  const auto alpha_limit = _mm_set1_epi8(static_cast<char>(0x80 + 6));
+  const auto case_bit = _mm_set1_epi8(0x20);
+  const auto zero = _mm_set1_epi8('0');
+  const auto a = _mm_set1_epi8('a');
+  const auto ten = _mm_set1_epi8(10);
+  const auto low_bytes = _mm_set1_epi16(0x00ff);
+  const auto to_values = [&](const __m128i c, int& valid) noexcept
+  {
+    const auto digit = _mm_sub_epi8(c, zero);
+    const auto alpha = _mm_sub_epi8(_mm_or_si128(c, case_bit), a);
+    const auto is_digit = _mm_cmplt_epi8(_mm_xor_si128(digit, bias), digit_limit);
+    const auto is_alpha = _mm_cmplt_epi8(_mm_xor_si128(alpha, bias), alpha_limit);
+    valid &= _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha));
+    return _mm_or_si128(_mm_and_si128(is_digit, digit),
+      _mm_andnot_si128(is_digit, _mm_add_epi8(alpha, ten)));
+  };
+  const auto to_bytes = [&](const __m128i values) noexcept
+  {
+    // Each 16-bit lane holds the high nibble in low byte and vice versa.
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, low_bytes), 4),
+      _mm_srli_epi16(values, 8));
+  };
+  for (; size >= 32; size -= 32, src += 32, d += 16) {
+    int valid{0xffff};
+    const auto v1 = to_values(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src)), valid);
+    const auto v2 = to_values(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + 16)), valid);
+    if (valid != 0xffff)
+      return false;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d),
+      _mm_packus_epi16(to_bytes(v1), to_bytes(v2)));
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto case_bit = vdupq_n_u8(0x20);
+  const auto zero = vdupq_n_u8('0');
+  const auto a = vdupq_n_u8('a');
+  const auto ten = vdupq_n_u8(10);
+  const auto six = vdupq_n_u8(6);
+  const auto to_values = [&](const uint8x16_t c, uint8x16_t& valid) noexcept
+  {
+    const auto digit = vsubq_u8(c, zero);
+    const auto alpha = vsubq_u8(vorrq_u8(c, case_bit), a);
+    const auto is_digit = vcltq_u8(digit, ten);
+    valid = vandq_u8(valid, vorrq_u8(is_digit, vcltq_u8(alpha, six)));
+    return vbslq_u8(is_digit, digit, vaddq_u8(alpha, ten));
+  };
+  for (; size >= 32; size -= 32, src += 32, d += 16) {
+    const auto c = vld2q_u8(reinterpret_cast<const std::uint8_t*>(src));
+    auto valid = vdupq_n_u8(0xff);
+    const auto hi = to_values(c.val[0], valid);
+    const auto lo = to_values(c.val[1], valid);
+    if (vminvq_u8(valid) != 0xff)
+      return false;
+    vst1q_u8(d, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+  }
+#endif
+  const auto value = [](const char c) noexcept -> int
+  {
+    if ('0' <= c && c <= '9')
+      return c - '0';
+    else if ('a' <= c && c <= 'f')
+      return c - 'a' + 10;
+    else if ('A' <= c && c <= 'F')
+      return c - 'A' + 10;
+    else
+      return -1;
+  };
+  for (; size >= 2; size -= 2, src += 2) {
+    const int hi{value(src[0])};
+    const int lo{value(src[1])};
+    if (hi < 0 || lo < 0)
+      return false;
+    *d++ = static_cast<std::uint8_t>(hi << 4 | lo);
+  }
+  return true;
+}
+
+} // namespace dmitigr::str
+
+#endif  // DMITIGR_STR_HEX_HPP
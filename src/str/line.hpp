@@ -18,12 +18,14 @@
 #define DMITIGR_STR_LINE_HPP
 
 #include "exceptions.hpp"
+#include "substr.hpp"
 
 #include <algorithm>
 #include <cstddef>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace dmitigr::str {
 
@@ -73,6 +75,122 @@ line_column_numbers_by_position(const std::string& str,
   return std::make_pair(line, column);
 }
 
+/**
+ * @brief Calls `callback(line)` for each line of `data`.
+ *
+ * @details The lines are separated by `delimiter` which is not included into
+ * the lines passed to the `callback`. Similarly to `std::getline()`, the
+ * last line is passed only if it's not empty.
+ *
+ * @param callback The function of form `callback(std::string_view line)`.
+ */
+template<typename F>
+void for_each_line(const std::string_view data, F&& callback,
+  const char delimiter = '\n')
+{
+  const char* b{data.data()};
+  const char* const e{b + data.size()};
+  while (b != e) {
+    const char* const d{find_char(b, e, delimiter)};
+    callback(std::string_view{b, static_cast<std::size_t>(d - b)});
+    if (d == e)
+      break;
+    b = d + 1;
+  }
+}
+
+/**
+ * @brief An index of line offsets of a string.
+ *
+ * @details The string is scanned once upon construction. The subsequent
+ * queries are answered by binary search, and their results are equal to the
+ * results of line_number_by_position() and line_column_numbers_by_position().
+ */
+class Line_index final {
+public:
+  /// Constructs the index of an empty string.
+  Line_index() = default;
+
+  /// Constructs the index of `str`.
+  explicit Line_index(const std::string_view str)
+    : size_{str.size()}
+  {
+    const char* const b{str.data()};
+    const char* const e{b + str.size()};
+    for (const char* p{find_char(b, e, '\n')}; p != e;
+         p = find_char(p + 1, e, '\n'))
+      newlines_.push_back(static_cast<std::size_t>(p - b));
+  }
+
+  /// @returns The size of the indexed string.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns The number of lines of the indexed string.
+  std::size_t line_count() const noexcept
+  {
+    return newlines_.size() + 1;
+  }
+
+  /**
+   * @returns The position of the beginning of the line `line`.
+   *
+   * @par Requires
+   * `(line < line_count())`.
+   */
+  std::size_t line_position(const std::size_t line) const
+  {
+    if (!(line < line_count()))
+      throw Exception{"cannot get position of line by invalid line number"};
+
+    return line ? newlines_[line - 1] + 1 : 0;
+  }
+
+  /**
+   * @returns The line number (which starts at 0) by the given absolute position.
+   *
+   * @par Requires
+   * `(pos < size())`.
+   */
+  std::size_t line_number(const std::size_t pos) const
+  {
+    if (!(pos < size_))
+      throw Exception{"cannot get line number by invalid position"};
+
+    return line_number__(pos);
+  }
+
+  /**
+   * @returns The line and column numbers (both starts at 0) by the given
+   * absolute position.
+   *
+   * @par Requires
+   * `(pos < size())`.
+   */
+  std::pair<std::size_t, std::size_t>
+  line_column_numbers(const std::size_t pos) const
+  {
+    if (!(pos < size_))
+      throw Exception{"cannot get line and column numbers by invalid position"};
+
+    const auto line = line_number__(pos);
+    return std::make_pair(line, pos - (line ? newlines_[line - 1] + 1 : 0));
+  }
+
+private:
+  std::size_t size_{};
+  std::vector<std::size_t> newlines_;
+
+  std::size_t line_number__(const std::size_t pos) const noexcept
+  {
+    // The newline at `pos` belongs to the line it terminates.
+    return static_cast<std::size_t>(std::lower_bound(newlines_.cbegin(),
+        newlines_.cend(), pos) - newlines_.cbegin());
+  }
+};
+
 } // namespace dmitigr::str
 
 #endif  // DMITIGR_STR_LINE_HPP
@@ -17,8 +17,13 @@
 #ifndef DMITIGR_STR_SEQUENCE_HPP
 #define DMITIGR_STR_SEQUENCE_HPP
 
+#include "substr.hpp"
+
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -28,21 +33,60 @@ namespace dmitigr::str {
 // Sequence conversions
 // -----------------------------------------------------------------------------
 
-/// @returns The string with stringified elements of the sequence in range `[b, e)`.
+/**
+ * @returns The string with stringified elements of the sequence in range `[b, e)`.
+ *
+ * @param to_str The function of form `to_str(element)` which returns the string
+ * representation of `element`, or the function of form `to_str(result, element)`
+ * which appends the string representation of `element` to `result`. Using of
+ * the latter form avoids the temporary strings.
+ */
 template<class InputIterator, typename Function>
 std::string to_string(const InputIterator b, const InputIterator e,
   const std::string_view sep, const Function& to_str)
 {
   std::string result;
-  if (b != e) {
-    auto i = b;
-    for (; i != e; ++i) {
+  for (auto i = b; i != e; ++i) {
+    if (i != b)
+      result.append(sep);
+    if constexpr (std::is_invocable_v<const Function&, std::string&,
+        decltype(*i)>)
+      to_str(result, *i);
+    else
       result.append(to_str(*i));
+  }
+  return result;
+}
+
+/**
+ * @overload
+ *
+ * @details The size of the result is estimated by the pass over the sequence
+ * in order to allocate the memory for the result at once.
+ *
+ * @param append The function of form `append(result, element)` which appends
+ * the string representation of `element` to `result`.
+ * @param estimate_size The function of form `estimate_size(element)` which
+ * returns the estimated size of the string representation of `element`.
+ */
+template<class ForwardIterator, typename Appender, typename Estimator>
+std::string to_string(const ForwardIterator b, const ForwardIterator e,
+  const std::string_view sep, const Appender& append,
+  const Estimator& estimate_size)
+{
+  std::string::size_type size{};
+  std::string::size_type count{};
+  for (auto i = b; i != e; ++i, ++count)
+    size += estimate_size(*i);
+  if (count)
+    size += (count - 1) * sep.size();
+
+  std::string result;
+  result.reserve(size);
+  for (auto i = b; i != e; ++i) {
+    if (i != b)
       result.append(sep);
-    }
-    const auto sep_size = sep.size();
-    for (std::string::size_type j{}; j < sep_size; ++j)
-      result.pop_back();
+    append(result, *i);
   }
   return result;
 }
@@ -65,11 +109,148 @@ std::string to_string(const Container& cont, const std::string_view sep)
   });
 }
 
+/**
+ * @brief A lazy range of the parts of a string separated by any of the
+ * separator characters.
+ *
+ * @details The parts are views of the string, so no memory is allocated. The
+ * parts are the same as the parts produced by to_vector().
+ *
+ * @remarks Both the string and the separators must outlive the range.
+ *
+ * @see split().
+ */
+class Split_range final {
+public:
+  /// The iterator of parts.
+  class Iterator final {
+  public:
+    /// The iterator category.
+    using iterator_category = std::forward_iterator_tag;
+
+    /// The value type.
+    using value_type = std::string_view;
+
+    /// The difference type.
+    using difference_type = std::ptrdiff_t;
+
+    /// The pointer type.
+    using pointer = const std::string_view*;
+
+    /// The reference type.
+    using reference = const std::string_view&;
+
+    /// Constructs the past-the-end iterator.
+    Iterator() noexcept = default;
+
+    /// @returns The current part.
+    reference operator*() const noexcept
+    {
+      return part_;
+    }
+
+    /// @returns The pointer to the current part.
+    pointer operator->() const noexcept
+    {
+      return &part_;
+    }
+
+    /// Moves to the next part.
+    Iterator& operator++() noexcept
+    {
+      const char* const part_end{part_.data() + part_.size()};
+      if (part_end == range_->end_)
+        *this = Iterator{};
+      else
+        set_part(part_end + 1);
+      return *this;
+    }
+
+    /// Moves to the next part.
+    Iterator operator++(int) noexcept
+    {
+      auto result = *this;
+      ++*this;
+      return result;
+    }
+
+    /// @returns `true` if `lhs` and `rhs` refer to the same part.
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return lhs.range_ == rhs.range_ && lhs.part_.data() == rhs.part_.data();
+    }
+
+    /// @returns `!(lhs == rhs)`.
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept
+    {
+      return !(lhs == rhs);
+    }
+
+  private:
+    friend Split_range;
+
+    const Split_range* range_{};
+    std::string_view part_;
+
+    Iterator(const Split_range& range, const char* const begin) noexcept
+      : range_{&range}
+    {
+      set_part(begin);
+    }
+
+    void set_part(const char* const begin) noexcept
+    {
+      const char* const end{find_first_of_chars(begin, range_->end_,
+        range_->separators_)};
+      part_ = {begin, static_cast<std::size_t>(end - begin)};
+    }
+  };
+
+  /// Constructs the range of parts of `input` separated by any of `separators`.
+  Split_range(const std::string_view input,
+    const std::string_view separators) noexcept
+    : input_{input}
+    , separators_{separators}
+    , end_{input.data() + input.size()}
+  {}
+
+  /// @returns The iterator to the first part.
+  Iterator begin() const noexcept
+  {
+    return input_.empty() ? end() : Iterator{*this, input_.data()};
+  }
+
+  /// @returns The past-the-end iterator.
+  Iterator end() const noexcept
+  {
+    return Iterator{};
+  }
+
+private:
+  std::string_view input_;
+  std::string_view separators_;
+  const char* end_{};
+};
+
+/**
+ * @returns The lazy range of the parts of `input` separated by any of
+ * `separators`.
+ *
+ * @see Split_range.
+ */
+inline Split_range split(const std::string_view input,
+  const std::string_view separators) noexcept
+{
+  return Split_range{input, separators};
+}
+
 /**
  * @brief Splits the `input` string into the parts separated by the
  * specified `separators`.
  *
  * @returns The vector of splitted parts.
+ *
+ * @see split().
  */
 template<class S = std::string>
 inline std::vector<S> to_vector(const std::string_view input,
@@ -77,18 +258,8 @@ inline std::vector<S> to_vector(const std::string_view input,
 {
   std::vector<S> result;
   result.reserve(4);
-  std::string_view::size_type pos{std::string_view::npos};
-  std::string_view::size_type offset{};
-  while (offset < input.size()) {
-    pos = input.find_first_of(separators, offset);
-    DMITIGR_ASSERT(offset <= pos);
-    const auto part_size =
-      std::min<std::string_view::size_type>(pos, input.size()) - offset;
-    result.push_back(S{input.substr(offset, part_size)});
-    offset += part_size + 1;
-  }
-  if (pos != std::string_view::npos) // input ends with a separator
-    result.emplace_back();
+  for (const auto part : split(input, separators))
+    result.push_back(S{part});
   return result;
 }
 
@@ -0,0 +1,32 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_STR_SIMD_HPP
+#define DMITIGR_STR_SIMD_HPP
+
+/*
+ * Defines DMITIGR_STR_SSE2 or DMITIGR_STR_NEON if the corresponding SIMD
+ * instructions are available at compile time, and includes the intrinsics.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DMITIGR_STR_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define DMITIGR_STR_NEON
+#include <arm_neon.h>
+#endif
+
+#endif  // DMITIGR_STR_SIMD_HPP
@@ -21,10 +21,12 @@
 #include "c_str.h"
 #include "c_str.hpp"
 #include "exceptions.hpp"
+#include "hex.hpp"
 #include "line.hpp"
 #include "numeric.hpp"
 #include "predicate.hpp"
 #include "sequence.hpp"
+#include "simd.hpp"
 #include "stream.hpp"
 #include "substr.hpp"
 #include "time.hpp"
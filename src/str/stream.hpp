@@ -19,8 +19,10 @@
 
 #include "../base/ret.hpp"
 #include "../fsx/filesystem.hpp"
+#include "../fsx/mapped_file.hpp"
 #include "basics.hpp"
 #include "exceptions.hpp"
+#include "line.hpp"
 #include "predicate.hpp"
 
 #include <algorithm>
@@ -32,6 +34,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace dmitigr::str {
@@ -98,6 +101,46 @@ read_to_strings(const std::filesystem::path& path,
     delimiter, is_binary);
 }
 
+/**
+ * @brief Splits the content of the mapped file into the vector of lines.
+ *
+ * @details Unlike read_to_strings_if() the lines are not copied.
+ *
+ * @param file The mapped file. It must outlive the result.
+ * @param pred The predicate of form `pred(line)` that returns `true` to
+ * indicate that `line` must be appended to the result.
+ * @param delimiter The delimiter character.
+ *
+ * @returns The views of lines of the `file`.
+ *
+ * @see for_each_line().
+ */
+template<typename Pred>
+std::vector<std::string_view>
+read_to_string_views_if(const fsx::Mapped_file& file, const Pred& pred,
+  const char delimiter = '\n')
+{
+  std::vector<std::string_view> result;
+  for_each_line(file.view(), [&result, &pred](const std::string_view line)
+  {
+    if (pred(line))
+      result.push_back(line);
+  }, delimiter);
+  return result;
+}
+
+/**
+ * @brief The convenient shortcut of read_to_string_views_if().
+ *
+ * @see read_to_string_views_if().
+ */
+inline std::vector<std::string_view>
+read_to_string_views(const fsx::Mapped_file& file, const char delimiter = '\n')
+{
+  return read_to_string_views_if(file, [](const auto&){return true;},
+    delimiter);
+}
+
 /**
  * @brief Reads a whole `input` stream to a string.
  *
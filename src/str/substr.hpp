@@ -19,11 +19,20 @@
 
 #include "predicate.hpp"
 #include "exceptions.hpp"
+#include "simd.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string_view>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace dmitigr::str {
 
 // -----------------------------------------------------------------------------
@@ -50,6 +59,109 @@ first_non_space_pos(const std::string_view str, const std::string_view::size_typ
     : std::string_view::npos;
 }
 
+namespace detail {
+
+/// @returns The number of trailing zero bits of the non-zero `value`.
+inline unsigned count_trailing_zeros(const std::uint64_t value) noexcept
+{
+#ifdef _MSC_VER
+  unsigned long result{};
+  _BitScanForward64(&result, value);
+  return static_cast<unsigned>(result);
+#else
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @returns The pointer to the first occurrence of `ch` in `[first, last)`, or
+ * `last` if there is no such a character.
+ *
+ * @remarks The SIMD instructions (SSE2 or NEON) are used if available.
+ */
+inline const char* find_char(const char* first, const char* const last,
+  const char ch) noexcept
+{
+#if defined(DMITIGR_STR_SSE2)
+  const auto needle = _mm_set1_epi8(ch);
+  for (; last - first >= 16; first += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    if (const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)))
+      return first + detail::count_trailing_zeros(static_cast<unsigned>(mask));
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto needle = vdupq_n_u8(static_cast<std::uint8_t>(ch));
+  for (; last - first >= 16; first += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+    // Each byte of the comparison result is narrowed to 4 bits of the mask.
+    const auto eq = vreinterpretq_u16_u8(vceqq_u8(v, needle));
+    const auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(eq, 4)), 0);
+    if (mask)
+      return first + detail::count_trailing_zeros(mask) / 4;
+  }
+#endif
+  const auto* const result = static_cast<const char*>(std::memchr(first, ch,
+      static_cast<std::size_t>(last - first)));
+  return result ? result : last;
+}
+
+/**
+ * @returns The pointer to the first occurrence of any of `chars` in
+ * `[first, last)`, or `last` if there is no such a character.
+ *
+ * @remarks The SIMD instructions (SSE2 or NEON) are used if available and
+ * `chars` consists of no more than 16 characters.
+ */
+inline const char* find_first_of_chars(const char* first, const char* const last,
+  const std::string_view chars) noexcept
+{
+  if (chars.empty())
+    return last;
+  else if (chars.size() == 1)
+    return find_char(first, last, chars[0]);
+
+  if (chars.size() <= 16) {
+#if defined(DMITIGR_STR_SSE2)
+    __m128i needles[16];
+    for (std::size_t i{}; i < chars.size(); ++i)
+      needles[i] = _mm_set1_epi8(chars[i]);
+    for (; last - first >= 16; first += 16) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+      auto eq = _mm_cmpeq_epi8(v, needles[0]);
+      for (std::size_t i{1}; i < chars.size(); ++i)
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, needles[i]));
+      if (const int mask = _mm_movemask_epi8(eq))
+        return first + detail::count_trailing_zeros(static_cast<unsigned>(mask));
+    }
+#elif defined(DMITIGR_STR_NEON)
+    uint8x16_t needles[16];
+    for (std::size_t i{}; i < chars.size(); ++i)
+      needles[i] = vdupq_n_u8(static_cast<std::uint8_t>(chars[i]));
+    for (; last - first >= 16; first += 16) {
+      const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+      auto eq = vceqq_u8(v, needles[0]);
+      for (std::size_t i{1}; i < chars.size(); ++i)
+        eq = vorrq_u8(eq, vceqq_u8(v, needles[i]));
+      const auto mask = vget_lane_u64(vreinterpret_u64_u8(
+          vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+      if (mask)
+        return first + detail::count_trailing_zeros(mask) / 4;
+    }
+#endif
+  }
+
+  std::array<bool, 256> is_char{};
+  for (const char ch : chars)
+    is_char[static_cast<unsigned char>(ch)] = true;
+  for (; first != last; ++first) {
+    if (is_char[static_cast<unsigned char>(*first)])
+      return first;
+  }
+  return last;
+}
+
 } // namespace dmitigr::str
 
 #endif  // DMITIGR_STR_SUBSTR_HPP
@@ -17,42 +17,180 @@
 #ifndef DMITIGR_STR_TIME_HPP
 #define DMITIGR_STR_TIME_HPP
 
-#include "../base/assert.hpp"
 #include "exceptions.hpp"
 
 #include <chrono>
-#include <cstring>
-#include <cstdio>
+#include <cstddef>
 #include <ctime>
 #include <string_view>
 
 namespace dmitigr::str {
 
+namespace detail {
+
+/// The layouts of formatted timepoints.
+enum class Time_layout {
+  /// `YYYY-MM-DD HH:MM:SS.ffffff` (local time).
+  human,
+
+  /// `YYYY-MM-DDTHH:MM:SS.ffffffZ`.
+  rfc3339_utc,
+
+  /// `YYYY-MM-DDTHH:MM:SS.ffffff+HH:MM` (local time).
+  rfc3339_local
+};
+
+/// A formatted timepoint which is reused while the second is unchanged.
+struct Time_format_cache final {
+  bool is_valid{};
+  std::time_t second{};
+  std::size_t fraction_pos{};
+  std::size_t size{};
+  char buf[40]{};
+};
+
+/// @returns The number of days since 1970-01-01 of the given civil date.
+constexpr long long days_from_civil(long long y, const unsigned m,
+  const unsigned d) noexcept
+{
+  y -= m <= 2;
+  const long long era{(y >= 0 ? y : y - 399) / 400};
+  const auto yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy{(153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1};
+  const unsigned doe{yoe * 365 + yoe / 4 - yoe / 100 + doy};
+  return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+/// Writes `width` decimal digits of `value` to `dest`.
+inline void write_digits(char* const dest, unsigned long value,
+  const std::size_t width) noexcept
+{
+  for (std::size_t i{width}; i--; value /= 10)
+    dest[i] = static_cast<char>('0' + value % 10);
+}
+
 /**
- * @returns The human-readable string representation of the given timepoint
- * with microseconds or empty string_view on error.
+ * @brief Formats the whole seconds part of `second` into `cache`.
+ *
+ * @returns `false` on error.
+ */
+inline bool format_second(Time_format_cache& cache, const std::time_t second,
+  const Time_layout layout) noexcept
+{
+  const bool is_utc{layout == Time_layout::rfc3339_utc};
+  std::tm tm{};
+#ifdef _WIN32
+  if (is_utc ? gmtime_s(&tm, &second) : localtime_s(&tm, &second))
+    return false;
+#else
+  if (!(is_utc ? gmtime_r(&second, &tm) : localtime_r(&second, &tm)))
+    return false;
+#endif
+  if (tm.tm_year + 1900 < 0 || tm.tm_year + 1900 > 9999)
+    return false;
+
+  char* const b{cache.buf};
+  write_digits(b, static_cast<unsigned long>(tm.tm_year + 1900), 4);
+  b[4] = '-';
+  write_digits(b + 5, static_cast<unsigned long>(tm.tm_mon + 1), 2);
+  b[7] = '-';
+  write_digits(b + 8, static_cast<unsigned long>(tm.tm_mday), 2);
+  b[10] = layout == Time_layout::human ? ' ' : 'T';
+  write_digits(b + 11, static_cast<unsigned long>(tm.tm_hour), 2);
+  b[13] = ':';
+  write_digits(b + 14, static_cast<unsigned long>(tm.tm_min), 2);
+  b[16] = ':';
+  write_digits(b + 17, static_cast<unsigned long>(tm.tm_sec), 2);
+  b[19] = '.';
+  cache.fraction_pos = 20;
+  cache.size = cache.fraction_pos + 6;
+  if (layout == Time_layout::rfc3339_utc) {
+    b[cache.size++] = 'Z';
+  } else if (layout == Time_layout::rfc3339_local) {
+    // The offset is the difference between the local civil time and UTC.
+    const long long local{days_from_civil(tm.tm_year + 1900,
+        static_cast<unsigned>(tm.tm_mon + 1),
+        static_cast<unsigned>(tm.tm_mday)) * 86400 +
+      tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec};
+    const long long offset{(local - static_cast<long long>(second)) / 60};
+    const auto abs_offset = static_cast<unsigned long>(offset < 0 ? -offset : offset);
+    char* const o{b + cache.size};
+    o[0] = offset < 0 ? '-' : '+';
+    write_digits(o + 1, abs_offset / 60, 2);
+    o[3] = ':';
+    write_digits(o + 4, abs_offset % 60, 2);
+    cache.size += 6;
+  }
+  cache.buf[cache.size] = '\0';
+  cache.second = second;
+  cache.is_valid = true;
+  return true;
+}
+
+/**
+ * @returns The string representation of `tp` according to `layout`, or empty
+ * string_view on error.
+ *
+ * @remarks The result refers to the thread-local buffer which is valid until
+ * the next call in the same thread. The calendar conversion is performed only
+ * when the second of `tp` differs from the second of the previous call.
  */
 template<class Clock, class Duration>
-std::string_view
-to_string_view(const std::chrono::time_point<Clock, Duration> tp) noexcept
+std::string_view format_time(const std::chrono::time_point<Clock, Duration> tp,
+  const Time_layout layout) noexcept
 {
   namespace chrono = std::chrono;
-  const auto tp_time_t = Clock::to_time_t(tp);
+  static thread_local Time_format_cache caches[3];
+  auto& cache = caches[static_cast<int>(layout)];
   const auto tse = tp.time_since_epoch();
-  const auto sec = chrono::duration_cast<chrono::seconds>(tse);
+  const auto sec = chrono::floor<chrono::seconds>(tse);
   const auto us = chrono::duration_cast<chrono::microseconds>(tse - sec);
-  static thread_local char buf[64];
-  if (const auto dt_length = std::strftime(buf,
-      sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&tp_time_t))) {
-    const auto max_rest_length = sizeof(buf) - dt_length;
-    const auto rest_length = std::snprintf(buf + dt_length,
-      max_rest_length, "%c%ld", '.', us.count());
-    DMITIGR_ASSERT(rest_length > 0 &&
-      static_cast<std::size_t>(rest_length) < max_rest_length);
-    return {buf, dt_length + rest_length};
+  const auto second = Clock::to_time_t(tp - (tse - sec));
+  if (!cache.is_valid || cache.second != second) {
+    if (!format_second(cache, second, layout)) {
+      cache.is_valid = false;
+      return {};
+    }
   }
-  buf[0] = '\0';
-  return {buf, 0};
+  write_digits(cache.buf + cache.fraction_pos,
+    static_cast<unsigned long>(us.count()), 6);
+  return {cache.buf, cache.size};
+}
+
+} // namespace detail
+
+/**
+ * @returns The human-readable string representation of the given timepoint
+ * in the local time with microseconds (`YYYY-MM-DD HH:MM:SS.ffffff`), or
+ * empty string_view on error.
+ *
+ * @remarks The result refers to the thread-local buffer which is valid until
+ * the next call in the same thread.
+ */
+template<class Clock, class Duration>
+std::string_view
+to_string_view(const std::chrono::time_point<Clock, Duration> tp) noexcept
+{
+  return detail::format_time(tp, detail::Time_layout::human);
+}
+
+/**
+ * @returns The RFC 3339 (ISO 8601) string representation of the given
+ * timepoint with microseconds, either in UTC (`YYYY-MM-DDTHH:MM:SS.ffffffZ`)
+ * or in the local time (`YYYY-MM-DDTHH:MM:SS.ffffff+HH:MM`), or empty
+ * string_view on error.
+ *
+ * @remarks The result is suitable for the text representation of PostgreSQL
+ * `timestamptz`, and refers to the thread-local buffer which is valid until
+ * the next call in the same thread.
+ */
+template<class Clock, class Duration>
+std::string_view
+to_rfc3339_string_view(const std::chrono::time_point<Clock, Duration> tp,
+  const bool is_utc = true) noexcept
+{
+  return detail::format_time(tp, is_utc ? detail::Time_layout::rfc3339_utc :
+    detail::Time_layout::rfc3339_local);
 }
 
 /// @retruns `to_string_view(Clock::now())`.
@@ -20,9 +20,12 @@
 #include "../base/assert.hpp"
 #include "basics.hpp"
 #include "predicate.hpp"
+#include "simd.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -83,45 +86,164 @@ inline void eliminate_duplicates(std::string& str)
   str.resize(new_size);
 }
 
-/// Trims `str` by dropping whitespaces at both sides of it.
-inline std::string trimmed(std::string str, const Trim trim = Trim::all)
+/**
+ * @returns The view of `str` without whitespaces at the side(s) specified
+ * by `trim`.
+ */
+inline std::string_view trimmed_view(const std::string_view str,
+  const Trim trim = Trim::all) noexcept
 {
-  if (str.empty())
-    return str;
-
-  const auto b = begin(str);
-  const auto e = end(str);
+  const auto b = cbegin(str);
+  const auto e = cend(str);
   const auto tb = static_cast<bool>(trim & Trim::lhs) ?
-    find_if(b, e, is_non_space<char>) : b;
-  if (tb == e) {
-    str.clear(); // the string consists of spaces, so just clear it out
-    return str;
-  }
+    std::find_if(b, e, is_non_space<char>) : b;
+  if (tb == e)
+    return {};
   const auto te = static_cast<bool>(trim & Trim::rhs) ?
-    find_if(rbegin(str), rend(str), is_non_space<char>).base() : e;
+    std::find_if(crbegin(str), crend(str), is_non_space<char>).base() : e;
+  return str.substr(static_cast<std::size_t>(tb - b),
+    static_cast<std::size_t>(te - tb));
+}
 
-  const std::string::size_type new_size = te - tb;
-  if (new_size != str.size()) {
-    if (tb != b)
-      move(tb, te, b);
-    str.resize(new_size);
+/// Trims `str` in place by dropping whitespaces at the side(s) specified by `trim`.
+inline void trim(std::string& str, const Trim trim = Trim::all)
+{
+  const auto view = trimmed_view(str, trim);
+  if (view.size() != str.size()) {
+    const auto offset = static_cast<std::size_t>(view.data() - str.data());
+    const auto size = view.size();
+    if (offset)
+      str.erase(0, offset);
+    str.resize(size);
   }
+}
 
+/// Trims `str` by dropping whitespaces at both sides of it.
+inline std::string trimmed(std::string str, const Trim trim = Trim::all)
+{
+  str::trim(str, trim);
   return str;
 }
 
+namespace detail {
+
+/**
+ * @brief Converts the case of ASCII letters of `size` characters of `str`.
+ *
+ * @details The blocks of ASCII characters are converted by using the SIMD
+ * instructions (SSE2 or NEON) if available, the rest of the characters are
+ * converted by `convert`.
+ */
+template<bool IsUpper, typename F>
+void convert_case(char* str, std::size_t size, const F& convert) noexcept
+{
+  const auto convert_scalar = [&convert](char* s, const std::size_t n) noexcept
+  {
+    for (const char* const e{s + n}; s != e; ++s)
+      *s = static_cast<char>(convert(static_cast<unsigned char>(*s)));
+  };
+#if defined(DMITIGR_STR_SSE2)
+  const auto first = _mm_set1_epi8(IsUpper ? 'a' - 1 : 'A' - 1);
+  const auto last = _mm_set1_epi8(IsUpper ? 'z' + 1 : 'Z' + 1);
+  const auto delta = _mm_set1_epi8(0x20);
+  for (; size >= 16; size -= 16, str += 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+    if (_mm_movemask_epi8(v)) {
+      convert_scalar(str, 16);
+      continue;
+    }
+    const auto is_letter = _mm_and_si128(_mm_cmpgt_epi8(v, first),
+      _mm_cmplt_epi8(v, last));
+    const auto d = _mm_and_si128(is_letter, delta);
+    v = IsUpper ? _mm_sub_epi8(v, d) : _mm_add_epi8(v, d);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(str), v);
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto first = vdupq_n_u8(IsUpper ? 'a' : 'A');
+  const auto last = vdupq_n_u8(IsUpper ? 'z' : 'Z');
+  const auto delta = vdupq_n_u8(0x20);
+  for (; size >= 16; size -= 16, str += 16) {
+    auto* const s = reinterpret_cast<std::uint8_t*>(str);
+    auto v = vld1q_u8(s);
+    if (vmaxvq_u8(v) & 0x80) {
+      convert_scalar(str, 16);
+      continue;
+    }
+    const auto is_letter = vandq_u8(vcgeq_u8(v, first), vcleq_u8(v, last));
+    const auto d = vandq_u8(is_letter, delta);
+    v = IsUpper ? vsubq_u8(v, d) : vaddq_u8(v, d);
+    vst1q_u8(s, v);
+  }
+#endif
+  convert_scalar(str, size);
+}
+
+/**
+ * @returns `true` if all of `size` characters of `str` are the letters of
+ * the case according to `IsUpper`.
+ *
+ * @details The blocks of ASCII characters are checked by using the SIMD
+ * instructions (SSE2 or NEON) if available, the rest of the characters are
+ * checked by `pred`.
+ */
+template<bool IsUpper, typename F>
+bool is_case(const char* str, std::size_t size, const F& pred) noexcept
+{
+  const auto is_case_scalar = [&pred](const char* s, const std::size_t n) noexcept
+  {
+    return std::all_of(s, s + n, [&pred](const unsigned char c)
+    {
+      return pred(c);
+    });
+  };
+#if defined(DMITIGR_STR_SSE2)
+  const auto first = _mm_set1_epi8(IsUpper ? 'A' - 1 : 'a' - 1);
+  const auto last = _mm_set1_epi8(IsUpper ? 'Z' + 1 : 'z' + 1);
+  for (; size >= 16; size -= 16, str += 16) {
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str));
+    if (_mm_movemask_epi8(v)) {
+      if (!is_case_scalar(str, 16))
+        return false;
+      continue;
+    }
+    const auto is_letter = _mm_and_si128(_mm_cmpgt_epi8(v, first),
+      _mm_cmplt_epi8(v, last));
+    if (_mm_movemask_epi8(is_letter) != 0xffff)
+      return false;
+  }
+#elif defined(DMITIGR_STR_NEON)
+  const auto first = vdupq_n_u8(IsUpper ? 'A' : 'a');
+  const auto last = vdupq_n_u8(IsUpper ? 'Z' : 'z');
+  for (; size >= 16; size -= 16, str += 16) {
+    const auto v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(str));
+    if (vmaxvq_u8(v) & 0x80) {
+      if (!is_case_scalar(str, 16))
+        return false;
+      continue;
+    }
+    if (vminvq_u8(vandq_u8(vcgeq_u8(v, first), vcleq_u8(v, last))) != 0xff)
+      return false;
+  }
+#endif
+  return is_case_scalar(str, size);
+}
+
+} // namespace detail
+
 // -----------------------------------------------------------------------------
 // lowercase
 
 /**
  * @brief Replaces all of uppercase characters in `str` by the corresponding
  * lowercase characters.
+ *
+ * @remarks The ASCII characters are processed by SIMD instructions if
+ * available, the other ones are processed according to the current locale.
  */
 inline void lowercase(std::string& str)
 {
-  auto b = begin(str);
-  auto e = end(str);
-  transform(b, e, b, [](const unsigned char c){return tolower(c);});
+  detail::convert_case<false>(str.data(), str.size(),
+    [](const unsigned char c){return tolower(c);});
 }
 
 /**
@@ -137,10 +259,8 @@ inline std::string to_lowercase(std::string result)
 /// @returns `true` if all of characters of `str` are in uppercase.
 inline bool is_lowercased(const std::string_view str) noexcept
 {
-  return std::all_of(cbegin(str), cend(str), [](const unsigned char c)
-  {
-    return islower(c);
-  });
+  return detail::is_case<false>(str.data(), str.size(),
+    [](const unsigned char c){return islower(c);});
 }
 
 // -----------------------------------------------------------------------------
@@ -149,12 +269,14 @@ inline bool is_lowercased(const std::string_view str) noexcept
 /**
  * @brief Replaces all of lowercase characters in `str` by the corresponding
  * uppercase characters.
+ *
+ * @remarks The ASCII characters are processed by SIMD instructions if
+ * available, the other ones are processed according to the current locale.
  */
 inline void uppercase(std::string& str)
 {
-  auto b = begin(str);
-  auto e = end(str);
-  transform(b, e, b, [](const unsigned char c){return toupper(c);});
+  detail::convert_case<true>(str.data(), str.size(),
+    [](const unsigned char c){return toupper(c);});
 }
 
 /**
@@ -170,10 +292,8 @@ inline std::string to_uppercase(std::string result)
 /// @returns `true` if all of character of `str` are in lowercase.
 inline bool is_uppercased(const std::string_view str) noexcept
 {
-  return std::all_of(cbegin(str), cend(str), [](const unsigned char c)
-  {
-    return isupper(c);
-  });
+  return detail::is_case<true>(str.data(), str.size(),
+    [](const unsigned char c){return isupper(c);});
 }
 
 } // namespace dmitigr::str
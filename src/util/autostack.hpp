@@ -17,13 +17,18 @@
 #ifndef DMITIGR_UTIL_AUTOSTACK_HPP
 #define DMITIGR_UTIL_AUTOSTACK_HPP
 
-#include <deque>
+#include "small_vector.hpp"
+
 #include <utility>
 
 namespace dmitigr::util {
 
-/// An autostack.
-template<typename T, class Container = std::deque<T>>
+/**
+ * @brief An autostack.
+ *
+ * @details By default, up to 8 elements are stored without allocation.
+ */
+template<typename T, class Container = Small_vector<T, 8>>
 struct Autostack final {
   /// An autostack guard.
   struct Guard final {
@@ -69,7 +74,7 @@ struct Autostack final {
   }
 
   /// The constructor.
-  Autostack(Container stack)
+  Autostack(Container stack = {})
     : stack_{std::move(stack)}
   {}
 
@@ -89,7 +94,7 @@ struct Autostack final {
   {
     Container result;
     stack_.swap(result);
-    return std::move(result);
+    return result;
   }
 
 private:
@@ -17,7 +17,26 @@
 #ifndef DMITIGR_UTIL_DIAGNOSTIC_HPP
 #define DMITIGR_UTIL_DIAGNOSTIC_HPP
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DMITIGR_UTIL_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define DMITIGR_UTIL_TSC
+#endif
 
 namespace dmitigr::util {
 
@@ -44,6 +63,236 @@ auto with_measure(const F& f)
   return chrono::duration_cast<D>(end - start);
 }
 
+// -----------------------------------------------------------------------------
+// Benchmark
+// -----------------------------------------------------------------------------
+
+/// @returns `true` if the cycle counter is available.
+constexpr bool is_cycle_counter_available() noexcept
+{
+#ifdef DMITIGR_UTIL_TSC
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @returns The value of the time stamp counter of the processor, or `0` if
+ * the counter is unavailable.
+ *
+ * @see is_cycle_counter_available().
+ */
+inline std::uint64_t cycle_count() noexcept
+{
+#ifdef DMITIGR_UTIL_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/// A result of a benchmark.
+struct Benchmark_result final {
+  /// The name of the benchmark.
+  std::string name;
+
+  /// The number of measured iterations.
+  std::size_t iteration_count{};
+
+  /// The minimum duration of the iteration.
+  std::chrono::nanoseconds min{};
+
+  /// The mean duration of the iteration.
+  std::chrono::nanoseconds mean{};
+
+  /// The median duration of the iteration.
+  std::chrono::nanoseconds p50{};
+
+  /// The 99th percentile of the duration of the iteration.
+  std::chrono::nanoseconds p99{};
+
+  /// The 99.9th percentile of the duration of the iteration.
+  std::chrono::nanoseconds p999{};
+
+  /// The maximum duration of the iteration.
+  std::chrono::nanoseconds max{};
+
+  /// The mean number of processor cycles per iteration, if available.
+  std::optional<double> cycles;
+
+  /// The mean number of allocations per iteration, if counted.
+  std::optional<double> allocations;
+
+  /// @returns The number of iterations per second according to `mean`.
+  double throughput() const noexcept
+  {
+    return mean.count() ? 1e9 / static_cast<double>(mean.count()) : 0;
+  }
+};
+
+/// Prints the `result` as a single line of the report.
+inline std::ostream& operator<<(std::ostream& os, const Benchmark_result& result)
+{
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << result.name << ": n=" << result.iteration_count
+     << " min=" << result.min.count()
+     << "ns mean=" << result.mean.count()
+     << "ns p50=" << result.p50.count()
+     << "ns p99=" << result.p99.count()
+     << "ns p999=" << result.p999.count()
+     << "ns max=" << result.max.count() << "ns"
+     << std::fixed << std::setprecision(1);
+  if (result.cycles)
+    os << " cycles=" << *result.cycles;
+  if (result.allocations)
+    os << " allocs=" << *result.allocations;
+  os.flags(flags);
+  os.precision(precision);
+  return os;
+}
+
+/**
+ * @brief A micro-benchmark.
+ *
+ * @details The benchmarked function is called `warmup_count()` times without
+ * measuring, then `iteration_count()` samples are measured. Each sample
+ * consists of `batch_size()` calls, so very short operations could be
+ * measured with the acceptable overhead of the clock.
+ */
+class Benchmark final {
+public:
+  /// The function which returns the total number of allocations performed.
+  using Allocation_counter = std::function<std::uint64_t()>;
+
+  /// The constructor.
+  explicit Benchmark(std::string name)
+    : name_{std::move(name)}
+  {}
+
+  /// @returns The name of the benchmark.
+  const std::string& name() const noexcept
+  {
+    return name_;
+  }
+
+  /// Sets the number of calls before the measuring.
+  Benchmark& set_warmup_count(const std::size_t value) noexcept
+  {
+    warmup_count_ = value;
+    return *this;
+  }
+
+  /// @returns The number of calls before the measuring.
+  std::size_t warmup_count() const noexcept
+  {
+    return warmup_count_;
+  }
+
+  /// Sets the number of measured samples.
+  Benchmark& set_iteration_count(const std::size_t value) noexcept
+  {
+    iteration_count_ = std::max<std::size_t>(value, 1);
+    return *this;
+  }
+
+  /// @returns The number of measured samples.
+  std::size_t iteration_count() const noexcept
+  {
+    return iteration_count_;
+  }
+
+  /// Sets the number of calls per sample.
+  Benchmark& set_batch_size(const std::size_t value) noexcept
+  {
+    batch_size_ = std::max<std::size_t>(value, 1);
+    return *this;
+  }
+
+  /// @returns The number of calls per sample.
+  std::size_t batch_size() const noexcept
+  {
+    return batch_size_;
+  }
+
+  /**
+   * @brief Sets the allocation counter. (For example, the function which
+   * returns the value of counter incremented by the replaced `operator new`.)
+   */
+  Benchmark& set_allocation_counter(Allocation_counter value)
+  {
+    allocation_counter_ = std::move(value);
+    return *this;
+  }
+
+  /// @returns The allocation counter.
+  const Allocation_counter& allocation_counter() const noexcept
+  {
+    return allocation_counter_;
+  }
+
+  /// @returns The result of benchmarking of `f`.
+  template<typename F>
+  Benchmark_result run(F&& f) const
+  {
+    namespace chrono = std::chrono;
+    using Clock = chrono::steady_clock;
+
+    for (std::size_t i{}; i < warmup_count_; ++i)
+      f();
+
+    std::vector<chrono::nanoseconds> samples(iteration_count_);
+    const auto allocations_before = allocation_counter_ ?
+      allocation_counter_() : 0;
+    const auto cycles_before = cycle_count();
+    for (auto& sample : samples) {
+      const auto start = Clock::now();
+      for (std::size_t i{}; i < batch_size_; ++i)
+        f();
+      sample = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start)
+        / batch_size_;
+    }
+    const auto cycles_after = cycle_count();
+    const auto allocations_after = allocation_counter_ ?
+      allocation_counter_() : 0;
+
+    const auto call_count = static_cast<double>(iteration_count_ * batch_size_);
+    Benchmark_result result;
+    result.name = name_;
+    result.iteration_count = iteration_count_;
+    chrono::nanoseconds total{};
+    for (const auto sample : samples)
+      total += sample;
+    result.mean = total / iteration_count_;
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](const double p)
+    {
+      const auto i = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+      return samples[i];
+    };
+    result.min = samples.front();
+    result.p50 = percentile(.5);
+    result.p99 = percentile(.99);
+    result.p999 = percentile(.999);
+    result.max = samples.back();
+    if (is_cycle_counter_available())
+      result.cycles = static_cast<double>(cycles_after - cycles_before) /
+        call_count;
+    if (allocation_counter_)
+      result.allocations =
+        static_cast<double>(allocations_after - allocations_before) / call_count;
+    return result;
+  }
+
+private:
+  std::string name_;
+  std::size_t warmup_count_{};
+  std::size_t iteration_count_{1};
+  std::size_t batch_size_{1};
+  Allocation_counter allocation_counter_;
+};
+
 } // namespace dmitigr::util
 
 #endif  // DMITIGR_UTIL_DIAGNOSTIC_HPP
@@ -0,0 +1,211 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_UTIL_RING_BUFFER_HPP
+#define DMITIGR_UTIL_RING_BUFFER_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::util {
+
+/**
+ * @brief A FIFO queue backed by a ring of reusable slots.
+ *
+ * @details The capacity is always a power of two and is doubled when the
+ * buffer is full, so the steady state doesn't allocate. The popped slots
+ * are reset by assigning `T{}` to them, so the resources owned by the
+ * elements are released immediately.
+ *
+ * @tparam T The type of elements. Must be default-constructible and
+ * move-assignable.
+ */
+template<typename T>
+class Ring_buffer final {
+public:
+  /// Constructs the empty buffer without allocation.
+  Ring_buffer() = default;
+
+  /// Constructs the empty buffer with at least `capacity` slots.
+  explicit Ring_buffer(const std::size_t capacity)
+  {
+    reserve(capacity);
+  }
+
+  /// @returns `true` if the buffer is empty.
+  bool empty() const noexcept
+  {
+    return !size_;
+  }
+
+  /// @returns The number of elements.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns The number of slots.
+  std::size_t capacity() const noexcept
+  {
+    return slots_.size();
+  }
+
+  /**
+   * @returns The first element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  T& front() noexcept
+  {
+    assert(!empty());
+    return slots_[head_];
+  }
+
+  /// @overload
+  const T& front() const noexcept
+  {
+    assert(!empty());
+    return slots_[head_];
+  }
+
+  /**
+   * @returns The last element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  T& back() noexcept
+  {
+    assert(!empty());
+    return slots_[index(size_ - 1)];
+  }
+
+  /// @overload
+  const T& back() const noexcept
+  {
+    assert(!empty());
+    return slots_[index(size_ - 1)];
+  }
+
+  /**
+   * @brief Appends the element constructed from `args` to the end.
+   *
+   * @returns The appended element.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  template<typename ... Types>
+  T& emplace(Types&& ... args)
+  {
+    T element{std::forward<Types>(args)...};
+    if (size_ == capacity())
+      reserve(capacity() ? capacity() * 2 : 4);
+    auto& result = slots_[index(size_)];
+    result = std::move(element);
+    ++size_;
+    return result;
+  }
+
+  /**
+   * @brief Removes the first element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  void pop() noexcept
+  {
+    assert(!empty());
+    slots_[head_] = T{};
+    head_ = index(1);
+    --size_;
+  }
+
+  /**
+   * @brief Removes the last element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  void pop_back() noexcept
+  {
+    assert(!empty());
+    slots_[index(size_ - 1)] = T{};
+    --size_;
+  }
+
+  /// Removes all the elements but keeps the slots.
+  void clear() noexcept
+  {
+    while (!empty())
+      pop();
+    head_ = 0;
+  }
+
+  /**
+   * @brief Ensures that the capacity is at least `capacity`.
+   *
+   * @par Exception safety guarantee
+   * Strong.
+   */
+  void reserve(const std::size_t capacity)
+  {
+    if (capacity <= this->capacity())
+      return;
+
+    std::size_t new_capacity{1};
+    while (new_capacity < capacity)
+      new_capacity *= 2;
+    std::vector<T> slots(new_capacity); // can throw
+    for (std::size_t i{}; i < size_; ++i)
+      slots[i] = std::move(slots_[index(i)]);
+    slots_.swap(slots);
+    head_ = 0;
+  }
+
+  /// Swaps this instance with `rhs`.
+  void swap(Ring_buffer& rhs) noexcept
+  {
+    using std::swap;
+    swap(slots_, rhs.slots_);
+    swap(head_, rhs.head_);
+    swap(size_, rhs.size_);
+  }
+
+private:
+  std::vector<T> slots_;
+  std::size_t head_{};
+  std::size_t size_{};
+
+  std::size_t index(const std::size_t offset) const noexcept
+  {
+    return (head_ + offset) & (slots_.size() - 1);
+  }
+};
+
+/// Ring_buffer is swappable.
+template<typename T>
+inline void swap(Ring_buffer<T>& lhs, Ring_buffer<T>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace dmitigr::util
+
+#endif  // DMITIGR_UTIL_RING_BUFFER_HPP
@@ -0,0 +1,318 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_UTIL_SMALL_VECTOR_HPP
+#define DMITIGR_UTIL_SMALL_VECTOR_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dmitigr::util {
+
+/**
+ * @brief A sequence container which stores up to `N` elements inline.
+ *
+ * @details The elements are stored in the storage of the instance itself
+ * until their number exceeds `N`, after that they are moved to the heap
+ * and the capacity grows geometrically.
+ *
+ * @tparam T The type of elements. Must be move-constructible.
+ * @tparam N The inline capacity.
+ */
+template<typename T, std::size_t N>
+class Small_vector final {
+  static_assert(N > 0);
+public:
+  /// The value type.
+  using value_type = T;
+
+  /// The size type.
+  using size_type = std::size_t;
+
+  /// The reference type.
+  using reference = T&;
+
+  /// The constant reference type.
+  using const_reference = const T&;
+
+  /// The iterator type.
+  using iterator = T*;
+
+  /// The constant iterator type.
+  using const_iterator = const T*;
+
+  /// Destroys the elements and releases the memory.
+  ~Small_vector()
+  {
+    clear();
+    deallocate();
+  }
+
+  /// Constructs the empty container without allocation.
+  Small_vector() noexcept = default;
+
+  /// Copy-constructible.
+  Small_vector(const Small_vector& rhs)
+  {
+    reserve(rhs.size_);
+    for (const auto& element : rhs)
+      emplace_back(element);
+  }
+
+  /// Copy-assignable.
+  Small_vector& operator=(const Small_vector& rhs)
+  {
+    if (this != &rhs) {
+      Small_vector tmp{rhs};
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  /// Move-constructible.
+  Small_vector(Small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    take(std::move(rhs));
+  }
+
+  /// Move-assignable.
+  Small_vector& operator=(Small_vector&& rhs)
+    noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    if (this != &rhs) {
+      clear();
+      deallocate();
+      take(std::move(rhs));
+    }
+    return *this;
+  }
+
+  /// Swaps this instance with `rhs`.
+  void swap(Small_vector& rhs)
+  {
+    Small_vector tmp{std::move(rhs)};
+    rhs = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  /// @returns `true` if the container is empty.
+  bool empty() const noexcept
+  {
+    return !size_;
+  }
+
+  /// @returns The number of elements.
+  size_type size() const noexcept
+  {
+    return size_;
+  }
+
+  /// @returns The number of elements which can be stored without allocation.
+  size_type capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /// @returns `true` if the elements are stored inline.
+  bool is_inline() const noexcept
+  {
+    return data_ == inline_data();
+  }
+
+  /// Ensures that `capacity() >= capacity`.
+  void reserve(const size_type capacity)
+  {
+    if (capacity <= capacity_)
+      return;
+
+    std::allocator<T> alloc;
+    T* const data{alloc.allocate(capacity)};
+    size_type i{};
+    try {
+      for (; i < size_; ++i)
+        ::new (static_cast<void*>(data + i)) T(std::move_if_noexcept(data_[i]));
+    } catch (...) {
+      std::destroy_n(data, i);
+      alloc.deallocate(data, capacity);
+      throw;
+    }
+    std::destroy_n(data_, size_);
+    deallocate();
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  /**
+   * @brief Constructs the element at the end.
+   *
+   * @returns The reference to the constructed element.
+   */
+  template<typename ... Types>
+  reference emplace_back(Types&& ... args)
+  {
+    if (size_ == capacity_) {
+      // The arguments can refer to the elements, so construct it first.
+      T element(std::forward<Types>(args)...);
+      reserve(capacity_ * 2);
+      return emplace_back(std::move(element));
+    }
+    auto* const result = ::new (static_cast<void*>(data_ + size_))
+      T(std::forward<Types>(args)...);
+    ++size_;
+    return *result;
+  }
+
+  /// Appends `value` to the end.
+  void push_back(const T& value)
+  {
+    emplace_back(value);
+  }
+
+  /// @overload
+  void push_back(T&& value)
+  {
+    emplace_back(std::move(value));
+  }
+
+  /**
+   * @brief Removes the last element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  void pop_back() noexcept
+  {
+    assert(!empty());
+    --size_;
+    std::destroy_at(data_ + size_);
+  }
+
+  /// Removes all of the elements. The capacity remains unchanged.
+  void clear() noexcept
+  {
+    std::destroy_n(data_, size_);
+    size_ = 0;
+  }
+
+  /**
+   * @returns The last element.
+   *
+   * @par Requires
+   * `!empty()`.
+   */
+  reference back() noexcept
+  {
+    assert(!empty());
+    return data_[size_ - 1];
+  }
+
+  /// @overload
+  const_reference back() const noexcept
+  {
+    assert(!empty());
+    return data_[size_ - 1];
+  }
+
+  /**
+   * @returns The element at index `i`.
+   *
+   * @par Requires
+   * `i < size()`.
+   */
+  reference operator[](const size_type i) noexcept
+  {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  /// @overload
+  const_reference operator[](const size_type i) const noexcept
+  {
+    assert(i < size_);
+    return data_[i];
+  }
+
+  /// @returns The iterator to the first element.
+  iterator begin() noexcept
+  {
+    return data_;
+  }
+
+  /// @overload
+  const_iterator begin() const noexcept
+  {
+    return data_;
+  }
+
+  /// @returns The iterator past the last element.
+  iterator end() noexcept
+  {
+    return data_ + size_;
+  }
+
+  /// @overload
+  const_iterator end() const noexcept
+  {
+    return data_ + size_;
+  }
+
+private:
+  alignas(T) unsigned char inline_[sizeof(T) * N];
+  T* data_{inline_data()};
+  size_type size_{};
+  size_type capacity_{N};
+
+  T* inline_data() noexcept
+  {
+    return reinterpret_cast<T*>(inline_);
+  }
+
+  const T* inline_data() const noexcept
+  {
+    return reinterpret_cast<const T*>(inline_);
+  }
+
+  void deallocate() noexcept
+  {
+    if (!is_inline()) {
+      std::allocator<T>{}.deallocate(data_, capacity_);
+      data_ = inline_data();
+      capacity_ = N;
+    }
+  }
+
+  /// Takes the elements of `rhs`. Requires: `empty() && is_inline()`.
+  void take(Small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+  {
+    if (rhs.is_inline()) {
+      for (auto& element : rhs)
+        emplace_back(std::move(element));
+      rhs.clear();
+    } else {
+      data_ = std::exchange(rhs.data_, rhs.inline_data());
+      size_ = std::exchange(rhs.size_, 0);
+      capacity_ = std::exchange(rhs.capacity_, N);
+    }
+  }
+};
+
+} // namespace dmitigr::util
+
+#endif  // DMITIGR_UTIL_SMALL_VECTOR_HPP
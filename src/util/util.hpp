@@ -21,5 +21,7 @@
 #include "contract.hpp"
 #include "diagnostic.hpp"
 #include "memory.hpp"
+#include "ring_buffer.hpp"
+#include "small_vector.hpp"
 
 #endif  // DMITIGR_UTIL_UTIL_HPP
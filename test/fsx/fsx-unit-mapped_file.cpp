@@ -0,0 +1,107 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/fsx/mapped_file.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main()
+{
+  try {
+    namespace fsx = dmitigr::fsx;
+    using fsx::Mapped_file;
+    using fsx::Mapped_file_advice;
+    using fsx::Mapped_file_mode;
+
+    const auto path = std::filesystem::temp_directory_path() /
+      "dmitigr_fsx_unit_mapped_file.txt";
+    {
+      std::ofstream out{path, std::ios_base::binary};
+      out << "dmitigr";
+    }
+
+    // Default constructed.
+    {
+      Mapped_file file;
+      DMITIGR_ASSERT(file.is_empty());
+      DMITIGR_ASSERT(!file.data());
+      DMITIGR_ASSERT(!file.advise(Mapped_file_advice::sequential));
+      file.flush();
+    }
+
+    // Read-only.
+    {
+      Mapped_file file{path};
+      DMITIGR_ASSERT(file.mode() == Mapped_file_mode::read_only);
+      DMITIGR_ASSERT(file.size() == 7);
+      DMITIGR_ASSERT(file.view() == "dmitigr");
+#ifndef _WIN32
+      DMITIGR_ASSERT(file.advise(Mapped_file_advice::sequential));
+      DMITIGR_ASSERT(file.advise(Mapped_file_advice::willneed));
+#endif
+
+      // Move.
+      Mapped_file file2{std::move(file)};
+      DMITIGR_ASSERT(file.is_empty());
+      DMITIGR_ASSERT(file2.view() == "dmitigr");
+      file = std::move(file2);
+      DMITIGR_ASSERT(file2.is_empty());
+      DMITIGR_ASSERT(file.view() == "dmitigr");
+      file.close();
+      DMITIGR_ASSERT(file.is_empty());
+    }
+
+    // Read-write.
+    {
+      Mapped_file file{path, Mapped_file_mode::read_write, true};
+      DMITIGR_ASSERT(file.mode() == Mapped_file_mode::read_write);
+      file.data()[0] = 'D';
+      file.flush();
+    }
+    {
+      std::ifstream in{path, std::ios_base::binary};
+      std::string content;
+      DMITIGR_ASSERT(std::getline(in, content));
+      DMITIGR_ASSERT(content == "Dmitigr");
+    }
+
+    // Empty file.
+    {
+      std::ofstream{path, std::ios_base::binary | std::ios_base::trunc};
+      const Mapped_file file{path};
+      DMITIGR_ASSERT(file.is_empty());
+      DMITIGR_ASSERT(file.view().empty());
+    }
+
+    // Nonexistent file.
+    std::filesystem::remove(path);
+    try {
+      const Mapped_file file{path};
+      DMITIGR_ASSERT(false);
+    } catch (const std::filesystem::filesystem_error& e) {
+      DMITIGR_ASSERT(e.path1() == path);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
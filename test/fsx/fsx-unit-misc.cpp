@@ -0,0 +1,71 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/fsx/misc.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main()
+{
+  try {
+    namespace fs = std::filesystem;
+    namespace fsx = dmitigr::fsx;
+
+    const auto root = fs::temp_directory_path() / "dmitigr_fsx_unit_misc";
+    fs::remove_all(root);
+    const auto touch = [](const fs::path& path)
+    {
+      std::ofstream{path};
+    };
+    for (int i{}; i < 8; ++i) {
+      const auto dir = root / std::to_string(i) / "sub";
+      fs::create_directories(dir);
+      touch(dir / "a.sql");
+      touch(dir / "b.txt");
+      touch(dir.parent_path() / "c.sql");
+    }
+    touch(root / "d.sql");
+    touch(root.parent_path() / "dmitigr_fsx_unit_misc.sql");
+
+    // file_paths_by_extension_parallel
+    {
+      auto expected = fsx::file_paths_by_extension(root, ".sql", true, true);
+      DMITIGR_ASSERT(expected.size() == 18);
+      std::sort(expected.begin(), expected.end());
+      for (const std::size_t thread_count : {0, 1, 3}) {
+        const auto paths = fsx::file_paths_by_extension_parallel(root, ".sql",
+          true, thread_count);
+        DMITIGR_ASSERT(paths == expected);
+      }
+      const auto paths = fsx::file_paths_by_extension_parallel(root, ".txt");
+      DMITIGR_ASSERT(paths.size() == 8);
+      DMITIGR_ASSERT(std::is_sorted(paths.begin(), paths.end()));
+    }
+
+    fs::remove_all(root);
+    fs::remove(root.parent_path() / "dmitigr_fsx_unit_misc.sql");
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,107 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/net/net.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace net = dmitigr::net;
+  using std::chrono::milliseconds;
+
+  const auto ring = std::make_shared<net::Io_uring>(64);
+  ASSERT(ring->native_handle() >= 0);
+
+  // Descriptors.
+  {
+    int sv[2];
+    ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    net::Uring_descriptor d0{ring, net::Socket_guard{sv[0]}};
+    net::Uring_descriptor d1{ring, net::Socket_guard{sv[1]}};
+    ASSERT(d0.write("hello", 5) == 5);
+    char buf[16];
+    ASSERT(d1.read(buf, sizeof(buf)) == 5);
+    ASSERT(std::string(buf, 5) == "hello");
+
+    // Linked sends.
+    const net::Const_buffer out[]{{"head", 4}, {"body", 4}};
+    ASSERT(d0.writev(out, 2) == 8);
+    std::string in;
+    while (in.size() < 8) {
+      const auto n = d1.read(buf, sizeof(buf));
+      ASSERT(n > 0);
+      in.append(buf, static_cast<std::size_t>(n));
+    }
+    ASSERT(in == "headbody");
+
+    // Registered buffers.
+    char fixed[8];
+    const net::Mutable_buffer bufs[]{{fixed, sizeof(fixed)}};
+    ring->register_buffers(bufs, 1);
+    fixed[0] = 'x';
+    ASSERT(d0.write_fixed(fixed, 1, 0) == 1);
+    ASSERT(d1.read(buf, sizeof(buf)) == 1 && buf[0] == 'x');
+    ASSERT(d0.write("y", 1) == 1);
+    ASSERT(d1.read_fixed(fixed, sizeof(fixed), 0) == 1 && fixed[0] == 'y');
+    ring->unregister_buffers();
+  }
+
+  // Listener.
+  {
+    auto options = net::Listener_options{"127.0.0.1", 50398, 64};
+    options.set_non_blocking(true);
+    net::Uring_listener listener{ring, options};
+    listener.listen();
+    ASSERT(listener.is_listening());
+    ASSERT(!listener.accept());
+    ASSERT(!listener.wait(milliseconds{1}));
+
+    std::vector<net::Socket_guard> clients;
+    for (int i{}; i < 3; ++i) {
+      clients.push_back(net::make_tcp_socket(net::Protocol_family::ipv4));
+      net::connect_socket(clients.back(),
+        {net::Ip_address::from_text("127.0.0.1"), 50398});
+    }
+    std::vector<std::unique_ptr<net::Descriptor>> accepted;
+    while (accepted.size() < clients.size()) {
+      ASSERT(listener.wait(milliseconds{1000}));
+      listener.accept_many(accepted, 16);
+    }
+    ASSERT(accepted.size() == clients.size());
+    ASSERT(!listener.accept());
+
+    ASSERT(::send(clients[0], "ping", 4, 0) == 4);
+    char buf[4];
+    ASSERT(accepted[0]->read(buf, sizeof(buf)) == 4);
+    ASSERT(std::string(buf, 4) == "ping");
+    for (auto& client : clients)
+      client.close();
+    listener.close();
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -17,6 +17,8 @@
 #include "../../src/base/assert.hpp"
 #include "../../src/net/net.hpp"
 
+#include <fstream>
+
 int main()
 {
   try {
@@ -92,6 +94,237 @@ int main()
     DMITIGR_ASSERT(f != f1);
     f1 = net::conv(f1);
     DMITIGR_ASSERT(f == f1);
+
+#ifndef _WIN32
+    // Polling.
+    {
+      using net::Socket_readiness;
+      using std::chrono::milliseconds;
+      int sv[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+      const net::Socket_guard s0{sv[0]};
+      net::Socket_guard s1{sv[1]};
+      auto r = net::poll(s0, Socket_readiness::read_ready |
+        Socket_readiness::write_ready, milliseconds::zero());
+      DMITIGR_ASSERT(r == Socket_readiness::write_ready);
+      DMITIGR_ASSERT(::write(s1, "x", 1) == 1);
+      r = net::poll(s0, Socket_readiness::read_ready, milliseconds{-1});
+      DMITIGR_ASSERT(r == Socket_readiness::read_ready);
+      char c{};
+      DMITIGR_ASSERT(::read(s0, &c, 1) == 1 && c == 'x');
+      r = net::poll(s0, Socket_readiness::read_ready, milliseconds{1});
+      DMITIGR_ASSERT(r == Socket_readiness::unready);
+      s1.close(); // hang up is reported as the readiness to read
+      r = net::poll(s0, Socket_readiness::read_ready, milliseconds{1000});
+      DMITIGR_ASSERT(r == Socket_readiness::read_ready);
+    }
+
+    // Polling of many sockets.
+    {
+      using net::Socket_readiness;
+      using std::chrono::milliseconds;
+      int sv1[2];
+      int sv2[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv1));
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv2));
+      const net::Socket_guard a0{sv1[0]}, a1{sv1[1]}, b0{sv2[0]}, b1{sv2[1]};
+      DMITIGR_ASSERT(::write(b1, "x", 1) == 1);
+
+      std::vector<net::Poll_entry> entries{
+        {a0, Socket_readiness::read_ready},
+        {b0, Socket_readiness::read_ready}};
+      DMITIGR_ASSERT(net::poll_many(entries, milliseconds{1000}) == 1);
+      DMITIGR_ASSERT(entries[0].readiness == Socket_readiness::unready);
+      DMITIGR_ASSERT(entries[1].readiness == Socket_readiness::read_ready);
+
+      net::Poller poller;
+      poller.add(a0, Socket_readiness::read_ready);
+      poller.add(b0, Socket_readiness::read_ready);
+      DMITIGR_ASSERT(poller.size() == 2);
+      DMITIGR_ASSERT(poller.contains(a0) && poller.contains(b0));
+      DMITIGR_ASSERT(poller.wait(milliseconds{1000}) == 1);
+      DMITIGR_ASSERT(poller.ready()[0].socket == b0);
+      DMITIGR_ASSERT(poller.ready()[0].readiness == Socket_readiness::read_ready);
+      poller.modify(a0, Socket_readiness::read_ready |
+        Socket_readiness::write_ready);
+      DMITIGR_ASSERT(poller.wait(milliseconds{1000}) == 2);
+      DMITIGR_ASSERT(poller.remove(b0));
+      DMITIGR_ASSERT(!poller.remove(b0));
+      DMITIGR_ASSERT(poller.wait(milliseconds{1000}) == 1);
+      DMITIGR_ASSERT(poller.ready()[0].socket == a0);
+      DMITIGR_ASSERT(poller.ready()[0].readiness == Socket_readiness::write_ready);
+      poller.modify(a0, Socket_readiness::read_ready);
+      DMITIGR_ASSERT(poller.wait(milliseconds{1}) == 0);
+    }
+
+    // Scatter/gather I/O.
+    {
+      int sv[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+      net::detail::socket_Descriptor d0{net::Socket_guard{sv[0]}};
+      net::detail::socket_Descriptor d1{net::Socket_guard{sv[1]}};
+      const net::Const_buffer out[]{{"head", 4}, {"", 0}, {"body", 4}};
+      DMITIGR_ASSERT(d0.writev(out, 3) == 8);
+      char head[2];
+      char body[8];
+      const net::Mutable_buffer in[]{{head, sizeof(head)}, {body, sizeof(body)}};
+      DMITIGR_ASSERT(d1.readv(in, 2) == 8);
+      DMITIGR_ASSERT(std::string(head, 2) == "he");
+      DMITIGR_ASSERT(std::string(body, 6) == "adbody");
+    }
+
+    // Buffered descriptor.
+    {
+      int sv[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+      net::Buffered_descriptor d0{std::make_unique<net::detail::socket_Descriptor>(
+          net::Socket_guard{sv[0]}), 16, 16};
+      net::Buffered_descriptor d1{std::make_unique<net::detail::socket_Descriptor>(
+          net::Socket_guard{sv[1]}), 16, 16};
+      DMITIGR_ASSERT(d0.read_buffer_size() == 16);
+      DMITIGR_ASSERT(d0.write_buffer_size() == 16);
+      DMITIGR_ASSERT(d0.write("one\n", 4) == 4);
+      DMITIGR_ASSERT(d0.write("two\n", 4) == 4);
+      DMITIGR_ASSERT(d0.write_buffered() == 8);
+      d0.flush();
+      DMITIGR_ASSERT(!d0.write_buffered());
+      const std::string long_line(40, 'x');
+      DMITIGR_ASSERT(d0.write(long_line.data(), 40) == 40);
+      DMITIGR_ASSERT(d0.write("\nend", 4) == 4);
+      d0.flush();
+
+      DMITIGR_ASSERT(d1.peek().substr(0, 4) == "one\n");
+      std::string line;
+      DMITIGR_ASSERT(d1.read_until(line, '\n') == 4 && line == "one\n");
+      line.clear();
+      DMITIGR_ASSERT(d1.read_until(line, '\n') == 4 && line == "two\n");
+      line.clear();
+      DMITIGR_ASSERT(d1.read_until(line, '\n', 10) == 10);
+      DMITIGR_ASSERT(d1.read_until(line, '\n') == 31);
+      DMITIGR_ASSERT(line == long_line + '\n');
+      char buf[3];
+      DMITIGR_ASSERT(d1.read(buf, sizeof(buf)) == 3);
+      DMITIGR_ASSERT(std::string(buf, 3) == "end");
+      d0.close();
+      line.clear();
+      DMITIGR_ASSERT(!d1.read_until(line, '\n'));
+      DMITIGR_ASSERT(d1.peek().empty());
+    }
+
+    // File transfer.
+    {
+      const auto path = std::filesystem::temp_directory_path() /
+        "dmitigr_net_unit_send_file";
+      std::string content;
+      for (int i{}; i < 1000; ++i)
+        content.append(std::to_string(i));
+      std::ofstream{path, std::ios_base::binary} << content;
+
+      int sv[2];
+      DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+      net::detail::socket_Descriptor d0{net::Socket_guard{sv[0]}};
+      net::Buffered_descriptor d1{std::make_unique<net::detail::socket_Descriptor>(
+          net::Socket_guard{sv[1]})};
+      const auto receive = [&d1](const std::size_t size)
+      {
+        std::string result(size, '\0');
+        for (std::size_t n{}; n < size;)
+          n += static_cast<std::size_t>(d1.read(result.data() + n,
+              static_cast<std::streamsize>(size - n)));
+        return result;
+      };
+      DMITIGR_ASSERT(net::send_file(d0, path) == content.size());
+      DMITIGR_ASSERT(receive(content.size()) == content);
+      DMITIGR_ASSERT(net::send_file(d0, path, 10, 5) == 5);
+      DMITIGR_ASSERT(receive(5) == content.substr(10, 5));
+      DMITIGR_ASSERT(net::send_file(d0, path, content.size() - 3, 100) == 3);
+      DMITIGR_ASSERT(receive(3) == content.substr(content.size() - 3));
+
+      // Non-socket descriptor.
+      struct String_descriptor final : net::Descriptor {
+        std::string data;
+        std::streamsize max_read_size() const override { return 0; }
+        std::streamsize max_write_size() const override { return 1000; }
+        std::streamsize read(char*, std::streamsize) override { return 0; }
+        std::streamsize write(const char* const buf, std::streamsize len) override
+        {
+          len = std::min(len, max_write_size());
+          data.append(buf, static_cast<std::size_t>(len));
+          return len;
+        }
+        void close() override {}
+        std::intptr_t native_handle() override { return -1; }
+      } descriptor;
+      DMITIGR_ASSERT(net::send_file(descriptor, path, 1) == content.size() - 1);
+      DMITIGR_ASSERT(descriptor.data == content.substr(1));
+      std::filesystem::remove(path);
+    }
+
+    // Non-blocking listener.
+    {
+      using std::chrono::milliseconds;
+      auto options = net::Listener_options{"127.0.0.1", 50397, 64};
+      net::Tcp_options tcp;
+      tcp.no_delay = true;
+      tcp.keepalive = true;
+      tcp.keepalive_idle = std::chrono::seconds{30};
+      tcp.receive_buffer_size = 65536;
+      tcp.fast_open = true;
+      options.set_non_blocking(true).set_reuse_port(true).set_tcp_options(tcp);
+      DMITIGR_ASSERT(options.tcp_options().no_delay);
+      DMITIGR_ASSERT(options.is_non_blocking() && options.is_reuse_port());
+      const auto listener = net::Listener::make(options);
+      listener->listen();
+      DMITIGR_ASSERT(listener->is_listening());
+      DMITIGR_ASSERT(!listener->accept());
+
+      net::Poller poller;
+      poller.add(static_cast<net::Socket_native>(listener->native_handle()),
+        net::Socket_readiness::read_ready);
+      std::vector<net::Socket_guard> clients;
+      for (int i{}; i < 3; ++i) {
+        clients.push_back(net::make_tcp_socket(net::Protocol_family::ipv4));
+        net::connect_socket(clients.back(),
+          {net::Ip_address::from_text("127.0.0.1"), 50397});
+      }
+      std::vector<std::unique_ptr<net::Descriptor>> accepted;
+      while (accepted.size() < clients.size()) {
+        DMITIGR_ASSERT(poller.wait(milliseconds{1000}) == 1);
+        listener->accept_many(accepted, 16);
+      }
+      DMITIGR_ASSERT(accepted.size() == clients.size());
+      DMITIGR_ASSERT(!listener->accept());
+
+      // TCP options.
+      const auto option = [](const std::intptr_t socket, const int level,
+        const int name)
+      {
+        int value{};
+        ::socklen_t size{sizeof(value)};
+        DMITIGR_ASSERT(!::getsockopt(static_cast<int>(socket), level, name,
+            &value, &size));
+        return value;
+      };
+      for (const auto& descriptor : accepted) {
+        const auto socket = descriptor->native_handle();
+        DMITIGR_ASSERT(option(socket, IPPROTO_TCP, TCP_NODELAY));
+        DMITIGR_ASSERT(option(socket, SOL_SOCKET, SO_KEEPALIVE));
+      }
+      {
+        net::Client_options copts{"127.0.0.1", 50397};
+        copts.set_tcp_options(tcp);
+        const auto client = net::make_tcp_connection(copts);
+        const auto socket = client->native_handle();
+        DMITIGR_ASSERT(option(socket, IPPROTO_TCP, TCP_NODELAY));
+        DMITIGR_ASSERT(option(socket, IPPROTO_TCP, TCP_KEEPIDLE) == 30);
+        DMITIGR_ASSERT(poller.wait(milliseconds{1000}) == 1);
+        DMITIGR_ASSERT(listener->accept());
+      }
+      poller.remove(static_cast<net::Socket_native>(listener->native_handle()));
+      for (auto& client : clients)
+        client.close();
+    }
+#endif
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
@@ -0,0 +1,333 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <libpq-fe.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+using dmitigr::util::Benchmark;
+using dmitigr::util::Benchmark_result;
+
+namespace {
+
+const char* const conninfo = "hostaddr=127.0.0.1 user=pgfe_test"
+  " password=pgfe_test dbname=pgfe_test connect_timeout=7";
+
+// -----------------------------------------------------------------------------
+// libpq
+// -----------------------------------------------------------------------------
+
+struct Pq_connection final {
+  PGconn* conn_{};
+
+  Pq_connection()
+    : conn_{PQconnectdb(conninfo)}
+  {
+    if (!conn_)
+      throw std::bad_alloc{};
+    else if (PQstatus(conn_) != CONNECTION_OK) {
+      const std::string message{PQerrorMessage(conn_)};
+      PQfinish(conn_);
+      throw std::runtime_error{"cannot connect to server: " + message};
+    }
+  }
+
+  ~Pq_connection()
+  {
+    PQfinish(conn_);
+  }
+
+  Pq_connection(const Pq_connection&) = delete;
+  Pq_connection& operator=(const Pq_connection&) = delete;
+
+  void check(PGresult* const res, const ExecStatusType expected) const
+  {
+    const auto status = PQresultStatus(res);
+    PQclear(res);
+    if (status != expected)
+      throw std::runtime_error{PQerrorMessage(conn_)};
+  }
+
+  void execute(const char* const query,
+    const ExecStatusType expected = PGRES_TUPLES_OK) const
+  {
+    check(PQexec(conn_, query), expected);
+  }
+
+  /// Fetches the rows in the single row mode and touches the values.
+  std::size_t fetch(const char* const query, const int result_format) const
+  {
+    if (!PQsendQueryParams(conn_, query, 0, nullptr, nullptr, nullptr, nullptr,
+        result_format))
+      throw std::runtime_error{PQerrorMessage(conn_)};
+    else if (!PQsetSingleRowMode(conn_))
+      throw std::runtime_error{"cannot switch to single row mode"};
+
+    std::size_t result{};
+    while (auto* const res = PQgetResult(conn_)) {
+      const auto status = PQresultStatus(res);
+      if (status == PGRES_SINGLE_TUPLE)
+        result += static_cast<std::size_t>(PQgetlength(res, 0, 0)) +
+          (PQgetvalue(res, 0, 0)[0] != 0);
+      PQclear(res);
+      if (status != PGRES_SINGLE_TUPLE && status != PGRES_TUPLES_OK)
+        throw std::runtime_error{PQerrorMessage(conn_)};
+    }
+    return result;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+
+void print_header(const char* const title)
+{
+  std::cout << "\n== " << title << " ==" << std::endl;
+}
+
+/// Prints the results and the overhead of pgfe relatively to libpq.
+void report(const Benchmark_result& pq, const Benchmark_result& pgfe)
+{
+  std::cout << "  " << pq << '\n' << "  " << pgfe << std::endl;
+  if (pq.mean.count()) {
+    const double overhead{(static_cast<double>(pgfe.mean.count()) /
+      static_cast<double>(pq.mean.count()) - 1) * 100};
+    std::cout << "  overhead: " << std::fixed << std::setprecision(1)
+              << overhead << "%" << std::defaultfloat << std::endl;
+  }
+}
+
+template<typename Pq, typename Pgfe>
+void compare(const std::string& name, const std::size_t iteration_count,
+  Pq&& pq, Pgfe&& pgfe)
+{
+  const auto make = [&name, iteration_count](const char* const client)
+  {
+    return Benchmark{name + " (" + client + ")"}
+      .set_warmup_count(std::max<std::size_t>(iteration_count / 10, 1))
+      .set_iteration_count(iteration_count);
+  };
+  const auto pq_result = make("pq").run(pq);
+  const auto pgfe_result = make("pgfe").run(pgfe);
+  report(pq_result, pgfe_result);
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  // The number of iterations for the latency benchmarks.
+  const std::size_t n{(argc >= 2) ? std::stoul(argv[1]) : 1000};
+
+  const Pq_connection pq;
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  // ---------------------------------------------------------------------------
+  print_header("simple query");
+  compare("select 1", n, [&]{pq.execute("select 1");},
+    [&]{conn->execute("select 1");});
+
+  // ---------------------------------------------------------------------------
+  print_header("prepared execute");
+  {
+    pq.check(PQprepare(pq.conn_, "bench_ps", "select $1::integer", 1, nullptr),
+      PGRES_COMMAND_OK);
+    auto ps = conn->prepare("select $1::integer", "bench_ps");
+    compare("execute", n, [&]
+    {
+      const char* const values[]{"42"};
+      pq.check(PQexecPrepared(pq.conn_, "bench_ps", 1, values, nullptr,
+          nullptr, 0), PGRES_TUPLES_OK);
+    }, [&]
+    {
+      ps.bind(0, 42);
+      ps.execute();
+    });
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("result fetch");
+  for (const auto format : {pgfe::Data_format::text, pgfe::Data_format::binary}) {
+    const bool is_text{format == pgfe::Data_format::text};
+    conn->set_result_format(format);
+    for (const unsigned long rows : {1UL, 1000UL, 1000000UL}) {
+      const auto query = "select generate_series(1," + std::to_string(rows) + ")";
+      const std::size_t iterations{rows >= 1000000 ? 3 : rows >= 1000 ? n / 10 : n};
+      compare(std::to_string(rows) + " rows " + (is_text ? "text" : "binary"),
+        std::max<std::size_t>(iterations, 1), [&]
+        {
+          (void)pq.fetch(query.c_str(), !is_text);
+        }, [&]
+        {
+          std::size_t result{};
+          conn->execute([&result](auto&& row)
+          {
+            const auto data = row.data();
+            result += data.size() + (static_cast<const char*>(data.bytes())[0] != 0);
+          }, query);
+        });
+    }
+  }
+  conn->set_result_format(pgfe::Data_format::text);
+
+  // ---------------------------------------------------------------------------
+  print_header("pipeline");
+  for (const std::size_t depth : {1, 10, 100, 1000}) {
+    std::vector<pgfe::Statement> statements(depth, pgfe::Statement{"select 1"});
+    const pgfe::Statement_vector vector{std::move(statements)};
+    compare("depth " + std::to_string(depth),
+      std::max<std::size_t>(n / depth, 3), [&]
+      {
+        if (!PQenterPipelineMode(pq.conn_))
+          throw std::runtime_error{"cannot enter pipeline mode"};
+        for (std::size_t i{}; i < depth; ++i) {
+          if (!PQsendQueryParams(pq.conn_, "select 1", 0, nullptr, nullptr,
+              nullptr, nullptr, 0))
+            throw std::runtime_error{PQerrorMessage(pq.conn_)};
+        }
+        if (!PQpipelineSync(pq.conn_))
+          throw std::runtime_error{PQerrorMessage(pq.conn_)};
+        for (std::size_t i{}; i < depth; ++i) {
+          while (auto* const res = PQgetResult(pq.conn_))
+            pq.check(res, PGRES_TUPLES_OK);
+        }
+        pq.check(PQgetResult(pq.conn_), PGRES_PIPELINE_SYNC);
+        if (!PQexitPipelineMode(pq.conn_))
+          throw std::runtime_error{PQerrorMessage(pq.conn_)};
+      }, [&]
+      {
+        conn->execute([](auto&&){}, vector);
+      });
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("copy");
+  {
+    conn->execute("create temp table bench_copy(id integer, dat text)");
+    pq.execute("create temp table bench_copy(id integer, dat text)",
+      PGRES_COMMAND_OK);
+    std::string data;
+    for (int i{}; i < 100000; ++i)
+      data.append(std::to_string(i)).append("\tdmitigr\n");
+
+    compare("copy in 100k rows", 5, [&]
+    {
+      pq.execute("copy bench_copy from stdin", PGRES_COPY_IN);
+      if (PQputCopyData(pq.conn_, data.data(), static_cast<int>(data.size())) != 1
+        || PQputCopyEnd(pq.conn_, nullptr) != 1)
+        throw std::runtime_error{PQerrorMessage(pq.conn_)};
+      while (auto* const res = PQgetResult(pq.conn_))
+        pq.check(res, PGRES_COMMAND_OK);
+    }, [&]
+    {
+      conn->execute("copy bench_copy from stdin");
+      auto copier = conn->copier();
+      copier.send(data);
+      copier.end();
+      conn->wait_response_throw();
+      (void)conn->completion();
+    });
+
+    compare("copy out", 5, [&]
+    {
+      pq.execute("copy bench_copy to stdout", PGRES_COPY_OUT);
+      char* buffer{};
+      while (PQgetCopyData(pq.conn_, &buffer, false) > 0)
+        PQfreemem(buffer);
+      while (auto* const res = PQgetResult(pq.conn_))
+        pq.check(res, PGRES_COMMAND_OK);
+    }, [&]
+    {
+      conn->execute("copy bench_copy to stdout");
+      const auto copier = conn->copier();
+      while (copier.receive());
+      conn->wait_response_throw();
+      (void)conn->completion();
+    });
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("array decode");
+  {
+    // The baseline is the manual parsing of the text representation.
+    std::string literal{"{"};
+    for (int i{}; i < 1000; ++i)
+      literal.append(i ? "," : "").append(std::to_string(i));
+    literal.append("}");
+    compare("1000 integers", n, [&]
+    {
+      std::vector<int> result;
+      result.reserve(1000);
+      for (const char* p{literal.c_str() + 1}; *p && *p != '}';) {
+        char* end{};
+        result.push_back(static_cast<int>(std::strtol(p, &end, 10)));
+        p = *end == ',' ? end + 1 : end;
+      }
+    }, [&]
+    {
+      using Array = std::vector<std::optional<int>>;
+      const auto result = pgfe::to<Array>(pgfe::Data_view{literal.c_str()});
+      if (result.size() != 1000)
+        throw std::runtime_error{"unexpected array size"};
+    });
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("pool acquire/release (pgfe only)");
+  for (const std::size_t thread_count : {1, 4, 16}) {
+    pgfe::Connection_pool pool{4, pgfe::test::connection_options()};
+    pool.connect();
+    constexpr std::size_t per_thread{1000};
+    const auto result = Benchmark{std::to_string(thread_count) + " threads x "
+      + std::to_string(per_thread)}
+      .set_iteration_count(3)
+      .run([&]
+      {
+        std::vector<std::thread> threads;
+        for (std::size_t i{}; i < thread_count; ++i) {
+          threads.emplace_back([&pool]
+          {
+            for (std::size_t j{}; j < per_thread; ++j)
+              (void)pool.connection();
+          });
+        }
+        for (auto& thread : threads)
+          thread.join();
+      });
+    std::cout << "  " << result << '\n' << "  per operation: "
+              << result.mean.count() / static_cast<long long>(thread_count * per_thread)
+              << "ns" << std::endl;
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
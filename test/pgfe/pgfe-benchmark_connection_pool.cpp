@@ -0,0 +1,124 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chrono = std::chrono;
+namespace pgfe = dmitigr::pgfe;
+using dmitigr::util::Benchmark_result;
+
+namespace {
+
+/**
+ * @returns The result of acquisitions of the connections of `pool` from
+ * `thread_count` threads. Each thread performs `iteration_count` acquisitions
+ * and executes the trivial query on each connection if `is_query`. The
+ * latency of acquisition includes the time of waiting for a free connection.
+ */
+Benchmark_result hammer(pgfe::Connection_pool& pool,
+  const std::size_t thread_count, const std::size_t iteration_count,
+  const bool is_query, chrono::nanoseconds& wall_time)
+{
+  using Clock = chrono::steady_clock;
+  std::vector<std::vector<chrono::nanoseconds>> samples(thread_count);
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  const auto start = Clock::now();
+  for (std::size_t i{}; i < thread_count; ++i) {
+    threads.emplace_back([&pool, &samples = samples[i], iteration_count, is_query]
+    {
+      samples.reserve(iteration_count);
+      for (std::size_t j{}; j < iteration_count; ++j) {
+        const auto acquire_start = Clock::now();
+        auto conn = pool.connection(std::nullopt);
+        samples.push_back(Clock::now() - acquire_start);
+        DMITIGR_ASSERT(conn.is_valid());
+        if (is_query)
+          conn->execute("select 1");
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  wall_time = Clock::now() - start;
+
+  std::vector<chrono::nanoseconds> all;
+  all.reserve(thread_count * iteration_count);
+  for (const auto& s : samples)
+    all.insert(all.end(), s.begin(), s.end());
+  std::sort(all.begin(), all.end());
+
+  Benchmark_result result;
+  result.name = std::to_string(thread_count) + " threads"
+    + (is_query ? " select 1" : " no query");
+  result.iteration_count = all.size();
+  chrono::nanoseconds total{};
+  for (const auto sample : all)
+    total += sample;
+  const auto percentile = [&all](const double p)
+  {
+    return all[static_cast<std::size_t>(p * static_cast<double>(all.size() - 1))];
+  };
+  result.mean = total / static_cast<long long>(all.size());
+  result.min = all.front();
+  result.p50 = percentile(.5);
+  result.p99 = percentile(.99);
+  result.p999 = percentile(.999);
+  result.max = all.back();
+  return result;
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  const std::size_t pool_size{(argc >= 2) ? std::stoul(argv[1]) : 8};
+  const std::size_t iteration_count{(argc >= 3) ? std::stoul(argv[2]) : 1000};
+
+  pgfe::Connection_pool pool{pool_size, pgfe::test::connection_options()};
+  pool.connect();
+  DMITIGR_ASSERT(pool.is_connected());
+
+  std::cout << "pool size: " << pool_size << ", acquisitions per thread: "
+            << iteration_count << std::endl;
+  for (const bool is_query : {false, true}) {
+    for (std::size_t thread_count{1}; thread_count <= 128; thread_count *= 2) {
+      chrono::nanoseconds wall_time{};
+      const auto result = hammer(pool, thread_count, iteration_count, is_query,
+        wall_time);
+      const double seconds{chrono::duration<double>(wall_time).count()};
+      std::cout << result << " throughput=" << std::fixed
+                << std::setprecision(0)
+                << (seconds > 0 ? static_cast<double>(result.iteration_count)
+                  / seconds : 0) << "/s" << std::defaultfloat << std::endl;
+    }
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
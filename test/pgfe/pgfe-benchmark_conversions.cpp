@@ -0,0 +1,216 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+using dmitigr::util::Benchmark;
+using pgfe::Data_format;
+using pgfe::Data_view;
+
+namespace {
+
+/// The number of measured samples.
+std::size_t iteration_count{1000};
+
+/// The sink of the benchmarked values.
+const void* volatile sink;
+
+/// Prevents the optimizing out of the computation of `value`.
+template<typename T>
+void do_not_optimize(const T& value) noexcept
+{
+  sink = &value;
+}
+
+void print_header(const char* const title)
+{
+  std::cout << "\n== " << title << " ==" << std::endl;
+}
+
+/// @returns The benchmark of the operation of the size `size` bytes.
+Benchmark make_benchmark(std::string name, const std::size_t size)
+{
+  // Short operations are batched to amortize the overhead of the clock.
+  const std::size_t batch_size = size < 1024 ? 100 : size < 65536 ? 10 : 1;
+  return Benchmark{std::move(name)}
+    .set_warmup_count(std::max<std::size_t>(iteration_count / 10, 1))
+    .set_iteration_count(iteration_count)
+    .set_batch_size(batch_size);
+}
+
+/// Measures the conversion of `data` to the value of type `T`.
+template<typename T>
+void bench_to_type(const std::string& name, const pgfe::Data& data)
+{
+  const auto format = data.format() == Data_format::binary ? "binary" : "text";
+  const auto result = make_benchmark("to_type " + name + " (" + format + ")",
+    data.size()).run([&data]
+    {
+      const auto value = pgfe::to<T>(data);
+      do_not_optimize(value);
+    });
+  std::cout << "  " << result << std::endl;
+}
+
+/// Measures the conversion of `value` to the data of the specified `format`.
+template<typename T>
+void bench_to_data(const std::string& name, const T& value,
+  const Data_format format)
+{
+  const auto size = pgfe::to_data(value, format)->size();
+  const auto result = make_benchmark("to_data " + name + " (" +
+    (format == Data_format::binary ? "binary" : "text") + ")", size)
+    .run([&value, format]
+    {
+      const auto data = pgfe::to_data(value, format);
+      do_not_optimize(data);
+    });
+  std::cout << "  " << result << std::endl;
+}
+
+/// Measures the conversions of `value` in both formats.
+template<typename T>
+void bench_both_formats(const std::string& name, const T& value)
+{
+  for (const auto format : {Data_format::text, Data_format::binary}) {
+    const auto data = pgfe::to_data(value, format);
+    const Data_view view{static_cast<const char*>(data->bytes()), data->size(),
+      format};
+    bench_to_type<T>(name, view);
+    bench_to_data(name, value, format);
+  }
+}
+
+/// Measures the conversions of `value` in text format only.
+template<typename T>
+void bench_text_format(const std::string& name, const T& value)
+{
+  const auto data = pgfe::to_data(value);
+  const Data_view view{static_cast<const char*>(data->bytes()), data->size(),
+    Data_format::text};
+  bench_to_type<T>(name, view);
+  bench_to_data(name, value, Data_format::text);
+}
+
+/// @returns The array of `size` optional integers with each 10th element null.
+std::vector<std::optional<int>> make_nullable_array(const std::size_t size)
+{
+  std::vector<std::optional<int>> result(size);
+  for (std::size_t i{}; i < size; ++i)
+    if (i % 10)
+      result[i] = static_cast<int>(i * 7919 % 1000000);
+  return result;
+}
+
+/// @returns The array of `size` integers.
+std::vector<int> make_array(const std::size_t size)
+{
+  std::vector<int> result(size);
+  for (std::size_t i{}; i < size; ++i)
+    result[i] = static_cast<int>(i * 7919 % 1000000);
+  return result;
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  if (argc >= 2)
+    iteration_count = std::stoul(argv[1]);
+
+  // ---------------------------------------------------------------------------
+  print_header("numerics");
+  bench_both_formats<short>("short", -12345);
+  bench_both_formats("int", 1234567890);
+  bench_both_formats("long long", -1234567890123456789LL);
+  bench_both_formats("float", 3.14159f);
+  bench_both_formats("double", -2.718281828459045);
+
+  // ---------------------------------------------------------------------------
+  print_header("bool and char");
+  bench_both_formats("bool", true);
+  bench_to_type<char>("char", Data_view{"x"});
+  bench_to_type<char>("char", Data_view{"x", 1, Data_format::binary});
+  bench_to_data("char", 'x', Data_format::text);
+
+  // ---------------------------------------------------------------------------
+  print_header("strings");
+  for (const std::size_t size : {16, 256, 4096, 1048576}) {
+    const std::string value(size, 's');
+    const auto suffix = " of " + std::to_string(size) + " bytes";
+    for (const auto format : {Data_format::text, Data_format::binary}) {
+      const Data_view view{value.data(), value.size(), format};
+      bench_to_type<std::string>("string" + suffix, view);
+      bench_to_type<std::string_view>("string_view" + suffix, view);
+    }
+    bench_to_data("string" + suffix, value, Data_format::text);
+    bench_to_data("string_view" + suffix, std::string_view{value},
+      Data_format::text);
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("optionals");
+  bench_to_type<std::optional<int>>("optional<int>", Data_view{"42"});
+  bench_to_type<std::optional<int>>("optional<int> null", Data_view{});
+  {
+    const std::optional<int> value{42};
+    const auto result = make_benchmark("to_data optional<int> (text)", 2)
+      .run([&value]
+      {
+        const auto data = pgfe::to_data(value);
+        do_not_optimize(data);
+      });
+    std::cout << "  " << result << std::endl;
+  }
+
+  // ---------------------------------------------------------------------------
+  print_header("arrays");
+  for (const std::size_t size : {10, 1000, 100000})
+    bench_both_formats("int[" + std::to_string(size) + "] with nulls",
+      make_nullable_array(size));
+  for (const std::size_t size : {10, 100}) {
+    const std::vector<std::vector<int>> value(size, make_array(size));
+    const auto sz = std::to_string(size);
+    bench_both_formats("int[" + sz + "][" + sz + "]", value);
+  }
+  {
+    const std::vector<std::vector<std::vector<int>>>
+      value(20, std::vector<std::vector<int>>(20, make_array(20)));
+    bench_both_formats("int[20][20][20]", value);
+  }
+  {
+    std::vector<std::optional<std::string>> value(1000);
+    for (std::size_t i{}; i < value.size(); ++i)
+      if (i % 10)
+        value[i] = "element \"" + std::to_string(i) + "\"";
+    bench_text_format("text[1000]", value);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
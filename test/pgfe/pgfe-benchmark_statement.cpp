@@ -0,0 +1,156 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace pgfe = dmitigr::pgfe;
+using dmitigr::util::Benchmark;
+
+namespace {
+
+/// The number of measured samples.
+std::size_t iteration_count{100};
+
+/// The number of the distinct named parameters of the generated queries.
+constexpr int parameter_count{64};
+
+void print_header(const std::string& title)
+{
+  std::cout << "\n== " << title << " ==" << std::endl;
+}
+
+template<typename F>
+void measure(const char* const name, F&& f)
+{
+  std::cout << "  " << Benchmark{name}
+    .set_warmup_count(std::max<std::size_t>(iteration_count / 10, 1))
+    .set_iteration_count(iteration_count)
+    .run(std::forward<F>(f)) << std::endl;
+}
+
+/**
+ * @returns The query of at least `size` bytes with comments, quoted literals
+ * and dollar-quoted strings, named parameters (including the ones rendered as
+ * literals and identifiers), positional parameter `$1` and the parameter
+ * `nested` to be replaced with a statement.
+ */
+std::string make_query(const std::size_t size)
+{
+  std::string result{"-- $id$benchmark$id$\nSELECT "};
+  for (int i{}; result.size() < size; ++i) {
+    const auto n = std::to_string(i % parameter_count);
+    result.append("t.c").append(std::to_string(i)).append(" + :p").append(n)
+      .append(" /* column ").append(n).append(" */, ")
+      .append(":'l").append(n).append("' || 'it''s' || $$quoted$$ AS :\"i")
+      .append(n).append("\",\n");
+  }
+  result.append("$1 FROM :nested t WHERE t.id = :id");
+  return result;
+}
+
+/// Binds all the named parameters of `s` which are generated by make_query().
+void bind_all(pgfe::Statement& s)
+{
+  for (int i{}; i < parameter_count; ++i) {
+    const auto n = std::to_string(i);
+    s.bind("p" + n, "42");
+    s.bind("l" + n, "literal " + n);
+    s.bind("i" + n, "identifier " + n);
+  }
+  s.bind("id", "$2");
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  if (argc >= 2)
+    iteration_count = std::stoul(argv[1]);
+
+  const pgfe::Statement nested{"SELECT :a a, :b b FROM t /* nested */"
+    " WHERE :where_"};
+
+  for (const std::size_t size : {10240, 102400}) {
+    const auto input = make_query(size);
+    print_header("statement of " + std::to_string(input.size()) + " bytes");
+
+    pgfe::Statement s;
+    measure("parse", [&s, &input]
+    {
+      s = input;
+    });
+
+    measure("to_string", [&s]
+    {
+      const auto str = s.to_string();
+      DMITIGR_ASSERT(!str.empty());
+    });
+
+    pgfe::Statement copy;
+    measure("copy", [&s, &copy]
+    {
+      copy = s;
+    });
+
+    measure("copy and bind", [&s, &copy]
+    {
+      copy = s;
+      bind_all(copy);
+    });
+
+    measure("copy and replace nested", [&s, &copy, &nested]
+    {
+      copy = s;
+      copy.replace_parameter("nested", nested);
+      copy.replace_parameter("where_", "a = :a");
+    });
+  }
+
+  // The rendering requires the connection for quoting of literals.
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  for (const std::size_t size : {10240, 102400}) {
+    pgfe::Statement s{make_query(size)};
+    print_header("rendering of statement of "
+      + std::to_string(s.to_string().size()) + " bytes");
+    s.replace_parameter("nested", nested);
+    s.replace_parameter("where_", "a = :a");
+    bind_all(s);
+    measure("bind and render", [&s, &conn]
+    {
+      s.bind("id", "$2");
+      const auto str = s.to_query_string(*conn);
+      DMITIGR_ASSERT(!str.empty());
+    });
+
+    measure("render", [&s, &conn]
+    {
+      const auto str = s.to_query_string(*conn);
+      DMITIGR_ASSERT(!str.empty());
+    });
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,318 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <libpq-fe.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+namespace {
+
+const char* const conninfo = "hostaddr=127.0.0.1 user=pgfe_test"
+  " password=pgfe_test dbname=pgfe_test connect_timeout=7";
+
+enum class Format { text, binary };
+
+const char* to_literal(const Format format) noexcept
+{
+  return format == Format::text ? "text" : "binary";
+}
+
+void append_int16(std::string& result, const std::int16_t value)
+{
+  const auto v = static_cast<std::uint16_t>(value);
+  result += static_cast<char>((v >> 8) & 0xff);
+  result += static_cast<char>(v & 0xff);
+}
+
+void append_int32(std::string& result, const std::int32_t value)
+{
+  const auto v = static_cast<std::uint32_t>(value);
+  for (int shift{24}; shift >= 0; shift -= 8)
+    result += static_cast<char>((v >> shift) & 0xff);
+}
+
+/// @returns The rows of `COPY` in the given format (the data of `COPY FROM`).
+std::vector<std::string> make_rows(const Format format,
+  const unsigned long row_count, const std::size_t row_width)
+{
+  const std::string payload(row_width, 'x');
+  std::vector<std::string> result;
+  result.reserve(row_count + 2);
+  if (format == Format::binary)
+    result.emplace_back("PGCOPY\n\377\r\n\0\0\0\0\0\0\0\0\0", 19);
+  for (unsigned long i{}; i < row_count; ++i) {
+    std::string row;
+    if (format == Format::text) {
+      row.append(std::to_string(i)).append(1, '\t')
+        .append(payload).append(1, '\n');
+    } else {
+      append_int16(row, 2);
+      append_int32(row, 4);
+      append_int32(row, static_cast<std::int32_t>(i));
+      append_int32(row, static_cast<std::int32_t>(payload.size()));
+      row.append(payload);
+    }
+    result.push_back(std::move(row));
+  }
+  if (format == Format::binary) {
+    std::string trailer;
+    append_int16(trailer, -1);
+    result.push_back(std::move(trailer));
+  }
+  return result;
+}
+
+std::string copy_statement(const Format format, const bool is_from)
+{
+  return std::string{"copy copy_throughput "}.append(is_from ?
+    "from stdin" : "to stdout").append(" (format ")
+    .append(to_literal(format)).append(")");
+}
+
+// -----------------------------------------------------------------------------
+// libpq
+// -----------------------------------------------------------------------------
+
+struct Pq_connection final {
+  PGconn* conn_{};
+
+  Pq_connection()
+    : conn_{PQconnectdb(conninfo)}
+  {
+    if (!conn_)
+      throw std::bad_alloc{};
+    else if (PQstatus(conn_) != CONNECTION_OK) {
+      const std::string message{PQerrorMessage(conn_)};
+      PQfinish(conn_);
+      throw std::runtime_error{"cannot connect to server: " + message};
+    }
+  }
+
+  ~Pq_connection()
+  {
+    PQfinish(conn_);
+  }
+
+  Pq_connection(const Pq_connection&) = delete;
+  Pq_connection& operator=(const Pq_connection&) = delete;
+
+  void execute(const std::string& query, const ExecStatusType expected) const
+  {
+    auto* const res = PQexec(conn_, query.c_str());
+    const auto status = PQresultStatus(res);
+    PQclear(res);
+    if (status != expected)
+      throw std::runtime_error{PQerrorMessage(conn_)};
+  }
+
+  void complete() const
+  {
+    while (auto* const res = PQgetResult(conn_)) {
+      const auto status = PQresultStatus(res);
+      PQclear(res);
+      if (status != PGRES_COMMAND_OK)
+        throw std::runtime_error{PQerrorMessage(conn_)};
+    }
+  }
+};
+
+/// Sends `rows` by chunks of `buffer_size` bytes with `PQputCopyData()`.
+void pq_copy_from(const Pq_connection& pq, const Format format,
+  const std::vector<std::string>& rows, const std::size_t buffer_size)
+{
+  pq.execute(copy_statement(format, true), PGRES_COPY_IN);
+  std::string buffer;
+  buffer.reserve(buffer_size);
+  const auto flush = [&pq, &buffer]
+  {
+    if (!buffer.empty()) {
+      if (PQputCopyData(pq.conn_, buffer.data(),
+          static_cast<int>(buffer.size())) != 1)
+        throw std::runtime_error{PQerrorMessage(pq.conn_)};
+      buffer.clear();
+    }
+  };
+  for (const auto& row : rows) {
+    if (buffer.size() + row.size() > buffer_size)
+      flush();
+    buffer.append(row);
+  }
+  flush();
+  if (PQputCopyEnd(pq.conn_, nullptr) != 1)
+    throw std::runtime_error{PQerrorMessage(pq.conn_)};
+  pq.complete();
+}
+
+/// @returns The number of bytes received with `PQgetCopyData()`.
+std::uintmax_t pq_copy_to(const Pq_connection& pq, const Format format)
+{
+  pq.execute(copy_statement(format, false), PGRES_COPY_OUT);
+  std::uintmax_t result{};
+  char* buffer{};
+  int size{};
+  while ((size = PQgetCopyData(pq.conn_, &buffer, false)) > 0) {
+    result += static_cast<std::uintmax_t>(size);
+    PQfreemem(buffer);
+  }
+  if (size == -2)
+    throw std::runtime_error{PQerrorMessage(pq.conn_)};
+  pq.complete();
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Pgfe
+// -----------------------------------------------------------------------------
+
+/// Sends `rows` by Copy_writer with the buffer capacity of `buffer_size`.
+void pgfe_copy_from(pgfe::Connection& conn, const Format format,
+  const std::vector<std::string>& rows, const std::size_t buffer_size)
+{
+  conn.execute(copy_statement(format, true));
+  auto copier = conn.copier();
+  pgfe::Copy_writer writer{copier, buffer_size};
+  for (const auto& row : rows)
+    writer.write(row);
+  writer.end();
+  conn.wait_response_throw();
+  (void)conn.completion();
+}
+
+/// @returns The number of bytes received by Copier::receive().
+std::uintmax_t pgfe_copy_to(pgfe::Connection& conn, const Format format)
+{
+  conn.execute(copy_statement(format, false));
+  const auto copier = conn.copier();
+  std::uintmax_t result{};
+  while (const auto data = copier.receive())
+    result += data.size();
+  conn.wait_response_throw();
+  (void)conn.completion();
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+
+void report(const char* const client, const char* const direction,
+  const Format format, const std::size_t row_width,
+  const std::size_t buffer_size, const unsigned long row_count,
+  const std::uintmax_t byte_count, const std::chrono::microseconds elapsed)
+{
+  const double seconds = static_cast<double>(elapsed.count()) / 1e6;
+  const double rows_per_second = seconds > 0 ? row_count / seconds : 0;
+  const double mb_per_second = seconds > 0 ?
+    static_cast<double>(byte_count) / (1024 * 1024) / seconds : 0;
+  std::cout << std::left
+            << std::setw(5) << client
+            << std::setw(5) << direction
+            << std::setw(7) << to_literal(format)
+            << std::right
+            << std::setw(7) << row_width
+            << std::setw(9) << buffer_size
+            << std::setw(12) << elapsed.count() << " us"
+            << std::setw(13) << std::fixed << std::setprecision(0)
+            << rows_per_second << " rows/s"
+            << std::setw(10) << std::setprecision(2)
+            << mb_per_second << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  namespace chrono = std::chrono;
+  using dmitigr::util::with_measure;
+
+  const unsigned long row_count{(argc >= 2) ? std::stoul(argv[1]) : 100000};
+  const std::vector<std::size_t> row_widths{16, 256, 4096};
+  const std::vector<std::size_t> buffer_sizes{4096, 65536, 1048576};
+
+  const Pq_connection pq;
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("drop table if exists copy_throughput");
+  conn->execute("create unlogged table copy_throughput"
+    "(id integer not null, dat text not null)");
+
+  std::cout << "client dir format width   buffer        time"
+    "            throughput" << std::endl;
+  for (const auto format : {Format::text, Format::binary}) {
+    for (const auto row_width : row_widths) {
+      const auto rows = make_rows(format, row_count, row_width);
+      std::uintmax_t byte_count{};
+      for (const auto& row : rows)
+        byte_count += row.size();
+
+      // COPY FROM.
+      for (const auto buffer_size : buffer_sizes) {
+        conn->execute("truncate copy_throughput");
+        const auto elapsed_pq = with_measure<chrono::microseconds>([&]
+        {
+          pq_copy_from(pq, format, rows, buffer_size);
+        });
+        report("pq", "from", format, row_width, buffer_size, row_count,
+          byte_count, elapsed_pq);
+
+        conn->execute("truncate copy_throughput");
+        const auto elapsed_pgfe = with_measure<chrono::microseconds>([&]
+        {
+          pgfe_copy_from(*conn, format, rows, buffer_size);
+        });
+        report("pgfe", "from", format, row_width, buffer_size, row_count,
+          byte_count, elapsed_pgfe);
+      }
+
+      // COPY TO (the buffer is managed by libpq).
+      std::uintmax_t received_pq{};
+      const auto elapsed_pq = with_measure<chrono::microseconds>([&]
+      {
+        received_pq = pq_copy_to(pq, format);
+      });
+      report("pq", "to", format, row_width, 0, row_count,
+        received_pq, elapsed_pq);
+
+      std::uintmax_t received_pgfe{};
+      const auto elapsed_pgfe = with_measure<chrono::microseconds>([&]
+      {
+        received_pgfe = pgfe_copy_to(*conn, format);
+      });
+      report("pgfe", "to", format, row_width, 0, row_count,
+        received_pgfe, elapsed_pgfe);
+
+      DMITIGR_ASSERT(received_pq == received_pgfe);
+    }
+  }
+  conn->execute("drop table copy_throughput");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,329 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The baseline of the notifications (Notification_dispatcher), the large
+// objects (Large_object and Large_object_streambuf) and the short transactions
+// (Transaction_guard, immediate and pipelined).
+//
+// Usage: pgfe-feature_throughput [iteration count] [large object size in MiB]
+
+#include "pgfe-unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chrono = std::chrono;
+namespace pgfe = dmitigr::pgfe;
+using dmitigr::util::Benchmark_result;
+using dmitigr::util::with_measure;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+/// @returns The result summarized from the `samples`.
+Benchmark_result summarize(std::string name,
+  std::vector<chrono::nanoseconds> samples)
+{
+  DMITIGR_ASSERT(!samples.empty());
+  std::sort(samples.begin(), samples.end());
+  Benchmark_result result;
+  result.name = std::move(name);
+  result.iteration_count = samples.size();
+  chrono::nanoseconds total{};
+  for (const auto sample : samples)
+    total += sample;
+  const auto percentile = [&samples](const double p)
+  {
+    return samples[static_cast<std::size_t>(p *
+      static_cast<double>(samples.size() - 1))];
+  };
+  result.mean = total / static_cast<long long>(samples.size());
+  result.min = samples.front();
+  result.p50 = percentile(.5);
+  result.p99 = percentile(.99);
+  result.p999 = percentile(.999);
+  result.max = samples.back();
+  return result;
+}
+
+/// Prints the number of `count` operations per second.
+void report_rate(const std::string& name, const std::size_t count,
+  const chrono::microseconds elapsed, const char* const unit)
+{
+  const double seconds = static_cast<double>(elapsed.count()) / 1e6;
+  std::cout << std::left << std::setw(36) << name << std::right
+            << std::setw(12) << elapsed.count() << " us"
+            << std::setw(12) << std::fixed << std::setprecision(0)
+            << (seconds > 0 ? static_cast<double>(count) / seconds : 0)
+            << ' ' << unit << std::defaultfloat << std::endl;
+}
+
+/// Prints the throughput of transferring of `byte_count` bytes.
+void report_bytes(const std::string& name, const std::size_t chunk_size,
+  const std::size_t byte_count, const chrono::microseconds elapsed)
+{
+  const double seconds = static_cast<double>(elapsed.count()) / 1e6;
+  std::cout << std::left << std::setw(24) << name << std::right
+            << std::setw(9) << chunk_size
+            << std::setw(12) << elapsed.count() << " us"
+            << std::setw(10) << std::fixed << std::setprecision(2)
+            << (seconds > 0 ?
+              static_cast<double>(byte_count) / (1024 * 1024) / seconds : 0)
+            << " MB/s" << std::defaultfloat << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+// Notifications
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Sends `count` notifications from the separate connection and
+ * dispatches them by `dispatcher` in the calling thread.
+ *
+ * @details The payload of each notification is the time of sending, so the
+ * latency is measured from the call of `pg_notify()` to the call of the
+ * subscriber. If `batch_size > 1`, the notifications are sent by transactions
+ * of `batch_size` notifications, which are delivered by the server on commit.
+ */
+void notify(pgfe::Notification_dispatcher& dispatcher,
+  const std::size_t count, const std::size_t batch_size)
+{
+  const std::string channel{"pgfe_feature_throughput"};
+  std::vector<chrono::nanoseconds> samples;
+  samples.reserve(count);
+  dispatcher.subscribe(channel, [&samples](const pgfe::Notification& n)
+  {
+    const auto now = Clock::now().time_since_epoch();
+    const chrono::nanoseconds sent{
+      std::stoll(pgfe::to<std::string>(n.payload()))};
+    samples.push_back(now - sent);
+  });
+
+  const auto start = Clock::now();
+  auto sender = std::async(std::launch::async, [&channel, count, batch_size]
+  {
+    auto conn = pgfe::test::make_connection();
+    conn->connect();
+    const pgfe::Statement statement{"select pg_notify($1, $2)"};
+    for (std::size_t i{}; i < count;) {
+      const auto end = std::min(i + batch_size, count);
+      if (batch_size > 1)
+        conn->execute("begin");
+      for (; i < end; ++i) {
+        const chrono::nanoseconds now{Clock::now().time_since_epoch()};
+        conn->execute(statement, channel, std::to_string(now.count()));
+      }
+      if (batch_size > 1)
+        conn->execute("commit");
+    }
+  });
+  std::size_t received{};
+  while (received < count) {
+    const auto dispatched = dispatcher.dispatch(chrono::milliseconds{1000});
+    received += dispatched;
+    if (!dispatched && sender.wait_for(chrono::seconds{}) ==
+      std::future_status::ready) {
+      sender.get(); // rethrows the error of the sender (if any)
+      throw std::runtime_error{"notifications are lost"};
+    }
+  }
+  const auto elapsed = chrono::duration_cast<chrono::microseconds>(
+    Clock::now() - start);
+  sender.get();
+  dispatcher.unsubscribe(channel);
+
+  const auto name = "notify (batch " + std::to_string(batch_size) + ")";
+  std::cout << summarize(name + " latency", std::move(samples)) << std::endl;
+  report_rate(name, count, elapsed, "messages/s");
+}
+
+// -----------------------------------------------------------------------------
+// Large objects
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Writes and reads back the large object of `size` bytes by chunks of
+ * `chunk_size` bytes by using Large_object directly and by using
+ * Large_object_streambuf (by pieces of 4 KiB).
+ */
+void transfer_large_object(pgfe::Connection& conn, const std::size_t size,
+  const std::size_t chunk_size)
+{
+  using pgfe::Large_object_open_mode;
+  using pgfe::Large_object_seek_whence;
+  constexpr std::size_t piece_size{4096};
+  const std::string data(std::max(chunk_size, piece_size), 'x');
+  std::string buffer(data.size(), '\0');
+
+  conn.execute("begin");
+  const auto oid = conn.create_large_object();
+  DMITIGR_ASSERT(oid != pgfe::invalid_oid);
+  auto lob = conn.open_large_object(oid,
+    Large_object_open_mode::writing | Large_object_open_mode::reading);
+  DMITIGR_ASSERT(lob);
+
+  // Large_object.
+  report_bytes("lo write", chunk_size, size,
+    with_measure<chrono::microseconds>([&]
+    {
+      for (std::size_t i{}; i < size; i += chunk_size)
+        lob.write(data.data(), std::min(chunk_size, size - i));
+    }));
+  DMITIGR_ASSERT(lob.seek(0, Large_object_seek_whence::begin) == 0);
+  report_bytes("lo read", chunk_size, size,
+    with_measure<chrono::microseconds>([&]
+    {
+      std::size_t received{};
+      while (const auto n = lob.read_into(buffer.data(), chunk_size))
+        received += n;
+      DMITIGR_ASSERT(received == size);
+    }));
+
+  // Large_object_streambuf.
+  lob.truncate(0);
+  DMITIGR_ASSERT(lob.seek(0, Large_object_seek_whence::begin) == 0);
+  {
+    pgfe::Large_object_streambuf lobuf{lob, chunk_size};
+    std::ostream out{&lobuf};
+    report_bytes("lo streambuf write", chunk_size, size,
+      with_measure<chrono::microseconds>([&]
+      {
+        for (std::size_t i{}; i < size; i += piece_size)
+          out.write(data.data(), static_cast<std::streamsize>(
+              std::min(piece_size, size - i)));
+        DMITIGR_ASSERT(out.flush());
+      }));
+
+    std::istream in{&lobuf};
+    DMITIGR_ASSERT(in.seekg(0));
+    report_bytes("lo streambuf read", chunk_size, size,
+      with_measure<chrono::microseconds>([&]
+      {
+        std::size_t received{};
+        while (in.read(buffer.data(), piece_size) || in.gcount())
+          received += static_cast<std::size_t>(in.gcount());
+        DMITIGR_ASSERT(received == size);
+      }));
+  }
+  (void)lob.close();
+  conn.execute("rollback"); // removes the large object
+}
+
+// -----------------------------------------------------------------------------
+// Transactions
+// -----------------------------------------------------------------------------
+
+const pgfe::Statement insert_statement{
+  "insert into feature_throughput values ($1)"};
+
+/// Commits `count` transactions of single insert one by one.
+void commit_immediate(pgfe::Connection& conn, const std::size_t count)
+{
+  report_rate("commit (immediate)", count,
+    with_measure<chrono::microseconds>([&]
+    {
+      for (std::size_t i{}; i < count; ++i) {
+        pgfe::Transaction_guard tg{conn};
+        conn.execute(insert_statement, static_cast<long long>(i));
+        tg.commit();
+      }
+    }), "commits/s");
+}
+
+/**
+ * @brief Commits `count` transactions of single insert in the pipeline.
+ *
+ * @details If `depth == 1` each transaction is committed by the pipelined
+ * Transaction_guard (i.e. costs the single round trip). Otherwise `depth`
+ * transactions are queued before completion of the pipeline.
+ */
+void commit_pipelined(pgfe::Connection& conn, const std::size_t count,
+  const std::size_t depth)
+{
+  using Mode = pgfe::Transaction_guard::Mode;
+  const auto ignore = [](auto&&){};
+  conn.set_pipeline_enabled(true);
+  report_rate("commit (pipelined, depth " + std::to_string(depth) + ")",
+    count, with_measure<chrono::microseconds>([&]
+    {
+      for (std::size_t i{}; i < count;) {
+        if (depth == 1) {
+          pgfe::Transaction_guard tg{conn, Mode::pipelined};
+          conn.execute_pipelined(ignore, insert_statement,
+            static_cast<long long>(i++));
+          tg.commit();
+        } else {
+          for (const auto end = std::min(i + depth, count); i < end; ++i) {
+            conn.execute_pipelined(ignore, "begin");
+            conn.execute_pipelined(ignore, insert_statement,
+              static_cast<long long>(i));
+            conn.execute_pipelined(ignore, "commit");
+          }
+          conn.complete_pipeline();
+        }
+      }
+    }), "commits/s");
+  conn.set_pipeline_enabled(false);
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  const std::size_t iteration_count{(argc >= 2) ? std::stoul(argv[1]) : 10000};
+  const std::size_t lo_size{((argc >= 3) ? std::stoul(argv[2]) : 64)
+    * 1024 * 1024};
+
+  // Notifications.
+  {
+    pgfe::Notification_dispatcher dispatcher{pgfe::test::connection_options()};
+    dispatcher.connect();
+    for (const std::size_t batch_size : {1, 100})
+      notify(dispatcher, iteration_count, batch_size);
+  }
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  // Large objects.
+  std::cout << "operation                   chunk        time       throughput"
+            << std::endl;
+  for (const std::size_t chunk_size : {4096, 65536, 262144, 1048576})
+    transfer_large_object(*conn, lo_size, chunk_size);
+
+  // Transactions.
+  conn->execute("drop table if exists feature_throughput");
+  conn->execute("create table feature_throughput(n bigint not null)");
+  commit_immediate(*conn, iteration_count);
+  for (const std::size_t depth : {1, 10, 100})
+    commit_pipelined(*conn, iteration_count, depth);
+  conn->execute("drop table feature_throughput");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
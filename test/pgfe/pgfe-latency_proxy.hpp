@@ -0,0 +1,356 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DMITIGR_LIBS_TEST_PGFE_LATENCY_PROXY_HPP
+#define DMITIGR_LIBS_TEST_PGFE_LATENCY_PROXY_HPP
+
+#include "../../src/net/client.hpp"
+#include "../../src/net/descriptor.hpp"
+#include "../../src/net/listener.hpp"
+#include "../../src/net/socket.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmitigr::pgfe::test {
+
+/// The options of Latency_proxy.
+struct Latency_proxy_options final {
+  /// The address to listen on.
+  std::string address{"127.0.0.1"};
+
+  /// The port to listen on.
+  int port{15432};
+
+  /// The address of the upstream server.
+  std::string upstream_address{"127.0.0.1"};
+
+  /// The port of the upstream server.
+  int upstream_port{5432};
+
+  /// The delay added to each chunk of data in each direction (one-way).
+  std::chrono::microseconds delay{};
+
+  /**
+   * The maximum deviation of the delay. Each chunk is delayed by the random
+   * value in range `[delay - jitter, delay + jitter]`, but never overtakes
+   * the preceding chunk, just like in TCP.
+   */
+  std::chrono::microseconds jitter{};
+
+  /// The bandwidth of each direction in bytes per second (`0` is unlimited).
+  std::uint64_t bandwidth{};
+
+  /// The seed of the jitter generator.
+  std::uint_fast32_t seed{std::mt19937::default_seed};
+};
+
+/**
+ * @brief A TCP proxy which adds the latency and limits the bandwidth of the
+ * traffic to the upstream server (PostgreSQL by default).
+ *
+ * @details Benchmarks on the localhost hide the round-trip costs, so the
+ * effect of pipelining, batching and pooling is better seen with the client
+ * connected through this proxy. For example:
+ * @code
+ * Latency_proxy_options options;
+ * options.delay = std::chrono::milliseconds{5};
+ * Latency_proxy proxy{options};
+ * pgfe::Connection conn{connection_options().set_port(proxy.port())};
+ * @endcode
+ *
+ * Each accepted connection is served by four threads: the reader and the
+ * writer of both directions. The reader stamps the chunks with the time of
+ * delivery and the writer delivers them no earlier than this time and no
+ * faster than the bandwidth allows.
+ */
+class Latency_proxy final {
+public:
+  /// Starts the proxy.
+  explicit Latency_proxy(Latency_proxy_options options)
+    : options_{std::move(options)}
+  {
+    using std::chrono::microseconds;
+    if (options_.delay < microseconds::zero())
+      throw std::invalid_argument{"invalid delay of latency proxy"};
+    else if (options_.jitter < microseconds::zero() ||
+      options_.jitter > options_.delay)
+      throw std::invalid_argument{"invalid jitter of latency proxy"};
+
+    listener_ = net::Listener::make({options_.address, options_.port, 64});
+    listener_->listen();
+    acceptor_ = std::thread{[this]{accept();}};
+  }
+
+  /// Stops the proxy and breaks the proxied connections.
+  ~Latency_proxy()
+  {
+    is_stopped_ = true;
+    acceptor_.join();
+    for (auto& session : sessions_)
+      session->stop();
+    sessions_.clear();
+  }
+
+  /// Non copy-constructible.
+  Latency_proxy(const Latency_proxy&) = delete;
+
+  /// Non copy-assignable.
+  Latency_proxy& operator=(const Latency_proxy&) = delete;
+
+  /// @returns The options.
+  const Latency_proxy_options& options() const noexcept
+  {
+    return options_;
+  }
+
+  /// @returns The port to connect to.
+  int port() const noexcept
+  {
+    return options_.port;
+  }
+
+  /// @returns The number of accepted connections.
+  std::uint64_t connection_count() const noexcept
+  {
+    return connection_count_;
+  }
+
+  /// @returns The number of bytes forwarded to the upstream server.
+  std::uint64_t upstream_byte_count() const noexcept
+  {
+    return upstream_byte_count_;
+  }
+
+  /// @returns The number of bytes forwarded to the clients.
+  std::uint64_t downstream_byte_count() const noexcept
+  {
+    return downstream_byte_count_;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  /// A chunk of data along with the time of its delivery.
+  struct Chunk final {
+    Clock::time_point due;
+    std::string data; // empty means end of stream
+  };
+
+  /// A one-way transfer of the data from `source` to `destination`.
+  class Pipe final {
+  public:
+    Pipe(const Latency_proxy_options& options,
+      std::shared_ptr<net::Descriptor> source,
+      std::shared_ptr<net::Descriptor> destination,
+      std::atomic<std::uint64_t>& byte_count)
+      : options_{options}
+      , source_{std::move(source)}
+      , destination_{std::move(destination)}
+      , byte_count_{byte_count}
+      , generator_{options.seed}
+    {
+      reader_ = std::thread{[this]{read();}};
+      writer_ = std::thread{[this]{write();}};
+    }
+
+    ~Pipe()
+    {
+      {
+        const std::lock_guard lg{mutex_};
+        is_stopped_ = true;
+      }
+      cv_.notify_one();
+      reader_.join();
+      writer_.join();
+    }
+
+    Pipe(const Pipe&) = delete;
+    Pipe& operator=(const Pipe&) = delete;
+
+  private:
+    const Latency_proxy_options& options_;
+    std::shared_ptr<net::Descriptor> source_;
+    std::shared_ptr<net::Descriptor> destination_;
+    std::atomic<std::uint64_t>& byte_count_;
+    std::mt19937 generator_;
+    Clock::time_point last_due_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Chunk> chunks_;
+    bool is_stopped_{};
+    std::thread reader_;
+    std::thread writer_;
+
+    Clock::time_point due_time()
+    {
+      auto delay = options_.delay;
+      using Rep = std::chrono::microseconds::rep;
+      if (const Rep jitter = options_.jitter.count()) {
+        std::uniform_int_distribution<Rep> dist{-jitter, jitter};
+        delay += std::chrono::microseconds{dist(generator_)};
+      }
+      return last_due_ = std::max(Clock::now() + delay, last_due_);
+    }
+
+    void push(std::string data)
+    {
+      {
+        const std::lock_guard lg{mutex_};
+        chunks_.push_back({due_time(), std::move(data)});
+      }
+      cv_.notify_one();
+    }
+
+    void read()
+    {
+      std::string buffer(16384, '\0');
+      try {
+        while (true) {
+          const auto size = source_->read(buffer.data(),
+            static_cast<std::streamsize>(buffer.size()));
+          if (size <= 0)
+            break;
+          push(buffer.substr(0, static_cast<std::size_t>(size)));
+        }
+      } catch (...) {}
+      push({});
+    }
+
+    void write()
+    {
+      auto free_time = Clock::now(); // when the bandwidth allows to send
+      while (true) {
+        std::unique_lock lk{mutex_};
+        cv_.wait(lk, [this]{return is_stopped_ || !chunks_.empty();});
+        if (is_stopped_)
+          return;
+        const auto due = std::max(chunks_.front().due, free_time);
+        if (cv_.wait_until(lk, due, [this]{return is_stopped_;}))
+          return;
+        auto chunk = std::move(chunks_.front());
+        chunks_.pop_front();
+        lk.unlock();
+
+        try {
+          if (chunk.data.empty()) {
+            net::shutdown_socket(native_handle(*destination_), net::sd_send);
+            return;
+          }
+          byte_count_ += chunk.data.size();
+          const char* data = chunk.data.data();
+          auto size = static_cast<std::streamsize>(chunk.data.size());
+          while (size > 0) {
+            const auto written = destination_->write(data, size);
+            data += written;
+            size -= written;
+          }
+        } catch (...) {
+          // The destination is gone, so break the source too.
+          shutdown(*source_);
+          return;
+        }
+
+        if (options_.bandwidth) {
+          using std::chrono::duration_cast;
+          const std::chrono::duration<double> transfer_time{
+            static_cast<double>(chunk.data.size()) / options_.bandwidth};
+          free_time = due + duration_cast<Clock::duration>(transfer_time);
+        }
+      }
+    }
+  };
+
+  /// A proxied connection.
+  class Session final {
+  public:
+    Session(Latency_proxy& proxy, std::unique_ptr<net::Descriptor> client)
+      : client_{std::move(client)}
+      , upstream_{net::make_tcp_connection({proxy.options_.upstream_address,
+          proxy.options_.upstream_port})}
+      , upstream_pipe_{proxy.options_, client_, upstream_,
+          proxy.upstream_byte_count_}
+      , downstream_pipe_{proxy.options_, upstream_, client_,
+          proxy.downstream_byte_count_}
+    {}
+
+    /// Breaks the connection to unblock the readers and the writers.
+    void stop() noexcept
+    {
+      shutdown(*client_);
+      shutdown(*upstream_);
+    }
+
+  private:
+    std::shared_ptr<net::Descriptor> client_;
+    std::shared_ptr<net::Descriptor> upstream_;
+    Pipe upstream_pipe_;
+    Pipe downstream_pipe_;
+  };
+
+  Latency_proxy_options options_;
+  std::unique_ptr<net::Listener> listener_;
+  std::atomic_bool is_stopped_{};
+  std::atomic<std::uint64_t> connection_count_{};
+  std::atomic<std::uint64_t> upstream_byte_count_{};
+  std::atomic<std::uint64_t> downstream_byte_count_{};
+  std::vector<std::unique_ptr<Session>> sessions_; // accessed by acceptor_
+  std::thread acceptor_;
+
+  static net::Socket_native native_handle(net::Descriptor& descriptor)
+  {
+    return static_cast<net::Socket_native>(descriptor.native_handle());
+  }
+
+  static void shutdown(net::Descriptor& descriptor) noexcept
+  {
+    try {
+      net::shutdown_socket(native_handle(descriptor), net::sd_both);
+    } catch (...) {}
+  }
+
+  void accept()
+  {
+    while (!is_stopped_) {
+      try {
+        if (!listener_->wait(std::chrono::milliseconds{50}))
+          continue;
+        auto client = listener_->accept();
+        ++connection_count_;
+        sessions_.push_back(std::make_unique<Session>(*this,
+            std::move(client)));
+      } catch (...) {
+        // The upstream is unavailable, so the client is just disconnected.
+      }
+    }
+  }
+};
+
+} // namespace dmitigr::pgfe::test
+
+#endif // DMITIGR_LIBS_TEST_PGFE_LATENCY_PROXY_HPP
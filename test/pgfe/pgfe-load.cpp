@@ -0,0 +1,337 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The load generator in the spirit of pgbench, but driven by pgfe.
+//
+// Usage: pgfe-load [script [threads [seconds [pipeline_depth]]]]
+//
+// The script is parsed by Statement_vector. The extra data of each statement
+// can contain:
+//   - `weight` - the relative frequency of the statement (1 by default);
+//   - the generator of each named parameter of the statement, either
+//   `random <min> <max>` (the uniformly distributed integer) or the constant
+//   value.
+// For example:
+//
+// -- $weight$3$weight$
+// -- $aid$random 1 100000$aid$
+// SELECT abalance FROM pgbench_accounts WHERE aid = :aid;
+
+#include "pgfe-unit.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const default_script =
+  "-- $weight$3$weight$\n"
+  "-- $n$random 1 1000000$n$\n"
+  "select :n::int + 1;\n"
+  "\n"
+  "-- $n$random 1 100$n$\n"
+  "select generate_series(1, :n::int);\n";
+
+// -----------------------------------------------------------------------------
+// Script
+// -----------------------------------------------------------------------------
+
+/// The generator of the values of the parameter.
+struct Generator final {
+  std::string name;
+  std::optional<std::pair<long long, long long>> range;
+  std::string value; // the constant value if `!range`
+
+  std::string operator()(std::mt19937_64& rng) const
+  {
+    if (range)
+      return std::to_string(std::uniform_int_distribution<long long>{
+          range->first, range->second}(rng));
+    else
+      return value;
+  }
+};
+
+/// The statement of the script along with its weight and generators.
+struct Script_statement final {
+  pgfe::Statement statement;
+  unsigned weight{1};
+  std::vector<Generator> generators;
+};
+
+Generator make_generator(std::string name, const std::string& spec)
+{
+  Generator result{std::move(name), std::nullopt, spec};
+  std::istringstream stream{spec};
+  std::string kind;
+  long long min{}, max{};
+  if (stream >> kind && kind == "random") {
+    if (!(stream >> min >> max) || min > max)
+      throw std::runtime_error{"invalid generator of parameter :" +
+        result.name + ": " + spec};
+    result.range = std::make_pair(min, max);
+  }
+  return result;
+}
+
+std::vector<Script_statement> parse_script(const std::string& text)
+{
+  std::vector<Script_statement> result;
+  pgfe::Statement_vector statements{text};
+  for (auto& statement : statements.vector()) {
+    if (statement.is_query_empty())
+      continue;
+
+    Script_statement s;
+    const auto& extra = statement.extra();
+    if (const auto i = extra.field_index("weight"); i < extra.field_count())
+      s.weight = static_cast<unsigned>(std::stoul(
+          pgfe::to<std::string>(extra.data(i))));
+    for (auto i = statement.positional_parameter_count();
+         i < statement.parameter_count(); ++i) {
+      std::string name{statement.parameter_name(i)};
+      if (statement.is_parameter_literal(i) ||
+        statement.is_parameter_identifier(i))
+        throw std::runtime_error{"quoted parameter :" + name +
+          " is not supported"};
+      const auto j = extra.field_index(name);
+      if (!(j < extra.field_count()))
+        throw std::runtime_error{"no generator of parameter :" + name};
+      s.generators.push_back(make_generator(std::move(name),
+          pgfe::to<std::string>(extra.data(j))));
+    }
+    s.statement = std::move(statement);
+    result.push_back(std::move(s));
+  }
+  if (result.empty())
+    throw std::runtime_error{"script is empty"};
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Worker
+// -----------------------------------------------------------------------------
+
+/// The results of the worker.
+struct Stats final {
+  std::exception_ptr failure; // the failure of reconnection
+  std::uint_least64_t error_count{};
+  std::vector<std::chrono::nanoseconds> latencies;
+};
+
+class Worker final {
+public:
+  Worker(pgfe::Connection_pool& pool,
+    const std::vector<Script_statement>& script,
+    const std::size_t pipeline_depth, const unsigned seed)
+    : conn_{pool.connection()}
+    , script_{script}
+    , pipeline_depth_{pipeline_depth}
+    , rng_{seed}
+  {
+    std::vector<unsigned> weights;
+    for (const auto& s : script_)
+      weights.push_back(s.weight);
+    pick_ = std::discrete_distribution<std::size_t>{weights.cbegin(),
+      weights.cend()};
+    prepare();
+  }
+
+  void run(const Clock::time_point deadline, Stats& stats)
+  {
+    while (Clock::now() < deadline) {
+      try {
+        if (pipeline_depth_ > 1)
+          run_pipelined(stats);
+        else
+          run_single(stats);
+      } catch (const std::exception&) {
+        // Start over on the new session.
+        ++stats.error_count;
+        conn_->disconnect();
+        conn_->connect();
+        prepare();
+      }
+    }
+  }
+
+private:
+  pgfe::Connection_pool::Handle conn_;
+  const std::vector<Script_statement>& script_;
+  std::size_t pipeline_depth_{};
+  std::mt19937_64 rng_;
+  std::discrete_distribution<std::size_t> pick_;
+  std::vector<pgfe::Prepared_statement> prepared_;
+
+  void prepare()
+  {
+    prepared_.clear();
+    for (std::size_t i{}; i < script_.size(); ++i)
+      prepared_.push_back(conn_->prepare(script_[i].statement,
+          "pgfe_load_" + std::to_string(i)));
+    if (pipeline_depth_ > 1)
+      conn_->set_pipeline_enabled(true);
+  }
+
+  pgfe::Prepared_statement& next()
+  {
+    const auto index = pick_(rng_);
+    auto& result = prepared_[index];
+    for (const auto& generator : script_[index].generators)
+      result.bind(generator.name, generator(rng_));
+    return result;
+  }
+
+  void run_single(Stats& stats)
+  {
+    auto& ps = next();
+    const auto start = Clock::now();
+    ps.execute();
+    stats.latencies.push_back(Clock::now() - start);
+  }
+
+  void run_pipelined(Stats& stats)
+  {
+    const auto start = Clock::now();
+    for (std::size_t i{}; i < pipeline_depth_; ++i)
+      next().execute_nio();
+    conn_->send_sync();
+    for (std::size_t i{}; i < pipeline_depth_; ++i) {
+      conn_->process_responses([](pgfe::Row&&){});
+      stats.latencies.push_back(Clock::now() - start);
+    }
+    conn_->wait_response_throw(); // the synchronization point
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Report
+// -----------------------------------------------------------------------------
+
+double to_ms(const std::chrono::nanoseconds value)
+{
+  return static_cast<double>(value.count()) / 1e6;
+}
+
+void report(std::vector<std::chrono::nanoseconds>& latencies,
+  const std::uint_least64_t error_count, const std::chrono::nanoseconds elapsed)
+{
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](const double p)
+  {
+    if (latencies.empty())
+      return std::chrono::nanoseconds::zero();
+    const auto index = static_cast<std::size_t>(p / 100 *
+      static_cast<double>(latencies.size() - 1));
+    return latencies[index];
+  };
+  const double seconds = static_cast<double>(elapsed.count()) / 1e9;
+  std::cout << std::fixed << std::setprecision(3)
+            << "statements: " << latencies.size() << '\n'
+            << "errors: " << error_count << '\n'
+            << "throughput: " << std::setprecision(0)
+            << static_cast<double>(latencies.size()) / seconds
+            << " statements/s\n" << std::setprecision(3)
+            << "latency p50: " << to_ms(percentile(50)) << " ms\n"
+            << "latency p90: " << to_ms(percentile(90)) << " ms\n"
+            << "latency p99: " << to_ms(percentile(99)) << " ms\n"
+            << "latency p99.9: " << to_ms(percentile(99.9)) << " ms\n"
+            << "latency max: " << to_ms(percentile(100)) << " ms" << std::endl;
+}
+
+} // namespace
+
+int main(const int argc, char* const argv[])
+try {
+  std::string script_text{default_script};
+  if (argc >= 2) {
+    std::ifstream file{argv[1], std::ios_base::binary};
+    if (!file)
+      throw std::runtime_error{"cannot open " + std::string{argv[1]}};
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    script_text = stream.str();
+  }
+  const std::size_t thread_count{(argc >= 3) ? std::stoul(argv[2]) : 4};
+  const std::chrono::seconds duration{(argc >= 4) ? std::stol(argv[3]) : 10};
+  const std::size_t pipeline_depth{(argc >= 5) ? std::stoul(argv[4]) : 1};
+  if (!thread_count || !pipeline_depth)
+    throw std::runtime_error{"invalid thread count or pipeline depth"};
+
+  const auto script = parse_script(script_text);
+  pgfe::Connection_pool pool{thread_count, pgfe::test::connection_options()};
+  pool.connect();
+
+  std::vector<Worker> workers;
+  workers.reserve(thread_count);
+  for (std::size_t i{}; i < thread_count; ++i)
+    workers.emplace_back(pool, script, pipeline_depth,
+      static_cast<unsigned>(i));
+
+  std::cout << "threads: " << thread_count << '\n'
+            << "duration: " << duration.count() << " s\n"
+            << "pipeline depth: " << pipeline_depth << std::endl;
+
+  std::vector<Stats> stats(thread_count);
+  std::vector<std::thread> threads;
+  const auto start = Clock::now();
+  const auto deadline = start + duration;
+  for (std::size_t i{}; i < thread_count; ++i)
+    threads.emplace_back([&workers, &stats, deadline, i]
+    {
+      try {
+        workers[i].run(deadline, stats[i]);
+      } catch (...) {
+        stats[i].failure = std::current_exception();
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  const auto elapsed = Clock::now() - start;
+
+  std::vector<std::chrono::nanoseconds> latencies;
+  std::uint_least64_t error_count{};
+  for (auto& s : stats) {
+    if (s.failure)
+      std::rethrow_exception(s.failure);
+    latencies.insert(latencies.end(), s.latencies.cbegin(), s.latencies.cend());
+    error_count += s.error_count;
+  }
+  report(latencies, error_count, elapsed);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -18,7 +18,9 @@
 
 #include <libpq-fe.h>
 
+#include <cstddef>
 #include <new>
+#include <string>
 
 const char* const query = "select generate_series(1,1000000)";
 
@@ -96,13 +98,12 @@ void test_pgfe()
   conn.execute([](auto&& r) { auto d = r.data(); }, query);
 }
 
-int main()
+int main(const int argc, char* const argv[])
 {
-  using dmitigr::util::with_measure;
-  std::cout << "Pq: ";
-  const auto elapsed_pq = with_measure(test_pq);
-  std::cout << elapsed_pq.count() << std::endl;
-  std::cout << "Pgfe: ";
-  const auto elapsed_pgfe = with_measure(test_pgfe);
-  std::cout << elapsed_pgfe.count() << std::endl;
+  using dmitigr::util::Benchmark;
+  const std::size_t iteration_count{(argc >= 2) ? std::stoul(argv[1]) : 1};
+  std::cout << Benchmark{"pq"}.set_iteration_count(iteration_count)
+    .run(test_pq) << std::endl;
+  std::cout << Benchmark{"pgfe"}.set_iteration_count(iteration_count)
+    .run(test_pgfe) << std::endl;
 }
@@ -0,0 +1,120 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+
+void* operator new(const std::size_t size)
+{
+  dmitigr::pgfe::record_allocation(size);
+  if (void* const result = std::malloc(size ? size : 1))
+    return result;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* const ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::Allocation_category;
+  using pgfe::allocation_counters;
+
+  const std::string long_string(1000, 'x');
+
+  // Conversions.
+  {
+    pgfe::reset_allocation_counters();
+    const auto data = pgfe::to_data(long_string);
+    const auto str = pgfe::to<std::string>(*data);
+    DMITIGR_ASSERT(str == long_string);
+    const auto counters = allocation_counters(Allocation_category::conversion);
+    if constexpr (pgfe::is_allocation_tracking_enabled()) {
+      DMITIGR_ASSERT(counters.count >= 2);
+      DMITIGR_ASSERT(counters.bytes >= 2 * long_string.size());
+    } else {
+      DMITIGR_ASSERT(!counters.count);
+      DMITIGR_ASSERT(!counters.bytes);
+    }
+    DMITIGR_ASSERT(!allocation_counters(Allocation_category::bind).count);
+  }
+
+  // Bind.
+  {
+    pgfe::reset_allocation_counters();
+    pgfe::Statement s{"SELECT :p"};
+    s.bind("p", long_string);
+    const auto counters = allocation_counters(Allocation_category::bind);
+    if constexpr (pgfe::is_allocation_tracking_enabled())
+      DMITIGR_ASSERT(counters.bytes >= long_string.size());
+    else
+      DMITIGR_ASSERT(!counters.count);
+  }
+
+  // Allocations outside of operations are not counted.
+  {
+    pgfe::reset_allocation_counters();
+    const std::string str{long_string};
+    DMITIGR_ASSERT(str.size() == long_string.size());
+    for (std::size_t i{}; i < pgfe::allocation_category_count; ++i) {
+      const auto counters = allocation_counters(
+        static_cast<Allocation_category>(i));
+      DMITIGR_ASSERT(!counters.count);
+      DMITIGR_ASSERT(!counters.bytes);
+    }
+  }
+
+  // Nested scopes don't change the category.
+  {
+    pgfe::reset_allocation_counters();
+    {
+      const pgfe::detail::Allocation_scope scope{Allocation_category::error};
+      const auto data = pgfe::to_data(long_string);
+      DMITIGR_ASSERT(data->size() == long_string.size());
+    }
+    DMITIGR_ASSERT(!allocation_counters(Allocation_category::conversion).count);
+    if constexpr (pgfe::is_allocation_tracking_enabled())
+      DMITIGR_ASSERT(allocation_counters(Allocation_category::error).count);
+  }
+
+  // Categories are per thread.
+  {
+    const pgfe::detail::Allocation_scope scope{Allocation_category::error};
+    std::thread{[]
+    {
+      DMITIGR_ASSERT(pgfe::detail::current_allocation_category() == -1);
+    }}.join();
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,171 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#define ASSERT DMITIGR_ASSERT
+
+namespace {
+
+template<typename T>
+T value(const ArrowArray& array, const std::size_t index)
+{
+  T result;
+  std::memcpy(&result, static_cast<const char*>(array.buffers[1]) +
+    index * sizeof(T), sizeof(T));
+  return result;
+}
+
+bool is_valid(const ArrowArray& array, const std::size_t index)
+{
+  return !array.buffers[0] ||
+    static_cast<const std::uint8_t*>(array.buffers[0])[index / 8] & (1 << index % 8);
+}
+
+std::string_view string(const ArrowArray& array, const std::size_t index)
+{
+  const auto* const offsets = static_cast<const std::int32_t*>(array.buffers[1]);
+  return {static_cast<const char*>(array.buffers[2]) + offsets[index],
+    static_cast<std::size_t>(offsets[index + 1] - offsets[index])};
+}
+
+} // namespace
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("set time zone 'UTC'");
+  conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+
+  const auto check = [](ArrowArray& array, ArrowSchema& schema)
+  {
+    ASSERT(std::string_view{schema.format} == "+s");
+    ASSERT(schema.n_children == 14);
+    ASSERT(array.length == 2);
+    ASSERT(array.n_children == 14);
+    for (int i{}; i < array.n_children; ++i) {
+      ASSERT(array.children[i]->length == 2);
+      ASSERT(array.children[i]->null_count == 1);
+      ASSERT(is_valid(*array.children[i], 0));
+      ASSERT(!is_valid(*array.children[i], 1));
+      ASSERT(schema.children[i]->flags == ARROW_FLAG_NULLABLE);
+    }
+    const auto format = [&schema](const int i)
+    {
+      return std::string_view{schema.children[i]->format};
+    };
+    ASSERT(std::string_view{schema.children[0]->name} == "b");
+    ASSERT(format(0) == "b");
+    ASSERT(*static_cast<const std::uint8_t*>(array.children[0]->buffers[1]) == 1);
+    ASSERT(format(1) == "s" && value<std::int16_t>(*array.children[1], 0) == 1);
+    ASSERT(format(2) == "i" && value<std::int32_t>(*array.children[2], 0) == 2);
+    ASSERT(format(3) == "l" && value<std::int64_t>(*array.children[3], 0) == 3);
+    ASSERT(format(4) == "f" && value<float>(*array.children[4], 0) == 1.5);
+    ASSERT(format(5) == "g" && value<double>(*array.children[5], 0) == 2.5);
+    ASSERT(format(6) == "tdD" && value<std::int32_t>(*array.children[6], 0) == 10958);
+    ASSERT(format(7) == "tsu:" &&
+      value<std::int64_t>(*array.children[7], 0) == 946684801000000);
+    ASSERT(format(8) == "tsu:UTC" &&
+      value<std::int64_t>(*array.children[8], 0) == 946684801000000);
+    ASSERT(format(9) == "w:16");
+    ASSERT(!std::memcmp(array.children[9]->buffers[1],
+        pgfe::Uuid::from_string("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11")
+        .bytes().data(), 16));
+    ASSERT(format(10) == "u" && string(*array.children[10], 0) == "dmitigr");
+    ASSERT(string(*array.children[10], 1).empty());
+    ASSERT(format(11) == "z" && string(*array.children[11], 0) == "\x01\x02");
+    ASSERT(format(12) == "u" && string(*array.children[12], 0) == "12.5");
+    ASSERT(format(13) == "u" && string(*array.children[13], 0) == R"({"a": 1})");
+
+    schema.release(&schema);
+    ASSERT(!schema.release);
+    array.release(&array);
+    ASSERT(!array.release);
+  };
+
+  for (const auto format : {pgfe::Data_format::text, pgfe::Data_format::binary}) {
+    conn->set_result_format(format);
+    conn->execute([&check](pgfe::Row_batch&& batch)
+    {
+      pgfe::Arrow_batch_builder builder{batch.info()};
+      ASSERT(builder.fields().size() == 14);
+      ASSERT(builder.fields()[0].name == "b");
+      ASSERT(builder.fields()[0].type == 16);
+      builder.append(batch);
+      ASSERT(builder.row_count() == 2);
+
+      ArrowArray array;
+      ArrowSchema schema;
+      builder.release(array, schema);
+      ASSERT(!builder.row_count());
+      check(array, schema);
+
+      // The builder is reusable.
+      builder.append(batch);
+      builder.release(array, schema);
+      check(array, schema);
+    }, R"(select * from (values
+      (true, 1::int2, 2::int4, 3::int8, 1.5::float4, 2.5::float8,
+      '2000-01-02'::date, '2000-01-01 00:00:01'::timestamp,
+      '2000-01-01 00:00:01+00'::timestamptz,
+      'a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11'::uuid, 'dmitigr'::text,
+      '\x0102'::bytea, 12.5::numeric, '{"a":1}'::jsonb),
+      (null, null, null, null, null, null, null, null, null, null, null, null,
+      null, null)) t(b, i2, i4, i8, f4, f8, d, ts, tstz, u, t, ba, n, j))");
+  }
+  conn->set_result_format(pgfe::Data_format::text);
+  conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+
+  // Failed append doesn't affect the rows appended.
+  {
+    pgfe::Arrow_batch_builder builder{{{"i", 23, pgfe::Data_format::text}}};
+    conn->execute([&builder](pgfe::Row&& row)
+    {
+      builder.append(row);
+    }, "select 1");
+    ASSERT(builder.row_count() == 1);
+    conn->execute([&builder](pgfe::Row&& row)
+    {
+      ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+      {
+        builder.append(row);
+      }));
+    }, "select 'a'");
+    ASSERT(builder.row_count() == 1);
+    ArrowArray array;
+    ArrowSchema schema;
+    builder.release(array, schema);
+    ASSERT(array.length == 1);
+    ASSERT(array.children[0]->length == 1);
+    ASSERT(value<std::int32_t>(*array.children[0], 0) == 1);
+    schema.release(&schema);
+    array.release(&array);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,133 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  auto conn = pgfe::test::make_connection();
+
+  // Offline.
+  {
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      pgfe::Batch_insert{*conn, "", {"a"}};
+    }));
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      pgfe::Batch_insert{*conn, "tab", {}};
+    }));
+
+    pgfe::Batch_insert insert{*conn, "tab", {"a", "b", "c"}};
+    ASSERT(insert.column_count() == 3);
+    ASSERT(insert.max_chunk_row_count() == 65535 / 3);
+    insert.set_max_chunk_row_count(100);
+    ASSERT(insert.max_chunk_row_count() == 100);
+    insert.set_max_chunk_row_count(std::nullopt);
+    ASSERT(insert.max_chunk_row_count() == 65535 / 3);
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      insert.set_max_chunk_row_count(0);
+    }));
+
+    ASSERT(insert.is_empty());
+    insert.add(1, "one", nullptr);
+    insert.add(2, std::string{"two"}, std::optional<int>{});
+    ASSERT(insert.row_count() == 2);
+    ASSERT(with_catch<pgfe::Client_exception>([&]{insert.add(3, "three");}));
+    ASSERT(insert.row_count() == 2);
+    ASSERT(with_catch<pgfe::Client_exception>([&]{insert.flush();}));
+    ASSERT(insert.is_empty());
+  }
+
+  conn->connect();
+  conn->execute("create temp table batch_insert_test"
+    "(id integer primary key, name text, score real)");
+
+  // Insert with the chunks of the various sizes.
+  {
+    pgfe::Batch_insert insert{*conn, "batch_insert_test", {"id", "name", "score"}};
+    insert.set_max_chunk_row_count(64);
+    for (int i{1}; i <= 1000; ++i)
+      insert.add(i, "name" + std::to_string(i),
+        i % 2 ? std::optional<float>{} : std::optional<float>{i / 2.f});
+    const auto result = insert.flush();
+    ASSERT(result.is_ok());
+    ASSERT(result.execution_count() == 15 + 2); // 15 * 64 + 32 + 8
+    ASSERT(result.row_count() == 1000);
+    ASSERT(insert.is_empty());
+    conn->execute([](auto&& row)
+    {
+      ASSERT(pgfe::to<long long>(row[0]) == 1000);
+      ASSERT(pgfe::to<long long>(row[1]) == 500);
+      ASSERT(pgfe::to<std::string>(row[2]) == "name1000");
+    }, "select count(*), count(score), max(name) filter (where id = 1000)"
+      " from batch_insert_test");
+
+    // The statements are reused.
+    for (int i{1001}; i <= 1010; ++i)
+      insert.add(i, "name", nullptr);
+    ASSERT(insert.flush().row_count() == 10);
+  }
+
+  // ON CONFLICT and RETURNING.
+  {
+    pgfe::Batch_insert insert{*conn, "batch_insert_test", {"id", "name"},
+      "on conflict (id) do nothing returning id"};
+    insert.add(1, "dup").add(2000, "new").add(2001, "new");
+    std::vector<int> ids;
+    const auto result = insert.flush([&ids](pgfe::Row&& row)
+    {
+      ids.push_back(pgfe::to<int>(row[0]));
+    });
+    ASSERT(result.is_ok());
+    ASSERT(result.row_count() == 2);
+    ASSERT((ids == std::vector<int>{2000, 2001}));
+  }
+
+  // Error.
+  {
+    pgfe::Batch_insert insert{*conn, "batch_insert_test", {"id"}};
+    insert.set_max_chunk_row_count(2);
+    insert.add(5000).add(5001).add(1).add(5002).add(5003);
+    const auto result = insert.flush();
+    ASSERT(!result.is_ok());
+    ASSERT(result.errors().size() == 1);
+    ASSERT(result.errors()[0].first == 1);
+    ASSERT(result.aborted_count() == 1);
+    ASSERT(conn->is_ready_for_request());
+    conn->execute([](auto&& row)
+    {
+      ASSERT(pgfe::to<long long>(row[0]) == 0);
+    }, "select count(*) from batch_insert_test where id >= 5000");
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,67 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/pgfe/statement.hpp"
+#include "../../src/util/diagnostic.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(const int argc, char* const argv[])
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  std::string input{"-- $id$benchmark$id$\nSELECT "};
+  for (int i{}; i < 64; ++i) {
+    const auto n = std::to_string(i);
+    input.append("t.c").append(n).append(" + :p").append(n)
+      .append(" /* c").append(n).append(" */, ");
+  }
+  input.append("$1 FROM :tab t WHERE t.id = :id");
+
+  const unsigned long iteration_count{(argc >= 2) ? std::stoul(argv[1]) : 1};
+  const auto measure = [iteration_count](const char* const name, auto&& f)
+  {
+    std::cout << dmitigr::util::Benchmark{name}
+      .set_iteration_count(iteration_count)
+      .run(f) << std::endl;
+  };
+
+  pgfe::Statement s;
+  measure("parse", [&s, &input]
+  {
+    s = input;
+  });
+
+  pgfe::Statement copy;
+  measure("copy", [&s, &copy]
+  {
+    copy = s;
+  });
+
+  measure("replace", [&s, &copy]
+  {
+    copy = s;
+    copy.replace_parameter("tab", "table1");
+    copy.replace_parameter("id", "$2");
+  });
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
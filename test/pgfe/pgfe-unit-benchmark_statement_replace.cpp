@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "../../src/pgfe/statement.hpp"
+#include "../../src/util/diagnostic.hpp"
 
 #include <iostream>
 
@@ -23,13 +24,16 @@ try {
   namespace pgfe = dmitigr::pgfe;
   pgfe::Statement s;
   const unsigned long iteration_count{(argc >= 2) ? std::stoul(argv[1]) : 1};
-  for (unsigned long i{}; i < iteration_count; ++i) {
-    s = "SELECT :list_ FROM :t1_ t1 JOIN :t2_ t2 ON (t1.t2 = t2.id) WHERE :where_";
-    s.replace_parameter("list_", "t1.id id, t1.age age, t2.dat dat");
-    s.replace_parameter("t1_", "table1");
-    s.replace_parameter("t2_", "table2");
-    s.replace_parameter("where_", "t1.nm = :nm AND t2.age = :age");
-  }
+  std::cout << dmitigr::util::Benchmark{"replace"}
+    .set_iteration_count(iteration_count)
+    .run([&s]
+    {
+      s = "SELECT :list_ FROM :t1_ t1 JOIN :t2_ t2 ON (t1.t2 = t2.id) WHERE :where_";
+      s.replace_parameter("list_", "t1.id id, t1.age age, t2.dat dat");
+      s.replace_parameter("t1_", "table1");
+      s.replace_parameter("t2_", "table2");
+      s.replace_parameter("where_", "t1.nm = :nm AND t2.age = :age");
+    }) << std::endl;
   const auto modified_string = s.to_string();
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
@@ -17,7 +17,28 @@
 #include "../../src/base/assert.hpp"
 #include "../../src/pgfe/conversions.hpp"
 #include "../../src/pgfe/data.hpp"
+#include "../../src/pgfe/row_mapping.hpp"
 #include "../../src/pgfe/tuple.hpp"
+#include "../../src/util/diagnostic.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace {
+
+struct Point final {
+  int x{};
+  std::optional<std::string> label;
+};
+
+} // namespace
+
+template<> struct dmitigr::pgfe::Row_mapping<Point> final {
+  static constexpr auto fields = std::make_tuple(
+    mapped_field("x", &Point::x),
+    mapped_field("label", &Point::label));
+};
 
 int main()
 {
@@ -129,6 +150,124 @@ int main()
       ASSERTMENTS;
 #undef ASSERTMENTS
     }
+
+    // -------------------------------------------------------------------------
+    // Compact storage
+    // -------------------------------------------------------------------------
+
+    {
+      pgfe::Tuple t;
+      for (int i{}; i < 20; ++i)
+        t.append("f" + std::to_string(i), i);
+      t.append("f0", "dup");
+      t.append("null", nullptr);
+      DMITIGR_ASSERT(!t.is_compact());
+      t.compact();
+      DMITIGR_ASSERT(t.is_compact());
+      DMITIGR_ASSERT(t.field_count() == 22);
+      DMITIGR_ASSERT(t.field_name(19) == "f19");
+      DMITIGR_ASSERT(t.field_index("f19") == 19);
+      DMITIGR_ASSERT(t.field_index("f0") == 0);
+      DMITIGR_ASSERT(t.field_index("f0", 1) == 20);
+      DMITIGR_ASSERT(t.field_index("none") == t.field_count());
+      DMITIGR_ASSERT(pgfe::to<int>(t.data("f7")) == 7);
+      DMITIGR_ASSERT(pgfe::to<std::string_view>(t.data(20)) == "dup");
+      DMITIGR_ASSERT(!t.data("null"));
+
+      // Copying shares the storage.
+      const pgfe::Tuple copy{t};
+      DMITIGR_ASSERT(copy.is_compact());
+      DMITIGR_ASSERT(copy.data(3).bytes() == t.data(3).bytes());
+      DMITIGR_ASSERT(copy == t);
+      DMITIGR_ASSERT(copy.is_field_names_shared(t));
+
+      // Modifying expands the storage.
+      t.set("f1", 100);
+      DMITIGR_ASSERT(!t.is_compact());
+      DMITIGR_ASSERT(!copy.is_field_names_shared(t));
+      DMITIGR_ASSERT(t.field_count() == 22);
+      DMITIGR_ASSERT(pgfe::to<int>(t.data("f1")) == 100);
+      DMITIGR_ASSERT(pgfe::to<int>(copy.data("f1")) == 1);
+      DMITIGR_ASSERT(!t.data("null"));
+      DMITIGR_ASSERT(t.field_index("f0", 1) == 20);
+      t.compact();
+      t.remove("f0");
+      DMITIGR_ASSERT(!t.is_compact());
+      DMITIGR_ASSERT(t.field_index("f0") == 19);
+    }
+
+    // -------------------------------------------------------------------------
+    // Binary records
+    // -------------------------------------------------------------------------
+
+    {
+      using dmitigr::util::with_catch;
+      using pgfe::Data_format;
+
+      const auto append_int4 = [](std::string& result, const std::uint32_t value)
+      {
+        for (int shift{24}; shift >= 0; shift -= 8)
+          result += static_cast<char>((value >> shift) & 0xff);
+      };
+
+      // The record of (int4 42, text NULL, text 'dmitigr').
+      std::string record;
+      append_int4(record, 3);
+      append_int4(record, 23);
+      append_int4(record, 4);
+      append_int4(record, 42);
+      append_int4(record, 25);
+      append_int4(record, static_cast<std::uint32_t>(-1));
+      append_int4(record, 25);
+      append_int4(record, 7);
+      record += "dmitigr";
+
+      const auto data = pgfe::Data::make(record, Data_format::binary);
+      auto t = pgfe::to<pgfe::Tuple>(*data);
+      DMITIGR_ASSERT(t.is_compact());
+      DMITIGR_ASSERT(t.field_count() == 3);
+      DMITIGR_ASSERT(t.field_index("") == 0);
+      DMITIGR_ASSERT(t.field_index("", 2) == 2);
+      DMITIGR_ASSERT(t.field_name(0).empty());
+      DMITIGR_ASSERT(t.data(0).format() == Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<int>(t.data(0)) == 42);
+      DMITIGR_ASSERT(!t.data(1));
+      DMITIGR_ASSERT(pgfe::to<std::string_view>(t.data(2)) == "dmitigr");
+      const pgfe::Tuple copy{t};
+      DMITIGR_ASSERT(!copy.data(1));
+      DMITIGR_ASSERT(t.vector().size() == 3);
+      DMITIGR_ASSERT(!t.is_compact());
+      const pgfe::Tuple expanded_copy{t};
+      DMITIGR_ASSERT(!expanded_copy.data(1));
+
+      // Mapping.
+      t.vector()[0].first = "x";
+      t.vector()[1].first = "label";
+      auto point = pgfe::map_composite<Point>(t);
+      DMITIGR_ASSERT(point.x == 42);
+      DMITIGR_ASSERT(!point.label);
+      t.remove("x");
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&t]
+      {
+        pgfe::map_composite<Point>(t);
+      }));
+
+      // Invalid records.
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&record]
+      {
+        pgfe::to<pgfe::Tuple>(*pgfe::Data::make(record, Data_format::text));
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&record]
+      {
+        pgfe::to<pgfe::Tuple>(*pgfe::Data::make(record.substr(0,
+              record.size() - 1), Data_format::binary));
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&record]
+      {
+        pgfe::to<pgfe::Tuple>(*pgfe::Data::make(record + 'x',
+            Data_format::binary));
+      }));
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
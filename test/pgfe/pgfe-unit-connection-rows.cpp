@@ -16,6 +16,9 @@
 
 #include "pgfe-unit.hpp"
 
+#include <thread>
+#include <vector>
+
 struct Person final {
   int id;
   std::string name;
@@ -47,6 +50,17 @@ template<> struct Conversions<Person> final {
 
 } // namespace dmitigr::pgfe
 
+struct Named_age final {
+  std::string name;
+  int age{};
+};
+
+template<> struct dmitigr::pgfe::Row_mapping<Named_age> final {
+  static constexpr auto fields = std::make_tuple(
+    mapped_field("name", &Named_age::name),
+    mapped_field("age", &Named_age::age));
+};
+
 int main()
 try {
   namespace pgfe = dmitigr::pgfe;
@@ -122,6 +136,111 @@ try {
 
     conn->execute("rollback");
   }
+
+  // Test 1d.
+  {
+    std::cout << "From rows delivered in full row delivery mode:" << std::endl;
+    conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+    DMITIGR_ASSERT(conn->row_delivery_mode() == pgfe::Row_delivery_mode::full);
+    std::vector<Person> persons;
+    const auto comp = conn->execute([&persons](auto&& row)
+    {
+      persons.emplace_back(pgfe::to<Person>(std::move(row)));
+    }, "select * from person order by id");
+    DMITIGR_ASSERT(comp.tag() == "SELECT");
+    DMITIGR_ASSERT(comp.row_count() == 2);
+    DMITIGR_ASSERT(persons.size() == 2);
+    DMITIGR_ASSERT(persons[0].name == "Alla");
+    DMITIGR_ASSERT(persons[1].name == "Bella");
+    conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+  }
+
+  // Test 1e.
+  {
+    std::cout << "From rows delivered in batches:" << std::endl;
+    conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+    std::vector<std::string> names;
+    std::size_t batch_count{};
+    conn->execute([&names, &batch_count](pgfe::Row_batch&& batch)
+    {
+      DMITIGR_ASSERT(batch);
+      DMITIGR_ASSERT(batch.row_count() == 2);
+      DMITIGR_ASSERT(batch.field_count() == 3);
+      DMITIGR_ASSERT(pgfe::to<int>(batch.data(0, "id")) == 1);
+      for (const auto& data : batch.column("name"))
+        names.emplace_back(pgfe::to<std::string>(data));
+      ++batch_count;
+    }, "select * from person order by id");
+    DMITIGR_ASSERT(batch_count == 1);
+    DMITIGR_ASSERT(names.size() == 2);
+    DMITIGR_ASSERT(names[0] == "Alla");
+    DMITIGR_ASSERT(names[1] == "Bella");
+
+    // Sharing the batch among threads.
+    std::vector<pgfe::Row_batch> shared;
+    conn->execute([&shared](pgfe::Row_batch&& batch)
+    {
+      for (int i{}; i < 4; ++i)
+        shared.push_back(batch.share());
+      DMITIGR_ASSERT(batch.is_shared());
+    }, "select generate_series(1, 1000)");
+    conn->execute("select 1"); // the connection proceeds
+    std::vector<std::thread> workers;
+    std::vector<long> sums(shared.size());
+    for (std::size_t i{}; i < shared.size(); ++i) {
+      workers.emplace_back([batch = std::move(shared[i]), &sum = sums[i]]
+      {
+        DMITIGR_ASSERT(batch.row_count() == 1000);
+        for (const auto& data : batch.column(0))
+          sum += pgfe::to<long>(data);
+      });
+    }
+    for (auto& worker : workers)
+      worker.join();
+    for (const auto sum : sums)
+      DMITIGR_ASSERT(sum == 500500);
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([]
+    {
+      pgfe::Row_batch{}.share();
+    }));
+    conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+  }
+
+  // Test 1f.
+  {
+    std::cout << "Fetched into containers:" << std::endl;
+    std::vector<Named_age> persons;
+    auto comp = conn->fetch_into(persons,
+      "select name, age from person order by id");
+    DMITIGR_ASSERT(comp.row_count() == 2);
+    DMITIGR_ASSERT(persons.size() == 2);
+    DMITIGR_ASSERT(persons[0].name == "Alla" && persons[0].age == 30);
+    DMITIGR_ASSERT(persons[1].name == "Bella" && persons[1].age == 33);
+    DMITIGR_ASSERT(conn->row_delivery_mode() == pgfe::Row_delivery_mode::single);
+
+    std::vector<long> numbers{0};
+    conn->fetch_into(numbers, "select generate_series(1, $1)", 1000);
+    DMITIGR_ASSERT(numbers.size() == 1001);
+    DMITIGR_ASSERT(numbers.back() == 1000);
+
+    std::vector<std::string> names;
+    std::vector<std::optional<int>> ages;
+    comp = conn->fetch_columns(std::tie(names, ages),
+      "select name, nullif(age, 33) from person order by id");
+    DMITIGR_ASSERT(comp.row_count() == 2);
+    DMITIGR_ASSERT(names.size() == 2 && ages.size() == 2);
+    DMITIGR_ASSERT(names[1] == "Bella");
+    DMITIGR_ASSERT(ages[0] == 30 && !ages[1]);
+
+    bool is_thrown{};
+    try {
+      conn->fetch_columns(std::tie(names), "select name, age from person");
+    } catch (const pgfe::Client_exception&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+    DMITIGR_ASSERT(conn->is_ready_for_request());
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -17,6 +17,9 @@
 #include "pgfe-unit.hpp"
 
 #include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
 
 int main()
 try {
@@ -26,6 +29,7 @@ try {
   using pgfe::Connection_status;
   using pgfe::Transaction_status;
   using pgfe::Row_processing;
+  using dmitigr::util::with_catch;
   using pgfe::to;
 
   // Initial state test
@@ -88,6 +92,21 @@ try {
     }
   }
 
+  // Connect to the first of candidates
+  {
+    auto bad_opts = pgfe::test::connection_options();
+    bad_opts.set_port(2345);
+    const auto opts = pgfe::test::connection_options();
+    auto conn = pgfe::connect_first({bad_opts, opts, bad_opts});
+    DMITIGR_ASSERT(conn.is_connected());
+    DMITIGR_ASSERT(conn.options().port() == opts.port());
+
+    try {
+      (void)pgfe::connect_first({bad_opts});
+      DMITIGR_ASSERT(false);
+    } catch (const pgfe::Client_exception&) {}
+  }
+
   // Connect to the pgfe_test database test
   {
     std::unique_ptr<pgfe::Connection> conn;
@@ -154,6 +173,19 @@ try {
       }
     }
 
+    // Completion tag parsed on demand test
+    {
+      auto comp = conn->execute("select generate_series(1, 3)");
+      pgfe::Completion moved{std::move(comp)};
+      DMITIGR_ASSERT(!comp);
+      DMITIGR_ASSERT(moved);
+      DMITIGR_ASSERT(moved.row_count() == 3);
+      DMITIGR_ASSERT(moved.tag() == "SELECT");
+      comp = std::move(moved);
+      DMITIGR_ASSERT(comp.tag() == "SELECT");
+      DMITIGR_ASSERT(comp.row_count() == 3);
+    }
+
     // Provoke the syntax error test
     {
       conn->execute("begin");
@@ -184,6 +216,36 @@ try {
       DMITIGR_ASSERT(conn->is_ready_for_request());
     }
 
+    // Exception-free execution test
+    {
+      auto r = conn->execute_nothrow("provoke syntax error");
+      DMITIGR_ASSERT(!r);
+      DMITIGR_ASSERT(r.err == pgfe::Server_errc::c42_syntax_error);
+      DMITIGR_ASSERT(!r.err.what().empty());
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+
+      int sum{};
+      r = conn->execute_nothrow([&sum](auto&& row)
+      {
+        sum += to<int>(row.data());
+      }, "select generate_series(1, 3)");
+      DMITIGR_ASSERT(r);
+      DMITIGR_ASSERT(r.res.tag() == "SELECT");
+      DMITIGR_ASSERT(sum == 6);
+
+      sum = 0;
+      r = conn->invoke_nothrow([&sum](auto&& row)
+      {
+        sum += to<int>(row.data());
+      }, "generate_series", 1, 4);
+      DMITIGR_ASSERT(r);
+      DMITIGR_ASSERT(sum == 10);
+
+      r = conn->invoke_nothrow("pgfe_no_such_function");
+      DMITIGR_ASSERT(r.err == pgfe::Server_errc::c42_undefined_function);
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+    }
+
       // Notice test (involving notice handler)
       {
         const auto old_notice_handler = conn->notice_handler();
@@ -197,6 +259,18 @@ try {
         const auto response_status = conn->handle_input(true);
         DMITIGR_ASSERT(response_status == pgfe::Response_status::ready);
         DMITIGR_ASSERT(handled);
+
+        // Filtering by severity.
+        int count{};
+        conn->set_notice_handler([&count](const pgfe::Notice&){++count;});
+        DMITIGR_ASSERT(!conn->notice_min_severity());
+        conn->set_notice_min_severity(pgfe::Problem_severity::warning);
+        DMITIGR_ASSERT(conn->notice_min_severity() == pgfe::Problem_severity::warning);
+        conn->execute("DO $$ BEGIN RAISE NOTICE 'n'; RAISE WARNING 'w'; END $$;");
+        DMITIGR_ASSERT(count == 1);
+        conn->set_notice_min_severity(std::nullopt);
+        conn->execute("DO $$ BEGIN RAISE NOTICE 'n'; RAISE WARNING 'w'; END $$;");
+        DMITIGR_ASSERT(count == 3);
         conn->set_notice_handler(old_notice_handler);
       }
 
@@ -490,6 +564,38 @@ try {
           DMITIGR_ASSERT(called);
         }
 
+        // Using the routine cache.
+        {
+          DMITIGR_ASSERT(!conn->is_routine_cache_enabled());
+          conn->set_routine_cache_enabled(true);
+          DMITIGR_ASSERT(conn->is_routine_cache_enabled());
+          int count{};
+          const auto check = [&count, &expected_result](auto&& r)
+          {
+            DMITIGR_ASSERT(to<std::string_view>(r["person_info"]) == expected_result);
+            ++count;
+          };
+          for (int i{}; i < 3; ++i) {
+            conn->invoke(check, "person_info", id, name, age);
+            conn->invoke(check, "person_info", a{"age", age}, a{"name", name},
+              a{"id", id});
+          }
+          DMITIGR_ASSERT(count == 6);
+          DMITIGR_ASSERT(conn->routine_cache_size() == 2);
+          DMITIGR_ASSERT(conn->describe("pgfe_routine_1"));
+          DMITIGR_ASSERT(conn->describe("pgfe_routine_2"));
+
+          // The deallocated statements are prepared again.
+          conn->execute("deallocate all");
+          conn->invoke(check, "person_info", id, name, age);
+          DMITIGR_ASSERT(count == 7);
+          DMITIGR_ASSERT(conn->routine_cache_size() == 2);
+
+          conn->clear_routine_cache();
+          DMITIGR_ASSERT(conn->routine_cache_size() == 0);
+          conn->set_routine_cache_enabled(false);
+        }
+
         conn->execute("rollback");
       }
 
@@ -509,11 +615,216 @@ try {
         DMITIGR_ASSERT(conn->result_format() == pgfe::Data_format::text);
       }
 
+      // Statement cache
+      {
+        DMITIGR_ASSERT(conn->statement_cache_capacity() == 0);
+        DMITIGR_ASSERT(conn->statement_cache_threshold() == 5);
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&conn]
+        {
+          conn->set_statement_cache_threshold(0);
+        }));
+        conn->set_statement_cache_capacity(2);
+        conn->set_statement_cache_threshold(1);
+        const auto prepared_count = [&conn]
+        {
+          std::int64_t result{};
+          conn->execute([&result](auto&& r)
+          {
+            result = to<std::int64_t>(r[0]);
+          }, "SELECT count(*) FROM pg_prepared_statements");
+          return result;
+        };
+        conn->execute("SELECT $1::integer", 1);
+        DMITIGR_ASSERT(conn->statement_cache_size() == 1);
+        DMITIGR_ASSERT(prepared_count() == 2);
+        conn->execute([](auto&& r)
+        {
+          DMITIGR_ASSERT(to<int>(r[0]) == 3);
+        }, "SELECT $1::integer", 3);
+        DMITIGR_ASSERT(conn->statement_cache_size() == 2);
+        // The least recently used statement is evicted.
+        conn->execute("SELECT 2");
+        DMITIGR_ASSERT(conn->statement_cache_size() == 2);
+        DMITIGR_ASSERT(prepared_count() == 2);
+        // DISCARD ALL clears the cache.
+        conn->execute("DISCARD ALL");
+        DMITIGR_ASSERT(conn->statement_cache_size() == 0);
+        DMITIGR_ASSERT(prepared_count() == 1);
+        conn->clear_statement_cache();
+        conn->set_statement_cache_capacity(0);
+        DMITIGR_ASSERT(conn->statement_cache_size() == 0);
+      }
+
+      // Metrics and tracing
+      {
+        DMITIGR_ASSERT(!conn->is_metrics_enabled());
+        conn->set_metrics_enabled(true);
+        std::vector<pgfe::Trace_event> events;
+        std::vector<std::string> queries;
+        conn->set_trace_handler([&events, &queries](const auto& e)
+        {
+          events.push_back(e);
+          queries.emplace_back(e.query);
+        });
+        conn->execute("SELECT generate_series(1, $1::integer)", 3);
+        DMITIGR_ASSERT(conn->metrics().request_count == 1);
+        DMITIGR_ASSERT(conn->metrics().row_count == 3);
+        DMITIGR_ASSERT(events.size() == 3);
+        DMITIGR_ASSERT(events[0].point == pgfe::Trace_point::request);
+        DMITIGR_ASSERT(events[0].request == pgfe::Trace_request::execute);
+        DMITIGR_ASSERT(events[0].parameter_count == 1);
+        DMITIGR_ASSERT(events[1].point == pgfe::Trace_point::first_row);
+        DMITIGR_ASSERT(events[2].point == pgfe::Trace_point::completion);
+        DMITIGR_ASSERT(events[2].row_count == 3);
+        DMITIGR_ASSERT(!events[2].is_failed);
+        DMITIGR_ASSERT(queries[2] == "SELECT generate_series(1, $1::integer)");
+        conn->set_trace_handler({});
+        {
+          // The default row delivery mode is single.
+          const auto& m = conn->metrics();
+          DMITIGR_ASSERT(m.first_response_time.count() == 1);
+          DMITIGR_ASSERT(m.row_streaming_time.count() == 1);
+          DMITIGR_ASSERT(m.wait_response_duration.count() >= 1);
+          DMITIGR_ASSERT(m.completion_count == 1);
+          DMITIGR_ASSERT(!m.error_count);
+        }
+        conn->execute("SELECT 1 WHERE false");
+        DMITIGR_ASSERT(conn->metrics().first_response_time.count() == 2);
+        DMITIGR_ASSERT(conn->metrics().row_streaming_time.count() == 1);
+        try {
+          conn->execute("SELECT 1/0");
+        } catch (const pgfe::Server_exception&) {}
+        DMITIGR_ASSERT(conn->metrics().error_count == 1);
+        conn->execute("DO $$BEGIN RAISE NOTICE 'notice'; END$$");
+        DMITIGR_ASSERT(conn->metrics().notice_count == 1);
+        DMITIGR_ASSERT(conn->metrics().completion_count == 3);
+        const auto snapshot = conn->take_metrics();
+        DMITIGR_ASSERT(snapshot.request_count == 4);
+        DMITIGR_ASSERT(snapshot.first_response_time.count() == 4);
+        DMITIGR_ASSERT(conn->metrics().request_count == 0);
+        DMITIGR_ASSERT(!conn->metrics().first_response_time.count());
+        conn->reset_metrics();
+        DMITIGR_ASSERT(conn->metrics().request_count == 0);
+        conn->set_metrics_enabled(false);
+      }
+
+      // Query tagging
+      {
+        DMITIGR_ASSERT(!conn->is_query_tagging_enabled());
+        const pgfe::Query_tag_guard guard{"request 42"};
+        std::string tag;
+        conn->set_trace_handler([&tag](const auto& e)
+        {
+          tag = e.tag;
+        });
+        std::string query;
+        conn->execute([&query](auto&& r)
+        {
+          query = pgfe::to<std::string>(r[0]);
+        }, "SELECT current_query()");
+        DMITIGR_ASSERT(query == "SELECT current_query()");
+        DMITIGR_ASSERT(tag == "request 42");
+
+        conn->set_query_tagging_enabled(true);
+        DMITIGR_ASSERT(conn->is_query_tagging_enabled());
+        conn->execute([&query](auto&& r)
+        {
+          query = pgfe::to<std::string>(r[0]);
+        }, "SELECT current_query()");
+        DMITIGR_ASSERT(query == "/* request 42 */ SELECT current_query()");
+        auto ps = conn->prepare("SELECT current_query()");
+        ps.execute([&query](auto&& r)
+        {
+          query = pgfe::to<std::string>(r[0]);
+        });
+        DMITIGR_ASSERT(query == "/* request 42 */ SELECT current_query()");
+        conn->set_query_tagging_enabled(false);
+        conn->set_trace_handler({});
+      }
+
       // to_quoted_literal(), to_quoted_identifier()
       {
         const std::string s{"the string"};
         DMITIGR_ASSERT(conn->to_quoted_literal(s) == "'" + s + "'");
         DMITIGR_ASSERT(conn->to_quoted_identifier(s) == "\"" + s + "\"");
+
+        std::string query{"SELECT "};
+        conn->append_quoted_literal(query, "it's \\ 'quoted'");
+        query += " AS ";
+        conn->append_quoted_identifier(query, "the \"name\"");
+        conn->execute([](auto&& row)
+        {
+          DMITIGR_ASSERT(to<std::string>(row["the \"name\""]) ==
+            "it's \\ 'quoted'");
+        }, query);
+      }
+
+      // cancel_request_nio(), set_request_timeout()
+      {
+        const auto is_canceled = [&conn](const auto& query)
+        {
+          try {
+            conn->execute(query);
+          } catch (const pgfe::Server_exception& e) {
+            return e.error().condition() == pgfe::Server_errc::c57_query_canceled;
+          }
+          return false;
+        };
+
+        conn->execute_nio("SELECT pg_sleep(10)");
+        DMITIGR_ASSERT(conn->cancel_request_nio());
+        DMITIGR_ASSERT(conn->wait_response());
+        DMITIGR_ASSERT(conn->error().condition() ==
+          pgfe::Server_errc::c57_query_canceled);
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+
+        conn->set_request_timeout(std::chrono::milliseconds{100});
+        DMITIGR_ASSERT(conn->request_timeout() == std::chrono::milliseconds{100});
+        DMITIGR_ASSERT(is_canceled("SELECT pg_sleep(10)"));
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+        DMITIGR_ASSERT(!is_canceled("SELECT 1"));
+        conn->set_request_timeout(std::nullopt);
+        DMITIGR_ASSERT(!conn->request_timeout());
+      }
+
+      // set_result_memory_limit(), set_result_memory_policy()
+      {
+        const auto is_exceeded = [&conn](const auto& query)
+        {
+          try {
+            conn->execute(query);
+          } catch (const pgfe::Client_exception& e) {
+            return e.condition() == pgfe::Client_errc::result_memory_exceeded;
+          }
+          return false;
+        };
+        const auto query = "select repeat('x', 1024) from generate_series(1, 1000)";
+
+        DMITIGR_ASSERT(conn->result_memory_policy() == pgfe::Result_memory_policy::cancel);
+        conn->set_result_memory_limit(64*1024);
+        DMITIGR_ASSERT(conn->result_memory_limit() == 64*1024);
+        DMITIGR_ASSERT(is_exceeded(query));
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+        DMITIGR_ASSERT(!is_exceeded("select 1"));
+
+        conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+        DMITIGR_ASSERT(is_exceeded(query));
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+
+        conn->set_result_memory_policy(pgfe::Result_memory_policy::stream);
+        DMITIGR_ASSERT(!is_exceeded(query));
+        DMITIGR_ASSERT(is_exceeded("select repeat('x', 128*1024)"));
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+
+        auto ps = conn->prepare(query);
+        DMITIGR_ASSERT(ps.result_memory_limit() == 64*1024);
+        ps.set_result_memory_limit(std::nullopt);
+        DMITIGR_ASSERT(ps.execute());
+
+        conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+        conn->set_result_memory_policy(pgfe::Result_memory_policy::cancel);
+        conn->set_result_memory_limit(std::nullopt);
+        DMITIGR_ASSERT(!conn->result_memory_limit());
       }
 
       // to_hex_data(), to_hex_string()
@@ -526,6 +837,92 @@ try {
         DMITIGR_ASSERT(!std::memcmp(data->bytes(), data2->bytes(), data->size()));
         DMITIGR_ASSERT(to<std::string_view>(*hex_data) == conn->to_hex_string(*data));
       }
+
+      // Simple query protocol
+      {
+        DMITIGR_ASSERT(!conn->is_simple_query_enabled());
+        conn->set_simple_query_enabled(true);
+        DMITIGR_ASSERT(conn->is_simple_query_enabled());
+        int sum{};
+        auto comp = conn->execute([&sum](auto&& row)
+        {
+          sum += to<int>(row[0]);
+        }, "select generate_series(1, 10)");
+        DMITIGR_ASSERT(comp.tag() == "SELECT" && sum == 55);
+        comp = conn->execute("select $1::int", 1); // extended protocol
+        DMITIGR_ASSERT(comp.tag() == "SELECT");
+
+        // The error of any command is the response.
+        DMITIGR_ASSERT(with_catch<pgfe::Server_exception>([&conn]
+        {
+          conn->execute("select 1; select 1/0; select 2");
+        }));
+        DMITIGR_ASSERT(conn->is_ready_for_request());
+        comp = conn->execute("create temp table simple(i int);"
+          " insert into simple values (1), (2)");
+        DMITIGR_ASSERT(comp.tag() == "INSERT" && comp.row_count() == 2);
+
+        // The rows of the multiple commands.
+        const auto delivered_values = [&conn]
+        {
+          std::vector<int> result;
+          const auto comp = conn->execute([&result](auto&& row)
+          {
+            result.push_back(to<int>(row[0]));
+          }, "select 1; select 2 union all select 3; set search_path to default;"
+            " select 4");
+          DMITIGR_ASSERT(comp.tag() == "SELECT");
+          return result;
+        };
+        DMITIGR_ASSERT(delivered_values() == std::vector<int>{1});
+        conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+        DMITIGR_ASSERT(delivered_values() == std::vector<int>{4});
+        conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+        conn->set_simple_query_enabled(false);
+
+        // Statement vector.
+        pgfe::Statement_vector script{"insert into simple values (3);"
+          " update simple set i = i * :factor -- comment\n;"
+          " delete from simple where i > 5"};
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+        {
+          conn->execute_simple(script);
+        }));
+        script[1].bind("factor", "2");
+        comp = conn->execute_simple(script);
+        DMITIGR_ASSERT(comp.tag() == "DELETE" && comp.row_count() == 1);
+        const auto count = conn->execute([](auto&&){},
+          "select count(*) from simple");
+        DMITIGR_ASSERT(count.row_count() == 1);
+        DMITIGR_ASSERT(with_catch<pgfe::Server_exception>([&]
+        {
+          conn->execute_simple(pgfe::Statement_vector{
+              "delete from simple; select 1/0"});
+        }));
+        conn->execute([](auto&& row)
+        {
+          DMITIGR_ASSERT(to<int>(row[0]) == 2); // the deletion is rolled back
+        }, "select count(*) from simple");
+        conn->execute("drop table simple");
+      }
+
+      // Parameters encoded in place.
+      {
+        const std::string text{"text"};
+        const std::optional<int> null;
+        conn->execute([&text](auto&& row)
+        {
+          DMITIGR_ASSERT(to<int>(row[0]) == -7);
+          DMITIGR_ASSERT(to<double>(row[1]) == 0.5);
+          DMITIGR_ASSERT(to<std::string>(row[2]) == text);
+          DMITIGR_ASSERT(to<bool>(row[3]));
+          DMITIGR_ASSERT(!row[4]);
+          DMITIGR_ASSERT(!row[5]);
+          DMITIGR_ASSERT(to<long long>(row[6]) == 9223372036854775807);
+        }, "select $1::int, $2::float8, :txt::text, :b::bool, $3::int,"
+           " $4::text, :ll::bigint", -7, 0.5, null, nullptr, text, true,
+           9223372036854775807LL);
+      }
     }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
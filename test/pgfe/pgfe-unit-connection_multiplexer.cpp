@@ -0,0 +1,103 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  pgfe::Connection_pool pool{3, pgfe::test::connection_options()};
+  pool.connect();
+
+  pgfe::Connection_multiplexer multiplexer{pool, 1};
+  DMITIGR_ASSERT(&multiplexer.pool() == &pool);
+  DMITIGR_ASSERT(multiplexer.worker_count() == 1);
+  DMITIGR_ASSERT(multiplexer.max_batch_size() ==
+    pgfe::Connection_multiplexer::default_max_batch_size);
+
+  // Many sessions share the single connection.
+  {
+    constexpr int session_count{32};
+    std::vector<std::thread> threads;
+    std::vector<int> values(session_count);
+    for (int i{}; i < session_count; ++i) {
+      threads.emplace_back([&multiplexer, &values, i]
+      {
+        auto session = multiplexer.session();
+        for (int j{}; j < 10; ++j) {
+          const auto comp = session.execute([&values, i](auto&& row)
+          {
+            values[i] += pgfe::to<int>(row[0]);
+          }, "select $1::int", i);
+          DMITIGR_ASSERT(comp.tag() == "SELECT");
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    for (int i{}; i < session_count; ++i)
+      DMITIGR_ASSERT(values[i] == i * 10);
+  }
+
+  // The error of a request doesn't affects the others.
+  {
+    auto session = multiplexer.session();
+    DMITIGR_ASSERT(!session.is_pinned());
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Server_exception>([&session]
+    {
+      session.execute("select 1/0");
+    }));
+    DMITIGR_ASSERT(session.execute("select 1").tag() == "SELECT");
+  }
+
+  // The pinned session.
+  {
+    auto session = multiplexer.session();
+    auto& conn = session.pin();
+    DMITIGR_ASSERT(session.is_pinned());
+    DMITIGR_ASSERT(&session.connection() == &conn);
+    {
+      pgfe::Transaction_guard tg{conn};
+      session.execute("create temp table mux(v int)");
+      DMITIGR_ASSERT(conn.is_transaction_uncommitted());
+      tg.commit();
+    }
+    session.execute("begin");
+    session.unpin();
+    DMITIGR_ASSERT(!session.is_pinned());
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&session]
+    {
+      session.connection();
+    }));
+  }
+
+  multiplexer.stop();
+  DMITIGR_ASSERT(multiplexer.is_stopped());
+  DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&multiplexer]
+  {
+    multiplexer.session().execute("select 1");
+  }));
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
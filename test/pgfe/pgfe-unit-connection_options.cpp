@@ -21,6 +21,7 @@
 #include "../../src/pgfe/connection_options.hpp"
 #include "../../src/util/diagnostic.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -54,6 +55,14 @@ int main()
       DMITIGR_ASSERT(co.session_mode() == value);
     }
 
+    {
+      const auto value = pgfe::Replication_mode::logical;
+      co.set(value);
+      DMITIGR_ASSERT(co.replication_mode() == value);
+      co.set_replication_mode(std::nullopt);
+      DMITIGR_ASSERT(!co.replication_mode());
+    }
+
     using ms = std::chrono::milliseconds;
     {
       ms valid_value{};
@@ -73,6 +82,25 @@ int main()
       DMITIGR_ASSERT(with_catch<Client_exception>([&]{ co.set_wait_response_timeout(invalid_value); }));
     }
 
+    {
+      co.set_startup_parameter("search_path", "app, public");
+      co.set_startup_parameter("application_name", "a\\b");
+      co.set_startup_parameter("statement_timeout", "5s");
+      DMITIGR_ASSERT(co.startup_parameters().size() == 3);
+      DMITIGR_ASSERT(co.startup_parameters().at("search_path") == "app, public");
+      co.set_startup_parameter("statement_timeout", std::nullopt);
+      DMITIGR_ASSERT(co.startup_parameters().size() == 2);
+
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]{ co.set_startup_parameter("", "1"); }));
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]{ co.set_startup_parameter("a=b", "1"); }));
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]{ co.set_startup_parameter("a b", "1"); }));
+
+      pgfe::Connection_options co2{co};
+      DMITIGR_ASSERT(co2 == co);
+      co2.set_startup_parameter("search_path", "public");
+      DMITIGR_ASSERT(co2 != co);
+    }
+
     {
       co.set_communication_mode(Cm::uds);
       DMITIGR_ASSERT(co.communication_mode() == Cm::uds);
@@ -132,6 +160,36 @@ int main()
       DMITIGR_ASSERT(co.tcp_user_timeout() == value);
     }
 
+    {
+      co.set_tcp_no_delay(true);
+      DMITIGR_ASSERT(co.tcp_no_delay() == true);
+    }
+
+    {
+      const auto valid_value = 1048576;
+      co.set_socket_send_buffer_size(valid_value);
+      DMITIGR_ASSERT(co.socket_send_buffer_size() == valid_value);
+      co.set_socket_receive_buffer_size(valid_value);
+      DMITIGR_ASSERT(co.socket_receive_buffer_size() == valid_value);
+
+      const auto invalid_value = 0;
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]() { co.set_socket_send_buffer_size(invalid_value); }));
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]() { co.set_socket_receive_buffer_size(invalid_value); }));
+    }
+
+    {
+      using std::chrono::microseconds;
+      const auto valid_value = microseconds{50};
+      co.set_wait_response_spin_duration(valid_value);
+      DMITIGR_ASSERT(co.wait_response_spin_duration() == valid_value);
+      co.set_socket_busy_poll(valid_value);
+      DMITIGR_ASSERT(co.socket_busy_poll() == valid_value);
+
+      const auto invalid_value = microseconds{-1};
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]() { co.set_wait_response_spin_duration(invalid_value); }));
+      DMITIGR_ASSERT(with_catch<Client_exception>([&]() { co.set_socket_busy_poll(invalid_value); }));
+    }
+
     {
       const auto valid_value_ipv4 = "127.0.0.1";
       co.set_address(valid_value_ipv4);
@@ -276,6 +334,12 @@ int main()
         DMITIGR_ASSERT(values[i]);
         std::cout << keywords[i] << " = " << "\"" << values[i] << "\"" << std::endl;
       }
+
+      const auto i = std::find_if(keywords, keywords + pco.count(),
+        [](const char* const keyword){return std::strcmp(keyword, "options") == 0;});
+      DMITIGR_ASSERT(i != keywords + pco.count());
+      DMITIGR_ASSERT(std::strcmp(values[i - keywords],
+        "-c application_name=a\\\\b -c search_path=app,\\ public") == 0);
     }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
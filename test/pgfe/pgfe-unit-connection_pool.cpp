@@ -16,6 +16,18 @@
 
 #include "pgfe-unit.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 namespace pgfe = dmitigr::pgfe;
 
 int main()
@@ -27,6 +39,37 @@ try {
   pool.connect();
   DMITIGR_ASSERT(pool.is_connected());
 
+  // Compiled options are shared by the connections and can be replaced.
+  {
+    const auto options = pool.options();
+    DMITIGR_ASSERT(options);
+    DMITIGR_ASSERT(options->options() == pgfe::test::connection_options());
+    {
+      auto conn = pool.connection();
+      DMITIGR_ASSERT(conn->compiled_options() == options);
+      conn->execute("select 1");
+    }
+
+    auto new_options = pgfe::test::connection_options();
+    new_options.set_connect_timeout(std::chrono::seconds{7});
+    pool.set_options(new_options);
+    DMITIGR_ASSERT(pool.options() != options);
+    DMITIGR_ASSERT(pool.options()->options() == new_options);
+    {
+      // The open connection is not affected until reconnected.
+      auto conn = pool.connection();
+      DMITIGR_ASSERT(conn->compiled_options() == options);
+      conn->disconnect();
+    }
+    {
+      auto conn = pool.connection();
+      DMITIGR_ASSERT(conn->is_connected());
+      DMITIGR_ASSERT(conn->compiled_options() == pool.options());
+      DMITIGR_ASSERT(conn->options() == new_options);
+    }
+    pool.set_options(pgfe::test::connection_options());
+  }
+
   pgfe::Connection* conn1p{};
   pgfe::Connection* conn2p{};
   pgfe::Connection* conn3p{};
@@ -59,6 +102,25 @@ try {
 
     auto conn4 = pool.connection();
     DMITIGR_ASSERT(!conn4);
+    conn4 = pool.try_connection();
+    DMITIGR_ASSERT(!conn4);
+    conn4 = pool.connection(std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(!conn4);
+
+    // Wait for the connection released by another thread.
+    std::thread releaser{[&conn3]
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds{50});
+      conn3.release();
+    }};
+    conn4 = pool.connection(std::nullopt);
+    releaser.join();
+    DMITIGR_ASSERT(conn4);
+    DMITIGR_ASSERT(!conn3);
+    DMITIGR_ASSERT(&*conn4 == conn3p);
+    conn3 = std::move(conn4);
+    DMITIGR_ASSERT(conn3);
+
     pool.disconnect();
     DMITIGR_ASSERT(!pool.is_connected());
     DMITIGR_ASSERT(conn1->is_connected());
@@ -71,6 +133,502 @@ try {
   DMITIGR_ASSERT(!conn1p->is_connected());
   DMITIGR_ASSERT(!conn2p->is_connected());
   DMITIGR_ASSERT(!conn3p->is_connected());
+
+  // Lazy connection establishment.
+  {
+    pgfe::Connection_pool pool2{2, pgfe::test::connection_options()};
+    DMITIGR_ASSERT(pool2.min_size() == pool2.size());
+    pool2.set_min_size(1);
+    DMITIGR_ASSERT(pool2.min_size() == 1);
+    pool2.connect();
+    DMITIGR_ASSERT(pool2.is_connected());
+    auto c1 = pool2.connection();
+    auto c2 = pool2.connection();
+    DMITIGR_ASSERT(c1 && c1->is_connected());
+    DMITIGR_ASSERT(c2 && c2->is_connected());
+  }
+
+  // Maintenance.
+  {
+    pgfe::Connection_pool pool3{1, pgfe::test::connection_options()};
+    pool3.connect();
+    const auto pid = pool3.connection()->server_pid();
+    pool3.set_max_lifetime(std::chrono::milliseconds{0});
+    DMITIGR_ASSERT(pool3.max_lifetime() == std::chrono::milliseconds{0});
+    pool3.maintain();
+    pool3.set_max_lifetime(std::nullopt);
+    {
+      auto conn = pool3.connection();
+      DMITIGR_ASSERT(conn && conn->is_connected());
+      DMITIGR_ASSERT(conn->server_pid() != pid);
+    }
+    pool3.set_maintenance_interval(std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(pool3.maintenance_interval() == std::chrono::milliseconds{10});
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    pool3.set_maintenance_interval(std::nullopt);
+    DMITIGR_ASSERT(pool3.connection()->is_ready_for_request());
+  }
+
+  // Warm spare connections.
+  {
+    pgfe::Connection_pool pool4{6, pgfe::test::connection_options()};
+    pool4.set_min_size(1);
+    pool4.connect();
+    DMITIGR_ASSERT(!pool4.warm_spare_count());
+    pool4.set_warm_spare_count(2);
+    DMITIGR_ASSERT(pool4.warm_spare_count() == 2);
+    DMITIGR_ASSERT(!pool4.predicted_demand());
+    {
+      auto c1 = pool4.connection();
+      auto c2 = pool4.connection();
+      auto c3 = pool4.connection();
+    }
+    pool4.set_metrics_enabled(true);
+    pool4.maintain();
+    DMITIGR_ASSERT(pool4.predicted_demand() == 3);
+    // The spares are opened ahead of the next burst.
+    DMITIGR_ASSERT(pool4.metrics().connect_count == 2);
+    {
+      std::vector<pgfe::Connection_pool::Handle> handles;
+      for (int i{}; i < 5; ++i)
+        handles.push_back(pool4.connection());
+    }
+    DMITIGR_ASSERT(pool4.metrics().connect_count == 2);
+
+    // The prediction follows the peak up and decays smoothly.
+    pool4.maintain();
+    DMITIGR_ASSERT(pool4.predicted_demand() == 5);
+    pool4.maintain();
+    DMITIGR_ASSERT(pool4.predicted_demand() == 4);
+  }
+
+  // The metrics handler can use the pool.
+  {
+    pgfe::Connection_pool pool5{1, pgfe::test::connection_options()};
+    pool5.set_metrics_enabled(true);
+    std::size_t miss_count{};
+    pool5.set_metrics_handler([&pool5, &miss_count](const auto metric, auto)
+    {
+      if (metric == pgfe::Connection_pool::Metric::acquire_miss)
+        miss_count = pool5.metrics().acquire_miss_count;
+      (void)pool5.free_count();
+    });
+    pool5.connect();
+    auto conn = pool5.connection();
+    DMITIGR_ASSERT(conn);
+    DMITIGR_ASSERT(!pool5.try_connection());
+    DMITIGR_ASSERT(miss_count == 1);
+  }
+
+  // Reset policies.
+  {
+    using Policy = pgfe::Connection_pool::Reset_policy;
+    DMITIGR_ASSERT(pool.reset_policy() == Policy::discard_all);
+    pool.connect();
+    for (const auto policy : {Policy::none, Policy::discard_all,
+        Policy::reset_all, Policy::keep_prepared, Policy::rollback,
+        Policy::deferred_discard_all}) {
+      pool.set_reset_policy(policy);
+      DMITIGR_ASSERT(pool.reset_policy() == policy);
+      auto conn = pool.connection();
+      DMITIGR_ASSERT(conn);
+      conn->execute("begin");
+      conn->execute("set application_name to 'pgfe_connection_pool'");
+      if (policy != Policy::rollback)
+        conn->execute("commit");
+      conn.release();
+      DMITIGR_ASSERT(!conn);
+      conn = pool.connection();
+      DMITIGR_ASSERT(conn);
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+      DMITIGR_ASSERT(!conn->is_transaction_uncommitted());
+    }
+  }
+
+  // The maintenance completes the deferred reset of idle connections.
+  {
+    using std::chrono::milliseconds;
+    pgfe::Connection_pool pool6{1, pgfe::test::connection_options()};
+    pool6.set_reset_policy(
+      pgfe::Connection_pool::Reset_policy::deferred_discard_all);
+    pool6.connect();
+    auto conn = pool6.connection();
+    const auto session_start_time = conn->session_start_time();
+    conn.release();
+    pool6.set_maintenance_interval(milliseconds{1});
+    std::this_thread::sleep_for(milliseconds{10});
+    pool6.maintain(); // checks the idle connection
+    pool6.set_maintenance_interval(std::nullopt);
+    conn = pool6.connection();
+    DMITIGR_ASSERT(conn->session_start_time() == session_start_time);
+  }
+
+  // Parallel COPY.
+  {
+    pool.connect();
+    pool.connection()->execute("drop table if exists pgfe_parallel_copy");
+    pool.connection()->execute("create table pgfe_parallel_copy"
+      "(id integer not null, str text)");
+    pgfe::Parallel_copy_loader loader{pool,
+      "copy pgfe_parallel_copy from stdin (format csv)"};
+    DMITIGR_ASSERT(&loader.pool() == &pool);
+    DMITIGR_ASSERT(loader.worker_count() == pool.size());
+    DMITIGR_ASSERT(loader.transaction_policy() ==
+      pgfe::Parallel_copy_loader::Transaction_policy::chunk);
+    loader.set_chunk_size(100);
+    DMITIGR_ASSERT(loader.chunk_size() == 100);
+    std::string input;
+    for (int i{}; i < 1000; ++i)
+      input.append(std::to_string(i)).append(",str\n");
+    {
+      std::istringstream stream{input};
+      const auto r = loader.load(stream);
+      DMITIGR_ASSERT(r.is_ok());
+      DMITIGR_ASSERT(r.row_count() == 1000);
+      DMITIGR_ASSERT(r.completion_count() == r.execution_count());
+      DMITIGR_ASSERT(r.execution_count() > 1);
+    }
+
+    // Errors.
+    input.append("bad,str\n");
+    for (const auto policy : {
+        pgfe::Parallel_copy_loader::Transaction_policy::chunk,
+        pgfe::Parallel_copy_loader::Transaction_policy::worker}) {
+      loader.set_transaction_policy(policy);
+      std::istringstream stream{input};
+      const auto r = loader.load(stream);
+      DMITIGR_ASSERT(!r.is_ok());
+      DMITIGR_ASSERT(r.errors().size() == 1);
+      DMITIGR_ASSERT(r.errors()[0].first + 1 == r.execution_count());
+      DMITIGR_ASSERT(r.completion_count() + r.aborted_count() + 1 ==
+        r.execution_count());
+    }
+    pool.connection()->execute("drop table pgfe_parallel_copy");
+  }
+
+  // Partitioned COPY.
+  {
+    pool.connect();
+    {
+      auto conn = pool.connection();
+      conn->execute("drop table if exists pgfe_partitioned_copy");
+      conn->execute("create table pgfe_partitioned_copy"
+        "(str text, id integer) partition by range (id)");
+      conn->execute("create table pgfe_partitioned_copy_1 partition of"
+        " pgfe_partitioned_copy for values from (minvalue) to (-10)");
+      conn->execute("create table pgfe_partitioned_copy_2 partition of"
+        " pgfe_partitioned_copy for values from (-10) to (500)");
+      conn->execute("create table pgfe_partitioned_copy_3 partition of"
+        " pgfe_partitioned_copy for values from (500) to (1000)");
+      conn->execute("create table pgfe_partitioned_copy_4 partition of"
+        " pgfe_partitioned_copy default");
+    }
+    pgfe::Partitioned_copy_loader loader{pool, "pgfe_partitioned_copy"};
+    DMITIGR_ASSERT(&loader.pool() == &pool);
+    DMITIGR_ASSERT(loader.worker_count() == pool.size());
+    DMITIGR_ASSERT(!loader.is_partitions_loaded());
+    loader.load_partitions();
+    DMITIGR_ASSERT(loader.partition_count() == 4);
+    const auto partition = [&loader](const std::optional<std::string_view> key)
+    {
+      return loader.partition_name(loader.route(key).value());
+    };
+    DMITIGR_ASSERT(partition("-11") == "pgfe_partitioned_copy_1");
+    DMITIGR_ASSERT(partition("-10") == "pgfe_partitioned_copy_2");
+    DMITIGR_ASSERT(partition("499") == "pgfe_partitioned_copy_2");
+    DMITIGR_ASSERT(partition("500") == "pgfe_partitioned_copy_3");
+    DMITIGR_ASSERT(partition("1000") == "pgfe_partitioned_copy_4");
+    DMITIGR_ASSERT(partition(std::nullopt) == "pgfe_partitioned_copy_4");
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+      {
+        loader.route("x");
+      }));
+
+    loader.set_chunk_size(100);
+    std::string input;
+    for (int i{-20}; i < 1020; ++i)
+      input.append("str\\t").append(std::to_string(i)).append("\tstr\n");
+    input.append("null\t\\N\n");
+    {
+      std::istringstream stream{input};
+      const auto r = loader.load(stream);
+      DMITIGR_ASSERT(r.is_ok());
+      DMITIGR_ASSERT(r.row_count() == 1041);
+      DMITIGR_ASSERT(r.execution_count() > 4);
+    }
+    {
+      auto conn = pool.connection();
+      conn->execute([](auto&& row)
+      {
+        DMITIGR_ASSERT(pgfe::to<long>(row.data(0)) == 10);
+        DMITIGR_ASSERT(pgfe::to<long>(row.data(1)) == 510);
+        DMITIGR_ASSERT(pgfe::to<long>(row.data(2)) == 500);
+        DMITIGR_ASSERT(pgfe::to<long>(row.data(3)) == 21);
+      }, "select"
+         " (select count(*) from only pgfe_partitioned_copy_1),"
+         " (select count(*) from only pgfe_partitioned_copy_2),"
+         " (select count(*) from only pgfe_partitioned_copy_3),"
+         " (select count(*) from only pgfe_partitioned_copy_4)");
+      conn->execute("drop table pgfe_partitioned_copy");
+    }
+  }
+
+  // Parallel COPY exporter.
+  {
+    pool.connect();
+    pgfe::Parallel_copy_exporter exporter{pool};
+    DMITIGR_ASSERT(&exporter.pool() == &pool);
+    DMITIGR_ASSERT(exporter.worker_count() == pool.size());
+    DMITIGR_ASSERT(exporter.snapshot().empty());
+
+    std::vector<pgfe::Statement> partitions;
+    for (int i{}; i < 5; ++i)
+      partitions.emplace_back("copy (select n from generate_series(1, 1000) n"
+        " where n % 5 = " + std::to_string(i) + ") to stdout");
+    std::vector<long> sums(partitions.size());
+    const auto count = exporter.execute(partitions,
+      [&sums](const std::size_t p, const pgfe::Data_view& data)
+      {
+        DMITIGR_ASSERT(p < sums.size());
+        sums[p] += std::stol(std::string{static_cast<const char*>(data.bytes()),
+          data.size()});
+      });
+    DMITIGR_ASSERT(count == 1000);
+    DMITIGR_ASSERT(!exporter.snapshot().empty());
+    long sum{};
+    for (const auto s : sums)
+      sum += s;
+    DMITIGR_ASSERT(sum == 500500);
+
+    // Not a COPY TO STDOUT.
+    bool is_thrown{};
+    try {
+      exporter.execute({"select 1"}, [](auto, const auto&){});
+    } catch (const pgfe::Client_exception&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+    DMITIGR_ASSERT(exporter.execute({}, [](auto, const auto&){}) == 0);
+  }
+
+  // Parallel range query.
+  {
+    pool.connect();
+    pgfe::Parallel_range_query query{pool,
+      "select n from generate_series(1, 1000) n where n >= $1 and n < $2"};
+    DMITIGR_ASSERT(&query.pool() == &pool);
+    DMITIGR_ASSERT(query.worker_count() == pool.size());
+    DMITIGR_ASSERT(query.partition_count() == query.worker_count());
+    DMITIGR_ASSERT(!query.is_ordered());
+    query.set_partition_count(7);
+    DMITIGR_ASSERT(query.partition_count() == 7);
+
+    // Unordered.
+    long sum{};
+    std::size_t count = query.execute(1, 1001, [&sum](const std::size_t p,
+      pgfe::Row&& row)
+    {
+      DMITIGR_ASSERT(p < 7);
+      sum += pgfe::to<long>(row.data());
+    });
+    DMITIGR_ASSERT(count == 1000);
+    DMITIGR_ASSERT(sum == 500500);
+
+    // Ordered.
+    query.set_ordered(true);
+    DMITIGR_ASSERT(query.is_ordered());
+    int expected{1};
+    count = query.execute(1, 1001, [&expected](std::size_t, pgfe::Row&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row.data()) == expected++);
+    });
+    DMITIGR_ASSERT(count == 1000 && expected == 1001);
+
+    // Empty range and exceptions.
+    DMITIGR_ASSERT(!query.execute(5, 5, [](std::size_t, pgfe::Row&&){}));
+    bool is_thrown{};
+    try {
+      query.execute(1, 1001, [](std::size_t, pgfe::Row&&)
+      {
+        throw std::runtime_error{"error"};
+      });
+    } catch (const std::runtime_error&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+  }
+
+  // Parallel large object transfer.
+  {
+    namespace fs = std::filesystem;
+    const auto dir = fs::temp_directory_path();
+    std::vector<fs::path> files;
+    std::vector<std::string> contents;
+    for (int i{}; i < 5; ++i) {
+      files.push_back(dir/("pgfe_parallel_lob" + std::to_string(i) + ".dat"));
+      contents.emplace_back(static_cast<std::size_t>(i) * 10000 + 1,
+        static_cast<char>('a' + i));
+      std::ofstream{files.back(), std::ios_base::binary} << contents.back();
+    }
+
+    pgfe::Parallel_large_object_transfer transfer{pool};
+    DMITIGR_ASSERT(&transfer.pool() == &pool);
+    DMITIGR_ASSERT(transfer.worker_count() == pool.size());
+    transfer.set_chunk_size(4096);
+    DMITIGR_ASSERT(transfer.chunk_size() == 4096);
+    transfer.set_read_ahead(2);
+    DMITIGR_ASSERT(transfer.read_ahead() == 2);
+    std::size_t done_count{};
+    transfer.set_progress_handler([&done_count, &contents](const auto& p)
+    {
+      DMITIGR_ASSERT(p.index < contents.size());
+      DMITIGR_ASSERT(p.transferred_size <= contents[p.index].size());
+      if (p.is_done) {
+        DMITIGR_ASSERT(p.total_size == contents[p.index].size());
+        ++done_count;
+      }
+    });
+
+    // Import.
+    const auto oids = transfer.import_files(files);
+    DMITIGR_ASSERT(oids.size() == files.size());
+    DMITIGR_ASSERT(done_count == files.size());
+    for (const auto oid : oids)
+      DMITIGR_ASSERT(oid != pgfe::invalid_oid);
+
+    // Export.
+    std::vector<pgfe::Parallel_large_object_transfer::Export_item> items;
+    for (std::size_t i{}; i < oids.size(); ++i)
+      items.emplace_back(oids[i], fs::path{files[i]}.concat(".out"));
+    done_count = 0;
+    transfer.export_files(items);
+    DMITIGR_ASSERT(done_count == items.size());
+    for (std::size_t i{}; i < items.size(); ++i) {
+      std::ifstream input{items[i].second, std::ios_base::binary};
+      std::ostringstream output;
+      output << input.rdbuf();
+      DMITIGR_ASSERT(output.str() == contents[i]);
+    }
+
+    // Read the range.
+    transfer.set_progress_handler(nullptr);
+    const auto range = transfer.read_range(oids[4], 100, 20000);
+    DMITIGR_ASSERT(range.size() == 20000);
+    DMITIGR_ASSERT(std::all_of(range.cbegin(), range.cend(),
+      [](const auto b){return static_cast<char>(b) == 'e';}));
+    DMITIGR_ASSERT(transfer.read_range(oids[1], 9000, 20000).size() == 1001);
+    DMITIGR_ASSERT(transfer.read_range(oids[1], 0, 0).empty());
+
+    // Cleanup.
+    auto conn = pool.connection();
+    for (std::size_t i{}; i < oids.size(); ++i) {
+      conn->execute("begin");
+      conn->remove_large_object(oids[i]);
+      conn->execute("commit");
+      fs::remove(files[i]);
+      fs::remove(items[i].second);
+    }
+  }
+
+  // Query catalog.
+  {
+    const pgfe::Query_catalog catalog{pgfe::Statement_vector{
+      "-- $id$pgfe_one$id$\nSELECT 1;"
+      "-- $id$pgfe_plus$id$\nSELECT :n::int + 1"}};
+    pgfe::Connection_pool pool4{2, pgfe::test::connection_options()};
+    pool4.set_connect_handler([&catalog](pgfe::Connection& conn)
+    {
+      catalog.prepare(conn);
+    });
+    pool4.connect();
+    auto conn = pool4.connection();
+    DMITIGR_ASSERT(conn && conn->is_ready_for_request());
+    auto ps = conn->describe("pgfe_plus");
+    DMITIGR_ASSERT(ps);
+    int value{};
+    ps.execute([&value](auto&& row)
+    {
+      value = pgfe::to<int>(row.data());
+    }, 2);
+    DMITIGR_ASSERT(value == 3);
+    DMITIGR_ASSERT(conn->describe("pgfe_one"));
+  }
+
+  // Group commit.
+  {
+    pool.connect();
+    pool.connection()->execute("drop table if exists pgfe_group_commit");
+    pool.connection()->execute("create table pgfe_group_commit"
+      "(id integer not null primary key)");
+    pgfe::Group_commit_executor executor{pool, 2};
+    DMITIGR_ASSERT(&executor.pool() == &pool);
+    DMITIGR_ASSERT(executor.worker_count() == 2);
+    DMITIGR_ASSERT(executor.max_batch_size() ==
+      pgfe::Group_commit_executor::default_max_batch_size);
+    executor.set_max_batch_size(16);
+    DMITIGR_ASSERT(executor.max_batch_size() == 16);
+    executor.set_max_delay(std::chrono::milliseconds{1});
+    DMITIGR_ASSERT(executor.max_delay() == std::chrono::milliseconds{1});
+
+    constexpr int thread_count{4};
+    constexpr int unit_count{100};
+    std::vector<std::thread> submitters;
+    std::vector<std::vector<std::future<void>>> futures(thread_count);
+    for (int t{}; t < thread_count; ++t) {
+      submitters.emplace_back([&executor, &futures, t]
+      {
+        for (int i{}; i < unit_count; ++i) {
+          const int id{t * unit_count + i};
+          futures[t].push_back(executor.submit([id](auto& unit)
+          {
+            // Each tenth unit violates the primary key.
+            unit.execute("insert into pgfe_group_commit values ($1)", id);
+            if (!(id % 10))
+              unit.execute("insert into pgfe_group_commit values ($1)", id);
+          }));
+        }
+      });
+    }
+    for (auto& submitter : submitters)
+      submitter.join();
+
+    int failure_count{};
+    for (auto& thread_futures : futures) {
+      for (auto& future : thread_futures) {
+        try {
+          future.get();
+        } catch (const pgfe::Server_exception& e) {
+          DMITIGR_ASSERT(e.error().condition() ==
+            pgfe::Server_errc::c23_unique_violation);
+          ++failure_count;
+        }
+      }
+    }
+    DMITIGR_ASSERT(failure_count == thread_count * unit_count / 10);
+
+    // The exception thrown by the unit of work.
+    auto future = executor.submit([](auto& unit)
+    {
+      unit.execute("insert into pgfe_group_commit values (-1)");
+      throw std::runtime_error{"error"};
+    });
+    bool is_thrown{};
+    try {
+      future.get();
+    } catch (const std::runtime_error&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+
+    executor.stop();
+    DMITIGR_ASSERT(executor.is_stopped());
+    pool.connection()->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row.data()) ==
+        thread_count * unit_count * 9 / 10);
+    }, "select count(*)::int from pgfe_group_commit");
+    pool.connection()->execute("drop table pgfe_group_commit");
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
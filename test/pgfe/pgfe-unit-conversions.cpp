@@ -15,11 +15,17 @@
 // limitations under the License.
 
 #include "../../src/base/assert.hpp"
+#include "../../src/pgfe/column_decoder.hpp"
 #include "../../src/pgfe/conversions.hpp"
 #include "../../src/pgfe/errctg.hpp"
 #include "../../src/pgfe/exceptions.hpp"
 #include "../../src/util/diagnostic.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <limits>
 #include <optional>
 #include <string>
@@ -135,6 +141,248 @@ int main()
       DMITIGR_ASSERT(original == converted);
     }
 
+    // numerics in text format
+    {
+      using pgfe::Data_view;
+      DMITIGR_ASSERT(pgfe::to<int>(Data_view{"+42"}) == 42);
+      DMITIGR_ASSERT(pgfe::to<short>(Data_view{"-32768"}) == -32768);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<short>(Data_view{"32768"});
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<int>(Data_view{"12x"});
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<long long>(Data_view{""});
+      }));
+
+      const double d{0.1};
+      DMITIGR_ASSERT(pgfe::to<double>(*pgfe::to_data(d)) == d);
+      const float f{numeric_limits<float>::max()};
+      DMITIGR_ASSERT(pgfe::to<float>(*pgfe::to_data(f)) == f);
+      DMITIGR_ASSERT(std::isinf(pgfe::to<double>(Data_view{"-Infinity"})));
+      DMITIGR_ASSERT(std::isnan(pgfe::to<double>(Data_view{"NaN"})));
+    }
+
+    // numerics in binary format
+    {
+      using pgfe::Data_format;
+      const short s{numeric_limits<short>::min()};
+      auto data = pgfe::to_data(s, Data_format::binary);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 2);
+      DMITIGR_ASSERT(static_cast<const unsigned char*>(data->bytes())[0] == 0x80);
+      DMITIGR_ASSERT(pgfe::to<short>(*data) == s);
+      DMITIGR_ASSERT(pgfe::to<int>(*data) == s);
+      DMITIGR_ASSERT(pgfe::to<long long>(*data) == s);
+
+      const int i{-65536};
+      data = pgfe::to_data(i, Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 4);
+      DMITIGR_ASSERT(pgfe::to<int>(*data) == i);
+      DMITIGR_ASSERT(pgfe::to<long long>(*data) == i);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        pgfe::to<short>(*data);
+      }));
+
+      const long long ll{numeric_limits<long long>::max()};
+      data = pgfe::to_data(ll, Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 8);
+      DMITIGR_ASSERT(pgfe::to<long long>(*data) == ll);
+
+      const float f{123.456f};
+      data = pgfe::to_data(f, Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 4);
+      DMITIGR_ASSERT(pgfe::to<float>(*data) == f);
+      DMITIGR_ASSERT(pgfe::to<double>(*data) == f);
+
+      const double d{numeric_limits<double>::min()};
+      data = pgfe::to_data(d, Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 8);
+      DMITIGR_ASSERT(pgfe::to<double>(*data) == d);
+
+      // out of range
+      data = pgfe::to_data(numeric_limits<double>::max(), Data_format::binary);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        pgfe::to<float>(*data);
+      }));
+      data = pgfe::to_data(-numeric_limits<double>::infinity(),
+        Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<float>(*data) == -numeric_limits<float>::infinity());
+      using Unsigned_conversions = pgfe::Numeric_conversions<unsigned>;
+      data = pgfe::to_data(short{-1}, Data_format::binary);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        Unsigned_conversions::to_type(*data);
+      }));
+      data = pgfe::to_data(-i, Data_format::binary);
+      DMITIGR_ASSERT(Unsigned_conversions::to_type(*data) == 65536);
+      data = pgfe::to_data(ll, Data_format::binary);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        Unsigned_conversions::to_type(*data);
+      }));
+
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<int>(pgfe::Data_view{"abc", 3, Data_format::binary});
+      }));
+
+      for (const bool b : {false, true}) {
+        data = pgfe::to_data(b, Data_format::binary);
+        DMITIGR_ASSERT(data->format() == Data_format::binary);
+        DMITIGR_ASSERT(data->size() == 1);
+        DMITIGR_ASSERT(pgfe::to<bool>(*data) == b);
+      }
+    }
+
+    // bytea
+    {
+      using pgfe::Data_format;
+      const std::vector<std::byte> original{std::byte{0}, std::byte{0xab},
+        std::byte{0xff}};
+      const auto data = pgfe::to_data(original);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 3);
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::byte>>(*data) == original);
+
+      const pgfe::Data_view hex{"\\x00abFF", 8, Data_format::text};
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::byte>>(hex) == original);
+      using Bytes3 = std::array<std::byte, 3>;
+      const auto arr = pgfe::to<Bytes3>(hex);
+      DMITIGR_ASSERT(std::equal(arr.begin(), arr.end(), original.begin()));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&hex]
+      {
+        pgfe::to<std::array<std::byte, 2>>(hex);
+      }));
+
+      // Text format.
+      const auto text = pgfe::to_data(original, Data_format::text);
+      DMITIGR_ASSERT(text->format() == Data_format::text);
+      DMITIGR_ASSERT(pgfe::to<std::string_view>(*text) == "\\x00abff");
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::byte>>(*text) == original);
+      const auto bytea = text->to_bytea();
+      DMITIGR_ASSERT(bytea->format() == Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::byte>>(*bytea) == original);
+      DMITIGR_ASSERT(pgfe::Data::to_bytea("\\x")->is_empty());
+      // Escape format.
+      DMITIGR_ASSERT(pgfe::to<std::string_view>(
+          *pgfe::Data::to_bytea("a\\134b")) == "a\\b");
+    }
+
+    // uuid
+    {
+      using pgfe::Data_format;
+      const std::string text{"a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11"};
+      const auto original = pgfe::Uuid::from_string(text);
+      DMITIGR_ASSERT(!original.is_nil());
+      DMITIGR_ASSERT(original.to_string() == text);
+      DMITIGR_ASSERT(pgfe::Uuid::from_string("{A0EEBC999C0B4EF8BB6D6BB9BD380A11}")
+        == original);
+      DMITIGR_ASSERT(pgfe::Uuid::from_string("a0eebc99-9c0b4ef8-bb6d6bb9-bd38-0a11")
+        == original);
+      for (const char* const invalid : {"a0eebc99", "{}", "",
+          "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11xyz",
+          "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a1100",
+          "a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11-",
+          "-a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11",
+          "a0eebc99--9c0b-4ef8-bb6d-6bb9bd380a11",
+          "a0e-ebc99-9c0b-4ef8-bb6d-6bb9bd380a11",
+          "{a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11"}) {
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([invalid]
+        {
+          pgfe::Uuid::from_string(invalid);
+        }));
+      }
+
+      auto data = pgfe::to_data(original);
+      DMITIGR_ASSERT(data->format() == Data_format::text);
+      DMITIGR_ASSERT(pgfe::to<pgfe::Uuid>(*data) == original);
+      data = pgfe::to_data(original, Data_format::binary);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 16);
+      DMITIGR_ASSERT(pgfe::to<pgfe::Uuid>(*data) == original);
+    }
+
+    // numeric
+    {
+      using pgfe::Data_format;
+      for (const char* const value : {"0", "1", "-0.5", "12345.678", "0.00001",
+          "10000", "-99990000.00010", "NaN", "Infinity", "-Infinity"}) {
+        const pgfe::Numeric original{value};
+        const auto data = pgfe::to_data(original, Data_format::binary);
+        DMITIGR_ASSERT(data->format() == Data_format::binary);
+        const auto converted = pgfe::to<pgfe::Numeric>(*data);
+        DMITIGR_ASSERT(converted == original);
+        DMITIGR_ASSERT(pgfe::to<pgfe::Numeric>(*pgfe::to_data(original)) == original);
+      }
+      DMITIGR_ASSERT(pgfe::to<pgfe::Numeric>(*pgfe::to_data(pgfe::Numeric{"-0.00"},
+        Data_format::binary)).to_string() == "0.00");
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::Numeric{"1e5"};
+      }));
+    }
+
+    // json
+    {
+      using pgfe::Data_format;
+      const std::string_view text{R"({"a": [1, "\u00e9"]})"};
+      const auto text_data = pgfe::Data::make(text, Data_format::text);
+      const auto view = pgfe::to<pgfe::Json_view>(*text_data);
+      DMITIGR_ASSERT(view.to_string_view() == text);
+      DMITIGR_ASSERT(view.to_string_view().data() == text_data->bytes());
+      const auto json_data = pgfe::Data::make(text, Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<pgfe::Json>(*json_data).to_string() == text);
+      const auto jsonb_data = pgfe::to_data(pgfe::Json{std::string{text}},
+        Data_format::binary);
+      DMITIGR_ASSERT(jsonb_data->format() == Data_format::binary);
+      DMITIGR_ASSERT(jsonb_data->size() == 1 + text.size());
+      DMITIGR_ASSERT(pgfe::to<pgfe::Json_view>(*jsonb_data) == view);
+      const auto no_copy = pgfe::to_data(view);
+      DMITIGR_ASSERT(no_copy->bytes() == view.to_string_view().data());
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<pgfe::Json>(*pgfe::Data::make(std::string_view{"\x02{}"},
+          Data_format::binary));
+      }));
+    }
+
+    // timestamp
+    {
+      using pgfe::Data_format;
+      using Time_point = std::chrono::system_clock::time_point;
+      using std::chrono::microseconds;
+      const auto ts = pgfe::to<Time_point>(pgfe::Data_view{
+          "2000-01-02 00:00:01.5+00"});
+      DMITIGR_ASSERT(std::chrono::duration_cast<microseconds>(
+          ts.time_since_epoch()).count() == 946771201500000);
+      DMITIGR_ASSERT(pgfe::to<Time_point>(pgfe::Data_view{
+          "2000-01-02 03:00:01.5+03"}) == ts);
+      DMITIGR_ASSERT(pgfe::to<Time_point>(pgfe::Data_view{
+          "2000-01-02 00:00:01.5"}) == ts);
+      DMITIGR_ASSERT(pgfe::to<std::string>(*pgfe::to_data(ts)) ==
+        "2000-01-02 00:00:01.500000+00");
+      DMITIGR_ASSERT(pgfe::to<Time_point>(pgfe::Data_view{"infinity"}) ==
+        Time_point::max());
+
+      auto data = pgfe::to_data(ts, Data_format::binary);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 8);
+      DMITIGR_ASSERT(pgfe::to<long long>(*data) == 86401500000);
+      DMITIGR_ASSERT(pgfe::to<Time_point>(*data) == ts);
+
+      // date
+      data = pgfe::to_data(std::int32_t{1}, Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<Time_point>(*data) ==
+        pgfe::to<Time_point>(pgfe::Data_view{"2000-01-02"}));
+    }
+
     // char
     {
       char original = 'd';
@@ -199,6 +447,45 @@ int main()
       }
     }
 
+    // std::optional<int> of binary format
+    {
+      const std::optional<int> original{14};
+      const auto data = pgfe::to_data(original, pgfe::Data_format::binary);
+      DMITIGR_ASSERT(data && data->format() == pgfe::Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<std::optional<int>>(*data) == original);
+    }
+
+    // The types of binary data
+    {
+      static_assert(pgfe::binary_oid_v<short> == 21);
+      static_assert(pgfe::binary_oid_v<int> == 23);
+      static_assert(pgfe::binary_oid_v<long long> == 20);
+      static_assert(pgfe::binary_oid_v<float> == 700);
+      static_assert(pgfe::binary_oid_v<double> == 701);
+      static_assert(pgfe::binary_oid_v<long double> == pgfe::invalid_oid);
+      static_assert(pgfe::binary_oid_v<bool> == 16);
+      static_assert(pgfe::binary_oid_v<std::vector<std::byte>> == 17);
+      static_assert(pgfe::binary_oid_v<pgfe::Uuid> == 2950);
+      static_assert(pgfe::binary_oid_v<pgfe::Numeric> == 1700);
+      static_assert(pgfe::binary_oid_v<pgfe::Json> == 3802);
+      static_assert(pgfe::binary_oid_v<pgfe::Json_view> == 3802);
+      static_assert(pgfe::binary_oid_v<
+        std::chrono::system_clock::time_point> == 1184);
+      static_assert(pgfe::binary_oid_v<std::optional<long long>> == 20);
+      static_assert(pgfe::binary_oid_v<std::string> == pgfe::invalid_oid);
+      static_assert(pgfe::binary_oid_v<My_string> == pgfe::invalid_oid);
+      static_assert(pgfe::binary_oid_v<std::vector<long long>> == 1016);
+      static_assert(pgfe::binary_oid_v<
+        std::vector<std::optional<std::string>>> == 1009);
+      static_assert(pgfe::binary_oid_v<
+        std::vector<std::vector<int>>> == 1007);
+      static_assert(pgfe::binary_oid_v<
+        std::vector<std::vector<std::byte>>> == 1001);
+      static_assert(pgfe::binary_oid_v<std::vector<pgfe::Uuid>> == 2951);
+      static_assert(pgfe::binary_oid_v<
+        std::vector<My_string>> == pgfe::invalid_oid);
+    }
+
     // Arrays
     // =========================================================================
 
@@ -229,6 +516,34 @@ int main()
       DMITIGR_ASSERT(original == converted);
     }
 
+    // Arrays of non-null values in text format (filled directly)
+    {
+      using Vec2 = std::vector<std::list<std::deque<double>>>;
+      const Vec2 original{{{1.5, 2}, {3, 4}}, {{5, 6}, {-7, 8}}};
+      auto data = pgfe::to_data(original);
+      DMITIGR_ASSERT(pgfe::to<Vec2>(*data) == original);
+
+      const std::vector<std::string> strs{"a b", "c,d", "\"q\"", ""};
+      data = pgfe::to_data(strs);
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::string>>(*data) == strs);
+
+      const auto condition_of = [](const std::string& literal, auto type)
+      {
+        try {
+          pgfe::to<decltype(type)>(*pgfe::Data::make(literal));
+        } catch (const pgfe::Client_exception& e) {
+          return e.condition();
+        }
+        return std::error_condition{};
+      };
+      DMITIGR_ASSERT(condition_of("{{1,NULL}}", std::vector<std::vector<int>>{}) ==
+        pgfe::Client_errc::improper_value_type);
+      DMITIGR_ASSERT(condition_of("{{1,2}}", std::vector<int>{}) ==
+        pgfe::Client_errc::insufficient_dimensionality);
+      DMITIGR_ASSERT(condition_of("{\"1\"}", std::vector<std::vector<int>>{}) ==
+        pgfe::Client_errc::excessive_dimensionality);
+    }
+
     // Insufficient array dimensionality
     {
       using Arr  = Vector_array<int>;
@@ -261,6 +576,56 @@ int main()
       DMITIGR_ASSERT(test_ok);
     }
 
+    // Arrays in binary format
+    {
+      using pgfe::Data_format;
+      using Arr2 = Array<Array<int, std::list>, std::vector>;
+      const Arr2 original{List_array<int>{1, std::nullopt, 3},
+        List_array<int>{4, 5, 6}};
+      auto data = pgfe::to_data(original, Data_format::binary);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<Arr2>(*data) == original);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        pgfe::to<std::vector<std::vector<int>>>(*data);
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        pgfe::to<Vector_array<int>>(*data);
+      }));
+
+      const std::vector<std::vector<long long>> vals{{1, 2}, {3, 4}};
+      data = pgfe::to_data(vals, Data_format::binary);
+      DMITIGR_ASSERT((pgfe::to<std::vector<std::vector<long long>>>(*data) == vals));
+
+      const std::vector<std::optional<double>> dbls{0.5, std::nullopt, -1e300,
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
+      data = pgfe::to_data(dbls, Data_format::binary);
+      DMITIGR_ASSERT((pgfe::to<std::vector<std::optional<double>>>(*data) == dbls));
+
+      const std::vector<short> shorts{-1, 0, 1, 32767, -32768};
+      data = pgfe::to_data(shorts, Data_format::binary);
+      DMITIGR_ASSERT((pgfe::to<std::vector<short>>(*data) == shorts));
+      // int2[] elements widened to int.
+      DMITIGR_ASSERT((pgfe::to<std::vector<int>>(*data) ==
+          std::vector<int>{-1, 0, 1, 32767, -32768}));
+
+      const std::vector<std::string> strs{"one", "", "three"};
+      data = pgfe::to_data(strs, Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::string>>(*data) == strs);
+
+      const std::vector<double> empty;
+      data = pgfe::to_data(empty, Data_format::binary);
+      DMITIGR_ASSERT(data->size() == 12);
+      DMITIGR_ASSERT(pgfe::to<std::vector<double>>(*data).empty());
+
+      const std::vector<std::vector<int>> jagged{{1, 2}, {3}};
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&jagged]
+      {
+        pgfe::to_data(jagged, Data_format::binary);
+      }));
+    }
+
     // Array literals
     {
       using Arr = Vector_array<int>;
@@ -387,6 +752,309 @@ int main()
           DMITIGR_ASSERT(cond == pgfe::Client_errc::malformed_literal);
         }
       }
+
+      // Long one-dimensional literals.
+      {
+        Vec vec;
+        std::string literal{"{"};
+        for (int i{}; i < 1000; ++i) {
+          vec.push_back(i * 7 - 3000);
+          literal.append(i ? ", " : "").append(std::to_string(vec.back()));
+        }
+        literal.append("}");
+        DMITIGR_ASSERT(pgfe::to<Vec>(*pgfe::Data::make(literal)) == vec);
+        DMITIGR_ASSERT(pgfe::to<Vec>(*pgfe::to_data(Vec{vec})) == vec);
+        literal.insert(literal.size() - 1, ",null");
+        const auto arr = pgfe::to<Arr>(*pgfe::Data::make(literal));
+        DMITIGR_ASSERT(arr.size() == vec.size() + 1);
+        DMITIGR_ASSERT(arr.front() == vec.front() && !arr.back());
+
+        using Strs = std::vector<std::string>;
+        const Strs strs{"one", "two three", "NULL", "a\"b", "0123456789abcdef"};
+        DMITIGR_ASSERT(pgfe::to<Strs>(*pgfe::to_data(Strs{strs})) == strs);
+        DMITIGR_ASSERT((pgfe::to<Strs>(*pgfe::Data::make(
+                "{alpha, beta,gamma,0123456789abcdef0123456789}")) ==
+            Strs{"alpha", "beta", "gamma", "0123456789abcdef0123456789"}));
+        DMITIGR_ASSERT((pgfe::to<std::vector<double>>(*pgfe::Data::make(
+                "{0.5,1e10,-2.25,3,4,5,6,7,8,9,10}")) ==
+            std::vector<double>{0.5, 1e10, -2.25, 3, 4, 5, 6, 7, 8, 9, 10}));
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+        {
+          pgfe::to<Vec>(*pgfe::Data::make("{1,2,3,4,5,6,7,8,9,10,11,12,,13}"));
+        }));
+      }
+
+      // Literal generation.
+      {
+        const auto to_literal = [](const auto& value)
+        {
+          const auto data = pgfe::to_data(value);
+          return std::string(static_cast<const char*>(data->bytes()),
+            data->size());
+        };
+        DMITIGR_ASSERT(to_literal(Vec{}) == "{}");
+        DMITIGR_ASSERT(to_literal(Vec{1, -2, 3}) == "{1,-2,3}");
+        DMITIGR_ASSERT(to_literal(Arr{1, std::nullopt}) == "{1,NULL}");
+        DMITIGR_ASSERT(to_literal(std::vector<Vec>{{1, 2}, {3, 4}}) ==
+          "{{1,2},{3,4}}");
+
+        using Strs = std::vector<std::string>;
+        const Strs strs{"", "NULL", "a\"b", "c\\d", "\\\"", "{x,y}", " "};
+        DMITIGR_ASSERT(to_literal(strs) ==
+          R"({"","NULL","a\"b","c\\d","\\\"","{x,y}"," "})");
+        DMITIGR_ASSERT(pgfe::to<Strs>(*pgfe::to_data(strs)) == strs);
+
+        std::string quotes(100000, '"');
+        const auto data = pgfe::to_data(Strs{quotes});
+        DMITIGR_ASSERT(data->format() == pgfe::Data_format::text);
+        DMITIGR_ASSERT(data->size() == 2 * quotes.size() + 4);
+        DMITIGR_ASSERT(pgfe::to<Strs>(*data) == Strs{quotes});
+      }
+    }
+
+    // Md_array
+    {
+      using pgfe::Data_format;
+      using Md = pgfe::Md_array<int>;
+      const auto to_literal = [](const Md& value)
+      {
+        const auto data = pgfe::to_data(value);
+        return std::string(static_cast<const char*>(data->bytes()),
+          data->size());
+      };
+
+      // Construction.
+      {
+        const Md empty;
+        DMITIGR_ASSERT(empty.is_empty());
+        DMITIGR_ASSERT(!empty.dimension_count());
+        DMITIGR_ASSERT(to_literal(empty) == "{}");
+
+        Md md{{2, 3}};
+        DMITIGR_ASSERT(md.dimension_count() == 2);
+        DMITIGR_ASSERT(md.size() == 6);
+        DMITIGR_ASSERT((md.lower_bounds() == std::vector<std::int32_t>{1, 1}));
+        DMITIGR_ASSERT(md.index_of({1, 2}) == 5);
+        md.at({1, 0}) = 7;
+        DMITIGR_ASSERT(md[3] == 7);
+        DMITIGR_ASSERT(!md.has_nulls());
+        md.set_null(3);
+        DMITIGR_ASSERT(md.has_nulls() && md.is_null(3) && !md[3]);
+        md.set_null(3, false);
+        DMITIGR_ASSERT(!md.has_nulls());
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&md]
+        {
+          md.index_of({2, 0});
+        }));
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]{Md{{2}, {1}};}));
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]{Md{{-1}};}));
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+        {
+          Md{{1, 1, 1, 1, 1, 1, 1}};
+        }));
+      }
+
+      // Text format.
+      {
+        const auto md = pgfe::to<Md>(*pgfe::Data::make("{{1,2,3},{4,NULL,6}}"));
+        DMITIGR_ASSERT((md.dimensions() == std::vector<std::int32_t>{2, 3}));
+        DMITIGR_ASSERT((md.values() == std::vector<int>{1, 2, 3, 4, 0, 6}));
+        DMITIGR_ASSERT(md.is_null(4) && !md.is_null(5));
+        DMITIGR_ASSERT(to_literal(md) == "{{1,2,3},{4,NULL,6}}");
+
+        auto shifted = pgfe::to<Md>(*pgfe::Data::make("[0:1][-1:0]={{1,2},{3,4}}"));
+        DMITIGR_ASSERT((shifted.lower_bounds() == std::vector<std::int32_t>{0, -1}));
+        DMITIGR_ASSERT(to_literal(shifted) == "[0:1][-1:0]={{1,2},{3,4}}");
+        shifted.set_lower_bounds({1, 1});
+        DMITIGR_ASSERT(to_literal(shifted) == "{{1,2},{3,4}}");
+
+        DMITIGR_ASSERT(pgfe::to<Md>(*pgfe::Data::make("{{},{}}")).is_empty());
+        DMITIGR_ASSERT(pgfe::to<Md>(*pgfe::Data::make("{{{1}},{{2}}}")).
+          dimension_count() == 3);
+        for (const char* const literal : {"{{1,2},{3}}", "{{1},2}", "{1,{2}}",
+            "[1:3]={1,2}", "[1:2={1,2}", "{1"}) {
+          DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([literal]
+          {
+            pgfe::to<Md>(*pgfe::Data::make(literal));
+          }));
+        }
+
+        using Strs = pgfe::Md_array<std::string>;
+        const auto strs = pgfe::to<Strs>(*pgfe::Data::make(R"({{"a,b",c},{"",NULL}})"));
+        DMITIGR_ASSERT((strs.values() == std::vector<std::string>{"a,b", "c", "", ""}));
+        DMITIGR_ASSERT(strs.is_null(3) && !strs.is_null(2));
+        DMITIGR_ASSERT(pgfe::to<Strs>(*pgfe::to_data(strs)) == strs);
+      }
+
+      // Binary format.
+      {
+        auto md = pgfe::to<Md>(*pgfe::Data::make("[0:1][1:2]={{1,2},{NULL,4}}"));
+        const auto data = pgfe::to_data(md, Data_format::binary);
+        DMITIGR_ASSERT(data->format() == Data_format::binary);
+        DMITIGR_ASSERT(pgfe::to<Md>(*data) == md);
+        DMITIGR_ASSERT((pgfe::to<Vector_array<Vector_array<int>>>(*data) ==
+          Vector_array<Vector_array<int>>{Vector_array<int>{1, 2},
+            Vector_array<int>{std::nullopt, 4}}));
+        DMITIGR_ASSERT(pgfe::to<Md>(*pgfe::to_data(Md{}, Data_format::binary)).
+          is_empty());
+        DMITIGR_ASSERT((pgfe::to<Md>(*pgfe::to_data(std::vector<std::vector<int>>{
+                {1, 2, 3}, {4, 5, 6}}, Data_format::binary)).dimensions() ==
+            std::vector<std::int32_t>{2, 3}));
+      }
+    }
+
+    // Arrays of views
+    {
+      using pgfe::Data_format;
+      using Views = std::vector<std::string_view>;
+      using Opt_views = Vector_array<std::string_view>;
+      const auto data = pgfe::Data::make(R"({one, "two, three" ,"",NULL})");
+      const auto* const bytes = static_cast<const char*>(data->bytes());
+      const auto is_view_of_data = [&](const std::string_view view)
+      {
+        return bytes <= view.data() && view.data() + view.size() <= bytes + data->size();
+      };
+      const auto views = pgfe::to<Opt_views>(*data);
+      DMITIGR_ASSERT(views.size() == 4);
+      DMITIGR_ASSERT(views[0] == "one" && is_view_of_data(*views[0]));
+      DMITIGR_ASSERT(views[1] == "two, three" && is_view_of_data(*views[1]));
+      DMITIGR_ASSERT(views[2] == "" && !views[3]);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&data]
+      {
+        pgfe::to<Views>(*data);
+      }));
+      for (const char* const literal : {R"({"a\"b"})", "{{a}}", "{a,}", "{\"a}"}) {
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([literal]
+        {
+          pgfe::to<Views>(*pgfe::Data::make(literal));
+        }));
+      }
+
+      const Views original{"a b", "c\"d", ""};
+      const auto text = pgfe::to_data(original);
+      DMITIGR_ASSERT(pgfe::to<std::vector<std::string>>(*text) ==
+        (std::vector<std::string>{"a b", "c\"d", ""}));
+      const auto binary = pgfe::to_data(original, Data_format::binary);
+      const auto binary_views = pgfe::to<Views>(*binary);
+      DMITIGR_ASSERT(binary_views == original);
+      DMITIGR_ASSERT(static_cast<const void*>(binary_views[0].data()) >
+        binary->bytes());
+      const auto na = pgfe::to<pgfe::Nullable_array<std::string_view>>(*data);
+      DMITIGR_ASSERT(na.size() == 4 && na.is_null(3) && is_view_of_data(na[1]));
+      DMITIGR_ASSERT(pgfe::to<pgfe::Md_array<std::string_view>>(*binary).values() ==
+        original);
+    }
+
+    // Nullable_array
+    {
+      using pgfe::Data_format;
+      using Na = pgfe::Nullable_array<int>;
+      const auto to_literal = [](const auto& value)
+      {
+        const auto data = pgfe::to_data(value);
+        return std::string(static_cast<const char*>(data->bytes()),
+          data->size());
+      };
+
+      Na na{{1, 2, 3}};
+      DMITIGR_ASSERT(na.size() == 3 && !na.has_nulls() && na.nulls().empty());
+      na.push_back_null();
+      na.push_back(5);
+      DMITIGR_ASSERT(na.size() == 5 && na.has_nulls());
+      DMITIGR_ASSERT(na.is_null(3) && !na.is_null(4) && na[4] == 5);
+      DMITIGR_ASSERT(to_literal(na) == "{1,2,3,NULL,5}");
+      DMITIGR_ASSERT(to_literal(Na{}) == "{}");
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        Na{{1}, {false, true}};
+      }));
+
+      // Text format (both the fast path and the general parser).
+      DMITIGR_ASSERT(pgfe::to<Na>(*pgfe::Data::make("{1,2,3,NULL,5}")) == na);
+      DMITIGR_ASSERT(pgfe::to<Na>(*pgfe::Data::make("{\"1\",2,\"3\",NULL,5}")) == na);
+      DMITIGR_ASSERT(pgfe::to<Na>(*pgfe::Data::make("[0:1]={1,2}")).size() == 2);
+      DMITIGR_ASSERT(pgfe::to<Na>(*pgfe::Data::make("{}")).is_empty());
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+      {
+        pgfe::to<Na>(*pgfe::Data::make("{{1,2},{3,4}}"));
+      }));
+
+      using Doubles = pgfe::Nullable_array<double>;
+      const auto doubles = pgfe::to<Doubles>(*pgfe::Data::make("{0.5,null,-2}"));
+      DMITIGR_ASSERT((doubles.values() == std::vector<double>{0.5, 0, -2}));
+      DMITIGR_ASSERT(doubles.is_null(1));
+
+      using Strs = pgfe::Nullable_array<std::string>;
+      const auto strs = pgfe::to<Strs>(*pgfe::Data::make(R"({"a b",NULL,c})"));
+      DMITIGR_ASSERT((strs.values() == std::vector<std::string>{"a b", "", "c"}));
+      DMITIGR_ASSERT(pgfe::to<Strs>(*pgfe::to_data(strs)) == strs);
+
+      // Binary format.
+      const auto data = pgfe::to_data(na, Data_format::binary);
+      DMITIGR_ASSERT(data->format() == Data_format::binary);
+      DMITIGR_ASSERT(pgfe::to<Na>(*data) == na);
+      DMITIGR_ASSERT((pgfe::to<Vector_array<int>>(*data) ==
+          Vector_array<int>{1, 2, 3, std::nullopt, 5}));
+      DMITIGR_ASSERT(pgfe::to<Na>(*pgfe::to_data(Na{}, Data_format::binary)).
+        is_empty());
+
+      auto values = Na{na}.release_values();
+      DMITIGR_ASSERT((values == std::vector<int>{1, 2, 3, 0, 5}));
+    }
+
+    // -------------------------------------------------------------------------
+    // Column decoders
+    // -------------------------------------------------------------------------
+
+    {
+      using pgfe::Column_decoder;
+      using pgfe::Data_format;
+      using pgfe::Data_view;
+
+      // Binary bigint to int.
+      Column_decoder<int> decoder{20, Data_format::binary};
+      DMITIGR_ASSERT(decoder.is_specialized());
+      DMITIGR_ASSERT(decoder(*pgfe::to_data(std::int64_t{-1234},
+            Data_format::binary)) == -1234);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&decoder]
+      {
+        decoder(*pgfe::to_data(std::int64_t{1} << 40, Data_format::binary));
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&decoder]
+      {
+        decoder(*pgfe::to_data(std::int32_t{1}, Data_format::binary));
+      }));
+
+      // Text integer to double.
+      const Column_decoder<double> ddecoder{23, Data_format::text};
+      DMITIGR_ASSERT(ddecoder.is_specialized());
+      DMITIGR_ASSERT(ddecoder(Data_view{"42"}) == 42);
+
+      // Binary float8 to int is not specialized.
+      const Column_decoder<int> fdecoder{701, Data_format::binary};
+      DMITIGR_ASSERT(!fdecoder.is_specialized());
+
+      // Strings, bools and the fallback to Conversions.
+      const Column_decoder<std::string> sdecoder{1043, Data_format::binary};
+      DMITIGR_ASSERT(sdecoder.is_specialized());
+      DMITIGR_ASSERT(sdecoder(Data_view{"dmitigr"}) == "dmitigr");
+      DMITIGR_ASSERT((Column_decoder<bool>{16, Data_format::binary}
+          (*pgfe::to_data(true, Data_format::binary))));
+      DMITIGR_ASSERT(!(Column_decoder<bool>{16, Data_format::text}
+          .is_specialized()));
+      const Column_decoder<int> gdecoder;
+      DMITIGR_ASSERT(!gdecoder.is_specialized());
+      DMITIGR_ASSERT(gdecoder(Data_view{"7"}) == 7);
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&gdecoder]
+      {
+        gdecoder(Data_view{});
+      }));
+
+      // Nullable values.
+      const Column_decoder<std::optional<int>> odecoder{23, Data_format::text};
+      DMITIGR_ASSERT(odecoder.is_specialized());
+      DMITIGR_ASSERT(odecoder(Data_view{"1"}) == 1);
+      DMITIGR_ASSERT(!odecoder(Data_view{}));
     }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
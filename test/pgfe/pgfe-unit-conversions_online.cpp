@@ -19,9 +19,11 @@
 #include "../../src/pgfe/statement.hpp"
 #include "pgfe-unit.hpp"
 
+#include <chrono>
 #include <optional>
 #include <limits>
 #include <string>
+#include <vector>
 
 int main()
 try {
@@ -124,6 +126,65 @@ try {
         DMITIGR_ASSERT(to<bool>(row[1]) == false);
       }, "SELECT true, $1::boolean", false);
     }
+
+    // bytea, uuid, numeric, timestamptz and date
+    {
+      using Time_point = std::chrono::system_clock::time_point;
+      const std::vector<std::byte> bytes{std::byte{0}, std::byte{0xff}};
+      const auto uuid = pgfe::Uuid::from_string("a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11");
+      const pgfe::Numeric numeric{"-12345.06780"};
+      conn->execute([&](auto&& row)
+      {
+        DMITIGR_ASSERT(to<std::vector<std::byte>>(row[0]) == bytes);
+        DMITIGR_ASSERT(to<pgfe::Uuid>(row[1]) == uuid);
+        DMITIGR_ASSERT(to<pgfe::Numeric>(row[2]) == numeric);
+        DMITIGR_ASSERT(to<Time_point>(row[3]) ==
+          to<Time_point>(pgfe::Data_view{"2000-01-02 00:00:01.5+00"}));
+        DMITIGR_ASSERT(to<Time_point>(row[4]) ==
+          to<Time_point>(pgfe::Data_view{"2000-01-02"}));
+      }, "SELECT $1::bytea, $2::uuid, $3::numeric,"
+        " '2000-01-02 03:00:01.5+03'::timestamptz, '2000-01-02'::date",
+        bytes, uuid, numeric);
+    }
+
+    // Md_array
+    {
+      using Matrix = pgfe::Md_array<double>;
+      Matrix matrix{{2, 3}, {1, 2, 3, 4, 5, 6}};
+      matrix.set_null(4);
+      conn->execute([&matrix](auto&& row)
+      {
+        DMITIGR_ASSERT(to<Matrix>(row[0]) == matrix);
+        const auto shifted = to<Matrix>(row[1]);
+        DMITIGR_ASSERT((shifted.lower_bounds() == std::vector<std::int32_t>{0, 1}));
+        DMITIGR_ASSERT(shifted.values() == matrix.values());
+      }, "SELECT $1::float8[], '[0:1][1:3]={{1,2,3},{4,NULL,6}}'::float8[]",
+        matrix);
+    }
+
+    // Arrays of views
+    {
+      conn->execute([](auto&& row)
+      {
+        const auto views = to<std::vector<std::string_view>>(row[0]);
+        DMITIGR_ASSERT((views == std::vector<std::string_view>{"one", "two, three"}));
+        const auto* const bytes = static_cast<const char*>(row[0].bytes());
+        DMITIGR_ASSERT(bytes <= views[0].data() &&
+          views[1].data() < bytes + row[0].size());
+      }, "SELECT '{one,\"two, three\"}'::text[]");
+    }
+
+    // Nullable_array
+    {
+      using Ints = pgfe::Nullable_array<int>;
+      Ints ints{{1, 2, 3}};
+      ints.set_null(1);
+      conn->execute([&ints](auto&& row)
+      {
+        DMITIGR_ASSERT(to<Ints>(row[0]) == ints);
+        DMITIGR_ASSERT(to<Ints>(row[1]) == ints);
+      }, "SELECT $1::int4[], '{1,NULL,3}'::int4[]", ints);
+    }
   }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
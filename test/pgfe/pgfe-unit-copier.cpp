@@ -16,7 +16,13 @@
 
 #include "pgfe-unit.hpp"
 
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <tuple>
 #include <vector>
 
 #define ASSERT DMITIGR_ASSERT
@@ -77,6 +83,264 @@ try {
   ASSERT(conn->is_ready_for_request());
   ASSERT(!conn->is_copy_in_progress());
   ASSERT(!copier);
+
+  // Test buffered send.
+  conn->execute("truncate num");
+  conn->execute("copy num from stdin (format csv)");
+  copier = conn->copier();
+  {
+    pgfe::Copy_writer writer{copier, 64};
+    ASSERT(&writer.copier() == &copier);
+    ASSERT(writer.buffer_capacity() == 64);
+    for (int i{}; i < 1000; ++i) {
+      ASSERT(writer.write(std::to_string(i)));
+      ASSERT(writer.write(",str\n"));
+      ASSERT(writer.buffered_size() < writer.buffer_capacity());
+    }
+    ASSERT(writer.end());
+    ASSERT(!writer.buffered_size());
+  }
+  ASSERT(!copier);
+  conn->wait_response_throw();
+  ASSERT(conn->completion().row_count() == 1000);
+
+  // Test file send.
+  {
+    const auto path = std::filesystem::temp_directory_path() /
+      "pgfe-unit-copier.csv";
+    {
+      std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+      for (int i{}; i < 1000; ++i)
+        file << i << ",str" << i << '\n';
+    }
+    conn->execute("truncate num");
+    conn->execute("copy num from stdin (format csv)");
+    copier = conn->copier();
+    ASSERT(copier.send_file(path, 100) == std::filesystem::file_size(path));
+    copier.end();
+    conn->wait_response_throw();
+    ASSERT(conn->completion().row_count() == 1000);
+    std::filesystem::remove(path);
+  }
+
+  // Test nonblocking send and receive.
+  {
+    using Sr = pgfe::Socket_readiness;
+    const auto wait = [&conn](const Sr sr)
+    {
+      if ((conn->wait_socket_readiness(sr) & Sr::read_ready) == Sr::read_ready)
+        conn->read_input();
+      conn->flush_output();
+    };
+    conn->set_nio_output_enabled(true);
+    conn->execute("truncate num");
+    conn->execute_nio("copy num from stdin (format csv)");
+    while (!conn->flush_output())
+      wait(Sr::read_ready | Sr::write_ready);
+    conn->wait_response_throw();
+    copier = conn->copier();
+    for (int i{}; i < 1000; ++i) {
+      const auto row = std::to_string(i).append(",str\n");
+      for (auto sr = copier.send_nio(row); sr != Sr::unready;
+           sr = copier.send_nio(row))
+        wait(sr);
+    }
+    for (auto sr = copier.end_nio(); sr != Sr::unready; sr = copier.end_nio())
+      wait(sr);
+    ASSERT(!copier);
+    ASSERT(!conn->is_output_flushed());
+    while (!conn->flush_output())
+      wait(Sr::read_ready | Sr::write_ready);
+    conn->wait_response_throw();
+    ASSERT(conn->completion().row_count() == 1000);
+    conn->set_nio_output_enabled(false);
+
+    conn->execute("copy num to stdout (format csv)");
+    copier = conn->copier();
+    int count{};
+    while (true) {
+      pgfe::Data_view data;
+      if (copier.receive_nio(data) != Sr::unready) {
+        conn->wait_socket_readiness(Sr::read_ready);
+        conn->read_input();
+      } else if (data)
+        ++count;
+      else
+        break;
+    }
+    ASSERT(count == 1000);
+    conn->wait_response_throw();
+    ASSERT(conn->completion().row_count() == 1000);
+  }
+
+  // Test batched receive.
+  {
+    conn->execute("copy num to stdout (format csv)");
+    copier = conn->copier();
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&copier]
+    {
+      pgfe::Copier::Batch batch;
+      copier.receive_batch(batch, 0, 1);
+    }));
+    pgfe::Copier::Batch batch;
+    std::string data;
+    std::size_t count{};
+    while (copier.receive_batch(batch, 100, 1024)) {
+      ASSERT(!batch.is_empty());
+      ASSERT(batch.row_count() <= 100);
+      ASSERT(batch.data_format() == pgfe::Data_format::text);
+      for (std::size_t i{}; i < batch.row_count(); ++i) {
+        const auto row = batch.row(i);
+        ASSERT(std::string_view(static_cast<const char*>(row.bytes()),
+            row.size()) == std::to_string(count++).append(",str\n"));
+      }
+      data.append(batch.data());
+    }
+    ASSERT(count == 1000);
+    ASSERT(batch.is_empty());
+    ASSERT(!copier.receive_batch(batch, 100, 1024));
+    conn->wait_response_throw();
+    ASSERT(conn->completion().row_count() == 1000);
+    ASSERT(data.size() == 1000 * 5 + 2890); // "N,str\n" for N in [0, 1000)
+  }
+
+  // Test binary send.
+  conn->execute("create temp table bin(i int4, b int8, f float8, t text,"
+    " n int4, o boolean)");
+  conn->execute("copy bin from stdin (format binary)");
+  copier = conn->copier();
+  ASSERT(copier.data_format(0) == pgfe::Data_format::binary);
+  {
+    pgfe::Copy_writer writer{copier};
+    pgfe::Copy_binary_writer bwriter{writer};
+    ASSERT(&bwriter.writer() == &writer);
+    for (int i{}; i < 10; ++i)
+      ASSERT(bwriter.write_row(i, std::int64_t{i} * 1000000000, i * .5,
+          "str" + std::to_string(i), std::optional<int>{}, i % 2 == 0));
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&bwriter]
+    {
+      bwriter.write_row(1);
+    }));
+    ASSERT(bwriter.end());
+  }
+  conn->wait_response_throw();
+  ASSERT(conn->completion().row_count() == 10);
+  conn->execute([](auto&& r)
+  {
+    ASSERT(pgfe::to<int>(r["i"]) == 9);
+    ASSERT(pgfe::to<std::int64_t>(r["b"]) == 9000000000);
+    ASSERT(pgfe::to<double>(r["f"]) == 4.5);
+    ASSERT(pgfe::to<std::string>(r["t"]) == "str9");
+    ASSERT(!r["n"]);
+    ASSERT(!pgfe::to<bool>(r["o"]));
+  }, "select * from bin where i = 9");
+
+  // Test typed receive.
+  conn->execute("insert into bin values (10, null, 0, e'a\\tb\\\\c', 1, true)");
+  for (const auto format : {pgfe::Copy_reader::Format::text,
+      pgfe::Copy_reader::Format::csv, pgfe::Copy_reader::Format::binary}) {
+    const bool is_text{format == pgfe::Copy_reader::Format::text};
+    const bool is_csv{format == pgfe::Copy_reader::Format::csv};
+    conn->execute(std::string{"copy (select * from bin where i >= 9 order by i)"
+      " to stdout"} + (is_csv ? " (format csv)" : is_text ? "" :
+        " (format binary)"));
+    copier = conn->copier();
+    pgfe::Copy_reader reader{copier, format};
+    ASSERT(&reader.copier() == &copier);
+    ASSERT(reader.format() == format);
+    ASSERT(reader.delimiter() == (is_csv ? ',' : '\t'));
+    ASSERT(reader.read());
+    ASSERT(reader.field_count() == 6);
+    ASSERT(reader.get<int>(0) == 9);
+    ASSERT(reader.get<std::int64_t>(1) == 9000000000);
+    ASSERT(reader.get<double>(2) == 4.5);
+    ASSERT(reader.get<std::string>(3) == "str9");
+    ASSERT(!reader.field(4));
+    ASSERT(!reader.get<std::optional<int>>(4));
+    ASSERT(!reader.get<bool>(5));
+    ASSERT(reader.read());
+    ASSERT(reader.get<int>(0) == 10);
+    ASSERT(!reader.field(1));
+    ASSERT(reader.get<std::string>(3) == "a\tb\\c");
+    ASSERT(reader.get<bool>(5));
+    ASSERT(!reader.read());
+    ASSERT(reader.is_done());
+    conn->wait_response_throw();
+    ASSERT(conn->completion().row_count() == 2);
+  }
+
+  // Test bulk load.
+  conn->execute("create temp table kv(k int4 primary key, v text)");
+  {
+    std::vector<std::tuple<int, std::string>> rows;
+    for (int i{}; i < 100; ++i)
+      rows.emplace_back(i, "v" + std::to_string(i));
+    ASSERT(conn->copy_into("kv", {"k", "v"}, rows) == 100);
+    ASSERT(conn->is_ready_for_request());
+
+    // Upsert.
+    rows = {{1, "one"}, {100, "hundred"}};
+    ASSERT(conn->copy_into("kv", {"k", "v"}, rows, {"k"}) == 2);
+    conn->execute([](auto&& r)
+    {
+      ASSERT(pgfe::to<long>(r[0]) == 101);
+      ASSERT(pgfe::to<std::string>(r[1]) == "one");
+    }, "select count(*), (select v from kv where k = 1) from kv");
+    ASSERT(conn->transaction_status() == pgfe::Transaction_status::unstarted);
+
+    // Upsert within the transaction, including the failed one.
+    conn->execute("begin");
+    ASSERT(conn->copy_into("kv", {"k", "v"}, rows, {"k"}) == 2);
+    ASSERT(conn->transaction_status() == pgfe::Transaction_status::uncommitted);
+    rows = {{1, "one"}, {1, "one"}}; // cannot affect the row twice
+    ASSERT(dmitigr::util::with_catch<pgfe::Server_exception>([&]
+    {
+      conn->copy_into("kv", {"k", "v"}, rows, {"k"});
+    }));
+    conn->execute("rollback");
+    rows = {{2, "two"}};
+    ASSERT(conn->copy_into("kv", {"k", "v"}, rows, {"k"}) == 1);
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&conn]
+    {
+      conn->copy_into("kv", {}, std::vector<std::tuple<int>>{});
+    }));
+  }
+
+  // Test bulk operations via unnest.
+  {
+    const std::vector<int> keys{200, 201, 202};
+    const std::vector<std::optional<std::string>> values{"a", std::nullopt, "c"};
+    ASSERT(conn->insert_unnest("kv", {"k", "v"}, std::tie(keys, values)) == 3);
+    ASSERT(conn->insert_unnest("kv", {"k", "v"}, std::tie(keys, values),
+        "on conflict do nothing") == 0);
+
+    const std::vector<std::string> new_values{"x", "y", "z"};
+    ASSERT(conn->update_unnest("kv", {"k", "v"}, {"k"},
+        std::tie(keys, new_values)) == 3);
+    conn->execute([](auto&& r)
+    {
+      ASSERT(pgfe::to<std::string>(r[0]) == "xyz");
+    }, "select string_agg(v, '' order by k) from kv where k >= 200");
+
+    const std::vector<int> no_keys;
+    const std::vector<std::string> no_values;
+    ASSERT(conn->insert_unnest("kv", {"k", "v"},
+        std::tie(no_keys, no_values)) == 0);
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+    {
+      conn->insert_unnest("kv", {"k", "v"}, std::tie(keys, no_values));
+    }));
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+    {
+      conn->insert_unnest("kv", {"k"}, std::tie(keys, values));
+    }));
+    ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+    {
+      conn->update_unnest("kv", {"k", "v"}, {"v", "k"},
+        std::tie(keys, values));
+    }));
+    ASSERT(conn->is_ready_for_request());
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
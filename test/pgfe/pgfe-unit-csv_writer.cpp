@@ -0,0 +1,144 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+#include "../../src/net/descriptor.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace net = dmitigr::net;
+namespace pgfe = dmitigr::pgfe;
+
+namespace {
+
+// The descriptor which writes into the string by the small portions.
+class String_descriptor final : public net::Descriptor {
+public:
+  std::string data;
+
+  std::streamsize max_read_size() const override { return 0; }
+  std::streamsize max_write_size() const override { return 7; }
+  std::streamsize read(char*, std::streamsize) override { return 0; }
+  std::streamsize write(const char* const buf, const std::streamsize len) override
+  {
+    const auto size = std::min(len, max_write_size());
+    data.append(buf, static_cast<std::size_t>(size));
+    return size;
+  }
+  void close() override {}
+  std::intptr_t native_handle() override { return -1; }
+};
+
+} // namespace
+
+int main()
+try {
+  using pgfe::Csv_writer;
+  using dmitigr::util::with_catch;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+  const std::string query{"select 1 \"a,b\", ''::text, null::text,"
+    " E'q\"\\\\\\t\\n' d, 'plain' e"};
+
+  // CSV to descriptor.
+  {
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+    {
+      String_descriptor descriptor;
+      Csv_writer{descriptor, Csv_writer::Format::csv, 0};
+    }));
+
+    String_descriptor descriptor;
+    Csv_writer writer{descriptor, Csv_writer::Format::csv, 16};
+    DMITIGR_ASSERT(writer.format() == Csv_writer::Format::csv);
+    DMITIGR_ASSERT(writer.block_size() == 16);
+    for (int i{}; i < 3; ++i) {
+      conn->execute([&writer](pgfe::Row_batch&& batch)
+      {
+        if (!writer.row_count())
+          writer.write_header(batch.info());
+        writer.write(batch);
+      }, query);
+    }
+    DMITIGR_ASSERT(writer.row_count() == 3);
+    writer.close();
+    DMITIGR_ASSERT(writer.is_closed());
+    const std::string row{"1,\"\",,\"q\"\"\\\t\n\",plain\n"};
+    DMITIGR_ASSERT(descriptor.data ==
+      "\"a,b\",text,text,d,e\n" + row + row + row);
+    DMITIGR_ASSERT(writer.byte_count() == descriptor.data.size());
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&writer]
+    {
+      writer.write(pgfe::Row_batch{});
+    }));
+  }
+
+  // TSV to file.
+  {
+    const auto path = std::filesystem::temp_directory_path() /
+      "pgfe-unit-csv_writer.tsv";
+    {
+      Csv_writer writer{path, Csv_writer::Format::tsv};
+      conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+      conn->execute([&writer](pgfe::Row&& row)
+      {
+        writer.write(row);
+      }, query);
+      conn->execute([&writer](pgfe::Row&& row)
+      {
+        writer.write(row);
+      }, "select i, repeat('x', i) from generate_series(1, 10000) i");
+      DMITIGR_ASSERT(writer.row_count() == 10001);
+      writer.close();
+    }
+    std::ifstream file{path, std::ios_base::binary};
+    const std::string content{std::istreambuf_iterator<char>{file},
+      std::istreambuf_iterator<char>{}};
+    DMITIGR_ASSERT(content.substr(0, content.find('\n', 0) + 1) ==
+      "1\t\t\\N\tq\"\\\\\\t\\n\tplain\n");
+    DMITIGR_ASSERT(std::count(content.begin(), content.end(), '\n') == 10001);
+    DMITIGR_ASSERT(content.substr(content.size() - 10007) ==
+      "10000\t" + std::string(10000, 'x') + "\n");
+    file.close();
+    std::filesystem::remove(path);
+  }
+
+  // Binary data isn't accepted.
+  {
+    String_descriptor descriptor;
+    Csv_writer writer{descriptor, Csv_writer::Format::csv};
+    conn->set_result_format(pgfe::Data_format::binary);
+    conn->execute([&writer](pgfe::Row&& row)
+    {
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+      {
+        writer.write(row);
+      }));
+    }, "select 1");
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
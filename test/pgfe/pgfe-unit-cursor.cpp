@@ -0,0 +1,93 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  // Outside of transaction.
+  ASSERT(with_catch<pgfe::Client_exception>([&conn]
+  {
+    pgfe::Cursor cursor{*conn, "select 1"};
+  }));
+
+  conn->execute("begin");
+  {
+    pgfe::Cursor cursor{*conn, "select generate_series(1, $1) n", 2500};
+    ASSERT(&cursor.connection() == conn.get());
+    ASSERT(!cursor.name().empty());
+    ASSERT(cursor.fetch_size() == pgfe::Cursor::default_fetch_size);
+    ASSERT(!cursor.is_fetch_pending());
+    ASSERT(!cursor.is_exhausted());
+    ASSERT(!cursor.is_closed());
+
+    // Fetch ahead.
+    auto batch = cursor.fetch();
+    ASSERT(batch);
+    ASSERT(batch.row_count() == 1000);
+    ASSERT(pgfe::to<int>(batch.data(0, 0)) == 1);
+    ASSERT(cursor.is_fetch_pending());
+    ASSERT(!conn->is_ready_for_request());
+
+    // Iterate.
+    cursor.set_fetch_size(700);
+    ASSERT(cursor.fetch_size() == 700);
+    int expected{1001};
+    std::size_t batch_count{};
+    for (const auto& b : cursor) {
+      for (std::size_t i{}; i < b.row_count(); ++i)
+        ASSERT(pgfe::to<int>(b.data(i, 0)) == expected++);
+      ++batch_count;
+    }
+    ASSERT(expected == 2501);
+    ASSERT(batch_count == 3); // 1000 + 700 + 800
+    ASSERT(cursor.is_exhausted());
+    ASSERT(!cursor.is_fetch_pending());
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(!cursor.fetch());
+  }
+  {
+    // Close with the pending fetch.
+    pgfe::Cursor cursor{*conn, "select generate_series(1, 10)"};
+    cursor.set_fetch_size(3);
+    ASSERT(cursor.fetch().row_count() == 3);
+    ASSERT(cursor.is_fetch_pending());
+    cursor.close();
+    ASSERT(cursor.is_closed());
+    ASSERT(conn->is_ready_for_request());
+    ASSERT(with_catch<pgfe::Client_exception>([&cursor]
+    {
+      cursor.fetch();
+    }));
+  }
+  conn->execute("commit");
+  ASSERT(conn->is_ready_for_request());
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -125,6 +125,77 @@ int main()
       ASSERTMENTS;
 #undef ASSERTMENTS
     }
+
+    // Inline_data
+    {
+      const pgfe::Inline_data empty;
+      DMITIGR_ASSERT(empty.format() == pgfe::Data_format::text);
+      DMITIGR_ASSERT(empty.is_empty());
+      const pgfe::Inline_data d{"Dmitry", 6, pgfe::Data_format::binary};
+      DMITIGR_ASSERT(d.format() == pgfe::Data_format::binary);
+      DMITIGR_ASSERT(d.size() == 6);
+      DMITIGR_ASSERT(static_cast<const char*>(d.bytes())[d.size()] == '\0');
+      const auto copy = d.to_data();
+      DMITIGR_ASSERT(*copy == d);
+      const std::string large(pgfe::Inline_data::capacity + 1, 'x');
+      bool is_thrown{};
+      try {
+        pgfe::Inline_data{large.data(), large.size()};
+      } catch (const pgfe::Client_exception&) {
+        is_thrown = true;
+      }
+      DMITIGR_ASSERT(is_thrown);
+
+      // Data::make() makes inline data for the small size.
+      DMITIGR_ASSERT(dynamic_cast<pgfe::Inline_data*>(pgfe::Data::make("small").get()));
+      DMITIGR_ASSERT(!dynamic_cast<pgfe::Inline_data*>(pgfe::Data::make(large).get()));
+      DMITIGR_ASSERT(to<std::string>(*pgfe::Data::make(large)) == large);
+    }
+
+    // Data_arena
+    {
+      pgfe::Data_arena arena{64};
+      DMITIGR_ASSERT(arena.block_size() == 64);
+      DMITIGR_ASSERT(arena.is_empty());
+      DMITIGR_ASSERT(!arena.capacity());
+
+      const auto& d1 = arena.make("Dmitry Igrishin");
+      DMITIGR_ASSERT(d1.format() == pgfe::Data_format::text);
+      DMITIGR_ASSERT(to<std::string_view>(d1) == "Dmitry Igrishin");
+      DMITIGR_ASSERT(static_cast<const char*>(d1.bytes())[d1.size()] == '\0');
+      const auto& d2 = arena.make("", pgfe::Data_format::binary);
+      DMITIGR_ASSERT(d2.format() == pgfe::Data_format::binary);
+      DMITIGR_ASSERT(d2.is_empty());
+      const auto& d3 = arena.to_data(-1234);
+      DMITIGR_ASSERT(to<int>(d3) == -1234);
+      const auto& d4 = arena.to_data(0.5);
+      DMITIGR_ASSERT(to<double>(d4) == 0.5);
+      const auto& d5 = arena.to_data(std::string(100, 'x'));
+      DMITIGR_ASSERT(to<std::string>(d5) == std::string(100, 'x'));
+      const auto& d6 = arena.to_data(true);
+      DMITIGR_ASSERT(to<bool>(d6));
+      const auto& d7 = arena.to_data(7, pgfe::Data_format::binary);
+      DMITIGR_ASSERT(d7.format() == pgfe::Data_format::binary);
+      DMITIGR_ASSERT(to<int>(d7) == 7);
+      DMITIGR_ASSERT(arena.size() == 7);
+      DMITIGR_ASSERT(to<std::string_view>(d1) == "Dmitry Igrishin");
+
+      // The blocks are reused after clear.
+      const auto capacity = arena.capacity();
+      DMITIGR_ASSERT(capacity >= 64);
+      arena.clear();
+      DMITIGR_ASSERT(arena.is_empty());
+      DMITIGR_ASSERT(arena.capacity() == capacity);
+      for (int i{}; i < 3; ++i)
+        arena.to_data(i);
+      DMITIGR_ASSERT(arena.size() == 3);
+      DMITIGR_ASSERT(arena.capacity() == capacity);
+
+      // Move.
+      pgfe::Data_arena arena2{std::move(arena)};
+      DMITIGR_ASSERT(arena2.size() == 3);
+      DMITIGR_ASSERT(arena2.capacity() == capacity);
+    }
   } catch (std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
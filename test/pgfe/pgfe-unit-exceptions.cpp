@@ -23,6 +23,35 @@
 int main()
 try {
   namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+  using pgfe::Problem;
+  using pgfe::Server_errc;
+
+  // SQLSTATE conversions.
+  static_assert(Problem::sqlstate_to_int("00000") == 0);
+  static_assert(Problem::sqlstate_to_int("23505") ==
+    static_cast<int>(Server_errc::c23_unique_violation));
+  static_assert(Problem::sqlstate_to_int("42601") ==
+    static_cast<int>(Server_errc::c42_syntax_error));
+  static_assert(Problem::sqlstate_to_int("XX002") ==
+    static_cast<int>(Server_errc::cxx_index_corrupted));
+  static_assert(Problem::sqlstate_to_int("ZZZZZ") == 60466175);
+  static_assert(Problem::sqlstate_to_int("xx002") ==
+    Problem::sqlstate_to_int("XX002"));
+  static_assert(Problem::sqlstate_to_int("2350") == -1);
+  static_assert(Problem::sqlstate_to_int("235055") == -1);
+  static_assert(Problem::sqlstate_to_int("23-05") == -1);
+  ASSERT(Problem::sqlstate_string_to_int("23505") ==
+    static_cast<int>(Server_errc::c23_unique_violation));
+  ASSERT(Problem::sqlstate_int_to_string(
+      static_cast<int>(Server_errc::c23_unique_violation)) == "23505");
+  ASSERT(with_catch<pgfe::Client_exception>([]
+  {
+    Problem::sqlstate_string_to_int("2350!");
+  }));
+  ASSERT(pgfe::server_error_category().message(
+      static_cast<int>(Server_errc::c23_unique_violation)).find(
+        "c23_unique_violation (23505)") != std::string::npos);
 
   auto conn = pgfe::test::make_connection();
   try {
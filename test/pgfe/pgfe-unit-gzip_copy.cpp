@@ -0,0 +1,60 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <filesystem>
+#include <string>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("create temp table num(id integer not null, str text)");
+  conn->execute("insert into num select i, 'str' || i"
+    " from generate_series(1, 10000) i");
+  const auto path = std::filesystem::temp_directory_path() /
+    "pgfe-unit-gzip_copy.csv.gz";
+
+  // Export.
+  conn->execute("copy num to stdout (format csv)");
+  auto copier = conn->copier();
+  const auto size = pgfe::copy_to_gzip_file(copier, path, 6, 1024);
+  ASSERT(size > 0);
+  ASSERT(std::filesystem::file_size(path) < size);
+  conn->wait_response_throw();
+  ASSERT(conn->completion().row_count() == 10000);
+
+  // Import.
+  conn->execute("truncate num");
+  conn->execute("copy num from stdin (format csv)");
+  copier = conn->copier();
+  ASSERT(pgfe::copy_from_gzip_file(copier, path, 1000) == size);
+  copier.end();
+  conn->wait_response_throw();
+  ASSERT(conn->completion().row_count() == 10000);
+  std::filesystem::remove(path);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,80 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using std::chrono::milliseconds;
+  const auto options = pgfe::test::connection_options();
+  pgfe::Routing_connection_pool pool{1, options, {options}};
+  pool.connect();
+
+  pgfe::Hedged_read_executor executor{pool};
+  DMITIGR_ASSERT(&executor.pool() == &pool);
+  DMITIGR_ASSERT(!executor.hedge_delay());
+  DMITIGR_ASSERT(executor.hedge_percentile() ==
+    pgfe::Hedged_read_executor::default_hedge_percentile);
+  DMITIGR_ASSERT(!executor.effective_hedge_delay());
+
+  // Not hedged until enough latencies are recorded.
+  executor.set_min_sample_count(2);
+  for (int i{}; i < 2; ++i) {
+    int value{};
+    executor.execute([&value](auto&& row)
+    {
+      value = pgfe::to<int>(row[0]);
+    }, "select $1::int", i);
+    DMITIGR_ASSERT(value == i);
+  }
+  DMITIGR_ASSERT(executor.latencies().count() == 2);
+  DMITIGR_ASSERT(executor.effective_hedge_delay());
+  DMITIGR_ASSERT(!executor.hedged_request_count());
+
+  // The slow replica is hedged by the primary.
+  const auto replica_pid = pool.replica(0).try_connection()->server_pid();
+  executor.set_hedge_delay(milliseconds{50});
+  DMITIGR_ASSERT(executor.effective_hedge_delay() == milliseconds{50});
+  int row_count{};
+  executor.execute([&row_count](auto&&)
+  {
+    ++row_count;
+  }, "select pg_sleep(case when pg_backend_pid() = $1 then 5 else 0 end)",
+    replica_pid);
+  DMITIGR_ASSERT(row_count == 1);
+  DMITIGR_ASSERT(executor.hedged_request_count() == 1);
+  DMITIGR_ASSERT(executor.hedge_win_count() == 1);
+
+  // The loser is returned to the pool ready for request.
+  {
+    auto conn = pool.replica(0).try_connection();
+    DMITIGR_ASSERT(conn);
+    DMITIGR_ASSERT(conn->is_ready_for_request());
+  }
+
+  DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&executor]
+  {
+    executor.set_hedge_percentile(0);
+  }));
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
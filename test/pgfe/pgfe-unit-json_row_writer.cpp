@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <optional>
+#include <string>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using pgfe::Json_row_writer;
+  using dmitigr::util::with_catch;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  const std::string query{"select 1::int2 a, -2::int4, 3::int8 \"c\"\"d\","
+    " true e, 0.5::float8 f, 'NaN'::float4 g, '-1.50'::numeric h,"
+    " '{\"k\": [1, null]}'::jsonb j, '[1,2]'::json k,"
+    " E'q\"\\\\\\n\\x01й'::text l, '\\x0aff'::bytea m,"
+    " '00000000-0000-0000-0000-000000000001'::uuid n, null::int o"};
+  const std::string expected{"{\"a\":1,\"int4\":-2,\"c\\\"d\":3,\"e\":true,"
+    "\"f\":0.5,\"g\":\"NaN\",\"h\":-1.50,\"j\":{\"k\": [1, null]},\"k\":[1,2],"
+    "\"l\":\"q\\\"\\\\\\n\\u0001й\",\"m\":\"\\\\x0aff\","
+    "\"n\":\"00000000-0000-0000-0000-000000000001\",\"o\":null}"};
+
+  for (const auto format : {pgfe::Data_format::text, pgfe::Data_format::binary}) {
+    conn->set_result_format(format);
+
+    // Rows.
+    {
+      std::optional<Json_row_writer> writer;
+      std::string output{'['};
+      for (int i{}; i < 2; ++i) {
+        conn->execute([&](pgfe::Row&& row)
+        {
+          if (!writer)
+            writer.emplace(row.info());
+          writer->write(output, row);
+        }, query);
+      }
+      output += ']';
+      DMITIGR_ASSERT(writer->field_count() == 13);
+      DMITIGR_ASSERT(writer->row_count() == 2);
+      DMITIGR_ASSERT(output == "[" + expected + "," + expected + "]");
+      writer->reset();
+      DMITIGR_ASSERT(!writer->row_count());
+    }
+
+    // Batches.
+    {
+      conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+      std::string output;
+      conn->execute([&output](pgfe::Row_batch&& batch)
+      {
+        Json_row_writer writer{batch.info()};
+        writer.write(output, batch);
+        DMITIGR_ASSERT(writer.row_count() == 3);
+
+        // The output is unchanged on failure.
+        const auto size = output.size();
+        DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+        {
+          writer.write(output, pgfe::Row_batch{});
+        }));
+        DMITIGR_ASSERT(output.size() == size);
+      }, "select i, repeat('x\"', i) s from generate_series(1, 3) i");
+      DMITIGR_ASSERT(output == "{\"i\":1,\"s\":\"x\\\"\"},"
+        "{\"i\":2,\"s\":\"x\\\"x\\\"\"},{\"i\":3,\"s\":\"x\\\"x\\\"x\\\"\"}");
+      conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+    }
+
+    // The long strings are scanned by blocks.
+    conn->execute([](pgfe::Row&& row)
+    {
+      std::string output;
+      Json_row_writer{row.info()}.write(output, row);
+      DMITIGR_ASSERT(output == "{\"s\":\"" + std::string(40, 'a') + "\\t" +
+        std::string(40, 'b') + "\"}");
+    }, "select repeat('a', 40) || E'\\t' || repeat('b', 40) s");
+  }
+
+  // Unsupported binary data.
+  conn->set_result_format(pgfe::Data_format::binary);
+  conn->execute([](pgfe::Row&& row)
+  {
+    std::string output;
+    Json_row_writer writer{row.info()};
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      writer.write(output, row);
+    }));
+    DMITIGR_ASSERT(output.empty());
+  }, "select current_date");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
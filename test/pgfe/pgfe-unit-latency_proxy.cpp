@@ -0,0 +1,155 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-latency_proxy.hpp"
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define ASSERT DMITIGR_ASSERT
+
+namespace {
+
+namespace net = dmitigr::net;
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+constexpr int echo_port{15433};
+constexpr int proxy_port{15434};
+
+/// Serves one connection by sending back everything received.
+void echo(net::Listener& listener)
+{
+  listener.wait();
+  const auto conn = listener.accept();
+  std::string buffer(4096, '\0');
+  while (const auto size = conn->read(buffer.data(),
+      static_cast<std::streamsize>(buffer.size())))
+    for (std::streamsize written{}; written < size;)
+      written += conn->write(buffer.data() + written, size - written);
+}
+
+/// @returns The time of sending `data` through `conn` and receiving it back.
+milliseconds round_trip(net::Descriptor& conn, const std::string& data)
+{
+  const auto start = Clock::now();
+  for (std::size_t written{}; written < data.size();)
+    written += static_cast<std::size_t>(conn.write(data.data() + written,
+        static_cast<std::streamsize>(data.size() - written)));
+  std::string received(data.size(), '\0');
+  for (std::size_t read{}; read < received.size();) {
+    const auto size = conn.read(received.data() + read,
+      static_cast<std::streamsize>(received.size() - read));
+    ASSERT(size > 0);
+    read += static_cast<std::size_t>(size);
+  }
+  ASSERT(received == data);
+  return std::chrono::duration_cast<milliseconds>(Clock::now() - start);
+}
+
+} // namespace
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::test::Latency_proxy;
+  using pgfe::test::Latency_proxy_options;
+  using dmitigr::util::with_catch;
+
+  // Offline.
+  {
+    Latency_proxy_options options;
+    options.delay = milliseconds{-1};
+    ASSERT(with_catch<std::invalid_argument>([&]{Latency_proxy{options};}));
+    options.delay = milliseconds{1};
+    options.jitter = milliseconds{2};
+    ASSERT(with_catch<std::invalid_argument>([&]{Latency_proxy{options};}));
+  }
+
+  // Latency and bandwidth (through the echo server).
+  {
+    const auto listener = net::Listener::make({"127.0.0.1", echo_port, 8});
+    listener->listen();
+    std::thread echo_server{[&listener]{echo(*listener);}};
+
+    Latency_proxy_options options;
+    options.port = proxy_port;
+    options.upstream_port = echo_port;
+    options.delay = milliseconds{20};
+    options.jitter = milliseconds{5};
+    options.bandwidth = 100000;
+    {
+      Latency_proxy proxy{options};
+      ASSERT(proxy.port() == proxy_port);
+      const auto conn = net::make_tcp_connection({"127.0.0.1", proxy_port});
+
+      // The delay is added in both directions.
+      const auto small = round_trip(*conn, "ping");
+      ASSERT(small >= milliseconds{30});
+
+      // 20000 bytes at 100000 bytes/s take about 200 ms.
+      const auto large = round_trip(*conn, std::string(20000, 'x'));
+      ASSERT(large >= milliseconds{150});
+
+      ASSERT(proxy.connection_count() == 1);
+      ASSERT(proxy.upstream_byte_count() == 20004);
+      ASSERT(proxy.downstream_byte_count() == 20004);
+    }
+    echo_server.join();
+  }
+
+  // Pipelining through the proxy.
+  {
+    Latency_proxy_options options;
+    options.port = proxy_port;
+    options.delay = milliseconds{10};
+    Latency_proxy proxy{options};
+    pgfe::Connection conn{pgfe::test::connection_options().set_port(
+        proxy.port())};
+    conn.connect();
+
+    constexpr int query_count{10};
+    auto start = Clock::now();
+    for (int i{}; i < query_count; ++i)
+      conn.execute("select 1");
+    const auto sequential_time = Clock::now() - start;
+    ASSERT(sequential_time >= query_count * 2 * options.delay);
+
+    conn.set_pipeline_enabled(true);
+    start = Clock::now();
+    for (int i{}; i < query_count; ++i)
+      conn.execute_nio("select 1");
+    conn.send_sync();
+    for (int i{}; i < query_count; ++i) {
+      conn.wait_response_throw();
+      ASSERT(conn.row());
+      conn.wait_response_throw();
+      ASSERT(conn.completion());
+    }
+    conn.wait_response_throw();
+    ASSERT(conn.ready_for_query());
+    const auto pipelined_time = Clock::now() - start;
+    ASSERT(pipelined_time < sequential_time / 2);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -14,9 +14,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "../../src/net/descriptor.hpp"
 #include "../../src/str/stream.hpp"
 #include "pgfe-unit.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
 #include <string_view>
 
 #define ASSERT DMITIGR_ASSERT
@@ -130,6 +137,106 @@ try {
   conn->execute("begin");
   conn->remove_large_object(oid);
   conn->execute("end");
+
+  /*
+   * Test stream buffer.
+   */
+  {
+    std::string expected;
+    for (int i{}; i < 100000; ++i)
+      expected.append(std::to_string(i)).append(1, '\n');
+
+    conn->execute("begin");
+    oid = conn->create_large_object();
+    ASSERT(oid != pgfe::invalid_oid);
+    lob.assign(conn->open_large_object(oid,
+        pgfe::Large_object_open_mode::writing |
+        pgfe::Large_object_open_mode::reading));
+    ASSERT(lob);
+    {
+      // Write.
+      pgfe::Large_object_streambuf lobuf{lob, 4096, 4};
+      ASSERT(&lobuf.large_object() == &lob);
+      ASSERT(lobuf.chunk_size() == 4096);
+      ASSERT(lobuf.read_ahead() == 4);
+      std::ostream out{&lobuf};
+      out << expected;
+      ASSERT(out.flush());
+      ASSERT(lob.tell() == static_cast<std::int_fast64_t>(expected.size()));
+
+      // Read with read-ahead.
+      std::istream in{&lobuf};
+      ASSERT(in.seekg(0));
+      std::ostringstream received;
+      received << in.rdbuf();
+      ASSERT(received.str() == expected);
+      ASSERT(conn->is_ready_for_request());
+
+      // Seek within the buffered data.
+      in.clear();
+      ASSERT(in.seekg(7));
+      char c{};
+      ASSERT(in.get(c) && c == expected[7]);
+      ASSERT(in.tellg() == 8);
+      std::string line;
+      ASSERT(std::getline(in, line) && line == "4");
+    }
+    {
+      // Read without read-ahead.
+      ASSERT(lob.seek(0, pgfe::Large_object_seek_whence::begin) == 0);
+      pgfe::Large_object_streambuf lobuf{lob, 1000, 1};
+      std::istream in{&lobuf};
+      std::ostringstream received;
+      received << in.rdbuf();
+      ASSERT(received.str() == expected);
+    }
+    {
+      // Read into the caller buffer.
+      ASSERT(lob.seek(0, pgfe::Large_object_seek_whence::begin) == 0);
+      std::string received(expected.size() + 10, '\0');
+      ASSERT(lob.read_into(received.data(), received.size()) == expected.size());
+      received.resize(expected.size());
+      ASSERT(received == expected);
+    }
+    {
+      // Send to the descriptor.
+      struct String_descriptor final : dmitigr::net::Descriptor {
+        std::string data;
+        std::streamsize max_read_size() const override { return 0; }
+        std::streamsize max_write_size() const override { return 1000; }
+        std::streamsize read(char*, std::streamsize) override { return 0; }
+        std::streamsize write(const char* const buf, std::streamsize len) override
+        {
+          len = std::min(len, max_write_size());
+          data.append(buf, static_cast<std::size_t>(len));
+          return len;
+        }
+        void close() override {}
+        std::intptr_t native_handle() override { return -1; }
+      } descriptor;
+      ASSERT(lob.seek(0, pgfe::Large_object_seek_whence::begin) == 0);
+      ASSERT(lob.send_to(descriptor, 4096) == expected.size());
+      ASSERT(descriptor.data == expected);
+    }
+    {
+      // Read the range in a single round trip.
+      const auto range = conn->read_large_object_range(oid, 2, 5);
+      ASSERT(range.size() == 5);
+      ASSERT(std::equal(range.cbegin(), range.cend(),
+          expected.cbegin() + 2, [](const auto b, const char c)
+          {
+            return static_cast<char>(b) == c;
+          }));
+      std::string tail(10, '\0');
+      ASSERT(conn->read_large_object_range(oid,
+          static_cast<std::int_fast64_t>(expected.size() - 3), tail.data(),
+          tail.size()) == 3);
+      ASSERT(tail.compare(0, 3, expected, expected.size() - 3) == 0);
+    }
+    lob.close();
+    conn->remove_large_object(oid);
+    conn->execute("end");
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -0,0 +1,90 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/pgfe/exceptions.hpp"
+#include "../../src/pgfe/metrics.hpp"
+
+#include <iostream>
+#include <thread>
+
+int main()
+{
+  try {
+    namespace pgfe = dmitigr::pgfe;
+    using namespace std::chrono_literals;
+    using pgfe::Duration_histogram;
+
+    DMITIGR_ASSERT(Duration_histogram::bucket_upper_bound(0) == 1us);
+    DMITIGR_ASSERT(Duration_histogram::bucket_upper_bound(1) == 2us);
+    DMITIGR_ASSERT(Duration_histogram::bucket_upper_bound(10) == 1024us);
+
+    Duration_histogram h;
+    DMITIGR_ASSERT(!h.count());
+    DMITIGR_ASSERT(h.percentile(50) == 0ns);
+
+    h.record(500ns);
+    h.record(1us);
+    h.record(3us);
+    h.record(1000us);
+    DMITIGR_ASSERT(h.count() == 4);
+    DMITIGR_ASSERT(h.sum() == 500ns + 1us + 3us + 1000us);
+    DMITIGR_ASSERT(h.max() == 1000us);
+    DMITIGR_ASSERT(h.bucket(0) == 1);
+    DMITIGR_ASSERT(h.bucket(1) == 1);
+    DMITIGR_ASSERT(h.bucket(2) == 1);
+    DMITIGR_ASSERT(h.bucket(10) == 1);
+    DMITIGR_ASSERT(h.percentile(25) == 1us);
+    DMITIGR_ASSERT(h.percentile(50) == 2us);
+    DMITIGR_ASSERT(h.percentile(100) == 1000us);
+
+    h.record(100h);
+    DMITIGR_ASSERT(h.bucket(Duration_histogram::bucket_count - 1) == 1);
+
+    h.reset();
+    DMITIGR_ASSERT(!h.count());
+    DMITIGR_ASSERT(h.sum() == 0ns);
+    DMITIGR_ASSERT(h.max() == 0ns);
+
+    // Query tags.
+    DMITIGR_ASSERT(pgfe::query_tag().empty());
+    pgfe::set_query_tag("request 1");
+    DMITIGR_ASSERT(pgfe::query_tag() == "request 1");
+    {
+      const pgfe::Query_tag_guard guard{"request 2"};
+      DMITIGR_ASSERT(pgfe::query_tag() == "request 2");
+      std::thread{[]{DMITIGR_ASSERT(pgfe::query_tag().empty());}}.join();
+    }
+    DMITIGR_ASSERT(pgfe::query_tag() == "request 1");
+    for (const char* const tag : {"*/ DROP TABLE t; /*", "nested /* comment"}) {
+      bool is_thrown{};
+      try {
+        pgfe::set_query_tag(tag);
+      } catch (const pgfe::Client_exception&) {
+        is_thrown = true;
+      }
+      DMITIGR_ASSERT(is_thrown);
+      DMITIGR_ASSERT(pgfe::query_tag() == "request 1");
+    }
+    pgfe::set_query_tag({});
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,196 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::to;
+  using std::chrono::milliseconds;
+
+  pgfe::Notification_dispatcher dispatcher{pgfe::test::connection_options()};
+  ASSERT(!dispatcher.connection().is_connected());
+  ASSERT(dispatcher.worker_count() == 0);
+
+  int cache_count{};
+  int other_count{};
+  dispatcher.subscribe("pgfe_cache", [&cache_count](const auto& n)
+  {
+    ASSERT(n.channel_name() == "pgfe_cache");
+    ASSERT(to<std::string_view>(n.payload()) == std::to_string(cache_count));
+    ++cache_count;
+  });
+  dispatcher.subscribe("pgfe_other", [&other_count](const auto&)
+  {
+    ++other_count;
+  });
+  ASSERT(dispatcher.is_subscribed("pgfe_cache"));
+  ASSERT(dispatcher.is_subscribed("pgfe_other"));
+  ASSERT(!dispatcher.is_subscribed("pgfe_none"));
+  dispatcher.connect();
+  ASSERT(dispatcher.connection().is_connected());
+  ASSERT(dispatcher.dispatch() == 0);
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  const auto notify = [&conn](const char* const channel, const int count)
+  {
+    conn->execute("begin");
+    for (int i{}; i < count; ++i)
+      conn->execute("select pg_notify($1, $2)", channel, std::to_string(i));
+    conn->execute("commit");
+  };
+  const auto dispatch = [&dispatcher](const std::size_t count)
+  {
+    std::size_t result{};
+    while (result < count)
+      result += dispatcher.dispatch(milliseconds{1000});
+    ASSERT(result == count);
+  };
+
+  // Batched dispatching in the calling thread.
+  notify("pgfe_cache", 100);
+  notify("pgfe_other", 10);
+  notify("pgfe_none", 10);
+  dispatch(110); // pgfe_none is not listened
+  ASSERT(cache_count == 100);
+  ASSERT(other_count == 10);
+
+  // Unsubscribe.
+  dispatcher.unsubscribe("pgfe_other");
+  ASSERT(!dispatcher.is_subscribed("pgfe_other"));
+  notify("pgfe_other", 10);
+  ASSERT(dispatcher.dispatch(milliseconds{100}) == 0);
+
+  // Unsubscribe by the subscriber.
+  {
+    int count{};
+    dispatcher.subscribe("pgfe_once", [&dispatcher, &count](const auto&)
+    {
+      ++count;
+      dispatcher.unsubscribe("pgfe_once");
+    });
+    notify("pgfe_once", 3);
+    dispatch(3);
+    ASSERT(count == 1);
+    ASSERT(!dispatcher.is_subscribed("pgfe_once"));
+  }
+
+  // Dispatching by workers.
+  {
+    std::atomic_int count{};
+    dispatcher.subscribe("pgfe_worker", [&count](const auto&){++count;});
+    dispatcher.set_worker_count(2);
+    ASSERT(dispatcher.worker_count() == 2);
+    cache_count = 0;
+    notify("pgfe_cache", 100);
+    notify("pgfe_worker", 100);
+    dispatch(200);
+    dispatcher.set_worker_count(0); // waits for the workers
+    ASSERT(cache_count == 100);
+    ASSERT(count == 100);
+  }
+
+  // Coalescing.
+  {
+    ASSERT(!dispatcher.coalescing_window());
+    dispatcher.set_coalescing_window(milliseconds{200});
+    ASSERT(dispatcher.coalescing_window() == milliseconds{200});
+    int count{};
+    dispatcher.subscribe("pgfe_coalesce", [&count](const auto&){++count;});
+    for (int i{}; i < 10; ++i)
+      notify("pgfe_coalesce", 3); // the payloads are "0", "1" and "2"
+    std::size_t dispatched{};
+    for (int i{}; i < 10 && !dispatched; ++i)
+      dispatched = dispatcher.dispatch(milliseconds{1000});
+    ASSERT(dispatched == 3);
+    ASSERT(count == 3);
+    dispatcher.set_coalescing_window(std::nullopt);
+    ASSERT(!dispatcher.coalescing_window());
+  }
+
+  // Result cache invalidation.
+  {
+    pgfe::Result_cache cache{2};
+    ASSERT(cache.capacity() == 2);
+    ASSERT(!cache.ttl());
+    cache.listen(dispatcher, "pgfe_result_cache");
+    auto ps = conn->prepare("select $1::integer + 1", "pgfe_rc");
+    auto result = cache.execute(ps, 1);
+    ASSERT(result && result->row_count() == 1);
+    ASSERT(to<int>(result->data(0, 0)) == 2);
+    ASSERT(cache.execute(ps, 1) == result);
+    ASSERT(cache.hit_count() == 1 && cache.miss_count() == 1);
+    ASSERT(to<int>(cache.execute(ps, 2)->data(0, 0)) == 3);
+    ASSERT(cache.size() == 2);
+
+    // Eviction of the least recently used result.
+    cache.execute(ps, 3);
+    ASSERT(cache.size() == 2);
+    cache.execute(ps, 1);
+    ASSERT(cache.miss_count() == 4);
+
+    // Invalidation by notification.
+    conn->execute("select pg_notify('pgfe_result_cache', 'pgfe_other')");
+    dispatch(1);
+    ASSERT(cache.size() == 2);
+    conn->execute("select pg_notify('pgfe_result_cache', 'pgfe_rc')");
+    dispatch(1);
+    ASSERT(cache.size() == 0);
+    cache.execute(ps, 1);
+    conn->execute("select pg_notify('pgfe_result_cache', '')");
+    dispatch(1);
+    ASSERT(cache.size() == 0);
+
+    // Expiration.
+    cache.set_ttl(milliseconds{10});
+    result = cache.execute(ps, 1);
+    ASSERT(cache.execute(ps, 1) == result);
+    std::this_thread::sleep_for(milliseconds{20});
+    ASSERT(cache.execute(ps, 1) != result);
+    dispatcher.unsubscribe("pgfe_result_cache");
+  }
+
+  // Exception of subscriber.
+  dispatcher.subscribe("pgfe_error", [](const auto&)
+  {
+    throw std::runtime_error{"subscriber error"};
+  });
+  notify("pgfe_error", 1);
+  bool is_thrown{};
+  try {
+    dispatch(1);
+  } catch (const std::runtime_error&) {
+    is_thrown = true;
+  }
+  ASSERT(is_thrown);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
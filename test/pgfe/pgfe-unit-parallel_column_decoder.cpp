@@ -0,0 +1,120 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using pgfe::Parallel_column_decoder;
+  using dmitigr::util::with_catch;
+
+  // Offline.
+  {
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+    {
+      Parallel_column_decoder{0};
+    }));
+    Parallel_column_decoder decoder{4};
+    DMITIGR_ASSERT(decoder.worker_count() == 4);
+    DMITIGR_ASSERT(Parallel_column_decoder{}.worker_count() > 0);
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&decoder]
+    {
+      decoder.set_min_range_size(0);
+    }));
+    decoder.set_min_range_size(10);
+    DMITIGR_ASSERT(decoder.min_range_size() == 10);
+
+    // Each row is handled exactly once.
+    std::vector<std::atomic<int>> hits(1003);
+    decoder.for_each_range(hits.size(), [&hits](auto first, auto last)
+    {
+      DMITIGR_ASSERT(first < last);
+      for (; first < last; ++first)
+        ++hits[first];
+    });
+    for (const auto& hit : hits)
+      DMITIGR_ASSERT(hit == 1);
+
+    // The failure of the lowest range is rethrown.
+    try {
+      decoder.for_each_range(1000, [](const auto first, auto)
+      {
+        throw std::runtime_error{std::to_string(first)};
+      });
+      DMITIGR_ASSERT(false);
+    } catch (const std::runtime_error& e) {
+      DMITIGR_ASSERT(std::string{e.what()} == "0");
+    }
+  }
+
+  // Decoding.
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->set_row_delivery_mode(pgfe::Row_delivery_mode::full);
+  Parallel_column_decoder decoder{4};
+  decoder.set_min_range_size(1000);
+  for (const auto format : {pgfe::Data_format::text, pgfe::Data_format::binary}) {
+    conn->set_result_format(format);
+    conn->execute([&decoder](pgfe::Row_batch&& batch)
+    {
+      constexpr int count{100000};
+      DMITIGR_ASSERT(batch.row_count() == count);
+      auto [ids, texts, evens, rems] = decoder.decode<std::int64_t,
+        std::string, bool, std::optional<int>>(batch, {0, 1, 2, 3});
+      DMITIGR_ASSERT(ids.size() == count);
+      DMITIGR_ASSERT(texts.size() == count);
+      DMITIGR_ASSERT(evens.size() == count);
+      DMITIGR_ASSERT(rems.size() == count);
+      for (int i{}; i < count; ++i) {
+        const int n{i + 1};
+        DMITIGR_ASSERT(ids[i] == n);
+        DMITIGR_ASSERT(texts[i] == std::to_string(n));
+        DMITIGR_ASSERT(evens[i] == !(n % 2));
+        DMITIGR_ASSERT(rems[i] == (n % 3 ? std::optional<int>{n % 3} :
+            std::nullopt));
+      }
+
+      const auto named = decoder.decode<std::string>(batch, "t");
+      DMITIGR_ASSERT(named == texts);
+
+      // NULL cannot be decoded to int.
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+      {
+        decoder.decode<int>(batch, 3);
+      }));
+      DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+      {
+        decoder.decode<int>(batch, 4);
+      }));
+    }, "select i::int8, i::text t, i % 2 = 0, nullif(i % 3, 0)"
+      " from generate_series(1, 100000) i");
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
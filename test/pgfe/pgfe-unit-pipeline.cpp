@@ -16,6 +16,9 @@
 
 #include "pgfe-unit.hpp"
 
+#include <type_traits>
+#include <vector>
+
 #define ASSERT DMITIGR_ASSERT
 
 int main()
@@ -167,6 +170,40 @@ try {
 
   ASSERT(conn->pipeline_status() == pgfe::Pipeline_status::enabled);
 
+  /*
+   * Test case 3 (draining of aborted requests).
+   */
+  {
+    ASSERT(conn->drain_aborted_pipeline().empty());
+    conn->execute_nio("syntax error");
+    for (int i{}; i < 10; ++i)
+      conn->execute_nio("select 1");
+    conn->send_sync();
+    conn->execute_nio("select 2 id");
+    conn->send_sync();
+    ASSERT(conn->request_queue_size() == 14);
+    conn->wait_response();
+    ASSERT(conn->error());
+    ASSERT(conn->pipeline_status() == pgfe::Pipeline_status::aborted);
+    const auto aborted = conn->drain_aborted_pipeline();
+    ASSERT(aborted.size() == 10);
+    for (std::size_t i{}; i < aborted.size(); ++i)
+      ASSERT(aborted[i] == i);
+    ASSERT(conn->request_queue_size() == 3);
+    conn->wait_response();
+    ASSERT(conn->ready_for_query());
+    ASSERT(conn->pipeline_status() == pgfe::Pipeline_status::enabled);
+    conn->wait_response();
+    auto row = conn->row();
+    ASSERT(row);
+    ASSERT(to<int>(row["id"]) == 2);
+    conn->wait_response();
+    ASSERT(conn->completion());
+    conn->wait_response();
+    ASSERT(conn->ready_for_query());
+    ASSERT(conn->request_queue_size() == 0);
+  }
+
   /*
    * Test case 4.
    */
@@ -184,9 +221,123 @@ try {
     ASSERT(completion.tag() == "SELECT");
   }
 
+  /*
+   * Test case 5 (automatic pipelining).
+   */
+  {
+    conn->set_pipeline_sync_request_threshold(4);
+    conn->set_pipeline_max_depth(8);
+    ASSERT(conn->pipeline_sync_request_threshold() == 4);
+    ASSERT(conn->pipeline_max_depth() == 8);
+
+    int row_count{};
+    int completion_count{};
+    for (int i{}; i < 100; ++i) {
+      conn->execute_pipelined([&row_count, &completion_count](auto&& response)
+      {
+        using R = std::decay_t<decltype(response)>;
+        if constexpr (std::is_same_v<R, pgfe::Row>) {
+          ASSERT(to<int>(response["id"]) == row_count % 3 + 1);
+          ++row_count;
+        } else if constexpr (std::is_same_v<R, pgfe::Completion>) {
+          ASSERT(response.tag() == "SELECT");
+          ++completion_count;
+        } else
+          ASSERT(false);
+      }, "select * from num order by id");
+      ASSERT(conn->request_queue_size() <= 8 + 1);
+    }
+    conn->complete_pipeline();
+    ASSERT(!conn->has_uncompleted_request());
+    ASSERT(row_count == 300);
+    ASSERT(completion_count == 100);
+
+    // Errors, and the requests aborted by them.
+    int error_count{};
+    int aborted_count{};
+    const auto on_error = [&error_count, &aborted_count](pgfe::Error&& error)
+    {
+      if (error)
+        ++error_count;
+      else
+        ++aborted_count;
+    };
+    conn->execute_pipelined(on_error, "syntax error");
+    conn->execute_pipelined(on_error, "select 1");
+    conn->complete_pipeline();
+    ASSERT(error_count == 1);
+    ASSERT(aborted_count == 1);
+  }
+
+  /*
+   * Test case 6 (pending results).
+   */
+  {
+    std::vector<pgfe::Pending_result> results;
+    for (int i{}; i < 10; ++i)
+      results.push_back(conn->execute_async("select $1::int id", i));
+    auto failed = conn->execute_async("syntax error");
+    auto aborted = conn->execute_async("select 1");
+    for (int i{}; i < 10; ++i) {
+      auto& result = results[static_cast<std::size_t>(i)];
+      ASSERT(result.get().tag() == "SELECT");
+      ASSERT(result.is_ready());
+      ASSERT(result.rows().size() == 1);
+      ASSERT(to<int>(result.rows()[0]["id"]) == i);
+    }
+    failed.wait();
+    ASSERT(failed.error());
+    try {
+      aborted.get();
+      ASSERT(false);
+    } catch (const pgfe::Client_exception&) {}
+    conn->complete_pipeline();
+  }
+
   conn->set_pipeline_enabled(false);
   ASSERT(conn->is_ready_for_request());
   ASSERT(conn->is_ready_for_nio_request());
+
+  /*
+   * Test case 7 (Statement_vector).
+   */
+  {
+    const pgfe::Statement_vector statements{
+      "-- Empty statement.\n;"
+      "select 1;"
+      "select 2/0;"
+      "select 3;"};
+    ASSERT(statements.size() == 4);
+    for (const auto mode : {pgfe::Pipeline_sync_mode::once,
+        pgfe::Pipeline_sync_mode::each}) {
+      std::vector<int> rows(statements.size());
+      std::vector<int> completions(statements.size());
+      std::vector<int> errors(statements.size());
+      std::vector<int> skips(statements.size());
+      conn->execute([&](const std::size_t i, auto&& response)
+      {
+        using R = std::decay_t<decltype(response)>;
+        if constexpr (std::is_same_v<R, pgfe::Row>) {
+          ASSERT(to<int>(response.data()) == static_cast<int>(i));
+          ++rows[i];
+        } else if constexpr (std::is_same_v<R, pgfe::Completion>)
+          ++completions[i];
+        else if (response)
+          ++errors[i];
+        else
+          ++skips[i];
+      }, statements, mode);
+      ASSERT(conn->is_ready_for_request());
+      ASSERT(conn->pipeline_status() == Pipeline_status::disabled);
+      ASSERT(!rows[0] && !completions[0] && !errors[0] && !skips[0]);
+      ASSERT(rows[1] == 1 && completions[1] == 1);
+      ASSERT(errors[2] == 1 && !completions[2]);
+      if (mode == pgfe::Pipeline_sync_mode::once)
+        ASSERT(skips[3] == 1 && !rows[3] && !completions[3]);
+      else
+        ASSERT(rows[3] == 1 && completions[3] == 1);
+    }
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -0,0 +1,140 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using pgfe::Socket_readiness;
+
+#ifndef _WIN32
+  // One-shot waits.
+  {
+    int fds[2];
+    DMITIGR_ASSERT(!::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+    pgfe::Poll_reactor reactor;
+    DMITIGR_ASSERT(!reactor.connection_count());
+    int write_count{};
+    int read_count{};
+    reactor.async_wait(fds[0], Socket_readiness::write_ready,
+      [&write_count](const Socket_readiness r)
+      {
+        DMITIGR_ASSERT((r & Socket_readiness::write_ready) ==
+          Socket_readiness::write_ready);
+        ++write_count;
+      });
+    reactor.async_wait(fds[0], Socket_readiness::read_ready,
+      [&read_count](const Socket_readiness r)
+      {
+        DMITIGR_ASSERT((r & Socket_readiness::read_ready) ==
+          Socket_readiness::read_ready);
+        ++read_count;
+      });
+    DMITIGR_ASSERT(reactor.run_once(std::chrono::milliseconds{100}) == 1);
+    DMITIGR_ASSERT(write_count == 1);
+    DMITIGR_ASSERT(!read_count);
+
+    // Nothing to read yet.
+    DMITIGR_ASSERT(!reactor.run_once(std::chrono::milliseconds{10}));
+    DMITIGR_ASSERT(!read_count);
+
+    DMITIGR_ASSERT(::write(fds[1], "x", 1) == 1);
+    reactor.run();
+    DMITIGR_ASSERT(write_count == 1);
+    DMITIGR_ASSERT(read_count == 1);
+
+    // The waits can be rearmed from callbacks.
+    int rearm_count{};
+    std::function<void(Socket_readiness)> rearm;
+    rearm = [&](Socket_readiness)
+    {
+      if (++rearm_count < 3)
+        reactor.async_wait(fds[0], Socket_readiness::read_ready, rearm);
+    };
+    reactor.async_wait(fds[0], Socket_readiness::read_ready, rearm);
+    reactor.run();
+    DMITIGR_ASSERT(rearm_count == 3);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+  }
+#endif
+
+  // Connections.
+  {
+    pgfe::Poll_reactor reactor;
+    const auto conn1 = pgfe::test::make_connection();
+    const auto conn2 = pgfe::test::make_connection();
+    conn1->connect();
+    conn2->connect();
+    int row_count{};
+    const auto handler = [&row_count](pgfe::Connection& conn)
+    {
+      if (const auto row = conn.row()) {
+        DMITIGR_ASSERT(pgfe::to<int>(row[0]) == 1);
+        ++row_count;
+      } else
+        DMITIGR_ASSERT(conn.completion());
+    };
+    reactor.add(*conn1, handler);
+    reactor.add(*conn2, handler);
+    DMITIGR_ASSERT(reactor.connection_count() == 2);
+    conn1->execute_nio("select 1");
+    conn2->execute_nio("select 1");
+    reactor.run();
+    DMITIGR_ASSERT(row_count == 2);
+
+    // The default handler dispatches the responses on async requests.
+    reactor.remove(*conn2);
+    reactor.add(*conn2);
+    auto result = conn2->execute_async("select 2");
+    reactor.run();
+    DMITIGR_ASSERT(result.is_ready());
+    DMITIGR_ASSERT(pgfe::to<int>(result.rows().at(0)[0]) == 2);
+
+    // The handler can remove the connection.
+    reactor.remove(*conn1);
+    reactor.add(*conn1, [&reactor](pgfe::Connection& conn)
+    {
+      if (!conn.row()) {
+        DMITIGR_ASSERT(conn.completion());
+        reactor.remove(conn);
+      }
+    });
+    conn1->execute_nio("select 1");
+    while (reactor.connection_count() == 2)
+      reactor.run_once();
+    conn1->wait_response();
+    DMITIGR_ASSERT(conn1->is_ready_for_request());
+
+    reactor.remove(*conn1);
+    reactor.remove(*conn2);
+    DMITIGR_ASSERT(!reactor.connection_count());
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -16,6 +16,11 @@
 
 #include "pgfe-unit.hpp"
 
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 int main()
 try {
   namespace pgfe = dmitigr::pgfe;
@@ -177,6 +182,85 @@ try {
     DMITIGR_ASSERT(pgfe::to<int>(na4.data()) == 14);
   }
 
+  // Parameter types.
+  {
+    // Binary parameters of explicit types without preparing.
+    conn->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<std::string>(row[0]) == "bigint");
+      DMITIGR_ASSERT(pgfe::to<long long>(row[1]) == 1LL << 40);
+      DMITIGR_ASSERT(pgfe::to<std::string>(row[2]) == "boolean");
+      DMITIGR_ASSERT(pgfe::to<bool>(row[3]));
+    }, "select pg_typeof($1)::text, $1, pg_typeof($2)::text, $2",
+      pgfe::binary_argument(1LL << 40), pgfe::binary_argument(true));
+    conn->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<std::string>(row[0]) == "integer");
+    }, "select pg_typeof($1)::text",
+      pgfe::Typed_argument{23, pgfe::to_data(7)});
+
+    // Parameter types specified upon preparing.
+    auto ps = conn->prepare("select pg_typeof($1)::text, $1, $2", "",
+      {20, pgfe::invalid_oid});
+    DMITIGR_ASSERT(ps.parameter_type(0) == 20);
+    DMITIGR_ASSERT(ps.parameter_type(1) == pgfe::invalid_oid);
+    ps.bind(0, 1LL << 40, pgfe::Data_format::binary);
+    DMITIGR_ASSERT(ps.bound(0).format() == pgfe::Data_format::binary);
+    DMITIGR_ASSERT(ps.parameter_type(0) == 20);
+    ps.bind(1, "text");
+    ps.execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<std::string>(row[0]) == "bigint");
+      DMITIGR_ASSERT(pgfe::to<long long>(row[1]) == 1LL << 40);
+      DMITIGR_ASSERT(pgfe::to<std::string>(row[2]) == "text");
+    });
+
+    // Parameter types inferred by the server.
+    conn->prepare("select $1::integer, $2::text", "ps_types");
+    const auto described = conn->describe("ps_types");
+    DMITIGR_ASSERT(described.parameter_type(0) == 23);
+    DMITIGR_ASSERT(described.parameter_type(1) == 25);
+    conn->unprepare("ps_types");
+
+    // Prepared and described in a single round trip.
+    {
+      auto ps = conn->prepare("select :a::integer a, $1::text b", "ps_described",
+        {}, true);
+      DMITIGR_ASSERT(ps.is_described());
+      DMITIGR_ASSERT(ps.parameter_count() == 2);
+      DMITIGR_ASSERT(ps.parameter_index("a") == 1);
+      DMITIGR_ASSERT(ps.parameter_type(0) == 25);
+      DMITIGR_ASSERT(ps.parameter_type(1) == 23);
+      DMITIGR_ASSERT(ps.row_info() && ps.row_info().field_count() == 2);
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+      conn->unprepare("ps_described");
+
+      auto ps_as_is = conn->prepare_as_is("select $1::integer", "", {}, true);
+      DMITIGR_ASSERT(ps_as_is.is_described());
+      DMITIGR_ASSERT(ps_as_is.parameter_count() == 1);
+      DMITIGR_ASSERT(ps_as_is.parameter_type(0) == 23);
+
+      bool is_thrown{};
+      try {
+        conn->prepare("select no_such_column", "ps_described", {}, true);
+      } catch (const pgfe::Server_exception&) {
+        is_thrown = true;
+      }
+      DMITIGR_ASSERT(is_thrown);
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+    }
+
+    // Binary parameters of the statements prepared by the statement cache.
+    conn->set_statement_cache_capacity(4);
+    for (int i{}; i < 4; ++i) {
+      conn->execute([](auto&& row)
+      {
+        DMITIGR_ASSERT(pgfe::to<std::string>(row[0]) == "double precision");
+      }, "select pg_typeof($1)::text", pgfe::binary_argument(.5));
+    }
+    conn->set_statement_cache_capacity(0);
+  }
+
   // Test invalidation of prepared statements after disconnection.
   auto ps3 = conn->prepare("select 3", "ps3");
   auto ps3_2 = conn->describe("ps3");
@@ -185,6 +269,58 @@ try {
   conn->disconnect();
   DMITIGR_ASSERT(!ps3);
   DMITIGR_ASSERT(!ps3_2);
+
+  // Bulk execution.
+  {
+    conn->execute("create temp table bulk(id integer primary key, str text)");
+    auto ps = conn->prepare("insert into bulk values ($1, $2)");
+    std::vector<std::tuple<int, std::string>> tuples;
+    for (int i{}; i < 1000; ++i)
+      tuples.emplace_back(i, std::to_string(i));
+    auto comp = ps.execute_many(tuples);
+    DMITIGR_ASSERT(comp.is_ok());
+    DMITIGR_ASSERT(comp.execution_count() == 1000);
+    DMITIGR_ASSERT(comp.completion_count() == 1000);
+    DMITIGR_ASSERT(comp.row_count() == 1000);
+    DMITIGR_ASSERT(comp.errors().empty());
+    DMITIGR_ASSERT(conn->is_ready_for_request());
+
+    // The duplicate key aborts the remaining executions.
+    const std::vector<std::pair<int, const char*>> pairs{
+      {1000, "a"}, {0, "b"}, {1001, "c"}};
+    comp = conn->execute_many("insert into bulk values ($1, $2)", pairs);
+    DMITIGR_ASSERT(!comp.is_ok());
+    DMITIGR_ASSERT(comp.execution_count() == 3);
+    DMITIGR_ASSERT(comp.completion_count() == 1);
+    DMITIGR_ASSERT(comp.aborted_count() == 1);
+    DMITIGR_ASSERT(comp.errors().size() == 1);
+    DMITIGR_ASSERT(comp.errors()[0].first == 1);
+    DMITIGR_ASSERT(comp.errors()[0].second.condition() ==
+      pgfe::Server_errc::c23_unique_violation);
+    DMITIGR_ASSERT(conn->is_ready_for_request());
+    conn->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<long>(row[0]) == 1000);
+    }, "select count(*) from bulk");
+  }
+
+  // Adaptive row delivery mode.
+  {
+    auto ps = conn->prepare("select generate_series(1, $1::integer)",
+      "ps_adaptive");
+    ps.set_row_delivery_mode(pgfe::Row_delivery_mode::adaptive);
+    DMITIGR_ASSERT(ps.row_delivery_mode() == pgfe::Row_delivery_mode::adaptive);
+    for (const int count : {1, 10, 10, 100000, 100000, 10}) {
+      long sum{};
+      ps.bind(0, count).execute([&sum](auto&& row)
+      {
+        sum += pgfe::to<long>(row[0]);
+      });
+      DMITIGR_ASSERT(sum == static_cast<long>(count) * (count + 1) / 2);
+      DMITIGR_ASSERT(conn->is_ready_for_request());
+    }
+    DMITIGR_ASSERT(ps.row_delivery_mode() == pgfe::Row_delivery_mode::adaptive);
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -0,0 +1,192 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+std::size_t allocation_count;
+} // namespace
+
+void* operator new(const std::size_t size)
+{
+  ++allocation_count;
+  if (void* const result = std::malloc(size ? size : 1))
+    return result;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* const ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  const auto conn = pgfe::test::make_connection();
+  conn->connect();
+  DMITIGR_ASSERT(conn->is_connected());
+
+  /*
+   * Returns the number of allocations performed by the `iteration_count`
+   * calls of `ps.execute_nio()`, excluding the response processing.
+   */
+  const auto execution_allocation_count = [&conn](pgfe::Prepared_statement& ps,
+    const int iteration_count)
+  {
+    std::size_t result{};
+    for (int i{}; i < iteration_count; ++i) {
+      const auto count = allocation_count;
+      ps.execute_nio();
+      result += allocation_count - count;
+      conn->process_responses([](pgfe::Row&&){});
+    }
+    return result;
+  };
+
+  auto ps0 = conn->prepare("SELECT 1 WHERE false");
+  auto ps16 = conn->prepare("SELECT 1 WHERE"
+    " $1::int + $2::int + $3::int + $4::int +"
+    " $5::int + $6::int + $7::int + $8::int +"
+    " $9::int + $10::int + $11::int + $12::int +"
+    " $13::int + $14::int + $15::int + $16::int < 0");
+  DMITIGR_ASSERT(ps16.parameter_count() == 16);
+  for (std::size_t i{}; i < ps16.parameter_count(); ++i)
+    ps16.bind(i, static_cast<int>(i));
+
+  // Warm up.
+  constexpr int iteration_count{64};
+  execution_allocation_count(ps0, iteration_count);
+  execution_allocation_count(ps16, iteration_count);
+
+  /*
+   * The parameter marshalling must not allocate, so the executions of the
+   * statement with 16 parameters must not allocate more than the executions
+   * of the statement without parameters.
+   */
+  const auto count0 = execution_allocation_count(ps0, iteration_count);
+  const auto count16 = execution_allocation_count(ps16, iteration_count);
+  DMITIGR_ASSERT(count16 == count0);
+
+  // The reusable buffers of the connection are used for many parameters.
+  auto ps32 = conn->prepare("SELECT 1 WHERE"
+    " $1::int + $2::int + $3::int + $4::int +"
+    " $5::int + $6::int + $7::int + $8::int +"
+    " $9::int + $10::int + $11::int + $12::int +"
+    " $13::int + $14::int + $15::int + $16::int +"
+    " $17::int + $18::int + $19::int + $20::int +"
+    " $21::int + $22::int + $23::int + $24::int +"
+    " $25::int + $26::int + $27::int + $28::int +"
+    " $29::int + $30::int + $31::int + $32::int < 0");
+  DMITIGR_ASSERT(ps32.parameter_count() == 32);
+  for (std::size_t i{}; i < ps32.parameter_count(); ++i)
+    ps32.bind(i, static_cast<int>(i));
+  execution_allocation_count(ps32, iteration_count);
+  const auto count32 = execution_allocation_count(ps32, iteration_count);
+  DMITIGR_ASSERT(count32 == count0);
+
+  // The small values are stored in place.
+  {
+    const auto count = allocation_count;
+    for (std::size_t i{}; i < ps16.parameter_count(); ++i)
+      ps16.bind(i, static_cast<int>(i));
+    DMITIGR_ASSERT(allocation_count == count);
+    DMITIGR_ASSERT(pgfe::to<int>(ps16.bound(15)) == 15);
+  }
+
+  // The data converted in the arena is allocated in the reused blocks.
+  auto pss = conn->prepare("SELECT 1 WHERE length($1) + length($2) < 0");
+  const std::string large_value(100, 'x');
+  pgfe::Data_arena arena;
+  pss.set_data_arena(&arena);
+  DMITIGR_ASSERT(pss.data_arena() == &arena);
+  const auto binding_allocation_count = [&pss, &arena, &large_value]
+  {
+    const auto count = allocation_count;
+    arena.clear();
+    pss.bind(0, large_value);
+    pss.bind(1, std::string_view{large_value});
+    return allocation_count - count;
+  };
+  binding_allocation_count();
+  DMITIGR_ASSERT(binding_allocation_count() == 0);
+  DMITIGR_ASSERT(pgfe::to<std::string_view>(pss.bound(1)) == large_value);
+  DMITIGR_ASSERT(execution_allocation_count(pss, iteration_count) == count0);
+
+  // The borrowed data is bound without copying.
+  pss.set_data_arena(nullptr);
+  {
+    const auto count = allocation_count;
+    pss.bind_no_copy(0, large_value);
+    pss.bind(1, pgfe::Data_view{large_value.data(), large_value.size()});
+    DMITIGR_ASSERT(allocation_count == count);
+    DMITIGR_ASSERT(pss.bound(0).bytes() == large_value.data());
+    DMITIGR_ASSERT(pss.bound(1).bytes() == large_value.data());
+    const std::byte bytes[]{std::byte{0xde}, std::byte{0xad}};
+    pss.bind_no_copy(1, bytes, sizeof(bytes));
+    DMITIGR_ASSERT(pss.bound(1).format() == pgfe::Data_format::binary);
+    DMITIGR_ASSERT(pss.bound(1).bytes() == bytes);
+  }
+  pss.bind_no_copy(1, large_value);
+  DMITIGR_ASSERT(execution_allocation_count(pss, iteration_count) == count0);
+
+  // The parameters of the supported types are encoded in place.
+  {
+    const pgfe::Statement s0{"SELECT 1 WHERE false"};
+    const pgfe::Statement s5{"SELECT 1 WHERE $1::int + $2::float8 < 0"
+      " AND length($3) > 0 AND $4::bool AND $5::int IS NULL"};
+    const std::optional<int> null;
+    const auto statement_allocation_count = [&](const auto& execute_nio)
+    {
+      std::size_t result{};
+      for (int i{}; i < iteration_count; ++i) {
+        const auto count = allocation_count;
+        execute_nio();
+        result += allocation_count - count;
+        conn->process_responses([](pgfe::Row&&){});
+      }
+      return result;
+    };
+    const auto execute_nio0 = [&]{conn->execute_nio(s0);};
+    const auto execute_nio5 = [&]
+    {
+      conn->execute_nio(s5, 1, 2.5, large_value, true, null);
+    };
+    statement_allocation_count(execute_nio0);
+    statement_allocation_count(execute_nio5);
+    DMITIGR_ASSERT(statement_allocation_count(execute_nio5) ==
+      statement_allocation_count(execute_nio0));
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
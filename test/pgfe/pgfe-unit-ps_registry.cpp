@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  namespace util = dmitigr::util;
+
+  // Registry
+  {
+    pgfe::Prepared_statement_registry registry;
+    DMITIGR_ASSERT(registry.is_empty());
+    registry.add("plus_one", "select $1::int + 1");
+    DMITIGR_ASSERT(registry.size() == 1);
+    DMITIGR_ASSERT(registry.contains("plus_one"));
+    DMITIGR_ASSERT(!registry.is_described("plus_one"));
+    DMITIGR_ASSERT(util::with_catch<pgfe::Client_exception>([&registry]
+    {
+      registry.add("plus_one", "select 1");
+    }));
+    DMITIGR_ASSERT(util::with_catch<pgfe::Client_exception>([&registry]
+    {
+      registry.add("", "select 1");
+    }));
+    DMITIGR_ASSERT(registry.remove("plus_one"));
+    DMITIGR_ASSERT(!registry.remove("plus_one"));
+    DMITIGR_ASSERT(registry.is_empty());
+  }
+
+  pgfe::Connection_pool pool{2, pgfe::test::connection_options()};
+  const auto& registry = pool.prepared_statement_registry();
+  DMITIGR_ASSERT(registry);
+  registry->add("plus_one", "select $1::int + 1 as value");
+  registry->add("plus_two", "select :n::int + 2 as value");
+  pool.set_connect_handler([](pgfe::Connection& conn)
+  {
+    conn.prepare_registered_statements();
+  });
+  pool.connect();
+
+  // The statements are prepared on connect and described once.
+  {
+    auto conn = pool.connection();
+    DMITIGR_ASSERT(conn);
+    DMITIGR_ASSERT(conn->prepared_statement_registry() == registry);
+    DMITIGR_ASSERT(registry->is_described("plus_one"));
+    DMITIGR_ASSERT(registry->is_described("plus_two"));
+    auto ps = conn->registered_statement("plus_two");
+    DMITIGR_ASSERT(ps.is_described());
+    DMITIGR_ASSERT(ps.row_info().field_name(0) == "value");
+    ps.bind("n", 1).execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row[0]) == 3);
+    });
+
+    // Prepared again after DISCARD ALL.
+    conn->execute("discard all");
+    ps = conn->registered_statement("plus_one");
+    DMITIGR_ASSERT(ps.is_described());
+    ps.bind(0, 1).execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row[0]) == 2);
+    });
+
+    DMITIGR_ASSERT(util::with_catch<pgfe::Client_exception>([&conn]
+    {
+      conn->registered_statement("none");
+    }));
+  }
+
+  // The description is shared by the other connection.
+  {
+    auto conn1 = pool.connection();
+    auto conn2 = pool.connection();
+    DMITIGR_ASSERT(conn1 && conn2);
+    auto ps = conn2->registered_statement("plus_one");
+    DMITIGR_ASSERT(ps.is_described());
+    DMITIGR_ASSERT(ps.parameter_type_oid(0) == 23);
+  }
+
+  // The statement which is not yet described is prepared lazily.
+  {
+    registry->add("plus_three", "select $1::int + 3");
+    auto conn = pool.connection();
+    conn->disconnect();
+    conn->connect();
+    auto ps = conn->registered_statement("plus_three");
+    DMITIGR_ASSERT(registry->is_described("plus_three"));
+    ps.bind(0, 1).execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row[0]) == 4);
+    });
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
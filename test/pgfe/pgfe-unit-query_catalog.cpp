@@ -0,0 +1,105 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+int main()
+try {
+  namespace fs = std::filesystem;
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  const std::string sql{
+    "-- The empty statement.\n;"
+    "-- $id$one$id$\nSELECT 1;"
+    "-- Unnamed statement.\nSELECT 0;"
+    "-- $id$sum$id$\nSELECT :a::int + :b::int, $$;$$, ':c';"
+    "/* $id$quoted$id$ */ SELECT :'name', :\"ident\""};
+
+  const pgfe::Statement_vector statements{sql};
+  const auto assert_catalog = [&statements](const pgfe::Query_catalog& catalog)
+  {
+    DMITIGR_ASSERT(catalog.size() == 3);
+    DMITIGR_ASSERT(!catalog.is_empty());
+    DMITIGR_ASSERT(catalog.query_index("one") == 0);
+    DMITIGR_ASSERT(catalog.query_index("sum") == 1);
+    DMITIGR_ASSERT(catalog.query_index("quoted") == 2);
+    DMITIGR_ASSERT(catalog.query_index("none") == catalog.size());
+    DMITIGR_ASSERT(catalog.name(1) == "sum");
+    const auto& sum = catalog.statement("sum");
+    DMITIGR_ASSERT(sum.parameter_count() == 2);
+    DMITIGR_ASSERT(sum.parameter_index("a") == 0);
+    DMITIGR_ASSERT(sum.parameter_index("b") == 1);
+    DMITIGR_ASSERT(sum.to_string() == statements[3].to_string());
+    DMITIGR_ASSERT(catalog.statement(0).to_string() == statements[1].to_string());
+    const auto& quoted = catalog.statement("quoted");
+    DMITIGR_ASSERT(quoted.parameter_count() == 2);
+    DMITIGR_ASSERT(quoted.to_string() == statements[4].to_string());
+    DMITIGR_ASSERT(quoted.extra().field_count() == 1);
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&catalog]
+    {
+      catalog.statement("none");
+    }));
+  };
+
+  // Parse.
+  const pgfe::Query_catalog catalog{statements};
+  assert_catalog(catalog);
+  DMITIGR_ASSERT(pgfe::Query_catalog{}.is_empty());
+  DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+  {
+    pgfe::Query_catalog{pgfe::Statement_vector{
+      "-- $id$a$id$\nSELECT 1;-- $id$a$id$\nSELECT 2"}};
+  }));
+
+  // Save and load.
+  const auto dir = fs::temp_directory_path();
+  const auto sql_file = dir/"pgfe_query_catalog.sql";
+  const auto cache_file = dir/"pgfe_query_catalog.pgfe";
+  fs::remove(cache_file);
+  catalog.save(cache_file);
+  assert_catalog(pgfe::Query_catalog::from_file(cache_file));
+
+  // Load with the cache.
+  std::ofstream{sql_file, std::ios_base::binary} << sql;
+  fs::last_write_time(sql_file, fs::last_write_time(cache_file) -
+    std::chrono::hours{1});
+  assert_catalog(pgfe::Query_catalog::from_sql_files({sql_file}));
+  assert_catalog(pgfe::Query_catalog::load({sql_file}, cache_file));
+
+  // Invalid cache file.
+  std::ofstream{cache_file, std::ios_base::binary} << "PGFEQC\x01\ngarbage";
+  DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&cache_file]
+  {
+    pgfe::Query_catalog::from_file(cache_file);
+  }));
+  assert_catalog(pgfe::Query_catalog::load({sql_file}, cache_file));
+  assert_catalog(pgfe::Query_catalog::from_file(cache_file));
+
+  fs::remove(sql_file);
+  fs::remove(cache_file);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
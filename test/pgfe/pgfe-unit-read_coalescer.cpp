@@ -0,0 +1,112 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+  using Result = pgfe::Read_coalescer::Result;
+
+  constexpr std::size_t pool_size = 4;
+  pgfe::Connection_pool pool{pool_size, pgfe::test::connection_options()};
+  pool.connect();
+  const auto& registry = pool.prepared_statement_registry();
+  registry->add("slow", "select pg_sleep(0.5), $1::integer n, $2::text s");
+  registry->add("fail", "select 1 / $1::integer");
+
+  pgfe::Read_coalescer reads{pool};
+  ASSERT(&reads.pool() == &pool);
+  ASSERT(!reads.connection_timeout());
+  ASSERT(!reads.in_flight_count());
+
+  // Identical reads.
+  {
+    constexpr std::size_t thread_count = 16;
+    std::promise<void> start;
+    const auto started = start.get_future().share();
+    std::vector<std::future<Result>> results;
+    for (std::size_t i{}; i < thread_count; ++i) {
+      results.push_back(std::async(std::launch::async, [&reads, started]
+      {
+        started.wait();
+        return reads.execute("slow", 7, nullptr);
+      }));
+    }
+    start.set_value();
+    std::vector<Result> values;
+    for (auto& result : results)
+      values.push_back(result.get());
+    for (const auto& value : values) {
+      ASSERT(value && value->row_count() == 1);
+      ASSERT(pgfe::to<int>(value->data(0, "n")) == 7);
+      ASSERT(!value->data(0, "s"));
+    }
+    ASSERT(reads.execution_count() < thread_count);
+    ASSERT(reads.execution_count() + reads.coalesced_count() == thread_count);
+    ASSERT(!reads.in_flight_count());
+  }
+
+  // Different parameters are executed independently.
+  {
+    const auto count = reads.execution_count();
+    auto r1 = std::async(std::launch::async, [&reads]
+    {
+      return reads.execute("slow", 1, std::string{"a"});
+    });
+    auto r2 = std::async(std::launch::async, [&reads]
+    {
+      return reads.execute("slow", 1, std::string{"b"});
+    });
+    ASSERT(pgfe::to<std::string>(r1.get()->data(0, "s")) == "a");
+    ASSERT(pgfe::to<std::string>(r2.get()->data(0, "s")) == "b");
+    ASSERT(reads.execution_count() == count + 2);
+  }
+
+  // Errors.
+  {
+    ASSERT(with_catch<pgfe::Server_exception>([&]{reads.execute("fail", 0);}));
+    ASSERT(!reads.in_flight_count());
+    const auto value = reads.execute("fail", 1);
+    ASSERT(pgfe::to<int>(value->data(0, 0)) == 1);
+    ASSERT(with_catch<pgfe::Client_exception>([&]{reads.execute("none");}));
+  }
+
+  // No free connection.
+  {
+    pgfe::Read_coalescer busy{pool, std::chrono::milliseconds{10}};
+    std::vector<pgfe::Connection_pool::Handle> handles;
+    for (std::size_t i{}; i < pool_size; ++i)
+      handles.push_back(pool.connection());
+    ASSERT(with_catch<pgfe::Client_exception>([&]{busy.execute("fail", 1);}));
+    ASSERT(!busy.in_flight_count() && busy.execution_count() == 1);
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,117 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/net/conversions.hpp"
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace net = dmitigr::net;
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+  using pgfe::Client_exception;
+  using pgfe::Data_format;
+  using pgfe::Data_view;
+  using Kind = pgfe::Replication_message::Kind;
+
+  // LSN.
+  {
+    ASSERT(pgfe::to_lsn("0/0") == 0);
+    ASSERT(pgfe::to_lsn("16/B374D848") == 0x16B374D848);
+    ASSERT(pgfe::to_lsn("FFFFFFFF/FFFFFFFF") == UINT64_MAX);
+    ASSERT(!pgfe::to_lsn(""));
+    ASSERT(!pgfe::to_lsn("16"));
+    ASSERT(!pgfe::to_lsn("16/"));
+    ASSERT(!pgfe::to_lsn("/1"));
+    ASSERT(!pgfe::to_lsn("16/G"));
+    ASSERT(!pgfe::to_lsn("100000000/0"));
+    ASSERT(pgfe::lsn_to_string(0) == "0/0");
+    ASSERT(pgfe::lsn_to_string(0x16B374D848) == "16/B374D848");
+    ASSERT(pgfe::lsn_to_string(UINT64_MAX) == "FFFFFFFF/FFFFFFFF");
+  }
+
+  // 2000-01-01 00:00:01 UTC in microseconds since the epoch of PostgreSQL.
+  constexpr std::int64_t server_time{1000000};
+  const auto expected_server_time = std::chrono::system_clock::time_point{
+    std::chrono::seconds{946684801}};
+
+  // XLogData.
+  {
+    std::string raw(25, 'w');
+    net::copy(raw.data() + 1, std::uint64_t{0x100});
+    net::copy(raw.data() + 9, std::uint64_t{0x200});
+    net::copy(raw.data() + 17, server_time);
+    raw.append(R"({"change":[]})");
+    const Data_view data{raw.data(), raw.size(), Data_format::binary};
+    const pgfe::Replication_message msg{data};
+    ASSERT(msg);
+    ASSERT(msg.kind() == Kind::xlog_data);
+    ASSERT(msg.wal_start() == 0x100);
+    ASSERT(msg.wal_end() == 0x200);
+    ASSERT(msg.server_time() == expected_server_time);
+    ASSERT(!msg.is_reply_requested());
+    ASSERT(msg.payload().size() == 13);
+    // Decoded in place.
+    ASSERT(msg.payload().bytes() == raw.data() + 25);
+    ASSERT(std::string_view(static_cast<const char*>(msg.payload().bytes()),
+        msg.payload().size()) == R"({"change":[]})");
+  }
+
+  // Primary keepalive.
+  {
+    std::string raw(18, 'k');
+    net::copy(raw.data() + 1, std::uint64_t{0x300});
+    net::copy(raw.data() + 9, server_time);
+    raw[17] = 1;
+    const Data_view data{raw.data(), raw.size(), Data_format::binary};
+    const pgfe::Replication_message msg{data};
+    ASSERT(msg);
+    ASSERT(msg.kind() == Kind::keepalive);
+    ASSERT(msg.wal_start() == 0);
+    ASSERT(msg.wal_end() == 0x300);
+    ASSERT(msg.server_time() == expected_server_time);
+    ASSERT(msg.is_reply_requested());
+    ASSERT(!msg.payload().size());
+  }
+
+  // Malformed messages.
+  {
+    ASSERT(!pgfe::Replication_message{});
+    const std::string short_xlog(24, 'w');
+    const std::string long_keepalive(19, 'k');
+    const std::string unknown(25, 'x');
+    for (const auto& raw : {short_xlog, long_keepalive, unknown}) {
+      const Data_view data{raw.data(), raw.size(), Data_format::binary};
+      ASSERT(with_catch<Client_exception>([&]
+      {
+        pgfe::Replication_message{data};
+      }));
+    }
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
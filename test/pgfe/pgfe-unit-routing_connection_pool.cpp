@@ -0,0 +1,73 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using pgfe::Session_mode;
+  const auto options = pgfe::test::connection_options();
+  auto broken_options = options;
+  broken_options.set_port(1);
+  pgfe::Routing_connection_pool pool{1, options, {options, broken_options}};
+  DMITIGR_ASSERT(pool.is_valid());
+  DMITIGR_ASSERT(pool.replica_count() == 2);
+  DMITIGR_ASSERT(pool.primary().size() == 1);
+  DMITIGR_ASSERT(pool.replica(0).size() == 1);
+  DMITIGR_ASSERT(!pool.is_connected());
+  pool.connect();
+  DMITIGR_ASSERT(pool.is_connected());
+  DMITIGR_ASSERT(pool.is_replica_available(0));
+  DMITIGR_ASSERT(!pool.is_replica_available(1));
+
+  {
+    auto conn1 = pool.try_connection(Session_mode::read_only);
+    DMITIGR_ASSERT(conn1);
+    DMITIGR_ASSERT(conn1.pool() == &pool.replica(0));
+
+    // The replica is busy, so the primary is used.
+    auto conn2 = pool.connection(Session_mode::read_only,
+      std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(conn2);
+    DMITIGR_ASSERT(conn2.pool() == &pool.primary());
+
+    auto conn3 = pool.connection(Session_mode::read_write,
+      std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(!conn3);
+  }
+
+  {
+    auto conn = pool.try_connection(Session_mode::read_write);
+    DMITIGR_ASSERT(conn);
+    DMITIGR_ASSERT(conn.pool() == &pool.primary());
+  }
+
+  pool.set_max_replica_lag(std::chrono::hours{1});
+  DMITIGR_ASSERT(pool.max_replica_lag() == std::chrono::hours{1});
+  pool.check_replicas();
+  DMITIGR_ASSERT(pool.is_replica_available(0));
+
+  pool.disconnect();
+  DMITIGR_ASSERT(!pool.is_connected());
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
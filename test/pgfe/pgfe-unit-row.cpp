@@ -16,6 +16,31 @@
 
 #include "pgfe-unit.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+struct Person final {
+  int id{};
+  std::string name;
+  std::optional<std::string> email;
+};
+
+} // namespace
+
+template<> struct dmitigr::pgfe::Row_mapping<Person> final {
+  static constexpr auto fields = std::make_tuple(
+    mapped_field("id", &Person::id),
+    mapped_field("name", &Person::name),
+    mapped_field("email", &Person::email));
+};
+
 int main()
 try {
   namespace pgfe = dmitigr::pgfe;
@@ -35,6 +60,75 @@ try {
     DMITIGR_ASSERT(row.info().field_index("theNumberOne") == 1);
   }, R"(select 1::integer theNumberOne, 1::integer "theNumberOne")");
 
+  // The name index is shared between the rows of the response.
+  for (const auto mode : {pgfe::Row_delivery_mode::single,
+         pgfe::Row_delivery_mode::full}) {
+    conn->set_row_delivery_mode(mode);
+    int count{};
+    std::vector<pgfe::Row> rows;
+    conn->execute([&count, &rows](auto&& row)
+    {
+      DMITIGR_ASSERT(row.field_index("a") == 0);
+      DMITIGR_ASSERT(row.field_index("b") == 1);
+      DMITIGR_ASSERT(row.field_index("a", 1) == 2);
+      DMITIGR_ASSERT(row.field_index("c") == row.field_count());
+      DMITIGR_ASSERT(pgfe::to<int>(row["b"]) == ++count);
+      rows.push_back(std::move(row));
+    }, "select 0 a, generate_series(1, 3) b, 2 a");
+    DMITIGR_ASSERT(count == 3);
+
+    // The index of the previous response is not reused.
+    conn->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(row.field_index("x") == 0);
+      DMITIGR_ASSERT(row.field_index("a") == row.field_count());
+    }, "select 1 x");
+    DMITIGR_ASSERT(rows.size() == 3 && rows[2].field_index("b") == 1);
+  }
+  conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+
+  // The names of tuples are shared between the rows of the response.
+  {
+    std::vector<pgfe::Tuple> tuples;
+    conn->execute([&tuples](auto&& row)
+    {
+      tuples.push_back(row.to_tuple());
+    }, "select 0 a, generate_series(1, 3) b, null::text c");
+    DMITIGR_ASSERT(tuples.size() == 3);
+    DMITIGR_ASSERT(tuples[0].is_compact());
+    DMITIGR_ASSERT(tuples[0].is_field_names_shared(tuples[2]));
+    DMITIGR_ASSERT(tuples[2].field_name(1) == "b");
+    DMITIGR_ASSERT(pgfe::to<int>(tuples[2].data("b")) == 3);
+    DMITIGR_ASSERT(!tuples[2].data("c"));
+
+    conn->execute([&tuples](auto&& row)
+    {
+      DMITIGR_ASSERT(!row.to_tuple().is_field_names_shared(tuples[0]));
+    }, "select 0 a, 1 b, null::text c");
+  }
+
+  // ---------------------------------------------------------------------------
+  // Row_mapping
+  // ---------------------------------------------------------------------------
+
+  {
+    std::vector<Person> persons;
+    conn->execute([&persons](Person&& p)
+    {
+      persons.push_back(std::move(p));
+    }, R"(select 'person' || n as name, null as email, n as id
+          from generate_series(1, 3) n)");
+    DMITIGR_ASSERT(persons.size() == 3);
+    DMITIGR_ASSERT(persons[2].id == 3);
+    DMITIGR_ASSERT(persons[2].name == "person3");
+    DMITIGR_ASSERT(!persons[2].email);
+
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&conn]
+    {
+      conn->execute([](Person&&){}, "select 1 id");
+    }));
+  }
+
   // ---------------------------------------------------------------------------
   // Row
   // ---------------------------------------------------------------------------
@@ -45,6 +139,36 @@ try {
       std::cout << col.first << ": " << pgfe::to<std::string_view>(col.second)
                 << std::endl;
   }, R"(select 1::int4 one, 2::int4 two, 3::int4 three)");
+
+  // Views of the values.
+  {
+    using Iter = pgfe::Row::Field_view<pgfe::Data_view>::Iterator;
+    static_assert(std::is_same_v<std::iterator_traits<Iter>::iterator_category,
+      std::random_access_iterator_tag>);
+
+    conn->execute([](auto&& row)
+    {
+      const auto values = row.values();
+      DMITIGR_ASSERT(values.size() == 3 && !values.empty());
+      DMITIGR_ASSERT(values.end() - values.begin() == 3);
+      DMITIGR_ASSERT(pgfe::to<int>(values[0]) == 1);
+      DMITIGR_ASSERT(pgfe::to<std::string_view>(values.begin()[1]) == "two");
+      DMITIGR_ASSERT(!values[2]);
+      int count{};
+      for (const auto value : values) {
+        DMITIGR_ASSERT(value == row.data(count));
+        ++count;
+      }
+      DMITIGR_ASSERT(count == 3);
+
+      const auto spans = row.spans();
+      DMITIGR_ASSERT(spans.size() == 3);
+      DMITIGR_ASSERT(spans[0] == "1" && spans[1] == "two");
+      DMITIGR_ASSERT(!spans[2].data());
+      DMITIGR_ASSERT(std::find(spans.begin(), spans.end(), "two") ==
+        spans.begin() + 1);
+    }, R"(select 1::int4 one, 'two' two, null::text three)");
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
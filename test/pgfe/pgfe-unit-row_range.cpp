@@ -0,0 +1,99 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+#include <ranges>
+#endif
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  // Complete iteration.
+  {
+    auto rows = conn->rows("select generate_series(1, $1) n", 100);
+    ASSERT(!rows.is_exhausted());
+    ASSERT(!conn->is_ready_for_request());
+    int expected{1};
+    for (auto&& row : rows)
+      ASSERT(pgfe::to<int>(row["n"]) == expected++);
+    ASSERT(expected == 101);
+    ASSERT(rows.is_exhausted());
+    ASSERT(rows.completion().tag() == "SELECT 100");
+    ASSERT(conn->is_ready_for_request());
+  }
+
+  // Early break cancels the request.
+  {
+    auto rows = conn->rows("select generate_series(1, 100000000)");
+    auto i = rows.begin();
+    for (; i != rows.end() && pgfe::to<int>((*i)[0]) != 10; ++i);
+    ASSERT(i != rows.end());
+    ASSERT(!conn->is_ready_for_request());
+  }
+  ASSERT(conn->is_ready_for_request());
+  ASSERT(conn->execute("select 1"));
+
+  // Error.
+  {
+    auto rows = conn->rows("select 1/0");
+    ASSERT(with_catch<pgfe::Server_exception>([&rows]{rows.begin();}));
+    ASSERT(rows.is_exhausted());
+    ASSERT(!rows.completion());
+    ASSERT(rows.begin() == rows.end());
+  }
+  ASSERT(conn->is_ready_for_request());
+
+  // Move.
+  {
+    auto rows = conn->rows("select generate_series(1, 3)");
+    auto rows2 = std::move(rows);
+    int sum{};
+    for (auto&& row : rows2)
+      sum += pgfe::to<int>(row[0]);
+    ASSERT(sum == 6);
+  }
+
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+  // Ranges.
+  {
+    static_assert(std::ranges::input_range<pgfe::Row_range>);
+    int sum{};
+    for (auto&& n : conn->rows("select generate_series(1, 10)")
+        | std::views::transform([](auto&& row){return pgfe::to<int>(row[0]);})
+        | std::views::filter([](const int n){return n % 2;})
+        | std::views::take(3))
+      sum += n;
+    ASSERT(sum == 1 + 3 + 5);
+  }
+  ASSERT(conn->is_ready_for_request());
+#endif
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,125 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/os/pid.hpp"
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#include <filesystem>
+#include <string>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  ASSERT(with_catch<pgfe::Client_exception>([]{pgfe::Row_spool{0};}));
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+
+  const auto query = "select n, case when n % 3 = 0 then null"
+    " else repeat('x', n % 50) end s from generate_series(1, 1000) n";
+  const auto check = [](const pgfe::Row_spool& spool)
+  {
+    ASSERT(spool.is_sealed());
+    ASSERT(spool.row_count() == 1000);
+    ASSERT(spool.field_count() == 2);
+    ASSERT(spool.info().field_name(1) == "s");
+    for (std::size_t i{}; i < spool.row_count(); ++i) {
+      const int n = static_cast<int>(i) + 1;
+      ASSERT(pgfe::to<int>(spool.data(i, 0)) == n);
+      const auto s = spool.data(i, 1);
+      if (n % 3)
+        ASSERT(pgfe::to<std::string>(s) == std::string(n % 50, 'x'));
+      else
+        ASSERT(!s);
+    }
+
+    // Batches.
+    const auto batch = spool.batch(995, 5);
+    ASSERT(batch.row_count() == 5);
+    ASSERT(pgfe::to<int>(batch.data(0, "n")) == 996);
+    ASSERT(!batch.data(0, "s"));
+    ASSERT(pgfe::to<std::string>(batch.data(4, "s")) == std::string(0, 'x'));
+    ASSERT(with_catch<pgfe::Client_exception>([&]{spool.batch(995, 6);}));
+    ASSERT(with_catch<pgfe::Client_exception>([&]{spool.batch(0, 0);}));
+  };
+
+  // In memory.
+  {
+    pgfe::Row_spool spool;
+    ASSERT(spool.memory_limit() == pgfe::Row_spool::default_memory_limit);
+    ASSERT(!spool.info());
+    const auto comp = spool.execute(*conn, query);
+    ASSERT(comp.tag() == "SELECT 1000");
+    ASSERT(!spool.is_spilled());
+    ASSERT(with_catch<pgfe::Client_exception>([&]{spool.data(0, 0);}));
+    spool.seal();
+    check(spool);
+    ASSERT(with_catch<pgfe::Client_exception>([&]{spool.execute(*conn, query);}));
+  }
+
+  // Spilled.
+  {
+    {
+      pgfe::Row_spool spool{4096};
+      conn->set_row_delivery_mode(pgfe::Row_delivery_mode::single);
+      conn->execute([&spool](pgfe::Row&& row){spool.append(row);}, query);
+      ASSERT(spool.is_spilled());
+      const auto byte_count = spool.byte_count();
+      spool.seal();
+      ASSERT(spool.byte_count() == byte_count);
+      check(spool);
+      ASSERT(with_catch<pgfe::Client_exception>([&]
+      {
+        conn->execute([&spool](pgfe::Row&& row){spool.append(row);},
+          "select 1");
+      }));
+
+      // Clear.
+      spool.clear();
+      ASSERT(!spool.is_sealed() && !spool.is_spilled());
+      ASSERT(!spool.row_count() && !spool.info());
+      spool.execute(*conn, "select 1::text");
+      spool.seal();
+      ASSERT(spool.row_count() == 1 && !spool.is_spilled());
+      ASSERT(pgfe::to<std::string>(spool.data(0, 0)) == "1");
+    }
+    for (const auto& entry : std::filesystem::directory_iterator{
+        std::filesystem::temp_directory_path()})
+      ASSERT(entry.path().filename().string().find("pgfe-spool-" +
+          std::to_string(dmitigr::os::pid()) + "-") == std::string::npos);
+  }
+
+  // Mismatched fields.
+  {
+    pgfe::Row_spool spool;
+    spool.execute(*conn, "select 1, 2");
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      spool.execute(*conn, "select 1");
+    }));
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
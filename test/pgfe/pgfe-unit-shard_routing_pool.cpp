@@ -0,0 +1,131 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <string>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using dmitigr::util::with_catch;
+  using Pool = pgfe::Shard_routing_pool;
+  const auto options = pgfe::test::connection_options();
+
+  // Offline.
+  {
+    DMITIGR_ASSERT(!Pool{}.is_valid());
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]{Pool{1, {}};}));
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+    {
+      Pool{}.shard_index("key");
+    }));
+
+    // The default hash is stable.
+    DMITIGR_ASSERT(Pool::default_hash("key") == Pool::default_hash("key"));
+    DMITIGR_ASSERT(Pool::default_hash("key1") != Pool::default_hash("key2"));
+
+    // Modulo routing.
+    Pool modulo{1, {options, options, options}};
+    DMITIGR_ASSERT(modulo.is_valid());
+    DMITIGR_ASSERT(modulo.shard_count() == 3);
+    DMITIGR_ASSERT(modulo.routing() == Pool::Routing::modulo);
+    DMITIGR_ASSERT(modulo.shard_index_by_hash(7) == 1);
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]{modulo.shard(3);}));
+    std::vector<int> counts(3);
+    for (int i{}; i < 3000; ++i)
+      ++counts[modulo.shard_index("user" + std::to_string(i))];
+    for (const auto count : counts)
+      DMITIGR_ASSERT(count > 800);
+
+    // Custom hasher.
+    Pool custom{1, {options, options}, Pool::Routing::modulo,
+      [](const std::string_view key){return std::stoull(std::string{key});}};
+    DMITIGR_ASSERT(custom.shard_index("4") == 0);
+    DMITIGR_ASSERT(custom.shard_index("5") == 1);
+
+    // Consistent hashing: adding the shard moves about 1/4 of keys.
+    Pool ring3{1, {options, options, options}, Pool::Routing::ring};
+    Pool ring4{1, {options, options, options, options}, Pool::Routing::ring};
+    int moved{};
+    for (int i{}; i < 4000; ++i) {
+      const auto key = "user" + std::to_string(i);
+      const auto index = ring4.shard_index(key);
+      DMITIGR_ASSERT(index < 4);
+      if (index != ring3.shard_index(key)) {
+        DMITIGR_ASSERT(index == 3);
+        ++moved;
+      }
+    }
+    DMITIGR_ASSERT(700 < moved && moved < 1300);
+
+    DMITIGR_ASSERT(!modulo.is_connected());
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      modulo.execute_on_all("select 1");
+    }));
+  }
+
+  Pool pool{1, {options, options}};
+  pool.connect();
+  DMITIGR_ASSERT(pool.is_connected());
+
+  // Routing.
+  {
+    auto conn = pool.connection("key", std::nullopt);
+    DMITIGR_ASSERT(conn);
+    DMITIGR_ASSERT(conn.pool() == &pool.shard(pool.shard_index("key")));
+    DMITIGR_ASSERT(!pool.try_connection("key"));
+  }
+  DMITIGR_ASSERT(pool.metrics(pool.shard_index("key")).route_count == 2);
+
+  // Scatter-gather.
+  {
+    std::vector<int> values(pool.shard_count());
+    const auto completions = pool.execute_on_all(
+      [&values](const std::size_t shard, pgfe::Row&& row)
+      {
+        values[shard] = pgfe::to<int>(row[0]);
+      }, "select $1::int", 7);
+    DMITIGR_ASSERT(completions.size() == 2);
+    DMITIGR_ASSERT(completions[0].tag() == "SELECT");
+    DMITIGR_ASSERT((values == std::vector<int>{7, 7}));
+
+    DMITIGR_ASSERT(with_catch<pgfe::Server_exception>([&]
+    {
+      pool.execute_on_all("select 1/0");
+    }));
+    for (std::size_t i{}; i < pool.shard_count(); ++i) {
+      const auto metrics = pool.metrics(i);
+      DMITIGR_ASSERT(metrics.scatter_count == 2);
+      DMITIGR_ASSERT(metrics.scatter_error_count == 1);
+      DMITIGR_ASSERT(metrics.scatter_time.count() == 1);
+    }
+    pool.reset_metrics();
+    DMITIGR_ASSERT(!pool.metrics(0).scatter_count);
+  }
+
+  pool.disconnect();
+  DMITIGR_ASSERT(!pool.is_connected());
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
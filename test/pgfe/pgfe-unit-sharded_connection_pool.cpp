@@ -0,0 +1,101 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  pgfe::Sharded_connection_pool pool{2, 1, pgfe::test::connection_options()};
+  DMITIGR_ASSERT(pool.is_valid());
+  DMITIGR_ASSERT(pool.shard_count() == 2);
+  DMITIGR_ASSERT(pool.size() == 2);
+  DMITIGR_ASSERT(!pool.is_connected());
+  pool.connect();
+  DMITIGR_ASSERT(pool.is_connected());
+
+  {
+    // The second connection is stolen from the other shard.
+    auto conn1 = pool.try_connection();
+    DMITIGR_ASSERT(conn1);
+    auto conn2 = pool.try_connection();
+    DMITIGR_ASSERT(conn2);
+    DMITIGR_ASSERT(conn1.pool() != conn2.pool());
+    auto conn3 = pool.try_connection();
+    DMITIGR_ASSERT(!conn3);
+    conn3 = pool.connection(std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(!conn3);
+
+    // Wait for the connection released by another thread.
+    std::thread releaser{[&conn1, &conn2]
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds{50});
+      conn1.release();
+      conn2.release();
+    }};
+    conn3 = pool.connection(std::nullopt);
+    releaser.join();
+    DMITIGR_ASSERT(conn3);
+    conn3->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(pgfe::to<int>(row.data()) == 1);
+    }, "select 1");
+  }
+
+  pool.disconnect();
+  DMITIGR_ASSERT(!pool.is_connected());
+
+  // Binding the shards to CPUs.
+  {
+    std::vector<unsigned> all_cpus(1024);
+    for (unsigned i{}; i < all_cpus.size(); ++i)
+      all_cpus[i] = i;
+    const auto nodes = pgfe::Sharded_connection_pool::numa_node_cpus();
+    for (const auto& node : nodes)
+      DMITIGR_ASSERT(!node.empty());
+
+    pgfe::Sharded_connection_pool bound{2, 1, pgfe::test::connection_options()};
+    DMITIGR_ASSERT(bound.shard_cpus(0).empty());
+    bound.set_shard_cpus(0, all_cpus);
+    DMITIGR_ASSERT(bound.shard_cpus(0) == all_cpus);
+    DMITIGR_ASSERT(bound.shard_cpus(1).empty());
+    DMITIGR_ASSERT(dmitigr::util::with_catch<pgfe::Client_exception>([&]
+    {
+      bound.set_shard_cpus(1, {static_cast<unsigned>(all_cpus.size())});
+    }));
+    DMITIGR_ASSERT(bound.shard_cpus(1).empty());
+    bound.connect();
+    DMITIGR_ASSERT(bound.is_connected());
+
+    // The thread runs on one of the CPUs of the first shard.
+    auto conn = bound.try_connection();
+    DMITIGR_ASSERT(conn);
+#ifdef __linux__
+    DMITIGR_ASSERT(conn.pool() == &bound.shard(0));
+#endif
+    bound.disconnect();
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
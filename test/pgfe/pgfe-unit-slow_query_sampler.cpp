@@ -0,0 +1,102 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  pgfe::Connection_pool pool{2, pgfe::test::connection_options()};
+  pool.connect();
+
+  std::mutex mutex;
+  std::condition_variable sampled;
+  std::optional<pgfe::Slow_query_sampler::Sample> sample;
+  pgfe::Slow_query_sampler sampler{pool, std::chrono::milliseconds{50},
+    [&](const pgfe::Slow_query_sampler::Sample& s)
+    {
+      pgfe::Slow_query_sampler::Sample copy;
+      copy.statement = s.statement;
+      for (const auto& p : s.parameters)
+        copy.parameters.push_back(p ? p->to_data() : nullptr);
+      copy.duration = s.duration;
+      copy.plan = s.plan;
+      const std::lock_guard lg{mutex};
+      sample = std::move(copy);
+      sampled.notify_one();
+    }};
+  DMITIGR_ASSERT(&sampler.pool() == &pool);
+  DMITIGR_ASSERT(sampler.threshold() == std::chrono::milliseconds{50});
+  DMITIGR_ASSERT(sampler.max_queue_size() ==
+    pgfe::Slow_query_sampler::default_max_queue_size);
+  DMITIGR_ASSERT(!sampler.is_stopped());
+
+  auto conn = pool.connection();
+  DMITIGR_ASSERT(conn);
+
+  // Fast query is not sampled.
+  int value{};
+  sampler.execute(*conn, [&value](auto&& row)
+  {
+    value = pgfe::to<int>(row[0]);
+  }, "select $1::integer", 1);
+  DMITIGR_ASSERT(value == 1);
+
+  // Slow query is sampled.
+  sampler.execute(*conn,
+    "select pg_sleep(0.1), $1::integer, :name::text", 2,
+    pgfe::a{"name", std::string{"dmitigr"}});
+  {
+    std::unique_lock lk{mutex};
+    DMITIGR_ASSERT(sampled.wait_for(lk, std::chrono::seconds{5},
+        [&sample]{return sample.has_value();}));
+  }
+  DMITIGR_ASSERT(sample->duration >= std::chrono::milliseconds{50});
+  DMITIGR_ASSERT(sample->parameters.size() == 2);
+  DMITIGR_ASSERT(pgfe::to<int>(*sample->parameters[0]) == 2);
+  DMITIGR_ASSERT(pgfe::to<std::string>(*sample->parameters[1]) == "dmitigr");
+  DMITIGR_ASSERT(sample->plan.find("\"Plan\"") != std::string::npos);
+  DMITIGR_ASSERT(sampler.sample_count() == 1);
+  DMITIGR_ASSERT(sampler.drop_count() == 0);
+
+  // The sample is dropped if there is no spare connection.
+  {
+    auto conn2 = pool.connection();
+    DMITIGR_ASSERT(conn2);
+    sampler.execute(*conn, "select pg_sleep(0.1)");
+    const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds{5};
+    while (!sampler.drop_count() && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    DMITIGR_ASSERT(sampler.drop_count() == 1);
+    DMITIGR_ASSERT(sampler.sample_count() == 1);
+  }
+
+  sampler.stop();
+  DMITIGR_ASSERT(sampler.is_stopped());
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
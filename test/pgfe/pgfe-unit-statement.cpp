@@ -70,6 +70,32 @@ int main()
       std::cout << st.to_string() << std::endl;
     }
 
+    // Static_statement
+    {
+      static constexpr pgfe::Static_statement sst{
+        "-- $id$static$id$\n"
+        "SELECT :a, :'b', $1, :a, 'it''s :x' /* :y */ FROM :\"c\""};
+      static_assert(sst.positional_parameter_count() == 1);
+      static_assert(sst.named_parameter_count() == 3);
+      static_assert(sst.parameter_count() == 4);
+      static_assert(!sst.has_missing_parameters());
+
+      const pgfe::Statement st = sst;
+      const pgfe::Statement rst{sst.text()};
+      DMITIGR_ASSERT(st.to_string() == rst.to_string());
+      DMITIGR_ASSERT(st.parameter_count() == rst.parameter_count());
+      for (std::size_t i{1}; i < st.parameter_count(); ++i)
+        DMITIGR_ASSERT(st.parameter_name(i) == rst.parameter_name(i));
+      DMITIGR_ASSERT(st.parameter_index("a") == 1);
+      DMITIGR_ASSERT(st.is_parameter_literal("b"));
+      DMITIGR_ASSERT(st.is_parameter_identifier("c"));
+      DMITIGR_ASSERT(pgfe::to<std::string>(st.extra().data("id")) == "static");
+
+      static constexpr pgfe::Static_statement missing{"SELECT $2"};
+      static_assert(missing.has_missing_parameters());
+      static_assert(missing.parameter_count() == 2);
+    }
+
     {
       pgfe::Statement st{R"(SELECT :num, :num, :'txt', :'txt' FROM :"tab", :"tab")"};
       DMITIGR_ASSERT(!st.is_empty());
@@ -105,6 +131,33 @@ int main()
       conn->connect();
       std::cout << st.to_string() << std::endl;
       std::cout << st.to_query_string(*conn) << std::endl;
+
+      DMITIGR_ASSERT(st.to_query_string(*conn) ==
+        R"(SELECT 1, 1, 'one', 'one' FROM "number", "number")");
+      st.bind("txt", "two");
+      DMITIGR_ASSERT(st.to_query_string(*conn) ==
+        R"(SELECT 1, 1, 'two', 'two' FROM "number", "number")");
+      const pgfe::Statement st_copy{st};
+      DMITIGR_ASSERT(st_copy.to_query_string(*conn) == st.to_query_string(*conn));
+
+      // The query string cached by the connection is refreshed upon bind().
+      const auto value_of = [&conn](const pgfe::Statement& statement)
+      {
+        std::string result;
+        conn->execute([&result](auto&& row)
+        {
+          result = pgfe::to<std::string>(row.data());
+        }, statement);
+        return result;
+      };
+      pgfe::Statement sel{"select :val::text"};
+      sel.bind("val", "one");
+      DMITIGR_ASSERT(value_of(sel) == "one");
+      DMITIGR_ASSERT(value_of(sel) == "one");
+      sel.bind("val", "two");
+      DMITIGR_ASSERT(value_of(sel) == "two");
+      const pgfe::Statement sel_copy{sel};
+      DMITIGR_ASSERT(value_of(sel_copy) == "two");
     }
 
     {
@@ -149,6 +202,24 @@ int main()
 
       std::cout << "Final SQL string is: " << s_orig.to_string() << std::endl;
     }
+
+    // Many named parameters (hash-indexed lookup).
+    {
+      std::string sql{"SELECT $1"};
+      for (int i{}; i < 256; ++i)
+        sql.append(", :p").append(std::to_string(i))
+          .append(", :p").append(std::to_string(i));
+      pgfe::Statement s_orig{sql};
+      pgfe::Statement s_moved{pgfe::Statement{s_orig}};
+      for (const auto* const st : {&s_orig, &s_moved}) {
+        DMITIGR_ASSERT(st->named_parameter_count() == 256);
+        for (int i{}; i < 256; ++i)
+          DMITIGR_ASSERT(st->parameter_index("p" + std::to_string(i))
+            == static_cast<std::size_t>(i) + 1);
+        DMITIGR_ASSERT(st->parameter_index("p256") == st->parameter_count());
+        DMITIGR_ASSERT(st->parameter_index("") == st->parameter_count());
+      }
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
@@ -0,0 +1,118 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  using pgfe::Statement;
+  using pgfe::Statement_binding;
+  using pgfe::to;
+  using dmitigr::util::with_catch;
+
+  const auto tmpl = std::make_shared<const Statement>(
+    "select $1::int + :x::int, :'val'::text as :\"col\"");
+
+  // Offline.
+  {
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([]
+    {
+      Statement_binding{nullptr};
+    }));
+
+    Statement_binding binding{tmpl};
+    DMITIGR_ASSERT(binding.statement() == tmpl);
+    DMITIGR_ASSERT(!binding.has_bound_parameters());
+    DMITIGR_ASSERT(!binding.bound("val"));
+    binding.bind("val", "one").bind("col", "c");
+    DMITIGR_ASSERT(binding.bound_parameter_count() == 2);
+    DMITIGR_ASSERT(binding.bound("val") == "one");
+    DMITIGR_ASSERT(!tmpl->bound("val")); // the template isn't affected
+    binding.bind("val", std::nullopt);
+    DMITIGR_ASSERT(binding.bound_parameter_count() == 1);
+    binding.clear();
+    DMITIGR_ASSERT(!binding.has_bound_parameters());
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&binding]
+    {
+      binding.bind("unknown", "1");
+    }));
+  }
+
+  // Rendering and execution.
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  {
+    Statement_binding binding{tmpl};
+    binding.bind("val", "it's").bind("col", "the col");
+    DMITIGR_ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      Statement_binding{tmpl}.to_query_string(*conn); // :'val' isn't bound
+    }));
+    DMITIGR_ASSERT(binding.to_query_string(*conn) ==
+      "select $1::int + $2::int, 'it''s'::text as \"the col\"");
+
+    binding.bind("x", "2");
+    std::string buffer{"/* a */ "};
+    binding.append_query_string(buffer, *conn);
+    DMITIGR_ASSERT(buffer ==
+      "/* a */ select $1::int + 2::int, 'it''s'::text as \"the col\"");
+
+    conn->execute([](auto&& row)
+    {
+      DMITIGR_ASSERT(to<int>(row[0]) == 3);
+      DMITIGR_ASSERT(row.info().field_name(1) == "the col");
+      DMITIGR_ASSERT(to<std::string>(row[1]) == "it's");
+    }, binding, 1);
+  }
+
+  // Sharing the template among threads.
+  {
+    std::vector<std::thread> workers;
+    for (int i{}; i < 4; ++i) {
+      workers.emplace_back([&tmpl, i]
+      {
+        auto conn = pgfe::test::make_connection();
+        conn->connect();
+        conn->set_statement_cache_capacity(4);
+        Statement_binding binding{tmpl};
+        binding.bind("col", "c").bind("x", std::to_string(i));
+        for (int j{}; j < 10; ++j) {
+          binding.bind("val", std::to_string(j));
+          conn->execute([i, j](auto&& row)
+          {
+            DMITIGR_ASSERT(to<int>(row[0]) == i + j);
+            DMITIGR_ASSERT(to<int>(row[1]) == j);
+          }, binding, j);
+        }
+      });
+    }
+    for (auto& worker : workers)
+      worker.join();
+  }
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
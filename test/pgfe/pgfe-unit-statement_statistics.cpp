@@ -0,0 +1,125 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/pgfe/statement_statistics.hpp"
+
+#include <iostream>
+#include <sstream>
+
+int main()
+{
+  try {
+    namespace pgfe = dmitigr::pgfe;
+    using namespace std::chrono_literals;
+    using pgfe::Statement_statistics;
+
+    // Normalization.
+    {
+      const auto norm = &Statement_statistics::normalized_query;
+      DMITIGR_ASSERT(norm("select 1") == "select ?");
+      DMITIGR_ASSERT(norm("  select\n\t1,  2.5e+3 ") == "select ?, ?");
+      DMITIGR_ASSERT(norm("select 'a''b', E'c\\'d', x'ff'") == "select ?, ?, ?");
+      DMITIGR_ASSERT(norm("select $tag$ $1 $tag$, $$x$$") == "select ?, ?");
+      DMITIGR_ASSERT(norm("select $1, $2 from t1 where c2 = 3") ==
+        "select $1, $2 from t1 where c2 = ?");
+      DMITIGR_ASSERT(norm("select \"col 1\" -- comment\nfrom t /* a /* b */ */")
+        == "select \"col 1\" from t");
+      DMITIGR_ASSERT(norm("") == "");
+    }
+
+    // Recording.
+    {
+      Statement_statistics stats{2};
+      DMITIGR_ASSERT(stats.max_entry_count() == 2);
+      DMITIGR_ASSERT(stats.entries().empty());
+
+      std::size_t next_call_count{};
+      const auto handler = stats.trace_handler([&next_call_count](const auto&)
+      {
+        ++next_call_count;
+      });
+
+      pgfe::Trace_event event;
+      event.request = pgfe::Trace_request::execute;
+      event.query = "select 1";
+      event.point = pgfe::Trace_point::request;
+      handler(event); // not recorded
+      DMITIGR_ASSERT(next_call_count == 1);
+      DMITIGR_ASSERT(stats.entries().empty());
+
+      event.point = pgfe::Trace_point::completion;
+      event.row_count = 1;
+      event.byte_count = 100;
+      event.duration = 10us;
+      handler(event);
+      event.query = "select 2";
+      event.duration = 30us;
+      event.is_failed = true;
+      handler(event);
+      DMITIGR_ASSERT(next_call_count == 3);
+
+      auto entry = stats.query_entry("select 3");
+      DMITIGR_ASSERT(entry);
+      DMITIGR_ASSERT(entry->key == "select ?");
+      DMITIGR_ASSERT(!entry->is_prepared_statement);
+      DMITIGR_ASSERT(entry->call_count == 2);
+      DMITIGR_ASSERT(entry->error_count == 1);
+      DMITIGR_ASSERT(entry->row_count == 2);
+      DMITIGR_ASSERT(entry->byte_count == 200);
+      DMITIGR_ASSERT(entry->min_duration == 10us);
+      DMITIGR_ASSERT(entry->durations.max() == 30us);
+      DMITIGR_ASSERT(entry->durations.sum() == 40us);
+      DMITIGR_ASSERT(entry->durations.percentile(99) == 30us);
+
+      event.query = {};
+      event.prepared_statement_name = "ps1";
+      event.is_failed = false;
+      event.duration = 100us;
+      handler(event);
+      entry = stats.prepared_statement_entry("ps1");
+      DMITIGR_ASSERT(entry);
+      DMITIGR_ASSERT(entry->is_prepared_statement);
+      DMITIGR_ASSERT(entry->call_count == 1);
+      DMITIGR_ASSERT(!stats.prepared_statement_entry("ps2"));
+
+      // The limit of entries is reached.
+      event.prepared_statement_name = "ps2";
+      handler(event);
+      DMITIGR_ASSERT(!stats.prepared_statement_entry("ps2"));
+      DMITIGR_ASSERT(stats.drop_count() == 1);
+
+      const auto entries = stats.entries();
+      DMITIGR_ASSERT(entries.size() == 2);
+      DMITIGR_ASSERT(entries[0].key == "ps1");
+      DMITIGR_ASSERT(entries[1].key == "select ?");
+
+      std::ostringstream out;
+      stats.dump(out, true);
+      DMITIGR_ASSERT(out.str() ==
+        "ps1\t1\t0\t1\t100\t100\t100\t100\t100\n"
+        "select ?\t2\t1\t2\t200\t40\t10\t30\t30\n");
+      DMITIGR_ASSERT(stats.entries().empty());
+      DMITIGR_ASSERT(!stats.drop_count());
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
@@ -17,6 +17,9 @@
 #include "../../src/str/stream.hpp"
 #include "pgfe-unit.hpp"
 
+#include <sstream>
+#include <string_view>
+
 int main(int, char* argv[])
 try {
   namespace pgfe = dmitigr::pgfe;
@@ -101,6 +104,70 @@ try {
   DMITIGR_ASSERT(bunch.statement_index("id", "plus_one") == bunch.size());
   DMITIGR_ASSERT(bunch[0].to_string() == "SELECT 2"); // SELECT 2
   DMITIGR_ASSERT(bunch.statement_index("id", "digit") == 1);
+
+  // -------------------------------------------------------------------------
+  // Extra index test
+  // -------------------------------------------------------------------------
+
+  {
+    pgfe::Statement_vector catalog{
+      "-- $id$a$id$\nSELECT 1;"
+      "-- $id$b$id$\nSELECT 2;"
+      "-- $id$a$id$\nSELECT 3"};
+    DMITIGR_ASSERT(catalog.statement_index("id", "a") == 0);
+    DMITIGR_ASSERT(catalog.statement_index("id", "a", 1) == 2);
+    DMITIGR_ASSERT(catalog.statement_index("id", "b") == 1);
+    DMITIGR_ASSERT(catalog.statement_index("id", "c") == catalog.size());
+    DMITIGR_ASSERT(catalog.statement_index("name", "a") == catalog.size());
+    catalog.remove(0);
+    DMITIGR_ASSERT(catalog.statement_index("id", "a") == 1);
+    catalog.append(pgfe::Statement{"-- $id$c$id$\nSELECT 4"});
+    DMITIGR_ASSERT(catalog.statement_index("id", "c") == 2);
+  }
+
+  // -------------------------------------------------------------------------
+  // Streaming test
+  // -------------------------------------------------------------------------
+
+  {
+    const pgfe::Statement_vector expected{input};
+    const auto assert_read = [&expected](pgfe::Statement_reader& reader)
+    {
+      std::size_t i{};
+      while (reader.read()) {
+        DMITIGR_ASSERT(i < expected.size());
+        DMITIGR_ASSERT(reader.statement().to_string() == expected[i].to_string());
+        DMITIGR_ASSERT(reader.statement().extra().field_count() ==
+          expected[i].extra().field_count());
+        ++i;
+      }
+      DMITIGR_ASSERT(reader.is_done());
+      DMITIGR_ASSERT(!reader.read());
+      DMITIGR_ASSERT(i == expected.size());
+      DMITIGR_ASSERT(reader.statement_count() == expected.size());
+    };
+
+    // In place.
+    {
+      pgfe::Statement_reader reader{std::string_view{input}};
+      assert_read(reader);
+    }
+
+    // By chunks, including the ones splitting quotes and comments.
+    for (const std::size_t chunk_size : {1, 7, 64, 65536}) {
+      std::istringstream stream{input};
+      pgfe::Statement_reader reader{stream, chunk_size};
+      assert_read(reader);
+    }
+
+    // Empty input.
+    {
+      std::istringstream stream;
+      pgfe::Statement_reader reader{stream};
+      DMITIGR_ASSERT(!reader.read());
+      DMITIGR_ASSERT(reader.is_done());
+    }
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -0,0 +1,115 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace pgfe = dmitigr::pgfe;
+
+int main()
+try {
+  namespace fs = std::filesystem;
+  const auto path = fs::temp_directory_path() / "pgfe-unit-traffic_replayer.bin";
+
+  // Empty recording.
+  {
+    pgfe::Traffic_recorder recorder{path};
+    DMITIGR_ASSERT(recorder.path() == path);
+    DMITIGR_ASSERT(!recorder.record_count());
+    DMITIGR_ASSERT(!recorder.is_failed());
+    recorder.flush();
+
+    const pgfe::Traffic_replayer replayer{path};
+    DMITIGR_ASSERT(!replayer.record_count());
+    DMITIGR_ASSERT(!replayer.session_count());
+    DMITIGR_ASSERT(replayer.recorded_duration().count() == 0);
+  }
+
+  // Malformed recording.
+  {
+    std::ofstream{path, std::ios_base::binary | std::ios_base::trunc}
+      << "PGFETRC1" << '\2';
+    bool is_thrown{};
+    try {
+      const pgfe::Traffic_replayer replayer{path};
+    } catch (const pgfe::Client_exception&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+  }
+
+  // Recording.
+  auto recorder = std::make_shared<pgfe::Traffic_recorder>(path);
+  {
+    auto conn = pgfe::test::make_connection();
+    conn->connect();
+    DMITIGR_ASSERT(!conn->traffic_recorder());
+    conn->set_traffic_recorder(recorder);
+    DMITIGR_ASSERT(conn->traffic_recorder() == recorder);
+    conn->execute("select $1::integer, $2::text", 1, nullptr);
+    auto ps = conn->prepare("select :n::integer + 1", "ps1");
+    for (int i{}; i < 3; ++i)
+      ps.bind("n", i).execute();
+    bool is_thrown{};
+    try {
+      conn->execute("select 1/0 where $1", true);
+    } catch (const pgfe::Server_exception&) {
+      is_thrown = true;
+    }
+    DMITIGR_ASSERT(is_thrown);
+    conn->set_traffic_recorder(nullptr);
+    conn->execute("select 1");
+  }
+  {
+    auto conn = pgfe::test::make_connection();
+    conn->connect();
+    conn->set_traffic_recorder(recorder);
+    conn->execute("select 2");
+  }
+  DMITIGR_ASSERT(recorder->record_count() == 7);
+  DMITIGR_ASSERT(!recorder->is_failed());
+  recorder->flush();
+
+  // Replaying.
+  {
+    pgfe::Traffic_replayer replayer{path};
+    DMITIGR_ASSERT(replayer.record_count() == 7);
+    DMITIGR_ASSERT(replayer.session_count() == 2);
+    DMITIGR_ASSERT(replayer.speed() == 1);
+    replayer.set_speed(0);
+
+    pgfe::Connection_pool pool{2, pgfe::test::connection_options()};
+    pool.connect();
+    const auto result = replayer.replay(pool);
+    DMITIGR_ASSERT(result.request_count == 7);
+    DMITIGR_ASSERT(result.error_count == 1);
+    DMITIGR_ASSERT(!result.skip_count);
+    DMITIGR_ASSERT(result.latencies.count() == 7);
+    DMITIGR_ASSERT(result.latencies.percentile(50) <= result.latencies.max());
+  }
+
+  fs::remove(path);
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
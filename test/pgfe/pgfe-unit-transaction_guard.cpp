@@ -17,6 +17,7 @@
 #include "pgfe-unit.hpp"
 
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 #define ASSERT DMITIGR_ASSERT
@@ -109,6 +110,58 @@ try {
   } catch (...) {
     ASSERT(!conn->is_connected() || !conn->is_transaction_uncommitted());
   }
+
+  // Pipelined transaction blocks.
+  if (!conn->is_connected())
+    conn->connect();
+  {
+    using Mode = Transaction_guard::Mode;
+    conn->set_pipeline_enabled(true);
+    {
+      Transaction_guard tg{*conn, Mode::pipelined};
+      ASSERT(tg.mode() == Mode::pipelined);
+      ASSERT(!tg.is_subtransaction());
+      const auto ignore = [](auto&&){};
+      conn->execute_pipelined(ignore, "create temp table pgfe_tg(n int)");
+      conn->execute_pipelined(ignore, "insert into pgfe_tg values (1)");
+      {
+        Transaction_guard st{*conn, Mode::pipelined, true, "p"};
+        ASSERT(st.is_subtransaction());
+        conn->execute_pipelined(ignore, "insert into pgfe_tg values (2)");
+        st.commit(); // release p
+      }
+      {
+        Transaction_guard st{*conn, Mode::pipelined, true, "p"};
+        conn->execute_pipelined(ignore, "insert into pgfe_tg values (3)");
+      } // rollback to savepoint p
+      tg.commit();
+      ASSERT(!conn->is_transaction_uncommitted());
+    }
+    int sum{};
+    conn->execute_pipelined([&sum](auto&& response)
+    {
+      if constexpr (std::is_same_v<std::decay_t<decltype(response)>, pgfe::Row>)
+        sum = pgfe::to<int>(response.data());
+    }, "select sum(n)::int from pgfe_tg");
+    conn->complete_pipeline();
+    ASSERT(sum == 3);
+
+    // Error in the pipelined transaction.
+    {
+      bool is_thrown{};
+      Transaction_guard tg{*conn, Mode::pipelined};
+      conn->execute_pipelined([](auto&&){}, "insert into pgfe_tg values ('x')");
+      try {
+        tg.commit();
+      } catch (const pgfe::Client_exception&) {
+        is_thrown = true;
+      }
+      ASSERT(is_thrown);
+    }
+    conn->complete_pipeline();
+    ASSERT(!conn->is_transaction_uncommitted());
+    conn->set_pipeline_enabled(false);
+  }
 } catch (const std::exception& e) {
   std::cerr << e.what() << std::endl;
   return 1;
@@ -0,0 +1,176 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pgfe-unit.hpp"
+
+#include <string>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+namespace {
+
+struct Labeled final {
+  int id{};
+  std::string label;
+};
+
+} // namespace
+
+template<> struct dmitigr::pgfe::Row_mapping<Labeled> final {
+  static constexpr auto fields = std::make_tuple(
+    mapped_field("id", &Labeled::id),
+    mapped_field("label", &Labeled::label));
+};
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("drop domain if exists pgfe_type_catalog_domain");
+  conn->execute("drop type if exists pgfe_type_catalog_composite");
+  conn->execute("drop type if exists pgfe_type_catalog_enum");
+  conn->execute("create type pgfe_type_catalog_enum as enum ('one', 'two')");
+  conn->execute("create type pgfe_type_catalog_composite as"
+    " (id integer, label pgfe_type_catalog_enum)");
+  conn->execute("create domain pgfe_type_catalog_domain as bigint");
+
+  // Initial state.
+  const auto catalog = conn->type_catalog();
+  ASSERT(catalog);
+  ASSERT(!catalog->is_loaded());
+  ASSERT(!catalog->size());
+  ASSERT(!catalog->descriptor(23));
+
+  // Load.
+  catalog->load(*conn);
+  ASSERT(catalog->is_loaded());
+  ASSERT(catalog->size() > 0);
+  {
+    const auto int4 = catalog->descriptor(23);
+    ASSERT(int4);
+    ASSERT(int4->schema == "pg_catalog");
+    ASSERT(int4->name == "int4");
+    ASSERT(int4->kind == pgfe::Type_kind::base);
+    ASSERT(int4->length == 4);
+    ASSERT(!int4->is_array());
+    ASSERT(catalog->descriptor("int4") == int4);
+    ASSERT(catalog->descriptor("pg_catalog.int4") == int4);
+
+    const auto int4_array = catalog->descriptor(int4->array_oid);
+    ASSERT(int4_array && int4_array->is_array());
+    ASSERT(int4_array->element_oid == 23);
+  }
+
+  // Enumerated type.
+  const auto enumeration = catalog->descriptor("pgfe_type_catalog_enum");
+  ASSERT(enumeration);
+  ASSERT(enumeration->kind == pgfe::Type_kind::enumeration);
+  ASSERT((enumeration->labels == std::vector<std::string>{"one", "two"}));
+  ASSERT(catalog->representation_oid(enumeration->oid) == 25);
+
+  // Composite type.
+  const auto composite = catalog->descriptor(
+    "public.pgfe_type_catalog_composite");
+  ASSERT(composite);
+  ASSERT(composite->kind == pgfe::Type_kind::composite);
+  ASSERT(composite->fields.size() == 2);
+  ASSERT(composite->fields[0].name == "id");
+  ASSERT(composite->fields[0].type_oid == 23);
+  ASSERT(composite->fields[1].type_oid == enumeration->oid);
+  ASSERT(composite->field_index("label") == 1);
+  ASSERT(composite->field_index("none") == 2);
+
+  // Domain.
+  const auto domain = catalog->descriptor("pgfe_type_catalog_domain");
+  ASSERT(domain);
+  ASSERT(domain->kind == pgfe::Type_kind::domain);
+  ASSERT(domain->base_oid == 20);
+  ASSERT(catalog->representation_oid(domain->oid) == 20);
+  ASSERT(catalog->representation_oid(23) == 23);
+
+  // Decoders.
+  conn->set_result_format(pgfe::Data_format::binary);
+  conn->execute([&catalog](auto&& row)
+  {
+    const auto d = catalog->make_decoder<int>(row.info(), 0);
+    ASSERT(d.is_specialized());
+    ASSERT(d(row.data(0)) == 7);
+    const auto e = catalog->make_decoder<std::string>(row.info(), 1);
+    ASSERT(e.is_specialized());
+    ASSERT(e(row.data(1)) == "two");
+  }, "select 7::pgfe_type_catalog_domain,"
+    " 'two'::pgfe_type_catalog_enum");
+
+  // Binary composites.
+  conn->execute([&catalog, &composite](auto&& row)
+  {
+    const auto tuple = catalog->to_tuple(row.data(0), composite->oid);
+    ASSERT(tuple.field_count() == 2);
+    ASSERT(tuple.field_name(0) == "id");
+    ASSERT(tuple.field_name(1) == "label");
+    ASSERT(pgfe::to<int>(tuple.data("id")) == 1);
+    ASSERT(pgfe::to<std::string>(tuple.data("label")) == "one");
+    const auto labeled = pgfe::map_composite<Labeled>(tuple);
+    ASSERT(labeled.id == 1);
+    ASSERT(labeled.label == "one");
+  }, "select (1, 'one')::pgfe_type_catalog_composite");
+  conn->set_result_format(pgfe::Data_format::text);
+  conn->set_result_format(pgfe::Data_format::text);
+
+  // Load on demand.
+  catalog->clear();
+  ASSERT(!catalog->is_loaded());
+  ASSERT(!catalog->size());
+  {
+    const auto descriptor = catalog->descriptor(*conn, composite->oid);
+    ASSERT(descriptor);
+    ASSERT(descriptor->fields.size() == 2);
+    ASSERT(catalog->size() == 1);
+    ASSERT(catalog->descriptor(composite->oid) == descriptor);
+    ASSERT(!catalog->descriptor(*conn, pgfe::invalid_oid));
+  }
+
+  // Sharing.
+  {
+    auto conn2 = pgfe::test::make_connection();
+    ASSERT(conn2->type_catalog() != catalog);
+    conn2->set_type_catalog(catalog);
+    ASSERT(conn2->type_catalog() == catalog);
+
+    pgfe::Connection_pool pool{2, pgfe::test::connection_options()};
+    ASSERT(pool.type_catalog());
+    pool.connect();
+    auto c1 = pool.connection();
+    auto c2 = pool.connection();
+    ASSERT(c1->type_catalog() == pool.type_catalog());
+    ASSERT(c2->type_catalog() == pool.type_catalog());
+    pool.type_catalog()->load(*c1);
+    ASSERT(c2->type_catalog()->descriptor("pgfe_type_catalog_enum"));
+  }
+
+  conn->execute("drop domain pgfe_type_catalog_domain");
+  conn->execute("drop type pgfe_type_catalog_composite");
+  conn->execute("drop type pgfe_type_catalog_enum");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
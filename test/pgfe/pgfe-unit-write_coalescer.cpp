@@ -0,0 +1,129 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/util/diagnostic.hpp"
+#include "pgfe-unit.hpp"
+
+#include <chrono>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define ASSERT DMITIGR_ASSERT
+
+int main()
+try {
+  namespace pgfe = dmitigr::pgfe;
+  using dmitigr::util::with_catch;
+
+  const auto options = pgfe::test::connection_options();
+
+  // Offline.
+  {
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      pgfe::Write_coalescer{options, "", {"a"}};
+    }));
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      pgfe::Write_coalescer{options, "tab", {}};
+    }));
+
+    pgfe::Write_coalescer coalescer{options, "tab", {"a", "b"}};
+    ASSERT(coalescer.table() == "tab");
+    ASSERT(coalescer.columns().size() == 2);
+    ASSERT(coalescer.max_batch_size() ==
+      pgfe::Write_coalescer::default_max_batch_size);
+    ASSERT(coalescer.max_delay() == pgfe::Write_coalescer::default_max_delay);
+    coalescer.set_max_batch_size(100);
+    ASSERT(coalescer.max_batch_size() == 100);
+    coalescer.set_max_delay(std::chrono::milliseconds{1});
+    ASSERT(coalescer.max_delay() == std::chrono::milliseconds{1});
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      coalescer.set_max_batch_size(0);
+    }));
+    ASSERT(with_catch<pgfe::Client_exception>([&]
+    {
+      coalescer.set_max_delay(std::chrono::milliseconds::zero());
+    }));
+    ASSERT(with_catch<pgfe::Client_exception>([&]{coalescer.insert(1);}));
+    ASSERT(!coalescer.is_stopped());
+    // The failure of the flush is reported by the future.
+    auto inserted = coalescer.insert(1, "one");
+    coalescer.stop();
+    ASSERT(with_catch<pgfe::Exception>([&]{inserted.get();}));
+    ASSERT(coalescer.is_stopped());
+    ASSERT(with_catch<pgfe::Client_exception>([&]{coalescer.insert(1, "one");}));
+  }
+
+  auto conn = pgfe::test::make_connection();
+  conn->connect();
+  conn->execute("drop table if exists pgfe_write_coalescer_test");
+  conn->execute("create table pgfe_write_coalescer_test"
+    "(id int4 primary key, name text)");
+
+  // Inserts from many threads.
+  {
+    constexpr int thread_count{8};
+    constexpr int row_count{1000};
+    pgfe::Write_coalescer coalescer{options, "pgfe_write_coalescer_test",
+      {"id", "name"}};
+    coalescer.set_max_batch_size(500);
+    std::vector<std::thread> threads;
+    for (int t{}; t < thread_count; ++t) {
+      threads.emplace_back([&coalescer, t]
+      {
+        std::vector<std::future<void>> inserted;
+        for (int i{}; i < row_count; ++i) {
+          const int id{t * row_count + i};
+          inserted.push_back(coalescer.insert(id, id % 2 ?
+              std::optional<std::string>{"name" + std::to_string(id)} :
+              std::nullopt));
+        }
+        for (auto& f : inserted)
+          f.get();
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    conn->execute([](auto&& row)
+    {
+      ASSERT(pgfe::to<long long>(row[0]) == thread_count * row_count);
+      ASSERT(pgfe::to<long long>(row[1]) == thread_count * row_count / 2);
+    }, "select count(*), count(name) from pgfe_write_coalescer_test");
+
+    // The failure of the batch is reported by the futures of its rows.
+    auto duplicate = coalescer.insert(0, "zero");
+    ASSERT(with_catch<pgfe::Server_exception>([&]{duplicate.get();}));
+
+    // The connection is re-established after the failure.
+    auto inserted = coalescer.insert(-1, "minus one");
+    coalescer.stop();
+    inserted.get();
+  }
+
+  conn->execute("drop table pgfe_write_coalescer_test");
+} catch (const std::exception& e) {
+  std::cerr << e.what() << std::endl;
+  return 1;
+} catch (...) {
+  std::cerr << "unknown error" << std::endl;
+  return 2;
+}
@@ -0,0 +1,75 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/str/hex.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+int main()
+{
+  try {
+    namespace str = dmitigr::str;
+
+    // Encode and decode all of the byte values with the sizes which cover
+    // both the SIMD and the scalar paths.
+    std::string bytes;
+    for (int i{}; i < 256 + 45; ++i)
+      bytes += static_cast<char>(i % 256);
+    for (std::size_t size{}; size <= bytes.size(); ++size) {
+      std::string hex(2*size, '\0');
+      str::hex_encode(hex.data(), bytes.data(), size);
+      for (std::size_t i{}; i < size; ++i) {
+        const auto b = static_cast<unsigned char>(bytes[i]);
+        DMITIGR_ASSERT(hex[2*i] == "0123456789abcdef"[b >> 4]);
+        DMITIGR_ASSERT(hex[2*i + 1] == "0123456789abcdef"[b & 0xf]);
+      }
+
+      std::string decoded(size, '\0');
+      DMITIGR_ASSERT(str::hex_decode(decoded.data(), hex.data(), hex.size()));
+      DMITIGR_ASSERT(decoded == bytes.substr(0, size));
+    }
+
+    // Uppercase digits.
+    {
+      const std::string hex{"DEADBEEF0123456789ABCDEFabcdef00DEADBEEF"};
+      std::string decoded(hex.size() / 2, '\0');
+      DMITIGR_ASSERT(str::hex_decode(decoded.data(), hex.data(), hex.size()));
+      DMITIGR_ASSERT(decoded[0] == '\xde' && decoded[19] == '\xef');
+    }
+
+    // Invalid digits at the any position.
+    {
+      const std::string valid(64, 'a');
+      std::string decoded(valid.size() / 2, '\0');
+      for (const char c : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\xff'}) {
+        for (std::size_t i{}; i < valid.size(); ++i) {
+          auto hex = valid;
+          hex[i] = c;
+          DMITIGR_ASSERT(!str::hex_decode(decoded.data(), hex.data(), hex.size()));
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
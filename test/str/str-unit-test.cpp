@@ -15,9 +15,16 @@
 // limitations under the License.
 
 #include "../../src/base/assert.hpp"
+#include "../../src/str/line.hpp"
 #include "../../src/str/sequence.hpp"
+#include "../../src/str/stream.hpp"
 #include "../../src/str/transform.hpp"
 
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
 int main()
 {
   try {
@@ -69,6 +76,37 @@ int main()
       DMITIGR_ASSERT(s == "con ten t");
     }
 
+    // In place and view
+    {
+      std::string s{"  content \t"};
+      DMITIGR_ASSERT(str::trimmed_view(s) == "content");
+      DMITIGR_ASSERT(str::trimmed_view(s, str::Trim::lhs) == "content \t");
+      DMITIGR_ASSERT(str::trimmed_view(s, str::Trim::rhs) == "  content");
+      DMITIGR_ASSERT(str::trimmed_view(" \t ").empty());
+      str::trim(s, str::Trim::rhs);
+      DMITIGR_ASSERT(s == "  content");
+      str::trim(s);
+      DMITIGR_ASSERT(s == "content");
+    }
+
+    // -------------------------------------------------------------------------
+    // case
+    // -------------------------------------------------------------------------
+
+    {
+      const std::string upper{"SELECT * FROM \xc0\xc1 WHERE ID = 1 AND NAME = 'DMITIGR'"};
+      const std::string lower{"select * from \xc0\xc1 where id = 1 and name = 'dmitigr'"};
+      DMITIGR_ASSERT(str::to_lowercase(upper) == lower);
+      DMITIGR_ASSERT(str::to_uppercase(lower) == upper);
+      DMITIGR_ASSERT(str::is_lowercased("abcdefghijklmnopqrstuvwxyz"));
+      DMITIGR_ASSERT(!str::is_lowercased("abcdefghijklmnopqrstuvwxyZ"));
+      DMITIGR_ASSERT(!str::is_lowercased("abcdefghijklmnop qrstuvwxyz"));
+      DMITIGR_ASSERT(str::is_uppercased("ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
+      DMITIGR_ASSERT(!str::is_uppercased("aBCDEFGHIJKLMNOPQRSTUVWXYZ"));
+      DMITIGR_ASSERT(!str::is_uppercased("ABCDEFGHIJKLMNOP\xc0QRSTUVWXYZ"));
+      DMITIGR_ASSERT(str::is_uppercased(""));
+    }
+
     // -------------------------------------------------------------------------
     // split
     // -------------------------------------------------------------------------
@@ -137,6 +175,154 @@ int main()
       DMITIGR_ASSERT(v[1] == "2");
       DMITIGR_ASSERT(v[2] == "3");
     }
+
+    // Lazy split
+    {
+      const std::string s{"host=localhost port=5432;;dbname=pgfe_test user=pgfe_test;"};
+      std::vector<std::string_view> v;
+      for (const auto part : str::split(s, " ;"))
+        v.push_back(part);
+      DMITIGR_ASSERT(v == str::to_vector<std::string_view>(s, " ;"));
+      DMITIGR_ASSERT(v.size() == 6);
+      DMITIGR_ASSERT(v[1] == "port=5432");
+      DMITIGR_ASSERT(v[2].empty());
+      DMITIGR_ASSERT(v[4] == "user=pgfe_test");
+      DMITIGR_ASSERT(v[5].empty());
+      const auto r = str::split("", ",");
+      DMITIGR_ASSERT(r.begin() == r.end());
+    }
+
+    // find_first_of_chars
+    {
+      const std::string s(40, 'a');
+      const char* const e{s.data() + s.size()};
+      DMITIGR_ASSERT(str::find_first_of_chars(s.data(), e, "") == e);
+      DMITIGR_ASSERT(str::find_first_of_chars(s.data(), e, "bcd") == e);
+      DMITIGR_ASSERT(str::find_first_of_chars(s.data(), e,
+          "bcdefghijklmnopqrstuvwxyz") == e);
+      for (const std::size_t pos : {0, 15, 16, 33, 39}) {
+        auto s2 = s;
+        s2[pos] = 'd';
+        const char* const e2{s2.data() + s2.size()};
+        DMITIGR_ASSERT(str::find_first_of_chars(s2.data(), e2, "bcd") ==
+          s2.data() + pos);
+        DMITIGR_ASSERT(str::find_first_of_chars(s2.data(), e2,
+            "bcdefghijklmnopqrstuvwxyz") == s2.data() + pos);
+      }
+    }
+
+    // -------------------------------------------------------------------------
+    // to_string
+    // -------------------------------------------------------------------------
+
+    {
+      const std::vector<int> v{1, 22, 333};
+      DMITIGR_ASSERT(str::to_string(v, ", ",
+          [](const int e){return std::to_string(e);}) == "1, 22, 333");
+      DMITIGR_ASSERT(str::to_string(v, ", ",
+          [](std::string& result, const int e)
+          {
+            result.append(std::to_string(e));
+          }) == "1, 22, 333");
+      const auto appender = [](std::string& result, const int e)
+      {
+        result.append(static_cast<std::size_t>(e % 10), '*');
+      };
+      const auto estimator = [](const int e)
+      {
+        return static_cast<std::size_t>(e % 10);
+      };
+      const auto s = str::to_string(v.cbegin(), v.cend(), "|", appender, estimator);
+      DMITIGR_ASSERT(s == "*|**|***");
+      DMITIGR_ASSERT(s.capacity() >= 8);
+      DMITIGR_ASSERT(str::to_string(v.cend(), v.cend(), "|", appender,
+          estimator).empty());
+      const std::vector<std::string> v2{"a", "b"};
+      DMITIGR_ASSERT(str::to_string(v2, "") == "ab");
+    }
+
+    // -------------------------------------------------------------------------
+    // lines
+    // -------------------------------------------------------------------------
+
+    // find_char
+    {
+      const std::string s(100, 'a');
+      DMITIGR_ASSERT(str::find_char(s.data(), s.data() + s.size(), 'b') ==
+        s.data() + s.size());
+      for (const std::size_t pos : {0, 1, 15, 16, 17, 31, 64, 99}) {
+        auto s2 = s;
+        s2[pos] = 'b';
+        DMITIGR_ASSERT(str::find_char(s2.data(), s2.data() + s2.size(), 'b') ==
+          s2.data() + pos);
+      }
+    }
+
+    // for_each_line
+    {
+      std::vector<std::string_view> lines;
+      const auto append = [&lines](const std::string_view line)
+      {
+        lines.push_back(line);
+      };
+      str::for_each_line("", append);
+      DMITIGR_ASSERT(lines.empty());
+      str::for_each_line("one\n\nthree and more than sixteen chars\nfour", append);
+      DMITIGR_ASSERT(lines.size() == 4);
+      DMITIGR_ASSERT(lines[0] == "one");
+      DMITIGR_ASSERT(lines[1].empty());
+      DMITIGR_ASSERT(lines[2] == "three and more than sixteen chars");
+      DMITIGR_ASSERT(lines[3] == "four");
+      lines.clear();
+      str::for_each_line("a;b;", append, ';');
+      DMITIGR_ASSERT(lines.size() == 2);
+      DMITIGR_ASSERT(lines[0] == "a");
+      DMITIGR_ASSERT(lines[1] == "b");
+    }
+
+    // Line_index
+    {
+      const std::string s{"one\n\nthree\nfour and more than sixteen chars\n"};
+      const str::Line_index index{s};
+      DMITIGR_ASSERT(index.size() == s.size());
+      DMITIGR_ASSERT(index.line_count() == 5);
+      DMITIGR_ASSERT(index.line_position(0) == 0);
+      DMITIGR_ASSERT(index.line_position(2) == 5);
+      for (std::size_t pos{}; pos < s.size(); ++pos) {
+        DMITIGR_ASSERT(index.line_number(pos) ==
+          static_cast<std::size_t>(str::line_number_by_position(s, pos)));
+        DMITIGR_ASSERT(index.line_column_numbers(pos) ==
+          str::line_column_numbers_by_position(s, pos));
+      }
+      try {
+        (void)index.line_number(s.size());
+        DMITIGR_ASSERT(false);
+      } catch (const str::Exception&) {}
+    }
+
+    // read_to_string_views_if
+    {
+      const auto path = std::filesystem::temp_directory_path() /
+        "dmitigr_str_unit_test_lines.txt";
+      {
+        std::ofstream out{path, std::ios_base::binary};
+        out << "-- comment\nselect 1;\n-- comment\nselect 2;\n";
+      }
+      {
+        const dmitigr::fsx::Mapped_file file{path};
+        DMITIGR_ASSERT(file.size() == 42);
+        const auto lines = str::read_to_string_views_if(file,
+          [](const std::string_view line)
+          {
+            return line.substr(0, 2) != "--";
+          });
+        DMITIGR_ASSERT(lines.size() == 2);
+        DMITIGR_ASSERT(lines[0] == "select 1;");
+        DMITIGR_ASSERT(lines[1] == "select 2;");
+        DMITIGR_ASSERT(str::read_to_string_views(file).size() == 4);
+      }
+      std::filesystem::remove(path);
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
@@ -17,6 +17,7 @@
 #include "../../src/base/assert.hpp"
 #include "../../src/str/time.hpp"
 
+#include <chrono>
 #include <iostream>
 #include <limits>
 
@@ -28,6 +29,42 @@ int main()
     std::cout.precision(std::numeric_limits<long int>::max_digits10);
     std::cout << str::now() << std::endl;
     std::cout << str::now() << std::endl;
+
+    namespace chrono = std::chrono;
+    using Tp = chrono::time_point<chrono::system_clock, chrono::microseconds>;
+
+    // RFC 3339 in UTC.
+    {
+      const Tp tp{chrono::microseconds{1234567890000005}};
+      DMITIGR_ASSERT(str::to_rfc3339_string_view(tp) ==
+        "2009-02-13T23:31:30.000005Z");
+      // The same second.
+      DMITIGR_ASSERT(str::to_rfc3339_string_view(tp + chrono::microseconds{999994}) ==
+        "2009-02-13T23:31:30.999999Z");
+      // The next second.
+      DMITIGR_ASSERT(str::to_rfc3339_string_view(tp + chrono::microseconds{999995}) ==
+        "2009-02-13T23:31:31.000000Z");
+      // Before the epoch.
+      DMITIGR_ASSERT(str::to_rfc3339_string_view(Tp{chrono::microseconds{-1}}) ==
+        "1969-12-31T23:59:59.999999Z");
+    }
+
+    // RFC 3339 in the local time.
+    {
+      const auto s = str::to_rfc3339_string_view(chrono::system_clock::now(), false);
+      DMITIGR_ASSERT(s.size() == 32);
+      DMITIGR_ASSERT(s[10] == 'T');
+      DMITIGR_ASSERT(s[26] == '+' || s[26] == '-');
+      DMITIGR_ASSERT(s[29] == ':');
+      std::cout << s << std::endl;
+    }
+
+    // Human-readable.
+    {
+      const auto s = str::to_string_view(chrono::system_clock::now());
+      DMITIGR_ASSERT(s.size() == 26);
+      DMITIGR_ASSERT(s[10] == ' ' && s[19] == '.');
+    }
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     return 1;
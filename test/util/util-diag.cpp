@@ -16,7 +16,9 @@
 
 #include "../../src/util/diagnostic.hpp"
 
+#include <cstdint>
 #include <iostream>
+#include <string>
 #include <thread>
 
 int main()
@@ -26,4 +28,17 @@ int main()
     std::this_thread::sleep_for(std::chrono::milliseconds{10});
   });
   std::cout << t.count() << std::endl;
+
+  std::uint64_t allocation_count{};
+  const auto result = dmitigr::util::Benchmark{"to_string"}
+    .set_warmup_count(100)
+    .set_iteration_count(1000)
+    .set_batch_size(10)
+    .set_allocation_counter([&allocation_count]{return allocation_count;})
+    .run([&allocation_count]
+    {
+      const auto s = std::to_string(allocation_count);
+      allocation_count += !s.empty();
+    });
+  std::cout << result << std::endl;
 }
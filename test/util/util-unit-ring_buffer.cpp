@@ -0,0 +1,85 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/util/ring_buffer.hpp"
+
+#include <iostream>
+#include <memory>
+
+int main()
+{
+  try {
+    using dmitigr::util::Ring_buffer;
+
+    Ring_buffer<int> rb;
+    DMITIGR_ASSERT(rb.empty());
+    DMITIGR_ASSERT(rb.capacity() == 0);
+    for (int i{}; i < 3; ++i)
+      rb.emplace(i);
+    DMITIGR_ASSERT(rb.size() == 3);
+    DMITIGR_ASSERT(rb.capacity() == 4);
+    DMITIGR_ASSERT(rb.front() == 0);
+    DMITIGR_ASSERT(rb.back() == 2);
+
+    // Wrap around.
+    rb.pop();
+    rb.pop();
+    rb.emplace(3);
+    rb.emplace(4);
+    rb.emplace(5);
+    DMITIGR_ASSERT(rb.size() == 4);
+    DMITIGR_ASSERT(rb.capacity() == 4);
+    DMITIGR_ASSERT(rb.front() == 2);
+    DMITIGR_ASSERT(rb.back() == 5);
+
+    // Grow when wrapped.
+    rb.emplace(6);
+    DMITIGR_ASSERT(rb.capacity() == 8);
+    for (int i{2}; i <= 6; ++i) {
+      DMITIGR_ASSERT(rb.front() == i);
+      rb.pop();
+    }
+    DMITIGR_ASSERT(rb.empty());
+
+    // pop_back()
+    rb.emplace(1);
+    rb.emplace(2);
+    rb.pop_back();
+    DMITIGR_ASSERT(rb.size() == 1);
+    DMITIGR_ASSERT(rb.back() == 1);
+
+    // The popped slots release the resources.
+    {
+      Ring_buffer<std::shared_ptr<int>> rbp;
+      auto p = std::make_shared<int>(1);
+      rbp.emplace(p);
+      DMITIGR_ASSERT(p.use_count() == 2);
+      rbp.pop();
+      DMITIGR_ASSERT(p.use_count() == 1);
+      rbp.emplace(p);
+      rbp.clear();
+      DMITIGR_ASSERT(p.use_count() == 1);
+      DMITIGR_ASSERT(rbp.capacity() == 4);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,93 @@
+// -*- C++ -*-
+//
+// Copyright 2022 Dmitry Igrishin
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "../../src/base/assert.hpp"
+#include "../../src/util/autostack.hpp"
+#include "../../src/util/small_vector.hpp"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main()
+{
+  try {
+    using dmitigr::util::Autostack;
+    using dmitigr::util::Small_vector;
+
+    Small_vector<std::string, 2> v;
+    DMITIGR_ASSERT(v.empty());
+    DMITIGR_ASSERT(v.capacity() == 2);
+    DMITIGR_ASSERT(v.is_inline());
+    v.push_back("one");
+    v.emplace_back(3, 't');
+    DMITIGR_ASSERT(v.is_inline());
+
+    // Spill to the heap, with the argument referring to an element.
+    v.push_back(v[0]);
+    DMITIGR_ASSERT(!v.is_inline());
+    DMITIGR_ASSERT(v.size() == 3);
+    DMITIGR_ASSERT(v.capacity() == 4);
+    DMITIGR_ASSERT(v[0] == "one" && v[1] == "ttt" && v[2] == "one");
+
+    // Copy and move.
+    auto v2 = v;
+    DMITIGR_ASSERT(v2.size() == 3 && v2.back() == "one");
+    auto v3 = std::move(v2);
+    DMITIGR_ASSERT(v2.empty() && v2.is_inline());
+    DMITIGR_ASSERT(v3.size() == 3);
+    v3.pop_back();
+    v3.pop_back();
+    Small_vector<std::string, 2> v4;
+    v4.push_back("four");
+    v4.swap(v3);
+    DMITIGR_ASSERT(v3.size() == 1 && v3.back() == "four" && v3.is_inline());
+    DMITIGR_ASSERT(v4.size() == 1 && v4.back() == "one");
+    v4 = v3;
+    DMITIGR_ASSERT(v4.size() == 1 && v4.back() == "four");
+    v4.clear();
+    DMITIGR_ASSERT(v4.empty());
+
+    // Move-only elements.
+    Small_vector<std::unique_ptr<int>, 1> pv;
+    for (int i{}; i < 5; ++i)
+      pv.emplace_back(std::make_unique<int>(i));
+    int sum{};
+    for (const auto& p : pv)
+      sum += *p;
+    DMITIGR_ASSERT(sum == 10);
+
+    // Autostack with the default container.
+    {
+      Autostack<std::string> stack;
+      {
+        const auto guard1 = stack.push("a");
+        const auto guard2 = stack.push("b");
+        DMITIGR_ASSERT(stack.container().size() == 2);
+        DMITIGR_ASSERT(stack.container().back() == "b");
+      }
+      DMITIGR_ASSERT(stack.container().empty());
+      const auto released = stack.release();
+      DMITIGR_ASSERT(released.empty());
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 2;
+  }
+}